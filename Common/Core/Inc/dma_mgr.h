@@ -0,0 +1,87 @@
+#ifndef __DMA_MGR_H__
+#define __DMA_MGR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*DMA1请求映射(F103参考手册DMA1请求表，每个请求只接在一个通道上):X(请求名, 通道号)*/
+#define DMA_REQUEST_MAP(X)                                                                   \
+    X(ADC1, 1) X(TIM2_CH3, 1) X(TIM4_CH1, 1)                                                 \
+    X(SPI1_RX, 2) X(USART3_TX, 2) X(TIM1_CH1, 2) X(TIM2_UP, 2) X(TIM3_CH3, 2)                \
+    X(SPI1_TX, 3) X(USART3_RX, 3) X(TIM1_CH2, 3) X(TIM3_CH4, 3) X(TIM3_UP, 3)                \
+    X(SPI2_RX, 4) X(USART1_TX, 4) X(I2C2_TX, 4) X(TIM1_CH4, 4) X(TIM4_CH2, 4)                \
+    X(SPI2_TX, 5) X(USART1_RX, 5) X(I2C2_RX, 5) X(TIM1_UP, 5) X(TIM2_CH1, 5) X(TIM4_CH3, 5) \
+    X(USART2_RX, 6) X(I2C1_TX, 6) X(TIM1_CH3, 6) X(TIM3_CH1, 6)                              \
+    X(USART2_TX, 7) X(I2C1_RX, 7) X(TIM2_CH2, 7) X(TIM2_CH4, 7) X(TIM4_UP, 7)
+
+/*本板的DMA方案:X(请求名, 优先级)。通道由请求决定，两个请求落在同一通道时编译报错；
+  优先级是全局策略:时序敏感的输出最高，接收(溢出即丢数据)高于发送，可随时重试的采样及存储最低，
+  同级时通道号小的优先。新增DMA路径在此登记，并在MSP初始化中调用 Dma_Setup()*/
+#if defined(USING_SLAVE)
+/*SPI2从机(spis.h)由主机定时，发送欠载即读出错误的数据，优先于其他发送*/
+#if defined(USING_SPI_SLAVE)
+#define DMA_PRIORITY_SPI2_TX DMA_PRIORITY_HIGH
+#else
+#define DMA_PRIORITY_SPI2_TX DMA_PRIORITY_LOW
+#endif
+#define DMA_PLAN_TABLE(X)                                   \
+    /*L101模块接收环，应答时序由帧间隔判定*/                \
+    X(USART3_RX, DMA_PRIORITY_VERY_HIGH)                    \
+    X(USART3_TX, DMA_PRIORITY_HIGH)                         \
+    /*ADC循环缓冲，按需取平均*/                             \
+    X(ADC1, DMA_PRIORITY_LOW)                               \
+    /*外部FRAM日志(extlog.h)的写入或SPI2从机的映像发送*/    \
+    X(SPI2_TX, DMA_PRIORITY_SPI2_TX)                        \
+    /*模拟量输出(aout.h)斜坡的逐点CCR写入，由TIM4节拍触发*/ \
+    X(TIM4_UP, DMA_PRIORITY_MEDIUM)                         \
+    X(TIM4_CH2, DMA_PRIORITY_MEDIUM)
+#else
+#define DMA_PLAN_TABLE(X)                                   \
+    /*软件串口逐位波形(io_uart.c)，延迟即位抖动*/       \
+    X(TIM3_UP, DMA_PRIORITY_VERY_HIGH)                      \
+    /*L101模块接收环*/                                      \
+    X(USART1_RX, DMA_PRIORITY_HIGH)                         \
+    X(USART1_TX, DMA_PRIORITY_MEDIUM)                       \
+    /*ADC循环缓冲，按需取平均*/                             \
+    X(ADC1, DMA_PRIORITY_LOW)
+#endif
+
+#define DMA_CHANNELS 7U
+
+    /*请求号(方案表中的序号)及各请求所在的通道*/
+#define DMA_PLAN_ENUM(req, prio) DMA_REQ_##req,
+#define DMA_CHANNEL_ENUM(req, ch) DMA_CHANNEL_##req = (ch),
+    enum
+    {
+        DMA_PLAN_TABLE(DMA_PLAN_ENUM)
+            DMA_REQS
+    };
+    enum
+    {
+        DMA_REQUEST_MAP(DMA_CHANNEL_ENUM)
+    };
+
+    typedef struct
+    {
+        /*各通道的使用者，NULL为空闲*/
+        DMA_HandleTypeDef *Handle[DMA_CHANNELS];
+        uint8_t Request[DMA_CHANNELS];
+        /*传输错误及完成次数*/
+        uint32_t Errors[DMA_CHANNELS];
+        uint32_t Transfers[DMA_CHANNELS];
+    } Dma_HandleTypeDef;
+
+    extern void Dma_Setup(DMA_HandleTypeDef *hdma, uint8_t Request);
+    extern void Dma_Irq(DMA_HandleTypeDef *hdma);
+    extern uint32_t Dma_Errors(void);
+    extern void Dma_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_MGR_H__ */
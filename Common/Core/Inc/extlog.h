@@ -0,0 +1,103 @@
+#ifndef __EXTLOG_H__
+#define __EXTLOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "os_port.h"
+
+/*SPI2外接FRAM(FM25V02/MB85RS256类，32KB，16位地址，无需擦除)，片选由软件控制，MISO上拉：
+  未装芯片时状态寄存器读回0xFF，各接口不写入且返回失败*/
+#define EXTLOG_SIZE 0x8000UL
+#define EXTLOG_CS_GPIO_Port GPIOB
+#define EXTLOG_CS_Pin GPIO_PIN_12
+/*主站的USART1占用DMA1通道4/5(SPI2的收发通道)，按字节查询收发，一条记录约15us，在日志任务中完成；
+  从站日志任务写入的数据段经DMA1通道5(SPI2_TX)发出，读取及调度器启动前的写入按字节查询*/
+#if defined(USING_SLAVE)
+#define EXTLOG_USE_DMA 1U
+#else
+#define EXTLOG_USE_DMA 0U
+#endif
+/*单次传输的超时(ms)*/
+#define EXTLOG_TIMEOUT 10U
+
+/*日志区:X(区域名, 起始地址, 槽长度(字节), 槽数, 合并)，每个区域是一个按序号循环覆盖的环，
+  序号n的记录位于第 n % 槽数 个槽；合并为1时队列中尚未写入的同区域记录被新记录替换(状态快照)*/
+#define EXTLOG_AREA_TABLE(X)                   \
+    /*事件顺序记录，序号与 Soe_Event 一致*/    \
+    X(SOE, 0x0000U, 32U, 768U, 0U)             \
+    /*协议统计的周期快照*/                     \
+    X(STATS, 0x6000U, 64U, 96U, 0U)            \
+    /*保留区(retain.h)的副本，掉电后据此恢复*/ \
+    X(RETAIN, 0x7800U, 32U, 64U, 1U)
+
+/*槽格式:[序号][长度][区域号][数据][CRC16]，CRC覆盖序号至数据；擦除及从未写入的槽CRC不符*/
+#define EXTLOG_HEAD_SIZE 6U
+#define EXTLOG_SLOT_MAX 64U
+#define EXTLOG_DATA_MAX(slot) ((slot) - EXTLOG_HEAD_SIZE - 2U)
+/*写入队列深度，满后新记录丢弃并计数*/
+#define EXTLOG_QUEUE_SIZE 8U
+#define EXTLOG_SIGNAL_POST 0x01U
+#define EXTLOG_SIGNAL_DONE 0x02U
+
+    /*区域号及各区域的槽长度(写入方据此检查记录长度)*/
+#define EXTLOG_AREA_ENUM(name, start, slot, slots, merge) EXTLOG_AREA_##name,
+#define EXTLOG_SLOT_ENUM(name, start, slot, slots, merge) EXTLOG_SLOT_##name = (slot),
+    enum
+    {
+        EXTLOG_AREA_TABLE(EXTLOG_AREA_ENUM)
+            EXTLOG_AREAS
+    };
+    enum
+    {
+        EXTLOG_AREA_TABLE(EXTLOG_SLOT_ENUM)
+    };
+
+    /*一条待写入的记录(已编码的槽映像)*/
+    typedef struct
+    {
+        uint8_t Area;
+        uint8_t Size;
+        uint32_t Sequence;
+        uint8_t Slot[EXTLOG_SLOT_MAX];
+    } Extlog_Request;
+
+    typedef struct
+    {
+        /*已检测到FRAM*/
+        bool Present;
+        /*各区域的序号已恢复(Extlog_Recover)，此前不写入*/
+        bool Ready;
+        /*各区域最新的序号，0表示尚无记录*/
+        uint32_t Sequence[EXTLOG_AREAS];
+        Extlog_Request Queue[EXTLOG_QUEUE_SIZE];
+        uint8_t Head;
+        uint8_t Count;
+        /*队首记录正在写入，不再合并*/
+        bool Busy;
+        /*日志任务，未运行时记录直接在调用者中写入*/
+        Os_Thread Thread;
+        /*SPI2的访问锁:日志任务写入时，读取者(shell、SOE导出)等待*/
+        Os_Mutex Lock;
+        uint32_t Writes;
+        uint32_t Drops;
+        uint32_t Errors;
+    } Extlog_HandleTypeDef;
+
+    extern bool Extlog_Init(void);
+    extern void Extlog_Recover(void);
+    extern bool Extlog_Write(uint8_t Area, uint32_t Sequence, const void *pData, uint8_t Size);
+    extern bool Extlog_Read(uint8_t Area, uint32_t Sequence, void *pData, uint8_t Size);
+    extern uint32_t Extlog_Latest(uint8_t Area);
+    extern uint32_t Extlog_Slots(uint8_t Area);
+    extern void Extlog_Process(uint32_t Timeout);
+    extern void Extlog_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EXTLOG_H__ */
@@ -0,0 +1,82 @@
+#ifndef __HEAP_TRACE_H__
+#define __HEAP_TRACE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#if !defined(USING_RTTHREAD)
+#include "FreeRTOS.h"
+#endif
+
+/*堆跟踪(USING_HEAP_TRACE，在 FreeRTOSConfig.h 中开启):heap_4 的每次分配及释放经 traceMALLOC/traceFREE
+  记录调用者(pvPortMalloc/vPortFree 的直接调用者，任务及内核对象显示为内核函数，按map文件查找)、
+  块大小(含块头)及时刻；ucHeap 由本模块定义，可按块头遍历整个堆得到空闲块分布。
+  静态分配(USING_STATIC_ALLOCATION，主站)时堆只用于shell输出缓冲区等临时分配*/
+/*最近分配/释放的记录环条目数(2的幂)*/
+#define HEAP_TRACE_RING 16U
+/*跟踪中的未释放块数，满后新块只计数；动态分配时包括任务栈及内核对象*/
+#if defined(USING_STATIC_ALLOCATION)
+#define HEAP_TRACE_LIVE 16U
+#else
+#define HEAP_TRACE_LIVE 40U
+#endif
+/*按调用者汇总未释放块时的最多调用者数*/
+#define HEAP_TRACE_SITES 8U
+
+    typedef enum
+    {
+        HEAP_TRACE_MALLOC = 0,
+        HEAP_TRACE_FREE,
+        HEAP_TRACE_FAIL,
+    } Heap_Trace_Op;
+
+    /*一次分配或释放*/
+    typedef struct
+    {
+        uint32_t Tick;
+        void *Caller;
+        void *Block;
+        uint16_t Size;
+        uint8_t Op;
+    } Heap_Trace_Record;
+
+    /*一个未释放的块及其分配者*/
+    typedef struct
+    {
+        void *Block;
+        void *Caller;
+        uint32_t Tick;
+        uint16_t Size;
+    } Heap_Trace_Live;
+
+    typedef struct
+    {
+        /*最近记录环，Head 为下一条记录的序号；Hold 期间(shell打印记录时)不写入*/
+        Heap_Trace_Record Ring[HEAP_TRACE_RING];
+        uint32_t Head;
+        bool Hold;
+        Heap_Trace_Live Live[HEAP_TRACE_LIVE];
+        uint16_t Lives;
+        uint32_t Mallocs;
+        uint32_t Frees;
+        uint32_t Fails;
+        /*跟踪表满时未记录的块*/
+        uint32_t Untracked;
+    } Heap_Trace_HandleTypeDef;
+
+#if defined(USING_HEAP_TRACE)
+    extern void Heap_Trace_Malloc(void *pBlock, size_t Size, void *pCaller);
+    extern void Heap_Trace_Free(void *pBlock, size_t Size, void *pCaller);
+    extern void Heap_Trace_Show(void);
+    extern void Heap_Trace_Map(void);
+    extern void Heap_Trace_Log(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HEAP_TRACE_H__ */
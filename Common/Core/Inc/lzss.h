@@ -0,0 +1,25 @@
+#ifndef __LZSS_H__
+#define __LZSS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*LZSS:每个标志字节管理随后至多8项(低位在前)，位为0时为一个原样字节，
+位为1时为一个匹配 |距离-1低8位|(距离-1高4位)<<4 | 长度-3|，距离1~4096，长度3~18*/
+#define LZSS_MATCH_MIN 3U
+#define LZSS_MATCH_MAX 18U
+#define LZSS_DISTANCE_MAX 4096U
+/*压缩时向前搜索的最大距离:限定每个输入字节的比较次数(耗时与输入长度成正比)，解压不受限制*/
+#define LZSS_SEARCH 256U
+
+    extern uint16_t Lzss_Pack(const uint8_t *pIn, uint16_t Length, uint8_t *pOut, uint16_t Size);
+    extern uint16_t Lzss_Unpack(const uint8_t *pIn, uint16_t Length, uint8_t *pOut, uint16_t Size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LZSS_H__ */
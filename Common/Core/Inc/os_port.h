@@ -0,0 +1,74 @@
+#ifndef __OS_PORT_H__
+#define __OS_PORT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*内核抽象层:应用代码只使用本文件中的接口，由 USING_RTTHREAD 选择 RT-Thread，默认为 FreeRTOS(CMSIS-RTOS)；
+  时间单位均为ms，信号为任务私有的32位事件标志，可在中断中置位*/
+#if defined(USING_RTTHREAD)
+#include "rtthread.h"
+
+    typedef rt_thread_t Os_Thread;
+    typedef rt_mutex_t Os_Mutex;
+    typedef rt_timer_t Os_Timer;
+
+#define OS_WAIT_FOREVER RT_WAITING_FOREVER
+#define Os_Running() (rt_thread_self() != RT_NULL)
+#define Os_Self() rt_thread_self()
+#define Os_Tick() ((uint32_t)(rt_tick_get() * 1000U / RT_TICK_PER_SECOND))
+#define Os_Delay(ms) rt_thread_mdelay(ms)
+#define Os_Critical_Enter() Os_Rt_Critical_Enter()
+#define Os_Critical_Exit() Os_Rt_Critical_Exit()
+#define Os_Suspend(thread) rt_thread_suspend(thread)
+#define Os_Resume(thread) rt_thread_resume(thread)
+#define Os_Mutex_Lock(mutex) rt_mutex_take((mutex), RT_WAITING_FOREVER)
+#define Os_Mutex_Unlock(mutex) rt_mutex_release(mutex)
+#define Os_Timer_Start(timer, ms)                                     \
+    do                                                                \
+    {                                                                 \
+        rt_tick_t __period = rt_tick_from_millisecond(ms);            \
+        rt_timer_control((timer), RT_TIMER_CTRL_SET_TIME, &__period); \
+        rt_timer_start(timer);                                        \
+    } while (0)
+#define Os_Timer_Stop(timer) rt_timer_stop(timer)
+#else
+#include "cmsis_os.h"
+
+    typedef osThreadId Os_Thread;
+    typedef osMutexId Os_Mutex;
+    typedef osTimerId Os_Timer;
+
+#define OS_WAIT_FOREVER osWaitForever
+#define Os_Running() osKernelRunning()
+#define Os_Self() osThreadGetId()
+#define Os_Tick() ((uint32_t)osKernelSysTick())
+#define Os_Delay(ms) osDelay(ms)
+#define Os_Critical_Enter() taskENTER_CRITICAL()
+#define Os_Critical_Exit() taskEXIT_CRITICAL()
+#define Os_Suspend(thread) osThreadSuspend(thread)
+#define Os_Resume(thread) osThreadResume(thread)
+/*shell 在持锁时会再次打印，使用递归互斥量*/
+#define Os_Mutex_Lock(mutex) osRecursiveMutexWait((mutex), osWaitForever)
+#define Os_Mutex_Unlock(mutex) osRecursiveMutexRelease(mutex)
+#define Os_Timer_Start(timer, ms) osTimerStart((timer), (ms))
+#define Os_Timer_Stop(timer) osTimerStop(timer)
+#endif
+
+#if defined(USING_RTTHREAD)
+    extern void Os_Rt_Critical_Enter(void);
+    extern void Os_Rt_Critical_Exit(void);
+#endif
+    extern bool Os_Signal_Attach(Os_Thread Thread);
+    extern void Os_Signal_Set(Os_Thread Thread, uint32_t Signals);
+    extern uint32_t Os_Signal_Wait(uint32_t Signals, uint32_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OS_PORT_H__ */
@@ -0,0 +1,45 @@
+#ifndef __RETAIN_H__
+#define __RETAIN_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "supervisor.h"
+
+/*保留区紧邻故障记录之下，工程的IRAM1须一并扣除这部分，启动代码不会清零*/
+#define RETAIN_SIZE 0x20U
+#define RETAIN_ADDR (SUPERVISOR_RAM_END - SUPERVISOR_CRASH_SIZE - RETAIN_SIZE)
+#define RETAIN_MAGIC 0x52544E31U
+
+    /*跨复位保留的运行状态:看门狗等热复位后据此恢复，上电时内容随机由CRC识别；
+      装有FRAM时每次修改另写入外部日志(extlog.h)，上电后从其中恢复*/
+    typedef struct
+    {
+        uint32_t Magic;
+        /*继电器输出(从站)*/
+        uint32_t Outputs;
+        /*节点就绪及阻塞集合(主站)*/
+        uint32_t Ready;
+        uint32_t Block;
+        /*首轮扫描已完成(主站)*/
+        uint8_t Scanned;
+        /*模块当前的速率等级，0表示未记录(主站)*/
+        uint8_t Spd;
+        uint16_t Crc16;
+    } Retain_Data;
+
+    extern bool Retain_Init(void);
+    extern bool Retain_Resume(void);
+    extern bool Retain_Load(Retain_Data *pData);
+    extern void Retain_Set_Outputs(uint32_t Outputs);
+    extern void Retain_Set_Nodes(uint32_t Ready, uint32_t Block, bool Scanned);
+    extern void Retain_Set_Link(uint8_t Spd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RETAIN_H__ */
@@ -0,0 +1,126 @@
+#ifndef __SUPERVISOR_H__
+#define __SUPERVISOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "os_port.h"
+#include "stdbool.h"
+
+/*可登记的任务数上限(任务表中的全部任务)*/
+#if defined(USING_SLAVE)
+#define SUPERVISOR_MAX_TASKS 8U
+#else
+#define SUPERVISOR_MAX_TASKS 12U
+#endif
+/*监督周期(ms):每周期检查一次全部心跳，全部按时才喂外部看门狗*/
+#define SUPERVISOR_PERIOD 100U
+/*任务心跳期限(ms)，与外部看门狗超时(约1.6s)之和即最长的停滞复位时间*/
+#define SUPERVISOR_DEADLINE 1000U
+/*无事可做的任务最长阻塞时间(ms)，须小于心跳期限*/
+#define SUPERVISOR_CHECKIN_TIME 500U
+/*登记失败的任务号*/
+#define SUPERVISOR_NONE 0xFFU
+/*复位后保留的故障记录位于RAM末尾 SUPERVISOR_CRASH_SIZE 字节，工程的IRAM1须扣除这部分，启动代码不会清零*/
+#define SUPERVISOR_RAM_END 0x20005000U
+#define SUPERVISOR_CRASH_SIZE 0x40U
+#define SUPERVISOR_CRASH_MAGIC 0x43525348U
+/*调用者的返回地址，Error_Handler() 据此记录出错的位置*/
+#if defined(__CC_ARM)
+#define SUPERVISOR_CALLER() ((uint32_t)__return_address())
+#else
+#define SUPERVISOR_CALLER() ((uint32_t)__builtin_return_address(0))
+#endif
+/*故障原因:栈溢出、Error_Handler()；异常为 SUPERVISOR_FAULT_EXCEPTION + 异常号(3:HardFault 4:MemManage 5:BusFault 6:UsageFault)*/
+#define SUPERVISOR_FAULT_STACK 0x01U
+#define SUPERVISOR_FAULT_ERROR 0x02U
+#define SUPERVISOR_FAULT_EXCEPTION 0x10U
+
+    /*任务表的一项:任务定义、启动参数及时间约束(ms)，不需要的约束填0*/
+    typedef struct
+    {
+        osThreadDef_t Def;
+        void *Argument;
+        Os_Thread *Handle;
+        /*激活周期:周期任务须在下次激活前完成*/
+        uint32_t Period;
+        /*响应期限:从激活到完成，为0时按激活周期检查*/
+        uint32_t Deadline;
+        /*心跳期限:为0时不参与看门狗监督*/
+        uint32_t Timeout;
+    } Supervisor_Entry;
+
+    /*一个被监督任务的心跳及响应时间统计*/
+    typedef struct
+    {
+        const char *Name;
+        Os_Thread Thread;
+        uint32_t Timeout;
+        uint32_t Period;
+        uint32_t Deadline;
+        /*最近一次心跳的系统节拍*/
+        volatile uint32_t Tick;
+        /*最近一次激活的系统节拍*/
+        uint32_t Start;
+        uint32_t Activations;
+        /*最长响应时间(ms)及超出期限的次数*/
+        uint16_t Worst;
+        uint16_t Misses;
+    } Supervisor_Task;
+
+    /*故障记录:在故障现场只写RAM，复位后由 crash 命令打印*/
+    typedef struct
+    {
+        uint32_t Magic;
+        /*自上电以来的故障复位次数*/
+        uint32_t Count;
+        /*故障时的系统节拍*/
+        uint32_t Tick;
+        uint32_t Reason;
+        char Task[configMAX_TASK_NAME_LEN];
+        /*异常时为硬件压栈的PC、LR及xPSR；其余原因PC为0，LR为调用者的返回地址*/
+        uint32_t Pc;
+        uint32_t Lr;
+        uint32_t Psr;
+        /*故障现场的栈顶(异常时为压栈前的值)*/
+        uint32_t Sp;
+        /*SCB的故障状态寄存器及 MMFAR/BFAR(对应的有效位置位时有意义)*/
+        uint32_t Cfsr;
+        uint32_t Hfsr;
+        uint32_t Addr;
+    } Supervisor_Crash;
+
+    typedef struct
+    {
+        Supervisor_Task Task[SUPERVISOR_MAX_TASKS];
+        uint8_t Count;
+        /*首个超时的任务号，SUPERVISOR_NONE表示全部正常；一经超时即停止喂狗等待复位*/
+        uint8_t Stalled;
+        /*暂停心跳检查的嵌套计数*/
+        uint8_t Hold;
+        uint32_t Feeds;
+    } Supervisor_HandleTypeDef;
+
+    extern void Supervisor_Init(void);
+    extern uint8_t Supervisor_Register(const char *Name, uint32_t Timeout);
+    extern void Supervisor_Create(const Supervisor_Entry *Table, uint8_t Count);
+    extern uint8_t Supervisor_Self(void);
+    extern void Supervisor_Checkin(uint8_t Id);
+    extern void Supervisor_Activate(uint8_t Id);
+    extern void Supervisor_Complete(uint8_t Id);
+    extern void Supervisor_Refresh(void);
+    extern void Supervisor_Hold(void);
+    extern void Supervisor_Release(void);
+    extern void Supervisor_Feed(bool Healthy);
+    extern void Supervisor_Fault(const char *Name, uint32_t Reason);
+    extern void Supervisor_Error(uint32_t Caller);
+    extern void Supervisor_Exception(const uint32_t *Frame, uint32_t Return);
+    extern void Supervisor_Safe(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SUPERVISOR_H__ */
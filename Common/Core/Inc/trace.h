@@ -0,0 +1,163 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "retain.h"
+
+/*最近事件环的条目数(2的幂)*/
+#define TRACE_RING_SIZE 32U
+/*直方图的格数:第0格为<1us，第n格为[2^(n-1), 2^n)us，最后一格含更长的延迟*/
+#define TRACE_BINS 16U
+/*延迟段数上限*/
+#define TRACE_SPAN_MAX 8U
+/*触发条件数上限*/
+#define TRACE_TRIGGERS 4U
+/*触发时冻结触发前 TRACE_PRE 条及触发后 TRACE_POST 条记录(合计不超过事件环)*/
+#define TRACE_PRE 8U
+#define TRACE_POST 8U
+#define TRACE_HOLD_RECORDS (TRACE_PRE + TRACE_POST)
+/*冻结区紧邻保留区之下，工程的IRAM1须一并扣除这部分，启动代码不会清零，热复位后仍可查看*/
+#define TRACE_HOLD_SIZE 0x70U
+#define TRACE_HOLD_ADDR (RETAIN_ADDR - TRACE_HOLD_SIZE)
+#define TRACE_HOLD_MAGIC 0x54524731U
+
+    /*测量点(中断及任务中均可记录)*/
+    typedef enum
+    {
+        TRACE_DI_EDGE = 0,
+        TRACE_DI_FRAME,
+        TRACE_UART_IDLE,
+        TRACE_MODBUS_WAKE,
+        TRACE_MODBUS_BEGIN,
+        TRACE_MODBUS_END,
+        TRACE_POLL_BEGIN,
+        TRACE_POLL_END,
+        TRACE_DI_BEGIN,
+        TRACE_DI_END,
+        TRACE_DO_BEGIN,
+        TRACE_DO_END,
+        TRACE_RELAY,
+        /*从站往返时间(主站，附带从站号及毫秒数)*/
+        TRACE_RTT,
+        /*触发条件成立的位置*/
+        TRACE_TRIGGER,
+        TRACE_EVENTS,
+    } Trace_Event;
+
+    /*触发条件的类型:成立时冻结前后的事件，直到 trace_arm 重新启用*/
+    typedef enum
+    {
+        TRACE_TRIG_NONE = 0,
+        /*延迟段超过阈值(us)，参数为段号(trace 命令的顺序)*/
+        TRACE_TRIG_SPAN,
+        /*往返时间超过阈值(ms)，参数为从站号，0:任意从站*/
+        TRACE_TRIG_RTT,
+        /*帧CRC错误*/
+        TRACE_TRIG_CRC,
+        /*请求队列满，请求被丢弃*/
+        TRACE_TRIG_QUEUE,
+        /*空闲堆低于阈值(字节)*/
+        TRACE_TRIG_HEAP,
+        TRACE_TRIGS,
+    } Trace_Trig_Type;
+
+    /*一条事件记录*/
+    typedef struct
+    {
+        uint32_t Cycles;
+        uint8_t Id;
+    } Trace_Record;
+
+    /*一段延迟:从起点事件最近一次出现到终点事件*/
+    typedef struct
+    {
+        const char *Name;
+        uint8_t Start;
+        uint8_t End;
+    } Trace_Span;
+
+    /*一个触发条件*/
+    typedef struct
+    {
+        uint8_t Type;
+        uint8_t Arg;
+        uint32_t Threshold;
+    } Trace_Trigger;
+
+    /*冻结的事件:在触发现场只写RAM，复位后仍由 trace_hold 命令打印*/
+    typedef struct
+    {
+        uint32_t Magic;
+        /*触发时的系统节拍及触发值(延迟us、往返ms、计数或空闲堆字节数)*/
+        uint32_t Tick;
+        uint32_t Value;
+        /*触发条件号及其类型、参数*/
+        uint8_t Index;
+        uint8_t Type;
+        uint8_t Arg;
+        /*记录数及其中触发前的条数(含触发位置)*/
+        uint8_t Count;
+        uint8_t Pre;
+        uint32_t Cycles[TRACE_HOLD_RECORDS];
+        uint8_t Id[TRACE_HOLD_RECORDS];
+    } Trace_Hold;
+
+    typedef struct
+    {
+        Trace_Trigger Trig[TRACE_TRIGGERS];
+        /*监视的计数器(按触发类型索引)及上次的值，计数增加时触发*/
+        const volatile uint32_t *Watch[TRACE_TRIGS];
+        uint32_t Seen[TRACE_TRIGS];
+        /*可以触发；已触发、等待触发后的记录，Fired 为触发位置之后的事件序号*/
+        bool Armed;
+        bool Pending;
+        uint32_t Fired;
+        /*触发条件号及触发值，冻结时写入冻结区*/
+        uint8_t Index;
+        uint32_t Value;
+        uint32_t Tick;
+    } Trace_TriggerTypeDef;
+
+    typedef struct
+    {
+        /*起点时刻，Open 第n位表示第n段已有起点*/
+        uint32_t Stamp[TRACE_SPAN_MAX];
+        uint32_t Open;
+        /*每段的样本数、最大值(周期)及直方图*/
+        uint32_t Count[TRACE_SPAN_MAX];
+        uint32_t Max[TRACE_SPAN_MAX];
+        uint16_t Bins[TRACE_SPAN_MAX][TRACE_BINS];
+        /*最近事件环，Head 为下一条记录的序号*/
+        Trace_Record Ring[TRACE_RING_SIZE];
+        uint32_t Head;
+    } Trace_HandleTypeDef;
+
+#if defined(USING_TRACE)
+#define TRACE(id) Trace_Point(id)
+#define TRACE_VALUE(id, arg, value) Trace_Value(id, arg, value)
+#else
+#define TRACE(id)
+#define TRACE_VALUE(id, arg, value)
+#endif
+
+    extern void Trace_Init(void);
+    extern void Trace_Point(Trace_Event Id);
+    extern void Trace_Value(Trace_Event Id, uint8_t Arg, uint32_t Value);
+    extern void Trace_Watch(Trace_Trig_Type Type, const volatile uint32_t *pCounter);
+    extern uint8_t Trace_Trigger_Set(int index, int type, int arg, int threshold);
+    extern void Trace_Arm(void);
+    extern void Trace_Hold_Show(void);
+    extern void Trace_Show(void);
+    extern void Trace_Log(void);
+    extern void Trace_Clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRACE_H__ */
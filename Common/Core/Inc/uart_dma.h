@@ -0,0 +1,94 @@
+#ifndef __UART_DMA_H__
+#define __UART_DMA_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*主站USART1与从站USART3共用本驱动，各板在 usart.c 中以 Uart_Dma_Init 绑定串口、接收环及中断入口；
+  共用本驱动的串口数，板子可在 main.h 中修改*/
+#ifndef UART_DMA_MAX_PORTS
+#define UART_DMA_MAX_PORTS 2U
+#endif
+/*接收段队列深度(2的幂)，任务处理前最多可积压的接收段数*/
+#define UART_DMA_RX_SPANS 16U
+/*发送段队列深度(2的幂)*/
+#define UART_DMA_TX_SEGMENTS 8U
+/*接收事件:DMA半满、DMA全满(环回绕)、线路空闲*/
+#define UART_DMA_EVENT_HALF 0x01
+#define UART_DMA_EVENT_FULL 0x02
+#define UART_DMA_EVENT_IDLE 0x04
+
+    typedef struct UartDma_Handle UartDma_HandleTypeDef;
+
+    /*一个发送段:直接引用调用者数据，发送完成前调用者不得改动*/
+    typedef struct
+    {
+        const uint8_t *pData;
+        uint16_t Length;
+        /*一组(帧)的最后一段:发送完成或被丢弃时回调 Done，同一组的段之间不会插入其他发送者的数据*/
+        bool Last;
+        void (*Done)(void *Arg, bool Sent);
+        void *Arg;
+    } UartDma_Segment;
+
+    /*接收回调:pData 指向接收环内新收到的连续数据，空闲事件可能不带数据；
+    注册了 Notify 时在任务中由 Uart_Dma_Rx_Dispatch 调用，否则直接在中断中调用*/
+    typedef void (*UartDma_RxEvent)(UartDma_HandleTypeDef *huart, const uint8_t *pData, uint16_t Length, uint8_t Event);
+    /*接收通知(中断中调用):有新的接收段待任务处理*/
+    typedef void (*UartDma_RxNotify)(UartDma_HandleTypeDef *huart, uint8_t Event);
+
+    /*一个接收段:接收环内的起始位置及长度*/
+    typedef struct
+    {
+        uint16_t Start;
+        uint16_t Length;
+        uint8_t Event;
+    } UartDma_Span;
+
+    struct UartDma_Handle
+    {
+        UART_HandleTypeDef *huart;
+        struct
+        {
+            /*循环DMA接收环及已交给上层的位置*/
+            uint8_t *pBuf;
+            uint16_t Size;
+            uint16_t Read;
+            UartDma_RxEvent Event;
+            UartDma_RxNotify Notify;
+            void *Arg;
+            /*中断发布、任务取走的接收段(自由计数)，及尚未被任务取走的字节数*/
+            UartDma_Span Spans[UART_DMA_RX_SPANS];
+            volatile uint32_t Span_Head, Span_Tail;
+            volatile uint32_t Pending;
+            uint32_t Overrun;
+        } Rx;
+        struct
+        {
+            UartDma_Segment Queue[UART_DMA_TX_SEGMENTS];
+            /*自由计数的入队/完成序号*/
+            volatile uint32_t Head, Tail;
+            volatile bool Busy;
+            uint32_t Dropped;
+        } Tx;
+    };
+
+    extern bool Uart_Dma_Init(UartDma_HandleTypeDef *huart, UART_HandleTypeDef *port, uint8_t *pBuf, uint16_t Size);
+    extern void Uart_Dma_Attach(UartDma_HandleTypeDef *huart, UartDma_RxEvent Event, UartDma_RxNotify Notify, void *Arg);
+    extern bool Uart_Dma_Rx_Start(UartDma_HandleTypeDef *huart);
+    extern void Uart_Dma_Rx_Stop(UartDma_HandleTypeDef *huart);
+    extern void Uart_Dma_Rx_Poll(UartDma_HandleTypeDef *huart);
+    extern uint32_t Uart_Dma_Rx_Dispatch(UartDma_HandleTypeDef *huart);
+    extern bool Uart_Dma_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count);
+    extern void Uart_Dma_Tx_Abort(UartDma_HandleTypeDef *huart);
+    extern void Uart_Dma_IRQHandler(UartDma_HandleTypeDef *huart);
+    extern bool Uart_Dma_Hal_Pending(UartDma_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_DMA_H__ */
@@ -0,0 +1,74 @@
+#ifndef __UTIMER_H__
+#define __UTIMER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*微秒定时器(USING_UTIMER，main.h):定时器按1us自由计数(计数不清零)，溢出中断把计数扩展为32位，比较通道只对准
+  最近的到期时刻，每个到期时刻一次比较中断；定时器按到期时刻排序挂在一条链上，到期后在定时器中断中回调。
+  回调须短小，只调用RTOS的中断接口；周期定时器按上次到期时刻累加，不随回调延迟漂移。
+  主站用TIM4的CH4(与模拟串口的边沿接收共用)；从站用TIM2的CH3(RTU帧间隔的t1.5、t3.5也是其上的定时器)*/
+#if defined(USING_SLAVE)
+#define UTIMER_TIM TIM2
+#define UTIMER_CCR CCR3
+#define UTIMER_SR_CC TIM_SR_CC3IF
+#define UTIMER_IT_CC TIM_DIER_CC3IE
+#define UTIMER_EGR_CC TIM_EGR_CC3G
+#else
+#define UTIMER_TIM TIM4
+#define UTIMER_CCR CCR4
+#define UTIMER_SR_CC TIM_SR_CC4IF
+#define UTIMER_IT_CC TIM_DIER_CC4IE
+#define UTIMER_EGR_CC TIM_EGR_CC4G
+#endif
+/*最长定时(us)，到期时刻按有符号差比较*/
+#define UTIMER_MAX 0x7FFFFFFFUL
+/*静态定义时的初值*/
+#define UTIMER_INIT(func, arg) {NULL, (func), (arg), 0, 0, false}
+
+    typedef void (*Utimer_Func)(void *Arg);
+
+    typedef struct Utimer
+    {
+        struct Utimer *Next;
+        Utimer_Func Func;
+        void *Arg;
+        /*到期时刻(us)*/
+        uint32_t Due;
+        /*周期(us)，0为单次*/
+        uint32_t Period;
+        bool Active;
+    } Utimer;
+
+    typedef struct
+    {
+        /*按到期时刻排序的定时器链*/
+        Utimer *Head;
+        /*计数的高16位(已左移)，由溢出中断递增*/
+        volatile uint32_t High;
+        /*到期回调次数、比较中断设置次数*/
+        uint32_t Fired;
+        uint32_t Armed;
+        /*回调相对到期时刻的最大延迟(us)*/
+        uint32_t Late_Max;
+        /*周期定时器错过整周期的次数*/
+        uint32_t Overruns;
+    } Utimer_HandleTypeDef;
+
+    extern void Utimer_Init(void);
+    extern uint32_t Utimer_Now(void);
+    extern void Utimer_Start(Utimer *pT, uint32_t Us, uint32_t Period);
+    extern void Utimer_Start_At(Utimer *pT, uint32_t Due, uint32_t Period);
+    extern void Utimer_Stop(Utimer *pT);
+    extern void Utimer_IRQHandler(void);
+    extern void Utimer_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UTIMER_H__ */
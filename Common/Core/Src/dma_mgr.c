@@ -0,0 +1,126 @@
+#include "dma_mgr.h"
+#include "shell_port.h"
+
+/*方案表中的请求不共用通道:各通道位之和等于其按位或*/
+#define DMA_PLAN_SUM(req, prio) +(1UL << DMA_CHANNEL_##req)
+#define DMA_PLAN_OR(req, prio) | (1UL << DMA_CHANNEL_##req)
+typedef char Dma_Plan_Check[((0UL DMA_PLAN_TABLE(DMA_PLAN_SUM)) == (0UL DMA_PLAN_TABLE(DMA_PLAN_OR))) ? 1 : -1];
+
+/*DMA方案描述*/
+typedef struct
+{
+    const char *Name;
+    uint8_t Channel;
+    uint32_t Priority;
+} Dma_Plan;
+
+#define DMA_PLAN_ENTRY(req, prio) {#req, DMA_CHANNEL_##req, (prio)},
+static const Dma_Plan Dma_Plans[DMA_REQS] = {DMA_PLAN_TABLE(DMA_PLAN_ENTRY)};
+
+static DMA_Channel_TypeDef *const Dma_Channels[DMA_CHANNELS] = {
+    DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4, DMA1_Channel5, DMA1_Channel6, DMA1_Channel7};
+
+static Dma_HandleTypeDef Dma;
+
+/**
+ * @brief	按方案分配通道并设置优先级
+ * @details	在MSP初始化中调用，按方案填写通道及优先级后(重新)执行 HAL_DMA_Init()，CubeMX生成的设置以此为准，其余配置由调用者填写；
+ *			请求不在方案表中或通道已被其他句柄占用时进入 Error_Handler()
+ * @param	hdma DMA句柄
+ * @param	Request 请求号(DMA_REQ_xxx)
+ * @retval	None
+ */
+void Dma_Setup(DMA_HandleTypeDef *hdma, uint8_t Request)
+{
+    uint8_t ch;
+
+    if (Request >= DMA_REQS)
+    {
+        Error_Handler();
+        return;
+    }
+    ch = Dma_Plans[Request].Channel - 1U;
+    if ((Dma.Handle[ch] != NULL) && (Dma.Handle[ch] != hdma))
+    {
+        Error_Handler();
+        return;
+    }
+    hdma->Instance = Dma_Channels[ch];
+    hdma->Init.Priority = Dma_Plans[Request].Priority;
+    if (HAL_DMA_Init(hdma) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    Dma.Handle[ch] = hdma;
+    Dma.Request[ch] = Request;
+}
+
+/**
+ * @brief	统计DMA中断
+ * @details	在DMA中断中 HAL_DMA_IRQHandler() 之前调用(其随后清除标志)，记录传输错误及完成次数
+ * @param	hdma DMA句柄
+ * @retval	None
+ */
+void Dma_Irq(DMA_HandleTypeDef *hdma)
+{
+    uint32_t isr = hdma->DmaBaseAddress->ISR;
+    uint8_t ch = (uint8_t)(hdma->ChannelIndex / 4U);
+
+    if (ch >= DMA_CHANNELS)
+    {
+        return;
+    }
+    if (isr & (DMA_FLAG_TE1 << hdma->ChannelIndex))
+    {
+        Dma.Errors[ch]++;
+    }
+    if ((isr & (DMA_FLAG_TC1 << hdma->ChannelIndex)) && (hdma->Instance->CCR & DMA_CCR_TCIE))
+    {
+        Dma.Transfers[ch]++;
+    }
+}
+
+/**
+ * @brief	全部通道的传输错误数
+ * @param	None
+ * @retval	错误数
+ */
+uint32_t Dma_Errors(void)
+{
+    uint32_t errors = 0;
+
+    for (uint8_t ch = 0; ch < DMA_CHANNELS; ch++)
+    {
+        errors += Dma.Errors[ch];
+    }
+    return errors;
+}
+
+/**
+ * @brief	打印DMA通道分配
+ * @details	列出各通道的使用者、优先级(0:低~3:最高)、剩余传输数及统计；方案中尚未初始化的请求标记 idle
+ * @param	None
+ * @retval	None
+ */
+void Dma_Show(void)
+{
+    for (uint8_t ch = 0; ch < DMA_CHANNELS; ch++)
+    {
+        const Dma_Plan *pP = Dma.Handle[ch] ? &Dma_Plans[Dma.Request[ch]] : NULL;
+
+        if (pP)
+        {
+            shellPrint(&shell, "ch%d %-10s prio = %d%s, remain = %u, transfers = %u, errors = %u\r\n", ch + 1U,
+                       pP->Name, pP->Priority >> DMA_CCR_PL_Pos, (Dma_Channels[ch]->CCR & DMA_CCR_EN) ? ", on" : "",
+                       Dma_Channels[ch]->CNDTR, Dma.Transfers[ch], Dma.Errors[ch]);
+        }
+    }
+    for (uint8_t i = 0; i < DMA_REQS; i++)
+    {
+        if (Dma.Handle[Dma_Plans[i].Channel - 1U] == NULL)
+        {
+            shellPrint(&shell, "ch%d %-10s idle\r\n", Dma_Plans[i].Channel, Dma_Plans[i].Name);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), dma, Dma_Show, show dma channels);
@@ -0,0 +1,481 @@
+#include "extlog.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#endif
+#include "spi.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+/*FRAM指令*/
+#define EXTLOG_CMD_WREN 0x06U
+#define EXTLOG_CMD_RDSR 0x05U
+#define EXTLOG_CMD_READ 0x03U
+#define EXTLOG_CMD_WRITE 0x02U
+/*状态寄存器中恒为0的位(bit0、bit4~6)，未装芯片时MISO上拉读回1*/
+#define EXTLOG_SR_ZERO 0x71U
+
+/*区域描述*/
+typedef struct
+{
+    const char *Name;
+    uint16_t Start;
+    uint8_t Slot;
+    uint16_t Slots;
+    bool Merge;
+} Extlog_Area;
+
+/*各区域不超出芯片容量，槽能放下记录头、至少一字节数据及CRC且不超过队列中的槽映像*/
+#define EXTLOG_AREA_CHECK(name, start, slot, slots, merge)                                               \
+    typedef char Extlog_##name##_Check[(((start) + (uint32_t)(slot) * (slots) <= EXTLOG_SIZE) &&         \
+                                        ((slot) > EXTLOG_HEAD_SIZE + 2U) && ((slot) <= EXTLOG_SLOT_MAX)) \
+                                           ? 1                                                           \
+                                           : -1];
+EXTLOG_AREA_TABLE(EXTLOG_AREA_CHECK)
+
+#define EXTLOG_AREA_ENTRY(name, start, slot, slots, merge) {#name, (start), (slot), (slots), (merge)},
+static const Extlog_Area Extlog_Areas[EXTLOG_AREAS] = {EXTLOG_AREA_TABLE(EXTLOG_AREA_ENTRY)};
+
+static Extlog_HandleTypeDef Extlog;
+
+/**
+ * @brief	选中或释放FRAM
+ * @param	Enable true:片选有效(低电平)
+ * @retval	None
+ */
+static void Extlog_Select(bool Enable)
+{
+    HAL_GPIO_WritePin(EXTLOG_CS_GPIO_Port, EXTLOG_CS_Pin, Enable ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+/**
+ * @brief	取得或释放SPI2
+ * @details	调度器启动前只有一个调用者，不加锁
+ * @param	Lock true:取得
+ * @retval	None
+ */
+static void Extlog_Lock(bool Lock)
+{
+    if ((Extlog.Lock == NULL) || !Os_Running())
+    {
+        return;
+    }
+#if defined(USING_RTTHREAD)
+    Lock ? rt_mutex_take(Extlog.Lock, RT_WAITING_FOREVER) : rt_mutex_release(Extlog.Lock);
+#else
+    Lock ? osMutexWait(Extlog.Lock, osWaitForever) : osMutexRelease(Extlog.Lock);
+#endif
+}
+
+#if (EXTLOG_USE_DMA)
+/**
+ * @brief	等待DMA发送完成
+ * @details	日志任务的其他信号(新记录)也会唤醒等待，只有收到完成信号才返回；新记录由队列本身记录，不会丢失
+ * @param	None
+ * @retval	false 超时
+ */
+static bool Extlog_Wait(void)
+{
+    uint32_t start = HAL_GetTick();
+
+    do
+    {
+        if (Os_Signal_Wait(EXTLOG_SIGNAL_DONE, EXTLOG_TIMEOUT) & EXTLOG_SIGNAL_DONE)
+        {
+            return true;
+        }
+    } while (HAL_GetTick() - start < EXTLOG_TIMEOUT);
+
+    return false;
+}
+
+/**
+ * @brief	SPI2的DMA发送完成
+ * @details	HAL在等到最后一个字节移出(BSY清零)后调用，片选由日志任务释放
+ * @param	hspi SPI句柄
+ * @retval	None
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi == &hspi2)
+    {
+        Os_Signal_Set(Extlog.Thread, EXTLOG_SIGNAL_DONE);
+    }
+}
+#endif
+
+/**
+ * @brief	执行一条FRAM指令
+ * @details	指令后跟16位地址(Address 不为负时)，随后写出或读入 Size 字节；片选在传输前后切换。
+ *			EXTLOG_USE_DMA 时日志任务写出的数据段经DMA发出，等待传输完成期间让出CPU
+ * @param	Cmd 指令
+ * @param	Address 地址，-1:无地址
+ * @param	pData 数据
+ * @param	Size 字节数
+ * @param	Write true:写出数据
+ * @retval	true 传输完成
+ */
+static bool Extlog_Transfer(uint8_t Cmd, int32_t Address, uint8_t *pData, uint16_t Size, bool Write)
+{
+    uint8_t head[3] = {Cmd, (uint8_t)((uint32_t)Address >> 8U), (uint8_t)Address};
+    bool ok;
+
+    Extlog_Select(true);
+    ok = (HAL_SPI_Transmit(&hspi2, head, (Address < 0) ? 1U : sizeof(head), EXTLOG_TIMEOUT) == HAL_OK);
+#if (EXTLOG_USE_DMA)
+    if (ok && Size && Write && (Extlog.Thread != NULL) && (Extlog.Thread == Os_Self()))
+    {
+        Os_Signal_Wait(EXTLOG_SIGNAL_DONE, 0);
+        ok = (HAL_SPI_Transmit_DMA(&hspi2, pData, Size) == HAL_OK) && Extlog_Wait();
+        if (!ok)
+        {
+            HAL_SPI_Abort(&hspi2);
+        }
+        Size = 0;
+    }
+#endif
+    if (ok && Size)
+    {
+        ok = ((Write ? HAL_SPI_Transmit(&hspi2, pData, Size, EXTLOG_TIMEOUT)
+                     : HAL_SPI_Receive(&hspi2, pData, Size, EXTLOG_TIMEOUT)) == HAL_OK);
+    }
+    Extlog_Select(false);
+
+    return ok;
+}
+
+/**
+ * @brief	写入FRAM
+ * @details	每次写入前置位写使能锁存，写入以字节为单位立即完成，无需擦除及等待
+ * @param	Address 地址
+ * @param	pData 数据
+ * @param	Size 字节数
+ * @retval	true 写入完成
+ */
+static bool Extlog_Program(uint16_t Address, uint8_t *pData, uint16_t Size)
+{
+    bool ok;
+
+    Extlog_Lock(true);
+    ok = Extlog_Transfer(EXTLOG_CMD_WREN, -1, NULL, 0, true) &&
+         Extlog_Transfer(EXTLOG_CMD_WRITE, Address, pData, Size, true);
+    Extlog_Lock(false);
+
+    return ok;
+}
+
+/**
+ * @brief	槽的地址
+ * @param	Area 区域号
+ * @param	Sequence 序号
+ * @retval	地址
+ */
+static uint16_t Extlog_Address(uint8_t Area, uint32_t Sequence)
+{
+    const Extlog_Area *pA = &Extlog_Areas[Area];
+
+    return (uint16_t)(pA->Start + (Sequence % pA->Slots) * pA->Slot);
+}
+
+/**
+ * @brief	编码一条记录
+ * @param	pSlot 槽映像
+ * @param	Area 区域号
+ * @param	Sequence 序号
+ * @param	pData 数据
+ * @param	Size 字节数
+ * @retval	槽映像的有效字节数
+ */
+static uint8_t Extlog_Encode(uint8_t *pSlot, uint8_t Area, uint32_t Sequence, const void *pData, uint8_t Size)
+{
+    uint16_t crc;
+
+    memcpy(pSlot, &Sequence, sizeof(Sequence));
+    pSlot[4] = Size;
+    pSlot[5] = Area;
+    memcpy(&pSlot[EXTLOG_HEAD_SIZE], pData, Size);
+    crc = mdCrc16(pSlot, EXTLOG_HEAD_SIZE + Size);
+    pSlot[EXTLOG_HEAD_SIZE + Size] = (uint8_t)crc;
+    pSlot[EXTLOG_HEAD_SIZE + Size + 1U] = (uint8_t)(crc >> 8U);
+
+    return (uint8_t)(EXTLOG_HEAD_SIZE + Size + 2U);
+}
+
+/**
+ * @brief	读出并校验一个槽
+ * @details	区域号、长度、CRC正确且序号落在本槽时有效
+ * @param	Area 区域号
+ * @param	Index 槽号
+ * @param	pSlot 槽映像(EXTLOG_SLOT_MAX 字节)
+ * @param	pSequence 记录的序号
+ * @retval	true 有效
+ */
+static bool Extlog_Load(uint8_t Area, uint16_t Index, uint8_t *pSlot, uint32_t *pSequence)
+{
+    const Extlog_Area *pA = &Extlog_Areas[Area];
+    uint8_t size;
+    bool ok;
+
+    Extlog_Lock(true);
+    ok = Extlog_Transfer(EXTLOG_CMD_READ, pA->Start + (uint32_t)Index * pA->Slot, pSlot, pA->Slot, false);
+    Extlog_Lock(false);
+    if (!ok)
+    {
+        return false;
+    }
+    memcpy(pSequence, pSlot, sizeof(*pSequence));
+    size = pSlot[4];
+
+    return (*pSequence != 0U) && (*pSequence % pA->Slots == Index) && (pSlot[5] == Area) &&
+           (size <= EXTLOG_DATA_MAX(pA->Slot)) &&
+           (mdCrc16(pSlot, EXTLOG_HEAD_SIZE + size) ==
+            (uint16_t)(pSlot[EXTLOG_HEAD_SIZE + size] | ((uint16_t)pSlot[EXTLOG_HEAD_SIZE + size + 1U] << 8U)));
+}
+
+/**
+ * @brief	检测FRAM
+ * @details	在 MX_SPI2_Init() 之后调用，只读状态寄存器；序号由 Extlog_Recover() 在启动任务中恢复，
+ *			此前的写入被拒绝，读取不受影响
+ * @param	None
+ * @retval	false 未检测到FRAM
+ */
+bool Extlog_Init(void)
+{
+#if !defined(USING_RTTHREAD)
+    static osStaticMutexDef_t control;
+    osMutexStaticDef(extlog, &control);
+#endif
+    uint8_t status = 0xFF;
+
+    memset(&Extlog, 0x00, sizeof(Extlog));
+#if defined(USING_SPI_SLAVE)
+    /*SPI2是协处理器接口(spis.h)，总线上没有FRAM，PB12为片选输入*/
+    return false;
+#endif
+    Extlog_Select(false);
+#if defined(USING_RTTHREAD)
+    Extlog.Lock = rt_mutex_create("extlog", RT_IPC_FLAG_PRIO);
+#else
+    Extlog.Lock = osMutexCreate(osMutex(extlog));
+#endif
+    Extlog.Present = Extlog_Transfer(EXTLOG_CMD_RDSR, -1, &status, 1U, false) && !(status & EXTLOG_SR_ZERO);
+
+    return Extlog.Present;
+}
+
+/**
+ * @brief	恢复各区域的序号
+ * @details	逐槽读出校验(32KB约20ms)，各区域中序号最大的有效记录为最新记录；在启动任务中调用一次，
+ *			不占用关键I/O的启动时间。完成后才接受写入，此前的记录由写入方(SOE、保留区)补写
+ * @param	None
+ * @retval	None
+ */
+void Extlog_Recover(void)
+{
+    uint8_t slot[EXTLOG_SLOT_MAX];
+    uint32_t seq, latest;
+
+    for (uint8_t area = 0; Extlog.Present && (area < EXTLOG_AREAS); area++)
+    {
+        latest = 0;
+        for (uint16_t i = 0; i < Extlog_Areas[area].Slots; i++)
+        {
+            if (Extlog_Load(area, i, slot, &seq) && (seq > latest))
+            {
+                latest = seq;
+            }
+        }
+        Extlog.Sequence[area] = latest;
+    }
+    Extlog.Ready = Extlog.Present;
+}
+
+/*从站在 main() 及启动任务中直接调用 Extlog_Init、Extlog_Recover*/
+#if !defined(USING_SLAVE)
+/**
+ * @brief	外部日志的启动模块:检测FRAM
+ * @param	None
+ * @retval	None
+ */
+static void Extlog_Boot_Init(void)
+{
+    Extlog_Init();
+}
+
+/**
+ * @brief	外部日志的启动模块:恢复各区域的序号
+ * @param	None
+ * @retval	None
+ */
+static void Extlog_Boot_Recover(void)
+{
+    Extlog_Recover();
+    Boot_Mark(BOOT_MARK_LOG);
+}
+BOOT_MODULE(extlog, BOOT_LEVEL_MAIN, Extlog_Boot_Init, "irq");
+BOOT_MODULE(extlog_recover, BOOT_LEVEL_STAGE, Extlog_Boot_Recover, "");
+#endif
+
+/**
+ * @brief	写入一条记录
+ * @details	任务中调用，编码后放入写入队列由日志任务写入；日志任务未运行(如调度器启动前)时直接写入。
+ *			合并区域的记录替换队列中尚未开始写入的同区域记录
+ * @param	Area 区域号
+ * @param	Sequence 序号，0:取区域的下一个序号
+ * @param	pData 数据
+ * @param	Size 字节数，不大于 EXTLOG_DATA_MAX(槽长度)
+ * @retval	false 未检测到FRAM、序号尚未恢复、长度超出或队列已满
+ */
+bool Extlog_Write(uint8_t Area, uint32_t Sequence, const void *pData, uint8_t Size)
+{
+    const Extlog_Area *pA = &Extlog_Areas[Area];
+    Extlog_Request *pR = NULL, *pTail;
+    uint8_t slot[EXTLOG_SLOT_MAX], size;
+
+    if (!Extlog.Ready || (Area >= EXTLOG_AREAS) || (Size > EXTLOG_DATA_MAX(pA->Slot)))
+    {
+        return false;
+    }
+    if (Extlog.Thread == NULL || !Os_Running())
+    {
+        Sequence = Sequence ? Sequence : Extlog.Sequence[Area] + 1U;
+        Extlog.Sequence[Area] = (Sequence > Extlog.Sequence[Area]) ? Sequence : Extlog.Sequence[Area];
+        size = Extlog_Encode(slot, Area, Sequence, pData, Size);
+        Extlog.Writes++;
+        if (!Extlog_Program(Extlog_Address(Area, Sequence), slot, size))
+        {
+            Extlog.Errors++;
+            return false;
+        }
+        return true;
+    }
+    Os_Critical_Enter();
+    if (pA->Merge && Extlog.Count)
+    {
+        pTail = &Extlog.Queue[(Extlog.Head + Extlog.Count - 1U) % EXTLOG_QUEUE_SIZE];
+        pR = ((pTail->Area == Area) && !((Extlog.Count == 1U) && Extlog.Busy)) ? pTail : NULL;
+    }
+    if ((pR == NULL) && (Extlog.Count < EXTLOG_QUEUE_SIZE))
+    {
+        pR = &Extlog.Queue[(Extlog.Head + Extlog.Count) % EXTLOG_QUEUE_SIZE];
+        Extlog.Count++;
+    }
+    if (pR)
+    {
+        Sequence = Sequence ? Sequence : Extlog.Sequence[Area] + 1U;
+        Extlog.Sequence[Area] = (Sequence > Extlog.Sequence[Area]) ? Sequence : Extlog.Sequence[Area];
+        pR->Area = Area;
+        pR->Sequence = Sequence;
+        pR->Size = Extlog_Encode(pR->Slot, Area, Sequence, pData, Size);
+    }
+    else
+    {
+        Extlog.Drops++;
+    }
+    Os_Critical_Exit();
+    if (pR)
+    {
+        Os_Signal_Set(Extlog.Thread, EXTLOG_SIGNAL_POST);
+    }
+
+    return (pR != NULL);
+}
+
+/**
+ * @brief	读取一条记录
+ * @details	尚在写入队列中的记录读不到
+ * @param	Area 区域号
+ * @param	Sequence 序号
+ * @param	pData 数据
+ * @param	Size 缓冲区字节数，记录较短时其余部分不变
+ * @retval	false 无此记录(未写入、已被覆盖或校验错误)
+ */
+bool Extlog_Read(uint8_t Area, uint32_t Sequence, void *pData, uint8_t Size)
+{
+    uint8_t slot[EXTLOG_SLOT_MAX];
+    uint32_t seq;
+
+    if (!Extlog.Present || (Area >= EXTLOG_AREAS) || (Sequence == 0U) ||
+        !Extlog_Load(Area, (uint16_t)(Sequence % Extlog_Areas[Area].Slots), slot, &seq) || (seq != Sequence))
+    {
+        return false;
+    }
+    memcpy(pData, &slot[EXTLOG_HEAD_SIZE], (slot[4] < Size) ? slot[4] : Size);
+
+    return true;
+}
+
+/**
+ * @brief	区域中最新记录的序号
+ * @param	Area 区域号
+ * @retval	0:尚无记录或未检测到FRAM
+ */
+uint32_t Extlog_Latest(uint8_t Area)
+{
+    return (Extlog.Present && (Area < EXTLOG_AREAS)) ? Extlog.Sequence[Area] : 0U;
+}
+
+/**
+ * @brief	区域的槽数(可保存的记录数)
+ * @param	Area 区域号
+ * @retval	0:未检测到FRAM
+ */
+uint32_t Extlog_Slots(uint8_t Area)
+{
+    return (Extlog.Present && (Area < EXTLOG_AREAS)) ? Extlog_Areas[Area].Slots : 0U;
+}
+
+/**
+ * @brief	写入排队的记录
+ * @details	由日志任务循环调用：依次写入队列中的记录，队列为空时等待新的记录
+ * @param	Timeout 最长等待时间(ms)
+ * @retval	None
+ */
+void Extlog_Process(uint32_t Timeout)
+{
+    Extlog_Request *pR;
+
+    Extlog.Thread = Os_Self();
+    for (;;)
+    {
+        Os_Critical_Enter();
+        pR = Extlog.Count ? &Extlog.Queue[Extlog.Head] : NULL;
+        Extlog.Busy = (pR != NULL);
+        Os_Critical_Exit();
+        if (pR == NULL)
+        {
+            break;
+        }
+        Extlog.Writes++;
+        if (!Extlog_Program(Extlog_Address(pR->Area, pR->Sequence), pR->Slot, pR->Size))
+        {
+            Extlog.Errors++;
+        }
+        Os_Critical_Enter();
+        Extlog.Head = (Extlog.Head + 1U) % EXTLOG_QUEUE_SIZE;
+        Extlog.Count--;
+        Extlog.Busy = false;
+        Os_Critical_Exit();
+    }
+    Os_Signal_Wait(EXTLOG_SIGNAL_POST, Timeout);
+}
+
+/**
+ * @brief	打印外部日志状态
+ * @param	None
+ * @retval	None
+ */
+void Extlog_Show(void)
+{
+    shellPrint(&shell, "fram = %s%s, queue = %d/%d, writes = %u, drops = %u, errors = %u\r\n",
+               Extlog.Present ? "present" : "absent", (Extlog.Present && !Extlog.Ready) ? " (recovering)" : "", Extlog.Count, EXTLOG_QUEUE_SIZE, Extlog.Writes, Extlog.Drops,
+               Extlog.Errors);
+    for (uint8_t area = 0; Extlog.Present && (area < EXTLOG_AREAS); area++)
+    {
+        const Extlog_Area *pA = &Extlog_Areas[area];
+
+        shellPrint(&shell, "%-8s 0x%04x, %d x %d bytes, latest = %u\r\n", pA->Name, pA->Start, pA->Slots, pA->Slot,
+                   Extlog.Sequence[area]);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), extlog, Extlog_Show, show external log);
@@ -0,0 +1,357 @@
+#include "heap_trace.h"
+#include "shell_port.h"
+
+#if !defined(USING_RTTHREAD)
+#include "task.h"
+
+/*heap_4 使用的堆(configAPPLICATION_ALLOCATED_HEAP)，由本模块定义以便遍历块头*/
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+
+#if defined(USING_HEAP_TRACE)
+/*与 heap_4.c 相同的块头:空闲块串成链表，已分配块的长度最高位置1*/
+typedef struct Heap_Link
+{
+    struct Heap_Link *pNext;
+    size_t Size;
+} Heap_Link;
+
+#define HEAP_LINK_SIZE ((sizeof(Heap_Link) + (portBYTE_ALIGNMENT - 1U)) & ~((size_t)portBYTE_ALIGNMENT_MASK))
+#define HEAP_ALLOCATED_BIT ((size_t)1U << ((sizeof(size_t) * 8U) - 1U))
+
+/*一次遍历的汇总*/
+typedef struct
+{
+    uint16_t Used_Blocks;
+    uint16_t Free_Blocks;
+    uint32_t Used_Bytes;
+    uint32_t Free_Bytes;
+    uint32_t Largest;
+    /*遍历恰好止于结束标记*/
+    bool Intact;
+} Heap_Trace_Scan;
+
+/*按调用者汇总的未释放块*/
+typedef struct
+{
+    void *Caller;
+    uint16_t Blocks;
+    uint32_t Bytes;
+    uint32_t Oldest;
+} Heap_Trace_Site;
+
+static Heap_Trace_HandleTypeDef Heap_Trace;
+
+/**
+ * @brief	堆的首块及结束标记的位置
+ * @details	与 prvHeapInit() 的对齐方式相同
+ * @param	pEnd 结束标记
+ * @retval	首块
+ */
+static uint8_t *Heap_Trace_Bounds(uint8_t **pEnd)
+{
+    size_t addr = (size_t)ucHeap, total = configTOTAL_HEAP_SIZE;
+
+    if (addr & portBYTE_ALIGNMENT_MASK)
+    {
+        addr += portBYTE_ALIGNMENT - 1U;
+        addr &= ~((size_t)portBYTE_ALIGNMENT_MASK);
+        total -= addr - (size_t)ucHeap;
+    }
+    *pEnd = (uint8_t *)((addr + total - HEAP_LINK_SIZE) & ~((size_t)portBYTE_ALIGNMENT_MASK));
+    return (uint8_t *)addr;
+}
+
+/**
+ * @brief	取得第 Index 个块
+ * @details	调度器挂起时调用；块在堆中首尾相接，按块头中的长度逐块前进
+ * @param	Index 块序号
+ * @param	pAddr 块头地址
+ * @param	pSize 块长度(含块头)
+ * @retval	true:块存在 false:超出最后一块、堆尚未初始化或块头损坏
+ */
+static bool Heap_Trace_Block(uint16_t Index, uint8_t **pAddr, size_t *pSize)
+{
+    uint8_t *end, *p = Heap_Trace_Bounds(&end);
+
+    while (p < end)
+    {
+        size_t size = ((Heap_Link *)p)->Size & ~HEAP_ALLOCATED_BIT;
+
+        if ((size == 0U) || (size > (size_t)(end - p)))
+        {
+            return false;
+        }
+        if (Index-- == 0U)
+        {
+            *pAddr = p;
+            *pSize = size;
+            return true;
+        }
+        p += size;
+    }
+    return false;
+}
+
+/**
+ * @brief	遍历整个堆
+ * @details	调度器挂起时调用
+ * @param	pScan 汇总结果
+ * @retval	None
+ */
+static void Heap_Trace_Walk(Heap_Trace_Scan *pScan)
+{
+    uint8_t *end, *p = Heap_Trace_Bounds(&end);
+
+    memset(pScan, 0, sizeof(*pScan));
+    while (p < end)
+    {
+        size_t size = ((Heap_Link *)p)->Size & ~HEAP_ALLOCATED_BIT;
+
+        if ((size == 0U) || (size > (size_t)(end - p)))
+        {
+            return;
+        }
+        if (((Heap_Link *)p)->Size & HEAP_ALLOCATED_BIT)
+        {
+            pScan->Used_Blocks++;
+            pScan->Used_Bytes += size;
+        }
+        else
+        {
+            pScan->Free_Blocks++;
+            pScan->Free_Bytes += size;
+            pScan->Largest = (size > pScan->Largest) ? size : pScan->Largest;
+        }
+        p += size;
+    }
+    pScan->Intact = (p == end);
+}
+
+/**
+ * @brief	查找未释放块的分配者
+ * @param	pBlock 用户数据地址
+ * @retval	跟踪表中的位置，未跟踪时为 NULL
+ */
+static Heap_Trace_Live *Heap_Trace_Find(void *pBlock)
+{
+    for (uint16_t i = 0; i < Heap_Trace.Lives; i++)
+    {
+        if (Heap_Trace.Live[i].Block == pBlock)
+        {
+            return &Heap_Trace.Live[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief	写入一条最近记录
+ * @param	Op 操作(HEAP_TRACE_xxx)
+ * @param	pBlock 用户数据地址
+ * @param	Size 块长度
+ * @param	pCaller 调用者
+ * @retval	None
+ */
+static void Heap_Trace_Record_Op(uint8_t Op, void *pBlock, size_t Size, void *pCaller)
+{
+    Heap_Trace_Record *pR;
+
+    if (Heap_Trace.Hold)
+    {
+        return;
+    }
+    pR = &Heap_Trace.Ring[Heap_Trace.Head++ & (HEAP_TRACE_RING - 1U)];
+    pR->Tick = HAL_GetTick();
+    pR->Caller = pCaller;
+    pR->Block = pBlock;
+    pR->Size = (uint16_t)Size;
+    pR->Op = Op;
+}
+
+/**
+ * @brief	记录一次分配
+ * @details	由 pvPortMalloc() 中的 traceMALLOC 在调度器挂起时调用，不得调用内核接口
+ * @param	pBlock 分配到的地址，NULL为失败
+ * @param	Size 块长度(含块头)
+ * @param	pCaller pvPortMalloc() 的调用者
+ * @retval	None
+ */
+void Heap_Trace_Malloc(void *pBlock, size_t Size, void *pCaller)
+{
+    Heap_Trace_Record_Op((pBlock != NULL) ? HEAP_TRACE_MALLOC : HEAP_TRACE_FAIL, pBlock, Size, pCaller);
+    if (pBlock == NULL)
+    {
+        Heap_Trace.Fails++;
+        return;
+    }
+    Heap_Trace.Mallocs++;
+    if (Heap_Trace.Lives < HEAP_TRACE_LIVE)
+    {
+        Heap_Trace_Live *pL = &Heap_Trace.Live[Heap_Trace.Lives++];
+
+        pL->Block = pBlock;
+        pL->Caller = pCaller;
+        pL->Tick = HAL_GetTick();
+        pL->Size = (uint16_t)Size;
+    }
+    else
+    {
+        Heap_Trace.Untracked++;
+    }
+}
+
+/**
+ * @brief	记录一次释放
+ * @details	由 vPortFree() 中的 traceFREE 在调度器挂起时调用
+ * @param	pBlock 释放的地址
+ * @param	Size 块长度(含块头)
+ * @param	pCaller vPortFree() 的调用者
+ * @retval	None
+ */
+void Heap_Trace_Free(void *pBlock, size_t Size, void *pCaller)
+{
+    Heap_Trace_Live *pL = Heap_Trace_Find(pBlock);
+
+    Heap_Trace_Record_Op(HEAP_TRACE_FREE, pBlock, Size, pCaller);
+    Heap_Trace.Frees++;
+    if (pL != NULL)
+    {
+        *pL = Heap_Trace.Live[--Heap_Trace.Lives];
+    }
+    else if (Heap_Trace.Untracked)
+    {
+        Heap_Trace.Untracked--;
+    }
+}
+
+/**
+ * @brief	按调用者汇总未释放块
+ * @details	调度器挂起时调用；调用者多于 HEAP_TRACE_SITES 时其余的不列出
+ * @param	pSites 汇总结果
+ * @retval	调用者数
+ */
+static uint8_t Heap_Trace_Sites(Heap_Trace_Site *pSites)
+{
+    uint8_t count = 0;
+    uint32_t now = HAL_GetTick();
+
+    for (uint16_t i = 0; i < Heap_Trace.Lives; i++)
+    {
+        const Heap_Trace_Live *pL = &Heap_Trace.Live[i];
+        uint8_t j = 0;
+
+        while ((j < count) && (pSites[j].Caller != pL->Caller))
+        {
+            j++;
+        }
+        if (j == count)
+        {
+            if (count >= HEAP_TRACE_SITES)
+            {
+                continue;
+            }
+            memset(&pSites[count++], 0, sizeof(pSites[0]));
+            pSites[j].Caller = pL->Caller;
+        }
+        pSites[j].Blocks++;
+        pSites[j].Bytes += pL->Size;
+        pSites[j].Oldest = ((now - pL->Tick) > pSites[j].Oldest) ? (now - pL->Tick) : pSites[j].Oldest;
+    }
+    return count;
+}
+
+/**
+ * @brief	打印堆的使用情况
+ * @details	空闲块分布由遍历得到:碎片率 = (空闲字节 - 最大空闲块) / 空闲字节；
+ *			按调用者列出未释放的块，持续增长且存在时间长的调用者即泄漏的来源
+ * @param	None
+ * @retval	None
+ */
+void Heap_Trace_Show(void)
+{
+    Heap_Trace_Scan scan;
+    Heap_Trace_Site sites[HEAP_TRACE_SITES];
+    uint8_t count;
+
+    vTaskSuspendAll();
+    Heap_Trace_Walk(&scan);
+    count = Heap_Trace_Sites(sites);
+    (void)xTaskResumeAll();
+    shellPrint(&shell, "heap = %u, free = %u, min free = %u\r\n", configTOTAL_HEAP_SIZE, xPortGetFreeHeapSize(),
+               xPortGetMinimumEverFreeHeapSize());
+    shellPrint(&shell, "used = %u blocks/%u bytes, free = %u blocks, largest = %u, fragmentation = %u%%%s\r\n",
+               scan.Used_Blocks, scan.Used_Bytes, scan.Free_Blocks, scan.Largest,
+               scan.Free_Bytes ? (scan.Free_Bytes - scan.Largest) * 100U / scan.Free_Bytes : 0U,
+               scan.Intact ? "" : " (heap not walked to its end)");
+    shellPrint(&shell, "malloc = %u, free = %u, failed = %u, untracked = %u\r\n", Heap_Trace.Mallocs, Heap_Trace.Frees,
+               Heap_Trace.Fails, Heap_Trace.Untracked);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        shellPrint(&shell, "0x%08x blocks = %u, bytes = %u, oldest = %u ms\r\n", (uint32_t)sites[i].Caller,
+                   sites[i].Blocks, sites[i].Bytes, sites[i].Oldest);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), heap, Heap_Trace_Show, show heap usage and live blocks by caller);
+
+/**
+ * @brief	打印堆的块分布
+ * @details	逐块列出相对堆起始的偏移、长度及已分配块的分配者；每块单独挂起调度器读取，
+ *			打印本身的分配可能使表在打印期间变化
+ * @param	None
+ * @retval	None
+ */
+void Heap_Trace_Map(void)
+{
+    uint8_t *addr;
+    size_t size;
+    bool used;
+    const Heap_Trace_Live *pL;
+    void *caller;
+
+    for (uint16_t i = 0;; i++)
+    {
+        vTaskSuspendAll();
+        if (!Heap_Trace_Block(i, &addr, &size))
+        {
+            (void)xTaskResumeAll();
+            break;
+        }
+        used = (((Heap_Link *)addr)->Size & HEAP_ALLOCATED_BIT) != 0U;
+        pL = used ? Heap_Trace_Find(addr + HEAP_LINK_SIZE) : NULL;
+        caller = pL ? pL->Caller : NULL;
+        (void)xTaskResumeAll();
+        shellPrint(&shell, "%5u %5u %s", (uint32_t)(addr - ucHeap), size, used ? "used" : "free");
+        if (caller != NULL)
+        {
+            shellPrint(&shell, " 0x%08x", (uint32_t)caller);
+        }
+        shellPrint(&shell, "\r\n");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), heap_map, Heap_Trace_Map, show heap block map);
+
+/**
+ * @brief	打印最近的分配及释放
+ * @details	打印期间暂停记录，避免shell输出的缓冲区分配冲掉记录
+ * @param	None
+ * @retval	None
+ */
+void Heap_Trace_Log(void)
+{
+    static const char *const ops[] = {"malloc", "free", "fail"};
+    uint32_t head = Heap_Trace.Head;
+    uint32_t n = (head > HEAP_TRACE_RING) ? HEAP_TRACE_RING : head;
+
+    Heap_Trace.Hold = true;
+    for (uint32_t i = head - n; i != head; i++)
+    {
+        const Heap_Trace_Record *pR = &Heap_Trace.Ring[i & (HEAP_TRACE_RING - 1U)];
+
+        shellPrint(&shell, "%10u %-6s %5u at %5d by 0x%08x\r\n", pR->Tick, ops[pR->Op], pR->Size,
+                   pR->Block ? (int)((uint8_t *)pR->Block - ucHeap) : -1, (uint32_t)pR->Caller);
+    }
+    Heap_Trace.Hold = false;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), heap_log, Heap_Trace_Log, show recent heap operations);
+#endif
+#endif
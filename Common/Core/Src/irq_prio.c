@@ -0,0 +1,84 @@
+#include "irq_prio.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#endif
+#include "shell_port.h"
+
+/*内核中断不高于系统调用上限，所有优先级在4位范围内*/
+#define IRQ_PRIORITY_CHECK(irqn, prio, type) \
+    typedef char Irq_##irqn##_Check[((((type) == IRQ_BARE) || ((prio) >= IRQ_SYSCALL_CEILING)) && ((prio) <= 15U)) ? 1 : -1];
+IRQ_PRIORITY_TABLE(IRQ_PRIORITY_CHECK)
+
+/*中断优先级描述*/
+typedef struct
+{
+    const char *Name;
+    IRQn_Type IRQn;
+    uint8_t Priority;
+    uint8_t Type;
+} Irq_Priority;
+
+#define IRQ_PRIORITY_ENTRY(irqn, prio, type) {#irqn, irqn, (prio), (type)},
+static const Irq_Priority Irq_Priorities[] = {IRQ_PRIORITY_TABLE(IRQ_PRIORITY_ENTRY)};
+
+#define IRQ_PRIORITY_COUNT (sizeof(Irq_Priorities) / sizeof(Irq_Priorities[0]))
+
+/**
+ * @brief	按优先级表设置外设中断优先级
+ * @details	在各外设初始化之后、启动调度器之前调用；FreeRTOS要求全部位用作抢占优先级(HAL_Init中设置)
+ * @param	None
+ * @retval	None
+ */
+void Irq_Priority_Init(void)
+{
+    if (HAL_NVIC_GetPriorityGrouping() != NVIC_PRIORITYGROUP_4)
+    {
+        Error_Handler();
+    }
+    for (uint16_t i = 0; i < IRQ_PRIORITY_COUNT; i++)
+    {
+        HAL_NVIC_SetPriority(Irq_Priorities[i].IRQn, Irq_Priorities[i].Priority, 0);
+    }
+}
+/*在任何外设中断使能之前设定优先级；从站在 main() 中直接调用 Irq_Priority_Init*/
+#if !defined(USING_SLAVE)
+BOOT_MODULE(irq, BOOT_LEVEL_MAIN, Irq_Priority_Init, "trace");
+#endif
+
+/**
+ * @brief	打印中断优先级
+ * @details	列出表中各中断的当前优先级；不在表中的已使能中断标记 unlisted，
+ *			当前优先级高于系统调用上限的内核中断标记 ceiling
+ * @param	None
+ * @retval	None
+ */
+void Irq_Priority_Show(void)
+{
+    uint32_t preempt, sub;
+    bool listed;
+
+    shellPrint(&shell, "syscall ceiling = %d\r\n", IRQ_SYSCALL_CEILING);
+    for (uint16_t i = 0; i < IRQ_PRIORITY_COUNT; i++)
+    {
+        const Irq_Priority *pI = &Irq_Priorities[i];
+
+        HAL_NVIC_GetPriority(pI->IRQn, NVIC_PRIORITYGROUP_4, &preempt, &sub);
+        shellPrint(&shell, "%-20s prio = %2d, %s%s%s\r\n", pI->Name, preempt, (pI->Type == IRQ_KERNEL) ? "kernel" : "bare",
+                   NVIC_GetEnableIRQ(pI->IRQn) ? "" : ", disabled",
+                   ((pI->Type == IRQ_KERNEL) && (preempt < IRQ_SYSCALL_CEILING)) ? ", ceiling" : "");
+    }
+    for (int32_t irqn = 0; irqn <= (int32_t)USBWakeUp_IRQn; irqn++)
+    {
+        listed = false;
+        for (uint16_t i = 0; i < IRQ_PRIORITY_COUNT; i++)
+        {
+            listed |= (Irq_Priorities[i].IRQn == (IRQn_Type)irqn);
+        }
+        if (!listed && NVIC_GetEnableIRQ((IRQn_Type)irqn))
+        {
+            HAL_NVIC_GetPriority((IRQn_Type)irqn, NVIC_PRIORITYGROUP_4, &preempt, &sub);
+            shellPrint(&shell, "irq %-16d prio = %2d, unlisted\r\n", irqn, preempt);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), irq, Irq_Priority_Show, show irq priorities);
@@ -0,0 +1,320 @@
+#include "kv.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#include "Flash.h"
+#endif
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+/*每页半字数及记录起始偏移(页头占两个半字)*/
+#define KV_PAGE_WORDS (KV_PAGE_SIZE / 2U)
+#define KV_HEAD_WORDS 2U
+/*记录占用的半字数:记录头、版本、数据、CRC*/
+#define KV_RECORD_WORDS(len) (3U + ((len) + 1U) / 2U)
+/*读取页内第 off 个半字*/
+#define KV_WORD(page, off) (*(__IO uint16_t *)((page) + (uint32_t)(off) * 2U))
+
+static Kv_HandleTypeDef Kv;
+
+/**
+ * @brief	向flash写入若干半字
+ * @details	写完逐个读回校验；主站的擦写程序位于RAM(Flash.c)，在擦写窗口中写入
+ * @param	Address 起始地址
+ * @param	pData 数据
+ * @param	Words 半字数
+ * @retval	true 写入成功
+ */
+static bool Kv_Program(uint32_t Address, const uint16_t *pData, uint16_t Words)
+{
+#if defined(USING_SLAVE)
+    bool ok = true;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+    for (uint16_t i = 0; ok && (i < Words); i++, Address += 2U)
+    {
+        ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Address, pData[i]) == HAL_OK) &&
+             (*(__IO uint16_t *)Address == pData[i]);
+    }
+    HAL_FLASH_Lock();
+
+    return ok;
+#else
+    return FLASH_Program(Address, pData, Words);
+#endif
+}
+
+/**
+ * @brief	擦除一页
+ * @details	擦除约20~40ms，只在整理及首次格式化时发生；从站擦除期间CPU停顿，
+ *          主站的擦写程序位于RAM，登记的中断照常响应
+ * @param	Page 页地址
+ * @retval	true 擦除成功
+ */
+static bool Kv_Erase(uint32_t Page)
+{
+#if defined(USING_SLAVE)
+    FLASH_EraseInitTypeDef erase = {.TypeErase = FLASH_TYPEERASE_PAGES, .PageAddress = Page, .NbPages = 1U};
+    uint32_t error = 0;
+    bool ok;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+    ok = (HAL_FLASHEx_Erase(&erase, &error) == HAL_OK) && (error == 0xFFFFFFFFUL);
+    HAL_FLASH_Lock();
+
+    return ok;
+#else
+    return FLASH_Erase(Page);
+#endif
+}
+
+/**
+ * @brief	校验一条记录
+ * @param	Page 页地址
+ * @param	Off 记录的半字偏移
+ * @retval	true CRC正确
+ */
+static bool Kv_Valid(uint32_t Page, uint16_t Off)
+{
+    uint16_t head = KV_WORD(Page, Off), len = head >> 8U;
+
+    return ((head & 0xFFU) != KV_KEY_NONE) && (len != 0U) && (len <= KV_VALUE_MAX) &&
+           (KV_WORD(Page, Off + KV_RECORD_WORDS(len) - 1U) ==
+            mdCrc16((mdU8 *)(Page + (uint32_t)Off * 2U), 4U + len));
+}
+
+/**
+ * @brief	查找键的最新记录
+ * @details	记录按写入顺序追加，最后一条校验正确的记录为最新值
+ * @param	Page 页地址
+ * @param	Tail 页内已用的半字数
+ * @param	Key 键
+ * @retval	记录的半字偏移，0:不存在
+ */
+static uint16_t Kv_Find(uint32_t Page, uint16_t Tail, uint8_t Key)
+{
+    uint16_t off = KV_HEAD_WORDS, found = 0, head;
+
+    for (; off < Tail; off += KV_RECORD_WORDS(head >> 8U))
+    {
+        head = KV_WORD(Page, off);
+        if (((head & 0xFFU) == Key) && Kv_Valid(Page, off))
+        {
+            found = off;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief	取得页内已用的半字数
+ * @details	记录头为擦除值时结束；记录头损坏(长度越界)时视为已满，下次写入时整理
+ * @param	Page 页地址
+ * @retval	已用的半字数
+ */
+static uint16_t Kv_Scan(uint32_t Page)
+{
+    uint16_t off = KV_HEAD_WORDS, head;
+
+    while (off < KV_PAGE_WORDS)
+    {
+        head = KV_WORD(Page, off);
+        if (head == 0xFFFFU)
+        {
+            break;
+        }
+        if (((head >> 8U) == 0U) || ((head >> 8U) > KV_VALUE_MAX) ||
+            (off + KV_RECORD_WORDS(head >> 8U) > KV_PAGE_WORDS))
+        {
+            return KV_PAGE_WORDS;
+        }
+        off += KV_RECORD_WORDS(head >> 8U);
+    }
+
+    return off;
+}
+
+/**
+ * @brief	在页尾追加一条记录
+ * @param	Page 页地址
+ * @param	Off 记录的半字偏移
+ * @param	Key 键
+ * @param	Version 版本
+ * @param	pValue 数据
+ * @param	Size 字节数
+ * @retval	true 写入成功
+ */
+static bool Kv_Append(uint32_t Page, uint16_t Off, uint8_t Key, uint16_t Version, const void *pValue, uint16_t Size)
+{
+    uint16_t record[KV_RECORD_WORDS(KV_VALUE_MAX)] = {0};
+    uint16_t words = KV_RECORD_WORDS(Size);
+
+    record[0] = (uint16_t)((Size << 8U) | Key);
+    record[1] = Version;
+    memcpy(&record[2], pValue, Size);
+    record[words - 1U] = mdCrc16((mdU8 *)record, 4U + Size);
+
+    return Kv_Program(Page + (uint32_t)Off * 2U, record, words);
+}
+
+/**
+ * @brief	整理参数存储区
+ * @details	擦除另一页，只拷贝各键的最新记录，最后写入页头使新页生效；
+ *          拷贝中途掉电时新页无页头，旧页仍为活动页
+ * @param	None
+ * @retval	true 整理成功
+ */
+static bool Kv_Compact(void)
+{
+    uint32_t page = (Kv.Page == KV_PAGE_ADDR(KV_PAGE_A)) ? KV_PAGE_ADDR(KV_PAGE_B) : KV_PAGE_ADDR(KV_PAGE_A);
+    uint16_t head[KV_HEAD_WORDS] = {KV_MAGIC, (uint16_t)(Kv.Gen + 1U)};
+    uint16_t off = KV_HEAD_WORDS, tail = KV_HEAD_WORDS, word;
+
+    if (!Kv_Erase(page) || !Kv_Program(page + 2U, &head[1], 1U))
+    {
+        return false;
+    }
+    for (; off < Kv.Tail; off += KV_RECORD_WORDS(word >> 8U))
+    {
+        word = KV_WORD(Kv.Page, off);
+        if (Kv_Find(Kv.Page, Kv.Tail, (uint8_t)word) != off)
+        {
+            continue;
+        }
+        if (!Kv_Program(page + (uint32_t)tail * 2U, (const uint16_t *)(Kv.Page + (uint32_t)off * 2U), KV_RECORD_WORDS(word >> 8U)))
+        {
+            return false;
+        }
+        tail += KV_RECORD_WORDS(word >> 8U);
+    }
+    if (!Kv_Program(page, &head[0], 1U))
+    {
+        return false;
+    }
+    Kv.Page = page;
+    Kv.Gen = head[1];
+    Kv.Tail = tail;
+
+    return true;
+}
+
+/**
+ * @brief	初始化参数存储区
+ * @details	两页均有页头时代数较新的一页为活动页；均无页头时格式化 KV_PAGE_A
+ * @param	None
+ * @retval	None
+ */
+void Kv_Init(void)
+{
+    uint32_t a = KV_PAGE_ADDR(KV_PAGE_A), b = KV_PAGE_ADDR(KV_PAGE_B);
+    bool va = (KV_WORD(a, 0) == KV_MAGIC), vb = (KV_WORD(b, 0) == KV_MAGIC);
+    uint16_t head[KV_HEAD_WORDS] = {KV_MAGIC, 0};
+
+    if (va || vb)
+    {
+        Kv.Page = (va && (!vb || ((int16_t)(KV_WORD(a, 1) - KV_WORD(b, 1)) > 0))) ? a : b;
+        Kv.Gen = KV_WORD(Kv.Page, 1);
+        Kv.Tail = Kv_Scan(Kv.Page);
+        return;
+    }
+    Kv.Page = a;
+    Kv.Gen = 0;
+    Kv.Tail = KV_HEAD_WORDS;
+    if (!Kv_Erase(a) || !Kv_Program(a, head, KV_HEAD_WORDS))
+    {
+        /*格式化失败时不再写入*/
+        Kv.Tail = KV_PAGE_WORDS;
+    }
+}
+/*从站由 Persist_Init() 直接调用 Kv_Init*/
+#if !defined(USING_SLAVE)
+BOOT_MODULE(kv, BOOT_LEVEL_MAIN, Kv_Init, "flash,retain");
+#endif
+
+/**
+ * @brief	读取参数
+ * @param	Key 键
+ * @param	pValue 存放数据
+ * @param	Size 缓冲区字节数，超出部分不拷贝
+ * @retval	参数的字节数，0:不存在
+ */
+uint16_t Kv_Get(uint8_t Key, void *pValue, uint16_t Size)
+{
+    uint16_t off = Kv.Page ? Kv_Find(Kv.Page, Kv.Tail, Key) : 0, len;
+
+    if (off == 0)
+    {
+        return 0;
+    }
+    len = KV_WORD(Kv.Page, off) >> 8U;
+    memcpy(pValue, (const void *)(Kv.Page + (uint32_t)(off + 2U) * 2U), (len < Size) ? len : Size);
+
+    return len;
+}
+
+/**
+ * @brief	保存参数
+ * @details	在活动页尾追加一条半字记录，不擦除flash；与最新值相同时不写入；
+ *          活动页写满时整理到另一页；在任务中调用，同一时刻只允许一个任务写入
+ * @param	Key 键
+ * @param	pValue 数据
+ * @param	Size 字节数(1~KV_VALUE_MAX)
+ * @retval	true 保存成功
+ */
+bool Kv_Set(uint8_t Key, const void *pValue, uint16_t Size)
+{
+    uint16_t off, version = 0;
+    bool ret = false;
+
+    if ((Key == KV_KEY_NONE) || (Size == 0U) || (Size > KV_VALUE_MAX) || (Kv.Page == 0U))
+    {
+        return false;
+    }
+    off = Kv_Find(Kv.Page, Kv.Tail, Key);
+    if (off)
+    {
+        if (((KV_WORD(Kv.Page, off) >> 8U) == Size) &&
+            (memcmp((const void *)(Kv.Page + (uint32_t)(off + 2U) * 2U), pValue, Size) == 0))
+        {
+            return true;
+        }
+        version = KV_WORD(Kv.Page, off + 1U) + 1U;
+    }
+    if ((Kv.Tail + KV_RECORD_WORDS(Size) <= KV_PAGE_WORDS) || Kv_Compact())
+    {
+        if (Kv.Tail + KV_RECORD_WORDS(Size) <= KV_PAGE_WORDS)
+        {
+            ret = Kv_Append(Kv.Page, Kv.Tail, Key, version, pValue, Size);
+            /*写入失败的记录同样占用空间*/
+            Kv.Tail += KV_RECORD_WORDS(Size);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief	打印参数存储区
+ * @details	列出各键的最新记录
+ * @param	None
+ * @retval	None
+ */
+void Kv_Show(void)
+{
+    uint16_t off = KV_HEAD_WORDS, head;
+
+    shellPrint(&shell, "page = 0x%08x, gen = %d, used = %d/%d\r\n", Kv.Page, Kv.Gen, Kv.Tail * 2U, KV_PAGE_SIZE);
+    for (; off < Kv.Tail; off += KV_RECORD_WORDS(head >> 8U))
+    {
+        head = KV_WORD(Kv.Page, off);
+        if (Kv_Find(Kv.Page, Kv.Tail, (uint8_t)head) == off)
+        {
+            shellPrint(&shell, "key = %d, ver = %d, len = %d, value = 0x%04x...\r\n", head & 0xFFU,
+                       KV_WORD(Kv.Page, off + 1U), head >> 8U, KV_WORD(Kv.Page, off + 2U));
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), kv, Kv_Show, show parameter store);
@@ -0,0 +1,119 @@
+#include "lzss.h"
+
+/**
+ * @brief	压缩
+ * @details	在搜索窗口内逐个比较取最长匹配，除输入输出缓冲区外不使用工作内存
+ * @param	pIn 原始数据
+ * @param	Length 原始数据长度
+ * @param	pOut 输出缓冲区
+ * @param	Size 输出缓冲区字节数
+ * @retval	压缩后的长度，0:输出超过 Size(数据不可压缩，应原样传输)
+ */
+uint16_t Lzss_Pack(const uint8_t *pIn, uint16_t Length, uint8_t *pOut, uint16_t Size)
+{
+    uint32_t in = 0, out = 0, flag = 0, bit = 8U, best, distance, n, limit;
+
+    while (in < Length)
+    {
+        if (bit == 8U)
+        {
+            /*新的标志字节*/
+            if (out >= Size)
+            {
+                return 0;
+            }
+            flag = out++;
+            pOut[flag] = 0;
+            bit = 0;
+        }
+        best = 0;
+        distance = 0;
+        limit = ((Length - in) < LZSS_MATCH_MAX) ? (Length - in) : LZSS_MATCH_MAX;
+        for (uint32_t back = 1U; (back <= in) && (back <= LZSS_SEARCH) && (best < limit); back++)
+        {
+            for (n = 0; (n < limit) && (pIn[in - back + n] == pIn[in + n]); n++)
+            {
+            }
+            if (n > best)
+            {
+                best = n;
+                distance = back;
+            }
+        }
+        if (best >= LZSS_MATCH_MIN)
+        {
+            if (out + 2U > Size)
+            {
+                return 0;
+            }
+            pOut[flag] |= 1U << bit;
+            pOut[out++] = (uint8_t)(distance - 1U);
+            pOut[out++] = (uint8_t)((((distance - 1U) >> 8U) << 4U) | (best - LZSS_MATCH_MIN));
+            in += best;
+        }
+        else
+        {
+            if (out >= Size)
+            {
+                return 0;
+            }
+            pOut[out++] = pIn[in++];
+        }
+        bit++;
+    }
+
+    return (uint16_t)out;
+}
+
+/**
+ * @brief	解压
+ * @param	pIn 压缩数据
+ * @param	Length 压缩数据长度
+ * @param	pOut 输出缓冲区
+ * @param	Size 输出缓冲区字节数
+ * @retval	解压后的长度，0:数据损坏(匹配距离越界、输出超过 Size 或匹配不完整)
+ */
+uint16_t Lzss_Unpack(const uint8_t *pIn, uint16_t Length, uint8_t *pOut, uint16_t Size)
+{
+    uint32_t in = 0, out = 0, distance, n, bit = 8U;
+    uint8_t flag = 0;
+
+    while (in < Length)
+    {
+        if (bit == 8U)
+        {
+            flag = pIn[in++];
+            bit = 0;
+            continue;
+        }
+        if (flag & (1U << bit++))
+        {
+            if (in + 2U > Length)
+            {
+                return 0;
+            }
+            distance = (((uint32_t)(pIn[in + 1U] >> 4U) << 8U) | pIn[in]) + 1U;
+            n = (pIn[in + 1U] & 0x0FU) + LZSS_MATCH_MIN;
+            in += 2U;
+            if ((distance > out) || (out + n > Size))
+            {
+                return 0;
+            }
+            /*匹配可与输出重叠(距离小于长度时重复最近的字节)，逐字节拷贝*/
+            for (; n; n--, out++)
+            {
+                pOut[out] = pOut[out - distance];
+            }
+        }
+        else
+        {
+            if (out >= Size)
+            {
+                return 0;
+            }
+            pOut[out++] = pIn[in++];
+        }
+    }
+
+    return (uint16_t)out;
+}
@@ -0,0 +1,116 @@
+#include "os_port.h"
+
+#if defined(USING_RTTHREAD)
+/*每个使用信号的线程挂接一个事件集，存放在线程控制块的 user_data 中*/
+#define OS_SIGNAL_THREADS 8U
+static struct rt_event Os_Events[OS_SIGNAL_THREADS];
+static uint8_t Os_Event_Count = 0;
+/*临界区嵌套计数及进入时的中断状态*/
+static uint32_t Os_Nest = 0;
+static rt_base_t Os_Level;
+
+/**
+ * @brief	进入临界区
+ * @details	与 FreeRTOS 的 taskENTER_CRITICAL 一致:关中断且可嵌套
+ * @param	None
+ * @retval	None
+ */
+void Os_Rt_Critical_Enter(void)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    if (Os_Nest++ == 0U)
+    {
+        Os_Level = level;
+    }
+}
+
+/**
+ * @brief	退出临界区
+ * @details	最外层退出时恢复进入前的中断状态
+ * @param	None
+ * @retval	None
+ */
+void Os_Rt_Critical_Exit(void)
+{
+    if (Os_Nest && (--Os_Nest == 0U))
+    {
+        rt_hw_interrupt_enable(Os_Level);
+    }
+}
+#endif
+
+/**
+ * @brief	为线程准备信号
+ * @details	FreeRTOS 使用任务通知，无需准备；RT-Thread 在线程启动前为其挂接事件集
+ * @param	Thread 线程
+ * @retval	false:事件集已用完
+ */
+bool Os_Signal_Attach(Os_Thread Thread)
+{
+#if defined(USING_RTTHREAD)
+    rt_event_t event;
+
+    if ((Thread == RT_NULL) || (Os_Event_Count >= OS_SIGNAL_THREADS))
+    {
+        return false;
+    }
+    event = &Os_Events[Os_Event_Count++];
+    rt_event_init(event, Thread->name, RT_IPC_FLAG_FIFO);
+    Thread->user_data = (rt_ubase_t)event;
+#else
+    UNUSED(Thread);
+#endif
+    return true;
+}
+
+/**
+ * @brief	向线程发送信号
+ * @details	可在中断中调用；线程为 NULL 时忽略
+ * @param	Thread 线程
+ * @param	Signals 信号
+ * @retval	None
+ */
+void Os_Signal_Set(Os_Thread Thread, uint32_t Signals)
+{
+    if (Thread == NULL)
+    {
+        return;
+    }
+#if defined(USING_RTTHREAD)
+    if (Thread->user_data)
+    {
+        rt_event_send((rt_event_t)Thread->user_data, Signals);
+    }
+#else
+    osSignalSet(Thread, (int32_t)Signals);
+#endif
+}
+
+/**
+ * @brief	等待发给本线程的信号
+ * @details	收到的信号在返回前清除
+ * @param	Signals 等待的信号
+ * @param	Timeout 最长等待时间(ms)，OS_WAIT_FOREVER 为一直等待
+ * @retval	收到的信号，超时为0
+ */
+uint32_t Os_Signal_Wait(uint32_t Signals, uint32_t Timeout)
+{
+#if defined(USING_RTTHREAD)
+    rt_event_t event = (rt_event_t)rt_thread_self()->user_data;
+    rt_uint32_t recved = 0;
+
+    if ((event == RT_NULL) ||
+        (rt_event_recv(event, Signals, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                       (Timeout == OS_WAIT_FOREVER) ? RT_WAITING_FOREVER : (rt_int32_t)rt_tick_from_millisecond(Timeout),
+                       &recved) != RT_EOK))
+    {
+        return 0;
+    }
+    return recved;
+#else
+    osEvent event = osSignalWait((int32_t)Signals, Timeout);
+
+    return (event.status == osEventSignal) ? (uint32_t)event.value.signals : 0;
+#endif
+}
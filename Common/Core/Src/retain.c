@@ -0,0 +1,207 @@
+#include "retain.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#endif
+#include "extlog.h"
+#include "mdcrc16.h"
+#include "string.h"
+
+/*保留区不在任何链接区内，复位后其内容保持不变*/
+#define Retain_Record ((Retain_Data *)RETAIN_ADDR)
+
+typedef char Retain_Extlog_Check[(sizeof(Retain_Data) <= EXTLOG_DATA_MAX(EXTLOG_SLOT_RETAIN)) ? 1 : -1];
+
+/*复位前保留的状态有效(热复位)*/
+static bool Retain_Warm;
+/*本次上电后保留区已被修改(外部日志恢复前的修改不能写入)*/
+static bool Retain_Changed;
+
+/**
+ * @brief	计算保留区的校验
+ * @param	pData 保留区
+ * @retval	CRC16
+ */
+static uint16_t Retain_Crc(const Retain_Data *pData)
+{
+    return mdCrc16((mdU8 *)pData, offsetof(Retain_Data, Crc16));
+}
+
+/**
+ * @brief	把保留区写入外部日志
+ * @details	保留区修改后调用，日志任务依次写入，队列中尚未写入的旧副本被替换
+ * @param	None
+ * @retval	None
+ */
+static void Retain_Save(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    Retain_Data data;
+
+    __disable_irq();
+    data = *Retain_Record;
+    __set_PRIMASK(primask);
+    Extlog_Write(EXTLOG_AREA_RETAIN, 0, &data, sizeof(data));
+}
+
+/**
+ * @brief	检查保留区
+ * @details	在写入保留区之前调用一次，只检查RAM；标志或校验错误(上电)时清零，
+ *			掉电前的副本由 Retain_Resume() 在外部日志恢复后取回
+ * @param	None
+ * @retval	true 热复位，保留的状态有效
+ */
+bool Retain_Init(void)
+{
+    Retain_Data *pR = Retain_Record;
+
+    Retain_Warm = (pR->Magic == RETAIN_MAGIC) && (pR->Crc16 == Retain_Crc(pR));
+    if (!Retain_Warm)
+    {
+        memset(pR, 0x00, sizeof(Retain_Data));
+        pR->Magic = RETAIN_MAGIC;
+        pR->Crc16 = Retain_Crc(pR);
+    }
+
+    return Retain_Warm;
+}
+
+/**
+ * @brief	从外部日志恢复保留区
+ * @details	在 Extlog_Recover() 之后调用一次：上电且此后尚未修改时取回掉电前最后保存的副本；
+ *			已修改时把当前内容补写入外部日志(此前的写入被拒绝)，不再恢复旧副本
+ * @param	None
+ * @retval	true 已从外部日志恢复，调用者据此重新应用保留的状态
+ */
+bool Retain_Resume(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    Retain_Data data;
+    bool ok;
+
+    if (Retain_Changed)
+    {
+        Retain_Save();
+    }
+    if (Retain_Warm || Retain_Changed)
+    {
+        return false;
+    }
+    ok = Extlog_Read(EXTLOG_AREA_RETAIN, Extlog_Latest(EXTLOG_AREA_RETAIN), &data, sizeof(data)) &&
+         (data.Magic == RETAIN_MAGIC) && (data.Crc16 == Retain_Crc(&data));
+    if (ok)
+    {
+        /*模块随电源一起复位，掉电前的速率等级不再适用*/
+        data.Spd = 0;
+        data.Crc16 = Retain_Crc(&data);
+        __disable_irq();
+        /*读取期间有修改时以修改为准*/
+        ok = !Retain_Changed;
+        if (ok)
+        {
+            *Retain_Record = data;
+            Retain_Warm = true;
+        }
+        __set_PRIMASK(primask);
+    }
+
+    return ok;
+}
+
+/*从站在 main() 及启动任务中直接调用 Retain_Init、Retain_Resume*/
+#if !defined(USING_SLAVE)
+/**
+ * @brief	保留区的启动模块:区分热复位与上电
+ * @param	None
+ * @retval	None
+ */
+static void Retain_Boot_Init(void)
+{
+    Retain_Init();
+}
+
+/**
+ * @brief	保留区的启动模块:上电时从外部日志取回
+ * @param	None
+ * @retval	None
+ */
+static void Retain_Boot_Resume(void)
+{
+    Retain_Resume();
+}
+/*在任何模块写入保留区之前检查*/
+BOOT_MODULE(retain, BOOT_LEVEL_MAIN, Retain_Boot_Init, "");
+BOOT_MODULE(retain_resume, BOOT_LEVEL_STAGE, Retain_Boot_Resume, "extlog_recover,soe_resume");
+#endif
+
+/**
+ * @brief	取得复位前保留的状态
+ * @param	pData 保留的状态
+ * @retval	false 冷启动，无保留的状态
+ */
+bool Retain_Load(Retain_Data *pData)
+{
+    if (Retain_Warm)
+    {
+        *pData = *Retain_Record;
+    }
+
+    return Retain_Warm;
+}
+
+/**
+ * @brief	保存继电器输出
+ * @details	写RAM并排队写入外部日志，继电器动作时调用
+ * @param	Outputs 第i位为输出i的状态
+ * @retval	None
+ */
+void Retain_Set_Outputs(uint32_t Outputs)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Retain_Record->Outputs = Outputs;
+    Retain_Record->Crc16 = Retain_Crc(Retain_Record);
+    Retain_Changed = true;
+    __set_PRIMASK(primask);
+    Retain_Save();
+}
+
+/**
+ * @brief	保存调度状态
+ * @details	写RAM并排队写入外部日志，就绪或阻塞集合变化时调用
+ * @param	Ready 就绪集合
+ * @param	Block 阻塞集合
+ * @param	Scanned 首轮扫描已完成
+ * @retval	None
+ */
+void Retain_Set_Nodes(uint32_t Ready, uint32_t Block, bool Scanned)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Retain_Record->Ready = Ready;
+    Retain_Record->Block = Block;
+    Retain_Record->Scanned = Scanned;
+    Retain_Record->Crc16 = Retain_Crc(Retain_Record);
+    Retain_Changed = true;
+    __set_PRIMASK(primask);
+    Retain_Save();
+}
+
+/**
+ * @brief	保存模块的速率等级
+ * @details	MCU复位时模块不复位，仍工作在原速率等级
+ * @param	Spd 速率等级
+ * @retval	None
+ */
+void Retain_Set_Link(uint8_t Spd)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Retain_Record->Spd = Spd;
+    Retain_Record->Crc16 = Retain_Crc(Retain_Record);
+    Retain_Changed = true;
+    __set_PRIMASK(primask);
+    Retain_Save();
+}
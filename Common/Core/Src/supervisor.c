@@ -0,0 +1,468 @@
+#include "supervisor.h"
+#include "os_port.h"
+#include "shell_port.h"
+
+static Supervisor_HandleTypeDef Supervisor = {.Stalled = SUPERVISOR_NONE};
+static Os_Timer Supervisor_Timer;
+/*故障记录不在任何链接区内，复位后其内容保持不变*/
+#define Supervisor_Crash_Record ((Supervisor_Crash *)(SUPERVISOR_RAM_END - SUPERVISOR_CRASH_SIZE))
+typedef char Supervisor_Crash_Check[(sizeof(Supervisor_Crash) <= SUPERVISOR_CRASH_SIZE) ? 1 : -1];
+
+/**
+ * @brief	周期检查全部任务的心跳
+ * @details	在定时器服务任务中调用；定时器服务任务本身停滞时同样不再喂狗
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Supervisor_Poll(void const *argument)
+{
+    uint32_t now = Os_Tick();
+
+    UNUSED(argument);
+    for (uint8_t i = 0; (i < Supervisor.Count) && (Supervisor.Stalled == SUPERVISOR_NONE) && !Supervisor.Hold; i++)
+    {
+        if (Supervisor.Task[i].Timeout && (now - Supervisor.Task[i].Tick > Supervisor.Task[i].Timeout))
+        {
+            Supervisor.Stalled = i;
+        }
+    }
+    if (Supervisor.Stalled == SUPERVISOR_NONE)
+    {
+        Supervisor.Feeds++;
+    }
+    Supervisor_Feed(Supervisor.Stalled == SUPERVISOR_NONE);
+}
+
+/**
+ * @brief	启动任务监督
+ * @details	在创建任务前调用；启动前登记的任务从此刻开始计时
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Init(void)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Supervisor, Supervisor_Poll, &control);
+
+    /*上电后RAM内容随机，没有有效标志时清除记录*/
+    if (Supervisor_Crash_Record->Magic != SUPERVISOR_CRASH_MAGIC)
+    {
+        Supervisor_Crash_Record->Count = 0;
+    }
+    Supervisor_Timer = osTimerCreate(osTimer(Supervisor), osTimerPeriodic, NULL);
+    if (Supervisor_Timer)
+    {
+        Os_Timer_Start(Supervisor_Timer, SUPERVISOR_PERIOD);
+    }
+}
+
+/**
+ * @brief	登记一个被监督的任务
+ * @details	在任务进入循环前调用；Timeout 不为0时任务须在 Timeout 内调用 Supervisor_Checkin
+ * @param	Name 任务名
+ * @param	Timeout 心跳期限(ms)
+ * @retval	任务号，SUPERVISOR_NONE:登记表已满
+ */
+uint8_t Supervisor_Register(const char *Name, uint32_t Timeout)
+{
+    uint8_t id = SUPERVISOR_NONE;
+
+    Os_Critical_Enter();
+    if (Supervisor.Count < SUPERVISOR_MAX_TASKS)
+    {
+        id = Supervisor.Count;
+        Supervisor.Task[id].Name = Name;
+        Supervisor.Task[id].Timeout = Timeout;
+        Supervisor.Task[id].Tick = Os_Tick();
+        Supervisor.Count++;
+    }
+    Os_Critical_Exit();
+    return id;
+}
+
+/**
+ * @brief	按任务表创建全部任务
+ * @details	在启动调度器前调用；每个任务按表中顺序登记，任务内以 Supervisor_Self 取得任务号
+ * @param	Table 任务表
+ * @param	Count 任务数
+ * @retval	None
+ */
+void Supervisor_Create(const Supervisor_Entry *Table, uint8_t Count)
+{
+    uint8_t id;
+
+    for (uint8_t i = 0; i < Count; i++)
+    {
+        *Table[i].Handle = osThreadCreate(&Table[i].Def, Table[i].Argument);
+        id = Supervisor_Register(Table[i].Def.name, Table[i].Timeout);
+        if (id != SUPERVISOR_NONE)
+        {
+            Supervisor.Task[id].Thread = *Table[i].Handle;
+            Supervisor.Task[id].Period = Table[i].Period;
+            Supervisor.Task[id].Deadline = Table[i].Deadline;
+        }
+    }
+}
+
+/**
+ * @brief	取得调用者的任务号
+ * @details
+ * @param	None
+ * @retval	任务号，SUPERVISOR_NONE:调用者不在任务表中
+ */
+uint8_t Supervisor_Self(void)
+{
+    Os_Thread self = Os_Self();
+
+    for (uint8_t i = 0; i < Supervisor.Count; i++)
+    {
+        if (Supervisor.Task[i].Thread == self)
+        {
+            return i;
+        }
+    }
+    return SUPERVISOR_NONE;
+}
+
+/**
+ * @brief	任务心跳
+ * @details
+ * @param	Id 任务号
+ * @retval	None
+ */
+void Supervisor_Checkin(uint8_t Id)
+{
+    if (Id < Supervisor.Count)
+    {
+        Supervisor.Task[Id].Tick = Os_Tick();
+    }
+}
+
+/**
+ * @brief	任务被激活
+ * @details	任务取得事件(或周期到达)后、开始处理前调用
+ * @param	Id 任务号
+ * @retval	None
+ */
+void Supervisor_Activate(uint8_t Id)
+{
+    if (Id < Supervisor.Count)
+    {
+        Supervisor.Task[Id].Start = Os_Tick();
+        Supervisor.Task[Id].Activations++;
+    }
+}
+
+/**
+ * @brief	任务本次处理完成
+ * @details	与 Supervisor_Activate 成对调用；响应时间超出期限(无期限时为激活周期)时计一次超限
+ * @param	Id 任务号
+ * @retval	None
+ */
+void Supervisor_Complete(uint8_t Id)
+{
+    Supervisor_Task *pT;
+    uint32_t elapsed, limit;
+
+    if ((Id >= Supervisor.Count) || !Supervisor.Task[Id].Activations)
+    {
+        return;
+    }
+    pT = &Supervisor.Task[Id];
+    elapsed = Os_Tick() - pT->Start;
+    limit = pT->Deadline ? pT->Deadline : pT->Period;
+    pT->Worst = (elapsed > pT->Worst) ? (uint16_t)((elapsed > 0xFFFFU) ? 0xFFFFU : elapsed) : pT->Worst;
+    if (limit && (elapsed > limit) && (pT->Misses < 0xFFFFU))
+    {
+        pT->Misses++;
+    }
+}
+
+/**
+ * @brief	刷新全部心跳
+ * @details	调度器被长时间挂起(如透传设置)恢复后调用，避免误判为任务停滞
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Refresh(void)
+{
+    uint32_t now = Os_Tick();
+
+    for (uint8_t i = 0; i < Supervisor.Count; i++)
+    {
+        Supervisor.Task[i].Tick = now;
+    }
+}
+
+/**
+ * @brief	暂停心跳检查
+ * @details	有意挂起被监督任务(如将模块切换到命令模式)前调用，期间照常喂狗；可嵌套
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Hold(void)
+{
+    Os_Critical_Enter();
+    Supervisor.Hold++;
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	恢复心跳检查
+ * @details	与 Supervisor_Hold 成对调用，最后一次恢复时刷新全部心跳
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Release(void)
+{
+    Os_Critical_Enter();
+    if (Supervisor.Hold && (--Supervisor.Hold == 0U))
+    {
+        Supervisor_Refresh();
+    }
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	喂外部看门狗
+ * @details	每个监督周期调用一次；由各工程按看门狗的接法实现
+ * @param	Healthy false:有任务超时，应停止喂狗
+ * @retval	None
+ */
+__weak void Supervisor_Feed(bool Healthy)
+{
+    UNUSED(Healthy);
+}
+
+/**
+ * @brief	故障时驱动输出到失效安全状态
+ * @details	在故障现场复位前调用(中断已关闭)：只允许直接写寄存器，不调用内核服务；由有输出的工程实现
+ * @param	None
+ * @retval	None
+ */
+__weak void Supervisor_Safe(void)
+{
+}
+
+/**
+ * @brief	取得故障现场的任务名
+ * @details	任务控制块不在RAM内(已被破坏)时不读取，避免在故障处理中再次出错
+ * @param	Thread 故障发生在任务中(使用PSP)
+ * @retval	任务名，未知时为NULL
+ */
+static const char *Supervisor_Current(bool Thread)
+{
+    TaskHandle_t self;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+    {
+        return "main";
+    }
+    if (!Thread)
+    {
+        return "isr";
+    }
+    self = xTaskGetCurrentTaskHandle();
+    return (((uint32_t)self >= SRAM_BASE) && ((uint32_t)self < SUPERVISOR_RAM_END)) ? pcTaskGetName(self) : NULL;
+}
+
+/**
+ * @brief	写入故障记录并立即复位
+ * @details	先写记录再驱动输出：失效安全处理本身出错(锁定)时仍由外部看门狗复位，记录不丢失
+ * @param	Name 故障任务名
+ * @param	Reason 故障原因
+ * @param	Pc 故障指令地址
+ * @param	Lr 返回地址
+ * @param	Psr 程序状态
+ * @param	Sp 故障现场的栈顶
+ * @retval	None
+ */
+static void Supervisor_Record(const char *Name, uint32_t Reason, uint32_t Pc, uint32_t Lr, uint32_t Psr, uint32_t Sp)
+{
+    Supervisor_Crash *pC = Supervisor_Crash_Record;
+    uint8_t i;
+
+    __disable_irq();
+    pC->Count = (pC->Magic == SUPERVISOR_CRASH_MAGIC) ? pC->Count + 1U : 1U;
+    pC->Magic = SUPERVISOR_CRASH_MAGIC;
+    pC->Tick = HAL_GetTick();
+    pC->Reason = Reason;
+    for (i = 0; Name && Name[i] && (i < sizeof(pC->Task) - 1U); i++)
+    {
+        pC->Task[i] = Name[i];
+    }
+    pC->Task[i] = '\0';
+    pC->Pc = Pc;
+    pC->Lr = Lr;
+    pC->Psr = Psr;
+    pC->Sp = Sp;
+    pC->Cfsr = SCB->CFSR;
+    pC->Hfsr = SCB->HFSR;
+    pC->Addr = (pC->Cfsr & SCB_CFSR_BFARVALID_Msk) ? SCB->BFAR : SCB->MMFAR;
+    Supervisor_Safe();
+    NVIC_SystemReset();
+}
+
+/**
+ * @brief	当前使用的栈指针
+ * @param	None
+ * @retval	栈顶地址
+ */
+static uint32_t Supervisor_Sp(void)
+{
+    return (__get_CONTROL() & 0x02U) ? __get_PSP() : __get_MSP();
+}
+
+/**
+ * @brief	记录故障并复位
+ * @details	在栈溢出等故障现场调用，此时栈和内核对象可能已被破坏：只写复位保留的RAM，不再调用串口或内核服务
+ * @param	Name 故障任务名
+ * @param	Reason 故障原因
+ * @retval	None
+ */
+void Supervisor_Fault(const char *Name, uint32_t Reason)
+{
+    Supervisor_Record(Name, Reason, 0, SUPERVISOR_CALLER(), __get_xPSR(), Supervisor_Sp());
+}
+
+/**
+ * @brief	Error_Handler() 的处理:记录出错位置并立即复位
+ * @details	代替关中断后死循环等待外部看门狗，复位前输出已处于失效安全状态
+ * @param	Caller Error_Handler() 的返回地址(SUPERVISOR_CALLER())
+ * @retval	None
+ */
+void Supervisor_Error(uint32_t Caller)
+{
+    Supervisor_Record(Supervisor_Current((__get_CONTROL() & 0x02U) != 0U), SUPERVISOR_FAULT_ERROR, 0, Caller,
+                      __get_xPSR(), Supervisor_Sp());
+}
+
+/**
+ * @brief	故障异常的处理:从压栈的现场取出PC/LR并立即复位
+ * @details	由异常入口按 EXC_RETURN 选择MSP或PSP后跳转调用；栈指针已越出RAM(栈溢出)时不读取压栈内容
+ * @param	Frame 硬件压栈的现场(R0~R3、R12、LR、PC、xPSR)
+ * @param	Return 异常入口的LR(EXC_RETURN)
+ * @retval	None
+ */
+void Supervisor_Exception(const uint32_t *Frame, uint32_t Return)
+{
+    uint32_t addr = (uint32_t)Frame, pc = 0, lr = 0, psr = 0, sp = addr;
+
+    if ((addr >= SRAM_BASE) && (addr + 0x20U <= SUPERVISOR_RAM_END))
+    {
+        lr = Frame[5];
+        pc = Frame[6];
+        psr = Frame[7];
+        /*xPSR第9位表示压栈时为8字节对齐填充了一个字*/
+        sp = addr + 0x20U + ((psr & (1UL << 9U)) ? 4U : 0U);
+    }
+    Supervisor_Record(Supervisor_Current((Return & 0x04U) != 0U),
+                      SUPERVISOR_FAULT_EXCEPTION + (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk), pc, lr, psr, sp);
+}
+
+/*故障异常入口:不压栈，直接把异常现场的栈指针及EXC_RETURN交给 Supervisor_Exception，
+  代替CubeMX生成的死循环(.ioc中已取消生成这四个处理函数)*/
+#if defined(__CC_ARM)
+__asm void HardFault_Handler(void)
+{
+    TST LR, #4
+    ITE EQ
+    MRSEQ R0, MSP
+    MRSNE R0, PSP
+    MOV R1, LR
+    B __cpp(Supervisor_Exception)
+}
+
+__asm void MemManage_Handler(void)
+{
+    B __cpp(HardFault_Handler)
+}
+
+__asm void BusFault_Handler(void)
+{
+    B __cpp(HardFault_Handler)
+}
+
+__asm void UsageFault_Handler(void)
+{
+    B __cpp(HardFault_Handler)
+}
+#elif defined(__GNUC__)
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile("tst lr, #4\n"
+                   "ite eq\n"
+                   "mrseq r0, msp\n"
+                   "mrsne r0, psp\n"
+                   "mov r1, lr\n"
+                   "b Supervisor_Exception\n");
+}
+
+__attribute__((naked)) void MemManage_Handler(void)
+{
+    __asm volatile("b HardFault_Handler\n");
+}
+
+__attribute__((naked)) void BusFault_Handler(void)
+{
+    __asm volatile("b HardFault_Handler\n");
+}
+
+__attribute__((naked)) void UsageFault_Handler(void)
+{
+    __asm volatile("b HardFault_Handler\n");
+}
+#endif
+
+/**
+ * @brief	打印任务监督状态
+ * @details	stack 为任务栈历史最少的剩余字数(内核按0xA5填充栈后统计)，据此调整任务栈及堆的大小
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Show(void)
+{
+    uint32_t now = Os_Tick();
+
+    for (uint8_t i = 0; i < Supervisor.Count; i++)
+    {
+        Supervisor_Task *pT = &Supervisor.Task[i];
+
+        shellPrint(&shell, "%-10s period = %u ms, deadline = %u ms, worst = %u ms, misses = %u/%u, stack = %u\r\n",
+                   pT->Name, pT->Period, pT->Deadline, pT->Worst, pT->Misses, pT->Activations,
+                   pT->Thread ? (unsigned)uxTaskGetStackHighWaterMark(pT->Thread) : 0U);
+        if (pT->Timeout)
+        {
+            shellPrint(&shell, "           timeout = %u ms, last = %u ms%s\r\n", pT->Timeout, now - pT->Tick,
+                       (Supervisor.Stalled == i) ? ", stalled" : "");
+        }
+    }
+    shellPrint(&shell, "feeds = %u, heap = %u bytes free, %u min\r\n", Supervisor.Feeds, xPortGetFreeHeapSize(),
+               xPortGetMinimumEverFreeHeapSize());
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), supervisor, Supervisor_Show, show task heartbeats and deadlines);
+
+/**
+ * @brief	打印故障记录
+ * @details
+ * @param	clear 不为0时打印后清除记录
+ * @retval	None
+ */
+void Supervisor_Crash_Show(int clear)
+{
+    Supervisor_Crash *pC = Supervisor_Crash_Record;
+
+    if (!pC->Count)
+    {
+        shellPrint(&shell, "no crash recorded\r\n");
+        return;
+    }
+    shellPrint(&shell, "crashes = %u, last: %s at %u ms, reason = 0x%02x\r\n", pC->Count, pC->Task, pC->Tick, pC->Reason);
+    shellPrint(&shell, "pc = 0x%08x, lr = 0x%08x, psr = 0x%08x, sp = 0x%08x\r\n", pC->Pc, pC->Lr, pC->Psr, pC->Sp);
+    shellPrint(&shell, "cfsr = 0x%08x, hfsr = 0x%08x, addr = 0x%08x\r\n", pC->Cfsr, pC->Hfsr, pC->Addr);
+    if (clear)
+    {
+        pC->Count = 0;
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), crash, Supervisor_Crash_Show, show crash record);
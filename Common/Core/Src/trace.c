@@ -0,0 +1,401 @@
+#include "trace.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#endif
+#include "shell_port.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#if defined(USING_TRACE)
+/*测量的延迟段，起点与终点由各自的测量点记录；未经过的段(如主站独有的段)不显示*/
+static const Trace_Span Trace_Spans[] = {
+    {"edge>frame", TRACE_DI_EDGE, TRACE_DI_FRAME},
+    {"idle>wake", TRACE_UART_IDLE, TRACE_MODBUS_WAKE},
+    {"idle>relay", TRACE_UART_IDLE, TRACE_RELAY},
+    {"modbus", TRACE_MODBUS_BEGIN, TRACE_MODBUS_END},
+    {"poll", TRACE_POLL_BEGIN, TRACE_POLL_END},
+    {"di", TRACE_DI_BEGIN, TRACE_DI_END},
+    {"do", TRACE_DO_BEGIN, TRACE_DO_END},
+};
+#define TRACE_SPANS (sizeof(Trace_Spans) / sizeof(Trace_Spans[0]))
+typedef char Trace_Spans_Fit[(TRACE_SPANS <= TRACE_SPAN_MAX) ? 1 : -1];
+
+static Trace_HandleTypeDef Trace;
+static Trace_TriggerTypeDef Trigger;
+/*冻结区不在任何链接区内，复位后其内容保持不变*/
+#define Trace_Hold_Record ((Trace_Hold *)TRACE_HOLD_ADDR)
+typedef char Trace_Hold_Check[(sizeof(Trace_Hold) <= TRACE_HOLD_SIZE) ? 1 : -1];
+typedef char Trace_Window_Check[(TRACE_HOLD_RECORDS <= TRACE_RING_SIZE) ? 1 : -1];
+
+/**
+ * @brief	启动DWT周期计数器
+ * @details	只使能计数，不清零(运行统计同样使用该计数器)；计数约59s回绕一次，只使用差值。
+ *			冻结区中已有复位前的记录时不启用触发，以免覆盖
+ * @param	None
+ * @retval	None
+ */
+void Trace_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    Trigger.Armed = (Trace_Hold_Record->Magic != TRACE_HOLD_MAGIC);
+}
+/*DWT计数在最先的中断中就可能被读取；从站在 main() 中直接调用 Trace_Init*/
+#if !defined(USING_SLAVE)
+BOOT_MODULE(trace, BOOT_LEVEL_MAIN, Trace_Init, "");
+#endif
+
+/**
+ * @brief	写入最近事件环
+ * @details	在关中断时调用
+ * @param	Id 测量点
+ * @param	Now 周期计数
+ * @retval	None
+ */
+static void Trace_Put(uint8_t Id, uint32_t Now)
+{
+    Trace.Ring[Trace.Head % TRACE_RING_SIZE].Cycles = Now;
+    Trace.Ring[Trace.Head % TRACE_RING_SIZE].Id = Id;
+    Trace.Head++;
+}
+
+/**
+ * @brief	触发条件成立
+ * @details	在关中断时调用；只有首个成立的条件生效，事件环中记下触发位置，再等待触发后的记录
+ * @param	Index 触发条件号
+ * @param	Value 触发值
+ * @param	Now 周期计数
+ * @retval	None
+ */
+static void Trace_Fire(uint8_t Index, uint32_t Value, uint32_t Now)
+{
+    if (!Trigger.Armed)
+    {
+        return;
+    }
+    Trigger.Armed = false;
+    Trigger.Pending = true;
+    Trigger.Index = Index;
+    Trigger.Value = Value;
+    Trigger.Tick = HAL_GetTick();
+    Trace_Put(TRACE_TRIGGER, Now);
+    Trigger.Fired = Trace.Head;
+}
+
+/**
+ * @brief	把触发前后的记录冻结到冻结区
+ * @details	在关中断时调用，触发后的记录已满 TRACE_POST 条；事件环在冻结后照常覆盖
+ * @param	None
+ * @retval	None
+ */
+static void Trace_Freeze(void)
+{
+    Trace_Hold *pH = Trace_Hold_Record;
+    uint32_t start = Trigger.Fired - ((Trigger.Fired > TRACE_PRE) ? TRACE_PRE : Trigger.Fired);
+
+    pH->Tick = Trigger.Tick;
+    pH->Value = Trigger.Value;
+    pH->Index = Trigger.Index;
+    pH->Type = Trigger.Trig[Trigger.Index].Type;
+    pH->Arg = Trigger.Trig[Trigger.Index].Arg;
+    pH->Pre = (uint8_t)(Trigger.Fired - start);
+    pH->Count = (uint8_t)(Trace.Head - start);
+    for (uint8_t i = 0; i < pH->Count; i++)
+    {
+        pH->Cycles[i] = Trace.Ring[(start + i) % TRACE_RING_SIZE].Cycles;
+        pH->Id[i] = Trace.Ring[(start + i) % TRACE_RING_SIZE].Id;
+    }
+    pH->Magic = TRACE_HOLD_MAGIC;
+    Trigger.Pending = false;
+}
+
+/**
+ * @brief	检查与测量点无关的触发条件
+ * @details	在关中断时调用；监视的计数器在下一个测量点才被发现，触发前的记录同样完整
+ * @param	Now 周期计数
+ * @retval	None
+ */
+static void Trace_Check(uint32_t Now)
+{
+    uint32_t count;
+
+    for (uint8_t k = TRACE_TRIG_CRC; k <= TRACE_TRIG_QUEUE; k++)
+    {
+        if (Trigger.Watch[k] == NULL)
+        {
+            continue;
+        }
+        count = *Trigger.Watch[k];
+        /*计数被清零时只重新同步*/
+        if ((int32_t)(count - Trigger.Seen[k]) > 0)
+        {
+            for (uint8_t i = 0; i < TRACE_TRIGGERS; i++)
+            {
+                if (Trigger.Trig[i].Type == k)
+                {
+                    Trace_Fire(i, count, Now);
+                }
+            }
+        }
+        Trigger.Seen[k] = count;
+    }
+    for (uint8_t i = 0; (i < TRACE_TRIGGERS) && Trigger.Armed; i++)
+    {
+        if ((Trigger.Trig[i].Type == TRACE_TRIG_HEAP) && (xPortGetFreeHeapSize() < Trigger.Trig[i].Threshold))
+        {
+            Trace_Fire(i, xPortGetFreeHeapSize(), Now);
+        }
+    }
+}
+
+/**
+ * @brief	记录一个测量点
+ * @details	中断及任务中均可调用，关中断约数十个周期：写入最近事件环，
+ *			作为起点时刷新各段的起点时刻，作为终点时把延迟计入直方图；
+ *			附带的参数及数值供触发条件判断(如往返时间的从站号及毫秒数)
+ * @param	Id 测量点
+ * @param	Arg 参数
+ * @param	Value 数值
+ * @retval	None
+ */
+void Trace_Value(Trace_Event Id, uint8_t Arg, uint32_t Value)
+{
+    uint32_t primask = __get_PRIMASK(), now, span, us;
+    uint8_t bin;
+
+    __disable_irq();
+    now = DWT->CYCCNT;
+    Trace_Put((uint8_t)Id, now);
+    for (uint8_t i = 0; i < TRACE_SPANS; i++)
+    {
+        if (Trace_Spans[i].Start == Id)
+        {
+            Trace.Stamp[i] = now;
+            Trace.Open |= 1UL << i;
+        }
+        else if ((Trace_Spans[i].End == Id) && (Trace.Open & (1UL << i)))
+        {
+            Trace.Open &= ~(1UL << i);
+            span = now - Trace.Stamp[i];
+            us = span / (SystemCoreClock / 1000000U);
+            bin = (uint8_t)(32U - __CLZ(us));
+            Trace.Bins[i][(bin < TRACE_BINS) ? bin : (TRACE_BINS - 1U)]++;
+            Trace.Max[i] = (span > Trace.Max[i]) ? span : Trace.Max[i];
+            Trace.Count[i]++;
+            for (uint8_t k = 0; k < TRACE_TRIGGERS; k++)
+            {
+                if ((Trigger.Trig[k].Type == TRACE_TRIG_SPAN) && (Trigger.Trig[k].Arg == i) &&
+                    (us > Trigger.Trig[k].Threshold))
+                {
+                    Trace_Fire(k, us, now);
+                }
+            }
+        }
+    }
+    for (uint8_t k = 0; (Id == TRACE_RTT) && (k < TRACE_TRIGGERS); k++)
+    {
+        if ((Trigger.Trig[k].Type == TRACE_TRIG_RTT) && ((Trigger.Trig[k].Arg == 0U) || (Trigger.Trig[k].Arg == Arg)) &&
+            (Value > Trigger.Trig[k].Threshold))
+        {
+            Trace_Fire(k, Value, now);
+        }
+    }
+    Trace_Check(now);
+    if (Trigger.Pending && (Trace.Head - Trigger.Fired >= TRACE_POST))
+    {
+        Trace_Freeze();
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	记录一个测量点
+ * @details	不附带参数的测量点
+ * @param	Id 测量点
+ * @retval	None
+ */
+void Trace_Point(Trace_Event Id)
+{
+    Trace_Value(Id, 0, 0);
+}
+
+/**
+ * @brief	登记一个监视的计数器
+ * @details	计数器自由计数(由其所在模块递增)，在测量点中比较，增加时满足同类型的触发条件
+ * @param	Type 触发类型(TRACE_TRIG_CRC 或 TRACE_TRIG_QUEUE)
+ * @param	pCounter 计数器
+ * @retval	None
+ */
+void Trace_Watch(Trace_Trig_Type Type, const volatile uint32_t *pCounter)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if ((Type < TRACE_TRIG_CRC) || (Type > TRACE_TRIG_QUEUE))
+    {
+        return;
+    }
+    __disable_irq();
+    Trigger.Watch[Type] = pCounter;
+    Trigger.Seen[Type] = (pCounter != NULL) ? *pCounter : 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	设置一个触发条件
+ * @details	类型为0时清除该条件；设置后须 trace_arm 才会在已冻结之后再次触发
+ * @param	index 触发条件号
+ * @param	type 类型(Trace_Trig_Type)
+ * @param	arg 参数(段号或从站号)
+ * @param	threshold 阈值(us、ms或字节)
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Trace_Trigger_Set(int index, int type, int arg, int threshold)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if ((index < 0) || (index >= (int)TRACE_TRIGGERS) || (type < 0) || (type >= (int)TRACE_TRIGS) || (arg < 0) ||
+        (arg > 0xFF) || (threshold < 0) || ((type == TRACE_TRIG_SPAN) && (arg >= (int)TRACE_SPANS)))
+    {
+        return 0xFF;
+    }
+    __disable_irq();
+    Trigger.Trig[index].Type = (uint8_t)type;
+    Trigger.Trig[index].Arg = (uint8_t)arg;
+    Trigger.Trig[index].Threshold = (uint32_t)threshold;
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace_trig, Trace_Trigger_Set, set trigger index type arg threshold);
+
+/**
+ * @brief	重新启用触发
+ * @details	丢弃冻结的记录；触发条件成立前事件环照常覆盖
+ * @param	None
+ * @retval	None
+ */
+void Trace_Arm(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Trace_Hold_Record->Magic = 0;
+    Trigger.Pending = false;
+    Trigger.Armed = true;
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace_arm, Trace_Arm, arm trace triggers);
+
+/**
+ * @brief	打印触发条件及冻结的记录
+ * @details	记录按时间顺序给出测量点及相对上一事件的间隔(us)，触发位置标为 *
+ * @param	None
+ * @retval	None
+ */
+void Trace_Hold_Show(void)
+{
+    Trace_Hold *pH = Trace_Hold_Record;
+    uint32_t mhz = SystemCoreClock / 1000000U;
+
+    for (uint8_t i = 0; i < TRACE_TRIGGERS; i++)
+    {
+        if (Trigger.Trig[i].Type != TRACE_TRIG_NONE)
+        {
+            shellPrint(&shell, "[%d] type = %u, arg = %u, threshold = %u\r\n", i, Trigger.Trig[i].Type, Trigger.Trig[i].Arg,
+                       Trigger.Trig[i].Threshold);
+        }
+    }
+    if (pH->Magic != TRACE_HOLD_MAGIC)
+    {
+        shellPrint(&shell, "%s\r\n", Trigger.Pending ? "triggered, waiting for post records" : (Trigger.Armed ? "armed" : "idle"));
+        return;
+    }
+    shellPrint(&shell, "trigger %u: type = %u, arg = %u, value = %u at %u ms\r\n", pH->Index, pH->Type, pH->Arg, pH->Value,
+               pH->Tick);
+    for (uint8_t i = 0; (i < pH->Count) && (i < TRACE_HOLD_RECORDS); i++)
+    {
+        shellPrint(&shell, "%c%2d +%uus\r\n", (i + 1U == pH->Pre) ? '*' : ' ', pH->Id[i],
+                   i ? (pH->Cycles[i] - pH->Cycles[i - 1U]) / mhz : 0U);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace_hold, Trace_Hold_Show, show frozen trace records);
+
+/**
+ * @brief	打印各段延迟的直方图
+ * @details	每格给出上限(us)及样本数，空格不打印
+ * @param	None
+ * @retval	None
+ */
+void Trace_Show(void)
+{
+    uint32_t mhz = SystemCoreClock / 1000000U;
+
+    for (uint8_t i = 0; i < TRACE_SPANS; i++)
+    {
+        if (Trace.Count[i] == 0U)
+        {
+            continue;
+        }
+        shellPrint(&shell, "%-10s n = %u, max = %uus\r\n ", Trace_Spans[i].Name, Trace.Count[i], Trace.Max[i] / mhz);
+        for (uint8_t k = 0; k < TRACE_BINS; k++)
+        {
+            if (Trace.Bins[i][k])
+            {
+                shellPrint(&shell, (k == TRACE_BINS - 1U) ? " >=%u:%u" : " <%u:%u", 1UL << ((k == TRACE_BINS - 1U) ? k - 1U : k),
+                           Trace.Bins[i][k]);
+            }
+        }
+        shellPrint(&shell, "\r\n");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace, Trace_Show, show latency histograms);
+
+/**
+ * @brief	打印最近的事件
+ * @details	按时间顺序给出测量点及相对上一事件的间隔(us)
+ * @param	None
+ * @retval	None
+ */
+void Trace_Log(void)
+{
+    uint32_t head = Trace.Head, mhz = SystemCoreClock / 1000000U;
+    uint32_t i = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+    uint32_t last = Trace.Ring[i % TRACE_RING_SIZE].Cycles;
+
+    for (; i < head; i++)
+    {
+        shellPrint(&shell, "%2d +%uus\r\n", Trace.Ring[i % TRACE_RING_SIZE].Id,
+                   (Trace.Ring[i % TRACE_RING_SIZE].Cycles - last) / mhz);
+        last = Trace.Ring[i % TRACE_RING_SIZE].Cycles;
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace_log, Trace_Log, show recent trace points);
+
+/**
+ * @brief	清除直方图及事件环
+ * @details	每次调整前后各测量一轮，便于对比；触发条件及冻结的记录不变
+ * @param	None
+ * @retval	None
+ */
+void Trace_Clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    memset(&Trace, 0, sizeof(Trace));
+    /*已触发时触发前的记录随事件环一起清除*/
+    Trigger.Fired = 0;
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trace_clear, Trace_Clear, clear latency histograms);
+#else
+void Trace_Init(void)
+{
+}
+
+void Trace_Watch(Trace_Trig_Type Type, const volatile uint32_t *pCounter)
+{
+    UNUSED(Type);
+    UNUSED(pCounter);
+}
+#endif
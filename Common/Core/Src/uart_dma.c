@@ -0,0 +1,410 @@
+#include "uart_dma.h"
+#include "trace.h"
+
+/*已注册的DMA串口，HAL回调按串口句柄分发*/
+static UartDma_HandleTypeDef *Uart_Dma_Ports[UART_DMA_MAX_PORTS];
+static uint8_t Uart_Dma_Count = 0;
+
+/**
+ * @brief	查找HAL串口对应的驱动句柄
+ * @details
+ * @param	port HAL串口句柄
+ * @retval	未注册时返回 NULL
+ */
+static UartDma_HandleTypeDef *Uart_Dma_Find(UART_HandleTypeDef *port)
+{
+    for (uint8_t i = 0; i < Uart_Dma_Count; i++)
+    {
+        if (Uart_Dma_Ports[i]->huart == port)
+        {
+            return Uart_Dma_Ports[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief	初始化DMA串口并启动循环接收
+ * @details	接收DMA需配置为 DMA_CIRCULAR，整个接收过程中不再停止及重启DMA
+ * @param	huart 驱动句柄
+ * @param	port HAL串口句柄
+ * @param	pBuf 接收环
+ * @param	Size 接收环长度
+ * @retval	true:成功
+ */
+bool Uart_Dma_Init(UartDma_HandleTypeDef *huart, UART_HandleTypeDef *port, uint8_t *pBuf, uint16_t Size)
+{
+    if ((huart == NULL) || (Uart_Dma_Find(port) == NULL && Uart_Dma_Count >= UART_DMA_MAX_PORTS))
+    {
+        return false;
+    }
+    huart->huart = port;
+    huart->Rx.pBuf = pBuf;
+    huart->Rx.Size = Size;
+    huart->Tx.Head = huart->Tx.Tail = 0;
+    huart->Tx.Busy = false;
+    if (Uart_Dma_Find(port) == NULL)
+    {
+        Uart_Dma_Ports[Uart_Dma_Count++] = huart;
+    }
+    return Uart_Dma_Rx_Start(huart);
+}
+
+/**
+ * @brief	注册接收回调
+ * @details	Notify 为 NULL 时接收回调直接在中断中执行；否则中断只发布(起始位置,长度)接收段并通知，
+ *			由任务调用 Uart_Dma_Rx_Dispatch 在任务上下文中执行接收回调。未注册回调时收到的数据被丢弃
+ * @param	huart 驱动句柄
+ * @param	Event 接收回调
+ * @param	Notify 接收通知
+ * @param	Arg 回调私有参数
+ * @retval	None
+ */
+void Uart_Dma_Attach(UartDma_HandleTypeDef *huart, UartDma_RxEvent Event, UartDma_RxNotify Notify, void *Arg)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    huart->Rx.Arg = Arg;
+    huart->Rx.Event = Event;
+    huart->Rx.Notify = Notify;
+    huart->Rx.Span_Tail = huart->Rx.Span_Head;
+    huart->Rx.Pending = 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	启动循环接收
+ * @details	从接收环起始处开始接收，并打开空闲中断
+ * @param	huart 驱动句柄
+ * @retval	true:成功
+ */
+bool Uart_Dma_Rx_Start(UartDma_HandleTypeDef *huart)
+{
+    huart->Rx.Read = 0;
+    if (HAL_UART_Receive_DMA(huart->huart, huart->Rx.pBuf, huart->Rx.Size) != HAL_OK)
+    {
+        return false;
+    }
+    __HAL_UART_CLEAR_IDLEFLAG(huart->huart);
+    __HAL_UART_ENABLE_IT(huart->huart, UART_IT_IDLE);
+    return true;
+}
+
+/**
+ * @brief	停止接收
+ * @details	仅停止接收DMA，发送不受影响
+ * @param	huart 驱动句柄
+ * @retval	None
+ */
+void Uart_Dma_Rx_Stop(UartDma_HandleTypeDef *huart)
+{
+    __HAL_UART_DISABLE_IT(huart->huart, UART_IT_IDLE);
+    HAL_UART_AbortReceive(huart->huart);
+}
+
+/**
+ * @brief	交付一个接收段
+ * @details	中断中调用；任务模式下只记录(起始位置,长度)，任务来不及处理(段队列满或积压超过接收环)时计入溢出
+ * @param	huart 驱动句柄
+ * @param	Start 接收环内起始位置
+ * @param	Length 长度
+ * @param	Event 接收事件
+ * @retval	None
+ */
+static void Uart_Dma_Rx_Publish(UartDma_HandleTypeDef *huart, uint16_t Start, uint16_t Length, uint8_t Event)
+{
+    UartDma_Span *pSpan;
+
+    if (huart->Rx.Event == NULL)
+    {
+        return;
+    }
+    if (huart->Rx.Notify == NULL)
+    {
+        huart->Rx.Event(huart, &huart->Rx.pBuf[Start], Length, Event);
+        return;
+    }
+    if (((huart->Rx.Span_Head - huart->Rx.Span_Tail) >= UART_DMA_RX_SPANS) ||
+        (huart->Rx.Pending + Length > huart->Rx.Size))
+    {
+        huart->Rx.Overrun++;
+        return;
+    }
+    pSpan = &huart->Rx.Spans[huart->Rx.Span_Head % UART_DMA_RX_SPANS];
+    pSpan->Start = Start;
+    pSpan->Length = Length;
+    pSpan->Event = Event;
+    huart->Rx.Pending += Length;
+    huart->Rx.Span_Head++;
+}
+
+/**
+ * @brief	把接收环中新收到的数据交给上层
+ * @details	中断中调用；环回绕时分两段交付，事件标志只随最后一段交付
+ * @param	huart 驱动句柄
+ * @param	Event 接收事件
+ * @retval	None
+ */
+static void Uart_Dma_Rx_Process(UartDma_HandleTypeDef *huart, uint8_t Event)
+{
+    uint16_t write = huart->Rx.Size - (uint16_t)__HAL_DMA_GET_COUNTER(huart->huart->hdmarx);
+    uint16_t read = huart->Rx.Read;
+    uint32_t head = huart->Rx.Span_Head;
+
+    write = (write < huart->Rx.Size) ? write : 0U;
+    if (write < read)
+    {
+        Uart_Dma_Rx_Publish(huart, read, huart->Rx.Size - read, 0U);
+        read = 0;
+    }
+    if ((write != read) || (Event & UART_DMA_EVENT_IDLE))
+    {
+        Uart_Dma_Rx_Publish(huart, read, write - read, Event);
+    }
+    huart->Rx.Read = write;
+    if ((huart->Rx.Notify) && (Event != 0U) && (huart->Rx.Span_Head != head))
+    {
+        huart->Rx.Notify(huart, Event);
+    }
+}
+
+/**
+ * @brief	在中断外取走已收到的数据
+ * @details	供定时器成帧等需要在空闲中断之外读取接收进度的场合使用
+ * @param	huart 驱动句柄
+ * @retval	None
+ */
+void Uart_Dma_Rx_Poll(UartDma_HandleTypeDef *huart)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Uart_Dma_Rx_Process(huart, 0U);
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	在任务中处理已发布的接收段
+ * @details	依次对每个接收段调用接收回调；数据在接收环内原地使用，需在DMA绕回覆盖前处理完
+ * @param	huart 驱动句柄
+ * @retval	处理的接收段数
+ */
+uint32_t Uart_Dma_Rx_Dispatch(UartDma_HandleTypeDef *huart)
+{
+    uint32_t count = 0, primask;
+    UartDma_Span span;
+
+    while (huart->Rx.Span_Tail != huart->Rx.Span_Head)
+    {
+        span = huart->Rx.Spans[huart->Rx.Span_Tail % UART_DMA_RX_SPANS];
+        if (huart->Rx.Event)
+        {
+            huart->Rx.Event(huart, &huart->Rx.pBuf[span.Start], span.Length, span.Event);
+        }
+        primask = __get_PRIMASK();
+        __disable_irq();
+        huart->Rx.Pending -= span.Length;
+        huart->Rx.Span_Tail++;
+        __set_PRIMASK(primask);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief	结束一段发送
+ * @details	组内最后一段结束时回调发送者
+ * @param	huart 驱动句柄
+ * @param	Sent 是否已发出
+ * @retval	None
+ */
+static void Uart_Dma_Tx_Release(UartDma_HandleTypeDef *huart, bool Sent)
+{
+    UartDma_Segment *pSeg = &huart->Tx.Queue[huart->Tx.Tail % UART_DMA_TX_SEGMENTS];
+
+    huart->Tx.Tail++;
+    if (pSeg->Last && pSeg->Done)
+    {
+        pSeg->Done(pSeg->Arg, Sent);
+    }
+}
+
+/**
+ * @brief	启动下一发送段
+ * @details	调用者需处于临界区或中断中；启动失败的段被丢弃
+ * @param	huart 驱动句柄
+ * @retval	None
+ */
+static void Uart_Dma_Tx_Start(UartDma_HandleTypeDef *huart)
+{
+    UartDma_Segment *pSeg;
+
+    while ((!huart->Tx.Busy) && (huart->Tx.Tail != huart->Tx.Head))
+    {
+        pSeg = &huart->Tx.Queue[huart->Tx.Tail % UART_DMA_TX_SEGMENTS];
+        huart->Tx.Busy = true;
+        if (HAL_UART_Transmit_DMA(huart->huart, (uint8_t *)pSeg->pData, pSeg->Length) != HAL_OK)
+        {
+            huart->Tx.Busy = false;
+            huart->Tx.Dropped++;
+            Uart_Dma_Tx_Release(huart, false);
+        }
+    }
+}
+
+/**
+ * @brief	一组发送段整体入队
+ * @details	任务或中断上下文均可调用；队列空间不足时整组丢弃
+ * @param	huart 驱动句柄
+ * @param	pSeg 发送段
+ * @param	Count 段数
+ * @retval	true:已入队
+ */
+bool Uart_Dma_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if ((Count == 0U) || (Count > UART_DMA_TX_SEGMENTS - (huart->Tx.Head - huart->Tx.Tail)))
+    {
+        huart->Tx.Dropped++;
+        __set_PRIMASK(primask);
+        return false;
+    }
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        huart->Tx.Queue[huart->Tx.Head++ % UART_DMA_TX_SEGMENTS] = pSeg[i];
+    }
+    Uart_Dma_Tx_Start(huart);
+    __set_PRIMASK(primask);
+    return true;
+}
+
+/**
+ * @brief	丢弃所有未发送的段
+ * @details	正在发送的段被停止，每组均以 Sent=false 回调发送者
+ * @param	huart 驱动句柄
+ * @retval	None
+ */
+void Uart_Dma_Tx_Abort(UartDma_HandleTypeDef *huart)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (huart->Tx.Busy)
+    {
+        HAL_UART_AbortTransmit(huart->huart);
+        huart->Tx.Busy = false;
+    }
+    while (huart->Tx.Tail != huart->Tx.Head)
+    {
+        Uart_Dma_Tx_Release(huart, false);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	串口中断前置处理
+ * @details	在 USARTx_IRQHandler 中先于 HAL_UART_IRQHandler 调用，处理空闲事件(不停止DMA)
+ * @param	huart 驱动句柄
+ * @retval	None
+ */
+void Uart_Dma_IRQHandler(UartDma_HandleTypeDef *huart)
+{
+    if ((__HAL_UART_GET_FLAG(huart->huart, UART_FLAG_IDLE) != RESET) &&
+        (__HAL_UART_GET_IT_SOURCE(huart->huart, UART_IT_IDLE) != RESET))
+    {
+        __HAL_UART_CLEAR_IDLEFLAG(huart->huart);
+        TRACE(TRACE_UART_IDLE);
+        Uart_Dma_Rx_Process(huart, UART_DMA_EVENT_IDLE);
+    }
+}
+
+/**
+ * @brief	是否还有交给 HAL_UART_IRQHandler 处理的事件
+ * @details	空闲事件已在 Uart_Dma_IRQHandler 中处理；只剩空闲事件时(最常见的情况)不再进入HAL的中断状态机。
+ *          错误标志不论是否使能中断都交给HAL，由HAL决定是否处理
+ * @param	huart 驱动句柄
+ * @retval	true 须调用 HAL_UART_IRQHandler
+ */
+bool Uart_Dma_Hal_Pending(UartDma_HandleTypeDef *huart)
+{
+    uint32_t sr = huart->huart->Instance->SR, cr1 = huart->huart->Instance->CR1;
+
+    return ((sr & (USART_SR_PE | USART_SR_FE | USART_SR_NE | USART_SR_ORE)) != 0U) ||
+           ((sr & USART_SR_RXNE) && (cr1 & USART_CR1_RXNEIE)) || ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE)) ||
+           ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE));
+}
+
+/**
+ * @brief	串口发送完成回调(DMA传输结束且TC置位)
+ * @details
+ * @param	port HAL串口句柄
+ * @retval	None
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *port)
+{
+    UartDma_HandleTypeDef *huart = Uart_Dma_Find(port);
+
+    if ((huart == NULL) || (!huart->Tx.Busy))
+    {
+        return;
+    }
+    huart->Tx.Busy = false;
+    Uart_Dma_Tx_Release(huart, true);
+    Uart_Dma_Tx_Start(huart);
+}
+
+/**
+ * @brief	DMA接收半满回调
+ * @details
+ * @param	port HAL串口句柄
+ * @retval	None
+ */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *port)
+{
+    UartDma_HandleTypeDef *huart = Uart_Dma_Find(port);
+
+    if (huart)
+    {
+        Uart_Dma_Rx_Process(huart, UART_DMA_EVENT_HALF);
+    }
+}
+
+/**
+ * @brief	DMA接收全满回调(循环模式下DMA自动回到接收环起始处)
+ * @details
+ * @param	port HAL串口句柄
+ * @retval	None
+ */
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *port)
+{
+    UartDma_HandleTypeDef *huart = Uart_Dma_Find(port);
+
+    if (huart)
+    {
+        Uart_Dma_Rx_Process(huart, UART_DMA_EVENT_FULL);
+    }
+}
+
+/**
+ * @brief	串口错误回调
+ * @details	溢出、噪声或帧错误时HAL会停止接收DMA，此处交付已收到的数据后重新启动循环接收
+ * @param	port HAL串口句柄
+ * @retval	None
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *port)
+{
+    UartDma_HandleTypeDef *huart = Uart_Dma_Find(port);
+
+    if ((huart == NULL) || (port->RxState != HAL_UART_STATE_READY))
+    {
+        return;
+    }
+    if (__HAL_UART_GET_IT_SOURCE(port, UART_IT_IDLE) != RESET)
+    {
+        Uart_Dma_Rx_Process(huart, UART_DMA_EVENT_IDLE);
+        Uart_Dma_Rx_Start(huart);
+    }
+}
@@ -0,0 +1,297 @@
+#include "utimer.h"
+#if !defined(USING_SLAVE)
+#include "boot.h"
+#include "io_uart.h"
+#endif
+#include "shell_port.h"
+
+#if defined(USING_UTIMER)
+#if !defined(USING_SLAVE) && defined(USING_IO_UART) && !defined(USING_SUART_EDGE_RX)
+#error "USING_UTIMER shares TIM4 with the soft uart edge timebase, enable USING_SUART_EDGE_RX"
+#endif
+
+/*shell中列出的定时器数*/
+#define UTIMER_SHOW_MAX 8U
+
+static Utimer_HandleTypeDef Utimer_Mgr;
+
+/**
+ * @brief	读取32位微秒计数
+ * @details	关中断调用；溢出标志已置位而中断尚未处理时计数已回绕，高位补一
+ * @param	None
+ * @retval	当前时刻(us)
+ */
+static uint32_t Utimer_Count(void)
+{
+    uint32_t high = Utimer_Mgr.High, cnt = UTIMER_TIM->CNT;
+
+    if ((UTIMER_TIM->SR & TIM_SR_UIF) && (cnt < 0x8000U))
+    {
+        high += 0x10000U;
+    }
+    return high | cnt;
+}
+
+/**
+ * @brief	按链首的到期时刻设置比较中断
+ * @details	关中断调用；一个计数周期以后才到期的不设比较，由溢出中断再次检查；
+ *			写入比较值前计数已越过到期时刻时由软件产生比较事件
+ * @param	None
+ * @retval	None
+ */
+static void Utimer_Arm(void)
+{
+    Utimer *pT = Utimer_Mgr.Head;
+
+    if ((pT == NULL) || ((int32_t)(pT->Due - Utimer_Count()) > 0xFFFF))
+    {
+        UTIMER_TIM->DIER &= ~UTIMER_IT_CC;
+        return;
+    }
+    UTIMER_TIM->UTIMER_CCR = (uint16_t)pT->Due;
+    UTIMER_TIM->SR = ~UTIMER_SR_CC;
+    UTIMER_TIM->DIER |= UTIMER_IT_CC;
+    Utimer_Mgr.Armed++;
+    if ((int32_t)(pT->Due - Utimer_Count()) <= 0)
+    {
+        UTIMER_TIM->EGR = UTIMER_EGR_CC;
+    }
+}
+
+/**
+ * @brief	按到期时刻插入定时器链
+ * @details	关中断调用；到期时刻相同的排在后面，按启动顺序回调
+ * @param	pT 定时器
+ * @retval	None
+ */
+static void Utimer_Insert(Utimer *pT)
+{
+    Utimer **pp = &Utimer_Mgr.Head;
+
+    while ((*pp != NULL) && ((int32_t)((*pp)->Due - pT->Due) <= 0))
+    {
+        pp = &(*pp)->Next;
+    }
+    pT->Next = *pp;
+    *pp = pT;
+    pT->Active = true;
+}
+
+/**
+ * @brief	从定时器链中取下
+ * @details	关中断调用
+ * @param	pT 定时器
+ * @retval	None
+ */
+static void Utimer_Remove(Utimer *pT)
+{
+    for (Utimer **pp = &Utimer_Mgr.Head; *pp != NULL; pp = &(*pp)->Next)
+    {
+        if (*pp == pT)
+        {
+            *pp = pT->Next;
+            break;
+        }
+    }
+    pT->Next = NULL;
+    pT->Active = false;
+}
+
+/**
+ * @brief	启动微秒时间基准
+ * @details	主站的TIM4已由 MX_TIM4_Init 按1us计数，由启动模块调用；从站在 MX_TIM2_Init 及 Irq_Priority_Init
+ *			之后调用。满量程自由运行，只开溢出中断，比较中断按需开启
+ * @param	None
+ * @retval	None
+ */
+void Utimer_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    UTIMER_TIM->ARR = 0xFFFFU;
+    UTIMER_TIM->DIER &= ~UTIMER_IT_CC;
+    UTIMER_TIM->SR = ~(TIM_SR_UIF | UTIMER_SR_CC);
+    UTIMER_TIM->DIER |= TIM_DIER_UIE;
+    UTIMER_TIM->CR1 |= TIM_CR1_CEN;
+    __set_PRIMASK(primask);
+}
+#if !defined(USING_SLAVE)
+BOOT_MODULE(utimer, BOOT_LEVEL_MAIN, Utimer_Init, "irq");
+#endif
+
+/**
+ * @brief	当前时刻
+ * @details	中断及任务中均可调用，约71分钟回绕，时刻之差按有符号数比较
+ * @param	None
+ * @retval	当前时刻(us)
+ */
+uint32_t Utimer_Now(void)
+{
+    uint32_t primask = __get_PRIMASK(), now;
+
+    __disable_irq();
+    now = Utimer_Count();
+    __set_PRIMASK(primask);
+    return now;
+}
+
+/**
+ * @brief	在指定时刻启动定时器
+ * @details	中断及任务中均可调用；已在运行的定时器按新时刻重新启动；成为最近的到期时刻时重设比较中断。
+ *			同一时刻起算的多个定时器(如t1.5与t3.5)用此接口，间隔不受调用先后影响
+ * @param	pT 定时器(Func 已设置)
+ * @param	Due 到期时刻(us，Utimer_Now() 加延时)
+ * @param	Period 周期(us)，0为单次
+ * @retval	None
+ */
+void Utimer_Start_At(Utimer *pT, uint32_t Due, uint32_t Period)
+{
+    uint32_t primask;
+
+    if ((pT == NULL) || (pT->Func == NULL))
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (pT->Active)
+    {
+        Utimer_Remove(pT);
+    }
+    pT->Due = Due;
+    pT->Period = (Period > UTIMER_MAX) ? UTIMER_MAX : Period;
+    Utimer_Insert(pT);
+    if (Utimer_Mgr.Head == pT)
+    {
+        Utimer_Arm();
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	启动定时器
+ * @param	pT 定时器(Func 已设置)
+ * @param	Us 延时(us)，不超过 UTIMER_MAX
+ * @param	Period 周期(us)，0为单次
+ * @retval	None
+ */
+void Utimer_Start(Utimer *pT, uint32_t Us, uint32_t Period)
+{
+    Utimer_Start_At(pT, Utimer_Now() + ((Us > UTIMER_MAX) ? UTIMER_MAX : Us), Period);
+}
+
+/**
+ * @brief	停止定时器
+ * @details	中断及任务中均可调用，未运行时无动作；停止的是链首时改为对准下一个到期时刻
+ * @param	pT 定时器
+ * @retval	None
+ */
+void Utimer_Stop(Utimer *pT)
+{
+    uint32_t primask;
+    bool head;
+
+    if (pT == NULL)
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (pT->Active)
+    {
+        head = (Utimer_Mgr.Head == pT);
+        Utimer_Remove(pT);
+        if (head)
+        {
+            Utimer_Arm();
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	定时器(UTIMER_TIM)中断
+ * @details	在 TIM4_IRQHandler(主站)或 TIM2_IRQHandler(从站)中直接调用，不经过 HAL_TIM_IRQHandler 的分发：
+ *			溢出时递增高位，然后依次取下到期的定时器并回调(回调在开中断下执行，可以启动或停止定时器)，
+ *			周期定时器在回调前按周期重新挂入；最后按新的链首设置比较中断
+ * @param	None
+ * @retval	None
+ */
+void Utimer_IRQHandler(void)
+{
+    Utimer *pT;
+    uint32_t primask = __get_PRIMASK(), now, late;
+
+    __disable_irq();
+    if (UTIMER_TIM->SR & TIM_SR_UIF)
+    {
+        UTIMER_TIM->SR = ~TIM_SR_UIF;
+        Utimer_Mgr.High += 0x10000U;
+    }
+    UTIMER_TIM->SR = ~UTIMER_SR_CC;
+    for (;;)
+    {
+        pT = Utimer_Mgr.Head;
+        now = Utimer_Count();
+        if ((pT == NULL) || ((int32_t)(pT->Due - now) > 0))
+        {
+            break;
+        }
+        Utimer_Mgr.Head = pT->Next;
+        pT->Next = NULL;
+        pT->Active = false;
+        late = now - pT->Due;
+        if (pT->Period)
+        {
+            pT->Due += pT->Period;
+            /*回调占用超过一个周期:从当前时刻重新起算，不补发*/
+            if ((int32_t)(pT->Due - now) <= 0)
+            {
+                pT->Due = now + pT->Period;
+                Utimer_Mgr.Overruns++;
+            }
+            Utimer_Insert(pT);
+        }
+        Utimer_Mgr.Fired++;
+        Utimer_Mgr.Late_Max = (late > Utimer_Mgr.Late_Max) ? late : Utimer_Mgr.Late_Max;
+        __set_PRIMASK(primask);
+        pT->Func(pT->Arg);
+        __disable_irq();
+    }
+    Utimer_Arm();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	打印当前时刻、回调统计及运行中的定时器
+ * @param	None
+ * @retval	None
+ */
+void Utimer_Show(void)
+{
+    Utimer_Func func[UTIMER_SHOW_MAX];
+    uint32_t left[UTIMER_SHOW_MAX], period[UTIMER_SHOW_MAX], count = 0, total = 0, now, primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    now = Utimer_Count();
+    for (Utimer *pT = Utimer_Mgr.Head; pT != NULL; pT = pT->Next, total++)
+    {
+        if (count < UTIMER_SHOW_MAX)
+        {
+            func[count] = pT->Func;
+            left[count] = pT->Due - now;
+            period[count++] = pT->Period;
+        }
+    }
+    __set_PRIMASK(primask);
+    shellPrint(&shell, "now = %uus, fired = %u, compare arms = %u, late max = %uus, overruns = %u, active = %u\r\n", now,
+               Utimer_Mgr.Fired, Utimer_Mgr.Armed, Utimer_Mgr.Late_Max, Utimer_Mgr.Overruns, total);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        shellPrint(&shell, "  %p due in %dus, period = %uus\r\n", (void *)func[i], (int32_t)left[i], period[i]);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), utimer, Utimer_Show, show microsecond timers);
+#endif
@@ -0,0 +1,28 @@
+#ifndef __MDAUTH_H__
+#define __MDAUTH_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+
+/*认证尾:|序号低字节|MAC低3字节|，位于从机地址+PDU之后、CRC之前，CRC覆盖认证尾*/
+#define MODBUS_AUTH_SIZE 4U
+#define MODBUS_AUTH_TAG_MASK 0x00FFFFFFUL
+/*MAC的域:主站请求以完整序号为随机数，从站应答以所应答请求的MAC为随机数*/
+#define MODBUS_AUTH_REQUEST 0x00U
+#define MODBUS_AUTH_REPLY 0x01U
+/*认证失败的异常码(用户定义):异常应答后附带从站最后接受的序号(4B，高字节在前)，主站据此重新同步*/
+#define MODBUS_EXCEPTION_AUTH 0x0CU
+
+/*Chaskey密钥及两个派生子密钥(小端32位字)*/
+struct ModbusAuth
+{
+    mdU32 k[4];
+    mdU32 k1[4];
+    mdU32 k2[4];
+};
+
+mdExport mdVOID mdAuthSetKey(struct ModbusAuth *auth, const mdU32 key[4]);
+mdExport mdU32 mdAuthTag(const struct ModbusAuth *auth, mdU8 domain, mdU32 nonce, const mdU8 *data, mdU32 length);
+mdExport mdU32 mdAuthSequence(mdU32 last, mdU8 low);
+
+#endif
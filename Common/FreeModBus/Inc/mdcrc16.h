@@ -0,0 +1,12 @@
+#ifndef __MDCRC16_H__
+#define __MDCRC16_H__
+
+#include "mdtype.h"
+
+/*CRC16/MODBUS初始值*/
+#define MD_CRC16_INIT   (0xFFFF)
+
+mdExport mdU16 mdCrc16( mdU8 * pucFrame, mdU32 usLen );
+mdExport mdU16 mdCrc16Update( mdU16 crc, const mdU8 * pucFrame, mdU32 usLen );
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __MDENDIAN_H__
+#define __MDENDIAN_H__
+
+#include <stdint.h>
+#include <string.h>
+#include "mdtype.h"
+
+/*字节序变换:Cortex-M3 上为单条 REV 及 REV+ROR(等效REV16)指令，每步处理32位(两个寄存器)；
+主机仿真构建中由编译器内建函数生成对应指令*/
+#if defined(__CC_ARM)
+#define mdREV(x) __rev(x)
+#define mdROR16(x) __ror((x), 16)
+/*不对齐的32位访问(Cortex-M3 的 LDR/STR 支持不对齐地址)*/
+#define mdLoadU32(p) (*(const __packed uint32_t *)(p))
+#define mdStoreU32(p, v) (*(__packed uint32_t *)(p) = (v))
+#else
+#define mdREV(x) __builtin_bswap32(x)
+#define mdROR16(x) ((uint32_t)(((uint32_t)(x) >> 16) | ((uint32_t)(x) << 16)))
+static __inline uint32_t mdLoadU32(const mdVOID *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+static __inline mdVOID mdStoreU32(mdVOID *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+#endif
+/*每个半字内交换字节*/
+#define mdREV16(x) mdROR16(mdREV(x))
+
+mdExport mdVOID mdPackU16s(mdU8 *buf, const mdU16 *data, mdU32 len, mdBOOL swap);
+mdExport mdVOID mdUnpackU16s(mdU16 *data, const mdU8 *buf, mdU32 len, mdBOOL swap);
+mdExport mdVOID mdSwapU16Pairs(mdU16 *data, mdU32 len);
+
+#endif
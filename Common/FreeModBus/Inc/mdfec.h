@@ -0,0 +1,40 @@
+#ifndef __MDFEC_H__
+#define __MDFEC_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+#include "mdrecbuffer.h"
+
+/*应用层前向纠错(mdfec.c):整个RTU帧(从机地址+PDU+CRC)按字节交织分为若干个RS(GF(256))码字，
+  每个码字附加2t个校验字节，可纠正每个码字中任意t个错误字节；交织后连续 t*深度 个字节的突发错误也可纠正。
+  线路帧:|标记|交织的数据|交织的校验|，标记为 MODBUS_FEC_MARK + 纠错等级，不是合法的从机地址(>247)，
+  不认识的接收方按非本站的帧丢弃；纠错后CRC仍按原帧校验，纠错失败或误纠正的帧不会被接受*/
+/*纠错等级:每个码字可纠正的错误字节数，0为不编码*/
+#define MODBUS_FEC_OFF 0U
+#define MODBUS_FEC_MAX 2U
+#define MODBUS_FEC_MARK 0xF8U
+/*交织深度(码字数)，帧长小于深度时每个字节一个码字*/
+#define MODBUS_FEC_DEPTH 4U
+/*编码后增加的最大字节数*/
+#define MODBUS_FEC_OVERHEAD (1U + 2U * MODBUS_FEC_MAX * MODBUS_FEC_DEPTH)
+
+/*是否为纠错编码的线路帧(首字节为标记)，返回纠错等级，否则返回 MODBUS_FEC_OFF*/
+#define mdFecLevel(buf, count)                                                                    \
+    ((((count) > 1U) && ((buf)[0] > MODBUS_FEC_MARK) && ((buf)[0] <= MODBUS_FEC_MARK + MODBUS_FEC_MAX)) \
+         ? (mdU8)((buf)[0] - MODBUS_FEC_MARK)                                                     \
+         : MODBUS_FEC_OFF)
+
+/*纠错统计(自由计数):解码的帧、纠正的字节数及无法纠正的帧；last 为最近一帧纠正的字节数(未编码的帧为0)*/
+struct ModbusFecStats
+{
+    mdU32 frames;
+    mdU32 corrected;
+    mdU32 failed;
+    mdU32 last;
+};
+
+mdExport mdU32 mdFecEncode(mdU8 *buf, mdU32 length, mdU32 size, mdU8 level);
+mdExport mdU32 mdFecDecode(mdU8 *buf, mdU32 length, mdU32 *corrected);
+mdExport mdU8 mdFecReceive(ReceiveBufferHandle recbuf, struct ModbusFecStats *stats);
+
+#endif
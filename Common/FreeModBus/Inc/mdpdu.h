@@ -0,0 +1,36 @@
+#ifndef __MDPDU_H__
+#define __MDPDU_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+
+/*mdPduParse 的结果:0为合法，否则与应答的异常码相同(非法数据地址、非法数据值)*/
+#define MODBUS_PDU_OK      0x00U
+#define MODBUS_PDU_ADDRESS 0x02U
+#define MODBUS_PDU_VALUE   0x03U
+
+/*
+    请求PDU视图:标准功能码(1~6、15、16、23)的RTU帧由 mdPduParse 一次检查帧长度、字节数、数量及地址范围，
+    处理函数只从视图取字段，不再各自从接收缓冲区解析及检查；写入数据不复制，data 直接指向接收缓冲区内的
+    报文格式数据(线圈按位打包、寄存器高字节在前)，交给寄存器池的打包操作。视图在接收缓冲区清除前有效
+*/
+struct ModbusPduView
+{
+    mdU8 id;
+    mdU8 code;
+    /*起始地址及数量:FC5/FC6 的数量为1；23功能码为读地址/读数量*/
+    mdU16 start;
+    mdU16 number;
+    /*FC5/FC6 的写入值(FC5 为 0xFF00 或 0x0000)*/
+    mdU16 value;
+    /*23功能码的写地址/写数量*/
+    mdU16 writeStart;
+    mdU16 writeNumber;
+    /*FC15/FC16/FC23 的写入数据及字节数，其余功能码为 NULL/0*/
+    mdU8 *data;
+    mdU32 bytes;
+};
+
+mdExport mdU8 mdPduParse(struct ModbusPduView *view, mdU8 *frame, mdU32 length);
+
+#endif
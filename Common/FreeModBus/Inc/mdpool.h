@@ -0,0 +1,53 @@
+#ifndef __MDPOOL_H__
+#define __MDPOOL_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include "mdtype.h"
+#include "mdconfig.h"
+
+/*固定块内存池:每种协议栈对象一个池，空闲块串成单链表，分配与释放均为O(1)，不会产生碎片*/
+struct mdPool
+{
+    const char *name;
+    /*块大小(按字取整)及块数*/
+    mdU32 blockSize;
+    mdU32 blocks;
+    mdU8 *base;
+    /*空闲块链表:空闲块的首个字保存下一空闲块*/
+    mdVOID *freeList;
+    mdBOOL ready;
+    /*当前占用块数、占用高水位及因池空导致的分配失败次数*/
+    mdU32 used, peak, failed;
+};
+
+mdAPI mdVOID *mdPoolAlloc(mdU32 size);
+mdAPI mdVOID mdPoolFree(mdVOID *block);
+mdAPI mdVOID mdPoolShow(void);
+
+#if defined(USING_FREERTOS)
+/*RTOS下协议栈对象从固定块内存池分配，不经过 heap_4(分配时无需挂起调度器)*/
+#define mdmalloc(pointer, type, length)                           \
+    do                                                            \
+    {                                                             \
+        (pointer) = (type *)mdPoolAlloc(sizeof(type) * (length)); \
+        if ((pointer) != NULL)                                    \
+        {                                                         \
+            memset((pointer), 0, sizeof(type) * (length));        \
+        }                                                         \
+    } while (0)
+#define mdfree(pointer) mdPoolFree(pointer)
+#else
+#define mdmalloc(pointer, type, length)                       \
+    do                                                        \
+    {                                                         \
+        (pointer) = (type *)malloc(sizeof(type) * (length));  \
+        if ((pointer) != NULL)                                \
+        {                                                     \
+            memset((pointer), 0, sizeof(type) * (length));    \
+        }                                                     \
+    } while (0)
+#define mdfree(pointer) free(pointer)
+#endif
+
+#endif
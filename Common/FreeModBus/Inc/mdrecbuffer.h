@@ -0,0 +1,49 @@
+#ifndef __MDRECBUFFER_H__
+#define __MDRECBUFFER_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+
+/*DMA接收的一帧:释放时不清除 buf，count 之后为上一帧的残留数据*/
+struct ReceiveFrame
+{
+    mdU8  buf[MODBUS_PDU_SIZE_MAX];
+    volatile mdU32 count;
+    /*接收过程中增量计算的CRC(含帧尾CRC，正确帧结果为0)及已校验的字节数*/
+    mdU16 crc;
+    mdU32 scanned;
+};
+
+typedef struct ReceiveBuffer* ReceiveBufferHandle;
+struct ReceiveBuffer
+{
+    /*当前正在处理的帧(指向 frame 中的某一帧)*/
+    mdU8  *buf;
+    mdU32 count;
+    /*当前帧CRC是否正确(接收时已计算，无需再次校验)*/
+    mdBOOL crcValid;
+    /*帧环:head 为DMA正在写入的帧，tail~head-1 为已接收待处理的帧*/
+    struct ReceiveFrame frame[RECEIVE_BUFFER_FRAMES];
+    volatile mdU32 head, tail;
+    /*中断中提前丢弃CRC错误或非本站的帧，不唤醒任务*/
+    mdBOOL filter;
+    /*按站号索引的接收表(非0为本站的逻辑单元)，由从机的单元表提供*/
+    const mdU8 *filterMap;
+    mdU8 broadcastId;
+    mdU32 rejected;
+    /*拒收帧中CRC错误的帧数*/
+    mdU32 crcErrors;
+};
+
+mdAPI mdVOID mdClearReceiveBuffer(ReceiveBufferHandle handler);
+mdAPI mdSTATUS mdCreateReceiveBuffer(ReceiveBufferHandle *handler);
+mdAPI mdVOID mdDestoryReceiveBuffer(ReceiveBufferHandle *handler);
+mdAPI mdU8 *mdReceiveBufferTarget(ReceiveBufferHandle handler);
+mdAPI mdU32 mdReceiveBufferPending(ReceiveBufferHandle handler);
+mdAPI mdVOID mdReceiveBufferScan(ReceiveBufferHandle handler, mdU32 received);
+mdAPI mdSTATUS mdReceiveBufferCommit(ReceiveBufferHandle handler, mdU32 count);
+mdAPI mdVOID mdReceiveBufferDiscard(ReceiveBufferHandle handler);
+mdAPI mdVOID mdReceiveBufferFilter(ReceiveBufferHandle handler, const mdU8 *map, mdU8 broadcastId);
+mdAPI mdSTATUS mdReceiveBufferFetch(ReceiveBufferHandle handler);
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef __MDREGPOOL_H__
+#define __MDREGPOOL_H__
+
+
+#include <stdint.h>
+#include "mdtype.h"
+#include "mdconfig.h"
+
+
+/*位数换算为所需寄存器个数*/
+#define mdBITS_TO_WORDS(n) (((n) + REGISTER_WIDTH - 1U) / REGISTER_WIDTH)
+/*寄存器池各组在变化标记表中的起始下标及总寄存器数(与结构体内存储顺序一致)*/
+#define REGISTER_POOL_COILS 0U
+#define REGISTER_POOL_INPUT_COILS (REGISTER_POOL_COILS + mdBITS_TO_WORDS(COIL_POOL_SIZE))
+#define REGISTER_POOL_INPUT_REGISTERS (REGISTER_POOL_INPUT_COILS + mdBITS_TO_WORDS(INPUT_COIL_POOL_SIZE))
+#define REGISTER_POOL_HOLD_REGISTERS (REGISTER_POOL_INPUT_REGISTERS + INPUT_REGISTER_POOL_SIZE)
+#define REGISTER_POOL_WORDS (REGISTER_POOL_HOLD_REGISTERS + HOLD_REGISTER_POOL_SIZE)
+
+/*32位数据在报文中的字顺序(字内均为大端)*/
+#define mdWORD_ORDER_ABCD 0U //高位字在前
+#define mdWORD_ORDER_CDAB 1U //低位字在前，与寄存器池的存储顺序一致
+
+typedef struct RegisterPool* RegisterPoolHandle;
+/*寄存器变化回调:index 为变化标记表下标，changed 为新旧值的异或(线圈组即为变化的位)；
+  在写入方的上下文中调用(Modbus任务、采集任务或中断)，回调须简短，不得再写同一寄存器池*/
+typedef mdVOID (*mdRegisterNotify)(RegisterPoolHandle handler, mdU32 index, mdU16 changed, mdVOID *arg);
+struct mdRegisterWatch
+{
+    //订阅的变化标记表下标范围 [from, to)
+    mdU32 from;
+    mdU32 to;
+    mdRegisterNotify notify;
+    mdVOID *arg;
+};
+struct mdWordRange
+{
+    //高位字在前的32位数据所在的变化标记表下标范围 [from, to)
+    mdU32 from;
+    mdU32 to;
+};
+/*寄存器池的方法:各实例共用同一张常量表，调用形式为 pool->ops->mdXxx(pool, ...)*/
+struct RegisterPoolOps
+{
+    mdSTATUS (*mdReadBit)(RegisterPoolHandle handler,mdU32 addr,mdBit *bit);
+    mdSTATUS (*mdWriteBit)(RegisterPoolHandle handler,mdU32 addr,mdBit bit);
+    mdSTATUS (*mdReadBits)(RegisterPoolHandle handler,mdU32 addr,mdU32 len,mdBit *bits);
+    mdSTATUS (*mdWriteBits)(RegisterPoolHandle handler,mdU32 addr,mdU32 len,mdBit *bits);
+    mdSTATUS (*mdReadU16)(RegisterPoolHandle handler,mdU32 addr,mdU16 *data);
+    mdSTATUS (*mdWriteU16)(RegisterPoolHandle handler,mdU32 addr,mdU16 data);
+    mdSTATUS (*mdReadU16s)(RegisterPoolHandle handler,mdU32 addr,mdU32 len,mdU16 *data);
+    mdSTATUS (*mdWriteU16s)(RegisterPoolHandle handler,mdU32 addr,mdU32 len,mdU16 *data);
+    /*按Modbus报文格式(大端字节)批量读写寄存器，登记过字顺序的32位数据在此转换，其余寄存器不交换*/
+    mdSTATUS (*mdReadU16sPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8* buf);
+    mdSTATUS (*mdWriteU16sPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const mdU8* buf);
+    /*登记 [addr, addr+len) 内32位数据在报文中的字顺序(mdWORD_ORDER_xxx)，只在初始化时调用*/
+    mdSTATUS (*mdSetWordOrder)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 order);
+    /*32位数据读写:len 为数据个数，每个占2个寄存器，低位字在前；整段须位于同一组，写入为一次原子提交*/
+    mdSTATUS (*mdReadU32s)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, uint32_t* data);
+    mdSTATUS (*mdWriteU32s)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const uint32_t* data);
+    mdSTATUS (*mdReadI32s)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, int32_t* data);
+    mdSTATUS (*mdWriteI32s)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const int32_t* data);
+    mdSTATUS (*mdReadFloats)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, float* data);
+    mdSTATUS (*mdWriteFloats)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const float* data);
+
+    mdSTATUS (*mdReadCoil)(RegisterPoolHandle handler, mdU32 addr, mdBit* bit);
+    mdSTATUS (*mdReadCoils)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit* bits);
+    mdSTATUS (*mdWriteCoil)(RegisterPoolHandle handler, mdU32 addr, mdBit bit);
+    mdSTATUS (*mdWriteCoils)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit* bits);
+    mdSTATUS (*mdReadInputCoil)(RegisterPoolHandle handler, mdU32 addr, mdBit* bit);
+    mdSTATUS (*mdReadInputCoils)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit* bits);
+    mdSTATUS (*mdWriteInputCoil)(RegisterPoolHandle handler, mdU32 addr, mdBit bit);
+    mdSTATUS (*mdWriteInputCoils)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit* bits);
+    /*按Modbus报文格式(低位在前的压缩字节)批量读写线圈/输入状态*/
+    mdSTATUS (*mdReadCoilsPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8* buf);
+    mdSTATUS (*mdWriteCoilsPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8* buf);
+    mdSTATUS (*mdReadInputCoilsPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8* buf);
+    mdSTATUS (*mdWriteInputCoilsPacked)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8* buf);
+    mdSTATUS (*mdReadInputRegister)(RegisterPoolHandle handler, mdU32 addr, mdU16* data);
+    mdSTATUS (*mdReadInputRegisters)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16* data);
+    mdSTATUS (*mdWriteInputRegister)(RegisterPoolHandle handler, mdU32 addr, mdU16 data);
+    mdSTATUS (*mdWriteInputRegisters)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16* data);
+    mdSTATUS (*mdReadHoldRegister)(RegisterPoolHandle handler, mdU32 addr, mdU16* data);
+    mdSTATUS (*mdReadHoldRegisters)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16* data);
+    mdSTATUS (*mdWriteHoldRegister)(RegisterPoolHandle handler, mdU32 addr, mdU16 data);
+    mdSTATUS (*mdWriteHoldRegisters)(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16* data);
+    /*取走下标不小于 from 的第一个变化寄存器，返回其变化标记表下标，无变化时返回 REGISTER_POOL_WORDS*/
+    mdU32 (*mdTakeDirty)(RegisterPoolHandle handler, mdU32 from);
+    /*取走下标不小于 from 的第一段连续变化寄存器(不跨组)，len 为段长，无变化时返回 REGISTER_POOL_WORDS 且 len 为0*/
+    mdU32 (*mdTakeDirtyRange)(RegisterPoolHandle handler, mdU32 from, mdU32 *len);
+    /*订阅变化标记表下标 [from, from+len) 内寄存器的变化，订阅数已满时返回 mdFALSE*/
+    mdSTATUS (*mdSubscribe)(RegisterPoolHandle handler, mdU32 from, mdU32 len, mdRegisterNotify notify, mdVOID *arg);
+};
+struct RegisterPool
+{
+    //线圈、输入状态(按位压缩存储)、输入寄存器、保持寄存器(连续存储，按下标直接访问)
+    mdU16 coils[mdBITS_TO_WORDS(COIL_POOL_SIZE)];
+    mdU16 inputCoils[mdBITS_TO_WORDS(INPUT_COIL_POOL_SIZE)];
+    mdU16 inputRegisters[INPUT_REGISTER_POOL_SIZE];
+    mdU16 holdRegisters[HOLD_REGISTER_POOL_SIZE];
+    //变化标记:寄存器值被改写后对应字节置1，由 mdTakeDirty 取走并清除(单字节存储，无需加锁)
+    mdU8 dirty[REGISTER_POOL_WORDS];
+    //提交序号:同一组内的多寄存器写入在关中断期间完成并加1，读取方据此判断是否读到了同一次提交
+    volatile mdU32 seq;
+    //变化订阅，只在初始化时登记
+    struct mdRegisterWatch watches[MODBUS_REGISTER_WATCHES];
+    mdU32 watchCount;
+    //报文中须交换字顺序的区段，只在初始化时登记
+    struct mdWordRange words[MODBUS_WORD_RANGES];
+    mdU32 wordCount;
+
+    //方法表(存放于flash)，所有寄存器池共用
+    const struct RegisterPoolOps *ops;
+};
+
+
+mdExport mdSTATUS mdCreateRegisterPool(RegisterPoolHandle* regpoolhandle);
+mdExport mdVOID mdDestoryRegisterPool(RegisterPoolHandle* regpoolhandle);
+
+/*位寻址:按寄存器位宽在编译期确定移位及掩码，不做除法*/
+#if (REGISTER_WIDTH == 8)
+#define mdBIT_SHIFT 3U
+#elif (REGISTER_WIDTH == 16)
+#define mdBIT_SHIFT 4U
+#elif (REGISTER_WIDTH == 32)
+#define mdBIT_SHIFT 5U
+#else
+#error "REGISTER_WIDTH must be 8, 16 or 32"
+#endif
+#define mdBIT_MASK ((mdU32)REGISTER_WIDTH - 1U)
+/*位地址所在的寄存器下标及寄存器内的位偏移*/
+#define mdBIT_WORD(n) ((mdU32)(n) >> mdBIT_SHIFT)
+#define mdBIT_OFFSET(n) ((mdU32)(n) & mdBIT_MASK)
+
+/*一致性读取:读取前取得提交序号，读完后序号已变化则重读，读到的一段寄存器来自同一次提交；
+  读取方不加锁，生产者的提交(mdWriteU16s 及按组批量写入)只关中断拷贝整段数据*/
+#define mdSnapshotBegin(pool) ((pool)->seq)
+#define mdSnapshotRetry(pool, s) ((pool)->seq != (s))
+
+/*组内地址换算为变化标记表下标，线圈/输入状态每个下标对应16个位*/
+#define mdCOIL_INDEX(addr) (REGISTER_POOL_COILS + mdBIT_WORD(addr))
+#define mdINPUT_COIL_INDEX(addr) (REGISTER_POOL_INPUT_COILS + mdBIT_WORD(addr))
+#define mdINPUT_REGISTER_INDEX(addr) (REGISTER_POOL_INPUT_REGISTERS + (mdU32)(addr))
+#define mdHOLD_REGISTER_INDEX(addr) (REGISTER_POOL_HOLD_REGISTERS + (mdU32)(addr))
+
+/*单个寄存器内的位操作*/
+#define mdGetBit(reg,offset) (((reg) >> (offset)) & 1U)
+#define mdSetBit(reg,offset,bit) do{(reg) = ((reg) & ~(1U << (offset))) | ((mdU16)(bit) << (offset));}while(0)
+#define mdSetBitOn(reg,offset) ((reg) |= (mdU16)(1U << (offset)))
+#define mdClrBit(reg,offset) ((reg) &= (mdU16)~(1U << (offset)))
+#define mdToggleBit(reg,offset) ((reg) ^= (mdU16)(1U << (offset)))
+
+/*位组(按位压缩的寄存器数组)中第n个位的读写:
+  开启位带时写入为对别名字的一次存储，由总线完成原子读改写，不影响同一寄存器的其他位，中断中无需临界区；
+  未开启时为普通读改写，中断与任务同时写同一寄存器须由调用者加锁*/
+#define mdBitRead(table,n) mdGetBit((table)[mdBIT_WORD(n)], mdBIT_OFFSET(n))
+#if (MODBUS_BIT_BAND)
+#define mdBIT_BAND_SRAM 0x20000000UL
+#define mdBIT_BAND_ALIAS 0x22000000UL
+#define mdBIT_BAND_SIZE 0x00100000UL
+/*别名字地址 = 别名区基址 + 字节偏移*32 + 位号*4，半字内的位号即为按字节展开后的位序*/
+#define mdBIT_BAND(table,n) (*(volatile mdU32 *)(mdBIT_BAND_ALIAS + (((mdU32)(table) - mdBIT_BAND_SRAM) << 5U) + ((mdU32)(n) << 2U)))
+/*对象整体位于SRAM位带区*/
+#define mdBIT_BAND_REGION(p) (((mdU32)(p) >= mdBIT_BAND_SRAM) && ((mdU32)(p) + sizeof(*(p)) <= mdBIT_BAND_SRAM + mdBIT_BAND_SIZE))
+/*单个位的读取为对别名字的一次加载*/
+#define mdBitLoad(table,n) (mdBIT_BAND(table,n))
+#define mdBitWrite(table,n,bit) (mdBIT_BAND(table,n) = (mdU32)(bit))
+#define mdBitSet(table,n) (mdBIT_BAND(table,n) = 1U)
+#define mdBitClear(table,n) (mdBIT_BAND(table,n) = 0U)
+#define mdBitToggle(table,n) (mdBIT_BAND(table,n) ^= 1U)
+#else
+#define mdBitLoad(table,n) mdBitRead(table,n)
+#define mdBitWrite(table,n,bit) mdSetBit((table)[mdBIT_WORD(n)], mdBIT_OFFSET(n), bit)
+#define mdBitSet(table,n) mdSetBitOn((table)[mdBIT_WORD(n)], mdBIT_OFFSET(n))
+#define mdBitClear(table,n) mdClrBit((table)[mdBIT_WORD(n)], mdBIT_OFFSET(n))
+#define mdBitToggle(table,n) mdToggleBit((table)[mdBIT_WORD(n)], mdBIT_OFFSET(n))
+#endif
+
+#endif
+
@@ -0,0 +1,396 @@
+#ifndef __MDRTUSLAVE_H__
+#define __MDRTUSLAVE_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+#include "mdregpool.h"
+#include "mdrecbuffer.h"
+#include "mdpool.h"
+#include "mdpdu.h"
+#if !(MODBUS_ROLE_MASTER)
+#include "mdcodec.h"
+#if (MODBUS_AUTH)
+#include "mdauth.h"
+#endif
+#endif
+
+#if (USER_MODBUS_LIB)
+#define UNREFERENCED_VALUE(P) (P)
+#define USING_DMA_TRANSPORT 1
+/*组播帧使用的从站号*/
+#define MODBUS_BROADCAST_ID 0x00
+/*逻辑单元可用的最大站号*/
+#define MODBUS_UNIT_ID_MAX 247U
+/*单元表中中继转发站号的标记(不是本站单元)*/
+#define MODBUS_UNIT_FORWARD 0xFFU
+/*转发帧的定点模式帧头:下游节点地址(2B)+信道*/
+#define MODBUS_FORWARD_HEADER 3U
+/*从机通讯波特率*/
+#define BUAD_RATE 115200U
+/*接收中断通知Modbus任务的信号(直接任务通知)*/
+#define MODBUS_SIGNAL_RX 0x01
+/*定时器周期为100us*/
+#define TIMER_UTIME 100U
+
+/*接收帧时错误*/
+#define ERROR1 1
+/*帧长度错误*/
+#define ERROR2 2
+/*CRC校验错误*/
+#define ERROR3 3
+/*站号错误*/
+#define ERROR4 4
+/*未知的功能码*/
+#define ERROR5 5
+
+#define LOW(n) ((mdU8)((mdU16)(n) & 0xFFU))
+#define HIGH(n) ((mdU8)((mdU16)(n) >> 8U))
+#define ToU16(high, low) ((((mdU16)high & 0x00ff) << 8) | \
+                          ((mdU16)low & 0x00ff))
+#define TIMER_CLEAN()  \
+    do                 \
+    {                  \
+        lastCount = 0; \
+        ustime = 0;    \
+        timeSum = 0;   \
+        error = 0;     \
+    } while (0)
+
+/* ================================================================== */
+/*                        core                                        */
+/* ================================================================== */
+#define MODBUS_CODE_1 1
+#define MODBUS_CODE_2 2
+#define MODBUS_CODE_3 3
+#define MODBUS_CODE_4 4
+#define MODBUS_CODE_5 5
+#define MODBUS_CODE_6 6
+#define MODBUS_CODE_15 15
+#define MODBUS_CODE_16 16
+#define MODBUS_CODE_20 20
+#define MODBUS_CODE_21 21
+#define MODBUS_CODE_23 23
+/*23功能码单次读取的最大寄存器数*/
+#define MODBUS_CODE23_READ_MAX 125U
+#define MODBUS_CODE23_WRITE_MAX 121U
+/*标准功能码单次读写的最大数量(Modbus协议规定):FC01/02位数、FC03/04寄存器数、FC15位数、FC16寄存器数*/
+#define MODBUS_READ_BITS_MAX 2000U
+#define MODBUS_READ_REGS_MAX 125U
+#define MODBUS_WRITE_BITS_MAX 1968U
+#define MODBUS_WRITE_REGS_MAX 123U
+/*文件记录(20/21功能码，仅主站实例):子请求的引用类型固定为6，记录号为文件内的寄存器序号(0~9999)，
+  一帧可含多个子请求，应答数据长度不超过 MODBUS_FILE_DATA_MAX 字节*/
+#define MODBUS_FILE_REF_TYPE 6U
+#define MODBUS_FILE_RECORDS 10000U
+#define MODBUS_FILE_DATA_MAX 0xF5U
+/*异常应答:|从机地址|功能码|0x80|异常码|CRC|*/
+#define MODBUS_EXCEPTION_FLAG 0x80U
+/*非法功能码、非法数据地址、非法数据值、从站设备故障*/
+#define MODBUS_EXCEPTION_FUNCTION 0x01U
+#define MODBUS_EXCEPTION_ADDRESS 0x02U
+#define MODBUS_EXCEPTION_VALUE 0x03U
+#define MODBUS_EXCEPTION_FAILURE 0x04U
+/*紧凑模拟量帧(用户自定义功能码)*/
+#define MODBUS_CODE_ANALOG 0x41
+/*延迟测试回显帧(用户自定义功能码):|序号(2B)|主站时刻(ms,4B)|，从站原样回显，高字节在前*/
+#define MODBUS_CODE_ECHO 0x42
+#define MODBUS_ECHO_SIZE 6U
+/*分块传输(用户自定义功能码):|操作|参数|，两端均由 xfer.c 处理，帧格式见 xfer.h*/
+#define MODBUS_CODE_XFER 0x44
+/*固件分发(用户自定义功能码):数据块以广播地址发出，两端均由 ota.c 处理，帧格式见 ota.h*/
+#define MODBUS_CODE_OTA 0x45
+/*入网发现(用户自定义功能码):主站广播信标，从站在随机时隙内回送站号及能力，由 discover.c 处理*/
+#define MODBUS_CODE_JOIN 0x46
+/*时间同步(用户自定义功能码):|主站时刻(ms,4B)|单程时延估计(ms,2B)|，从站原样回显；主站由L101调度发起，从站由 timesync.c 处理*/
+#define MODBUS_CODE_TIME 0x47
+#define MODBUS_TIME_SIZE 6U
+/*输出场景(用户自定义功能码):|场景号|，从站一次切换场景中的全部输出，两端均由 scene.c 处理*/
+#define MODBUS_CODE_SCENE 0x49
+/*写线圈应答中附带上报的最大线圈数*/
+#define MODBUS_REPORT_MAX 16U
+/*线圈状态之后附带的从站健康信息:|错误计数(2B)|运行时间(s,4B)|RSSI(1B)|，高字节在前*/
+#define MODBUS_HEALTH_SIZE 7U
+/*从站无法取得RSSI时上报的值*/
+#define MODBUS_RSSI_UNKNOWN 0x80U
+/*健康信息之后附带的模拟量:|通道掩码|各置位通道的值(2B，高字节在前)|，掩码为0时整段省略*/
+#define MODBUS_ANALOG_REPORT_MAX 8U
+
+#define mdGetSlaveId() (recbuf[0])
+#define mdGetCrc16() (ToU16(recbuf[reclen - 1], recbuf[reclen - 2]))
+#define mdGetCode() (recbuf[1])
+
+/*应答帧最大长度:定点模式帧头(3) + 从机地址(1) + PDU + CRC(2)；
+ASCII帧为 ':' + 2 * (从机地址 + PDU + LRC) + CR LF*/
+#if (MODBUS_ASCII)
+#define MODBUS_TX_BUFFER_SIZE (2U * (MODBUS_PDU_SIZE_MAX + 2U) + 3U)
+#else
+#define MODBUS_TX_BUFFER_SIZE (MODBUS_PDU_SIZE_MAX + 6U)
+#endif
+
+/*发送队列中的一帧*/
+struct TransmitFrame
+{
+    mdU8 buf[MODBUS_TX_BUFFER_SIZE];
+    /*发送的数据:拷贝发送时指向 buf，直接发送时指向调用者缓冲区*/
+    mdU8 *data;
+    mdU32 length;
+};
+
+typedef struct ModbusRTUSlave *ModbusRTUSlaveHandler;
+/*功能码处理函数*/
+typedef mdVOID (*ModbusRTUCodeHandle)(ModbusRTUSlaveHandler handler);
+
+/*自定义功能码表项*/
+struct ModbusRTUCustomCode
+{
+    mdU8 code;
+    ModbusRTUCodeHandle handle;
+};
+
+#if (MODBUS_ROLE_MASTER)
+/*文件读写函数:data 为高字节在前的 length 个寄存器，返回 mdFALSE 时整帧不应答*/
+typedef mdSTATUS (*ModbusRTUFileRead)(mdU16 file, mdU16 record, mdU16 length, mdU8 *data);
+typedef mdSTATUS (*ModbusRTUFileWrite)(mdU16 file, mdU16 record, mdU16 length, const mdU8 *data);
+
+/*文件表项(各实例共用):只读文件的 write 为 NULL*/
+struct ModbusRTUFile
+{
+    mdU16 file;
+    ModbusRTUFileRead read;
+    ModbusRTUFileWrite write;
+};
+#else
+#if (MODBUS_CODE_PROFILE)
+/*一个功能码的分派统计(自由计数，md_prof_clear 清零):调用次数、累计及最长处理耗时(DWT周期)*/
+struct ModbusRTUCodeProfile
+{
+    mdU32 count;
+    mdU32 total;
+    mdU32 max;
+    mdU8 code;
+};
+#endif
+
+/*重复帧缓存项:以请求帧的CRC、长度和功能码标识一帧，保存其应答*/
+struct ModbusRTUDupEntry
+{
+    mdU16 crc;
+    mdU8 code;
+    mdU8 replyLength;
+    mdU32 length;
+    mdU32 tick;
+    mdU8 reply[MODBUS_DUP_REPLY_SIZE];
+};
+
+/*中继转发表项:发往站号 id 的请求经L101定点模式转发到下游节点 addr/channel，下游应答加上本站应答帧头回传主站；
+下游从站的应答地址及信道须设为本站节点*/
+struct ModbusRTUForward
+{
+    mdU16 addr;
+    mdU8 id;
+    mdU8 channel;
+    /*已转发请求、等待下游应答及转发时刻*/
+    mdBOOL waiting;
+    mdU32 tick;
+};
+#endif
+
+/*协议栈句柄:主站与从站共用收发、成帧及标准功能码部分，按 MODBUS_ROLE_MASTER 裁剪各自的扩展*/
+struct ModbusRTUSlave
+{
+    mdU8 slaveId;
+    mdU32 usartBaudRate;
+    mdU32 stopTime, invalidTime;
+    mdBOOL updateFlag;
+    /*绑定的串口驱动句柄(UartDma_HandleTypeDef)，为 NULL 时由 mdRTUPopChar 自行发送*/
+    mdVOID *port;
+    ReceiveBufferHandle receiveBuffer;
+    RegisterPoolHandle registerPool;
+    /*正在处理的请求所属单元的寄存器池，只有主单元时即为 registerPool*/
+    RegisterPoolHandle unitPool;
+    /*应答帧静态发送缓冲区*/
+    mdU8 txBuffer[MODBUS_TX_BUFFER_SIZE];
+    mdU32 txLength;
+    mdBOOL txOverflow;
+#if (MODBUS_ROLE_MASTER)
+    /*异步发送队列(txDepth 帧):txTail 为正在发送的帧，txTail~txHead-1 为待发送帧；
+    txDepth 为0时不分配队列，mdRTUPopChar 返回即视为发送完成*/
+    struct TransmitFrame *txQueue;
+    mdU32 txDepth;
+#else
+    /*异步发送队列:txTail 为正在发送的帧，txTail~txHead-1 为待发送帧*/
+    struct TransmitFrame txQueue[TRANSMIT_QUEUE_FRAMES];
+#endif
+    volatile mdU32 txHead, txTail;
+    volatile mdBOOL txBusy;
+    mdU32 txDropped;
+    /*发送完成通知(中断上下文调用，可为 NULL)，txLastLength 为刚发完一帧的长度*/
+    mdVOID (*mdRTUTxDone)(ModbusRTUSlaveHandler handler);
+    mdU32 txLastLength;
+    /*写线圈后通知(接收任务上下文调用，可为 NULL)，写入的线圈为 [addr, addr + length)*/
+    mdVOID (*mdRTUCoilWritten)(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+    /*写保持寄存器后通知(接收任务上下文调用，可为 NULL)，写入的寄存器为 [addr, addr + length)*/
+    mdVOID (*mdRTUHoldWritten)(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+    /*中心处理器拒绝的帧数(地址、功能码或长度错误)*/
+    mdU32 errors;
+    mdSTATUS (*mdRTUPopChar)(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+    mdVOID (*mdRTUCenterProcessor)(ModbusRTUSlaveHandler handler);
+    mdVOID (*mdRTUError)(ModbusRTUSlaveHandler handler, mdU8 error);
+    /*串口驱动收到数据时的通知(中断上下文调用，可为 NULL)，用于唤醒处理该实例的任务*/
+    mdVOID (*mdRTURxNotify)(ModbusRTUSlaveHandler handler);
+
+    mdVOID (*portRTUPushChar)(ModbusRTUSlaveHandler handler, mdU8 c);
+    mdVOID (*portRTUTimerTick)(ModbusRTUSlaveHandler handler, mdU32 ustime);
+
+    mdVOID (*portRTUPushString)(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+    mdVOID (*mdRTUSendString)(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+    /*直接发送调用者缓冲区中的一帧(不拷贝)，缓冲区在发送完成前不得改动*/
+    mdVOID (*mdRTUSendFrame)(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+    /*用户注册的自定义功能码，优先于标准功能码表*/
+    struct ModbusRTUCustomCode customCodes[MODBUS_CUSTOM_CODES];
+    /*定时器成帧:上次空闲中断时已接收的字节数、t1.5处线路是否保持空闲、当前帧内超过t1.5的字符间隔数*/
+    volatile mdU32 frameMark;
+    volatile mdBOOL frameQuiet;
+    volatile mdU32 frameGaps;
+    /*因字符间隔超过t1.5被丢弃的帧数*/
+    mdU32 lossFrames;
+    /*协议统计(自由计数):接收帧、进入发送队列的帧，及按错误码(ERROR1~ERROR5)统计的出错帧*/
+    mdU32 rxFrames, txFrames;
+    mdU32 errorCodes[ERROR5 + 1];
+    /*正在处理的请求经 mdPduParse 检查后的视图，标准功能码的处理函数从中取字段*/
+    struct ModbusPduView pdu;
+#if (MODBUS_ROLE_MASTER)
+    /*寄存器池由创建时传入(与其他实例共用)，销毁时不释放*/
+    mdBOOL poolShared;
+#else
+    /*逻辑单元表:unitMap 按站号索引，非0时为 unitPools 下标+1；0号单元为主单元(slaveId，registerPool)*/
+    mdU8 unitMap[256];
+    RegisterPoolHandle unitPools[MODBUS_UNITS];
+    mdU8 unitIds[MODBUS_UNITS];
+    mdU32 unitCount;
+    /*中继转发表，表中站号在 unitMap 中标记为 MODBUS_UNIT_FORWARD*/
+    struct ModbusRTUForward forwards[MODBUS_FORWARDS];
+    mdU32 forwardCount;
+    /*转发的请求数、回传的应答数、下游未应答的请求数*/
+    mdU32 forwarded, returned, forwardTimeouts;
+    /*成帧编解码器:接收帧还原为RTU帧后处理，应答按其格式编码*/
+    const struct ModbusCodec *codec;
+    /*发往本站单元的请求在执行前通知(接收任务上下文调用，可为 NULL)，可在其中延迟处理；返回 mdFALSE 时丢弃该请求，不应答*/
+    mdBOOL (*mdRTURequest)(ModbusRTUSlaveHandler handler, mdU8 id);
+    /*写线圈应答回显后附带上报的线圈区间 [reportAddress, reportAddress + reportLength)，长度为0时不上报；
+    附带数据格式同FC1应答:|字节数|线圈状态|*/
+    mdU16 reportAddress;
+    mdU16 reportLength;
+    /*在上报的线圈状态之后附带健康信息(MODBUS_HEALTH_SIZE字节)，lastRssi 由传输层更新*/
+    mdBOOL reportHealth;
+    /*在健康信息之后附带模拟量(可为 NULL，接收任务上下文调用):返回需上报的通道掩码，values[i] 为通道i的值；
+    只用于本机单元且开启了健康信息的应答*/
+    mdU8 (*mdRTUReportAnalog)(ModbusRTUSlaveHandler handler, mdU16 *values);
+    /*快速写入(可为 NULL，串口空闲中断中调用):一个接收段即为发往主单元的完整RTU帧、CRC(及认证)正确的FC05或场景帧时，
+    在任务处理前先交给应用，frame[0, length) 为 从机地址+PDU；之后该帧仍照常由任务处理及应答*/
+    mdVOID (*mdRTUFastWrite)(ModbusRTUSlaveHandler handler, const mdU8 *frame, mdU32 length);
+    /*上次接收通知时的接收段序号及其是否以空闲结束(下一个接收段从帧首开始)，交给快速写入的帧数*/
+    mdU32 fastSpan;
+    mdBOOL fastStart;
+    mdU32 fastFrames;
+    mdU8 lastRssi;
+    /*发出的异常应答数*/
+    mdU32 exceptions;
+    /*最近执行的写命令及其应答(replyLength为0的项无效)，dupCapture 为正在执行、等待记录应答的项*/
+    struct ModbusRTUDupEntry dupCache[MODBUS_DUP_CACHE];
+    mdU32 dupNext;
+    struct ModbusRTUDupEntry *dupCapture;
+    /*由缓存应答的重传帧数*/
+    mdU32 dupHits;
+#if (MODBUS_AUTH)
+    /*帧认证密钥，NULL 时不认证；开启后不处理组播帧(主站无法为其重新同步序号)*/
+    struct ModbusAuth *auth;
+    /*各单元最后接受的请求序号；authCeiling 为已保存的序号上限，接受超过上限的序号前经 mdRTUAuthCeiling 保存新上限，
+    上电后各单元从上限开始，重启前用过的序号不能重放*/
+    mdU32 authSeq[MODBUS_UNITS];
+    mdU32 authCeiling;
+    mdSTATUS (*mdRTUAuthCeiling)(ModbusRTUSlaveHandler handler, mdU32 ceiling);
+    /*正在应答的请求已认证:应答以请求的MAC为随机数签名，并带回请求的序号低字节*/
+    mdBOOL authActive;
+    mdU8 authSeqLow;
+    mdU32 authTag;
+    /*认证失败的请求数*/
+    mdU32 authFailures;
+#endif
+#if (MODBUS_CODE_PROFILE)
+    /*各功能码的分派统计，profileOther 为统计表用尽后未能登记的分派次数*/
+    struct ModbusRTUCodeProfile profile[MODBUS_PROFILE_CODES];
+    mdU32 profileOther;
+#endif
+#endif
+};
+
+/*创建参数:未用到的字段须清零*/
+struct ModbusRTUSlaveRegisterInfo
+{
+    mdU8 slaveId;
+    mdU32 usartBaudRate;
+    mdSTATUS (*mdRTUPopChar)(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+    /*串口驱动句柄:非 NULL 且使用DMA传输时，创建时将接收绑定到本实例*/
+    mdVOID *port;
+    mdVOID (*mdRTURxNotify)(ModbusRTUSlaveHandler handler);
+#if (MODBUS_ROLE_MASTER)
+    /*为 NULL 时创建独立的寄存器池，否则与其他实例共用该寄存器池*/
+    RegisterPoolHandle registerPool;
+    /*发送队列深度，0:同步发送(mdRTUPopChar 返回时已发送完成或已拷贝走)*/
+    mdU32 txFrames;
+#endif
+};
+
+mdAPI mdSTATUS mdCreateModbusRTUSlave(ModbusRTUSlaveHandler *handler, struct ModbusRTUSlaveRegisterInfo info);
+mdAPI mdVOID mdDestoryModbusRTUSlave(ModbusRTUSlaveHandler *handler);
+mdAPI mdVOID mdU16Swap(mdU16 *data, mdU32 length);
+mdAPI mdVOID mdRTUTxComplete(ModbusRTUSlaveHandler handler);
+mdAPI mdVOID mdRTUTxAbort(ModbusRTUSlaveHandler handler);
+mdAPI mdSTATUS mdRTUPortPopChar(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length);
+mdAPI mdVOID mdRTUFrameIdle(ModbusRTUSlaveHandler handler, mdU32 count);
+mdAPI mdVOID mdRTUFrameCheck(ModbusRTUSlaveHandler handler, mdU32 count);
+mdAPI mdBOOL mdRTUFrameTimeout(ModbusRTUSlaveHandler handler, mdU32 count);
+mdAPI mdSTATUS mdRTUFrameCommit(ModbusRTUSlaveHandler handler, mdU32 count);
+mdAPI mdSTATUS mdRTURegisterCode(ModbusRTUSlaveHandler handler, mdU8 code, ModbusRTUCodeHandle handle);
+#if (MODBUS_ROLE_MASTER)
+/*定义当前从机对象:不对外开放接口*/
+mdAPI ModbusRTUSlaveHandler mdMaster;
+#define Master_Object mdMaster
+mdAPI mdSTATUS mdRTURegisterFile(mdU16 file, ModbusRTUFileRead read, ModbusRTUFileWrite write);
+mdAPI mdVOID ModbusInit(ModbusRTUSlaveHandler *handler);
+#else
+mdAPI ModbusRTUSlaveHandler mdhandler;
+mdAPI mdVOID mdRTUDupFlush(ModbusRTUSlaveHandler handler);
+mdAPI mdVOID mdRTUReply(ModbusRTUSlaveHandler handler, const mdU8 *pdu, mdU32 length);
+mdAPI mdVOID mdRTUSendFrom(ModbusRTUSlaveHandler handler, mdU8 id, const mdU8 *pdu, mdU32 length);
+mdAPI mdVOID mdRTUReplyException(ModbusRTUSlaveHandler handler, mdU8 exception);
+mdAPI mdSTATUS mdRTUSetCodec(ModbusRTUSlaveHandler handler, mdU32 id);
+mdAPI mdSTATUS mdRTUAddUnit(ModbusRTUSlaveHandler handler, mdU8 id, RegisterPoolHandle *pool);
+mdAPI RegisterPoolHandle mdRTUFindUnit(ModbusRTUSlaveHandler handler, mdU8 id);
+mdAPI mdSTATUS mdRTUAliasUnit(ModbusRTUSlaveHandler handler, mdU8 id, mdBOOL enable);
+mdAPI mdSTATUS mdRTUAddForward(ModbusRTUSlaveHandler handler, mdU8 id, mdU16 addr, mdU8 channel);
+mdAPI mdVOID mdRTUClearForwards(ModbusRTUSlaveHandler handler);
+#if (MODBUS_AUTH)
+mdAPI mdVOID mdRTUSetAuth(ModbusRTUSlaveHandler handler, struct ModbusAuth *auth, mdU32 ceiling);
+#endif
+mdAPI mdVOID ModbusInit(mdVOID);
+#endif
+/*接口：100us定时器回调函数*/
+#define mdRTU_Handler(obj) (obj->portRTUTimerTick(obj, TIMER_UTIME))
+#define mdRTU_Recive_Buf(obj) (obj->receiveBuffer->buf)
+#define mdRTU_Recive_Len(obj) (obj->receiveBuffer->count)
+#define mdRTU_Recive_Target(obj) (mdReceiveBufferTarget(obj->receiveBuffer))
+#define mdRTU_Recive_Commit(obj, len) (mdReceiveBufferCommit(obj->receiveBuffer, len))
+#define mdRTU_SendString(obj, buf, len) (obj->mdRTUSendString(obj, buf, len))
+#define mdRTU_WriteCoil(obj, addr, bit) (obj->registerPool->ops->mdWriteCoil(obj->registerPool, addr, bit))
+#define mdRTU_ReadCoil(obj, addr, bit) (obj->registerPool->ops->mdReadCoil(obj->registerPool, addr, &bit))
+#define mdRTU_ReadCoilsPacked(obj, addr, len, buf) (obj->registerPool->ops->mdReadCoilsPacked(obj->registerPool, addr, len, buf))
+#define mdRTU_WriteCoilsPacked(obj, addr, len, buf) (obj->registerPool->ops->mdWriteCoilsPacked(obj->registerPool, addr, len, buf))
+#define mdRTU_WriteInputCoil(obj, addr, bit) (obj->registerPool->ops->mdWriteInputCoil(obj->registerPool, addr, bit))
+#define mdRTU_WriteInputCoilsPacked(obj, addr, len, buf) (obj->registerPool->ops->mdWriteInputCoilsPacked(obj->registerPool, addr, len, buf))
+#define mdRTU_ReadHoldReg(obj, addr, data) (obj->registerPool->ops->mdReadHoldRegister(obj->registerPool, addr, &data))
+#define mdRTU_WriteHoldRegs(obj, start_addr, len, data) (obj->registerPool->ops->mdWriteHoldRegisters(obj->registerPool, start_addr, len, (mdU16 *)&data))
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+#include "mdauth.h"
+
+#if (USER_MODBUS_LIB)
+#define mdAuthRotl(x, b) (((x) << (b)) | ((x) >> (32U - (b))))
+/*置换轮数(Chaskey-12)*/
+#define MD_AUTH_ROUNDS 12U
+
+/*
+    mdAuthPermute
+        @v      状态(4个32位字)
+        @return
+    接口：Chaskey置换，只用加法、循环移位及异或，每轮耗时固定
+*/
+static mdVOID mdAuthPermute(mdU32 *v)
+{
+    for (mdU32 i = 0; i < MD_AUTH_ROUNDS; i++)
+    {
+        v[0] += v[1];
+        v[1] = mdAuthRotl(v[1], 5U) ^ v[0];
+        v[0] = mdAuthRotl(v[0], 16U);
+        v[2] += v[3];
+        v[3] = mdAuthRotl(v[3], 8U) ^ v[2];
+        v[0] += v[3];
+        v[3] = mdAuthRotl(v[3], 13U) ^ v[0];
+        v[2] += v[1];
+        v[1] = mdAuthRotl(v[1], 7U) ^ v[2];
+        v[2] = mdAuthRotl(v[2], 16U);
+    }
+}
+
+/*
+    mdAuthTimesTwo
+        @out    结果
+        @in     输入
+        @return
+    接口：GF(2^128)中乘以x，用于派生子密钥
+*/
+static mdVOID mdAuthTimesTwo(mdU32 *out, const mdU32 *in)
+{
+    mdU32 carry = (in[3] >> 31U) ? 0x87U : 0x00U;
+
+    out[3] = (in[3] << 1U) | (in[2] >> 31U);
+    out[2] = (in[2] << 1U) | (in[1] >> 31U);
+    out[1] = (in[1] << 1U) | (in[0] >> 31U);
+    out[0] = (in[0] << 1U) ^ carry;
+}
+
+/*
+    mdAuthSetKey
+        @auth   认证上下文
+        @key    128位密钥(4个32位字)
+        @return
+*/
+mdVOID mdAuthSetKey(struct ModbusAuth *auth, const mdU32 key[4])
+{
+    for (mdU32 i = 0; i < 4U; i++)
+    {
+        auth->k[i] = key[i];
+    }
+    mdAuthTimesTwo(auth->k1, auth->k);
+    mdAuthTimesTwo(auth->k2, auth->k1);
+}
+
+/*
+    mdAuthByte
+        @domain 域
+        @nonce  随机数
+        @data   数据
+        @pos    消息内偏移
+        @return 消息 |域(4B)|随机数(4B)|数据| 中偏移 pos 处的字节
+*/
+static mdU32 mdAuthByte(mdU8 domain, mdU32 nonce, const mdU8 *data, mdU32 pos)
+{
+    if (pos < 4U)
+    {
+        return (pos == 0) ? domain : 0U;
+    }
+    if (pos < 8U)
+    {
+        return (nonce >> (8U * (pos - 4U))) & 0xFFU;
+    }
+    return data[pos - 8U];
+}
+
+/*
+    mdAuthTag
+        @auth   认证上下文
+        @domain MODBUS_AUTH_REQUEST 或 MODBUS_AUTH_REPLY
+        @nonce  随机数(请求为序号，应答为所应答请求的MAC)
+        @data   从机地址+PDU
+        @length 长度
+        @return 截断为24位的MAC
+    接口：Chaskey MAC，按16字节小端分块，耗时只与帧长有关
+*/
+mdU32 mdAuthTag(const struct ModbusAuth *auth, mdU8 domain, mdU32 nonce, const mdU8 *data, mdU32 length)
+{
+    mdU32 v[4], total = 8U + length, pos = 0, n;
+    const mdU32 *last;
+
+    for (mdU32 i = 0; i < 4U; i++)
+    {
+        v[i] = auth->k[i];
+    }
+    for (;;)
+    {
+        n = ((total - pos) > 16U) ? 16U : (total - pos);
+        for (mdU32 i = 0; i < n; i++)
+        {
+            v[i >> 2U] ^= mdAuthByte(domain, nonce, data, pos + i) << (8U * (i & 3U));
+        }
+        pos += n;
+        if (pos >= total)
+        {
+            break;
+        }
+        mdAuthPermute(v);
+    }
+    /*整块结尾与补齐(0x01及若干0)结尾使用不同的子密钥*/
+    if (n < 16U)
+    {
+        v[n >> 2U] ^= 0x01UL << (8U * (n & 3U));
+        last = auth->k2;
+    }
+    else
+    {
+        last = auth->k1;
+    }
+    for (mdU32 i = 0; i < 4U; i++)
+    {
+        v[i] ^= last[i];
+    }
+    mdAuthPermute(v);
+    v[0] ^= last[0];
+
+    return v[0] & MODBUS_AUTH_TAG_MASK;
+}
+
+/*
+    mdAuthSequence
+        @last   最后接受的序号
+        @low    帧中携带的序号低字节
+        @return 大于 last 且低字节为 low 的最小序号
+*/
+mdU32 mdAuthSequence(mdU32 last, mdU8 low)
+{
+    mdU32 seq = (last & ~0xFFUL) | low;
+
+    return (seq > last) ? seq : seq + 0x100UL;
+}
+#endif
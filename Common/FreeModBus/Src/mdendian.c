@@ -0,0 +1,86 @@
+#include "mdendian.h"
+
+/*
+    mdPackU16s
+        @buf     报文缓冲区(可不对齐)
+        @data    寄存器数组
+        @len     寄存器个数
+        @swap    mdTRUE时相邻两个寄存器交换(高位字在前的32位数据，见 mdSetWordOrder)
+        @return
+    接口：寄存器按大端写入报文；两个寄存器作为一个32位字处理，不交换时为REV16，交换时为REV，
+    奇数个寄存器时最后一个单独写入(不参与交换)
+*/
+mdVOID mdPackU16s(mdU8 *buf, const mdU16 *data, mdU32 len, mdBOOL swap)
+{
+    const mdU16 *end = data + (len & ~1UL);
+
+    if (swap)
+    {
+        for (; data < end; data += 2, buf += 4)
+        {
+            mdStoreU32(buf, mdREV(mdLoadU32(data)));
+        }
+    }
+    else
+    {
+        for (; data < end; data += 2, buf += 4)
+        {
+            mdStoreU32(buf, mdREV16(mdLoadU32(data)));
+        }
+    }
+    if (len & 1U)
+    {
+        buf[0] = (mdU8)(*data >> 8U);
+        buf[1] = (mdU8)*data;
+    }
+}
+
+/*
+    mdUnpackU16s
+        @data    寄存器数组
+        @buf     报文缓冲区(可不对齐)
+        @len     寄存器个数
+        @swap    mdTRUE时相邻两个寄存器交换
+        @return
+    接口：从报文中按大端读出寄存器，为 mdPackU16s 的逆变换，每步处理两个寄存器
+*/
+mdVOID mdUnpackU16s(mdU16 *data, const mdU8 *buf, mdU32 len, mdBOOL swap)
+{
+    mdU16 *end = data + (len & ~1UL);
+
+    if (swap)
+    {
+        for (; data < end; data += 2, buf += 4)
+        {
+            mdStoreU32(data, mdREV(mdLoadU32(buf)));
+        }
+    }
+    else
+    {
+        for (; data < end; data += 2, buf += 4)
+        {
+            mdStoreU32(data, mdREV16(mdLoadU32(buf)));
+        }
+    }
+    if (len & 1U)
+    {
+        *data = (mdU16)(((mdU16)buf[0] << 8U) | buf[1]);
+    }
+}
+
+/*
+    mdSwapU16Pairs
+        @data    交换的缓冲区
+        @len     长度
+        @return
+    接口：交换相邻两个半字，每步一次32位循环移位；奇数长度时最后一个不变
+*/
+mdVOID mdSwapU16Pairs(mdU16 *data, mdU32 len)
+{
+    mdU16 *end = data + (len & ~1UL);
+
+    for (; data < end; data += 2)
+    {
+        mdStoreU32(data, mdROR16(mdLoadU32(data)));
+    }
+}
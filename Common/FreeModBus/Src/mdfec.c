@@ -0,0 +1,373 @@
+#include "mdfec.h"
+#include "mdcrc16.h"
+#include <string.h>
+
+#if (USER_MODBUS_LIB)
+#define MD_FEC_PARITY_MAX (2U * MODBUS_FEC_MAX)
+/*一个码字的最大长度:交织深度满时每个码字的数据字节数加校验字节数，帧长小于深度时为1加校验字节数*/
+#define MD_FEC_CODEWORD_MAX ((MODBUS_PDU_SIZE_MAX + MODBUS_FEC_DEPTH - 1U) / MODBUS_FEC_DEPTH + MD_FEC_PARITY_MAX)
+
+/*GF(256)(本原多项式0x11D)的指数表及对数表，α=0x02*/
+static const mdU8 mdFecExp[255] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+    0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+    0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+    0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+    0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+    0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+    0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+    0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+    0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+    0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+    0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+    0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+    0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+    0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+    0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E
+};
+
+static const mdU8 mdFecLog[256] = {
+    0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+    0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+    0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+    0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+    0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+    0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+    0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+    0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+    0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+    0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+    0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+    0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+    0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+    0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+    0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+    0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+/*
+    mdFecMul
+        @a      乘数
+        @b      乘数
+        @return GF(256)中的积
+*/
+static mdU8 mdFecMul(mdU8 a, mdU8 b)
+{
+    if ((a == 0) || (b == 0))
+    {
+        return 0;
+    }
+    return mdFecExp[((mdU32)mdFecLog[a] + mdFecLog[b]) % 255U];
+}
+
+/*
+    mdFecDiv
+        @a      被除数
+        @b      除数(非0)
+        @return GF(256)中的商
+*/
+static mdU8 mdFecDiv(mdU8 a, mdU8 b)
+{
+    if (a == 0)
+    {
+        return 0;
+    }
+    return mdFecExp[((mdU32)mdFecLog[a] + 255U - mdFecLog[b]) % 255U];
+}
+
+/*
+    mdFecGenerator
+        @g      生成多项式系数(高次在前，nsym+1项)
+        @nsym   校验字节数
+        @return
+    接口：g(x) = (x - α^0)(x - α^1)...(x - α^(nsym-1))
+*/
+static mdVOID mdFecGenerator(mdU8 *g, mdU32 nsym)
+{
+    memset(g, 0, nsym + 1U);
+    g[0] = 1U;
+    for (mdU32 i = 0; i < nsym; i++)
+    {
+        for (mdU32 j = i + 1U; j > 0; j--)
+        {
+            g[j] ^= mdFecMul(g[j - 1U], mdFecExp[i]);
+        }
+    }
+}
+
+/*
+    mdFecGeometry
+        @total  数据及校验的字节数(不含标记)
+        @nsym   每个码字的校验字节数
+        @length 返回数据字节数
+        @depth  返回交织深度
+        @return 长度与纠错等级相符返回 mdTRUE
+    接口：由接收到的帧长推算编码时的数据长度及交织深度(与 mdFecEncode 的取法一致)
+*/
+static mdSTATUS mdFecGeometry(mdU32 total, mdU32 nsym, mdU32 *length, mdU32 *depth)
+{
+    if (total >= MODBUS_FEC_DEPTH * (1U + nsym))
+    {
+        *depth = MODBUS_FEC_DEPTH;
+        *length = total - nsym * MODBUS_FEC_DEPTH;
+        return mdTRUE;
+    }
+    if ((total % (1U + nsym)) || (total == 0))
+    {
+        return mdFALSE;
+    }
+    *length = *depth = total / (1U + nsym);
+    return mdTRUE;
+}
+
+/*
+    mdFecCorrect
+        @cw     码字(高次在前，末尾nsym个字节为校验)
+        @n      码字长度
+        @nsym   校验字节数
+        @fixed  返回纠正的字节数
+        @return 码字无误或已纠正返回 mdTRUE，错误超过纠错能力返回 mdFALSE
+    接口：伴随式 -> Berlekamp-Massey求错误位置多项式 -> Chien搜索错误位置 -> Forney算法求错误值
+*/
+static mdSTATUS mdFecCorrect(mdU8 *cw, mdU32 n, mdU32 nsym, mdU32 *fixed)
+{
+    mdU8 s[MD_FEC_PARITY_MAX], c[MD_FEC_PARITY_MAX + 1U], b[MD_FEC_PARITY_MAX + 1U], t[MD_FEC_PARITY_MAX + 1U];
+    mdU8 omega[MD_FEC_PARITY_MAX], pos[MD_FEC_PARITY_MAX], xi, d, bd = 1U, value, den, x;
+    mdU32 errors = 0, shift = 1U, found = 0, p;
+    mdBOOL clean = mdTRUE;
+
+    *fixed = 0;
+    /*伴随式 S_i = r(α^i)*/
+    for (mdU32 i = 0; i < nsym; i++)
+    {
+        s[i] = 0;
+        for (mdU32 k = 0; k < n; k++)
+        {
+            s[i] = mdFecMul(s[i], mdFecExp[i]) ^ cw[k];
+        }
+        clean = s[i] ? mdFALSE : clean;
+    }
+    if (clean)
+    {
+        return mdTRUE;
+    }
+    /*Berlekamp-Massey:c 为错误位置多项式(低次在前)*/
+    memset(c, 0, sizeof(c));
+    memset(b, 0, sizeof(b));
+    c[0] = b[0] = 1U;
+    for (mdU32 r = 0; r < nsym; r++)
+    {
+        d = s[r];
+        for (mdU32 i = 1; i <= errors; i++)
+        {
+            d ^= mdFecMul(c[i], s[r - i]);
+        }
+        if (d == 0)
+        {
+            shift++;
+            continue;
+        }
+        memcpy(t, c, sizeof(c));
+        for (mdU32 i = shift; i <= nsym; i++)
+        {
+            c[i] ^= mdFecMul(mdFecDiv(d, bd), b[i - shift]);
+        }
+        if (2U * errors <= r)
+        {
+            errors = r + 1U - errors;
+            memcpy(b, t, sizeof(b));
+            bd = d;
+            shift = 1U;
+        }
+        else
+        {
+            shift++;
+        }
+    }
+    if (2U * errors > nsym)
+    {
+        return mdFALSE;
+    }
+    /*Chien搜索:第k个字节的次数为 n-1-k，错误位置多项式在 α^-(n-1-k) 处为0*/
+    for (mdU32 k = 0; k < n; k++)
+    {
+        p = n - 1U - k;
+        xi = mdFecExp[(255U - p % 255U) % 255U];
+        value = 0;
+        x = 1U;
+        for (mdU32 i = 0; i <= errors; i++)
+        {
+            value ^= mdFecMul(c[i], x);
+            x = mdFecMul(x, xi);
+        }
+        if (value == 0)
+        {
+            if (found >= errors)
+            {
+                return mdFALSE;
+            }
+            pos[found++] = (mdU8)k;
+        }
+    }
+    if (found != errors)
+    {
+        return mdFALSE;
+    }
+    /*错误值多项式 Ω(x) = S(x)Λ(x) mod x^nsym*/
+    for (mdU32 i = 0; i < nsym; i++)
+    {
+        omega[i] = 0;
+        for (mdU32 j = 0; (j <= i) && (j <= errors); j++)
+        {
+            omega[i] ^= mdFecMul(s[i - j], c[j]);
+        }
+    }
+    /*Forney(首个根为α^0):e = X·Ω(X^-1)/Λ'(X^-1)*/
+    for (mdU32 e = 0; e < found; e++)
+    {
+        p = n - 1U - pos[e];
+        xi = mdFecExp[(255U - p % 255U) % 255U];
+        value = den = 0;
+        x = 1U;
+        for (mdU32 i = 0; i < nsym; i++)
+        {
+            value ^= mdFecMul(omega[i], x);
+            /*形式导数只保留奇次项:Λ'(x) = Σ Λ_i·x^(i-1)，i 为奇数*/
+            if ((i & 1U) && (i <= errors))
+            {
+                den ^= mdFecMul(c[i], mdFecDiv(x, xi));
+            }
+            x = mdFecMul(x, xi);
+        }
+        if (den == 0)
+        {
+            return mdFALSE;
+        }
+        cw[pos[e]] ^= mdFecMul(mdFecExp[p % 255U], mdFecDiv(value, den));
+    }
+    *fixed = found;
+    return mdTRUE;
+}
+
+/*
+    mdFecEncode
+        @buf    帧(从机地址+PDU+CRC)，就地编码为线路帧
+        @length 帧长
+        @size   缓冲区容量
+        @level  纠错等级(1~MODBUS_FEC_MAX)
+        @return 线路帧长度，等级无效或编码后超过缓冲区及接收帧容量时返回0(帧未改动)
+    接口：第i个字节属于第 i%深度 个码字，校验字节排在数据之后并延续同一交织顺序，
+    线路上任意连续 等级*深度 个字节中每个码字最多占 等级 个
+*/
+mdU32 mdFecEncode(mdU8 *buf, mdU32 length, mdU32 size, mdU8 level)
+{
+    mdU8 g[MD_FEC_PARITY_MAX + 1U], par[MD_FEC_PARITY_MAX], fb;
+    mdU32 nsym = 2U * level, depth = (length < MODBUS_FEC_DEPTH) ? length : MODBUS_FEC_DEPTH;
+    mdU32 total = 1U + length + nsym * depth;
+    mdU8 *body = &buf[1];
+
+    if ((level == MODBUS_FEC_OFF) || (level > MODBUS_FEC_MAX) || (length == 0) || (total > size) ||
+        (total > MODBUS_PDU_SIZE_MAX))
+    {
+        return 0;
+    }
+    memmove(body, buf, length);
+    buf[0] = (mdU8)(MODBUS_FEC_MARK + level);
+    mdFecGenerator(g, nsym);
+    for (mdU32 j = 0; j < depth; j++)
+    {
+        memset(par, 0, nsym);
+        for (mdU32 k = j; k < length; k += depth)
+        {
+            /*除以生成多项式的移位寄存器，余式即校验*/
+            fb = body[k] ^ par[0];
+            for (mdU32 i = 0; i + 1U < nsym; i++)
+            {
+                par[i] = par[i + 1U] ^ mdFecMul(fb, g[i + 1U]);
+            }
+            par[nsym - 1U] = mdFecMul(fb, g[nsym]);
+        }
+        for (mdU32 i = 0; i < nsym; i++)
+        {
+            body[length + (j + depth - length % depth) % depth + i * depth] = par[i];
+        }
+    }
+    return total;
+}
+
+/*
+    mdFecDecode
+        @buf       线路帧，就地还原为原帧
+        @length    线路帧长度
+        @corrected 返回纠正的字节数
+        @return    原帧长度，不是纠错编码的帧、长度不符或错误超过纠错能力时返回0
+*/
+mdU32 mdFecDecode(mdU8 *buf, mdU32 length, mdU32 *corrected)
+{
+    mdU8 cw[MD_FEC_CODEWORD_MAX];
+    mdU32 level = mdFecLevel(buf, length), nsym = 2U * level, data, depth, n, k, fixed;
+    mdU8 *body = &buf[1];
+
+    *corrected = 0;
+    if ((level == MODBUS_FEC_OFF) || !mdFecGeometry(length - 1U, nsym, &data, &depth))
+    {
+        return 0;
+    }
+    for (mdU32 j = 0; j < depth; j++)
+    {
+        /*取出第j个码字:数据字节在前，校验字节在后*/
+        for (n = 0, k = j; k < data; k += depth)
+        {
+            cw[n++] = body[k];
+        }
+        for (mdU32 i = 0; i < nsym; i++)
+        {
+            cw[n++] = body[data + (j + depth - data % depth) % depth + i * depth];
+        }
+        if (!mdFecCorrect(cw, n, nsym, &fixed))
+        {
+            return 0;
+        }
+        *corrected += fixed;
+        for (n = 0, k = j; (k < data) && fixed; k += depth)
+        {
+            body[k] = cw[n++];
+        }
+    }
+    memmove(buf, body, data);
+    return data;
+}
+
+/*
+    mdFecReceive
+        @recbuf 接收缓冲区(当前帧)
+        @stats  纠错统计
+        @return 当前帧的纠错等级，不是纠错编码的帧返回 MODBUS_FEC_OFF
+    接口：纠错编码的帧就地还原为RTU帧并更新 count/crcValid；无法纠正时帧不变且 crcValid 为 mdFALSE
+*/
+mdU8 mdFecReceive(ReceiveBufferHandle recbuf, struct ModbusFecStats *stats)
+{
+    mdU8 level = mdFecLevel(recbuf->buf, recbuf->count);
+    mdU32 corrected, length;
+
+    stats->last = 0;
+    if (level == MODBUS_FEC_OFF)
+    {
+        return MODBUS_FEC_OFF;
+    }
+    stats->frames++;
+    length = mdFecDecode(recbuf->buf, recbuf->count, &corrected);
+    if (length == 0)
+    {
+        stats->failed++;
+        recbuf->crcValid = mdFALSE;
+        return level;
+    }
+    stats->corrected += corrected;
+    stats->last = corrected;
+    recbuf->count = length;
+    recbuf->crcValid = ((length >= 4U) && (mdCrc16(recbuf->buf, length) == 0)) ? mdTRUE : mdFALSE;
+    return level;
+}
+#endif
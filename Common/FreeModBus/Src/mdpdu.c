@@ -0,0 +1,127 @@
+#include "mdpdu.h"
+#include "mdrtuslave.h"
+#include <string.h>
+
+#if (USER_MODBUS_LIB)
+/*
+    mdPduRange
+        @start  起始地址
+        @number 数量
+        @max    协议规定的最大数量
+        @size   寄存器池中该组的容量
+        @return 合法返回 MODBUS_PDU_OK，否则返回异常码
+*/
+static mdU8 mdPduRange(mdU32 start, mdU32 number, mdU32 max, mdU32 size)
+{
+    if ((number == 0) || (number > max))
+    {
+        return MODBUS_PDU_VALUE;
+    }
+    return (start + number <= size) ? MODBUS_PDU_OK : MODBUS_PDU_ADDRESS;
+}
+
+/*
+    mdPduParse
+        @view   视图
+        @frame  RTU帧(从机地址+PDU+CRC，CRC已校验)
+        @length 帧长度
+        @return 合法返回 MODBUS_PDU_OK，否则返回异常码
+    接口：检查标准功能码请求的帧长度、字节数、数量及地址范围并填写视图，之后处理函数不会越界读取接收帧，
+    也不会越界读写寄存器池或超出发送缓冲区；其他功能码只填写站号及功能码，由各自的处理函数检查
+*/
+mdU8 mdPduParse(struct ModbusPduView *view, mdU8 *frame, mdU32 length)
+{
+    mdU8 ret;
+
+    memset(view, 0, sizeof(*view));
+    if (length < 4U)
+    {
+        return MODBUS_PDU_VALUE;
+    }
+    view->id = frame[0];
+    view->code = frame[1];
+    switch (view->code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+    case MODBUS_CODE_5:
+    case MODBUS_CODE_6:
+        if (length != 8U)
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        break;
+    case MODBUS_CODE_15:
+    case MODBUS_CODE_16:
+        /*从机地址+功能码+起始地址+数量+字节数+数据+CRC*/
+        if ((length < 9U) || (length != 9U + frame[6]))
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        view->data = &frame[7];
+        view->bytes = frame[6];
+        break;
+    case MODBUS_CODE_23:
+        /*读地址/数量之后为写地址/数量、字节数及数据*/
+        if ((length < 13U) || (length != 13U + frame[10]))
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        view->writeStart = ToU16(frame[6], frame[7]);
+        view->writeNumber = ToU16(frame[8], frame[9]);
+        view->data = &frame[11];
+        view->bytes = frame[10];
+        break;
+    default:
+        return MODBUS_PDU_OK;
+    }
+    view->start = ToU16(frame[2], frame[3]);
+    view->number = ToU16(frame[4], frame[5]);
+    switch (view->code)
+    {
+    case MODBUS_CODE_1:
+        return mdPduRange(view->start, view->number, MODBUS_READ_BITS_MAX, COIL_POOL_SIZE);
+    case MODBUS_CODE_2:
+        return mdPduRange(view->start, view->number, MODBUS_READ_BITS_MAX, INPUT_COIL_POOL_SIZE);
+    case MODBUS_CODE_3:
+        return mdPduRange(view->start, view->number, MODBUS_READ_REGS_MAX, HOLD_REGISTER_POOL_SIZE);
+    case MODBUS_CODE_4:
+        return mdPduRange(view->start, view->number, MODBUS_READ_REGS_MAX, INPUT_REGISTER_POOL_SIZE);
+    case MODBUS_CODE_5:
+        view->value = view->number;
+        view->number = 1U;
+        /*线圈值只能为 0xFF00 或 0x0000*/
+        if ((view->value != 0xFF00U) && (view->value != 0))
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        return mdPduRange(view->start, 1U, 1U, COIL_POOL_SIZE);
+    case MODBUS_CODE_6:
+        view->value = view->number;
+        view->number = 1U;
+        return mdPduRange(view->start, 1U, 1U, HOLD_REGISTER_POOL_SIZE);
+    case MODBUS_CODE_15:
+        if (view->bytes != (view->number + 7U) / 8U)
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        return mdPduRange(view->start, view->number, MODBUS_WRITE_BITS_MAX, COIL_POOL_SIZE);
+    case MODBUS_CODE_16:
+        if (view->bytes != view->number * 2U)
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        return mdPduRange(view->start, view->number, MODBUS_WRITE_REGS_MAX, HOLD_REGISTER_POOL_SIZE);
+    default:
+        if (view->bytes != view->writeNumber * 2U)
+        {
+            return MODBUS_PDU_VALUE;
+        }
+        ret = mdPduRange(view->start, view->number, MODBUS_CODE23_READ_MAX, HOLD_REGISTER_POOL_SIZE);
+        return ret ? ret
+                   : mdPduRange(view->writeStart, view->writeNumber, MODBUS_CODE23_WRITE_MAX, HOLD_REGISTER_POOL_SIZE);
+    }
+}
+#endif
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "main.h"
+#include "mdpool.h"
+#include "mdrtuslave.h"
+#if (MODBUS_ROLE_MASTER)
+#include "mdrtumaster.h"
+#endif
+#include "shell_port.h"
+
+#if (USER_MODBUS_LIB)
+/*块大小按字取整，保证每个块都满足对象的对齐要求*/
+#define mdPoolWords(type) ((sizeof(type) + sizeof(mdU32) - 1U) / sizeof(mdU32))
+/*池的存储区(链接时分配)及池描述*/
+#define mdPoolStorage(name, type, blocks) static mdU32 name##Storage[blocks][mdPoolWords(type)]
+#define mdPoolEntry(name, type, blocks) \
+    {#name, mdPoolWords(type) * sizeof(mdU32), blocks, (mdU8 *)name##Storage, NULL, mdFALSE, 0, 0, 0}
+
+/*每个从机的各逻辑单元各占一个寄存器池*/
+mdPoolStorage(slave, struct ModbusRTUSlave, MODBUS_POOL_BLOCKS);
+mdPoolStorage(regpool, struct RegisterPool, MODBUS_POOL_BLOCKS * MODBUS_UNITS);
+mdPoolStorage(recbuffer, struct ReceiveBuffer, MODBUS_POOL_BLOCKS);
+#if (MODBUS_ROLE_MASTER)
+mdPoolStorage(master, struct ModbusRTUMaster, MODBUS_POOL_BLOCKS);
+#endif
+
+static struct mdPool mdPools[] = {
+    mdPoolEntry(slave, struct ModbusRTUSlave, MODBUS_POOL_BLOCKS),
+    mdPoolEntry(regpool, struct RegisterPool, MODBUS_POOL_BLOCKS * MODBUS_UNITS),
+    mdPoolEntry(recbuffer, struct ReceiveBuffer, MODBUS_POOL_BLOCKS),
+#if (MODBUS_ROLE_MASTER)
+    mdPoolEntry(master, struct ModbusRTUMaster, MODBUS_POOL_BLOCKS),
+#endif
+};
+#define mdPoolCount() (sizeof(mdPools) / sizeof(mdPools[0]))
+
+/*
+    mdPoolInit
+        @pool   内存池
+        @return
+    首次使用时把全部块串入空闲链表(关中断后调用)
+*/
+static mdVOID mdPoolInit(struct mdPool *pool)
+{
+    pool->freeList = NULL;
+    for (mdU32 i = pool->blocks; i > 0; i--)
+    {
+        mdVOID **block = (mdVOID **)&pool->base[(i - 1U) * pool->blockSize];
+        *block = pool->freeList;
+        pool->freeList = block;
+    }
+    pool->ready = mdTRUE;
+}
+
+/*
+    mdPoolAlloc
+        @size   需要的字节数
+        @return 成功返回块地址，没有对应的池或池已空时返回 NULL
+    接口：从块大小不小于 size 的最小池中取一块；各对象大小不同，即从该对象专用的池中分配。
+    只在关中断期间操作空闲链表，不挂起调度器
+*/
+mdVOID *mdPoolAlloc(mdU32 size)
+{
+    struct mdPool *fit = NULL;
+    mdVOID **block = NULL;
+    mdU32 primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (mdU32 i = 0; i < mdPoolCount(); i++)
+    {
+        if ((mdPools[i].blockSize >= size) && ((fit == NULL) || (mdPools[i].blockSize < fit->blockSize)))
+        {
+            fit = &mdPools[i];
+        }
+    }
+    if (fit != NULL)
+    {
+        if (!fit->ready)
+        {
+            mdPoolInit(fit);
+        }
+        block = (mdVOID **)fit->freeList;
+        if (block != NULL)
+        {
+            fit->freeList = *block;
+            fit->used++;
+            fit->peak = (fit->used > fit->peak) ? fit->used : fit->peak;
+        }
+        else
+        {
+            fit->failed++;
+        }
+    }
+    __set_PRIMASK(primask);
+    return block;
+}
+
+/*
+    mdPoolFree
+        @block  mdPoolAlloc 取得的块，为 NULL 或不属于任何池时忽略
+        @return
+    接口：按地址找到所属的池并归还该块
+*/
+mdVOID mdPoolFree(mdVOID *block)
+{
+    mdU8 *p = (mdU8 *)block;
+    mdU32 primask;
+
+    if (block == NULL)
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (mdU32 i = 0; i < mdPoolCount(); i++)
+    {
+        struct mdPool *pool = &mdPools[i];
+        if (pool->ready && (p >= pool->base) && (p < &pool->base[pool->blocks * pool->blockSize]))
+        {
+            *(mdVOID **)block = pool->freeList;
+            pool->freeList = block;
+            pool->used--;
+            break;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/*
+    mdPoolShow
+        @return
+    接口：打印各内存池的块大小、占用及高水位
+*/
+mdVOID mdPoolShow(void)
+{
+    for (mdU32 i = 0; i < mdPoolCount(); i++)
+    {
+        shellPrint(&shell, "%-10s size = %4lu, blocks = %lu, used = %lu, peak = %lu, failed = %lu\r\n", mdPools[i].name,
+                   (unsigned long)mdPools[i].blockSize, (unsigned long)mdPools[i].blocks,
+                   (unsigned long)mdPools[i].used, (unsigned long)mdPools[i].peak, (unsigned long)mdPools[i].failed);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), mdpool, mdPoolShow, show modbus pools);
+
+#endif
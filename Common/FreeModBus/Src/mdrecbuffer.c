@@ -0,0 +1,202 @@
+
+#include "mdrecbuffer.h"
+#include "mdcrc16.h"
+#include "mdfec.h"
+#include "mdpool.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+#if(USER_MODBUS_LIB)
+#define mdNextFrame(n) (((n) + 1U) % RECEIVE_BUFFER_FRAMES)
+/*纠错编码的帧须先解码才能校验CRC及站号，中断中不过滤*/
+#if (MODBUS_FEC)
+#define mdReceiveBufferFec(buf, count) (mdFecLevel(buf, count) != MODBUS_FEC_OFF)
+#else
+#define mdReceiveBufferFec(buf, count) (mdFALSE)
+#endif
+
+/*
+    mdResetFrame
+        @frame 帧
+    DMA开始写入新帧前复位其增量CRC
+*/
+static mdVOID mdResetFrame(struct ReceiveFrame *frame)
+{
+    frame->count = 0;
+    frame->crc = MD_CRC16_INIT;
+    frame->scanned = 0;
+}
+
+/*
+    mdClearReceiveBuffer
+        @handler 句柄
+        @return
+    复位接收缓冲:释放当前正在处理的帧，使其可被DMA重新使用；
+    只复位长度及CRC状态，不清除数据(DMA会覆盖，解析不读取 count 之后的字节)
+*/
+mdVOID mdClearReceiveBuffer(ReceiveBufferHandle handler)
+{
+    if ((handler->count > 0) && (handler->tail != handler->head))
+    {
+        mdResetFrame(&handler->frame[handler->tail]);
+        handler->tail = mdNextFrame(handler->tail);
+    }
+    handler->count = 0;
+}
+
+/*
+    mdReceiveBufferTarget
+        @handler 句柄
+        @return  DMA接收地址
+    获取DMA当前应写入的帧
+*/
+mdU8 *mdReceiveBufferTarget(ReceiveBufferHandle handler)
+{
+    return handler->frame[handler->head].buf;
+}
+
+/*
+    mdReceiveBufferPending
+        @handler 句柄
+        @return  当前帧已接收的字节数
+    获取正在接收(尚未提交)的帧长度
+*/
+mdU32 mdReceiveBufferPending(ReceiveBufferHandle handler)
+{
+    return handler->frame[handler->head].count;
+}
+
+/*
+    mdReceiveBufferScan
+        @handler  句柄
+        @received DMA已写入当前帧的字节数
+        @return
+    中断中调用(DMA半满/全满/空闲):对新收到的字节增量计算CRC，帧结束时无需再整帧校验
+*/
+mdVOID mdReceiveBufferScan(ReceiveBufferHandle handler, mdU32 received)
+{
+    struct ReceiveFrame *frame = &handler->frame[handler->head];
+
+    received = received < MODBUS_PDU_SIZE_MAX ? received : MODBUS_PDU_SIZE_MAX;
+    if (received > frame->scanned)
+    {
+        frame->crc = mdCrc16Update(frame->crc, &frame->buf[frame->scanned], received - frame->scanned);
+        frame->scanned = received;
+    }
+}
+
+/*
+    mdReceiveBufferCommit
+        @handler 句柄
+        @count   本帧接收到的字节数
+        @return  本帧被接收返回 mdTRUE，需要唤醒任务处理
+    中断中调用:将DMA写完的帧交给任务处理并切换到空闲帧(由 mdReceiveBufferTarget 取得)；
+    启用过滤时丢弃CRC错误或非本站的帧(纠错编码的帧除外)；没有空闲帧时丢弃本帧，DMA继续使用原来的帧
+*/
+mdSTATUS mdReceiveBufferCommit(ReceiveBufferHandle handler, mdU32 count)
+{
+    struct ReceiveFrame *frame = &handler->frame[handler->head];
+    mdU32 next = mdNextFrame(handler->head);
+
+    mdReceiveBufferScan(handler, count);
+    if ((count == 0) || (next == handler->tail) ||
+        (handler->filter && !mdReceiveBufferFec(frame->buf, count) &&
+         ((count < 4U) || (frame->crc != 0) ||
+          ((handler->filterMap[frame->buf[0]] == 0) && (frame->buf[0] != handler->broadcastId)))))
+    {
+        handler->rejected += (count > 0) ? 1U : 0U;
+        handler->crcErrors += (handler->filter && (count >= 4U) && (frame->crc != 0)) ? 1U : 0U;
+        mdResetFrame(frame);
+        return mdFALSE;
+    }
+    frame->count = count;
+    handler->head = next;
+    mdResetFrame(&handler->frame[next]);
+    return mdTRUE;
+}
+
+/*
+    mdReceiveBufferDiscard
+        @handler 句柄
+        @return
+    中断中调用:丢弃DMA正在写入的帧(如帧内字符间隔超过t1.5)，计入拒收统计
+*/
+mdVOID mdReceiveBufferDiscard(ReceiveBufferHandle handler)
+{
+    handler->rejected++;
+    mdResetFrame(&handler->frame[handler->head]);
+}
+
+/*
+    mdReceiveBufferFilter
+        @handler     句柄
+        @map         按站号索引的接收表(256项，非0为本站)，须在过滤期间保持有效
+        @broadcastId 广播地址
+        @return
+    启用中断中的帧过滤:仅CRC正确且发往本站任一逻辑单元或广播地址的帧会交给任务
+*/
+mdVOID mdReceiveBufferFilter(ReceiveBufferHandle handler, const mdU8 *map, mdU8 broadcastId)
+{
+    handler->filterMap = map;
+    handler->broadcastId = broadcastId;
+    handler->filter = mdTRUE;
+}
+
+
+/*
+    mdReceiveBufferFetch
+        @handler 句柄
+        @return  有待处理帧时返回 mdTRUE
+    任务中调用:取出最早接收到的帧作为当前帧(buf/count)，当前帧未释放时直接返回
+*/
+mdSTATUS mdReceiveBufferFetch(ReceiveBufferHandle handler)
+{
+    if (handler->count > 0)
+    {
+        return mdTRUE;
+    }
+    if (handler->tail == handler->head)
+    {
+        return mdFALSE;
+    }
+    handler->buf = handler->frame[handler->tail].buf;
+    handler->count = handler->frame[handler->tail].count;
+    handler->crcValid = (handler->frame[handler->tail].crc == 0) ? mdTRUE : mdFALSE;
+    return mdTRUE;
+}
+
+/*
+    mdCreateReceiveBuffer
+        @handler 句柄
+        @return
+    创建并初始化接收缓冲
+*/
+mdSTATUS mdCreateReceiveBuffer(ReceiveBufferHandle *handler)
+{
+    mdmalloc((*handler), struct ReceiveBuffer, 1U);
+    if(!(*handler)){
+        return mdFALSE;
+    }
+    memset((*handler), 0, sizeof(struct ReceiveBuffer));
+    for (mdU32 i = 0; i < RECEIVE_BUFFER_FRAMES; i++)
+    {
+        mdResetFrame(&(*handler)->frame[i]);
+    }
+    (*handler)->buf = (*handler)->frame[0].buf;
+    return mdTRUE;
+}
+
+/*
+    mdDestoryReceiveBuffer
+        @handler 句柄
+        @return
+    销毁接收缓冲，释放内存
+*/
+mdVOID mdDestoryReceiveBuffer(ReceiveBufferHandle *handler)
+{
+    mdfree(*handler);
+    (*handler) = NULL;
+}
+#endif
+
@@ -0,0 +1,1078 @@
+#include "mdregpool.h"
+#include "mdpool.h"
+#include "mdendian.h"
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (USER_MODBUS_LIB)
+/* ================================================================== */
+/*                        底层代码                                     */
+/*              作用：按寄存器组划分静态存储区，O(1)定位任意地址寄存器          */
+/* ================================================================== */
+
+/*mdGetRegister 由高到低逐组比较偏移:各组偏移须递增且组间不重叠，否则地址会落入相邻组*/
+typedef char mdRegisterOffsetCheck[((COIL_OFFSET + mdBITS_TO_WORDS(COIL_POOL_SIZE) <= INPUT_COIL_OFFSET) &&
+                                    (INPUT_COIL_OFFSET + mdBITS_TO_WORDS(INPUT_COIL_POOL_SIZE) <= INPUT_REGISTER_OFFSET) &&
+                                    (INPUT_REGISTER_OFFSET + INPUT_REGISTER_POOL_SIZE <= HOLD_REGISTER_OFFSET))
+                                       ? 1
+                                       : -1];
+
+/*
+    mdGetRegister
+        @handler 句柄
+        @addr   寄存器地址(含组偏移)
+        @return 找到则返回寄存器所在位置，否则返回 NULL
+    根据寄存器地址所在的组和组内下标直接定位寄存器，不在任何组范围内时返回 NULL
+    线圈和输入状态按位压缩，组内第n个寄存器保存第16n~16n+15个位
+*/
+static mdU16 *mdGetRegister(RegisterPoolHandle handler, mdU32 addr)
+{
+    if (addr >= HOLD_REGISTER_OFFSET)
+    {
+        addr -= HOLD_REGISTER_OFFSET;
+        return addr < HOLD_REGISTER_POOL_SIZE ? &handler->holdRegisters[addr] : NULL;
+    }
+    if (addr >= INPUT_REGISTER_OFFSET)
+    {
+        addr -= INPUT_REGISTER_OFFSET;
+        return addr < INPUT_REGISTER_POOL_SIZE ? &handler->inputRegisters[addr] : NULL;
+    }
+    if (addr >= INPUT_COIL_OFFSET)
+    {
+        addr -= INPUT_COIL_OFFSET;
+        return addr < mdBITS_TO_WORDS(INPUT_COIL_POOL_SIZE) ? &handler->inputCoils[addr] : NULL;
+    }
+    if (addr >= COIL_OFFSET)
+    {
+        addr -= COIL_OFFSET;
+        return addr < mdBITS_TO_WORDS(COIL_POOL_SIZE) ? &handler->coils[addr] : NULL;
+    }
+    return NULL;
+}
+
+/*
+    mdMarkDirty
+        @handler 句柄
+        @index   变化标记表下标
+        @changed 新旧值的异或
+        @return
+    寄存器值确有变化时置位其变化标记并通知订阅了该下标的回调；
+    标记只做单字节写入，不与取走标记的一方竞争
+*/
+static mdVOID mdMarkDirty(RegisterPoolHandle handler, mdU32 index, mdU16 changed)
+{
+    if (changed == 0)
+    {
+        return;
+    }
+    handler->dirty[index] = 1U;
+    for (mdU32 i = 0; i < handler->watchCount; i++)
+    {
+        const struct mdRegisterWatch *watch = &handler->watches[i];
+        if ((index >= watch->from) && (index < watch->to))
+        {
+            watch->notify(handler, index, changed, watch->arg);
+        }
+    }
+}
+
+/*
+    mdGetRegisters
+        @handler 句柄
+        @addr   起始寄存器地址(含组偏移)
+        @len    寄存器个数
+        @return 整段都在同一组内时返回起始位置，否则返回 NULL
+    定位一段连续寄存器，用于批量读写
+*/
+static mdU16 *mdGetRegisters(RegisterPoolHandle handler, mdU32 addr, mdU32 len)
+{
+    mdU16 *first = mdGetRegister(handler, addr);
+    if ((first == NULL) || (len == 0))
+    {
+        return first;
+    }
+    mdU16 *last = mdGetRegister(handler, addr + len - 1U);
+    return (last == first + len - 1U) ? first : NULL;
+}
+
+/* ================================================================== */
+/*                        第二层封装                                    */
+/*     作用：位操作与按组访问，越界访问返回 mdFALSE                         */
+/* ================================================================== */
+
+#define ToBit(n) ((mdU32)n > 0 ? mdHigh : mdLow)
+
+/*
+    mdReadBit
+        @handler 句柄
+        @addr    位地址，如果寄存器位宽为16，则0~15都在第一个寄存器中，以此类推
+        @bit    位结果
+        @return 地址越界时返回 mdFALSE，否则 mdTRUE
+    根据地址在当前句柄中读取位大小
+*/
+static mdSTATUS mdReadBit(RegisterPoolHandle handler, mdU32 addr, mdBit *bit)
+{
+    mdU16 *reg = mdGetRegister(handler, mdBIT_WORD(addr));
+    if (reg == NULL)
+    {
+        (*bit) = mdLow;
+        return mdFALSE;
+    }
+    (*bit) = ToBit(mdGetBit(*reg, mdBIT_OFFSET(addr)));
+    return mdTRUE;
+}
+
+/*
+    mdWriteBit
+        @handler 句柄
+        @addr    位地址，如果寄存器位宽为16，则0~15都在第一个寄存器中，以此类推
+        @bit    位大小
+        @return 地址越界时返回 mdFALSE，否则 mdTRUE
+    根据地址修改当前句柄中的位大小，位值变化时只做一次位写入
+*/
+static mdSTATUS mdWriteBit(RegisterPoolHandle handler, mdU32 addr, mdBit bit)
+{
+    mdU16 *reg = mdGetRegister(handler, mdBIT_WORD(addr));
+    if (reg == NULL)
+    {
+        return mdFALSE;
+    }
+    if (mdGetBit(*reg, mdBIT_OFFSET(addr)) != ToBit(bit))
+    {
+        mdBitWrite(reg, mdBIT_OFFSET(addr), ToBit(bit));
+        mdMarkDirty(handler, reg - handler->coils, (mdU16)(1U << mdBIT_OFFSET(addr)));
+    }
+    return mdTRUE;
+}
+
+/*
+    mdReadBits
+        @handler 句柄
+        @addr    位地址，如果寄存器位宽为16，则0~15都在第一个寄存器中，以此类推
+        @len    长度
+        @bits    位数组
+        @return 存在越界地址时返回 mdFALSE，否则 mdTRUE
+    根据地址在当前句柄中读取 len 个位大小，结果保存在 bits中
+*/
+static mdSTATUS mdReadBits(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    mdSTATUS ret = mdTRUE;
+    for (mdU32 i = 0; i < len; i++)
+    {
+        if (mdReadBit(handler, addr + i, bits++) == mdFALSE)
+            ret = mdFALSE;
+    }
+    return ret;
+}
+
+/*
+    mdWriteBits
+        @handler 句柄
+        @addr    位地址，如果寄存器位宽为16，则0~15都在第一个寄存器中，以此类推
+        @len    长度
+        @bits    位数组
+        @return 存在越界地址时返回 mdFALSE，否则 mdTRUE
+    根据地址修改当前句柄中的 len 个位大小
+*/
+static mdSTATUS mdWriteBits(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    mdSTATUS ret = mdTRUE;
+    for (mdU32 i = 0; i < len; i++)
+    {
+        if (mdWriteBit(handler, addr + i, bits[i]) == mdFALSE)
+            ret = mdFALSE;
+    }
+    return ret;
+}
+
+/*
+    mdReadU16
+        @handler 句柄
+        @addr    寄存器地址
+        @data    寄存器数据
+        @return  地址越界时返回 mdFALSE(data置0)，否则 mdTRUE
+    根据地址读取一个寄存器值
+*/
+static mdSTATUS mdReadU16(RegisterPoolHandle handler, mdU32 addr, mdU16 *data)
+{
+    mdU16 *reg = mdGetRegister(handler, addr);
+    (*data) = (reg != NULL) ? *reg : 0;
+    return (reg != NULL) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdWriteU16
+        @handler 句柄
+        @addr    寄存器地址
+        @data    寄存器数据
+        @return  地址越界时返回 mdFALSE ,否则返回 mdTRUE
+    根据地址写入一个寄存器
+*/
+static mdSTATUS mdWriteU16(RegisterPoolHandle handler, mdU32 addr, mdU16 data)
+{
+    mdU16 *reg = mdGetRegister(handler, addr);
+    if (reg == NULL)
+    {
+        return mdFALSE;
+    }
+    mdU16 old = *reg;
+    (*reg) = data;
+    mdMarkDirty(handler, reg - handler->coils, old ^ data);
+    return mdTRUE;
+}
+
+/*
+    mdReadU16s
+        @handler 句柄
+        @addr    寄存器地址
+        @len    读取长度
+        @data    值数组
+        @return  存在越界地址时返回 mdFALSE(越界部分置0)，否则 mdTRUE
+    根据地址读取一组寄存器值，整段位于同一组时直接拷贝，拷贝期间有提交时重读(见 mdSnapshotBegin)
+*/
+static mdSTATUS mdReadU16s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    mdSTATUS ret = mdTRUE;
+    mdU16 *reg = mdGetRegisters(handler, addr, len);
+    if (reg != NULL)
+    {
+        mdU32 seq;
+        do
+        {
+            seq = mdSnapshotBegin(handler);
+            //经 volatile 访问，拷贝不会被编译器移出序号的两次读取之间
+            for (mdU32 i = 0; i < len; i++)
+            {
+                data[i] = ((volatile const mdU16 *)reg)[i];
+            }
+        } while (mdSnapshotRetry(handler, seq));
+        return mdTRUE;
+    }
+    for (mdU32 i = 0; i < len; i++)
+    {
+        if (mdReadU16(handler, addr + i, data++) == mdFALSE)
+            ret = mdFALSE;
+    }
+    return ret;
+}
+
+/*
+    mdWriteU16s
+        @handler 句柄
+        @addr    寄存器地址
+        @len    写入长度
+        @data    值数组
+        @return  存在越界地址时返回 mdFALSE(越界部分丢弃) ,否则返回 mdTRUE
+    根据地址写入一组寄存器值，只标记值有变化的寄存器；整段位于同一组时为一次原子提交:
+    关中断写入整段并递增提交序号，一致性读取的一方不会读到新旧各半的多寄存器数据(如浮点数)，
+    变化回调在关中断期间执行
+*/
+static mdSTATUS mdWriteU16s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    mdSTATUS ret = mdTRUE;
+    mdU16 *reg = mdGetRegisters(handler, addr, len);
+    if (reg != NULL)
+    {
+        mdU32 primask = __get_PRIMASK();
+        __disable_irq();
+        for (mdU32 i = 0; i < len; i++, reg++)
+        {
+            mdU16 old = *reg;
+            *reg = data[i];
+            mdMarkDirty(handler, reg - handler->coils, old ^ data[i]);
+        }
+        handler->seq++;
+        __set_PRIMASK(primask);
+        return mdTRUE;
+    }
+    for (mdU32 i = 0; i < len; i++)
+    {
+        if (mdWriteU16(handler, addr + i, *(data++)) == mdFALSE)
+            ret = mdFALSE;
+    }
+    return ret;
+}
+
+/*
+    mdWordSegment
+        @handler 句柄
+        @index   变化标记表下标
+        @len     剩余的寄存器个数
+        @mode    本段的处理方式
+        @return  本段寄存器个数
+    按登记的字顺序(见 mdSetWordOrder)划分报文中的一段寄存器:不在高位字在前区段内的寄存器不交换；
+    区段内从32位数据起始开始的成对交换；只取到32位数据中的一个寄存器时单独一段，报文中取同一数据的另一半
+*/
+#define mdSEGMENT_PLAIN 0U
+#define mdSEGMENT_SWAP 1U
+#define mdSEGMENT_PREV 2U
+#define mdSEGMENT_NEXT 3U
+static mdU32 mdWordSegment(RegisterPoolHandle handler, mdU32 index, mdU32 len, mdU8 *mode)
+{
+    mdU32 n = len;
+
+    *mode = mdSEGMENT_PLAIN;
+    for (mdU32 i = 0; i < handler->wordCount; i++)
+    {
+        const struct mdWordRange *range = &handler->words[i];
+        if ((index >= range->from) && (index < range->to))
+        {
+            n = ((range->to - index) < len) ? (range->to - index) : len;
+            if ((index - range->from) & 1U)
+            {
+                *mode = mdSEGMENT_PREV;
+                return 1U;
+            }
+            if (n == 1U)
+            {
+                *mode = mdSEGMENT_NEXT;
+                return 1U;
+            }
+            *mode = mdSEGMENT_SWAP;
+            return n & ~1UL;
+        }
+        if ((range->from > index) && (range->from - index < n))
+        {
+            n = range->from - index;
+        }
+    }
+    return n;
+}
+
+/*
+    mdPackSegment
+        @buf     报文缓冲区
+        @reg     本段第一个寄存器
+        @n       寄存器个数
+        @mode    处理方式(见 mdWordSegment)
+        @return
+    把一段寄存器按大端写入报文
+*/
+static mdVOID mdPackSegment(mdU8 *buf, const mdU16 *reg, mdU32 n, mdU8 mode)
+{
+    reg += (mode == mdSEGMENT_NEXT) ? 1 : ((mode == mdSEGMENT_PREV) ? -1 : 0);
+    mdPackU16s(buf, reg, n, (mdBOOL)(mode == mdSEGMENT_SWAP));
+}
+
+/*
+    mdStoreSegment
+        @handler 句柄
+        @reg     本段第一个寄存器
+        @buf     报文缓冲区
+        @n       寄存器个数
+        @mode    处理方式(见 mdWordSegment)
+        @return
+    把报文中的一段寄存器写入寄存器池，每次转换两个寄存器，只标记值有变化的寄存器
+*/
+static mdVOID mdStoreSegment(RegisterPoolHandle handler, mdU16 *reg, const mdU8 *buf, mdU32 n, mdU8 mode)
+{
+    mdU32 index;
+    uint32_t old, now;
+
+    reg += (mode == mdSEGMENT_NEXT) ? 1 : ((mode == mdSEGMENT_PREV) ? -1 : 0);
+    index = reg - handler->coils;
+    for (; n >= 2U; n -= 2U, reg += 2, buf += 4, index += 2U)
+    {
+        old = mdLoadU32(reg);
+        now = (mode == mdSEGMENT_SWAP) ? mdREV(mdLoadU32(buf)) : mdREV16(mdLoadU32(buf));
+        mdStoreU32(reg, now);
+        //两个半字在内存中的顺序与小端32位字的低、高半字一致
+        mdMarkDirty(handler, index, (mdU16)(old ^ now));
+        mdMarkDirty(handler, index + 1U, (mdU16)((old ^ now) >> 16U));
+    }
+    if (n)
+    {
+        mdU16 last = *reg;
+        *reg = (mdU16)(((mdU16)buf[0] << 8U) | buf[1]);
+        mdMarkDirty(handler, index, last ^ *reg);
+    }
+}
+
+/*
+    mdReadU16sPacked
+        @handler 句柄
+        @addr    寄存器地址
+        @len    读取长度
+        @buf     报文缓冲区(大端，可不对齐)
+        @return  存在越界地址时返回 mdFALSE(越界部分置0)，否则 mdTRUE
+    按报文格式读取一组寄存器，字顺序按登记的区段转换(见 mdSetWordOrder)，其余寄存器不交换；
+    整段位于同一组时每次打包两个寄存器(见 mdPackU16s)，拷贝期间有提交时重读
+*/
+static mdSTATUS mdReadU16sPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    mdSTATUS ret = mdTRUE;
+    mdU16 *reg = mdGetRegisters(handler, addr, len);
+    mdU32 index, n, seq;
+    mdU8 mode;
+    if (reg != NULL)
+    {
+        index = reg - handler->coils;
+        do
+        {
+            seq = mdSnapshotBegin(handler);
+            for (mdU32 i = 0; i < len; i += n)
+            {
+                n = mdWordSegment(handler, index + i, len - i, &mode);
+                mdPackSegment(&buf[2U * i], &reg[i], n, mode);
+            }
+        } while (mdSnapshotRetry(handler, seq));
+        return mdTRUE;
+    }
+    for (mdU32 i = 0; i < len; i++, buf += 2)
+    {
+        reg = mdGetRegister(handler, addr + i);
+        if (reg == NULL)
+        {
+            buf[0] = buf[1] = 0;
+            ret = mdFALSE;
+            continue;
+        }
+        mdWordSegment(handler, reg - handler->coils, 1U, &mode);
+        mdPackSegment(buf, reg, 1U, mode);
+    }
+    return ret;
+}
+
+/*
+    mdWriteU16sPacked
+        @handler 句柄
+        @addr    寄存器地址
+        @len    写入长度
+        @buf     报文缓冲区(大端，可不对齐)
+        @return  存在越界地址时返回 mdFALSE(越界部分丢弃) ,否则返回 mdTRUE
+    按报文格式写入一组寄存器，为 mdReadU16sPacked 的逆变换；整段位于同一组时与 mdWriteU16s 一样为一次原子提交
+*/
+static mdSTATUS mdWriteU16sPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const mdU8 *buf)
+{
+    mdSTATUS ret = mdTRUE;
+    mdU16 *reg = mdGetRegisters(handler, addr, len);
+    mdU32 index, n;
+    mdU8 mode;
+    if (reg != NULL)
+    {
+        mdU32 primask = __get_PRIMASK();
+        index = reg - handler->coils;
+        __disable_irq();
+        for (mdU32 i = 0; i < len; i += n)
+        {
+            n = mdWordSegment(handler, index + i, len - i, &mode);
+            mdStoreSegment(handler, &reg[i], &buf[2U * i], n, mode);
+        }
+        handler->seq++;
+        __set_PRIMASK(primask);
+        return mdTRUE;
+    }
+    for (mdU32 i = 0; i < len; i++, buf += 2)
+    {
+        reg = mdGetRegister(handler, addr + i);
+        if (reg == NULL)
+        {
+            ret = mdFALSE;
+            continue;
+        }
+        mdWordSegment(handler, reg - handler->coils, 1U, &mode);
+        mdStoreSegment(handler, reg, buf, 1U, mode);
+    }
+    return ret;
+}
+
+/*
+    mdSetWordOrder
+        @handler 句柄
+        @addr    起始寄存器地址(含组偏移)
+        @len     寄存器个数(每个32位数据占2个)
+        @order   报文中的字顺序(mdWORD_ORDER_ABCD/mdWORD_ORDER_CDAB)
+        @return  长度为奇数、越界、跨组、位于线圈组、与已登记的区段重叠或登记数已满时返回 mdFALSE
+    登记一段32位数据在报文中的字顺序，只在初始化时调用；低位字在前与寄存器池的存储顺序一致，
+    只做检查不占登记数
+*/
+static mdSTATUS mdSetWordOrder(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 order)
+{
+    mdU16 *reg = (len && !(len & 1U)) ? mdGetRegisters(handler, addr, len) : NULL;
+    struct mdWordRange *range;
+    mdU32 from;
+
+    if (reg == NULL)
+    {
+        return mdFALSE;
+    }
+    from = reg - handler->coils;
+    if (from < REGISTER_POOL_INPUT_REGISTERS)
+    {
+        return mdFALSE;
+    }
+    for (mdU32 i = 0; i < handler->wordCount; i++)
+    {
+        range = &handler->words[i];
+        if ((from < range->to) && (range->from < from + len))
+        {
+            return mdFALSE;
+        }
+    }
+    if (order == mdWORD_ORDER_CDAB)
+    {
+        return mdTRUE;
+    }
+    if ((order != mdWORD_ORDER_ABCD) || (handler->wordCount >= MODBUS_WORD_RANGES))
+    {
+        return mdFALSE;
+    }
+    range = &handler->words[handler->wordCount];
+    range->from = from;
+    range->to = from + len;
+    handler->wordCount++;
+    return mdTRUE;
+}
+
+/*
+    mdRead32s
+        @handler 句柄
+        @addr    起始寄存器地址(含组偏移)
+        @len     32位数据个数
+        @data    数据数组(uint32_t/int32_t/float)
+        @return  越界或跨组时返回 mdFALSE(数据置0)，否则 mdTRUE
+    按寄存器池的存储顺序(低位字在前)读取一组32位数据，每个占2个寄存器，拷贝期间有提交时重读；
+    报文中的字顺序只在收发时按登记转换一次(见 mdSetWordOrder)
+*/
+static mdSTATUS mdRead32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdVOID *data)
+{
+    mdU16 *reg = mdGetRegisters(handler, addr, 2U * len);
+    mdU8 *dst = data;
+    uint32_t value;
+    mdU32 seq;
+
+    if (reg == NULL)
+    {
+        memset(data, 0, 4U * len);
+        return mdFALSE;
+    }
+    do
+    {
+        seq = mdSnapshotBegin(handler);
+        //经 volatile 访问，拷贝不会被编译器移出序号的两次读取之间
+        for (mdU32 i = 0; i < len; i++)
+        {
+            value = (uint32_t)((volatile const mdU16 *)reg)[2U * i] |
+                    ((uint32_t)((volatile const mdU16 *)reg)[2U * i + 1U] << 16U);
+            mdStoreU32(&dst[4U * i], value);
+        }
+    } while (mdSnapshotRetry(handler, seq));
+    return mdTRUE;
+}
+
+/*
+    mdWrite32s
+        @handler 句柄
+        @addr    起始寄存器地址(含组偏移)
+        @len     32位数据个数
+        @data    数据数组(uint32_t/int32_t/float)
+        @return  越界或跨组时返回 mdFALSE(不写入)，否则 mdTRUE
+    按寄存器池的存储顺序写入一组32位数据，与 mdWriteU16s 一样为一次原子提交，只标记值有变化的寄存器
+*/
+static mdSTATUS mdWrite32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const mdVOID *data)
+{
+    mdU16 *reg = mdGetRegisters(handler, addr, 2U * len);
+    const mdU8 *src = data;
+    mdU32 primask, index;
+    uint32_t old, now;
+
+    if (reg == NULL)
+    {
+        return mdFALSE;
+    }
+    index = reg - handler->coils;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (mdU32 i = 0; i < len; i++, reg += 2, src += 4, index += 2U)
+    {
+        old = mdLoadU32(reg);
+        now = mdLoadU32(src);
+        mdStoreU32(reg, now);
+        mdMarkDirty(handler, index, (mdU16)(old ^ now));
+        mdMarkDirty(handler, index + 1U, (mdU16)((old ^ now) >> 16U));
+    }
+    handler->seq++;
+    __set_PRIMASK(primask);
+    return mdTRUE;
+}
+
+static mdSTATUS mdReadU32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, uint32_t *data)
+{
+    return mdRead32s(handler, addr, len, data);
+}
+
+static mdSTATUS mdWriteU32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const uint32_t *data)
+{
+    return mdWrite32s(handler, addr, len, data);
+}
+
+static mdSTATUS mdReadI32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, int32_t *data)
+{
+    return mdRead32s(handler, addr, len, data);
+}
+
+static mdSTATUS mdWriteI32s(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const int32_t *data)
+{
+    return mdWrite32s(handler, addr, len, data);
+}
+
+static mdSTATUS mdReadFloats(RegisterPoolHandle handler, mdU32 addr, mdU32 len, float *data)
+{
+    return mdRead32s(handler, addr, len, data);
+}
+
+static mdSTATUS mdWriteFloats(RegisterPoolHandle handler, mdU32 addr, mdU32 len, const float *data)
+{
+    return mdWrite32s(handler, addr, len, data);
+}
+
+/*
+    mdReadBitTable
+        @table  位组存储区
+        @size   位组总位数
+        @addr   组内起始位
+        @len    位数
+        @bits   位数组(越界部分置 mdLow)
+        @return 存在越界地址时返回 mdFALSE，否则 mdTRUE
+    按位读取压缩存储的线圈/输入状态
+*/
+static mdSTATUS mdReadBitTable(const mdU16 *table, mdU32 size, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    for (mdU32 i = 0; i < len; i++)
+    {
+        mdU32 pos = addr + i;
+        *(bits++) = (pos < size) ? ToBit(mdBitRead(table, pos)) : mdLow;
+    }
+    return (addr + len <= size) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdWriteBitTable
+        @handler 句柄
+        @table  位组存储区
+        @group  位组在变化标记表中的起始下标
+        @size   位组总位数
+        @addr   组内起始位
+        @len    位数
+        @bits   位数组(越界部分丢弃)
+        @return 存在越界地址时返回 mdFALSE，否则 mdTRUE
+    按位写入压缩存储的线圈/输入状态，只写入变化的位，每个位为一次存储(见 mdBitWrite)
+*/
+static mdSTATUS mdWriteBitTable(RegisterPoolHandle handler, mdU16 *table, mdU32 group, mdU32 size, mdU32 addr,
+                                mdU32 len, mdBit *bits)
+{
+    for (mdU32 i = 0; (i < len) && (addr + i < size); i++)
+    {
+        mdU32 pos = addr + i;
+        if (mdBitRead(table, pos) != ToBit(bits[i]))
+        {
+            mdBitWrite(table, pos, ToBit(bits[i]));
+            mdMarkDirty(handler, group + mdBIT_WORD(pos), (mdU16)(1U << mdBIT_OFFSET(pos)));
+        }
+    }
+    return (addr + len <= size) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdReadPackedTable
+        @table  位组存储区
+        @size   位组总位数
+        @addr   组内起始位
+        @len    位数
+        @buf    输出缓冲区，(len+7)/8 字节，第0字节最低位对应起始位
+        @return 越界时返回 mdFALSE 且不修改 buf，否则 mdTRUE
+    以相邻两个寄存器组成的32位窗口移位取字节，直接生成 FC01/FC02 应答数据区
+*/
+static mdSTATUS mdReadPackedTable(const mdU16 *table, mdU32 size, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    if ((addr >= size) || (len > size - addr))
+    {
+        return mdFALSE;
+    }
+    for (mdU32 i = 0; i < len; i += 8U)
+    {
+        mdU32 pos = addr + i;
+        mdU32 word = mdBIT_WORD(pos);
+        mdU32 window = table[word];
+        if (word + 1U < mdBITS_TO_WORDS(size))
+        {
+            window |= (mdU32)table[word + 1U] << REGISTER_WIDTH;
+        }
+        window >>= mdBIT_OFFSET(pos);
+        if (len - i < 8U)
+        {
+            window &= (1U << (len - i)) - 1U;
+        }
+        *(buf++) = (mdU8)window;
+    }
+    return mdTRUE;
+}
+
+/*
+    mdWritePackedTable
+        @handler 句柄
+        @table  位组存储区
+        @group  位组在变化标记表中的起始下标
+        @size   位组总位数
+        @addr   组内起始位
+        @len    位数
+        @buf    输入缓冲区，格式同 FC15 请求数据区
+        @return 越界时返回 mdFALSE 且不修改存储区，否则 mdTRUE
+    每次以掩码合并一个字节到相邻两个寄存器中
+*/
+static mdSTATUS mdWritePackedTable(RegisterPoolHandle handler, mdU16 *table, mdU32 group, mdU32 size, mdU32 addr,
+                                   mdU32 len, mdU8 *buf)
+{
+    if ((addr >= size) || (len > size - addr))
+    {
+        return mdFALSE;
+    }
+    for (mdU32 i = 0; i < len; i += 8U)
+    {
+        mdU32 pos = addr + i;
+        mdU32 word = mdBIT_WORD(pos);
+        mdU32 off = mdBIT_OFFSET(pos);
+        mdU32 mask = (len - i < 8U) ? ((1U << (len - i)) - 1U) : 0xFFU;
+        mdU32 value = ((mdU32)*(buf++) & mask) << off;
+        mdU16 old = table[word];
+        mask <<= off;
+        table[word] = (mdU16)((table[word] & ~mask) | value);
+        mdMarkDirty(handler, group + word, old ^ table[word]);
+        if (mask >> REGISTER_WIDTH)
+        {
+            old = table[word + 1U];
+            table[word + 1U] = (mdU16)((table[word + 1U] & ~(mask >> REGISTER_WIDTH)) | (value >> REGISTER_WIDTH));
+            mdMarkDirty(handler, group + word + 1U, old ^ table[word + 1U]);
+        }
+    }
+    return mdTRUE;
+}
+
+/*
+    mdReadBitOne
+        @table  位组存储区
+        @size   位组总位数
+        @addr   组内位地址
+        @bit    位结果(越界时置 mdLow)
+        @return 越界时返回 mdFALSE，否则 mdTRUE
+    单个线圈/输入状态的读取：一次边界比较加一次位带别名字加载
+*/
+static mdSTATUS mdReadBitOne(const mdU16 *table, mdU32 size, mdU32 addr, mdBit *bit)
+{
+    if (addr >= size)
+    {
+        (*bit) = mdLow;
+        return mdFALSE;
+    }
+    (*bit) = (mdBit)mdBitLoad(table, addr);
+    return mdTRUE;
+}
+
+/*
+    mdWriteBitOne
+        @handler 句柄
+        @table  位组存储区
+        @group  位组在变化标记表中的起始下标
+        @size   位组总位数
+        @addr   组内位地址
+        @bit    位大小
+        @return 越界时返回 mdFALSE，否则 mdTRUE
+    单个线圈/输入状态的写入：值变化时为一次位带别名字存储及一次变化标记字节存储，
+    均不影响相邻位，可在边沿中断中直接调用而无需临界区
+*/
+static mdSTATUS mdWriteBitOne(RegisterPoolHandle handler, mdU16 *table, mdU32 group, mdU32 size, mdU32 addr, mdBit bit)
+{
+    if (addr >= size)
+    {
+        return mdFALSE;
+    }
+    bit = ToBit(bit);
+    if ((mdBit)mdBitLoad(table, addr) != bit)
+    {
+        mdBitWrite(table, addr, bit);
+        mdMarkDirty(handler, group + mdBIT_WORD(addr), (mdU16)(1U << mdBIT_OFFSET(addr)));
+    }
+    return mdTRUE;
+}
+
+static mdSTATUS mdReadCoil(RegisterPoolHandle handler, mdU32 addr, mdBit *bit)
+{
+    return mdReadBitOne(handler->coils, COIL_POOL_SIZE, addr, bit);
+}
+
+static mdSTATUS mdReadCoils(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    return mdReadBitTable(handler->coils, COIL_POOL_SIZE, addr, len, bits);
+}
+
+static mdSTATUS mdWriteCoil(RegisterPoolHandle handler, mdU32 addr, mdBit bit)
+{
+    return mdWriteBitOne(handler, handler->coils, REGISTER_POOL_COILS, COIL_POOL_SIZE, addr, bit);
+}
+
+static mdSTATUS mdWriteCoils(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    return mdWriteBitTable(handler, handler->coils, REGISTER_POOL_COILS, COIL_POOL_SIZE, addr, len, bits);
+}
+
+static mdSTATUS mdReadInputCoil(RegisterPoolHandle handler, mdU32 addr, mdBit *bit)
+{
+    return mdReadBitOne(handler->inputCoils, INPUT_COIL_POOL_SIZE, addr, bit);
+}
+
+static mdSTATUS mdReadInputCoils(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    return mdReadBitTable(handler->inputCoils, INPUT_COIL_POOL_SIZE, addr, len, bits);
+}
+
+static mdSTATUS mdWriteInputCoil(RegisterPoolHandle handler, mdU32 addr, mdBit bit)
+{
+    return mdWriteBitOne(handler, handler->inputCoils, REGISTER_POOL_INPUT_COILS, INPUT_COIL_POOL_SIZE, addr, bit);
+}
+
+static mdSTATUS mdWriteInputCoils(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdBit *bits)
+{
+    return mdWriteBitTable(handler, handler->inputCoils, REGISTER_POOL_INPUT_COILS, INPUT_COIL_POOL_SIZE, addr, len, bits);
+}
+
+static mdSTATUS mdReadCoilsPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    return mdReadPackedTable(handler->coils, COIL_POOL_SIZE, addr, len, buf);
+}
+
+static mdSTATUS mdWriteCoilsPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    return mdWritePackedTable(handler, handler->coils, REGISTER_POOL_COILS, COIL_POOL_SIZE, addr, len, buf);
+}
+
+static mdSTATUS mdReadInputCoilsPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    return mdReadPackedTable(handler->inputCoils, INPUT_COIL_POOL_SIZE, addr, len, buf);
+}
+
+static mdSTATUS mdWriteInputCoilsPacked(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU8 *buf)
+{
+    return mdWritePackedTable(handler, handler->inputCoils, REGISTER_POOL_INPUT_COILS, INPUT_COIL_POOL_SIZE, addr, len, buf);
+}
+
+static mdSTATUS mdReadInputRegister(RegisterPoolHandle handler, mdU32 addr, mdU16 *data)
+{
+    return handler->ops->mdReadU16(handler, addr + INPUT_REGISTER_OFFSET, data);
+}
+
+static mdSTATUS mdReadInputRegisters(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    return handler->ops->mdReadU16s(handler, addr + INPUT_REGISTER_OFFSET, len, data);
+}
+
+static mdSTATUS mdWriteInputRegister(RegisterPoolHandle handler, mdU32 addr, mdU16 data)
+{
+    return handler->ops->mdWriteU16(handler, addr + INPUT_REGISTER_OFFSET, data);
+}
+
+static mdSTATUS mdWriteInputRegisters(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    return handler->ops->mdWriteU16s(handler, addr + INPUT_REGISTER_OFFSET, len, data);
+}
+
+static mdSTATUS mdReadHoldRegister(RegisterPoolHandle handler, mdU32 addr, mdU16 *data)
+{
+    return handler->ops->mdReadU16(handler, addr + HOLD_REGISTER_OFFSET, data);
+}
+
+static mdSTATUS mdReadHoldRegisters(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    return handler->ops->mdReadU16s(handler, addr + HOLD_REGISTER_OFFSET, len, data);
+}
+
+static mdSTATUS mdWriteHoldRegister(RegisterPoolHandle handler, mdU32 addr, mdU16 data)
+{
+    return handler->ops->mdWriteU16(handler, addr + HOLD_REGISTER_OFFSET, data);
+}
+
+static mdSTATUS mdWriteHoldRegisters(RegisterPoolHandle handler, mdU32 addr, mdU32 len, mdU16 *data)
+{
+    return handler->ops->mdWriteU16s(handler, addr + HOLD_REGISTER_OFFSET, len, data);
+}
+
+/*
+    mdTakeDirty
+        @handler 句柄
+        @from   起始下标(变化标记表下标，见 REGISTER_POOL_xxx)
+        @return 第一个变化寄存器的下标，无变化时返回 REGISTER_POOL_WORDS
+    取走并清除一个变化标记；在取走与读取寄存器之间再次写入时标记会重新置位，不会漏报
+*/
+static mdU32 mdTakeDirty(RegisterPoolHandle handler, mdU32 from)
+{
+    for (; from < REGISTER_POOL_WORDS; from++)
+    {
+        if (handler->dirty[from])
+        {
+            handler->dirty[from] = 0U;
+            break;
+        }
+    }
+    return from;
+}
+
+/*
+    mdTakeDirtyRange
+        @handler 句柄
+        @from   起始下标
+        @len    段长
+        @return 段的起始下标，无变化时返回 REGISTER_POOL_WORDS
+    取走并清除一段连续的变化标记，段不跨越寄存器组；逐个清除标记后再由调用者读取寄存器，
+    读取前的再次写入会重新置位，不会漏报
+*/
+static mdU32 mdTakeDirtyRange(RegisterPoolHandle handler, mdU32 from, mdU32 *len)
+{
+    static const mdU32 groups[] = {REGISTER_POOL_INPUT_COILS, REGISTER_POOL_INPUT_REGISTERS,
+                                   REGISTER_POOL_HOLD_REGISTERS, REGISTER_POOL_WORDS};
+    mdU32 start = mdTakeDirty(handler, from), end = start + 1U, limit = REGISTER_POOL_WORDS;
+
+    if (start >= REGISTER_POOL_WORDS)
+    {
+        (*len) = 0;
+        return start;
+    }
+    for (mdU32 i = 0; i < sizeof(groups) / sizeof(groups[0]); i++)
+    {
+        if (start < groups[i])
+        {
+            limit = groups[i];
+            break;
+        }
+    }
+    for (; (end < limit) && handler->dirty[end]; end++)
+    {
+        handler->dirty[end] = 0U;
+    }
+    (*len) = end - start;
+    return start;
+}
+
+/*
+    mdSubscribe
+        @handler 句柄
+        @from   起始下标(见 mdCOIL_INDEX 等)
+        @len    下标个数
+        @notify 回调
+        @arg    回调参数
+        @return 参数错误或订阅数已满时返回 mdFALSE，否则 mdTRUE
+    订阅一段寄存器的变化；在初始化阶段调用，登记后不可撤销
+*/
+static mdSTATUS mdSubscribe(RegisterPoolHandle handler, mdU32 from, mdU32 len, mdRegisterNotify notify, mdVOID *arg)
+{
+    struct mdRegisterWatch *watch;
+
+    if ((notify == NULL) || (len == 0) || (from >= REGISTER_POOL_WORDS) || (len > REGISTER_POOL_WORDS - from) ||
+        (handler->watchCount >= MODBUS_REGISTER_WATCHES))
+    {
+        return mdFALSE;
+    }
+    watch = &handler->watches[handler->watchCount];
+    watch->from = from;
+    watch->to = from + len;
+    watch->notify = notify;
+    watch->arg = arg;
+    handler->watchCount++;
+    return mdTRUE;
+}
+
+/*寄存器池方法表*/
+static const struct RegisterPoolOps mdRegisterPoolOps = {
+    .mdReadBit = mdReadBit,
+    .mdReadBits = mdReadBits,
+    .mdReadU16 = mdReadU16,
+    .mdReadU16s = mdReadU16s,
+    .mdWriteBit = mdWriteBit,
+    .mdWriteBits = mdWriteBits,
+    .mdWriteU16 = mdWriteU16,
+    .mdWriteU16s = mdWriteU16s,
+    .mdReadU16sPacked = mdReadU16sPacked,
+    .mdWriteU16sPacked = mdWriteU16sPacked,
+    .mdSetWordOrder = mdSetWordOrder,
+    .mdReadU32s = mdReadU32s,
+    .mdWriteU32s = mdWriteU32s,
+    .mdReadI32s = mdReadI32s,
+    .mdWriteI32s = mdWriteI32s,
+    .mdReadFloats = mdReadFloats,
+    .mdWriteFloats = mdWriteFloats,
+    .mdReadCoil = mdReadCoil,
+    .mdReadCoils = mdReadCoils,
+    .mdWriteCoil = mdWriteCoil,
+    .mdWriteCoils = mdWriteCoils,
+    .mdReadInputCoil = mdReadInputCoil,
+    .mdReadInputCoils = mdReadInputCoils,
+    .mdWriteInputCoil = mdWriteInputCoil,
+    .mdWriteInputCoils = mdWriteInputCoils,
+    .mdReadCoilsPacked = mdReadCoilsPacked,
+    .mdWriteCoilsPacked = mdWriteCoilsPacked,
+    .mdReadInputCoilsPacked = mdReadInputCoilsPacked,
+    .mdWriteInputCoilsPacked = mdWriteInputCoilsPacked,
+    .mdReadInputRegister = mdReadInputRegister,
+    .mdReadInputRegisters = mdReadInputRegisters,
+    .mdWriteInputRegister = mdWriteInputRegister,
+    .mdWriteInputRegisters = mdWriteInputRegisters,
+    .mdReadHoldRegister = mdReadHoldRegister,
+    .mdReadHoldRegisters = mdReadHoldRegisters,
+    .mdWriteHoldRegister = mdWriteHoldRegister,
+    .mdWriteHoldRegisters = mdWriteHoldRegisters,
+    .mdTakeDirty = mdTakeDirty,
+    .mdTakeDirtyRange = mdTakeDirtyRange,
+    .mdSubscribe = mdSubscribe,
+};
+
+/*
+    mdCreateRegisterPool
+        @regpoolhandle  句柄
+        @return 空间不足或(开启位带时)不在SRAM位带区时返回 mdFALSE，否则返回 mdTRUE
+    创建并初始化寄存器池
+*/
+mdSTATUS mdCreateRegisterPool(RegisterPoolHandle *regpoolhandle)
+{
+    mdSTATUS ret = mdFALSE;
+    RegisterPoolHandle handler;
+    mdmalloc(handler, struct RegisterPool, 1U);
+#if (MODBUS_BIT_BAND)
+    //线圈经位带别名区访问，寄存器池须整体位于SRAM位带区
+    if ((handler != NULL) && !mdBIT_BAND_REGION(handler))
+    {
+        mdfree(handler);
+        handler = NULL;
+    }
+#endif
+    if (handler != NULL)
+    {
+        handler->ops = &mdRegisterPoolOps;
+        handler->watchCount = 0;
+        handler->wordCount = 0;
+        handler->seq = 0;
+
+        //寄存器池静态分配，需清零(编译器不会初始化动态分配的结构体)
+        memset(handler->coils, 0, sizeof(handler->coils));
+        memset(handler->inputCoils, 0, sizeof(handler->inputCoils));
+        memset(handler->inputRegisters, 0, sizeof(handler->inputRegisters));
+        memset(handler->holdRegisters, 0, sizeof(handler->holdRegisters));
+        memset(handler->dirty, 0, sizeof(handler->dirty));
+        ret = mdTRUE;
+    }
+    (*regpoolhandle) = handler;
+    return ret;
+}
+
+/*
+    mdDestoryRegisterPool
+        @regpoolhandle  句柄
+        @return
+    释放寄存器池空间，句柄置 NULL
+*/
+mdVOID mdDestoryRegisterPool(RegisterPoolHandle *regpoolhandle)
+{
+    //寄存器随寄存器池一次性释放
+    mdfree(*regpoolhandle);
+    (*regpoolhandle) = NULL;
+}
+
+#endif
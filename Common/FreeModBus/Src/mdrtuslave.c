@@ -0,0 +1,2583 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "mdendian.h"
+#include "usart.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+#include "io_signal.h"
+#include "trace.h"
+#if (MODBUS_ROLE_MASTER)
+#include "mdrtumaster.h"
+#include "L101.h"
+#if defined(USING_TDMA)
+#include "tdma.h"
+#endif
+#if defined(USING_STANDBY)
+#include "standby.h"
+#endif
+#if defined(USING_DISCOVER)
+#include "discover.h"
+#endif
+#include "capture.h"
+#endif
+#if (RTU_TIMER_FRAMING)
+#if (MODBUS_ROLE_MASTER)
+#error "RTU_TIMER_FRAMING needs the Slave board microsecond timers (Rtu_Frame_Start)"
+#endif
+#include "stm32f1xx_it.h"
+#endif
+
+/*主站与从站共用本协议栈:收发队列、成帧、标准功能码及自定义功能码表为公共部分；
+主站另有文件记录(20/21功能码)及主站请求引擎的应答分派，从站另有逻辑单元、中继转发、成帧编解码器、
+重复帧缓存、帧认证及应答附带的上报数据，按 MODBUS_ROLE_MASTER 裁剪；
+串口、任务句柄及站号由各板的 mdconfig.h 给出*/
+extern osThreadId MODBUS_TASK_HANDLE;
+
+#if (USER_MODBUS_LIB)
+#if (MODBUS_ROLE_MASTER)
+/*主站各实例的发送队列深度在创建时指定*/
+#define mdTxDepth(handler) ((handler)->txDepth)
+#else
+#define mdTxDepth(handler) (TRANSMIT_QUEUE_FRAMES)
+#endif
+#define mdNextTxFrame(handler, n) (((n) + 1U) % mdTxDepth(handler))
+/* ================================================================== */
+/*                        接口区                                       */
+/* ================================================================== */
+#if (MODBUS_ROLE_MASTER)
+/*定义Modbus主机句柄*/
+ModbusRTUSlaveHandler mdMaster;
+/*文件记录(20/21功能码)的文件表，各从机实例共用*/
+static struct ModbusRTUFile mdRTUFiles[MODBUS_FILES];
+static mdVOID portRtuClientTick(ModbusRTUSlaveHandler handler, mdU32 ustime);
+#else
+ModbusRTUSlaveHandler mdhandler;
+#endif
+
+/*
+    portRtuTxDone
+        @arg  句柄
+        @sent 是否已发出
+        @return
+    接口：串口驱动发送完成回调(中断上下文)，释放当前帧并启动下一帧
+*/
+static void portRtuTxDone(void *arg, bool sent)
+{
+    mdRTUTxComplete((ModbusRTUSlaveHandler)arg);
+}
+
+/*
+    mdRTUPortPopChar
+        @handler 句柄
+        @data    待发送数据
+        @length  数据长度
+        @return  成功进入串口驱动发送队列返回 mdTRUE
+    接口：Modbus协议栈发送底层接口，把帧交给句柄绑定的串口驱动(handler->port)，完成后回调 portRtuTxDone
+*/
+mdSTATUS mdRTUPortPopChar(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    UartDma_HandleTypeDef *port = (UartDma_HandleTypeDef *)handler->port;
+
+    if (port == NULL)
+    {
+        return mdFALSE;
+    }
+#if (USING_DMA_TRANSPORT)
+    UartDma_Segment seg = {data, (uint16_t)length, true, portRtuTxDone, handler};
+    return Uart_Dma_Transmit(port, &seg, 1U) ? mdTRUE : mdFALSE;
+#else
+    return (HAL_UART_Transmit(port->huart, data, length, 0xFFFF) == HAL_OK) ? mdTRUE : mdFALSE;
+#endif
+}
+
+/*
+    portRtuTaskNotify
+        @handler 句柄
+        @return
+    接口：本机协议栈的接收通知，只唤醒Modbus任务
+*/
+static mdVOID portRtuTaskNotify(ModbusRTUSlaveHandler handler)
+{
+    /*开启串口中断后Modbus任务可能尚未创建；任务通知是置位操作，多次通知合并为一次唤醒，
+    任务被唤醒后处理接收环内的全部数据，不会丢帧*/
+    if (MODBUS_TASK_HANDLE != NULL)
+    {
+        osSignalSet(MODBUS_TASK_HANDLE, MODBUS_SIGNAL_RX);
+    }
+}
+
+#if (RTU_TIMER_FRAMING == 0)
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUFastFilter
+        @handler 句柄
+        @uart    串口驱动句柄
+        @event   接收事件
+        @return
+    快速写入(中断中调用)：上次通知以空闲结束且本次只发布了一个以空闲结束的接收段时，该段即为一整帧(环尾分段、
+    DMA半满/全满事件打断的帧交给任务处理)；只接受RTU类编解码器下发往主单元、长度符合的FC05及场景帧，
+    校验CRC，开启认证时由序号低字节还原序号并校验MAC(不更新最后接受的序号，仍由任务校验并记录)。
+    请求前通知可丢弃请求时(模拟器)不使用快速写入
+*/
+static mdVOID mdRTUFastFilter(ModbusRTUSlaveHandler handler, UartDma_HandleTypeDef *uart, uint8_t event)
+{
+    const UartDma_Span *span;
+    mdU8 *frame;
+    mdU32 spans = uart->Rx.Span_Head - handler->fastSpan, len, extra = 0;
+    mdBOOL start = handler->fastStart;
+
+    handler->fastSpan = uart->Rx.Span_Head;
+    handler->fastStart = (event & UART_DMA_EVENT_IDLE) ? mdTRUE : mdFALSE;
+    if (!start || (spans != 1U) || !handler->fastStart || !handler->codec->rtuFilter ||
+        (handler->mdRTURequest != NULL))
+    {
+        return;
+    }
+    span = &uart->Rx.Spans[(uart->Rx.Span_Head - 1U) % UART_DMA_RX_SPANS];
+    frame = &uart->Rx.pBuf[span->Start];
+#if (MODBUS_AUTH)
+    extra = (handler->auth != NULL) ? MODBUS_AUTH_SIZE : 0U;
+#endif
+    if ((span->Length < 3U) || (frame[0] != handler->slaveId))
+    {
+        return;
+    }
+    len = span->Length - extra - 2U;
+    if (!((frame[1] == MODBUS_CODE_5) && (len == 6U)) && !((frame[1] == MODBUS_CODE_SCENE) && (len == 3U)))
+    {
+        return;
+    }
+    if (mdCrc16(frame, span->Length - 2U) != ToU16(frame[span->Length - 1U], frame[span->Length - 2U]))
+    {
+        return;
+    }
+#if (MODBUS_AUTH)
+    if ((extra != 0U) &&
+        (mdAuthTag(handler->auth, MODBUS_AUTH_REQUEST, mdAuthSequence(handler->authSeq[0], frame[len]), frame, len) !=
+         (frame[len + 1U] | ((mdU32)frame[len + 2U] << 8U) | ((mdU32)frame[len + 3U] << 16U))))
+    {
+        return;
+    }
+#endif
+    handler->fastFrames++;
+    handler->mdRTUFastWrite(handler, frame, len);
+}
+#endif
+
+/*
+    portRtuRxNotify
+        @uart   串口驱动句柄
+        @event  接收事件
+        @return
+    接口：串口驱动接收通知(中断中调用)，转给绑定实例的通知函数，组帧及校验在任务中完成；
+    从站注册了快速写入时先在中断中检查本次接收的帧
+*/
+static void portRtuRxNotify(UartDma_HandleTypeDef *uart, uint8_t event)
+{
+    ModbusRTUSlaveHandler handler = (ModbusRTUSlaveHandler)uart->Rx.Arg;
+
+    if (handler == NULL)
+    {
+        return;
+    }
+#if !(MODBUS_ROLE_MASTER)
+    if (handler->mdRTUFastWrite != NULL)
+    {
+        mdRTUFastFilter(handler, uart, event);
+    }
+#endif
+    if (handler->mdRTURxNotify != NULL)
+    {
+        handler->mdRTURxNotify(handler);
+    }
+}
+#endif
+
+/*
+    portRtuRxEvent
+        @uart   串口驱动句柄
+        @data   接收环内新收到的数据
+        @length 数据长度
+        @event  接收事件
+        @return
+    接口：接收段处理，数据追加到当前帧并增量计算CRC。默认在任务中由 Uart_Dma_Rx_Dispatch 调用，
+    线路空闲时提交帧；定时器成帧时在中断中调用，空闲时启动 t1.5/t3.5 定时，由定时器判定帧结束
+*/
+static void portRtuRxEvent(UartDma_HandleTypeDef *uart, const uint8_t *data, uint16_t length, uint8_t event)
+{
+    ModbusRTUSlaveHandler handler = (ModbusRTUSlaveHandler)uart->Rx.Arg;
+    ReceiveBufferHandle recbuf = handler->receiveBuffer;
+    struct ReceiveFrame *frame = &recbuf->frame[recbuf->head];
+
+#if (RTU_TIMER_FRAMING == 0) && !(MODBUS_ROLE_MASTER)
+    /*透明通道:接收数据原样转发到本地串口，不组帧*/
+    if (handler->codec->decode == NULL)
+    {
+        User_Shell_Write((char *)data, length);
+        return;
+    }
+#endif
+    length = (length < MODBUS_PDU_SIZE_MAX - frame->count) ? length : (MODBUS_PDU_SIZE_MAX - frame->count);
+    memcpy(&frame->buf[frame->count], data, length);
+    frame->count += length;
+    mdReceiveBufferScan(recbuf, frame->count);
+    if (!(event & UART_DMA_EVENT_IDLE))
+    {
+        return;
+    }
+#if (RTU_TIMER_FRAMING)
+    /*空闲中断只表示线路暂停，由微秒定时器判定间隔是否达到t3.5*/
+    mdRTUFrameIdle(handler, frame->count);
+    Rtu_Frame_Start(handler->invalidTime, handler->stopTime);
+#else
+    /*CRC错误及发往其他从站的帧在此丢弃*/
+    mdReceiveBufferCommit(recbuf, frame->count);
+#endif
+}
+
+/*
+    portRtuPushChar
+        @handler 句柄
+        @c 待接收字符
+        @return
+    接口：接收一个字符(追加到DMA当前写入帧，帧结束时由 mdReceiveBufferCommit 提交)
+*/
+static mdVOID portRtuPushChar(ModbusRTUSlaveHandler handler, mdU8 c)
+{
+    ReceiveBufferHandle recbuf = handler->receiveBuffer;
+    struct ReceiveFrame *frame = &recbuf->frame[recbuf->head];
+    if (frame->count < MODBUS_PDU_SIZE_MAX)
+    {
+        frame->buf[frame->count++] = c;
+    }
+}
+
+/*
+    portRtuPushString
+        @handler 句柄
+        @*data   数据
+        @length  数据长度
+    接口：接收一个字符串(作为完整的一帧放入接收帧环)
+*/
+static mdVOID portRtuPushString(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    ReceiveBufferHandle recbuf = handler->receiveBuffer;
+    length = length < MODBUS_PDU_SIZE_MAX ? length : MODBUS_PDU_SIZE_MAX;
+    memcpy(mdReceiveBufferTarget(recbuf), data, length);
+    mdReceiveBufferCommit(recbuf, length);
+}
+
+/*
+    mdRTUTxStart
+        @handler 句柄
+        @return
+    接口：发送队列空闲且有待发送帧时启动底层发送(调用者需处于临界区或中断中)
+*/
+static mdVOID mdRTUTxStart(ModbusRTUSlaveHandler handler)
+{
+    while ((!handler->txBusy) && (handler->txTail != handler->txHead))
+    {
+        struct TransmitFrame *frame = &handler->txQueue[handler->txTail];
+        handler->txBusy = mdTRUE;
+        if (handler->mdRTUPopChar(handler, frame->data, frame->length) == mdFALSE)
+        { /*底层启动失败:丢弃该帧，继续下一帧*/
+            handler->txBusy = mdFALSE;
+            handler->txDropped++;
+            handler->txTail = mdNextTxFrame(handler, handler->txTail);
+        }
+    }
+}
+
+/*
+    mdRTUTxComplete
+        @handler 句柄
+        @return
+    接口：发送完成中断中调用，释放当前帧并启动下一帧，然后通知调用者
+*/
+mdVOID mdRTUTxComplete(ModbusRTUSlaveHandler handler)
+{
+    if ((mdTxDepth(handler) == 0) || (!handler->txBusy))
+    {
+        return;
+    }
+    handler->txBusy = mdFALSE;
+    handler->txLastLength = handler->txQueue[handler->txTail].length;
+    handler->txTail = mdNextTxFrame(handler, handler->txTail);
+    mdRTUTxStart(handler);
+    if (handler->mdRTUTxDone != NULL)
+    {
+        handler->mdRTUTxDone(handler);
+    }
+}
+
+/*
+    mdRTUTxAbort
+        @handler 句柄
+        @return
+    接口：底层发送被外部停止后(如 HAL_UART_DMAStop)清空发送队列
+*/
+mdVOID mdRTUTxAbort(ModbusRTUSlaveHandler handler)
+{
+    mdU32 primask = __get_PRIMASK();
+    __disable_irq();
+    handler->txTail = handler->txHead;
+    handler->txBusy = mdFALSE;
+    __set_PRIMASK(primask);
+}
+
+/*
+    mdRTUTxEnqueue
+        @handler 句柄
+        @*data   数据缓冲区
+        @length  数据长度
+        @copy    为 mdTRUE 时拷贝进发送队列，否则队列项直接引用调用者缓冲区
+        @return
+    接口：一帧进入发送队列后立即返回，由DMA完成中断依次发送；队列满或帧过长时丢弃并计数；
+    无发送队列的实例(发送队列深度为0)或不使用DMA传输时直接交给 mdRTUPopChar
+*/
+static mdVOID mdRTUTxEnqueue(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length, mdBOOL copy)
+{
+    struct TransmitFrame *frame;
+    mdU32 primask, next;
+
+    if ((length == 0) || (length > MODBUS_TX_BUFFER_SIZE))
+    {
+        handler->txDropped++;
+        return;
+    }
+#if (USING_DMA_TRANSPORT)
+    if (mdTxDepth(handler) == 0)
+#endif
+    {
+        if (handler->mdRTUPopChar(handler, data, length) == mdFALSE)
+        {
+            handler->txDropped++;
+            return;
+        }
+        handler->txFrames++;
+        handler->txLastLength = length;
+        if (handler->mdRTUTxDone != NULL)
+        {
+            handler->mdRTUTxDone(handler);
+        }
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    next = mdNextTxFrame(handler, handler->txHead);
+    if (next == handler->txTail)
+    {
+        handler->txDropped++;
+    }
+    else
+    {
+        frame = &handler->txQueue[handler->txHead];
+        if (copy)
+        {
+            memcpy(frame->buf, data, length);
+            data = frame->buf;
+        }
+        frame->data = data;
+        frame->length = length;
+        handler->txHead = next;
+        handler->txFrames++;
+#if (MODBUS_ROLE_MASTER)
+        if (handler == mdMaster)
+        {
+            CAPTURE(CAPTURE_TX, data, length);
+        }
+#endif
+        mdRTUTxStart(handler);
+    }
+    __set_PRIMASK(primask);
+}
+
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUDupStore
+        @entry   缓存项
+        @*data   应答帧
+        @length  应答帧长度
+        @return
+    接口：记录一条写命令的应答，超过 MODBUS_DUP_REPLY_SIZE 的应答不缓存(重传时重新执行)
+*/
+static mdVOID mdRTUDupStore(struct ModbusRTUDupEntry *entry, mdU8 *data, mdU32 length)
+{
+    if ((length == 0) || (length > MODBUS_DUP_REPLY_SIZE))
+    {
+        return;
+    }
+    memcpy(entry->reply, data, length);
+    entry->replyLength = (mdU8)length;
+    entry->tick = osKernelSysTick();
+}
+#endif
+
+/*
+    mdRTUSendString
+        @handler 句柄
+        @*data   数据缓冲区
+        @length  数据长度
+        @return
+    接口：发送一帧数据。数据被拷贝进发送队列后立即返回，调用者可立即改动缓冲区；
+    从站正在执行的写命令的应答同时记入重复帧缓存
+*/
+static mdVOID mdRTUSendString(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+#if !(MODBUS_ROLE_MASTER)
+    if (handler->dupCapture != NULL)
+    {
+        mdRTUDupStore(handler->dupCapture, data, length);
+        handler->dupCapture = NULL;
+    }
+#endif
+    mdRTUTxEnqueue(handler, data, length, mdTRUE);
+}
+
+/*
+    mdRTUSendFrame
+        @handler 句柄
+        @*data   数据缓冲区
+        @length  数据长度
+        @return
+    接口：直接发送调用者缓冲区中的一帧(如网关转发的请求)，省去一次整帧拷贝
+*/
+static mdVOID mdRTUSendFrame(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    mdRTUTxEnqueue(handler, data, length, mdFALSE);
+}
+
+/*
+    mdRTUTxBegin
+        @handler 句柄
+        @return
+    接口：开始组织一帧应答，应答直接序列化到句柄内的静态发送缓冲区；从站先写入编解码器的帧头
+*/
+static mdVOID mdRTUTxBegin(ModbusRTUSlaveHandler handler)
+{
+#if (MODBUS_ROLE_MASTER)
+    handler->txLength = 0;
+#else
+    const struct ModbusCodec *codec = handler->codec;
+
+    memcpy(handler->txBuffer, codec->header, codec->headerLength);
+    handler->txLength = codec->headerLength;
+#endif
+    handler->txOverflow = mdFALSE;
+}
+
+/*
+    mdRTUTxReserve
+        @handler 句柄
+        @length  需要的字节数
+        @return  成功返回已清零的写入位置，空间不足(需为CRC预留2字节)时返回 NULL
+    接口：在发送缓冲区中预留一段空间，供调用者直接填充数据
+*/
+static mdU8 *mdRTUTxReserve(ModbusRTUSlaveHandler handler, mdU32 length)
+{
+    mdU8 *p;
+    if ((handler->txOverflow) || (handler->txLength + length + 2U > MODBUS_TX_BUFFER_SIZE))
+    {
+        handler->txOverflow = mdTRUE;
+        return NULL;
+    }
+    p = &handler->txBuffer[handler->txLength];
+    memset(p, 0, length);
+    handler->txLength += length;
+    return p;
+}
+
+static mdVOID mdRTUTxPutU8(ModbusRTUSlaveHandler handler, mdU8 data)
+{
+    mdU8 *p = mdRTUTxReserve(handler, 1U);
+    if (p != NULL)
+    {
+        p[0] = data;
+    }
+}
+
+#if !(MODBUS_ROLE_MASTER)
+static mdVOID mdRTUTxPutU16(ModbusRTUSlaveHandler handler, mdU16 data)
+{
+    mdU8 *p = mdRTUTxReserve(handler, 2U);
+    if (p != NULL)
+    {
+        p[0] = HIGH(data);
+        p[1] = LOW(data);
+    }
+}
+#endif
+
+static mdVOID mdRTUTxPutString(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    mdU8 *p = mdRTUTxReserve(handler, length);
+    if (p != NULL)
+    {
+        memcpy(p, data, length);
+    }
+}
+
+/*
+    mdRTUTxFlush
+        @handler 句柄
+        @return
+    接口：原样发送缓冲区内容，溢出时丢弃该帧
+*/
+static mdVOID mdRTUTxFlush(ModbusRTUSlaveHandler handler)
+{
+    if (handler->txOverflow)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    handler->mdRTUSendString(handler, handler->txBuffer, handler->txLength);
+}
+
+/*
+    mdRTUTxEnd
+        @handler 句柄
+        @return
+    接口：主站在缓冲区末尾追加CRC(低字节在前)；从站由编解码器在帧头之后的 从机地址+PDU 上追加校验
+    (RTU为CRC，低字节在前)并转换为线路帧，开启帧认证时先在 从机地址+PDU 之后附加认证尾；然后发送，溢出时丢弃该帧
+*/
+static mdVOID mdRTUTxEnd(ModbusRTUSlaveHandler handler)
+{
+#if (MODBUS_ROLE_MASTER)
+    mdU16 crc;
+#else
+    const struct ModbusCodec *codec = handler->codec;
+#if (MODBUS_AUTH)
+    mdU32 tag;
+    mdU8 *p;
+
+    /*已认证请求的应答在校验之前附加认证尾*/
+    if (handler->authActive && !handler->txOverflow)
+    {
+        tag = mdAuthTag(handler->auth, MODBUS_AUTH_REPLY, handler->authTag, &handler->txBuffer[codec->headerLength],
+                        handler->txLength - codec->headerLength);
+        p = mdRTUTxReserve(handler, MODBUS_AUTH_SIZE);
+        if (p != NULL)
+        {
+            p[0] = handler->authSeqLow;
+            p[1] = tag;
+            p[2] = tag >> 8U;
+            p[3] = tag >> 16U;
+        }
+    }
+#endif
+#endif
+    if (!handler->txOverflow)
+    {
+#if (MODBUS_ROLE_MASTER)
+        crc = mdCrc16(handler->txBuffer, handler->txLength);
+        /*Reserve时已为CRC预留空间*/
+        handler->txBuffer[handler->txLength++] = LOW(crc);
+        handler->txBuffer[handler->txLength++] = HIGH(crc);
+#else
+        handler->txLength = codec->encode(handler->txBuffer, codec->headerLength, handler->txLength, MODBUS_TX_BUFFER_SIZE);
+        handler->txOverflow = (handler->txLength == 0) ? mdTRUE : mdFALSE;
+#endif
+    }
+    mdRTUTxFlush(handler);
+}
+
+#if (MODBUS_ROLE_MASTER)
+/*
+    ModbusInit
+        @handler 本机从机协议栈的句柄变量
+    接口：初始化Modbus协议栈，并在其上建立主站请求引擎
+*/
+void ModbusInit(ModbusRTUSlaveHandler *handler)
+{
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    struct ModbusRTUMasterRegisterInfo client;
+    info.slaveId = SLAVE_ID;
+    info.usartBaudRate = BUAD_RATE;
+    info.mdRTUPopChar = mdRTUPortPopChar;
+    info.port = &MODBUS_UART_DMA;
+    info.txFrames = TRANSMIT_QUEUE_FRAMES;
+    info.mdRTURxNotify = portRtuTaskNotify;
+    if (mdCreateModbusRTUSlave(handler, info))
+    {
+        /*该实例收到的是各从站的应答，交给主站请求引擎而非从机功能码处理*/
+        (*handler)->portRTUTimerTick = portRtuClientTick;
+        /*主站请求引擎共用本协议栈的串口收发及寄存器池*/
+        client.transport = *handler;
+        client.mdRTUMasterReady = NULL;
+        mdCreateModbusRTUMaster(&Client_Object, client);
+    }
+}
+#else
+static mdVOID mdRTUHandleAnalog(ModbusRTUSlaveHandler handler);
+static mdVOID mdRTUHandleEcho(ModbusRTUSlaveHandler handler);
+
+/*
+    ModbusInit
+        @void
+    接口：初始化Modbus协议栈
+*/
+void ModbusInit(void)
+{
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    info.slaveId = SLAVE_ID;
+    info.usartBaudRate = BUAD_RATE;
+    info.mdRTUPopChar = mdRTUPortPopChar;
+    info.port = &MODBUS_UART_DMA;
+    info.mdRTURxNotify = portRtuTaskNotify;
+    if (mdCreateModbusRTUSlave(&mdhandler, info) == mdFALSE)
+    {
+        return;
+    }
+    /*紧凑模拟量帧使用自定义功能码*/
+    mdRTURegisterCode(mdhandler, MODBUS_CODE_ANALOG, mdRTUHandleAnalog);
+    /*主站延迟测试的回显帧*/
+    mdRTURegisterCode(mdhandler, MODBUS_CODE_ECHO, mdRTUHandleEcho);
+    /*RTU类编解码器:CRC错误及发往其他从站的帧在接收中断中直接丢弃*/
+    mdRTUSetCodec(mdhandler, MODBUS_FRAME_CODEC);
+}
+
+/*
+    mdRTUCodecShow
+        @return
+    接口：列出可用的成帧编解码器，当前使用的以'*'标出
+*/
+static mdVOID mdRTUCodecShow(mdVOID)
+{
+    const struct ModbusCodec *codec;
+
+    for (mdU32 i = 0; (mdhandler != NULL) && (i < MODBUS_CODECS); i++)
+    {
+        codec = mdCodecFind(i);
+        if (codec != NULL)
+        {
+            shellPrint(&shell, "%c %lu %s\r\n", (codec == mdhandler->codec) ? '*' : ' ', (unsigned long)i, codec->name);
+        }
+    }
+#if (MODBUS_FEC)
+    shellPrint(&shell, "fec: decoded = %lu, corrected = %lu, failed = %lu\r\n", (unsigned long)mdCodecFecStats()->frames,
+               (unsigned long)mdCodecFecStats()->corrected, (unsigned long)mdCodecFecStats()->failed);
+#endif
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_codec, mdRTUCodecShow, show modbus framing codecs);
+
+/*
+    mdRTUCodecSelect
+        @id 编解码器编号(0 rtu，1 rtu-fp，2 ascii)，透明通道由 md_pipe 进入
+        @return
+    接口：切换成帧编解码器
+*/
+static mdVOID mdRTUCodecSelect(int id)
+{
+    if ((mdhandler == NULL) || (id < 0) || (id == MODBUS_CODEC_PIPE) || !mdRTUSetCodec(mdhandler, (mdU32)id))
+    {
+        shellPrint(&shell, "codec %d unavailable\r\n", id);
+        return;
+    }
+    mdRTUCodecShow();
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_codec_set, mdRTUCodecSelect, select modbus framing codec);
+
+#if (RTU_TIMER_FRAMING == 0)
+/*透明通道上行分段长度，及退出透明通道的转义序列长度(连续的'+')*/
+#define MODBUS_PIPE_CHUNK 64U
+#define MODBUS_PIPE_ESCAPE 3U
+
+/*
+    portRtuPipeDone
+        @arg  分段占用标志
+        @sent 是否已发出
+        @return
+    接口：透明通道上行分段发送完成回调(中断上下文)，释放该分段
+*/
+static void portRtuPipeDone(void *arg, bool sent)
+{
+    *(volatile mdBOOL *)arg = mdFALSE;
+}
+
+/*
+    mdRTUPipe
+        @return
+    接口：透明通道，在shell任务中运行:USART1收到的数据经DMA原样从无线串口发出，
+    无线串口收到的数据由Modbus任务原样写到USART1，协议栈不组帧也不应答；两个分段交替使用，
+    一段发送时读取下一段。连续收到 MODBUS_PIPE_ESCAPE 个'+'且其间没有其他数据时退出，
+    未凑满的'+'在其他数据到来时补发；shell日志在此期间同样写到USART1
+*/
+static mdVOID mdRTUPipe(void)
+{
+    static const mdU8 escape[MODBUS_PIPE_ESCAPE] = {'+', '+', '+'};
+    static mdU8 chunk[2][MODBUS_PIPE_CHUNK];
+    static volatile mdBOOL busy[2];
+    const struct ModbusCodec *codec;
+    mdBOOL filter;
+    mdU32 k = 0, held = 0, n, i;
+    UartDma_Segment seg[2];
+
+    if (mdhandler == NULL)
+    {
+        return;
+    }
+    codec = mdhandler->codec;
+    filter = mdhandler->receiveBuffer->filter;
+    shellPrint(&shell, "pipe: uart1 <-> radio, send \"+++\" to exit\r\n");
+    mdRTUSetCodec(mdhandler, MODBUS_CODEC_PIPE);
+    for (;;)
+    {
+        while (busy[k])
+        {
+            osDelay(1);
+        }
+        n = User_Shell_Read((char *)chunk[k], MODBUS_PIPE_CHUNK);
+        for (i = 0; (i < n) && (chunk[k][i] == '+'); i++)
+        {
+        }
+        if ((i == n) && (held + n <= MODBUS_PIPE_ESCAPE))
+        {
+            held += n;
+            if (held == MODBUS_PIPE_ESCAPE)
+            {
+                break;
+            }
+            continue;
+        }
+        i = 0;
+        if (held > 0)
+        {
+            seg[i++] = (UartDma_Segment){escape, (uint16_t)held, false, NULL, NULL};
+            held = 0;
+        }
+        busy[k] = mdTRUE;
+        seg[i++] = (UartDma_Segment){chunk[k], (uint16_t)n, true, portRtuPipeDone, (void *)&busy[k]};
+        if (!Uart_Dma_Transmit(&MODBUS_UART_DMA, seg, (uint16_t)i))
+        {
+            busy[k] = mdFALSE;
+        }
+        k ^= 1U;
+    }
+    while (busy[0] || busy[1])
+    {
+        osDelay(1);
+    }
+    mdhandler->codec = codec;
+    mdhandler->receiveBuffer->filter = filter;
+    shellPrint(&shell, "\r\npipe closed\r\n");
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_pipe, mdRTUPipe, transparent pipe between uart1 and radio);
+#endif
+#endif
+
+/*
+    mdRTUError
+        @handler 句柄
+        @error   错误码
+        @return
+    接口：Modbus协议栈出错处理
+*/
+static mdVOID mdRTUError(ModbusRTUSlaveHandler handler, mdU8 error)
+{
+    handler->errors++;
+    if (error <= ERROR5)
+    {
+        handler->errorCodes[error]++;
+    }
+}
+
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUException
+        @handler   句柄
+        @exception 异常码
+        @return
+    接口：回送异常应答，请求方收到一个短帧即可结束事务，不必等待超时
+*/
+static mdVOID mdRTUException(ModbusRTUSlaveHandler handler, mdU8 exception)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+
+    handler->exceptions++;
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, recbuf[0]);
+    mdRTUTxPutU8(handler, recbuf[1] | MODBUS_EXCEPTION_FLAG);
+    mdRTUTxPutU8(handler, exception);
+    mdRTUTxEnd(handler);
+}
+#endif
+
+/*
+    mdRTUCheckRequest
+        @handler 句柄
+        @return  合法返回0，否则返回异常码
+    接口：标准功能码在访问寄存器池及组织应答之前经 mdPduParse 一次检查帧长度、字节数、数量及地址范围，
+    处理函数只从视图取字段，不会越界读写或超出发送缓冲区；文件记录的子请求由处理函数逐个检查，
+    自定义功能码由各自的处理函数检查
+*/
+static mdU8 mdRTUCheckRequest(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count;
+
+#if (MODBUS_ROLE_MASTER)
+    switch (mdGetCode())
+    {
+    case MODBUS_CODE_20:
+        /*从机地址+功能码+字节数+若干7字节的子请求+CRC*/
+        return ((reclen == 5U + recbuf[2]) && (recbuf[2] >= 7U) && ((recbuf[2] % 7U) == 0)) ? MODBUS_PDU_OK : MODBUS_PDU_VALUE;
+    case MODBUS_CODE_21:
+        /*子请求至少含一个寄存器，各子请求的长度由处理函数检查*/
+        return ((reclen == 5U + recbuf[2]) && (recbuf[2] >= 9U)) ? MODBUS_PDU_OK : MODBUS_PDU_VALUE;
+    default:
+        break;
+    }
+#endif
+    return mdPduParse(&handler->pdu, recbuf, reclen);
+}
+
+/*
+    modbusRTU_Handler
+        @void
+    接口：100us定时器回调函数
+*/
+// void inline mdRTU_Handler(void)
+// {
+// // #if defined(USING_DEBUG)
+// //     shellPrint(&shell,"tick = 0x%p\r\n", portRtuTimerTick);
+// // #endif
+//     mdhandler->portRTUTimerTick(mdhandler, TIMER_UTIME);
+
+// }
+
+/*
+    mdRTUHandleCode1
+        @handler 句柄
+        @return
+    接口：解析01功能码
+*/
+static mdVOID mdRTUHandleCode1(ModbusRTUSlaveHandler handler)
+{
+    const struct ModbusPduView *pdu = &handler->pdu;
+    RegisterPoolHandle regPool = handler->unitPool;
+    mdU8 bytes = (mdU8)((pdu->number + 7U) / 8U);
+    mdU8 *data;
+
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, pdu->id);
+    mdRTUTxPutU8(handler, pdu->code);
+    mdRTUTxPutU8(handler, bytes);
+    /*按报文格式直接读取压缩后的位数据*/
+    data = mdRTUTxReserve(handler, bytes);
+    if (data != NULL)
+    {
+        regPool->ops->mdReadCoilsPacked(regPool, pdu->start, pdu->number, data);
+    }
+    /*注意CRC顺序*/
+    mdRTUTxEnd(handler);
+}
+
+static mdVOID mdRTUHandleCode2(ModbusRTUSlaveHandler handler)
+{
+    const struct ModbusPduView *pdu = &handler->pdu;
+    RegisterPoolHandle regPool = handler->unitPool;
+    mdU8 bytes = (mdU8)((pdu->number + 7U) / 8U);
+    mdU8 *data;
+
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, pdu->id);
+    mdRTUTxPutU8(handler, pdu->code);
+    mdRTUTxPutU8(handler, bytes);
+    /*按报文格式直接读取压缩后的位数据*/
+    data = mdRTUTxReserve(handler, bytes);
+    if (data != NULL)
+    {
+        regPool->ops->mdReadInputCoilsPacked(regPool, pdu->start, pdu->number, data);
+    }
+    /*注意CRC顺序*/
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUTxPutRegisters
+        @handler 句柄
+        @addr    起始寄存器地址(含组偏移)
+        @length  寄存器个数
+        @return
+    接口：按应答格式写入一段寄存器；整段按报文格式一次读入发送缓冲区(见 mdReadU16sPacked)，
+    只有登记过字顺序的32位数据交换半字，应答中的多寄存器数据来自同一次提交
+*/
+static mdVOID mdRTUTxPutRegisters(ModbusRTUSlaveHandler handler, mdU32 addr, mdU16 length)
+{
+    RegisterPoolHandle regPool = handler->unitPool;
+    mdU8 *data = mdRTUTxReserve(handler, 2U * length);
+
+    if (data != NULL)
+    {
+        regPool->ops->mdReadU16sPacked(regPool, addr, length, data);
+    }
+}
+
+static mdVOID mdRTUHandleCode3(ModbusRTUSlaveHandler handler)
+{
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, pdu->id);
+    mdRTUTxPutU8(handler, pdu->code);
+    mdRTUTxPutU8(handler, (mdU8)(pdu->number * 2U));
+    mdRTUTxPutRegisters(handler, pdu->start + HOLD_REGISTER_OFFSET, pdu->number);
+    mdRTUTxEnd(handler);
+}
+
+static mdVOID mdRTUHandleCode4(ModbusRTUSlaveHandler handler)
+{
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, pdu->id);
+    mdRTUTxPutU8(handler, pdu->code);
+    mdRTUTxPutU8(handler, (mdU8)(pdu->number * 2U));
+    mdRTUTxPutRegisters(handler, pdu->start + INPUT_REGISTER_OFFSET, pdu->number);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUCoilCommit
+        @handler 句柄
+        @addr 起始线圈地址
+        @length 线圈数
+    线圈已写入寄存器池，通知用户立即处理(如驱动继电器)，不必等待输出任务轮询；
+    仅主单元的写入通知，其他逻辑单元通过寄存器池的变化订阅处理
+*/
+static mdVOID mdRTUCoilCommit(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+    if ((handler->mdRTUCoilWritten != NULL) && (handler->unitPool == handler->registerPool))
+    {
+        handler->mdRTUCoilWritten(handler, addr, length);
+    }
+}
+
+/*
+    mdRTUHoldCommit
+        @handler 句柄
+        @addr 起始寄存器地址
+        @length 寄存器数
+    保持寄存器已写入寄存器池，通知用户(如延迟写回flash)，仅主单元的写入通知
+*/
+static mdVOID mdRTUHoldCommit(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+    if ((handler->mdRTUHoldWritten != NULL) && (handler->unitPool == handler->registerPool))
+    {
+        handler->mdRTUHoldWritten(handler, addr, length);
+    }
+}
+
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUTxPutHealth
+        @handler 句柄
+    附带从站健康信息:累计错误数(CRC错误、成帧丢弃、发送丢弃及中心处理器拒绝的帧，饱和于0xFFFF)、
+    上电以来的秒数及最近一次RSSI，主站据此在每次事务中了解从站状态，无需另行诊断轮询
+*/
+static mdVOID mdRTUTxPutHealth(ModbusRTUSlaveHandler handler)
+{
+    mdU32 errors = handler->receiveBuffer->crcErrors + handler->lossFrames + handler->txDropped + handler->errors;
+    mdU32 uptime = osKernelSysTick() / 1000U;
+
+    mdRTUTxPutU16(handler, (mdU16)((errors > 0xFFFFU) ? 0xFFFFU : errors));
+    mdRTUTxPutU16(handler, (mdU16)(uptime >> 16U));
+    mdRTUTxPutU16(handler, (mdU16)uptime);
+    mdRTUTxPutU8(handler, handler->lastRssi);
+}
+
+/*
+    mdRTUTxPutAnalog
+        @handler 句柄
+    在健康信息之后附带越过死区的模拟量，主站在写线圈的同一事务中取得远端模拟量，无需另行读取
+*/
+static mdVOID mdRTUTxPutAnalog(ModbusRTUSlaveHandler handler)
+{
+    mdU16 values[MODBUS_ANALOG_REPORT_MAX];
+    mdU8 mask;
+
+    if ((handler->mdRTUReportAnalog == NULL) || (handler->unitPool != handler->registerPool))
+    {
+        return;
+    }
+    mask = handler->mdRTUReportAnalog(handler, values);
+    if (mask == 0)
+    {
+        return;
+    }
+    mdRTUTxPutU8(handler, mask);
+    for (mdU8 i = 0; i < MODBUS_ANALOG_REPORT_MAX; i++)
+    {
+        if (mask & (1U << i))
+        {
+            mdRTUTxPutU16(handler, values[i]);
+        }
+    }
+}
+
+/*
+    mdRTUTxPutReport
+        @handler 句柄
+    在写线圈应答的回显之后附带上报区间的线圈状态，主站在同一事务中取得从站输入
+*/
+static mdVOID mdRTUTxPutReport(ModbusRTUSlaveHandler handler)
+{
+    mdU8 bits[(MODBUS_REPORT_MAX + 7U) / 8U] = {0};
+    mdU16 bytes = (handler->reportLength + 7U) / 8U;
+
+    if ((handler->reportLength == 0) || (handler->reportLength > MODBUS_REPORT_MAX) ||
+        (handler->unitPool->ops->mdReadCoilsPacked(handler->unitPool, handler->reportAddress,
+                                                  handler->reportLength, bits) == mdFALSE))
+    {
+        return;
+    }
+    mdRTUTxPutU8(handler, (mdU8)bytes);
+    mdRTUTxPutString(handler, bits, bytes);
+    if (handler->reportHealth)
+    {
+        mdRTUTxPutHealth(handler);
+        mdRTUTxPutAnalog(handler);
+    }
+}
+#endif
+
+static mdVOID mdRTUHandleCode5(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    RegisterPoolHandle regPool = handler->unitPool;
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    regPool->ops->mdWriteCoil(regPool, pdu->start, pdu->value ? mdHigh : mdLow);
+    mdRTUCoilCommit(handler, pdu->start, 1U);
+    mdRTUTxBegin(handler);
+    /*回显请求(不含CRC)，从站配置了上报区间时附带线圈状态*/
+    mdRTUTxPutString(handler, recbuf, 6U);
+#if !(MODBUS_ROLE_MASTER)
+    mdRTUTxPutReport(handler);
+#endif
+    mdRTUTxEnd(handler);
+}
+
+static mdVOID mdRTUHandleCode6(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    RegisterPoolHandle regPool = handler->unitPool;
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    regPool->ops->mdWriteHoldRegister(regPool, pdu->start, pdu->value);
+    mdRTUHoldCommit(handler, pdu->start, 1U);
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 6U);
+    mdRTUTxEnd(handler);
+}
+
+static mdVOID mdRTUHandleCode15(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    RegisterPoolHandle regPool = handler->unitPool;
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    /*写入数据直接从接收帧交给寄存器池*/
+    regPool->ops->mdWriteCoilsPacked(regPool, pdu->start, pdu->number, pdu->data);
+    mdRTUCoilCommit(handler, pdu->start, pdu->number);
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 6U);
+#if !(MODBUS_ROLE_MASTER)
+    mdRTUTxPutReport(handler);
+#endif
+    mdRTUTxEnd(handler);
+}
+
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUHandleGroup
+        @handler 句柄
+    处理主站组播的FC15帧:第n位为从站号n的线圈值，起始地址为从站上的线圈地址
+*/
+static mdVOID mdRTUHandleGroup(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count;
+    RegisterPoolHandle regPool = handler->registerPool;
+    mdU16 startAddress = ToU16(recbuf[2], recbuf[3]);
+    mdU16 length = ToU16(recbuf[4], recbuf[5]);
+    mdU8 id = handler->slaveId;
+
+    /*位图中不包含本站或帧长度不足*/
+    if ((id >= length) || (reclen < 10U + id / 8U))
+    {
+        return;
+    }
+    regPool->ops->mdWriteCoil(regPool, startAddress, (recbuf[7 + id / 8] >> (id % 8)) & 0x01);
+    mdRTUCoilCommit(handler, startAddress, 1U);
+}
+
+/*
+    mdRTUHandleAnalog
+        @handler 句柄
+    处理主站下发的紧凑模拟量帧:|功能码|起始地址|存在位图|完整值位图|Data|
+    完整值为2字节12bit码值，否则为相对当前值的1字节有符号增量
+*/
+static mdVOID mdRTUHandleAnalog(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count;
+    RegisterPoolHandle regPool = handler->unitPool;
+    mdU8 present = recbuf[3], full = recbuf[4];
+    mdU32 pos = 5U;
+    mdU16 addr, data;
+
+    if (reclen < 7U)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    for (mdU8 k = 0; k < 8U; k++)
+    {
+        if (!(present & (1U << k)))
+        {
+            continue;
+        }
+        /*帧长度不足*/
+        if (pos + ((full & (1U << k)) ? 2U : 1U) > reclen - 2U)
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+        addr = ANALOG_OUTPUT_START_ADDR + recbuf[2] + k;
+        if (full & (1U << k))
+        {
+            data = ToU16(recbuf[pos], recbuf[pos + 1U]);
+            pos += 2U;
+        }
+        else
+        {
+            data = 0;
+            regPool->ops->mdReadHoldRegister(regPool, addr, &data);
+            data = (mdU16)((int16_t)data + (int8_t)recbuf[pos]);
+            pos++;
+        }
+        regPool->ops->mdWriteHoldRegister(regPool, addr, data & 0x0FFF);
+    }
+    mdRTUHoldCommit(handler, ANALOG_OUTPUT_START_ADDR + recbuf[2], 8U);
+    /*应答:从机地址+功能码+起始地址+存在位图*/
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 4U);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUHandleEcho
+        @handler 句柄
+        @return
+    接口：解析延迟测试帧，不访问寄存器池，收到后立即原样回显序号及主站时刻
+*/
+static mdVOID mdRTUHandleEcho(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count;
+
+    if (reclen != 2U + MODBUS_ECHO_SIZE + 2U)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 2U + MODBUS_ECHO_SIZE);
+    mdRTUTxEnd(handler);
+}
+#endif
+
+static mdVOID mdRTUHandleCode16(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    RegisterPoolHandle regPool = handler->unitPool;
+    const struct ModbusPduView *pdu = &handler->pdu;
+
+    regPool->ops->mdWriteU16sPacked(regPool, pdu->start + HOLD_REGISTER_OFFSET, pdu->number, pdu->data);
+    mdRTUHoldCommit(handler, pdu->start, pdu->number);
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 6U);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUHandleCode23
+        @handler 句柄
+        @return
+    接口：解析23功能码(读写多个保持寄存器)，先写后读，一次往返完成输出下发及输入读取
+*/
+static mdVOID mdRTUHandleCode23(ModbusRTUSlaveHandler handler)
+{
+    const struct ModbusPduView *pdu = &handler->pdu;
+    RegisterPoolHandle regPool = handler->unitPool;
+
+    regPool->ops->mdWriteU16sPacked(regPool, pdu->writeStart + HOLD_REGISTER_OFFSET, pdu->writeNumber, pdu->data);
+    mdRTUHoldCommit(handler, pdu->writeStart, pdu->writeNumber);
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, pdu->id);
+    mdRTUTxPutU8(handler, pdu->code);
+    mdRTUTxPutU8(handler, (mdU8)(pdu->number * 2U));
+    /*与03功能码一致*/
+    mdRTUTxPutRegisters(handler, pdu->start + HOLD_REGISTER_OFFSET, pdu->number);
+    mdRTUTxEnd(handler);
+}
+
+#if (MODBUS_ROLE_MASTER)
+/*
+    mdRTUFindFile
+        @file    文件号
+        @return  文件表项，未登记时返回 NULL
+*/
+static struct ModbusRTUFile *mdRTUFindFile(mdU16 file)
+{
+    for (mdU32 i = 0; i < MODBUS_FILES; i++)
+    {
+        if ((mdRTUFiles[i].read != NULL) && (mdRTUFiles[i].file == file))
+        {
+            return &mdRTUFiles[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+    mdRTUHandleCode20
+        @handler 句柄
+        @return
+    接口：解析20功能码(读文件记录)，各子请求的数据由文件表中的读函数直接写入发送缓冲区；
+    任一子请求的文件未登记、记录越界或读取失败时整帧不应答
+*/
+static mdVOID mdRTUHandleCode20(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU8 count = recbuf[2], *sub, *data;
+    struct ModbusRTUFile *pFile;
+    mdU16 file, record, length;
+
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, 2U);
+    /*应答数据长度在组帧结束后回填*/
+    mdRTUTxPutU8(handler, 0);
+    for (mdU32 i = 0; i < count; i += 7U)
+    {
+        sub = &recbuf[3U + i];
+        file = ToU16(sub[1], sub[2]);
+        record = ToU16(sub[3], sub[4]);
+        length = ToU16(sub[5], sub[6]);
+        pFile = mdRTUFindFile(file);
+        if ((sub[0] != MODBUS_FILE_REF_TYPE) || (pFile == NULL) || (length == 0) ||
+            ((mdU32)record + length > MODBUS_FILE_RECORDS))
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+        mdRTUTxPutU8(handler, (mdU8)(1U + 2U * length));
+        mdRTUTxPutU8(handler, MODBUS_FILE_REF_TYPE);
+        data = mdRTUTxReserve(handler, 2U * length);
+        if ((data == NULL) || (handler->txLength - 3U > MODBUS_FILE_DATA_MAX))
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+        if (!pFile->read(file, record, length, data))
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+    }
+    handler->txBuffer[2] = (mdU8)(handler->txLength - 3U);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUHandleCode21
+        @handler 句柄
+        @return
+    接口：解析21功能码(写文件记录)，先检查全部子请求再依次写入，应答为请求的回显；
+    数据直接从接收帧交给文件表中的写函数
+*/
+static mdVOID mdRTUHandleCode21(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen = handler->receiveBuffer->count;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 end = 3U + recbuf[2], pos;
+    struct ModbusRTUFile *pFile;
+    mdU16 file, record, length;
+    mdU8 *sub;
+
+    for (pos = 3U; pos < end; pos += 7U + 2U * length)
+    {
+        sub = &recbuf[pos];
+        if (pos + 7U > end)
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+        file = ToU16(sub[1], sub[2]);
+        record = ToU16(sub[3], sub[4]);
+        length = ToU16(sub[5], sub[6]);
+        pFile = mdRTUFindFile(file);
+        if ((pos + 7U + 2U * length > end) || (sub[0] != MODBUS_FILE_REF_TYPE) ||
+            (pFile == NULL) || (pFile->write == NULL) || (length == 0) ||
+            ((mdU32)record + length > MODBUS_FILE_RECORDS))
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+    }
+    for (pos = 3U; pos < end; pos += 7U + 2U * length)
+    {
+        sub = &recbuf[pos];
+        file = ToU16(sub[1], sub[2]);
+        length = ToU16(sub[5], sub[6]);
+        if (!mdRTUFindFile(file)->write(file, ToU16(sub[3], sub[4]), length, &sub[7]))
+        {
+            handler->mdRTUError(handler, ERROR2);
+            return;
+        }
+    }
+    mdRTUTxBegin(handler);
+    mdRTUTxPutString(handler, recbuf, reclen - 2U);
+    mdRTUTxEnd(handler);
+}
+#endif
+
+/*
+    portRtuTimerTick
+        @handler 句柄
+        @ustime  时长跨度，单位 us(未使用)
+        @return
+    接口：从机实例依次处理接收帧环中的请求并应答
+*/
+static mdVOID portRtuTimerTick(ModbusRTUSlaveHandler handler, mdU32 ustime)
+{
+    ReceiveBufferHandle pBuf = handler->receiveBuffer;
+
+    /*依次处理接收帧环中所有已接收的帧*/
+    while (mdReceiveBufferFetch(pBuf))
+    {
+        handler->rxFrames++;
+        TRACE(TRACE_MODBUS_BEGIN);
+        handler->mdRTUCenterProcessor(handler);
+        TRACE(TRACE_MODBUS_END);
+        mdClearReceiveBuffer(pBuf);
+    }
+}
+
+#if (MODBUS_ROLE_MASTER)
+/*
+    mdRTUIsRequest
+        @handler 句柄
+        @pB      接收帧
+        @return  是发给本机的请求返回 mdTRUE
+    接口：主站实例上登记了处理函数的自定义功能码(如shell隧道)、且从机地址为本机的帧是上位机经无线发来的请求，
+    而不是从站的应答；主站不向从站发出这些功能码，二者不会混淆
+*/
+static mdBOOL mdRTUIsRequest(ModbusRTUSlaveHandler handler, ReceiveBufferHandle pB)
+{
+    if (!pB->crcValid || (pB->count < 3U) || (pB->buf[0] != handler->slaveId))
+    {
+        return mdFALSE;
+    }
+    for (mdU32 i = 0; i < MODBUS_CUSTOM_CODES; i++)
+    {
+        if ((handler->customCodes[i].handle != NULL) && (handler->customCodes[i].code == pB->buf[1]))
+        {
+            return mdTRUE;
+        }
+    }
+    return mdFALSE;
+}
+
+/*
+    portRtuClientTick
+        @handler 句柄
+        @ustime  时长跨度，单位 us(未使用)
+        @return
+    接口：主站协议栈(L101)依次把接收帧环中的应答交给主站请求引擎，发给本机的自定义功能码请求交给中心处理器
+*/
+static mdVOID portRtuClientTick(ModbusRTUSlaveHandler handler, mdU32 ustime)
+{
+    ReceiveBufferHandle pB = handler->receiveBuffer;
+
+    /*依次处理接收帧环中所有已接收的帧*/
+    while (mdReceiveBufferFetch(pB))
+    {
+        handler->rxFrames++;
+        CAPTURE(CAPTURE_RX, pB->buf, pB->count);
+#if (MODBUS_FEC)
+        /*纠错编码的应答先就地还原为RTU帧并重新校验CRC*/
+        if (Client_Object != NULL)
+        {
+            mdFecReceive(pB, &Client_Object->fec);
+        }
+#endif
+        /*CRC错误的帧仍交给请求引擎，由其按应答错误结束对应的请求*/
+        if (!pB->crcValid)
+        {
+            handler->mdRTUError(handler, ERROR3);
+        }
+        if (mdRTUIsRequest(handler, pB))
+        {
+            handler->mdRTUCenterProcessor(handler);
+            mdClearReceiveBuffer(pB);
+            continue;
+        }
+#if defined(USING_TDMA)
+        /*其他主站发出的时隙信标不是应答*/
+        if (pB->crcValid && Tdma_Beacon(pB->buf, pB->count))
+        {
+            mdClearReceiveBuffer(pB);
+            continue;
+        }
+#endif
+#if defined(USING_STANDBY)
+        /*对方主站发出的调度状态镜像不是应答*/
+        if (pB->crcValid && Standby_Frame(pB->buf, pB->count))
+        {
+            mdClearReceiveBuffer(pB);
+            continue;
+        }
+#endif
+#if defined(USING_DISCOVER)
+        /*入网应答不对应在途请求*/
+        if (pB->crcValid && Discover_Reply(pB->buf, pB->count))
+        {
+            mdClearReceiveBuffer(pB);
+            continue;
+        }
+#endif
+        /*交给主站请求引擎匹配在途请求，来自未知从站或已超时请求的应答被丢弃*/
+        if (Client_Object != NULL)
+        {
+            TRACE(TRACE_MODBUS_BEGIN);
+            mdRTU_Response(Client_Object, pB);
+            TRACE(TRACE_MODBUS_END);
+        }
+        mdClearReceiveBuffer(pB);
+    }
+}
+#endif
+
+/*标准功能码处理表(存放于flash)，下标为功能码*/
+static const ModbusRTUCodeHandle mdRTUCodeTable[MODBUS_CODE_23 + 1] = {
+    [MODBUS_CODE_1] = mdRTUHandleCode1,
+    [MODBUS_CODE_2] = mdRTUHandleCode2,
+    [MODBUS_CODE_3] = mdRTUHandleCode3,
+    [MODBUS_CODE_4] = mdRTUHandleCode4,
+    [MODBUS_CODE_5] = mdRTUHandleCode5,
+    [MODBUS_CODE_6] = mdRTUHandleCode6,
+    [MODBUS_CODE_15] = mdRTUHandleCode15,
+    [MODBUS_CODE_16] = mdRTUHandleCode16,
+#if (MODBUS_ROLE_MASTER)
+    [MODBUS_CODE_20] = mdRTUHandleCode20,
+    [MODBUS_CODE_21] = mdRTUHandleCode21,
+#endif
+    [MODBUS_CODE_23] = mdRTUHandleCode23,
+};
+
+/*
+    mdRTUFindCode
+        @handler 句柄
+        @code    功能码
+        @return  功能码处理函数，不支持时返回 NULL
+    先查找用户注册的自定义功能码，再查找标准功能码表
+*/
+static ModbusRTUCodeHandle mdRTUFindCode(ModbusRTUSlaveHandler handler, mdU8 code)
+{
+    for (mdU32 i = 0; i < MODBUS_CUSTOM_CODES; i++)
+    {
+        if ((handler->customCodes[i].handle != NULL) && (handler->customCodes[i].code == code))
+        {
+            return handler->customCodes[i].handle;
+        }
+    }
+    return (code < sizeof(mdRTUCodeTable) / sizeof(mdRTUCodeTable[0])) ? mdRTUCodeTable[code] : NULL;
+}
+
+#if (MODBUS_ROLE_MASTER)
+/*
+    mdModbusRTUCenterProcessor
+        @handler 句柄
+        @receFrame 待处理的帧（已校验通过）
+    处理一帧，并且通过接口发送处理结果；主站实例不回送异常应答
+*/
+static mdVOID mdRTUCenterProcessor(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen = handler->receiveBuffer->count;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    ModbusRTUCodeHandle handle;
+    if (reclen < 3)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    /*CRC已在接收时逐字节计算*/
+    if ((CRC_CHECK != 0) && !handler->receiveBuffer->crcValid)
+    {
+        handler->mdRTUError(handler, ERROR3);
+        return;
+    }
+    if (mdGetSlaveId() != handler->slaveId)
+    {
+        handler->mdRTUError(handler, ERROR4);
+        return;
+    }
+    handle = mdRTUFindCode(handler, mdGetCode());
+    if (handle == NULL)
+    {
+        handler->mdRTUError(handler, ERROR5);
+        return;
+    }
+    if (mdRTUCheckRequest(handler) != MODBUS_PDU_OK)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    handle(handler);
+}
+#else
+/*
+    mdRTUDupCacheable
+        @code    功能码
+        @return  需要缓存的写命令返回 mdTRUE
+    只有写命令会改变输出，读命令重传时直接重新执行
+*/
+static mdBOOL mdRTUDupCacheable(mdU8 code)
+{
+    return ((code == MODBUS_CODE_5) || (code == MODBUS_CODE_6) || (code == MODBUS_CODE_15) ||
+            (code == MODBUS_CODE_16) || (code == MODBUS_CODE_23) || (code == MODBUS_CODE_ANALOG))
+               ? mdTRUE
+               : mdFALSE;
+}
+
+/*
+    mdRTUDupLookup
+        @handler 句柄
+        @return  时间窗内已执行过的同一帧返回其缓存项，否则返回 NULL
+    Modbus RTU帧不带序号，以请求帧的CRC、长度和功能码作为帧标识
+*/
+static struct ModbusRTUDupEntry *mdRTUDupLookup(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen = handler->receiveBuffer->count;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU16 crc = mdGetCrc16();
+    mdU32 now = osKernelSysTick();
+
+    for (mdU32 i = 0; i < MODBUS_DUP_CACHE; i++)
+    {
+        struct ModbusRTUDupEntry *entry = &handler->dupCache[i];
+        if ((entry->replyLength != 0) && (entry->crc == crc) && (entry->length == reclen) &&
+            (entry->code == mdGetCode()) && (now - entry->tick < MODBUS_DUP_WINDOW))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+#if (MODBUS_AUTH)
+/*
+    mdRTUDupPlain
+        @handler 句柄
+        @entry   命中的缓存项
+        @return  还原后的 帧头+从机地址+PDU+认证尾+CRC 长度，无法还原时返回0
+    接口：缓存的应答拷贝进发送缓冲区；缓存的是纠错编码的线路帧时就地还原，重新签名后按本次请求的纠错等级编码
+*/
+static mdU32 mdRTUDupPlain(ModbusRTUSlaveHandler handler, const struct ModbusRTUDupEntry *entry)
+{
+    mdU32 start = handler->codec->headerLength, length = entry->replyLength;
+#if (MODBUS_FEC)
+    mdU32 fixed;
+#endif
+
+    memcpy(handler->txBuffer, entry->reply, length);
+#if (MODBUS_FEC)
+    if ((length > start) && (mdFecLevel(&handler->txBuffer[start], length - start) != MODBUS_FEC_OFF))
+    {
+        length = mdFecDecode(&handler->txBuffer[start], length - start, &fixed);
+        length = length ? (start + length) : 0;
+    }
+#endif
+    return length;
+}
+#endif
+
+/*
+    mdRTUDupBegin
+        @handler 句柄
+        @return
+    接口：为即将执行的写命令分配缓存项(覆盖最旧的项)，其应答在发送时记录
+*/
+static mdVOID mdRTUDupBegin(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen = handler->receiveBuffer->count;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    struct ModbusRTUDupEntry *entry = &handler->dupCache[handler->dupNext];
+
+    handler->dupNext = (handler->dupNext + 1U) % MODBUS_DUP_CACHE;
+    entry->replyLength = 0;
+    entry->crc = mdGetCrc16();
+    entry->code = mdGetCode();
+    entry->length = reclen;
+    handler->dupCapture = entry;
+}
+
+#if (MODBUS_CODE_PROFILE)
+/*
+    mdRTUProfileBegin
+        @return 分派开始时的DWT周期计数
+    接口：分派前钩子
+*/
+static mdU32 mdRTUProfileBegin(mdVOID)
+{
+    return DWT->CYCCNT;
+}
+
+/*
+    mdRTUProfileEnd
+        @handler 句柄
+        @code    功能码
+        @start   分派开始时的周期计数
+        @return
+    接口：分派后钩子，按功能码累计调用次数、总耗时及最长耗时；表中没有该功能码时占用一个空项
+*/
+static mdVOID mdRTUProfileEnd(ModbusRTUSlaveHandler handler, mdU8 code, mdU32 start)
+{
+    mdU32 cycles = DWT->CYCCNT - start;
+    struct ModbusRTUCodeProfile *p;
+
+    for (p = handler->profile; p < &handler->profile[MODBUS_PROFILE_CODES]; p++)
+    {
+        if ((p->count == 0) || (p->code == code))
+        {
+            p->code = code;
+            p->count++;
+            p->total += cycles;
+            p->max = (cycles > p->max) ? cycles : p->max;
+            return;
+        }
+    }
+    handler->profileOther++;
+}
+
+/*
+    mdRTUProfileShow
+        @return
+    接口：按功能码输出分派统计，耗时单位为DWT周期(72MHz时72个周期为1us)
+*/
+static mdVOID mdRTUProfileShow(mdVOID)
+{
+    struct ModbusRTUCodeProfile *p;
+
+    if (mdhandler == NULL)
+    {
+        return;
+    }
+    shellPrint(&shell, "code  count      total      max        avg\r\n");
+    for (p = mdhandler->profile; (p < &mdhandler->profile[MODBUS_PROFILE_CODES]) && p->count; p++)
+    {
+        shellPrint(&shell, "0x%02x  %-10lu %-10lu %-10lu %lu\r\n", p->code, (unsigned long)p->count,
+                   (unsigned long)p->total, (unsigned long)p->max, (unsigned long)(p->total / p->count));
+    }
+    shellPrint(&shell, "other = %lu\r\n", (unsigned long)mdhandler->profileOther);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_prof, mdRTUProfileShow, show function code dispatch profile);
+
+/*
+    mdRTUProfileClear
+        @return
+    接口：清除分派统计，Modbus任务可能正在累计，关中断清除
+*/
+static mdVOID mdRTUProfileClear(mdVOID)
+{
+    mdU32 primask;
+
+    if (mdhandler == NULL)
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(mdhandler->profile, 0, sizeof(mdhandler->profile));
+    mdhandler->profileOther = 0;
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_prof_clear, mdRTUProfileClear, clear function code dispatch profile);
+#endif
+
+#if (MODBUS_AUTH)
+/*
+    mdRTUAuthVerify
+        @handler 句柄
+        @index   请求所属单元的下标
+        @return  认证通过返回 mdTRUE
+    接口：由序号低字节还原大于该单元最后接受序号的最小序号并校验MAC，通过后去除认证尾并就地重算CRC，
+    之后按不认证的帧处理(重复帧缓存以去除认证尾后的帧标识)；
+    失败时以认证异常应答带回最后接受的序号(高字节在前)，主站据此重新同步
+*/
+static mdSTATUS mdRTUAuthVerify(ModbusRTUSlaveHandler handler, mdU32 index)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count, len, seq, tag, ceiling;
+    mdU16 crc;
+
+    if (reclen < 4U + MODBUS_AUTH_SIZE)
+    {
+        handler->authFailures++;
+        handler->mdRTUError(handler, ERROR2);
+        return mdFALSE;
+    }
+    len = reclen - MODBUS_AUTH_SIZE - 2U;
+    seq = mdAuthSequence(handler->authSeq[index], recbuf[len]);
+    tag = mdAuthTag(handler->auth, MODBUS_AUTH_REQUEST, seq, recbuf, len);
+    /*异常应答同样签名，以收到的请求MAC为随机数*/
+    handler->authSeqLow = recbuf[len];
+    handler->authTag = recbuf[len + 1U] | ((mdU32)recbuf[len + 2U] << 8U) | ((mdU32)recbuf[len + 3U] << 16U);
+    handler->authActive = mdTRUE;
+    if (tag != handler->authTag)
+    {
+        handler->authFailures++;
+        handler->exceptions++;
+        mdRTUTxBegin(handler);
+        mdRTUTxPutU8(handler, recbuf[0]);
+        mdRTUTxPutU8(handler, recbuf[1] | MODBUS_EXCEPTION_FLAG);
+        mdRTUTxPutU8(handler, MODBUS_EXCEPTION_AUTH);
+        mdRTUTxPutU16(handler, handler->authSeq[index] >> 16U);
+        mdRTUTxPutU16(handler, handler->authSeq[index]);
+        mdRTUTxEnd(handler);
+        return mdFALSE;
+    }
+    if (seq > handler->authCeiling)
+    {
+        /*每65536个序号保存一次上限*/
+        ceiling = (seq | 0xFFFFUL) + 1U;
+        if ((handler->mdRTUAuthCeiling != NULL) && !handler->mdRTUAuthCeiling(handler, ceiling))
+        {
+            handler->mdRTUError(handler, ERROR1);
+            mdRTUException(handler, MODBUS_EXCEPTION_FAILURE);
+            return mdFALSE;
+        }
+        handler->authCeiling = ceiling;
+    }
+    handler->authSeq[index] = seq;
+    crc = mdCrc16(recbuf, len);
+    recbuf[len++] = crc;
+    recbuf[len++] = crc >> 8U;
+    handler->receiveBuffer->count = len;
+
+    return mdTRUE;
+}
+#endif
+
+/*
+    mdRTUForwardFrame
+        @handler 句柄
+        @return
+    中继转发:L101定点模式不携带源地址，按转发表项的状态区分方向，等待下游应答期间收到的帧为应答，
+    加上本站应答帧头回传主站；否则为主站请求，改用下游节点的定点帧头原样(含CRC)转发；
+    主站对经中继的请求按跳数放宽超时，等待期间不会重发
+*/
+static mdVOID mdRTUForwardFrame(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count, now = osKernelSysTick();
+    struct ModbusRTUForward *forward = NULL;
+
+    for (mdU32 i = 0; i < handler->forwardCount; i++)
+    {
+        if (handler->forwards[i].id == mdGetSlaveId())
+        {
+            forward = &handler->forwards[i];
+            break;
+        }
+    }
+    if ((forward == NULL) || (reclen + MODBUS_FORWARD_HEADER > MODBUS_TX_BUFFER_SIZE))
+    {
+        handler->mdRTUError(handler, ERROR4);
+        return;
+    }
+    if (forward->waiting && ((mdU32)(now - forward->tick) < MODBUS_FORWARD_TIMEOUT))
+    {
+        forward->waiting = mdFALSE;
+        handler->returned++;
+        mdRTUTxBegin(handler);
+        memcpy(&handler->txBuffer[handler->txLength], recbuf, reclen);
+        handler->mdRTUSendString(handler, handler->txBuffer, handler->txLength + reclen);
+        return;
+    }
+    handler->forwardTimeouts += forward->waiting ? 1U : 0U;
+    handler->txBuffer[0] = HIGH(forward->addr);
+    handler->txBuffer[1] = LOW(forward->addr);
+    handler->txBuffer[2] = forward->channel;
+    memcpy(&handler->txBuffer[MODBUS_FORWARD_HEADER], recbuf, reclen);
+    forward->waiting = mdTRUE;
+    forward->tick = now;
+    handler->forwarded++;
+    handler->mdRTUSendString(handler, handler->txBuffer, MODBUS_FORWARD_HEADER + reclen);
+}
+
+/*
+    mdModbusRTUCenterProcessor
+        @handler 句柄
+        @receFrame 待处理的帧（已校验通过）
+    处理一帧，并且通过接口发送处理结果
+*/
+static mdVOID mdRTUCenterProcessor(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    ModbusRTUCodeHandle handle;
+    mdU8 exception, unit;
+#if (MODBUS_CODE_PROFILE)
+    mdU32 start;
+#endif
+
+    /*还原为RTU帧:RTU帧的CRC已在接收过程中增量计算，ASCII帧校验LRC后转换*/
+    if (!handler->codec->decode(handler->receiveBuffer))
+    {
+        handler->mdRTUError(handler, ERROR3);
+        return;
+    }
+    reclen = handler->receiveBuffer->count;
+    if (reclen < 3)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+#if defined(USING_DEBUG)
+    shellPrint(&shell, "gcrc = 0x%04x, crc = 0x%04x\r\n", mdCrc16(recbuf, reclen - 2), mdGetCrc16());
+#endif
+#if (MODBUS_AUTH)
+    handler->authActive = mdFALSE;
+#endif
+    /*组播帧:各从站从位图中取出自己的位，不应答*/
+    if ((mdGetSlaveId() == MODBUS_BROADCAST_ID) && (mdGetCode() == MODBUS_CODE_15))
+    {
+#if (MODBUS_AUTH)
+        if (handler->auth != NULL)
+        {
+            handler->authFailures++;
+            return;
+        }
+#endif
+        mdRTUHandleGroup(handler);
+        return;
+    }
+    /*其余广播帧只交给注册的自定义功能码(如固件分发)，处理函数不应答*/
+    if (mdGetSlaveId() == MODBUS_BROADCAST_ID)
+    {
+        handle = mdRTUFindCode(handler, mdGetCode());
+#if (MODBUS_AUTH)
+        if ((handler->auth != NULL) && (handle != NULL))
+        {
+            handler->authFailures++;
+            return;
+        }
+#endif
+        if ((handle != NULL) && (handler->unitCount > 0))
+        {
+            handler->unitPool = handler->unitPools[0];
+            handle(handler);
+        }
+        return;
+    }
+    /*按站号直接查单元表，请求在该单元的寄存器池上执行*/
+    unit = handler->unitMap[mdGetSlaveId()];
+    if (unit == 0)
+    {
+        handler->mdRTUError(handler, ERROR4);
+        return;
+    }
+    if (unit == MODBUS_UNIT_FORWARD)
+    {
+        mdRTUForwardFrame(handler);
+        return;
+    }
+    if ((handler->mdRTURequest != NULL) && !handler->mdRTURequest(handler, mdGetSlaveId()))
+    {
+        return;
+    }
+#if (MODBUS_AUTH)
+    /*转发的帧由下游从站校验；认证只用于RTU编解码器*/
+    if ((handler->auth != NULL) && handler->codec->rtuFilter)
+    {
+        if (!mdRTUAuthVerify(handler, unit - 1U))
+        {
+            return;
+        }
+        reclen = handler->receiveBuffer->count;
+    }
+#endif
+    handler->unitPool = handler->unitPools[unit - 1U];
+    handle = mdRTUFindCode(handler, mdGetCode());
+    if (handle == NULL)
+    {
+        handler->mdRTUError(handler, ERROR5);
+        mdRTUException(handler, MODBUS_EXCEPTION_FUNCTION);
+        return;
+    }
+    /*非法请求在访问寄存器池之前即以异常应答结束，不进入重复帧缓存*/
+    exception = mdRTUCheckRequest(handler);
+    if (exception)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        mdRTUException(handler, exception);
+        return;
+    }
+    if (mdRTUDupCacheable(mdGetCode()))
+    {
+        struct ModbusRTUDupEntry *entry = mdRTUDupLookup(handler);
+        /*主站因应答丢失而重传:命令已执行，只重发缓存的应答(翻转、脉冲等不会执行两次)*/
+        if (entry != NULL)
+        {
+            handler->dupHits++;
+#if (MODBUS_AUTH)
+            /*已认证的重传帧序号不同:取出缓存应答的 帧头+从机地址+PDU 按本次请求重新签名*/
+            mdU32 plain = handler->authActive ? mdRTUDupPlain(handler, entry) : 0;
+            if (plain >= handler->codec->headerLength + MODBUS_AUTH_SIZE + 4U)
+            {
+                handler->txLength = plain - MODBUS_AUTH_SIZE - 2U;
+                handler->txOverflow = mdFALSE;
+                mdRTUTxEnd(handler);
+                return;
+            }
+#endif
+            handler->mdRTUSendString(handler, entry->reply, entry->replyLength);
+            return;
+        }
+        mdRTUDupBegin(handler);
+    }
+#if (MODBUS_CODE_PROFILE)
+    start = mdRTUProfileBegin();
+    handle(handler);
+    mdRTUProfileEnd(handler, mdGetCode(), start);
+#else
+    handle(handler);
+#endif
+    /*未发出应答(出错)的命令不缓存*/
+    handler->dupCapture = NULL;
+}
+#endif
+
+/*
+    mdRTUAttachPort
+        @handler 句柄
+        @return
+    接口：把句柄绑定的串口驱动的接收交给该实例
+*/
+static mdVOID mdRTUAttachPort(ModbusRTUSlaveHandler handler)
+{
+#if (USING_DMA_TRANSPORT)
+    if (handler->port == NULL)
+    {
+        return;
+    }
+#if (RTU_TIMER_FRAMING)
+    /*定时器成帧需要在中断中跟踪接收进度，接收段直接在中断中追加到接收帧*/
+    Uart_Dma_Attach((UartDma_HandleTypeDef *)handler->port, portRtuRxEvent, NULL, handler);
+#else
+    /*中断只发布接收段，处理该实例的任务取走后追加到协议栈的接收帧*/
+    Uart_Dma_Attach((UartDma_HandleTypeDef *)handler->port, portRtuRxEvent, portRtuRxNotify, handler);
+#endif
+#endif
+}
+
+/* ================================================================== */
+/*                        API                                         */
+/* ================================================================== */
+/*
+    mdCreateModbusRTUSlave
+        @handler 句柄
+        @info    创建参数
+    创建一个modbus从机；info.port 非 NULL 时把该串口的接收绑定到新实例
+*/
+mdSTATUS mdCreateModbusRTUSlave(ModbusRTUSlaveHandler *handler, struct ModbusRTUSlaveRegisterInfo info)
+{
+    mdmalloc((*handler), struct ModbusRTUSlave, 1U);
+#if defined(USING_DEBUG)
+    shellPrint(&shell, "handler = 0x%p\r\n", *handler);
+#endif
+    if ((*handler) == NULL)
+    {
+        return mdFALSE;
+    }
+    (*handler)->mdRTUPopChar = info.mdRTUPopChar;
+    (*handler)->mdRTUCenterProcessor = mdRTUCenterProcessor;
+    (*handler)->mdRTUError = mdRTUError;
+    (*handler)->mdRTURxNotify = info.mdRTURxNotify;
+    (*handler)->port = info.port;
+    (*handler)->slaveId = info.slaveId;
+    /*波特率高于19200时按规范使用固定值:t1.5 = 750us，t3.5 = 1750us*/
+    (*handler)->invalidTime = (info.usartBaudRate > 19200U) ? 750U : (mdU32)(1.5 * DATA_BITS * 1000 * 1000 / info.usartBaudRate);
+    (*handler)->stopTime = (info.usartBaudRate > 19200U) ? 1750U : (mdU32)(3.5 * DATA_BITS * 1000 * 1000 / info.usartBaudRate);
+    (*handler)->frameMark = 0;
+    (*handler)->frameQuiet = mdFALSE;
+    (*handler)->frameGaps = 0;
+    (*handler)->lossFrames = 0;
+    (*handler)->rxFrames = 0;
+    (*handler)->txFrames = 0;
+    memset((*handler)->errorCodes, 0, sizeof((*handler)->errorCodes));
+    (*handler)->errors = 0;
+    (*handler)->updateFlag = false;
+    (*handler)->portRTUPushChar = portRtuPushChar;
+    (*handler)->portRTUTimerTick = portRtuTimerTick;
+    (*handler)->portRTUPushString = portRtuPushString;
+    (*handler)->mdRTUSendString = mdRTUSendString;
+    (*handler)->mdRTUSendFrame = mdRTUSendFrame;
+    (*handler)->mdRTUTxDone = NULL;
+    (*handler)->mdRTUCoilWritten = NULL;
+    (*handler)->mdRTUHoldWritten = NULL;
+    memset((*handler)->customCodes, 0, sizeof((*handler)->customCodes));
+    (*handler)->txHead = (*handler)->txTail = 0;
+    (*handler)->txBusy = mdFALSE;
+    (*handler)->txDropped = 0;
+    (*handler)->txLastLength = 0;
+    (*handler)->receiveBuffer = NULL;
+#if (MODBUS_ROLE_MASTER)
+    (*handler)->txDepth = info.txFrames;
+    (*handler)->txQueue = NULL;
+    (*handler)->poolShared = (info.registerPool != NULL) ? mdTRUE : mdFALSE;
+    (*handler)->registerPool = info.registerPool;
+
+    if (info.txFrames > 0)
+    {
+        mdmalloc((*handler)->txQueue, struct TransmitFrame, info.txFrames);
+    }
+    if (((info.txFrames == 0) || ((*handler)->txQueue != NULL)) &&
+        ((*handler)->poolShared || mdCreateRegisterPool(&((*handler)->registerPool))))
+    {
+        if (mdCreateReceiveBuffer(&((*handler)->receiveBuffer)))
+        {
+            (*handler)->unitPool = (*handler)->registerPool;
+            mdRTUAttachPort(*handler);
+            return mdTRUE;
+        }
+        if (!(*handler)->poolShared)
+        {
+            mdDestoryRegisterPool(&((*handler)->registerPool));
+        }
+    }
+#else
+    (*handler)->codec = mdCodecFind(MODBUS_FRAME_CODEC);
+    (*handler)->mdRTURequest = NULL;
+    (*handler)->reportAddress = 0;
+    (*handler)->reportLength = 0;
+    (*handler)->reportHealth = mdFALSE;
+    (*handler)->mdRTUReportAnalog = NULL;
+    (*handler)->mdRTUFastWrite = NULL;
+    (*handler)->fastSpan = 0;
+    (*handler)->fastStart = mdTRUE;
+    (*handler)->fastFrames = 0;
+    (*handler)->lastRssi = MODBUS_RSSI_UNKNOWN;
+    memset((*handler)->dupCache, 0, sizeof((*handler)->dupCache));
+    (*handler)->dupNext = 0;
+    (*handler)->dupCapture = NULL;
+    (*handler)->dupHits = 0;
+    (*handler)->exceptions = 0;
+#if (MODBUS_CODE_PROFILE)
+    memset((*handler)->profile, 0, sizeof((*handler)->profile));
+    (*handler)->profileOther = 0;
+    /*分派耗时使用DWT周期计数器*/
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    memset((*handler)->unitMap, 0, sizeof((*handler)->unitMap));
+    memset((*handler)->unitPools, 0, sizeof((*handler)->unitPools));
+    (*handler)->unitCount = 0;
+    memset((*handler)->forwards, 0, sizeof((*handler)->forwards));
+    (*handler)->forwardCount = 0;
+    (*handler)->forwarded = 0;
+    (*handler)->returned = 0;
+    (*handler)->forwardTimeouts = 0;
+#if (MODBUS_AUTH)
+    (*handler)->auth = NULL;
+    memset((*handler)->authSeq, 0, sizeof((*handler)->authSeq));
+    (*handler)->authCeiling = 0;
+    (*handler)->mdRTUAuthCeiling = NULL;
+    (*handler)->authActive = mdFALSE;
+    (*handler)->authFailures = 0;
+#endif
+
+    (*handler)->registerPool = NULL;
+    if (mdCreateRegisterPool(&((*handler)->registerPool)))
+    {
+        if (mdCreateReceiveBuffer(&((*handler)->receiveBuffer)))
+        {
+            /*主单元:站号 slaveId，使用协议栈自身的寄存器池*/
+            (*handler)->unitPools[0] = (*handler)->unitPool = (*handler)->registerPool;
+            (*handler)->unitIds[0] = info.slaveId;
+            (*handler)->unitMap[info.slaveId] = 1U;
+            (*handler)->unitCount = 1U;
+            mdRTUAttachPort(*handler);
+            return mdTRUE;
+        }
+        mdDestoryRegisterPool(&((*handler)->registerPool));
+    }
+#endif
+#if defined(USING_DEBUG)
+    shellPrint(&shell, "Cpool = %d, Crec = %d\r\n", (*handler)->registerPool != NULL, (*handler)->receiveBuffer != NULL);
+#endif
+#if (MODBUS_ROLE_MASTER)
+    if ((*handler)->txQueue != NULL)
+    {
+        mdfree((*handler)->txQueue);
+    }
+#endif
+    mdfree(*handler);
+    (*handler) = NULL;
+    return mdFALSE;
+}
+
+/*
+    mdRTUFrameIdle
+        @handler 句柄
+        @count   当前帧DMA已接收的字节数
+        @return
+    定时器成帧(中断中调用):串口空闲中断时记录接收位置，随后由端口重新启动 t1.5/t3.5 定时；
+    若上一次空闲后线路已保持 t1.5 而帧仍在继续，则记一次帧内间隔超限
+*/
+mdVOID mdRTUFrameIdle(ModbusRTUSlaveHandler handler, mdU32 count)
+{
+    if (handler->frameQuiet && (count != handler->frameMark))
+    {
+        handler->frameGaps++;
+    }
+    handler->frameMark = count;
+    handler->frameQuiet = mdFALSE;
+}
+
+/*
+    mdRTUFrameCheck
+        @handler 句柄
+        @count   当前帧DMA已接收的字节数
+        @return
+    定时器成帧(中断中调用):空闲中断后 t1.5 时刻，记录期间是否收到新字符
+*/
+mdVOID mdRTUFrameCheck(ModbusRTUSlaveHandler handler, mdU32 count)
+{
+    handler->frameQuiet = (count == handler->frameMark) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdRTUFrameTimeout
+        @handler 句柄
+        @count   当前帧DMA已接收的字节数
+        @return  线路保持 t3.5 空闲(帧结束)返回 mdTRUE，期间收到新字符返回 mdFALSE(等待下一次空闲中断)
+    定时器成帧(中断中调用):空闲中断后 t3.5 时刻判定帧是否结束
+*/
+mdBOOL mdRTUFrameTimeout(ModbusRTUSlaveHandler handler, mdU32 count)
+{
+    return (count == handler->frameMark) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdRTUFrameCommit
+        @handler 句柄
+        @count   帧长度
+        @return  帧交给任务处理返回 mdTRUE
+    定时器成帧(中断中调用):帧结束后提交接收帧；帧内字符间隔超过 t1.5 且未开启 IGNORE_LOSS_FRAME 时丢弃该帧
+*/
+mdSTATUS mdRTUFrameCommit(ModbusRTUSlaveHandler handler, mdU32 count)
+{
+    mdU32 gaps = handler->frameGaps;
+
+    handler->frameMark = 0;
+    handler->frameQuiet = mdFALSE;
+    handler->frameGaps = 0;
+    if ((gaps > 0) && (IGNORE_LOSS_FRAME == 0))
+    {
+        handler->lossFrames++;
+        mdReceiveBufferDiscard(handler->receiveBuffer);
+        return mdFALSE;
+    }
+    return mdReceiveBufferCommit(handler->receiveBuffer, count);
+}
+#if !(MODBUS_ROLE_MASTER)
+/*
+    mdRTUDupFlush
+        @handler 句柄
+        @return
+    清空重复帧缓存:本地改变了输出(如通信超时的失效保护)后，主站重传的命令需要重新执行；
+    在Modbus接收任务上下文中调用
+*/
+mdVOID mdRTUDupFlush(ModbusRTUSlaveHandler handler)
+{
+    for (mdU32 i = 0; i < MODBUS_DUP_CACHE; i++)
+    {
+        handler->dupCache[i].replyLength = 0;
+    }
+    handler->dupCapture = NULL;
+}
+
+#if (MODBUS_AUTH)
+/*
+    mdRTUSetAuth
+        @handler 句柄
+        @auth    认证密钥，NULL 时关闭认证
+        @ceiling 已保存的序号上限，各单元从此开始接受更大的序号
+        @return
+    开启或关闭帧认证并清空重复帧缓存(缓存的应答格式随之改变)；Modbus任务可能正在处理，关中断切换
+*/
+mdVOID mdRTUSetAuth(ModbusRTUSlaveHandler handler, struct ModbusAuth *auth, mdU32 ceiling)
+{
+    mdU32 primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (mdU32 i = 0; i < MODBUS_UNITS; i++)
+    {
+        handler->authSeq[i] = ceiling;
+    }
+    handler->authCeiling = ceiling;
+    handler->auth = auth;
+    mdRTUDupFlush(handler);
+    __set_PRIMASK(primask);
+}
+#endif
+#endif
+
+/*
+    mdRTURegisterCode
+        @handler 句柄
+        @code    功能码
+        @handle  处理函数，为 NULL 时注销该功能码
+        @return  成功返回 mdTRUE，自定义功能码表已满返回 mdFALSE
+    注册一个自定义功能码(如FC23、FC43)，也可覆盖标准功能码的处理函数
+*/
+mdSTATUS mdRTURegisterCode(ModbusRTUSlaveHandler handler, mdU8 code, ModbusRTUCodeHandle handle)
+{
+    struct ModbusRTUCustomCode *slot = NULL;
+
+    for (mdU32 i = 0; i < MODBUS_CUSTOM_CODES; i++)
+    {
+        struct ModbusRTUCustomCode *entry = &handler->customCodes[i];
+        if ((entry->handle != NULL) && (entry->code == code))
+        {
+            entry->handle = handle;
+            return mdTRUE;
+        }
+        if ((entry->handle == NULL) && (slot == NULL))
+        {
+            slot = entry;
+        }
+    }
+    if (handle == NULL)
+    {
+        return mdTRUE;
+    }
+    if (slot == NULL)
+    {
+        return mdFALSE;
+    }
+    slot->code = code;
+    slot->handle = handle;
+    return mdTRUE;
+}
+
+#if (MODBUS_ROLE_MASTER)
+/*
+    mdRTURegisterFile
+        @file    文件号
+        @read    读函数，为 NULL 时注销该文件
+        @write   写函数，为 NULL 时文件只读
+        @return  成功返回 mdTRUE，文件表已满返回 mdFALSE
+    登记一个供20/21功能码读写的文件(如事件记录、趋势、参数)，已登记的文件号替换其读写函数
+*/
+mdSTATUS mdRTURegisterFile(mdU16 file, ModbusRTUFileRead read, ModbusRTUFileWrite write)
+{
+    struct ModbusRTUFile *slot = mdRTUFindFile(file);
+
+    for (mdU32 i = 0; (slot == NULL) && (i < MODBUS_FILES); i++)
+    {
+        if (mdRTUFiles[i].read == NULL)
+        {
+            slot = &mdRTUFiles[i];
+        }
+    }
+    if (slot == NULL)
+    {
+        return (read == NULL) ? mdTRUE : mdFALSE;
+    }
+    slot->file = file;
+    slot->write = write;
+    slot->read = read;
+    return mdTRUE;
+}
+#else
+/*
+    mdRTUReply
+        @handler 句柄
+        @pdu     应答PDU(功能码+数据)
+        @length  PDU长度
+        @return
+    供自定义功能码处理函数回送应答:按当前编解码器加帧头及校验，开启帧认证时同样签名
+*/
+mdVOID mdRTUReply(ModbusRTUSlaveHandler handler, const mdU8 *pdu, mdU32 length)
+{
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, handler->receiveBuffer->buf[0]);
+    mdRTUTxPutString(handler, (mdU8 *)pdu, length);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUSendFrom
+        @handler 句柄
+        @id      从机地址
+        @pdu     PDU(功能码+数据)
+        @length  PDU长度
+        @return
+    在Modbus任务中主动发出一帧(如对广播的延迟应答):按当前编解码器加帧头及校验；
+    不对应当前请求，开启帧认证时不签名
+*/
+mdVOID mdRTUSendFrom(ModbusRTUSlaveHandler handler, mdU8 id, const mdU8 *pdu, mdU32 length)
+{
+#if (MODBUS_AUTH)
+    handler->authActive = mdFALSE;
+#endif
+    mdRTUTxBegin(handler);
+    mdRTUTxPutU8(handler, id);
+    mdRTUTxPutString(handler, (mdU8 *)pdu, length);
+    mdRTUTxEnd(handler);
+}
+
+/*
+    mdRTUReplyException
+        @handler   句柄
+        @exception 异常码
+        @return
+    供自定义功能码处理函数回送异常应答
+*/
+mdVOID mdRTUReplyException(ModbusRTUSlaveHandler handler, mdU8 exception)
+{
+    mdRTUException(handler, exception);
+}
+
+/*
+    mdRTUAddUnit
+        @handler 句柄
+        @id      逻辑单元的站号(1~247，不得与已有单元重复)
+        @pool    返回该单元新建的寄存器池，可为 NULL
+        @return  单元表已满、站号非法或寄存器池分配失败返回 mdFALSE
+    在同一从站上增加一个逻辑单元(如继电器单元之外的模拟量单元)，发往该站号的请求在其独立的寄存器池上执行；
+    写入不触发 mdRTUCoilWritten/mdRTUHoldWritten，用户通过寄存器池的变化订阅处理；组播帧仍只作用于主单元
+*/
+mdSTATUS mdRTUAddUnit(ModbusRTUSlaveHandler handler, mdU8 id, RegisterPoolHandle *pool)
+{
+    RegisterPoolHandle unitPool = NULL;
+
+    if ((handler->unitCount >= MODBUS_UNITS) || (id == MODBUS_BROADCAST_ID) || (id > MODBUS_UNIT_ID_MAX) ||
+        handler->unitMap[id] || !mdCreateRegisterPool(&unitPool))
+    {
+        return mdFALSE;
+    }
+    handler->unitPools[handler->unitCount] = unitPool;
+    handler->unitIds[handler->unitCount] = id;
+    handler->unitCount++;
+    /*最后登记站号(单字节写入)，接收中断及中心处理器随即开始接收该站号*/
+    handler->unitMap[id] = (mdU8)handler->unitCount;
+    if (pool != NULL)
+    {
+        *pool = unitPool;
+    }
+    return mdTRUE;
+}
+
+/*
+    mdRTUFindUnit
+        @handler 句柄
+        @id      站号
+        @return  该站号逻辑单元的寄存器池，不是本站单元时返回 NULL
+*/
+RegisterPoolHandle mdRTUFindUnit(ModbusRTUSlaveHandler handler, mdU8 id)
+{
+    mdU8 unit = handler->unitMap[id];
+
+    return (unit && (unit != MODBUS_UNIT_FORWARD)) ? handler->unitPools[unit - 1U] : NULL;
+}
+
+/*
+    mdRTUAliasUnit
+        @handler 句柄
+        @id      站号(1~247)
+        @enable  mdTRUE:映射到主单元 mdFALSE:取消映射
+        @return  站号非法或已属于其他单元/转发表返回 mdFALSE
+    把站号映射到主单元(从站模拟器):发往该站号的请求在主单元的寄存器池上执行，应答带回请求的站号；
+    主单元自身的站号不能取消
+*/
+mdSTATUS mdRTUAliasUnit(ModbusRTUSlaveHandler handler, mdU8 id, mdBOOL enable)
+{
+    if ((id == MODBUS_BROADCAST_ID) || (id > MODBUS_UNIT_ID_MAX) || (handler->unitCount == 0) ||
+        (handler->unitMap[id] > 1U))
+    {
+        return mdFALSE;
+    }
+    if (id != handler->slaveId)
+    {
+        handler->unitMap[id] = enable ? 1U : 0;
+    }
+    return mdTRUE;
+}
+
+/*
+    mdRTUAddForward
+        @handler 句柄
+        @id      下游从站号(1~247，不得为本站单元)
+        @addr    下游节点L101地址
+        @channel 下游节点信道
+        @return  转发表已满或站号非法返回 mdFALSE，已有的站号更新其下游节点
+    本站作为中继，把发往站号 id 的请求转发给下游节点
+*/
+mdSTATUS mdRTUAddForward(ModbusRTUSlaveHandler handler, mdU8 id, mdU16 addr, mdU8 channel)
+{
+    struct ModbusRTUForward *forward = NULL;
+
+    if ((id == MODBUS_BROADCAST_ID) || (id > MODBUS_UNIT_ID_MAX) ||
+        (handler->unitMap[id] && (handler->unitMap[id] != MODBUS_UNIT_FORWARD)))
+    {
+        return mdFALSE;
+    }
+    for (mdU32 i = 0; i < handler->forwardCount; i++)
+    {
+        forward = (handler->forwards[i].id == id) ? &handler->forwards[i] : forward;
+    }
+    if (forward == NULL)
+    {
+        if (handler->forwardCount >= MODBUS_FORWARDS)
+        {
+            return mdFALSE;
+        }
+        forward = &handler->forwards[handler->forwardCount++];
+    }
+    forward->addr = addr;
+    forward->channel = channel;
+    forward->waiting = mdFALSE;
+    forward->id = id;
+    /*最后登记站号，接收中断随即开始接收该站号的帧*/
+    handler->unitMap[id] = MODBUS_UNIT_FORWARD;
+    return mdTRUE;
+}
+
+/*
+    mdRTUClearForwards
+        @handler 句柄
+        @return
+    清空中继转发表
+*/
+mdVOID mdRTUClearForwards(ModbusRTUSlaveHandler handler)
+{
+    for (mdU32 i = 0; i < handler->forwardCount; i++)
+    {
+        handler->unitMap[handler->forwards[i].id] = 0;
+    }
+    handler->forwardCount = 0;
+}
+
+/*
+    mdRTUUnitShow
+        @return
+    接口：列出本站的逻辑单元
+*/
+static mdVOID mdRTUUnitShow(mdVOID)
+{
+    if (mdhandler == NULL)
+    {
+        return;
+    }
+    for (mdU32 i = 0; i < mdhandler->unitCount; i++)
+    {
+        shellPrint(&shell, "unit %lu: id = 0x%02x, pool = 0x%p%s\r\n", (unsigned long)i, mdhandler->unitIds[i],
+                   mdhandler->unitPools[i], i ? "" : " (primary)");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_units, mdRTUUnitShow, list modbus logical units);
+
+/*
+    mdRTUUnitAdd
+        @id     站号
+        @return 成功返回0，失败返回0xFF
+    接口：运行时增加一个逻辑单元(寄存器池初值为0，掉电不保存)
+*/
+static int mdRTUUnitAdd(int id)
+{
+    if ((mdhandler == NULL) || (id < 0) || (id > 0xFF) || !mdRTUAddUnit(mdhandler, (mdU8)id, NULL))
+    {
+        return 0xFF;
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), md_unit_add, mdRTUUnitAdd, add a modbus logical unit);
+
+/*
+    mdRTUSetCodec
+        @handler 句柄
+        @id      编解码器编号(MODBUS_CODEC_RTU 等)
+        @return  编解码器不存在或未编译时返回 mdFALSE
+    切换成帧编解码器:RTU类编解码器在接收中断中按CRC及站号过滤，ASCII及透明通道关闭过滤；
+    接收帧环中尚未处理的帧按新格式解码
+*/
+mdSTATUS mdRTUSetCodec(ModbusRTUSlaveHandler handler, mdU32 id)
+{
+    const struct ModbusCodec *codec = mdCodecFind(id);
+
+    if (codec == NULL)
+    {
+        return mdFALSE;
+    }
+    if ((CRC_CHECK != 0) && codec->rtuFilter)
+    {
+        mdReceiveBufferFilter(handler->receiveBuffer, handler->unitMap, MODBUS_BROADCAST_ID);
+    }
+    else
+    {
+        handler->receiveBuffer->filter = mdFALSE;
+    }
+    handler->codec = codec;
+    return mdTRUE;
+}
+#endif
+
+/*
+    mdDestoryModbusRTUSlave
+        @handler 句柄
+    销毁一个modbus从机
+*/
+mdVOID mdDestoryModbusRTUSlave(ModbusRTUSlaveHandler *handler)
+{
+#if (MODBUS_ROLE_MASTER)
+    if (!(*handler)->poolShared)
+    {
+        mdDestoryRegisterPool(&((*handler)->registerPool));
+    }
+    if ((*handler)->txQueue != NULL)
+    {
+        mdfree((*handler)->txQueue);
+    }
+#else
+    for (mdU32 i = 1; i < (*handler)->unitCount; i++)
+    {
+        mdDestoryRegisterPool(&((*handler)->unitPools[i]));
+    }
+    mdDestoryRegisterPool(&((*handler)->registerPool));
+#endif
+    mdDestoryReceiveBuffer(&((*handler)->receiveBuffer));
+    mdfree(*handler);
+    (*handler) = NULL;
+}
+
+/*
+    mdU16Swap
+        @*data   交换的缓冲区
+        @*length 长度
+    交换一个mdU16缓冲区中相邻两个元素，奇数长度时最后一个不变(见 mdSwapU16Pairs)
+*/
+mdVOID mdU16Swap(mdU16 *data, mdU32 length)
+{
+    mdSwapU16Pairs(data, length);
+}
+
+#endif
@@ -348,6 +348,7 @@ typedef struct shell_def
         unsigned short number;                                  /**< 历史记录数 */
         unsigned short record;                                  /**< 当前记录位置 */
         signed short offset;                                    /**< 当前历史记录偏移 */
+        unsigned short depth;                                   /**< 当前历史记录深度 */
     } history;
 #endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
     struct
@@ -433,6 +434,7 @@ typedef struct
 #define shellGetPath(_shell)            ((_shell)->info.path)
 
 void shellInit(Shell *shell, char *buffer, unsigned short size);
+void shellSetArena(Shell *shell, char *buffer, unsigned short size, unsigned short history);
 unsigned short shellWriteString(Shell *shell, const char *string);
 void shellPrint(Shell *shell, char *fmt, ...);
 void shellScan(Shell *shell, char *fmt, ...);
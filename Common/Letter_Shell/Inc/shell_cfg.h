@@ -4,172 +4,279 @@
  * @brief shell config
  * @version 3.0.0
  * @date 2019-12-31
- * 
+ *
  * @copyright (c) 2019 Letter
- * 
+ *
  */
 
 #ifndef __SHELL_CFG_H__
 #define __SHELL_CFG_H__
 
+/**
+ * @brief 裁剪配置
+ *        minimal: 只保留命令执行及help，不含历史记录、变量、用户/按键列表、命令索引及启动信息
+ *        field-debug: 现场调试使用，含历史记录、命令索引及启动信息
+ *        full: 全部功能，含变量、伴生对象、列表命令及`exec`
+ */
+#define     SHELL_PROFILE_MINIMAL       0
+#define     SHELL_PROFILE_FIELD_DEBUG   1
+#define     SHELL_PROFILE_FULL          2
+
+/**
+ * @brief 工程配置
+ *        各工程在`shell_cfg_user.h`中选择`SHELL_PROFILE`，并可覆盖本文件中的任意配置项
+ */
+#include "shell_cfg_user.h"
+
+#ifndef SHELL_PROFILE
+#define     SHELL_PROFILE               SHELL_PROFILE_FIELD_DEBUG
+#endif
+
+/**
+ * @brief 是否使用精简后端
+ *        使能后以`shell_lite.c`代替`shell.c`、`shell_ext.c`及`shell_companion.c`:
+ *        只保留整行执行、退格及`help`，命令仍由`SHELL_EXPORT_CMD()`导出，函数型命令的参数为整数、字符或字符串；
+ *        各源文件可同时加入工程，未选用的一组编译为空
+ */
+#ifndef SHELL_USING_LITE
+#define     SHELL_USING_LITE            0
+#endif
 
 /**
  * @brief 是否使用默认shell任务while循环，使能宏`SHELL_USING_TASK`后此宏有意义
  *        使能此宏，则`shellTask()`函数会一直循环读取输入，一般使用操作系统建立shell
  *        任务时使能此宏，关闭此宏的情况下，一般适用于无操作系统，在主循环中调用`shellTask()`
  */
-#define     SHELL_TASK_WHILE            1
+#ifndef SHELL_TASK_WHILE
+#define     SHELL_TASK_WHILE            0
+#endif
 
 /**
  * @brief 是否使用命令导出方式
  *        使能此宏后，可以使用`SHELL_EXPORT_CMD()`等导出命令
  *        定义shell命令，关闭此宏的情况下，需要使用命令表的方式
  */
+#ifndef SHELL_USING_CMD_EXPORT
 #define     SHELL_USING_CMD_EXPORT      1
+#endif
 
 /**
  * @brief 是否使用shell伴生对象
  *        一些扩展的组件(文件系统支持，日志工具等)需要使用伴生对象
  */
-#define     SHELL_USING_COMPANION       0
+#ifndef SHELL_USING_COMPANION
+#define     SHELL_USING_COMPANION       (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
+
+/**
+ * @brief 是否支持shell变量
+ *        关闭后不能读写`SHELL_EXPORT_VAR()`导出的变量，也不能以`$var`作为参数
+ */
+#ifndef SHELL_USING_VAR
+#define     SHELL_USING_VAR             (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
+
+/**
+ * @brief 是否导出`users`、`cmds`、`vars`、`keys`列表命令
+ */
+#ifndef SHELL_USING_LIST_CMD
+#define     SHELL_USING_LIST_CMD        (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
 
 /**
  * @brief 支持shell尾行模式
  */
-#define     SHELL_SUPPORT_END_LINE      1
+#ifndef SHELL_SUPPORT_END_LINE
+#define     SHELL_SUPPORT_END_LINE      (SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG)
+#endif
 
 /**
  * @brief 是否在输出命令列表中列出用户
  */
-#define     SHELL_HELP_LIST_USER        1
+#ifndef SHELL_HELP_LIST_USER
+#define     SHELL_HELP_LIST_USER        (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
 
 /**
  * @brief 是否在输出命令列表中列出变量
  */
+#ifndef SHELL_HELP_LIST_VAR
 #define     SHELL_HELP_LIST_VAR         0
+#endif
 
 /**
  * @brief 是否在输出命令列表中列出按键
  */
+#ifndef SHELL_HELP_LIST_KEY
 #define     SHELL_HELP_LIST_KEY         0
+#endif
 
 /**
  * @brief 是否在输出命令列表中展示命令权限
  */
-#define     SHELL_HELP_SHOW_PERMISSION  1
+#ifndef SHELL_HELP_SHOW_PERMISSION
+#define     SHELL_HELP_SHOW_PERMISSION  (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
 
 /**
  * @brief 使用LF作为命令行回车触发
  *        可以和SHELL_ENTER_CR同时开启
  */
+#ifndef SHELL_ENTER_LF
 #define     SHELL_ENTER_LF              1
+#endif
 
 /**
  * @brief 使用CR作为命令行回车触发
  *        可以和SHELL_ENTER_LF同时开启
  */
+#ifndef SHELL_ENTER_CR
 #define     SHELL_ENTER_CR              1
+#endif
 
 /**
  * @brief 使用CRLF作为命令行回车触发
  *        不可以和SHELL_ENTER_LF或SHELL_ENTER_CR同时开启
  */
+#ifndef SHELL_ENTER_CRLF
 #define     SHELL_ENTER_CRLF            0
+#endif
 
 /**
  * @brief 使用执行未导出函数的功能
  *        启用后，可以通过`exec [addr] [args]`直接执行对应地址的函数
  * @attention 如果地址错误，可能会直接引起程序崩溃
  */
-#define     SHELL_EXEC_UNDEF_FUNC       1
+#ifndef SHELL_EXEC_UNDEF_FUNC
+#define     SHELL_EXEC_UNDEF_FUNC       (SHELL_PROFILE >= SHELL_PROFILE_FULL)
+#endif
 
 /**
  * @brief shell命令参数最大数量
  *        包含命令名在内，超过16个参数并且使用了参数自动转换的情况下，需要修改源码
  */
+#ifndef SHELL_PARAMETER_MAX_NUMBER
 #define     SHELL_PARAMETER_MAX_NUMBER  8
+#endif
 
 /**
  * @brief 历史命令记录数量
+ *        为0时不使用历史记录，输入缓冲全部用于当前命令行
  */
-#define     SHELL_HISTORY_MAX_NUMBER    5
+#ifndef SHELL_HISTORY_MAX_NUMBER
+#define     SHELL_HISTORY_MAX_NUMBER    ((SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG) && !SHELL_USING_LITE ? 5 : 0)
+#endif
 
 /**
  * @brief 双击间隔(ms)
  *        使能宏`SHELL_LONG_HELP`后此宏生效，定义双击tab补全help的时间间隔
  */
+#ifndef SHELL_DOUBLE_CLICK_TIME
 #define     SHELL_DOUBLE_CLICK_TIME     200
+#endif
 
 /**
  * @brief 快速帮助
  *        作用于双击tab的场景，当使能此宏时，双击tab不会对命令进行help补全，而是直接显示对应命令的帮助信息
  */
+#ifndef SHELL_QUICK_HELP
 #define     SHELL_QUICK_HELP            1
-
+#endif
 
 /**
  * @brief 管理的最大shell数量
  */
-#define     SHELL_MAX_NUMBER            5
+#ifndef SHELL_MAX_NUMBER
+#define     SHELL_MAX_NUMBER            ((SHELL_PROFILE >= SHELL_PROFILE_FULL) ? 5 : 1)
+#endif
+
+/**
+ * @brief 命令表排序索引的最大条目数(不大于256)
+ *        `shellInit()`时建立索引，查找命令及按键时二分查找
+ *        命令表条目数超过此值时不建立索引，退回顺序查找；为0时不使用索引
+ */
+#ifndef SHELL_INDEX_MAX_NUMBER
+#define     SHELL_INDEX_MAX_NUMBER      ((SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG) ? 128 : 0)
+#endif
 
 /**
  * @brief shell格式化输出的缓冲大小
  *        为0时不使用shell格式化输出
  */
-#define     SHELL_PRINT_BUFFER          128
+#ifndef SHELL_PRINT_BUFFER
+#define     SHELL_PRINT_BUFFER          ((SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG) ? 256 : 128)
+#endif
 
 /**
  * @brief shell格式化输入的缓冲大小
  *        为0时不使用shell格式化输入
  * @note shell格式化输入会阻塞shellTask, 仅适用于在有操作系统的情况下使用
  */
+#ifndef SHELL_SCAN_BUFFER
 #define     SHELL_SCAN_BUFFER          0
+#endif
 
 /**
  * @brief 获取系统时间(ms)
  *        定义此宏为获取系统Tick，如`HAL_GetTick()`
  * @note 此宏不定义时无法使用双击tab补全命令help，无法使用shell超时锁定
  */
+#ifndef SHELL_GET_TICK
 #define     SHELL_GET_TICK()           HAL_GetTick()
+#endif
 
 /**
  * @brief 使用锁
  * @note 使用shell锁时，需要对加锁和解锁进行实现
  */
+#ifndef SHELL_USING_LOCK
 #define     SHELL_USING_LOCK            1
+#endif
 
 /**
  * @brief shell内存分配
- *        shell本身不需要此接口，若使用shell伴生对象，需要进行定义
+ *        shell本身不需要此接口，若使用shell伴生对象或在`USING_RTOS`下格式化输出，需要进行定义
  */
+#ifndef SHELL_MALLOC
 #define     SHELL_MALLOC(size)          pvPortMalloc(size)
+#endif
 
 /**
  * @brief shell内存释放
- *        shell本身不需要此接口，若使用shell伴生对象，需要进行定义
+ *        shell本身不需要此接口，若使用shell伴生对象或在`USING_RTOS`下格式化输出，需要进行定义
  */
+#ifndef SHELL_FREE
 #define     SHELL_FREE(obj)             vPortFree(obj)
+#endif
 
 /**
  * @brief 是否显示shell信息
  */
-#define     SHELL_SHOW_INFO             1
+#ifndef SHELL_SHOW_INFO
+#define     SHELL_SHOW_INFO             (SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG)
+#endif
 
 /**
  * @brief 是否在登录后清除命令行
  */
-#define     SHELL_CLS_WHEN_LOGIN        1
+#ifndef SHELL_CLS_WHEN_LOGIN
+#define     SHELL_CLS_WHEN_LOGIN        (SHELL_PROFILE >= SHELL_PROFILE_FIELD_DEBUG)
+#endif
 
 /**
  * @brief shell默认用户
  */
+#ifndef SHELL_DEFAULT_USER
 #define     SHELL_DEFAULT_USER          "LHC"
+#endif
 
 /**
  * @brief shell默认用户密码
  *        若默认用户不需要密码，设为""
  */
+#ifndef SHELL_DEFAULT_USER_PASSWORD
 #define     SHELL_DEFAULT_USER_PASSWORD ""
+#endif
 
 /**
  * @brief shell自动锁定超时
@@ -177,6 +284,8 @@
  *        设置为0时关闭自动锁定功能，时间单位为`SHELL_GET_TICK()`单位
  * @note 使用超时锁定必须保证`SHELL_GET_TICK()`有效
  */
+#ifndef SHELL_LOCK_TIMEOUT
 #define     SHELL_LOCK_TIMEOUT          0 * 60 * 1000
+#endif
 
 #endif
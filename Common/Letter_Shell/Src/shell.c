@@ -22,6 +22,7 @@
 #include "cmsis_os.h"
 #endif
 
+#if SHELL_USING_LITE == 0
 #if SHELL_USING_CMD_EXPORT == 1
 /**
  * @brief 默认用户
@@ -166,16 +167,35 @@ static const char *shellText[] =
  */
 static Shell *shellList[SHELL_MAX_NUMBER] = {NULL};
 
+#if SHELL_INDEX_MAX_NUMBER > 0
+/**
+ * @brief shell命令表排序索引
+ *        前 commandCount 项为命令、变量及用户，其后 keyCount 项为按键
+ */
+static struct
+{
+    void *base;                                         /**< 已建立索引的命令表基址 */
+    unsigned char item[SHELL_INDEX_MAX_NUMBER];         /**< 命令在命令表中的序号 */
+    unsigned short commandCount;                        /**< 命令、变量及用户数量 */
+    unsigned short keyCount;                            /**< 按键数量 */
+} shellIndex;
+#endif /** SHELL_INDEX_MAX_NUMBER > 0 */
+
 static void shellAdd(Shell *shell);
 static void shellWritePrompt(Shell *shell, unsigned char newline);
 static void shellWriteReturnValue(Shell *shell, int value);
+#if SHELL_USING_VAR == 1
 static int shellShowVar(Shell *shell, ShellCommand *command);
+#endif
 static void shellSetUser(Shell *shell, const ShellCommand *user);
 ShellCommand *shellSeekCommand(Shell *shell,
                                const char *cmd,
                                ShellCommand *base,
                                unsigned short compareLength);
 static void shellWriteCommandHelp(Shell *shell, char *cmd);
+#if SHELL_INDEX_MAX_NUMBER > 0
+static void shellIndexBuild(Shell *shell);
+#endif
 
 /**
  * @brief shell 初始化
@@ -189,18 +209,7 @@ void shellInit(Shell *shell, char *buffer, unsigned short size)
     shell->info.user = NULL;
     shell->status.isChecked = 1;
 
-    shell->parser.buffer = buffer;
-    shell->parser.bufferSize = size / (SHELL_HISTORY_MAX_NUMBER + 1);
-
-#if SHELL_HISTORY_MAX_NUMBER > 0
-    shell->history.offset = 0;
-    shell->history.number = 0;
-    shell->history.record = 0;
-    for (short i = 0; i < SHELL_HISTORY_MAX_NUMBER; i++)
-    {
-        shell->history.item[i] = buffer + shell->parser.bufferSize * (i + 1);
-    }
-#endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+    shellSetArena(shell, buffer, size, SHELL_HISTORY_MAX_NUMBER);
 
 #if SHELL_USING_CMD_EXPORT == 1
 #if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && __ARMCC_VERSION >= 6000000)
@@ -221,6 +230,9 @@ void shellInit(Shell *shell, char *buffer, unsigned short size)
     shell->commandList.count = shellCommandCount;
 #endif
 
+#if SHELL_INDEX_MAX_NUMBER > 0
+    shellIndexBuild(shell);
+#endif
     shellAdd(shell);
 
     shellSetUser(shell, shellSeekCommand(shell,
@@ -230,6 +242,41 @@ void shellInit(Shell *shell, char *buffer, unsigned short size)
     shellWritePrompt(shell, 1);
 }
 
+/**
+ * @brief shell 设置输入缓冲区
+ *        缓冲区按 history + 1 等分，第一份为命令行，其余为历史记录，
+ *        history 大于`SHELL_HISTORY_MAX_NUMBER`时按`SHELL_HISTORY_MAX_NUMBER`
+ *        buffer 为NULL时shell丢弃输入，缓冲区可暂时借给其他模块使用
+ * @note 在shell任务停放时或在shell命令中调用，当前命令行及历史记录被清空
+ *
+ * @param shell shell对象
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @param history 历史记录深度
+ */
+void shellSetArena(Shell *shell, char *buffer, unsigned short size, unsigned short history)
+{
+    if (history > SHELL_HISTORY_MAX_NUMBER)
+    {
+        history = SHELL_HISTORY_MAX_NUMBER;
+    }
+    shell->parser.length = 0;
+    shell->parser.cursor = 0;
+    shell->parser.buffer = buffer;
+    shell->parser.bufferSize = buffer ? size / (history + 1) : 0;
+
+#if SHELL_HISTORY_MAX_NUMBER > 0
+    shell->history.depth = buffer ? history : 0;
+    shell->history.offset = 0;
+    shell->history.number = 0;
+    shell->history.record = 0;
+    for (short i = 0; i < shell->history.depth; i++)
+    {
+        shell->history.item[i] = buffer + shell->parser.bufferSize * (i + 1);
+    }
+#endif /** SHELL_HISTORY_MAX_NUMBER > 0 */
+}
+
 /**
  * @brief 添加shell
  *
@@ -363,7 +410,7 @@ static void shellWritePrompt(Shell *shell, unsigned char newline)
 void shellPrint(Shell *shell, char *fmt, ...)
 {
 #if defined(USING_RTOS)
-    char *buffer = (char *)pvPortMalloc(SHELL_PRINT_BUFFER);
+    char *buffer = (char *)SHELL_MALLOC(SHELL_PRINT_BUFFER);
 #else
     char buffer[SHELL_PRINT_BUFFER];
 #endif
@@ -371,6 +418,10 @@ void shellPrint(Shell *shell, char *fmt, ...)
     va_list vargs;
 
     SHELL_ASSERT(shell, return );
+#if defined(USING_RTOS)
+    /*堆内存不足时放弃本次输出*/
+    SHELL_ASSERT(buffer, return );
+#endif
 
     va_start(vargs, fmt);
     vsnprintf(buffer, SHELL_PRINT_BUFFER - 1, fmt, vargs);
@@ -378,7 +429,7 @@ void shellPrint(Shell *shell, char *fmt, ...)
 
     shellWriteString(shell, buffer);
 #if defined(USING_RTOS)
-    vPortFree(buffer);
+    SHELL_FREE(buffer);
 #endif
 }
 #endif
@@ -657,6 +708,7 @@ void shellListCommand(Shell *shell)
     }
 }
 
+#if SHELL_USING_VAR == 1 && (SHELL_HELP_LIST_VAR == 1 || SHELL_USING_LIST_CMD == 1)
 /**
  * @brief shell列出变量
  *
@@ -674,7 +726,9 @@ void shellListVar(Shell *shell)
         }
     }
 }
+#endif
 
+#if SHELL_HELP_LIST_USER == 1 || SHELL_USING_LIST_CMD == 1
 /**
  * @brief shell列出用户
  *
@@ -692,7 +746,9 @@ void shellListUser(Shell *shell)
         }
     }
 }
+#endif
 
+#if SHELL_HELP_LIST_KEY == 1 || SHELL_USING_LIST_CMD == 1
 /**
  * @brief shell列出按键
  *
@@ -710,6 +766,7 @@ void shellListKey(Shell *shell)
         }
     }
 }
+#endif
 
 /**
  * @brief shell列出所有命令
@@ -722,7 +779,7 @@ void shellListAll(Shell *shell)
     shellListUser(shell);
 #endif
     shellListCommand(shell);
-#if SHELL_HELP_LIST_VAR == 1
+#if SHELL_USING_VAR == 1 && SHELL_HELP_LIST_VAR == 1
     shellListVar(shell);
 #endif
 #if SHELL_HELP_LIST_KEY == 1
@@ -919,6 +976,89 @@ static void shellRemoveParamQuotes(Shell *shell)
     }
 }
 
+#if SHELL_INDEX_MAX_NUMBER > 0
+/**
+ * @brief shell 命令表排序索引比较
+ *
+ * @param a 命令a
+ * @param b 命令b
+ * @return int 小于0 a在前; 0 相同; 大于0 b在前
+ */
+static int shellIndexCompare(ShellCommand *a, ShellCommand *b)
+{
+    if (a->attr.attrs.type == SHELL_TYPE_KEY)
+    {
+        if ((unsigned int)a->data.key.value == (unsigned int)b->data.key.value)
+        {
+            return 0;
+        }
+        return ((unsigned int)a->data.key.value < (unsigned int)b->data.key.value) ? -1 : 1;
+    }
+    return strcmp(shellGetCommandName(a), shellGetCommandName(b));
+}
+
+/**
+ * @brief shell 建立命令表排序索引
+ *        命令、变量及用户按名称排序，按键按键值排序，相同名称保持命令表中的顺序
+ *        全部shell共用同一命令表，只建立一次
+ *
+ * @param shell shell对象
+ */
+static void shellIndexBuild(Shell *shell)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+    unsigned char *item = shellIndex.item;
+    unsigned short count = 0;
+
+    if (shellIndex.base == shell->commandList.base)
+    {
+        return;
+    }
+    shellIndex.base = NULL;
+    if (shell->commandList.count > SHELL_INDEX_MAX_NUMBER)
+    {
+        return;
+    }
+    for (unsigned char isKey = 0; isKey < 2; isKey++)
+    {
+        unsigned short first = count;
+        for (unsigned short i = 0; i < shell->commandList.count; i++)
+        {
+            if ((base[i].attr.attrs.type == SHELL_TYPE_KEY) != isKey)
+            {
+                continue;
+            }
+            unsigned short j = count++;
+            while (j > first && shellIndexCompare(&base[item[j - 1]], &base[i]) > 0)
+            {
+                item[j] = item[j - 1];
+                j--;
+            }
+            item[j] = (unsigned char)i;
+        }
+        if (!isKey)
+        {
+            shellIndex.commandCount = count;
+        }
+    }
+    shellIndex.keyCount = count - shellIndex.commandCount;
+    shellIndex.base = shell->commandList.base;
+}
+#endif /** SHELL_INDEX_MAX_NUMBER > 0 */
+
+/**
+ * @brief shell 比较命令名称
+ *
+ * @param name 命令名称
+ * @param cmd 命令
+ * @param compareLength 匹配字符串长度，为0时比较整个字符串
+ * @return int 同strcmp
+ */
+static int shellNameCompare(const char *name, const char *cmd, unsigned short compareLength)
+{
+    return compareLength ? strncmp(name, cmd, compareLength) : strcmp(name, cmd);
+}
+
 /**
  * @brief shell匹配命令
  *
@@ -934,6 +1074,38 @@ ShellCommand *shellSeekCommand(Shell *shell,
                                unsigned short compareLength)
 {
     const char *name;
+#if SHELL_INDEX_MAX_NUMBER > 0
+    if (base == shell->commandList.base && shellIndex.base == base)
+    {
+        unsigned short low = 0, high = shellIndex.commandCount, mid;
+        while (low < high)
+        {
+            mid = (low + high) / 2;
+            if (shellNameCompare(shellGetCommandName(&base[shellIndex.item[mid]]), cmd, compareLength) < 0)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        /* 同名(或同前缀)的命令在索引中相邻，取第一个有权限的 */
+        for (; low < shellIndex.commandCount; low++)
+        {
+            ShellCommand *command = &base[shellIndex.item[low]];
+            if (shellNameCompare(shellGetCommandName(command), cmd, compareLength) != 0)
+            {
+                break;
+            }
+            if (shellCheckPermission(shell, command) == 0)
+            {
+                return command;
+            }
+        }
+        return NULL;
+    }
+#endif
     unsigned short count = shell->commandList.count -
                            ((int)base - (int)shell->commandList.base) / sizeof(ShellCommand);
     for (unsigned short i = 0; i < count; i++)
@@ -961,6 +1133,7 @@ ShellCommand *shellSeekCommand(Shell *shell,
     return NULL;
 }
 
+#if SHELL_USING_VAR == 1
 /**
  * @brief shell 获取变量值
  *
@@ -1127,6 +1300,7 @@ int shellSetVar(char *name, int value)
 SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC) | SHELL_CMD_DISABLE_RETURN,
     setVar, shellSetVar, set var);
+#endif /** SHELL_USING_VAR == 1 */
 
 /**
  * @brief shell运行命令
@@ -1161,10 +1335,12 @@ unsigned int shellRunCommand(Shell *shell, ShellCommand *command)
             shellWriteReturnValue(shell, returnValue);
         }
     }
+#if SHELL_USING_VAR == 1
     else if (command->attr.attrs.type >= SHELL_TYPE_VAR_INT && command->attr.attrs.type <= SHELL_TYPE_VAR_NODE)
     {
         shellShowVar(shell, command);
     }
+#endif
     else if (command->attr.attrs.type == SHELL_TYPE_USER)
     {
         shellSetUser(shell, command);
@@ -1251,7 +1427,11 @@ static void shellWriteReturnValue(Shell *shell, int value)
 static void shellHistoryAdd(Shell *shell)
 {
     shell->history.offset = 0;
-    if (shell->history.number > 0 && strcmp(shell->history.item[(shell->history.record == 0 ? SHELL_HISTORY_MAX_NUMBER : shell->history.record) - 1],
+    if (shell->history.depth == 0)
+    {
+        return;
+    }
+    if (shell->history.number > 0 && strcmp(shell->history.item[(shell->history.record == 0 ? shell->history.depth : shell->history.record) - 1],
                                             shell->parser.buffer) == 0)
     {
         return;
@@ -1261,11 +1441,11 @@ static void shellHistoryAdd(Shell *shell)
     {
         shell->history.record++;
     }
-    if (++shell->history.number > SHELL_HISTORY_MAX_NUMBER)
+    if (++shell->history.number > shell->history.depth)
     {
-        shell->history.number = SHELL_HISTORY_MAX_NUMBER;
+        shell->history.number = shell->history.depth;
     }
-    if (shell->history.record >= SHELL_HISTORY_MAX_NUMBER)
+    if (shell->history.record >= shell->history.depth)
     {
         shell->history.record = 0;
     }
@@ -1279,6 +1459,10 @@ static void shellHistoryAdd(Shell *shell)
  */
 static void shellHistory(Shell *shell, signed char dir)
 {
+    if (shell->history.depth == 0)
+    {
+        return;
+    }
     if (dir > 0)
     {
         if (shell->history.offset-- <=
@@ -1309,7 +1493,7 @@ static void shellHistory(Shell *shell, signed char dir)
     else
     {
         if ((shell->parser.length = shellStringCopy(shell->parser.buffer,
-                                                    shell->history.item[(shell->history.record + SHELL_HISTORY_MAX_NUMBER + shell->history.offset) % SHELL_HISTORY_MAX_NUMBER])) == 0)
+                                                    shell->history.item[(shell->history.record + shell->history.depth + shell->history.offset) % shell->history.depth])) == 0)
         {
             return;
         }
@@ -1628,6 +1812,58 @@ SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN) | SHELL_CMD_DISABLE_RETURN,
     help, shellHelp, show command info\r\nhelp[cmd]);
 
+/**
+ * @brief shell 匹配按键
+ *
+ * @param shell shell对象
+ * @param mask 已输入字节及当前字节在键值中的掩码
+ * @param value 已输入字节及当前字节组成的键值
+ * @return ShellCommand* 匹配到的按键
+ */
+static ShellCommand *shellSeekKey(Shell *shell, unsigned int mask, unsigned int value)
+{
+    ShellCommand *base = (ShellCommand *)shell->commandList.base;
+
+#if SHELL_INDEX_MAX_NUMBER > 0
+    if (shellIndex.base == base)
+    {
+        /* 掩码总是从最高字节开始，按键值排序后匹配的按键相邻 */
+        unsigned short low = shellIndex.commandCount, mid;
+        unsigned short high = shellIndex.commandCount + shellIndex.keyCount, end = high;
+        while (low < high)
+        {
+            mid = (low + high) / 2;
+            if (((unsigned int)base[shellIndex.item[mid]].data.key.value & mask) < value)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        for (; low < end && ((unsigned int)base[shellIndex.item[low]].data.key.value & mask) == value; low++)
+        {
+            if (shellCheckPermission(shell, &base[shellIndex.item[low]]) == 0)
+            {
+                return &base[shellIndex.item[low]];
+            }
+        }
+        return NULL;
+    }
+#endif
+    for (unsigned short i = 0; i < shell->commandList.count; i++)
+    {
+        if (base[i].attr.attrs.type == SHELL_TYPE_KEY
+            && ((unsigned int)base[i].data.key.value & mask) == value
+            && shellCheckPermission(shell, &base[i]) == 0)
+        {
+            return &base[i];
+        }
+    }
+    return NULL;
+}
+
 /**
  * @brief shell 输入处理
  *
@@ -1636,7 +1872,7 @@ SHELL_EXPORT_CMD(
  */
 void shellHandler(Shell *shell, char data)
 {
-    SHELL_ASSERT(data, return );
+    SHELL_ASSERT(data && shell->parser.buffer, return );
     SHELL_LOCK(shell);
 
 #if SHELL_LOCK_TIMEOUT > 0
@@ -1668,28 +1904,23 @@ void shellHandler(Shell *shell, char data)
         keyFilter = 0xFF000000;
     }
 
-    /* 遍历ShellCommand列表，尝试进行按键键值匹配 */
-    ShellCommand *base = (ShellCommand *)shell->commandList.base;
-    for (short i = 0; i < shell->commandList.count; i++)
+    /* 在按键中匹配已输入的键值及当前字节 */
+    ShellCommand *key = shellSeekKey(shell,
+                                     (unsigned int)keyFilter | (0xFFU << keyByteOffset),
+                                     (unsigned int)shell->parser.keyValue
+                                         | ((unsigned int)(unsigned char)data << keyByteOffset));
+    if (key)
     {
-        /* 判断是否是按键定义并验证权限 */
-        if (base[i].attr.attrs.type == SHELL_TYPE_KEY && shellCheckPermission(shell, &(base[i])) == 0)
+        shell->parser.keyValue |= data << keyByteOffset;
+        data = 0x00;
+        if (keyByteOffset == 0
+            || (key->data.key.value & (0xFF << (keyByteOffset - 8))) == 0x00000000)
         {
-            /* 对输入的字节同按键键值进行匹配 */
-            if ((base[i].data.key.value & keyFilter) == shell->parser.keyValue && (base[i].data.key.value & (0xFF << keyByteOffset)) == (data << keyByteOffset))
+            if (key->data.key.function)
             {
-                shell->parser.keyValue |= data << keyByteOffset;
-                data = 0x00;
-                if (keyByteOffset == 0 || (base[i].data.key.value & (0xFF << (keyByteOffset - 8))) == 0x00000000)
-                {
-                    if (base[i].data.key.function)
-                    {
-                        base[i].data.key.function(shell);
-                    }
-                    shell->parser.keyValue = 0x00000000;
-                    break;
-                }
+                key->data.key.function(shell);
             }
+            shell->parser.keyValue = 0x00000000;
         }
     }
 
@@ -1760,6 +1991,7 @@ void shellTask(void *param)
 #endif
 }
 
+#if SHELL_USING_LIST_CMD == 1
 /**
  * @brief shell 输出用户列表(shell调用)
  */
@@ -1790,6 +2022,7 @@ SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC) | SHELL_CMD_DISABLE_RETURN,
     cmds, shellCmds, list all cmd);
 
+#if SHELL_USING_VAR == 1
 /**
  * @brief shell 输出变量列表(shell调用)
  */
@@ -1804,6 +2037,7 @@ void shellVars(void)
 SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC) | SHELL_CMD_DISABLE_RETURN,
     vars, shellVars, list all var);
+#endif /** SHELL_USING_VAR == 1 */
 
 /**
  * @brief shell 输出按键列表(shell调用)
@@ -1819,6 +2053,7 @@ void shellKeys(void)
 SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC) | SHELL_CMD_DISABLE_RETURN,
     keys, shellKeys, list all key);
+#endif /** SHELL_USING_LIST_CMD == 1 */
 
 /**
  * @brief shell 清空控制台(shell调用)
@@ -1846,7 +2081,7 @@ int shellRun(Shell *shell, const char *cmd)
 {
     SHELL_ASSERT(shell && cmd, return -1);
     char active = shell->status.isActive;
-    if (strlen(cmd) > shell->parser.bufferSize - 1)
+    if (!shell->parser.buffer || strlen(cmd) > shell->parser.bufferSize - 1)
     {
         shellWriteString(shell, shellText[SHELL_TEXT_CMD_TOO_LONG]);
         return -1;
@@ -1890,3 +2125,4 @@ SHELL_EXPORT_CMD(
     SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_MAIN) | SHELL_CMD_DISABLE_RETURN,
     exec, shellExecute, execute function undefined);
 #endif
+#endif /** SHELL_USING_LITE == 0 */
@@ -10,7 +10,11 @@
  */
  #include "shell.h"
  
+#if SHELL_USING_LITE == 0
 #if SHELL_USING_COMPANION == 1
+#if !defined(USING_RTTHREAD)
+#include "cmsis_os.h"
+#endif
 /**
  * @brief shell添加伴生对象
  * 
@@ -85,3 +89,4 @@ void *shellCompanionGet(Shell *shell, int id)
     return (void *)0;
 }
 #endif /** SHELL_USING_COMPANION == 1 */
+#endif /** SHELL_USING_LITE == 0 */
@@ -14,11 +14,14 @@
 #include "shell_ext.h"
 
 
+#if SHELL_USING_LITE == 0
 extern ShellCommand* shellSeekCommand(Shell *shell,
                                       const char *cmd,
                                       ShellCommand *base,
                                       unsigned short compareLength);
+#if SHELL_USING_VAR == 1
 extern int shellGetVarValue(Shell *shell, ShellCommand *command);
+#endif
 
 /**
  * @brief 判断数字进制
@@ -237,6 +240,7 @@ static unsigned int shellExtParseNumber(char *string)
 }
 
 
+#if SHELL_USING_VAR == 1
 /**
  * @brief 解析变量参数
  * 
@@ -259,6 +263,7 @@ static unsigned int shellExtParseVar(Shell *shell, char *var)
         return 0;
     }
 }
+#endif /** SHELL_USING_VAR == 1 */
 
 
 /**
@@ -278,10 +283,12 @@ unsigned int shellExtParsePara(Shell *shell, char *string)
     {
         return (unsigned int)shellExtParseNumber(string);
     }
+#if SHELL_USING_VAR == 1
     else if (*string == '$' && *(string + 1))
     {
         return shellExtParseVar(shell, string);
     }
+#endif
     else if (*string)
     {
         return (unsigned int)shellExtParseString(string);
@@ -444,4 +451,4 @@ int shellExtRun(Shell *shell, ShellCommand *command, int argc, char *argv[])
         // break;
     }
 }
-
+#endif /** SHELL_USING_LITE == 0 */
@@ -0,0 +1,346 @@
+/**
+ * @file shell_lite.c
+ * @brief 精简shell后端(SHELL_USING_LITE)
+ *        按 AT-Command-master/Demo/framework/cli.c 的结构:整行接收后按空格切分，
+ *        在命令段中顺序查找并执行，不含历史记录、补全、光标编辑、用户、变量及命令索引；
+ *        与 shell.c 共用 shell.h 的对象、接口及 SHELL_EXPORT_CMD 命令段，工程只需换用源文件
+ *
+ */
+
+#include "shell.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdarg.h"
+#include "stdlib.h"
+
+#if SHELL_USING_LITE == 1
+#if SHELL_USING_CMD_EXPORT != 1
+#error shell lite requires SHELL_USING_CMD_EXPORT
+#endif
+
+#if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && __ARMCC_VERSION >= 6000000)
+extern const unsigned int shellCommand$$Base;
+extern const unsigned int shellCommand$$Limit;
+#elif defined(__ICCARM__) || defined(__ICCRX__)
+#pragma section = "shellCommand"
+#elif defined(__GNUC__)
+extern const unsigned int _shell_command_start;
+extern const unsigned int _shell_command_end;
+#endif
+
+/*提示符*/
+#define SHELL_LITE_PROMPT "\r\n" SHELL_DEFAULT_USER ":/$ "
+
+/*精简后端只服务一个shell对象*/
+static Shell *shellLite = NULL;
+
+/**
+ * @brief shell 初始化
+ *
+ * @param shell shell对象
+ * @param buffer 命令行缓冲区
+ * @param size 缓冲区大小
+ */
+void shellInit(Shell *shell, char *buffer, unsigned short size)
+{
+#if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && __ARMCC_VERSION >= 6000000)
+    shell->commandList.base = (ShellCommand *)(&shellCommand$$Base);
+    shell->commandList.count = ((unsigned int)(&shellCommand$$Limit) - (unsigned int)(&shellCommand$$Base)) / sizeof(ShellCommand);
+#elif defined(__ICCARM__) || defined(__ICCRX__)
+    shell->commandList.base = (ShellCommand *)(__section_begin("shellCommand"));
+    shell->commandList.count = ((unsigned int)(__section_end("shellCommand")) - (unsigned int)(__section_begin("shellCommand"))) / sizeof(ShellCommand);
+#elif defined(__GNUC__)
+    shell->commandList.base = (ShellCommand *)(&_shell_command_start);
+    shell->commandList.count = ((unsigned int)(&_shell_command_end) - (unsigned int)(&_shell_command_start)) / sizeof(ShellCommand);
+#else
+#error not supported compiler
+#endif
+    shell->status.isChecked = 1;
+    shellLite = shell;
+    shellSetArena(shell, buffer, size, 0);
+    shellWriteString(shell, SHELL_LITE_PROMPT);
+}
+
+/**
+ * @brief shell 设置输入缓冲区
+ *        精简后端没有历史记录，整个缓冲区用作命令行，history 被忽略；
+ *        buffer 为NULL时shell丢弃输入
+ *
+ * @param shell shell对象
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @param history 历史记录深度(未使用)
+ */
+void shellSetArena(Shell *shell, char *buffer, unsigned short size, unsigned short history)
+{
+    (void)history;
+    shell->parser.length = 0;
+    shell->parser.cursor = 0;
+    shell->parser.buffer = buffer;
+    shell->parser.bufferSize = buffer ? size : 0;
+}
+
+/**
+ * @brief 获取当前活动shell
+ *
+ * @return Shell* 执行命令期间为初始化的shell对象，否则为NULL
+ */
+Shell *shellGetCurrent(void)
+{
+    return (shellLite && shellLite->status.isActive) ? shellLite : NULL;
+}
+
+/**
+ * @brief shell 写字符串
+ *
+ * @param shell shell对象
+ * @param string 字符串数据
+ *
+ * @return unsigned short 写入字符的数量
+ */
+unsigned short shellWriteString(Shell *shell, const char *string)
+{
+    return shell->write ? shell->write((char *)string, (unsigned short)strlen(string)) : 0;
+}
+
+#if SHELL_PRINT_BUFFER > 0
+/**
+ * @brief shell格式化输出
+ *        格式化缓冲区在调用者的栈上，不分配堆内存
+ *
+ * @param shell shell对象
+ * @param fmt 格式化字符串
+ * @param ... 参数
+ */
+void shellPrint(Shell *shell, char *fmt, ...)
+{
+    char buffer[SHELL_PRINT_BUFFER];
+    va_list vargs;
+
+    va_start(vargs, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, vargs);
+    va_end(vargs);
+    shellWriteString(shell, buffer);
+}
+#endif
+
+/**
+ * @brief 查找命令
+ *
+ * @param shell shell对象
+ * @param name 命令名
+ *
+ * @return const ShellCommand* 命令，未找到时返回NULL
+ */
+static const ShellCommand *shellLiteSeek(Shell *shell, const char *name)
+{
+    const ShellCommand *base = (const ShellCommand *)shell->commandList.base;
+
+    for (unsigned short i = 0; i < shell->commandList.count; i++)
+    {
+        if (((base[i].attr.attrs.type == SHELL_TYPE_CMD_MAIN) || (base[i].attr.attrs.type == SHELL_TYPE_CMD_FUNC)) &&
+            (strcmp(name, base[i].data.cmd.name) == 0))
+        {
+            return &base[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 解析函数型命令的参数
+ *        'c' 为字符，以数字或'-'开头的按 strtol 解析(支持0x十六进制)，其余为字符串(去掉两侧的双引号)
+ *
+ * @param string 参数字符串
+ *
+ * @return int 参数值
+ */
+static int shellLiteParam(char *string)
+{
+    unsigned short length = (unsigned short)strlen(string);
+
+    if ((string[0] == '\'') && (length == 3U) && (string[2] == '\''))
+    {
+        return string[1];
+    }
+    if ((string[0] == '-') || ((string[0] >= '0') && (string[0] <= '9')))
+    {
+        return (int)strtol(string, NULL, 0);
+    }
+    if ((string[0] == '"') && (length >= 2U) && (string[length - 1U] == '"'))
+    {
+        string[length - 1U] = '\0';
+        string++;
+    }
+    return (int)string;
+}
+
+/**
+ * @brief 执行命令行
+ *
+ * @param shell shell对象
+ */
+static void shellLiteExec(Shell *shell)
+{
+    char *argv[SHELL_PARAMETER_MAX_NUMBER];
+    int params[SHELL_PARAMETER_MAX_NUMBER] = {0};
+    int argc = 0, value;
+    char *p = shell->parser.buffer;
+    const ShellCommand *command;
+
+    shell->parser.buffer[shell->parser.length] = '\0';
+    while (*p && (argc < SHELL_PARAMETER_MAX_NUMBER))
+    {
+        while (*p == ' ')
+        {
+            *p++ = '\0';
+        }
+        if (*p)
+        {
+            argv[argc++] = p;
+        }
+        while (*p && (*p != ' '))
+        {
+            p++;
+        }
+    }
+    if (argc == 0)
+    {
+        return;
+    }
+    command = shellLiteSeek(shell, argv[0]);
+    if (command == NULL)
+    {
+        shellWriteString(shell, "Command not Found\r\n");
+        return;
+    }
+    SHELL_LOCK(shell);
+    shell->status.isActive = 1;
+    if (command->attr.attrs.type == SHELL_TYPE_CMD_MAIN)
+    {
+        value = command->data.cmd.function(argc, argv);
+    }
+    else
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            params[i - 1] = shellLiteParam(argv[i]);
+        }
+        /*多余的参数由被调函数忽略(AAPCS由调用者清理栈)*/
+        value = command->data.cmd.function(params[0], params[1], params[2], params[3],
+                                           params[4], params[5], params[6]);
+    }
+    shell->status.isActive = 0;
+    SHELL_UNLOCK(shell);
+    if (!command->attr.attrs.disableReturn)
+    {
+        shellPrint(shell, "Return: %d, 0x%08x\r\n", value, value);
+    }
+}
+typedef char shellLiteParamCheck[(SHELL_PARAMETER_MAX_NUMBER <= 8) ? 1 : -1];
+
+/**
+ * @brief shell 处理一个输入字符
+ *        普通字符回显并追加到命令行，退格删除末尾字符，回车、换行或CRLF执行，命令行满时丢弃后续字符
+ *
+ * @param shell shell对象
+ * @param data 输入数据
+ */
+void shellHandler(Shell *shell, char data)
+{
+    if (shell->parser.buffer == NULL)
+    {
+        return;
+    }
+    if ((data == '\n') && (shell->parser.keyValue == '\r'))
+    {
+        /*CRLF只执行一次*/
+        shell->parser.keyValue = data;
+        return;
+    }
+    shell->parser.keyValue = data;
+    if ((data == '\r') || (data == '\n'))
+    {
+        shellWriteString(shell, "\r\n");
+        shellLiteExec(shell);
+        shell->parser.length = 0;
+        shellWriteString(shell, SHELL_LITE_PROMPT);
+    }
+    else if ((data == '\b') || (data == 0x7F))
+    {
+        if (shell->parser.length)
+        {
+            shell->parser.length--;
+            shellWriteString(shell, "\b \b");
+        }
+    }
+    else if ((data >= ' ') && (shell->parser.length + 1U < shell->parser.bufferSize))
+    {
+        shell->parser.buffer[shell->parser.length++] = data;
+        shell->write(&data, 1);
+    }
+}
+
+/**
+ * @brief shell 任务
+ *        每次读取一批输入并逐字处理
+ *
+ * @param param 参数(shell对象)
+ */
+void shellTask(void *param)
+{
+    Shell *shell = (Shell *)param;
+    char data[16];
+    unsigned short count;
+
+    if (shell->read == NULL)
+    {
+        return;
+    }
+    count = shell->read(data, sizeof(data));
+    for (unsigned short i = 0; i < count; i++)
+    {
+        shellHandler(shell, data[i]);
+    }
+}
+
+/**
+ * @brief 执行一行命令
+ *
+ * @param shell shell对象
+ * @param cmd 命令行
+ *
+ * @return int 0 执行 -1 缓冲区不可用或命令过长
+ */
+int shellRun(Shell *shell, const char *cmd)
+{
+    unsigned short length = (unsigned short)strlen(cmd);
+
+    if ((shell->parser.buffer == NULL) || (length + 1U > shell->parser.bufferSize))
+    {
+        return -1;
+    }
+    memcpy(shell->parser.buffer, cmd, length);
+    shell->parser.length = length;
+    shellLiteExec(shell);
+    shell->parser.length = 0;
+    return 0;
+}
+
+/**
+ * @brief 列出命令
+ */
+void shellHelp(void)
+{
+    const ShellCommand *base = (const ShellCommand *)shellLite->commandList.base;
+
+    for (unsigned short i = 0; i < shellLite->commandList.count; i++)
+    {
+        if ((base[i].attr.attrs.type == SHELL_TYPE_CMD_MAIN) || (base[i].attr.attrs.type == SHELL_TYPE_CMD_FUNC))
+        {
+            shellPrint(shellLite, "%-16s%s\r\n", base[i].data.cmd.name, base[i].data.cmd.desc);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC) | SHELL_CMD_DISABLE_RETURN, help, shellHelp, show command info);
+#endif /** SHELL_USING_LITE == 1 */
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""主站调度吞吐量的硬件在环测试。
+
+主站经 shell 串口、从站模拟器(USING_SIMULATOR 固件)经其 shell 串口连接到PC。
+每一轮:按轮次设定模拟器的应答延迟及丢弃概率，清零主站计数器及直方图，运行 --duration 秒后
+读取主站的 stats / trace / l101_link 及模拟器的 sim，计算吞吐量、轮询一周的时间及超时率。
+SSPD(空中速率)/SFEC(前向纠错)在L101模块上设置，每轮开始前提示操作者按轮次名称配置模块。
+
+    hil_bench.py --master COM3 --sim COM4 --units 16 --base 1 --addr 0x0002 --channel 10 \\
+                 --run spd10:0:0:0 --run spd10_loss5:0:0:50 --run spd6:20:10:0 --json after.json
+    hil_bench.py --compare before.json after.json
+
+轮次格式 名称[:延迟ms[:抖动ms[:丢弃‰]]]。依赖 pyserial。
+"""
+import argparse
+import csv
+import json
+import re
+import sys
+import time
+
+try:
+    import serial
+except ImportError:
+    serial = None
+
+
+class Shell:
+    """letter shell 会话:发送一条命令，读到输出静止为止。"""
+
+    def __init__(self, port, baud, quiet=0.3):
+        self.port = serial.Serial(port, baud, timeout=0.05)
+        self.quiet = quiet
+
+    def cmd(self, line, wait=3.0):
+        self.port.reset_input_buffer()
+        self.port.write((line + "\r").encode("ascii"))
+        out, last, start = b"", time.time(), time.time()
+        while time.time() - start < wait:
+            data = self.port.read(256)
+            if data:
+                out, last = out + data, time.time()
+            elif out and time.time() - last > self.quiet:
+                break
+        text = out.decode("ascii", "replace").replace("\r", "")
+        # 去掉命令回显及结尾的提示符
+        lines = [l for l in text.split("\n") if l.strip() and not l.strip().endswith(line)]
+        if lines and lines[-1].rstrip().endswith("$"):
+            lines.pop()
+        return "\n".join(lines)
+
+
+STATS_TOTAL = re.compile(r"(\w+) = (\d+)")
+STATS_SLAVE = re.compile(r"\[(\d+)\] id = (\d+), tx = (\d+), rx = (\d+), timeouts = (\d+), retries = (\d+)")
+TRACE_SPAN = re.compile(r"^(\S+)\s+n = (\d+), max = (\d+)us")
+TRACE_BIN = re.compile(r"(<|>=)(\d+):(\d+)")
+
+
+def parse_stats(text):
+    """stats:总计数器及各从站的 tx/rx/timeouts/retries。"""
+    totals, slaves = {}, []
+    for line in text.split("\n"):
+        m = STATS_SLAVE.search(line)
+        if m:
+            slaves.append(dict(zip(("event", "id", "tx", "rx", "timeouts", "retries"), map(int, m.groups()))))
+        elif not line.startswith("class"):
+            totals.update((k, int(v)) for k, v in STATS_TOTAL.findall(line))
+    return totals, slaves
+
+
+def parse_trace(text):
+    """trace:各延迟段的样本数、最大值及对数直方图(上界us -> 计数)。"""
+    spans, cur = {}, None
+    for line in text.split("\n"):
+        m = TRACE_SPAN.match(line.strip())
+        if m:
+            cur = spans[m.group(1)] = {"n": int(m.group(2)), "max_us": int(m.group(3)), "bins": []}
+        elif cur is not None:
+            for op, edge, count in TRACE_BIN.findall(line):
+                # <2^k 格的上界为 2^k；>= 格取最大值
+                cur["bins"].append([int(edge) if op == "<" else cur["max_us"], int(count)])
+    return spans
+
+
+def percentile(bins, q):
+    """按直方图估计分位数(取所在格的上界)。"""
+    total = sum(c for _, c in bins)
+    acc = 0
+    for edge, count in bins:
+        acc += count
+        if total and acc >= q * total:
+            return edge
+    return 0
+
+
+def summarize(run, duration, totals, slaves, spans):
+    polled = [s for s in slaves if s["tx"]]
+    tx = sum(s["tx"] for s in polled)
+    rx = sum(s["rx"] for s in polled)
+    timeouts = sum(s["timeouts"] for s in polled)
+    row = {
+        "run": run["name"], "delay": run["delay"], "jitter": run["jitter"], "drop": run["drop"],
+        "slaves": len(polled), "duration": duration,
+        "tx_per_s": round(tx / duration, 2), "rx_per_s": round(rx / duration, 2),
+        "timeout_pct": round(100.0 * timeouts / tx, 2) if tx else 0.0,
+        # 轮询一周:最少被访问的从站两次访问之间的平均时间
+        "cycle_ms": round(1000.0 * duration / min(s["tx"] for s in polled), 1) if polled else 0.0,
+        "overrun": totals.get("overrun", 0), "drops": totals.get("drops", 0),
+    }
+    for name, span in spans.items():
+        row[name + "_p50_us"] = percentile(span["bins"], 0.5)
+        row[name + "_p90_us"] = percentile(span["bins"], 0.9)
+        row[name + "_max_us"] = span["max_us"]
+    return row
+
+
+def parse_run(spec):
+    parts = spec.split(":")
+    vals = [int(p) for p in parts[1:]] + [0, 0, 0]
+    return {"name": parts[0], "delay": vals[0], "jitter": vals[1], "drop": vals[2]}
+
+
+def bench(args):
+    if serial is None:
+        sys.exit("pyserial is required: pip install pyserial")
+    master = Shell(args.master, args.baud)
+    sim = Shell(args.sim, args.baud) if args.sim else None
+    if args.units:
+        # 主站节点表的前 N 个事件指向模拟器上的 N 个站号
+        master.cmd("l101_nodes %d" % args.units)
+        for i in range(args.units):
+            master.cmd("l101_map %d %d %d %d" % (i, int(args.addr, 0), args.channel, args.base + i))
+        if sim:
+            sim.cmd("sim_units %d %d" % (args.base, args.units))
+    results = []
+    for spec in args.run:
+        run = parse_run(spec)
+        if not args.no_prompt:
+            input("[%s] configure SSPD/SFEC on the L101 modules, then press Enter..." % run["name"])
+        if sim:
+            sim.cmd("sim_reply %d %d %d" % (run["delay"], run["jitter"], run["drop"]))
+            sim.cmd("sim_clear")
+        time.sleep(args.settle)
+        master.cmd("stats_clear")
+        master.cmd("trace_clear")
+        start = time.time()
+        time.sleep(args.duration)
+        raw = {"stats": master.cmd("stats"), "trace": master.cmd("trace"), "link": master.cmd("l101_link")}
+        duration = time.time() - start
+        if sim:
+            raw["sim"] = sim.cmd("sim")
+        totals, slaves = parse_stats(raw["stats"])
+        spans = parse_trace(raw["trace"])
+        row = summarize(run, duration, totals, slaves, spans)
+        print(json.dumps(row))
+        results.append({"summary": row, "slaves": slaves, "trace": spans, "raw": raw})
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=1)
+    if args.csv and results:
+        keys = sorted({k for r in results for k in r["summary"]})
+        with open(args.csv, "a", newline="") as f:
+            w = csv.DictWriter(f, keys)
+            if f.tell() == 0:
+                w.writeheader()
+            w.writerows(r["summary"] for r in results)
+
+
+def compare(before, after):
+    """按轮次名称对比两次测试的汇总值。"""
+    load = lambda p: {r["summary"]["run"]: r["summary"] for r in json.load(open(p))}
+    old, new = load(before), load(after)
+    for name in (n for n in new if n in old):
+        print("[%s]" % name)
+        for key, value in new[name].items():
+            prev = old[name].get(key)
+            if isinstance(value, (int, float)) and isinstance(prev, (int, float)) and key not in ("delay", "jitter", "drop"):
+                delta = "%+.1f%%" % (100.0 * (value - prev) / prev) if prev else ""
+                print("  %-16s %10s -> %-10s %s" % (key, prev, value, delta))
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("--master", help="Master shell serial port")
+    p.add_argument("--sim", help="simulator shell serial port")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--units", type=int, default=0, help="map N master events onto the simulator (<= 32)")
+    p.add_argument("--base", type=int, default=1, help="first simulated slave id")
+    p.add_argument("--addr", default="0", help="simulator L101 address")
+    p.add_argument("--channel", type=int, default=0, help="simulator L101 channel")
+    p.add_argument("--run", action="append", default=[], help="name[:delay_ms[:jitter_ms[:drop_permille]]]")
+    p.add_argument("--duration", type=float, default=60.0, help="seconds per run")
+    p.add_argument("--settle", type=float, default=3.0, help="seconds before counters are cleared")
+    p.add_argument("--no-prompt", action="store_true", help="do not stop between runs")
+    p.add_argument("--json", help="write the full results")
+    p.add_argument("--csv", help="append one summary row per run")
+    p.add_argument("--compare", nargs=2, metavar=("BEFORE", "AFTER"), help="compare two result files")
+    args = p.parse_args()
+    if args.compare:
+        compare(*args.compare)
+    elif args.master and args.run:
+        bench(args)
+    else:
+        p.error("--master and at least one --run are required")
+
+
+if __name__ == "__main__":
+    main()
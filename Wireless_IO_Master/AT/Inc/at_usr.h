@@ -12,6 +12,8 @@ extern "C" {
 
 
 extern at_obj_t at;  
+/*处理一帧模块主动上报的信息*/
+extern bool At_Urc_Process(const char *pData, uint16_t Size);
 
 #ifdef __cplusplus
 }
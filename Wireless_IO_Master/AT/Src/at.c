@@ -24,12 +24,10 @@
 #include "comdef.h"
 #include "main.h"
 #include "mdrtuslave.h"
-#if defined(USING_RTTHREAD)
-#include "rtthread.h"
-#else
-#include "cmsis_os.h"
-#endif
+#include "os_port.h"
 #include "shell_port.h"
+#include "mode.h"
+#include "L101.h"
 
 #if defined(USING_AT)
 
@@ -477,8 +475,12 @@ void at_process(at_obj_t *at)
 #define SADDR "0"
 /*L102-L 工作频段：(398+ch)MHz*/
 #define SCH "0"
-/**/
+/*前向纠错，与空中时间模型一致(L101_FEC)*/
+#if (L101_FEC)
 #define SFEC "ON"
+#else
+#define SFEC "OFF"
+#endif
 /*10~20（默认 20db）不推荐使用小功率发送，其电源利用效率不高*/
 #define SPWR "20"
 /*time： 0~15000ms（默认 500）仅在 LR/LSR 模式下有效，表示进入接收状态所持续的最长时间，当速率等级较慢的时候应适
@@ -495,15 +497,10 @@ Data：123456（默认 123456）。
 Style：ascii、hex（默认 ascii）。*/
 #define SPDATE "123456,hex"
 /*设置/查询发送完成回复标志,sta：1 为打开，0 为关闭。*/
-#define SSENDOK "0"
+#define SSENDOK "1"
 
 extern UART_HandleTypeDef huart1;
 
-extern osThreadId shellHandle;
-extern osThreadId mdbusHandle;
-extern osTimerId Timer1Handle;
-extern osSemaphoreId ReciveHandle;
-
 /*定义一个标志，在配置模式下，操作系统相关任务不执行*/
 // bool g_Modbus_ExeFlag = false;
 
@@ -548,11 +545,60 @@ typedef enum
 typedef struct
 {
     At_InfoList Name;
-    char *pSend;
-    char *pRecv;
+    const char *pSend;
+    const char *pRecv;
     void (*event)(char *data);
 } At_HandleTypeDef __attribute__((aligned(4)));
 
+/*运行时设置参数时单条AT指令的最大长度*/
+#define AT_APPLY_CMD_SIZE 20U
+/*后台AT作业队列深度及单个作业可替换参数的指令数*/
+#define AT_JOB_QUEUE 3U
+#define AT_JOB_PARAMS 2U
+/*后台AT作业标签:同一标签尚未执行的作业以最新的为准*/
+#define AT_JOB_SPEED 0x01U
+#define AT_JOB_POWER 0x02U
+#define AT_JOB_CONFIG 0x03U
+
+/*作业中代替指令表默认参数的一条指令(不含结束符)*/
+typedef struct
+{
+    uint8_t Step;
+    char Text[AT_APPLY_CMD_SIZE];
+} At_ParamTypeDef;
+
+/*后台AT作业:按序执行的指令及完成回调；Diff 为真时先查询模块当前值，只写入不同的参数*/
+typedef struct
+{
+    const At_InfoList *pList;
+    uint8_t Count;
+    uint8_t Tag;
+    bool Diff;
+    At_ParamTypeDef Param[AT_JOB_PARAMS];
+    void (*Done)(bool ok, void *arg);
+    void *Arg;
+} At_JobTypeDef;
+
+typedef struct
+{
+    At_JobTypeDef Queue[AT_JOB_QUEUE];
+    uint8_t Head;
+    uint8_t Count;
+    /*队首作业正在执行*/
+    bool Running;
+    uint8_t Step;
+    /*当前指令处于查询阶段*/
+    bool Query;
+    /*本作业已写入过参数，须保存并重启模块*/
+    bool Changed;
+    /*当前指令、期待应答及发送时刻*/
+    const At_HandleTypeDef *pCmd;
+    const char *pRecv;
+    uint32_t Timer;
+    /*查询阶段期待的应答，如"+SPD:10\r\n"*/
+    char Expect[AT_APPLY_CMD_SIZE + sizeof(AT_CMD_END_MARK_CRLF)];
+} At_EngineTypeDef;
+
 // typedef struct
 // {
 //     char *pRecv;
@@ -561,7 +607,8 @@ typedef struct
 
 // static uint16_t g_ATWait_Times = AT_WAITTIMES;
 
-At_HandleTypeDef At_Table[] = {
+/*指令表只读，存放于flash*/
+static const At_HandleTypeDef At_Table[] = {
     {.Name = CMD_MODE, .pSend = "+++", "a", NULL},
     {.Name = CMD_SURE, .pSend = "a", AT_CMD_OK, NULL},
     {.Name = EXIT_CMD, .pSend = "AT+ENTM", NULL, NULL},                                  /*退出命令模式，恢复原工作模式*/
@@ -589,7 +636,7 @@ At_HandleTypeDef At_Table[] = {
 };
 #define AT_TABLE_SIZE (sizeof(At_Table) / sizeof(At_HandleTypeDef))
 
-static const char *atText[] = {
+static const char *const atText[] = {
     [CONF_MODE] = "Note: Enter configuration!\r\n",
     [FREE_MODE] = "Note: Enter free mode!\r\n",
     [UNKOWN_MODE] = "Error: Unknown mode!\r\n",
@@ -630,56 +677,86 @@ static const char *atText[] = {
 #define SET_HAL_TICK(__value) (uwTick = __value)
 
 /**
- * @brief       等待接收到指定串
- * @param[in]   resp    - 期待待接收串(如"OK",">")
- * @param[in]   timeout - 等待超时时间
+ * @brief       在一帧应答中查找期待串及错误串
+ * @details     按帧长度单遍扫描，只在首字符相同的位置比较，两个串共用一次遍历；
+ *              不依赖结束符，帧中含'\0'(如模式切换时的杂散字节)时不会提前结束；
+ *              与逐个strstr一致，期待串优先于错误串
+ * @param[in]   pBuf    - 应答帧
+ * @param[in]   len     - 帧长度
+ * @param[in]   resp    - 期待串
+ * @retval      CONF_SUCCESS/CONF_ERROR，均未出现时为 CONF_TOMEOUT
  */
-At_InfoList Wait_Recv(Shell *const shell, const ReceiveBufferHandle pB, const char *resp, uint16_t timeout)
+static At_InfoList At_Match(const uint8_t *pBuf, uint32_t len, const char *resp)
 {
+    const uint32_t rlen = strlen(resp), elen = sizeof(AT_CMD_ERROR) - 1U;
     At_InfoList ret = CONF_TOMEOUT;
-//    SET_HAL_TICK(0U);
-    uint32_t timer = HAL_GetTick();
 
-    // ret = CONF_SUCCESS;
-#if defined(USING_DEBUG)
-    // shellPrint(shell, ">wait:%s\r\n", resp);
-#endif
-    // while (HAL_GetTick() - timer < timeout)
-    // {
-    //     osDelay(1);
-    // };
+    if (rlen == 0U)
+    {
+        return CONF_SUCCESS;
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((pBuf[i] == (uint8_t)resp[0]) && (len - i >= rlen) && !memcmp(&pBuf[i], resp, rlen))
+        {
+            return CONF_SUCCESS;
+        }
+        if ((pBuf[i] == (uint8_t)AT_CMD_ERROR[0]) && (len - i >= elen) && !memcmp(&pBuf[i], AT_CMD_ERROR, elen))
+        {
+            ret = CONF_ERROR;
+        }
+    }
 
-#if defined(USING_DEBUG)
-    // shellPrint(shell, "error:%d\r\n", __HAL_UART_GET_FLAG(&huart1, UART_FLAG_ORE));
-#endif
+    return ret;
+}
 
-    /*DMA receive interrupt is managed by the operating system*/
-    // portENABLE_INTERRUPTS();
-    while (!pB->count)
+/**
+ * @brief       取一帧应答并与指定串比较
+ * @details     不阻塞，尚未收到应答时返回false；比较后清除接收缓冲区
+ * @param[in]   resp    - 期待待接收串(如"OK",">")
+ * @param[out]  pResult - 比较结果
+ * @retval      true 已收到一帧应答
+ */
+static bool At_Fetch(Shell *const shell, const ReceiveBufferHandle pB, const char *resp, At_InfoList *pResult)
+{
+    if (!mdReceiveBufferFetch(pB))
     {
-
-        // if (HAL_GetTick() - timer > timeout)
-        if (GET_TIMEOUT_FLAG(timer, HAL_GetTick(), timeout, HAL_MAX_DELAY))
-            break;
-        osDelay(1);
+        return false;
     }
-    // portDISABLE_INTERRUPTS();
-#if defined(USING_DEBUG)
-    // shellPrint(shell, "pB->count:%d\r\n", pB->count);
-    // shellPrint(shell, "pB:%p\r\n", pB);
-    // shellPrint(shell, "tick = :%d\r\n", HAL_GetTick());
-#endif
+    *pResult = CONF_TOMEOUT;
     if (pB->count)
     {
-        pB->buf[pB->count] = '\0';
-        ret = strstr((const char *)&(pB->buf), resp) ? CONF_SUCCESS : (strstr((const char *)&(pB->buf), AT_CMD_ERROR) ? CONF_ERROR : CONF_TOMEOUT);
+        *pResult = At_Match(pB->buf, pB->count, resp);
 #if defined(USING_DEBUG)
-        // shellPrint(shell, ">[MCU<-L101]:%s, timer = %d\r\n", pB->buf, timer);
-        shellPrint(shell, ">[MCU<-L101]:%s\r\n", pB->buf);
+        shellPrint(shell, ">[MCU<-L101]:%.*s\r\n", (int)pB->count, pB->buf);
 #endif
     }
     mdClearReceiveBuffer(pB);
 
+    return true;
+}
+
+/**
+ * @brief       等待接收到指定串
+ * @param[in]   resp    - 期待待接收串(如"OK",">")
+ * @param[in]   timeout - 等待超时时间
+ */
+At_InfoList Wait_Recv(Shell *const shell, const ReceiveBufferHandle pB, const char *resp, uint16_t timeout)
+{
+    At_InfoList ret = CONF_TOMEOUT;
+    uint32_t timer = HAL_GetTick();
+
+    /*DMA receive interrupt is managed by the operating system*/
+    while (!At_Fetch(shell, pB, resp, &ret))
+    {
+        if (GET_TIMEOUT_FLAG(timer, HAL_GetTick(), timeout, HAL_MAX_DELAY))
+        {
+            mdClearReceiveBuffer(pB);
+            break;
+        }
+        Os_Delay(1);
+    }
+
     return ret;
 }
 
@@ -689,7 +766,7 @@ At_InfoList Wait_Recv(Shell *const shell, const ReceiveBufferHandle pB, const ch
  * @param  data  接收的数据
  * @retval None
  */
-At_HandleTypeDef *Get_AtCmd(At_HandleTypeDef *pAt, At_InfoList list, uint16_t size)
+const At_HandleTypeDef *Get_AtCmd(const At_HandleTypeDef *pAt, At_InfoList list, uint16_t size)
 {
     for (uint16_t i = 0; i < size; i++)
     {
@@ -722,9 +799,10 @@ void Free_Mode(Shell *shell, char *pData)
     char pBuf[64U] = {0};
 #endif
     ModbusRTUSlaveHandler pH = Master_Object;
-    At_HandleTypeDef *pAt = At_Table, *pS = NULL;
+    const At_HandleTypeDef *pAt = At_Table, *pS = NULL;
     At_InfoList result = CONF_SUCCESS;
-    char *pRe = NULL, *pDest = NULL;
+    const char *pRe = NULL;
+    char *pDest = NULL;
     uint16_t len = 0;
 
     //     while ((*pData) != ESC_CODE)
@@ -844,8 +922,8 @@ __exit:
 static void Config_Mode(Shell *shell, char *pData)
 {
     ModbusRTUSlaveHandler pH = Master_Object;
-    At_HandleTypeDef *pAt = At_Table, *pS = NULL;
-    char *pRe = NULL;
+    const At_HandleTypeDef *pAt = At_Table, *pS = NULL;
+    const char *pRe = NULL;
     At_InfoList result = CONF_SUCCESS;
     bool at_mutex = false;
 
@@ -913,6 +991,345 @@ static void Config_Mode(Shell *shell, char *pData)
     }
 }
 
+/**
+ * @brief  取得指令的期待应答
+ * @details 进入命令模式及设置回显时比较指令表中的应答，其余指令比较"OK"
+ * @param  pS 指令
+ * @retval 期待应答
+ */
+static const char *At_Expect(const At_HandleTypeDef *pS)
+{
+    return ((pS->Name == CMD_MODE) || (pS->Name == SET_ECHO)) ? pS->pRecv : AT_CMD_OK;
+}
+
+static At_EngineTypeDef At_Engine;
+
+/**
+ * @brief  提交一个后台AT作业
+ * @details 同一标签的作业尚未开始执行时以新作业代替，否则排入队尾；
+ *          作业由At任务的At_Poll()逐条推进，完成后在At任务中回调 Done
+ * @param  pJob 作业(指令序列须为静态常量)
+ * @retval true 已排队 false 队列已满
+ */
+bool At_Submit(const At_JobTypeDef *pJob)
+{
+    At_EngineTypeDef *pE = &At_Engine;
+    At_JobTypeDef *pSlot = NULL;
+    bool ret = false;
+
+    if ((pJob == NULL) || (pJob->pList == NULL) || (pJob->Count == 0U))
+    {
+        return false;
+    }
+    Os_Critical_Enter();
+    /*队首作业正在执行时不可替换*/
+    for (uint8_t i = pE->Running ? 1U : 0U; i < pE->Count; i++)
+    {
+        if (pE->Queue[(pE->Head + i) % AT_JOB_QUEUE].Tag == pJob->Tag)
+        {
+            pSlot = &pE->Queue[(pE->Head + i) % AT_JOB_QUEUE];
+            break;
+        }
+    }
+    if ((pSlot == NULL) && (pE->Count < AT_JOB_QUEUE))
+    {
+        pSlot = &pE->Queue[(pE->Head + pE->Count++) % AT_JOB_QUEUE];
+    }
+    if (pSlot)
+    {
+        *pSlot = *pJob;
+        ret = true;
+    }
+    Os_Critical_Exit();
+    if (ret)
+    {
+        Mode_Request(MODE_SIGNAL_JOB);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  判断指令是否为可查询的参数设置指令
+ * @details 形如"AT+SPD=10"、应答形如"+SPD:10"的指令可先以"AT+SPD"查询当前值
+ * @param  pS 指令
+ * @retval true 可查询
+ */
+static bool At_Setter(const At_HandleTypeDef *pS)
+{
+    return (pS->Name > SET_ECHO) && pS->pSend && strchr(pS->pSend, '=') && pS->pRecv && (pS->pRecv[0] == '+');
+}
+
+/**
+ * @brief  发送当前作业的一条指令
+ * @details 查询阶段只发送指令中'='之前的部分，并由参数生成期待的查询应答
+ * @param  pE 作业引擎
+ * @param  pS 指令
+ * @param  query 是否为查询阶段
+ * @retval None
+ */
+static void At_Send(At_EngineTypeDef *pE, const At_HandleTypeDef *pS, bool query)
+{
+    ModbusRTUSlaveHandler pH = Master_Object;
+    const At_JobTypeDef *pJob = &pE->Queue[pE->Head];
+    const char *pText = pS->pSend, *pValue = NULL;
+    char cmd[AT_APPLY_CMD_SIZE + sizeof(AT_CMD_END_MARK_CRLF)];
+
+    for (uint8_t i = 0; i < AT_JOB_PARAMS; i++)
+    {
+        if (pJob->Param[i].Text[0] && (pJob->Param[i].Step == pE->Step) && (pS->Name == pJob->pList[pE->Step]))
+        {
+            pText = pJob->Param[i].Text;
+        }
+    }
+    pValue = strchr(pText, '=');
+    if (query && pValue)
+    {
+        snprintf(cmd, sizeof(cmd), "%.*s" AT_CMD_END_MARK_CRLF, (int)(pValue - pText), pText);
+        /*"AT+SPD=10"的查询应答为"+SPD:10"*/
+        snprintf(pE->Expect, sizeof(pE->Expect), "%.*s:%s" AT_CMD_END_MARK_CRLF, (int)(pValue - pText - 2),
+                 pText + 2, pValue + 1);
+        pE->pRecv = pE->Expect;
+    }
+    else
+    {
+        snprintf(cmd, sizeof(cmd), (pS->Name > CMD_SURE) ? "%s" AT_CMD_END_MARK_CRLF : "%s", pText);
+        pE->pRecv = At_Expect(pS);
+        pE->Changed |= At_Setter(pS);
+        query = false;
+    }
+    pE->Query = query;
+    pE->pCmd = pS;
+    pE->Timer = HAL_GetTick();
+    pH->mdRTUSendString(pH, (mdU8 *)cmd, strlen(cmd));
+}
+
+/**
+ * @brief  从当前步开始发出下一条须执行的指令
+ * @details 比较模式下参数均未改变时不保存出厂配置，并以退出命令模式代替重启
+ * @param  pE 作业引擎
+ * @param  pResult 指令不存在时置为 NO_CMD
+ * @retval true 已发出 false 作业已结束
+ */
+static bool At_Issue(At_EngineTypeDef *pE, At_InfoList *pResult)
+{
+    const At_JobTypeDef *pJob = &pE->Queue[pE->Head];
+    const At_HandleTypeDef *pS = NULL;
+
+    for (; pE->Step < pJob->Count; pE->Step++)
+    {
+        pS = Get_AtCmd(At_Table, pJob->pList[pE->Step], AT_TABLE_SIZE);
+        if (pS == NULL)
+        {
+            *pResult = NO_CMD;
+            return false;
+        }
+        if (pJob->Diff && !pE->Changed)
+        {
+            if (pS->Name == RECOVERY)
+            {
+                continue;
+            }
+            pS = (pS->Name == RESTART) ? Get_AtCmd(At_Table, EXIT_CMD, AT_TABLE_SIZE) : pS;
+        }
+        At_Send(pE, pS, pJob->Diff && At_Setter(pS));
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief  结束队首作业
+ * @details 退出配置模式后出队并回调
+ * @param  pE 作业引擎
+ * @param  result 执行结果
+ * @retval None
+ */
+static void At_Finish(At_EngineTypeDef *pE, At_InfoList result)
+{
+    At_JobTypeDef job = pE->Queue[pE->Head];
+
+    shellWriteString(Shell_Object, atText[result]);
+    Mode_Leave();
+    Os_Critical_Enter();
+    pE->Running = false;
+    pE->Head = (pE->Head + 1U) % AT_JOB_QUEUE;
+    pE->Count--;
+    Os_Critical_Exit();
+    if (job.Done)
+    {
+        job.Done(result == CONF_SUCCESS, job.Arg);
+    }
+}
+
+/**
+ * @brief  推进后台AT作业
+ * @details 由At任务周期调用，从不阻塞等待应答：作业开始时进入配置模式，
+ *          每次只检查一次应答或超时，作业结束后立即退出配置模式
+ * @param  None
+ * @retval true 仍有作业待推进 false 队列已空
+ */
+bool At_Poll(void)
+{
+    At_EngineTypeDef *pE = &At_Engine;
+    ModbusRTUSlaveHandler pH = Master_Object;
+    At_InfoList result = CONF_SUCCESS;
+
+    if (!pE->Running)
+    {
+        if (pE->Count == 0U)
+        {
+            return false;
+        }
+        /*模块处于命令模式期间不处理Modbus数据，Modbus及无线调度任务停放*/
+        if (!Mode_Enter(MODE_CONFIG))
+        {
+            return true;
+        }
+        pE->Running = true;
+        pE->Step = 0;
+        pE->Changed = false;
+        mdClearReceiveBuffer(pH->receiveBuffer);
+        if (!At_Issue(pE, &result))
+        {
+            At_Finish(pE, result);
+        }
+        return (pE->Count != 0U);
+    }
+    if (!At_Fetch(Shell_Object, pH->receiveBuffer, pE->pRecv, &result))
+    {
+        if (!GET_TIMEOUT_FLAG(pE->Timer, HAL_GetTick(), MAX_URC_RECV_TIMEOUT, HAL_MAX_DELAY))
+        {
+            return true;
+        }
+        mdClearReceiveBuffer(pH->receiveBuffer);
+        result = CONF_TOMEOUT;
+    }
+    /*查询值与期望不同或模块不支持查询时写入参数，相同时跳过*/
+    if (pE->Query && (result != CONF_SUCCESS))
+    {
+        At_Send(pE, pE->pCmd, false);
+        return true;
+    }
+    if (result == CONF_SUCCESS)
+    {
+        pE->Step++;
+        if (At_Issue(pE, &result))
+        {
+            return true;
+        }
+    }
+    At_Finish(pE, result);
+
+    return (pE->Count != 0U);
+}
+
+/**
+ * @brief  速率等级作业完成
+ * @param  ok 是否写入成功
+ * @param  arg 目标速率等级
+ * @retval None
+ */
+static void At_Speed_Done(bool ok, void *arg)
+{
+    /*设置失败时保持原速率，等待下一统计窗口*/
+    L101_Link_Applied(ok ? (uint8_t)(uintptr_t)arg : L101_Link_Speed());
+}
+
+/**
+ * @brief  设置L101模块速率等级
+ * @details 由链路管理调用，作业在后台执行，完成后通知链路管理
+ * @note   全网模块需工作在相同速率下，从站须同步修改
+ * @param  level 速率等级(1~10)
+ * @retval true 已排队 false 参数错误或队列已满
+ */
+bool At_Set_Speed(uint8_t level)
+{
+    static const At_InfoList list[] = {CMD_MODE, CMD_SURE, SET_ECHO, SPEED_GRADE, RESTART};
+    At_JobTypeDef job = {.pList = list, .Count = ARRAY_COUNT(list), .Tag = AT_JOB_SPEED,
+                         .Done = At_Speed_Done, .Arg = (void *)(uintptr_t)level};
+
+    if ((level < 1U) || (level > 10U))
+    {
+        return false;
+    }
+    job.Param[0].Step = 3U;
+    snprintf(job.Param[0].Text, sizeof(job.Param[0].Text), "AT+SPD=%d", level);
+
+    return At_Submit(&job);
+}
+
+/**
+ * @brief  功耗模式作业完成
+ * @param  ok 是否写入成功
+ * @param  arg 未使用
+ * @retval None
+ */
+static void At_Power_Done(bool ok, void *arg)
+{
+    (void)arg;
+    L101_Power_Applied(ok);
+}
+
+/**
+ * @brief  设置L101模块功耗模式
+ * @details 占空比网络中主站模块工作在WU模式，每帧前发送与从站唤醒间隔等长的唤醒码，
+ *          保证落在LR模式从站的侦听窗口内；常收网络恢复RUN模式
+ * @note   从站模块须配置为LR模式及相同的唤醒间隔
+ * @param  duty true 占空比网络 false 常收网络
+ * @param  wtm 唤醒间隔(ms)
+ * @retval true 已排队 false 队列已满
+ */
+bool At_Set_Power(bool duty, uint16_t wtm)
+{
+    static const At_InfoList list[] = {CMD_MODE, CMD_SURE, SET_ECHO, POWER_MODE, SET_TWAKEUP, RESTART};
+    At_JobTypeDef job = {.pList = list, .Count = ARRAY_COUNT(list), .Tag = AT_JOB_POWER, .Diff = true,
+                         .Done = At_Power_Done, .Arg = NULL};
+
+    job.Param[0].Step = 3U;
+    snprintf(job.Param[0].Text, sizeof(job.Param[0].Text), "AT+PMODE=%s", duty ? "WU" : "RUN");
+    job.Param[1].Step = 4U;
+    snprintf(job.Param[1].Text, sizeof(job.Param[1].Text), "AT+WTM=%d", wtm);
+
+    return At_Submit(&job);
+}
+
+/**
+ * @brief  全部参数作业完成
+ * @param  ok 是否写入成功
+ * @param  arg 未使用
+ * @retval None
+ */
+static void At_Configure_Done(bool ok, void *arg)
+{
+    (void)arg;
+    shellPrint(Shell_Object, "at_conf: %s\r\n", ok ? "done" : "failed");
+}
+
+/**
+ * @brief  在后台按指令表写入L101模块的全部默认参数
+ * @details 与参数配置模式的指令序列一致，执行期间本机I/O照常运行；
+ *          先查询模块当前值，只写入与指令表不同的参数，有改动时另存为出厂配置并重启，
+ *          均相同时直接退出命令模式
+ * @param  None
+ * @retval None
+ */
+void At_Configure(void)
+{
+    static const At_InfoList list[] = {CMD_MODE, CMD_SURE, SET_ECHO, SET_UART, WORK_MODE, POWER_MODE,
+                                       SET_TIDLE, SET_TWAKEUP, SPEED_GRADE, TARGET_ADDR, CHANNEL,
+                                       CHECK_ERROR, TRANS_POWER, SET_OUTTIME, FINISH_FLAG, RECOVERY, RESTART};
+    const At_JobTypeDef job = {.pList = list, .Count = ARRAY_COUNT(list), .Tag = AT_JOB_CONFIG, .Diff = true,
+                               .Done = At_Configure_Done, .Arg = NULL};
+
+    if (!At_Submit(&job))
+    {
+        shellWriteString(Shell_Object, "at_conf: queue full\r\n");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), at_conf, At_Configure, write default l101 config);
+
 /**
  * @brief  通过AT指令配置L101模块参数
  * @param  cmd 命令模式 1参数配置 2自由指令
@@ -928,29 +1345,14 @@ void At_Handle(uint8_t cmd)
         shellWriteString(sh, atText[UNKOWN_MODE]);
         return;
     }
-    //    __set_PRIMASK(1); /* 禁止全局中断*/
-    /*挂起mdbusHandle任务*/
-    // osThreadSuspend(mdbusHandle);
-    osThreadSuspendAll();
-    /*停止发送定时器*/
-    osTimerStop(Timer1Handle);
-    //    __set_PRIMASK(0); /*  使能全局中断 */
-    // __HAL_UART_DISABLE_IT(&huart1, UART_IT_IDLE);
-    // HAL_NVIC_DisableIRQ(USART1_IRQn);
+    /*只停放与AT配置冲突的任务，本机I/O照常运行*/
+    if (!Mode_Enter(MODE_CONFIG))
+    {
+        return;
+    }
     shellWriteString(sh, atText[cmd]);
     cmd ? Free_Mode(sh, &recive_data) : Config_Mode(sh, &recive_data);
-    /*打开发送定时器*/
-    osTimerStart(Timer1Handle, MDTASK_SENDTIMES);
-    /*恢复mdbusHandle任务*/
-    // osThreadResume(mdbusHandle);
-#if defined(USING_DEBUG)
-    // shellPrint(sh, "portNVIC_INT_CTRL_REG = 0x%x\r\n", portNVIC_INT_CTRL_REG);
-#endif
-    // __set_PRIMASK(1); /* 禁止全局中断*/
-    osThreadResumeAll();
-    // __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
-    // HAL_NVIC_EnableIRQ(USART1_IRQn);
-    // __set_PRIMASK(0); /*  使能全局中断 */
+    Mode_Leave();
 }
 #if defined(USING_DEBUG)
 SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), at, At_Handle, config);
@@ -22,4 +22,45 @@ const at_adapter_t adap = {
 	// .write       = uart_write,
 	// .read        = uart_read
 	0};
+#else
+#include "L101.h"
+#include <string.h>
+
+/*定义URC表:模块在透传模式下主动上报的信息*/
+static const urc_item_t utc_tbl[] = {
+	{"+CSQ:", AT_CMD_END_MARK_CRLF, L101_Urc_Rssi},
+	{"SEND OK", AT_CMD_END_MARK_CRLF, L101_Urc_Send_Ok}};
+
+/**
+ * @brief	处理一帧模块主动上报的信息
+ * @details	透传模式下URC与Modbus帧共用串口，每个空闲帧最多含一条URC；
+ *          忽略帧首的回车换行，前缀匹配后把其余内容交给处理程序
+ * @param	pData 接收到的帧
+ * @param	Size 帧长度
+ * @retval	true 已作为URC处理
+ */
+bool At_Urc_Process(const char *pData, uint16_t Size)
+{
+	char buf[URC_SIZE];
+	at_urc_ctx_t ctx = {.read = NULL, .buf = buf, .bufsize = sizeof(buf)};
+
+	for (; Size && ((*pData == '\r') || (*pData == '\n')); pData++, Size--)
+	{
+	}
+	for (uint16_t i = 0; i < sizeof(utc_tbl) / sizeof(urc_item_t); i++)
+	{
+		uint16_t len = strlen(utc_tbl[i].prefix);
+
+		if ((Size >= len) && (strncmp(pData, utc_tbl[i].prefix, len) == 0))
+		{
+			ctx.recvlen = (Size - len < sizeof(buf)) ? Size - len : sizeof(buf) - 1U;
+			memcpy(buf, pData + len, ctx.recvlen);
+			buf[ctx.recvlen] = '\0';
+			utc_tbl[i].handler(&ctx);
+			return true;
+		}
+	}
+
+	return false;
+}
 #endif
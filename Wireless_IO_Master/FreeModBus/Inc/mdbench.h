@@ -0,0 +1,32 @@
+#ifndef __MDBENCH_H__
+#define __MDBENCH_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+#include "mdregpool.h"
+
+#if (MODBUS_MICRO_BENCH)
+/*每个工作负载的调用次数、基准项数上限*/
+#define MDBENCH_CALLS 256U
+#define MDBENCH_CASES 16U
+/*默认轮数*/
+#define MDBENCH_ROUNDS 16U
+
+/*一项基准结果:calls 次调用的总耗时及最快一轮(MDBENCH_CALLS 次调用)的耗时，单位为时钟单位*/
+struct mdBenchResult
+{
+    const char *name;
+    const char *workload;
+    mdU32 calls;
+    mdU32 total;
+    mdU32 best;
+};
+
+/*时钟:目标板为DWT周期计数，主机为纳秒数，允许回绕*/
+typedef mdU32 (*mdBenchClock)(mdVOID);
+
+mdAPI mdU32 mdBenchRun(RegisterPoolHandle pool, mdBenchClock now, mdU32 rounds, struct mdBenchResult *results, mdU32 size);
+mdAPI mdVOID mdBenchReport(const struct mdBenchResult *results, mdU32 count, const char *unit);
+#endif
+
+#endif
@@ -7,23 +7,86 @@
 /*不严格遵从成帧机制，保留所有帧内字符间隔大于1.5个字符时间的帧*/
 #define IGNORE_LOSS_FRAME           (0)
 /*帧尾的CRC检查*/
-#define CRC_CHECK                   (0) 
+#define CRC_CHECK                   (1) 
 /*ModBus数据帧位数:1bit start + 8bit data + 1bit stop*/
 #define DATA_BITS                   (10)
+/*使用硬件定时器比较检测t1.5/t3.5帧间隔成帧(0:仅依赖串口空闲中断成帧)*/
+#define RTU_TIMER_FRAMING           (0)
+/*寄存器池及CRC微基准(mdbench.c)，目标板上导出 mdbench 命令并以DWT周期计数；主机仿真构建中始终开启*/
+#ifndef MODBUS_MICRO_BENCH
+#define MODBUS_MICRO_BENCH          (0)
+#endif
+
 
+/*协议栈角色:主站映像另外编译主站请求引擎(mdrtumaster.c)，公共部分(Common/FreeModBus)按此裁剪*/
+#define MODBUS_ROLE_MASTER          (1)
+/*本机从机协议栈的站号*/
+#define SLAVE_ID                    (0x00)
+/*本机从机协议栈默认绑定的串口DMA驱动句柄(usart.c)，其他实例经 ModbusRTUSlaveRegisterInfo.port 绑定各自的串口*/
+#define MODBUS_UART_DMA             Uart1_Dma
+/*接收通知唤醒的Modbus任务句柄(freertos.c)*/
+#define MODBUS_TASK_HANDLE          mdbusHandle
+/*固定块内存池:从机协议栈、寄存器池、接收缓冲及主站请求引擎各一个池，每个池的块数(链接时分配)*/
+#define MODBUS_POOL_BLOCKS          (1)
+/*一个从机协议栈上的逻辑单元数，主站的从机协议栈只有主单元*/
+#define MODBUS_UNITS                (1)
 
 #define MODBUS_PDU_SIZE_MIN         (4)
 #define MODBUS_PDU_SIZE_MAX         (253)
+/*接收帧环的帧数(>=2)，保证处理一帧时后续帧不被覆盖*/
+#define RECEIVE_BUFFER_FRAMES       (3)
+/*异步发送队列的帧数(>=2)*/
+#define TRANSMIT_QUEUE_FRAMES       (2)
+/*每个从机可注册的自定义功能码个数*/
+#define MODBUS_CUSTOM_CODES         (2)
+/*可登记的文件记录(20/21功能码)文件数，各从机实例共用一张文件表*/
+#define MODBUS_FILES                (8)
+/*每个寄存器池可订阅的寄存器变化回调个数*/
+#define MODBUS_REGISTER_WATCHES     (4)
+/*每个寄存器池可登记的32位数据字顺序区段个数(高位字在前的区段)*/
+#define MODBUS_WORD_RANGES          (4)
+/*主站请求队列深度*/
+#define MASTER_REQUEST_QUEUE_SIZE   (8)
+/*主站同时等待应答的最大请求数(目标从站互不相同)*/
+#define MASTER_MAX_PIPELINE         (2)
+/*高类别请求可连续越过更早提交的低类别请求的次数，之后最早的请求先发出(低类别请求不会饿死)*/
+#define MASTER_CLASS_BYPASS         (8)
+/*请求队列为控制及报警类请求保留的空闲项数，有此类请求排队或在途时诊断及遥测类请求不占用*/
+#define MASTER_CLASS_RESERVE        (2)
+/*主站请求引擎的传输端口数(端口0为共用的从机协议栈，其余如第二个L101模块)，流水线深度按端口计算*/
+#define MASTER_PORTS                (2)
+/*请求的传输层前缀最大长度(如L101目标节点地址+信道)*/
+#define MASTER_PREFIX_SIZE          (3)
+/*自定义功能码请求的最大数据长度*/
+#define MASTER_DATA_SIZE            (24)
+/*线圈控制帧(05/15功能码)的模板数，按从站号直接映射(2的幂，0:不使用)；帧头的CRC预先算好，组帧时只补写线圈数据*/
+#define MASTER_FRAME_TEMPLATES      (8)
+/*帧认证(mdauth.c):请求及应答在CRC之前附带序号低字节及24位MAC，运行中由句柄的 auth 指针开关*/
+#define MODBUS_AUTH                 (1)
+/*应用层前向纠错(mdfec.c):整帧RS编码并按字节交织，纠正突发干扰损坏的少量字节而不必重传；
+主站按链路选择纠错等级，从站以请求的等级应答*/
+#define MODBUS_FEC                  (1)
+/*主站为每个从站号维护的认证序号表项数*/
+#define MASTER_AUTH_PEERS           (32)
 
 #define REGISTER_WIDTH              (16)
+/*线圈单个位的读改写经Cortex-M3 SRAM位带别名区完成(单条存储指令，中断中可直接调用)，
+寄存器池须位于SRAM位带区(0x20000000~0x200FFFFF)；主机仿真构建中关闭*/
+#ifndef MODBUS_BIT_BAND
+#define MODBUS_BIT_BAND             (1)
+#endif
 
 #define COIL_OFFSET                         (1)
 #define INPUT_COIL_OFFSET                   (10001)
 #define INPUT_REGISTER_OFFSET               (30001)
 #define HOLD_REGISTER_OFFSET                (40001)
-/*每个寄存器组最大寄存器个数(占用4*REGISTER_POOL_MAX_BUFFER <REGISTER_POOL_MAX_REGISTER_NUMBER)*/
+/*每个寄存器组默认寄存器个数(每个寄存器占用2字节，编译期静态分配)*/
 #define REGISTER_POOL_MAX_BUFFER            (32)
-
-#define REGISTER_POOL_MAX_REGISTER_NUMBER   (256)
+/*线圈、输入状态、输入寄存器、保持寄存器各组的寄存器个数*/
+#define COIL_POOL_SIZE                      REGISTER_POOL_MAX_BUFFER
+#define INPUT_COIL_POOL_SIZE                REGISTER_POOL_MAX_BUFFER
+/*输入寄存器另含运行统计区(monitor.h)、协议统计区(stats.h)及远端模拟量(L101.h)*/
+#define INPUT_REGISTER_POOL_SIZE            (128)
+#define HOLD_REGISTER_POOL_SIZE             REGISTER_POOL_MAX_BUFFER
 
 #endif
@@ -1,8 +0,0 @@
-#ifndef __MDCRC16_H__
-#define __MDCRC16_H__
-
-#include "mdtype.h"
-
-mdExport mdU16 mdCrc16( mdU8 * pucFrame, mdU32 usLen );
-
-#endif
@@ -0,0 +1,243 @@
+#ifndef __MDRTUMASTER_H__
+#define __MDRTUMASTER_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+#include "mdrtuslave.h"
+#if (MODBUS_AUTH)
+#include "mdauth.h"
+#endif
+#if (MODBUS_FEC)
+#include "mdfec.h"
+#endif
+
+#if (USER_MODBUS_LIB)
+/*请求完成结果*/
+#define MASTER_RESULT_OK 0
+/*异常应答、长度或CRC错误*/
+#define MASTER_RESULT_ERROR 1
+/*应答超时*/
+#define MASTER_RESULT_TIMEOUT 2
+/*mdRTUMasterDeadline:没有等待应答的请求*/
+#define MASTER_NO_DEADLINE 0xFFFFFFFFUL
+
+#if (MODBUS_AUTH)
+/*认证尾在请求及应答中占用的字节数，认证可在运行中开启，收发缓冲区始终预留*/
+#define MASTER_AUTH_RESERVE MODBUS_AUTH_SIZE
+#else
+#define MASTER_AUTH_RESERVE 0U
+#endif
+
+/*FC01/02单次读取的最大位数、FC03/04单次读取的最大寄存器数(应答需放入一个接收帧)*/
+#define MASTER_READ_BITS_MAX ((MODBUS_PDU_SIZE_MAX - 5U - MASTER_AUTH_RESERVE) * 8U)
+#define MASTER_READ_REGS_MAX ((MODBUS_PDU_SIZE_MAX - 5U - MASTER_AUTH_RESERVE) / 2U)
+
+/*请求的业务类别:类别高的请求先发出，同一类别按提交顺序；请求清零时为诊断类*/
+#define MASTER_CLASS_DIAG 0U
+#define MASTER_CLASS_TELEMETRY 1U
+#define MASTER_CLASS_CONTROL 2U
+#define MASTER_CLASS_ALARM 3U
+#define MASTER_CLASSES 4U
+
+/*从站在线圈状态之后附带的健康信息长度:|错误计数(2B)|运行时间(s,4B)|RSSI(1B)|，与从站 MODBUS_HEALTH_SIZE 一致*/
+#define MASTER_HEALTH_SIZE 7U
+/*健康信息之后附带的模拟量:|通道掩码|各置位通道的值(2B)|，最多通道数与从站 MODBUS_ANALOG_REPORT_MAX 一致*/
+#define MASTER_ANALOG_MAX 8U
+
+typedef struct ModbusRTUMaster *ModbusRTUMasterHandler;
+
+/*从站健康信息*/
+struct ModbusRTUHealth
+{
+    /*应答中带有健康信息*/
+    mdBOOL valid;
+    /*最近一次RSSI(原始字节，0x80为从站无法取得)*/
+    mdU8 rssi;
+    /*从站累计错误数(饱和于0xFFFF)*/
+    mdU16 errors;
+    /*从站上电以来的秒数*/
+    mdU32 uptime;
+};
+
+/*一个主站请求:提交时整体拷贝进请求队列*/
+struct ModbusRTURequest
+{
+    /*传输层前缀(如L101目标节点地址+信道)，原样发送且不参与CRC计算*/
+    mdU8 prefix[MASTER_PREFIX_SIZE];
+    mdU8 prefixLength;
+    /*发出请求的传输端口(0~MASTER_PORTS-1)，应答只在同一端口上匹配*/
+    mdU8 port;
+    mdU8 slaveId;
+    mdU8 code;
+    /*业务类别(MASTER_CLASS_*)*/
+    mdU8 priority;
+    /*从站寄存器起始地址及数量*/
+    mdU16 address;
+    mdU16 number;
+    /*本地寄存器池地址:读请求的应答写入此处，写请求的数据在发出时从此处读取*/
+    mdU16 local;
+    /*23功能码:写保持寄存器的从站起始地址、数量及本地数据地址(读部分使用 address/number/local)*/
+    mdU16 writeAddress;
+    mdU16 writeNumber;
+    mdU16 writeLocal;
+    /*自定义功能码:功能码之后的PDU数据，应答回显其前echoLength个字节*/
+    mdU8 data[MASTER_DATA_SIZE];
+    mdU8 dataLength;
+    mdU8 echoLength;
+    /*写线圈请求:从站在应答回显后附带的线圈状态(|字节数|线圈状态|)写入本地输入线圈
+    [reportLocal, reportLocal + reportNumber)，数量为0时只接受标准应答*/
+    mdU16 reportLocal;
+    mdU16 reportNumber;
+    /*健康信息之后附带的模拟量:通道i的值写入本地输入寄存器 analogLocal + i(i < analogNumber)，
+    数量为0时不接受附带模拟量的应答*/
+    mdU16 analogLocal;
+    mdU8 analogNumber;
+    /*线圈状态之后附带的从站健康信息，由应答解析填写，在完成回调中读取*/
+    struct ModbusRTUHealth health;
+    /*应答经纠错还原时纠正的字节数，由应答解析填写*/
+    mdU8 fecCorrected;
+    /*透传请求(frame 不为 NULL):frame 指向调用者缓冲区中已带CRC的 从机地址+PDU+CRC，其前预留 prefixLength 字节，
+    发出时前缀就地写入预留区后整帧直接交给传输层(不拷贝)，请求结束前缓冲区不得改动；
+    应答不解析，CRC正确的应答帧(含异常应答)在完成回调中由 reply/replyLength 取得，回调返回后失效*/
+    mdU8 *frame;
+    mdU16 frameLength;
+    mdU8 *reply;
+    mdU16 replyLength;
+    /*应答超时(ms)*/
+    mdU32 timeout;
+    /*请求完成回调(可为 NULL)，在接收任务或轮询调用者的上下文中执行*/
+    mdVOID (*callback)(struct ModbusRTURequest *request, mdU8 result);
+    mdVOID *arg;
+};
+
+/*请求队列中的一项*/
+struct ModbusRTUTransaction
+{
+    struct ModbusRTURequest request;
+    volatile mdU8 state;
+    /*提交顺序，按先后发出*/
+    mdU32 sequence;
+    /*发出时刻(ms)*/
+    mdU32 start;
+    /*写请求及自定义功能码应答(回显)的CRC*/
+    mdU16 expect;
+    mdU16 echo;
+    /*实际发出的从站起始地址、数量及本地地址:合并后覆盖组内所有请求，否则与请求相同*/
+    mdU16 address;
+    mdU16 number;
+    mdU16 local;
+    /*并入本请求的其他请求(状态为 MASTER_MERGED)，随本请求一同结束*/
+    struct ModbusRTUTransaction *next;
+#if (MODBUS_AUTH)
+    /*发出时使用的认证序号及请求MAC，应答的MAC以请求MAC为随机数*/
+    mdU32 authSeq;
+    mdU32 authTag;
+#endif
+};
+
+#if (MODBUS_AUTH)
+/*一个从站号的认证序号(最近一次发出的值)，id 为0的表项空闲*/
+struct ModbusRTUAuthPeer
+{
+    mdU8 id;
+    mdU32 seq;
+};
+#endif
+
+#if (MASTER_FRAME_TEMPLATES)
+/*线圈控制帧模板:从站号、功能码、地址及数量相同的帧只有线圈数据不同*/
+struct ModbusRTUFrameTemplate
+{
+    mdBOOL valid;
+    mdU8 slaveId;
+    mdU8 code;
+    mdU16 address;
+    mdU16 number;
+    /*应答回显(前6字节)的CRC*/
+    mdU16 echo;
+    /*05功能码:线圈复位/置位时整帧的CRC；15功能码:crc[0]为至字节数为止的CRC中间值*/
+    mdU16 crc[2];
+};
+#endif
+
+/*附加传输端口:发送函数在轮询调用者的上下文中调用，整帧(含前缀)须在返回前取走或拷贝*/
+struct ModbusRTUMasterPort
+{
+    mdVOID (*send)(ModbusRTUMasterHandler handler, mdU8 *data, mdU32 length);
+    /*端口是否可以发送(可为 NULL)*/
+    mdBOOL (*ready)(ModbusRTUMasterHandler handler);
+    /*本端口等待应答的请求数*/
+    volatile mdU32 pending;
+};
+
+struct ModbusRTUMaster
+{
+    /*共用从机协议栈的串口收发及寄存器池*/
+    ModbusRTUSlaveHandler transport;
+    struct ModbusRTUTransaction queue[MASTER_REQUEST_QUEUE_SIZE];
+    mdU32 sequence;
+    /*等待应答的请求数*/
+    volatile mdU32 pending;
+    mdU8 txBuffer[MODBUS_TX_BUFFER_SIZE];
+    /*统计:完成、应答错误、超时、参数错误被拒绝的请求，无匹配请求的应答及队列满丢弃的请求*/
+    mdU32 completed, errors, timeouts, rejected, unknown, drops;
+    /*其中CRC错误的应答*/
+    mdU32 crcErrors;
+    /*并入其他请求而省去的事务数*/
+    mdU32 coalesced;
+#if (MASTER_FRAME_TEMPLATES)
+    struct ModbusRTUFrameTemplate templates[MASTER_FRAME_TEMPLATES];
+    /*按模板组帧的次数及重建模板的次数*/
+    mdU32 templateHits, templateMisses;
+#endif
+    /*各类别发出的事务数；高类别请求连续越过更早提交的请求的次数，及因此让最早的请求先发出的次数*/
+    mdU32 classSent[MASTER_CLASSES];
+    mdU32 bypass, aged;
+#if (MODBUS_AUTH)
+    /*帧认证密钥，NULL 时不认证；开启后不接受广播请求(从站无法应答重新同步)*/
+    struct ModbusAuth *auth;
+    struct ModbusRTUAuthPeer peers[MASTER_AUTH_PEERS];
+    /*认证失败的应答数、按从站异常应答重新同步的次数及序号表满被拒绝的请求数*/
+    mdU32 authFailures, authResyncs, authFull;
+#endif
+#if (MODBUS_FEC)
+    /*按端口及从站号取得请求的纠错等级(可为 NULL，不编码)，由链路管理提供*/
+    mdU8 (*mdRTUMasterFec)(ModbusRTUMasterHandler handler, mdU8 port, mdU8 slaveId);
+    /*纠错编码发出的请求数及编码后超出帧容量而按原帧发出的请求数；应答的解码统计由接收处填写*/
+    mdU32 fecSent, fecPlain;
+    struct ModbusFecStats fec;
+#endif
+    /*端口0(transport)是否可以发送(可为 NULL)*/
+    mdBOOL (*mdRTUMasterReady)(ModbusRTUMasterHandler handler);
+    /*各端口的状态，端口0的 send/ready 不使用*/
+    struct ModbusRTUMasterPort ports[MASTER_PORTS];
+    mdSTATUS (*mdRTUMasterSubmit)(ModbusRTUMasterHandler handler, const struct ModbusRTURequest *request);
+    mdVOID (*mdRTUMasterPoll)(ModbusRTUMasterHandler handler, mdU32 now);
+    mdVOID (*mdRTUMasterReceive)(ModbusRTUMasterHandler handler, ReceiveBufferHandle buffer);
+    mdVOID (*mdRTUMasterReceiveOn)(ModbusRTUMasterHandler handler, mdU8 port, ReceiveBufferHandle buffer);
+};
+
+struct ModbusRTUMasterRegisterInfo
+{
+    ModbusRTUSlaveHandler transport;
+    mdBOOL (*mdRTUMasterReady)(ModbusRTUMasterHandler handler);
+};
+
+/*定义当前主站请求引擎对象*/
+mdAPI ModbusRTUMasterHandler mdClient;
+#define Client_Object mdClient
+mdAPI mdSTATUS mdCreateModbusRTUMaster(ModbusRTUMasterHandler *handler, struct ModbusRTUMasterRegisterInfo info);
+mdAPI mdVOID mdDestoryModbusRTUMaster(ModbusRTUMasterHandler *handler);
+mdAPI mdU32 mdRTUMasterFree(ModbusRTUMasterHandler handler);
+mdAPI mdU32 mdRTUMasterDeadline(ModbusRTUMasterHandler handler, mdU32 now);
+mdAPI mdSTATUS mdRTUMasterAttach(ModbusRTUMasterHandler handler, mdU8 port,
+                                 mdVOID (*send)(ModbusRTUMasterHandler handler, mdU8 *data, mdU32 length),
+                                 mdBOOL (*ready)(ModbusRTUMasterHandler handler));
+/*接口：提交请求、超时检查及发出排队请求、处理一帧应答*/
+#define mdRTU_Submit(obj, request) (obj->mdRTUMasterSubmit(obj, request))
+#define mdRTU_Poll(obj, now) (obj->mdRTUMasterPoll(obj, now))
+#define mdRTU_Response(obj, buffer) (obj->mdRTUMasterReceive(obj, buffer))
+#define mdRTU_ResponseOn(obj, port, buffer) (obj->mdRTUMasterReceiveOn(obj, port, buffer))
+#endif
+
+#endif
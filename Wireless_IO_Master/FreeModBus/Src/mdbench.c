@@ -0,0 +1,282 @@
+#include <string.h>
+#include "mdbench.h"
+#include "mdcrc16.h"
+#include "mdrtuslave.h"
+#include "main.h"
+#include "shell_port.h"
+
+#if (USER_MODBUS_LIB) && (MODBUS_MICRO_BENCH)
+/*帧长:典型短帧及最大PDU*/
+#define MDBENCH_SHORT_FRAME 8U
+#define MDBENCH_LONG_FRAME MODBUS_PDU_SIZE_MAX
+/*单次读线圈的位数及单次写保持寄存器的个数*/
+#define MDBENCH_COILS 8U
+#define MDBENCH_REGS 4U
+
+/*基准操作:arg 为工作负载中的地址或长度*/
+typedef mdVOID (*mdBenchOp)(mdU32 arg);
+
+/*在副本上测量，不改动运行中的寄存器池*/
+static struct RegisterPool mdBenchPool;
+static mdU16 mdBenchAddr[MDBENCH_CALLS];
+static mdU8 mdBenchFrame[MDBENCH_LONG_FRAME];
+static mdU16 mdBenchWords[MDBENCH_LONG_FRAME / 2U];
+/*保存结果，避免被编译器优化掉*/
+static volatile mdU32 mdBenchSink;
+
+/*
+    mdBenchFill
+        @kind   工作负载:0 顺序，1 随机，2 稀疏(步进跨越组边界，约一半地址越界)
+        @limit  组内有效起始地址个数
+        @return 工作负载名称
+    接口：生成固定的地址序列，随机序列使用固定种子，各次运行结果可比较
+*/
+static const char *mdBenchFill(mdU32 kind, mdU32 limit)
+{
+    static const char *const names[] = {"seq", "random", "sparse"};
+    mdU32 seed = 0x2545F491UL;
+
+    for (mdU32 i = 0; i < MDBENCH_CALLS; i++)
+    {
+        switch (kind)
+        {
+        case 0:
+            mdBenchAddr[i] = (mdU16)(i % limit);
+            break;
+        case 1:
+            seed ^= (seed << 13U) & 0xFFFFFFFFUL;
+            seed ^= seed >> 17U;
+            seed ^= (seed << 5U) & 0xFFFFFFFFUL;
+            mdBenchAddr[i] = (mdU16)(seed % limit);
+            break;
+        default:
+            mdBenchAddr[i] = (mdU16)((i * 37U) % (2U * limit));
+            break;
+        }
+    }
+    return names[kind];
+}
+
+static mdVOID mdBenchReadCoils(mdU32 arg)
+{
+    mdBit bits[MDBENCH_COILS];
+
+    mdBenchSink += mdBenchPool.ops->mdReadCoils(&mdBenchPool, arg, MDBENCH_COILS, bits);
+}
+
+static mdVOID mdBenchWriteHold(mdU32 arg)
+{
+    mdU16 data[MDBENCH_REGS] = {(mdU16)arg, (mdU16)(arg + 1U), (mdU16)(arg + 2U), (mdU16)(arg + 3U)};
+
+    mdBenchSink += mdBenchPool.ops->mdWriteHoldRegisters(&mdBenchPool, arg, MDBENCH_REGS, data);
+}
+
+static mdVOID mdBenchLookup(mdU32 arg)
+{
+    mdU16 data = 0;
+
+    mdBenchPool.ops->mdReadInputRegister(&mdBenchPool, arg, &data);
+    mdBenchSink += data;
+}
+
+/*
+    mdBenchCrcBitwise
+        @pucFrame 数据
+        @usLen    长度
+        @return   CRC16/MODBUS
+    逐位计算的参考实现，与查表法 mdCrc16 比较
+*/
+static mdU16 mdBenchCrcBitwise(const mdU8 *pucFrame, mdU32 usLen)
+{
+    mdU16 crc = MD_CRC16_INIT;
+
+    while (usLen--)
+    {
+        crc ^= *pucFrame++;
+        for (mdU32 i = 0; i < 8U; i++)
+        {
+            crc = (crc & 1U) ? (crc >> 1U) ^ 0xA001U : (crc >> 1U);
+        }
+    }
+    return crc;
+}
+
+static mdVOID mdBenchCrcTable(mdU32 arg)
+{
+    mdBenchSink += mdCrc16(mdBenchFrame, arg);
+}
+
+static mdVOID mdBenchCrcBits(mdU32 arg)
+{
+    mdBenchSink += mdBenchCrcBitwise(mdBenchFrame, arg);
+}
+
+static mdVOID mdBenchSwap(mdU32 arg)
+{
+    mdU16Swap(mdBenchWords, arg);
+    mdBenchSink += mdBenchWords[0];
+}
+
+/*
+    mdBenchMeasure
+        @now     时钟
+        @rounds  轮数
+        @op      基准操作
+        @fixed   为 mdTRUE 时每次调用的参数固定为 arg，否则取工作负载中的地址
+        @arg     固定参数
+        @result  结果
+        @return
+    接口：先预热一轮(填充缓存及分支预测)，再逐轮测量 MDBENCH_CALLS 次调用的耗时，
+    记录总耗时及最快一轮(排除中断及调度干扰)，含一次间接调用的开销
+*/
+static mdVOID mdBenchMeasure(mdBenchClock now, mdU32 rounds, mdBenchOp op, mdBOOL fixed, mdU32 arg,
+                             struct mdBenchResult *result)
+{
+    mdU32 start, elapsed;
+
+    for (mdU32 i = 0; i < MDBENCH_CALLS; i++)
+    {
+        op(fixed ? arg : mdBenchAddr[i]);
+    }
+    result->calls = rounds * MDBENCH_CALLS;
+    result->total = 0;
+    result->best = 0xFFFFFFFFUL;
+    for (mdU32 r = 0; r < rounds; r++)
+    {
+        start = now();
+        for (mdU32 i = 0; i < MDBENCH_CALLS; i++)
+        {
+            op(fixed ? arg : mdBenchAddr[i]);
+        }
+        elapsed = now() - start;
+        result->total += elapsed;
+        result->best = (elapsed < result->best) ? elapsed : result->best;
+    }
+}
+
+/*
+    mdBenchRun
+        @pool    寄存器池模板(拷贝后在副本上测量)
+        @now     时钟
+        @rounds  轮数，0 使用 MDBENCH_ROUNDS
+        @results 结果表
+        @size    结果表项数
+        @return  结果项数
+    接口：按固定工作负载测量寄存器池访问、CRC及半字交换
+*/
+mdU32 mdBenchRun(RegisterPoolHandle pool, mdBenchClock now, mdU32 rounds, struct mdBenchResult *results, mdU32 size)
+{
+    static const struct
+    {
+        const char *name;
+        mdBenchOp op;
+        /*组内有效起始地址个数*/
+        mdU32 limit;
+    } poolCases[] = {
+        {"read_coils", mdBenchReadCoils, COIL_POOL_SIZE - MDBENCH_COILS + 1U},
+        {"write_hold", mdBenchWriteHold, HOLD_REGISTER_POOL_SIZE - MDBENCH_REGS + 1U},
+        {"lookup", mdBenchLookup, INPUT_REGISTER_POOL_SIZE},
+    };
+    static const struct
+    {
+        const char *name;
+        const char *workload;
+        mdBenchOp op;
+        mdU32 arg;
+    } fixedCases[] = {
+        {"crc_table", "8B", mdBenchCrcTable, MDBENCH_SHORT_FRAME},
+        {"crc_table", "253B", mdBenchCrcTable, MDBENCH_LONG_FRAME},
+        {"crc_bitwise", "8B", mdBenchCrcBits, MDBENCH_SHORT_FRAME},
+        {"crc_bitwise", "253B", mdBenchCrcBits, MDBENCH_LONG_FRAME},
+        {"u16swap", "32W", mdBenchSwap, 32U},
+        {"u16swap", "126W", mdBenchSwap, MDBENCH_LONG_FRAME / 2U},
+    };
+    mdU32 count = 0;
+
+    if ((pool == NULL) || (now == NULL))
+    {
+        return 0;
+    }
+    rounds = rounds ? rounds : MDBENCH_ROUNDS;
+    memcpy(&mdBenchPool, pool, sizeof(mdBenchPool));
+    /*副本上的写入不通知运行中的订阅者*/
+    mdBenchPool.watchCount = 0;
+    for (mdU32 i = 0; i < sizeof(mdBenchFrame); i++)
+    {
+        mdBenchFrame[i] = (mdU8)(i * 7U + 1U);
+    }
+    memset(mdBenchWords, 0x5A, sizeof(mdBenchWords));
+    for (mdU32 i = 0; i < sizeof(poolCases) / sizeof(poolCases[0]); i++)
+    {
+        for (mdU32 kind = 0; (kind < 3U) && (count < size); kind++)
+        {
+            results[count].name = poolCases[i].name;
+            results[count].workload = mdBenchFill(kind, poolCases[i].limit);
+            mdBenchMeasure(now, rounds, poolCases[i].op, mdFALSE, 0, &results[count]);
+            count++;
+        }
+    }
+    for (mdU32 i = 0; (i < sizeof(fixedCases) / sizeof(fixedCases[0])) && (count < size); i++)
+    {
+        results[count].name = fixedCases[i].name;
+        results[count].workload = fixedCases[i].workload;
+        mdBenchMeasure(now, rounds, fixedCases[i].op, mdTRUE, fixedCases[i].arg, &results[count]);
+        count++;
+    }
+    return count;
+}
+
+/*
+    mdBenchReport
+        @results 结果表
+        @count   结果项数
+        @unit    时钟单位
+        @return
+    接口：输出回归报告，每项一行"名称,工作负载,调用次数,总耗时,最快一轮耗时,单次耗时"，
+    单次耗时按最快一轮计算并保留两位小数；以'#'开头的行为注释，主机端 md_micro 可据此与基线比较
+*/
+mdVOID mdBenchReport(const struct mdBenchResult *results, mdU32 count, const char *unit)
+{
+    mdU32 centi;
+
+    shellPrint(&shell, "# mdbench unit=%s calls/round=%u\r\n# case,workload,calls,total,best,per_call\r\n", unit,
+               MDBENCH_CALLS);
+    for (mdU32 i = 0; i < count; i++)
+    {
+        centi = (mdU32)(((mdU64)results[i].best * 100U) / MDBENCH_CALLS);
+        shellPrint(&shell, "%s,%s,%lu,%lu,%lu,%lu.%02lu\r\n", results[i].name, results[i].workload,
+                   (unsigned long)results[i].calls, (unsigned long)results[i].total, (unsigned long)results[i].best,
+                   (unsigned long)(centi / 100U), (unsigned long)(centi % 100U));
+    }
+}
+
+#if !defined(MODBUS_BENCH_HOST)
+static mdU32 mdBenchCycles(mdVOID)
+{
+    return DWT->CYCCNT;
+}
+
+/*
+    mdBenchShell
+        @rounds 轮数，0 使用 MDBENCH_ROUNDS
+        @return
+    接口：在当前协议栈寄存器池的副本上运行微基准，以DWT周期为单位输出报告
+*/
+static mdVOID mdBenchShell(int rounds)
+{
+    static struct mdBenchResult results[MDBENCH_CASES];
+    mdU32 count;
+
+    if (Master_Object == NULL)
+    {
+        return;
+    }
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    count = mdBenchRun(Master_Object->registerPool, mdBenchCycles, (rounds > 0) ? (mdU32)rounds : 0,
+                       results, MDBENCH_CASES);
+    mdBenchReport(results, count, "cycles");
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), mdbench, mdBenchShell, register pool and crc benchmark);
+#endif
+#endif
@@ -0,0 +1,1176 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "main.h"
+#include "shell_port.h"
+
+
+#if (USER_MODBUS_LIB)
+/*请求队列项状态*/
+#define MASTER_FREE 0
+#define MASTER_QUEUED 1
+#define MASTER_WAIT 2
+/*已取得结果，回调执行中*/
+#define MASTER_DONE 3
+/*已并入同一从站的相邻请求，随其一同发出及结束*/
+#define MASTER_MERGED 4
+
+#define mdMasterLock(primask)       \
+    do                              \
+    {                               \
+        primask = __get_PRIMASK();  \
+        __disable_irq();            \
+    } while (0)
+#define mdMasterUnlock(primask) __set_PRIMASK(primask)
+
+/*定义Modbus主站请求引擎句柄*/
+ModbusRTUMasterHandler mdClient;
+
+/*
+    mdRTUMasterCount
+        @handler 句柄
+        @result  请求结果
+        @return
+*/
+static mdVOID mdRTUMasterCount(ModbusRTUMasterHandler handler, mdU8 result)
+{
+    switch (result)
+    {
+    case MASTER_RESULT_OK:
+        handler->completed++;
+        break;
+    case MASTER_RESULT_TIMEOUT:
+        handler->timeouts++;
+        break;
+    default:
+        handler->errors++;
+        break;
+    }
+}
+
+/*
+    mdRTUMasterFinish
+        @handler 句柄
+        @t       已取得结果的请求(状态为 MASTER_DONE)
+        @result  请求结果
+        @return
+    接口：统计并回调，然后释放队列项；并入的请求共用同一结果(读请求的数据已按各自的本地地址写入)
+*/
+static mdVOID mdRTUMasterFinish(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, mdU8 result)
+{
+    struct ModbusRTUTransaction *f, *next;
+
+    mdRTUMasterCount(handler, result);
+    if (t->request.callback != NULL)
+    {
+        t->request.callback(&t->request, result);
+    }
+    for (f = t->next; f != NULL; f = next)
+    {
+        next = f->next;
+        mdRTUMasterCount(handler, result);
+        if (f->request.callback != NULL)
+        {
+            f->request.callback(&f->request, result);
+        }
+        f->next = NULL;
+        f->state = MASTER_FREE;
+    }
+    t->next = NULL;
+    t->state = MASTER_FREE;
+}
+
+/*
+    mdRTUMasterClaim
+        @handler 句柄
+        @t       请求
+        @return  取得该请求的处理权返回 mdTRUE
+    接口：应答与超时可能同时到来，只有先将状态由 MASTER_WAIT 改为 MASTER_DONE 的一方处理结果
+*/
+static mdSTATUS mdRTUMasterClaim(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t)
+{
+    mdU32 primask;
+    mdSTATUS ret = mdFALSE;
+
+    mdMasterLock(primask);
+    if (t->state == MASTER_WAIT)
+    {
+        t->state = MASTER_DONE;
+        handler->pending--;
+        handler->ports[t->request.port].pending--;
+        ret = mdTRUE;
+    }
+    mdMasterUnlock(primask);
+
+    return ret;
+}
+
+/*
+    mdRTUMasterSpanValid
+        @code         功能码(01/02/03/04/15/16)
+        @number       位数或寄存器数
+        @prefixLength 传输层前缀长度
+        @return       请求和应答都不超出收发缓冲区返回 mdTRUE
+*/
+static mdSTATUS mdRTUMasterSpanValid(mdU8 code, mdU32 number, mdU32 prefixLength)
+{
+    mdU32 bytes;
+
+    switch (code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+        return ((number > 0) && (number <= MASTER_READ_BITS_MAX)) ? mdTRUE : mdFALSE;
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+        return ((number > 0) && (number <= MASTER_READ_REGS_MAX)) ? mdTRUE : mdFALSE;
+    default:
+        bytes = (code == MODBUS_CODE_15) ? (number + 7U) / 8U : number * 2U;
+        /*前缀+从机地址+功能码+起始地址+数量+字节数+数据+认证尾+CRC*/
+        return ((number > 0) && (bytes <= 0xFF) &&
+                (prefixLength + 7U + bytes + MASTER_AUTH_RESERVE + 2U <= MODBUS_TX_BUFFER_SIZE))
+                   ? mdTRUE
+                   : mdFALSE;
+    }
+}
+
+/*
+    mdRTUMasterCheck
+        @request 请求
+        @return  请求可以发出返回 mdTRUE
+    接口：检查功能码及数量，保证请求和应答都不超出收发缓冲区
+*/
+static mdSTATUS mdRTUMasterCheck(const struct ModbusRTURequest *request)
+{
+    if ((request->prefixLength > MASTER_PREFIX_SIZE) || (request->timeout == 0))
+    {
+        return mdFALSE;
+    }
+    if (request->frame != NULL)
+    {
+        /*从机地址+功能码+CRC，帧首为请求的从站号(应答据此匹配)*/
+        return ((request->frameLength >= 4U) &&
+                (request->prefixLength + request->frameLength + MASTER_AUTH_RESERVE <= MODBUS_TX_BUFFER_SIZE) &&
+                (request->frame[0] == request->slaveId))
+                   ? mdTRUE
+                   : mdFALSE;
+    }
+    switch (request->code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+    case MODBUS_CODE_15:
+    case MODBUS_CODE_16:
+        return mdRTUMasterSpanValid(request->code, request->number, request->prefixLength);
+    case MODBUS_CODE_5:
+    case MODBUS_CODE_6:
+        return mdTRUE;
+    case MODBUS_CODE_23:
+        /*读写各自的数量限制，写部分:前缀+从机地址+功能码+读写地址及数量+字节数+数据+认证尾+CRC*/
+        return ((request->number > 0) && (request->number <= MASTER_READ_REGS_MAX) &&
+                (request->number <= MODBUS_CODE23_READ_MAX) && (request->writeNumber > 0) &&
+                (request->prefixLength + 11U + request->writeNumber * 2U + MASTER_AUTH_RESERVE + 2U <=
+                 MODBUS_TX_BUFFER_SIZE) &&
+                (request->writeNumber * 2U <= 0xFF))
+                   ? mdTRUE
+                   : mdFALSE;
+    default:
+        return ((request->dataLength <= MASTER_DATA_SIZE) && (request->echoLength <= request->dataLength))
+                   ? mdTRUE
+                   : mdFALSE;
+    }
+}
+
+/*
+    mdRTUMasterUrgent
+        @handler 句柄
+        @return  有控制及报警类请求排队或在途返回 mdTRUE
+*/
+static mdBOOL mdRTUMasterUrgent(ModbusRTUMasterHandler handler)
+{
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if ((t->state != MASTER_FREE) && (t->request.priority >= MASTER_CLASS_CONTROL))
+        {
+            return mdTRUE;
+        }
+    }
+    return mdFALSE;
+}
+
+/*
+    mdRTUMasterSubmit
+        @handler 句柄
+        @request 请求(拷贝进队列，调用后即可释放)
+        @return  入队成功返回 mdTRUE，参数错误或队列满返回 mdFALSE(开启认证时广播请求同样被拒绝)
+    接口：提交一个请求，在下一次 mdRTUMasterPoll 中按类别及提交顺序发出；
+    有控制及报警类请求排队或在途时，诊断及遥测类请求不占用为其保留的最后 MASTER_CLASS_RESERVE 个空闲项
+    (没有时可用满队列，否则按固定顺序提交的低类别请求始终被拒绝，也就无从在发送时老化)
+*/
+static mdSTATUS mdRTUMasterSubmit(ModbusRTUMasterHandler handler, const struct ModbusRTURequest *request)
+{
+    struct ModbusRTUTransaction *t;
+    mdU32 primask;
+
+    if ((mdRTUMasterCheck(request) == mdFALSE) || (request->port >= MASTER_PORTS) ||
+        (request->port && (handler->ports[request->port].send == NULL)) || (request->priority >= MASTER_CLASSES))
+    {
+        handler->rejected++;
+        return mdFALSE;
+    }
+#if (MODBUS_AUTH)
+    if ((handler->auth != NULL) && (request->slaveId == MODBUS_BROADCAST_ID))
+    {
+        handler->rejected++;
+        return mdFALSE;
+    }
+#endif
+    if ((request->priority < MASTER_CLASS_CONTROL) && (mdRTUMasterFree(handler) <= MASTER_CLASS_RESERVE) &&
+        mdRTUMasterUrgent(handler))
+    {
+        handler->drops++;
+        return mdFALSE;
+    }
+    for (t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if (t->state == MASTER_FREE)
+        {
+            memcpy(&t->request, request, sizeof(t->request));
+            mdMasterLock(primask);
+            t->sequence = handler->sequence++;
+            t->state = MASTER_QUEUED;
+            mdMasterUnlock(primask);
+            return mdTRUE;
+        }
+    }
+    handler->drops++;
+    return mdFALSE;
+}
+
+#if (MODBUS_AUTH)
+/*
+    mdRTUMasterPeer
+        @handler 句柄
+        @slaveId 从站号
+        @return  该从站的认证序号表项，表满返回 NULL
+*/
+static struct ModbusRTUAuthPeer *mdRTUMasterPeer(ModbusRTUMasterHandler handler, mdU8 slaveId)
+{
+    struct ModbusRTUAuthPeer *idle = NULL;
+
+    for (struct ModbusRTUAuthPeer *p = &handler->peers[0]; p < &handler->peers[MASTER_AUTH_PEERS]; p++)
+    {
+        if (p->id == slaveId)
+        {
+            return p;
+        }
+        idle = ((idle == NULL) && (p->id == 0)) ? p : idle;
+    }
+    if (idle != NULL)
+    {
+        /*新表项从0开始，从站以重新同步应答告知其最后接受的序号*/
+        idle->id = slaveId;
+        idle->seq = 0;
+    }
+    return idle;
+}
+
+/*
+    mdRTUMasterSign
+        @handler 句柄
+        @t       请求
+        @adu     从机地址+PDU
+        @len     长度
+        @return  附加认证尾后的长度，序号表满返回 0
+    接口：每帧使用该从站的下一个序号，请求MAC记入事务供校验应答
+*/
+static mdU32 mdRTUMasterSign(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, mdU8 *adu, mdU32 len)
+{
+    struct ModbusRTUAuthPeer *peer = mdRTUMasterPeer(handler, adu[0]);
+
+    if (peer == NULL)
+    {
+        handler->authFull++;
+        return 0;
+    }
+    t->authSeq = ++peer->seq;
+    t->authTag = mdAuthTag(handler->auth, MODBUS_AUTH_REQUEST, t->authSeq, adu, len);
+    adu[len++] = (mdU8)t->authSeq;
+    adu[len++] = t->authTag;
+    adu[len++] = t->authTag >> 8U;
+    adu[len++] = t->authTag >> 16U;
+
+    return len;
+}
+
+/*
+    mdRTUMasterVerify
+        @handler 句柄
+        @t       应答对应的请求
+        @buffer  接收缓冲区(当前帧)
+        @return  认证通过返回 mdTRUE
+    接口：校验应答的认证尾后去除，并就地重算CRC，之后按不认证的应答解析；
+    认证失败的异常应答附带从站最后接受的序号，据此重新同步该从站的序号，请求按错误结束由调度重试
+*/
+static mdSTATUS mdRTUMasterVerify(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t,
+                                  ReceiveBufferHandle buffer)
+{
+    mdU8 *recbuf = buffer->buf;
+    mdU32 len = buffer->count - MODBUS_AUTH_SIZE - 2U, tag;
+    struct ModbusRTUAuthPeer *peer;
+    mdU16 crc;
+
+    if (!buffer->crcValid || (buffer->count < 4U + MODBUS_AUTH_SIZE))
+    {
+        return mdFALSE;
+    }
+    tag = mdAuthTag(handler->auth, MODBUS_AUTH_REPLY, t->authTag, recbuf, len);
+    if ((recbuf[len] != (mdU8)t->authSeq) || (recbuf[len + 1U] != (mdU8)tag) || (recbuf[len + 2U] != (mdU8)(tag >> 8U)) ||
+        (recbuf[len + 3U] != (mdU8)(tag >> 16U)))
+    {
+        handler->authFailures++;
+        return mdFALSE;
+    }
+    if ((len == 7U) && (recbuf[1] & 0x80U) && (recbuf[2] == MODBUS_EXCEPTION_AUTH))
+    {
+        peer = mdRTUMasterPeer(handler, recbuf[0]);
+        if (peer != NULL)
+        {
+            peer->seq = ((mdU32)ToU16(recbuf[3], recbuf[4]) << 16U) | ToU16(recbuf[5], recbuf[6]);
+        }
+        handler->authResyncs++;
+    }
+    crc = mdCrc16(recbuf, len);
+    recbuf[len++] = crc;
+    recbuf[len++] = crc >> 8U;
+    buffer->count = len;
+
+    return mdTRUE;
+}
+#endif
+
+/*
+    mdRTUMasterAuth
+        @handler 句柄
+        @return  已开启帧认证返回 mdTRUE
+*/
+static mdSTATUS mdRTUMasterAuth(ModbusRTUMasterHandler handler)
+{
+#if (MODBUS_AUTH)
+    return (handler->auth != NULL) ? mdTRUE : mdFALSE;
+#else
+    return mdFALSE;
+#endif
+}
+
+/*
+    mdRTUMasterSeal
+        @handler 句柄
+        @t       请求
+        @adu     从机地址+PDU
+        @len     长度
+        @return  附加认证尾(开启认证时)及CRC后的长度，失败返回 0
+*/
+static mdU32 mdRTUMasterSeal(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, mdU8 *adu, mdU32 len)
+{
+    mdU16 crc;
+
+#if (MODBUS_AUTH)
+    if (handler->auth != NULL)
+    {
+        len = mdRTUMasterSign(handler, t, adu, len);
+        if (len == 0)
+        {
+            return 0;
+        }
+    }
+#endif
+    /*CRC低字节在前*/
+    crc = mdCrc16(adu, len);
+    adu[len++] = crc;
+    adu[len++] = crc >> 8U;
+
+    return len;
+}
+
+#if (MASTER_FRAME_TEMPLATES)
+typedef char mdTemplatesPow2[((MASTER_FRAME_TEMPLATES & (MASTER_FRAME_TEMPLATES - 1U)) == 0) ? 1 : -1];
+
+/*
+    mdRTUMasterTemplate
+        @handler 句柄
+        @t       待发出的请求
+        @adu     已写入的从机地址+PDU
+        @len     长度
+        @return  按模板补写了CRC返回 mdTRUE
+    接口：05/15功能码的帧头在从站号、地址及数量不变时相同，CRC只对线圈数据计算(05功能码直接取两值表)；
+          开启认证时认证尾随请求变化，不使用模板
+*/
+static mdSTATUS mdRTUMasterTemplate(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, mdU8 *adu,
+                                    mdU32 len)
+{
+    struct ModbusRTUFrameTemplate *tp = &handler->templates[t->request.slaveId & (MASTER_FRAME_TEMPLATES - 1U)];
+    mdU8 off[6];
+    mdU16 crc;
+
+    if (((t->request.code != MODBUS_CODE_5) && (t->request.code != MODBUS_CODE_15)) || mdRTUMasterAuth(handler))
+    {
+        return mdFALSE;
+    }
+    if (!tp->valid || (tp->slaveId != t->request.slaveId) || (tp->code != t->request.code) ||
+        (tp->address != t->address) || (tp->number != t->number))
+    {
+        tp->valid = mdTRUE;
+        tp->slaveId = t->request.slaveId;
+        tp->code = t->request.code;
+        tp->address = t->address;
+        tp->number = t->number;
+        if (tp->code == MODBUS_CODE_5)
+        {
+            memcpy(off, adu, sizeof(off));
+            off[4] = 0x00;
+            tp->crc[0] = mdCrc16(off, sizeof(off));
+            off[4] = 0xFF;
+            tp->crc[1] = mdCrc16(off, sizeof(off));
+        }
+        else
+        {
+            tp->echo = mdCrc16(adu, 6U);
+            tp->crc[0] = mdCrc16Update(tp->echo, &adu[6], 1U);
+        }
+        handler->templateMisses++;
+    }
+    else
+    {
+        handler->templateHits++;
+    }
+    if (tp->code == MODBUS_CODE_5)
+    {
+        /*写单个线圈的应答回显整帧*/
+        crc = tp->crc[adu[4] ? 1U : 0U];
+        t->expect = crc;
+    }
+    else
+    {
+        crc = mdCrc16Update(tp->crc[0], &adu[7], len - 7U);
+        t->expect = tp->echo;
+    }
+    adu[len++] = crc;
+    adu[len++] = crc >> 8U;
+
+    return mdTRUE;
+}
+#endif
+
+/*
+    mdRTUMasterBuild
+        @handler 句柄
+        @t       待发出的请求
+        @return  帧长度，读取本地寄存器失败返回 0
+    接口：在发送缓冲区中组帧，写请求的数据此时才从本地寄存器池读取
+*/
+static mdU32 mdRTUMasterBuild(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t)
+{
+    struct ModbusRTURequest *request = &t->request;
+    RegisterPoolHandle regPool = handler->transport->registerPool;
+    mdU8 *adu = &handler->txBuffer[request->prefixLength];
+    mdU32 len = 0, bytes;
+    mdU16 data = 0;
+    mdBit bit = mdLow;
+
+    memcpy(handler->txBuffer, request->prefix, request->prefixLength);
+    adu[len++] = request->slaveId;
+    adu[len++] = request->code;
+    /*写请求应答为请求的前6个字节*/
+    t->echo = 6U;
+    switch (request->code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+    case MODBUS_CODE_15:
+    case MODBUS_CODE_16:
+    case MODBUS_CODE_23:
+        adu[len++] = HIGH(t->address);
+        adu[len++] = LOW(t->address);
+        adu[len++] = HIGH(t->number);
+        adu[len++] = LOW(t->number);
+        if (request->code == MODBUS_CODE_15)
+        {
+            bytes = (t->number + 7U) / 8U;
+            adu[len++] = bytes;
+            memset(&adu[len], 0, bytes);
+            if (regPool->ops->mdReadCoilsPacked(regPool, t->local, t->number, &adu[len]) == mdFALSE)
+            {
+                return 0;
+            }
+            len += bytes;
+        }
+        else if ((request->code == MODBUS_CODE_16) || (request->code == MODBUS_CODE_23))
+        { /*16功能码写 address 开始的寄存器；23功能码在读地址及数量之后写 writeAddress 开始的寄存器*/
+            mdU16 number = t->number, local = t->local;
+            if (request->code == MODBUS_CODE_23)
+            {
+                number = request->writeNumber;
+                local = request->writeLocal;
+                adu[len++] = HIGH(request->writeAddress);
+                adu[len++] = LOW(request->writeAddress);
+                adu[len++] = HIGH(number);
+                adu[len++] = LOW(number);
+            }
+            adu[len++] = number * 2U;
+            /*字顺序按本地寄存器池的登记转换*/
+            if (regPool->ops->mdReadU16sPacked(regPool, local + HOLD_REGISTER_OFFSET, number, &adu[len]) == mdFALSE)
+            {
+                return 0;
+            }
+            len += number * 2U;
+        }
+        break;
+    case MODBUS_CODE_5:
+        if (regPool->ops->mdReadCoil(regPool, t->local, &bit) == mdFALSE)
+        {
+            return 0;
+        }
+        adu[len++] = HIGH(t->address);
+        adu[len++] = LOW(t->address);
+        adu[len++] = bit ? 0xFF : 0x00;
+        adu[len++] = 0x00;
+        break;
+    case MODBUS_CODE_6:
+        if (regPool->ops->mdReadHoldRegister(regPool, t->local, &data) == mdFALSE)
+        {
+            return 0;
+        }
+        adu[len++] = HIGH(t->address);
+        adu[len++] = LOW(t->address);
+        adu[len++] = HIGH(data);
+        adu[len++] = LOW(data);
+        break;
+    default:
+        memcpy(&adu[len], request->data, request->dataLength);
+        len += request->dataLength;
+        t->echo = 2U + request->echoLength;
+        break;
+    }
+#if (MASTER_FRAME_TEMPLATES)
+    if (mdRTUMasterTemplate(handler, t, adu, len))
+    {
+        return request->prefixLength + len + 2U;
+    }
+#endif
+    t->expect = mdCrc16(adu, t->echo);
+    len = mdRTUMasterSeal(handler, t, adu, len);
+
+    return len ? request->prefixLength + len : 0;
+}
+
+/*
+    mdRTUMasterIsWaiting
+        @handler 句柄
+        @slaveId 从站号
+        @return  该从站有请求正在等待应答返回 mdTRUE
+    接口：从站号即事务标签，同一从站同时只允许一个请求在途
+*/
+static mdSTATUS mdRTUMasterIsWaiting(ModbusRTUMasterHandler handler, mdU8 slaveId)
+{
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if ((t->state == MASTER_WAIT) && (t->request.slaveId == slaveId))
+        {
+            return mdTRUE;
+        }
+    }
+    return mdFALSE;
+}
+
+/*
+    mdRTUMasterOpen
+        @handler 句柄
+        @port    端口
+        @return  端口流水线未满且传输层可以发送返回 mdTRUE
+*/
+static mdSTATUS mdRTUMasterOpen(ModbusRTUMasterHandler handler, mdU8 port)
+{
+    mdBOOL (*ready)(ModbusRTUMasterHandler handler) = port ? handler->ports[port].ready : handler->mdRTUMasterReady;
+
+    return ((handler->ports[port].pending < MASTER_MAX_PIPELINE) && ((ready == NULL) || ready(handler))) ? mdTRUE
+                                                                                                          : mdFALSE;
+}
+
+/*
+    mdRTUMasterNext
+        @handler 句柄
+        @open    各端口是否可以发送
+        @return  可以发送的端口上类别最高、同类别中最早提交且目标从站空闲的请求，无则返回 NULL
+    接口：严格按类别优先，高类别请求连续 MASTER_CLASS_BYPASS 次越过更早提交的请求后，
+    改为发出最早的请求，低类别请求的等待以此为界
+*/
+static struct ModbusRTUTransaction *mdRTUMasterNext(ModbusRTUMasterHandler handler, const mdBOOL *open)
+{
+    struct ModbusRTUTransaction *next = NULL, *oldest = NULL;
+
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if ((t->state != MASTER_QUEUED) || !open[t->request.port] || mdRTUMasterIsWaiting(handler, t->request.slaveId))
+        {
+            continue;
+        }
+        if ((oldest == NULL) || ((mdU32)(t->sequence - oldest->sequence) & 0x80000000UL))
+        {
+            oldest = t;
+        }
+        if ((next == NULL) || (t->request.priority > next->request.priority) ||
+            ((t->request.priority == next->request.priority) && ((mdU32)(t->sequence - next->sequence) & 0x80000000UL)))
+        {
+            next = t;
+        }
+    }
+    if (next == oldest)
+    {
+        handler->bypass = 0;
+    }
+    else if (++handler->bypass > MASTER_CLASS_BYPASS)
+    {
+        handler->bypass = 0;
+        handler->aged++;
+        next = oldest;
+    }
+    return next;
+}
+
+/*
+    mdRTUMasterMergeable
+        @request 请求
+        @return  可与相邻请求合并返回 mdTRUE
+    接口：01/02/03/04/15/16功能码的普通请求，写线圈附带上报区间时应答格式不同，不合并
+*/
+static mdSTATUS mdRTUMasterMergeable(const struct ModbusRTURequest *request)
+{
+    switch (request->code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+    case MODBUS_CODE_16:
+        break;
+    case MODBUS_CODE_15:
+        if (request->reportNumber == 0)
+        {
+            break;
+        }
+        /*fall through*/
+    default:
+        return mdFALSE;
+    }
+    return ((request->frame == NULL) && (request->slaveId != MODBUS_BROADCAST_ID)) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdRTUMasterOvertakes
+        @handler 句柄
+        @lead    即将发出的请求
+        @t       候选请求
+        @return  t 之前排有同一从站的其他请求返回 mdTRUE
+    接口：合并使 t 提前发出，不得越过同一从站先提交、尚未并入的请求(如先写后读)，各从站的请求顺序不变
+*/
+static mdSTATUS mdRTUMasterOvertakes(ModbusRTUMasterHandler handler, const struct ModbusRTUTransaction *lead,
+                                     const struct ModbusRTUTransaction *t)
+{
+    for (struct ModbusRTUTransaction *u = &handler->queue[0]; u < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; u++)
+    {
+        if ((u != lead) && (u->state == MASTER_QUEUED) && (u->request.slaveId == t->request.slaveId) &&
+            ((mdU32)(u->sequence - t->sequence) & 0x80000000UL))
+        {
+            return mdTRUE;
+        }
+    }
+    return mdFALSE;
+}
+
+/*
+    mdRTUMasterCoalesce
+        @handler 句柄
+        @lead    即将发出的请求
+        @return
+    接口：把排队中同一从站、同一功能码及前缀，且从站地址与本地地址对应关系相同的相邻或重叠请求并入 lead，
+    合并为一个连续区间的事务(不超过收发缓冲区)；读应答按区间写入本地寄存器池即分发到各请求的本地地址，
+    写请求在发出时从本地寄存器池取整个区间；应答超时取组内最短的一个。
+    字顺序按寄存器地址登记(见 mdSetWordOrder)，与请求的起始地址及数量无关，合并不改变数据
+*/
+static mdVOID mdRTUMasterCoalesce(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *lead)
+{
+    struct ModbusRTURequest *request = &lead->request;
+    struct ModbusRTUTransaction *t;
+    mdU32 lo, hi;
+    mdBOOL merged;
+
+    lead->address = request->address;
+    lead->number = request->number;
+    lead->local = request->local;
+    lead->next = NULL;
+    if (!mdRTUMasterMergeable(request))
+    {
+        return;
+    }
+    do
+    {
+        merged = mdFALSE;
+        for (t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+        {
+            if ((t == lead) || (t->state != MASTER_QUEUED) || (t->request.slaveId != request->slaveId) ||
+                (t->request.code != request->code) || !mdRTUMasterMergeable(&t->request) ||
+                (t->request.prefixLength != request->prefixLength) ||
+                memcmp(t->request.prefix, request->prefix, request->prefixLength) ||
+                ((mdU16)(t->request.address - t->request.local) != (mdU16)(lead->address - lead->local)))
+            {
+                continue;
+            }
+            /*只合并相邻或重叠的区间*/
+            if ((t->request.address > (mdU32)lead->address + lead->number) ||
+                (lead->address > (mdU32)t->request.address + t->request.number))
+            {
+                continue;
+            }
+            lo = (t->request.address < lead->address) ? t->request.address : lead->address;
+            hi = ((mdU32)t->request.address + t->request.number > (mdU32)lead->address + lead->number)
+                     ? (mdU32)t->request.address + t->request.number
+                     : (mdU32)lead->address + lead->number;
+            if ((hi > 0x10000UL) || !mdRTUMasterSpanValid(request->code, hi - lo, request->prefixLength) ||
+                mdRTUMasterOvertakes(handler, lead, t))
+            {
+                continue;
+            }
+            lead->local = (mdU16)(lead->local - (lead->address - lo));
+            lead->address = (mdU16)lo;
+            lead->number = (mdU16)(hi - lo);
+            request->timeout = (t->request.timeout < request->timeout) ? t->request.timeout : request->timeout;
+            t->state = MASTER_MERGED;
+            t->next = lead->next;
+            lead->next = t;
+            handler->coalesced++;
+            merged = mdTRUE;
+        }
+    } while (merged);
+}
+
+#if (MODBUS_FEC)
+/*
+    mdRTUMasterProtect
+        @handler 句柄
+        @t       请求
+        @data    线路帧(前缀+ADU)，编码时改为发送缓冲区
+        @len     线路帧长度
+        @inplace 是否就地发送调用者缓冲区，编码时清除
+        @return  编码后的线路帧长度
+    接口：链路管理为目标从站选择了纠错等级时，ADU(不含前缀)在发送缓冲区中编码；
+    编码后超出帧容量的请求按原帧发出(从站始终接受未编码的帧)
+*/
+static mdU32 mdRTUMasterProtect(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, mdU8 **data,
+                                mdU32 len, mdBOOL *inplace)
+{
+    mdU8 level = (handler->mdRTUMasterFec != NULL)
+                     ? handler->mdRTUMasterFec(handler, t->request.port, t->request.slaveId)
+                     : MODBUS_FEC_OFF;
+    mdU32 prefix = t->request.prefixLength, n;
+
+    if ((level == MODBUS_FEC_OFF) || (len <= prefix))
+    {
+        return len;
+    }
+    if (*data != handler->txBuffer)
+    {
+        memcpy(handler->txBuffer, *data, len);
+        *data = handler->txBuffer;
+        *inplace = mdFALSE;
+    }
+    n = mdFecEncode(&handler->txBuffer[prefix], len - prefix, MODBUS_TX_BUFFER_SIZE - prefix, level);
+    if (n == 0)
+    {
+        handler->fecPlain++;
+        return len;
+    }
+    handler->fecSent++;
+    return prefix + n;
+}
+#endif
+
+/*
+    mdRTUMasterPoll
+        @handler 句柄
+        @now     当前时间(ms)
+        @return
+    接口：处理超时的请求，然后在各端口流水线允许时按类别及提交顺序发出排队的请求，各端口互不阻塞；
+    广播请求发出即完成
+*/
+static mdVOID mdRTUMasterPoll(ModbusRTUMasterHandler handler, mdU32 now)
+{
+    struct ModbusRTUTransaction *t;
+    struct ModbusRTUMasterPort *port;
+    mdBOOL open[MASTER_PORTS], inplace;
+    mdU32 len, primask;
+    mdU8 *data;
+
+    for (t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if ((t->state == MASTER_WAIT) && ((mdU32)(now - t->start) >= t->request.timeout) &&
+            mdRTUMasterClaim(handler, t))
+        {
+            mdRTUMasterFinish(handler, t, MASTER_RESULT_TIMEOUT);
+        }
+    }
+    for (;;)
+    {
+        /*每发出一帧后重新检查各端口(发送后模块即转为忙)*/
+        for (mdU8 p = 0; p < MASTER_PORTS; p++)
+        {
+            open[p] = ((p == 0) || (handler->ports[p].send != NULL)) ? mdRTUMasterOpen(handler, p) : mdFALSE;
+        }
+        t = mdRTUMasterNext(handler, open);
+        if (t == NULL)
+        {
+            break;
+        }
+        port = &handler->ports[t->request.port];
+        inplace = ((t->request.frame != NULL) && (mdRTUMasterAuth(handler) == mdFALSE)) ? mdTRUE : mdFALSE;
+        if (inplace)
+        {
+            /*透传请求:前缀就地写入调用者缓冲区的预留区*/
+            data = t->request.frame - t->request.prefixLength;
+            memcpy(data, t->request.prefix, t->request.prefixLength);
+            len = t->request.prefixLength + t->request.frameLength;
+        }
+        else if (t->request.frame != NULL)
+        {
+            /*开启认证时透传请求去掉CRC拷贝进发送缓冲区，附加认证尾后重算CRC*/
+            data = handler->txBuffer;
+            memcpy(data, t->request.prefix, t->request.prefixLength);
+            memcpy(&data[t->request.prefixLength], t->request.frame, t->request.frameLength - 2U);
+            len = mdRTUMasterSeal(handler, t, &data[t->request.prefixLength], t->request.frameLength - 2U);
+            len = len ? t->request.prefixLength + len : 0;
+        }
+        else
+        {
+            mdRTUMasterCoalesce(handler, t);
+            data = handler->txBuffer;
+            len = mdRTUMasterBuild(handler, t);
+        }
+        if (len == 0)
+        {
+            t->state = MASTER_DONE;
+            mdRTUMasterFinish(handler, t, MASTER_RESULT_ERROR);
+            continue;
+        }
+#if (MODBUS_FEC)
+        len = mdRTUMasterProtect(handler, t, &data, len, &inplace);
+#endif
+        t->start = now;
+        handler->classSent[t->request.priority]++;
+        /*先登记再发送，避免应答先于登记到达*/
+        mdMasterLock(primask);
+        t->state = MASTER_WAIT;
+        handler->pending++;
+        port->pending++;
+        mdMasterUnlock(primask);
+        /*就地组帧的透传请求直接发送调用者缓冲区；广播请求发出即结束，缓冲区随即被释放，仍拷贝进发送队列*/
+        if (t->request.port)
+        {
+            port->send(handler, data, len);
+        }
+        else if (inplace && (t->request.slaveId != MODBUS_BROADCAST_ID))
+        {
+            handler->transport->mdRTUSendFrame(handler->transport, data, len);
+        }
+        else
+        {
+            handler->transport->mdRTUSendString(handler->transport, data, len);
+        }
+        if ((t->request.slaveId == MODBUS_BROADCAST_ID) && mdRTUMasterClaim(handler, t))
+        {
+            mdRTUMasterFinish(handler, t, MASTER_RESULT_OK);
+        }
+    }
+}
+
+/*
+    mdRTUMasterParse
+        @handler 句柄
+        @t       应答对应的请求
+        @buffer  接收缓冲区(当前帧)
+        @return  请求结果
+    接口：校验一帧应答，读请求的数据直接写入本地寄存器池
+*/
+static mdU8 mdRTUMasterParse(ModbusRTUMasterHandler handler, struct ModbusRTUTransaction *t, ReceiveBufferHandle buffer)
+{
+    struct ModbusRTURequest *request = &t->request;
+    RegisterPoolHandle regPool = handler->transport->registerPool;
+    mdU8 *recbuf = buffer->buf;
+    mdU32 reclen = buffer->count, bytes, plain, extra;
+    mdSTATUS ret = mdTRUE;
+    mdU8 *health, mask;
+
+    /*CRC错误的应答另行计数(同时计入应答错误)*/
+    if (!buffer->crcValid)
+    {
+        handler->crcErrors++;
+        return MASTER_RESULT_ERROR;
+    }
+#if (MODBUS_AUTH)
+    if ((handler->auth != NULL) && (mdRTUMasterVerify(handler, t, buffer) == mdFALSE))
+    {
+        return MASTER_RESULT_ERROR;
+    }
+    reclen = buffer->count;
+#endif
+    if (request->frame != NULL)
+    {
+        if (reclen < 4U)
+        {
+            return MASTER_RESULT_ERROR;
+        }
+        request->reply = recbuf;
+        request->replyLength = (mdU16)reclen;
+        return MASTER_RESULT_OK;
+    }
+    /*异常应答(功能码最高位置1)同样不满足以下条件*/
+    if ((reclen < 5U) || (recbuf[1] != request->code))
+    {
+        return MASTER_RESULT_ERROR;
+    }
+    switch (request->code)
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+        bytes = (t->number + 7U) / 8U;
+        if ((recbuf[2] != bytes) || (reclen != 5U + bytes))
+        {
+            return MASTER_RESULT_ERROR;
+        }
+        ret = (request->code == MODBUS_CODE_1)
+                  ? regPool->ops->mdWriteCoilsPacked(regPool, t->local, t->number, &recbuf[3])
+                  : regPool->ops->mdWriteInputCoilsPacked(regPool, t->local, t->number, &recbuf[3]);
+        break;
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+    case MODBUS_CODE_23:
+        bytes = t->number * 2U;
+        if ((recbuf[2] != bytes) || (reclen != 5U + bytes))
+        {
+            return MASTER_RESULT_ERROR;
+        }
+        /*整段为一次提交，字顺序按本地寄存器池的登记转换*/
+        ret = regPool->ops->mdWriteU16sPacked(regPool,
+                                         t->local + ((request->code != MODBUS_CODE_4) ? HOLD_REGISTER_OFFSET
+                                                                                      : INPUT_REGISTER_OFFSET),
+                                         t->number, &recbuf[3]);
+        break;
+    case MODBUS_CODE_5:
+    case MODBUS_CODE_15:
+        /*回显之后附带从站上报的线圈状态*/
+        if (request->reportNumber && (reclen > t->echo + 2U))
+        {
+            bytes = (request->reportNumber + 7U) / 8U;
+            plain = t->echo + 3U + bytes;
+            health = &recbuf[t->echo + 1U + bytes];
+            /*线圈状态之后可能附带从站健康信息，其后可能附带模拟量*/
+            mask = ((request->analogNumber != 0) && (reclen > plain + MASTER_HEALTH_SIZE)) ? health[MASTER_HEALTH_SIZE] : 0U;
+            extra = 0;
+            for (mdU8 m = mask; m; m >>= 1U)
+            {
+                extra += (m & 0x01U) ? 2U : 0U;
+            }
+            extra += mask ? 1U : 0U;
+            if (((reclen != plain) && (reclen != plain + MASTER_HEALTH_SIZE + extra)) || (recbuf[t->echo] != bytes) ||
+                ((mask >> request->analogNumber) != 0) || (mdCrc16(recbuf, t->echo) != t->expect))
+            {
+                return MASTER_RESULT_ERROR;
+            }
+            ret = regPool->ops->mdWriteInputCoilsPacked(regPool, request->reportLocal, request->reportNumber,
+                                                   &recbuf[t->echo + 1U]);
+            request->health.valid = (reclen != plain) ? mdTRUE : mdFALSE;
+            if (request->health.valid)
+            {
+                request->health.errors = ToU16(health[0], health[1]);
+                request->health.uptime = ((mdU32)ToU16(health[2], health[3]) << 16U) | ToU16(health[4], health[5]);
+                request->health.rssi = health[6];
+            }
+            /*远端模拟量逐通道写入，未附带的通道保持上次的值*/
+            health += MASTER_HEALTH_SIZE + 1U;
+            for (mdU8 i = 0; mask; i++, mask >>= 1U)
+            {
+                if (mask & 0x01U)
+                {
+                    ret &= regPool->ops->mdWriteInputRegister(regPool, request->analogLocal + i, ToU16(health[0], health[1]));
+                    health += 2U;
+                }
+            }
+            break;
+        }
+        /*fall through*/
+    default:
+        /*写请求及自定义功能码:应答为请求前若干字节的回显*/
+        ret = ((reclen == t->echo + 2U) &&
+               (ToU16(recbuf[reclen - 1U], recbuf[reclen - 2U]) == t->expect))
+                  ? mdTRUE
+                  : mdFALSE;
+        break;
+    }
+    return ret ? MASTER_RESULT_OK : MASTER_RESULT_ERROR;
+}
+
+/*
+    mdRTUMasterReceiveOn
+        @handler 句柄
+        @port    收到应答的端口
+        @buffer  接收缓冲区(当前帧)
+        @return
+    接口：根据端口及从站号匹配等待应答的请求；无匹配(未知从站或已超时)的应答直接丢弃；
+    各端口的接收任务可分别调用
+*/
+static mdVOID mdRTUMasterReceiveOn(ModbusRTUMasterHandler handler, mdU8 port, ReceiveBufferHandle buffer)
+{
+    if (buffer->count == 0)
+    {
+        return;
+    }
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if ((t->state == MASTER_WAIT) && (t->request.port == port) && (t->request.slaveId == buffer->buf[0]) &&
+            mdRTUMasterClaim(handler, t))
+        {
+#if (MODBUS_FEC)
+            /*接收处在交给请求引擎之前解码，统计中为当前帧的纠正字节数*/
+            t->request.fecCorrected = (mdU8)((handler->fec.last < 0xFFU) ? handler->fec.last : 0xFFU);
+#endif
+            mdRTUMasterFinish(handler, t, mdRTUMasterParse(handler, t, buffer));
+            return;
+        }
+    }
+    handler->unknown++;
+}
+
+/*
+    mdRTUMasterReceive
+        @handler 句柄
+        @buffer  接收缓冲区(当前帧)
+        @return
+    接口：处理端口0(共用的从机协议栈)上收到的一帧应答
+*/
+static mdVOID mdRTUMasterReceive(ModbusRTUMasterHandler handler, ReceiveBufferHandle buffer)
+{
+    mdRTUMasterReceiveOn(handler, 0, buffer);
+}
+
+/*
+    mdRTUMasterAttach
+        @handler 句柄
+        @port    端口(1~MASTER_PORTS-1)
+        @send    整帧发送函数
+        @ready   就绪检查(可为 NULL)
+        @return  端口号非法返回 mdFALSE
+    接口：登记附加传输端口，在提交该端口的请求之前调用
+*/
+mdSTATUS mdRTUMasterAttach(ModbusRTUMasterHandler handler, mdU8 port,
+                           mdVOID (*send)(ModbusRTUMasterHandler handler, mdU8 *data, mdU32 length),
+                           mdBOOL (*ready)(ModbusRTUMasterHandler handler))
+{
+    if ((port == 0) || (port >= MASTER_PORTS) || (send == NULL))
+    {
+        return mdFALSE;
+    }
+    handler->ports[port].ready = ready;
+    handler->ports[port].send = send;
+    return mdTRUE;
+}
+
+/*
+    mdRTUMasterFree
+        @handler 句柄
+        @return  请求队列空闲项数
+*/
+mdU32 mdRTUMasterFree(ModbusRTUMasterHandler handler)
+{
+    mdU32 count = 0;
+
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        count += (t->state == MASTER_FREE) ? 1U : 0;
+    }
+    return count;
+}
+
+/*
+    mdRTUMasterDeadline
+        @handler 句柄
+        @now     当前时刻(ms)
+        @return  等待应答的请求中最早超时的剩余时间(ms)，已超时为0，没有时为 MASTER_NO_DEADLINE
+    接口：调用者在该时刻再调用 mdRTU_Poll，超时判定及重发不必等到下一调度节拍
+*/
+mdU32 mdRTUMasterDeadline(ModbusRTUMasterHandler handler, mdU32 now)
+{
+    mdU32 left = MASTER_NO_DEADLINE, elapsed;
+
+    for (struct ModbusRTUTransaction *t = &handler->queue[0]; t < &handler->queue[MASTER_REQUEST_QUEUE_SIZE]; t++)
+    {
+        if (t->state != MASTER_WAIT)
+        {
+            continue;
+        }
+        elapsed = now - t->start;
+        if (elapsed >= t->request.timeout)
+        {
+            return 0;
+        }
+        left = (t->request.timeout - elapsed < left) ? t->request.timeout - elapsed : left;
+    }
+    return left;
+}
+
+/*
+    mdCreateModbusRTUMaster
+        @handler 句柄
+        @info    共用的从机协议栈及传输层就绪检查
+    创建一个modbus主站请求引擎
+*/
+mdSTATUS mdCreateModbusRTUMaster(ModbusRTUMasterHandler *handler, struct ModbusRTUMasterRegisterInfo info)
+{
+    if (info.transport == NULL)
+    {
+        return mdFALSE;
+    }
+    mdmalloc((*handler), struct ModbusRTUMaster, 1U);
+#if defined(USING_DEBUG)
+    shellPrint(&shell, "client = 0x%p\r\n", *handler);
+#endif
+    if ((*handler) == NULL)
+    {
+        return mdFALSE;
+    }
+    memset((*handler), 0, sizeof(struct ModbusRTUMaster));
+    (*handler)->transport = info.transport;
+    (*handler)->mdRTUMasterReady = info.mdRTUMasterReady;
+    (*handler)->mdRTUMasterSubmit = mdRTUMasterSubmit;
+    (*handler)->mdRTUMasterPoll = mdRTUMasterPoll;
+    (*handler)->mdRTUMasterReceive = mdRTUMasterReceive;
+    (*handler)->mdRTUMasterReceiveOn = mdRTUMasterReceiveOn;
+
+    return mdTRUE;
+}
+
+/*
+    mdDestoryModbusRTUMaster
+        @handler 句柄
+    销毁一个modbus主站请求引擎
+*/
+mdVOID mdDestoryModbusRTUMaster(ModbusRTUMasterHandler *handler)
+{
+    mdfree(*handler);
+    (*handler) = NULL;
+}
+
+#endif
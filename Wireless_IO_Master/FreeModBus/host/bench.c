@@ -0,0 +1,491 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "host_port.h"
+#include "sim_channel.h"
+
+/*与目标板一致:无线调度周期(ms)、每个从站的输出线圈及上报的输入线圈数*/
+#define BENCH_POLL_MS 50U
+#define BENCH_NODE_COILS 4U
+#define BENCH_NODES_MAX (COIL_POOL_SIZE / BENCH_NODE_COILS)
+/*从站L101模块地址的起始值*/
+#define BENCH_NODE_ADDR 0x0100U
+#define BENCH_CHANNEL 0x17U
+/*目标板串口发送完成中断相对启动发送的延时(ms)*/
+#define BENCH_TX_DONE_MS 1U
+
+/*一个仿真从站:独立的从机协议栈，应答经仿真信道返回主站*/
+typedef struct
+{
+    ModbusRTUSlaveHandler Stack;
+    uint16_t Addr;
+    /*有请求在途及其提交时刻*/
+    bool Busy;
+    uint32_t Submit;
+    uint32_t Ok, Error, Timeout;
+    uint32_t Rtt_Max;
+} Bench_Node;
+
+/*一项耗时统计*/
+typedef struct
+{
+    const char *Name;
+    uint64_t Calls;
+    uint64_t Cycles, Cycles_Max;
+    uint64_t Ns, Ns_Max;
+} Bench_Timing;
+
+/*等待发送完成回调的串口发送段(仿真DMA发送完成中断)*/
+typedef struct
+{
+    bool Pending;
+    uint32_t Due;
+    void (*Done)(void *Arg, bool Sent);
+    void *Arg;
+} Bench_TxDone;
+
+static Sim_Channel Air;
+static Bench_Node Nodes[BENCH_NODES_MAX];
+static uint32_t Node_Count = 4U;
+static Bench_TxDone Tx_Done;
+static Bench_Timing Timing_Poll = {.Name = "Master_Poll"};
+static Bench_Timing Timing_Rx = {.Name = "mdRTU_Handler"};
+/*调度时延:请求提交到实际发出的最大间隔(ms)，及发出的帧数*/
+static uint32_t Sched_Max, Sched_Sum, Sched_Count;
+static uint64_t Stack_Frames;
+
+/**
+ * @brief	取得当前周期计数
+ * @details	x86主机使用TSC，其他主机以单调时钟的纳秒数代替
+ * @param	None
+ * @retval	周期计数
+ */
+static uint64_t Bench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint64_t Bench_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief	记录一次调用的耗时
+ * @param	pT 耗时统计
+ * @param	Cycles 周期数
+ * @param	Ns 纳秒数
+ * @retval	None
+ */
+static void Bench_Record(Bench_Timing *pT, uint64_t Cycles, uint64_t Ns)
+{
+    pT->Calls++;
+    pT->Cycles += Cycles;
+    pT->Ns += Ns;
+    pT->Cycles_Max = (Cycles > pT->Cycles_Max) ? Cycles : pT->Cycles_Max;
+    pT->Ns_Max = (Ns > pT->Ns_Max) ? Ns : pT->Ns_Max;
+}
+
+static Bench_Node *Bench_Find(uint16_t Addr)
+{
+    for (uint32_t i = 0; i < Node_Count; i++)
+    {
+        if (Nodes[i].Addr == Addr)
+        {
+            return &Nodes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief	应答到达主站
+ * @details	与目标板一致:L101模块去掉前缀后原样输出，串口空闲时提交一帧并通知Modbus任务
+ * @param	Arg 未使用
+ * @param	pData 应答
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Bench_Master_Deliver(void *Arg, const uint8_t *pData, uint16_t Length)
+{
+    (void)Arg;
+    if (Uart1_Dma.Rx.Event)
+    {
+        Uart1_Dma.Rx.Event(&Uart1_Dma, pData, Length, UART_DMA_EVENT_IDLE);
+    }
+    if (Uart1_Dma.Rx.Notify)
+    {
+        Uart1_Dma.Rx.Notify(&Uart1_Dma, UART_DMA_EVENT_IDLE);
+    }
+}
+
+/**
+ * @brief	请求到达从站
+ * @details	从站协议栈处理后经 Bench_Slave_Pop 返回应答
+ * @param	Arg 从站
+ * @param	pData 请求(已去掉前缀)
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Bench_Slave_Deliver(void *Arg, const uint8_t *pData, uint16_t Length)
+{
+    ModbusRTUSlaveHandler pH = ((Bench_Node *)Arg)->Stack;
+    ReceiveBufferHandle pB = pH->receiveBuffer;
+
+    pH->portRTUPushString(pH, (mdU8 *)pData, Length);
+    while (mdReceiveBufferFetch(pB))
+    {
+        pH->mdRTUCenterProcessor(pH);
+        mdClearReceiveBuffer(pB);
+    }
+}
+
+/**
+ * @brief	从站发送底层接口
+ * @param	handler 从站协议栈
+ * @param	data 应答
+ * @param	length 长度
+ * @retval	mdTRUE
+ */
+static mdSTATUS Bench_Slave_Pop(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    Sim_Channel_Send(&Air, Host_Tick, data, (uint16_t)length, Bench_Master_Deliver, NULL);
+    return mdTRUE;
+}
+
+/**
+ * @brief	从站FC15处理
+ * @details	与从机工程一致:写入线圈后在回显之后附带输入线圈状态(|字节数|线圈状态|)；
+ *          输入线圈回环为刚写入的输出，主站据此校验数据
+ * @param	handler 从站协议栈
+ * @retval	None
+ */
+static mdVOID Bench_Slave_Code15(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    RegisterPoolHandle regPool = handler->registerPool;
+    mdU16 number = ToU16(recbuf[4], recbuf[5]);
+    mdU8 reply[6U + 1U + (BENCH_NODE_COILS + 7U) / 8U + 2U] = {0};
+    mdU16 crc;
+
+    if (number > BENCH_NODE_COILS)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    regPool->ops->mdWriteCoilsPacked(regPool, ToU16(recbuf[2], recbuf[3]), number, &recbuf[7]);
+    regPool->ops->mdWriteInputCoilsPacked(regPool, 0, number, &recbuf[7]);
+    memcpy(reply, recbuf, 6U);
+    reply[6] = (BENCH_NODE_COILS + 7U) / 8U;
+    regPool->ops->mdReadInputCoilsPacked(regPool, 0, BENCH_NODE_COILS, &reply[7]);
+    crc = mdCrc16(reply, sizeof(reply) - 2U);
+    reply[sizeof(reply) - 2U] = LOW(crc);
+    reply[sizeof(reply) - 1U] = HIGH(crc);
+    handler->mdRTUSendString(handler, reply, sizeof(reply));
+}
+
+/**
+ * @brief	主站串口发送
+ * @details	按L101定点传输格式取出目标节点地址，去掉前缀后送入空口；发送完成回调延后到下一节拍
+ * @param	huart 驱动句柄
+ * @param	pSeg 发送段
+ * @param	Count 段数
+ * @retval	true 已接受
+ */
+static bool Bench_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    uint8_t frame[SIM_FRAME_SIZE];
+    uint16_t length = 0;
+    Bench_Node *pN;
+
+    (void)huart;
+    if (Tx_Done.Pending)
+    {
+        return false;
+    }
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        if (length + pSeg[i].Length > sizeof(frame))
+        {
+            return false;
+        }
+        memcpy(&frame[length], pSeg[i].pData, pSeg[i].Length);
+        length += pSeg[i].Length;
+    }
+    if (length > MASTER_PREFIX_SIZE)
+    {
+        pN = Bench_Find(ToU16(frame[0], frame[1]));
+        if (pN != NULL)
+        {
+            uint32_t wait = Host_Tick - pN->Submit;
+            Sched_Max = (wait > Sched_Max) ? wait : Sched_Max;
+            Sched_Sum += wait;
+            Sched_Count++;
+            Sim_Channel_Send(&Air, Host_Tick, &frame[MASTER_PREFIX_SIZE], length - MASTER_PREFIX_SIZE,
+                             Bench_Slave_Deliver, pN);
+        }
+    }
+    Tx_Done.Pending = true;
+    Tx_Done.Due = Host_Tick + BENCH_TX_DONE_MS;
+    Tx_Done.Done = pSeg[Count - 1U].Done;
+    Tx_Done.Arg = pSeg[Count - 1U].Arg;
+
+    return true;
+}
+
+/**
+ * @brief	L101模块是否可以发送
+ * @details	与 L101_Ready 一致:模块忙(串口帧未发完或空口正在发送)时请求留在主站请求队列中
+ * @param	handler 主站请求引擎句柄
+ * @retval	mdTRUE 空闲 mdFALSE 忙
+ */
+static mdBOOL Bench_Ready(ModbusRTUMasterHandler handler)
+{
+    (void)handler;
+    return (!Tx_Done.Pending && ((int32_t)(Host_Tick - Air.Busy) >= 0)) ? mdTRUE : mdFALSE;
+}
+
+/**
+ * @brief	请求完成回调
+ * @param	request 完成的请求
+ * @param	result 请求结果
+ * @retval	None
+ */
+static void Bench_Request_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    Bench_Node *pN = (Bench_Node *)request->arg;
+    uint32_t rtt = Host_Tick - pN->Submit;
+
+    pN->Busy = false;
+    switch (result)
+    {
+    case MASTER_RESULT_OK:
+        pN->Ok++;
+        pN->Rtt_Max = (rtt > pN->Rtt_Max) ? rtt : pN->Rtt_Max;
+        break;
+    case MASTER_RESULT_TIMEOUT:
+        pN->Timeout++;
+        break;
+    default:
+        pN->Error++;
+        break;
+    }
+}
+
+/**
+ * @brief	无线调度
+ * @details	按 Master_Poll 的方式:每个空闲从站提交一个带输入上报的FC15请求，
+ *          然后由请求引擎处理超时并按流水线深度发出
+ * @param	Timeout 应答超时(ms)
+ * @retval	None
+ */
+static void Bench_Poll(uint32_t Timeout)
+{
+    RegisterPoolHandle regPool = Master_Object->registerPool;
+    struct ModbusRTURequest request;
+    mdBit bit = mdLow;
+
+    for (uint32_t i = 0; i < Node_Count; i++)
+    {
+        Bench_Node *pN = &Nodes[i];
+        if (pN->Busy)
+        {
+            continue;
+        }
+        /*每次下发翻转一路输出*/
+        regPool->ops->mdReadCoil(regPool, i * BENCH_NODE_COILS, &bit);
+        regPool->ops->mdWriteCoil(regPool, i * BENCH_NODE_COILS, bit ? mdLow : mdHigh);
+        memset(&request, 0, sizeof(request));
+        request.prefix[0] = pN->Addr >> 8U;
+        request.prefix[1] = pN->Addr;
+        request.prefix[2] = BENCH_CHANNEL;
+        request.prefixLength = MASTER_PREFIX_SIZE;
+        request.slaveId = (mdU8)(i + 1U);
+        request.code = MODBUS_CODE_15;
+        request.address = 0;
+        request.number = BENCH_NODE_COILS;
+        request.local = i * BENCH_NODE_COILS;
+        request.reportLocal = i * BENCH_NODE_COILS;
+        request.reportNumber = BENCH_NODE_COILS;
+        /*周期刷新输出并取回输入，同目标板的遥测类请求*/
+        request.priority = MASTER_CLASS_TELEMETRY;
+        request.timeout = Timeout;
+        request.callback = Bench_Request_Done;
+        request.arg = pN;
+        if (mdRTU_Submit(Client_Object, &request))
+        {
+            pN->Busy = true;
+            pN->Submit = Host_Tick;
+        }
+    }
+    mdRTU_Poll(Client_Object, Host_Tick);
+}
+
+static void Bench_Print_Timing(const Bench_Timing *pT)
+{
+    printf("%-14s calls = %-8llu avg = %6llu cycles / %6llu ns, max = %8llu cycles / %8llu ns\n", pT->Name,
+           (unsigned long long)pT->Calls, (unsigned long long)(pT->Calls ? pT->Cycles / pT->Calls : 0),
+           (unsigned long long)(pT->Calls ? pT->Ns / pT->Calls : 0), (unsigned long long)pT->Cycles_Max,
+           (unsigned long long)pT->Ns_Max);
+}
+
+static void Bench_Usage(const char *name)
+{
+    printf("usage: %s [-n nodes] [-t duration_ms] [-d latency_ms] [-j jitter_ms] [-b bitrate] [-l loss_permille] [-s seed]\n",
+           name);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t duration = 600000U, base = 30U, jitter = 10U, bitrate = 9600U, loss = 20U, seed = 1U;
+    uint32_t timeout, ok = 0, error = 0, expired = 0, rtt = 0, starved = 0;
+    uint64_t c0, n0, wall = 0;
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    ModbusRTUSlaveHandler *pHandler;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:d:j:b:l:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            Node_Count = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            duration = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            base = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            jitter = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            bitrate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            loss = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            Bench_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if ((Node_Count == 0) || (Node_Count > BENCH_NODES_MAX) || (loss > 1000U))
+    {
+        Bench_Usage(argv[0]);
+        return 2;
+    }
+    Sim_Channel_Init(&Air, base, jitter, bitrate, (uint16_t)loss, seed);
+    Host_Transmit = Bench_Transmit;
+    ModbusInit(&Master_Object);
+    if ((Master_Object == NULL) || (Client_Object == NULL))
+    {
+        printf("modbus init failed\n");
+        return 1;
+    }
+    Client_Object->mdRTUMasterReady = Bench_Ready;
+    info.usartBaudRate = BUAD_RATE;
+    info.mdRTUPopChar = Bench_Slave_Pop;
+    for (uint32_t i = 0; i < Node_Count; i++)
+    {
+        info.slaveId = (mdU8)(i + 1U);
+        pHandler = &Nodes[i].Stack;
+        if (!mdCreateModbusRTUSlave(pHandler, info) ||
+            !mdRTURegisterCode(Nodes[i].Stack, MODBUS_CODE_15, Bench_Slave_Code15))
+        {
+            printf("node %u init failed\n", i + 1U);
+            return 1;
+        }
+        Nodes[i].Addr = BENCH_NODE_ADDR + i;
+    }
+    /*应答窗口:请求与应答各一次固定时延、最大抖动及32字节的空口时间，另加一个调度周期*/
+    timeout = 2U * (base + jitter + (32U * 8U * 1000U + bitrate - 1U) / bitrate) + BENCH_POLL_MS;
+
+    for (Host_Tick = 1U; Host_Tick <= duration; Host_Tick++)
+    {
+        if (Tx_Done.Pending && ((int32_t)(Host_Tick - Tx_Done.Due) >= 0))
+        {
+            Tx_Done.Pending = false;
+            Tx_Done.Done(Tx_Done.Arg, true);
+        }
+        Sim_Channel_Poll(&Air, Host_Tick);
+        if (Host_Signal & MODBUS_SIGNAL_RX)
+        {
+            mdU32 frames = Master_Object->rxFrames;
+            Host_Signal &= ~MODBUS_SIGNAL_RX;
+            c0 = Bench_Cycles();
+            n0 = Bench_Ns();
+            mdRTU_Handler(Master_Object);
+            Bench_Record(&Timing_Rx, Bench_Cycles() - c0, Bench_Ns() - n0);
+            Stack_Frames += Master_Object->rxFrames - frames;
+        }
+        if ((Host_Tick % BENCH_POLL_MS) == 0)
+        {
+            mdU32 frames = Master_Object->txFrames;
+            c0 = Bench_Cycles();
+            n0 = Bench_Ns();
+            Bench_Poll(timeout);
+            Bench_Record(&Timing_Poll, Bench_Cycles() - c0, Bench_Ns() - n0);
+            Stack_Frames += Master_Object->txFrames - frames;
+        }
+    }
+    wall = Timing_Rx.Ns + Timing_Poll.Ns;
+
+    printf("nodes = %u, duration = %u ms, latency = %u+%u ms, bitrate = %u bps, loss = %u/1000, seed = %u\n",
+           Node_Count, duration, base, jitter, bitrate, loss, seed);
+    for (uint32_t i = 0; i < Node_Count; i++)
+    {
+        printf("node %u: ok = %u, error = %u, timeout = %u, rtt max = %u ms\n", i + 1U, Nodes[i].Ok, Nodes[i].Error,
+               Nodes[i].Timeout, Nodes[i].Rtt_Max);
+        ok += Nodes[i].Ok;
+        error += Nodes[i].Error;
+        expired += Nodes[i].Timeout;
+        rtt = (Nodes[i].Rtt_Max > rtt) ? Nodes[i].Rtt_Max : rtt;
+        starved += Nodes[i].Ok ? 0U : 1U;
+    }
+    printf("air: sent = %u, lost = %u, overrun = %u\n", Air.Sent, Air.Lost, Air.Overrun);
+    printf("master: tx = %lu, tx dropped = %lu, rx = %lu, unknown = %lu, drops = %lu, crc errors = %lu\n",
+           (unsigned long)Master_Object->txFrames, (unsigned long)Master_Object->txDropped,
+           (unsigned long)Master_Object->rxFrames,
+           (unsigned long)Client_Object->unknown, (unsigned long)Client_Object->drops,
+           (unsigned long)Master_Object->errorCodes[ERROR3]);
+#if (MASTER_FRAME_TEMPLATES)
+    printf("frame templates: hits = %lu, misses = %lu\n", (unsigned long)Client_Object->templateHits,
+           (unsigned long)Client_Object->templateMisses);
+#endif
+    printf("transactions: ok = %u, error = %u, timeout = %u, %.2f/s simulated, rtt max = %u ms\n", ok, error, expired,
+           ok * 1000.0 / duration, rtt);
+    printf("scheduling latency: avg = %.2f ms, max = %u ms\n", Sched_Count ? (double)Sched_Sum / Sched_Count : 0.0,
+           Sched_Max);
+    Bench_Print_Timing(&Timing_Poll);
+    Bench_Print_Timing(&Timing_Rx);
+    printf("host: %.0f frames/s through the stack\n", wall ? Stack_Frames * 1e9 / wall : 0.0);
+
+    /*有从站没有完成任何请求(被请求队列饿死)时返回错误，供CI判断*/
+    if (starved)
+    {
+        printf("starved nodes = %u\n", starved);
+    }
+    return starved ? 1 : 0;
+}
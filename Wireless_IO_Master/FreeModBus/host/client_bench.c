@@ -0,0 +1,591 @@
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "mdclient.h"
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "host_port.h"
+#include "sim_channel.h"
+
+/*主机客户端吞吐量基准:以不同窗口持续读取若干从站的保持寄存器，比较逐个请求与流水请求的完成率及时延。
+  -S 时不接目标板:仿真线程按 gateway.c 的方式接收套接字上的请求(帧槽、半双工线路、字节间隔分帧)，
+  交给主站请求引擎经仿真LoRa信道转发到各仿真从站，请求引擎与从站均为本构建中的协议栈*/
+#define CB_NODES_MAX 16U
+#define CB_WINDOWS_MAX 8U
+/*与 gateway.h 一致:帧槽数、转发超时、帧结束的字节间隔及异常码*/
+#define CB_SLOTS MASTER_MAX_PIPELINE
+#define CB_GW_TIMEOUT 1000U
+#define CB_GW_GAP_US 4000U
+#define CB_EXCEPTION_BUSY 0x06U
+#define CB_EXCEPTION_PATH 0x0AU
+#define CB_EXCEPTION_TARGET 0x0BU
+/*仿真从站的L101地址及信道(同 bench.c)*/
+#define CB_NODE_ADDR 0x0100U
+#define CB_CHANNEL 0x17U
+
+/*网关帧槽:Buf 前 MASTER_PREFIX_SIZE 字节为帧头预留区*/
+typedef struct
+{
+    uint8_t State;
+    uint8_t Buf[MASTER_PREFIX_SIZE + MODBUS_PDU_SIZE_MAX];
+    uint16_t Length;
+} Cb_Slot;
+
+enum
+{
+    CB_FREE = 0,
+    CB_WAIT,
+    CB_REPLY,
+};
+
+/*仿真网关及其后的无线网络，全部只在仿真线程中访问*/
+typedef struct
+{
+    int Fd;
+    uint32_t Baud;
+    uint8_t Prefix_Length;
+    uint32_t Nodes;
+    ModbusRTUSlaveHandler Stack[CB_NODES_MAX];
+    Sim_Channel Air;
+    Cb_Slot Slot[CB_SLOTS];
+    /*串口接收中的帧及最后一个字节的时刻(us)*/
+    uint8_t Rx[MASTER_PREFIX_SIZE + MODBUS_PDU_SIZE_MAX];
+    uint16_t Rx_Length;
+    bool Rx_Collided;
+    uint64_t Rx_Last;
+    /*正在回送的应答:线路占用到 Line_Busy 时刻，届时写入套接字*/
+    Cb_Slot *Out;
+    uint64_t Line_Busy;
+    /*主站串口发送完成的仿真(同 bench.c)*/
+    bool Tx_Pending;
+    uint32_t Tx_Due;
+    void (*Tx_Done)(void *Arg, bool Sent);
+    void *Tx_Arg;
+    uint32_t Frames, Collisions, Busy, Bad;
+    volatile bool Stop;
+} Cb_Sim;
+
+/*一轮测试的结果*/
+typedef struct
+{
+    uint32_t Ok, Exception, Timeout;
+    uint64_t Latency_Sum, Latency_Max;
+} Cb_Result;
+
+/*一个基准请求*/
+typedef struct
+{
+    Cb_Result *pResult;
+    uint64_t Submit;
+} Cb_Request;
+
+static Cb_Sim Sim;
+
+/**
+ * @brief	应答到达主站串口
+ * @param	Arg 未使用
+ * @param	pData 应答
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Cb_Master_Deliver(void *Arg, const uint8_t *pData, uint16_t Length)
+{
+    (void)Arg;
+    if (Uart1_Dma.Rx.Event)
+    {
+        Uart1_Dma.Rx.Event(&Uart1_Dma, pData, Length, UART_DMA_EVENT_IDLE);
+    }
+    if (Uart1_Dma.Rx.Notify)
+    {
+        Uart1_Dma.Rx.Notify(&Uart1_Dma, UART_DMA_EVENT_IDLE);
+    }
+}
+
+static void Cb_Slave_Deliver(void *Arg, const uint8_t *pData, uint16_t Length)
+{
+    ModbusRTUSlaveHandler pH = (ModbusRTUSlaveHandler)Arg;
+    ReceiveBufferHandle pB = pH->receiveBuffer;
+
+    pH->portRTUPushString(pH, (mdU8 *)pData, Length);
+    while (mdReceiveBufferFetch(pB))
+    {
+        pH->mdRTUCenterProcessor(pH);
+        mdClearReceiveBuffer(pB);
+    }
+}
+
+static mdSTATUS Cb_Slave_Pop(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    (void)handler;
+    Sim_Channel_Send(&Sim.Air, Host_Tick, data, (uint16_t)length, Cb_Master_Deliver, NULL);
+    return mdTRUE;
+}
+
+/**
+ * @brief	主站串口发送
+ * @details	按前缀中的节点地址送入空口；发送完成回调延后一个节拍
+ * @param	huart 驱动句柄
+ * @param	pSeg 发送段
+ * @param	Count 段数
+ * @retval	true 已接受
+ */
+static bool Cb_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    uint8_t frame[SIM_FRAME_SIZE];
+    uint16_t length = 0, node;
+
+    (void)huart;
+    if (Sim.Tx_Pending)
+    {
+        return false;
+    }
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        if (length + pSeg[i].Length > sizeof(frame))
+        {
+            return false;
+        }
+        memcpy(&frame[length], pSeg[i].pData, pSeg[i].Length);
+        length += pSeg[i].Length;
+    }
+    node = (uint16_t)(ToU16(frame[0], frame[1]) - CB_NODE_ADDR);
+    if ((length > MASTER_PREFIX_SIZE) && (node < Sim.Nodes))
+    {
+        Sim_Channel_Send(&Sim.Air, Host_Tick, &frame[MASTER_PREFIX_SIZE], length - MASTER_PREFIX_SIZE,
+                         Cb_Slave_Deliver, Sim.Stack[node]);
+    }
+    Sim.Tx_Pending = true;
+    Sim.Tx_Due = Host_Tick + 1U;
+    Sim.Tx_Done = pSeg[Count - 1U].Done;
+    Sim.Tx_Arg = pSeg[Count - 1U].Arg;
+
+    return true;
+}
+
+static mdBOOL Cb_Ready(ModbusRTUMasterHandler handler)
+{
+    (void)handler;
+    return (!Sim.Tx_Pending && ((int32_t)(Host_Tick - Sim.Air.Busy) >= 0)) ? mdTRUE : mdFALSE;
+}
+
+static void Cb_Seal(uint8_t *pFrame, uint16_t Length)
+{
+    uint16_t crc = mdCrc16(pFrame, Length - 2U);
+
+    pFrame[Length - 2U] = LOW(crc);
+    pFrame[Length - 1U] = HIGH(crc);
+}
+
+static void Cb_Exception(Cb_Slot *pS, uint8_t Code, uint8_t Exception)
+{
+    uint8_t *p = &pS->Buf[MASTER_PREFIX_SIZE];
+
+    p[1] = Code | 0x80U;
+    p[2] = Exception;
+    pS->Length = 5U;
+    Cb_Seal(p, pS->Length);
+    pS->State = CB_REPLY;
+}
+
+/**
+ * @brief	转发请求完成(同 Gateway_Done)
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Cb_Gateway_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    Cb_Slot *pS = (Cb_Slot *)request->arg;
+
+    if ((result == MASTER_RESULT_OK) && (request->reply != NULL) && (request->replyLength <= MODBUS_PDU_SIZE_MAX))
+    {
+        memcpy(&pS->Buf[MASTER_PREFIX_SIZE], request->reply, request->replyLength);
+        pS->Length = request->replyLength;
+        pS->State = CB_REPLY;
+        return;
+    }
+    Cb_Exception(pS, request->code, CB_EXCEPTION_TARGET);
+}
+
+/**
+ * @brief	网关收到一帧请求
+ * @details	同 Gateway_Process/Gateway_Submit:帧槽用尽时丢弃，从站号1~n路由到对应的仿真节点，
+ *			其余回送路径不可用异常；请求队列满时回送从站忙异常
+ * @param	None
+ * @retval	None
+ */
+static void Cb_Gateway_Frame(void)
+{
+    struct ModbusRTURequest request;
+    Cb_Slot *pS = NULL;
+    uint8_t *p;
+    uint16_t len = Sim.Rx_Length - Sim.Prefix_Length;
+
+    Sim.Frames++;
+    for (uint32_t i = 0; (i < CB_SLOTS) && (pS == NULL); i++)
+    {
+        pS = (Sim.Slot[i].State == CB_FREE) ? &Sim.Slot[i] : NULL;
+    }
+    if (pS == NULL)
+    {
+        Sim.Busy++;
+        return;
+    }
+    p = &pS->Buf[MASTER_PREFIX_SIZE];
+    if ((Sim.Rx_Length < Sim.Prefix_Length + 4U) || (len > MODBUS_PDU_SIZE_MAX) ||
+        mdCrc16(&Sim.Rx[Sim.Prefix_Length], len))
+    {
+        Sim.Bad++;
+        return;
+    }
+    memcpy(p, &Sim.Rx[Sim.Prefix_Length], len);
+    pS->Length = len;
+    if ((p[0] == MODBUS_BROADCAST_ID) || (p[0] > Sim.Nodes))
+    {
+        Cb_Exception(pS, p[1], CB_EXCEPTION_PATH);
+        return;
+    }
+    memset(&request, 0, sizeof(request));
+    request.prefix[0] = HIGH(CB_NODE_ADDR + p[0] - 1U);
+    request.prefix[1] = LOW(CB_NODE_ADDR + p[0] - 1U);
+    request.prefix[2] = CB_CHANNEL;
+    request.prefixLength = MASTER_PREFIX_SIZE;
+    request.frame = p;
+    request.frameLength = len;
+    request.slaveId = p[0];
+    request.code = p[1];
+    request.priority = MASTER_CLASS_TELEMETRY;
+    request.timeout = CB_GW_TIMEOUT;
+    request.callback = Cb_Gateway_Done;
+    request.arg = pS;
+    pS->State = CB_WAIT;
+    if (!mdRTU_Submit(Client_Object, &request))
+    {
+        Cb_Exception(pS, request.code, CB_EXCEPTION_BUSY);
+    }
+}
+
+/**
+ * @brief	仿真线程
+ * @details	系统节拍跟随实际时间推进；线路为半双工:回送应答期间到达的字节丢失(计为冲突)，
+ *			接收一帧的过程中不回送应答
+ * @param	Arg 未使用
+ * @retval	NULL
+ */
+static void *Cb_Sim_Thread(void *Arg)
+{
+    struct pollfd pfd = {Sim.Fd, POLLIN, 0};
+    uint64_t start = Mdc_Now(), now;
+    uint8_t buf[256];
+    ssize_t n;
+
+    (void)Arg;
+    while (!Sim.Stop)
+    {
+        now = Mdc_Now();
+        while (Host_Tick < (uint32_t)((now - start) / 1000U))
+        {
+            Host_Tick++;
+            if (Sim.Tx_Pending && ((int32_t)(Host_Tick - Sim.Tx_Due) >= 0))
+            {
+                Sim.Tx_Pending = false;
+                Sim.Tx_Done(Sim.Tx_Arg, true);
+            }
+            Sim_Channel_Poll(&Sim.Air, Host_Tick);
+            if (Host_Signal & MODBUS_SIGNAL_RX)
+            {
+                Host_Signal &= ~MODBUS_SIGNAL_RX;
+                mdRTU_Handler(Master_Object);
+            }
+            mdRTU_Poll(Client_Object, Host_Tick);
+        }
+        if ((Sim.Out != NULL) && (now >= Sim.Line_Busy))
+        {
+            (void)!write(Sim.Fd, &Sim.Out->Buf[MASTER_PREFIX_SIZE], Sim.Out->Length);
+            Sim.Out->State = CB_FREE;
+            Sim.Out = NULL;
+        }
+        if (Sim.Rx_Length && (now >= Sim.Rx_Last + CB_GW_GAP_US))
+        {
+            if (Sim.Rx_Collided)
+            {
+                Sim.Collisions++;
+            }
+            else
+            {
+                Cb_Gateway_Frame();
+            }
+            Sim.Rx_Length = 0;
+            Sim.Rx_Collided = false;
+        }
+        for (uint32_t i = 0; (i < CB_SLOTS) && (Sim.Out == NULL) && (Sim.Rx_Length == 0U); i++)
+        {
+            if (Sim.Slot[i].State == CB_REPLY)
+            {
+                Sim.Out = &Sim.Slot[i];
+                Sim.Line_Busy = now + (uint64_t)Sim.Out->Length * DATA_BITS * 1000000U / Sim.Baud;
+            }
+        }
+        if (poll(&pfd, 1, 1) <= 0)
+        {
+            continue;
+        }
+        n = read(Sim.Fd, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            break;
+        }
+        now = Mdc_Now();
+        Sim.Rx_Collided |= (Sim.Out != NULL);
+        for (ssize_t i = 0; (i < n) && (Sim.Rx_Length < sizeof(Sim.Rx)); i++)
+        {
+            Sim.Rx[Sim.Rx_Length++] = buf[i];
+        }
+        Sim.Rx_Last = now;
+    }
+    return NULL;
+}
+
+/**
+ * @brief	创建仿真网关及仿真从站
+ * @param	Fd 网关一侧的套接字
+ * @param	Baud 串口速率
+ * @param	Nodes 从站数
+ * @param	Latency 空口固定时延(ms)
+ * @param	Jitter 随机抖动(ms)
+ * @param	Prefix_Length 请求前缀长度(PC侧L101模块去掉)
+ * @retval	true 成功
+ */
+static bool Cb_Sim_Init(int Fd, uint32_t Baud, uint32_t Nodes, uint32_t Latency, uint32_t Jitter, uint8_t Prefix_Length)
+{
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    ModbusRTUSlaveHandler *pHandler;
+
+    Sim.Fd = Fd;
+    Sim.Baud = Baud;
+    Sim.Nodes = Nodes;
+    Sim.Prefix_Length = Prefix_Length;
+    Sim_Channel_Init(&Sim.Air, Latency, Jitter, 9600U, 0, 1U);
+    Host_Transmit = Cb_Transmit;
+    ModbusInit(&Master_Object);
+    if ((Master_Object == NULL) || (Client_Object == NULL))
+    {
+        return false;
+    }
+    Client_Object->mdRTUMasterReady = Cb_Ready;
+    info.usartBaudRate = BUAD_RATE;
+    info.mdRTUPopChar = Cb_Slave_Pop;
+    for (uint32_t i = 0; i < Nodes; i++)
+    {
+        info.slaveId = (mdU8)(i + 1U);
+        pHandler = &Sim.Stack[i];
+        if (!mdCreateModbusRTUSlave(pHandler, info))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void Cb_Done(void *Arg, int Result, const uint8_t *pReply, uint16_t Length)
+{
+    Cb_Request *pQ = (Cb_Request *)Arg;
+    Cb_Result *pR = pQ->pResult;
+    uint64_t latency = Mdc_Now() - pQ->Submit;
+
+    (void)Length;
+    if ((Result == MDC_RESULT_OK) && (pReply != NULL) && !(pReply[1] & 0x80U))
+    {
+        pR->Ok++;
+        pR->Latency_Sum += latency;
+        pR->Latency_Max = (latency > pR->Latency_Max) ? latency : pR->Latency_Max;
+    }
+    else if (Result == MDC_RESULT_TIMEOUT)
+    {
+        pR->Timeout++;
+    }
+    else
+    {
+        pR->Exception++;
+    }
+    free(pQ);
+}
+
+/**
+ * @brief	以一个窗口运行一轮
+ * @details	请求完成即补充，积压不超过窗口(时延不含排队)；依次读取各从站的保持寄存器(相邻请求的从站不同)
+ * @param	pH 客户端
+ * @param	First 起始从站号
+ * @param	Nodes 从站数
+ * @param	Registers 每次读取的寄存器数
+ * @param	Duration 时长(ms)
+ * @param	pR 结果
+ * @retval	None
+ */
+static void Cb_Run(Mdc_Handle *pH, uint8_t First, uint32_t Nodes, uint16_t Registers, uint32_t Duration,
+                   Cb_Result *pR)
+{
+    uint64_t end = Mdc_Now() + (uint64_t)Duration * 1000U;
+    uint8_t pdu[5] = {MODBUS_CODE_3, 0, 0, HIGH(Registers), LOW(Registers)};
+    uint32_t next = 0;
+    Cb_Request *pQ;
+
+    memset(pR, 0, sizeof(*pR));
+    while (Mdc_Now() < end)
+    {
+        while (Mdc_Pending(pH) < pH->Window)
+        {
+            pQ = malloc(sizeof(*pQ));
+            if (pQ == NULL)
+            {
+                break;
+            }
+            pQ->pResult = pR;
+            pQ->Submit = Mdc_Now();
+            if (!Mdc_Submit(pH, (uint8_t)(First + next % Nodes), pdu, sizeof(pdu), 0, Cb_Done, pQ))
+            {
+                free(pQ);
+                break;
+            }
+            next++;
+        }
+        if (Mdc_Poll(pH, 10U) < 0)
+        {
+            break;
+        }
+    }
+    /*排空在途请求，计入本轮*/
+    while (Mdc_Pending(pH) && (Mdc_Poll(pH, 100U) >= 0))
+    {
+    }
+}
+
+static void Cb_Usage(const char *name)
+{
+    printf("usage: %s (-d device | -S) [-b baud] [-w 1,2,...] [-F] [-a addr -c channel] [-f first_unit] [-n units]\n"
+           "       [-r registers] [-t duration_ms] [-l latency_ms] [-j jitter_ms]\n",
+           name);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *device = NULL;
+    uint32_t baud = 9600U, nodes = 4U, registers = 8U, duration = 5000U, latency = 30U, jitter = 10U;
+    uint32_t addr = 0, channel = 0, first = 1U, windows[CB_WINDOWS_MAX] = {1U, MDC_WINDOW_DEFAULT}, count = 2U;
+    bool simulate = false, full = false, prefix = false;
+    static Mdc_Handle link;
+    Cb_Result result;
+    pthread_t thread;
+    int opt, sv[2];
+    char *p;
+
+    while ((opt = getopt(argc, argv, "d:Sb:w:Fa:c:f:n:r:t:l:j:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            device = optarg;
+            break;
+        case 'S':
+            simulate = true;
+            break;
+        case 'b':
+            baud = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            for (count = 0, p = optarg; (count < CB_WINDOWS_MAX) && (*p != '\0'); p += (*p == ',') ? 1 : 0)
+            {
+                windows[count++] = (uint32_t)strtoul(p, &p, 0);
+            }
+            break;
+        case 'F':
+            full = true;
+            break;
+        case 'a':
+            addr = (uint32_t)strtoul(optarg, NULL, 0);
+            prefix = true;
+            break;
+        case 'c':
+            channel = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            first = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            nodes = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            registers = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            duration = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            latency = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            jitter = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            Cb_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if ((simulate == (device != NULL)) || (nodes == 0U) || (nodes > CB_NODES_MAX) || (first + nodes > 0x100U) ||
+        (registers == 0U) || (registers > MODBUS_READ_REGS_MAX) || (baud == 0U) || (count == 0U))
+    {
+        Cb_Usage(argv[0]);
+        return 2;
+    }
+    if (simulate)
+    {
+        first = 1U;
+        if ((socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) ||
+            !Cb_Sim_Init(sv[1], baud, nodes, latency, jitter, prefix ? MASTER_PREFIX_SIZE : 0U) ||
+            (pthread_create(&thread, NULL, Cb_Sim_Thread, NULL) != 0))
+        {
+            printf("simulation init failed\n");
+            return 1;
+        }
+        Mdc_Attach(&link, sv[0], baud);
+        printf("simulated gateway: %u slots, %u nodes, air latency = %u+%u ms\n", CB_SLOTS, nodes, latency, jitter);
+    }
+    else if (Mdc_Open(&link, device, baud) < 0)
+    {
+        printf("cannot open %s at %u bps\n", device, baud);
+        return 1;
+    }
+    if (prefix)
+    {
+        Mdc_Set_Prefix(&link, (uint16_t)addr, (uint8_t)channel);
+    }
+    printf("%u bps, units %u..%u, %u registers per read, %u ms per run%s\n", baud, first, first + nodes - 1U,
+           registers, duration, full ? ", full duplex" : "");
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        Mdc_Set_Window(&link, (uint8_t)windows[k], full);
+        Cb_Run(&link, (uint8_t)first, nodes, (uint16_t)registers, duration, &result);
+        printf("window %u: ok = %-6u %7.2f/s, latency avg = %7.1f ms max = %7.1f ms, exceptions = %u, timeouts = %u\n",
+               windows[k], result.Ok, result.Ok * 1000.0 / duration,
+               result.Ok ? result.Latency_Sum / 1000.0 / result.Ok : 0.0, result.Latency_Max / 1000.0,
+               result.Exception, result.Timeout);
+    }
+    printf("link: tx = %u, rx = %u, timeouts = %u, stray = %u, dropped bytes = %u\n", link.Stats.Tx, link.Stats.Rx,
+           link.Stats.Timeout, link.Stats.Stray, link.Stats.Dropped);
+    if (simulate)
+    {
+        Sim.Stop = true;
+        pthread_join(thread, NULL);
+        printf("gateway: frames = %u, collisions = %u, busy = %u, bad = %u; air: sent = %u, lost = %u\n", Sim.Frames,
+               Sim.Collisions, Sim.Busy, Sim.Bad, Sim.Air.Sent, Sim.Air.Lost);
+    }
+    Mdc_Close(&link);
+
+    return result.Ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <string.h>
+#include "spi.h"
+#include "extlog.h"
+
+/*外部日志(Common/Core/Src/extlog.c)测试:SPI2上仿真一片FRAM，检查检测、序号恢复、环的覆盖及坏槽的处理*/
+/*FRAM指令，与 extlog.c 一致*/
+#define FRAM_CMD_WREN 0x06U
+#define FRAM_CMD_RDSR 0x05U
+#define FRAM_CMD_READ 0x03U
+#define FRAM_CMD_WRITE 0x02U
+
+GPIO_TypeDef Host_GpioB;
+SPI_HandleTypeDef hspi2;
+
+/*仿真FRAM:片选有效后第一个字节为指令，读写指令随后为16位地址，再之后为数据*/
+static struct
+{
+    bool Present;
+    bool Selected;
+    /*写使能锁存，写指令结束(释放片选)时清除*/
+    bool Wel;
+    uint8_t Cmd;
+    uint8_t Phase;
+    uint16_t Address;
+    uint8_t Memory[EXTLOG_SIZE];
+} Fram;
+
+static uint32_t Checks;
+static uint32_t Failures;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+    if ((PinState == GPIO_PIN_SET) && Fram.Selected && (Fram.Cmd == FRAM_CMD_WRITE))
+    {
+        Fram.Wel = false;
+    }
+    Fram.Selected = (PinState == GPIO_PIN_RESET);
+    Fram.Phase = 0;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)hspi;
+    (void)Timeout;
+    for (uint16_t i = 0; Fram.Present && Fram.Selected && (i < Size); i++)
+    {
+        switch (Fram.Phase)
+        {
+        case 0:
+            Fram.Cmd = pData[i];
+            Fram.Wel = Fram.Wel || (Fram.Cmd == FRAM_CMD_WREN);
+            Fram.Phase = ((Fram.Cmd == FRAM_CMD_READ) || (Fram.Cmd == FRAM_CMD_WRITE)) ? 1U : 3U;
+            break;
+        case 1:
+            Fram.Address = (uint16_t)(pData[i] << 8U);
+            Fram.Phase = 2U;
+            break;
+        case 2:
+            Fram.Address |= pData[i];
+            Fram.Phase = 3U;
+            break;
+        default:
+            if ((Fram.Cmd == FRAM_CMD_WRITE) && Fram.Wel)
+            {
+                Fram.Memory[Fram.Address++ % EXTLOG_SIZE] = pData[i];
+            }
+            break;
+        }
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)hspi;
+    (void)Timeout;
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        /*未装芯片时MISO上拉*/
+        if (!Fram.Present || !Fram.Selected)
+        {
+            pData[i] = 0xFFU;
+        }
+        else if (Fram.Cmd == FRAM_CMD_RDSR)
+        {
+            pData[i] = Fram.Wel ? 0x02U : 0x00U;
+        }
+        else
+        {
+            pData[i] = Fram.Memory[Fram.Address++ % EXTLOG_SIZE];
+        }
+    }
+    return HAL_OK;
+}
+
+static void Test_Check(bool Ok, const char *pWhat)
+{
+    Checks++;
+    if (!Ok)
+    {
+        Failures++;
+        printf("FAIL: %s\n", pWhat);
+    }
+}
+
+/**
+ * @brief	仿真复位:重新检测FRAM并恢复序号
+ * @param	None
+ * @retval	true 检测到FRAM
+ */
+static bool Test_Boot(void)
+{
+    bool present = Extlog_Init();
+
+    Extlog_Recover();
+    return present;
+}
+
+/**
+ * @brief	检查一条SOE记录
+ * @param	Sequence 序号
+ * @retval	true 读出且内容为写入时的序号
+ */
+static bool Test_Read(uint32_t Sequence)
+{
+    uint32_t value = 0;
+
+    return Extlog_Read(EXTLOG_AREA_SOE, Sequence, &value, sizeof(value)) && (value == Sequence);
+}
+
+int main(void)
+{
+    uint8_t big[EXTLOG_SLOT_MAX] = {0};
+    uint32_t slots, last;
+
+    /*未装芯片:检测失败，不接受写入*/
+    Fram.Present = false;
+    Test_Check(!Test_Boot(), "absent fram detected");
+    Test_Check(!Extlog_Write(EXTLOG_AREA_SOE, 0, &last, sizeof(last)), "write accepted without fram");
+    Test_Check(Extlog_Slots(EXTLOG_AREA_SOE) == 0U, "slots reported without fram");
+
+    /*空白芯片:恢复前拒绝写入，恢复后各区域尚无记录*/
+    Fram.Present = true;
+    Test_Check(Extlog_Init(), "fram not detected");
+    Test_Check(!Extlog_Write(EXTLOG_AREA_SOE, 0, &last, sizeof(last)), "write accepted before recovery");
+    Extlog_Recover();
+    for (uint8_t area = 0; area < EXTLOG_AREAS; area++)
+    {
+        Test_Check(Extlog_Latest(area) == 0U, "blank fram has records");
+    }
+
+    /*写满一圈多5条:最早的5条被覆盖，序号连续*/
+    slots = Extlog_Slots(EXTLOG_AREA_SOE);
+    last = slots + 5U;
+    for (uint32_t seq = 1; seq <= last; seq++)
+    {
+        Test_Check(Extlog_Write(EXTLOG_AREA_SOE, 0, &seq, sizeof(seq)), "write failed");
+    }
+    Test_Check(Extlog_Latest(EXTLOG_AREA_SOE) == last, "latest sequence");
+    Test_Check(!Test_Read(5U), "overwritten record still readable");
+    Test_Check(Test_Read(6U) && Test_Read(last), "record not readable");
+    Test_Check(!Extlog_Write(EXTLOG_AREA_SOE, 0, big, EXTLOG_DATA_MAX(EXTLOG_SLOT_SOE) + 1U), "oversized record accepted");
+
+    /*复位后序号从日志中恢复*/
+    Test_Check(Test_Boot() && (Extlog_Latest(EXTLOG_AREA_SOE) == last), "sequence not recovered");
+    Test_Check(Extlog_Latest(EXTLOG_AREA_STATS) == 0U, "records leaked into another area");
+
+    /*最新的槽损坏(CRC不符)时退回前一条记录*/
+    Fram.Memory[(last % slots) * EXTLOG_SLOT_SOE + EXTLOG_HEAD_SIZE] ^= 0x5AU;
+    Test_Check(Test_Boot() && (Extlog_Latest(EXTLOG_AREA_SOE) == last - 1U), "corrupt slot accepted");
+    Test_Check(!Test_Read(last) && Test_Read(last - 1U), "corrupt slot read");
+
+    printf("extlog: checks = %u, failures = %u\n", Checks, Failures);
+    return Failures ? 1 : 0;
+}
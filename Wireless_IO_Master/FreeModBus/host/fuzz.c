@@ -0,0 +1,645 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "mdfec.h"
+#include "host_port.h"
+
+/*主机模糊测试:向从机协议栈的中心处理器及主站请求引擎的应答解析灌入畸形帧。
+  检查项:应答不超出发送缓冲区、站号及CRC正确，格式不合法的标准请求不得被执行(不应答)；
+  用 -DMD_SANITIZE=ON 构建时越界读写由 AddressSanitizer 报告。同时统计各类输入的处理吞吐量*/
+/*被测从站的站号及主站在途请求的目标从站数*/
+#define FUZZ_SLAVE_ID 0x01U
+#define FUZZ_PEERS 4U
+/*被测从站登记的文件号(20/21功能码)，其余文件号未登记*/
+#define FUZZ_FILE 1U
+/*随机帧的最大长度:超过接收帧容量，覆盖截断路径*/
+#define FUZZ_FRAME_MAX (MODBUS_PDU_SIZE_MAX + 16U)
+/*字节流输入每段的最大长度(超过接收帧容量)*/
+#define FUZZ_CHUNK_MAX 1024U
+
+/*输入类别*/
+typedef enum
+{
+    FUZZ_RANDOM = 0,
+    FUZZ_MUTATE,
+    FUZZ_STREAM,
+    FUZZ_FEC,
+    FUZZ_KINDS,
+} Fuzz_Kind;
+
+typedef struct
+{
+    const char *Name;
+    uint64_t Frames;
+    uint64_t Bytes;
+    uint64_t Ns;
+    uint64_t Replies;
+} Fuzz_Stats;
+
+static Fuzz_Stats Stats[FUZZ_KINDS] = {{"random"}, {"mutate"}, {"stream"}, {"fec"}};
+static ModbusRTUSlaveHandler Slave;
+static uint32_t Seed = 1U;
+/*当前输入帧，供应答检查判断请求是否合法*/
+static const uint8_t *Fuzz_Frame;
+static uint32_t Fuzz_Length;
+static uint32_t Violations;
+static uint64_t Replies;
+/*等待发送完成回调的主站发送段*/
+static void (*Tx_Done)(void *Arg, bool Sent);
+static void *Tx_Arg;
+
+static uint64_t Fuzz_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief	取得随机数
+ * @details	xorshift32，固定种子可复现
+ * @param	None
+ * @retval	随机数
+ */
+static uint32_t Fuzz_Random(void)
+{
+    Seed ^= Seed << 13U;
+    Seed ^= Seed >> 17U;
+    Seed ^= Seed << 5U;
+    return Seed;
+}
+
+static void Fuzz_Fail(const char *pWhat)
+{
+    Violations++;
+    if (Violations <= 10U)
+    {
+        printf("violation: %s, frame (%u bytes):", pWhat, Fuzz_Length);
+        for (uint32_t i = 0; (i < Fuzz_Length) && (i < 24U); i++)
+        {
+            printf(" %02x", Fuzz_Frame[i]);
+        }
+        printf("\n");
+    }
+}
+
+static void Fuzz_Seal(uint8_t *pFrame, uint32_t Length)
+{
+    uint16_t crc = mdCrc16(pFrame, Length - 2U);
+
+    pFrame[Length - 2U] = LOW(crc);
+    pFrame[Length - 1U] = HIGH(crc);
+}
+
+/**
+ * @brief	按协议判断文件记录请求(20/21功能码)的格式是否合法
+ * @details	每个子请求的引用类型为6、文件已登记、记录不越界；读请求的应答数据不超过 MODBUS_FILE_DATA_MAX，
+ *			写请求的子请求恰好填满字节数
+ * @param	pFrame 请求
+ * @param	Length 长度
+ * @retval	true 合法
+ */
+static bool Fuzz_File_Valid(const uint8_t *pFrame, uint32_t Length)
+{
+    uint32_t end, pos, step, total = 0, record, number;
+    bool read = (pFrame[1] == MODBUS_CODE_20);
+
+    if ((Length < 5U) || (Length != 5U + pFrame[2]) || (pFrame[2] < (read ? 7U : 9U)) || (read && (pFrame[2] % 7U)))
+    {
+        return false;
+    }
+    end = 3U + pFrame[2];
+    for (pos = 3U; pos < end; pos += step)
+    {
+        if (pos + 7U > end)
+        {
+            return false;
+        }
+        record = ToU16(pFrame[pos + 3U], pFrame[pos + 4U]);
+        number = ToU16(pFrame[pos + 5U], pFrame[pos + 6U]);
+        step = read ? 7U : (7U + 2U * number);
+        total += 2U + 2U * number;
+        if ((pFrame[pos] != MODBUS_FILE_REF_TYPE) || (ToU16(pFrame[pos + 1U], pFrame[pos + 2U]) != FUZZ_FILE) ||
+            !number || (record + number > MODBUS_FILE_RECORDS) || (pos + step > end) ||
+            (read && (total > MODBUS_FILE_DATA_MAX)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief	按协议判断标准请求的格式是否合法
+ * @details	与协议栈的检查相互独立:帧长度、字节数与数量一致，数量不超过协议上限
+ * @param	pFrame 请求
+ * @param	Length 长度
+ * @retval	true 合法(或不是标准功能码)
+ */
+static bool Fuzz_Request_Valid(const uint8_t *pFrame, uint32_t Length)
+{
+    uint32_t number = (Length >= 6U) ? ToU16(pFrame[4], pFrame[5]) : 0;
+
+    switch (pFrame[1])
+    {
+    case MODBUS_CODE_1:
+    case MODBUS_CODE_2:
+        return (Length == 8U) && number && (number <= MODBUS_READ_BITS_MAX);
+    case MODBUS_CODE_3:
+    case MODBUS_CODE_4:
+        return (Length == 8U) && number && (number <= MODBUS_READ_REGS_MAX);
+    case MODBUS_CODE_5:
+    case MODBUS_CODE_6:
+        return Length == 8U;
+    case MODBUS_CODE_15:
+        return (Length >= 9U) && (Length == 9U + pFrame[6]) && number && (number <= MODBUS_WRITE_BITS_MAX) &&
+               (pFrame[6] == (number + 7U) / 8U);
+    case MODBUS_CODE_16:
+        return (Length >= 9U) && (Length == 9U + pFrame[6]) && number && (number <= MODBUS_WRITE_REGS_MAX) &&
+               (pFrame[6] == number * 2U);
+    case MODBUS_CODE_23:
+        return (Length >= 13U) && (Length == 13U + pFrame[10]) && number && (number <= MODBUS_CODE23_READ_MAX) &&
+               ToU16(pFrame[8], pFrame[9]) && (pFrame[10] == ToU16(pFrame[8], pFrame[9]) * 2U);
+    case MODBUS_CODE_20:
+    case MODBUS_CODE_21:
+        return Fuzz_File_Valid(pFrame, Length);
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief	被测从站的发送底层接口
+ * @details	检查每一帧应答
+ * @param	handler 从站协议栈
+ * @param	data 应答
+ * @param	length 长度
+ * @retval	mdTRUE
+ */
+static mdSTATUS Fuzz_Slave_Pop(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    Replies++;
+    if ((length < 4U) || (length > MODBUS_TX_BUFFER_SIZE))
+    {
+        Fuzz_Fail("reply length");
+    }
+    else if ((data[0] != FUZZ_SLAVE_ID) || (mdCrc16(data, length - 2U) != ToU16(data[length - 1U], data[length - 2U])))
+    {
+        Fuzz_Fail("reply header or crc");
+    }
+    if ((Fuzz_Frame != NULL) && !Fuzz_Request_Valid(Fuzz_Frame, (Fuzz_Length < MODBUS_PDU_SIZE_MAX) ? Fuzz_Length
+                                                                                                    : MODBUS_PDU_SIZE_MAX))
+    {
+        Fuzz_Fail("malformed request executed");
+    }
+    /*写入数据经视图直接从接收帧交给寄存器池，不得越过CRC*/
+    else if ((Fuzz_Frame != NULL) &&
+             ((Fuzz_Frame[1] == MODBUS_CODE_15) || (Fuzz_Frame[1] == MODBUS_CODE_16) || (Fuzz_Frame[1] == MODBUS_CODE_23)) &&
+             ((Slave->pdu.data == NULL) ||
+              (Slave->pdu.data + Slave->pdu.bytes != Slave->receiveBuffer->buf + Slave->receiveBuffer->count - 2U)))
+    {
+        Fuzz_Fail("pdu view outside request");
+    }
+    return mdTRUE;
+}
+
+/**
+ * @brief	被测从站的文件读函数
+ * @details	按记录号填充，供应答长度检查
+ * @param	file 文件号
+ * @param	record 起始记录号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdTRUE
+ */
+static mdSTATUS Fuzz_File_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    for (mdU16 i = 0; i < length; i++)
+    {
+        data[2U * i] = HIGH(record + i);
+        data[2U * i + 1U] = LOW(record + i);
+    }
+    return (file == FUZZ_FILE) ? mdTRUE : mdFALSE;
+}
+
+static mdSTATUS Fuzz_File_Write(mdU16 file, mdU16 record, mdU16 length, const mdU8 *data)
+{
+    (void)record;
+    (void)length;
+    (void)data;
+    return (file == FUZZ_FILE) ? mdTRUE : mdFALSE;
+}
+
+/**
+ * @brief	主站串口发送
+ * @details	丢弃请求；发送完成回调延后到下一轮，与目标板的DMA发送完成中断一致
+ * @param	huart 驱动句柄
+ * @param	pSeg 发送段
+ * @param	Count 段数
+ * @retval	true 已接受
+ */
+static bool Fuzz_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    (void)huart;
+    if (Tx_Done != NULL)
+    {
+        return false;
+    }
+    Tx_Done = pSeg[Count - 1U].Done;
+    Tx_Arg = pSeg[Count - 1U].Arg;
+    return true;
+}
+
+static void Fuzz_Request_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    (void)request;
+    (void)result;
+}
+
+/**
+ * @brief	保持主站有在途请求
+ * @details	随机功能码及数量，使畸形应答能匹配到在途请求并进入应答解析
+ * @param	None
+ * @retval	None
+ */
+static void Fuzz_Submit(void)
+{
+    static const uint8_t codes[] = {MODBUS_CODE_1, MODBUS_CODE_2, MODBUS_CODE_3, MODBUS_CODE_4,
+                                    MODBUS_CODE_5, MODBUS_CODE_15, MODBUS_CODE_16};
+    struct ModbusRTURequest request;
+
+    memset(&request, 0, sizeof(request));
+    request.slaveId = (mdU8)(1U + Fuzz_Random() % FUZZ_PEERS);
+    request.code = codes[Fuzz_Random() % sizeof(codes)];
+    request.address = (mdU16)(Fuzz_Random() % COIL_POOL_SIZE);
+    request.number = (mdU16)(1U + Fuzz_Random() % 8U);
+    request.local = 0;
+    if (request.code == MODBUS_CODE_15)
+    {
+        request.reportNumber = (mdU16)(Fuzz_Random() % 9U);
+        request.analogLocal = (mdU16)(Fuzz_Random() % INPUT_REGISTER_POOL_SIZE);
+        request.analogNumber = (mdU8)(Fuzz_Random() % (MASTER_ANALOG_MAX + 1U));
+    }
+    request.timeout = 20U;
+    request.callback = Fuzz_Request_Done;
+    mdRTU_Submit(Client_Object, &request);
+}
+
+/**
+ * @brief	生成一帧变异的标准请求
+ * @details	从合法请求出发，数量取边界值，再随机改写、截断或加长若干字节；多数情况下重新计算CRC，
+ *			使畸形帧越过CRC检查进入处理函数
+ * @param	pFrame 输出缓冲区(FUZZ_FRAME_MAX字节)
+ * @retval	帧长度
+ */
+static uint32_t Fuzz_Mutate(uint8_t *pFrame)
+{
+    static const uint8_t codes[] = {MODBUS_CODE_1,  MODBUS_CODE_2,  MODBUS_CODE_3,  MODBUS_CODE_4,
+                                    MODBUS_CODE_5,  MODBUS_CODE_6,  MODBUS_CODE_15, MODBUS_CODE_16,
+                                    MODBUS_CODE_20, MODBUS_CODE_21, MODBUS_CODE_23};
+    static const uint16_t numbers[] = {0, 1, 7, 8, 9, 31, 32, 33, 123, 124, 125, 126, 255, 256, 2000, 2001, 0xFFFF};
+    uint16_t number = numbers[Fuzz_Random() % (sizeof(numbers) / sizeof(numbers[0]))];
+    uint16_t address = (Fuzz_Random() & 1U) ? (uint16_t)(Fuzz_Random() % 64U) : (uint16_t)Fuzz_Random();
+    uint32_t length = 8U, bytes, fixed = 7U;
+
+    memset(pFrame, 0, FUZZ_FRAME_MAX);
+    pFrame[0] = FUZZ_SLAVE_ID;
+    pFrame[1] = codes[Fuzz_Random() % sizeof(codes)];
+    pFrame[2] = HIGH(address);
+    pFrame[3] = LOW(address);
+    pFrame[4] = HIGH(number);
+    pFrame[5] = LOW(number);
+    switch (pFrame[1])
+    {
+    case MODBUS_CODE_15:
+    case MODBUS_CODE_16:
+        bytes = (pFrame[1] == MODBUS_CODE_15) ? (number + 7U) / 8U : number * 2U;
+        pFrame[6] = (uint8_t)bytes;
+        bytes = (bytes < MODBUS_PDU_SIZE_MAX - 9U) ? bytes : (Fuzz_Random() % (MODBUS_PDU_SIZE_MAX - 9U));
+        length = 9U + bytes;
+        break;
+    case MODBUS_CODE_23:
+        pFrame[6] = pFrame[2];
+        pFrame[7] = pFrame[3];
+        pFrame[8] = pFrame[4];
+        pFrame[9] = pFrame[5];
+        bytes = number * 2U;
+        pFrame[10] = (uint8_t)bytes;
+        bytes = (bytes < MODBUS_PDU_SIZE_MAX - 13U) ? bytes : (Fuzz_Random() % (MODBUS_PDU_SIZE_MAX - 13U));
+        length = 13U + bytes;
+        fixed = 11U;
+        break;
+    case MODBUS_CODE_20:
+    case MODBUS_CODE_21:
+        /*子请求:[引用类型][文件号][记录号][数量]，读请求含1~4个子请求，写请求含1个子请求及随机数据*/
+        bytes = (pFrame[1] == MODBUS_CODE_20) ? 7U * (1U + Fuzz_Random() % 4U) : 7U + 2U * (number % 128U);
+        pFrame[2] = (uint8_t)bytes;
+        for (uint32_t i = 3U; i < 3U + bytes; i += 7U)
+        {
+            pFrame[i] = MODBUS_FILE_REF_TYPE;
+            pFrame[i + 1U] = 0;
+            pFrame[i + 2U] = (Fuzz_Random() % 8U) ? FUZZ_FILE : (uint8_t)Fuzz_Random();
+            pFrame[i + 3U] = HIGH(address);
+            pFrame[i + 4U] = LOW(address);
+            pFrame[i + 5U] = HIGH(number);
+            pFrame[i + 6U] = LOW(number);
+            if (pFrame[1] == MODBUS_CODE_21)
+            {
+                break;
+            }
+        }
+        length = 5U + bytes;
+        fixed = (pFrame[1] == MODBUS_CODE_20) ? length : 10U;
+        break;
+    default:
+        break;
+    }
+    for (uint32_t i = fixed; i < length - 2U; i++)
+    {
+        pFrame[i] = (uint8_t)Fuzz_Random();
+    }
+    /*随机改写、截断或加长*/
+    for (uint32_t k = Fuzz_Random() % 4U; k; k--)
+    {
+        switch (Fuzz_Random() % 3U)
+        {
+        case 0:
+            pFrame[1U + Fuzz_Random() % (length - 1U)] ^= (uint8_t)(1U << (Fuzz_Random() % 8U));
+            break;
+        case 1:
+            length = (length > 3U) ? 3U + Fuzz_Random() % (length - 2U) : length;
+            break;
+        default:
+            length += Fuzz_Random() % 16U;
+            length = (length < FUZZ_FRAME_MAX) ? length : FUZZ_FRAME_MAX;
+            break;
+        }
+    }
+    if ((Fuzz_Random() % 4U) && (length >= 4U))
+    {
+        Fuzz_Seal(pFrame, length);
+    }
+    return length;
+}
+
+/**
+ * @brief	向被测从站送入一帧并处理
+ * @param	Kind 输入类别
+ * @param	pFrame 帧
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Fuzz_Slave_Feed(Fuzz_Kind Kind, const uint8_t *pFrame, uint32_t Length)
+{
+    ReceiveBufferHandle pB = Slave->receiveBuffer;
+    uint64_t n0 = Fuzz_Ns(), replies = Replies;
+
+    Fuzz_Frame = pFrame;
+    Fuzz_Length = Length;
+    Slave->portRTUPushString(Slave, (mdU8 *)pFrame, Length);
+    while (mdReceiveBufferFetch(pB))
+    {
+        Slave->mdRTUCenterProcessor(Slave);
+        mdClearReceiveBuffer(pB);
+    }
+    Fuzz_Frame = NULL;
+    Stats[Kind].Ns += Fuzz_Ns() - n0;
+    Stats[Kind].Frames++;
+    Stats[Kind].Bytes += Length;
+    Stats[Kind].Replies += Replies - replies;
+}
+
+/**
+ * @brief	向主站串口灌入一段连续的畸形字节流
+ * @details	按任意长度分段经串口接收事件送入，随机插入线路空闲；
+ *			处理按 Modbus 任务的方式进行，在途请求由请求引擎匹配应答
+ * @param	Bytes 字节数
+ * @retval	None
+ */
+static void Fuzz_Stream(uint32_t Bytes)
+{
+    static uint8_t chunk[FUZZ_CHUNK_MAX];
+    uint32_t tick = 0;
+
+    while (Bytes)
+    {
+        uint32_t length = 1U + Fuzz_Random() % FUZZ_CHUNK_MAX;
+        uint64_t n0;
+
+        length = (length < Bytes) ? length : Bytes;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            chunk[i] = (uint8_t)Fuzz_Random();
+        }
+        /*部分分段以在途请求的从站号开头，其中一些补上CRC*/
+        if ((Fuzz_Random() & 1U) && (length >= 4U))
+        {
+            chunk[0] = (uint8_t)(1U + Fuzz_Random() % FUZZ_PEERS);
+            if (Fuzz_Random() & 1U)
+            {
+                Fuzz_Seal(chunk, (length < MODBUS_PDU_SIZE_MAX) ? length : MODBUS_PDU_SIZE_MAX);
+            }
+        }
+        if (Tx_Done != NULL)
+        {
+            void (*done)(void *Arg, bool Sent) = Tx_Done;
+            Tx_Done = NULL;
+            done(Tx_Arg, true);
+        }
+        Host_Tick = ++tick;
+        if ((tick % 8U) == 0)
+        {
+            Fuzz_Submit();
+        }
+        n0 = Fuzz_Ns();
+        Uart1_Dma.Rx.Event(&Uart1_Dma, chunk, (uint16_t)length, (Fuzz_Random() & 1U) ? UART_DMA_EVENT_IDLE : 0);
+        Uart1_Dma.Rx.Notify(&Uart1_Dma, UART_DMA_EVENT_IDLE);
+        if (Host_Signal & MODBUS_SIGNAL_RX)
+        {
+            Host_Signal &= ~MODBUS_SIGNAL_RX;
+            mdRTU_Handler(Master_Object);
+        }
+        mdRTU_Poll(Client_Object, Host_Tick);
+        /*检查之后不应留下已超时仍在等待的请求，否则超时定时器会反复到期*/
+        if (mdRTUMasterDeadline(Client_Object, Host_Tick) == 0)
+        {
+            Fuzz_Fail("expired request left waiting");
+        }
+        Stats[FUZZ_STREAM].Ns += Fuzz_Ns() - n0;
+        Stats[FUZZ_STREAM].Frames++;
+        Stats[FUZZ_STREAM].Bytes += length;
+        Bytes -= length;
+    }
+}
+
+/**
+ * @brief	纠错编码往返检查
+ * @details	随机帧按随机等级编码后，奇数次注入纠错能力以内的错误(任意位置连续 等级*深度 个字节的突发，
+ *			或任意位置共等级个错误字节)，解码须还原原帧；偶数次注入任意数量的错误，只检查解码不越界；
+ *			还原的帧计入 replies
+ * @param	Iterations 帧数
+ * @retval	None
+ */
+static void Fuzz_Fec(uint32_t Iterations)
+{
+    uint8_t frame[MODBUS_PDU_SIZE_MAX], orig[MODBUS_PDU_SIZE_MAX];
+    mdU32 length, total, depth, corrected, at;
+    mdU8 level;
+
+    for (uint32_t i = 0; i < Iterations; i++)
+    {
+        uint64_t n0 = Fuzz_Ns();
+
+        length = 1U + Fuzz_Random() % (MODBUS_PDU_SIZE_MAX - MODBUS_FEC_OVERHEAD);
+        level = (mdU8)(1U + Fuzz_Random() % MODBUS_FEC_MAX);
+        for (uint32_t k = 0; k < length; k++)
+        {
+            orig[k] = frame[k] = (uint8_t)Fuzz_Random();
+        }
+        total = mdFecEncode(frame, length, sizeof(frame), level);
+        if (total == 0)
+        {
+            Fuzz_Frame = orig;
+            Fuzz_Length = length;
+            Fuzz_Fail("fec encode refused");
+            continue;
+        }
+        depth = (length < MODBUS_FEC_DEPTH) ? length : MODBUS_FEC_DEPTH;
+        if ((i & 1U) && (Fuzz_Random() & 1U))
+        { /*连续 等级*深度 个字节的突发(标记字节损坏的帧不会被识别为纠错帧，只在数据及校验中注入)*/
+            at = 1U + Fuzz_Random() % (total - 1U);
+            for (uint32_t k = at; (k < at + level * depth) && (k < total); k++)
+            {
+                frame[k] ^= (uint8_t)(1U + Fuzz_Random() % 255U);
+            }
+        }
+        else if (i & 1U)
+        { /*任意位置共 等级 个错误字节*/
+            for (uint32_t k = 0; k < level; k++)
+            {
+                frame[1U + Fuzz_Random() % (total - 1U)] ^= (uint8_t)(1U + Fuzz_Random() % 255U);
+            }
+        }
+        else
+        {
+            for (uint32_t k = Fuzz_Random() % 16U; k > 0; k--)
+            {
+                frame[1U + Fuzz_Random() % (total - 1U)] ^= (uint8_t)Fuzz_Random();
+            }
+        }
+        Fuzz_Frame = frame;
+        Fuzz_Length = total;
+        if ((mdFecDecode(frame, total, &corrected) != length) || memcmp(frame, orig, length))
+        {
+            if (i & 1U)
+            {
+                Fuzz_Fail("fec correctable frame not restored");
+            }
+        }
+        else
+        {
+            Stats[FUZZ_FEC].Replies++;
+        }
+        Stats[FUZZ_FEC].Ns += Fuzz_Ns() - n0;
+        Stats[FUZZ_FEC].Frames++;
+        Stats[FUZZ_FEC].Bytes += total;
+    }
+    Fuzz_Frame = NULL;
+}
+
+static void Fuzz_Usage(const char *name)
+{
+    printf("usage: %s [-i iterations] [-m stream_bytes] [-s seed]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = 1000000U, stream = 16U * 1024U * 1024U;
+    uint8_t frame[FUZZ_FRAME_MAX];
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    ModbusRTUSlaveHandler *pHandler = &Slave;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:m:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i':
+            iterations = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            stream = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            Seed = (uint32_t)strtoul(optarg, NULL, 0);
+            Seed = Seed ? Seed : 1U;
+            break;
+        default:
+            Fuzz_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    printf("seed = %u, iterations = %u, stream = %u bytes\n", Seed, iterations, stream);
+    Host_Transmit = Fuzz_Transmit;
+    ModbusInit(&Master_Object);
+    info.slaveId = FUZZ_SLAVE_ID;
+    info.usartBaudRate = BUAD_RATE;
+    info.mdRTUPopChar = Fuzz_Slave_Pop;
+    if ((Master_Object == NULL) || (Client_Object == NULL) || !mdCreateModbusRTUSlave(pHandler, info) ||
+        !mdRTURegisterFile(FUZZ_FILE, Fuzz_File_Read, Fuzz_File_Write))
+    {
+        printf("modbus init failed\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        if (i & 1U)
+        {
+            Fuzz_Slave_Feed(FUZZ_MUTATE, frame, Fuzz_Mutate(frame));
+            continue;
+        }
+        uint32_t length = Fuzz_Random() % FUZZ_FRAME_MAX;
+        for (uint32_t k = 0; k < length; k++)
+        {
+            frame[k] = (uint8_t)Fuzz_Random();
+        }
+        if (length >= 4U)
+        {
+            frame[0] = (Fuzz_Random() & 1U) ? FUZZ_SLAVE_ID : frame[0];
+            if (Fuzz_Random() & 1U)
+            {
+                Fuzz_Seal(frame, length);
+            }
+        }
+        Fuzz_Slave_Feed(FUZZ_RANDOM, frame, length);
+    }
+    Fuzz_Stream(stream);
+    Fuzz_Fec(iterations / 4U);
+
+    for (uint32_t k = 0; k < FUZZ_KINDS; k++)
+    {
+        const Fuzz_Stats *pS = &Stats[k];
+        printf("%-7s inputs = %-9llu replies = %-8llu %8.0f inputs/s %7.2f MB/s %6.0f ns/input\n", pS->Name,
+               (unsigned long long)pS->Frames, (unsigned long long)pS->Replies,
+               pS->Ns ? pS->Frames * 1e9 / pS->Ns : 0.0, pS->Ns ? pS->Bytes * 1e3 / pS->Ns : 0.0,
+               pS->Frames ? (double)pS->Ns / pS->Frames : 0.0);
+    }
+    printf("slave: rx errors = %lu/%lu/%lu/%lu/%lu, tx dropped = %lu\n", (unsigned long)Slave->errorCodes[ERROR1],
+           (unsigned long)Slave->errorCodes[ERROR2], (unsigned long)Slave->errorCodes[ERROR3],
+           (unsigned long)Slave->errorCodes[ERROR4], (unsigned long)Slave->errorCodes[ERROR5],
+           (unsigned long)Slave->txDropped);
+    printf("master: rx = %lu, unknown = %lu, completed = %lu, errors = %lu, timeouts = %lu\n",
+           (unsigned long)Master_Object->rxFrames, (unsigned long)Client_Object->unknown,
+           (unsigned long)Client_Object->completed, (unsigned long)Client_Object->errors,
+           (unsigned long)Client_Object->timeouts);
+    printf("violations = %u\n", Violations);
+
+    return Violations ? 1 : 0;
+}
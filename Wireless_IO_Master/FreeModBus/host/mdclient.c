@@ -0,0 +1,615 @@
+/*串口波特率常量(B57600及以上)及 writev 不在POSIX基本集中*/
+#define _DEFAULT_SOURCE
+#include "mdclient.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "mdcrc16.h"
+
+/**
+ * @brief	当前时刻
+ * @param	None
+ * @retval	单调时钟(us)
+ */
+uint64_t Mdc_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+static Mdc_Request *Mdc_At(Mdc_Handle *pH, uint32_t Index)
+{
+    return &pH->Queue[Index % MDC_BACKLOG];
+}
+
+/**
+ * @brief	挂接已打开的描述符
+ * @details	描述符须可读写；窗口及超时恢复默认，不带前缀
+ * @param	pH 客户端
+ * @param	Fd 描述符(串口、伪终端或套接字)
+ * @param	Baud 线路速率(bps)，0:不估算帧的发送时间
+ * @retval	None
+ */
+void Mdc_Attach(Mdc_Handle *pH, int Fd, uint32_t Baud)
+{
+    memset(pH, 0, sizeof(*pH));
+    pH->Fd = Fd;
+    pH->Baud = Baud;
+    pH->Window = MDC_WINDOW_DEFAULT;
+    pH->Gap_Us = MDC_FRAME_GAP_US;
+}
+
+/**
+ * @brief	打开串口
+ * @details	原始模式8N1，无流控；以非阻塞方式读写
+ * @param	pH 客户端
+ * @param	pDevice 设备路径
+ * @param	Baud 波特率
+ * @retval	0 成功 -1 打开失败或波特率不支持
+ */
+int Mdc_Open(Mdc_Handle *pH, const char *pDevice, uint32_t Baud)
+{
+    static const struct
+    {
+        uint32_t Baud;
+        speed_t Speed;
+    } rates[] = {{1200U, B1200},   {2400U, B2400},   {4800U, B4800},   {9600U, B9600},
+                 {19200U, B19200}, {38400U, B38400}, {57600U, B57600}, {115200U, B115200}};
+    struct termios tio;
+    speed_t speed = B0;
+    int fd;
+
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+    {
+        speed = (rates[i].Baud == Baud) ? rates[i].Speed : speed;
+    }
+    if (speed == B0)
+    {
+        return -1;
+    }
+    fd = open(pDevice, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+        tio.c_oflag &= ~OPOST;
+        tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+        tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+        tio.c_cflag |= CS8 | CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(fd, TCSANOW, &tio) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        tcflush(fd, TCIOFLUSH);
+    }
+    Mdc_Attach(pH, fd, Baud);
+    pH->Own = true;
+
+    return 0;
+}
+
+/**
+ * @brief	设置L101定点传输前缀
+ * @details	PC侧经L101模块以定点模式发送时，每帧请求前加目标节点地址及信道
+ * @param	pH 客户端
+ * @param	Addr 目标节点地址
+ * @param	Channel 目标信道
+ * @retval	None
+ */
+void Mdc_Set_Prefix(Mdc_Handle *pH, uint16_t Addr, uint8_t Channel)
+{
+    pH->Prefix[0] = (uint8_t)(Addr >> 8U);
+    pH->Prefix[1] = (uint8_t)Addr;
+    pH->Prefix[2] = Channel;
+    pH->Prefix_Length = MASTER_PREFIX_SIZE;
+}
+
+/**
+ * @brief	设置窗口
+ * @param	pH 客户端
+ * @param	Window 同时在途的请求数(1~MDC_WINDOW_MAX)，1即逐个请求
+ * @param	Full_Duplex true:滑动窗口 false:半双工按轮发出
+ * @retval	None
+ */
+void Mdc_Set_Window(Mdc_Handle *pH, uint8_t Window, bool Full_Duplex)
+{
+    pH->Window = (Window == 0U) ? 1U : ((Window > MDC_WINDOW_MAX) ? MDC_WINDOW_MAX : Window);
+    pH->Full_Duplex = Full_Duplex;
+}
+
+/**
+ * @brief	完成一个请求并回调
+ * @details	队首连续已完成的请求出队
+ * @param	pH 客户端
+ * @param	pR 请求
+ * @param	Result 结果
+ * @param	pReply 应答
+ * @param	Length 应答长度
+ * @retval	None
+ */
+static void Mdc_Complete(Mdc_Handle *pH, Mdc_Request *pR, int Result, const uint8_t *pReply, uint16_t Length)
+{
+    pR->Done = true;
+    if (pR->Sent)
+    {
+        pH->Inflight--;
+    }
+    if (pR->Callback != NULL)
+    {
+        pR->Callback(pR->Arg, Result, pReply, Length);
+    }
+    while ((pH->Head != pH->Issue) && Mdc_At(pH, pH->Head)->Done)
+    {
+        pH->Head++;
+    }
+}
+
+/**
+ * @brief	关闭客户端
+ * @details	待发及在途的请求以 MDC_RESULT_CANCEL 回调；由 Mdc_Open 打开的串口随之关闭
+ * @param	pH 客户端
+ * @retval	None
+ */
+void Mdc_Close(Mdc_Handle *pH)
+{
+    Mdc_Request *pR;
+
+    /*待发的请求视为已发出，由 Mdc_Complete 一并出队*/
+    for (; pH->Issue != pH->Tail; pH->Issue++)
+    {
+        pR = Mdc_At(pH, pH->Issue);
+        pR->Sent = true;
+        pH->Inflight++;
+    }
+    for (uint32_t i = pH->Head; i != pH->Tail; i++)
+    {
+        pR = Mdc_At(pH, i);
+        if (!pR->Done)
+        {
+            Mdc_Complete(pH, pR, MDC_RESULT_CANCEL, NULL, 0);
+        }
+    }
+    if (pH->Own && (pH->Fd >= 0))
+    {
+        close(pH->Fd);
+    }
+    pH->Fd = -1;
+    pH->Own = false;
+}
+
+/**
+ * @brief	提交一个请求
+ * @details	加上从站号及CRC后进入积压队列，由 Mdc_Poll 按窗口发出；广播请求(从站号0)发出后即完成
+ * @param	pH 客户端
+ * @param	Slave 从站号
+ * @param	pPdu 功能码及数据
+ * @param	Length PDU长度
+ * @param	Timeout 应答超时(ms)，0:MDC_TIMEOUT_DEFAULT
+ * @param	Callback 完成回调，可为 NULL
+ * @param	Arg 回调参数
+ * @retval	true 已接受 false 积压队列满或帧过长
+ */
+bool Mdc_Submit(Mdc_Handle *pH, uint8_t Slave, const uint8_t *pPdu, uint16_t Length, uint32_t Timeout,
+                Mdc_Callback Callback, void *Arg)
+{
+    Mdc_Request *pR;
+    uint16_t crc;
+
+    if ((pH->Tail - pH->Head >= MDC_BACKLOG) || (Length == 0U) || (Length + 3U > MDC_FRAME_MAX))
+    {
+        pH->Stats.Rejected++;
+        return false;
+    }
+    pR = Mdc_At(pH, pH->Tail);
+    memset(pR, 0, sizeof(*pR));
+    pR->Frame[0] = Slave;
+    memcpy(&pR->Frame[1], pPdu, Length);
+    crc = mdCrc16(pR->Frame, Length + 1U);
+    pR->Frame[Length + 1U] = (uint8_t)crc;
+    pR->Frame[Length + 2U] = (uint8_t)(crc >> 8U);
+    pR->Length = Length + 3U;
+    pR->Timeout = Timeout ? Timeout : MDC_TIMEOUT_DEFAULT;
+    pR->Callback = Callback;
+    pR->Arg = Arg;
+    pH->Tail++;
+
+    return true;
+}
+
+/**
+ * @brief	待发及在途的请求数
+ * @param	pH 客户端
+ * @retval	请求数
+ */
+uint32_t Mdc_Pending(const Mdc_Handle *pH)
+{
+    return pH->Tail - pH->Head;
+}
+
+/**
+ * @brief	整帧写出
+ * @details	前缀与帧一次写出；非阻塞描述符暂时写不进时等待可写
+ * @param	pH 客户端
+ * @param	pR 请求
+ * @retval	true 成功 false 写出错
+ */
+static bool Mdc_Write(Mdc_Handle *pH, const Mdc_Request *pR)
+{
+    struct iovec iov[2] = {{pH->Prefix, pH->Prefix_Length}, {(void *)pR->Frame, pR->Length}};
+    struct pollfd pfd = {pH->Fd, POLLOUT, 0};
+    int cnt = 2;
+    ssize_t n;
+
+    while (cnt > 0)
+    {
+        n = writev(pH->Fd, &iov[2 - cnt], cnt);
+        if (n < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EINTR))
+            {
+                return false;
+            }
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        for (; (cnt > 0) && ((size_t)n >= iov[2 - cnt].iov_len); cnt--)
+        {
+            n -= (ssize_t)iov[2 - cnt].iov_len;
+        }
+        if (cnt > 0)
+        {
+            iov[2 - cnt].iov_base = (uint8_t *)iov[2 - cnt].iov_base + n;
+            iov[2 - cnt].iov_len -= (size_t)n;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief	按窗口发出待发的请求
+ * @details	帧间保持 Gap_Us 的静默(发送时间按波特率估算)；半双工时只在没有在途请求且未收到字节时开始新的一轮
+ * @param	pH 客户端
+ * @param	Now 当前时刻(us)
+ * @param	pNext 返回下一帧可发出的时刻(us)，没有可发的请求时不改写
+ * @retval	0 正常 -1 写出错
+ */
+static int Mdc_Issue(Mdc_Handle *pH, uint64_t Now, uint64_t *pNext)
+{
+    Mdc_Request *pR;
+    uint64_t ready;
+
+    if (!pH->Full_Duplex && (pH->Inflight == 0U) && (pH->Rx_Length == 0U))
+    {
+        pH->Burst = true;
+    }
+    while ((pH->Issue != pH->Tail) && (pH->Inflight < pH->Window) && (pH->Full_Duplex || pH->Burst))
+    {
+        ready = pH->Tx_Idle + pH->Gap_Us;
+        ready = (pH->Rx_Last + pH->Gap_Us > ready) ? (pH->Rx_Last + pH->Gap_Us) : ready;
+        if (Now < ready)
+        {
+            *pNext = ready;
+            return 0;
+        }
+        pR = Mdc_At(pH, pH->Issue);
+        if (!Mdc_Write(pH, pR))
+        {
+            return -1;
+        }
+        pH->Issue++;
+        pH->Stats.Tx++;
+        pH->Inflight++;
+        pR->Sent = true;
+        pR->Deadline = Now + (uint64_t)pR->Timeout * 1000U;
+        pH->Tx_Idle = Now;
+        if (pH->Baud)
+        {
+            pH->Tx_Idle += (uint64_t)(pR->Length + pH->Prefix_Length) * DATA_BITS * 1000000U / pH->Baud;
+            pR->Deadline += pH->Tx_Idle - Now;
+        }
+        if (pR->Frame[0] == 0x00U)
+        {
+            Mdc_Complete(pH, pR, MDC_RESULT_OK, NULL, 0);
+        }
+    }
+    if (pH->Inflight >= pH->Window)
+    {
+        pH->Burst = false;
+    }
+    return 0;
+}
+
+static bool Mdc_Crc_Ok(const uint8_t *pFrame, uint16_t Length)
+{
+    return (Length >= 4U) && (mdCrc16((uint8_t *)pFrame, Length) == 0U);
+}
+
+/**
+ * @brief	确定接收缓冲区开头一帧应答的长度
+ * @details	异常应答5字节；05/06/08/15/16功能码为8字节的回显，从机工程在15功能码回显后附带
+ *			|字节数|输入线圈状态|，按CRC判断是哪一种；其余功能码按 |字节数|数据| 的格式；
+ *			都不成立时等到线路空闲，取CRC正确的最短长度(自定义格式的应答)
+ * @param	p 缓冲区
+ * @param	Count 字节数
+ * @param	Idle 线路已空闲
+ * @retval	>0 帧长度 0 等待更多字节 -1 开头的字节不是帧头
+ */
+static int Mdc_Frame_Length(const uint8_t *p, uint16_t Count, bool Idle)
+{
+    uint16_t length;
+
+    if (Count < 3U)
+    {
+        return Idle ? -1 : 0;
+    }
+    if (p[1] & 0x80U)
+    {
+        length = 5U;
+    }
+    else if ((p[1] == 5U) || (p[1] == 6U) || (p[1] == 8U) || (p[1] == 15U) || (p[1] == 16U))
+    {
+        if ((Count >= 8U) && Mdc_Crc_Ok(p, 8U))
+        {
+            return 8;
+        }
+        length = (Count >= 7U) ? (9U + p[6]) : 8U;
+    }
+    else
+    {
+        length = 5U + p[2];
+    }
+    if ((length <= MDC_FRAME_MAX) && (Count >= length) && Mdc_Crc_Ok(p, length))
+    {
+        return length;
+    }
+    if (!Idle)
+    {
+        return 0;
+    }
+    for (length = 4U; length <= Count; length++)
+    {
+        if (Mdc_Crc_Ok(p, length))
+        {
+            return length;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief	在在途请求中查找应答对应的请求
+ * @details	从站号相同、功能码相同(异常应答去掉最高位)的最早的请求
+ * @param	pH 客户端
+ * @param	Slave 从站号
+ * @param	Code 功能码
+ * @retval	请求，没有时为 NULL
+ */
+static Mdc_Request *Mdc_Match(Mdc_Handle *pH, uint8_t Slave, uint8_t Code)
+{
+    Mdc_Request *pR;
+
+    for (uint32_t i = pH->Head; i != pH->Issue; i++)
+    {
+        pR = Mdc_At(pH, i);
+        if (!pR->Done && (pR->Frame[0] == Slave) && ((Code == 0xFFU) || (pR->Frame[1] == (Code & 0x7FU))))
+        {
+            return pR;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief	从接收缓冲区中取出应答
+ * @details	开头的字节不是任何在途请求的从站号时逐字节丢弃，重新同步
+ * @param	pH 客户端
+ * @param	Idle 线路已空闲
+ * @retval	完成的请求数
+ */
+static int Mdc_Parse(Mdc_Handle *pH, bool Idle)
+{
+    uint8_t frame[MDC_FRAME_MAX];
+    Mdc_Request *pR;
+    int length, done = 0;
+
+    while (pH->Rx_Length > 0U)
+    {
+        length = (Mdc_Match(pH, pH->Rx[0], 0xFFU) != NULL) ? Mdc_Frame_Length(pH->Rx, pH->Rx_Length, Idle) : -1;
+        if (length == 0)
+        {
+            break;
+        }
+        if (length < 0)
+        {
+            length = 1;
+            pH->Stats.Dropped++;
+        }
+        else
+        {
+            /*回调中可能提交新的请求，应答先移出接收缓冲区*/
+            memcpy(frame, pH->Rx, (size_t)length);
+            pR = Mdc_Match(pH, frame[0], frame[1]);
+            pH->Stats.Rx++;
+            if (pR != NULL)
+            {
+                done++;
+                memmove(pH->Rx, &pH->Rx[length], pH->Rx_Length - (uint16_t)length);
+                pH->Rx_Length -= (uint16_t)length;
+                Mdc_Complete(pH, pR, MDC_RESULT_OK, frame, (uint16_t)length);
+                continue;
+            }
+            pH->Stats.Stray++;
+        }
+        memmove(pH->Rx, &pH->Rx[length], pH->Rx_Length - (uint16_t)length);
+        pH->Rx_Length -= (uint16_t)length;
+    }
+    return done;
+}
+
+/**
+ * @brief	处理超时的在途请求
+ * @param	pH 客户端
+ * @param	Now 当前时刻(us)
+ * @param	pNext 返回最近的应答期限(us)
+ * @retval	超时的请求数
+ */
+static int Mdc_Expire(Mdc_Handle *pH, uint64_t Now, uint64_t *pNext)
+{
+    Mdc_Request *pR;
+    int done = 0;
+
+    for (uint32_t i = pH->Head; i != pH->Issue; i++)
+    {
+        pR = Mdc_At(pH, i);
+        if (pR->Done)
+        {
+            continue;
+        }
+        if (pR->Deadline <= Now)
+        {
+            pH->Stats.Timeout++;
+            done++;
+            Mdc_Complete(pH, pR, MDC_RESULT_TIMEOUT, NULL, 0);
+            /*出队后重新从队首检查*/
+            i = pH->Head - 1U;
+            continue;
+        }
+        *pNext = (pR->Deadline < *pNext) ? pR->Deadline : *pNext;
+    }
+    return done;
+}
+
+/**
+ * @brief	收发一次
+ * @details	发出窗口内的请求，接收并匹配应答，处理超时；有请求完成或等待 Wait 后返回。
+ *			完成回调在此调用，回调中可以提交请求，不能再调用 Mdc_Poll
+ * @param	pH 客户端
+ * @param	Wait 最长等待时间(ms)
+ * @retval	完成的请求数，-1:读写出错或对端关闭
+ */
+int Mdc_Poll(Mdc_Handle *pH, uint32_t Wait)
+{
+    struct pollfd pfd = {pH->Fd, POLLIN, 0};
+    uint64_t now = Mdc_Now(), end = now + (uint64_t)Wait * 1000U, next;
+    int done = 0, ms;
+    ssize_t n;
+
+    if (pH->Fd < 0)
+    {
+        return -1;
+    }
+    for (;;)
+    {
+        next = end;
+        if (Mdc_Issue(pH, now, &next) < 0)
+        {
+            return -1;
+        }
+        done += Mdc_Expire(pH, now, &next);
+        if (pH->Rx_Length)
+        {
+            if (now >= pH->Rx_Last + pH->Gap_Us)
+            {
+                done += Mdc_Parse(pH, true);
+                continue;
+            }
+            next = (pH->Rx_Last + pH->Gap_Us < next) ? (pH->Rx_Last + pH->Gap_Us) : next;
+        }
+        if (done || (now >= end))
+        {
+            return done;
+        }
+        ms = (int)((next > now) ? ((next - now + 999U) / 1000U) : 0U);
+        if (poll(&pfd, 1, ms) > 0)
+        {
+            n = read(pH->Fd, &pH->Rx[pH->Rx_Length], sizeof(pH->Rx) - pH->Rx_Length);
+            if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EINTR)))
+            {
+                return -1;
+            }
+            now = Mdc_Now();
+            if (n > 0)
+            {
+                pH->Rx_Length += (uint16_t)n;
+                pH->Rx_Last = now;
+                pH->Burst = false;
+                done += Mdc_Parse(pH, false);
+                /*缓冲区满仍不成帧时丢弃最旧的字节*/
+                if (pH->Rx_Length == sizeof(pH->Rx))
+                {
+                    done += Mdc_Parse(pH, true);
+                }
+            }
+            continue;
+        }
+        now = Mdc_Now();
+    }
+}
+
+/*同步请求的结果*/
+typedef struct
+{
+    bool Done;
+    int Result;
+    uint8_t *pReply;
+    uint16_t Size, Length;
+} Mdc_Sync;
+
+static void Mdc_Sync_Done(void *Arg, int Result, const uint8_t *pReply, uint16_t Length)
+{
+    Mdc_Sync *pS = (Mdc_Sync *)Arg;
+
+    pS->Done = true;
+    pS->Result = Result;
+    pS->Length = (Length < pS->Size) ? Length : pS->Size;
+    if (pReply != NULL)
+    {
+        memcpy(pS->pReply, pReply, pS->Length);
+    }
+}
+
+/**
+ * @brief	同步请求
+ * @details	排在已提交的请求之后发出，等待期间其他请求照常完成及回调
+ * @param	pH 客户端
+ * @param	Slave 从站号
+ * @param	pPdu 功能码及数据
+ * @param	Length PDU长度
+ * @param	pReply 应答缓冲区(含从站号及CRC)
+ * @param	Size 缓冲区字节数
+ * @param	Timeout 应答超时(ms)，0:MDC_TIMEOUT_DEFAULT
+ * @retval	应答长度，-1:提交失败或链路出错 -2:超时
+ */
+int Mdc_Transact(Mdc_Handle *pH, uint8_t Slave, const uint8_t *pPdu, uint16_t Length, uint8_t *pReply,
+                 uint16_t Size, uint32_t Timeout)
+{
+    Mdc_Sync sync = {false, MDC_RESULT_CANCEL, pReply, Size, 0};
+
+    if (!Mdc_Submit(pH, Slave, pPdu, Length, Timeout, Mdc_Sync_Done, &sync))
+    {
+        return -1;
+    }
+    while (!sync.Done)
+    {
+        if (Mdc_Poll(pH, 100U) < 0)
+        {
+            Mdc_Close(pH);
+        }
+    }
+    return (sync.Result == MDC_RESULT_OK) ? sync.Length : ((sync.Result == MDC_RESULT_TIMEOUT) ? -2 : -1);
+}
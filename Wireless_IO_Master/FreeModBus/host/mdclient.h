@@ -0,0 +1,109 @@
+#ifndef __MDCLIENT_H__
+#define __MDCLIENT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include "mdconfig.h"
+
+/*主机侧Modbus RTU客户端(mdclient.c):经串口(或任意字节流描述符)访问主站网关的本机从站及其转发的远端从站。
+  请求按提交顺序发出，同时在途的请求数不超过窗口:网关按帧槽(GATEWAY_SLOTS = MASTER_MAX_PIPELINE)接收请求，
+  帧槽用尽时丢弃请求，故默认窗口取该值；应答按从站号及功能码匹配最早的在途请求(不同从站的应答可能乱序到达)。
+  RS-485为半双工:默认在没有在途请求时才开始新的一轮，一轮内连续发出至多一个窗口的请求，收到任何字节即结束本轮，
+  请求不会与网关的应答在线上相撞(网关的本机从站在请求结束后立即应答，只有转发的请求能在一轮内重叠)；
+  经全双工链路(如PC侧的L101模块)访问时可改为滑动窗口*/
+/*默认窗口及窗口上限*/
+#define MDC_WINDOW_DEFAULT MASTER_MAX_PIPELINE
+#define MDC_WINDOW_MAX 8U
+/*待发及在途请求的总数(积压队列)*/
+#define MDC_BACKLOG 64U
+/*RTU帧最大长度(从站号+PDU+CRC，与网关帧槽一致)*/
+#define MDC_FRAME_MAX MODBUS_PDU_SIZE_MAX
+/*相邻两帧请求之间的最小静默时间(us):网关以字节间隔超过 GATEWAY_FRAME_GAP(4ms) 作为帧结束*/
+#define MDC_FRAME_GAP_US 5000U
+/*默认应答超时(ms):长于网关的转发超时(GATEWAY_TIMEOUT)，超时的转发请求先收到网关的目标无响应异常*/
+#define MDC_TIMEOUT_DEFAULT 1500U
+
+/*请求结果:收到应答(含异常应答，由功能码最高位区分)、超时、链路关闭或出错时取消*/
+#define MDC_RESULT_OK 0
+#define MDC_RESULT_TIMEOUT 1
+#define MDC_RESULT_CANCEL 2
+
+    /*完成回调:在 Mdc_Poll 中调用，pReply 为应答RTU帧(含从站号及CRC，回调返回后失效)，未收到应答时为 NULL*/
+    typedef void (*Mdc_Callback)(void *Arg, int Result, const uint8_t *pReply, uint16_t Length);
+
+    typedef struct
+    {
+        uint8_t Frame[MDC_FRAME_MAX];
+        uint16_t Length;
+        uint32_t Timeout;
+        /*应答期限(单调时钟us)，发出后有效*/
+        uint64_t Deadline;
+        bool Sent;
+        bool Done;
+        Mdc_Callback Callback;
+        void *Arg;
+    } Mdc_Request;
+
+    /*自由计数的统计*/
+    typedef struct
+    {
+        uint32_t Tx;
+        uint32_t Rx;
+        uint32_t Timeout;
+        /*与在途请求都不匹配的应答(多为超时后迟到的应答)*/
+        uint32_t Stray;
+        /*重新同步时丢弃的字节*/
+        uint32_t Dropped;
+        /*积压队列满时拒绝的请求*/
+        uint32_t Rejected;
+    } Mdc_Stats;
+
+    typedef struct
+    {
+        int Fd;
+        /*描述符由 Mdc_Open 打开，Mdc_Close 时关闭*/
+        bool Own;
+        /*线路速率(bps)，用于估算帧的发送时间，0:不估算*/
+        uint32_t Baud;
+        /*L101定点传输前缀(目标地址高、低字节及信道)，只加在请求前，应答由模块去掉前缀后输出*/
+        uint8_t Prefix[MASTER_PREFIX_SIZE];
+        uint8_t Prefix_Length;
+        uint8_t Window;
+        bool Full_Duplex;
+        /*半双工时本轮仍可发出请求*/
+        bool Burst;
+        uint32_t Gap_Us;
+        /*线路空闲(上一帧请求发完)的时刻及最近收到字节的时刻(us)*/
+        uint64_t Tx_Idle;
+        uint64_t Rx_Last;
+        /*积压队列:[Head, Tail) 依次为在途及待发的请求，Issue 为下一个待发的请求*/
+        Mdc_Request Queue[MDC_BACKLOG];
+        uint32_t Head, Issue, Tail;
+        uint32_t Inflight;
+        uint8_t Rx[2U * MDC_FRAME_MAX];
+        uint16_t Rx_Length;
+        Mdc_Stats Stats;
+    } Mdc_Handle;
+
+    extern void Mdc_Attach(Mdc_Handle *pH, int Fd, uint32_t Baud);
+    extern int Mdc_Open(Mdc_Handle *pH, const char *pDevice, uint32_t Baud);
+    extern void Mdc_Close(Mdc_Handle *pH);
+    extern void Mdc_Set_Prefix(Mdc_Handle *pH, uint16_t Addr, uint8_t Channel);
+    extern void Mdc_Set_Window(Mdc_Handle *pH, uint8_t Window, bool Full_Duplex);
+    extern bool Mdc_Submit(Mdc_Handle *pH, uint8_t Slave, const uint8_t *pPdu, uint16_t Length, uint32_t Timeout,
+                           Mdc_Callback Callback, void *Arg);
+    extern uint32_t Mdc_Pending(const Mdc_Handle *pH);
+    extern int Mdc_Poll(Mdc_Handle *pH, uint32_t Wait);
+    extern int Mdc_Transact(Mdc_Handle *pH, uint8_t Slave, const uint8_t *pPdu, uint16_t Length, uint8_t *pReply,
+                            uint16_t Size, uint32_t Timeout);
+    extern uint64_t Mdc_Now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MDCLIENT_H__ */
@@ -0,0 +1,143 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mdbench.h"
+
+/*主机上默认轮数(目标板默认 MDBENCH_ROUNDS)*/
+#define MICRO_ROUNDS 1024U
+/*基线文件中的最大条目数及行长*/
+#define MICRO_BASELINE_MAX 64U
+#define MICRO_LINE_SIZE 128U
+
+typedef struct
+{
+    char Name[32];
+    char Workload[16];
+    double Per_Call;
+} Micro_Baseline;
+
+static Micro_Baseline Baseline[MICRO_BASELINE_MAX];
+static uint32_t Baseline_Count;
+
+static mdU32 Micro_Ns(mdVOID)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (mdU32)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+/**
+ * @brief	读取基线报告
+ * @details	格式与 mdBenchReport 的输出一致，忽略'#'开头的注释行
+ * @param	pPath 文件路径
+ * @retval	true 读取成功
+ */
+static bool Micro_Load(const char *pPath)
+{
+    char line[MICRO_LINE_SIZE];
+    unsigned long calls, total, best;
+    FILE *fp = fopen(pPath, "r");
+
+    if (fp == NULL)
+    {
+        return false;
+    }
+    while ((Baseline_Count < MICRO_BASELINE_MAX) && fgets(line, sizeof(line), fp))
+    {
+        Micro_Baseline *pB = &Baseline[Baseline_Count];
+        if ((line[0] != '#') && (sscanf(line, "%31[^,],%15[^,],%lu,%lu,%lu,%lf", pB->Name, pB->Workload, &calls, &total,
+                                        &best, &pB->Per_Call) == 6))
+        {
+            Baseline_Count++;
+        }
+    }
+    fclose(fp);
+
+    return true;
+}
+
+static const Micro_Baseline *Micro_Find(const char *pName, const char *pWorkload)
+{
+    for (uint32_t i = 0; i < Baseline_Count; i++)
+    {
+        if (!strcmp(Baseline[i].Name, pName) && !strcmp(Baseline[i].Workload, pWorkload))
+        {
+            return &Baseline[i];
+        }
+    }
+    return NULL;
+}
+
+static void Micro_Usage(const char *name)
+{
+    printf("usage: %s [-r rounds] [-b baseline.csv] [-t threshold_percent]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct mdBenchResult results[MDBENCH_CASES];
+    RegisterPoolHandle pool = NULL;
+    const char *pPath = NULL;
+    uint32_t rounds = MICRO_ROUNDS, threshold = 25U, count, regress = 0;
+    double per_call, delta;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:b:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+            rounds = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            pPath = optarg;
+            break;
+        case 't':
+            threshold = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            Micro_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if ((pPath != NULL) && !Micro_Load(pPath))
+    {
+        printf("cannot open %s\n", pPath);
+        return 2;
+    }
+    if (!mdCreateRegisterPool(&pool))
+    {
+        printf("register pool init failed\n");
+        return 1;
+    }
+    count = mdBenchRun(pool, Micro_Ns, rounds, results, MDBENCH_CASES);
+    mdBenchReport(results, count, "ns");
+    if (pPath == NULL)
+    {
+        return 0;
+    }
+    /*与基线比较:单次耗时超过基线 threshold% 记为回退*/
+    printf("# compare baseline=%s threshold=%u%%\n# case,workload,per_call,baseline,delta%%\n", pPath, threshold);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Micro_Baseline *pB = Micro_Find(results[i].name, results[i].workload);
+        per_call = (double)results[i].best / MDBENCH_CALLS;
+        if ((pB == NULL) || (pB->Per_Call <= 0.0))
+        {
+            printf("%s,%s,%.2f,-,-\n", results[i].name, results[i].workload, per_call);
+            continue;
+        }
+        delta = (per_call - pB->Per_Call) * 100.0 / pB->Per_Call;
+        printf("%s,%s,%.2f,%.2f,%+.1f%s\n", results[i].name, results[i].workload, per_call, pB->Per_Call, delta,
+               (delta > threshold) ? ",REGRESSION" : "");
+        regress += (delta > threshold) ? 1U : 0U;
+    }
+    mdDestoryRegisterPool(&pool);
+
+    return regress ? 1 : 0;
+}
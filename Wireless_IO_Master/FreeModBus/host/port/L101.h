@@ -0,0 +1,7 @@
+#ifndef __L101_H__
+#define __L101_H__
+
+/*主机仿真构建:无线调度由仿真驱动(bench.c)按 Master_Poll 的方式实现*/
+#include "main.h"
+
+#endif /* __L101_H__ */
@@ -0,0 +1,15 @@
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+/*主机仿真构建:不做分级启动，模块的初始化函数由测试程序直接调用(登记项只引用初始化函数)*/
+#define BOOT_MODULE(name, level, init, depends) \
+    static void (*const Boot_Module_##name)(void) __attribute__((unused)) = (init)
+
+/*启动标记不记录*/
+#define BOOT_MARK_LOG 0U
+static inline void Boot_Mark(unsigned char Mark)
+{
+    (void)Mark;
+}
+
+#endif /* __BOOT_H__ */
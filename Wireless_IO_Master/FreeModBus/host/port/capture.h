@@ -0,0 +1,7 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+/*主机仿真构建:回放的帧来自捕获文件，捕获点为空*/
+#define CAPTURE(dir, data, length)
+
+#endif /* __CAPTURE_H__ */
@@ -0,0 +1,11 @@
+#ifndef __CMSIS_OS_H__
+#define __CMSIS_OS_H__
+
+/*主机仿真构建:Modbus任务由仿真驱动按信号调度*/
+#include "main.h"
+
+typedef void *osThreadId;
+
+extern int32_t osSignalSet(osThreadId thread_id, int32_t signal);
+
+#endif /* __CMSIS_OS_H__ */
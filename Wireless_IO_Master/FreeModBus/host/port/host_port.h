@@ -0,0 +1,15 @@
+#ifndef __HOST_PORT_H__
+#define __HOST_PORT_H__
+
+/*主机仿真构建:端口层(port.c)的仿真状态，由仿真驱动推进及挂接*/
+#include "usart.h"
+#include "cmsis_os.h"
+
+/*仿真时钟(ms)，HAL_GetTick 返回此值*/
+extern uint32_t Host_Tick;
+/*Modbus任务收到的信号，osSignalSet 置位，由仿真驱动取走*/
+extern int32_t Host_Signal;
+/*串口发送:为 NULL 时发送段被丢弃*/
+extern bool (*Host_Transmit)(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count);
+
+#endif /* __HOST_PORT_H__ */
@@ -0,0 +1,7 @@
+#ifndef __IO_SIGNAL_H__
+#define __IO_SIGNAL_H__
+
+/*主机仿真构建:协议栈不依赖本机I/O*/
+#include "main.h"
+
+#endif /* __IO_SIGNAL_H__ */
@@ -0,0 +1,35 @@
+#ifndef __MAIN_H__
+#define __MAIN_H__
+/*目标板 main.h 的保护宏:编译目标板源文件(如 tunnel.c)时预先包含本文件，目标板 main.h 被跳过*/
+#define __MAIN_H
+
+/*主机仿真构建:替代目标板的 main.h，只提供协议栈用到的内核及HAL接口*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*主机上没有中断，临界区为空操作(仿真为单线程)*/
+static inline uint32_t __get_PRIMASK(void)
+{
+    return 0;
+}
+static inline void __disable_irq(void)
+{
+}
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+/*仿真时钟(ms)，由仿真驱动推进*/
+extern uint32_t HAL_GetTick(void);
+
+#endif /* __MAIN_H__ */
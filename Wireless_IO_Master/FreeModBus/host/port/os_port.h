@@ -0,0 +1,48 @@
+#ifndef __OS_PORT_H__
+#define __OS_PORT_H__
+
+/*主机仿真构建:替代 Common/Core/Inc/os_port.h(保护宏相同，编译共用模块时预先包含本文件)。
+  仿真为单线程且调度器从不运行，共用模块走调度器启动前的路径:不加锁，记录直接写入*/
+#include "main.h"
+
+typedef void *Os_Thread;
+typedef void *Os_Mutex;
+
+#define OS_WAIT_FOREVER 0xFFFFFFFFU
+#define Os_Running() false
+#define Os_Self() NULL
+#define Os_Critical_Enter()
+#define Os_Critical_Exit()
+
+/*共用模块中创建互斥量的CMSIS-RTOS接口，主机上不创建*/
+typedef uint32_t osStaticMutexDef_t;
+#define osWaitForever OS_WAIT_FOREVER
+#define osMutexStaticDef(name, control) (void)(control)
+#define osMutex(name) NULL
+#define osMutexCreate(def) NULL
+
+static inline int32_t osMutexWait(Os_Mutex mutex, uint32_t millisec)
+{
+    (void)mutex;
+    (void)millisec;
+    return 0;
+}
+static inline int32_t osMutexRelease(Os_Mutex mutex)
+{
+    (void)mutex;
+    return 0;
+}
+
+static inline void Os_Signal_Set(Os_Thread Thread, uint32_t Signals)
+{
+    (void)Thread;
+    (void)Signals;
+}
+static inline uint32_t Os_Signal_Wait(uint32_t Signals, uint32_t Timeout)
+{
+    (void)Signals;
+    (void)Timeout;
+    return 0;
+}
+
+#endif /* __OS_PORT_H__ */
@@ -0,0 +1,43 @@
+#include "host_port.h"
+
+UART_HandleTypeDef huart1;
+UartDma_HandleTypeDef Uart1_Dma = {.huart = &huart1};
+/*Modbus任务句柄:非空即可接收任务通知*/
+osThreadId mdbusHandle = &mdbusHandle;
+
+uint32_t Host_Tick;
+int32_t Host_Signal;
+bool (*Host_Transmit)(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count);
+
+uint32_t HAL_GetTick(void)
+{
+    return Host_Tick;
+}
+
+int32_t osSignalSet(osThreadId thread_id, int32_t signal)
+{
+    (void)thread_id;
+    Host_Signal |= signal;
+    return 0;
+}
+
+void Uart_Dma_Attach(UartDma_HandleTypeDef *huart, UartDma_RxEvent Event, UartDma_RxNotify Notify, void *Arg)
+{
+    huart->Rx.Event = Event;
+    huart->Rx.Notify = Notify;
+    huart->Rx.Arg = Arg;
+}
+
+bool Uart_Dma_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    return Host_Transmit ? Host_Transmit(huart, pSeg, Count) : false;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    return HAL_OK;
+}
@@ -0,0 +1,13 @@
+#ifndef __SHELL_PORT_H__
+#define __SHELL_PORT_H__
+
+/*主机仿真构建:shell输出重定向到标准输出*/
+#include <stdio.h>
+
+#define shellPrint(shell, ...) printf(__VA_ARGS__)
+/*主机上不导出shell命令*/
+#define SHELL_EXPORT_CMD(...)
+/*shell接收环入口，由测试程序实现*/
+extern unsigned short Shell_Rx_Push(const char *data, unsigned short len);
+
+#endif /* __SHELL_PORT_H__ */
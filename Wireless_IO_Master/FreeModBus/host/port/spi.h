@@ -0,0 +1,33 @@
+#ifndef __SPI_H__
+#define __SPI_H__
+
+/*主机仿真构建:SPI2及片选GPIO的最小接口，由测试程序实现(如 extlog_test.c 的仿真FRAM)*/
+#include "main.h"
+
+typedef struct
+{
+    uint32_t Instance;
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t Instance;
+} GPIO_TypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+extern GPIO_TypeDef Host_GpioB;
+#define GPIOB (&Host_GpioB)
+#define GPIO_PIN_12 ((uint16_t)0x1000U)
+
+extern SPI_HandleTypeDef hspi2;
+
+extern void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+extern HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+extern HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+#endif /* __SPI_H__ */
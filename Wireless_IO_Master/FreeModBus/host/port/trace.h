@@ -0,0 +1,7 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+/*主机仿真构建:耗时由仿真驱动统计，跟踪点为空*/
+#define TRACE(id)
+
+#endif /* __TRACE_H__ */
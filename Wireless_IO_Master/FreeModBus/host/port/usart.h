@@ -0,0 +1,48 @@
+#ifndef __USART_H__
+#define __USART_H__
+
+/*主机仿真构建:串口及DMA驱动的最小接口，发送段交给仿真信道，接收由仿真信道回调*/
+#include "main.h"
+
+#define UART_DMA_EVENT_HALF 0x01
+#define UART_DMA_EVENT_FULL 0x02
+#define UART_DMA_EVENT_IDLE 0x04
+
+typedef struct
+{
+    uint32_t Instance;
+} UART_HandleTypeDef;
+
+typedef struct UartDma_Handle UartDma_HandleTypeDef;
+
+typedef struct
+{
+    const uint8_t *pData;
+    uint16_t Length;
+    bool Last;
+    void (*Done)(void *Arg, bool Sent);
+    void *Arg;
+} UartDma_Segment;
+
+typedef void (*UartDma_RxEvent)(UartDma_HandleTypeDef *huart, const uint8_t *pData, uint16_t Length, uint8_t Event);
+typedef void (*UartDma_RxNotify)(UartDma_HandleTypeDef *huart, uint8_t Event);
+
+struct UartDma_Handle
+{
+    UART_HandleTypeDef *huart;
+    struct
+    {
+        UartDma_RxEvent Event;
+        UartDma_RxNotify Notify;
+        void *Arg;
+    } Rx;
+};
+
+extern UART_HandleTypeDef huart1;
+extern UartDma_HandleTypeDef Uart1_Dma;
+
+extern void Uart_Dma_Attach(UartDma_HandleTypeDef *huart, UartDma_RxEvent Event, UartDma_RxNotify Notify, void *Arg);
+extern bool Uart_Dma_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count);
+extern HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+#endif /* __USART_H__ */
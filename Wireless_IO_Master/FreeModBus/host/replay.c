@@ -0,0 +1,476 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "host_port.h"
+
+/*捕获文件中一帧的最大长度，与目标板发送缓冲区一致*/
+#define REPLAY_FRAME_MAX MODBUS_TX_BUFFER_SIZE
+/*统计应答时延的从站号数*/
+#define REPLAY_IDS 256U
+/*目标板串口发送完成中断相对启动发送的延时(ms)*/
+#define REPLAY_TX_DONE_MS 1U
+
+/*捕获文件中的一帧(capture_dump 的一行)*/
+typedef struct
+{
+    /*相对第一帧的时刻(ms)*/
+    uint32_t Tick;
+    bool Tx;
+    uint16_t Length;
+    /*透传请求:frame 之前预留前缀区，前缀就地写入(内容与捕获的前缀相同)*/
+    uint8_t Buf[MASTER_PREFIX_SIZE + REPLAY_FRAME_MAX];
+} Replay_Frame;
+
+/*回放时各从站号的统计*/
+typedef struct
+{
+    uint32_t Requests, Replies;
+    /*捕获中请求到下一个同站号应答的时延(ms)*/
+    uint32_t Rtt_Sum, Rtt_Max, Rtt_Count;
+    uint32_t Pending;
+    bool Waiting;
+} Replay_Id;
+
+typedef struct
+{
+    uint64_t Calls, Ns, Ns_Max;
+} Replay_Timing;
+
+static Replay_Frame *Frames;
+static uint32_t Frame_Count;
+static Replay_Id Ids[REPLAY_IDS];
+static uint32_t Prefix = MASTER_PREFIX_SIZE;
+static uint32_t Completed, Errors, Timeouts, Rejected, Skipped;
+/*请求实际发出时刻相对回放时刻的延迟(ms)*/
+static uint32_t Sched_Max, Sched_Count;
+static uint64_t Sched_Sum;
+static Replay_Timing Timing_Rx, Timing_Poll;
+/*等待发送完成回调的串口发送段(仿真DMA发送完成中断)*/
+static struct
+{
+    bool Pending;
+    uint32_t Due;
+    void (*Done)(void *Arg, bool Sent);
+    void *Arg;
+} Tx_Done;
+/*回放中的请求:提交时刻，供发出时统计调度延迟*/
+static uint32_t Submit_Tick[REPLAY_IDS];
+
+static uint64_t Replay_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void Replay_Record(Replay_Timing *pT, uint64_t Ns)
+{
+    pT->Calls++;
+    pT->Ns += Ns;
+    pT->Ns_Max = (Ns > pT->Ns_Max) ? Ns : pT->Ns_Max;
+}
+
+/**
+ * @brief	帧尾CRC是否正确
+ * @param	pData 从机地址+PDU+CRC
+ * @param	Length 长度
+ * @retval	true 正确
+ */
+static bool Replay_Crc_Ok(const uint8_t *pData, uint32_t Length)
+{
+    /*整帧(含CRC)的CRC为0*/
+    return (Length >= 4U) && (mdCrc16((mdU8 *)pData, Length) == 0);
+}
+
+/**
+ * @brief	读取 capture_dump 的输出
+ * @details	每行 "时刻 R|T 十六进制帧"，其余行(命令回显、提示符、capture_begin)忽略；
+ *			时刻按32位回绕换算为相对第一帧的毫秒数
+ * @param	Path 文件名
+ * @retval	true 读到至少一帧
+ */
+static bool Replay_Load(const char *Path)
+{
+    FILE *fp = fopen(Path, "r");
+    char line[2U * REPLAY_FRAME_MAX + 64U], hex[2U * REPLAY_FRAME_MAX + 2U], dir;
+    unsigned long tick;
+    uint32_t first = 0, capacity = 0;
+    bool ended = false;
+
+    if (fp == NULL)
+    {
+        perror(Path);
+        return false;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        Replay_Frame *pF;
+        size_t n;
+
+        if (strncmp(line, "capture_end", 11U) == 0)
+        {
+            ended = true;
+        }
+        if ((sscanf(line, "%lu %c %s", &tick, &dir, hex) != 3) || ((dir != 'R') && (dir != 'T')) ||
+            ((n = strlen(hex)) < 2U) || (n & 1U) || (n / 2U > REPLAY_FRAME_MAX))
+        {
+            continue;
+        }
+        if (Frame_Count == capacity)
+        {
+            capacity = capacity ? capacity * 2U : 256U;
+            Frames = realloc(Frames, capacity * sizeof(Replay_Frame));
+            if (Frames == NULL)
+            {
+                fclose(fp);
+                return false;
+            }
+        }
+        pF = &Frames[Frame_Count];
+        first = Frame_Count ? first : (uint32_t)tick;
+        pF->Tick = (uint32_t)tick - first;
+        pF->Tx = (dir == 'T');
+        pF->Length = (uint16_t)(n / 2U);
+        for (size_t i = 0; i < pF->Length; i++)
+        {
+            unsigned int byte;
+            if (sscanf(&hex[i * 2U], "%2x", &byte) != 1)
+            {
+                break;
+            }
+            pF->Buf[MASTER_PREFIX_SIZE + i] = (uint8_t)byte;
+        }
+        Frame_Count++;
+    }
+    fclose(fp);
+    if (!ended)
+    {
+        printf("warning: no capture_end, the dump may be truncated\n");
+    }
+    return Frame_Count != 0;
+}
+
+/**
+ * @brief	取得请求帧中前缀之后的ADU
+ * @details	按 -p 给出的前缀长度取ADU，CRC不符时再按无前缀(透明传输)尝试
+ * @param	pF 帧
+ * @param	pPrefix 前缀长度
+ * @retval	ADU，不是Modbus请求时返回 NULL
+ */
+static uint8_t *Replay_Adu(Replay_Frame *pF, uint32_t *pPrefix)
+{
+    uint8_t *data = &pF->Buf[MASTER_PREFIX_SIZE];
+
+    if ((pF->Length > Prefix) && Replay_Crc_Ok(&data[Prefix], pF->Length - Prefix))
+    {
+        *pPrefix = Prefix;
+        return &data[Prefix];
+    }
+    if (Replay_Crc_Ok(data, pF->Length))
+    {
+        *pPrefix = 0;
+        return data;
+    }
+    return NULL;
+}
+
+/**
+ * @brief	统计捕获中的流量
+ * @details	各从站号的请求、应答数，及请求到下一个同站号应答的时延
+ * @param	None
+ * @retval	None
+ */
+static void Replay_Profile(void)
+{
+    uint32_t tx = 0, rx = 0, tx_bytes = 0, rx_bytes = 0, prefix, duration;
+    uint32_t last[REPLAY_IDS] = {0};
+
+    for (uint32_t i = 0; i < Frame_Count; i++)
+    {
+        Replay_Frame *pF = &Frames[i];
+        uint8_t *adu;
+
+        if (pF->Tx)
+        {
+            tx++;
+            tx_bytes += pF->Length;
+            adu = Replay_Adu(pF, &prefix);
+            if (adu != NULL)
+            {
+                Ids[adu[0]].Requests++;
+                Ids[adu[0]].Waiting = true;
+                last[adu[0]] = pF->Tick;
+            }
+            continue;
+        }
+        rx++;
+        rx_bytes += pF->Length;
+        if (pF->Length >= 4U)
+        {
+            Replay_Id *pI = &Ids[pF->Buf[MASTER_PREFIX_SIZE]];
+            pI->Replies++;
+            if (pI->Waiting)
+            {
+                uint32_t rtt = pF->Tick - last[pF->Buf[MASTER_PREFIX_SIZE]];
+                pI->Waiting = false;
+                pI->Rtt_Sum += rtt;
+                pI->Rtt_Count++;
+                pI->Rtt_Max = (rtt > pI->Rtt_Max) ? rtt : pI->Rtt_Max;
+            }
+        }
+    }
+    duration = Frames[Frame_Count - 1U].Tick;
+    printf("capture: frames = %u, duration = %u ms, tx = %u (%u bytes), rx = %u (%u bytes), %.2f frames/s\n",
+           Frame_Count, duration, tx, tx_bytes, rx, rx_bytes, duration ? Frame_Count * 1000.0 / duration : 0.0);
+    for (uint32_t id = 0; id < REPLAY_IDS; id++)
+    {
+        Replay_Id *pI = &Ids[id];
+        if (pI->Requests || pI->Replies)
+        {
+            printf("id %3u: requests = %u, replies = %u, rtt avg = %.1f ms, max = %u ms\n", id, pI->Requests,
+                   pI->Replies, pI->Rtt_Count ? (double)pI->Rtt_Sum / pI->Rtt_Count : 0.0, pI->Rtt_Max);
+        }
+    }
+}
+
+/**
+ * @brief	主站串口发送
+ * @details	发出的请求不再送往从站(应答来自捕获)，只统计相对回放时刻的调度延迟；发送完成回调延后到下一节拍
+ * @param	huart 驱动句柄
+ * @param	pSeg 发送段
+ * @param	Count 段数
+ * @retval	true 已接受
+ */
+static bool Replay_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    const uint8_t *data = pSeg[0].pData;
+
+    (void)huart;
+    if (Tx_Done.Pending)
+    {
+        return false;
+    }
+    if (pSeg[0].Length > Prefix)
+    {
+        uint32_t wait = Host_Tick - Submit_Tick[data[Prefix]];
+        Sched_Max = (wait > Sched_Max) ? wait : Sched_Max;
+        Sched_Sum += wait;
+        Sched_Count++;
+    }
+    Tx_Done.Pending = true;
+    Tx_Done.Due = Host_Tick + REPLAY_TX_DONE_MS;
+    Tx_Done.Done = pSeg[Count - 1U].Done;
+    Tx_Done.Arg = pSeg[Count - 1U].Arg;
+
+    return true;
+}
+
+static mdBOOL Replay_Ready(ModbusRTUMasterHandler handler)
+{
+    (void)handler;
+    return Tx_Done.Pending ? mdFALSE : mdTRUE;
+}
+
+static void Replay_Request_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    Ids[request->slaveId].Pending--;
+    switch (result)
+    {
+    case MASTER_RESULT_OK:
+        Completed++;
+        break;
+    case MASTER_RESULT_TIMEOUT:
+        Timeouts++;
+        break;
+    default:
+        Errors++;
+        break;
+    }
+}
+
+/**
+ * @brief	在回放时刻提交一帧捕获的请求
+ * @details	作为透传请求提交，由请求引擎按当前构建的调度发出并匹配捕获中的应答；
+ *			业务类别在捕获中不可知，均按诊断类提交
+ * @param	pF 帧
+ * @param	Timeout 应答超时(ms)
+ * @retval	None
+ */
+static void Replay_Submit(Replay_Frame *pF, uint32_t Timeout)
+{
+    struct ModbusRTURequest request;
+    uint32_t prefix;
+    uint8_t *adu = Replay_Adu(pF, &prefix);
+
+    if (adu == NULL)
+    {
+        Skipped++;
+        return;
+    }
+    memset(&request, 0, sizeof(request));
+    memcpy(request.prefix, &pF->Buf[MASTER_PREFIX_SIZE], prefix);
+    request.prefixLength = (mdU8)prefix;
+    request.slaveId = adu[0];
+    request.code = adu[1];
+    request.frame = adu;
+    request.frameLength = (mdU16)(pF->Length - prefix);
+    request.timeout = Timeout;
+    request.callback = Replay_Request_Done;
+    if (mdRTU_Submit(Client_Object, &request))
+    {
+        Ids[adu[0]].Pending++;
+        Submit_Tick[adu[0]] = Host_Tick;
+    }
+    else
+    {
+        Rejected++;
+    }
+}
+
+/**
+ * @brief	应答到达主站
+ * @details	与目标板一致:串口空闲时提交一帧并通知Modbus任务
+ * @param	pF 帧
+ * @retval	None
+ */
+static void Replay_Deliver(Replay_Frame *pF)
+{
+    if (Uart1_Dma.Rx.Event)
+    {
+        Uart1_Dma.Rx.Event(&Uart1_Dma, &pF->Buf[MASTER_PREFIX_SIZE], pF->Length, UART_DMA_EVENT_IDLE);
+    }
+    if (Uart1_Dma.Rx.Notify)
+    {
+        Uart1_Dma.Rx.Notify(&Uart1_Dma, UART_DMA_EVENT_IDLE);
+    }
+}
+
+static void Replay_Print_Timing(const char *Name, const Replay_Timing *pT)
+{
+    printf("%-14s calls = %-8llu avg = %6llu ns, max = %8llu ns\n", Name, (unsigned long long)pT->Calls,
+           (unsigned long long)(pT->Calls ? pT->Ns / pT->Calls : 0), (unsigned long long)pT->Ns_Max);
+}
+
+static void Replay_Usage(const char *name)
+{
+    printf("usage: %s [-x speed] [-n loops] [-p prefix_bytes] [-t timeout_ms] [-q] capture.txt\n", name);
+    printf("  -t  reply timeout of the replayed requests, 300 ms by default (the capture does not record it)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t loops = 1U, timeout = 300U, next = 0, loop = 0, span, end;
+    double speed = 1.0;
+    bool quiet = false;
+    uint64_t n0, wall;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "x:n:p:t:qh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'x':
+            speed = strtod(optarg, NULL);
+            break;
+        case 'n':
+            loops = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            Prefix = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            timeout = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            Replay_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if ((optind >= argc) || (speed <= 0.0) || (loops == 0) || (Prefix > MASTER_PREFIX_SIZE) || (timeout == 0))
+    {
+        Replay_Usage(argv[0]);
+        return 2;
+    }
+    if (!Replay_Load(argv[optind]))
+    {
+        printf("%s: no frames\n", argv[optind]);
+        return 1;
+    }
+    if (!quiet)
+    {
+        Replay_Profile();
+    }
+    Host_Transmit = Replay_Transmit;
+    ModbusInit(&Master_Object);
+    if ((Master_Object == NULL) || (Client_Object == NULL))
+    {
+        printf("modbus init failed\n");
+        return 1;
+    }
+    Client_Object->mdRTUMasterReady = Replay_Ready;
+
+    /*按 -x 压缩时间轴(应答超时不变)；每轮之间留出一个应答超时，上一轮的请求全部结束后再开始*/
+    span = (uint32_t)(Frames[Frame_Count - 1U].Tick / speed) + timeout + 1U;
+    end = loops * span;
+    for (Host_Tick = 1U; Host_Tick <= end; Host_Tick++)
+    {
+        if (Tx_Done.Pending && ((int32_t)(Host_Tick - Tx_Done.Due) >= 0))
+        {
+            Tx_Done.Pending = false;
+            Tx_Done.Done(Tx_Done.Arg, true);
+        }
+        while ((loop < loops) && (loop * span + 1U + (uint32_t)(Frames[next].Tick / speed) <= Host_Tick))
+        {
+            if (Frames[next].Tx)
+            {
+                Replay_Submit(&Frames[next], timeout);
+            }
+            else
+            {
+                Replay_Deliver(&Frames[next]);
+            }
+            if (++next == Frame_Count)
+            {
+                next = 0;
+                loop++;
+            }
+        }
+        if (Host_Signal & MODBUS_SIGNAL_RX)
+        {
+            Host_Signal &= ~MODBUS_SIGNAL_RX;
+            n0 = Replay_Ns();
+            mdRTU_Handler(Master_Object);
+            Replay_Record(&Timing_Rx, Replay_Ns() - n0);
+        }
+        n0 = Replay_Ns();
+        mdRTU_Poll(Client_Object, Host_Tick);
+        Replay_Record(&Timing_Poll, Replay_Ns() - n0);
+    }
+    wall = Timing_Rx.Ns + Timing_Poll.Ns;
+
+    printf("replay: speed = %.2fx, loops = %u, timeout = %u ms, simulated = %u ms\n", speed, loops, timeout, end);
+    printf("requests: completed = %u, errors = %u, timeouts = %u, rejected = %u, skipped = %u\n", Completed, Errors,
+           Timeouts, Rejected, Skipped);
+    printf("master: tx = %lu, tx dropped = %lu, rx = %lu, unknown = %lu, drops = %lu, crc errors = %lu\n",
+           (unsigned long)Master_Object->txFrames, (unsigned long)Master_Object->txDropped,
+           (unsigned long)Master_Object->rxFrames, (unsigned long)Client_Object->unknown,
+           (unsigned long)Client_Object->drops, (unsigned long)Master_Object->errorCodes[ERROR3]);
+    printf("scheduling delay: avg = %.2f ms, max = %u ms\n", Sched_Count ? (double)Sched_Sum / Sched_Count : 0.0,
+           Sched_Max);
+    Replay_Print_Timing("mdRTU_Handler", &Timing_Rx);
+    Replay_Print_Timing("mdRTU_Poll", &Timing_Poll);
+    printf("host: %.0f frames/s through the stack\n",
+           wall ? (Master_Object->rxFrames + Master_Object->txFrames) * 1e9 / wall : 0.0);
+
+    /*没有任何请求完成时返回错误，供CI判断*/
+    return Completed ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include "sim_channel.h"
+#include <string.h>
+
+/**
+ * @brief	初始化仿真信道
+ * @param	pC 信道
+ * @param	Base 固定时延(ms)
+ * @param	Jitter 随机抖动上限(ms)
+ * @param	Bitrate 空中速率(bps)
+ * @param	Loss 丢帧率(千分比)
+ * @param	Seed 随机数种子
+ * @retval	None
+ */
+void Sim_Channel_Init(Sim_Channel *pC, uint32_t Base, uint32_t Jitter, uint32_t Bitrate, uint16_t Loss, uint32_t Seed)
+{
+    memset(pC, 0, sizeof(*pC));
+    pC->Base = Base;
+    pC->Jitter = Jitter;
+    pC->Bitrate = Bitrate ? Bitrate : 1U;
+    pC->Loss = Loss;
+    pC->Seed = Seed ? Seed : 1U;
+}
+
+/**
+ * @brief	取得伪随机数
+ * @details	xorshift32，与平台的 rand() 无关，保证不同主机上结果一致
+ * @param	pC 信道
+ * @retval	随机数
+ */
+uint32_t Sim_Channel_Random(Sim_Channel *pC)
+{
+    uint32_t x = pC->Seed;
+
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    pC->Seed = x;
+
+    return x;
+}
+
+/**
+ * @brief	向信道发送一帧
+ * @details	帧在空口空闲后开始发送；丢失的帧同样占用空口时间
+ * @param	pC 信道
+ * @param	Now 当前时刻(ms)
+ * @param	pData 数据
+ * @param	Length 长度
+ * @param	Deliver 到达回调
+ * @param	Arg 回调参数
+ * @retval	true 已发送(可能在途中丢失) false 在途帧过多或帧过长
+ */
+bool Sim_Channel_Send(Sim_Channel *pC, uint32_t Now, const uint8_t *pData, uint16_t Length, Sim_Deliver Deliver, void *Arg)
+{
+    Sim_Frame *pF = NULL;
+    uint32_t start = ((int32_t)(pC->Busy - Now) > 0) ? pC->Busy : Now;
+    uint32_t air = (Length * 8U * 1000U + pC->Bitrate - 1U) / pC->Bitrate;
+
+    for (uint32_t i = 0; i < SIM_CHANNEL_FRAMES; i++)
+    {
+        if (!pC->Frames[i].Used)
+        {
+            pF = &pC->Frames[i];
+            break;
+        }
+    }
+    if ((pF == NULL) || (Length > SIM_FRAME_SIZE))
+    {
+        pC->Overrun++;
+        return false;
+    }
+    pC->Busy = start + air;
+    pC->Sent++;
+    if ((Sim_Channel_Random(pC) % 1000U) < pC->Loss)
+    {
+        pC->Lost++;
+        return true;
+    }
+    pF->Used = true;
+    pF->Due = start + air + pC->Base + (pC->Jitter ? Sim_Channel_Random(pC) % (pC->Jitter + 1U) : 0);
+    pF->Length = Length;
+    pF->Deliver = Deliver;
+    pF->Arg = Arg;
+    memcpy(pF->Buf, pData, Length);
+
+    return true;
+}
+
+/**
+ * @brief	投递到达的帧
+ * @details	回调中可以继续发送(如从站应答)，新帧最早在下一次调用时到达
+ * @param	pC 信道
+ * @param	Now 当前时刻(ms)
+ * @retval	本次投递的帧数
+ */
+uint32_t Sim_Channel_Poll(Sim_Channel *pC, uint32_t Now)
+{
+    uint32_t count = 0;
+    Sim_Frame frame;
+
+    for (uint32_t i = 0; i < SIM_CHANNEL_FRAMES; i++)
+    {
+        if (pC->Frames[i].Used && ((int32_t)(Now - pC->Frames[i].Due) >= 0))
+        {
+            /*先释放再回调，回调中发送的帧可以复用该项*/
+            frame = pC->Frames[i];
+            pC->Frames[i].Used = false;
+            frame.Deliver(frame.Arg, frame.Buf, frame.Length);
+            count++;
+        }
+    }
+
+    return count;
+}
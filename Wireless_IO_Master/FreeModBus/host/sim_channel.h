@@ -0,0 +1,57 @@
+#ifndef __SIM_CHANNEL_H__
+#define __SIM_CHANNEL_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+
+/*信道上同时在途的最大帧数及单帧最大长度*/
+#define SIM_CHANNEL_FRAMES 32U
+#define SIM_FRAME_SIZE 256U
+
+    /*帧到达回调:在 Sim_Channel_Poll 中调用*/
+    typedef void (*Sim_Deliver)(void *Arg, const uint8_t *pData, uint16_t Length);
+
+    typedef struct
+    {
+        /*到达时刻(ms)*/
+        uint32_t Due;
+        bool Used;
+        uint16_t Length;
+        Sim_Deliver Deliver;
+        void *Arg;
+        uint8_t Buf[SIM_FRAME_SIZE];
+    } Sim_Frame;
+
+    /*仿真LoRa信道:半双工，帧按发送顺序依次占用空口；
+      到达时延 = 排队 + 空口时间(字节数/空中速率) + 固定时延(唤醒码、前导码及模块转发) + 随机抖动*/
+    typedef struct
+    {
+        uint32_t Base;
+        uint32_t Jitter;
+        /*空中速率(bps)*/
+        uint32_t Bitrate;
+        /*丢帧率(千分比)*/
+        uint16_t Loss;
+        /*伪随机数状态，相同种子得到相同的仿真结果*/
+        uint32_t Seed;
+        /*空口被占用到此时刻(ms)*/
+        uint32_t Busy;
+        Sim_Frame Frames[SIM_CHANNEL_FRAMES];
+        /*统计:发送、丢失及因在途帧过多被丢弃的帧*/
+        uint32_t Sent, Lost, Overrun;
+    } Sim_Channel;
+
+    extern void Sim_Channel_Init(Sim_Channel *pC, uint32_t Base, uint32_t Jitter, uint32_t Bitrate, uint16_t Loss, uint32_t Seed);
+    extern uint32_t Sim_Channel_Random(Sim_Channel *pC);
+    extern bool Sim_Channel_Send(Sim_Channel *pC, uint32_t Now, const uint8_t *pData, uint16_t Length, Sim_Deliver Deliver, void *Arg);
+    extern uint32_t Sim_Channel_Poll(Sim_Channel *pC, uint32_t Now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_CHANNEL_H__ */
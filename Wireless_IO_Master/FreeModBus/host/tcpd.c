@@ -0,0 +1,371 @@
+/*SO_REUSEADDR 及 getaddrinfo 等不在POSIX基本集中*/
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "mdclient.h"
+
+/*Modbus TCP网关:多个SCADA客户端的请求(MBAP头+PDU)转成RTU帧，经 mdclient 按窗口流水发往主站串口，
+  应答按原事务号回送。单元号0及0xFF(未指定)映射为默认从站号；应答超时回送网关目标无响应异常，
+  积压队列满时回送从站忙异常*/
+#define TCPD_CLIENTS 32U
+/*MBAP头:事务号(2)、协议号(2)、长度(2)、单元号(1)*/
+#define TCPD_MBAP_SIZE 7U
+#define TCPD_ADU_MAX (TCPD_MBAP_SIZE + MDC_FRAME_MAX - 3U)
+/*与网关一致的异常码*/
+#define TCPD_EXCEPTION_BUSY 0x06U
+#define TCPD_EXCEPTION_TARGET 0x0BU
+
+typedef struct
+{
+    int Fd;
+    /*连接序号:连接关闭后到达的应答丢弃*/
+    uint32_t Gen;
+    uint8_t Buf[TCPD_ADU_MAX];
+    uint16_t Length;
+    uint32_t Requests;
+} Tcpd_Client;
+
+/*一个转发中的请求*/
+typedef struct
+{
+    uint32_t Slot;
+    uint32_t Gen;
+    uint16_t Tid;
+    uint8_t Unit;
+    uint8_t Code;
+} Tcpd_Pending;
+
+static Tcpd_Client Clients[TCPD_CLIENTS];
+static Mdc_Handle Link;
+static uint8_t Default_Unit = 0xF7U;
+static uint32_t Timeout = MDC_TIMEOUT_DEFAULT;
+static volatile sig_atomic_t Quit;
+static struct
+{
+    uint32_t Accepted, Requests, Replies, Timeouts, Busy, Bad;
+} Stats;
+
+static void Tcpd_Signal(int Sig)
+{
+    (void)Sig;
+    Quit = 1;
+}
+
+static void Tcpd_Drop(Tcpd_Client *pC)
+{
+    close(pC->Fd);
+    pC->Fd = -1;
+    pC->Gen++;
+    pC->Length = 0;
+}
+
+/**
+ * @brief	回送一帧应答
+ * @details	帧很短，套接字发送缓冲区写不下时视为客户端不再读取，关闭连接
+ * @param	pC 客户端
+ * @param	Tid 事务号
+ * @param	Unit 单元号
+ * @param	pPdu 应答PDU
+ * @param	Length PDU长度
+ * @retval	None
+ */
+static void Tcpd_Reply(Tcpd_Client *pC, uint16_t Tid, uint8_t Unit, const uint8_t *pPdu, uint16_t Length)
+{
+    uint8_t adu[TCPD_ADU_MAX];
+
+    if ((pC->Fd < 0) || (Length + TCPD_MBAP_SIZE > sizeof(adu)))
+    {
+        return;
+    }
+    adu[0] = (uint8_t)(Tid >> 8U);
+    adu[1] = (uint8_t)Tid;
+    adu[2] = 0;
+    adu[3] = 0;
+    adu[4] = (uint8_t)((Length + 1U) >> 8U);
+    adu[5] = (uint8_t)(Length + 1U);
+    adu[6] = Unit;
+    memcpy(&adu[TCPD_MBAP_SIZE], pPdu, Length);
+    if (send(pC->Fd, adu, TCPD_MBAP_SIZE + Length, MSG_NOSIGNAL | MSG_DONTWAIT) != (ssize_t)(TCPD_MBAP_SIZE + Length))
+    {
+        Tcpd_Drop(pC);
+    }
+}
+
+static void Tcpd_Exception(Tcpd_Client *pC, uint16_t Tid, uint8_t Unit, uint8_t Code, uint8_t Exception)
+{
+    uint8_t pdu[2] = {(uint8_t)(Code | 0x80U), Exception};
+
+    Tcpd_Reply(pC, Tid, Unit, pdu, sizeof(pdu));
+}
+
+/**
+ * @brief	串口请求完成
+ * @details	RTU应答去掉从站号及CRC后按原事务号及单元号回送；发起的连接已关闭时丢弃
+ * @param	Arg 转发中的请求
+ * @param	Result 结果
+ * @param	pReply RTU应答
+ * @param	Length 应答长度
+ * @retval	None
+ */
+static void Tcpd_Done(void *Arg, int Result, const uint8_t *pReply, uint16_t Length)
+{
+    Tcpd_Pending *pP = (Tcpd_Pending *)Arg;
+    Tcpd_Client *pC = &Clients[pP->Slot];
+
+    if (pC->Gen == pP->Gen)
+    {
+        if ((Result == MDC_RESULT_OK) && (pReply != NULL))
+        {
+            Stats.Replies++;
+            Tcpd_Reply(pC, pP->Tid, pP->Unit, &pReply[1], Length - 3U);
+        }
+        else if (Result == MDC_RESULT_TIMEOUT)
+        {
+            Stats.Timeouts++;
+            Tcpd_Exception(pC, pP->Tid, pP->Unit, pP->Code, TCPD_EXCEPTION_TARGET);
+        }
+    }
+    free(pP);
+}
+
+/**
+ * @brief	从客户端缓冲区中取出完整的请求并提交
+ * @details	协议号不为0或长度不合法时关闭连接(无法再分帧)
+ * @param	pC 客户端
+ * @retval	None
+ */
+static void Tcpd_Process(Tcpd_Client *pC)
+{
+    Tcpd_Pending *pP;
+    uint16_t tid, length;
+    uint8_t unit, slave;
+
+    while ((pC->Fd >= 0) && (pC->Length >= TCPD_MBAP_SIZE))
+    {
+        tid = (uint16_t)((pC->Buf[0] << 8U) | pC->Buf[1]);
+        length = (uint16_t)((pC->Buf[4] << 8U) | pC->Buf[5]);
+        if (pC->Buf[2] || pC->Buf[3] || (length < 2U) || (TCPD_MBAP_SIZE - 1U + length > sizeof(pC->Buf)))
+        {
+            Stats.Bad++;
+            Tcpd_Drop(pC);
+            return;
+        }
+        if (pC->Length < TCPD_MBAP_SIZE - 1U + length)
+        {
+            return;
+        }
+        unit = pC->Buf[6];
+        slave = ((unit == 0x00U) || (unit == 0xFFU)) ? Default_Unit : unit;
+        pC->Requests++;
+        Stats.Requests++;
+        pP = malloc(sizeof(*pP));
+        if (pP != NULL)
+        {
+            pP->Slot = (uint32_t)(pC - Clients);
+            pP->Gen = pC->Gen;
+            pP->Tid = tid;
+            pP->Unit = unit;
+            pP->Code = pC->Buf[TCPD_MBAP_SIZE];
+        }
+        if ((pP == NULL) ||
+            !Mdc_Submit(&Link, slave, &pC->Buf[TCPD_MBAP_SIZE], length - 1U, Timeout, Tcpd_Done, pP))
+        {
+            Stats.Busy++;
+            Tcpd_Exception(pC, tid, unit, pC->Buf[TCPD_MBAP_SIZE], TCPD_EXCEPTION_BUSY);
+            free(pP);
+        }
+        length += TCPD_MBAP_SIZE - 1U;
+        memmove(pC->Buf, &pC->Buf[length], pC->Length - length);
+        pC->Length -= length;
+    }
+}
+
+static int Tcpd_Listen(uint16_t Port)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0), on = 1;
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(Port);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(fd, 8) < 0))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void Tcpd_Accept(int Listen)
+{
+    int fd = accept(Listen, NULL, NULL), on = 1;
+
+    if (fd < 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < TCPD_CLIENTS; i++)
+    {
+        if (Clients[i].Fd < 0)
+        {
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            Clients[i].Fd = fd;
+            Clients[i].Length = 0;
+            Stats.Accepted++;
+            return;
+        }
+    }
+    close(fd);
+}
+
+static void Tcpd_Usage(const char *name)
+{
+    printf("usage: %s -d device [-b baud] [-p port] [-u unit] [-w window] [-F] [-a addr -c channel] [-t timeout_ms]\n",
+           name);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *device = NULL;
+    uint32_t baud = 9600U, window = MDC_WINDOW_DEFAULT, addr = 0, channel = 0;
+    uint16_t port = 502U;
+    bool full = false, prefix = false;
+    struct pollfd pfd[TCPD_CLIENTS + 1U];
+    int opt, listen_fd;
+    ssize_t n;
+
+    while ((opt = getopt(argc, argv, "d:b:p:u:w:Fa:c:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            device = optarg;
+            break;
+        case 'b':
+            baud = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            port = (uint16_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'u':
+            Default_Unit = (uint8_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            window = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'F':
+            full = true;
+            break;
+        case 'a':
+            addr = (uint32_t)strtoul(optarg, NULL, 0);
+            prefix = true;
+            break;
+        case 'c':
+            channel = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            Timeout = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            Tcpd_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if ((device == NULL) || (window == 0U) || (window > MDC_WINDOW_MAX))
+    {
+        Tcpd_Usage(argv[0]);
+        return 2;
+    }
+    if (Mdc_Open(&Link, device, baud) < 0)
+    {
+        printf("cannot open %s at %u bps\n", device, baud);
+        return 1;
+    }
+    Mdc_Set_Window(&Link, (uint8_t)window, full);
+    if (prefix)
+    {
+        Mdc_Set_Prefix(&Link, (uint16_t)addr, (uint8_t)channel);
+    }
+    listen_fd = Tcpd_Listen(port);
+    if (listen_fd < 0)
+    {
+        printf("cannot listen on port %u\n", port);
+        return 1;
+    }
+    for (uint32_t i = 0; i < TCPD_CLIENTS; i++)
+    {
+        Clients[i].Fd = -1;
+    }
+    signal(SIGINT, Tcpd_Signal);
+    signal(SIGTERM, Tcpd_Signal);
+    printf("%s at %u bps, window = %u%s, default unit = 0x%02X, listening on port %u\n", device, baud, window,
+           full ? " full duplex" : "", Default_Unit, port);
+
+    while (!Quit)
+    {
+        /*有请求待发或在途时由串口一侧推进，套接字只做非阻塞检查*/
+        if (Mdc_Poll(&Link, Mdc_Pending(&Link) ? 5U : 0U) < 0)
+        {
+            printf("serial link error\n");
+            break;
+        }
+        pfd[0].fd = listen_fd;
+        pfd[0].events = POLLIN;
+        for (uint32_t i = 0; i < TCPD_CLIENTS; i++)
+        {
+            pfd[i + 1U].fd = Clients[i].Fd;
+            pfd[i + 1U].events = POLLIN;
+            pfd[i + 1U].revents = 0;
+        }
+        if (poll(pfd, TCPD_CLIENTS + 1U, Mdc_Pending(&Link) ? 0 : 50) <= 0)
+        {
+            continue;
+        }
+        if (pfd[0].revents & POLLIN)
+        {
+            Tcpd_Accept(listen_fd);
+        }
+        for (uint32_t i = 0; i < TCPD_CLIENTS; i++)
+        {
+            Tcpd_Client *pC = &Clients[i];
+            if ((pC->Fd < 0) || (pfd[i + 1U].fd != pC->Fd) || !(pfd[i + 1U].revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                continue;
+            }
+            n = recv(pC->Fd, &pC->Buf[pC->Length], sizeof(pC->Buf) - pC->Length, MSG_DONTWAIT);
+            if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EINTR)))
+            {
+                Tcpd_Drop(pC);
+                continue;
+            }
+            if (n > 0)
+            {
+                pC->Length += (uint16_t)n;
+                Tcpd_Process(pC);
+            }
+        }
+    }
+    Mdc_Close(&Link);
+    close(listen_fd);
+    printf("clients = %u, requests = %u, replies = %u, timeouts = %u, busy = %u, bad = %u\n", Stats.Accepted,
+           Stats.Requests, Stats.Replies, Stats.Timeouts, Stats.Busy, Stats.Bad);
+    printf("link: tx = %u, rx = %u, timeouts = %u, stray = %u, dropped bytes = %u\n", Link.Stats.Tx, Link.Stats.Rx,
+           Link.Stats.Timeout, Link.Stats.Stray, Link.Stats.Dropped);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <string.h>
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
+#include "host_port.h"
+#include "tunnel.h"
+
+/*shell隧道端到端测试:隧道请求经主站串口(L101)进入主站协议栈，由 portRtuClientTick 交给中心处理器及
+  tunnel.c 的处理函数，应答带回shell输出；同一串口上的从站应答(含紧凑模拟量帧)仍交给主站请求引擎*/
+/*仿真shell对输入的回显前缀*/
+#define TEST_ECHO "> "
+
+static uint8_t Tx_Frame[MODBUS_TX_BUFFER_SIZE];
+static uint16_t Tx_Length;
+static uint32_t Tx_Count;
+static bool Mode_Open;
+static uint32_t Failures;
+
+/**
+ * @brief	仿真shell接收
+ * @details	输入立即以回显的形式作为shell输出，经 Tunnel_Capture 进入隧道缓冲区
+ * @param	data 输入
+ * @param	len 字节数
+ * @retval	接收的字节数
+ */
+unsigned short Shell_Rx_Push(const char *data, unsigned short len)
+{
+    Tunnel_Capture(TEST_ECHO, sizeof(TEST_ECHO) - 1U);
+    Tunnel_Capture(data, len);
+    return len;
+}
+
+void Mode_Tunnel(bool Open)
+{
+    Mode_Open = Open;
+}
+
+static bool Test_Transmit(UartDma_HandleTypeDef *huart, const UartDma_Segment *pSeg, uint16_t Count)
+{
+    (void)huart;
+    Tx_Length = 0;
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        if (Tx_Length + pSeg[i].Length <= sizeof(Tx_Frame))
+        {
+            memcpy(&Tx_Frame[Tx_Length], pSeg[i].pData, pSeg[i].Length);
+            Tx_Length += pSeg[i].Length;
+        }
+    }
+    Tx_Count++;
+    /*主机上发送立即完成*/
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        if (pSeg[i].Done != NULL)
+        {
+            pSeg[i].Done(pSeg[i].Arg, true);
+        }
+    }
+    return true;
+}
+
+static void Test_Check(bool Ok, const char *pWhat)
+{
+    if (!Ok)
+    {
+        Failures++;
+        printf("FAIL: %s\n", pWhat);
+    }
+}
+
+/**
+ * @brief	一帧到达主站串口并由Modbus任务处理
+ * @param	pFrame 帧(不含CRC)
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Test_Feed(const uint8_t *pFrame, uint16_t Length)
+{
+    uint8_t frame[MODBUS_TX_BUFFER_SIZE];
+    uint16_t crc = mdCrc16((uint8_t *)pFrame, Length);
+
+    memcpy(frame, pFrame, Length);
+    frame[Length] = LOW(crc);
+    frame[Length + 1U] = HIGH(crc);
+    Host_Tick++;
+    Uart1_Dma.Rx.Event(&Uart1_Dma, frame, Length + 2U, UART_DMA_EVENT_IDLE);
+    Uart1_Dma.Rx.Notify(&Uart1_Dma, UART_DMA_EVENT_IDLE);
+    if (Host_Signal & MODBUS_SIGNAL_RX)
+    {
+        Host_Signal &= ~MODBUS_SIGNAL_RX;
+        mdRTU_Handler(Master_Object);
+    }
+}
+
+/**
+ * @brief	检查隧道应答
+ * @param	pText 期望的shell输出
+ * @retval	None
+ */
+static void Test_Reply(const char *pText)
+{
+    uint16_t n = (uint16_t)strlen(pText);
+
+    Test_Check(Tx_Length == 5U + n, "reply length");
+    Test_Check((Tx_Frame[0] == SLAVE_ID) && (Tx_Frame[1] == TUNNEL_CODE) && (Tx_Frame[2] == n), "reply header");
+    Test_Check((Tx_Length >= 5U) && (mdCrc16(Tx_Frame, Tx_Length) == 0U), "reply crc");
+    Test_Check((Tx_Length == 5U + n) && !memcmp(&Tx_Frame[3], pText, n), "reply shell output");
+}
+
+int main(void)
+{
+    const uint8_t open[] = {SLAVE_ID, TUNNEL_CODE, 5U, 'h', 'e', 'l', 'p', '\r'};
+    const uint8_t fetch[] = {SLAVE_ID, TUNNEL_CODE, 0U};
+    const uint8_t close[] = {SLAVE_ID, TUNNEL_CODE, TUNNEL_CLOSE};
+    /*从站发来的紧凑模拟量帧:不是请求，不得触发应答*/
+    const uint8_t analog[] = {0x01U, MODBUS_CODE_ANALOG, 2U, 0x12U, 0x34U};
+    uint32_t unknown;
+
+    Test_Check(TUNNEL_CODE != MODBUS_CODE_ANALOG, "tunnel code collides with analog uplink");
+    Host_Transmit = Test_Transmit;
+    ModbusInit(&Master_Object);
+    if ((Master_Object == NULL) || (Client_Object == NULL))
+    {
+        printf("modbus init failed\n");
+        return 1;
+    }
+    Tunnel_Init(Master_Object);
+
+    Test_Feed(open, sizeof(open));
+    Test_Check(Tx_Count == 1U, "tunnel request not answered");
+    Test_Check(Mode_Open && Tunnel_Active(), "session not opened");
+    Test_Reply(TEST_ECHO "help\r");
+
+    Test_Feed(fetch, sizeof(fetch));
+    Test_Check(Tx_Count == 2U, "fetch not answered");
+    Test_Reply("");
+
+    unknown = Client_Object->unknown;
+    Test_Feed(analog, sizeof(analog));
+    Test_Check(Tx_Count == 2U, "analog uplink answered as a request");
+    Test_Check(Client_Object->unknown == unknown + 1U, "analog uplink not given to the request engine");
+
+    Test_Feed(close, sizeof(close));
+    Test_Check(Tx_Count == 3U, "close not answered");
+    Test_Check(!Mode_Open && !Tunnel_Active(), "session not closed");
+    Test_Reply("");
+
+    printf("tunnel: frames = %u, failures = %u\n", Tx_Count, Failures);
+    return Failures ? 1 : 0;
+}
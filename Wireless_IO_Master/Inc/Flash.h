@@ -0,0 +1,97 @@
+/*
+ * myflash.h
+ *
+ *  Created on: 2021年07月31日
+ *      Author: LHC
+ */
+
+/*
+*@note:STM32F103C8T6的Flash有效容量为64KB，但是实际可以使用超过64KB，上限是128KB
+*/
+
+#ifndef INC_FLASH_H_
+#define INC_FLASH_H_
+
+#include "main.h"
+
+/* FLASH大小：64KB ,SRAM : 20KB*/
+#define STM32FLASH_SIZE  0x00020000UL/*128KB*/
+
+/* FLASH起始地址 */
+#define STM32FLASH_BASE  FLASH_BASE
+
+/* FLASH结束地址:此芯片实际flah大小256k，但是使用了VET6的配置*/
+#define STM32FLASH_END   (STM32FLASH_BASE | STM32FLASH_SIZE)
+
+/* FLASH页大小：2K */
+#define STM32FLASH_PAGE_SIZE FLASH_PAGE_SIZE
+
+/* FLASH总页数 */
+#define STM32FLASH_PAGE_NUM  (STM32FLASH_SIZE / STM32FLASH_PAGE_SIZE)
+
+/* 获取页地址，X=0~STM32FLASH_PAGE_NUM */
+#define ADDR_FLASH_PAGE_X(X)    (STM32FLASH_BASE | (X * STM32FLASH_PAGE_SIZE))
+
+
+/* 代码放入RAM执行(由分散加载文件中的RW_IRAM1区收集)，flash擦写期间照常运行 */
+#define FLASH_RAMFUNC __attribute__((section(".RamFunc"), noinline))
+
+/* flash操作期间仍在RAM中响应的中断数 */
+#define FLASH_RAM_VECTORS 2U
+
+/* 后台写入队列深度 */
+#define FLASH_QUEUE_SIZE 4U
+
+/* 唤醒flash任务的信号 */
+#define FLASH_SIGNAL_POST 0x01U
+
+/*
+ * flash操作期间仍须响应的中断
+ * Handler位于RAM(FLASH_RAMFUNC)，不得调用flash中的函数
+ * Leave在操作结束后调用，Ready返回true时才开始操作，均可为NULL
+ */
+typedef struct
+{
+	IRQn_Type IRQn;
+	void (*Handler)(void);
+	void (*Leave)(void);
+	bool (*Ready)(void);
+} Flash_Ram_Vector;
+
+/* 后台写入请求的状态 */
+typedef enum
+{
+	FLASH_REQ_IDLE = 0,
+	FLASH_REQ_PENDING,
+	FLASH_REQ_DONE,
+	FLASH_REQ_FAILED,
+} Flash_State;
+
+/*
+ * 后台写入请求:由请求方静态分配，状态为 FLASH_REQ_PENDING 期间不得修改 pData 指向的数据
+ * 写入时先擦除 Address 所在页
+ */
+typedef struct
+{
+	uint32_t Address;
+	const uint16_t *pData;
+	/* 半字数 */
+	uint32_t Size;
+	volatile Flash_State State;
+} Flash_Request;
+
+
+/*函数声明*/
+void FLASH_Init(void);
+bool FLASH_Ram_Register(const Flash_Ram_Vector *pVector);
+const void *FLASH_Map(uint32_t Address, uint32_t Size);
+bool     FLASH_Read(uint32_t Address, void *Buffer, uint32_t Size);
+bool     FLASH_Erase(uint32_t Address);
+bool     FLASH_Program(uint32_t Address, const uint16_t *Buffer, uint32_t Size);
+uint32_t FLASH_Write(uint32_t Address, const uint16_t *Buffer, uint32_t Size);
+bool     FLASH_Post(Flash_Request *pRequest);
+void     FLASH_Process(uint32_t Timeout);
+void     FLASH_Show(void);
+
+
+#endif /* INC_FLASH_H_ */
@@ -62,6 +62,8 @@
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)64)
 #define configTOTAL_HEAP_SIZE                    ((size_t)10240)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configGENERATE_RUN_TIME_STATS            1
+#define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
@@ -85,9 +87,10 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelete                 1
 #define INCLUDE_vTaskCleanUpResources       0
 #define INCLUDE_vTaskSuspend                1
-#define INCLUDE_vTaskDelayUntil             0
+#define INCLUDE_vTaskDelayUntil             1
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -120,6 +123,16 @@ header file. */
 //#define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); for( ;; );}
 /* USER CODE END 1 */
 
+/* USER CODE BEGIN 2 */
+/* Definitions needed when configGENERATE_RUN_TIME_STATS is on */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  extern void configureTimerForRunTimeStats(void);
+  extern unsigned long getRunTimeCounterValue(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE getRunTimeCounterValue
+/* USER CODE END 2 */
+
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names. */
 #define vPortSVCHandler    SVC_Handler
@@ -132,6 +145,31 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* The monitor tells the idle task apart when summing the CPU load */
+#define INCLUDE_xTaskGetIdleTaskHandle      1
+#if defined(USING_STATIC_ALLOCATION)
+/* Tasks, timers, the mutex and the Modbus objects are placed at link time;
+   the heap only serves the transient shellPrint buffers */
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                    ((size_t)2048)
+#endif
+/* The heap array lives in heap_trace.c so its block map can be walked */
+#define configAPPLICATION_ALLOCATED_HEAP         1
+/* Log every heap_4 allocation and free with its caller (heap_trace.c); comment out to remove the hooks */
+#define USING_HEAP_TRACE
+#if defined(USING_HEAP_TRACE)
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  extern void Heap_Trace_Malloc(void *pBlock, size_t Size, void *pCaller);
+  extern void Heap_Trace_Free(void *pBlock, size_t Size, void *pCaller);
+#endif
+#if defined(__CC_ARM)
+#define HEAP_TRACE_CALLER() ((void *)__return_address())
+#else
+#define HEAP_TRACE_CALLER() __builtin_return_address(0)
+#endif
+#define traceMALLOC(pvAddress, uiSize) Heap_Trace_Malloc((pvAddress), (uiSize), HEAP_TRACE_CALLER())
+#define traceFREE(pvAddress, uiSize) Heap_Trace_Free((pvAddress), (uiSize), HEAP_TRACE_CALLER())
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -6,14 +6,125 @@ extern "C"
 {
 #endif
 #include "main.h"
+#include "at_usr.h"
+#include "board_cfg.h"
 
 /*定义Master发送缓冲区字节数*/
 #define PF_TX_SIZE 64U
-#define LEVENTS (sizeof(L101_Map) / sizeof(L101_HandleTypeDef))
+/*L101_Map容量*/
+#define L101_MAX_EVENTS (sizeof(L101_Map) / sizeof(L101_HandleTypeDef))
+/*当前配置的节点数*/
+#define LEVENTS (g_L101_Events)
+/*节点映射表存放于系统参数区*/
+#define L101_MAP_PAGE 126U
+#define L101_MAP_MAGIC 0x4C31U
+#define L101_MAP_VERSION 0x02U
+/*调度节拍到达:定时器通知无线调度任务执行一次 Master_Poll*/
+#define L101_SIGNAL_POLL 0x01U
+/*模块上报发送完成:无线调度任务立即提交下一请求，不等下一节拍*/
+#define L101_SIGNAL_FREE 0x02U
 /*累计三次超时或者错误后，改变上报的时间*/
 #define SUSPEND_TIMES 3U
 /*30s增加一个离线设备扫描*/
 #define TOTAL_SUM 5U
+/*应答等待窗口上下限(单位:MDTASK_SENDTIMES)*/
+#define L101_RTO_MIN_TIMES 1U
+#define L101_RTO_MAX_TIMES 20U
+/*离线设备重新探测的最大退避指数*/
+#define L101_BACKOFF_MAX 5U
+/*从站在写线圈应答中附带上报的输入映像:事件n(目标从站首个事件)的输入位于本地输入线圈
+L101_REMOTE_INPUT_START_ADDR + n * L101_REMOTE_INPUTS，可作为路由表的输入线圈源*/
+#define L101_REMOTE_INPUT_START_ADDR BOARD_REG_REMOTE_INPUT
+#define L101_REMOTE_INPUTS 2U
+/*从站在健康信息之后附带的模拟量(越过从站死区的通道):事件n的通道i位于本地输入寄存器
+L101_REMOTE_ANALOG_START_ADDR + n * L101_REMOTE_ANALOGS + i，无需另行读取从站的模拟量*/
+#define L101_REMOTE_ANALOG_START_ADDR BOARD_REG_REMOTE_ANALOG
+#define L101_REMOTE_ANALOGS 2U
+/*链路质量统计窗口(完成的事务数)*/
+#define L101_LINK_WINDOW 32U
+/*丢包率上限/下限(%)*/
+#define L101_LINK_LOSS_MAX 20U
+#define L101_LINK_LOSS_MIN 5U
+/*连续满足升速条件的窗口数*/
+#define L101_LINK_UP_WINDOWS 4U
+/*全网连续超时次数达到后回退到保守速率*/
+#define L101_LINK_FALLBACK_TIMES 6U
+/*应用层纠错:从站丢包率(%)超过该值时提高一级纠错等级(低于降速的门限，先以纠错挽回丢包)，
+  连续L101_LINK_UP_WINDOWS个窗口无丢包且应答无需纠正时降低一级*/
+#define L101_FEC_LOSS_UP 10U
+/*拥塞控制(USING_AIMD):速率单位为0.1帧/s；每个周期(不短于 L101_AIMD_CYCLE ms且至少完成 L101_AIMD_SAMPLES 个
+  在线从站事务)统计一次丢包率，超过 L101_AIMD_LOSS(%)时速率乘以 L101_AIMD_BETA/8，无丢包且速率受限时加 L101_AIMD_STEP*/
+#define L101_AIMD_CYCLE 1000U
+#define L101_AIMD_SAMPLES 4U
+#define L101_AIMD_LOSS 10U
+#define L101_AIMD_BETA 4U
+#define L101_AIMD_STEP 5U
+#define L101_AIMD_RATE_MIN 5U
+/*占空比预算(USING_AIRTIME):L101_AIR_WINDOW(s)的滑动窗口分为 L101_AIR_BUCKETS 个时段，窗口内主模块的发送时间
+  不超过占空比(0.1%，按频段的法规设置)；余量低于预算的 L101_AIR_RESERVE(%) 时只发出报警及控制类请求，
+  不足一次典型请求时停止发送，直到窗口滑过旧的发送*/
+#define L101_AIR_WINDOW 3600U
+#define L101_AIR_BUCKETS 60U
+#define L101_AIR_DUTY 100U
+#define L101_AIR_DUTY_MAX 1000U
+#define L101_AIR_RESERVE 25U
+/*速率等级范围，与AT+SPD一致*/
+#define L101_SPD_MIN 1U
+#define L101_SPD_MAX 10U
+#define L101_SPD_SAFE 6U
+/*发送准入:模块串口缓冲区(字节，按手册取保守值)及每帧前导码、包头的开销(字节)；
+  按速率等级估计已写入数据的空中时间，剩余不超过 L101_ADMIT_AHEAD(ms) 时模块忙也写入下一帧，
+  串口写入与当前帧的发送重叠，模块发完即可接着发送*/
+#define L101_TX_BUFFER 256U
+#define L101_AIR_OVERHEAD 8U
+#define L101_ADMIT_AHEAD 20U
+/*空中时间模型:模块的前向纠错设置(AT+FEC 由此生成)；开启时数据部分按编码率4/8相对4/5估计，空中时间乘以8/5*/
+#define L101_FEC 1U
+#define L101_FEC_NUM 8U
+#define L101_FEC_DEN 5U
+/*模块收到完整一帧到串口输出、从站组织应答到模块开始发送的处理时间之和(ms)，按手册取保守值*/
+#define L101_TURNAROUND 20U
+/*调度使用的典型事务:写线圈请求(含前缀)及附带输入、健康信息的应答字节数*/
+#define L101_REQUEST_BYTES 13U
+#define L101_REPLY_BYTES 17U
+/*后台心跳占用信道时间的上限(%)，其余留给变位、模拟量等事件；低速率等级下据此放宽心跳间隔*/
+#define L101_HEARTBEAT_LOAD 50U
+/*L101广播地址*/
+#define L101_BROADCAST_ADDR 0xFFFFU
+/*组播时等待L101模块空闲的最长时间(ms)*/
+#define L101_GROUP_WAIT 200U
+/*不同目标从站同时在途的最大请求数*/
+#define L101_MAX_PIPELINE 2U
+/*中继路由条目数(整表作为一个参数保存，不超过 KV_VALUE_MAX)及最大跳数*/
+#define L101_HOPS 5U
+#define L101_HOPS_MAX 4U
+/*经中继访问时每一跳至少预留的应答时间(ms)，不得小于中继从站等待下游应答的时间(MODBUS_FORWARD_TIMEOUT)*/
+#define L101_HOP_BUDGET 300U
+/*无事件时后台心跳帧间隔(单位:MDTASK_SENDTIMES)*/
+/*网络功耗模式:常收(RUN)；占空比网络中主站模块工作在WU模式，每帧前发送与唤醒间隔等长的唤醒码，
+从站模块须配置为LR模式及相同的唤醒间隔、空闲时间，并把失效安全超时设为大于单个从站的心跳间隔*/
+#define L101_POWER_RUN 0x00U
+#define L101_POWER_DUTY 0x01U
+/*唤醒间隔(ms)，与AT+WTM一致*/
+#define L101_WTM_MIN 500U
+#define L101_WTM_MAX 4000U
+#define L101_WTM_STEP 500U
+#define L101_WTM_DEFAULT 2000U
+/*从站收到数据后保持唤醒的空闲时间(s)，与AT+ITM一致*/
+#define L101_ITM_MIN 3U
+#define L101_ITM_MAX 240U
+#define L101_ITM_DEFAULT 20U
+/*延迟测试:测试帧最短发送间隔(ms)及往返时间直方图分档数*/
+#define L101_TEST_INTERVAL_MIN MDTASK_SENDTIMES
+#define L101_TEST_BINS 18U
+/*时间同步:相邻两帧同步帧的最短间隔(ms)，同步帧代替到期的心跳轮流发往在线从站*/
+#define L101_SYNC_INTERVAL 2000U
+#if defined(USING_COS_MODE)
+#define L101_HEARTBEAT_TIMES 20U
+#else
+/*未开启变位模式时，每个空闲节拍都轮询一次*/
+#define L101_HEARTBEAT_TIMES 1U
+#endif
     /*Enter键值*/
     // #define ENTER_CODE 0x2F
 
@@ -41,6 +152,39 @@ extern "C"
         L_TimeOut,
     } L101_State;
 
+    /*从站累计统计(自由计数，stats_clear 清零):发出的请求、正确应答、超时及失败后的重发次数，
+      及线圈与确认值相同而未发送的变位事件数*/
+    typedef struct
+    {
+        uint32_t Tx;
+        uint32_t Rx;
+        uint32_t Timeouts;
+        uint32_t Retries;
+        uint32_t Skips;
+    } L101_Stats;
+
+    /*中继路由:事件 Event 的请求发往下一跳节点 Addr/Channel，经 Hops 跳(含最后一跳)到达从站，Hops 为0时无效*/
+    typedef struct
+    {
+        uint16_t Addr;
+        uint8_t Event;
+        uint8_t Channel;
+        uint8_t Hops;
+    } L101_Hop;
+
+    /*热备主站镜像的调度状态(standby.h):bit n对应L101_Map[n]*/
+    typedef struct
+    {
+        uint32_t Ready;
+        uint32_t Block;
+        /*本机线圈(目标输出)、最近一次被从站确认的线圈值及确认值有效的事件*/
+        uint32_t Coils;
+        uint32_t Coil_Ack;
+        uint32_t Coil_Valid;
+        /*首轮扫描已完成*/
+        bool Scanned;
+    } L101_Mirror;
+
     /*定义L101事件处理结构*/
     typedef struct L101
     { /*从站设备地址*/
@@ -54,6 +198,20 @@ extern "C"
         /*模拟量信号地址*/
         uint16_t Analog_Addr;
         uint16_t Crc16;
+        /*最近一次被从站确认的模拟量(12bit码值)*/
+        uint16_t Analog_Ack;
+        /*已发出待确认的模拟量*/
+        uint16_t Analog_Sent;
+        /*Analog_Ack有效时才允许增量编码*/
+        bool Analog_Valid;
+        bool Analog_Pending;
+        /*最近一次被从站确认的线圈值*/
+        uint8_t Coil_Ack;
+        /*已发出待确认的线圈值(提交时的本地线圈)*/
+        uint8_t Coil_Sent;
+        /*Coil_Ack有效时才允许省去线圈值未变的变位事件*/
+        bool Coil_Valid;
+        bool Coil_Pending;
         /*检查各从站是否响应*/
         struct
         { /*当前状态*/
@@ -62,16 +220,103 @@ extern "C"
             uint32_t Times;
             /*错误计数器*/
             uint32_t Counter;
+            /*请求发出时刻(ms)*/
+            uint32_t Start;
+            /*当前请求的业务类别(MASTER_CLASS_*)*/
+            uint8_t Priority;
+            /*最近一次往返时间(ms)*/
+            uint32_t Rtt;
+            /*平滑往返时间(ms,放大8倍)*/
+            uint32_t Srtt;
+            /*往返时间偏差(ms,放大4倍)*/
+            uint32_t Rttvar;
+            /*连续失败次数*/
+            uint8_t Errors;
+            /*退避指数*/
+            uint8_t Backoff;
+            /*剩余退避的探测次数*/
+            uint16_t Holdoff;
+            /*统计窗口内的请求/应答次数*/
+            uint16_t Tx;
+            uint16_t Rx;
+            /*上一窗口的丢包率(%)*/
+            uint8_t Loss;
         } Check;
-        /*对应回调函数*/
-        uint8_t (*func)(struct L101 *param);
+        /*从站在写线圈应答中附带的健康信息*/
+        struct
+        { /*已收到过健康信息*/
+            bool Valid;
+            /*最近一次RSSI(原始字节)*/
+            uint8_t Rssi;
+            /*从站累计错误数*/
+            uint16_t Errors;
+            /*从站运行时间(s)*/
+            uint32_t Uptime;
+            /*检测到的从站复位次数*/
+            uint16_t Reboots;
+        } Health;
+        /*应用层纠错(MODBUS_FEC):链路管理按丢包率为该从站选择的纠错等级，只在目标从站首个事件中有效*/
+        struct
+        { /*当前纠错等级*/
+            uint8_t Level;
+            /*由 l101_fec 命令固定，不再自动调整*/
+            bool Locked;
+            /*连续无丢包且无纠错的窗口数*/
+            uint8_t Good;
+            /*统计窗口内应答中纠正的字节数*/
+            uint16_t Fixed;
+            /*累计纠正的字节数*/
+            uint32_t Total;
+        } Fec;
+        /*累计统计*/
+        L101_Stats Stats;
     } L101_HandleTypeDef __attribute__((aligned(4)));
 
+    extern uint16_t g_L101_Events;
     extern void Slist_Init(void);
+    extern bool L101_Map_Load(void);
+    extern uint8_t L101_Map_Save(void);
+    extern uint8_t L101_Set_Nodes(int nodes);
+    extern uint8_t L101_Set_Io(int event, int digital, int analog);
+    extern void L101_Map_Show(void);
+    extern uint8_t L101_Set_Map(int event, int addr, int channel, int id);
+    extern bool L101_Find_Node(uint8_t Slave_Id, uint16_t *pAddr, uint8_t *pChannel);
+    extern bool L101_Node_At(uint16_t Index, uint8_t *pSlave_Id, uint16_t *pAddr, uint8_t *pChannel);
+    extern bool L101_Join(uint8_t Slave_Id, uint8_t Channel);
+    extern uint8_t L101_Set_Hop(int event, int addr, int channel, int hops);
+    extern void L101_Hop_Show(void);
     extern bool inline Get_L101_Status(void);
+    extern void L101_Status_Edge(uint16_t GPIO_Pin);
     extern void Set_L101_FactoryMode(void);
     extern void Shell_Mode(void);
     extern void Master_Poll(void);
+    extern void Master_Kick(void);
+    extern void Set_L101_Dirty(uint16_t addr);
+    extern void Set_L101_Alarm(uint16_t addr);
+    extern void Set_L101_Analog(uint16_t addr);
+    extern uint8_t Set_RegsFrame(L101_HandleTypeDef *pL);
+    extern uint8_t L101_Group_Write(uint16_t coil_addr, uint8_t *bitmap, uint16_t bits);
+    extern uint8_t L101_Group_All(int coil_addr, int bit);
+    extern uint8_t L101_Link_Target(void);
+    extern void L101_Air_Show(void);
+    extern uint8_t L101_Burst_Window(uint8_t Slave_Id, uint32_t Length, uint8_t Max);
+    extern uint8_t L101_Link_Speed(void);
+    extern void L101_Link_Applied(uint8_t level);
+    extern void L101_Link_Show(void);
+    extern uint8_t L101_Set_Fec(int event, int level);
+    extern uint8_t L101_Set_Rate(int rate);
+    extern const L101_Stats *L101_Stats_Get(uint16_t event, uint8_t *pId);
+    extern void L101_Stats_Clear(void);
+    extern uint8_t L101_Set_Power(int mode, int wtm, int itm);
+    extern bool L101_Power_Pending(bool *pDuty, uint16_t *pWtm);
+    extern void L101_Power_Applied(bool ok);
+    extern uint8_t L101_Test_Start(int event, int interval);
+    extern void L101_Test_Stop(void);
+    extern void L101_Test_Show(void);
+    extern void L101_Urc_Rssi(at_urc_ctx_t *ctx);
+    extern void L101_Urc_Send_Ok(at_urc_ctx_t *ctx);
+    extern void L101_Mirror_Get(L101_Mirror *pM);
+    extern void L101_Mirror_Set(const L101_Mirror *pM);
 #ifdef __cplusplus
 }
 #endif
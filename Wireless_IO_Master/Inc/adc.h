@@ -28,8 +28,21 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-#define ADC_DMA_CHANNEL 2U
-#define ADC_SAMPLING_NUM   8U
+#include "board_cfg.h"
+/*扫描通道数与板级配置的模拟量表一致*/
+#define ADC_DMA_CHANNEL BOARD_ANALOG_COUNT
+#if defined(USING_ADC_TIMER_TRIGGER)
+/*触发速率固定为TIM1时基频率(1kHz)，触发相位为时基周期内的比较值(us)*/
+#define ADC_TRIGGER_PHASE 500U
+/*DMA环内每通道的采样数(半字存放):半满/全满各处理一半*/
+#define ADC_SAMPLING_NUM   16U
+/*滑动和抽取:每通道累加 2^ADC_DECIMATION_SHIFT 个采样输出一次(16ms)*/
+#define ADC_DECIMATION_SHIFT 4U
+#else
+#define ADC_SAMPLING_NUM   64U
+/*连续转换时约14ms输出一次*/
+#define ADC_DECIMATION_SHIFT 10U
+#endif
 #define ADC_DMA_SIZE (ADC_DMA_CHANNEL * ADC_SAMPLING_NUM)
 /* USER CODE END Includes */
 
@@ -42,8 +55,10 @@ extern ADC_HandleTypeDef hadc1;
 void MX_ADC1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
-extern uint32_t Adc_buffer[ADC_DMA_SIZE];
+extern uint16_t Adc_buffer[ADC_DMA_SIZE];
 extern uint32_t Get_AdcValue(const uint32_t Channel);
+extern void Adc_Result_Callback(void);
+extern void Adc_Block_Callback(const uint16_t *pData);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
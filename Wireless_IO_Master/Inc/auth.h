@@ -0,0 +1,26 @@
+#ifndef __AUTH_H__
+#define __AUTH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+
+    /*帧认证配置(整体保存在参数区)，主站与各从站使用同一密钥*/
+    typedef struct
+    {
+        uint8_t Enable;
+        uint32_t Key[4];
+    } Auth_Config;
+
+    extern void Auth_Init(void);
+    extern uint8_t Auth_Set(int enable, int k0, int k1, int k2, int k3);
+    extern void Auth_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUTH_H__ */
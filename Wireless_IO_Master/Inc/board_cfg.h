@@ -0,0 +1,82 @@
+#ifndef __BOARD_CFG_H__
+#define __BOARD_CFG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*板级配置:I/O点、寄存器布局及节点映射的唯一描述。各表为X宏，在用到的地方展开为编译期常量
+  或flash中的const数据；io_signal.h、L101.h、route.c等处的相关常量均由此导出，更换板型只修改本文件*/
+
+/*数字量输入:X(通道, GPIO端口, 引脚号, 默认节点的模块地址, 模块信道, 从站号)
+  通道n对应输入线圈 BOARD_REG_DIGITAL + n，默认路由驱动线圈 BOARD_REG_OUTPUT + n，
+  默认节点n把该线圈转发到远端从站；快照一次读取GPIOA、GPIOB的IDR，端口限于A、B；
+  引脚须与 cubemx.ioc 中 DDIn 的配置一致(board_cfg.c 中检查)*/
+#define BOARD_DIGITAL_TABLE(X)         \
+    X(0, A, 3, 0x01, 0x01, 0x01)       \
+    X(1, A, 4, 0x02, 0x02, 0x02)       \
+    X(2, A, 5, 0x03, 0x03, 0x03)       \
+    X(3, A, 6, 0x04, 0x04, 0x04)       \
+    X(4, A, 7, 0x05, 0x05, 0x05)       \
+    X(5, B, 0, 0x06, 0x06, 0x06)       \
+    X(6, B, 1, 0x07, 0x07, 0x07)       \
+    X(7, B, 10, 0x08, 0x08, 0x08)
+
+/*模拟量输入(ADC扫描顺序):X(通道, 满量程(uA/mV，对应12bit码值4095))
+  通道0电流，通道1电压*/
+#define BOARD_ANALOG_TABLE(X) \
+    X(0, 20000)               \
+    X(1, 10000)
+
+/*寄存器布局:X(区域名, 寄存器组, 起始地址, 个数)，起始地址导出为 BOARD_REG_<区域名>；
+  各区域不得超出所在组的寄存器池(board_cfg.c 中编译期检查)，同组区域的重叠由 board 命令列出*/
+#define BOARD_REGISTER_TABLE(X)                                                   \
+    /*本机数字量输入的电平*/                                                      \
+    X(DIGITAL, INPUT_COIL, 0x00, BOARD_DIGITAL_COUNT)                             \
+    /*远端从站在写线圈应答中上报的输入映像，每个事件 L101_REMOTE_INPUTS 位*/    \
+    X(REMOTE_INPUT, INPUT_COIL, 0x10, BOARD_DIGITAL_COUNT * L101_REMOTE_INPUTS)   \
+    /*默认路由的目标线圈，经节点映射转发到远端从站的输出*/                      \
+    X(OUTPUT, COIL, 0x00, BOARD_DIGITAL_COUNT)                                    \
+    /*12bit原始码值:本机各通道及经Modbus写入的值，节点按 Analog_Addr 读取*/      \
+    X(ANALOG_RAW, HOLD_REGISTER, 0x10, BOARD_DIGITAL_COUNT)                       \
+    /*报警上下限:每通道[上限][下限]*/                                            \
+    X(ANALOG_LIMIT, HOLD_REGISTER, 0x18, BOARD_ANALOG_COUNT * 2U)                 \
+    /*校准接口:[命令][参考值]*/                                                  \
+    X(ANALOG_CAL, HOLD_REGISTER, 0x1C, 2U)                                        \
+    /*计数模式输入的计数及频率(pulse.h)，每通道 PULSE_CHANNEL_REGS 个*/           \
+    X(PULSE, INPUT_REGISTER, 0x00, BOARD_DIGITAL_COUNT * PULSE_CHANNEL_REGS)      \
+    /*模拟量报警状态*/                                                           \
+    X(ANALOG_ALARM, INPUT_REGISTER, 0x1B, 1U)                                     \
+    /*校准后的模拟量*/                                                           \
+    X(ANALOG_INPUT, INPUT_REGISTER, 0x1C, BOARD_ANALOG_COUNT)                     \
+    /*运行统计(monitor.h)*/                                                      \
+    X(MONITOR, INPUT_REGISTER, 0x20, MONITOR_REG_SIZE)                            \
+    /*计量结果(meter.h)*/                                                        \
+    X(METER, INPUT_REGISTER, 0x34, METER_REG_SIZE)                                \
+    /*协议统计(stats.h)*/                                                        \
+    X(STATS, INPUT_REGISTER, 0x40, STATS_REG_SIZE)                                \
+    /*远端从站在写线圈应答中上报的模拟量(uA/mV)，每个事件 L101_REMOTE_ANALOGS 个*/ \
+    X(REMOTE_ANALOG, INPUT_REGISTER, 0x70, BOARD_DIGITAL_COUNT * L101_REMOTE_ANALOGS)
+
+/*表项计数*/
+#define BOARD_COUNT_DIGITAL(ch, port, pin, addr, chan, id) +1U
+#define BOARD_COUNT_ANALOG(ch, full) +1U
+#define BOARD_DIGITAL_COUNT (0U BOARD_DIGITAL_TABLE(BOARD_COUNT_DIGITAL))
+#define BOARD_ANALOG_COUNT (0U BOARD_ANALOG_TABLE(BOARD_COUNT_ANALOG))
+
+    /*各区域的起始地址(个数在使用处展开，可引用其他模块的常量)*/
+#define BOARD_REG_ENUM(name, group, start, count) BOARD_REG_##name = (start),
+    enum
+    {
+        BOARD_REGISTER_TABLE(BOARD_REG_ENUM)
+    };
+
+    extern void Board_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOARD_CFG_H__ */
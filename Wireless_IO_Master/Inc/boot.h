@@ -0,0 +1,78 @@
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "os_port.h"
+
+/*分级启动:main() 中只初始化关键I/O(输入采集、ADC及其依赖)，FRAM序号恢复、节点表、软件串口等
+  在启动任务中完成，依赖这些模块的任务先调用 Boot_Wait()。启动节点:X(节点名, 说明)，
+  记录自 HAL_Init() 起的毫秒数*/
+#define BOOT_MARK_TABLE(X)                 \
+    X(MAIN, "critical init done")          \
+    X(INPUT, "first input capture")        \
+    X(LOG, "fram log recovered")           \
+    X(READY, "deferred init done")         \
+    X(RADIO, "first radio poll")
+/*模块登记:各模块在自己的源文件中以 BOOT_MODULE() 登记初始化函数、级别及依赖，登记项放在 bootModule 段中，
+  启动时按依赖顺序执行(Boot_Run)，未编译的模块没有登记项，也不再出现在启动代码中。
+  级别:BOOT_LEVEL_MAIN 在 main() 中、调度器启动前执行(关键I/O及其依赖)，
+  BOOT_LEVEL_STAGE 在启动任务中与已运行的输入采集等任务并行执行(RT-Thread下在创建线程前执行)；
+  依赖为以逗号分隔的模块名，未登记(未编译)的依赖视为已满足，前一级的模块均已完成*/
+#define BOOT_LEVEL_MAIN 0U
+#define BOOT_LEVEL_STAGE 1U
+/*登记的模块数上限(完成标记为一个字)*/
+#define BOOT_MODULES_MAX 32U
+#define BOOT_MODULE(name, level, init, depends)                                            \
+    __attribute__((used)) const Boot_Module Boot_Module_##name __attribute__((section("bootModule"))) = \
+        {#name, (init), (depends), (level)}
+/*可等待启动完成的任务数*/
+#define BOOT_WAITERS 8U
+/*启动完成信号，不与各任务自身的信号重叠*/
+#define BOOT_SIGNAL_READY 0x40000000U
+
+#define BOOT_MARK_ENUM(name, text) BOOT_MARK_##name,
+    enum
+    {
+        BOOT_MARK_TABLE(BOOT_MARK_ENUM)
+            BOOT_MARKS
+    };
+
+    typedef struct
+    {
+        const char *Name;
+        void (*Init)(void);
+        const char *Depends;
+        uint8_t Level;
+    } Boot_Module;
+
+    typedef struct
+    {
+        /*各节点的时刻(ms)及已到达的节点*/
+        uint32_t Tick[BOOT_MARKS];
+        uint32_t Marked;
+        /*延后的初始化已完成*/
+        bool Ready;
+        /*已完成的模块、因依赖无法满足而按登记顺序执行的模块(段内序号)及各模块的初始化用时(ms)*/
+        uint32_t Done;
+        uint32_t Forced;
+        uint16_t Module_Ms[BOOT_MODULES_MAX];
+        Os_Thread Waiter[BOOT_WAITERS];
+        uint8_t Waiters;
+    } Boot_HandleTypeDef;
+
+    extern void Boot_Run(uint8_t Level);
+    extern void Boot_Mark(uint8_t Mark);
+    extern void Boot_Done(void);
+    extern void Boot_Wait(void);
+    extern void Boot_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOT_H__ */
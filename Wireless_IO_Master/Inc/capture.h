@@ -0,0 +1,52 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*帧捕获(USING_CAPTURE，main.h):Modbus串口(L101)收发的每一帧连同时刻记入RAM环，环满时覆盖最早的帧；
+  capture_dump 按行导出 "时刻(ms) R|T 十六进制帧"，主机仿真构建的 md_replay 据此按原时序或加速回放*/
+/*环的字节数(2的幂)，L101短帧约可保存100帧*/
+#define CAPTURE_RING_SIZE 2048U
+#define CAPTURE_RX 0U
+#define CAPTURE_TX 1U
+/*记录:[时刻(4)][方向(1)][长度(2)][帧]，多字节字段为小端*/
+#define CAPTURE_HEAD_SIZE 7U
+/*capture_dump 每次打印的字节数*/
+#define CAPTURE_DUMP_BYTES 32U
+
+    typedef struct
+    {
+        bool Enabled;
+        /*最早及下一条记录的位置(字节序号，取模后为环内偏移)*/
+        uint32_t Tail;
+        uint32_t Head;
+        /*环内的帧数、捕获的帧数及被覆盖的帧数*/
+        uint32_t Records;
+        uint32_t Frames;
+        uint32_t Overwritten;
+        uint8_t Ring[CAPTURE_RING_SIZE];
+    } Capture_HandleTypeDef;
+
+#if defined(USING_CAPTURE)
+#define CAPTURE(dir, data, length) Capture_Frame(dir, data, length)
+#else
+#define CAPTURE(dir, data, length)
+#endif
+
+    extern void Capture_Frame(uint8_t Dir, const uint8_t *pData, uint32_t Length);
+    extern uint8_t Capture_Start(int Enable);
+    extern void Capture_Dump(void);
+    extern void Capture_Clear(void);
+    extern uint32_t Capture_Read(uint32_t Offset, uint8_t *pData, uint32_t Length);
+    extern uint32_t Capture_Used(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAPTURE_H__ */
@@ -0,0 +1,68 @@
+#ifndef __DEFER_H__
+#define __DEFER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "os_port.h"
+
+/*中断下半部(USING_DEFER，main.h):中断只取走硬件数据后登记处理函数，由最高优先级的 defer 任务执行；
+  每个来源一个槽，执行前重复登记的同一来源合并为一次(参数按位或)，不排队也不丢失*/
+#define DEFER_SIGNAL_POST 0x01U
+
+/*来源:X(名称, 说明)，按表中顺序执行*/
+#define DEFER_SOURCE_TABLE(X)                                \
+    /*ADC模拟看门狗越限，参数为越限方向(报警位)*/           \
+    X(AWD, "analog watchdog")                                \
+    /*抽取滤波器输出新的码值:校准、写寄存器、越限及发送判断*/ \
+    X(ADC, "adc result")                                     \
+    /*计量窗口结束:开方、换算及写寄存器(meter.h)*/           \
+    X(METER, "meter window")
+
+#define DEFER_SOURCE_ENUM(name, desc) DEFER_SRC_##name,
+    enum
+    {
+        DEFER_SOURCE_TABLE(DEFER_SOURCE_ENUM)
+            DEFER_SOURCES
+    };
+#undef DEFER_SOURCE_ENUM
+
+    typedef void (*Defer_Func)(uint32_t Arg);
+
+    typedef struct
+    {
+        Defer_Func Func;
+        /*合并后的参数*/
+        uint32_t Arg;
+        /*首次登记时的DWT周期计数*/
+        uint32_t Posted;
+        /*登记及执行次数，差值为被合并的次数*/
+        uint32_t Posts;
+        uint32_t Runs;
+        /*登记到开始执行及执行耗时的最大值(us)*/
+        uint32_t Latency_Max;
+        uint32_t Run_Max;
+    } Defer_Slot;
+
+    typedef struct
+    {
+        /*defer 任务，未运行时登记的函数直接在调用者中执行*/
+        Os_Thread Thread;
+        /*待执行的来源(位)*/
+        volatile uint32_t Pending;
+        Defer_Slot Slots[DEFER_SOURCES];
+    } Defer_HandleTypeDef;
+
+    extern void Defer_Post(uint8_t Source, Defer_Func Func, uint32_t Arg);
+    extern void Defer_Process(uint32_t Timeout);
+    extern void Defer_Show(void);
+    extern void Defer_Clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEFER_H__ */
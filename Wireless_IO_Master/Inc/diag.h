@@ -0,0 +1,59 @@
+#ifndef __DIAG_H__
+#define __DIAG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+#include "io_signal.h"
+#include "monitor.h"
+
+/*诊断帧:[同步字0xA5 0x5A][长度][帧序号][记录...][CRC16低字节][CRC16高字节]，
+长度为帧序号及全部记录的字节数，CRC16/MODBUS覆盖长度之后到CRC之前的内容；
+每条记录为 [类型][长度][内容]，多字节字段均为小端*/
+#define DIAG_SYNC0 0xA5U
+#define DIAG_SYNC1 0x5AU
+/*状态:[系统节拍(4)][堆剩余(4)][堆历史最小剩余(4)][最新SOE序号(4)][丢弃的帧数(4)]*/
+#define DIAG_TLV_STATUS 0x01U
+/*数字量:[线圈(DIAG_COILS位)][输入线圈(DIAG_COILS位)]，按位打包*/
+#define DIAG_TLV_COILS 0x02U
+/*输入寄存器快照:[起始地址(2)][寄存器...]，模拟量报警、模拟量及运行统计*/
+#define DIAG_TLV_INPUTS 0x03U
+/*SOE事件:每个事件 [序号(4)][毫秒时刻(4)][毫秒内微秒(2)][点号(1)][电平(1)]*/
+#define DIAG_TLV_SOE 0x04U
+/*打包的线圈数*/
+#define DIAG_COILS 32U
+/*输入寄存器快照范围:模拟量报警位到运行统计导出区末尾*/
+#define DIAG_REG_START_ADDR ANALOG_ALARM_ADDR
+#define DIAG_REG_SIZE (MONITOR_REG_START_ADDR + MONITOR_REG_SIZE - DIAG_REG_START_ADDR)
+/*每帧最多携带的SOE事件数，其余在后续帧中发送*/
+#define DIAG_SOE_EVENTS 4U
+#define DIAG_SOE_EVENT_SIZE 12U
+/*发送周期下限(ms):9600bps下一帧约需140ms*/
+#define DIAG_MIN_PERIOD 200U
+#define DIAG_FRAME_SIZE (6U + 22U + (2U + DIAG_COILS / 4U) + (4U + DIAG_REG_SIZE * 2U) + \
+                         (2U + DIAG_SOE_EVENTS * DIAG_SOE_EVENT_SIZE))
+
+    typedef struct
+    {
+        /*读取快照的寄存器池*/
+        RegisterPoolHandle Pool;
+        /*发送周期(ms)，为0时停止*/
+        uint32_t Period;
+        /*已发送的最新SOE序号*/
+        uint32_t Soe;
+        uint32_t Dropped;
+        uint8_t Sequence;
+        uint8_t Frame[DIAG_FRAME_SIZE];
+    } Diag_HandleTypeDef;
+
+    extern void Diag_Init(RegisterPoolHandle Pool);
+    extern void Diag_Start(uint32_t Period);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DIAG_H__ */
@@ -0,0 +1,93 @@
+#ifndef __DISCOVER_H__
+#define __DISCOVER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "io_signal.h"
+#include "mdrtumaster.h"
+
+/*入网发现(MODBUS_CODE_JOIN)，与从站 discover.h 一致:
+  信标(广播) |会话|轮次|时隙数|时隙长度(ms,2B)|
+  应答       |会话|轮次|数字量输入数|输出数|模拟量输入数|逻辑单元数|
+  从站对每个新轮次的信标随机选一个时隙应答，主站据应答把映射表中的事件加入就绪集合*/
+#define DISCOVER_BEACON_SIZE 5U
+#define DISCOVER_REPLY_SIZE 6U
+/*时隙长度(ms)须大于一帧应答的空中时间；时隙数按信道上的从站数取2倍(2的幂)，范围如下*/
+#define DISCOVER_SLOT_MS 150U
+#define DISCOVER_SLOTS_MIN 2U
+#define DISCOVER_SLOTS_MAX 16U
+/*每个信道的信标轮数(碰撞的从站在下一轮重新选择时隙)及最后一个时隙之后的等待(ms)*/
+#define DISCOVER_ROUNDS 2U
+#define DISCOVER_GUARD 300U
+/*记录的未映射从站数*/
+#define DISCOVER_UNKNOWN 8U
+/*Discover_Poll() 的返回值*/
+#define DISCOVER_UNAVAILABLE 0x00U
+#define DISCOVER_RUNNING 0x01U
+#define DISCOVER_FINISHED 0x02U
+
+    /*发现步骤*/
+    typedef enum
+    {
+        DISCOVER_IDLE = 0,
+        DISCOVER_BEACON,
+        DISCOVER_LISTEN,
+    } Discover_Phase;
+
+    /*应答了信标但不在映射表中的从站(l101_map 命令加入)*/
+    typedef struct
+    {
+        uint8_t Id;
+        uint8_t Channel;
+        uint8_t Inputs;
+        uint8_t Outputs;
+        uint8_t Analogs;
+        uint8_t Units;
+    } Discover_Node;
+
+    /*自由计数的统计(discover 命令查看)*/
+    typedef struct
+    {
+        uint32_t Beacons;
+        uint32_t Replies;
+        /*最近一次发现的耗时(ms)*/
+        uint32_t Elapsed;
+    } Discover_Stats;
+
+    typedef struct
+    {
+        uint8_t Frame[MASTER_PREFIX_SIZE + 2U + DISCOVER_BEACON_SIZE + 2U];
+        /*映射表中直接可达的信道及各信道上的从站数*/
+        uint8_t Channel[EXTERN_DIGITAL_MAX];
+        uint8_t Expected[EXTERN_DIGITAL_MAX];
+        uint8_t Channels;
+        /*当前信道下标、轮次及时隙数*/
+        uint8_t Index;
+        uint8_t Round;
+        uint8_t Slots;
+        uint8_t Session;
+        volatile Discover_Phase Phase;
+        volatile bool Pending;
+        /*当前信道已应答的站号位图及个数*/
+        uint8_t Heard[32];
+        volatile uint8_t Heard_Count;
+        /*本轮应答窗口的结束时刻(ms)*/
+        volatile uint32_t Deadline;
+        uint32_t Start;
+        Discover_Node Unknown[DISCOVER_UNKNOWN];
+        uint8_t Unknowns;
+        Discover_Stats Stats;
+    } Discover_HandleTypeDef;
+
+    extern uint8_t Discover_Poll(void);
+    extern bool Discover_Reply(const uint8_t *pFrame, uint32_t Length);
+    extern void Discover_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISCOVER_H__ */
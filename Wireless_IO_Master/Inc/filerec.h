@@ -0,0 +1,45 @@
+#ifndef __FILEREC_H__
+#define __FILEREC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtuslave.h"
+#include "kv.h"
+
+/*文件记录(20/21功能码)的文件表:批量数据经一帧读出多段寄存器，不再按03功能码每次125个寄存器分段；
+  文件内的记录号即寄存器序号，各文件开头为状态头，其后的数据由新到旧(或由旧到新)连续排列，
+  未记录的位置读出为0*/
+/*事件顺序记录(只读):[最新序号高16位][最新序号低16位]，随后第k条(k=0为最新)事件占
+  SOE_REG_EVENT_SIZE 个寄存器，格式与SOE输入寄存器导出区一致(soe.h)*/
+#define FILEREC_SOE 1U
+#define FILEREC_SOE_HEAD 2U
+/*趋势记录(只读，trend.h):文件号 FILEREC_TREND + 级号，
+  [最新窗口序号高16位][最新窗口序号低16位][窗口长度(s)][环深度]，随后第k个窗口(k=0为最新)的各通道依次为
+  [最小值][最大值][平均值][采样数]*/
+#define FILEREC_TREND 2U
+#define FILEREC_TREND_HEAD 4U
+/*参数(读写，kv.h):键k占记录 k * FILEREC_CONFIG_REGS 起的 FILEREC_CONFIG_REGS 个寄存器，内容为参数的原始字节
+  (每个寄存器两字节，高字节为低地址的字节)；写入须从键的首个记录开始，以写入的寄存器数为参数长度*/
+#define FILEREC_CONFIG 5U
+#define FILEREC_CONFIG_REGS (KV_VALUE_MAX / 2U)
+/*帧捕获(只读，capture.h):[环内字节数高16位][环内字节数低16位]，随后为由旧到新的捕获记录的原始字节*/
+#define FILEREC_CAPTURE 6U
+#define FILEREC_CAPTURE_HEAD 2U
+/*变化上报(只读，rbe.h):记录号为读取方已收到的最后一条事件的序号N(取模 RBE_SEQ_WRAP，首次读取为0)，
+  读出 [最新序号][第一条读出事件的序号][条数(最高位:N之后有事件已被覆盖)]，随后为N之后由旧到新的事件，
+  每条 FILEREC_RBE_EVENT 个寄存器 [点号][新值][时刻(ms)高16位][时刻低16位]，读出的条数受请求的寄存器数限制，
+  下次以最后一条读出事件的序号读取*/
+#define FILEREC_RBE 7U
+#define FILEREC_RBE_HEAD 3U
+#define FILEREC_RBE_EVENT 4U
+
+    extern void FileRec_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FILEREC_H__ */
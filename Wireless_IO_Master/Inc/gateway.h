@@ -0,0 +1,91 @@
+#ifndef __GATEWAY_H__
+#define __GATEWAY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+#include "mdrtuslave.h"
+
+/*显式路由条目数(整表作为一个参数保存，不超过 KV_VALUE_MAX)*/
+#define GATEWAY_ROUTES 5U
+/*帧槽数:同时在途的转发请求不超过主站流水线深度*/
+#define GATEWAY_SLOTS MASTER_MAX_PIPELINE
+/*转发请求的应答超时(ms)，本地主站的应答超时应大于该值*/
+#define GATEWAY_TIMEOUT 1000U
+/*帧内字节间隔超过该值(ms)视为帧结束(9600bps时t3.5约4ms)*/
+#define GATEWAY_FRAME_GAP 4U
+/*空闲时检查待回送应答的周期(ms)*/
+#define GATEWAY_POLL 5U
+/*本机从站号:上位机以该从站号直接访问本机寄存器池(共用主站协议栈的寄存器池)，不经无线转发；0:不启用*/
+#define GATEWAY_LOCAL_ID 0xF7U
+/*Modbus异常码:从站忙、网关路径不可用、网关目标无响应*/
+#define GATEWAY_EXCEPTION_BUSY 0x06U
+#define GATEWAY_EXCEPTION_PATH 0x0AU
+#define GATEWAY_EXCEPTION_TARGET 0x0BU
+/*帧槽状态:空闲、待提交(网关任务填好)、在途(请求引擎持有)、待回送*/
+#define GATEWAY_FREE 0x00U
+#define GATEWAY_READY 0x01U
+#define GATEWAY_WAIT 0x02U
+#define GATEWAY_REPLY 0x03U
+
+    /*一条显式路由:本地从站号 Unit 转发到节点 Addr/Channel 上的远端从站 Slave*/
+    typedef struct
+    {
+        uint16_t Addr;
+        uint8_t Unit;
+        uint8_t Slave;
+        uint8_t Channel;
+        /*条目有效*/
+        uint8_t Valid;
+    } Gateway_Route;
+
+    /*帧槽:Buf 前 MASTER_PREFIX_SIZE 字节为L101帧头预留区，请求在其后就地接收并直接发出，应答写回同一位置*/
+    typedef struct
+    {
+        uint8_t Buf[MASTER_PREFIX_SIZE + MODBUS_PDU_SIZE_MAX];
+        uint16_t Length;
+        /*本地主站使用的从站号，应答回送前改回*/
+        uint8_t Unit;
+        uint8_t Channel;
+        uint16_t Addr;
+        volatile uint8_t State;
+    } Gateway_Slot;
+
+    /*自由计数的统计(gw 命令查看)*/
+    typedef struct
+    {
+        uint32_t Rx;
+        uint32_t Tx;
+        uint32_t Bad_Frame;
+        uint32_t No_Route;
+        uint32_t Busy;
+        uint32_t Timeout;
+        uint32_t Error;
+        /*本机从站处理的请求数*/
+        uint32_t Local;
+    } Gateway_Stats;
+
+    typedef struct
+    {
+        Gateway_Route Route[GATEWAY_ROUTES];
+        Gateway_Slot Slot[GATEWAY_SLOTS];
+        Gateway_Stats Stats;
+        /*本机从站协议栈实例(无发送队列，应答写入 Local_Slot)*/
+        ModbusRTUSlaveHandler Local;
+        Gateway_Slot *Local_Slot;
+    } Gateway_HandleTypeDef;
+
+    extern void Gateway_Init(void);
+    extern void Gateway_Process(uint32_t Wait);
+    extern void Gateway_Submit(void);
+    extern uint8_t Gateway_Set_Route(int unit, int addr, int channel, int slave);
+    extern void Gateway_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GATEWAY_H__ */
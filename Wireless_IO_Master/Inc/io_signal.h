@@ -4,19 +4,61 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include "main.h"
+#include "board_cfg.h"
 
-/*定义外部数字量输入路数*/
-#define EXTERN_DIGITAL_MAX 8U
-/*定义外部模拟量输入路数*/
-#define EXTERN_ANALOG_MAX 2U
+/*定义外部数字量输入路数(board_cfg.h)*/
+#define EXTERN_DIGITAL_MAX BOARD_DIGITAL_COUNT
+/*定义外部模拟量输入路数(board_cfg.h)*/
+#define EXTERN_ANALOG_MAX BOARD_ANALOG_COUNT
 /*数字信号量在内存中初始地址*/
-#define DIGITAL_START_ADDR 0x00
-/*模拟信号量在内存中初始地址*/
-#define ANALOG_START_ADDR 0x00
-
+#define DIGITAL_START_ADDR BOARD_REG_DIGITAL
+/*12bit原始ADC码值在保持寄存器中的初始地址*/
+#define ANALOG_RAW_START_ADDR BOARD_REG_ANALOG_RAW
+/*数字量输入去抖时间(ms):最后一次边沿后保持稳定的时间*/
+#define DIGITAL_DEBOUNCE_TIME 5U
+/*校准后的模拟量在输入寄存器中的初始地址:每通道1个寄存器，通道0电流(uA)、通道1电压(mV)*/
+#define ANALOG_INPUT_START_ADDR BOARD_REG_ANALOG_INPUT
+/*模拟量发送死区默认值:绝对死区(12bit码值)、相对死区(上次发送值的0.1%)；
+两者取大，变化超过死区且距上次发送不小于最短间隔(ms)时才标记发送，
+到达最长间隔(s，为0时不限)时即使未变化也标记发送*/
+#define ANALOG_DEADBAND_ABSOLUTE 8U
+#define ANALOG_DEADBAND_PERCENT 5U
+#define ANALOG_PUBLISH_MIN_INTERVAL 200U
+#define ANALOG_PUBLISH_MAX_INTERVAL 60U
+/*校准系数存放的flash页(与Flash.c中的分区说明一致)*/
+#define ANALOG_CAL_PAGE 127U
+#define ANALOG_CAL_MAGIC 0x4341U
+#define ANALOG_CAL_VERSION 0x02U
+/*Modbus校准接口(保持寄存器):向命令寄存器写 通道<<8|命令，参考值(uA/mV)先写入参考值寄存器；
+执行完成后命令寄存器清0，失败时置为0xFFFF*/
+#define ANALOG_CAL_CMD_ADDR BOARD_REG_ANALOG_CAL
+#define ANALOG_CAL_VALUE_ADDR (BOARD_REG_ANALOG_CAL + 1U)
+/*校准命令:采集低点、采集高点并计算系数、保存到flash、恢复默认系数*/
+#define ANALOG_CAL_CMD_LOW 0x01
+#define ANALOG_CAL_CMD_HIGH 0x02
+#define ANALOG_CAL_CMD_SAVE 0x03
+#define ANALOG_CAL_CMD_RESET 0x04
+/*模拟量报警上下限(12bit码值)在保持寄存器中的初始地址:每通道[上限][下限]，为0时不检查*/
+#define ANALOG_LIMIT_START_ADDR BOARD_REG_ANALOG_LIMIT
+/*模拟量报警状态在输入寄存器中的地址:bit2n 通道n超上限，bit2n+1 通道n超下限*/
+#define ANALOG_ALARM_ADDR BOARD_REG_ANALOG_ALARM
+/*由ADC模拟看门狗监视的通道(与 MX_ADC1_Init 中模拟看门狗的 ADC_CHANNEL_2 对应)*/
+#define ANALOG_AWD_CHANNEL 1U
+/*输入任务信号:数字量输入产生边沿*/
+#define IO_SIGNAL_EDGE 0x01
+/*输入任务信号:收到Modbus校准命令*/
+#define IO_SIGNAL_CAL 0x02
 
 extern void Io_Digital_Handle(void);
+extern uint8_t Io_Digital_Snapshot(void);
+extern void Io_Digital_Edge(uint16_t GPIO_Pin);
+extern uint32_t Io_Digital_Debounce(void);
 extern void Io_Analog_Handle(void);
+extern bool Io_Analog_Cal_Load(void);
+extern int32_t Io_Analog_Gain(uint16_t Channel);
+extern uint8_t Io_Analog_Cal_Save(void);
+extern void Io_Analog_Cal_Command(void);
 
 #ifdef __cplusplus
 }
@@ -6,6 +6,7 @@ extern "C"
 {
 #endif
 #include "main.h"
+#include "os_port.h"
 
 /*用户波特率*/
 #define User_BaudRate 9600U
@@ -15,14 +16,54 @@ extern "C"
 #define MAX_PARAM 5U
 /*接收时的滤波次数*/
 #define MAX_SAMPING 3U
-/*1S*/
-#define TOTAL_TIMES 1000000.0F
-/*对应波特率时发送一位所用的时间*/
-#define BIT_TIMES(b) (TOTAL_TIMES / (float)b)
-/*获取定时时间规则*/
-#define GET_RULE1(b) (BIT_TIMES(b) * 5.0F / 13.0F)
-#define GET_RULE2(b) (BIT_TIMES(b) * 5.0F / 52.0F)
-#define GET_RULE3(b) (BIT_TIMES(b) * 21.0F / 26.0F)
+/*发送定时器(TIM3，不分频)与接收定时器(TIM4，72分频)的计数频率*/
+#define SUART_TX_CLOCK 72000000UL
+#define SUART_RX_CLOCK 1000000UL
+/*四舍五入的整数除法*/
+#define SUART_DIV_ROUND(n, d) (((n) + (d) / 2U) / (d))
+/*对应波特率时一位的发送定时器计数*/
+#define SUART_TX_TICKS(b) SUART_DIV_ROUND(SUART_TX_CLOCK, (b))
+/*对应波特率时一位的接收定时器计数(Q8定点，保留小数部分)*/
+#define SUART_BIT_Q8(b) SUART_DIV_ROUND(SUART_RX_CLOCK * 256UL, (b))
+/*获取定时时间规则:一位时间的 num/den(接收定时器计数)*/
+#define SUART_RULE(b, num, den) SUART_DIV_ROUND(SUART_RX_CLOCK * (num), (b) * (den))
+#define GET_RULE1(b) SUART_RULE(b, 5UL, 13UL)
+#define GET_RULE2(b) SUART_RULE(b, 5UL, 52UL)
+#define GET_RULE3(b) SUART_RULE(b, 21UL, 26UL)
+/*每位三次采样间隔之和与一位时间的误差(Q8)，逐位累加后补偿*/
+#define GET_RULE_ERROR(b) ((int32_t)SUART_BIT_Q8(b) - (int32_t)((GET_RULE2(b) * 2UL + GET_RULE3(b)) * 256UL))
+/*定时器周期为计数值减1*/
+#define SUART_SET_PERIOD(htim, ticks) __HAL_TIM_SET_AUTORELOAD((htim), (uint32_t)(ticks)-1U)
+/*中断热路径中直接读写寄存器启停定时器更新中断，不经过HAL状态机(定时器句柄的State不再变化)*/
+#define SUART_TIM_START_IT(tim) ((tim)->SR = ~TIM_SR_UIF, (tim)->DIER |= TIM_DIER_UIE, (tim)->CR1 |= TIM_CR1_CEN)
+#define SUART_TIM_STOP_IT(tim) ((tim)->DIER &= ~TIM_DIER_UIE, (tim)->CR1 &= ~TIM_CR1_CEN, (tim)->CNT = 0U)
+/*经BSRR输出引脚电平，经IDR读取引脚电平*/
+#define SUART_PIN_WRITE(port, pin, level) ((port)->BSRR = (level) ? (uint32_t)(pin) : ((uint32_t)(pin) << 16U))
+#define SUART_PIN_READ(port, pin) (((port)->IDR & (pin)) ? 1U : 0U)
+/*发送时由定时器更新事件触发DMA把预先展开的波形写入BSRR(注释后为逐位中断发送)*/
+#define USING_SUART_DMA_TX
+/*DMA发送波形缓冲区半区长度(公共节拍数)*/
+#define SUART_WAVE_HALF 64U
+/*共用一组定时器的模拟串口通道数*/
+#define SUART_MAX_CHANNELS 3U
+/*接收时在边沿中断中记录时间戳，在任务中按边沿间隔解码(注释后为每位三次定时采样)*/
+#define USING_SUART_EDGE_RX
+/*边沿时间戳缓冲区长度(2的幂)*/
+#define SUART_EDGE_SIZE 64U
+/*发送环形缓冲区长度(2的幂)*/
+#define SUART_TX_RING_SIZE 128U
+/*校准(需DMA发送及边沿接收):发送引脚经跳线回接接收引脚，按波特率表逐档发送已知码型，统计各边沿
+  相对起始位下降沿的偏差(即解码时实际看到的边沿中断延迟差)，得到采样点修正并保存到参数区*/
+#if defined(USING_SUART_DMA_TX) && defined(USING_SUART_EDGE_RX)
+#define USING_SUART_CAL
+#endif
+/*每档发送码型的轮数(每轮的边沿数不超过边沿缓冲区)*/
+#define SUART_CAL_ROUNDS 8U
+/*修正后边沿偏差不超过一位时间的 1/SUART_CAL_MARGIN 时该档可用，其余裕量留给对端时钟偏差及线路畸变*/
+#define SUART_CAL_MARGIN 4U
+/*读写任务阻塞等待的信号*/
+#define SUART_SIGNAL_RX 0x01
+#define SUART_SIGNAL_TX 0x02
 
     typedef enum
     {
@@ -70,6 +111,20 @@ extern "C"
             uint8_t *pBuf;        /*发送缓冲区指针*/
             uint16_t Total_Times; /*发送一个字节花费的时间*/
             bool Finsh_Flag;      /*发送完成标志*/
+#if defined(USING_SUART_DMA_TX)
+            GPIO_TypeDef *Port;             /*发送引脚*/
+            uint16_t Pin;
+            uint16_t Frame;                 /*正在发送的位序列(低位先发)*/
+            uint8_t Frame_Bits;             /*剩余位数*/
+            uint8_t Level;                  /*当前输出电平*/
+            uint16_t Div;                   /*每位的公共节拍数*/
+            uint16_t Sub;                   /*当前位剩余节拍数*/
+            bool Freed;                     /*本次填充取出了数据*/
+            uint8_t Ring[SUART_TX_RING_SIZE]; /*发送环形缓冲区:任务写入，DMA完成中断取出*/
+            volatile uint16_t Ring_Head;
+            volatile uint16_t Ring_Tail;
+            volatile Os_Thread Waiter;      /*等待缓冲区空间的任务*/
+#endif
         } Tx;
         struct
         {
@@ -77,6 +132,8 @@ extern "C"
             TIM_HandleTypeDef *Timer_Handle;
             bool En;
             IRQn_Type IRQn; /*接收引脚的外部中断*/
+            GPIO_TypeDef *Port; /*接收引脚*/
+            uint16_t Pin;
             Uart_State Status;
             uint8_t Bits;                       /*接收位计数*/
             uint8_t Filters;                    /*滤波次数*/
@@ -84,16 +141,47 @@ extern "C"
             uint16_t Len;                       /*接收到数据长度统计*/
             uint8_t *pBuf;                      /*接收缓冲区指针*/
             uint16_t Sam_Times[MAX_PARAM - 1U]; /*三次采样时间*/
+            uint32_t Bit_Q8;                    /*一位时间(Q8定点)*/
+            int16_t Bit_Error;                  /*每位采样间隔的累计误差(Q8)*/
+            int16_t Frac;                       /*当前字节已累计的误差(Q8)*/
+            int16_t Bias;                       /*采样点修正(us)，由校准得到*/
             bool Finsh_Flag;                    /*接收完成标志*/
+#if defined(USING_SUART_EDGE_RX)
+            uint32_t Edges[SUART_EDGE_SIZE]; /*边沿记录:低16位为定时器计数(us)，bit16为边沿后的电平*/
+            volatile uint16_t Edge_Head;     /*中断写入位置*/
+            volatile uint16_t Edge_Tail;     /*任务读取位置*/
+            volatile uint32_t Edge_Tick;     /*最后一个边沿的系统时刻(ms)*/
+            uint32_t Edge_Lost;              /*缓冲区满丢弃的边沿数*/
+            uint32_t Frame_Errors;           /*停止位错误的字节数*/
+            bool Busy;                       /*正在解码一个字节*/
+            uint8_t Level;                   /*已处理边沿后的线路电平*/
+            uint16_t Start;                  /*起始位下降沿时间戳*/
+            volatile Os_Thread Waiter;      /*等待接收数据的任务*/
+#endif
+#if defined(USING_SUART_CAL)
+            volatile Os_Thread Cal;         /*正在校准的任务，期间其他任务不能收发*/
+#endif
         } Rx;
         Check Check_Type;
+        uint32_t Baud_Rate;
     } IoUart_HandleTypeDef __attribute__((aligned(4)));
 
     extern IoUart_HandleTypeDef S_Uart1;
     extern void MX_Suart_Init(void);
+    extern bool MX_Suart_Register(IoUart_HandleTypeDef *huart);
     extern bool Get_ValidBits(uint8_t n);
+    extern uint16_t Suart_Sample_Ticks(IoUart_HandleTypeDef *huart, uint8_t index);
     extern HAL_StatusTypeDef HAL_SUART_Transmit(IoUart_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
     extern HAL_StatusTypeDef HAL_SUART_Receive(IoUart_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+#if defined(USING_SUART_CAL)
+    extern void Suart_Calibrate(void);
+#endif
+#if !defined(USING_SUART_DMA_TX)
+    extern void Suart_Tx_IRQHandler(void);
+#endif
+#if !defined(USING_SUART_EDGE_RX)
+    extern void Suart_Rx_IRQHandler(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,69 @@
+#ifndef __IRQ_PRIO_H__
+#define __IRQ_PRIO_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*中断优先级方案:优先级分组4(4位抢占优先级，无子优先级)，数值越小越优先；各外设中断的优先级只在本表中给出，
+  启动时覆盖CubeMX生成的值(irq_prio.c)。
+  内核中断(IRQ_KERNEL)会调用RTOS的中断接口(Os_Signal_Set、osSignalSet、osMessagePut等)，优先级不得高于
+  系统调用上限 IRQ_SYSCALL_CEILING(编译期检查)；裸中断(IRQ_BARE)高于上限，不受内核临界区屏蔽，只做不调用RTOS的定时工作。
+  模拟串口的逐位收发定时位于内核中断之上，抖动与USART及内核临界区无关；边沿接收须唤醒任务，为最高的内核中断*/
+#define IRQ_BARE 0U
+#define IRQ_KERNEL 1U
+
+#if defined(USING_RTTHREAD)
+/*RT-Thread关中断使用PRIMASK，无系统调用上限*/
+#define IRQ_SYSCALL_CEILING 0U
+#else
+#include "FreeRTOSConfig.h"
+#define IRQ_SYSCALL_CEILING configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#endif
+
+#if defined(USING_UTIMER)
+/*TIM4为微秒定时器(utimer.h)的比较及溢出中断，到期回调会唤醒任务，为最高的内核中断*/
+#define IRQ_TIM4_PRIORITY 5U
+#define IRQ_TIM4_TYPE IRQ_KERNEL
+#else
+#define IRQ_TIM4_PRIORITY 1U
+#define IRQ_TIM4_TYPE IRQ_BARE
+#endif
+
+/*X(中断号, 抢占优先级, 类型)*/
+#define IRQ_PRIORITY_TABLE(X)                                                  \
+    /*HAL时基，只递增计数*/                                                    \
+    X(TIM1_UP_IRQn, TICK_INT_PRIORITY, IRQ_BARE)                               \
+    /*模拟串口逐位采样(未开启 USING_SUART_EDGE_RX 时)或微秒定时器*/            \
+    X(TIM4_IRQn, IRQ_TIM4_PRIORITY, IRQ_TIM4_TYPE)                             \
+    /*模拟串口逐位发送(未开启 USING_SUART_DMA_TX 时)*/                         \
+    X(TIM3_IRQn, 2U, IRQ_BARE)                                                 \
+    /*模拟串口接收边沿，入口处取时间戳；同一中断线服务DDI2~DDI4*/              \
+    X(EXTI9_5_IRQn, 5U, IRQ_KERNEL)                                            \
+    /*模拟串口发送波形的半区填充，须在另一半区播放完之前完成*/                 \
+    X(DMA1_Channel3_IRQn, 5U, IRQ_KERNEL)                                      \
+    /*USART1(Modbus、AT及L101透传)及其收发DMA*/                                \
+    X(USART1_IRQn, 6U, IRQ_KERNEL)                                             \
+    X(DMA1_Channel4_IRQn, 6U, IRQ_KERNEL)                                      \
+    X(DMA1_Channel5_IRQn, 6U, IRQ_KERNEL)                                      \
+    /*L101模块STATUS引脚；同一中断线服务DDI7*/                                 \
+    X(EXTI15_10_IRQn, 6U, IRQ_KERNEL)                                          \
+    /*ADC的DMA(抽取滤波)及模拟看门狗*/                                         \
+    X(DMA1_Channel1_IRQn, 7U, IRQ_KERNEL)                                      \
+    X(ADC1_2_IRQn, 7U, IRQ_KERNEL)                                             \
+    /*数字量输入DDI0、DDI1、DDI5、DDI6*/                                       \
+    X(EXTI3_IRQn, 8U, IRQ_KERNEL)                                              \
+    X(EXTI4_IRQn, 8U, IRQ_KERNEL)                                              \
+    X(EXTI0_IRQn, 8U, IRQ_KERNEL)                                              \
+    X(EXTI1_IRQn, 8U, IRQ_KERNEL)
+
+    extern void Irq_Priority_Init(void);
+    extern void Irq_Priority_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IRQ_PRIO_H__ */
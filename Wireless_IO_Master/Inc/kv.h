@@ -0,0 +1,65 @@
+#ifndef __KV_H__
+#define __KV_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*参数存储区占用的两页(与Flash.c中的分区说明一致)，交替作为活动页*/
+#define KV_PAGE_A 123U
+#define KV_PAGE_B 124U
+#define KV_PAGE_SIZE FLASH_PAGE_SIZE
+#define KV_PAGE_ADDR(n) (FLASH_BASE + (uint32_t)(n) * KV_PAGE_SIZE)
+#define KV_MAGIC 0x4B56U
+/*单个参数的最大字节数*/
+#define KV_VALUE_MAX 32U
+/*无效键(擦除后的值)*/
+#define KV_KEY_NONE 0xFFU
+/*参数键*/
+#define KV_KEY_BOOTS 0x01U
+/*曾经在线的调度节点集合，上电时作为调度提示*/
+#define KV_KEY_NODES 0x02U
+/*网关显式路由表*/
+#define KV_KEY_GATEWAY 0x03U
+/*多主站时隙接入配置*/
+#define KV_KEY_TDMA 0x04U
+/*第二个L101模块服务的信道表*/
+#define KV_KEY_RADIO 0x05U
+/*经中继访问的节点路由表*/
+#define KV_KEY_HOP 0x06U
+/*帧认证开关及密钥*/
+#define KV_KEY_AUTH 0x07U
+/*模拟串口各档波特率的采样点修正*/
+#define KV_KEY_SUART 0x08U
+/*本机逻辑程序，占用 LOGIC_KV_CHUNKS 个连续的键(logic.h)*/
+#define KV_KEY_LOGIC 0x09U
+/*数字量输入的计数模式(pulse.h)*/
+#define KV_KEY_PULSE 0x0DU
+/*热备主站配置(standby.h)*/
+#define KV_KEY_STANDBY 0x0EU
+
+    /*页格式:[KV_MAGIC][代数]，随后依次追加记录
+      记录格式:[长度<<8|键][版本][数据(补齐到半字)][CRC16]，CRC覆盖记录头、版本及数据*/
+    typedef struct
+    {
+        /*活动页地址*/
+        uint32_t Page;
+        /*活动页代数，整理时加1，较新的一页为活动页*/
+        uint16_t Gen;
+        /*下一条记录的半字偏移*/
+        uint16_t Tail;
+    } Kv_HandleTypeDef;
+
+    extern void Kv_Init(void);
+    extern uint16_t Kv_Get(uint8_t Key, void *pValue, uint16_t Size);
+    extern bool Kv_Set(uint8_t Key, const void *pValue, uint16_t Size);
+    extern void Kv_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KV_H__ */
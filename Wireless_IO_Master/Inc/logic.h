@@ -0,0 +1,121 @@
+#ifndef __LOGIC_H__
+#define __LOGIC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*本机逻辑(USING_LOGIC，main.h):固定周期扫描，每周期先取输入快照，按程序逐条求值，
+  最后只把变化的线圈写回寄存器池，调度器经线圈的变化订阅下发到远端从站；
+  程序为布尔栈上的指令表(与IEC 61131-3的IL相近)，由 logic_add 编辑，logic_save 保存*/
+/*扫描周期(ms)*/
+#define LOGIC_PERIOD 10U
+/*程序的最大指令数，保存为 LOGIC_KV_CHUNKS 个参数(kv.h)*/
+#define LOGIC_MAX_INSNS 32U
+#define LOGIC_KV_CHUNKS 4U
+/*布尔栈深度、定时器及边沿存储个数*/
+#define LOGIC_STACK_DEPTH 8U
+#define LOGIC_TIMERS 8U
+#define LOGIC_EDGES 16U
+/*各位空间的位数:输入线圈、线圈及中间变量的地址均为 0 ~ LOGIC_BITS-1*/
+#define LOGIC_BITS 32U
+/*位空间(LD/ST的 Arg)*/
+#define LOGIC_SPACE_INPUT 0x00U
+#define LOGIC_SPACE_COIL 0x01U
+#define LOGIC_SPACE_MARKER 0x02U
+#define LOGIC_SPACES 3U
+/*比较指令的寄存器(GT/LT的 Arg):低7位为地址，最高位置1时为保持寄存器，否则为输入寄存器*/
+#define LOGIC_REG_HOLD 0x80U
+#define LOGIC_REG_ADDR_MASK 0x7FU
+/*Logic_Check 的返回值:程序有效*/
+#define LOGIC_OK 0xFFU
+/*程序变化时唤醒空闲的逻辑任务*/
+#define LOGIC_SIGNAL_LOAD 0x01U
+
+/*指令:X(助记符, 出栈数, 入栈数, 说明)；Arg 与 Operand 的含义见说明，操作码为表中序号，0为程序结束*/
+#define LOGIC_OP_TABLE(X)                                         \
+    X(END, 0U, 0U, "end of program")                              \
+    /*Arg:位空间 Operand:地址*/                                 \
+    X(LD, 0U, 1U, "push bit")                                     \
+    X(LDN, 0U, 1U, "push inverted bit")                           \
+    /*栈顶写入线圈或中间变量，不出栈*/                          \
+    X(ST, 1U, 1U, "store top")                                    \
+    X(STN, 1U, 1U, "store inverted top")                          \
+    /*栈顶为1时置位/复位*/                                      \
+    X(SET, 1U, 1U, "set if top")                                  \
+    X(RST, 1U, 1U, "reset if top")                                \
+    X(AND, 2U, 1U, "and")                                         \
+    X(OR, 2U, 1U, "or")                                           \
+    X(XOR, 2U, 1U, "xor")                                         \
+    X(NOT, 1U, 1U, "not")                                         \
+    X(POP, 1U, 0U, "drop top")                                    \
+    /*Arg:定时器号 Operand:设定值(ms)，栈顶为输入，替换为输出*/ \
+    X(TON, 1U, 1U, "on delay")                                    \
+    X(TOF, 1U, 1U, "off delay")                                   \
+    /*Arg:边沿存储号，栈顶替换为一个扫描周期的脉冲*/            \
+    X(RISE, 1U, 1U, "rising edge")                                \
+    X(FALL, 1U, 1U, "falling edge")                               \
+    /*Arg:寄存器 Operand:常数，比较结果入栈*/                   \
+    X(GT, 0U, 1U, "register > constant")                          \
+    X(LT, 0U, 1U, "register < constant")
+
+#define LOGIC_OP_ENUM(name, pops, pushes, desc) LOGIC_OP_##name,
+    enum
+    {
+        LOGIC_OP_TABLE(LOGIC_OP_ENUM)
+            LOGIC_OPS
+    };
+#undef LOGIC_OP_ENUM
+
+    typedef struct
+    {
+        uint8_t Op;
+        uint8_t Arg;
+        uint16_t Operand;
+    } Logic_Insn;
+
+    typedef struct
+    {
+        /*计时起点(系统节拍)*/
+        uint32_t Start;
+        uint8_t Running;
+        uint8_t Q;
+    } Logic_Timer;
+
+    typedef struct
+    {
+        Logic_Insn Program[LOGIC_MAX_INSNS];
+        /*有效指令数(至END为止)*/
+        uint8_t Count;
+        /*首条无效指令的序号，LOGIC_OK:程序有效*/
+        uint8_t Error;
+        Logic_Timer Timer[LOGIC_TIMERS];
+        /*边沿存储:上一周期的输入*/
+        uint16_t Edge;
+        uint32_t Marker;
+        /*上一周期开始时的DWT周期计数，0:尚未扫描*/
+        uint32_t Last;
+        uint32_t Scans;
+        /*扫描耗时超过周期的次数及写回的线圈数*/
+        uint32_t Overruns;
+        uint32_t Writes;
+        /*周期抖动及扫描耗时(us)*/
+        uint32_t Jitter_Max;
+        uint32_t Scan_Last;
+        uint32_t Scan_Max;
+    } Logic_HandleTypeDef;
+
+    extern void Logic_Init(void);
+    extern bool Logic_Ready(void);
+    extern uint8_t Logic_Check(const Logic_Insn *pProgram, uint8_t Count);
+    extern void Logic_Scan(void);
+    extern void Logic_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOGIC_H__ */
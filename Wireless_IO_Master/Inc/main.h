@@ -45,8 +45,56 @@ extern "C" {
 #define USING_DEBUG 1
 #define USING_RTOS
 #define MDTASK_SENDTIMES 50U
+/*变位触发发送:输入变化时立即下发，空闲时仅发送心跳帧*/
+#define USING_COS_MODE
+/*同一从站的线圈合并为一帧(FC15)发送*/
+#define USING_BATCH_FRAME
+/*根据链路质量自动调整速率等级(需从站同步改变速率)*/
+// #define USING_L101_AUTO_SPD
+/*拥塞控制:遥测、心跳及诊断请求按速率限制发出，信道干净时加性提速，丢包时乘性降速(l101_rate 命令)*/
+#define USING_AIMD
+/*占空比预算:按空中时间模型统计主模块在滑动窗口内的发送时间，余量不足时先停发遥测及诊断请求，耗尽时停止发送(l101_duty 命令)*/
+#define USING_AIRTIME
 // #define USING_L101
 #define USING_IO_UART
+/*网关:软件串口(RS-485)上的Modbus RTU请求经L101转发到远端从站(需 USING_IO_UART)*/
+// #define USING_GATEWAY
+/*多主站时隙接入:各主站只在分配的时隙内发送，成员跟随协调者的信标同步*/
+// #define USING_TDMA
+/*热备主站:备用主站接收工作主站的调度状态镜像，工作主站停止发出镜像时接管(standby 命令)*/
+// #define USING_STANDBY
+/*第二个L101模块接在软件串口上，按信道分组与第一个模块并行轮询(需 USING_IO_UART，与网关互斥)*/
+// #define USING_L101_RADIO2
+/*ADC由TIM1_CC1(时基定时器比较事件)同步触发扫描，关闭时ADC连续转换*/
+#define USING_ADC_TIMER_TRIGGER
+/*延迟测量点:事件及DWT周期计数记入RAM环并统计直方图，关闭时测量点不产生代码*/
+#define USING_TRACE
+/*分块传输:从站的事件记录、配置及转发表经LZSS压缩后分块读写(xfer_get/xfer_put 命令)*/
+#define USING_XFER
+/*固件分发:从站映像以广播分块发出，按各从站的缺块位图补发(ota_start 命令)，需128KB flash的器件*/
+#define USING_OTA
+/*入网发现:首次上电广播信标，从站在随机时隙应答，代替逐个扫描映射表(不在线的从站不再拖慢组网)*/
+#define USING_DISCOVER
+/*时间同步:心跳节拍中轮流向在线从站发出主站时刻，从站据此换算事件时刻(SOE)为主站时间*/
+#define USING_TIMESYNC
+/*帧捕获:Modbus串口收发的帧及时刻记入2KB的RAM环(capture/capture_dump 命令)，供主机仿真构建回放(md_replay)*/
+// #define USING_CAPTURE
+/*中断下半部:ADC滤波输出及模拟看门狗的处理由最高优先级的 defer 任务执行，中断只登记(defer 命令)*/
+#define USING_DEFER
+/*本机逻辑:按固定周期扫描布尔指令表(与/或/非、TON/TOF、边沿、模拟量比较)驱动线圈，连锁逻辑无需经上位PLC往返(logic_add 命令)*/
+// #define USING_LOGIC
+/*脉冲计数:选为计数模式的数字量输入在边沿中断中计数并测频，计数及频率写入输入寄存器(pulse_set 命令)*/
+#define USING_PULSE
+/*趋势记录:校准后的模拟量按秒/分钟/15分钟窗口聚合为最小/最大/平均值，保存在RAM环中(trend 命令)*/
+#define USING_TREND
+/*计量:电流、电压两路同步采样，在ADC的DMA中断中以Q15定点累加，每秒输出有效值、有功功率、功率因数及电能(meter 命令)，需 USING_ADC_TIMER_TRIGGER*/
+#define USING_METER
+/*输出场景:从站保存预设的多路输出，一帧(可广播)即可同时切换(scene_apply 命令)，场景表经分块传输写入(scene_put 命令)*/
+#define USING_SCENE
+/*变化上报:寄存器池中的点变化时(线圈逐位、寄存器超过死区)记入带序号的RAM环，本地SCADA以一帧20功能码读取某序号之后的事件(rbe 命令)*/
+#define USING_RBE
+/*微秒定时器:TIM4(模拟串口边沿接收的时间基准)扩展为32位微秒时钟，单次/周期定时器按最近的到期时刻设置一次比较中断，应答超时到期即判定(utimer 命令)*/
+#define USING_UTIMER
 #if defined(USING_FREERTOS)
 /*Custom memory management*/
 #define CUSTOM_MALLOC pvPortMalloc
@@ -78,7 +126,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
-
+void Boot_Stage(void);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
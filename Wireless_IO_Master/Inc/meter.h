@@ -0,0 +1,65 @@
+#ifndef __METER_H__
+#define __METER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "board_cfg.h"
+
+/*计量(USING_METER，main.h):通道0电流、通道1电压同一次扫描转换(两通道采样间隔约7us，相位误差可忽略)，
+  在ADC的DMA半满/全满中断中把每个采样换为相对半量程的Q15值，累加 Σi、Σv、Σi²、Σv²、Σvi；
+  每 METER_WINDOW 个采样(整数个50/60Hz周期)结束一个窗口，由 defer 任务开方、换算并写入输入寄存器。
+  前端须把交流信号偏置在半量程，均值(直流分量)从结果中扣除；工程单位同校准后的模拟量(uA/mV)*/
+#define METER_CHANNEL_I 0U
+#define METER_CHANNEL_V 1U
+/*窗口采样数:TIM1触发时为1kHz，1s为50Hz的50个周期、60Hz的60个周期；须为半个DMA环的整数倍*/
+#define METER_WINDOW 1000U
+/*输入寄存器布局(高字在前):[电流有效值uA][电压有效值mV][有功功率uW(有符号,2)][正向有功电能uWh(2)]
+  [功率因数x1000(有符号)][窗口序号]*/
+#define METER_REG_IRMS 0U
+#define METER_REG_VRMS 1U
+#define METER_REG_POWER 2U
+#define METER_REG_ENERGY 4U
+#define METER_REG_PF 6U
+#define METER_REG_SEQ 7U
+#define METER_REG_SIZE 8U
+
+    /*一个窗口的累加值(Q15采样及其Q30乘积)*/
+    typedef struct
+    {
+        int32_t Sum_I;
+        int32_t Sum_V;
+        uint64_t Sum_II;
+        uint64_t Sum_VV;
+        int64_t Sum_VI;
+        uint32_t Count;
+    } Meter_Acc;
+
+    typedef struct
+    {
+        /*中断中累加的当前窗口，及交给 defer 任务的上一个窗口*/
+        Meter_Acc Acc;
+        Meter_Acc Done;
+        /*最近一个窗口的结果:有效值(uA/mV)、有功功率(nW)及功率因数(x1000)*/
+        uint16_t Irms;
+        uint16_t Vrms;
+        int32_t Power;
+        int16_t Pf;
+        /*正向有功电能(nW*ms)*/
+        uint64_t Energy;
+        /*结束的窗口数，及 defer 任务尚未取走时被覆盖的窗口数*/
+        uint32_t Windows;
+        uint32_t Overruns;
+    } Meter_HandleTypeDef;
+
+    extern void Meter_Clear(void);
+    extern void Meter_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __METER_H__ */
@@ -0,0 +1,54 @@
+#ifndef __MODE_H__
+#define __MODE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*各工作模式停放的对象(位掩码):Modbus任务、轮询定时器、无线调度任务、shell任务*/
+#define MODE_PARK_MDBUS 0x01U
+#define MODE_PARK_POLL 0x02U
+#define MODE_PARK_RADIO 0x04U
+#define MODE_PARK_SHELL 0x08U
+/*唤醒At任务的信号:shell请求自由AT模式、链路管理改变速率等级、网络功耗配置待写入、后台AT作业已排队*/
+#define MODE_SIGNAL_FREE 0x01U
+#define MODE_SIGNAL_LINK 0x02U
+#define MODE_SIGNAL_POWER 0x04U
+#define MODE_SIGNAL_JOB 0x08U
+
+    /*工作模式:运行、AT配置(串口交给AT引擎)、shell(串口交给控制台)*/
+    typedef enum
+    {
+        MODE_RUN = 0,
+        MODE_CONFIG,
+        MODE_SHELL,
+    } Mode_TypeDef;
+
+    typedef struct
+    {
+        Mode_TypeDef Current;
+        /*进入配置模式前的模式，退出时恢复*/
+        Mode_TypeDef Previous;
+        /*当前被停放的任务*/
+        uint8_t Parked;
+        /*由配置模式停放、退出时须恢复的任务*/
+        uint8_t Config;
+        /*shell隧道会话进行中*/
+        bool Tunnel;
+    } Mode_HandleTypeDef;
+
+    extern void Mode_Init(void);
+    extern bool Mode_Enter(Mode_TypeDef Target);
+    extern bool Mode_Leave(void);
+    extern Mode_TypeDef Mode_Get(void);
+    extern void Mode_Request(uint32_t Signal);
+    extern void Mode_Tunnel(bool Open);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODE_H__ */
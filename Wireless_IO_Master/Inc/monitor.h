@@ -0,0 +1,56 @@
+#ifndef __MONITOR_H__
+#define __MONITOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+#include "board_cfg.h"
+
+/*可统计的任务数上限(含空闲任务及定时器服务任务)*/
+#define MONITOR_MAX_TASKS 12U
+/*统计周期(ms)，CPU占用率为周期内的平均值*/
+#define MONITOR_PERIOD 1000U
+/*运行统计在输入寄存器中的初始地址*/
+#define MONITOR_REG_START_ADDR BOARD_REG_MONITOR
+/*输入寄存器中导出的任务数，每个任务占 MONITOR_REG_TASK_SIZE 个寄存器*/
+#define MONITOR_REG_TASKS 8U
+#define MONITOR_REG_TASK_SIZE 2U
+/*导出区:[CPU占用率(0.1%)][堆剩余(字节)][堆历史最小剩余(字节)][任务数]，
+随后按任务创建顺序排列 [任务CPU占用率(0.1%)][栈历史最小剩余(字)]*/
+#define MONITOR_REG_SIZE (4U + MONITOR_REG_TASKS * MONITOR_REG_TASK_SIZE)
+
+    /*一个任务的运行统计*/
+    typedef struct
+    {
+        const char *Name;
+        /*上一周期结束时的累计运行时间*/
+        uint32_t Last;
+        /*周期内CPU占用率(0.1%)*/
+        uint16_t Load;
+        /*栈历史最小剩余(字)*/
+        uint16_t Stack;
+    } Monitor_Task;
+
+    typedef struct
+    {
+        /*按任务号(创建顺序)存放*/
+        Monitor_Task Task[MONITOR_MAX_TASKS];
+        uint8_t Count;
+        /*上一周期结束时的运行时间基准*/
+        uint32_t Last;
+        /*周期内CPU占用率(0.1%)，即非空闲任务的占用率之和*/
+        uint16_t Load;
+        /*导出运行统计的寄存器池(可为 NULL)*/
+        RegisterPoolHandle Pool;
+    } Monitor_HandleTypeDef;
+
+    extern void Monitor_Init(RegisterPoolHandle Pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MONITOR_H__ */
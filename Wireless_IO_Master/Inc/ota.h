@@ -0,0 +1,100 @@
+#ifndef __OTA_H__
+#define __OTA_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+
+/*固件分发(MODBUS_CODE_OTA)，与从站 ota.h 一致，多字节字段高字节在前:
+  开始(广播) |0x01|会话|映像长度(4B)|映像CRC32(4B)|版本(2B)|
+  数据(广播) |0x02|会话|块号(2B)|数据(OTA_CHUNK，最后一块可更短)|
+  查询       |0x03|会话|起始块号(2B)| -> |0x03|会话|状态|缺少的块数(2B)|窗口起始块号(2B)|缺块位图(OTA_WINDOW/8)|
+  激活(广播) |0x04|会话|*/
+#define OTA_OP_BEGIN 0x01U
+#define OTA_OP_DATA 0x02U
+#define OTA_OP_STATUS 0x03U
+#define OTA_OP_ACTIVATE 0x04U
+/*从站接收状态*/
+#define OTA_STATE_NONE 0x00U
+#define OTA_STATE_RECEIVING 0x01U
+#define OTA_STATE_VERIFIED 0x02U
+#define OTA_STATE_BAD 0x03U
+#define OTA_CHUNK 64U
+#define OTA_WINDOW 128U
+#define OTA_STATUS_SIZE (8U + OTA_WINDOW / 8U)
+/*待分发的从站映像:128KB器件的后64KB，由烧录器写入(一次烧录主站代替逐台烧录从站)*/
+#define OTA_IMAGE_ADDR 0x08010000UL
+#define OTA_IMAGE_MAX 0xF800UL
+#define OTA_CHUNKS_MAX ((OTA_IMAGE_MAX + OTA_CHUNK - 1U) / OTA_CHUNK)
+/*开始及激活帧的重复次数、补发轮数上限、查询的重试次数及应答超时(ms)*/
+#define OTA_REPEATS 3U
+#define OTA_ROUNDS 8U
+#define OTA_RETRIES 3U
+#define OTA_TIMEOUT 1000U
+
+    /*分发步骤*/
+    typedef enum
+    {
+        OTA_IDLE = 0,
+        OTA_BEGIN,
+        OTA_STREAM,
+        OTA_QUERY,
+        OTA_ACTIVATE,
+        OTA_DONE,
+        OTA_FAILED,
+    } Ota_Step;
+
+    /*自由计数的统计(ota 命令查看)*/
+    typedef struct
+    {
+        /*广播的数据块(含补发)*/
+        uint32_t Chunks;
+        uint32_t Queries;
+        /*查询无应答的从站*/
+        uint32_t Lost;
+        /*最近一轮查询中映像已校验的从站数*/
+        uint16_t Verified;
+        uint16_t Rounds;
+    } Ota_Stats;
+
+    typedef struct
+    {
+        /*请求帧:前缀 + 从机地址 + 功能码 + |操作|会话|块号(2B)| + 数据 + CRC*/
+        uint8_t Frame[MASTER_PREFIX_SIZE + 6U + OTA_CHUNK + 2U];
+        /*待广播的块:开始时为全部块，查询后为各从站缺块的并集*/
+        uint8_t Need[(OTA_CHUNKS_MAX + 7U) / 8U];
+        volatile Ota_Step Step;
+        /*有请求在途，由完成回调清除*/
+        volatile bool Pending;
+        /*有从站没有当前会话(复位或漏收开始帧)，下一轮先重发开始帧*/
+        bool Need_Begin;
+        uint8_t Session;
+        uint8_t Channel;
+        uint8_t Repeat;
+        uint8_t Retry;
+        uint16_t Version;
+        uint32_t Length;
+        uint32_t Crc;
+        /*下一个待广播的块、待查询的映射表下标及查询的起始块号*/
+        uint16_t Cursor;
+        uint16_t Node;
+        uint16_t From;
+        /*正在查询的从站*/
+        uint8_t Slave;
+        uint16_t Addr;
+        Ota_Stats Stats;
+    } Ota_HandleTypeDef;
+
+    extern void Ota_Submit(void);
+    extern uint8_t Ota_Start(int channel, int length, int version);
+    extern uint8_t Ota_Stop(void);
+    extern void Ota_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OTA_H__ */
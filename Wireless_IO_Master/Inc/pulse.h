@@ -0,0 +1,66 @@
+#ifndef __PULSE_H__
+#define __PULSE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "board_cfg.h"
+
+/*脉冲计数(USING_PULSE，main.h):选为计数模式的数字量输入在边沿中断中直接计数(有效电平的上升沿)，
+  不去抖、不唤醒输入任务，也不再更新输入线圈及路由；频率由输入任务按周期以首末脉冲的时刻计算(倒数测频)*/
+/*频率更新周期(ms)*/
+#define PULSE_PERIOD 1000U
+/*超过该时间(ms)没有脉冲时频率记为0*/
+#define PULSE_ZERO_TIME 5000U
+/*每通道的输入寄存器:[计数高16位][计数低16位][频率(0.1Hz)]，起始地址 BOARD_REG_PULSE + 通道 * PULSE_CHANNEL_REGS*/
+#define PULSE_CHANNEL_REGS 3U
+/*无线发送:通道n(不小于模拟量通道数)的频率(Hz，饱和到12bit)写入原始码值保持寄存器 ANALOG_RAW_START_ADDR + n，
+  与上次发送值相差超过死区(Hz)时标记发送，由 Analog_Addr 为n的节点以紧凑模拟量帧发出*/
+#define PULSE_DEADBAND_DEFAULT 1U
+#define PULSE_FREQ_MAX 0x0FFFU
+
+    /*计数模式配置(kv.h，KV_KEY_PULSE)*/
+    typedef struct
+    {
+        /*计数模式的通道(位)*/
+        uint8_t Mask;
+        uint8_t Reserved;
+        /*无线发送的死区(Hz)，为0时不发送*/
+        uint16_t Deadband;
+    } Pulse_Config;
+
+    typedef struct
+    {
+        /*自由计数的脉冲数及最后一个脉冲的DWT周期计数(中断中更新)*/
+        volatile uint32_t Count;
+        volatile uint32_t Last;
+        /*上一次计算频率时的计数及其脉冲时刻*/
+        uint32_t Ref_Count;
+        uint32_t Ref_Last;
+        bool Ref_Valid;
+        /*频率(0.1Hz)及上次标记发送的频率(Hz)*/
+        uint16_t Freq;
+        uint16_t Published;
+    } Pulse_Channel;
+
+    typedef struct
+    {
+        Pulse_Config Config;
+        Pulse_Channel Channel[BOARD_DIGITAL_COUNT];
+        /*上次更新的系统节拍*/
+        uint32_t Tick;
+    } Pulse_HandleTypeDef;
+
+    extern void Pulse_Init(void);
+    extern bool Pulse_Edge(uint16_t Channel, bool Level);
+    extern uint32_t Pulse_Update(void);
+    extern void Pulse_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PULSE_H__ */
@@ -0,0 +1,57 @@
+#ifndef __RADIO2_H__
+#define __RADIO2_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+
+/*第二个L101模块在主站请求引擎中的端口号*/
+#define RADIO2_PORT 1U
+/*帧内字节间隔超过该值(ms)视为帧结束(9600bps时t3.5约4ms)*/
+#define RADIO2_FRAME_GAP 4U
+/*空闲时检查待发送请求的周期(ms)*/
+#define RADIO2_POLL 5U
+/*模块没有忙指示引脚:串口写入一帧后至少间隔该时间(ms)再写下一帧，须大于一帧的空中时间*/
+#define RADIO2_TX_GAP 60U
+/*软件串口发送一帧的最长时间(ms)*/
+#define RADIO2_TX_TIMEOUT 300U
+/*信道分配表按位记录由第二个模块服务的信道(0~255)，整表作为一个参数保存*/
+#define RADIO2_PLAN_SIZE 32U
+
+    /*自由计数的统计(l101_radio_show 命令查看)*/
+    typedef struct
+    {
+        uint32_t Rx;
+        uint32_t Tx;
+        uint32_t Bad_Frame;
+        /*请求帧超出发送缓冲区*/
+        uint32_t Drop;
+    } Radio2_Stats;
+
+    typedef struct
+    {
+        uint8_t Plan[RADIO2_PLAN_SIZE];
+        /*请求引擎交来的整帧(含L101帧头)，由软件串口任务发出*/
+        uint8_t Tx_Buf[MASTER_PREFIX_SIZE + MODBUS_PDU_SIZE_MAX];
+        uint16_t Tx_Length;
+        volatile bool Tx_Pending;
+        /*最近一帧写完的时刻(ms)*/
+        volatile uint32_t Tx_End;
+        Radio2_Stats Stats;
+    } Radio2_HandleTypeDef;
+
+    extern void Radio2_Init(void);
+    extern void Radio2_Process(uint32_t Wait);
+    extern uint8_t Radio2_Port(uint8_t Channel);
+    extern bool Radio2_Ready(void);
+    extern uint8_t Radio2_Set(int channel, int radio);
+    extern void Radio2_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADIO2_H__ */
@@ -0,0 +1,59 @@
+#ifndef __RBE_H__
+#define __RBE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdregpool.h"
+#include "board_cfg.h"
+
+/*变化上报(USING_RBE，main.h):本机寄存器池中的点在写入时(任何来源:Modbus、采集任务或中断)经订阅回调
+  记入RAM环，每条事件为(点号, 新值, 时刻)并按序号连续编号；本地SCADA经网关的本机从站(第二个Modbus口)
+  以一帧20功能码读取文件 FILEREC_RBE 的“序号N之后的事件”(filerec.h)，不再轮询整个寄存器映像。
+  线圈组逐位上报，寄存器与上次上报值之差达到死区时才上报；输入寄存器只上报运行统计之前的区域
+  (计数、报警及模拟量)，统计计数器每秒都在变化，不上报*/
+/*环深度(条，2的幂)，不小于一帧20功能码可读出的条数*/
+#define RBE_RING_SIZE 32U
+/*序号按此取模(2的幂)，取模后的序号即文件记录号，须小于 MODBUS_FILE_RECORDS*/
+#define RBE_SEQ_WRAP 8192U
+/*寄存器的默认死区(rbe_deadband 命令修改)*/
+#define RBE_DEADBAND 8U
+/*上报的输入寄存器区域 [0, RBE_INPUT_END)*/
+#define RBE_INPUT_END BOARD_REG_MONITOR
+/*上报的寄存器个数(输入寄存器区域及全部保持寄存器)，各保存上次上报值*/
+#define RBE_REG_COUNT (RBE_INPUT_END + HOLD_REGISTER_POOL_SIZE)
+
+    typedef struct
+    {
+        /*Modbus点号:线圈1起、离散输入10001起、输入寄存器30001起、保持寄存器40001起*/
+        uint16_t Ref;
+        uint16_t Value;
+        uint32_t Tick;
+    } Rbe_Event;
+
+    typedef struct
+    {
+        Rbe_Event Ring[RBE_RING_SIZE];
+        /*已记录的事件数，第n条(n从1起)事件位于 Ring[(n - 1) % RBE_RING_SIZE]*/
+        volatile uint32_t Head;
+        uint16_t Last[RBE_REG_COUNT];
+        uint16_t Deadband;
+        /*被覆盖后才被读取的请求数及落在死区内的写入次数*/
+        uint32_t Lost;
+        uint32_t Suppressed;
+    } Rbe_HandleTypeDef;
+
+    extern void Rbe_Init(RegisterPoolHandle Pool);
+    extern uint16_t Rbe_Since(uint16_t Seq, Rbe_Event *pEvents, uint16_t Max, uint16_t *pFirst, uint16_t *pLatest,
+                              bool *pLost);
+    extern uint8_t Rbe_Set_Deadband(int deadband);
+    extern void Rbe_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RBE_H__ */
@@ -0,0 +1,39 @@
+#ifndef __REGWATCH_H__
+#define __REGWATCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+
+/*寄存器组类型，与Modbus参考地址前缀一致*/
+#define REGWATCH_COILS 0U
+#define REGWATCH_INPUT_COILS 1U
+#define REGWATCH_INPUT_REGISTERS 3U
+#define REGWATCH_HOLD_REGISTERS 4U
+/*regdump 每行打印的寄存器数/位数*/
+#define REGWATCH_DUMP_REGS 8U
+#define REGWATCH_DUMP_BITS 16U
+/*监视周期下限(ms)及每个周期最多输出的变化寄存器数，其余留到下一周期*/
+#define REGWATCH_MIN_PERIOD 100U
+#define REGWATCH_MAX_CHANGES 16U
+
+    typedef struct
+    {
+        /*被监视的寄存器池*/
+        RegisterPoolHandle Pool;
+        /*监视周期(ms)，为0时停止*/
+        uint32_t Period;
+    } Regwatch_HandleTypeDef;
+
+    extern void Regwatch_Init(RegisterPoolHandle Pool);
+    extern void Regwatch_Dump(int Type, int Start, int Count);
+    extern void Regwatch_Start(uint32_t Period);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __REGWATCH_H__ */
@@ -0,0 +1,59 @@
+#ifndef __ROUTE_H__
+#define __ROUTE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*路由表最大条目数*/
+#define ROUTE_MAX_ENTRIES 32U
+/*路由表存放的flash页(与Flash.c中的分区说明一致)*/
+#define ROUTE_PAGE 125U
+#define ROUTE_MAGIC 0x5254U
+#define ROUTE_VERSION 0x01U
+/*路由源类型:本机数字量输入通道、输入线圈(远端从站输入的映像)、模拟量报警位(ANALOG_ALARM_ADDR的位号)*/
+#define ROUTE_SRC_DIGITAL 0x00U
+#define ROUTE_SRC_INPUT 0x01U
+#define ROUTE_SRC_ALARM 0x02U
+#define ROUTE_SRC_TYPES 3U
+/*无路由源的索引*/
+#define ROUTE_NONE 0xFFU
+
+    /*一条路由:源点驱动本机线圈 Target；映射到该线圈的L101节点把它转发到远端从站的输出*/
+    typedef struct
+    {
+        uint8_t Type;
+        uint8_t Invert;
+        uint16_t Source;
+        uint16_t Target;
+    } Route_Entry;
+
+    /*编译后的路由源:扇出为 Fanout[First, First + Count)*/
+    typedef struct
+    {
+        uint16_t Source;
+        uint8_t Type;
+        /*最近一次传播的电平，ROUTE_NONE表示尚未传播*/
+        uint8_t State;
+        uint8_t First;
+        uint8_t Count;
+    } Route_Source;
+
+    /*编译后的扇出目标*/
+    typedef struct
+    {
+        uint16_t Target;
+        uint8_t Invert;
+    } Route_Fanout;
+
+    extern void Route_Init(void);
+    extern void Route_Digital(uint16_t Channel, uint8_t Value);
+    extern void Route_Poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROUTE_H__ */
@@ -0,0 +1,62 @@
+#ifndef __SCENE_H__
+#define __SCENE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+
+/*输出场景(MODBUS_CODE_SCENE)，与从站 scene.h 一致:
+  请求 |场景号| -> |场景号|，广播站号时同一信道的从站同时执行，不应答；从站场景未定义时异常应答
+  场景表作为分块传输对象 XFER_OBJ_SCENE 整体写入，每个场景的传输格式(高字节在前):
+  |线圈掩码(2B)|线圈值(2B)|模拟量掩码|保留|模拟量0(2B)|模拟量1(2B)|*/
+#define SCENE_MAX 8U
+#define SCENE_AOUT_MAX 2U
+#define SCENE_WIRE_SIZE (6U + 2U * SCENE_AOUT_MAX)
+#define SCENE_TABLE_SIZE (SCENE_MAX * SCENE_WIRE_SIZE)
+/*请求帧(前缀另填):从机地址 + 功能码 + 场景号 + CRC*/
+#define SCENE_FRAME_SIZE 5U
+/*单播请求的应答超时(ms)*/
+#define SCENE_TIMEOUT 1000U
+
+    /*自由计数的统计(scene 命令查看)*/
+    typedef struct
+    {
+        uint32_t Sent;
+        uint32_t Acked;
+        /*超时、异常应答或无效应答*/
+        uint32_t Failed;
+    } Scene_Stats;
+
+    typedef struct
+    {
+        /*待下发的场景表(传输格式)，scene_edit 编辑，scene_put 写入从站*/
+        uint8_t Table[SCENE_TABLE_SIZE];
+        /*请求引擎就地发出的透传帧，请求结束前不改动*/
+        uint8_t Frame[SCENE_FRAME_SIZE];
+        /*有待提交的请求、有请求在途(由完成回调清除)*/
+        volatile bool Queued;
+        volatile bool Pending;
+        /*目标从站(0:广播)、节点地址、信道及场景号*/
+        uint8_t Slave;
+        uint16_t Addr;
+        uint8_t Channel;
+        uint8_t Index;
+        /*最近一次请求的结果(MASTER_RESULT_xxx，异常应答时为0x80|异常码)*/
+        uint8_t Result;
+        Scene_Stats Stats;
+    } Scene_HandleTypeDef;
+
+    extern void Scene_Submit(void);
+    extern uint8_t Scene_Apply(int slave, int index, int channel);
+    extern uint8_t Scene_Edit(int index, int coil_mask, int coil_value, int aout_mask, int aout0, int aout1);
+    extern uint8_t Scene_Put(int slave);
+    extern void Scene_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCENE_H__ */
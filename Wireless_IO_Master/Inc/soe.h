@@ -0,0 +1,59 @@
+#ifndef __SOE_H__
+#define __SOE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+
+/*事件顺序记录(SOE)环深度(2的幂)，满后覆盖最旧的记录；装有FRAM时另写入外部日志(extlog.h)，
+  序号跨上电连续，较旧的记录从外部日志读取*/
+#define SOE_LOG_SIZE 32U
+/*SOE在输入寄存器中的初始地址*/
+#define SOE_REG_START_ADDR 0x00
+/*输入寄存器中导出的最新事件数，每个事件占 SOE_REG_EVENT_SIZE 个寄存器*/
+#define SOE_REG_EVENTS 5U
+#define SOE_REG_EVENT_SIZE 5U
+/*导出区:最新序号低16位、环内记录数，随后按由新到旧排列
+[序号低16位][点号<<8|电平][毫秒时刻高16位][毫秒时刻低16位][毫秒内微秒]*/
+#define SOE_REG_SIZE (2U + SOE_REG_EVENTS * SOE_REG_EVENT_SIZE)
+
+    /*一条事件记录*/
+    typedef struct
+    {
+        uint32_t Sequence;
+        /*HAL_GetTick 毫秒时刻及毫秒内的微秒数(TIM1时基计数器)*/
+        uint32_t Tick;
+        uint16_t Us;
+        /*点号(本机线圈地址)及新电平*/
+        uint8_t Point;
+        uint8_t Value;
+    } Soe_Event;
+
+    typedef struct
+    {
+        Soe_Event Log[SOE_LOG_SIZE];
+        /*最新记录的序号(自由计数，0表示尚无记录)*/
+        uint32_t Sequence;
+        /*本次上电的第一个序号，更早的记录不在RAM环中*/
+        uint32_t First;
+        /*已接续外部日志的序号(Soe_Resume)，此前的事件从1起编号，只在RAM环中*/
+        bool Resumed;
+        /*导出SOE的寄存器池(可为 NULL)*/
+        RegisterPoolHandle Pool;
+    } Soe_HandleTypeDef;
+
+    extern void Soe_Init(RegisterPoolHandle Pool);
+    extern void Soe_Resume(void);
+    extern void Soe_Record(uint8_t Point, uint8_t Value);
+    extern bool Soe_Read(uint32_t Sequence, Soe_Event *pEvent);
+    extern uint32_t Soe_Latest(void);
+    extern void Soe_Pack(const Soe_Event *pEvent, mdU16 *pReg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SOE_H__ */
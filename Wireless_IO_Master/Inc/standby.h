@@ -0,0 +1,77 @@
+#ifndef __STANDBY_H__
+#define __STANDBY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "L101.h"
+
+/*热备主站(USING_STANDBY，main.h):两台主站接同一组从站，工作的一台每个镜像周期向另一台发出调度状态，
+  备用的一台只接收不发送；连续 STANDBY_MISSES 个周期未收到镜像时接管，按镜像中的节点集合及线圈确认值
+  直接按事件调度，不重新扫描，从站看到的输出值不变；不抢占:恢复的主站在对方工作时保持备用*/
+#define STANDBY_OFF 0x00U
+/*上电时较早接管，两台同时工作时保持工作*/
+#define STANDBY_PRIMARY 0x01U
+/*上电时多等待一个接管时间，两台同时工作时让出*/
+#define STANDBY_BACKUP 0x02U
+/*镜像周期范围(ms)，接管时间为 STANDBY_MISSES 个周期，须小于从站的通信失效时间*/
+#define STANDBY_PERIOD_MIN 200U
+#define STANDBY_PERIOD_MAX 10000U
+#define STANDBY_MISSES 2U
+/*镜像帧(用户自定义功能码，发往对方主站的模块地址):
+  |序号(1B)|就绪集合(4B)|阻塞集合(4B)|线圈(4B)|线圈确认值(4B)|确认值有效(4B)|首轮扫描完成(1B)|*/
+#define STANDBY_CODE_MIRROR 0x48U
+#define STANDBY_MIRROR_SIZE 22U
+
+    /*热备配置(整体保存在参数区)*/
+    typedef struct
+    {
+        uint8_t Role;
+        /*镜像使用的信道*/
+        uint8_t Channel;
+        /*对方主站的模块地址*/
+        uint16_t Peer;
+        uint16_t Period_Ms;
+    } Standby_Config;
+
+    /*自由计数的统计(standby 命令查看)*/
+    typedef struct
+    {
+        uint32_t Tx;
+        uint32_t Rx;
+        /*备用转为工作的次数*/
+        uint32_t Takeover;
+        /*两台同时工作时让出的次数*/
+        uint32_t Yield;
+        /*工作时收到对方的镜像(两台同时工作)*/
+        uint32_t Conflict;
+    } Standby_Stats;
+
+    typedef struct
+    {
+        Standby_Config Cfg;
+        /*Modbus任务收到、尚未由调度任务采用的镜像*/
+        L101_Mirror Rx;
+        bool Rx_New;
+        /*最近一次收到镜像(备用时为上电时刻)及发出镜像的时刻(ms)*/
+        uint32_t Last_Rx;
+        uint32_t Last_Tx;
+        bool Active;
+        uint8_t Seq;
+        Standby_Stats Stats;
+    } Standby_HandleTypeDef;
+
+    extern void Standby_Init(void);
+    extern bool Standby_Poll(void);
+    extern bool Standby_Active(void);
+    extern bool Standby_Frame(const uint8_t *pFrame, uint32_t Length);
+    extern uint8_t Standby_Set(int role, int peer, int channel, int period_ms);
+    extern void Standby_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STANDBY_H__ */
@@ -0,0 +1,35 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+#include "board_cfg.h"
+
+/*导出周期(ms)*/
+#define STATS_PERIOD 1000U
+/*每 STATS_LOG_EXPORTS 次导出把汇总计数的快照写入外部日志(extlog.h)，由 stats_log 命令读出*/
+#define STATS_LOG_EXPORTS 60U
+/*协议统计在输入寄存器中的初始地址(紧随运行统计区)*/
+#define STATS_REG_START_ADDR BOARD_REG_STATS
+/*导出区:[接收帧][发送帧][CRC错误][长度错误][无匹配请求的应答][超时][应答错误][重发][DMA接收溢出]
+[丢弃(请求队列满及发送队列满)]，随后按事件号排列各从站 [请求][正确应答][超时][重发]；
+均为自由计数的低16位，由 stats_clear 清零*/
+#define STATS_REG_HEAD 10U
+#define STATS_REG_NODE_SIZE 4U
+#define STATS_REG_NODES BOARD_DIGITAL_COUNT
+#define STATS_REG_SIZE (STATS_REG_HEAD + STATS_REG_NODES * STATS_REG_NODE_SIZE)
+
+    extern void Stats_Init(RegisterPoolHandle Pool);
+    extern void Stats_Show(void);
+    extern void Stats_Clear(void);
+    extern void Stats_Log_Show(int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STATS_H__ */
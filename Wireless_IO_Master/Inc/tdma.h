@@ -0,0 +1,80 @@
+#ifndef __TDMA_H__
+#define __TDMA_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+
+/*时隙接入模式:关闭(仅检查模块忙)、协调者(发出信标)、成员(跟随信标同步)*/
+#define TDMA_OFF 0x00U
+#define TDMA_COORDINATOR 0x01U
+#define TDMA_MEMBER 0x02U
+/*每帧最大时隙数及时隙长度范围(ms)，时隙长度为调度节拍的整数倍*/
+#define TDMA_SLOTS_MAX 8U
+#define TDMA_SLOT_MIN 300U
+#define TDMA_SLOT_MAX 5000U
+/*时隙末尾的保护时间(ms):剩余时间不足时不再发出新请求，须大于一次请求及应答的空中时间*/
+#define TDMA_GUARD 150U
+/*信标从发出到被成员处理的估计时延(ms，空中时间及串口成帧)，同步时补偿*/
+#define TDMA_BEACON_DELAY 40U
+/*连续该帧数未收到信标视为失步，按本地时钟继续划分时隙*/
+#define TDMA_LOST_FRAMES 8U
+/*信标帧(用户自定义功能码，以广播地址发出):|时隙数(1B)|时隙长度(ms,2B)|发出时刻在帧内的偏移(ms,2B)|序号(1B)|*/
+#define TDMA_CODE_BEACON 0x43U
+#define TDMA_BEACON_SIZE 6U
+
+    /*时隙配置(整体保存在参数区)*/
+    typedef struct
+    {
+        uint8_t Mode;
+        /*本主站的时隙号*/
+        uint8_t Slot;
+        /*每帧时隙数，成员以协调者信标中的值为准*/
+        uint8_t Slots;
+        /*信标使用的信道(各主站共用)*/
+        uint8_t Channel;
+        uint16_t Slot_Ms;
+    } Tdma_Config;
+
+    /*自由计数的统计(tdma 命令查看)*/
+    typedef struct
+    {
+        uint32_t Beacon_Tx;
+        uint32_t Beacon_Rx;
+        /*同步次数及最近一次校正量(ms)*/
+        uint32_t Resync;
+        int32_t Drift;
+        /*收到其他协调者的信标(配置冲突)*/
+        uint32_t Conflict;
+        /*时隙外被推迟的发送检查次数*/
+        uint32_t Deferred;
+    } Tdma_Stats;
+
+    typedef struct
+    {
+        Tdma_Config Cfg;
+        /*当前帧的起点(ms)，随时间推进到最近一帧*/
+        uint32_t Epoch;
+        /*最近一次收到信标的时刻(ms)*/
+        uint32_t Last_Beacon;
+        /*协调者在当前帧已发出信标*/
+        bool Sent;
+        bool Synced;
+        uint8_t Seq;
+        Tdma_Stats Stats;
+    } Tdma_HandleTypeDef;
+
+    extern void Tdma_Init(void);
+    extern bool Tdma_Open(void);
+    extern void Tdma_Poll(void);
+    extern bool Tdma_Beacon(const uint8_t *pFrame, uint32_t Length);
+    extern uint8_t Tdma_Set(int mode, int slot, int slots, int slot_ms, int channel);
+    extern void Tdma_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDMA_H__ */
@@ -35,6 +35,8 @@ extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim4;
 
+extern DMA_HandleTypeDef hdma_tim3_up;
+
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
@@ -0,0 +1,79 @@
+#ifndef __TREND_H__
+#define __TREND_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "board_cfg.h"
+
+/*趋势记录(USING_TREND，main.h):校准后的模拟量按多级时间窗聚合为最小/最大/平均值及采样数，
+  每个采样只更新最细一级的累加器，窗口结束时并入上一级(每采样O(1))；各级为按序号循环覆盖的RAM环，
+  序号n的记录是自 Trend_Init() 起第n个窗口，位于第 n % 深度 个位置，中间没有采样的窗口记为采样数0*/
+/*分级:X(级名, 窗口长度(ms), 环深度)，窗口长度须为下一级的整数倍；FRAM已由 extlog.h 的各区域占满，只存放在RAM中*/
+#define TREND_LEVEL_TABLE(X)      \
+    /*最近30s的秒级趋势*/         \
+    X(SECOND, 1000UL, 30U)        \
+    /*最近1h的分钟级趋势*/        \
+    X(MINUTE, 60000UL, 60U)       \
+    /*最近8h的15分钟级趋势*/      \
+    X(QUARTER, 900000UL, 32U)
+/*一条记录的寄存器数:[最小值][最大值][平均值][采样数]*/
+#define TREND_RECORD_REGS 4U
+
+#define TREND_LEVEL_ENUM(name, period, depth) TREND_LEVEL_##name,
+    enum
+    {
+        TREND_LEVEL_TABLE(TREND_LEVEL_ENUM)
+            TREND_LEVELS
+    };
+
+    /*一个窗口内一路模拟量的聚合值(工程值uA/mV)，采样数饱和到0xFFFF*/
+    typedef struct
+    {
+        uint16_t Min;
+        uint16_t Max;
+        uint16_t Avg;
+        uint16_t Count;
+    } Trend_Record;
+
+    /*尚未结束的窗口的累加器*/
+    typedef struct
+    {
+        uint16_t Min;
+        uint16_t Max;
+        uint32_t Count;
+        uint64_t Sum;
+    } Trend_Acc;
+
+    typedef struct
+    {
+        Trend_Acc Acc[BOARD_ANALOG_COUNT];
+        /*最新结束的窗口序号，0表示尚无记录*/
+        uint32_t Sequence;
+        /*当前窗口结束的系统节拍*/
+        uint32_t Deadline;
+    } Trend_Level;
+
+    typedef struct
+    {
+        Trend_Level Level[TREND_LEVELS];
+        /*Trend_Init() 的系统节拍，窗口n始于 Base + (n - 1) * 窗口长度*/
+        uint32_t Base;
+        bool Ready;
+    } Trend_HandleTypeDef;
+
+    extern void Trend_Init(void);
+    extern void Trend_Sample(const uint16_t *pValue);
+    extern bool Trend_Read(uint8_t Level, uint8_t Channel, uint32_t Sequence, Trend_Record *pRecord);
+    extern uint32_t Trend_Latest(uint8_t Level);
+    extern uint32_t Trend_Depth(uint8_t Level);
+    extern uint32_t Trend_Period(uint8_t Level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TREND_H__ */
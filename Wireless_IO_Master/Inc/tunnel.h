@@ -0,0 +1,44 @@
+#ifndef __TUNNEL_H__
+#define __TUNNEL_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtuslave.h"
+
+/*shell隧道功能码(用户自定义功能码区，不与 mdrtuslave.h 中的 MODBUS_CODE_ANALOG 等自定义功能码重叠)，
+经L101到达主站串口、从机地址为本机(SLAVE_ID)的请求由 portRtuClientTick 交给中心处理器
+请求:[从站地址][TUNNEL_CODE][n][n字节shell输入][CRC]，n为0时只取回输出，n为 TUNNEL_CLOSE 时结束会话
+应答:[从站地址][TUNNEL_CODE][m][m字节shell输出][CRC]*/
+#define TUNNEL_CODE 0x4AU
+#define TUNNEL_CLOSE 0xFFU
+/*每帧最多携带的shell输入/输出字节数*/
+#define TUNNEL_CHUNK 64U
+/*shell输出缓冲区尺寸(2的整数次幂)，满时丢弃新的输出*/
+#define TUNNEL_TX_SIZE 256U
+/*会话空闲超时(ms)，超时后shell输出恢复到本地控制台*/
+#define TUNNEL_TIMEOUT 30000U
+
+    typedef struct
+    {
+        char Buffer[TUNNEL_TX_SIZE];
+        /*自由计数的写入/取回位置*/
+        volatile uint32_t Head, Tail;
+        uint32_t Dropped;
+        /*最近一次请求的系统节拍*/
+        uint32_t Last;
+        volatile bool Open;
+        uint8_t Frame[TUNNEL_CHUNK + 5U];
+    } Tunnel_HandleTypeDef;
+
+    extern void Tunnel_Init(ModbusRTUSlaveHandler handler);
+    extern bool Tunnel_Active(void);
+    extern bool Tunnel_Capture(const char *data, unsigned short len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TUNNEL_H__ */
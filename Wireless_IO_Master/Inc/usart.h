@@ -28,13 +28,14 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "uart_dma.h"
 /* USER CODE END Includes */
 
 extern UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN Private defines */
 #define MD_UART huart1
+extern UartDma_HandleTypeDef Uart1_Dma;
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
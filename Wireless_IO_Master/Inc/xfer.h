@@ -0,0 +1,124 @@
+#ifndef __XFER_H__
+#define __XFER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdrtumaster.h"
+
+/*分块传输(MODBUS_CODE_XFER)，与从站 xfer.h 一致:
+  打开读取 |0x01|对象| -> |0x01|对象|信息|     读取块 |0x02|块号|块数| -> |0x02|块号|长度|数据|
+  打开写入 |0x03|对象|信息| -> |0x03|对象|     写入块 |0x04|块号|长度|数据| -> |0x04|块号|已收到的块位图|
+  提交     |0x05| -> |0x05|结果|              连续写入 |0x06|块号|长度|数据| (广播站号，不应答)
+  信息:|编码|原始长度(2B)|传输长度(2B)|原始数据CRC(2B)|，高字节在前
+  读取块时从块号起连续返回至多 XFER_READ_BLOCKS 块(不足时到传输长度为止)；写入时窗口内的前几块以连续写入
+  发出(L101前缀仍指向目标从站)，窗口最后一块用写入块，其应答的位图确认整个窗口(选择重传)*/
+#define XFER_OP_OPEN_READ 0x01U
+#define XFER_OP_READ 0x02U
+#define XFER_OP_OPEN_WRITE 0x03U
+#define XFER_OP_WRITE 0x04U
+#define XFER_OP_COMMIT 0x05U
+#define XFER_OP_BURST 0x06U
+/*传输对象:SOE事件记录(只读)、掉电保持的配置寄存器、中继转发表、输出场景表(scene.h)*/
+#define XFER_OBJ_SOE 0x00U
+#define XFER_OBJ_CONFIG 0x01U
+#define XFER_OBJ_FORWARD 0x02U
+#define XFER_OBJ_SCENE 0x03U
+#define XFER_OBJECTS 4U
+/*编码:原样、LZSS(压缩后不小于原始数据时原样传输)*/
+#define XFER_MODE_STORED 0x00U
+#define XFER_MODE_LZSS 0x01U
+#define XFER_INFO_SIZE 7U
+/*每块数据字节数及对象的最大原始长度*/
+#define XFER_BLOCK 64U
+#define XFER_RAW_SIZE 384U
+#define XFER_BLOCKS_MAX ((XFER_RAW_SIZE + XFER_BLOCK - 1U) / XFER_BLOCK)
+/*一次读取应答的最多块数(应答PDU不超过 MODBUS_PDU_SIZE_MAX)*/
+#define XFER_READ_BLOCKS 3U
+/*提交结果:成功、有未收到的块、解压或CRC错误、对象拒绝写入*/
+#define XFER_OK 0x00U
+#define XFER_MISSING 0x01U
+#define XFER_CORRUPT 0x02U
+#define XFER_REJECTED 0x03U
+/*每个请求的应答超时(ms，一块数据的空中时间约100ms)及连续失败的重试次数*/
+#define XFER_TIMEOUT 2000U
+#define XFER_RETRIES 3U
+/*请求帧:前缀 + 从机地址 + 功能码 + |操作|块号|长度| + 数据 + CRC*/
+#define XFER_FRAME_SIZE (MASTER_PREFIX_SIZE + 5U + XFER_BLOCK + 2U)
+
+    /*传输状态*/
+    typedef enum
+    {
+        XFER_IDLE = 0,
+        XFER_OPEN,
+        XFER_BLOCKS,
+        XFER_COMMIT,
+        XFER_DONE,
+        XFER_FAILED,
+    } Xfer_State;
+
+    /*自由计数的统计(xfer 命令查看)*/
+    typedef struct
+    {
+        uint32_t Requests;
+        uint32_t Blocks;
+        /*以连续写入发出的块(不等应答)*/
+        uint32_t Bursts;
+        /*超时、错误及异常应答后重发的请求*/
+        uint32_t Retries;
+        uint32_t Done;
+        uint32_t Failed;
+        /*经压缩节省的空中字节数*/
+        uint32_t Saved;
+    } Xfer_Stats;
+
+    /*传输会话(同时只有一个)*/
+    typedef struct
+    {
+        /*对象的原始内容:读取完成后为从站对象，写入时为待写入的内容*/
+        uint8_t Raw[XFER_RAW_SIZE];
+        /*按块传输的数据:LZSS编码时为压缩数据，原样编码时直接传输 Raw*/
+        uint8_t Packed[XFER_RAW_SIZE];
+        /*请求引擎就地发出的透传帧，请求结束前不改动*/
+        uint8_t Frame[XFER_FRAME_SIZE];
+        volatile Xfer_State State;
+        /*有请求在途，由完成回调清除*/
+        volatile bool Pending;
+        bool Write;
+        uint8_t Slave;
+        uint8_t Object;
+        uint8_t Mode;
+        /*读取时已收到的块；写入时为从站应答中的已收到位图*/
+        uint8_t Received;
+        /*写入时本窗口已连续写入、尚未确认的块*/
+        uint8_t Sent;
+        /*写入窗口(块数，1:逐块等待应答)*/
+        uint8_t Window;
+        /*在途请求的操作、首块号、块数及连续失败次数*/
+        uint8_t Op;
+        uint8_t Block;
+        uint8_t Count;
+        uint8_t Retry;
+        /*提交结果或失败原因(从站的异常码)*/
+        uint8_t Result;
+        uint16_t Raw_Length;
+        uint16_t Length;
+        uint16_t Crc;
+        uint16_t Addr;
+        uint8_t Channel;
+        Xfer_Stats Stats;
+    } Xfer_HandleTypeDef;
+
+    extern void Xfer_Submit(void);
+    extern uint8_t Xfer_Get(int slave, int object);
+    extern uint8_t Xfer_Put(int slave, int object);
+    extern uint8_t Xfer_Write(int slave, int object, const uint8_t *pRaw, uint16_t Length);
+    extern void Xfer_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XFER_H__ */
@@ -0,0 +1,10 @@
+#ifndef _SHELL_CFG_USER_H_
+#define _SHELL_CFG_USER_H_
+
+/*主站shell裁剪配置，未列出的配置项取 Common/Letter_Shell/Inc/shell_cfg.h 中的默认值；
+  SHELL_PROFILE 也可在工程的预定义宏中给出*/
+#ifndef SHELL_PROFILE
+#define SHELL_PROFILE SHELL_PROFILE_FIELD_DEBUG
+#endif
+
+#endif /* _SHELL_CFG_USER_H_ */
@@ -2,10 +2,11 @@
 #define _SHELL__PORT_H_
 
 #include "shell.h"
+#include "usart.h"
 // #define USING_FREERTOS
 //#define USING_RTTHREAD
 
-/*定义shell缓冲区尺寸*/
+/*定义shell缓冲区尺寸(命令行及历史记录共用，命令行长度为 SHELL_BUFFER_SIZE / (历史深度 + 1))*/
 #define SHELL_BUFFER_SIZE 128U
 
 /*声明shell对象*/
@@ -15,4 +16,33 @@ extern Shell shell;
 /*初始化shell*/
 extern void User_Shell_Init(Shell *shell);
 
+#if defined(USING_L101)
+/*shell发送完成信号(与软件串口的信号位区分)*/
+#define SHELL_SIGNAL_TX 0x04
+#endif
+
+/*shell日志缓冲区有数据待发送信号*/
+#define SHELL_SIGNAL_LOG 0x08
+/*异步写入(shell->write)及低优先级发送任务:各任务首次输出时占用一个专用日志环，写入不关中断、不等待串口*/
+extern unsigned short Shell_Log_Write(char *data, unsigned short len);
+extern void Shell_Log_Task(void const *argument);
+extern void Shell_Log_Show(void);
+
+/*shell接收环收到数据信号及接收环长度(2的整数次幂)*/
+#define SHELL_SIGNAL_RX 0x10
+#define SHELL_RX_SIZE 128U
+/*shell模式下接管/交还USART1接收，及USART1接收中断中调用*/
+extern void Shell_Rx_Start(void);
+extern void Shell_Rx_Stop(void);
+extern void Shell_Rx_IRQHandler(void);
+/*shell隧道输入；软件串口控制台在隧道会话期间及平时取隧道输入的最长等待时间(ms)*/
+#define SHELL_TUNNEL_POLL 20U
+#define SHELL_TUNNEL_IDLE 1000U
+extern unsigned short Shell_Rx_Push(const char *data, unsigned short len);
+
+/*shell缓冲区借出/交还，及运行时选择历史记录深度*/
+extern char *Shell_Arena_Lend(unsigned short *pSize);
+extern void Shell_Arena_Return(void);
+extern void Shell_Arena_Split(int depth);
+
 #endif /* _SHELL_PORT_H_ */
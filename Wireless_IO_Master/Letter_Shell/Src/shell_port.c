@@ -6,6 +6,8 @@
 #include "shell_port.h"
 #include "usart.h"
 #include "io_uart.h"
+#include "tunnel.h"
+#include "boot.h"
 
 /*定义shell目标端口*/
 #if defined(USING_IO_UART)
@@ -17,16 +19,113 @@
 /*定义shell调试接口*/
 #define Printf_Dbug(info) shellPrint(&shell, info);
 
-#if defined(USING_RTTHREAD)
-#include "rtthread.h"
-extern rt_mutex_t shellMutexHandle;
-#else
-#include "cmsis_os.h"
-extern osMutexId shellMutexHandle;
-#endif
+#include "os_port.h"
+extern Os_Mutex shellMutexHandle;
+extern Os_Thread shell_logHandle;
+extern Os_Thread shellHandle;
 /* 定义shell对象*/
 Shell shell;
-char shell_buffer[SHELL_BUFFER_SIZE];
+/*shell输入缓冲区:命令行及历史记录按当前深度等分*/
+static char shell_buffer[SHELL_BUFFER_SIZE];
+static unsigned short Shell_History = SHELL_HISTORY_MAX_NUMBER;
+
+/*shell接收环:USART1接收中断(shell模式)及shell隧道写入，shell任务读取*/
+typedef struct
+{
+	char Buffer[SHELL_RX_SIZE];
+	/*自由计数的写入/读取位置*/
+	volatile uint32_t Head, Tail;
+} Shell_RxRing;
+
+static Shell_RxRing Shell_Rx;
+
+/**
+ * @brief shell接管串口接收
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Shell_Rx_Start(void)
+{
+#if !defined(USING_IO_UART)
+	/*串口接收DMA已停止，丢弃残留数据后按字节中断接收*/
+	Shell_Rx.Tail = Shell_Rx.Head;
+	__HAL_UART_CLEAR_OREFLAG(&SHELL_TARGET_UART);
+	__HAL_UART_ENABLE_IT(&SHELL_TARGET_UART, UART_IT_RXNE);
+#endif
+}
+
+/**
+ * @brief shell交还串口接收
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Shell_Rx_Stop(void)
+{
+#if !defined(USING_IO_UART)
+	/*须在重新启动接收DMA前关闭，否则中断会抢走DMA的数据*/
+	__HAL_UART_DISABLE_IT(&SHELL_TARGET_UART, UART_IT_RXNE);
+#endif
+}
+
+/**
+ * @brief shell串口接收中断处理
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Shell_Rx_IRQHandler(void)
+{
+#if !defined(USING_IO_UART)
+	if (__HAL_UART_GET_FLAG(&SHELL_TARGET_UART, UART_FLAG_RXNE) &&
+		__HAL_UART_GET_IT_SOURCE(&SHELL_TARGET_UART, UART_IT_RXNE))
+	{
+		/*读DR同时清除RXNE及溢出标志；环满时丢弃*/
+		char data = (char)(SHELL_TARGET_UART.Instance->DR & 0xFF);
+
+		if (Shell_Rx.Head - Shell_Rx.Tail < SHELL_RX_SIZE)
+		{
+			Shell_Rx.Buffer[Shell_Rx.Head % SHELL_RX_SIZE] = data;
+			Shell_Rx.Head++;
+		}
+		if ((shellHandle != NULL) && Os_Running())
+		{
+			Os_Signal_Set(shellHandle, SHELL_SIGNAL_RX);
+		}
+	}
+#endif
+}
+
+/**
+ * @brief shell接收环写入数据
+ *
+ * @param data 数据
+ * @param len 字节数
+ *
+ * @return unsigned short 实际写入的字节数(环满时丢弃其余部分)
+ */
+unsigned short Shell_Rx_Push(const char *data, unsigned short len)
+{
+	uint32_t primask = __get_PRIMASK();
+	unsigned short count = 0;
+
+	__disable_irq();
+	for (; (count < len) && (Shell_Rx.Head - Shell_Rx.Tail < SHELL_RX_SIZE); count++)
+	{
+		Shell_Rx.Buffer[Shell_Rx.Head % SHELL_RX_SIZE] = data[count];
+		Shell_Rx.Head++;
+	}
+	__set_PRIMASK(primask);
+	if (count && (shellHandle != NULL) && Os_Running())
+	{
+		Os_Signal_Set(shellHandle, SHELL_SIGNAL_RX);
+	}
+	return count;
+}
 
 /**
  * @brief shell读取数据函数原型
@@ -34,23 +133,109 @@ char shell_buffer[SHELL_BUFFER_SIZE];
  * @param data shell读取的字符
  * @param len 请求读取的字符数量
  *
- * @return unsigned short 实际读取到的字符数量
+ * @return unsigned short 实际读取到的字符数量(硬件串口无数据时阻塞等待接收中断)
  */
 unsigned short User_Shell_Read(char *data, unsigned short len)
 {
+	unsigned short count = 0;
+
 #if defined(USING_IO_UART)
-	if (HAL_SUART_Receive(&SHELL_TARGET_UART, (uint8_t *)data, len, 0xFFFF) == HAL_OK)
+	/*软件串口阻塞在自己的边沿通知上，限时等待以便取走隧道输入*/
+	if ((Shell_Rx.Head == Shell_Rx.Tail) &&
+		(HAL_SUART_Receive(&SHELL_TARGET_UART, (uint8_t *)data, len,
+						   Tunnel_Active() ? SHELL_TUNNEL_POLL : SHELL_TUNNEL_IDLE) == HAL_OK))
+	{
+		return len;
+	}
 #else
-	if (HAL_UART_Receive(&SHELL_TARGET_UART, (uint8_t *)data, len, 0x01) != HAL_OK)
+	while (Shell_Rx.Head == Shell_Rx.Tail)
+	{
+		Os_Signal_Wait(SHELL_SIGNAL_RX, OS_WAIT_FOREVER);
+	}
 #endif
+	for (; (count < len) && (Shell_Rx.Head != Shell_Rx.Tail); count++)
 	{
-		return len;
+		data[count] = Shell_Rx.Buffer[Shell_Rx.Tail % SHELL_RX_SIZE];
+		Shell_Rx.Tail++;
 	}
-	/*串口接收数据失败*/
-	return 0;
+
+	return count;
 }
 
+#if defined(USING_L101)
+/*L101透传帧头:目标地址0xFFFF(广播)+信道0x00*/
 #define FRAME_HEADER "\xFF\xFF\x00"
+/*shell经LoRa输出的串口驱动(与Modbus共用发送队列)*/
+#define SHELL_LINK_UART Uart1_Dma
+/*单次写入等待发送完成的最长时间(ms)*/
+#define SHELL_TX_TIMEOUT 100U
+
+/*一次写入的完成通知*/
+typedef struct
+{
+	Os_Thread Waiter;
+	volatile bool Done;
+	bool Sent;
+} Shell_TxWait;
+
+static const uint8_t Shell_Frame_Header[] = FRAME_HEADER;
+
+/**
+ * @brief	shell帧发送完成回调
+ * @details	串口驱动在中断中(或丢弃队列时)调用
+ * @param	Arg 写入任务的完成通知
+ * @param	Sent 是否已发出
+ * @retval	None
+ */
+static void Shell_Tx_Done(void *Arg, bool Sent)
+{
+	Shell_TxWait *pWait = (Shell_TxWait *)Arg;
+
+	pWait->Sent = Sent;
+	pWait->Done = true;
+	if (pWait->Waiter)
+	{
+		Os_Signal_Set(pWait->Waiter, SHELL_SIGNAL_TX);
+	}
+}
+
+/**
+ * @brief	帧头与内容作为一组两段放入串口发送队列
+ * @details	不分配内存、不拷贝数据；内容段引用调用者缓冲区，因此需等待该帧发送完成后才能返回
+ * @param	data 需写的字符数据
+ * @param	len 需要写入的字符数
+ * @retval	实际写入的字符数量
+ */
+static unsigned short Shell_Tx_Frame(const char *data, unsigned short len)
+{
+	uint32_t start;
+	Shell_TxWait wait = {Os_Running() ? Os_Self() : NULL, false, false};
+	UartDma_Segment seg[] = {
+		{Shell_Frame_Header, sizeof(Shell_Frame_Header) - 1U, false, NULL, NULL},
+		{(const uint8_t *)data, len, true, Shell_Tx_Done, &wait},
+	};
+
+	if (!Uart_Dma_Transmit(&SHELL_LINK_UART, seg, sizeof(seg) / sizeof(seg[0])))
+	{ /*队列已满:丢弃本次输出*/
+		return 0;
+	}
+	start = HAL_GetTick();
+	while (!wait.Done)
+	{
+		if (GET_TIMEOUT_FLAG(start, HAL_GetTick(), SHELL_TX_TIMEOUT, HAL_MAX_DELAY))
+		{ /*串口发送卡死:丢弃队列(回调中置位 Done)，避免DMA继续引用已失效的缓冲区*/
+			Uart_Dma_Tx_Abort(&SHELL_LINK_UART);
+			break;
+		}
+		if (wait.Waiter)
+		{
+			Os_Signal_Wait(SHELL_SIGNAL_TX, SHELL_TX_TIMEOUT);
+		}
+	}
+	return wait.Sent ? len : 0;
+}
+#endif
+
 /**
  * @brief shell写数据函数原型
  *
@@ -62,36 +247,219 @@ unsigned short User_Shell_Read(char *data, unsigned short len)
 unsigned short User_Shell_Write(char *data, unsigned short len)
 {
 #if defined(USING_L101)
-	char *pData = (char *)pvPortMalloc(sizeof(len + 3U));
-
-	if (pData)
-	{
-		memcpy(pData, FRAME_HEADER, sizeof(FRAME_HEADER) - 1U);
-		memcpy(&pData[3], data, len);
-	}
-	else
-	{
-		goto __exit;
-	}
-	if (HAL_UART_Transmit(&SHELL_TARGET_UART, (uint8_t *)pData, len + 3U, 0xFFFF) != HAL_OK)
+	return len ? Shell_Tx_Frame(data, len) : 0;
 #else
 #if defined(USING_IO_UART)
 	if (HAL_SUART_Transmit(&SHELL_TARGET_UART, (uint8_t *)data, len, 0xFFFF) != HAL_OK)
 #else
 	if (HAL_UART_Transmit(&SHELL_TARGET_UART, (uint8_t *)data, len, 0xFFFF) != HAL_OK)
-#endif
 #endif
 	{ /*串口发送数据失败*/
 		len = 0;
 	}
-
-#if defined(USING_L101)
-__exit:
-	vPortFree(pData);
+	return len;
 #endif
+}
+
+/*共用日志环尺寸及各任务专用日志环的个数、尺寸(2的整数次幂)*/
+#define SHELL_LOG_SIZE 256U
+#define SHELL_LOG_SLOTS 4U
+#define SHELL_LOG_SLOT_SIZE 64U
+
+/*异步日志环:由低优先级的 Shell_Log_Task 合并发送。
+  专用环只有一个写入任务(首次输出时占用)，写入位置只由该任务推进、发送位置只由发送任务推进，写入时不关中断；
+  中断、调度器启动前、shell任务及专用环已被占完后的任务写入共用环，关中断复制*/
+typedef struct
+{
+	char *Buffer;
+	uint32_t Size;
+	/*自由计数的写入/发送位置*/
+	volatile uint32_t Head, Tail;
+	/*专用环的写入任务，NULL表示空闲*/
+	Os_Thread Owner;
+	uint32_t Dropped;
+} Shell_LogRing;
+
+static char Shell_Log_Shared[SHELL_LOG_SIZE];
+static char Shell_Log_Private[SHELL_LOG_SLOTS][SHELL_LOG_SLOT_SIZE];
+/*[0]为共用环*/
+static Shell_LogRing Shell_Log[1U + SHELL_LOG_SLOTS];
+
+/**
+ * @brief 选择写入的日志环
+ *
+ * @param None
+ *
+ * @return Shell_LogRing* 本任务的专用环，中断或无专用环可用时为共用环
+ */
+static Shell_LogRing *Shell_Log_Select(void)
+{
+	Os_Thread self;
+	Shell_LogRing *pRing;
+
+	if (__get_IPSR() || !Os_Running())
+	{
+		return &Shell_Log[0];
+	}
+	self = Os_Self();
+	/*shell任务的命令输出较长，使用共用环*/
+	if (self == shellHandle)
+	{
+		return &Shell_Log[0];
+	}
+	for (pRing = &Shell_Log[1]; pRing < &Shell_Log[1U + SHELL_LOG_SLOTS]; pRing++)
+	{
+		if (pRing->Owner == self)
+		{
+			return pRing;
+		}
+	}
+	/*首次输出:占用一个空闲的专用环，只在此时关中断*/
+	Os_Critical_Enter();
+	for (pRing = &Shell_Log[1]; (pRing < &Shell_Log[1U + SHELL_LOG_SLOTS]) && (pRing->Owner != NULL); pRing++)
+	{
+	}
+	if (pRing < &Shell_Log[1U + SHELL_LOG_SLOTS])
+	{
+		pRing->Owner = self;
+	}
+	Os_Critical_Exit();
+
+	return (pRing < &Shell_Log[1U + SHELL_LOG_SLOTS]) ? pRing : &Shell_Log[0];
+}
+
+/**
+ * @brief 写入日志环
+ *
+ * @param pRing 日志环
+ * @param data 需写的字符数据
+ * @param len 需要写入的字符数
+ *
+ * @return bool 缓冲区不足时整段丢弃并返回false
+ */
+static bool Shell_Log_Put(Shell_LogRing *pRing, const char *data, uint32_t len)
+{
+	uint32_t head, first;
+
+	if (len > pRing->Size - (pRing->Head - pRing->Tail))
+	{
+		pRing->Dropped++;
+		return false;
+	}
+	head = pRing->Head % pRing->Size;
+	first = (len < pRing->Size - head) ? len : (pRing->Size - head);
+	memcpy(&pRing->Buffer[head], data, first);
+	memcpy(pRing->Buffer, &data[first], len - first);
+	/*内容写完后才推进写入位置，发送任务不会读到未写完的部分*/
+	pRing->Head += len;
+	return true;
+}
+
+/**
+ * @brief shell异步写数据
+ *
+ * @param data 需写的字符数据
+ * @param len 需要写入的字符数
+ *
+ * @return unsigned short 实际写入的字符数量(缓冲区不足时整段丢弃并返回0)
+ */
+unsigned short Shell_Log_Write(char *data, unsigned short len)
+{
+	Shell_LogRing *pRing;
+	uint32_t primask;
+	bool ok;
+
+	if (len == 0U)
+	{
+		return 0;
+	}
+	/*隧道会话期间输出只经隧道返回*/
+	if (Tunnel_Capture(data, len))
+	{
+		return len;
+	}
+	pRing = Shell_Log_Select();
+	if (pRing != &Shell_Log[0])
+	{
+		ok = Shell_Log_Put(pRing, data, len);
+	}
+	else
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		ok = Shell_Log_Put(pRing, data, len);
+		__set_PRIMASK(primask);
+	}
+	if (!ok)
+	{
+		return 0;
+	}
+	/*调度器启动前只缓存，任务运行后统一发送*/
+	if ((shell_logHandle != NULL) && Os_Running())
+	{
+		Os_Signal_Set(shell_logHandle, SHELL_SIGNAL_LOG);
+	}
 	return len;
 }
 
+/**
+ * @brief shell日志发送任务
+ *
+ * @param argument 未使用
+ *
+ * @return None
+ */
+void Shell_Log_Task(void const *argument)
+{
+	Shell_LogRing *pRing;
+	uint32_t tail, length;
+	bool pending;
+
+	for (;;)
+	{
+		/*各环轮流发送，上一次发送期间累积的输出合并为一次写入；同一任务的输出保持顺序*/
+		do
+		{
+			pending = false;
+			for (pRing = &Shell_Log[0]; pRing < &Shell_Log[1U + SHELL_LOG_SLOTS]; pRing++)
+			{
+				if ((length = pRing->Head - pRing->Tail) == 0U)
+				{
+					continue;
+				}
+				tail = pRing->Tail % pRing->Size;
+				/*只发送到缓冲区末尾的连续部分，回绕部分在下一轮发送*/
+				if (length > pRing->Size - tail)
+				{
+					length = pRing->Size - tail;
+				}
+				User_Shell_Write(&pRing->Buffer[tail], (unsigned short)length);
+				pRing->Tail += length;
+				pending = true;
+			}
+		} while (pending);
+		Os_Signal_Wait(SHELL_SIGNAL_LOG, OS_WAIT_FOREVER);
+	}
+}
+
+/**
+ * @brief 打印日志环状态
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Shell_Log_Show(void)
+{
+	for (uint32_t i = 0; i < 1U + SHELL_LOG_SLOTS; i++)
+	{
+		shellPrint(&shell, "[%u] %s: size = %u, used = %u, dropped = %u\r\n", i,
+				   i ? ((Shell_Log[i].Owner != NULL) ? "task" : "free") : "shared", Shell_Log[i].Size,
+				   Shell_Log[i].Head - Shell_Log[i].Tail, Shell_Log[i].Dropped);
+	}
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), log, Shell_Log_Show, show shell log rings);
+
 /**
  * @brief 用户shell上锁
  *
@@ -101,12 +469,7 @@ __exit:
  */
 int userShellLock(Shell *shell)
 {
-#if defined(USING_RTTHREAD)
-	rt_mutex_take(shellMutexHandle, RT_WAITING_FOREVER);
-#else
-	osRecursiveMutexWait(shellMutexHandle, portMAX_DELAY);
-	// osMutexWait(shellMutexHandle, portMAX_DELAY);
-#endif
+	Os_Mutex_Lock(shellMutexHandle);
 	return 0;
 }
 
@@ -119,16 +482,62 @@ int userShellLock(Shell *shell)
  */
 int userShellUnlock(Shell *shell)
 {
-#if defined(USING_RTTHREAD)
-	/* 释 放 互 斥 锁 */
-	rt_mutex_release(shellMutexHandle);
-#else
-	osRecursiveMutexRelease(shellMutexHandle);
-	// osMutexRelease(shellMutexHandle);
-#endif
+	Os_Mutex_Unlock(shellMutexHandle);
 	return 0;
 }
 
+/**
+ * @brief 借出shell输入缓冲区
+ *
+ * @param pSize 缓冲区大小
+ *
+ * @return char* 缓冲区，已借出时返回NULL
+ * @note 只在shell任务停放期间使用(如 USING_L101 的运行模式)，恢复shell前须调用 Shell_Arena_Return 交还；
+ *       借出期间shell丢弃输入
+ */
+char *Shell_Arena_Lend(unsigned short *pSize)
+{
+	if (shell.parser.buffer == NULL)
+	{
+		return NULL;
+	}
+	shellSetArena(&shell, NULL, 0, 0);
+	*pSize = SHELL_BUFFER_SIZE;
+	return shell_buffer;
+}
+
+/**
+ * @brief 交还shell输入缓冲区
+ *
+ * @param None
+ *
+ * @return None
+ * @note 按当前的历史记录深度重新划分缓冲区，命令行及历史记录被清空
+ */
+void Shell_Arena_Return(void)
+{
+	shellSetArena(&shell, shell_buffer, SHELL_BUFFER_SIZE, Shell_History);
+}
+
+/**
+ * @brief 设置历史记录深度
+ *
+ * @param depth 历史记录深度，大于 SHELL_HISTORY_MAX_NUMBER 时按 SHELL_HISTORY_MAX_NUMBER
+ *
+ * @return None
+ * @note 深度越小命令行越长，命令行长度为 SHELL_BUFFER_SIZE / (depth + 1)
+ */
+void Shell_Arena_Split(int depth)
+{
+	Shell_History = (depth <= 0) ? 0U : (((unsigned int)depth > SHELL_HISTORY_MAX_NUMBER) ? SHELL_HISTORY_MAX_NUMBER : (unsigned short)depth);
+	if (shell.parser.buffer != NULL)
+	{
+		Shell_Arena_Return();
+	}
+	shellPrint(&shell, "history = %d, line = %d\r\n", Shell_History, SHELL_BUFFER_SIZE / (Shell_History + 1U));
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), history, Shell_Arena_Split, history depth);
+
 /**
  * @brief shell初始化
  *
@@ -138,10 +547,28 @@ int userShellUnlock(Shell *shell)
  */
 void User_Shell_Init(Shell *shell)
 {
-	shell->write = User_Shell_Write;
+	Shell_Log[0].Buffer = Shell_Log_Shared;
+	Shell_Log[0].Size = SHELL_LOG_SIZE;
+	for (uint32_t i = 0; i < SHELL_LOG_SLOTS; i++)
+	{
+		Shell_Log[1U + i].Buffer = Shell_Log_Private[i];
+		Shell_Log[1U + i].Size = SHELL_LOG_SLOT_SIZE;
+	}
+	shell->write = Shell_Log_Write;
 	shell->read = User_Shell_Read;
 	shell->lock = userShellLock;
 	shell->unlock = userShellUnlock;
 
 	shellInit(shell, shell_buffer, SHELL_BUFFER_SIZE);
 }
+
+/**
+ * @brief	shell的启动模块
+ * @param	None
+ * @retval	None
+ */
+static void User_Shell_Boot_Init(void)
+{
+	User_Shell_Init(&shell);
+}
+BOOT_MODULE(shell, BOOT_LEVEL_MAIN, User_Shell_Boot_Init, "irq");
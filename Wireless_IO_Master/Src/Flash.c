@@ -6,46 +6,309 @@
  */
 
 #include "Flash.h"
+#include "boot.h"
+#include "os_port.h"
+#include "shell_port.h"
 #include "string.h"
 
 /*===================================================================================*/
 /* Flash 分配
-* @用户flash区域：0-125页(1KB/页)
+* @用户flash区域：0-122页(1KB/页)
+* @参数存储区(追加写，两页交替)： 123-124页
+* @路由表： 125页
 * @系统参数区： 126页
 * @校准系数存放区域：127页
 */
 /*===================================================================================*/
 
+/*===================================================================================*/
+/* 擦写窗口
+* @单bank的F103擦写期间取指会停顿到操作结束(擦除一页约20~40ms)
+* @擦写程序及登记的中断处理位于RAM，中断向量表复制到RAM
+* @窗口内只保留登记的中断，其余中断及系统节拍暂停，挂起位保留到窗口结束后处理
+*/
+/*===================================================================================*/
+
+/* 向量数:16个系统异常及全部外设中断；VTOR须按表长向上取2的幂对齐 */
+#define FLASH_VECTORS (16U + (uint32_t)USBWakeUp_IRQn + 1U)
+/* 等待各通道可以开始擦写的最长时间(ms) */
+#define FLASH_READY_TIMEOUT 100U
+
+static uint32_t Flash_Vectors[FLASH_VECTORS] __attribute__((aligned(256)));
+
+/* 后台写入队列及窗口统计 */
+typedef struct
+{
+	/* 复制前的中断向量表，窗口结束后据此恢复登记的向量 */
+	const uint32_t *Rom;
+	const Flash_Ram_Vector *Ram[FLASH_RAM_VECTORS];
+	uint8_t Ram_Count;
+	Flash_Request *Queue[FLASH_QUEUE_SIZE];
+	uint8_t Head;
+	uint8_t Count;
+	/* flash任务，未运行时请求直接在调用者中写入 */
+	Os_Thread Thread;
+	uint32_t Writes;
+	uint32_t Errors;
+	/* 最长的擦写窗口(us) */
+	uint32_t Worst;
+} Flash_HandleTypeDef;
+
+static Flash_HandleTypeDef Flash;
+
 /*
  *  初始化FLASH
+ *  @note 中断向量表复制到RAM，须在开启中断及调度器之前调用
  */
 void FLASH_Init(void)
 {
 	HAL_FLASH_Unlock();
 	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
 	HAL_FLASH_Lock();
+	Flash.Rom = (const uint32_t *)SCB->VTOR;
+	memcpy(Flash_Vectors, Flash.Rom, sizeof(Flash_Vectors));
+	__disable_irq();
+	SCB->VTOR = (uint32_t)Flash_Vectors;
+	__DSB();
+	__enable_irq();
+}
+BOOT_MODULE(flash, BOOT_LEVEL_MAIN, FLASH_Init, "irq");
+
+/**
+ * 登记flash操作期间仍须响应的中断
+ * @param  pVector 中断及其RAM中的处理函数，须静态分配
+ * @return         true 登记成功
+ */
+bool FLASH_Ram_Register(const Flash_Ram_Vector *pVector)
+{
+	if (pVector == NULL || Flash.Ram_Count >= FLASH_RAM_VECTORS)
+		return false;
+
+	Flash.Ram[Flash.Ram_Count++] = pVector;
+	return true;
+}
+
+/**
+ * 等待flash操作结束
+ * @note   位于RAM，只访问寄存器
+ * @return 操作成功
+ */
+static FLASH_RAMFUNC bool FLASH_Ram_Wait(void)
+{
+	bool ok;
+
+	while (FLASH->SR & FLASH_SR_BSY)
+	{
+	}
+	ok = !(FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR));
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+
+	return ok;
+}
+
+/**
+ * 在RAM中擦除一页或按半字写入
+ * @note   位于RAM，只访问寄存器；写入后逐个读回校验
+ * @param  Address 页地址或写入起始地址
+ * @param  Buffer  待写入的数据，为NULL时擦除 Address 所在页
+ * @param  Size    半字数
+ * @return         操作成功
+ */
+static FLASH_RAMFUNC bool FLASH_Ram_Run(uint32_t Address, const uint16_t *Buffer, uint32_t Size)
+{
+	__IO uint16_t *pdst = (__IO uint16_t *)Address;
+	bool ok = true;
+
+	if (Buffer == NULL)
+	{
+		FLASH->CR |= FLASH_CR_PER;
+		FLASH->AR = Address;
+		FLASH->CR |= FLASH_CR_STRT;
+		ok = FLASH_Ram_Wait();
+		FLASH->CR &= ~FLASH_CR_PER;
+		return ok;
+	}
+	FLASH->CR |= FLASH_CR_PG;
+	for (uint32_t i = 0; ok && (i < Size); i++)
+	{
+		pdst[i] = Buffer[i];
+		ok = FLASH_Ram_Wait() && (pdst[i] == Buffer[i]);
+	}
+	FLASH->CR &= ~FLASH_CR_PG;
+
+	return ok;
+}
+
+/**
+ * 登记的各通道是否都可以开始flash操作
+ * @return true 可以开始
+ */
+static bool FLASH_Ready(void)
+{
+	for (uint8_t i = 0; i < Flash.Ram_Count; i++)
+	{
+		if (Flash.Ram[i]->Ready && !Flash.Ram[i]->Ready())
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * 在擦写窗口中执行一次flash操作
+ * @note   窗口内不切换任务；登记的中断改由RAM中的处理函数响应，其余中断暂停，
+ *         系统节拍暂停期间的计数不补偿，窗口结束后补一次节拍
+ * @param  Address 页地址或写入起始地址
+ * @param  Buffer  待写入的数据，为NULL时擦除
+ * @param  Size    半字数
+ * @return         操作成功
+ */
+static bool FLASH_Window(uint32_t Address, const uint16_t *Buffer, uint32_t Size)
+{
+	uint32_t enabled[2], keep[2] = {0, 0}, tickint, primask, start;
+	const Flash_Ram_Vector *pv;
+	bool ok;
+
+	/* 等待各通道进入可暂停的状态(如模拟串口发送结束)，在关中断后确认，最多等待 FLASH_READY_TIMEOUT */
+	for (uint32_t t = 0;; t++)
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if (FLASH_Ready() || !Os_Running() || (t >= FLASH_READY_TIMEOUT))
+			break;
+		__set_PRIMASK(primask);
+		Os_Delay(1U);
+	}
+	Flash.Rom = (Flash.Rom == NULL) ? (const uint32_t *)SCB->VTOR : Flash.Rom;
+	if (FLASH->CR & FLASH_CR_LOCK)
+	{
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+	}
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+	for (uint8_t i = 0; i < Flash.Ram_Count; i++)
+	{
+		pv = Flash.Ram[i];
+		keep[(uint32_t)pv->IRQn >> 5U] |= 1UL << ((uint32_t)pv->IRQn & 0x1FU);
+		Flash_Vectors[16U + (uint32_t)pv->IRQn] = (uint32_t)pv->Handler;
+	}
+	for (uint8_t j = 0; j < 2U; j++)
+	{
+		enabled[j] = NVIC->ISER[j];
+		NVIC->ICER[j] = enabled[j] & ~keep[j];
+	}
+	tickint = SysTick->CTRL & SysTick_CTRL_TICKINT_Msk;
+	SysTick->CTRL &= ~tickint;
+	__DSB();
+	__ISB();
+	start = DWT->CYCCNT;
+	__set_PRIMASK(primask);
+
+	ok = FLASH_Ram_Run(Address, Buffer, Size);
+
+	__disable_irq();
+	start = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000U);
+	Flash.Worst = (start > Flash.Worst) ? start : Flash.Worst;
+	FLASH->CR |= FLASH_CR_LOCK;
+	for (uint8_t i = 0; i < Flash.Ram_Count; i++)
+	{
+		pv = Flash.Ram[i];
+		Flash_Vectors[16U + (uint32_t)pv->IRQn] = Flash.Rom[16U + (uint32_t)pv->IRQn];
+	}
+	__DSB();
+	SysTick->CTRL |= tickint;
+	if (tickint)
+	{
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+	}
+	for (uint8_t j = 0; j < 2U; j++)
+	{
+		NVIC->ISER[j] = enabled[j];
+	}
+	__set_PRIMASK(primask);
+	for (uint8_t i = 0; i < Flash.Ram_Count; i++)
+	{
+		if (Flash.Ram[i]->Leave)
+		{
+			Flash.Ram[i]->Leave();
+		}
+	}
+
+	return ok;
+}
+
+/**
+ * 擦除一页
+ * @param  Address 页地址
+ * @return         擦除成功
+ */
+bool FLASH_Erase(uint32_t Address)
+{
+	if (Address < STM32FLASH_BASE || (Address >= STM32FLASH_END))
+		return false;
+
+	return FLASH_Window(Address, NULL, 0);
+}
+
+/**
+ * 按半字写入已擦除的flash
+ * @param  Address 写入起始地址，！！！要求2字节对齐！！！
+ * @param  Buffer  待写入的数据
+ * @param  Size    半字数
+ * @return         写入并校验成功
+ */
+bool FLASH_Program(uint32_t Address, const uint16_t *Buffer, uint32_t Size)
+{
+	if (Address < STM32FLASH_BASE || (Address + Size * 2U > STM32FLASH_END) || (Address & 0x01U) || Buffer == NULL)
+		return false;
+
+	return (Size == 0) || FLASH_Window(Address, Buffer, Size);
+}
+
+/**
+ * 映射FLASH
+ * @param  Address 地址
+ * @note   flash按存储器映射直接读取，参数记录无需拷贝；记录结构体须按页首对齐存放
+ * @param  Size    数据大小，单位字节
+ * @return         数据的只读指针，地址非法时返回NULL
+ */
+const void *FLASH_Map(uint32_t Address, uint32_t Size)
+{
+	/* 非法地址 */
+	if (Address < STM32FLASH_BASE || (Address + Size > STM32FLASH_END) || Size == 0)
+		return NULL;
+
+	return (const void *)Address;
 }
 
 /**
  * 读FLASH
  * @param  Address 地址
- * @note   为了兼容各种数据类型，按字节读取
+ * @note   地址及缓冲区均按字对齐时按字拷贝，其余部分按字节拷贝
  * @param  Buffer  存放读取的数据
  * @param  Size    要读取的数据大小，单位字节
  * @return         读出成功的字节数
  */
 bool FLASH_Read(uint32_t Address, void *Buffer, uint32_t Size)
 {
+	const uint8_t *psrc = (const uint8_t *)FLASH_Map(Address, Size);
 	uint8_t *pdata = (uint8_t *)Buffer;
+	uint32_t i = 0;
 
 	/* 非法地址 */
-	if (Address < STM32FLASH_BASE || (Address > STM32FLASH_END) || Size == 0 || Buffer == NULL)
+	if (psrc == NULL || Buffer == NULL)
 		return false;
-	
-	for(uint32_t i = 0; i < Size; i++)
+
+	if (((Address | (uint32_t)pdata) & 0x03U) == 0)
+	{
+		for (; i + 4U <= Size; i += 4U)
+		{
+			*(uint32_t *)(pdata + i) = *(const uint32_t *)(psrc + i);
+		}
+	}
+	for (; i < Size; i++)
 	{
-		pdata[i] = *(__IO uint16_t*)Address;
-		Address += 1U;
+		pdata[i] = psrc[i];
 	}
 
 	return true;
@@ -53,47 +316,98 @@ bool FLASH_Read(uint32_t Address, void *Buffer, uint32_t Size)
 
 /**
  * 写FLASH
+ * @note   先擦除 Address 所在页，擦除及写入均在擦写窗口中进行
  * @param  Address    写入起始地址，！！！要求2字节对齐！！！
  * @param  Buffer     待写入的数据，！！！要求2字节对齐！！！
  * @param  Size 要写入的数据量，单位：半字，！！！要求2字节对齐！！！
- * @return            实际写入的数据量，单位：字节
+ * @return            0 成功，非0 失败
  */
 uint32_t FLASH_Write(uint32_t Address, const uint16_t *Buffer, uint32_t Size)
-{   
-	/*初始化FLASH_EraseInitTypeDef*/
-    FLASH_EraseInitTypeDef pEraseInit;
-    /*设置PageError*/
-    uint32_t PageError = 0;
-	
+{
 	/* 非法地址 */
 	if (Address < STM32FLASH_BASE || (Address > STM32FLASH_END) || Size == 0 || Buffer == NULL)
+		return true;
+
+	return !FLASH_Erase(Address) || !FLASH_Program(Address, Buffer, Size);
+}
+
+/**
+ * 提交后台写入请求
+ * @note   flash任务未运行(如调度器启动前)时直接写入
+ * @param  pRequest 写入请求
+ * @return          false 上次请求尚未完成或队列已满
+ */
+bool FLASH_Post(Flash_Request *pRequest)
+{
+	bool ok = false;
+
+	if (pRequest == NULL || pRequest->State == FLASH_REQ_PENDING)
 		return false;
-	
-	/*1、解锁FLASH*/
-    HAL_FLASH_Unlock();
-    /*2、擦除FLASH*/
-	pEraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
-    pEraseInit.PageAddress = Address;
-    pEraseInit.NbPages = 1U;
-	/*清除flash标志位*/
-	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
-    HAL_FLASHEx_Erase(&pEraseInit, &PageError);
-    /*3、对FLASH烧写*/
-    uint16_t TempBuf = 0;
-    for(uint32_t i = 0; i < Size; i++)
-    {
-        TempBuf = *(Buffer + i);
-        HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD , Address + i * 2, TempBuf);
-		/*写完数据之后，再读出来校验*/
-		if ((*(__IO uint16_t*) (Address + i * 2) != TempBuf))
+
+	if (Flash.Thread == NULL || !Os_Running())
+	{
+		pRequest->State = FLASH_Write(pRequest->Address, pRequest->pData, pRequest->Size) ? FLASH_REQ_FAILED : FLASH_REQ_DONE;
+		return (pRequest->State == FLASH_REQ_DONE);
+	}
+	Os_Critical_Enter();
+	if (Flash.Count < FLASH_QUEUE_SIZE)
+	{
+		pRequest->State = FLASH_REQ_PENDING;
+		Flash.Queue[(Flash.Head + Flash.Count) % FLASH_QUEUE_SIZE] = pRequest;
+		Flash.Count++;
+		ok = true;
+	}
+	Os_Critical_Exit();
+	if (ok)
+	{
+		Os_Signal_Set(Flash.Thread, FLASH_SIGNAL_POST);
+	}
+
+	return ok;
+}
+
+/**
+ * 处理后台写入请求
+ * @note   由flash任务循环调用：依次写入排队的请求，队列为空时等待新的请求
+ * @param  Timeout 最长等待时间(ms)
+ */
+void FLASH_Process(uint32_t Timeout)
+{
+	Flash_Request *preq;
+
+	Flash.Thread = Os_Self();
+	for (;;)
+	{
+		Os_Critical_Enter();
+		preq = Flash.Count ? Flash.Queue[Flash.Head] : NULL;
+		Os_Critical_Exit();
+		if (preq == NULL)
+			break;
+
+		Flash.Writes++;
+		if (FLASH_Write(preq->Address, preq->pData, preq->Size))
+		{
+			Flash.Errors++;
+			preq->State = FLASH_REQ_FAILED;
+		}
+		else
 		{
-			return true;
+			preq->State = FLASH_REQ_DONE;
 		}
-		// Usart1_Printf("addr is  %d\r\n", Address);	
-    }
-    /*4、锁住FLASH*/
-    HAL_FLASH_Lock();
-	
-	return PageError;
+		Os_Critical_Enter();
+		Flash.Head = (Flash.Head + 1U) % FLASH_QUEUE_SIZE;
+		Flash.Count--;
+		Os_Critical_Exit();
+	}
+	Os_Signal_Wait(FLASH_SIGNAL_POST, Timeout);
 }
 
+/**
+ * 打印后台写入统计
+ */
+void FLASH_Show(void)
+{
+	shellPrint(&shell, "queue = %d/%d, writes = %d, errors = %d, worst window = %dus, ram irqs = %d\r\n",
+			   Flash.Count, FLASH_QUEUE_SIZE, Flash.Writes, Flash.Errors, Flash.Worst, Flash.Ram_Count);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), flash, FLASH_Show, show flash writer);
@@ -1,489 +1,3336 @@
 #include "L101.h"
+#include "boot.h"
 #include "usart.h"
-#if defined(USING_RTTHREAD)
-#include "rtthread.h"
-#else
-#include "cmsis_os.h"
-#endif
+#include "os_port.h"
 #include "shell_port.h"
 #include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "mdcrc16.h"
 #include "io_signal.h"
+#include "Flash.h"
+#include "trace.h"
+#include "route.h"
+#include "mode.h"
+#include "kv.h"
+#include "retain.h"
+#include "auth.h"
+#if defined(USING_GATEWAY)
+#include "gateway.h"
+#endif
+#if defined(USING_TDMA)
+#include "tdma.h"
+#endif
+#if defined(USING_STANDBY)
+#include "standby.h"
+#endif
+#if defined(USING_XFER)
+#include "xfer.h"
+#endif
+#if defined(USING_OTA)
+#include "ota.h"
+#endif
+#if defined(USING_SCENE)
+#include "scene.h"
+#endif
+#if defined(USING_DISCOVER)
+#include "discover.h"
+#endif
+#if defined(USING_UTIMER)
+#include "utimer.h"
+#endif
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+/*L101模块数及事件所在信道由哪个模块服务(即请求引擎端口)*/
+#define L101_RADIOS 2U
+#define L101_RADIO_OF(pL) Radio2_Port(L101_Next_Channel(pL))
+#else
+#define L101_RADIOS 1U
+#define L101_RADIO_OF(pL) 0U
+#endif
+#include <stdlib.h>
+
+/*往返时间计时基准(ms)*/
+#define L101_GET_MS() Os_Tick()
+
+extern Os_Thread radioHandle;
 
 /*定义L101临时组包缓冲区*/
 // static uint8_t g_pFBuffer[PF_TX_SIZE] = {0};
 
-/*建立lora模块各节点间调度数据结构*/
+/*建立lora模块各节点间调度数据结构:bit n对应L101_Map[n]*/
 typedef struct
 {
-    List_t *Ready;
-    List_t *Block;
+    uint32_t Ready;
+    uint32_t Block;
+    /*已发出请求、等待应答的事务集合*/
+    uint32_t Busy;
+    /*就绪/阻塞集合的轮询游标*/
+    uint16_t Pos[2U];
     bool First_Flag;
 } L101_Schedule __attribute__((aligned(4)));
 
-static L101_Schedule *pLs = NULL;
-static ListItem_t *g_Item[2U] = {NULL, NULL};
+/*调度集合最多容纳32个事件*/
+typedef char L101_Map_Size_Check[(EXTERN_DIGITAL_MAX <= 32U) ? 1 : -1];
+
+/*存储在flash中的节点映射记录*/
+typedef struct
+{
+    uint16_t Magic;
+    uint8_t Version;
+    uint8_t Nodes;
+    /*网络功耗配置*/
+    uint8_t Power;
+    uint8_t Reserved;
+    uint16_t Wtm;
+    uint16_t Itm;
+    struct
+    {
+        uint16_t Sdevice_Addr;
+        uint8_t Schannel;
+        uint8_t Slave_Id;
+        uint16_t Digital_Addr;
+        uint16_t Analog_Addr;
+    } Node[EXTERN_DIGITAL_MAX];
+    uint16_t Crc16;
+} L101_Map_Record __attribute__((aligned(2)));
+
+/*链路管理:全网共用一个速率等级*/
+typedef struct
+{
+    /*模块当前速率等级*/
+    uint8_t Spd;
+    /*期望的速率等级*/
+    uint8_t Target;
+    /*连续满足升速条件的窗口数*/
+    uint8_t Good;
+    /*当前窗口内完成的事务数*/
+    uint16_t Count;
+    /*全网连续超时次数*/
+    uint16_t Timeouts;
+    /*模块最近一次上报的信号强度，0表示尚未上报*/
+    uint8_t Rssi;
+} L101_Link;
+
+/*发送准入模型:写入模块的数据按当前速率等级排队发送*/
+typedef struct
+{
+    /*模块缓冲区中的数据预计发完的时刻(ms)*/
+    volatile uint32_t Drain;
+    /*STATUS引脚变为空闲的次数及模块忙时提前写入的帧数*/
+    volatile uint32_t Edges;
+    volatile uint32_t Early;
+} L101_Admit;
+
+#if defined(USING_AIMD)
+/*拥塞控制:令牌桶限制遥测、心跳及诊断请求的提交速率，报警及控制类请求不受限但同样消耗令牌(可透支)*/
+typedef struct
+{
+    /*当前速率(0.1帧/s)，由 l101_rate 命令固定时不再调整*/
+    uint16_t Rate;
+    bool Locked;
+    /*本周期内令牌曾达到上限(速率未限制提交，不提速)*/
+    bool Full;
+    /*令牌(一帧为 L101_AIMD_FRAME)*/
+    int32_t Credit;
+    /*上次补充令牌的时刻及本周期开始时刻(ms)*/
+    uint32_t Last;
+    uint32_t Start;
+    /*本周期内在线从站完成的事务数及其中超时、失败的事务数*/
+    uint16_t Done;
+    uint16_t Lost;
+    /*上一周期的丢包率(%)及累计提速、降速次数*/
+    uint8_t Loss;
+    uint32_t Ups;
+    uint32_t Downs;
+} L101_Pace;
+#endif
+
+#if defined(USING_AIRTIME)
+/*占空比预算:各时段累计主模块的发送时间(ms)，窗口内各时段之和为已用的空中时间*/
+typedef struct
+{
+    uint32_t Bucket[L101_AIR_BUCKETS];
+    uint8_t Head;
+    /*当前时段的开始时刻(ms)*/
+    uint32_t Start;
+    /*窗口内已用的空中时间(ms)*/
+    uint32_t Used;
+    /*发送完成中断中累计、尚未计入时段的空中时间(ms)*/
+    volatile uint32_t Fresh;
+    /*占空比(0.1%)*/
+    uint16_t Duty;
+    /*累计的空中时间(ms)，余量不足时停发遥测及诊断的次数，预算耗尽时停止发送的次数*/
+    uint32_t Total;
+    uint32_t Shed;
+    uint32_t Blocked;
+} L101_Air;
+#endif
+
+/*网络功耗配置:全网共用唤醒间隔，主站据此安排发送及等待应答*/
+typedef struct
+{
+    /*期望的功耗模式及主站模块当前的功耗模式*/
+    uint8_t Mode;
+    uint8_t Applied;
+    uint16_t Wtm;
+    uint16_t Itm;
+    /*配置已修改，待写入主站模块*/
+    bool Pending;
+} L101_Power;
+
+/*延迟测试:按设定间隔向目标从站发出带序号及时刻的回显帧，序号最低位作为翻转的虚拟输入*/
+typedef struct
+{
+    bool Enable;
+    /*目标事件，LEVENTS及以上时轮流发往各从站*/
+    uint16_t Event;
+    /*轮流发送的游标*/
+    uint16_t Cursor;
+    uint16_t Seq;
+    /*发送间隔及上一帧发出时刻(ms)*/
+    uint32_t Interval;
+    uint32_t Last;
+} L101_Test;
+
+/*各从站的延迟测试统计:往返时间不含唤醒码时长*/
+typedef struct
+{
+    uint32_t Tx;
+    uint32_t Rx;
+    uint32_t Lost;
+    uint32_t Min;
+    uint32_t Max;
+    uint32_t Sum;
+    uint16_t Hist[L101_TEST_BINS];
+} L101_Latency;
+
+/*往返时间直方图各档上限(ms)，最后一档不设上限*/
+static const uint16_t g_Test_Bins[L101_TEST_BINS - 1U] = {20, 40, 60, 80, 100, 150, 200, 250, 300, 400, 500,
+                                                          600, 800, 1000, 1500, 2000, 3000};
+static L101_Test g_Test;
+static L101_Latency g_Latency[EXTERN_DIGITAL_MAX];
+#if defined(USING_TIMESYNC)
+/*时间同步:轮流发送的游标、上一帧发出时刻(ms)及发出的帧数*/
+static struct
+{
+    uint16_t Cursor;
+    uint32_t Last;
+    uint32_t Tx;
+} g_Sync;
+#endif
+static L101_Link g_Link = {.Spd = L101_SPD_MAX, .Target = L101_SPD_MAX};
+/*各速率等级的空中速率(bps)，与AT+SPD 1~10对应*/
+static const uint16_t g_Air_Rate[L101_SPD_MAX] = {268, 488, 537, 878, 977, 1758, 3125, 6250, 10937, 21875};
+static L101_Admit g_Admit;
+#if defined(USING_AIMD)
+/*一帧消耗的令牌:速率(0.1帧/s)乘以时间(ms)*/
+#define L101_AIMD_FRAME 10000L
+/*令牌上限(帧):各模块可同时在途的请求数*/
+#define L101_AIMD_BURST (L101_RADIOS * L101_MAX_PIPELINE)
+static L101_Pace g_Pace;
+#endif
+#if defined(USING_AIRTIME)
+/*每个时段的时长(ms)*/
+#define L101_AIR_SLOT (L101_AIR_WINDOW * 1000U / L101_AIR_BUCKETS)
+static L101_Air g_Air = {.Duty = L101_AIR_DUTY};
+#endif
+static L101_Power g_Power = {.Mode = L101_POWER_RUN, .Applied = L101_POWER_RUN, .Wtm = L101_WTM_DEFAULT, .Itm = L101_ITM_DEFAULT};
+static L101_Schedule g_Schedule;
+static L101_Schedule *pLs = &g_Schedule;
+/*曾经在线的节点集合，与参数存储区中的记录一致*/
+static uint32_t g_Known;
+/*各从站变位事件标志位(bit n对应L101_Map[n])*/
+static volatile uint32_t g_Dirty = 0;
+/*各从站模拟量报警事件标志位(bit n对应L101_Map[n])，可在中断中置位*/
+static volatile uint32_t g_Alarm = 0;
+/*各从站模拟量待发送标志位(bit n对应L101_Map[n])，由模拟量死区/发送间隔判断后在中断中置位*/
+static volatile uint32_t g_Analog = 0;
+/*首次扫描的游标*/
+static uint16_t g_Scan = 0;
+/*中继路由表*/
+static L101_Hop g_Hop[L101_HOPS];
+typedef char L101_Hop_Size_Check[(sizeof(g_Hop) <= KV_VALUE_MAX) ? 1 : -1];
+
+/*调度索引:由节点配置导出的位图及紧凑数组，只在配置变化时由 L101_Index_Build() 重建，
+  调度节拍及中断中不再逐个比较节点的地址、信道*/
+typedef struct
+{
+    /*各目标从站首个事件的集合*/
+    uint32_t Leaders;
+    /*事件号不小于该事件、目标从站相同的事件集合，及目标从站的首个事件号*/
+    uint32_t Group[EXTERN_DIGITAL_MAX];
+    uint8_t Leader[EXTERN_DIGITAL_MAX];
+    /*各模块服务的事件集合*/
+    uint32_t Radio[L101_RADIOS];
+    /*各事件的线圈及模拟量地址，连续存放供中断中按地址查找*/
+    uint16_t Digital[EXTERN_DIGITAL_MAX];
+    uint16_t Analog[EXTERN_DIGITAL_MAX];
+} L101_Index;
+static L101_Index g_Index;
+typedef char L101_Index_Check[(EXTERN_DIGITAL_MAX <= 32U) ? 1 : -1];
 
-extern osThreadId shellHandle;
-extern osThreadId mdbusHandle;
-extern osTimerId Timer1Handle;
 /*静态函数声明*/
+static mdBOOL L101_Ready(ModbusRTUMasterHandler handler);
+#if (MODBUS_FEC)
+static mdU8 L101_Fec_Level(ModbusRTUMasterHandler handler, mdU8 port, mdU8 slaveId);
+#endif
+static mdVOID L101_Tx_Done(ModbusRTUSlaveHandler handler);
+static const L101_Hop *L101_Hop_Find(const L101_HandleTypeDef *pL);
+static bool L101_Coil_Settled(L101_HandleTypeDef *pL);
+static uint8_t L101_Next_Channel(const L101_HandleTypeDef *pL);
+static void L101_Index_Build(void);
+#if defined(USING_BATCH_FRAME)
+static uint8_t Set_CoilsFrame(L101_HandleTypeDef *pL);
+#define L101_FRAME_FUNC Set_CoilsFrame
+#else
 static uint8_t Set_BitFrame(L101_HandleTypeDef *pL);
+#define L101_FRAME_FUNC Set_BitFrame
+#endif
 
 /*L101事件处理映射图*/
-L101_HandleTypeDef L101_Map[EXTERN_DIGITAL_MAX] = {
-    {.Sdevice_Addr = 0x01, .Schannel = 0x01, .Slave_Id = 0x01, .Digital_Addr = 0x0000, .Crc16 = 0, .Analog_Addr = 0x0000, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x02, .Schannel = 0x02, .Slave_Id = 0x02, .Digital_Addr = 0x0001, .Crc16 = 0, .Analog_Addr = 0x0001, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x03, .Schannel = 0x03, .Slave_Id = 0x03, .Digital_Addr = 0x0002, .Crc16 = 0, .Analog_Addr = 0x0002, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x04, .Schannel = 0x04, .Slave_Id = 0x04, .Digital_Addr = 0x0003, .Crc16 = 0, .Analog_Addr = 0x0003, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x05, .Schannel = 0x05, .Slave_Id = 0x05, .Digital_Addr = 0x0004, .Crc16 = 0, .Analog_Addr = 0x0004, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x06, .Schannel = 0x06, .Slave_Id = 0x06, .Digital_Addr = 0x0005, .Crc16 = 0, .Analog_Addr = 0x0005, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x07, .Schannel = 0x07, .Slave_Id = 0x07, .Digital_Addr = 0x0006, .Crc16 = 0, .Analog_Addr = 0x0006, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-    {.Sdevice_Addr = 0x08, .Schannel = 0x08, .Slave_Id = 0x08, .Digital_Addr = 0x0007, .Crc16 = 0, .Analog_Addr = 0x0007, .Check = {L_None, 3U, 0}, .func = Set_BitFrame},
-};
+/*默认节点由板级配置展开:节点n转发本机线圈 BOARD_REG_OUTPUT + n，读取原始码值 Analog_Addr = n*/
+#define L101_MAP_ENTRY(ch, port, pin, addr, chan, id)                                                \
+    [ch] = {.Sdevice_Addr = (addr), .Schannel = (chan), .Slave_Id = (id), .Digital_Addr = BOARD_REG_OUTPUT + (ch), \
+            .Crc16 = 0, .Analog_Addr = (ch), .Check = {L_None, 3U, 0}},
+L101_HandleTypeDef L101_Map[EXTERN_DIGITAL_MAX] = {BOARD_DIGITAL_TABLE(L101_MAP_ENTRY)};
+/*当前配置的节点数(不大于L101_MAX_EVENTS)*/
+uint16_t g_L101_Events = EXTERN_DIGITAL_MAX;
 
 /**
- * @brief  初始化调度列表
+ * @brief  恢复复位前的调度状态
+ * @details 热复位时从保留区恢复节点集合及模块速率等级(模块未随MCU复位)，不再重新扫描全网；
+ *          上电时以参数存储区中曾在线的节点作为提示直接按事件调度，离线节点由心跳移入阻塞集合
  * @param  None
  * @retval None
  */
-void Slist_Init(void)
+static void L101_Schedule_Restore(void)
 {
-    pLs = (L101_Schedule *)pvPortMalloc(sizeof(L101_Schedule));
-    if (pLs != NULL)
+    uint32_t mask = (LEVENTS >= 32U) ? 0xFFFFFFFFUL : ((1UL << LEVENTS) - 1UL);
+    Retain_Data retain;
+
+    g_Known = 0;
+    Kv_Get(KV_KEY_NODES, &g_Known, sizeof(g_Known));
+    if (Retain_Load(&retain))
     {
-        pLs->Ready = (List_t *)pvPortMalloc(sizeof(List_t));
-        pLs->Ready ? (vListInitialise(pLs->Ready)) : (vPortFree(pLs->Ready));
-        pLs->Block = (List_t *)pvPortMalloc(sizeof(List_t));
-        pLs->Block ? (vListInitialise(pLs->Block)) : (vPortFree(pLs->Block));
-        pLs->First_Flag = false;
+        pLs->Ready = retain.Ready & mask;
+        pLs->Block = retain.Block & mask & ~pLs->Ready;
+        pLs->First_Flag = retain.Scanned;
+        if ((retain.Spd >= L101_SPD_MIN) && (retain.Spd <= L101_SPD_MAX))
+        {
+            g_Link.Spd = g_Link.Target = retain.Spd;
+        }
     }
-    else
+    else if (g_Known & mask)
     {
-        vPortFree(pLs);
+        pLs->Ready = g_Known & mask;
+        pLs->First_Flag = true;
     }
+    Retain_Set_Nodes(pLs->Ready, pLs->Block, pLs->First_Flag);
+    /*模块保持保留区中的速率等级，按其设定初始等待窗口*/
+    L101_Link_Applied(g_Link.Spd);
 }
 
 /**
- * @brief  取得16bitCRC校验码
- * @param  ptr   当前数据串指针
- * @param  length  数据长度
- * @param  init_dat 校验所用的初始数据
- * @retval 16bit校验码
+ * @brief  保存调度状态
+ * @details 每次调度后调用:节点集合变化时写入保留区；出现新的在线节点时记入参数存储区，
+ *          节点上下线反复变化不会重复写flash
+ * @param  None
+ * @retval None
  */
-static uint16_t Get_Crc16(uint8_t *ptr, uint16_t length, uint16_t init_dat)
+static void L101_Schedule_Save(void)
 {
-    uint16_t i = 0;
-    uint16_t j = 0;
-    uint16_t crc16 = init_dat;
+    static uint32_t ready = 0, block = 0;
+    static bool scanned = false;
 
-    for (i = 0; i < length; i++)
+    if ((pLs->Ready == ready) && (pLs->Block == block) && (pLs->First_Flag == scanned))
     {
-        crc16 ^= *ptr++;
+        return;
+    }
+    ready = pLs->Ready;
+    block = pLs->Block;
+    scanned = pLs->First_Flag;
+    Retain_Set_Nodes(ready, block, scanned);
+    if (ready & ~g_Known)
+    {
+        g_Known |= ready;
+        Kv_Set(KV_KEY_NODES, &g_Known, sizeof(g_Known));
+    }
+}
+
+/**
+ * @brief  取得镜像给热备主站的调度状态
+ * @details 在无线调度任务中调用；只取已被从站确认的线圈，在途的线圈由接管后的调度重新确认
+ * @param  pM 调度状态
+ * @retval None
+ */
+void L101_Mirror_Get(L101_Mirror *pM)
+{
+    L101_HandleTypeDef *pL;
+    mdBit bit;
 
-        for (j = 0; j < 8; j++)
+    memset(pM, 0, sizeof(*pM));
+    Os_Critical_Enter();
+    pM->Ready = pLs->Ready;
+    pM->Block = pLs->Block;
+    Os_Critical_Exit();
+    pM->Scanned = pLs->First_Flag;
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        if ((mdRTU_ReadCoil(Master_Object, pL->Digital_Addr, bit) == mdTRUE) && bit)
         {
-            crc16 = (crc16 & 0x0001) ? ((crc16 >> 1) ^ 0xa001) : (crc16 >> 1U);
+            pM->Coils |= 1UL << i;
         }
+        pM->Coil_Ack |= pL->Coil_Ack ? (1UL << i) : 0;
+        pM->Coil_Valid |= (pL->Coil_Valid && !pL->Coil_Pending) ? (1UL << i) : 0;
     }
-    return (crc16);
 }
 
 /**
- * @brief  大小端数据类型交换
- * @note   对于一个单精度浮点数的交换仅仅需要2次
- * @param  pData 数据
- * @param  start 开始位置
- * @param  length  数据长度
+ * @brief  采用主用主站镜像的调度状态
+ * @details 备用主站在无线调度任务中调用(此时不发出请求)：节点集合及线圈确认值与主用主站一致，
+ *          接管后已确认的从站直接按事件调度，不重新扫描，线圈与确认值相同的事件不重发；
+ *          本机线圈写为主用主站的目标输出，同时写入保留区
+ * @param  pM 调度状态
  * @retval None
  */
-void Endian_Swap(uint8_t *pData, uint8_t start, uint8_t length)
+void L101_Mirror_Set(const L101_Mirror *pM)
 {
-    uint8_t i = 0;
-    uint8_t tmp = 0;
-    uint8_t count = length / 2U;
-    uint8_t end = start + length - 1U;
+    uint32_t mask = (LEVENTS >= 32U) ? 0xFFFFFFFFUL : ((1UL << LEVENTS) - 1UL);
+    L101_HandleTypeDef *pL;
 
-    for (; i < count; i++)
+    for (uint16_t i = 0; i < LEVENTS; i++)
     {
-        tmp = pData[start + i];
-        pData[start + i] = pData[end - i];
-        pData[end - i] = tmp;
+        pL = &L101_Map[i];
+        mdRTU_WriteCoil(Master_Object, pL->Digital_Addr, (pM->Coils >> i) & 0x01U);
+        pL->Coil_Ack = (uint8_t)((pM->Coil_Ack >> i) & 0x01U);
+        pL->Coil_Valid = ((pM->Coil_Valid >> i) & 0x01U) ? true : false;
+        pL->Coil_Pending = false;
     }
+    Os_Critical_Enter();
+    pLs->Ready = pM->Ready & mask;
+    pLs->Block = pM->Block & mask & ~pLs->Ready;
+    pLs->Busy = 0;
+    Os_Critical_Exit();
+    pLs->First_Flag = pM->Scanned;
+    L101_Schedule_Save();
 }
 
+#if defined(USING_COS_MODE)
 /**
- * @brief	获取Lora模块当前是否空闲
- * @details	无线发送数据时拉低，用于指示发送繁忙状态
- * @param	None
- * @retval	ture/fale
+ * @brief  线圈变化通知
+ * @details 由寄存器池在写入方的上下文中调用，只标记变位事件，请求由调度节拍发出
+ * @param  handler 寄存器池
+ * @param  index 变化标记表下标
+ * @param  changed 变化的位
+ * @param  arg 未使用
+ * @retval None
  */
-bool inline Get_L101_Status(void)
+static mdVOID L101_Coil_Changed(RegisterPoolHandle handler, mdU32 index, mdU16 changed, mdVOID *arg)
 {
-    return ((bool)HAL_GPIO_ReadPin(STATUS_GPIO_Port, STATUS_Pin));
+    UNUSED(handler);
+    UNUSED(arg);
+    for (uint16_t bit = 0; changed; bit++, changed >>= 1U)
+    {
+        if (changed & 0x01)
+        {
+            Set_L101_Dirty((uint16_t)((index - REGISTER_POOL_COILS) * REGISTER_WIDTH + bit));
+        }
+    }
 }
+#endif
 
 /**
- * @brief	Lora模块恢复出厂设置
- * @details	拉低 3s 以上恢复出厂设置
- * @param	None
- * @retval	None
+ * @brief  初始化调度列表
+ * @param  None
+ * @retval None
  */
-void Set_L101_FactoryMode(void)
+void Slist_Init(void)
 {
-    HAL_GPIO_WritePin(RELOAD_GPIO_Port, RELOAD_Pin, GPIO_PIN_RESET);
-#if defined(USING_RTTHREAD)
-    rt_thread_mdelay(3500);
-#else
-    osDelay(3500);
+    /*flash中无有效记录时使用默认映射表*/
+    L101_Map_Load();
+    Route_Init();
+    pLs->Ready = 0;
+    pLs->Block = 0;
+    pLs->Busy = 0;
+    pLs->Pos[0] = pLs->Pos[1] = LEVENTS - 1U;
+    pLs->First_Flag = false;
+    L101_Schedule_Restore();
+    if (Kv_Get(KV_KEY_HOP, g_Hop, sizeof(g_Hop)) != sizeof(g_Hop))
+    {
+        memset(g_Hop, 0, sizeof(g_Hop));
+    }
+    L101_Index_Build();
+#if defined(USING_TDMA)
+    Tdma_Init();
+#endif
+#if defined(USING_STANDBY)
+    Standby_Init();
+#endif
+    /*L101模块忙时请求留在主站请求队列中*/
+    if (Client_Object != NULL)
+    {
+        Client_Object->mdRTUMasterReady = L101_Ready;
+#if (MODBUS_FEC)
+        Client_Object->mdRTUMasterFec = L101_Fec_Level;
+#endif
+        /*应答CRC错误及请求队列满可作为跟踪的触发条件*/
+        Trace_Watch(TRACE_TRIG_CRC, (const volatile uint32_t *)&Client_Object->crcErrors);
+        Trace_Watch(TRACE_TRIG_QUEUE, (const volatile uint32_t *)&Client_Object->drops);
+    }
+    /*每帧写入模块后按空中时间推进准入模型*/
+    if (Master_Object != NULL)
+    {
+        Master_Object->mdRTUTxDone = L101_Tx_Done;
+    }
+#if defined(USING_L101_RADIO2)
+    Radio2_Init();
+#endif
+#if (MODBUS_AUTH)
+    Auth_Init();
+#endif
+#if defined(USING_COS_MODE)
+    /*线圈无论由上位机、路由表还是本机改写，变化时都立即标记对应节点*/
+    if (Master_Object != NULL)
+    {
+        Master_Object->registerPool->ops->mdSubscribe(Master_Object->registerPool, mdCOIL_INDEX(0),
+                                                 mdBITS_TO_WORDS(COIL_POOL_SIZE), L101_Coil_Changed, NULL);
+    }
 #endif
-    HAL_GPIO_WritePin(RELOAD_GPIO_Port, RELOAD_Pin, GPIO_PIN_SET);
 }
+/*节点表从保留区恢复，上电时以参数区中的提示恢复；第二个模块接在软件串口上*/
+BOOT_MODULE(slist, BOOT_LEVEL_STAGE, Slist_Init, "retain_resume,kv_boots,suart");
 
 /**
- * @brief	确定Lora模块工作的方式
- * @details
- * @param	handler:modbus主机/从机句柄
- * @retval	true:定点模式;fasle:shell
+ * @brief  运行时修改一个事件的目标从站
+ * @param  event 事件号
+ * @param  addr 从站设备地址
+ * @param  channel 从站信道
+ * @param  id 从站号
+ * @retval 0 成功 0xFF 参数错误
  */
-bool Check_Mode(ModbusRTUSlaveHandler handler)
+uint8_t L101_Set_Map(int event, int addr, int channel, int id)
 {
-    ReceiveBufferHandle pB = handler->receiveBuffer;
+    L101_HandleTypeDef *pL = NULL;
+
+    if ((event < 0) || (event >= (int)L101_MAX_EVENTS) || (id < 0) || (id > 0xFF) ||
+        (addr < 0) || (addr > 0xFFFF) || (channel < 0) || (channel > 0xFF))
+    {
+        return 0xFF;
+    }
+    pL = &L101_Map[event];
+    Os_Critical_Enter();
+    pL->Sdevice_Addr = addr;
+    pL->Schannel = channel;
+    pL->Slave_Id = id;
+    pL->Check.State = L_None;
+    pL->Check.Srtt = 0;
+    pL->Coil_Valid = false;
+    /*目标改变后重新探测*/
+    pLs->Ready &= ~(1UL << event);
+    pLs->Block &= ~(1UL << event);
+    pLs->Busy &= ~(1UL << event);
+    Os_Critical_Exit();
+    L101_Index_Build();
+    Set_L101_Dirty(pL->Digital_Addr);
 
-    return (((pB->count > 0) && (pB->buf[0] == ENTER_CODE)) ? (false) : (true));
+    return 0;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_map, L101_Set_Map, set event addr channel id);
 
 /**
- * @brief   进入shell模式
- * @details
- * @param	None
- * @retval	None
+ * @brief  从flash中加载节点映射表
+ * @details 记录头、版本及CRC校验均正确时才覆盖默认映射表
+ * @param  None
+ * @retval true 加载成功 false 无有效记录
  */
-void Shell_Mode(void)
+bool L101_Map_Load(void)
 {
-    __HAL_UART_DISABLE_IT(&huart1, UART_IT_IDLE);
-    HAL_NVIC_DisableIRQ(USART1_IRQn);
-    if (HAL_UART_DMAStop(&huart1) != HAL_OK)
+    /*直接读取flash中的记录，不拷贝*/
+    const L101_Map_Record *pRecord = (const L101_Map_Record *)FLASH_Map(ADDR_FLASH_PAGE_X(L101_MAP_PAGE), sizeof(L101_Map_Record));
+
+    if (pRecord == NULL)
     {
-        return;
+        return false;
     }
-    /*挂起Modbus任务*/
-    // osThreadSuspend(mdbusHandle);
-    /*恢复shell任务*/
-    osThreadResume(shellHandle);
-    /*停止发送定时器*/
-    osTimerStop(Timer1Handle);
+    if ((pRecord->Magic != L101_MAP_MAGIC) || (pRecord->Version != L101_MAP_VERSION) ||
+        (pRecord->Nodes == 0) || (pRecord->Nodes > L101_MAX_EVENTS) || (pRecord->Power > L101_POWER_DUTY) ||
+        (pRecord->Wtm < L101_WTM_MIN) || (pRecord->Wtm > L101_WTM_MAX) ||
+        (pRecord->Itm < L101_ITM_MIN) || (pRecord->Itm > L101_ITM_MAX) ||
+        (pRecord->Crc16 != mdCrc16((uint8_t *)pRecord, offsetof(L101_Map_Record, Crc16))))
+    {
+        return false;
+    }
+    for (uint16_t i = 0; i < pRecord->Nodes; i++)
+    {
+        L101_Map[i].Sdevice_Addr = pRecord->Node[i].Sdevice_Addr;
+        L101_Map[i].Schannel = pRecord->Node[i].Schannel;
+        L101_Map[i].Slave_Id = pRecord->Node[i].Slave_Id;
+        L101_Map[i].Digital_Addr = pRecord->Node[i].Digital_Addr;
+        L101_Map[i].Analog_Addr = pRecord->Node[i].Analog_Addr;
+    }
+    g_L101_Events = pRecord->Nodes;
+    g_Power.Mode = pRecord->Power;
+    g_Power.Wtm = pRecord->Wtm;
+    g_Power.Itm = pRecord->Itm;
+    /*上电时模块按出厂的常收模式工作，占空比网络需重新写入*/
+    g_Power.Pending = (pRecord->Power != L101_POWER_RUN);
+
+    return true;
 }
 
 /**
- * @brief   退出shell模式
- * @details
- * @param	None
- * @retval	None
+ * @brief  保存节点映射表到flash
+ * @details 记录交给flash任务在后台写入，不等待擦写完成
+ * @param  None
+ * @retval 0 已提交 0xFF 上次保存尚未完成
  */
-#if defined(USING_L101)
-uint8_t Exit_Shell(void)
+uint8_t L101_Map_Save(void)
 {
-    __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
-    HAL_NVIC_EnableIRQ(USART1_IRQn);
-    if (HAL_UART_Receive_DMA(&huart1, mdRTU_Recive_Buf(Master_Object), MODBUS_PDU_SIZE_MAX) != HAL_OK)
+    static L101_Map_Record record;
+    static Flash_Request request = {.Address = ADDR_FLASH_PAGE_X(L101_MAP_PAGE), .pData = (const uint16_t *)&record,
+                                    .Size = sizeof(record) / 2U};
+
+    if (request.State == FLASH_REQ_PENDING)
     {
         return 0xFF;
     }
-    /*恢复modbus任务*/
-    // osThreadResume(mdbusHandle);
-    /*挂起shell任务*/
-    osThreadSuspend(shellHandle);
-    /*打开发送定时器*/
-    osTimerStart(Timer1Handle, MDTASK_SENDTIMES);
-    return 0x00;
+    memset(&record, 0x00, sizeof(record));
+    record.Magic = L101_MAP_MAGIC;
+    record.Version = L101_MAP_VERSION;
+    record.Nodes = LEVENTS;
+    record.Power = g_Power.Mode;
+    record.Wtm = g_Power.Wtm;
+    record.Itm = g_Power.Itm;
+    for (uint16_t i = 0; i < L101_MAX_EVENTS; i++)
+    {
+        record.Node[i].Sdevice_Addr = L101_Map[i].Sdevice_Addr;
+        record.Node[i].Schannel = L101_Map[i].Schannel;
+        record.Node[i].Slave_Id = L101_Map[i].Slave_Id;
+        record.Node[i].Digital_Addr = L101_Map[i].Digital_Addr;
+        record.Node[i].Analog_Addr = L101_Map[i].Analog_Addr;
+    }
+    record.Crc16 = mdCrc16((uint8_t *)&record, offsetof(L101_Map_Record, Crc16));
+
+    return FLASH_Post(&request) ? 0 : 0xFF;
 }
-#if defined(USING_DEBUG)
-SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), exit_shell, Exit_Shell, exit);
-#endif
-#endif
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_save, L101_Map_Save, save l101 map);
 
 /**
- * @brief	位变量组帧
- * @details 主机设备号为0，信道为0
- * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---Data---|---CRC---|
- * @param	None
- * @retval	None
+ * @brief  运行时修改节点数
+ * @details 超出节点数的事件从调度集合中移除，并重新扫描所有节点
+ * @param  nodes 节点数
+ * @retval 0 成功 0xFF 参数错误
  */
-uint8_t Set_BitFrame(L101_HandleTypeDef *pL)
+uint8_t L101_Set_Nodes(int nodes)
 {
-    mdBit Coil_Bit;
-    mdSTATUS ret = mdFALSE;
-    Frame_Head pF = {.Addr.Val = 0x0000};
-    /*读取对应寄存器地址*/
-    // ret = g_Mdmaster->registerPool->mdReadCoil(g_Mdmaster->registerPool, pL->Digital_Addr, &Coil_Bit);
-    ret = mdRTU_ReadCoil(Master_Object, pL->Digital_Addr, Coil_Bit);
+    uint32_t mask;
 
-    mdU8 buf[] = {0, 0, pL->Schannel, pL->Slave_Id, 0x05, pL->Digital_Addr >> 8U,
-                  pL->Digital_Addr, (uint8_t)(Coil_Bit & 0x00FF),
-                  0x00, 0x00, 0x00};
-    /*读取寄存器正确*/
-    if (ret == mdTRUE)
+    if ((nodes <= 0) || (nodes > (int)L101_MAX_EVENTS))
     {
-        /*得到从站设备地址*/
-        pF.Addr.V.H = pL->Sdevice_Addr << 8U;
-        pF.Addr.V.L = pL->Sdevice_Addr;
-        /*拷贝前2个字节到临时缓冲区*/
-        memcpy(&buf[0], (mdU8 *)&pF, sizeof(pF));
-        /*计算CRC:memcpy拷贝属于大端*/
-        pL->Crc16 = Get_Crc16(&buf[sizeof(pF) + 1U], sizeof(buf) - 5U, 0xffff);
-        /*拷贝两个字节CRC到临时缓冲区*/
-        memcpy(&buf[sizeof(buf) - sizeof(pL->Crc16)], (mdU8 *)&pL->Crc16, sizeof(pL->Crc16));
-        /*数据传输到从站*/
-        // g_Mdmaster->mdRTUSendString(g_Mdmaster, buf, sizeof(buf));
-        mdRTU_SendString(Master_Object, buf, sizeof(buf));
-        /*传输完成一个从站后考虑适当的延时*/
+        return 0xFF;
     }
+    mask = (nodes >= 32) ? 0xFFFFFFFFUL : ((1UL << nodes) - 1UL);
+    Os_Critical_Enter();
+    g_L101_Events = nodes;
+    pLs->Ready &= mask;
+    pLs->Block &= mask;
+    pLs->Busy &= mask;
+    g_Dirty &= mask;
+    g_Alarm &= mask;
+    g_Analog &= mask;
+    pLs->Pos[0] = pLs->Pos[1] = LEVENTS - 1U;
+    g_Scan = 0;
+    pLs->First_Flag = false;
+    Os_Critical_Exit();
+    L101_Index_Build();
 
-    return ret;
+    return 0;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_nodes, L101_Set_Nodes, set l101 nodes);
 
 /**
- * @brief	添加列表项到列表
- * @details
- * @param	None
- * @retval	None
+ * @brief  运行时修改一个事件的寄存器地址
+ * @param  event 事件号
+ * @param  digital 线圈地址
+ * @param  analog 模拟量地址
+ * @retval 0 成功 0xFF 参数错误
  */
-void Add_ListItem(List_t *list, TickType_t data)
+uint8_t L101_Set_Io(int event, int digital, int analog)
 {
-    ListItem_t *p = NULL;
-    p = (ListItem_t *)pvPortMalloc(sizeof(ListItem_t));
-    if (p == NULL)
+    if ((event < 0) || (event >= (int)L101_MAX_EVENTS) ||
+        (digital < 0) || (digital > 0xFFFF) || (analog < 0) || (analog > 0xFFFF))
     {
-        vPortFree(p);
-        return;
+        return 0xFF;
     }
-    vListInitialiseItem(p);
-    listSET_LIST_ITEM_VALUE(p, data);
-    /*按照data大小升序排列*/
-    // vListInsert(list, p);
-    vListInsertEnd(list, p);
+    Os_Critical_Enter();
+    L101_Map[event].Digital_Addr = digital;
+    L101_Map[event].Analog_Addr = analog;
+    L101_Map[event].Analog_Valid = false;
+    L101_Map[event].Coil_Valid = false;
+    Os_Critical_Exit();
+    L101_Index_Build();
+    Set_L101_Dirty(digital);
+
+    return 0;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_io, L101_Set_Io, set event digital analog);
 
 /**
- * @brief	从列表中查找指定列表项
- * @details
- * @param	None
- * @retval	None
+ * @brief  打印节点映射表
+ * @param  None
+ * @retval None
  */
-ListItem_t *Find_ListItem(List_t *list, TickType_t data)
+void L101_Map_Show(void)
 {
-    ListItem_t *p = list->xListEnd.pxNext;
+    L101_HandleTypeDef *pL = NULL;
+
+    shellPrint(&shell, "nodes: %d/%d, power = %s%s, wtm = %d ms, itm = %d s\r\n", LEVENTS, L101_MAX_EVENTS,
+               (g_Power.Mode == L101_POWER_DUTY) ? "duty" : "run", g_Power.Pending ? "(pending)" : "",
+               g_Power.Wtm, g_Power.Itm);
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        shellPrint(&shell, "[%d] addr = 0x%04x, ch = %d, id = %d, coil = %d, reg = %d, radio = %d\r\n", i,
+                   pL->Sdevice_Addr, pL->Schannel, pL->Slave_Id, pL->Digital_Addr, pL->Analog_Addr,
+                   L101_RADIO_OF(pL));
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_show, L101_Map_Show, show l101 map);
 
-    for (; p->xItemValue != portMAX_DELAY; p = p->pxNext)
+/**
+ * @brief	查找事件的中继路由
+ * @param	pL 事件
+ * @retval	路由条目，直接可达的节点返回 NULL
+ */
+static const L101_Hop *L101_Hop_Find(const L101_HandleTypeDef *pL)
+{
+    for (uint8_t i = 0; i < L101_HOPS; i++)
     {
-        if (listGET_LIST_ITEM_VALUE(p) == data)
+        if (g_Hop[i].Hops && (g_Hop[i].Event == (uint8_t)(pL - L101_Map)))
         {
-            return p;
+            return &g_Hop[i];
         }
     }
+
     return NULL;
 }
 
 /**
- * @brief	从列表中移除列表
- * @details
- * @param	None
- * @retval	列表中剩余的列表项
+ * @brief	取得事件请求实际发往的信道
+ * @param	pL 事件
+ * @retval	下一跳节点的信道
  */
-UBaseType_t Remove_ListItem(List_t *list, TickType_t data)
+static uint8_t L101_Next_Channel(const L101_HandleTypeDef *pL)
 {
-    UBaseType_t items;
-    /*先从对应列表中查找到列表项，在移除*/
-    ListItem_t *p = Find_ListItem(list, data);
-    if (p && (p->xItemValue != portMAX_DELAY))
-    {
-        items = uxListRemove(p);
-        /*释放链表节点*/
-        vPortFree(p);
-        return items;
-    }
-    return 0;
+    const L101_Hop *pH = L101_Hop_Find(pL);
+
+    return pH ? pH->Channel : pL->Schannel;
 }
 
 /**
- * @brief	获取一个列表项
- * @details
- * @param	None
- * @retval	目标列表项
+ * @brief  设置事件的中继路由
+ * @details 超出直达范围的从站经中继从站转发，请求发往下一跳节点，应答时间按跳数放宽；
+ *          中继从站须配置对应的转发项，远端从站的应答地址及信道须设为最后一个中继节点
+ * @param  event 事件号
+ * @param  addr 下一跳节点地址
+ * @param  channel 下一跳节点信道
+ * @param  hops 到达从站的跳数(2~L101_HOPS_MAX)，0:删除路由(直接访问)
+ * @retval 0 成功 0xFF 参数错误、路由表满或保存失败
  */
-ListItem_t *Get_OneListItem(List_t *list, ListItem_t **p)
+uint8_t L101_Set_Hop(int event, int addr, int channel, int hops)
 {
-    // static ListItem_t *p = NULL;
+    L101_Hop *pH = NULL;
 
-    if (list == NULL)
+    if ((event < 0) || (event >= (int)L101_MAX_EVENTS) || (addr < 0) || (addr > 0xFFFF) || (channel < 0) ||
+        (channel > 0xFF) || (hops < 0) || (hops == 1) || (hops > (int)L101_HOPS_MAX))
     {
-        return NULL;
+        return 0xFF;
+    }
+    pH = (L101_Hop *)L101_Hop_Find(&L101_Map[event]);
+    for (uint8_t i = 0; (pH == NULL) && (i < L101_HOPS); i++)
+    {
+        pH = g_Hop[i].Hops ? NULL : &g_Hop[i];
+    }
+    if (pH == NULL)
+    {
+        return (hops == 0) ? 0 : 0xFF;
     }
-    *p = *p ? (*p) : ((ListItem_t *)&list->xListEnd);
-    *p = ((*p)->pxNext->xItemValue == portMAX_DELAY) ? ((ListItem_t *)list->xListEnd.pxNext) : ((*p)->pxNext);
+    Os_Critical_Enter();
+    pH->Event = event;
+    pH->Addr = addr;
+    pH->Channel = channel;
+    pH->Hops = hops;
+    /*路径改变后重新探测*/
+    L101_Map[event].Check.Srtt = 0;
+    pLs->Block &= ~(1UL << event);
+    Os_Critical_Exit();
+    /*双模块时所在模块随下一跳信道变化*/
+    L101_Index_Build();
 
-    return *p;
+    return Kv_Set(KV_KEY_HOP, g_Hop, sizeof(g_Hop)) ? 0 : 0xFF;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_hop, L101_Set_Hop, set event next hop addr channel hops);
 
 /**
- * @brief	查找在线设备
- * @details
- * @param	None
- * @retval	None
+ * @brief  打印中继路由表
+ * @param  None
+ * @retval None
  */
-TickType_t Get_OnlineDevice(List_t *list)
+void L101_Hop_Show(void)
 {
-    TickType_t data;
-    if (list != NULL)
+    for (uint8_t i = 0; i < L101_HOPS; i++)
     {
-        data = listGET_LIST_ITEM_VALUE(Get_OneListItem(list, &g_Item[0]));
-        if (data == portMAX_DELAY)
+        if (g_Hop[i].Hops)
         {
-            return 0;
+            shellPrint(&shell, "[%d] event = %d, next = 0x%04x, ch = %d, hops = %d, budget = %d ms\r\n", i,
+                       g_Hop[i].Event, g_Hop[i].Addr, g_Hop[i].Channel, g_Hop[i].Hops, g_Hop[i].Hops * L101_HOP_BUDGET);
         }
-        return data;
     }
-
-    return 0;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_hops, L101_Hop_Show, show l101 relay routes);
 
 /**
- * @brief	主站发送数据给从站
- * @details
- * @param	None
- * @retval	None
+ * @brief	按从站号查找节点
+ * @details	供网关在没有显式路由时取得目标节点地址及信道
+ * @param	Slave_Id 从站号
+ * @param	pAddr 目标节点地址
+ * @param	pChannel 信道
+ * @retval	true 找到
  */
-void Master_Poll(void)
+bool L101_Find_Node(uint8_t Slave_Id, uint16_t *pAddr, uint8_t *pChannel)
 {
-    L101_HandleTypeDef *pL = NULL;
-    static uint16_t event_x = 0;
-    static uint16_t sum = 0;
-    static bool option_flag = false;
-
-    /*首次上电扫描所有从机状态*/
-    event_x = (pLs->First_Flag && option_flag) ? (option_flag = false, Get_OnlineDevice(pLs->Ready)) : (event_x);
-
-#if defined(USING_DEBUG)
-    // shellPrint(&shell, "\r\nevent_x = %d\r\n", event_x);
-#endif
-    if (event_x >= LEVENTS)
-    {
-        return;
-    }
-    pL = &L101_Map[event_x];
-
-    if ((pL == NULL) || (pLs == NULL))
+    for (uint16_t i = 0; i < g_L101_Events; i++)
     {
-        return;
-    }
-#if defined(USING_DEBUG)
-    // shellPrint(&shell, "\r\np[%d],Check.State = %d\r\n", event_x, pL->Check.State);
-#endif
-    switch (pL->Check.State)
-    { /*首次发出事件或者从机响应成功*/
-    case L_None:
-    case L_OK:
-    { /*清除超时计数器*/
-        pL->Check.Counter = 0;
-        /*确保L101模块当前处于空闲状态*/
-        if (!Get_L101_Status())
+        if (L101_Map[i].Slave_Id == Slave_Id)
         {
-            return;
-        }
-        pL->func(pL);
-        // L101_Map[1].func(&L101_Map[1]);
-        /*保障首次事件不被错过*/
-        if (pL->Check.State == L_OK)
-        { /*释放操作信号*/
-            option_flag = true;
-            /*当前设备在就绪列表中不存在*/
-            if (Find_ListItem(pLs->Ready, event_x) == NULL)
-            { /*检测到回应的设备加入就绪列表*/
-                Add_ListItem(pLs->Ready, event_x);
-            }
-            if (pLs->First_Flag == false)
-            {
-                /*一个周期扫描结束*/
-                pLs->First_Flag = (++event_x >= LEVENTS) ? (event_x = 0, true) : false;
-            }
+            /*经中继访问的节点取下一跳*/
+            const L101_Hop *pH = L101_Hop_Find(&L101_Map[i]);
+            *pAddr = pH ? pH->Addr : L101_Map[i].Sdevice_Addr;
+            *pChannel = L101_Next_Channel(&L101_Map[i]);
+            return true;
         }
-        /*转换状态*/
-        pL->Check.State = L_Wait;
     }
-    break;
-    case L_Wait:
-    {
-        /*接收超时，不是接收错误导致的超时*/
-        if (++pL->Check.Counter >= pL->Check.Times)
-        {
-            pL->Check.Counter = 0;
-            pL->Check.State = L_TimeOut;
-        }
-#if defined(USING_DEBUG)
 
-#endif
+    return false;
+}
+
+/**
+ * @brief	按下标取得节点映射表中的从站
+ * @details	供固件分发逐个查询从站；同一从站可占用映射表的多行
+ * @param	Index 映射表下标
+ * @param	pSlave_Id 从站号
+ * @param	pAddr 从站节点地址
+ * @param	pChannel 从站信道
+ * @retval	true 下标有效
+ */
+bool L101_Node_At(uint16_t Index, uint8_t *pSlave_Id, uint16_t *pAddr, uint8_t *pChannel)
+{
+    if (Index >= g_L101_Events)
+    {
+        return false;
     }
-    break;
-    case L_Error:
-    case L_TimeOut:
+    *pSlave_Id = L101_Map[Index].Slave_Id;
+    *pAddr = L101_Map[Index].Sdevice_Addr;
+    *pChannel = L101_Map[Index].Schannel;
+
+    return true;
+}
+
+/**
+ * @brief	应答入网信标的从站加入就绪集合
+ * @details	在Modbus任务中调用；只处理直接可达且位于信标信道上的事件，
+ *          加入后标记变位，由调度节拍把当前线圈状态下发
+ * @param	Slave_Id 从站号
+ * @param	Channel 信标信道
+ * @retval	true 映射表中有该从站
+ */
+bool L101_Join(uint8_t Slave_Id, uint8_t Channel)
+{
+    L101_HandleTypeDef *pL;
+    bool found = false;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
     {
-        // pL->Check.State = L_OK;
-        /*当前设备不在阻塞列表中*/
-        if (Find_ListItem(pLs->Block, event_x) == NULL)
-        {
-            Add_ListItem(pLs->Block, event_x);
-        }
-        /*从就绪列表中移除:非首次扫描状态*/
-        if (pLs->First_Flag)
-        { /*当前错误设备处于离线*/
-            Remove_ListItem(pLs->Ready, event_x);
-        }
-        else
+        pL = &L101_Map[i];
+        if ((pL->Slave_Id != Slave_Id) || (pL->Schannel != Channel) || (L101_Hop_Find(pL) != NULL))
         {
-            /*一个周期扫描结束*/
-            pLs->First_Flag = (++event_x >= LEVENTS) ? (event_x = 0, true) : false;
+            continue;
         }
-        pL->Check.State = L_None;
+        Os_Critical_Enter();
+        pLs->Ready |= 1UL << i;
+        pLs->Block &= ~(1UL << i);
+        pL->Check.Errors = 0;
+        pL->Check.Backoff = 0;
+        pL->Check.Holdoff = 0;
+        /*重新入网的从站可能已复位*/
+        pL->Coil_Valid = false;
+        Os_Critical_Exit();
+        Set_L101_Dirty(pL->Digital_Addr);
+        found = true;
     }
-    break;
-    default:
-        break;
+    return found;
+}
+
+/**
+ * @brief	入网发现结束
+ * @details	未应答的事件移入阻塞集合，之后按退避重新探测
+ * @param	None
+ * @retval	None
+ */
+static void L101_Discover_End(void)
+{
+    uint32_t mask = (LEVENTS >= 32U) ? 0xFFFFFFFFUL : ((1UL << LEVENTS) - 1UL);
+
+    Os_Critical_Enter();
+    pLs->Block |= mask & ~pLs->Ready;
+    pLs->First_Flag = true;
+    g_Scan = 0;
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	获取Lora模块当前是否空闲
+ * @details	无线发送数据时拉低，用于指示发送繁忙状态
+ * @param	None
+ * @retval	ture/fale
+ */
+bool inline Get_L101_Status(void)
+{
+    return ((bool)HAL_GPIO_ReadPin(STATUS_GPIO_Port, STATUS_Pin));
+}
+
+/**
+ * @brief	Lora模块恢复出厂设置
+ * @details	拉低 3s 以上恢复出厂设置
+ * @param	None
+ * @retval	None
+ */
+void Set_L101_FactoryMode(void)
+{
+    HAL_GPIO_WritePin(RELOAD_GPIO_Port, RELOAD_Pin, GPIO_PIN_RESET);
+    Os_Delay(3500);
+    HAL_GPIO_WritePin(RELOAD_GPIO_Port, RELOAD_Pin, GPIO_PIN_SET);
+}
+
+/**
+ * @brief	确定Lora模块工作的方式
+ * @details
+ * @param	handler:modbus主机/从机句柄
+ * @retval	true:定点模式;fasle:shell
+ */
+bool Check_Mode(ModbusRTUSlaveHandler handler)
+{
+    ReceiveBufferHandle pB = handler->receiveBuffer;
+
+    /*模块主动上报的信息不是Modbus帧，先行处理*/
+    while (mdReceiveBufferFetch(pB) && !pB->crcValid && At_Urc_Process((const char *)pB->buf, pB->count))
+    {
+        mdClearReceiveBuffer(pB);
+    }
+    return ((mdReceiveBufferFetch(pB) && (pB->buf[0] == ENTER_CODE)) ? (false) : (true));
+}
+
+/**
+ * @brief   进入shell模式
+ * @details
+ * @param	None
+ * @retval	None
+ */
+void Shell_Mode(void)
+{
+    /*停止接收及发送定时器，恢复shell任务*/
+    Mode_Enter(MODE_SHELL);
+}
+
+/**
+ * @brief   退出shell模式
+ * @details
+ * @param	None
+ * @retval	None
+ */
+#if defined(USING_L101)
+uint8_t Exit_Shell(void)
+{
+    /*重新启动接收及发送定时器，挂起shell任务*/
+    return Mode_Leave() ? 0x00 : 0xFF;
+}
+#if defined(USING_DEBUG)
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), exit_shell, Exit_Shell, exit);
+#endif
+#endif
+
+/**
+ * @brief	取得每帧前的唤醒码时长
+ * @details	主站模块工作在WU模式时，每帧先发送唤醒间隔长度的唤醒码
+ * @param	None
+ * @retval	唤醒码时长(ms)，常收网络为0
+ */
+static uint32_t L101_Wake_Time(void)
+{
+    return (g_Power.Applied == L101_POWER_DUTY) ? g_Power.Wtm : 0;
+}
+
+/**
+ * @brief	速率等级的空中速率
+ * @param	Spd 速率等级，超出范围时按最低等级
+ * @retval	bps
+ */
+static uint32_t L101_Spd_Rate(uint8_t Spd)
+{
+    return g_Air_Rate[((Spd >= L101_SPD_MIN) && (Spd <= L101_SPD_MAX) ? Spd : L101_SPD_MIN) - 1U];
+}
+
+/**
+ * @brief	当前速率等级的空中速率
+ * @param	None
+ * @retval	bps
+ */
+static uint32_t L101_Air_Rate(void)
+{
+    return L101_Spd_Rate(g_Link.Spd);
+}
+
+/**
+ * @brief	估计一帧在指定速率等级下的发送时间
+ * @details	前导码及包头按 L101_AIR_OVERHEAD 字节计，开启前向纠错时数据部分按 L101_FEC_NUM/L101_FEC_DEN 放大
+ * @param	Spd 速率等级
+ * @param	Length 写入模块的字节数
+ * @retval	发送时间(ms)，不含唤醒码
+ */
+static uint32_t L101_Spd_Air_Time(uint8_t Spd, uint32_t Length)
+{
+    uint32_t rate = L101_Spd_Rate(Spd);
+    uint32_t bits = Length * 8000U;
+
+#if (L101_FEC)
+    bits = bits * L101_FEC_NUM / L101_FEC_DEN;
+#endif
+    return (bits + L101_AIR_OVERHEAD * 8000U + rate - 1U) / rate;
+}
+
+/**
+ * @brief	估计一帧的空中时间
+ * @param	Length 写入模块的字节数
+ * @retval	唤醒码时长加数据按当前速率等级的发送时间(ms)
+ */
+static uint32_t L101_Air_Time(uint32_t Length)
+{
+    return L101_Wake_Time() + L101_Spd_Air_Time(g_Link.Spd, Length);
+}
+
+/**
+ * @brief	估计一次典型事务(写线圈请求及应答)的往返时间
+ * @param	Spd 速率等级
+ * @retval	请求、应答的空中时间及两次处理时间之和(ms)，不含唤醒码
+ */
+static uint32_t L101_Exchange_Time(uint8_t Spd)
+{
+    return L101_Spd_Air_Time(Spd, L101_REQUEST_BYTES) + L101_Spd_Air_Time(Spd, L101_REPLY_BYTES) +
+           2U * L101_TURNAROUND;
+}
+
+/**
+ * @brief	应答等待窗口下限
+ * @details	窗口不短于当前速率等级下一次典型事务的往返时间，低速率等级下RTT样本不足时也不会提前判超时
+ * @param	None
+ * @retval	等待窗口(单位:MDTASK_SENDTIMES)
+ */
+static uint32_t L101_Rto_Floor(void)
+{
+    uint32_t times = (L101_Exchange_Time(g_Link.Spd) + MDTASK_SENDTIMES - 1U) / MDTASK_SENDTIMES;
+
+    return (times > L101_RTO_MIN_TIMES) ? times : L101_RTO_MIN_TIMES;
+}
+
+/**
+ * @brief	应答等待窗口上限
+ * @details	至少为下限的4倍，最低速率等级下超时加倍仍有余量
+ * @param	None
+ * @retval	等待窗口(单位:MDTASK_SENDTIMES)
+ */
+static uint32_t L101_Rto_Ceil(void)
+{
+    uint32_t times = 4U * L101_Rto_Floor();
+
+    return (times > L101_RTO_MAX_TIMES) ? times : L101_RTO_MAX_TIMES;
+}
+
+/**
+ * @brief	在线从站的心跳间隔
+ * @details	一次心跳事务占用信道的时间不超过心跳间隔的 L101_HEARTBEAT_LOAD%，高速率等级下为 L101_HEARTBEAT_TIMES
+ * @param	None
+ * @retval	心跳间隔(单位:MDTASK_SENDTIMES)
+ */
+static uint32_t L101_Heartbeat_Times(void)
+{
+    uint32_t busy = L101_Exchange_Time(g_Link.Spd) + L101_Wake_Time();
+    uint32_t times = (busy * 100U + L101_HEARTBEAT_LOAD * MDTASK_SENDTIMES - 1U) / (L101_HEARTBEAT_LOAD * MDTASK_SENDTIMES);
+
+    return (times > L101_HEARTBEAT_TIMES) ? times : L101_HEARTBEAT_TIMES;
+}
+
+/**
+ * @brief	连续发送窗口
+ * @details	窗口内的帧不等应答连续写入模块，最后一帧的应答确认整个窗口:窗口的空中时间覆盖一次往返
+ *			(有样本时取从站的平滑往返时间，否则按空中时间模型)使信道不空闲，且不少于模块缓冲区容得下的帧数；
+ *			经中继访问的从站为1(中继会截获不带站号的帧)
+ * @param	Slave_Id 从站号
+ * @param	Length 每帧写入模块的字节数
+ * @param	Max 窗口上限
+ * @retval	帧数(1..Max)
+ */
+uint8_t L101_Burst_Window(uint8_t Slave_Id, uint32_t Length, uint8_t Max)
+{
+    uint32_t rtt = L101_Exchange_Time(g_Link.Spd) + L101_Wake_Time();
+    uint32_t frame = L101_Air_Time(Length), window;
+
+    for (uint16_t i = 0; i < g_L101_Events; i++)
+    {
+        if (L101_Map[i].Slave_Id != Slave_Id)
+        {
+            continue;
+        }
+        if (L101_Hop_Find(&L101_Map[i]) != NULL)
+        {
+            return 1U;
+        }
+        rtt = L101_Map[i].Check.Srtt ? (L101_Map[i].Check.Srtt >> 3U) : rtt;
+        break;
+    }
+    window = 1U + (rtt + frame - 1U) / frame;
+    window = (window > L101_TX_BUFFER / Length) ? window : (L101_TX_BUFFER / Length);
+
+    return (uint8_t)((window < Max) ? window : Max);
+}
+
+/**
+ * @brief	一帧已写入模块
+ * @details	串口发送完成中断中调用，模块缓冲区中的数据接在上一帧之后发送
+ * @param	handler 共用的从机协议栈句柄
+ * @retval	None
+ */
+static mdVOID L101_Tx_Done(ModbusRTUSlaveHandler handler)
+{
+    uint32_t now = HAL_GetTick();
+    uint32_t start = ((int32_t)(g_Admit.Drain - now) > 0) ? g_Admit.Drain : now;
+
+    g_Admit.Early += Get_L101_Status() ? 0U : 1U;
+    g_Admit.Drain = start + L101_Air_Time(handler->txLastLength);
+#if defined(USING_AIRTIME)
+    g_Air.Fresh += L101_Air_Time(handler->txLastLength);
+#endif
+}
+
+/**
+ * @brief	STATUS引脚上升沿(模块变为空闲)
+ * @details	外部中断中调用:模块缓冲区已空，校正准入模型并唤醒无线调度任务立即发出排队的请求，
+ *			不必等到下一个调度节拍
+ * @param	GPIO_Pin 触发中断的引脚
+ * @retval	None
+ */
+void L101_Status_Edge(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin != STATUS_Pin)
+    {
+        return;
+    }
+    g_Admit.Edges++;
+    g_Admit.Drain = HAL_GetTick();
+    if (radioHandle)
+    {
+        Os_Signal_Set(radioHandle, L101_SIGNAL_FREE);
+    }
+}
+
+/**
+ * @brief	发送准入
+ * @details	模块空闲时可以写入；模块忙时按模型估计缓冲区中剩余的空中时间，
+ *			不超过 L101_ADMIT_AHEAD 且缓冲区容得下一整帧时提前写入；模型已发完而引脚仍忙时以引脚为准
+ * @param	None
+ * @retval	true 可以写入下一帧
+ */
+static bool L101_Admit_Check(void)
+{
+    int32_t left = (int32_t)(g_Admit.Drain - HAL_GetTick());
+
+    if (Get_L101_Status())
+    {
+        return true;
+    }
+    return (left > 0) && ((uint32_t)left <= L101_ADMIT_AHEAD) &&
+           ((uint32_t)left * L101_Air_Rate() / 8000U + MODBUS_TX_BUFFER_SIZE <= L101_TX_BUFFER);
+}
+
+#if defined(USING_AIRTIME)
+/**
+ * @brief	滑动占空比窗口
+ * @details	计入发送完成中断累计的空中时间，按经过的时间推进时段，滑出窗口的时段从已用时间中扣除
+ * @param	None
+ * @retval	None
+ */
+static void L101_Air_Roll(void)
+{
+    uint32_t now = L101_GET_MS(), fresh;
+
+    Os_Critical_Enter();
+    fresh = g_Air.Fresh;
+    g_Air.Fresh = 0;
+    Os_Critical_Exit();
+    for (uint8_t i = 0; ((uint32_t)(now - g_Air.Start) >= L101_AIR_SLOT) && (i < L101_AIR_BUCKETS); i++)
+    {
+        g_Air.Head = (g_Air.Head + 1U < L101_AIR_BUCKETS) ? g_Air.Head + 1U : 0;
+        g_Air.Used -= g_Air.Bucket[g_Air.Head];
+        g_Air.Bucket[g_Air.Head] = 0;
+        g_Air.Start += L101_AIR_SLOT;
+    }
+    /*停顿超过整个窗口时各时段均已清空*/
+    if ((uint32_t)(now - g_Air.Start) >= L101_AIR_SLOT)
+    {
+        g_Air.Start = now;
+    }
+    g_Air.Bucket[g_Air.Head] += fresh;
+    g_Air.Used += fresh;
+    g_Air.Total += fresh;
+}
+
+/**
+ * @brief	窗口内的空中时间预算
+ * @param	None
+ * @retval	ms
+ */
+static uint32_t L101_Air_Budget(void)
+{
+    return L101_AIR_WINDOW * g_Air.Duty;
+}
+
+/**
+ * @brief	窗口内剩余的空中时间
+ * @param	None
+ * @retval	ms
+ */
+static uint32_t L101_Air_Left(void)
+{
+    L101_Air_Roll();
+    return (g_Air.Used < L101_Air_Budget()) ? (L101_Air_Budget() - g_Air.Used) : 0;
+}
+
+/**
+ * @brief	占空比预算是否允许主模块发出一类请求
+ * @details	剩余不足一次典型请求(含唤醒码)时都不允许；低于预算的 L101_AIR_RESERVE% 时只允许报警及控制类
+ * @param	Class 业务类别(MASTER_CLASS_*)
+ * @retval	true 允许
+ */
+static bool L101_Air_Allow(uint8_t Class)
+{
+    uint32_t left = L101_Air_Left();
+
+    if (left < L101_Air_Time(L101_REQUEST_BYTES))
+    {
+        g_Air.Blocked++;
+        return false;
+    }
+    if ((Class < MASTER_CLASS_CONTROL) && (left * 100U < L101_Air_Budget() * L101_AIR_RESERVE))
+    {
+        g_Air.Shed++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief	设置占空比
+ * @param	duty 占空比(0.1%)，1000为不限制
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t L101_Set_Duty(int duty)
+{
+    if ((duty <= 0) || (duty > (int)L101_AIR_DUTY_MAX))
+    {
+        return 0xFF;
+    }
+    g_Air.Duty = (uint16_t)duty;
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_duty, L101_Set_Duty, set airtime duty cycle permille);
+#endif
+
+/**
+ * @brief	L101模块是否可以发送
+ * @details	作为主站请求引擎的传输层就绪检查；开启时隙接入时还须处于本主站的时隙，
+ *			开启占空比预算时预算耗尽后不再发送(任何类别)
+ * @param	handler 主站请求引擎句柄
+ * @retval	mdTRUE 可以写入 mdFALSE 忙
+ */
+static mdBOOL L101_Ready(ModbusRTUMasterHandler handler)
+{
+    bool ready = L101_Admit_Check();
+
+#if defined(USING_TDMA)
+    ready = ready && Tdma_Open();
+#endif
+#if defined(USING_AIRTIME)
+    ready = ready && (L101_Air_Left() >= L101_Air_Time(L101_REQUEST_BYTES));
+#endif
+    return ready ? mdTRUE : mdFALSE;
+}
+
+static bool Is_SameDestination(L101_HandleTypeDef *pA, L101_HandleTypeDef *pB);
+
+/**
+ * @brief	记录从站附带的健康信息
+ * @details	运行时间倒退说明从站已复位，其保持寄存器已丢失，模拟量需整值重发，线圈确认值作废
+ * @param	pL 目标从站首个事件
+ * @param	pHealth 应答中的健康信息
+ * @retval	None
+ */
+static void L101_Health_Update(L101_HandleTypeDef *pL, const struct ModbusRTUHealth *pHealth)
+{
+    if (!pHealth->valid)
+    {
+        return;
+    }
+    if (pL->Health.Valid && (pHealth->uptime < pL->Health.Uptime))
+    {
+        pL->Health.Reboots++;
+        /*合并帧中同一从站的各事件共用该从站的寄存器*/
+        for (uint16_t i = 0; i < LEVENTS; i++)
+        {
+            if (Is_SameDestination(pL, &L101_Map[i]))
+            {
+                L101_Map[i].Analog_Valid = false;
+                L101_Map[i].Coil_Valid = false;
+            }
+        }
+    }
+    pL->Health.Valid = true;
+    pL->Health.Rssi = pHealth->rssi;
+    pL->Health.Errors = pHealth->errors;
+    pL->Health.Uptime = pHealth->uptime;
+}
+
+/**
+ * @brief	记录一次延迟测试结果
+ * @details	应答已由请求引擎按回显的序号及时刻校验，往返时间以帧内时刻计算
+ * @param	pL 目标从站首个事件
+ * @param	request 完成的测试请求
+ * @param	result 请求结果
+ * @retval	None
+ */
+static void L101_Test_Record(L101_HandleTypeDef *pL, const struct ModbusRTURequest *request, mdU8 result)
+{
+    L101_Latency *pT = &g_Latency[pL - L101_Map];
+    uint32_t rtt, bin;
+
+    if (result != MASTER_RESULT_OK)
+    {
+        pT->Lost++;
+        return;
+    }
+    rtt = L101_GET_MS() - (((uint32_t)request->data[2] << 24U) | ((uint32_t)request->data[3] << 16U) |
+                           ((uint32_t)request->data[4] << 8U) | request->data[5]);
+    rtt = (rtt > L101_Wake_Time()) ? rtt - L101_Wake_Time() : 0;
+    for (bin = 0; (bin < L101_TEST_BINS - 1U) && (rtt > g_Test_Bins[bin]); bin++)
+    {
+    }
+    pT->Min = (pT->Rx && (pT->Min <= rtt)) ? pT->Min : rtt;
+    pT->Max = (pT->Max >= rtt) ? pT->Max : rtt;
+    pT->Sum += rtt;
+    pT->Hist[bin] += (pT->Hist[bin] < 0xFFFFU) ? 1U : 0U;
+    pT->Rx++;
+}
+
+/**
+ * @brief	L101请求完成回调
+ * @details	由Modbus接收任务(应答)或Master_Poll(超时)调用，记录应答结果及往返时间；
+ *          事务已被撤销(如修改了映射表)时忽略
+ * @param	request 完成的请求
+ * @param	result 请求结果
+ * @retval	None
+ */
+static void L101_Request_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    L101_HandleTypeDef *pL = (L101_HandleTypeDef *)request->arg;
+
+    if (!(pLs->Busy & (1UL << (pL - L101_Map))))
+    {
+        return;
+    }
+    if (request->code == MODBUS_CODE_ECHO)
+    {
+        L101_Test_Record(pL, request, result);
+    }
+    switch (result)
+    {
+    case MASTER_RESULT_OK:
+        /*唤醒码时长固定，不计入往返时间估计*/
+        pL->Check.Rtt = L101_GET_MS() - pL->Check.Start;
+        pL->Check.Rtt = (pL->Check.Rtt > L101_Wake_Time()) ? pL->Check.Rtt - L101_Wake_Time() : 0;
+        TRACE_VALUE(TRACE_RTT, pL->Slave_Id, pL->Check.Rtt);
+        pL->Check.State = L_OK;
+        L101_Health_Update(pL, &request->health);
+        pL->Fec.Fixed += request->fecCorrected;
+        pL->Fec.Total += request->fecCorrected;
+        break;
+    case MASTER_RESULT_TIMEOUT:
+        pL->Check.State = L_TimeOut;
+        break;
+    default:
+        pL->Check.State = L_Error;
+        break;
+    }
+}
+
+/**
+ * @brief	初始化发往目标从站的请求
+ * @details	请求前加上目标节点地址和信道，应答等待窗口由往返时间估计
+ * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---PDU---|---CRC---|
+ * @param	pL 目标从站首个事件
+ * @param	request 请求
+ * @param	code 功能码
+ * @retval	None
+ */
+static void L101_Request_Init(L101_HandleTypeDef *pL, struct ModbusRTURequest *request, mdU8 code)
+{
+    const L101_Hop *pH = L101_Hop_Find(pL);
+    uint32_t hops = pH ? pH->Hops : 1U, timeout = pL->Check.Times * MDTASK_SENDTIMES;
+
+    memset(request, 0, sizeof(*request));
+    /*经中继访问的从站:帧发往下一跳节点，每一跳至少预留 L101_HOP_BUDGET，中继等待下游应答期间不会重发*/
+    request->prefix[0] = (pH ? pH->Addr : pL->Sdevice_Addr) >> 8U;
+    request->prefix[1] = pH ? pH->Addr : pL->Sdevice_Addr;
+    request->prefix[2] = L101_Next_Channel(pL);
+    request->prefixLength = sizeof(Frame_Head) + 1U;
+    request->port = L101_RADIO_OF(pL);
+    request->slaveId = pL->Slave_Id;
+    request->code = code;
+    timeout = ((hops > 1U) && (timeout < hops * L101_HOP_BUDGET)) ? hops * L101_HOP_BUDGET : timeout;
+    request->timeout = timeout + hops * L101_Wake_Time();
+    request->priority = pL->Check.Priority;
+    request->callback = L101_Request_Done;
+    request->arg = pL;
+    /*写线圈应答中附带的从站输入*/
+    request->reportLocal = L101_REMOTE_INPUT_START_ADDR + (pL - L101_Map) * L101_REMOTE_INPUTS;
+    request->reportNumber = L101_REMOTE_INPUTS;
+    request->analogLocal = L101_REMOTE_ANALOG_START_ADDR + (pL - L101_Map) * L101_REMOTE_ANALOGS;
+    request->analogNumber = L101_REMOTE_ANALOGS;
+}
+
+/**
+ * @brief	延迟测试组帧
+ * @details	帧内为序号及发出时刻，从站原样回显，请求引擎校验回显内容
+ * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---功能码---|---序号（2B）---|---时刻（4B）---|---CRC---|
+ * @param	pL 目标从站首个事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 请求队列满
+ */
+static uint8_t Set_EchoFrame(L101_HandleTypeDef *pL)
+{
+    struct ModbusRTURequest request;
+    uint32_t now = L101_GET_MS();
+
+    L101_Request_Init(pL, &request, MODBUS_CODE_ECHO);
+    g_Test.Seq++;
+    g_Test.Last = now;
+    request.data[0] = g_Test.Seq >> 8U;
+    request.data[1] = g_Test.Seq;
+    request.data[2] = now >> 24U;
+    request.data[3] = now >> 16U;
+    request.data[4] = now >> 8U;
+    request.data[5] = now;
+    request.dataLength = MODBUS_ECHO_SIZE;
+    request.echoLength = MODBUS_ECHO_SIZE;
+    if (mdRTU_Submit(Client_Object, &request) == mdFALSE)
+    {
+        return mdFALSE;
+    }
+    g_Latency[pL - L101_Map].Tx++;
+
+    return mdTRUE;
+}
+
+#if defined(USING_TIMESYNC)
+/**
+ * @brief	时间同步组帧
+ * @details	帧内为提交时刻及单程时延估计:唤醒码时长加平滑往返时间的一半(经中继时为整条路径)，
+ *			从站以收到时刻对齐主站时间并原样回显
+ * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---功能码---|---主站时刻（4B）---|---时延（2B）---|---CRC---|
+ * @param	pL 目标从站首个事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 请求队列满
+ */
+static uint8_t Set_TimeFrame(L101_HandleTypeDef *pL)
+{
+    struct ModbusRTURequest request;
+    uint32_t now = L101_GET_MS();
+    uint32_t delay = L101_Wake_Time() + (pL->Check.Srtt ? pL->Check.Srtt / 16U : pL->Check.Rtt / 2U);
+
+    L101_Request_Init(pL, &request, MODBUS_CODE_TIME);
+    delay = (delay > 0xFFFFU) ? 0xFFFFU : delay;
+    request.data[0] = now >> 24U;
+    request.data[1] = now >> 16U;
+    request.data[2] = now >> 8U;
+    request.data[3] = now;
+    request.data[4] = delay >> 8U;
+    request.data[5] = delay;
+    request.dataLength = MODBUS_TIME_SIZE;
+    request.echoLength = MODBUS_TIME_SIZE;
+    if (mdRTU_Submit(Client_Object, &request) == mdFALSE)
+    {
+        return mdFALSE;
+    }
+    g_Sync.Last = now;
+    g_Sync.Tx++;
+
+    return mdTRUE;
+}
+#endif
+
+#if !defined(USING_BATCH_FRAME)
+/**
+ * @brief	位变量组帧(FC05)
+ * @details 主机设备号为0，信道为0
+ * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---Data---|---CRC---|
+ * @param	pL 目标事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 请求队列满
+ */
+uint8_t Set_BitFrame(L101_HandleTypeDef *pL)
+{
+    struct ModbusRTURequest request;
+
+    L101_Request_Init(pL, &request, MODBUS_CODE_5);
+    request.address = request.local = pL->Digital_Addr;
+    TRACE(TRACE_DI_FRAME);
+
+    return mdRTU_Submit(Client_Object, &request);
+}
+#endif
+
+/**
+ * @brief	判断两个事件是否属于同一目标从站
+ * @details	相同设备地址、信道和从站号的事件可合并到一帧中发送
+ * @param	pA 事件A
+ * @param	pB 事件B
+ * @retval	true 同一从站 false 不同从站
+ */
+static bool Is_SameDestination(L101_HandleTypeDef *pA, L101_HandleTypeDef *pB)
+{
+    return ((pA->Sdevice_Addr == pB->Sdevice_Addr) &&
+            (pA->Schannel == pB->Schannel) &&
+            (pA->Slave_Id == pB->Slave_Id));
+}
+
+/**
+ * @brief	取得目标从站的首个事件号
+ * @details	合并帧只由首个事件负责收发及应答状态，从站应答也只匹配到首个事件
+ * @param	event 事件号
+ * @retval	首个事件号
+ */
+static uint16_t Get_GroupLeader(uint16_t event)
+{
+    return (event < EXTERN_DIGITAL_MAX) ? g_Index.Leader[event] : event;
+}
+
+/**
+ * @brief	重建调度索引
+ * @details	在初始化及节点映射、节点数、寄存器地址或中继路由改变后调用，O(n^2)比较只在此进行；
+ *			新索引先在栈上建好再整体替换，中断中按地址查找时不会看到一半的索引
+ * @param	None
+ * @retval	None
+ */
+static void L101_Index_Build(void)
+{
+    L101_Index index;
+
+    memset(&index, 0, sizeof(index));
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        index.Leader[i] = (uint8_t)i;
+#if defined(USING_BATCH_FRAME)
+        for (uint16_t j = 0; j < i; j++)
+        {
+            if (Is_SameDestination(&L101_Map[j], &L101_Map[i]))
+            {
+                index.Leader[i] = (uint8_t)j;
+                break;
+            }
+        }
+#endif
+        index.Leaders |= (index.Leader[i] == i) ? (1UL << i) : 0;
+        for (uint16_t j = i; j < LEVENTS; j++)
+        {
+            index.Group[i] |= Is_SameDestination(&L101_Map[j], &L101_Map[i]) ? (1UL << j) : 0;
+        }
+        index.Radio[L101_RADIO_OF(&L101_Map[i])] |= 1UL << i;
+        index.Digital[i] = L101_Map[i].Digital_Addr;
+        index.Analog[i] = L101_Map[i].Analog_Addr;
+    }
+    Os_Critical_Enter();
+    g_Index = index;
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	L101组播帧封装并发送
+ * @details	在PDU前加上目标节点地址和信道，在末尾加上CRC；组播帧无应答，不经过主站请求队列
+ * @note    |---目标节点地址（2B）---|---信道（1B）---|---从机地址---|---PDU---|---CRC---|
+ * @param	pL 目标节点
+ * @param	buf 发送缓冲区，PDU从buf[sizeof(Frame_Head) + 2U]处开始
+ * @param	len PDU长度(不含从机地址)
+ * @retval	None
+ */
+static void L101_SendFrame(L101_HandleTypeDef *pL, mdU8 *buf, uint16_t len)
+{
+    Frame_Head pF = {.Addr.Val = 0x0000};
+    uint16_t crc;
+    /*从机地址开始的报文长度*/
+    uint16_t adu_len = len + 1U;
+    mdU8 *padu = &buf[sizeof(pF) + 1U];
+
+    /*得到从站设备地址*/
+    pF.Addr.V.H = pL->Sdevice_Addr >> 8U;
+    pF.Addr.V.L = pL->Sdevice_Addr;
+    memcpy(&buf[0], (mdU8 *)&pF, sizeof(pF));
+    buf[sizeof(pF)] = pL->Schannel;
+    padu[0] = pL->Slave_Id;
+    crc = mdCrc16(padu, adu_len);
+    memcpy(&padu[adu_len], (mdU8 *)&crc, sizeof(crc));
+    mdRTU_SendString(Master_Object, buf, sizeof(pF) + 1U + adu_len + sizeof(crc));
+}
+
+#if defined(USING_BATCH_FRAME)
+/**
+ * @brief	多线圈组帧(FC15)
+ * @details 将同一目标从站的所有线圈合并到一帧中发送
+ * @param	pL 目标从站首个事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 参数错误或请求队列满
+ */
+static uint8_t Set_CoilsFrame(L101_HandleTypeDef *pL)
+{
+    struct ModbusRTURequest request;
+    uint16_t start = 0xFFFF, end = 0, i;
+
+    /*计算该从站线圈地址范围*/
+    for (i = 0; i < LEVENTS; i++)
+    {
+        if (Is_SameDestination(&L101_Map[i], pL))
+        {
+            start = L101_Map[i].Digital_Addr < start ? L101_Map[i].Digital_Addr : start;
+            end = L101_Map[i].Digital_Addr > end ? L101_Map[i].Digital_Addr : end;
+        }
+    }
+    /*线圈数据在发出时才从本地寄存器池读取*/
+    L101_Request_Init(pL, &request, MODBUS_CODE_15);
+    request.address = request.local = start;
+    request.number = end - start + 1U;
+    TRACE(TRACE_DI_FRAME);
+
+    return mdRTU_Submit(Client_Object, &request);
+}
+#endif
+
+/**
+ * @brief	多保持寄存器组帧(FC16)
+ * @details 将同一目标从站的所有模拟量寄存器合并到一帧中发送，
+ *          可作为模拟量通道的事件回调函数
+ * @param	pL 目标从站首个事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 参数错误或请求队列满
+ */
+uint8_t Set_RegsFrame(L101_HandleTypeDef *pL)
+{
+    struct ModbusRTURequest request;
+    uint16_t start = 0xFFFF, end = 0, i;
+
+    for (i = 0; i < LEVENTS; i++)
+    {
+        if (Is_SameDestination(&L101_Map[i], pL))
+        {
+            start = L101_Map[i].Analog_Addr < start ? L101_Map[i].Analog_Addr : start;
+            end = L101_Map[i].Analog_Addr > end ? L101_Map[i].Analog_Addr : end;
+        }
+    }
+    L101_Request_Init(pL, &request, MODBUS_CODE_16);
+    request.address = request.local = start;
+    request.number = end - start + 1U;
+
+    return mdRTU_Submit(Client_Object, &request);
+}
+
+/**
+ * @brief	判断事件的模拟量是否需要发送
+ * @details	死区及发送间隔已由模拟量采集判断，这里只取出被标记事件的当前码值
+ * @param	pL 目标事件
+ * @param	pending 本帧待发送的事件集合
+ * @param	value 当前模拟量(12bit码值)
+ * @retval	true 需要发送 false 无需发送
+ */
+static bool Is_AnalogChanged(L101_HandleTypeDef *pL, uint32_t pending, mdU16 *value)
+{
+    mdU16 data;
+
+    if (mdRTU_ReadHoldReg(Master_Object, ANALOG_RAW_START_ADDR + pL->Analog_Addr, data) == mdFALSE)
+    {
+        return false;
+    }
+    *value = data & 0x0FFF;
+
+    return (!pL->Analog_Valid || (pending & (1UL << (pL - L101_Map))));
+}
+
+/**
+ * @brief	紧凑模拟量组帧
+ * @details 同一目标从站中被标记的模拟量合并为一帧；上次确认值有效且差值在int8范围内时
+ *          只发送1字节增量，否则发送2字节12bit码值。应答失败后下次全部发送完整码值
+ * @note    |---功能码---|---起始地址---|---存在位图---|---完整值位图---|---Data---|
+ *          第k位对应模拟量地址(起始地址 + k)
+ * @param	pL 目标从站首个事件
+ * @param	pending 被标记的事件集合
+ * @retval	mdTRUE 请求已提交 mdFALSE 无变化的模拟量或请求队列满
+ */
+static uint8_t Set_AnalogFrame(L101_HandleTypeDef *pL, uint32_t pending)
+{
+    struct ModbusRTURequest request;
+    /*功能码之后的PDU数据*/
+    mdU8 *pdu = request.data;
+    uint16_t base = 0xFFFF, len = 3U, i, k;
+    mdU16 value;
+    int32_t delta;
+    L101_HandleTypeDef *pE = NULL;
+
+    for (i = 0; i < LEVENTS; i++)
+    {
+        if (Is_SameDestination(&L101_Map[i], pL))
+        {
+            base = L101_Map[i].Analog_Addr < base ? L101_Map[i].Analog_Addr : base;
+        }
+    }
+    if (base > 0xFF)
+    {
+        return mdFALSE;
+    }
+    L101_Request_Init(pL, &request, MODBUS_CODE_ANALOG);
+    pdu[0] = base;
+    for (k = 0; k < 8U; k++)
+    {
+        /*同一地址只编码一次*/
+        for (i = 0, pE = NULL; i < LEVENTS; i++)
+        {
+            if (Is_SameDestination(&L101_Map[i], pL) && (L101_Map[i].Analog_Addr == base + k))
+            {
+                pE = &L101_Map[i];
+                break;
+            }
+        }
+        if ((pE == NULL) || !Is_AnalogChanged(pE, pending, &value))
+        {
+            continue;
+        }
+        delta = (int32_t)value - (int32_t)pE->Analog_Ack;
+        pdu[1] |= 1U << k;
+        if (pE->Analog_Valid && (delta >= -128) && (delta <= 127))
+        {
+            pdu[len++] = (int8_t)delta;
+        }
+        else
+        {
+            pdu[2] |= 1U << k;
+            pdu[len++] = value >> 8U;
+            pdu[len++] = value;
+        }
+        for (; i < LEVENTS; i++)
+        {
+            if (Is_SameDestination(&L101_Map[i], pL) && (L101_Map[i].Analog_Addr == base + k))
+            {
+                L101_Map[i].Analog_Sent = value;
+                L101_Map[i].Analog_Pending = true;
+            }
+        }
+    }
+    if (pdu[1] == 0)
+    {
+        return mdFALSE;
+    }
+    /*应答:从机地址+功能码+起始地址+存在位图*/
+    request.dataLength = len;
+    request.echoLength = 2U;
+
+    return mdRTU_Submit(Client_Object, &request);
+}
+
+/**
+ * @brief	确认或作废已发出的模拟量
+ * @param	leader 目标从站首个事件号
+ * @param	ok 从站是否正确应答
+ * @retval	None
+ */
+static void L101_Analog_Commit(uint16_t leader, bool ok)
+{
+    L101_HandleTypeDef *pL = NULL;
+
+    for (uint16_t i = leader; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        if (!pL->Analog_Pending || !Is_SameDestination(pL, &L101_Map[leader]))
+        {
+            continue;
+        }
+        pL->Analog_Pending = false;
+        /*应答丢失时从站可能已更新，下次发送完整码值*/
+        pL->Analog_Ack = pL->Analog_Sent;
+        pL->Analog_Valid = ok;
+        if (!ok)
+        { /*发送失败的模拟量不等下一次越出死区，重新标记*/
+            Os_Critical_Enter();
+            g_Analog |= 1UL << i;
+            Os_Critical_Exit();
+        }
+    }
+}
+
+/**
+ * @brief	组播写从站线圈
+ * @details	以广播地址向各信道发送一帧FC15，第n位为从站号n的线圈值，
+ *          从站不应答，状态由后续心跳帧确认
+ * @param	coil_addr 从站上的线圈地址
+ * @param	bitmap 各从站线圈值位图
+ * @param	bits 位图有效位数
+ * @retval	mdTRUE 发送成功 mdFALSE 参数错误、L101模块忙或已开启帧认证
+ */
+uint8_t L101_Group_Write(uint16_t coil_addr, uint8_t *bitmap, uint16_t bits)
+{
+    mdU8 buf[PF_TX_SIZE];
+    mdU8 *pdu = &buf[sizeof(Frame_Head) + 2U];
+    uint16_t bytes = (bits + 7U) / 8U, i, j, wait;
+    L101_HandleTypeDef group = {.Sdevice_Addr = L101_BROADCAST_ADDR, .Slave_Id = MODBUS_BROADCAST_ID};
+
+    if ((bitmap == NULL) || (bits == 0) || (6U + bytes + 2U > sizeof(buf) - (sizeof(Frame_Head) + 2U)))
+    {
+        return mdFALSE;
+    }
+#if (MODBUS_AUTH)
+    /*广播帧无法按从站重新同步序号，开启帧认证时从站不处理组播帧*/
+    if ((Client_Object != NULL) && (Client_Object->auth != NULL))
+    {
+        return mdFALSE;
+    }
+#endif
+    for (i = 0; i < LEVENTS; i++)
+    { /*同一信道只发送一次*/
+        for (j = 0; (j < i) && (L101_Map[j].Schannel != L101_Map[i].Schannel); j++)
+        {
+        }
+        if (j < i)
+        {
+            continue;
+        }
+        /*等待L101模块空闲*/
+        for (wait = 0; !Get_L101_Status(); wait++)
+        {
+            if (wait >= L101_GROUP_WAIT)
+            {
+                return mdFALSE;
+            }
+            Os_Delay(1);
+        }
+        pdu[0] = 0x0F;
+        pdu[1] = coil_addr >> 8U;
+        pdu[2] = coil_addr;
+        pdu[3] = bits >> 8U;
+        pdu[4] = bits;
+        pdu[5] = bytes;
+        memcpy(&pdu[6], bitmap, bytes);
+        group.Schannel = L101_Map[i].Schannel;
+        L101_SendFrame(&group, buf, 6U + bytes);
+    }
+
+    return mdTRUE;
+}
+
+/**
+ * @brief	组播设置所有从站线圈
+ * @details	用于急停等需要同时动作的场景
+ * @param	coil_addr 从站上的线圈地址
+ * @param	bit 线圈值
+ * @retval	0 成功 0xFF 失败
+ */
+uint8_t L101_Group_All(int coil_addr, int bit)
+{
+    uint8_t bitmap[32U] = {0};
+    uint16_t bits = 0;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        if (bit)
+        {
+            bitmap[L101_Map[i].Slave_Id / 8U] |= 1U << (L101_Map[i].Slave_Id % 8U);
+        }
+        bits = (L101_Map[i].Slave_Id + 1U) > bits ? (L101_Map[i].Slave_Id + 1U) : bits;
+    }
+
+    return L101_Group_Write(coil_addr, bitmap, bits) == mdTRUE ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), group_all, L101_Group_All, group write coil_addr bit);
+
+/**
+ * @brief	从集合中取出游标之后的下一个成员
+ * @details	先屏蔽游标及之前的位，无成员时从头开始，利用CLZ指令定位
+ * @param	set 事件集合
+ * @param	pos 上次取出的事件号
+ * @retval	事件号，集合为空时返回LEVENTS
+ */
+static uint16_t Get_NextMember(uint32_t set, uint16_t pos)
+{
+    uint32_t mask;
+
+    if (set == 0)
+    {
+        return LEVENTS;
+    }
+    mask = (pos >= 31U) ? 0 : (set & ~((2UL << pos) - 1UL));
+    mask = mask ? mask : set;
+    /*取最低位的成员*/
+    mask &= (~mask + 1UL);
+
+    return (uint16_t)(31U - __CLZ(mask));
+}
+
+/**
+ * @brief	标记从站有待发送的变位事件
+ * @details	由数字量采集任务调用，同一寄存器可能映射到多个从站
+ * @param	addr 发生变化的线圈地址
+ * @retval	None
+ */
+void Set_L101_Dirty(uint16_t addr)
+{
+    uint32_t mask = 0;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        if (g_Index.Digital[i] == addr)
+        {
+            mask |= 1UL << i;
+        }
+    }
+    if (mask)
+    {
+        Os_Critical_Enter();
+        g_Dirty |= mask;
+        Os_Critical_Exit();
+    }
+}
+
+/**
+ * @brief	标记从站有待发送的模拟量报警事件
+ * @details	由模拟量报警(ADC中断)调用，报警事件优先于变位事件发送
+ * @param	addr 越限的模拟量地址
+ * @retval	None
+ */
+void Set_L101_Alarm(uint16_t addr)
+{
+    uint32_t mask = 0, primask;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        if (g_Index.Analog[i] == addr)
+        {
+            mask |= 1UL << i;
+        }
+    }
+    if (mask)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        g_Alarm |= mask;
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * @brief	标记从站有待发送的模拟量
+ * @details	由模拟量采集(ADC中断)在越出死区或到达最长发送间隔时调用
+ * @param	addr 模拟量地址
+ * @retval	None
+ */
+void Set_L101_Analog(uint16_t addr)
+{
+    uint32_t mask = 0, primask;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        if (g_Index.Analog[i] == addr)
+        {
+            mask |= 1UL << i;
+        }
+    }
+    if (mask)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        g_Analog |= mask;
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * @brief	取出下一个待发送的模拟量报警事件
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	事件号，无事件时返回LEVENTS
+ */
+static uint16_t Get_AlarmEvent(uint32_t exclude)
+{
+    uint16_t event;
+
+    if (g_Alarm == 0)
+    {
+        return LEVENTS;
+    }
+    Os_Critical_Enter();
+    event = Get_NextMember(g_Alarm & ~exclude, LEVENTS - 1U);
+    if (event < LEVENTS)
+    {
+        g_Alarm &= ~(1UL << event);
+    }
+    Os_Critical_Exit();
+
+    return event;
+}
+
+/**
+ * @brief	取出下一个待发送的变位事件
+ * @details	从上次位置之后开始查找，避免低序号从站长期占用信道；线圈已回到从站确认值的事件直接丢弃
+ * @param	last 上次发送的事件号
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	事件号，无事件时返回LEVENTS
+ */
+static uint16_t Get_DirtyEvent(uint16_t last, uint32_t exclude)
+{
+    uint16_t event;
+
+    while (g_Dirty & ~exclude)
+    {
+        Os_Critical_Enter();
+        event = Get_NextMember(g_Dirty & ~exclude, last);
+        if (event < LEVENTS)
+        {
+            g_Dirty &= ~(1UL << event);
+        }
+        Os_Critical_Exit();
+        if ((event >= LEVENTS) || !L101_Coil_Settled(&L101_Map[event]))
+        {
+            return event;
+        }
+        L101_Map[event].Stats.Skips++;
+        last = event;
+    }
+
+    return LEVENTS;
+}
+
+/**
+ * @brief	从阻塞集合中取出可重新探测的设备
+ * @details	仍在退避中的设备消耗一次探测机会
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	可探测的事件集合
+ */
+static uint32_t Get_ProbeSet(uint32_t exclude)
+{
+    uint32_t set = 0, block = pLs->Block & ~exclude;
+    uint16_t event;
+
+    for (; block; block &= block - 1UL)
+    {
+        event = Get_NextMember(block, LEVENTS - 1U);
+        if (L101_Map[event].Check.Holdoff)
+        {
+            L101_Map[event].Check.Holdoff--;
+            continue;
+        }
+        set |= 1UL << event;
+    }
+
+    return set;
+}
+
+/**
+ * @brief	取得后台心跳事件
+ * @details	轮流发送就绪列表中的设备，每TOTAL_SUM次心跳从阻塞列表中取出一个退避结束的离线设备重新探测
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	事件号，无事件时返回LEVENTS
+ */
+static uint16_t Get_HeartbeatEvent(uint32_t exclude)
+{
+    static uint16_t probe = 0;
+    uint16_t event;
+    uint32_t set = 0;
+
+    /*判断是否有离线设备*/
+    if ((pLs->Block & ~exclude) && ((++probe >= TOTAL_SUM) || (pLs->Ready == 0)))
+    {
+        probe = 0;
+        set = Get_ProbeSet(exclude);
+    }
+    if (set)
+    {
+        /*循环的从阻塞集合中取出一个设备*/
+        event = Get_NextMember(set, pLs->Pos[1]);
+        pLs->Pos[1] = event;
+        /*探测成功后才移入就绪集合*/
+        return event;
+    }
+    event = Get_NextMember(pLs->Ready & ~exclude, pLs->Pos[0]);
+    if (event < LEVENTS)
+    {
+        pLs->Pos[0] = event;
+    }
+
+    return event;
+}
+
+/**
+ * @brief	取得有待发送模拟量的在线从站
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	事件号，无事件时返回LEVENTS
+ */
+static uint16_t Get_AnalogEvent(uint32_t exclude)
+{
+    static uint16_t pos = L101_MAX_EVENTS - 1U;
+    uint32_t set = g_Analog & pLs->Ready & ~exclude;
+
+    if (set == 0)
+    {
+        return LEVENTS;
+    }
+    pos = Get_NextMember(set, pos);
+
+    return pos;
+}
+
+#if defined(USING_TIMESYNC)
+/**
+ * @brief	取得到期的时间同步事件
+ * @details	每 L101_SYNC_INTERVAL 至多一帧，轮流发往在线从站，离线从站的探测不受影响
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	目标从站首个事件号，未到期或无可发送的从站时返回LEVENTS
+ */
+static uint16_t Get_SyncEvent(uint32_t exclude)
+{
+    uint32_t set = 0;
+
+    if ((uint32_t)(L101_GET_MS() - g_Sync.Last) < L101_SYNC_INTERVAL)
+    {
+        return LEVENTS;
+    }
+    set = g_Index.Leaders & pLs->Ready & ~exclude;
+    if (set == 0)
+    {
+        return LEVENTS;
+    }
+    g_Sync.Cursor = Get_NextMember(set, g_Sync.Cursor);
+
+    return g_Sync.Cursor;
+}
+#endif
+
+/**
+ * @brief	取得到期的延迟测试事件
+ * @details	测试帧优先级低于实际事件；目标从站正在等待应答时顺延到下一节拍，期间不补发
+ * @param	exclude 正在等待应答的事件集合
+ * @retval	目标从站首个事件号，未到期或无可发送的从站时返回LEVENTS
+ */
+static uint16_t Get_TestEvent(uint32_t exclude)
+{
+    uint32_t set = 0;
+
+    if (!g_Test.Enable || ((uint32_t)(L101_GET_MS() - g_Test.Last) < g_Test.Interval))
+    {
+        return LEVENTS;
+    }
+    if (g_Test.Event < LEVENTS)
+    {
+        set = 1UL << Get_GroupLeader(g_Test.Event);
+    }
+    else
+    {
+        set = g_Index.Leaders;
+    }
+    set &= ~exclude;
+    if (set == 0)
+    {
+        return LEVENTS;
+    }
+    g_Test.Cursor = Get_NextMember(set, g_Test.Cursor);
+
+    return g_Test.Cursor;
+}
+
+/**
+ * @brief	取得目标从站的事件集合
+ * @param	leader 目标从站首个事件号
+ * @retval	同一目标从站的所有事件
+ */
+static uint32_t Get_GroupMask(uint16_t leader)
+{
+    return (leader < EXTERN_DIGITAL_MAX) ? g_Index.Group[leader] : 0;
+}
+
+/**
+ * @brief	线圈是否与从站确认值相同
+ * @param	pL 目标事件
+ * @retval	true 确认值有效、无在途的线圈且本地线圈与确认值相同
+ */
+static bool L101_Coil_Settled(L101_HandleTypeDef *pL)
+{
+    mdBit bit;
+
+    return pL->Coil_Valid && !pL->Coil_Pending && (mdRTU_ReadCoil(Master_Object, pL->Digital_Addr, bit) == mdTRUE) &&
+           (bit == pL->Coil_Ack);
+}
+
+/**
+ * @brief	提交目标从站的线圈帧
+ * @details	线圈数据由请求引擎在发出时才读取，这里记下提交时的值作为发出值；其间线圈再变化会重新标记变位事件，
+ *			确认值与实际发出值不同时至多多发一帧，不会漏发
+ * @param	pL 目标从站首个事件
+ * @retval	mdTRUE 请求已提交 mdFALSE 请求队列满
+ */
+static uint8_t L101_Coil_Frame(L101_HandleTypeDef *pL)
+{
+    uint16_t leader = pL - L101_Map;
+#if defined(USING_BATCH_FRAME)
+    uint32_t set = Get_GroupMask(leader);
+#else
+    uint32_t set = 1UL << leader;
+#endif
+    L101_HandleTypeDef *pE;
+    mdBit bit;
+
+    for (; set; set &= set - 1UL)
+    {
+        pE = &L101_Map[Get_NextMember(set, LEVENTS - 1U)];
+        if (mdRTU_ReadCoil(Master_Object, pE->Digital_Addr, bit) == mdTRUE)
+        {
+            pE->Coil_Sent = bit;
+            pE->Coil_Pending = true;
+        }
+    }
+    return L101_FRAME_FUNC(pL);
+}
+
+/**
+ * @brief	确认或作废已发出的线圈
+ * @details	应答失败时确认值作废；目标从站仍在线而线圈与确认值不同时(发出后线圈又变化、变位标记随模拟量帧
+ *			或同一从站的其他事件被清除、应答失败)重新标记变位事件
+ * @param	leader 目标从站首个事件号
+ * @param	ok 从站是否正确应答
+ * @retval	None
+ */
+static void L101_Coil_Commit(uint16_t leader, bool ok)
+{
+    L101_HandleTypeDef *pL = NULL;
+    uint32_t dirty = 0;
+
+    for (uint16_t i = leader; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        if (!Is_SameDestination(pL, &L101_Map[leader]))
+        {
+            continue;
+        }
+        if (pL->Coil_Pending)
+        {
+            pL->Coil_Pending = false;
+            pL->Coil_Ack = pL->Coil_Sent;
+            pL->Coil_Valid = ok;
+        }
+        if ((pLs->Ready & (1UL << leader)) && !L101_Coil_Settled(pL))
+        {
+            dirty |= 1UL << i;
+        }
+    }
+    if (dirty)
+    {
+        Os_Critical_Enter();
+        g_Dirty |= dirty;
+        Os_Critical_Exit();
+    }
+}
+
+/**
+ * @brief	统计集合中的成员数
+ * @param	set 事件集合
+ * @retval	成员数
+ */
+static uint16_t Get_SetCount(uint32_t set)
+{
+    uint16_t count = 0;
+
+    for (; set; set &= set - 1UL)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief	更新从站应答等待窗口
+ * @details	Jacobson/Karels算法:SRTT += (RTT - SRTT)/8, RTTVAR += (|RTT - SRTT| - RTTVAR)/4,
+ *          RTO = SRTT + 4*RTTVAR，再折算为Master_Poll节拍数
+ * @param	pL 目标事务
+ * @retval	None
+ */
+static void L101_Update_Rto(L101_HandleTypeDef *pL)
+{
+    int32_t delta;
+    uint32_t rto;
+
+    if (pL->Check.Srtt == 0)
+    { /*首个样本:SRTT = RTT, RTTVAR = RTT/2*/
+        pL->Check.Srtt = pL->Check.Rtt << 3U;
+        pL->Check.Rttvar = pL->Check.Rtt << 1U;
+    }
+    else
+    {
+        delta = (int32_t)pL->Check.Rtt - (int32_t)(pL->Check.Srtt >> 3U);
+        pL->Check.Srtt += delta;
+        delta = delta < 0 ? -delta : delta;
+        pL->Check.Rttvar += delta - (int32_t)(pL->Check.Rttvar >> 2U);
+    }
+    rto = (pL->Check.Srtt >> 3U) + pL->Check.Rttvar;
+    /*向上取整到节拍*/
+    rto = (rto + MDTASK_SENDTIMES - 1U) / MDTASK_SENDTIMES;
+    /*上下限随速率等级由空中时间模型给出*/
+    pL->Check.Times = rto < L101_Rto_Floor() ? L101_Rto_Floor() : (rto > L101_Rto_Ceil() ? L101_Rto_Ceil() : rto);
+}
+
+#if (MODBUS_FEC)
+/**
+ * @brief	按一个统计窗口的结果调整从站的纠错等级
+ * @details	丢包率超过L101_FEC_LOSS_UP时提高一级；纠错生效后丢包会被掩盖，
+ *          因此只有在连续若干窗口既无丢包、应答也无需纠正时才降低一级
+ * @param	pL 目标从站首个事件
+ * @param	loss 窗口内的丢包率(%)
+ * @retval	None
+ */
+static void L101_Fec_Update(L101_HandleTypeDef *pL, uint16_t loss)
+{
+    if (pL->Fec.Locked)
+    {
+        pL->Fec.Fixed = 0;
+        return;
+    }
+    if ((loss > L101_FEC_LOSS_UP) && (pL->Fec.Level < MODBUS_FEC_MAX))
+    {
+        pL->Fec.Level++;
+        pL->Fec.Good = 0;
+    }
+    else if (loss || pL->Fec.Fixed || (pL->Fec.Level == MODBUS_FEC_OFF))
+    {
+        pL->Fec.Good = 0;
+    }
+    else if (++pL->Fec.Good >= L101_LINK_UP_WINDOWS)
+    {
+        pL->Fec.Level--;
+        pL->Fec.Good = 0;
+    }
+    pL->Fec.Fixed = 0;
+}
+
+/**
+ * @brief	取得发往从站的请求的纠错等级
+ * @details	作为主站请求引擎的纠错选择，在提交请求的任务中调用；不在映射表中的从站不编码
+ * @param	handler 主站请求引擎句柄
+ * @param	port 传输端口
+ * @param	slaveId 从站号
+ * @retval	纠错等级
+ */
+static mdU8 L101_Fec_Level(ModbusRTUMasterHandler handler, mdU8 port, mdU8 slaveId)
+{
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        if ((g_Index.Leaders & (1UL << i)) && (L101_Map[i].Slave_Id == slaveId))
+        {
+            return L101_Map[i].Fec.Level;
+        }
+    }
+    return MODBUS_FEC_OFF;
+}
+
+/**
+ * @brief	设置从站的纠错等级
+ * @details	设定的等级不再随丢包率调整，-1 恢复自动选择(从不编码开始)；重新上电后恢复自动
+ * @param	event 事件号(作用于其目标从站)
+ * @param	level 纠错等级(0~MODBUS_FEC_MAX)，-1:自动
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t L101_Set_Fec(int event, int level)
+{
+    L101_HandleTypeDef *pL;
+
+    if ((event < 0) || (event >= (int)LEVENTS) || (level < -1) || (level > (int)MODBUS_FEC_MAX))
+    {
+        return 0xFF;
+    }
+    pL = &L101_Map[g_Index.Leader[event]];
+    pL->Fec.Locked = (level >= 0);
+    pL->Fec.Level = (level >= 0) ? (uint8_t)level : MODBUS_FEC_OFF;
+    pL->Fec.Good = 0;
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_fec, L101_Set_Fec, set slave fec level event level);
+#endif
+
+/**
+ * @brief	更新链路质量统计
+ * @details	每L101_LINK_WINDOW个事务统计一次各在线从站丢包率:最差从站超过上限时降一级速率，
+ *          连续L101_LINK_UP_WINDOWS个窗口均低于下限时升一级；全网连续超时则直接回退到保守速率。
+ *          应答中不含RSSI，仅依据应答成功率判断
+ * @param	pL 完成的事务
+ * @param	state 事务结果
+ * @retval	None
+ */
+static void L101_Link_Update(L101_HandleTypeDef *pL, L101_State state)
+{
+    uint16_t worst = 0, loss;
+
+    pL->Check.Tx++;
+    pL->Check.Rx += (state == L_OK) ? 1U : 0;
+    g_Link.Timeouts = (state == L_TimeOut) ? g_Link.Timeouts + 1U : 0;
+    if ((g_Link.Timeouts >= L101_LINK_FALLBACK_TIMES) && (g_Link.Target > L101_SPD_SAFE))
+    {
+        g_Link.Target = L101_SPD_SAFE;
+        g_Link.Good = 0;
+        g_Link.Timeouts = 0;
+    }
+    if (++g_Link.Count < L101_LINK_WINDOW)
+    {
+        return;
+    }
+    g_Link.Count = 0;
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        /*窗口内无应答的离线从站不参与速率选择*/
+        if (pL->Check.Rx)
+        {
+            loss = (pL->Check.Tx - pL->Check.Rx) * 100U / pL->Check.Tx;
+            worst = loss > worst ? loss : worst;
+            pL->Check.Loss = loss;
+#if (MODBUS_FEC)
+            L101_Fec_Update(pL, loss);
+#endif
+        }
+#if (MODBUS_FEC)
+        else if (pL->Check.Tx && !pL->Fec.Locked)
+        { /*窗口内纠错编码的请求全部无应答:从站可能不支持纠错，回到不编码后重新评估*/
+            pL->Fec.Level = MODBUS_FEC_OFF;
+            pL->Fec.Good = 0;
+        }
+#endif
+        pL->Check.Tx = pL->Check.Rx = 0;
+    }
+    if (worst > L101_LINK_LOSS_MAX)
+    {
+        g_Link.Good = 0;
+        g_Link.Target = g_Link.Target > L101_SPD_MIN ? g_Link.Target - 1U : L101_SPD_MIN;
+    }
+    else if ((worst < L101_LINK_LOSS_MIN) && (++g_Link.Good >= L101_LINK_UP_WINDOWS))
+    {
+        g_Link.Good = 0;
+        g_Link.Target = g_Link.Target < L101_SPD_MAX ? g_Link.Target + 1U : L101_SPD_MAX;
+    }
+    else if (worst >= L101_LINK_LOSS_MIN)
+    {
+        g_Link.Good = 0;
+    }
+}
+
+#if defined(USING_AIMD)
+/**
+ * @brief	拥塞控制的速率上限
+ * @details	按空中时间模型，各模块每个在途请求每次往返(含唤醒码)发出一帧
+ * @param	None
+ * @retval	速率(0.1帧/s)
+ */
+static uint16_t L101_Pace_Ceil(void)
+{
+    uint32_t rate = 10000U * L101_AIMD_BURST / (L101_Exchange_Time(g_Link.Spd) + L101_Wake_Time());
+
+    return (rate > L101_AIMD_RATE_MIN) ? (uint16_t)rate : L101_AIMD_RATE_MIN;
+}
+
+/**
+ * @brief	记录一个完成的事务
+ * @details	只统计提交时在线的从站，离线从站的探测超时不代表信道拥塞
+ * @param	online 提交时是否在线
+ * @param	state 事务结果
+ * @retval	None
+ */
+static void L101_Pace_Count(bool online, L101_State state)
+{
+    if (!online)
+    {
+        return;
+    }
+    g_Pace.Done = (g_Pace.Done < 0xFFFFU) ? g_Pace.Done + 1U : g_Pace.Done;
+    g_Pace.Lost += ((state != L_OK) && (g_Pace.Lost < 0xFFFFU)) ? 1U : 0U;
+}
+
+/**
+ * @brief	补充令牌并按周期调整速率
+ * @details	丢包率超过 L101_AIMD_LOSS 时乘性降速；无丢包且本周期令牌未满(速率限制了提交)时加性提速，
+ *			需求低于速率时保持不变，空闲后不会虚增；速率在 L101_AIMD_RATE_MIN 与空中时间上限之间
+ * @param	None
+ * @retval	true 有令牌，可以提交受限的请求
+ */
+static bool L101_Pace_Admit(void)
+{
+    uint32_t now = L101_GET_MS(), elapsed = now - g_Pace.Last;
+    uint16_t top = L101_Pace_Ceil(), rate;
+
+    g_Pace.Last = now;
+    /*长时间未调用时只补满，避免乘法溢出*/
+    elapsed = (elapsed > L101_AIMD_CYCLE) ? L101_AIMD_CYCLE : elapsed;
+    g_Pace.Credit += (int32_t)(elapsed * g_Pace.Rate);
+    if (g_Pace.Credit >= (int32_t)(L101_AIMD_BURST * L101_AIMD_FRAME))
+    {
+        g_Pace.Credit = (int32_t)(L101_AIMD_BURST * L101_AIMD_FRAME);
+        g_Pace.Full = true;
+    }
+    if (((uint32_t)(now - g_Pace.Start) >= L101_AIMD_CYCLE) && (g_Pace.Done >= L101_AIMD_SAMPLES))
+    {
+        g_Pace.Loss = (uint8_t)(g_Pace.Lost * 100U / g_Pace.Done);
+        if (!g_Pace.Locked && (g_Pace.Loss > L101_AIMD_LOSS))
+        {
+            rate = (uint16_t)(g_Pace.Rate * L101_AIMD_BETA / 8U);
+            g_Pace.Rate = (rate > L101_AIMD_RATE_MIN) ? rate : L101_AIMD_RATE_MIN;
+            g_Pace.Downs++;
+        }
+        else if (!g_Pace.Locked && (g_Pace.Lost == 0) && !g_Pace.Full && (g_Pace.Rate < top))
+        {
+            rate = g_Pace.Rate + L101_AIMD_STEP;
+            g_Pace.Rate = (rate < top) ? rate : top;
+            g_Pace.Ups++;
+        }
+        g_Pace.Start = now;
+        g_Pace.Done = g_Pace.Lost = 0;
+        g_Pace.Full = false;
+    }
+
+    return g_Pace.Credit >= L101_AIMD_FRAME;
+}
+
+/**
+ * @brief	固定拥塞控制的速率
+ * @param	rate 速率(0.1帧/s)，0:恢复自动调整
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t L101_Set_Rate(int rate)
+{
+    if ((rate < 0) || (rate > 0xFFFF) || ((rate > 0) && (rate < (int)L101_AIMD_RATE_MIN)))
+    {
+        return 0xFF;
+    }
+    g_Pace.Locked = (rate > 0);
+    /*恢复自动调整时从当前速率继续*/
+    g_Pace.Rate = (rate > 0) ? (uint16_t)rate : ((g_Pace.Rate < L101_Pace_Ceil()) ? g_Pace.Rate : L101_Pace_Ceil());
+    g_Pace.Done = g_Pace.Lost = 0;
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_rate, L101_Set_Rate, set poll rate limit rate);
+#endif
+
+/**
+ * @brief	取得链路管理期望的速率等级
+ * @param	None
+ * @retval	速率等级
+ */
+uint8_t L101_Link_Target(void)
+{
+    return g_Link.Target;
+}
+
+/**
+ * @brief	取得模块当前速率等级
+ * @param	None
+ * @retval	速率等级
+ */
+uint8_t L101_Link_Speed(void)
+{
+    return g_Link.Spd;
+}
+
+/**
+ * @brief	速率等级已写入模块
+ * @details	速率改变后各从站往返时间随之改变，等待窗口按空中时间模型重新取为下限的2倍，
+ *          由后续RTT样本收敛；速率等级同时写入保留区
+ * @param	level 模块实际的速率等级
+ * @retval	None
+ */
+void L101_Link_Applied(uint8_t level)
+{
+    g_Link.Spd = level;
+    g_Link.Target = level;
+    Retain_Set_Link(level);
+    g_Link.Good = 0;
+    g_Link.Count = 0;
+    g_Link.Timeouts = 0;
+#if defined(USING_AIMD)
+    /*首次从上限开始；降低速率等级后不超过新的上限，提高后由加性增逐步提速*/
+    if (!g_Pace.Locked && ((g_Pace.Rate == 0) || (g_Pace.Rate > L101_Pace_Ceil())))
+    {
+        g_Pace.Rate = L101_Pace_Ceil();
+    }
+#endif
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        L101_Map[i].Check.Srtt = 0;
+        L101_Map[i].Check.Times = 2U * L101_Rto_Floor();
+        L101_Map[i].Check.Tx = L101_Map[i].Check.Rx = 0;
+    }
+}
+
+/**
+ * @brief	打印链路质量
+ * @param	None
+ * @retval	None
+ */
+void L101_Link_Show(void)
+{
+    L101_HandleTypeDef *pL = NULL;
+
+    int32_t left = (int32_t)(g_Admit.Drain - HAL_GetTick());
+
+    shellPrint(&shell, "spd = %d, target = %d, rssi = %d\r\n", g_Link.Spd, g_Link.Target, g_Link.Rssi);
+    shellPrint(&shell, "air = %u bps, backlog = %d ms, edges = %u, early = %u\r\n", L101_Air_Rate(),
+               (left > 0) ? left : 0, g_Admit.Edges, g_Admit.Early);
+#if defined(USING_AIMD)
+    shellPrint(&shell, "rate = %u.%u/s%s, ceil = %u.%u/s, tokens = %d, loss = %d%%, up = %u, down = %u\r\n",
+               g_Pace.Rate / 10U, g_Pace.Rate % 10U, g_Pace.Locked ? " (fixed)" : "", L101_Pace_Ceil() / 10U,
+               L101_Pace_Ceil() % 10U, (int)(g_Pace.Credit / L101_AIMD_FRAME), g_Pace.Loss, g_Pace.Ups,
+               g_Pace.Downs);
+#endif
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        pL = &L101_Map[i];
+        shellPrint(&shell, "[%d] id = %d, %s, loss = %d%%, srtt = %dms, rto = %d\r\n", i, pL->Slave_Id,
+                   (pLs->Ready & (1UL << i)) ? "online" : "offline", pL->Check.Loss,
+                   pL->Check.Srtt >> 3U, pL->Check.Times);
+        if (pL->Health.Valid)
+        {
+            shellPrint(&shell, "    errors = %d, uptime = %us, rssi = 0x%02x, reboots = %d\r\n", pL->Health.Errors,
+                       pL->Health.Uptime, pL->Health.Rssi, pL->Health.Reboots);
+        }
+#if (MODBUS_FEC)
+        if (pL->Fec.Level || pL->Fec.Locked || pL->Fec.Total)
+        {
+            shellPrint(&shell, "    fec = %d%s, corrected = %u\r\n", pL->Fec.Level, pL->Fec.Locked ? " (fixed)" : "",
+                       pL->Fec.Total);
+        }
+#endif
+    }
+#if (MODBUS_FEC)
+    if (Client_Object != NULL)
+    {
+        shellPrint(&shell, "fec: sent = %u, plain = %u, decoded = %u, corrected = %u, failed = %u\r\n",
+                   Client_Object->fecSent, Client_Object->fecPlain, Client_Object->fec.frames,
+                   Client_Object->fec.corrected, Client_Object->fec.failed);
+    }
+#endif
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_link, L101_Link_Show, show link quality);
+
+/**
+ * @brief	打印空中时间模型及当前映射表的预计更新能力
+ * @details	每个从站的更新为一次典型事务；信道半双工，每个模块每秒最多完成 1000/(往返时间+唤醒码) 次更新，
+ *			映射表中所有从站轮流更新一遍的时间为从站数乘以往返时间；另列出各速率等级下的对应值供选择
+ * @param	None
+ * @retval	None
+ */
+void L101_Air_Show(void)
+{
+    uint32_t slaves = 0, exchange, updates;
+
+    for (uint16_t i = 0; i < LEVENTS; i++)
+    {
+        slaves += (Get_GroupLeader(i) == i) ? 1U : 0;
+    }
+    exchange = L101_Exchange_Time(g_Link.Spd) + L101_Wake_Time();
+    shellPrint(&shell, "spd = %d (%u bps), fec = %s, wake = %u ms, turnaround = %u ms\r\n", g_Link.Spd,
+               L101_Air_Rate(), L101_FEC ? "on" : "off", L101_Wake_Time(), L101_TURNAROUND);
+    shellPrint(&shell, "request = %u B / %u ms, reply = %u B / %u ms, exchange = %u ms\r\n", L101_REQUEST_BYTES,
+               L101_Spd_Air_Time(g_Link.Spd, L101_REQUEST_BYTES), L101_REPLY_BYTES,
+               L101_Spd_Air_Time(g_Link.Spd, L101_REPLY_BYTES), exchange);
+    shellPrint(&shell, "rto = %u..%u, heartbeat = %u (x %u ms), heartbeat load = %u%%\r\n", L101_Rto_Floor(),
+               L101_Rto_Ceil(), L101_Heartbeat_Times(), MDTASK_SENDTIMES,
+               exchange * 100U / (L101_Heartbeat_Times() * MDTASK_SENDTIMES));
+    shellPrint(&shell, "slaves = %u, radios = %u\r\n", slaves, L101_RADIOS);
+#if defined(USING_AIRTIME)
+    exchange = L101_Air_Left();
+    shellPrint(&shell, "duty = %u.%u%%, window = %u s, used = %u ms, left = %u ms (%u%%), total = %u ms, shed = %u, blocked = %u\r\n",
+               g_Air.Duty / 10U, g_Air.Duty % 10U, L101_AIR_WINDOW, g_Air.Used, exchange,
+               exchange * 100U / L101_Air_Budget(), g_Air.Total, g_Air.Shed, g_Air.Blocked);
+#endif
+    shellPrint(&shell, "spd      bps  exchange  updates/s  cycle\r\n");
+    for (uint8_t spd = L101_SPD_MIN; spd <= L101_SPD_MAX; spd++)
+    {
+        exchange = L101_Exchange_Time(spd) + L101_Wake_Time();
+        /*每秒更新数按0.1次打印*/
+        updates = L101_RADIOS * 10000U / exchange;
+        shellPrint(&shell, "%c%2d %8u %6u ms %7u.%u %6u ms\r\n", (spd == g_Link.Spd) ? '*' : ' ', spd,
+                   L101_Spd_Rate(spd), exchange, updates / 10U, updates % 10U,
+                   (slaves * exchange + L101_RADIOS - 1U) / L101_RADIOS);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_air, L101_Air_Show, show airtime model and update capacity);
+
+/**
+ * @brief	取得从站的累计统计
+ * @param	event 事件号
+ * @param	pId 存放从机地址
+ * @retval	统计，事件号超出映射表时为 NULL
+ */
+const L101_Stats *L101_Stats_Get(uint16_t event, uint8_t *pId)
+{
+    if (event >= L101_MAX_EVENTS)
+    {
+        return NULL;
+    }
+    *pId = L101_Map[event].Slave_Id;
+
+    return &L101_Map[event].Stats;
+}
+
+/**
+ * @brief	清除各从站的累计统计
+ * @details	由 stats_clear 调用，不影响链路质量估计
+ * @param	None
+ * @retval	None
+ */
+void L101_Stats_Clear(void)
+{
+    Os_Critical_Enter();
+    for (uint16_t i = 0; i < L101_MAX_EVENTS; i++)
+    {
+        memset(&L101_Map[i].Stats, 0, sizeof(L101_Map[i].Stats));
+    }
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	开始延迟测试
+ * @details	清除上次的测试统计，之后按间隔在无实际事件的节拍发出回显帧；
+ *          可对比不同速率等级、FEC及调度参数下的往返时间分布
+ * @param	event 目标事件，-1:轮流发往各从站
+ * @param	interval 发送间隔(ms，不小于调度节拍)
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t L101_Test_Start(int event, int interval)
+{
+    if ((event < -1) || (event >= (int)LEVENTS) || (interval < (int)L101_TEST_INTERVAL_MIN))
+    {
+        return 0xFF;
     }
-    if (pLs->First_Flag)
+    Os_Critical_Enter();
+    memset(g_Latency, 0, sizeof(g_Latency));
+    g_Test.Event = (event < 0) ? L101_MAX_EVENTS : (uint16_t)event;
+    g_Test.Cursor = L101_MAX_EVENTS - 1U;
+    g_Test.Interval = (uint32_t)interval;
+    g_Test.Last = L101_GET_MS() - g_Test.Interval;
+    g_Test.Enable = true;
+    Os_Critical_Exit();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), lat_start, L101_Test_Start, start latency test event interval);
+
+/**
+ * @brief	停止延迟测试
+ * @details	在途的测试帧仍计入统计
+ * @param	None
+ * @retval	None
+ */
+void L101_Test_Stop(void)
+{
+    g_Test.Enable = false;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), lat_stop, L101_Test_Stop, stop latency test);
+
+/**
+ * @brief	打印延迟测试结果
+ * @details	p99取直方图中累计达到99%的一档上限，不超过最大值
+ * @param	None
+ * @retval	None
+ */
+void L101_Test_Show(void)
+{
+    L101_Latency *pT = NULL;
+    uint32_t need, sum, p99;
+    uint16_t bin;
+
+    shellPrint(&shell, "test = %s, interval = %ums, seq = %d, spd = %d\r\n", g_Test.Enable ? "on" : "off",
+               g_Test.Interval, g_Test.Seq, g_Link.Spd);
+#if defined(USING_TIMESYNC)
+    shellPrint(&shell, "time sync: interval = %ums, tx = %u\r\n", L101_SYNC_INTERVAL, g_Sync.Tx);
+#endif
+    for (uint16_t i = 0; i < LEVENTS; i++)
     {
-        ListItem_t *p = NULL;
-        /*1个None+3Wait+1Timeout,增加一个就绪列表项消耗*/
-        if (++sum >= pL->Check.Times + 2U + pLs->Ready->uxNumberOfItems)
+        pT = &g_Latency[i];
+        if (pT->Tx == 0)
         {
-            sum = 0;
-            option_flag = true;
-            /*判断是否有离线设备*/
-            if (listCURRENT_LIST_LENGTH(pLs->Block))
-            {
-                /*循环的从阻塞列表中移除一个列表项*/
-                p = Get_OneListItem(pLs->Block, &g_Item[1]);
-                /*加入就绪列表*/
-                Add_ListItem(pLs->Ready, listGET_LIST_ITEM_VALUE(p));
-                /*从阻塞列表中移除*/
-                Remove_ListItem(pLs->Block, listGET_LIST_ITEM_VALUE(p));
+            continue;
+        }
+        need = (pT->Rx * 99U + 99U) / 100U;
+        for (bin = 0, sum = 0; (bin < L101_TEST_BINS - 1U) && ((sum += pT->Hist[bin]) < need); bin++)
+        {
+        }
+        p99 = (bin < L101_TEST_BINS - 1U) && (g_Test_Bins[bin] < pT->Max) ? g_Test_Bins[bin] : pT->Max;
+        shellPrint(&shell, "[%d] id = %d, tx = %u, rx = %u, lost = %u, rtt min/avg/max/p99 = %u/%u/%u/%ums\r\n", i,
+                   L101_Map[i].Slave_Id, pT->Tx, pT->Rx, pT->Lost, pT->Min, pT->Rx ? pT->Sum / pT->Rx : 0, pT->Max,
+                   p99);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), lat, L101_Test_Show, show latency test);
+
+/**
+ * @brief	模块上报信号强度
+ * @details	由URC处理调用，记录于链路管理
+ * @param	ctx URC内容(前缀之后的部分)
+ * @retval	None
+ */
+void L101_Urc_Rssi(at_urc_ctx_t *ctx)
+{
+    int rssi = atoi(ctx->buf);
+
+    g_Link.Rssi = (rssi < 0) ? (uint8_t)(-rssi) : (uint8_t)rssi;
+}
+
+/**
+ * @brief	模块上报发送完成
+ * @details	由Modbus任务调用，唤醒无线调度任务立即提交下一请求
+ * @param	ctx 未使用
+ * @retval	None
+ */
+void L101_Urc_Send_Ok(at_urc_ctx_t *ctx)
+{
+    (void)ctx;
+    if (radioHandle)
+    {
+        Os_Signal_Set(radioHandle, L101_SIGNAL_FREE);
+    }
+}
+
+/**
+ * @brief	设置网络功耗模式
+ * @details	唤醒At任务把功耗模式及唤醒间隔写入主站模块；l101_save后随映射表保存
+ * @param	mode 0:常收 1:占空比网络
+ * @param	wtm 唤醒间隔(ms，500的整数倍)
+ * @param	itm 从站空闲时间(s)
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t L101_Set_Power(int mode, int wtm, int itm)
+{
+    if ((mode < (int)L101_POWER_RUN) || (mode > (int)L101_POWER_DUTY) ||
+        (wtm < (int)L101_WTM_MIN) || (wtm > (int)L101_WTM_MAX) || (wtm % L101_WTM_STEP) ||
+        (itm < (int)L101_ITM_MIN) || (itm > (int)L101_ITM_MAX))
+    {
+        return 0xFF;
+    }
+    Os_Critical_Enter();
+    g_Power.Mode = mode;
+    g_Power.Wtm = wtm;
+    g_Power.Itm = itm;
+    g_Power.Pending = true;
+    Os_Critical_Exit();
+    Mode_Request(MODE_SIGNAL_POWER);
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_power, L101_Set_Power, set power mode wtm itm);
+
+/**
+ * @brief	取得待写入主站模块的功耗配置
+ * @param	pDuty 是否为占空比网络
+ * @param	pWtm 唤醒间隔(ms)
+ * @retval	true 有待写入的配置
+ */
+bool L101_Power_Pending(bool *pDuty, uint16_t *pWtm)
+{
+    bool pending;
+
+    Os_Critical_Enter();
+    pending = g_Power.Pending;
+    *pDuty = (g_Power.Mode == L101_POWER_DUTY);
+    *pWtm = g_Power.Wtm;
+    Os_Critical_Exit();
+
+    return pending;
+}
+
+/**
+ * @brief	功耗配置已写入主站模块
+ * @details	成功时按新的唤醒码时长重新估计等待窗口；失败时恢复为模块当前的功耗模式
+ * @param	ok 是否写入成功
+ * @retval	None
+ */
+void L101_Power_Applied(bool ok)
+{
+    Os_Critical_Enter();
+    g_Power.Pending = false;
+    if (ok)
+    {
+        g_Power.Applied = g_Power.Mode;
+        for (uint16_t i = 0; i < LEVENTS; i++)
+        {
+            L101_Map[i].Check.Srtt = 0;
+        }
+    }
+    else
+    {
+        g_Power.Mode = g_Power.Applied;
+    }
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	处理一个在途事务的状态
+ * @param	event 事件号
+ * @retval	None
+ */
+static void L101_Transaction_Check(uint16_t event)
+{
+    L101_HandleTypeDef *pL = &L101_Map[event];
+#if defined(USING_AIMD)
+    bool online = (pLs->Ready & (1UL << event)) != 0;
+#endif
+
 #if defined(USING_DEBUG)
-                // shellPrint(&shell, "p = 0x%p,\r\n", p);
-                // // shellPrint(&shell, "\r\nschdule !\r\n");
-                // shellPrint(&shell, "\r\nBlocK_List:\r\n");
-                // for (p = (ListItem_t *)pLs->Block->xListEnd.pxNext; p->xItemValue != portMAX_DELAY; p = p->pxNext)
-                // {
-                //     shellPrint(&shell, "Bnums = %d,value[0x%p] = %d\r\n", pLs->Block->uxNumberOfItems, p, listGET_LIST_ITEM_VALUE(p));
-                // }
-                // shellPrint(&shell, "p->xItemValue = 0X%0X\r\n", p->xItemValue);
-                // shellPrint(&shell, "\r\nReady_List:\r\n");
-                // for (p = (ListItem_t *)pLs->Ready->xListEnd.pxNext; p->xItemValue != portMAX_DELAY; p = p->pxNext)
-                // {
-                //     shellPrint(&shell, "Rnums = %d,value[0x%p] = %d\r\n", pLs->Ready->uxNumberOfItems, p, listGET_LIST_ITEM_VALUE(p));
-                // }
-                // shellPrint(&shell, "OS remaining heap = %dByte, Mini heap = %dByte\r\n",
-                //    xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
+    // shellPrint(&shell, "\r\np[%d],Check.State = %d\r\n", event, pL->Check.State);
+#endif
+    switch (pL->Check.State)
+    {
+    case L_Wait:
+        /*应答超时由主站请求引擎判定*/
+        return;
+    case L_OK:
+    { /*检测到回应的设备加入就绪集合*/
+        pL->Stats.Rx++;
+        pLs->Ready |= 1UL << event;
+        pLs->Block &= ~(1UL << event);
+        pL->Check.Errors = 0;
+        pL->Check.Backoff = 0;
+        pL->Check.Holdoff = 0;
+        L101_Update_Rto(pL);
+        L101_Analog_Commit(event, true);
+        L101_Coil_Commit(event, true);
+    }
+    break;
+    case L_Error:
+    case L_TimeOut:
+    {
+        pL->Stats.Timeouts += (pL->Check.State == L_TimeOut) ? 1U : 0U;
+        L101_Analog_Commit(event, false);
+        /*等待窗口加倍*/
+        pL->Check.Times = (pL->Check.Times << 1U) > L101_Rto_Ceil() ? L101_Rto_Ceil() : (pL->Check.Times << 1U);
+        pL->Check.Errors = pL->Check.Errors < 0xFF ? pL->Check.Errors + 1U : 0xFF;
+        /*离线设备或在线设备累计失败SUSPEND_TIMES次，从就绪集合移入阻塞集合*/
+        if (!(pLs->Ready & (1UL << event)) || (pL->Check.Errors >= SUSPEND_TIMES))
+        {
+            pLs->Block |= 1UL << event;
+            pLs->Ready &= ~(1UL << event);
+            /*重新探测失败后指数退避*/
+            pL->Check.Holdoff = (1U << pL->Check.Backoff) - 1U;
+            pL->Check.Backoff = pL->Check.Backoff < L101_BACKOFF_MAX ? pL->Check.Backoff + 1U : L101_BACKOFF_MAX;
+        }
+        L101_Coil_Commit(event, false);
+    }
+    break;
+    default:
+        break;
+    }
+#if defined(USING_AIMD)
+    L101_Pace_Count(online, pL->Check.State);
+#endif
+    L101_Link_Update(pL, pL->Check.State);
+    pL->Check.State = L_None;
+    /*释放事务*/
+    pLs->Busy &= ~(1UL << event);
+}
+
+/**
+ * @brief	占空比网络的心跳间隔
+ * @details	心跳轮流发往各从站，全网间隔为两倍空闲时间除以节点数
+ * @param	None
+ * @retval	心跳间隔(单位:MDTASK_SENDTIMES)
+ */
+static uint32_t L101_Duty_Heartbeat(void)
+{
+    uint32_t times = (2000U * g_Power.Itm) / (MDTASK_SENDTIMES * (LEVENTS ? LEVENTS : 1U));
+
+    return (times > L101_Heartbeat_Times()) ? times : L101_Heartbeat_Times();
+}
+
+/**
+ * @brief	取得因模块不能发送而排除的事件
+ * @details	按服务信道的模块分别统计在途事务，在途已满或模块忙时排除该模块信道上的所有事件，
+ *          各模块互不阻塞；唤醒码占用信道，占空比网络中每个模块只允许一个请求在途
+ * @param	duty 是否为占空比网络
+ * @retval	排除的事件集合
+ */
+static uint32_t L101_Radio_Exclude(bool duty)
+{
+    uint32_t exclude = 0, group;
+    uint8_t busy;
+    bool ready;
+
+    for (uint8_t r = 0; r < L101_RADIOS; r++)
+    {
+        group = g_Index.Radio[r];
+        busy = 0;
+        for (uint32_t set = pLs->Busy & group; set; set &= set - 1UL)
+        {
+            busy++;
+        }
+#if defined(USING_L101_RADIO2)
+        ready = r ? Radio2_Ready() : L101_Admit_Check();
+#else
+        ready = L101_Admit_Check();
+#endif
+#if defined(USING_TDMA)
+        /*时隙外不提交，事件留到本主站的下一时隙，往返时间不计入等待时隙的时间*/
+        ready = ready && ((r != 0) || Tdma_Open());
+#endif
+#if defined(USING_AIRTIME)
+        /*占空比预算耗尽时主模块上的事件留到窗口滑过旧的发送之后*/
+        ready = ready && ((r != 0) || L101_Air_Allow(MASTER_CLASS_ALARM));
+#endif
+        if ((busy >= (duty ? 1U : L101_MAX_PIPELINE)) || !ready)
+        {
+            exclude |= group;
+        }
+    }
+
+    return exclude;
+}
+
+/**
+ * @brief	选择下一个目标从站并提交请求
+ * @details	首次上电依次扫描所有从站；之后依次优先发送有模拟量报警、有变位事件的从站，
+ *          无事件时按心跳间隔(L101_Heartbeat_Times，低速率等级下放宽)发送一帧心跳刷新从站状态；
+ *          不同目标从站最多可同时有L101_MAX_PIPELINE个请求在途；占空比网络中串行发送并放宽心跳间隔；
+ *          请求按来源标记类别:模拟量报警为报警类，变位事件为控制类，模拟量及在线从站心跳为遥测类，
+ *          扫描、离线探测及延迟测试为诊断类；开启拥塞控制时报警、控制类以外的请求受速率限制；
+ *          占空比余量不足时主模块上只发出报警及控制类请求
+ * @param	tick 是否为调度节拍，发送完成上报触发的提交不推进心跳计数
+ * @retval	None
+ */
+static void L101_Schedule_Submit(bool tick)
+{
+    L101_HandleTypeDef *pL = NULL;
+    static uint16_t event_x = 0;
+    static uint16_t heartbeat = 0;
+    uint16_t next = LEVENTS;
+    uint32_t busy = pLs->Busy, exclude = 0, pending = 0, shed = 0;
+    uint32_t mask = (LEVENTS >= 32U) ? 0xFFFFFFFFUL : ((1UL << LEVENTS) - 1UL);
+    uint8_t priority = MASTER_CLASS_DIAG;
+    bool analog = false, test = false, sync = false;
+    bool duty = (g_Power.Applied == L101_POWER_DUTY);
+
+    /*处理所有在途事务*/
+    while (busy)
+    {
+        next = Get_NextMember(busy, LEVENTS - 1U);
+        busy &= ~(1UL << next);
+        L101_Transaction_Check(next);
+    }
+    /*所有模块均不能发送*/
+    exclude = L101_Radio_Exclude(duty);
+    if ((exclude & mask) == mask)
+    {
+        return;
+    }
+    /*正在等待应答的从站不再发出新请求*/
+    for (busy = pLs->Busy; busy; busy &= busy - 1UL)
+    {
+        exclude |= Get_GroupMask(Get_NextMember(busy, LEVENTS - 1U));
+    }
+#if defined(USING_AIRTIME)
+    shed = L101_Air_Allow(MASTER_CLASS_TELEMETRY) ? 0 : g_Index.Radio[0];
+#endif
+    next = LEVENTS;
+    /*首次上电扫描所有从机状态*/
+    if (pLs->First_Flag == false)
+    {
+#if defined(USING_DISCOVER)
+        /*入网信标代替逐个扫描，不可用时(开启帧认证)仍逐个扫描*/
+        switch (Discover_Poll())
+        {
+        case DISCOVER_RUNNING:
+            return;
+        case DISCOVER_FINISHED:
+            L101_Discover_End();
+            return;
+        default:
+            break;
+        }
 #endif
+        if ((exclude | shed) & (1UL << Get_GroupLeader(g_Scan)))
+        {
+            return;
+        }
+        next = g_Scan;
+        /*一个周期扫描结束*/
+        pLs->First_Flag = (++g_Scan >= LEVENTS) ? (g_Scan = 0, true) : false;
+    }
+    else
+    {
+        /*模拟量报警最优先:同一从站的模拟量全部以完整码值重发*/
+        next = Get_AlarmEvent(exclude);
+        if (next < LEVENTS)
+        {
+            analog = true;
+            priority = MASTER_CLASS_ALARM;
+            for (busy = Get_GroupMask(Get_GroupLeader(next)); busy; busy &= busy - 1UL)
+            {
+                L101_Map[Get_NextMember(busy, LEVENTS - 1U)].Analog_Valid = false;
             }
         }
+        else
+        { /*其次为变位事件*/
+            next = Get_DirtyEvent(event_x, exclude);
+            priority = MASTER_CLASS_CONTROL;
+        }
+        /*以下为遥测及诊断类请求*/
+        exclude |= shed;
+#if defined(USING_AIMD)
+        /*其余请求按拥塞控制的速率发出，令牌不足时留到之后的节拍*/
+        if ((next >= LEVENTS) && !L101_Pace_Admit())
+        {
+            return;
+        }
+#endif
+        if (next >= LEVENTS)
+        { /*再次为超出死区或到达最长发送间隔的模拟量*/
+            next = Get_AnalogEvent(exclude);
+            analog = (next < LEVENTS);
+            priority = MASTER_CLASS_TELEMETRY;
+        }
+        /*延迟测试帧在无实际事件时按设定间隔发出，并代替本节拍的心跳*/
+        if ((next >= LEVENTS) && tick)
+        {
+            next = Get_TestEvent(exclude);
+            test = (next < LEVENTS);
+            priority = MASTER_CLASS_DIAG;
+        }
+        /*占空比网络中从站在空闲时间内收到心跳会一直保持唤醒，每个从站的心跳间隔取两倍空闲时间*/
+        if ((next >= LEVENTS) && tick && (++heartbeat >= (duty ? L101_Duty_Heartbeat() : L101_Heartbeat_Times())))
+        {
+            heartbeat = 0;
+#if defined(USING_TIMESYNC)
+            /*到期的时间同步帧代替本次心跳，不增加空中流量*/
+            next = Get_SyncEvent(exclude);
+            sync = (next < LEVENTS);
+            next = sync ? next : Get_HeartbeatEvent(exclude);
+#else
+            next = Get_HeartbeatEvent(exclude);
+#endif
+            /*离线设备的探测不得挤占在线设备的业务*/
+            priority = ((next < LEVENTS) && (pLs->Block & (1UL << next))) ? MASTER_CLASS_DIAG : MASTER_CLASS_TELEMETRY;
+        }
+    }
+    if (next >= LEVENTS)
+    {
+        return;
+    }
+    /*合并帧由目标从站的首个事件发出*/
+    event_x = Get_GroupLeader(next);
+    /*同一从站的其余变位事件随本帧一起发出；测试帧及同步帧不携带事件*/
+    Os_Critical_Enter();
+    if (!test && !sync)
+    {
+        g_Dirty &= ~Get_GroupMask(event_x);
+        g_Alarm &= ~Get_GroupMask(event_x);
+    }
+    if (analog)
+    {
+        pending = g_Analog & Get_GroupMask(event_x);
+        g_Analog &= ~pending;
+    }
+    Os_Critical_Exit();
+#if defined(USING_AIMD)
+    /*报警及控制类请求可透支，至多透支一个突发，之后的受限请求相应推迟*/
+    if (g_Pace.Credit > -(int32_t)(L101_AIMD_BURST * L101_AIMD_FRAME))
+    {
+        g_Pace.Credit -= L101_AIMD_FRAME;
+    }
+#endif
+    pL = &L101_Map[event_x];
+    pL->Check.State = L_Wait;
+    pL->Check.Start = L101_GET_MS();
+    pL->Check.Priority = priority;
+    pL->Stats.Tx++;
+    pL->Stats.Retries += pL->Check.Errors ? 1U : 0U;
+    pLs->Busy |= 1UL << event_x;
+#if defined(USING_TIMESYNC)
+    if (sync ? (Set_TimeFrame(pL) == mdFALSE)
+             : test ? (Set_EchoFrame(pL) == mdFALSE)
+                    : ((!analog || (Set_AnalogFrame(pL, pending) == mdFALSE)) && (L101_Coil_Frame(pL) == mdFALSE)))
+#else
+    if (test ? (Set_EchoFrame(pL) == mdFALSE)
+             : ((!analog || (Set_AnalogFrame(pL, pending) == mdFALSE)) && (L101_Coil_Frame(pL) == mdFALSE)))
+#endif
+    { /*请求未能提交，下一节拍按失败处理*/
+        pL->Check.State = L_Error;
+    }
+}
+
+#if defined(USING_UTIMER)
+/*在途请求最早的应答超时时刻*/
+static void L101_Arq_Expire(void *Arg);
+static Utimer L101_Arq_Timer = UTIMER_INIT(L101_Arq_Expire, NULL);
+
+/**
+ * @brief	应答超时到期
+ * @details	在TIM4中断中回调，唤醒调度任务由 Master_Kick 判定超时并立即重发或发出排队的请求
+ * @param	Arg 未使用
+ * @retval	None
+ */
+static void L101_Arq_Expire(void *Arg)
+{
+    (void)Arg;
+    if (radioHandle)
+    {
+        Os_Signal_Set(radioHandle, L101_SIGNAL_FREE);
+    }
+}
+#endif
+
+/**
+ * @brief	对准最早的应答超时
+ * @details	请求引擎按毫秒计时，只在调度节拍中判定超时，应答超时最多晚 MDTASK_SENDTIMES；
+ *			开启 USING_UTIMER 时每次检查后用单次微秒定时器对准最早的超时时刻，
+ *			到期时毫秒计数尚未进位的由下一次检查补足1ms
+ * @param	None
+ * @retval	None
+ */
+static void L101_Arq_Arm(void)
+{
+#if defined(USING_UTIMER)
+    uint32_t left = mdRTUMasterDeadline(Client_Object, L101_GET_MS());
+
+    if (left == MASTER_NO_DEADLINE)
+    {
+        Utimer_Stop(&L101_Arq_Timer);
+        return;
+    }
+    left = (left == 0) ? 1U : ((left > UTIMER_MAX / 1000U) ? UTIMER_MAX / 1000U : left);
+    Utimer_Start(&L101_Arq_Timer, left * 1000U, 0);
+#endif
+}
+
+/**
+ * @brief	主站发送数据给从站
+ * @details	由调度器提交请求，请求的发出、应答匹配及超时由主站请求引擎完成
+ * @param	None
+ * @retval	None
+ */
+void Master_Poll(void)
+{
+    bool bulk = true;
+
+    if (Client_Object == NULL)
+    {
+        return;
+    }
+#if defined(USING_STANDBY)
+    /*备用主站只采用镜像，不发出请求，排队的请求在接管后发出*/
+    if (!Standby_Poll())
+    {
+        return;
+    }
+#endif
+    TRACE(TRACE_POLL_BEGIN);
+#if defined(USING_TDMA)
+    /*协调者在本时隙开始时先发出信标*/
+    Tdma_Poll();
+#endif
+    /*输入线圈及报警类路由源变化时先驱动目标线圈，本节拍即可下发*/
+    Route_Poll();
+    L101_Schedule_Submit(true);
+#if defined(USING_L101_RADIO2)
+    /*两个模块各自服务一组信道，同一节拍为另一模块上的从站再提交一个请求*/
+    L101_Schedule_Submit(false);
+#endif
+    L101_Schedule_Save();
+#if defined(USING_GATEWAY)
+    Gateway_Submit();
+#endif
+#if defined(USING_AIRTIME)
+    /*占空比余量不足时暂停分块传输及固件下发，会话保留，余量恢复后继续*/
+    bulk = L101_Air_Allow(MASTER_CLASS_TELEMETRY);
+#endif
+#if defined(USING_XFER)
+    if (bulk)
+    {
+        Xfer_Submit();
+    }
+#endif
+#if defined(USING_OTA)
+    if (bulk)
+    {
+        Ota_Submit();
+    }
+#endif
+#if defined(USING_SCENE)
+    Scene_Submit();
+#endif
+    /*超时检查并发出排队的请求*/
+    mdRTU_Poll(Client_Object, L101_GET_MS());
+    L101_Arq_Arm();
+    TRACE(TRACE_POLL_END);
+}
+
+/**
+ * @brief	模块空闲后立即发送下一请求
+ * @details	由发送完成上报触发，只提交事件请求，心跳及探测仍按调度节拍
+ * @param	None
+ * @retval	None
+ */
+void Master_Kick(void)
+{
+    bool bulk = true;
+
+    if (Client_Object == NULL)
+    {
+        return;
+    }
+#if defined(USING_STANDBY)
+    if (!Standby_Active())
+    {
+        return;
+    }
+#endif
+    L101_Schedule_Submit(false);
+    L101_Schedule_Save();
+#if defined(USING_GATEWAY)
+    Gateway_Submit();
+#endif
+#if defined(USING_AIRTIME)
+    bulk = L101_Air_Allow(MASTER_CLASS_TELEMETRY);
+#endif
+#if defined(USING_XFER)
+    if (bulk)
+    {
+        Xfer_Submit();
+    }
+#endif
+#if defined(USING_OTA)
+    if (bulk)
+    {
+        Ota_Submit();
     }
+#endif
+#if defined(USING_SCENE)
+    Scene_Submit();
+#endif
+    mdRTU_Poll(Client_Object, L101_GET_MS());
+    L101_Arq_Arm();
 }
@@ -21,7 +21,12 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
-uint32_t Adc_buffer[ADC_DMA_SIZE] = {0};
+#include "dma_mgr.h"
+#if defined(USING_ADC_TIMER_TRIGGER)
+extern TIM_HandleTypeDef htim1;
+static void Adc_Trigger_Init(void);
+#endif
+uint16_t Adc_buffer[ADC_DMA_SIZE] = {0};
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc1;
@@ -57,10 +62,10 @@ void MX_ADC1_Init(void)
   /** Configure Analog WatchDog 1
   */
   AnalogWDGConfig.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
-  AnalogWDGConfig.HighThreshold = 0;
+  AnalogWDGConfig.HighThreshold = 4095;
   AnalogWDGConfig.LowThreshold = 0;
   AnalogWDGConfig.Channel = ADC_CHANNEL_2;
-  AnalogWDGConfig.ITMode = DISABLE;
+  AnalogWDGConfig.ITMode = ENABLE;
   if (HAL_ADC_AnalogWDGConfig(&hadc1, &AnalogWDGConfig) != HAL_OK)
   {
     Error_Handler();
@@ -83,6 +88,16 @@ void MX_ADC1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN ADC1_Init 2 */
+#if defined(USING_ADC_TIMER_TRIGGER)
+  /*Each TIM1 CC1 event starts one scan of both channels*/
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T1_CC1;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  Adc_Trigger_Init();
+#endif
 
   /* USER CODE END ADC1_Init 2 */
 
@@ -115,8 +130,8 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
     hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
     hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
     hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
-    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
-    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
     hdma_adc1.Init.Mode = DMA_CIRCULAR;
     hdma_adc1.Init.Priority = DMA_PRIORITY_HIGH;
     if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
@@ -126,7 +141,12 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 
     __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc1);
 
+    /* ADC1 interrupt Init */
+    HAL_NVIC_SetPriority(ADC1_2_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
   /* USER CODE BEGIN ADC1_MspInit 1 */
+    /*Channel and priority from the board DMA plan (dma_mgr.h)*/
+    Dma_Setup(&hdma_adc1, DMA_REQ_ADC1);
 
   /* USER CODE END ADC1_MspInit 1 */
   }
@@ -151,6 +171,16 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 
     /* ADC1 DMA DeInit */
     HAL_DMA_DeInit(adcHandle->DMA_Handle);
+
+    /* ADC1 interrupt Deinit */
+  /* USER CODE BEGIN ADC1:ADC1_2_IRQn disable */
+    /**
+    * Uncomment the line below to disable the "ADC1_2_IRQn" interrupt
+    * Be aware, disabling shared interrupt may affect other IPs
+    */
+    /* HAL_NVIC_DisableIRQ(ADC1_2_IRQn); */
+  /* USER CODE END ADC1:ADC1_2_IRQn disable */
+
   /* USER CODE BEGIN ADC1_MspDeInit 1 */
 
   /* USER CODE END ADC1_MspDeInit 1 */
@@ -158,32 +188,121 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 }
 
 /* USER CODE BEGIN 1 */
-#define ADC_FILTER_SHIFT 3U
+#if defined(USING_ADC_TIMER_TRIGGER)
+/**
+ * @brief  Use TIM1 channel 1 compare events as the ADC trigger
+ * @note   TIM1 is the HAL timebase (1MHz counter, 1ms period), so the ADC
+ *         is triggered once per tick, ADC_TRIGGER_PHASE us after the update.
+ *         Channel 1 has no pin mapped to the timer, nothing is driven.
+ * @retval None
+ */
+static void Adc_Trigger_Init(void)
+{
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  sConfigOC.OCMode = TIM_OCMODE_PWM1;
+  sConfigOC.Pulse = ADC_TRIGGER_PHASE;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if ((HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_1) != HAL_OK) ||
+      (HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1) != HAL_OK))
+  {
+    Error_Handler();
+  }
+}
+#endif
+
+/*抽取滤波器:DMA半满/全满中断中对新到的半环增量累加(不重复扫描整个环)，
+满 2^ADC_DECIMATION_SHIFT 个采样输出一次均值，读取结果为O(1)*/
+static struct
+{
+  uint32_t Acc[ADC_DMA_CHANNEL];
+  uint32_t Count;
+  volatile uint16_t Result[ADC_DMA_CHANNEL];
+} Adc_Filter;
+
 /**
  * @brief  Get ADC channel value of DMA transmission
  * @note   Channel 1 and Channel 2 of ADC1 are used
  * @param  Channel Channel ID
- * @retval ADC average value
+ * @retval Latest decimated ADC value
  */
 uint32_t Get_AdcValue(const uint32_t Channel)
 {
-	uint32_t sum = 0;
-	uint32_t *pAdc_Str = &Adc_buffer[0];
-
   /*Prevent array out of bounds*/
-  if (Channel > ADC_DMA_CHANNEL)
+  if (Channel >= ADC_DMA_CHANNEL)
   {
     return 0;
   }
-  /*Add channel offset*/
-	 pAdc_Str += Channel;
+  return Adc_Filter.Result[Channel];
+}
 
-	for( ; pAdc_Str < Adc_buffer + ADC_DMA_SIZE ; pAdc_Str += ADC_DMA_CHANNEL)
-	{
-      sum += *pAdc_Str;
-	}
+/**
+ * @brief  New decimated ADC values are available
+ * @note   Called from the DMA interrupt
+ * @retval None
+ */
+__weak void Adc_Result_Callback(void)
+{
+}
 
-	return (sum >> ADC_FILTER_SHIFT);
+/**
+ * @brief  One half of the DMA ring is ready
+ * @note   Called from the DMA interrupt before the decimation filter, with the raw
+ *         scans of all channels; the half stays intact until the other half is filled
+ * @param  pData First sample of the half ring
+ * @retval None
+ */
+__weak void Adc_Block_Callback(const uint16_t *pData)
+{
+  UNUSED(pData);
+}
+
+/**
+ * @brief  Accumulate one half of the DMA ring into the decimation filter
+ * @param  pData First sample of the half ring
+ * @retval None
+ */
+static void Adc_Filter_Process(const uint16_t *pData)
+{
+  const uint16_t *pEnd = pData + ADC_DMA_SIZE / 2U;
+
+  Adc_Block_Callback(pData);
+  for (; pData < pEnd; pData += ADC_DMA_CHANNEL)
+  {
+    for (uint32_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+      Adc_Filter.Acc[i] += pData[i] & 0x0FFFU;
+    }
+  }
+  Adc_Filter.Count += ADC_SAMPLING_NUM / 2U;
+  if (Adc_Filter.Count < (1UL << ADC_DECIMATION_SHIFT))
+  {
+    return;
+  }
+  for (uint32_t i = 0; i < ADC_DMA_CHANNEL; i++)
+  {
+    Adc_Filter.Result[i] = (uint16_t)(Adc_Filter.Acc[i] >> ADC_DECIMATION_SHIFT);
+    Adc_Filter.Acc[i] = 0;
+  }
+  Adc_Filter.Count = 0;
+  Adc_Result_Callback();
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc->Instance == ADC1)
+  {
+    Adc_Filter_Process(&Adc_buffer[0]);
+  }
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc->Instance == ADC1)
+  {
+    Adc_Filter_Process(&Adc_buffer[ADC_DMA_SIZE / 2U]);
+  }
 }
 /* USER CODE END 1 */
 
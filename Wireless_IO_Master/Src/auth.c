@@ -0,0 +1,104 @@
+#include "auth.h"
+#include "kv.h"
+#include "os_port.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if (MODBUS_AUTH)
+typedef char Auth_Config_Size_Check[(sizeof(Auth_Config) <= KV_VALUE_MAX) ? 1 : -1];
+
+static Auth_Config Auth_Cfg;
+static struct ModbusAuth Auth_Key;
+
+/**
+ * @brief	按配置开关主站请求引擎的帧认证
+ * @details	调度任务可能正在组帧，关中断更换密钥
+ * @param	None
+ * @retval	None
+ */
+static void Auth_Apply(void)
+{
+    mdU32 key[4];
+
+    if (Client_Object == NULL)
+    {
+        return;
+    }
+    Os_Critical_Enter();
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        key[i] = Auth_Cfg.Key[i];
+    }
+    mdAuthSetKey(&Auth_Key, key);
+    Client_Object->auth = Auth_Cfg.Enable ? &Auth_Key : NULL;
+    Os_Critical_Exit();
+}
+
+/**
+ * @brief	加载帧认证配置
+ * @details	在调度列表初始化时调用；从未配置时不认证
+ * @param	None
+ * @retval	None
+ */
+void Auth_Init(void)
+{
+    if (Kv_Get(KV_KEY_AUTH, &Auth_Cfg, sizeof(Auth_Cfg)) != sizeof(Auth_Cfg))
+    {
+        memset(&Auth_Cfg, 0, sizeof(Auth_Cfg));
+    }
+    Auth_Apply();
+}
+
+/**
+ * @brief	设置帧认证
+ * @details	请求及应答附带序号低字节及24位MAC(Chaskey)，从站须配置同一密钥；
+ *			开启后组播写线圈及广播请求不再发出，只认证L101链路上的Modbus帧，时隙信标不认证
+ * @param	enable 0:关闭 1:开启
+ * @param	k0 密钥第0个字
+ * @param	k1 密钥第1个字
+ * @param	k2 密钥第2个字
+ * @param	k3 密钥第3个字
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Auth_Set(int enable, int k0, int k1, int k2, int k3)
+{
+    if ((enable < 0) || (enable > 1))
+    {
+        return 0xFF;
+    }
+    Auth_Cfg.Enable = enable;
+    Auth_Cfg.Key[0] = (uint32_t)k0;
+    Auth_Cfg.Key[1] = (uint32_t)k1;
+    Auth_Cfg.Key[2] = (uint32_t)k2;
+    Auth_Cfg.Key[3] = (uint32_t)k3;
+    Auth_Apply();
+
+    return Kv_Set(KV_KEY_AUTH, &Auth_Cfg, sizeof(Auth_Cfg)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), auth_set, Auth_Set, set auth enable k0 k1 k2 k3);
+
+/**
+ * @brief	打印帧认证状态、统计及各从站的序号(不显示密钥)
+ * @param	None
+ * @retval	None
+ */
+void Auth_Show(void)
+{
+    struct ModbusRTUAuthPeer *pP;
+
+    if (Client_Object == NULL)
+    {
+        return;
+    }
+    shellPrint(&shell, "auth = %d, failures = %u, resyncs = %u, full = %u\r\n", Client_Object->auth != NULL,
+               Client_Object->authFailures, Client_Object->authResyncs, Client_Object->authFull);
+    for (pP = &Client_Object->peers[0]; pP < &Client_Object->peers[MASTER_AUTH_PEERS]; pP++)
+    {
+        if (pP->id != 0)
+        {
+            shellPrint(&shell, "id = %d, seq = %u\r\n", pP->id, pP->seq);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), auth, Auth_Show, show frame auth);
+#endif
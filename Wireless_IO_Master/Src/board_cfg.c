@@ -0,0 +1,87 @@
+#include "board_cfg.h"
+#include "io_signal.h"
+#include "L101.h"
+#include "monitor.h"
+#include "stats.h"
+#include "pulse.h"
+#include "meter.h"
+#include "mdconfig.h"
+#include "shell_port.h"
+
+/*寄存器组编号(board 命令显示用)*/
+#define BOARD_GROUP_COIL 0U
+#define BOARD_GROUP_INPUT_COIL 1U
+#define BOARD_GROUP_INPUT_REGISTER 2U
+#define BOARD_GROUP_HOLD_REGISTER 3U
+
+/*各区域不超出所在组的寄存器池*/
+#define BOARD_REG_FITS(name, group, start, count) \
+    typedef char Board_##name##_Fits[((start) + (count) <= group##_POOL_SIZE) ? 1 : -1];
+BOARD_REGISTER_TABLE(BOARD_REG_FITS)
+
+/*数字量引脚与CubeMX生成的 DDIn 引脚一致*/
+#define BOARD_PIN_CHECK(ch, port, pin, addr, chan, id) \
+    typedef char Board_DDI##ch##_Check[(GPIO_PIN_##pin == DDI##ch##_Pin) ? 1 : -1];
+BOARD_DIGITAL_TABLE(BOARD_PIN_CHECK)
+
+/*寄存器区域描述*/
+typedef struct
+{
+    const char *Name;
+    uint8_t Group;
+    uint16_t Start;
+    uint16_t Count;
+} Board_Region;
+
+/*数字量输入描述*/
+typedef struct
+{
+    const char *Port;
+    uint8_t Pin;
+    uint8_t Sdevice_Addr;
+    uint8_t Schannel;
+    uint8_t Slave_Id;
+} Board_Digital;
+
+#define BOARD_REG_ENTRY(name, group, start, count) {#name, BOARD_GROUP_##group, (start), (count)},
+static const Board_Region Board_Regions[] = {BOARD_REGISTER_TABLE(BOARD_REG_ENTRY)};
+
+#define BOARD_DIGITAL_ENTRY(ch, port, pin, addr, chan, id) [ch] = {#port, (pin), (addr), (chan), (id)},
+static const Board_Digital Board_Digitals[BOARD_DIGITAL_COUNT] = {BOARD_DIGITAL_TABLE(BOARD_DIGITAL_ENTRY)};
+
+/**
+ * @brief	打印板级配置
+ * @details	寄存器布局逐项列出，与同组中靠前的区域重叠时标记 overlap
+ * @param	None
+ * @retval	None
+ */
+void Board_Show(void)
+{
+    static const char *const groups[] = {"coil", "input_coil", "input_reg", "hold_reg"};
+    const uint16_t regions = sizeof(Board_Regions) / sizeof(Board_Regions[0]);
+
+    for (uint16_t i = 0; i < regions; i++)
+    {
+        const Board_Region *pR = &Board_Regions[i];
+        bool overlap = false;
+
+        for (uint16_t j = 0; j < i; j++)
+        {
+            const Board_Region *pO = &Board_Regions[j];
+
+            overlap |= (pO->Group == pR->Group) && (pR->Start < pO->Start + pO->Count) &&
+                       (pO->Start < pR->Start + pR->Count);
+        }
+        shellPrint(&shell, "%-12s %-10s 0x%04x..0x%04x%s\r\n", pR->Name, groups[pR->Group], pR->Start,
+                   pR->Start + pR->Count - 1U, overlap ? " overlap" : "");
+    }
+    for (uint16_t i = 0; i < BOARD_DIGITAL_COUNT; i++)
+    {
+        const Board_Digital *pD = &Board_Digitals[i];
+
+        shellPrint(&shell, "di%d = P%s%d, node addr = 0x%02x, ch = %d, id = %d\r\n", i, pD->Port, pD->Pin,
+                   pD->Sdevice_Addr, pD->Schannel, pD->Slave_Id);
+    }
+    shellPrint(&shell, "analog channels = %d\r\n", BOARD_ANALOG_COUNT);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), board, Board_Show, show board config);
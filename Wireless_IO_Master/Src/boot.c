@@ -0,0 +1,206 @@
+#include "boot.h"
+#include "shell_port.h"
+#include "string.h"
+
+#define BOOT_MARK_TEXT(name, text) text,
+static const char *const Boot_Texts[BOOT_MARKS] = {BOOT_MARK_TABLE(BOOT_MARK_TEXT)};
+
+static Boot_HandleTypeDef Boot;
+
+#if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && __ARMCC_VERSION >= 6000000)
+extern const Boot_Module bootModule$$Base[];
+extern const Boot_Module bootModule$$Limit[];
+#define BOOT_MODULE_BASE bootModule$$Base
+#define BOOT_MODULE_LIMIT bootModule$$Limit
+#elif defined(__GNUC__)
+extern const Boot_Module __start_bootModule[];
+extern const Boot_Module __stop_bootModule[];
+#define BOOT_MODULE_BASE __start_bootModule
+#define BOOT_MODULE_LIMIT __stop_bootModule
+#endif
+
+/**
+ * @brief	登记的模块数
+ * @param	None
+ * @retval	不大于 BOOT_MODULES_MAX
+ */
+static uint32_t Boot_Modules(void)
+{
+    uint32_t count = (uint32_t)(BOOT_MODULE_LIMIT - BOOT_MODULE_BASE);
+
+    return (count < BOOT_MODULES_MAX) ? count : BOOT_MODULES_MAX;
+}
+
+/**
+ * @brief	模块的依赖是否都已完成
+ * @param	pModule 模块
+ * @retval	true 可以执行
+ */
+static bool Boot_Ready(const Boot_Module *pModule)
+{
+    const char *p = pModule->Depends, *end;
+    uint32_t count = Boot_Modules(), length;
+
+    while ((p != NULL) && *p)
+    {
+        end = strchr(p, ',');
+        length = end ? (uint32_t)(end - p) : (uint32_t)strlen(p);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if ((strncmp(BOOT_MODULE_BASE[i].Name, p, length) == 0) && (BOOT_MODULE_BASE[i].Name[length] == '\0') &&
+                !(Boot.Done & (1UL << i)))
+            {
+                return false;
+            }
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return true;
+}
+
+/**
+ * @brief	执行一个模块的初始化
+ * @param	Index 段内序号
+ * @retval	None
+ */
+static void Boot_Init(uint32_t Index)
+{
+    uint32_t start = HAL_GetTick();
+
+    BOOT_MODULE_BASE[Index].Init();
+    Boot.Module_Ms[Index] = (uint16_t)(HAL_GetTick() - start);
+    Boot.Done |= 1UL << Index;
+}
+
+/**
+ * @brief	执行一级的模块初始化
+ * @details	反复扫描登记项，执行依赖都已完成的模块，直到没有可执行的模块(链接顺序不影响结果)；
+ *			依赖成环或依赖了更晚一级的模块时，其余模块按登记顺序执行并记入 Forced(boot 命令中标记)
+ * @param	Level 级别(BOOT_LEVEL_xxx)
+ * @retval	None
+ */
+void Boot_Run(uint8_t Level)
+{
+    uint32_t count = Boot_Modules();
+    bool progress;
+
+    do
+    {
+        progress = false;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if ((BOOT_MODULE_BASE[i].Level == Level) && !(Boot.Done & (1UL << i)) && Boot_Ready(&BOOT_MODULE_BASE[i]))
+            {
+                Boot_Init(i);
+                progress = true;
+            }
+        }
+    } while (progress);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((BOOT_MODULE_BASE[i].Level == Level) && !(Boot.Done & (1UL << i)))
+        {
+            Boot.Forced |= 1UL << i;
+            Boot_Init(i);
+        }
+    }
+    /*超出上限的登记项没有完成标记，最后按登记顺序执行*/
+    for (const Boot_Module *pModule = &BOOT_MODULE_BASE[count]; pModule < BOOT_MODULE_LIMIT; pModule++)
+    {
+        if (pModule->Level == Level)
+        {
+            pModule->Init();
+        }
+    }
+}
+
+/**
+ * @brief	记录启动节点
+ * @details	只记录第一次到达的时刻，之后的调用无效，可在任务的循环中调用
+ * @param	Mark 节点号(BOOT_MARK_xxx)
+ * @retval	None
+ */
+void Boot_Mark(uint8_t Mark)
+{
+    if ((Mark < BOOT_MARKS) && !(Boot.Marked & (1UL << Mark)))
+    {
+        Boot.Tick[Mark] = HAL_GetTick();
+        Boot.Marked |= 1UL << Mark;
+    }
+}
+
+/**
+ * @brief	延后的初始化完成
+ * @details	由启动任务(调度器未运行时由 main())调用，唤醒在 Boot_Wait() 中等待的任务
+ * @param	None
+ * @retval	None
+ */
+void Boot_Done(void)
+{
+    uint8_t count;
+
+    Os_Critical_Enter();
+    Boot.Ready = true;
+    count = Boot.Waiters;
+    Os_Critical_Exit();
+    Boot_Mark(BOOT_MARK_READY);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Os_Signal_Set(Boot.Waiter[i], BOOT_SIGNAL_READY);
+    }
+}
+
+/**
+ * @brief	等待延后的初始化完成
+ * @details	依赖启动任务所初始化模块的任务在进入循环前调用；期间到达的其他信号保留给任务自身
+ * @param	None
+ * @retval	None
+ */
+void Boot_Wait(void)
+{
+    bool listed = false;
+
+    Os_Critical_Enter();
+    if (!Boot.Ready && (Boot.Waiters < BOOT_WAITERS))
+    {
+        Boot.Waiter[Boot.Waiters++] = Os_Self();
+        listed = true;
+    }
+    Os_Critical_Exit();
+    while (!Boot.Ready && Os_Running())
+    {
+        /*未能登记的任务按1ms查询*/
+        Os_Signal_Wait(BOOT_SIGNAL_READY, listed ? OS_WAIT_FOREVER : 1U);
+    }
+}
+
+/**
+ * @brief	打印启动节点的时刻
+ * @param	None
+ * @retval	None
+ */
+void Boot_Show(void)
+{
+    for (uint8_t i = 0; i < BOOT_MARKS; i++)
+    {
+        if (Boot.Marked & (1UL << i))
+        {
+            shellPrint(&shell, "%-20s %u ms\r\n", Boot_Texts[i], Boot.Tick[i]);
+        }
+        else
+        {
+            shellPrint(&shell, "%-20s -\r\n", Boot_Texts[i]);
+        }
+    }
+    for (uint32_t i = 0; i < Boot_Modules(); i++)
+    {
+        shellPrint(&shell, "  %-16s L%u %s%u ms\r\n", BOOT_MODULE_BASE[i].Name, BOOT_MODULE_BASE[i].Level,
+                   (Boot.Forced & (1UL << i)) ? "(forced) " : "", Boot.Module_Ms[i]);
+    }
+    if ((uint32_t)(BOOT_MODULE_LIMIT - BOOT_MODULE_BASE) > BOOT_MODULES_MAX)
+    {
+        shellPrint(&shell, "  %u modules over BOOT_MODULES_MAX run unordered\r\n",
+                   (uint32_t)(BOOT_MODULE_LIMIT - BOOT_MODULE_BASE) - BOOT_MODULES_MAX);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), boot, Boot_Show, show boot timing and modules);
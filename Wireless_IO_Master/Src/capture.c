@@ -0,0 +1,190 @@
+#include "capture.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_CAPTURE)
+typedef char Capture_Ring_Pow2[((CAPTURE_RING_SIZE & (CAPTURE_RING_SIZE - 1U)) == 0) ? 1 : -1];
+
+static Capture_HandleTypeDef Capture;
+
+/**
+ * @brief	写入环(在环尾回绕)
+ * @param	Pos 字节序号
+ * @param	pData 数据
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Capture_Put(uint32_t Pos, const uint8_t *pData, uint32_t Length)
+{
+    uint32_t offset = Pos % CAPTURE_RING_SIZE;
+    uint32_t first = (Length < CAPTURE_RING_SIZE - offset) ? Length : (CAPTURE_RING_SIZE - offset);
+
+    memcpy(&Capture.Ring[offset], pData, first);
+    memcpy(Capture.Ring, &pData[first], Length - first);
+}
+
+/**
+ * @brief	读出环(在环尾回绕)
+ * @param	Pos 字节序号
+ * @param	pData 数据
+ * @param	Length 长度
+ * @retval	None
+ */
+static void Capture_Get(uint32_t Pos, uint8_t *pData, uint32_t Length)
+{
+    uint32_t offset = Pos % CAPTURE_RING_SIZE;
+    uint32_t first = (Length < CAPTURE_RING_SIZE - offset) ? Length : (CAPTURE_RING_SIZE - offset);
+
+    memcpy(pData, &Capture.Ring[offset], first);
+    memcpy(&pData[first], Capture.Ring, Length - first);
+}
+
+/**
+ * @brief	捕获一帧
+ * @details	中断及任务中均可调用，关中断期间拷贝帧(最长约260字节)；空间不足时覆盖最早的记录，
+ *			未开启捕获时立即返回
+ * @param	Dir CAPTURE_RX/CAPTURE_TX
+ * @param	pData 帧(含L101前缀及CRC)
+ * @param	Length 长度
+ * @retval	None
+ */
+void Capture_Frame(uint8_t Dir, const uint8_t *pData, uint32_t Length)
+{
+    uint32_t primask, size = CAPTURE_HEAD_SIZE + Length;
+    uint32_t tick = HAL_GetTick();
+    uint8_t head[CAPTURE_HEAD_SIZE] = {(uint8_t)tick, (uint8_t)(tick >> 8U), (uint8_t)(tick >> 16U),
+                                       (uint8_t)(tick >> 24U), Dir, (uint8_t)Length, (uint8_t)(Length >> 8U)};
+    uint8_t old[CAPTURE_HEAD_SIZE];
+
+    if (!Capture.Enabled || (Length == 0) || (size > CAPTURE_RING_SIZE))
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    /*导出开始前已通过上面检查的调用者在此放弃，导出期间环不变*/
+    if (!Capture.Enabled)
+    {
+        __set_PRIMASK(primask);
+        return;
+    }
+    while (Capture.Head + size - Capture.Tail > CAPTURE_RING_SIZE)
+    {
+        Capture_Get(Capture.Tail, old, CAPTURE_HEAD_SIZE);
+        Capture.Tail += CAPTURE_HEAD_SIZE + (old[5] | ((uint32_t)old[6] << 8U));
+        Capture.Records--;
+        Capture.Overwritten++;
+    }
+    Capture_Put(Capture.Head, head, CAPTURE_HEAD_SIZE);
+    Capture_Put(Capture.Head + CAPTURE_HEAD_SIZE, pData, Length);
+    Capture.Head += size;
+    Capture.Records++;
+    Capture.Frames++;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	开启或停止捕获
+ * @details	已捕获的帧保留，重新开启后继续追加
+ * @param	Enable 1:开启 0:停止
+ * @retval	0
+ */
+uint8_t Capture_Start(int Enable)
+{
+    Capture.Enabled = Enable ? true : false;
+    shellPrint(&shell, "capture %s, records = %u, frames = %u, overwritten = %u\r\n", Capture.Enabled ? "on" : "off",
+               Capture.Records, Capture.Frames, Capture.Overwritten);
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), capture, Capture_Start, capture frames 1 0);
+
+/**
+ * @brief	按时间顺序导出环内的帧
+ * @details	导出期间暂停捕获，结束后恢复；每帧一行 "时刻(ms) R|T 十六进制帧"，
+ *			以 capture_end 结束，主机工具据此判断导出完整
+ * @param	None
+ * @retval	None
+ */
+void Capture_Dump(void)
+{
+    bool enabled = Capture.Enabled;
+    uint8_t head[CAPTURE_HEAD_SIZE], data[CAPTURE_DUMP_BYTES];
+    char hex[CAPTURE_DUMP_BYTES * 2U + 1U];
+    uint32_t pos, length, n;
+
+    Capture.Enabled = false;
+    shellPrint(&shell, "capture_begin records = %u, overwritten = %u\r\n", Capture.Records, Capture.Overwritten);
+    for (pos = Capture.Tail; pos != Capture.Head; pos += CAPTURE_HEAD_SIZE + length)
+    {
+        Capture_Get(pos, head, CAPTURE_HEAD_SIZE);
+        length = head[5] | ((uint32_t)head[6] << 8U);
+        shellPrint(&shell, "%u %c ",
+                   head[0] | ((uint32_t)head[1] << 8U) | ((uint32_t)head[2] << 16U) | ((uint32_t)head[3] << 24U),
+                   (head[4] == CAPTURE_TX) ? 'T' : 'R');
+        for (uint32_t i = 0; i < length; i += n)
+        {
+            n = (length - i < CAPTURE_DUMP_BYTES) ? (length - i) : CAPTURE_DUMP_BYTES;
+            Capture_Get(pos + CAPTURE_HEAD_SIZE + i, data, n);
+            for (uint32_t j = 0; j < n; j++)
+            {
+                hex[j * 2U] = "0123456789ABCDEF"[data[j] >> 4U];
+                hex[j * 2U + 1U] = "0123456789ABCDEF"[data[j] & 0x0FU];
+            }
+            hex[n * 2U] = '\0';
+            shellPrint(&shell, "%s", hex);
+        }
+        shellPrint(&shell, "\r\n");
+    }
+    shellPrint(&shell, "capture_end\r\n");
+    Capture.Enabled = enabled;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), capture_dump, Capture_Dump, dump captured frames);
+
+/**
+ * @brief	读取环内的记录
+ * @details	按字节序号从最早的记录起读取(记录格式见 capture.h)，关中断期间拷贝，在任务中调用
+ * @param	Offset 距最早记录的字节数
+ * @param	pData 数据
+ * @param	Length 最多读取的字节数
+ * @retval	读取的字节数
+ */
+uint32_t Capture_Read(uint32_t Offset, uint8_t *pData, uint32_t Length)
+{
+    uint32_t primask = __get_PRIMASK(), used;
+
+    __disable_irq();
+    used = Capture.Head - Capture.Tail;
+    Length = (Offset >= used) ? 0 : ((Length < used - Offset) ? Length : (used - Offset));
+    Capture_Get(Capture.Tail + Offset, pData, Length);
+    __set_PRIMASK(primask);
+    return Length;
+}
+
+/**
+ * @brief	环内记录的字节数
+ * @param	None
+ * @retval	字节数
+ */
+uint32_t Capture_Used(void)
+{
+    return Capture.Head - Capture.Tail;
+}
+
+/**
+ * @brief	清空捕获环
+ * @param	None
+ * @retval	None
+ */
+void Capture_Clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Capture.Tail = Capture.Head;
+    Capture.Records = 0;
+    Capture.Frames = 0;
+    Capture.Overwritten = 0;
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), capture_clear, Capture_Clear, clear captured frames);
+#endif
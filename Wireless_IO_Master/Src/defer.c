@@ -0,0 +1,147 @@
+#include "defer.h"
+#include "shell_port.h"
+
+#if defined(USING_DEFER)
+typedef char Defer_Sources_Check[(DEFER_SOURCES <= 32U) ? 1 : -1];
+
+#define DEFER_SOURCE_NAME(name, desc) #name,
+static const char *const Defer_Name[DEFER_SOURCES] = {DEFER_SOURCE_TABLE(DEFER_SOURCE_NAME)};
+#undef DEFER_SOURCE_NAME
+
+static Defer_HandleTypeDef Defer;
+
+/**
+ * @brief	DWT周期数换算为us
+ * @param	Cycles 周期数
+ * @retval	us
+ */
+static uint32_t Defer_Us(uint32_t Cycles)
+{
+    return Cycles / (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief	登记一个下半部
+ * @details	中断及任务中均可调用；该来源尚未执行时只合并参数，不重复唤醒计时；
+ *			defer 任务未运行(调度器启动前)时直接执行
+ * @param	Source 来源(DEFER_SRC_xxx)
+ * @param	Func 处理函数
+ * @param	Arg 参数，与未执行的参数按位或
+ * @retval	None
+ */
+void Defer_Post(uint8_t Source, Defer_Func Func, uint32_t Arg)
+{
+    Defer_Slot *pS;
+    uint32_t primask;
+
+    if ((Source >= DEFER_SOURCES) || (Func == NULL))
+    {
+        return;
+    }
+    if (Defer.Thread == NULL)
+    {
+        Func(Arg);
+        return;
+    }
+    pS = &Defer.Slots[Source];
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (!(Defer.Pending & (1UL << Source)))
+    {
+        pS->Posted = DWT->CYCCNT;
+        pS->Arg = 0;
+    }
+    pS->Func = Func;
+    pS->Arg |= Arg;
+    pS->Posts++;
+    Defer.Pending |= 1UL << Source;
+    __set_PRIMASK(primask);
+    Os_Signal_Set(Defer.Thread, DEFER_SIGNAL_POST);
+}
+
+/**
+ * @brief	执行登记的下半部
+ * @details	由 defer 任务循环调用：按来源表的顺序执行，执行期间同一来源的新登记留到下一轮；
+ *			全部执行后等待新的登记
+ * @param	Timeout 最长等待时间(ms)
+ * @retval	None
+ */
+void Defer_Process(uint32_t Timeout)
+{
+    Defer_Func func;
+    uint32_t primask, arg, posted, start, us;
+
+    Defer.Thread = Os_Self();
+    while (Defer.Pending)
+    {
+        for (uint8_t i = 0; i < DEFER_SOURCES; i++)
+        {
+            Defer_Slot *pS = &Defer.Slots[i];
+
+            primask = __get_PRIMASK();
+            __disable_irq();
+            if (!(Defer.Pending & (1UL << i)))
+            {
+                __set_PRIMASK(primask);
+                continue;
+            }
+            Defer.Pending &= ~(1UL << i);
+            func = pS->Func;
+            arg = pS->Arg;
+            posted = pS->Posted;
+            __set_PRIMASK(primask);
+
+            start = DWT->CYCCNT;
+            func(arg);
+            us = Defer_Us(start - posted);
+            pS->Latency_Max = (us > pS->Latency_Max) ? us : pS->Latency_Max;
+            us = Defer_Us(DWT->CYCCNT - start);
+            pS->Run_Max = (us > pS->Run_Max) ? us : pS->Run_Max;
+            pS->Runs++;
+        }
+    }
+    Os_Signal_Wait(DEFER_SIGNAL_POST, Timeout);
+}
+
+/**
+ * @brief	打印各来源的登记、执行及合并次数和最大延迟
+ * @param	None
+ * @retval	None
+ */
+void Defer_Show(void)
+{
+    for (uint8_t i = 0; i < DEFER_SOURCES; i++)
+    {
+        Defer_Slot *pS = &Defer.Slots[i];
+
+        shellPrint(&shell, "%-4s posts = %u, runs = %u, coalesced = %u, latency max = %uus, run max = %uus\r\n",
+                   Defer_Name[i], pS->Posts, pS->Runs, pS->Posts - pS->Runs - ((Defer.Pending >> i) & 0x01U),
+                   pS->Latency_Max, pS->Run_Max);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), defer, Defer_Show, show deferred interrupt work);
+
+/**
+ * @brief	清除各来源的计数及最大值
+ * @details	未执行的登记保留
+ * @param	None
+ * @retval	None
+ */
+void Defer_Clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (uint8_t i = 0; i < DEFER_SOURCES; i++)
+    {
+        Defer_Slot *pS = &Defer.Slots[i];
+
+        pS->Posts = (Defer.Pending >> i) & 0x01U;
+        pS->Runs = 0;
+        pS->Latency_Max = 0;
+        pS->Run_Max = 0;
+    }
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), defer_clear, Defer_Clear, clear deferred work counters);
+#endif
@@ -0,0 +1,140 @@
+#include "diag.h"
+#include "cmsis_os.h"
+#include "soe.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+
+static Diag_HandleTypeDef Diag;
+static osTimerId Diag_Timer;
+
+/**
+ * @brief	按小端写入多字节字段
+ * @details
+ * @param	pBuf 写入位置
+ * @param	Value 字段值
+ * @param	Size 字节数
+ * @retval	写入后的位置
+ */
+static uint8_t *Diag_Put(uint8_t *pBuf, uint32_t Value, uint8_t Size)
+{
+    for (uint8_t i = 0; i < Size; i++, Value >>= 8U)
+    {
+        *pBuf++ = (uint8_t)Value;
+    }
+    return pBuf;
+}
+
+/**
+ * @brief	组一帧诊断记录并写入shell日志缓冲区
+ * @details	在定时器服务任务中调用；缓冲区不足时整帧丢弃，未发出的SOE事件留到下一帧
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Diag_Poll(void const *argument)
+{
+    uint8_t *pBuf = &Diag.Frame[4], *pLen;
+    mdU16 regs[DIAG_REG_SIZE] = {0};
+    uint32_t latest = Soe_Latest(), soe = Diag.Soe;
+    Soe_Event event;
+    mdU16 crc;
+
+    UNUSED(argument);
+    if (latest - soe > SOE_LOG_SIZE)
+    { /*事件已被覆盖:从环内最旧的记录开始，上位机按序号的间隔发现丢失*/
+        soe = latest - SOE_LOG_SIZE;
+    }
+    Diag.Frame[0] = DIAG_SYNC0;
+    Diag.Frame[1] = DIAG_SYNC1;
+    Diag.Frame[3] = Diag.Sequence;
+
+    *pBuf++ = DIAG_TLV_STATUS;
+    *pBuf++ = 20U;
+    pBuf = Diag_Put(pBuf, osKernelSysTick(), 4U);
+    pBuf = Diag_Put(pBuf, xPortGetFreeHeapSize(), 4U);
+    pBuf = Diag_Put(pBuf, xPortGetMinimumEverFreeHeapSize(), 4U);
+    pBuf = Diag_Put(pBuf, latest, 4U);
+    pBuf = Diag_Put(pBuf, Diag.Dropped, 4U);
+
+    *pBuf++ = DIAG_TLV_COILS;
+    *pBuf++ = DIAG_COILS / 4U;
+    memset(pBuf, 0, DIAG_COILS / 4U);
+    Diag.Pool->ops->mdReadCoilsPacked(Diag.Pool, 0, DIAG_COILS, pBuf);
+    Diag.Pool->ops->mdReadInputCoilsPacked(Diag.Pool, 0, DIAG_COILS, &pBuf[DIAG_COILS / 8U]);
+    pBuf += DIAG_COILS / 4U;
+
+    *pBuf++ = DIAG_TLV_INPUTS;
+    *pBuf++ = 2U + DIAG_REG_SIZE * 2U;
+    pBuf = Diag_Put(pBuf, DIAG_REG_START_ADDR, 2U);
+    Diag.Pool->ops->mdReadInputRegisters(Diag.Pool, DIAG_REG_START_ADDR, DIAG_REG_SIZE, regs);
+    for (uint32_t i = 0; i < DIAG_REG_SIZE; i++)
+    {
+        pBuf = Diag_Put(pBuf, regs[i], 2U);
+    }
+
+    *pBuf++ = DIAG_TLV_SOE;
+    pLen = pBuf++;
+    for (*pLen = 0; (soe != latest) && (*pLen < DIAG_SOE_EVENTS * DIAG_SOE_EVENT_SIZE); *pLen += DIAG_SOE_EVENT_SIZE)
+    {
+        if (!Soe_Read(++soe, &event))
+        {
+            break;
+        }
+        pBuf = Diag_Put(pBuf, event.Sequence, 4U);
+        pBuf = Diag_Put(pBuf, event.Tick, 4U);
+        pBuf = Diag_Put(pBuf, event.Us, 2U);
+        *pBuf++ = event.Point;
+        *pBuf++ = event.Value;
+    }
+
+    Diag.Frame[2] = (uint8_t)(pBuf - &Diag.Frame[3]);
+    crc = mdCrc16(&Diag.Frame[2], (mdU32)(pBuf - &Diag.Frame[2]));
+    pBuf = Diag_Put(pBuf, crc, 2U);
+    if (Shell_Log_Write((char *)Diag.Frame, (unsigned short)(pBuf - Diag.Frame)))
+    {
+        Diag.Soe = soe;
+        Diag.Sequence++;
+    }
+    else
+    {
+        Diag.Dropped++;
+    }
+}
+
+/**
+ * @brief	初始化二进制诊断输出
+ * @details	只创建发送定时器，由 diag 命令启动
+ * @param	Pool 读取快照的寄存器池
+ * @retval	None
+ */
+void Diag_Init(RegisterPoolHandle Pool)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Diag, Diag_Poll, &control);
+
+    Diag.Pool = Pool;
+    Diag_Timer = osTimerCreate(osTimer(Diag), osTimerPeriodic, NULL);
+}
+
+/**
+ * @brief	启动或停止二进制诊断输出
+ * @details	诊断帧与文本输出共用shell输出，上位机按同步字、长度及CRC分帧，跳过其间的文本；
+ *			启动时从最新的SOE事件之后开始发送
+ * @param	Period 发送周期(ms)，为0时停止，小于 DIAG_MIN_PERIOD 时按 DIAG_MIN_PERIOD
+ * @retval	None
+ */
+void Diag_Start(uint32_t Period)
+{
+    if (!Diag_Timer || !Diag.Pool)
+    {
+        return;
+    }
+    osTimerStop(Diag_Timer);
+    Diag.Period = Period ? ((Period < DIAG_MIN_PERIOD) ? DIAG_MIN_PERIOD : Period) : 0;
+    if (Diag.Period)
+    {
+        Diag.Soe = Soe_Latest();
+        Diag.Dropped = 0;
+        osTimerStart(Diag_Timer, Diag.Period);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), diag, Diag_Start, binary diagnostics period);
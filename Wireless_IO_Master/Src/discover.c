@@ -0,0 +1,262 @@
+#include "discover.h"
+#include "L101.h"
+#include "os_port.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+#endif
+
+#if defined(USING_DISCOVER)
+static Discover_HandleTypeDef Discover;
+
+/**
+ * @brief	统计映射表中直接可达的信道
+ * @details	经中继访问的从站收不到信标，结束后留在阻塞集合中按退避探测
+ * @param	None
+ * @retval	None
+ */
+static void Discover_Channels(void)
+{
+    uint16_t addr, next;
+    uint8_t id, ch, other, other_ch, k;
+    bool seen;
+
+    Discover.Channels = 0;
+    for (uint16_t i = 0; L101_Node_At(i, &id, &addr, &ch); i++)
+    {
+        seen = false;
+        for (uint16_t j = 0; !seen && (j < i); j++)
+        {
+            seen = L101_Node_At(j, &other, &next, &other_ch) && (other == id);
+        }
+        if (seen || !L101_Find_Node(id, &next, &other_ch) || (next != addr))
+        {
+            continue;
+        }
+        for (k = 0; (k < Discover.Channels) && (Discover.Channel[k] != ch); k++)
+        {
+        }
+        if (k == Discover.Channels)
+        {
+            Discover.Channel[Discover.Channels] = ch;
+            Discover.Expected[Discover.Channels++] = 0;
+        }
+        Discover.Expected[k]++;
+    }
+}
+
+/**
+ * @brief	开始一个信道的发现
+ * @details	时隙数取该信道从站数的2倍(2的幂)，碰撞概率与从站数无关
+ * @param	None
+ * @retval	None
+ */
+static void Discover_Channel_Begin(void)
+{
+    uint8_t slots = DISCOVER_SLOTS_MIN;
+
+    while ((slots < DISCOVER_SLOTS_MAX) && (slots < 2U * Discover.Expected[Discover.Index]))
+    {
+        slots <<= 1U;
+    }
+    Discover.Slots = slots;
+    Discover.Round = 0;
+    memset(Discover.Heard, 0, sizeof(Discover.Heard));
+    Discover.Heard_Count = 0;
+    Discover.Phase = DISCOVER_BEACON;
+}
+
+/**
+ * @brief	信标发出
+ * @details	广播发出即完成，应答窗口从此时开始
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Discover_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    UNUSED(request);
+    if ((result == MASTER_RESULT_OK) && (Discover.Phase == DISCOVER_BEACON))
+    {
+        Discover.Deadline = Os_Tick() + (uint32_t)Discover.Slots * DISCOVER_SLOT_MS + DISCOVER_GUARD;
+        Discover.Stats.Beacons++;
+        Discover.Phase = DISCOVER_LISTEN;
+    }
+    Discover.Pending = false;
+}
+
+/**
+ * @brief	发出当前信道的信标
+ * @param	None
+ * @retval	None
+ */
+static void Discover_Beacon(void)
+{
+    struct ModbusRTURequest request;
+    uint8_t *p = &Discover.Frame[MASTER_PREFIX_SIZE];
+    uint16_t crc;
+
+    p[0] = MODBUS_BROADCAST_ID;
+    p[1] = MODBUS_CODE_JOIN;
+    p[2] = Discover.Session;
+    p[3] = Discover.Round;
+    p[4] = Discover.Slots;
+    p[5] = DISCOVER_SLOT_MS >> 8U;
+    p[6] = DISCOVER_SLOT_MS & 0xFFU;
+    crc = mdCrc16(p, 2U + DISCOVER_BEACON_SIZE);
+    p[7] = (uint8_t)crc;
+    p[8] = (uint8_t)(crc >> 8U);
+    memset(&request, 0, sizeof(request));
+    request.prefix[0] = L101_BROADCAST_ADDR >> 8U;
+    request.prefix[1] = L101_BROADCAST_ADDR & 0xFFU;
+    request.prefix[2] = Discover.Channel[Discover.Index];
+    request.prefixLength = MASTER_PREFIX_SIZE;
+#if defined(USING_L101_RADIO2)
+    request.port = Radio2_Port(request.prefix[2]);
+#endif
+    request.frame = p;
+    request.frameLength = 2U + DISCOVER_BEACON_SIZE + 2U;
+    request.slaveId = MODBUS_BROADCAST_ID;
+    request.code = MODBUS_CODE_JOIN;
+    request.callback = Discover_Done;
+    Discover.Pending = true;
+    if (!mdRTU_Submit(Client_Object, &request))
+    {
+        Discover.Pending = false;
+    }
+}
+
+/**
+ * @brief	推进发现过程
+ * @details	在调度任务中代替首次上电的逐个扫描:逐个信道广播信标并等待随机时隙内的应答，
+ *			信道上的从站都已应答时提前结束该信道；耗时只与信道数相关，与不在线的从站数无关；
+ *			开启帧认证时不能广播，仍逐个扫描
+ * @param	None
+ * @retval	DISCOVER_RUNNING 进行中 DISCOVER_FINISHED 已结束 DISCOVER_UNAVAILABLE 不可用
+ */
+uint8_t Discover_Poll(void)
+{
+    if (Client_Object == NULL)
+    {
+        return DISCOVER_UNAVAILABLE;
+    }
+#if (MODBUS_AUTH)
+    if (Client_Object->auth != NULL)
+    {
+        return DISCOVER_UNAVAILABLE;
+    }
+#endif
+    switch (Discover.Phase)
+    {
+    case DISCOVER_IDLE:
+        Discover_Channels();
+        Discover.Session++;
+        Discover.Index = 0;
+        Discover.Start = Os_Tick();
+        if (Discover.Channels == 0)
+        {
+            return DISCOVER_FINISHED;
+        }
+        Discover_Channel_Begin();
+        /* fall through */
+    case DISCOVER_BEACON:
+        if (!Discover.Pending)
+        {
+            Discover_Beacon();
+        }
+        return DISCOVER_RUNNING;
+    default:
+        break;
+    }
+    if (((int32_t)(Os_Tick() - Discover.Deadline) < 0) && (Discover.Heard_Count < Discover.Expected[Discover.Index]))
+    {
+        return DISCOVER_RUNNING;
+    }
+    if ((++Discover.Round < DISCOVER_ROUNDS) && (Discover.Heard_Count < Discover.Expected[Discover.Index]))
+    {
+        Discover.Phase = DISCOVER_BEACON;
+        return DISCOVER_RUNNING;
+    }
+    if (++Discover.Index < Discover.Channels)
+    {
+        Discover_Channel_Begin();
+        return DISCOVER_RUNNING;
+    }
+    Discover.Phase = DISCOVER_IDLE;
+    Discover.Stats.Elapsed = Os_Tick() - Discover.Start;
+
+    return DISCOVER_FINISHED;
+}
+
+/**
+ * @brief	处理收到的入网应答
+ * @details	在Modbus任务中对每个CRC正确的接收帧调用；映射表中的从站加入就绪集合，
+ *			不在映射表中的从站记入未映射表
+ * @param	pFrame 从机地址+PDU+CRC
+ * @param	Length 帧长
+ * @retval	true 是入网应答，不再交给主站请求引擎
+ */
+bool Discover_Reply(const uint8_t *pFrame, uint32_t Length)
+{
+    uint8_t id = pFrame[0], ch = Discover.Channel[Discover.Index], i;
+    Discover_Node *pN;
+
+    if ((Length != 2U + DISCOVER_REPLY_SIZE + 2U) || (pFrame[1] != MODBUS_CODE_JOIN))
+    {
+        return false;
+    }
+    if ((Discover.Phase != DISCOVER_LISTEN) || (pFrame[2] != Discover.Session) || (id == MODBUS_BROADCAST_ID))
+    {
+        return true;
+    }
+    Discover.Stats.Replies++;
+    if (Discover.Heard[id >> 3U] & (1U << (id & 0x07U)))
+    {
+        return true;
+    }
+    Discover.Heard[id >> 3U] |= 1U << (id & 0x07U);
+    if (L101_Join(id, ch))
+    {
+        Discover.Heard_Count++;
+        return true;
+    }
+    for (i = 0; (i < Discover.Unknowns) && ((Discover.Unknown[i].Id != id) || (Discover.Unknown[i].Channel != ch)); i++)
+    {
+    }
+    if ((i == Discover.Unknowns) && (Discover.Unknowns < DISCOVER_UNKNOWN))
+    {
+        pN = &Discover.Unknown[Discover.Unknowns++];
+        pN->Id = id;
+        pN->Channel = ch;
+        pN->Inputs = pFrame[4];
+        pN->Outputs = pFrame[5];
+        pN->Analogs = pFrame[6];
+        pN->Units = pFrame[7];
+    }
+    return true;
+}
+
+/**
+ * @brief	打印发现结果及统计
+ * @param	None
+ * @retval	None
+ */
+void Discover_Show(void)
+{
+    Discover_Node *pN;
+
+    shellPrint(&shell, "session = %d, channels = %d, beacons = %u, replies = %u, elapsed = %u ms\r\n",
+               Discover.Session, Discover.Channels, Discover.Stats.Beacons, Discover.Stats.Replies,
+               Discover.Stats.Elapsed);
+    for (uint8_t i = 0; i < Discover.Unknowns; i++)
+    {
+        pN = &Discover.Unknown[i];
+        shellPrint(&shell, "unmapped id = %d, ch = %d, di = %d, do = %d, ai = %d, units = %d\r\n", pN->Id,
+                   pN->Channel, pN->Inputs, pN->Outputs, pN->Analogs, pN->Units);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), discover, Discover_Show, show node discovery);
+#endif
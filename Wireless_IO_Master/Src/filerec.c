@@ -0,0 +1,271 @@
+#include "filerec.h"
+#include "boot.h"
+#include "soe.h"
+#include "string.h"
+#if defined(USING_TREND)
+#include "trend.h"
+#endif
+#if defined(USING_CAPTURE)
+#include "capture.h"
+#endif
+#if defined(USING_RBE)
+#include "rbe.h"
+#endif
+
+#if defined(USING_TREND)
+/*每级趋势占一个文件号*/
+typedef char FileRec_Trend_Check[(FILEREC_TREND + TREND_LEVELS <= FILEREC_CONFIG) ? 1 : -1];
+#endif
+#if defined(USING_RBE)
+/*取模后的序号加上一帧可读的寄存器数仍是合法的记录号*/
+typedef char FileRec_Rbe_Check[(RBE_SEQ_WRAP + MODBUS_FILE_DATA_MAX / 2U <= MODBUS_FILE_RECORDS) ? 1 : -1];
+#endif
+
+/**
+ * @brief	写入一个寄存器(高字节在前)
+ * @param	pData 写入位置
+ * @param	Value 寄存器值
+ * @retval	None
+ */
+static void FileRec_Put(mdU8 *pData, uint16_t Value)
+{
+    pData[0] = HIGH(Value);
+    pData[1] = LOW(Value);
+}
+
+/**
+ * @brief	读事件顺序记录文件
+ * @details	每条事件只读取一次(外部日志中的事件经SPI2读出)，已覆盖或尚未记录的事件读出为0
+ * @param	file 文件号
+ * @param	record 起始记录号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdTRUE
+ */
+static mdSTATUS FileRec_Soe_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    uint32_t latest = Soe_Latest(), cached = UINT32_MAX, k;
+    mdU16 regs[SOE_REG_EVENT_SIZE], index;
+    Soe_Event event;
+
+    UNUSED(file);
+    for (mdU16 i = 0; i < length; i++, data += 2U)
+    {
+        index = record + i;
+        if (index < FILEREC_SOE_HEAD)
+        {
+            FileRec_Put(data, (uint16_t)(index ? latest : (latest >> 16U)));
+            continue;
+        }
+        k = (index - FILEREC_SOE_HEAD) / SOE_REG_EVENT_SIZE;
+        if (k != cached)
+        {
+            memset(regs, 0, sizeof(regs));
+            if ((k < latest) && Soe_Read(latest - k, &event))
+            {
+                Soe_Pack(&event, regs);
+            }
+            cached = k;
+        }
+        FileRec_Put(data, regs[(index - FILEREC_SOE_HEAD) % SOE_REG_EVENT_SIZE]);
+    }
+    return mdTRUE;
+}
+
+#if defined(USING_TREND)
+/**
+ * @brief	读趋势记录文件
+ * @param	file 文件号(FILEREC_TREND + 级号)
+ * @param	record 起始记录号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdTRUE
+ */
+static mdSTATUS FileRec_Trend_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    uint8_t level = (uint8_t)(file - FILEREC_TREND);
+    uint32_t latest = Trend_Latest(level), k, field;
+    const uint16_t head[FILEREC_TREND_HEAD] = {(uint16_t)(latest >> 16U), (uint16_t)latest,
+                                               (uint16_t)(Trend_Period(level) / 1000UL), (uint16_t)Trend_Depth(level)};
+    Trend_Record rec;
+    uint16_t regs[TREND_RECORD_REGS];
+    mdU16 index;
+
+    for (mdU16 i = 0; i < length; i++, data += 2U)
+    {
+        index = record + i;
+        if (index < FILEREC_TREND_HEAD)
+        {
+            FileRec_Put(data, head[index]);
+            continue;
+        }
+        k = (index - FILEREC_TREND_HEAD) / (BOARD_ANALOG_COUNT * TREND_RECORD_REGS);
+        field = (index - FILEREC_TREND_HEAD) % (BOARD_ANALOG_COUNT * TREND_RECORD_REGS);
+        if ((k >= latest) || !Trend_Read(level, (uint8_t)(field / TREND_RECORD_REGS), latest - k, &rec))
+        {
+            rec = (Trend_Record){0};
+        }
+        regs[0] = rec.Min;
+        regs[1] = rec.Max;
+        regs[2] = rec.Avg;
+        regs[3] = rec.Count;
+        FileRec_Put(data, regs[field % TREND_RECORD_REGS]);
+    }
+    return mdTRUE;
+}
+#endif
+
+/**
+ * @brief	读参数文件
+ * @param	file 文件号
+ * @param	record 起始记录号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdTRUE
+ */
+static mdSTATUS FileRec_Config_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    uint8_t value[KV_VALUE_MAX];
+    uint32_t cached = UINT32_MAX, key, offset;
+
+    UNUSED(file);
+    for (mdU16 i = 0; i < length; i++, data += 2U)
+    {
+        key = (uint32_t)(record + i) / FILEREC_CONFIG_REGS;
+        offset = (uint32_t)(record + i) % FILEREC_CONFIG_REGS * 2U;
+        if (key != cached)
+        {
+            memset(value, 0, sizeof(value));
+            if (key != KV_KEY_NONE)
+            {
+                Kv_Get((uint8_t)key, value, sizeof(value));
+            }
+            cached = key;
+        }
+        data[0] = value[offset];
+        data[1] = value[offset + 1U];
+    }
+    return mdTRUE;
+}
+
+/**
+ * @brief	写参数文件
+ * @details	一个子请求写入一个键，参数的使用者在下次加载时读取新值
+ * @param	file 文件号
+ * @param	record 起始记录号(须为键的首个记录)
+ * @param	length 寄存器数
+ * @param	data 请求数据
+ * @retval	mdFALSE:未对齐到键、超出单个参数或写入flash失败
+ */
+static mdSTATUS FileRec_Config_Write(mdU16 file, mdU16 record, mdU16 length, const mdU8 *data)
+{
+    uint32_t key = record / FILEREC_CONFIG_REGS;
+
+    UNUSED(file);
+    if ((record % FILEREC_CONFIG_REGS) || (length > FILEREC_CONFIG_REGS) || (key >= KV_KEY_NONE))
+    {
+        return mdFALSE;
+    }
+    return Kv_Set((uint8_t)key, data, length * 2U) ? mdTRUE : mdFALSE;
+}
+
+#if defined(USING_CAPTURE)
+/**
+ * @brief	读帧捕获文件
+ * @param	file 文件号
+ * @param	record 起始记录号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdTRUE
+ */
+static mdSTATUS FileRec_Capture_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    uint32_t used = Capture_Used(), offset;
+    mdU16 head = (record < FILEREC_CAPTURE_HEAD) ? (FILEREC_CAPTURE_HEAD - record) : 0;
+
+    UNUSED(file);
+    head = (head < length) ? head : length;
+    for (mdU16 i = 0; i < head; i++, data += 2U)
+    {
+        FileRec_Put(data, (uint16_t)((record + i) ? used : (used >> 16U)));
+    }
+    length -= head;
+    offset = (uint32_t)(record + head - FILEREC_CAPTURE_HEAD) * 2U;
+    /*环内剩余的字节之后读出为0(发送缓冲区已清零)*/
+    Capture_Read(offset, data, length * 2U);
+    return mdTRUE;
+}
+#endif
+
+#if defined(USING_RBE)
+/**
+ * @brief	读变化上报文件
+ * @details	记录号为已收到的序号，不是寄存器序号；同一帧中可有多个子请求各自读取
+ * @param	file 文件号
+ * @param	record 已收到的最后一条事件的序号
+ * @param	length 寄存器数
+ * @param	data 应答数据
+ * @retval	mdFALSE:序号超出取模范围
+ */
+static mdSTATUS FileRec_Rbe_Read(mdU16 file, mdU16 record, mdU16 length, mdU8 *data)
+{
+    Rbe_Event events[MODBUS_FILE_DATA_MAX / 2U / FILEREC_RBE_EVENT];
+    uint16_t head[FILEREC_RBE_HEAD], max, count, regs[FILEREC_RBE_EVENT];
+    bool lost;
+
+    UNUSED(file);
+    if (record >= RBE_SEQ_WRAP)
+    {
+        return mdFALSE;
+    }
+    max = (length > FILEREC_RBE_HEAD) ? (uint16_t)((length - FILEREC_RBE_HEAD) / FILEREC_RBE_EVENT) : 0U;
+    max = (max < sizeof(events) / sizeof(events[0])) ? max : (uint16_t)(sizeof(events) / sizeof(events[0]));
+    count = Rbe_Since(record, events, max, &head[1], &head[0], &lost);
+    head[2] = count | (lost ? 0x8000U : 0U);
+    for (mdU16 i = 0; i < length; i++, data += 2U)
+    {
+        if (i < FILEREC_RBE_HEAD)
+        {
+            FileRec_Put(data, head[i]);
+            continue;
+        }
+        memset(regs, 0, sizeof(regs));
+        if ((i - FILEREC_RBE_HEAD) / FILEREC_RBE_EVENT < count)
+        {
+            const Rbe_Event *pEvent = &events[(i - FILEREC_RBE_HEAD) / FILEREC_RBE_EVENT];
+
+            regs[0] = pEvent->Ref;
+            regs[1] = pEvent->Value;
+            regs[2] = (uint16_t)(pEvent->Tick >> 16U);
+            regs[3] = (uint16_t)pEvent->Tick;
+        }
+        FileRec_Put(data, regs[(i - FILEREC_RBE_HEAD) % FILEREC_RBE_EVENT]);
+    }
+    return mdTRUE;
+}
+#endif
+
+/**
+ * @brief	登记文件表
+ * @details	文件表由各从机实例共用(网关的本机从站及主机仿真构建中的从站)，在创建协议栈后调用
+ * @param	None
+ * @retval	None
+ */
+void FileRec_Init(void)
+{
+    mdRTURegisterFile(FILEREC_SOE, FileRec_Soe_Read, NULL);
+#if defined(USING_TREND)
+    for (uint8_t level = 0; level < TREND_LEVELS; level++)
+    {
+        mdRTURegisterFile(FILEREC_TREND + level, FileRec_Trend_Read, NULL);
+    }
+#endif
+    mdRTURegisterFile(FILEREC_CONFIG, FileRec_Config_Read, FileRec_Config_Write);
+#if defined(USING_CAPTURE)
+    mdRTURegisterFile(FILEREC_CAPTURE, FileRec_Capture_Read, NULL);
+#endif
+#if defined(USING_RBE)
+    mdRTURegisterFile(FILEREC_RBE, FileRec_Rbe_Read, NULL);
+#endif
+}
+BOOT_MODULE(filerec, BOOT_LEVEL_MAIN, FileRec_Init, "modbus");
@@ -26,6 +26,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "usart.h"
 #include "shell.h"
 #include "shell_port.h"
 #include "mdrtuslave.h"
@@ -33,19 +34,50 @@
 #include "io_signal.h"
 #include "L101.h"
 #include "io_uart.h"
+#include "os_port.h"
+#include "supervisor.h"
+#include "trace.h"
+#include "mode.h"
+#include "monitor.h"
+#include "stats.h"
+#include "diag.h"
+#include "regwatch.h"
+#if defined(USING_GATEWAY)
+#include "gateway.h"
+#endif
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+#endif
+#include "tim.h"
+#include "Flash.h"
+#include "extlog.h"
+#include "boot.h"
+#if defined(USING_DEFER)
+#include "defer.h"
+#endif
+#if defined(USING_LOGIC)
+#include "logic.h"
+#endif
+#if defined(USING_PULSE)
+#include "pulse.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
-bool g_At = false;
-SHELL_EXPORT_VAR(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_VAR_INT), g_at, &g_At, at_cmd);
 extern void Free_Mode(Shell *shell, char *pData);
 extern bool Check_Mode(ModbusRTUSlaveHandler handler);
+extern bool At_Set_Speed(uint8_t level);
+extern bool At_Set_Power(bool duty, uint16_t wtm);
+extern bool At_Poll(void);
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/*Response deadline (ms) of a received Modbus frame, well inside the host's reply timeout*/
+#define MDBUS_DEADLINE 10U
+/*Step period (ms) of a queued AT job while it waits for the module's reply*/
+#define AT_JOB_POLL 5U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -55,25 +87,88 @@ extern bool Check_Mode(ModbusRTUSlaveHandler handler);
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
-/* USER CODE END Variables */
+/*shell日志发送任务(由 shell_port.c 唤醒)*/
+osThreadId shell_logHandle;
+uint32_t shell_logBuffer[ 128 ];
+osStaticThreadDef_t shell_logControlBlock;
+/*无线调度任务(由 Timer1 按 MDTASK_SENDTIMES 唤醒)*/
+osThreadId radioHandle;
+uint32_t radioBuffer[ 256 ];
+osStaticThreadDef_t radioControlBlock;
 osThreadId shellHandle;
+uint32_t shellBuffer[ 256 ];
+osStaticThreadDef_t shellControlBlock;
 osThreadId atHandle;
+uint32_t atBuffer[ 128 ];
+osStaticThreadDef_t atControlBlock;
 osThreadId mdbusHandle;
+uint32_t mdbusBuffer[ 256 ];
+osStaticThreadDef_t mdbusControlBlock;
 osThreadId read_ioHandle;
+uint32_t read_ioBuffer[ 256 ];
+osStaticThreadDef_t read_ioControlBlock;
+/*flash后台写入任务(由 FLASH_Post 唤醒)*/
+osThreadId flashHandle;
+uint32_t flashBuffer[ 128 ];
+osStaticThreadDef_t flashControlBlock;
+/*外部FRAM日志写入任务(由 Extlog_Write 唤醒)*/
+osThreadId extlogHandle;
+uint32_t extlogBuffer[ 128 ];
+osStaticThreadDef_t extlogControlBlock;
+#if defined(USING_DEFER)
+/*中断下半部任务(由 Defer_Post 唤醒)*/
+osThreadId deferHandle;
+uint32_t deferBuffer[ 128 ];
+osStaticThreadDef_t deferControlBlock;
+#endif
+#if defined(USING_LOGIC)
+/*本机逻辑扫描任务(按 LOGIC_PERIOD 周期运行)*/
+osThreadId logicHandle;
+uint32_t logicBuffer[ 128 ];
+osStaticThreadDef_t logicControlBlock;
+#endif
+#if defined(USING_GATEWAY)
+osThreadId gatewayHandle;
+uint32_t gatewayBuffer[ 128 ];
+osStaticThreadDef_t gatewayControlBlock;
+#endif
+#if defined(USING_L101_RADIO2)
+osThreadId radio2Handle;
+uint32_t radio2Buffer[ 128 ];
+osStaticThreadDef_t radio2ControlBlock;
+#endif
+
+/* USER CODE END Variables */
 osTimerId Timer1Handle;
+osStaticTimerDef_t Timer1ControlBlock;
 osMutexId shellMutexHandle;
-osSemaphoreId ReciveHandle;
+osStaticMutexDef_t shellMutexControlBlock;
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
-
-/* USER CODE END FunctionPrototypes */
-
 void Shell_Task(void const * argument);
 void At_Task(void const * argument);
 void Mdbus_Task(void const * argument);
 void Read_Io_Task(void const * argument);
+void Radio_Task(void const * argument);
+void Flash_Task(void const * argument);
+void Extlog_Task(void const * argument);
+void Boot_Task(void const * argument);
+#if defined(USING_DEFER)
+void Defer_Task(void const * argument);
+#endif
+#if defined(USING_LOGIC)
+void Logic_Task(void const * argument);
+#endif
+#if defined(USING_GATEWAY)
+void Gateway_Task(void const * argument);
+#endif
+#if defined(USING_L101_RADIO2)
+void Radio2_Task(void const * argument);
+#endif
+
+/* USER CODE END FunctionPrototypes */
+
 void Timer_Callback(void const * argument);
 
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
@@ -85,15 +180,36 @@ void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackTy
 void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize );
 
 /* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
 void vApplicationStackOverflowHook(xTaskHandle xTask, signed char *pcTaskName);
 
+/* USER CODE BEGIN 1 */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+/*The DWT cycle counter runs at the core clock and wraps after about 59 s;
+  the monitor only uses differences over one sampling period*/
+void configureTimerForRunTimeStats(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  return DWT->CYCCNT;
+}
+/* USER CODE END 1 */
+
 /* USER CODE BEGIN 4 */
 __weak void vApplicationStackOverflowHook(xTaskHandle xTask, signed char *pcTaskName)
 {
   /* Run time stack overflow checking is performed if
   configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2. This hook function is
   called if a stack overflow is detected. */
-  shellPrint(&shell, "%s is stack overflow!\r\n", pcTaskName);
+  /* The stack is already corrupt: keep the task name in retained RAM and reset */
+  UNUSED(xTask);
+  Supervisor_Fault((const char *)pcTaskName, SUPERVISOR_FAULT_STACK);
 }
 /* USER CODE END 4 */
 
@@ -134,73 +250,128 @@ void MX_FREERTOS_Init(void) {
   /* USER CODE END Init */
   /* Create the mutex(es) */
   /* definition and creation of shellMutex */
-  osMutexDef(shellMutex);
+  osMutexStaticDef(shellMutex, &shellMutexControlBlock);
   shellMutexHandle = osMutexCreate(osMutex(shellMutex));
 
   /* USER CODE BEGIN RTOS_MUTEX */
   /* add mutexes, ... */
   /* USER CODE END RTOS_MUTEX */
 
-  /* Create the semaphores(s) */
-  /* definition and creation of Recive */
-  osSemaphoreDef(Recive);
-  ReciveHandle = osSemaphoreCreate(osSemaphore(Recive), 1);
-
   /* USER CODE BEGIN RTOS_SEMAPHORES */
   /* add semaphores, ... */
   /* USER CODE END RTOS_SEMAPHORES */
 
   /* Create the timer(s) */
   /* definition and creation of Timer1 */
-  osTimerDef(Timer1, Timer_Callback);
+  osTimerStaticDef(Timer1, Timer_Callback, &Timer1ControlBlock);
   Timer1Handle = osTimerCreate(osTimer(Timer1), osTimerPeriodic, NULL);
 
   /* USER CODE BEGIN RTOS_TIMERS */
   /* start timers, add new ones, ... */
+  /*Feed the external watchdog only while every registered task checks in*/
+  Supervisor_Init();
+  /*Per-task CPU load and stack margin for the top command and input registers*/
+  Monitor_Init(Master_Object->registerPool);
+  /*Frame, error and per-slave counters for fleet link monitoring*/
+  Stats_Init(Master_Object->registerPool);
+  /*Binary diagnostic frames, started by the diag command*/
+  Diag_Init(Master_Object->registerPool);
+  /*Register change watch, started by the regwatch command*/
+  Regwatch_Init(Master_Object->registerPool);
+#if defined(USING_LOGIC)
+  /*Local logic program from the parameter store, scanned by the logic task*/
+  Logic_Init();
+#endif
+#if defined(USING_GATEWAY)
+  /*Routes of the RS-485 to L101 gateway*/
+  Gateway_Init();
+#endif
+#if defined(USING_PULSE)
+  /*Inputs in counter mode, counted by the edge interrupt from here on*/
+  Pulse_Init();
+#endif
   /* USER CODE END RTOS_TIMERS */
 
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
   /* USER CODE END RTOS_QUEUES */
 
-  /* Create the thread(s) */
-  /* definition and creation of shell */
-  osThreadDef(shell, Shell_Task, osPriorityBelowNormal, 0, 256);
-  shellHandle = osThreadCreate(osThread(shell), (void*) &shell);
-
-  /* definition and creation of at */
-  osThreadDef(at, At_Task, osPriorityLow, 0, 128);
-  atHandle = osThreadCreate(osThread(at), (void*) &shell);
-
-  /* definition and creation of mdbus */
-  osThreadDef(mdbus, Mdbus_Task, osPriorityNormal, 0, 256);
-  mdbusHandle = osThreadCreate(osThread(mdbus), NULL);
-
-  /* definition and creation of read_io */
-  osThreadDef(read_io, Read_Io_Task, osPriorityAboveNormal, 0, 256);
-  read_ioHandle = osThreadCreate(osThread(read_io), NULL);
-
   /* USER CODE BEGIN RTOS_THREADS */
-  osTimerStart(Timer1Handle, MDTASK_SENDTIMES);
-  /*Suspend shell task*/
-#if defined(USING_L101)
-  osThreadSuspend(shellHandle);
+  /*Rate-monotonic task table: the tighter the deadline, the higher the priority.
+    Period, deadline and heartbeat timeout in ms, 0 where a constraint does not apply*/
+  static const Supervisor_Entry table[] = {
+#if defined(USING_DEFER)
+      /*Bottom halves of the ADC and analog watchdog interrupts, above every task they feed*/
+      {{"defer", Defer_Task, osPriorityHigh, 0, 128, deferBuffer, &deferControlBlock},
+       NULL, &deferHandle, 0, 0, 0},
+#endif
+      {{"read_io", Read_Io_Task, osPriorityAboveNormal, 0, 256, read_ioBuffer, &read_ioControlBlock},
+       NULL, &read_ioHandle, 0, DIGITAL_DEBOUNCE_TIME, SUPERVISOR_DEADLINE},
+#if defined(USING_LOGIC)
+      /*Fixed-period scan: the deadline is the scan period*/
+      {{"logic", Logic_Task, osPriorityAboveNormal, 0, 128, logicBuffer, &logicControlBlock},
+       NULL, &logicHandle, LOGIC_PERIOD, 0, SUPERVISOR_DEADLINE},
+#endif
+      {{"mdbus", Mdbus_Task, osPriorityNormal, 0, 256, mdbusBuffer, &mdbusControlBlock},
+       NULL, &mdbusHandle, 0, MDBUS_DEADLINE, SUPERVISOR_DEADLINE},
+      /*Master_Poll runs here rather than in the timer service, which only sets the cadence*/
+      {{"radio", Radio_Task, osPriorityBelowNormal, 0, 256, radioBuffer, &radioControlBlock},
+       NULL, &radioHandle, MDTASK_SENDTIMES, 0, SUPERVISOR_DEADLINE},
+#if defined(USING_GATEWAY)
+      /*Receives on the soft UART; the radio task submits the frames*/
+      {{"gateway", Gateway_Task, osPriorityBelowNormal, 0, 128, gatewayBuffer, &gatewayControlBlock},
+       NULL, &gatewayHandle, 0, 0, SUPERVISOR_DEADLINE},
+#endif
+#if defined(USING_L101_RADIO2)
+      /*Second L101 on the soft UART; the radio task hands it requests through the master engine*/
+      {{"radio2", Radio2_Task, osPriorityBelowNormal, 0, 128, radio2Buffer, &radio2ControlBlock},
+       NULL, &radio2Handle, 0, 0, SUPERVISOR_DEADLINE},
 #endif
+      {{"shell", Shell_Task, osPriorityLow, 0, 256, shellBuffer, &shellControlBlock},
+       &shell, &shellHandle, 0, 0, 0},
+      {{"at", At_Task, osPriorityLow, 0, 128, atBuffer, &atControlBlock},
+       &shell, &atHandle, 0, 0, 0},
+      /*Page erases run from RAM here, the savers only queue a request*/
+      {{"flash", Flash_Task, osPriorityLow, 0, 128, flashBuffer, &flashControlBlock},
+       NULL, &flashHandle, 0, 0, 0},
+      /*SOE, counter snapshots and retained state go to the FRAM from here, the writers only queue the record*/
+      {{"extlog", Extlog_Task, osPriorityLow, 0, 128, extlogBuffer, &extlogControlBlock},
+       NULL, &extlogHandle, 0, 0, 0},
+      /*Drain the asynchronous shell log at the lowest priority*/
+      {{"shell_log", Shell_Log_Task, osPriorityIdle, 0, 128, shell_logBuffer, &shell_logControlBlock},
+       NULL, &shell_logHandle, 0, 0, 0},
+  };
+
+  Supervisor_Create(table, sizeof(table) / sizeof(table[0]));
+  /*The deferred boot stage runs behind the input task; the stack goes back to the heap when it ends*/
+  osThreadDef(boot, Boot_Task, osPriorityBelowNormal, 0, 256);
+  osThreadCreate(osThread(boot), NULL);
+  osTimerStart(Timer1Handle, MDTASK_SENDTIMES);
+  /*Park the tasks that do not own the UART in run mode*/
+  Mode_Init();
   /* add threads, ... */
   /* USER CODE END RTOS_THREADS */
 
 }
 
-/* USER CODE BEGIN Header_Shell_Task */
+/* Timer_Callback function */
+void Timer_Callback(void const * argument)
+{
+  /* USER CODE BEGIN Timer_Callback */
+  /*Keep the timer service short: the radio task does the actual transmit*/
+  osSignalSet(radioHandle, L101_SIGNAL_POLL);
+  /* USER CODE END Timer_Callback */
+}
+
+/* Private application code --------------------------------------------------*/
+/* USER CODE BEGIN Application */
 /**
  * @brief  Function implementing the shell thread.
  * @param  argument: Not used
  * @retval None
  */
-/* USER CODE END Header_Shell_Task */
 void Shell_Task(void const * argument)
 {
-  /* USER CODE BEGIN Shell_Task */
   /* Infinite loop */
   for (;;)
   {
@@ -210,74 +381,91 @@ void Shell_Task(void const * argument)
 #endif
     shellTask((void *)argument);
   }
-  /* USER CODE END Shell_Task */
 }
 
-/* USER CODE BEGIN Header_At_Task */
 /**
  * @brief Function implementing the at thread.
  * @param argument: Not used
  * @retval None
  */
-/* USER CODE END Header_At_Task */
 void At_Task(void const * argument)
 {
-  /* USER CODE BEGIN At_Task */
   char recv_data = '\0';
-  // static uint16_t counter = 0;
+  /*The first pass picks up a power profile restored from flash*/
+  uint32_t signals = MODE_SIGNAL_LINK | MODE_SIGNAL_POWER;
+  /*The AT jobs address the node list and the retained link speed*/
+  Boot_Wait();
   /* Infinite loop */
   for (;;)
   {
 #if defined(USING_DEBUG)
-    // uint8_t data = 0;
-    // extern L101_HandleTypeDef L101_Map[EXTERN_DIGITAL_MAX];
-    // L101_Map[0].Check.State = L_OK;
-    // L101_Map[1].Check.State = L_OK;
-    // L101_Map[7].Check.State = L_OK;
-    // HAL_SUART_Receive(&S_Uart1, &data, 1, 0x10);
-    // shellPrint(&shell, "flag = %d,Recv_Data = 0x%02x.\r\n", S_Uart1.Rx.Finsh_Flag, data);
-    // S_Uart1.Rx.Finsh_Flag = false;
-    // osDelay(1000);
-
-    if (g_At)
+    if (signals & MODE_SIGNAL_FREE)
+    {
+      /*Hand the UART to the AT engine; only the conflicting tasks are parked*/
+      if (Mode_Enter(MODE_CONFIG))
+      {
+        Free_Mode((Shell *)argument, &recv_data);
+        Mode_Leave();
+      }
+    }
+#endif
+#if defined(USING_L101_AUTO_SPD)
+    /*链路管理要求改变速率等级*/
+    if ((signals & MODE_SIGNAL_LINK) && (L101_Link_Target() != L101_Link_Speed()))
     {
-      /*Suspend mdbushandle task*/
-      osThreadSuspendAll();
-      osTimerStop(Timer1Handle);
-      g_At = false;
-      Free_Mode((Shell *)argument, &recv_data);
-      /*Restore mdbushandle task*/
-      osThreadResumeAll();
-      osTimerStart(Timer1Handle, MDTASK_SENDTIMES);
+      /*The job reports back through L101_Link_Applied(); a rejected job keeps the current speed*/
+      if (!At_Set_Speed(L101_Link_Target()))
+      {
+        L101_Link_Applied(L101_Link_Speed());
+      }
     }
 #endif
-    // at_process(&at);
-    osDelay(5);
+#if defined(USING_L101)
+    bool duty;
+    uint16_t wtm;
+    /*A new network power profile is queued for the Master module*/
+    if ((signals & MODE_SIGNAL_POWER) && L101_Power_Pending(&duty, &wtm) && !At_Set_Power(duty, wtm))
+    {
+      L101_Power_Applied(false);
+    }
+#endif
+    /*Step queued AT jobs without blocking on replies; sleep until a request arrives once idle*/
+    signals = Os_Signal_Wait(MODE_SIGNAL_FREE | MODE_SIGNAL_LINK | MODE_SIGNAL_POWER | MODE_SIGNAL_JOB,
+                             At_Poll() ? AT_JOB_POLL : OS_WAIT_FOREVER);
   }
-  /* USER CODE END At_Task */
 }
 
-/* USER CODE BEGIN Header_Mdbus_Task */
 /**
  * @brief Function implementing the mdbus thread.
  * @param argument: Not used
  * @retval None
  */
-/* USER CODE END Header_Mdbus_Task */
 void Mdbus_Task(void const * argument)
 {
-  /* USER CODE BEGIN Mdbus_Task */
+  uint8_t dog = Supervisor_Self();
+  /*Replies go out through the L101 hooks installed by Slist_Init(); received frames stay pending meanwhile*/
+  Boot_Wait();
   /* Infinite loop */
   for (;;)
   {
     /*https://www.cnblogs.com/w-smile/p/11333950.html*/
-    if (osOK == osSemaphoreWait(ReciveHandle, osWaitForever))
+    /*Woken by a direct task notification from the receive interrupt; the bounded wait
+      lets an idle bus still check in with the supervisor*/
+    uint32_t signals = Os_Signal_Wait(MODBUS_SIGNAL_RX, SUPERVISOR_CHECKIN_TIME);
+
+    Supervisor_Checkin(dog);
+    if (signals)
     {
+      TRACE(TRACE_MODBUS_WAKE);
+      Supervisor_Activate(dog);
+      /*Assemble the spans published by the receive interrupt into Modbus frames*/
+      Uart_Dma_Rx_Dispatch(&Uart1_Dma);
 #if defined(USING_L101)
       Check_Mode(Master_Object) ? mdRTU_Handler(Master_Object) : Shell_Mode();
 #else
       mdRTU_Handler(Master_Object);
 #endif
+      Supervisor_Complete(dog);
 #if defined(USING_DEBUG)
       shellWriteEndLine(&shell, "Received a data!\r\n", 19U);
       // shellPrint(&shell, "Received a data!\r\n");
@@ -294,39 +482,229 @@ void Mdbus_Task(void const * argument)
 
     // osDelay(10);
   }
-  /* USER CODE END Mdbus_Task */
 }
 
-/* USER CODE BEGIN Header_Read_Io_Task */
 /**
  * @brief Function implementing the read_io thread.
  * @param argument: Not used
  * @retval None
  */
-/* USER CODE END Header_Read_Io_Task */
 void Read_Io_Task(void const * argument)
 {
-  /* USER CODE BEGIN Read_Io_Task */
+  /*Take the initial input state once, afterwards only edges are processed*/
+  Io_Digital_Handle();
+  Boot_Mark(BOOT_MARK_INPUT);
+  uint8_t dog = Supervisor_Self();
   /* Infinite loop */
   for (;;)
   {
-    Io_Digital_Handle();
-    Io_Analog_Handle();
-    osDelay(50);
+    /*Sleep until the next edge or a settling input; analog values are published by the ADC DMA interrupt*/
+    uint32_t wait = Io_Digital_Debounce();
+#if defined(USING_PULSE)
+    /*Counter inputs only need the periodic frequency update*/
+    uint32_t update = Pulse_Update();
+
+    wait = (update < wait) ? update : wait;
+#endif
+    /*The edges of the previous activation are processed by the debounce pass above*/
+    Supervisor_Complete(dog);
+    uint32_t signals = Os_Signal_Wait(IO_SIGNAL_EDGE | IO_SIGNAL_CAL, (wait < SUPERVISOR_CHECKIN_TIME) ? wait : SUPERVISOR_CHECKIN_TIME);
+
+    Supervisor_Checkin(dog);
+    Supervisor_Activate(dog);
+    /*Calibration commands written over Modbus are handled here; a save only queues the flash write*/
+    if (signals & IO_SIGNAL_CAL)
+    {
+      Io_Analog_Cal_Command();
+    }
   }
-  /* USER CODE END Read_Io_Task */
 }
 
-/* Timer_Callback function */
-void Timer_Callback(void const * argument)
+/**
+ * @brief  Function implementing the radio scheduler thread.
+ * @note   Timer1 only signals the poll cadence, so building and sending frames no longer
+ *         blocks the other software timers; stopping Timer1 still pauses polling
+ * @param  argument: Not used
+ * @retval None
+ */
+void Radio_Task(void const * argument)
 {
-  /* USER CODE BEGIN Timer_Callback */
-  Master_Poll();
-  /* USER CODE END Timer_Callback */
+  uint8_t dog = Supervisor_Self();
+  /*Polling starts once the node list is restored*/
+  Boot_Wait();
+  /* Infinite loop */
+  for (;;)
+  {
+    /*The bounded wait keeps checking in while Timer1 is stopped for AT configuration*/
+    uint32_t signals = Os_Signal_Wait(L101_SIGNAL_POLL | L101_SIGNAL_FREE, SUPERVISOR_CHECKIN_TIME);
+
+    Supervisor_Checkin(dog);
+    if (signals)
+    {
+      Supervisor_Activate(dog);
+      /*A "SEND OK" report frees the radio before the next tick; only the tick advances the heartbeat*/
+      (signals & L101_SIGNAL_POLL) ? Master_Poll() : Master_Kick();
+      Boot_Mark(BOOT_MARK_RADIO);
+      Supervisor_Complete(dog);
+#if defined(USING_L101_AUTO_SPD)
+      /*The speed level is rewritten by the at task*/
+      if (L101_Link_Target() != L101_Link_Speed())
+      {
+        Mode_Request(MODE_SIGNAL_LINK);
+      }
+#endif
+    }
+  }
 }
 
-/* Private application code --------------------------------------------------*/
-/* USER CODE BEGIN Application */
+/**
+ * @brief  Function implementing the flash writer thread.
+ * @note   Erases and programs the queued records one page at a time; the critical
+ *         interrupts keep running from RAM while the flash is busy
+ * @param  argument: Not used
+ * @retval None
+ */
+void Flash_Task(void const * argument)
+{
+  /* Infinite loop */
+  for (;;)
+  {
+    FLASH_Process(osWaitForever);
+  }
+}
+
+/**
+ * @brief  Function implementing the external log thread.
+ * @note   Writes the queued records to the SPI2 FRAM in order; readers share the bus through its lock
+ * @param  argument: Not used
+ * @retval None
+ */
+void Extlog_Task(void const * argument)
+{
+  /* Infinite loop */
+  for (;;)
+  {
+    Extlog_Process(osWaitForever);
+  }
+}
+
+#if defined(USING_DEFER)
+/**
+ * @brief  Function implementing the deferred interrupt work thread.
+ * @note   Runs the handlers the interrupts posted, one coalesced run per source
+ * @param  argument: Not used
+ * @retval None
+ */
+void Defer_Task(void const * argument)
+{
+  /* Infinite loop */
+  for (;;)
+  {
+    Defer_Process(osWaitForever);
+  }
+}
+#endif
+
+#if defined(USING_LOGIC)
+/**
+ * @brief  Function implementing the local logic thread.
+ * @note   Released every LOGIC_PERIOD ms by osDelayUntil (vTaskDelayUntil), so the scan start does not drift
+ *         with the scan time; without a valid program it waits for logic_add/logic_del
+ * @param  argument: Not used
+ * @retval None
+ */
+void Logic_Task(void const * argument)
+{
+  uint8_t dog = Supervisor_Self();
+  uint32_t wake = Os_Tick();
+  /* Infinite loop */
+  for (;;)
+  {
+    if (!Logic_Ready())
+    {
+      Os_Signal_Wait(LOGIC_SIGNAL_LOAD, SUPERVISOR_CHECKIN_TIME);
+      Supervisor_Checkin(dog);
+      wake = Os_Tick();
+      continue;
+    }
+    osDelayUntil(&wake, LOGIC_PERIOD);
+    Supervisor_Checkin(dog);
+    Supervisor_Activate(dog);
+    Logic_Scan();
+    Supervisor_Complete(dog);
+  }
+}
+#endif
+
+/**
+ * @brief  Function implementing the boot thread.
+ * @note   Created after the task table: recovers the FRAM log and brings up the radio side
+ *         (Boot_Stage) while the inputs are already sampled, then releases the waiting tasks and ends
+ * @param  argument: Not used
+ * @retval None
+ */
+void Boot_Task(void const * argument)
+{
+  Boot_Stage();
+  Boot_Done();
+  osThreadTerminate(NULL);
+}
+
+#if defined(USING_GATEWAY)
+/**
+ * @brief  Function implementing the gateway thread.
+ * @note   The first byte wait is short so that finished replies are sent back promptly
+ * @param  argument: Not used
+ * @retval None
+ */
+void Gateway_Task(void const * argument)
+{
+  uint8_t dog = Supervisor_Self();
+  /*The soft UART comes up in the boot stage*/
+  Boot_Wait();
+  /* Infinite loop */
+  for (;;)
+  {
+    Supervisor_Checkin(dog);
+    Gateway_Process(GATEWAY_POLL);
+  }
+}
+#endif
+
+#if defined(USING_L101_RADIO2)
+/**
+ * @brief  Function implementing the radio2 thread.
+ * @note   The first byte wait is short so that queued requests go out promptly
+ * @param  argument: Not used
+ * @retval None
+ */
+void Radio2_Task(void const * argument)
+{
+  uint8_t dog = Supervisor_Self();
+  /*The soft UART comes up in the boot stage*/
+  Boot_Wait();
+  /* Infinite loop */
+  for (;;)
+  {
+    Supervisor_Checkin(dog);
+    Radio2_Process(RADIO2_POLL);
+  }
+}
+#endif
+
+/**
+ * @brief  Gate the hardware watchdog feed
+ * @note   TIM2 CH4 PWM toggles WDT_Pin; stopping it on a stalled task lets the external watchdog reset the board
+ * @param  Healthy: false once a supervised task missed its deadline
+ * @retval None
+ */
+void Supervisor_Feed(bool Healthy)
+{
+  if (!Healthy)
+  {
+    HAL_TIM_PWM_Stop(&htim2, TIM_CHANNEL_4);
+  }
+}
 
 /* USER CODE END Application */
 
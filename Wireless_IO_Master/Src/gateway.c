@@ -0,0 +1,390 @@
+#include "gateway.h"
+#include "L101.h"
+#include "io_uart.h"
+#include "kv.h"
+#include "os_port.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_GATEWAY)
+#if !defined(USING_IO_UART)
+#error "USING_GATEWAY needs the soft uart, enable USING_IO_UART"
+#endif
+
+typedef char Gateway_Route_Size_Check[(sizeof(Gateway_Route) * GATEWAY_ROUTES <= KV_VALUE_MAX) ? 1 : -1];
+
+extern Os_Thread radioHandle;
+
+static Gateway_HandleTypeDef Gateway;
+
+/**
+ * @brief	重新计算帧尾CRC
+ * @param	pFrame 从机地址+PDU+CRC
+ * @param	Length 整帧长度
+ * @retval	None
+ */
+static void Gateway_Crc(uint8_t *pFrame, uint16_t Length)
+{
+    uint16_t crc = mdCrc16(pFrame, Length - 2U);
+
+    pFrame[Length - 2U] = (uint8_t)crc;
+    pFrame[Length - 1U] = (uint8_t)(crc >> 8U);
+}
+
+/**
+ * @brief	在帧槽中构造异常应答并等待回送
+ * @param	pS 帧槽
+ * @param	Code 请求的功能码
+ * @param	Exception 异常码
+ * @retval	None
+ */
+static void Gateway_Exception(Gateway_Slot *pS, uint8_t Code, uint8_t Exception)
+{
+    uint8_t *p = &pS->Buf[MASTER_PREFIX_SIZE];
+
+    p[0] = pS->Unit;
+    p[1] = Code | 0x80U;
+    p[2] = Exception;
+    Gateway_Crc(p, 5U);
+    pS->Length = 5U;
+    pS->State = GATEWAY_REPLY;
+}
+
+/**
+ * @brief	查找本地从站号的路由
+ * @details	先查显式路由表，没有条目时按节点映射表(从站号不变)转发
+ * @param	pS 帧槽，找到时写入目标地址及信道
+ * @param	Unit 本地从站号
+ * @param	pSlave 远端从站号
+ * @retval	true 找到
+ */
+static bool Gateway_Find(Gateway_Slot *pS, uint8_t Unit, uint8_t *pSlave)
+{
+    for (uint8_t i = 0; i < GATEWAY_ROUTES; i++)
+    {
+        if (Gateway.Route[i].Valid && (Gateway.Route[i].Unit == Unit))
+        {
+            pS->Addr = Gateway.Route[i].Addr;
+            pS->Channel = Gateway.Route[i].Channel;
+            *pSlave = Gateway.Route[i].Slave;
+            return true;
+        }
+    }
+    *pSlave = Unit;
+
+    return (Unit != MODBUS_BROADCAST_ID) && L101_Find_Node(Unit, &pS->Addr, &pS->Channel);
+}
+
+/**
+ * @brief	转发请求完成
+ * @details	在接收任务或轮询调用者的上下文中执行：应答拷贝回帧槽并改回本地从站号，
+ *			远端的异常应答原样回送，超时及错误时回送网关目标无响应异常
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Gateway_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    Gateway_Slot *pS = (Gateway_Slot *)request->arg;
+    uint8_t *p = &pS->Buf[MASTER_PREFIX_SIZE];
+
+    if (request->slaveId == MODBUS_BROADCAST_ID)
+    {
+        pS->State = GATEWAY_FREE;
+        return;
+    }
+    if ((result == MASTER_RESULT_OK) && (request->reply != NULL) && (request->replyLength <= MODBUS_PDU_SIZE_MAX))
+    {
+        memcpy(p, request->reply, request->replyLength);
+        pS->Length = request->replyLength;
+        if (p[0] != pS->Unit)
+        {
+            p[0] = pS->Unit;
+            Gateway_Crc(p, pS->Length);
+        }
+        pS->State = GATEWAY_REPLY;
+        return;
+    }
+    (result == MASTER_RESULT_TIMEOUT) ? Gateway.Stats.Timeout++ : Gateway.Stats.Error++;
+    Gateway_Exception(pS, request->code, GATEWAY_EXCEPTION_TARGET);
+}
+
+/**
+ * @brief	接收一帧
+ * @details	等待首字节至多 Wait ms，之后字节间隔超过 GATEWAY_FRAME_GAP 时帧结束；超出 Size 的字节丢弃
+ * @param	pBuf 缓冲区
+ * @param	Size 缓冲区字节数
+ * @param	Wait 首字节等待时间(ms)
+ * @retval	收到的字节数(可大于 Size)，0:没有数据
+ */
+static uint16_t Gateway_Receive(uint8_t *pBuf, uint16_t Size, uint32_t Wait)
+{
+    uint16_t len = 0;
+    uint8_t data;
+
+    if (HAL_SUART_Receive(&S_Uart1, &data, 1U, Wait) != HAL_OK)
+    {
+        return 0;
+    }
+    do
+    {
+        if (len < Size)
+        {
+            pBuf[len] = data;
+        }
+        len = (len < 0xFFFFU) ? (len + 1U) : len;
+    } while (HAL_SUART_Receive(&S_Uart1, &data, 1U, GATEWAY_FRAME_GAP) == HAL_OK);
+
+    return len;
+}
+
+/**
+ * @brief	本机从站的发送底层接口
+ * @details	在网关任务中由协议栈同步调用：应答拷贝进当前帧槽，下一次 Gateway_Process 时回送
+ * @param	handler 本机从站协议栈
+ * @param	data 应答
+ * @param	length 长度
+ * @retval	mdTRUE 成功
+ */
+static mdSTATUS Gateway_Local_Pop(ModbusRTUSlaveHandler handler, mdU8 *data, mdU32 length)
+{
+    Gateway_Slot *pS = Gateway.Local_Slot;
+
+    if ((pS == NULL) || (length > MODBUS_PDU_SIZE_MAX))
+    {
+        return mdFALSE;
+    }
+    memcpy(&pS->Buf[MASTER_PREFIX_SIZE], data, length);
+    pS->Length = (uint16_t)length;
+    pS->State = GATEWAY_REPLY;
+
+    return mdTRUE;
+}
+
+/**
+ * @brief	加载网关路由表并创建本机从站
+ * @details	本机从站与主站协议栈共用寄存器池，只另占一个接收帧环
+ * @param	None
+ * @retval	None
+ */
+void Gateway_Init(void)
+{
+    struct ModbusRTUSlaveRegisterInfo info = {0};
+    ModbusRTUSlaveHandler *pHandler = &Gateway.Local;
+
+    if (Kv_Get(KV_KEY_GATEWAY, Gateway.Route, sizeof(Gateway.Route)) != sizeof(Gateway.Route))
+    {
+        memset(Gateway.Route, 0, sizeof(Gateway.Route));
+    }
+    if ((GATEWAY_LOCAL_ID != MODBUS_BROADCAST_ID) && (Master_Object != NULL))
+    {
+        info.slaveId = GATEWAY_LOCAL_ID;
+        info.usartBaudRate = User_BaudRate;
+        info.mdRTUPopChar = Gateway_Local_Pop;
+        info.registerPool = Master_Object->registerPool;
+        mdCreateModbusRTUSlave(pHandler, info);
+    }
+}
+
+/**
+ * @brief	网关一次收发
+ * @details	在网关任务中执行：先回送已完成的应答，再在空闲帧槽中接收软件串口上的请求；
+ *			请求就地改写从站号后交给调度任务提交，没有路由时回送网关路径不可用异常，
+ *			帧槽用尽时丢弃请求(本地主站超时重发)
+ * @param	Wait 首字节等待时间(ms)
+ * @retval	None
+ */
+void Gateway_Process(uint32_t Wait)
+{
+    Gateway_Slot *pS = NULL;
+    uint8_t scratch[4], slave, *p;
+    uint16_t len;
+
+    for (uint8_t i = 0; i < GATEWAY_SLOTS; i++)
+    {
+        if (Gateway.Slot[i].State == GATEWAY_REPLY)
+        {
+            HAL_SUART_Transmit(&S_Uart1, &Gateway.Slot[i].Buf[MASTER_PREFIX_SIZE], Gateway.Slot[i].Length,
+                               GATEWAY_TIMEOUT);
+            Gateway.Stats.Tx++;
+            Gateway.Slot[i].State = GATEWAY_FREE;
+        }
+        if ((pS == NULL) && (Gateway.Slot[i].State == GATEWAY_FREE))
+        {
+            pS = &Gateway.Slot[i];
+        }
+    }
+    p = pS ? &pS->Buf[MASTER_PREFIX_SIZE] : scratch;
+    len = Gateway_Receive(p, pS ? MODBUS_PDU_SIZE_MAX : sizeof(scratch), Wait);
+    if (len == 0)
+    {
+        return;
+    }
+    Gateway.Stats.Rx++;
+    if (pS == NULL)
+    {
+        Gateway.Stats.Busy++;
+        return;
+    }
+    /*正确帧连同CRC计算的结果为0*/
+    if ((len < 4U) || (len > MODBUS_PDU_SIZE_MAX) || mdCrc16(p, len))
+    {
+        Gateway.Stats.Bad_Frame++;
+        return;
+    }
+    pS->Unit = p[0];
+    pS->Length = len;
+    if ((Gateway.Local != NULL) && (p[0] == GATEWAY_LOCAL_ID))
+    {
+        /*本机请求在网关任务中直接处理，广播及出错的请求不应答，帧槽保持空闲*/
+        Gateway.Stats.Local++;
+        Gateway.Local_Slot = pS;
+        Gateway.Local->portRTUPushString(Gateway.Local, p, len);
+        mdRTU_Handler(Gateway.Local);
+        Gateway.Local_Slot = NULL;
+        return;
+    }
+    if (!Gateway_Find(pS, p[0], &slave))
+    {
+        /*广播请求不应答*/
+        if (p[0] != MODBUS_BROADCAST_ID)
+        {
+            Gateway.Stats.No_Route++;
+            Gateway_Exception(pS, p[1], GATEWAY_EXCEPTION_PATH);
+        }
+        return;
+    }
+    if (slave != p[0])
+    {
+        p[0] = slave;
+        Gateway_Crc(p, len);
+    }
+    pS->State = GATEWAY_READY;
+    /*不等下一个调度节拍*/
+    Os_Signal_Set(radioHandle, L101_SIGNAL_FREE);
+}
+
+/**
+ * @brief	提交待转发的请求
+ * @details	在调度任务中执行(请求引擎只由该任务提交)：帧槽缓冲区直接作为透传请求，
+ *			前缀写入预留区后整帧发出，不经过请求队列及发送队列的拷贝
+ * @param	None
+ * @retval	None
+ */
+void Gateway_Submit(void)
+{
+    struct ModbusRTURequest request;
+    Gateway_Slot *pS;
+
+    if (Client_Object == NULL)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < GATEWAY_SLOTS; i++)
+    {
+        pS = &Gateway.Slot[i];
+        if (pS->State != GATEWAY_READY)
+        {
+            continue;
+        }
+        memset(&request, 0, sizeof(request));
+        request.prefix[0] = (uint8_t)(pS->Addr >> 8U);
+        request.prefix[1] = (uint8_t)pS->Addr;
+        request.prefix[2] = pS->Channel;
+        request.prefixLength = MASTER_PREFIX_SIZE;
+        request.frame = &pS->Buf[MASTER_PREFIX_SIZE];
+        request.frameLength = pS->Length;
+        request.slaveId = request.frame[0];
+        request.code = request.frame[1];
+        /*上位机的写操作为控制类，读操作为遥测类*/
+        request.priority = ((request.code == MODBUS_CODE_5) || (request.code == MODBUS_CODE_6) ||
+                            (request.code == MODBUS_CODE_15) || (request.code == MODBUS_CODE_16) ||
+                            (request.code == MODBUS_CODE_23))
+                               ? MASTER_CLASS_CONTROL
+                               : MASTER_CLASS_TELEMETRY;
+        request.timeout = GATEWAY_TIMEOUT;
+        request.callback = Gateway_Done;
+        request.arg = pS;
+        pS->State = GATEWAY_WAIT;
+        if (!mdRTU_Submit(Client_Object, &request))
+        {
+            Gateway.Stats.Busy++;
+            Gateway_Exception(pS, request.code, GATEWAY_EXCEPTION_BUSY);
+        }
+    }
+}
+
+/**
+ * @brief	设置一条网关路由
+ * @details	addr 为负数时删除该本地从站号的路由，之后按节点映射表转发；路由表立即保存
+ * @param	unit 本地从站号
+ * @param	addr 目标节点地址
+ * @param	channel 目标信道
+ * @param	slave 远端从站号
+ * @retval	0 成功 0xFF 参数错误或路由表已满
+ */
+uint8_t Gateway_Set_Route(int unit, int addr, int channel, int slave)
+{
+    Gateway_Route *pR = NULL;
+
+    if ((unit < 0) || (unit > 0xFF) || (addr > 0xFFFF) || (channel < 0) || (channel > 0xFF) || (slave < 0) ||
+        (slave > 0xFF) || ((unit == MODBUS_BROADCAST_ID) != (slave == MODBUS_BROADCAST_ID)))
+    {
+        return 0xFF;
+    }
+    for (uint8_t i = 0; i < GATEWAY_ROUTES; i++)
+    {
+        if (Gateway.Route[i].Valid && (Gateway.Route[i].Unit == unit))
+        {
+            pR = &Gateway.Route[i];
+            break;
+        }
+        if ((pR == NULL) && !Gateway.Route[i].Valid)
+        {
+            pR = &Gateway.Route[i];
+        }
+    }
+    if ((pR == NULL) || ((addr < 0) && !pR->Valid))
+    {
+        return (addr < 0) ? 0 : 0xFF;
+    }
+    Os_Critical_Enter();
+    pR->Valid = (addr >= 0);
+    pR->Unit = unit;
+    pR->Slave = slave;
+    pR->Addr = (addr >= 0) ? addr : 0;
+    pR->Channel = channel;
+    Os_Critical_Exit();
+
+    return Kv_Set(KV_KEY_GATEWAY, Gateway.Route, sizeof(Gateway.Route)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), gw_route, Gateway_Set_Route, set gateway unit addr channel slave);
+
+/**
+ * @brief	打印网关路由表及统计
+ * @param	None
+ * @retval	None
+ */
+void Gateway_Show(void)
+{
+    Gateway_Stats *pT = &Gateway.Stats;
+
+    shellPrint(&shell, "rx = %u, tx = %u, bad = %u, no_route = %u, busy = %u, timeout = %u, error = %u, local = %u\r\n",
+               pT->Rx, pT->Tx, pT->Bad_Frame, pT->No_Route, pT->Busy, pT->Timeout, pT->Error, pT->Local);
+    for (uint8_t i = 0; i < GATEWAY_ROUTES; i++)
+    {
+        if (Gateway.Route[i].Valid)
+        {
+            shellPrint(&shell, "[%d] unit = %d -> addr = 0x%04x, ch = %d, id = %d\r\n", i, Gateway.Route[i].Unit,
+                       Gateway.Route[i].Addr, Gateway.Route[i].Channel, Gateway.Route[i].Slave);
+        }
+    }
+    for (uint8_t i = 0; i < GATEWAY_SLOTS; i++)
+    {
+        shellPrint(&shell, "slot[%d] state = %d, unit = %d, len = %d\r\n", i, Gateway.Slot[i].State,
+                   Gateway.Slot[i].Unit, Gateway.Slot[i].Length);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), gw, Gateway_Show, show gateway);
+#endif
@@ -1,72 +1,785 @@
 #include "io_signal.h"
+#include "boot.h"
 #include "main.h"
 #include "mdrtuslave.h"
 #include "adc.h"
 #include "shell_port.h"
+#include "L101.h"
+#include "cmsis_os.h"
+#include "soe.h"
+#include "route.h"
+#include "Flash.h"
+#include "mdcrc16.h"
+#include "trace.h"
+#if defined(USING_DEFER)
+#include "defer.h"
+#endif
+#if defined(USING_PULSE)
+#include "pulse.h"
+#endif
+#if defined(USING_TREND)
+#include "trend.h"
+#endif
+
+/*光耦输入为低有效:快照整体取反*/
+#define DIGITAL_INVERT_MASK 0xFF
+
+/*数字量输入快照:按板级配置展开为各通道的移位拼接，引脚号均为常量*/
+#define IO_DIGITAL_BIT(ch, port, pin, addr, chan, id) | (uint8_t)(((idr_##port >> (pin)) & 0x01U) << (ch))
+/*各通道的中断引脚*/
+#define IO_DIGITAL_PIN(ch, port, pin, addr, chan, id) [ch] = GPIO_PIN_##pin,
+static const uint16_t Digital_Pins[EXTERN_DIGITAL_MAX] = {BOARD_DIGITAL_TABLE(IO_DIGITAL_PIN)};
+
+/*数字量输入边沿记录:中断置位待处理通道并记录最后一次边沿时刻，任务中去抖*/
+typedef struct
+{
+    volatile uint8_t Pending;
+    /*已在首个边沿立即读取、正在等待稳定的通道*/
+    uint8_t Settling;
+    /*已写入输入线圈的电平*/
+    uint8_t State;
+    volatile uint32_t Edge_Tick[EXTERN_DIGITAL_MAX];
+    /*统计:边沿数、被滤除的抖动数*/
+    volatile uint32_t Edges;
+    uint32_t Bounces;
+} Io_DigitalInput;
+
+static Io_DigitalInput Digital_Input;
+extern osThreadId read_ioHandle;
+
+/**
+ * @brief	外部数字量输入快照
+ * @details	GPIOA、GPIOB的IDR各读取一次，按快照表拼出8路输入，保证各通道为同一时刻的采样
+ * @param	None
+ * @retval	按通道号排列的输入电平(已翻转光耦的输入信号)
+ */
+uint8_t Io_Digital_Snapshot(void)
+{
+    uint32_t idr_A = GPIOA->IDR, idr_B = GPIOB->IDR;
+    uint8_t snapshot = 0 BOARD_DIGITAL_TABLE(IO_DIGITAL_BIT);
 
-#define Get_Digital_Port(GPIO_Port) \
-    (GPIO_Port ? GPIOA : GPIOB)
+    return snapshot ^ DIGITAL_INVERT_MASK;
+}
+
+/**
+ * @brief	提交一路数字量输入的新电平
+ * @details	电平未变化时不处理；变化时写入输入线圈(一次位带存储，不影响相邻通道)，并经路由表驱动目标线圈
+ * @param	Channel 通道号
+ * @param	bit 输入电平
+ * @retval	None
+ */
+static void Io_Digital_Commit(uint16_t Channel, mdBit bit)
+{
+    mdU32 addr = DIGITAL_START_ADDR + Channel;
+
+    if (((Digital_Input.State >> Channel) & 0x01) == bit)
+    {
+        return;
+    }
+    Digital_Input.State ^= (uint8_t)(1U << Channel);
+    Soe_Record((uint8_t)addr, bit);
+    /*写入输入线圈*/
+    if (mdRTU_WriteInputCoil(Master_Object, addr, bit) == mdFALSE)
+    {
+#if defined(USING_DEBUG)
+        shellPrint(&shell, "DD[%d] = 0x%d\r\n", Channel, bit);
+#endif
+    }
+    Route_Digital(Channel, bit);
+}
 
-#define Get_Digital_Pin(GPIO_Pin) \
-    (GPIO_Pin < 5U ? (DDI0_Pin << GPIO_Pin) : (GPIO_Pin < 7U ? (DDI5_Pin << (GPIO_Pin - 5U)) : DDI7_Pin))
 /**
  * @brief	外部数字量输入处理
- * @details	STM32F103C8T6共在io口扩展了8路数字输入
+ * @details	STM32F103C8T6共在io口扩展了8路数字输入；一次快照读取全部通道并整字节写入输入线圈，
+ *			经路由表驱动全部目标线圈，用于上电时建立初始状态，此后只由边沿中断驱动
  * @param	None
  * @retval	None
  */
 void Io_Digital_Handle(void)
 {
-    GPIO_TypeDef *pGPIOx;
-    uint16_t GPIO_Pinx;
-    mdBit bit = mdLow;
-    mdU32 addr;
-    mdSTATUS ret;
+    uint8_t snapshot, changed;
+
+    TRACE(TRACE_DI_BEGIN);
+    snapshot = Io_Digital_Snapshot();
+    changed = snapshot ^ Digital_Input.State;
+    Digital_Input.State = snapshot;
+    /*整字节写入输入线圈*/
+    if (mdRTU_WriteInputCoilsPacked(Master_Object, DIGITAL_START_ADDR, EXTERN_DIGITAL_MAX, &snapshot) == mdFALSE)
+    {
+#if defined(USING_DEBUG)
+        shellPrint(&shell, "DD = 0x%02x\r\n", snapshot);
+#endif
+    }
+    for (uint16_t i = 0; i < EXTERN_DIGITAL_MAX; i++, changed >>= 1U)
+    {
+        if (changed & 0x01)
+        {
+            Soe_Record(DIGITAL_START_ADDR + i, (snapshot >> i) & 0x01);
+        }
+        Route_Digital(i, (snapshot >> i) & 0x01);
+    }
+    TRACE(TRACE_DI_END);
+}
 
+/**
+ * @brief	数字量输入边沿中断处理
+ * @details	只记录边沿时刻，通道进入待处理时唤醒输入任务，抖动期间的后续边沿只刷新时刻；
+ *			计数模式的通道只计数(pulse.h)
+ * @param	GPIO_Pin 触发中断引脚
+ * @retval	None
+ */
+void Io_Digital_Edge(uint16_t GPIO_Pin)
+{
     for (uint16_t i = 0; i < EXTERN_DIGITAL_MAX; i++)
     {
-        pGPIOx = Get_Digital_Port((i < 5U ? 1 : 0));
-        GPIO_Pinx = Get_Digital_Pin(i);
-        /*读取外部数字引脚状态:翻转光耦的输入信号*/
-        bit = (mdBit)HAL_GPIO_ReadPin(pGPIOx, GPIO_Pinx) ? 0 : 1;
-        /*计算出出当前写入地址*/
-        addr = DIGITAL_START_ADDR + i;
-        /*写入输入线圈*/
-        // ret = g_Mdmaster->registerPool->mdWriteCoil(g_Mdmaster->registerPool, addr, bit);
-        ret = mdRTU_WriteCoil(Master_Object, addr, bit);
-        /*写入失败*/
-        if (ret == mdFALSE)
+        if (GPIO_Pin != Digital_Pins[i])
         {
-#if defined(USING_DEBUG)
-            // mdhandler->registerPool->mdReadInputCoil(mdhandler->registerPool, addr, &bit);
-            shellPrint(&shell, "DD[%d] = 0x%d\r\n", i, bit);
+            continue;
+        }
+        TRACE(TRACE_DI_EDGE);
+#if defined(USING_PULSE)
+        if (Pulse_Edge(i, (Io_Digital_Snapshot() >> i) & 0x01U))
+        {
+            break;
+        }
 #endif
+        Digital_Input.Edge_Tick[i] = HAL_GetTick();
+        Digital_Input.Edges++;
+        if (!(Digital_Input.Pending & (1U << i)))
+        {
+            Digital_Input.Pending |= (uint8_t)(1U << i);
+            if (read_ioHandle != NULL)
+            {
+                osSignalSet(read_ioHandle, IO_SIGNAL_EDGE);
+            }
+        }
+        break;
+    }
+}
+
+/**
+ * @brief	数字量输入去抖
+ * @details	通道的首个边沿立即读取并提交(不等待去抖时间)，随后忽略抖动，
+ *			最后一次边沿后稳定 DIGITAL_DEBOUNCE_TIME 再读取一次确认最终电平
+ * @param	None
+ * @retval	距下一通道稳定的等待时间(ms)，无待处理通道时为 osWaitForever
+ */
+uint32_t Io_Digital_Debounce(void)
+{
+    uint32_t wait = osWaitForever, now, elapsed, primask;
+    uint8_t pending = Digital_Input.Pending, mask, snapshot;
+    mdBit bit;
+
+    if (!pending)
+    {
+        return wait;
+    }
+    /*所有待处理通道使用同一次快照*/
+    snapshot = Io_Digital_Snapshot();
+
+    for (uint16_t i = 0; pending; i++, pending >>= 1U)
+    {
+        if (!(pending & 0x01))
+        {
+            continue;
+        }
+        mask = (uint8_t)(1U << i);
+        bit = (mdBit)((snapshot >> i) & 0x01);
+        if (!(Digital_Input.Settling & mask))
+        {
+            Digital_Input.Settling |= mask;
+            Io_Digital_Commit(i, bit);
+        }
+        now = HAL_GetTick();
+        /*判断稳定与清除待处理需与边沿中断互斥，期间的新边沿会重新置位*/
+        primask = __get_PRIMASK();
+        __disable_irq();
+        elapsed = now - Digital_Input.Edge_Tick[i];
+        if (elapsed >= DIGITAL_DEBOUNCE_TIME)
+        {
+            Digital_Input.Pending &= (uint8_t)~mask;
+        }
+        __set_PRIMASK(primask);
+        if (elapsed < DIGITAL_DEBOUNCE_TIME)
+        {
+            wait = (DIGITAL_DEBOUNCE_TIME - elapsed < wait) ? (DIGITAL_DEBOUNCE_TIME - elapsed) : wait;
+            continue;
+        }
+        Digital_Input.Settling &= (uint8_t)~mask;
+        /*稳定后的电平与首个边沿时读取的不一致:首次读取落在抖动中，以稳定电平为准*/
+        if (((Digital_Input.State >> i) & 0x01) != bit)
+        {
+            Digital_Input.Bounces++;
+            Io_Digital_Commit(i, bit);
+        }
+    }
+    return wait;
+}
+
+/*模拟量校准:工程值(uA/mV) = (码值 * Gain + Offset) >> 16，系数为Q16定点数*/
+typedef struct
+{
+    int32_t Gain;
+    int32_t Offset;
+} Io_AnalogCal;
+
+/*模拟量发送条件，单位同 ANALOG_DEADBAND_ABSOLUTE 等默认值*/
+typedef struct
+{
+    uint16_t Absolute;
+    uint16_t Percent;
+    uint16_t Min_Interval;
+    uint16_t Max_Interval;
+} Io_AnalogDeadband;
+
+/*校准系数及发送条件在flash中的记录*/
+typedef struct
+{
+    uint16_t Magic;
+    uint8_t Version;
+    uint8_t Channels;
+    Io_AnalogCal Cal[ADC_DMA_CHANNEL];
+    Io_AnalogDeadband Deadband[ADC_DMA_CHANNEL];
+    uint16_t Crc16;
+} Io_AnalogCal_Record __attribute__((aligned(4)));
+
+/*最近一次标记发送的码值及时刻*/
+typedef struct
+{
+    mdU16 Code;
+    bool Valid;
+    uint32_t Tick;
+} Io_AnalogPublish;
+
+/*两点校准的采集点:码值及对应的参考值*/
+typedef struct
+{
+    mdU16 Code[2];
+    int32_t Value[2];
+    bool Valid;
+} Io_AnalogCal_Point;
+
+#define ANALOG_CAL_Q16(full_scale) ((int32_t)(((int64_t)(full_scale) << 16) / 4095))
+/*两点的码值差不足时拒绝计算，避免分辨率不足导致的增益误差*/
+#define ANALOG_CAL_MIN_SPAN 256
+
+/*默认系数由板级配置的满量程展开*/
+#define ANALOG_CAL_DEFAULT(ch, full) [ch] = {ANALOG_CAL_Q16(full), 0},
+static const Io_AnalogCal Analog_Cal_Default[ADC_DMA_CHANNEL] = {BOARD_ANALOG_TABLE(ANALOG_CAL_DEFAULT)};
+/*换算中使用的系数(DMA中断或 defer 任务)，修改时关中断成对更新*/
+static Io_AnalogCal Analog_Cal[ADC_DMA_CHANNEL] = {BOARD_ANALOG_TABLE(ANALOG_CAL_DEFAULT)};
+static Io_AnalogCal_Point Analog_Cal_Point[ADC_DMA_CHANNEL];
+static Io_AnalogDeadband Analog_Deadband[ADC_DMA_CHANNEL] = {
+    {ANALOG_DEADBAND_ABSOLUTE, ANALOG_DEADBAND_PERCENT, ANALOG_PUBLISH_MIN_INTERVAL, ANALOG_PUBLISH_MAX_INTERVAL},
+    {ANALOG_DEADBAND_ABSOLUTE, ANALOG_DEADBAND_PERCENT, ANALOG_PUBLISH_MIN_INTERVAL, ANALOG_PUBLISH_MAX_INTERVAL},
+};
+static Io_AnalogPublish Analog_Publish[ADC_DMA_CHANNEL];
+
+/*当前的模拟量报警状态，位定义同 ANALOG_ALARM_ADDR*/
+static volatile uint8_t Analog_Alarm;
+
+/**
+ * @brief	模拟量报警状态变化
+ * @details	写入报警状态寄存器，并通知调度器优先下发越限通道的模拟量
+ * @param	alarm 新的报警状态
+ * @retval	None
+ */
+static void Io_Analog_Alarm_Post(uint8_t alarm)
+{
+    uint8_t changed = alarm ^ Analog_Alarm;
+
+    Analog_Alarm = alarm;
+    Master_Object->registerPool->ops->mdWriteInputRegister(Master_Object->registerPool, ANALOG_ALARM_ADDR, alarm);
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        if (changed & (0x03U << (2U * i)))
+        {
+            Set_L101_Alarm(i);
+        }
+    }
+}
+
+/**
+ * @brief	模拟量越限检查
+ * @details	抽取滤波后逐通道与保持寄存器中的上下限比较；同时按看门狗通道的上下限
+ *			设置ADC模拟看门狗，通道回到窗口内后重新打开看门狗中断
+ * @param	raw 滤波后的码值
+ * @retval	None
+ */
+static void Io_Analog_Alarm(const mdU16 *raw)
+{
+    mdU16 limit[ADC_DMA_CHANNEL * 2U];
+    uint8_t alarm = 0;
+
+    if (Master_Object->registerPool->ops->mdReadHoldRegisters(Master_Object->registerPool, ANALOG_LIMIT_START_ADDR,
+                                                         ADC_DMA_CHANNEL * 2U, limit) == mdFALSE)
+    {
+        return;
+    }
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        if (limit[2U * i] && (raw[i] > limit[2U * i]))
+        {
+            alarm |= 1U << (2U * i);
+        }
+        if (limit[2U * i + 1U] && (raw[i] < limit[2U * i + 1U]))
+        {
+            alarm |= 1U << (2U * i + 1U);
+        }
+    }
+    if (alarm != Analog_Alarm)
+    {
+        Io_Analog_Alarm_Post(alarm);
+    }
+    /*看门狗在越限期间保持关闭，避免每次转换都进入中断*/
+    hadc1.Instance->HTR = limit[2U * ANALOG_AWD_CHANNEL] ? limit[2U * ANALOG_AWD_CHANNEL] : 0x0FFFU;
+    hadc1.Instance->LTR = limit[2U * ANALOG_AWD_CHANNEL + 1U];
+    if (!(alarm & (0x03U << (2U * ANALOG_AWD_CHANNEL))))
+    {
+        __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD);
+        __HAL_ADC_ENABLE_IT(&hadc1, ADC_IT_AWD);
+    }
+}
+
+#if defined(USING_DEFER)
+/**
+ * @brief	看门狗越限的下半部
+ * @details	在 defer 任务中执行，与 Io_Analog_Alarm 同在该任务中修改报警状态
+ * @param	Arg 越限方向(报警位)，合并的多次越限按位或
+ * @retval	None
+ */
+static void Io_Analog_Awd_Defer(uint32_t Arg)
+{
+    Io_Analog_Alarm_Post(Analog_Alarm | (uint8_t)Arg);
+}
+#endif
+
+/**
+ * @brief	ADC模拟看门狗中断
+ * @details	看门狗通道的单次采样越限时立即报警，不等待抽取滤波；越限采样同时写入
+ *			原始码值寄存器，使报警帧携带越限值，下次滤波输出后恢复为滤波值；
+ *			开启 USING_DEFER 时报警状态的更新交给 defer 任务
+ * @param	hadc ADC句柄
+ * @retval	None
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+    mdU16 code = (mdU16)(hadc->Instance->DR & 0x0FFFU);
+    uint8_t alarm = (code > hadc->Instance->HTR) ? (1U << (2U * ANALOG_AWD_CHANNEL)) : (2U << (2U * ANALOG_AWD_CHANNEL));
+
+    __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+    mdRTU_WriteHoldRegs(Master_Object, ANALOG_RAW_START_ADDR + ANALOG_AWD_CHANNEL, 1U, code);
+#if defined(USING_DEFER)
+    Defer_Post(DEFER_SRC_AWD, Io_Analog_Awd_Defer, alarm);
+#else
+    Io_Analog_Alarm_Post(Analog_Alarm | alarm);
+#endif
+}
+
+/**
+ * @brief	码值换算为工程值
+ * @details	在 Io_Analog_Handle 中调用，只用整数乘法与移位，结果四舍五入并限幅到16bit
+ * @param	Channel 通道号
+ * @param	Code 滤波后的码值
+ * @retval	工程值(uA/mV)
+ */
+static mdU16 Io_Analog_Apply(uint16_t Channel, mdU16 Code)
+{
+    int64_t value = (int64_t)Code * Analog_Cal[Channel].Gain + Analog_Cal[Channel].Offset + 0x8000;
+
+    if (value < 0)
+    {
+        return 0;
+    }
+    value >>= 16;
+    return (mdU16)((value > 0xFFFF) ? 0xFFFF : value);
+}
+
+/**
+ * @brief	模拟量发送判断
+ * @details	变化超过死区(绝对死区与相对死区取大)且距上次发送不小于最短间隔，或到达最长间隔时，
+ *			通知调度器发送该通道；过于频繁的变化在最短间隔到达后以最新值发送
+ * @param	raw 滤波后的码值
+ * @retval	None
+ */
+static void Io_Analog_Publish(const mdU16 *raw)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        Io_AnalogPublish *pPub = &Analog_Publish[i];
+        const Io_AnalogDeadband *pBand = &Analog_Deadband[i];
+        uint32_t elapsed = now - pPub->Tick;
+        uint32_t band = ((uint32_t)pPub->Code * pBand->Percent) / 1000U;
+        uint32_t delta = (raw[i] > pPub->Code) ? (raw[i] - pPub->Code) : (pPub->Code - raw[i]);
+
+        band = (band > pBand->Absolute) ? band : pBand->Absolute;
+        if ((pPub->Valid && ((delta <= band) || (elapsed < pBand->Min_Interval))) &&
+            (!pBand->Max_Interval || (elapsed < pBand->Max_Interval * 1000UL)))
+        {
+            continue;
         }
+        pPub->Code = raw[i];
+        pPub->Valid = true;
+        pPub->Tick = now;
+#if defined(USING_COS_MODE)
+        Set_L101_Analog(i);
+#endif
     }
 }
 
 /**
  * @brief	外部模拟量输入处理
- * @details	STM32F103C8T6共在io口扩展了2路模拟输入，通道0为电流，通道1为电压
+ * @details	STM32F103C8T6共在io口扩展了2路模拟输入，通道0为电流，通道1为电压；
+ *			取抽取滤波后的码值，校准值写入输入寄存器，原始码值写入保持寄存器，检查越限报警及发送条件
  * @param	None
  * @retval	None
  */
 void Io_Analog_Handle(void)
 {
-    mdU32 addr = ANALOG_START_ADDR;
     mdSTATUS ret;
-    float temp_data[ADC_DMA_CHANNEL] = {0};
+    mdU16 temp_data[ADC_DMA_CHANNEL];
+    mdU16 raw_data[ADC_DMA_CHANNEL];
+    mdU16 cmd = 0;
 
-    // Get_AdcValue(ADC_CHANNEL_0);
-    /*写入保持寄存器*/
-    // ret = g_Mdmaster->registerPool->mdWriteHoldRegisters(g_Mdmaster->registerPool, addr, sizeof(temp_data), (mdU16 *)&temp_data);
-    ret = mdRTU_WriteHoldRegs(Master_Object, addr, sizeof(temp_data), temp_data);
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        raw_data[i] = (mdU16)Get_AdcValue(i);
+        temp_data[i] = Io_Analog_Apply(i, raw_data[i]);
+    }
+    ret = Master_Object->registerPool->ops->mdWriteInputRegisters(Master_Object->registerPool, ANALOG_INPUT_START_ADDR,
+                                                             ADC_DMA_CHANNEL, temp_data);
+    /*原始码值供紧凑模拟量帧使用*/
+    ret &= mdRTU_WriteHoldRegs(Master_Object, ANALOG_RAW_START_ADDR, ADC_DMA_CHANNEL, raw_data);
+    Io_Analog_Alarm(raw_data);
+    Io_Analog_Publish(raw_data);
+#if defined(USING_TREND)
+    Trend_Sample(temp_data);
+#endif
+    /*校准命令涉及flash擦写，交给输入任务执行*/
+    mdRTU_ReadHoldReg(Master_Object, ANALOG_CAL_CMD_ADDR, cmd);
+    if (cmd && (cmd != 0xFFFFU) && read_ioHandle)
+    {
+        osSignalSet(read_ioHandle, IO_SIGNAL_CAL);
+    }
 
     /*写入失败*/
     if (ret == mdFALSE)
     {
     }
-#if defined(USING_DEBUG)
-    // shellPrint(&shell,"AD[%d] = 0x%d\r\n", 0, Get_AdcValue(ADC_CHANNEL_1));
+}
+
+#if defined(USING_DEFER)
+/**
+ * @brief	新码值的下半部
+ * @details	在 defer 任务中执行，执行前多次输出的码值只处理最新的一次
+ * @param	Arg 未使用
+ * @retval	None
+ */
+static void Io_Analog_Defer(uint32_t Arg)
+{
+    UNUSED(Arg);
+    Io_Analog_Handle();
+}
 #endif
+
+/**
+ * @brief	抽取滤波器输出新的码值
+ * @details	在ADC的DMA中断中调用，模拟量不再需要任务轮询；开启 USING_DEFER 时
+ *			中断只登记，换算、写寄存器及越限判断在 defer 任务中完成
+ * @param	None
+ * @retval	None
+ */
+void Adc_Result_Callback(void)
+{
+#if defined(USING_DEFER)
+    Defer_Post(DEFER_SRC_ADC, Io_Analog_Defer, 0);
+#else
+    Io_Analog_Handle();
+#endif
+}
+
+/**
+ * @brief	取得一路的校准增益
+ * @details	供计量换算交流量(偏移对交流分量无影响)，单个字读取无需关中断
+ * @param	Channel 通道号
+ * @retval	增益(Q16，uA或mV每码值)，通道号越界时为0
+ */
+int32_t Io_Analog_Gain(uint16_t Channel)
+{
+    return (Channel < ADC_DMA_CHANNEL) ? Analog_Cal[Channel].Gain : 0;
+}
+
+/**
+ * @brief	更新一路校准系数
+ * @details	换算时会同时读取增益与偏移，关中断后成对写入
+ * @param	Channel 通道号
+ * @param	pCal 新系数
+ * @retval	None
+ */
+static void Io_Analog_Cal_Set(uint16_t Channel, const Io_AnalogCal *pCal)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Analog_Cal[Channel] = *pCal;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	从flash中加载模拟量校准系数及发送条件
+ * @details	记录头、版本、通道数及CRC校验均正确时才覆盖默认系数；在启动ADC前调用
+ * @param	None
+ * @retval	true 加载成功 false 无有效记录
+ */
+bool Io_Analog_Cal_Load(void)
+{
+    /*直接读取flash中的记录，不拷贝*/
+    const Io_AnalogCal_Record *pRecord = (const Io_AnalogCal_Record *)FLASH_Map(ADDR_FLASH_PAGE_X(ANALOG_CAL_PAGE), sizeof(Io_AnalogCal_Record));
+
+    if (pRecord == NULL)
+    {
+        return false;
+    }
+    if ((pRecord->Magic != ANALOG_CAL_MAGIC) || (pRecord->Version != ANALOG_CAL_VERSION) ||
+        (pRecord->Channels != ADC_DMA_CHANNEL) ||
+        (pRecord->Crc16 != mdCrc16((uint8_t *)pRecord, offsetof(Io_AnalogCal_Record, Crc16))))
+    {
+        return false;
+    }
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        /*增益为0的记录无意义，保留默认系数*/
+        if (pRecord->Cal[i].Gain)
+        {
+            Io_Analog_Cal_Set(i, &pRecord->Cal[i]);
+        }
+        Analog_Deadband[i] = pRecord->Deadband[i];
+    }
+
+    return true;
+}
+
+/**
+ * @brief	模拟量校准的启动模块:在启动ADC前加载系数
+ * @param	None
+ * @retval	None
+ */
+static void Io_Analog_Boot_Init(void)
+{
+    Io_Analog_Cal_Load();
+}
+BOOT_MODULE(analog_cal, BOOT_LEVEL_MAIN, Io_Analog_Boot_Init, "kv");
+
+/**
+ * @brief	保存模拟量校准系数及发送条件到flash
+ * @details	记录交给flash任务在后台写入，不等待擦写完成
+ * @param	None
+ * @retval	0 已提交 0xFF 上次保存尚未完成
+ */
+uint8_t Io_Analog_Cal_Save(void)
+{
+    static Io_AnalogCal_Record record;
+    static Flash_Request request = {.Address = ADDR_FLASH_PAGE_X(ANALOG_CAL_PAGE), .pData = (const uint16_t *)&record,
+                                    .Size = sizeof(record) / 2U};
+
+    if (request.State == FLASH_REQ_PENDING)
+    {
+        return 0xFF;
+    }
+    memset(&record, 0x00, sizeof(record));
+    record.Magic = ANALOG_CAL_MAGIC;
+    record.Version = ANALOG_CAL_VERSION;
+    record.Channels = ADC_DMA_CHANNEL;
+    memcpy(record.Cal, Analog_Cal, sizeof(record.Cal));
+    memcpy(record.Deadband, Analog_Deadband, sizeof(record.Deadband));
+    record.Crc16 = mdCrc16((uint8_t *)&record, offsetof(Io_AnalogCal_Record, Crc16));
+
+    return FLASH_Post(&request) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal_save, Io_Analog_Cal_Save, save analog calibration);
+
+/**
+ * @brief	两点校准采集
+ * @details	输入端接入参考信号后调用，记录当前滤波码值；采集高点时由两点计算增益与偏移，
+ *			新系数立即生效，保存到flash需另行执行
+ * @param	Channel 通道号
+ * @param	Point 0:低点 1:高点
+ * @param	Value 参考值(uA/mV)
+ * @retval	0 成功 0xFF 失败
+ */
+static uint8_t Io_Analog_Cal_Point(uint16_t Channel, uint8_t Point, int32_t Value)
+{
+    Io_AnalogCal_Point *pPoint;
+    Io_AnalogCal cal;
+    int32_t span;
+    int64_t gain, offset;
+
+    if ((Channel >= ADC_DMA_CHANNEL) || (Point > 1U))
+    {
+        return 0xFF;
+    }
+    pPoint = &Analog_Cal_Point[Channel];
+    pPoint->Code[Point] = (mdU16)Get_AdcValue(Channel);
+    pPoint->Value[Point] = Value;
+    if (Point == 0U)
+    {
+        pPoint->Valid = true;
+        return 0;
+    }
+    if (!pPoint->Valid)
+    {
+        return 0xFF;
+    }
+    span = (int32_t)pPoint->Code[1] - (int32_t)pPoint->Code[0];
+    if ((span < ANALOG_CAL_MIN_SPAN) && (span > -ANALOG_CAL_MIN_SPAN))
+    {
+        return 0xFF;
+    }
+    gain = ((int64_t)(pPoint->Value[1] - pPoint->Value[0]) * 65536) / span;
+    offset = (int64_t)pPoint->Value[0] * 65536 - gain * pPoint->Code[0];
+    if ((gain <= 0) || (gain > INT32_MAX) || (offset > INT32_MAX) || (offset < INT32_MIN))
+    {
+        return 0xFF;
+    }
+    cal.Gain = (int32_t)gain;
+    cal.Offset = (int32_t)offset;
+    Io_Analog_Cal_Set(Channel, &cal);
+    pPoint->Valid = false;
+
+    return 0;
+}
+
+/**
+ * @brief	恢复一路模拟量的默认校准系数
+ * @param	Channel 通道号
+ * @retval	0 成功 0xFF 失败
+ */
+static uint8_t Io_Analog_Cal_Reset(uint16_t Channel)
+{
+    if (Channel >= ADC_DMA_CHANNEL)
+    {
+        return 0xFF;
+    }
+    Io_Analog_Cal_Set(Channel, &Analog_Cal_Default[Channel]);
+    Analog_Cal_Point[Channel].Valid = false;
+
+    return 0;
+}
+
+/**
+ * @brief	执行Modbus校准命令
+ * @details	在输入任务中调用；命令寄存器为 通道<<8|命令，参考值取自参考值寄存器，
+ *			执行后命令寄存器清0，失败时置为0xFFFF
+ * @param	None
+ * @retval	None
+ */
+void Io_Analog_Cal_Command(void)
+{
+    mdU16 cmd = 0, value = 0;
+    uint16_t channel;
+    uint8_t ret;
+
+    if ((mdRTU_ReadHoldReg(Master_Object, ANALOG_CAL_CMD_ADDR, cmd) == mdFALSE) ||
+        (mdRTU_ReadHoldReg(Master_Object, ANALOG_CAL_VALUE_ADDR, value) == mdFALSE) || !cmd || (cmd == 0xFFFFU))
+    {
+        return;
+    }
+    channel = cmd >> 8U;
+    switch (cmd & 0xFFU)
+    {
+    case ANALOG_CAL_CMD_LOW:
+        ret = Io_Analog_Cal_Point(channel, 0U, value);
+        break;
+    case ANALOG_CAL_CMD_HIGH:
+        ret = Io_Analog_Cal_Point(channel, 1U, value);
+        break;
+    case ANALOG_CAL_CMD_SAVE:
+        ret = Io_Analog_Cal_Save();
+        break;
+    case ANALOG_CAL_CMD_RESET:
+        ret = Io_Analog_Cal_Reset(channel);
+        break;
+    default:
+        ret = 0xFF;
+        break;
+    }
+    Master_Object->registerPool->ops->mdWriteHoldRegister(Master_Object->registerPool, ANALOG_CAL_CMD_ADDR,
+                                                     ret ? 0xFFFFU : 0U);
+}
+
+/**
+ * @brief	shell两点校准
+ * @param	ch 通道号
+ * @param	point 0:低点 1:高点 其他:恢复默认系数
+ * @param	value 参考值(uA/mV)
+ * @retval	0 成功 0xFF 失败
+ */
+int Io_Analog_Cal_Shell(int ch, int point, int value)
+{
+    if (ch < 0)
+    {
+        return 0xFF;
+    }
+    if ((point != 0) && (point != 1))
+    {
+        return Io_Analog_Cal_Reset((uint16_t)ch);
+    }
+    return Io_Analog_Cal_Point((uint16_t)ch, (uint8_t)point, value);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal, Io_Analog_Cal_Shell, analog calibration ch point value);
+
+/**
+ * @brief	打印模拟量校准系数及发送条件
+ * @param	None
+ * @retval	None
+ */
+void Io_Analog_Cal_Show(void)
+{
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        mdU16 code = (mdU16)Get_AdcValue(i);
+
+        shellPrint(&shell, "[%d] gain = %d, offset = %d (Q16), code = %d, value = %d\r\n", i, Analog_Cal[i].Gain,
+                   Analog_Cal[i].Offset, code, Io_Analog_Apply(i, code));
+        shellPrint(&shell, "    deadband = %d/%d.%d%%, interval = %dms/%ds\r\n", Analog_Deadband[i].Absolute,
+                   Analog_Deadband[i].Percent / 10U, Analog_Deadband[i].Percent % 10U,
+                   Analog_Deadband[i].Min_Interval, Analog_Deadband[i].Max_Interval);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal_show, Io_Analog_Cal_Show, show analog calibration);
+
+/**
+ * @brief	设置模拟量发送条件
+ * @details	在下一次滤波输出时生效，保存到flash需执行 cal_save
+ * @param	ch 通道号
+ * @param	absolute 绝对死区(12bit码值)
+ * @param	percent 相对死区(上次发送值的0.1%)
+ * @param	min_ms 最短发送间隔(ms)
+ * @param	max_s 最长发送间隔(s)，为0时不限
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Io_Analog_Set_Deadband(int ch, int absolute, int percent, int min_ms, int max_s)
+{
+    Io_AnalogDeadband band;
+    uint32_t primask;
+
+    if ((ch < 0) || (ch >= (int)ADC_DMA_CHANNEL) || (absolute < 0) || (absolute > 0x0FFF) || (percent < 0) ||
+        (percent > 1000) || (min_ms < 0) || (min_ms > 0xFFFF) || (max_s < 0) || (max_s > 0xFFFF) ||
+        (max_s && ((uint32_t)max_s * 1000UL < (uint32_t)min_ms)))
+    {
+        return 0xFF;
+    }
+    band.Absolute = (uint16_t)absolute;
+    band.Percent = (uint16_t)percent;
+    band.Min_Interval = (uint16_t)min_ms;
+    band.Max_Interval = (uint16_t)max_s;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    Analog_Deadband[ch] = band;
+    __set_PRIMASK(primask);
+
+    return 0;
 }
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), deadband, Io_Analog_Set_Deadband, set ch abs pct min_ms max_s);
@@ -1,50 +1,120 @@
 #include "io_uart.h"
+#include "boot.h"
 #include "tim.h"
 #include "shell_port.h"
-#if defined(USING_RTTHREAD)
-#include "rtthread.h"
-#else
-#include "cmsis_os.h"
-#endif
+#include "io_signal.h"
+#include "L101.h"
+#include "os_port.h"
+#include "Flash.h"
+#include "kv.h"
 
 /*定义串口*/
 IoUart_HandleTypeDef S_Uart1 = {0};
-// static uint16_t g_table[MAX_PARAM] = {0};
+/*已注册的模拟串口通道*/
+static IoUart_HandleTypeDef *Suart_Channels[SUART_MAX_CHANNELS];
+static uint8_t Suart_Count = 0;
+
+#if defined(USING_SUART_EDGE_RX)
+static void Suart_Edge_Ram_IRQHandler(void);
+static void Suart_Flash_Leave(void);
+static bool Suart_Flash_Ready(void);
+#endif
+
+/*波特率参数表项*/
+typedef struct
+{
+    uint32_t Baud;
+    uint16_t Tx_Ticks;
+    uint32_t Bit_Q8;
+    uint16_t Sam_Times[MAX_PARAM - 1U];
+    int16_t Bit_Error;
+} Suart_BaudTable;
+
+#define SUART_BAUD_ENTRY(b)                                        \
+    {                                                              \
+        (b), SUART_TX_TICKS(b), SUART_BIT_Q8(b),                   \
+            {GET_RULE1(b), GET_RULE2(b), GET_RULE2(b), GET_RULE3(b)}, \
+            (int16_t)GET_RULE_ERROR(b)                             \
+    }
 
 /**
- * @brief 定义模拟串口相关波特率表
+ * @brief 定义模拟串口相关波特率表(编译期整数计算)
  * @4800bps             __________________
  * |     Start_Bit     |
- * | 80   20   20   88 | 单位:us
+ * | 80   20   20   168| 单位:us
  * |____|____|____|____|
- * @param rate 目标波特率
- * @param table 参数表
- * @return true/false
- */
-// static bool Get_BaudTable(uint16_t rate, uint16_t *table)
-// {
-//     uint16_t temp_table[MAX_PARAM] = {
-//         GET_RULE1(rate), GET_RULE2(rate), GET_RULE2(rate), GET_RULE3(rate), BIT_TIMES(rate)};
-//     if (rate > MAX_IOUART_BAUDRATE)
-//     {
-//         return false;
-//     }
-//     return (memcpy(table, temp_table, sizeof(temp_table)) ? true : false);
-// }
+ */
+static const Suart_BaudTable Baud_Table[] = {
+    SUART_BAUD_ENTRY(1200U),
+    SUART_BAUD_ENTRY(2400U),
+    SUART_BAUD_ENTRY(4800U),
+    SUART_BAUD_ENTRY(9600U),
+    SUART_BAUD_ENTRY(19200U),
+    SUART_BAUD_ENTRY(38400U),
+    SUART_BAUD_ENTRY(MAX_IOUART_BAUDRATE),
+};
 
+#define SUART_BAUDS (sizeof(Baud_Table) / sizeof(Baud_Table[0]))
+/*各档的采样点修正(us)，校准后保存在参数区*/
+static int16_t Suart_Trim[SUART_BAUDS];
+
+/**
+ * @brief	按波特率查表设置模拟串口定时参数
+ * @details
+ * @param	huart 模拟串口句柄
+ * @param   rate 目标波特率
+ * @retval	true/false
+ */
 static bool Get_BaudTable(IoUart_HandleTypeDef *huart, uint32_t rate)
 {
-    if (rate > MAX_IOUART_BAUDRATE)
+    for (uint8_t i = 0; i < SUART_BAUDS; i++)
     {
-        return false;
+        const Suart_BaudTable *p = &Baud_Table[i];
+
+        if (p->Baud == rate)
+        {
+            int32_t first = (int32_t)p->Sam_Times[Start_Recv] + Suart_Trim[i];
+
+            huart->Tx.Total_Times = p->Tx_Ticks;
+            huart->Rx.Bit_Q8 = p->Bit_Q8;
+            huart->Rx.Bit_Error = p->Bit_Error;
+            huart->Rx.Bias = Suart_Trim[i];
+            memcpy(huart->Rx.Sam_Times, p->Sam_Times, sizeof(huart->Rx.Sam_Times));
+            /*定时采样时起始位后的第一个间隔同样按修正量平移全部采样点*/
+            huart->Rx.Sam_Times[Start_Recv] = (uint16_t)((first > 0) ? first : 1);
+            return true;
+        }
     }
-    huart->Tx.Total_Times = BIT_TIMES(rate);
-    huart->Rx.Sam_Times[Start_Recv] = GET_RULE1(rate);
-    huart->Rx.Sam_Times[Sampling2] = GET_RULE2(rate);
-    huart->Rx.Sam_Times[Sampling3] = GET_RULE2(rate);
-    huart->Rx.Sam_Times[Sampling1] = GET_RULE3(rate);
 
-    return true;
+    return false;
+}
+
+/**
+ * @brief	取得下一次采样的定时计数
+ * @details 每位最后一个间隔补偿采样间隔取整的累计误差，长帧采样点保持在位中央
+ * @param	huart 模拟串口句柄
+ * @param   index 采样序号
+ * @retval	定时器计数
+ */
+uint16_t Suart_Sample_Ticks(IoUart_HandleTypeDef *huart, uint8_t index)
+{
+    uint16_t ticks = huart->Rx.Sam_Times[index];
+
+    if (index == Sampling1)
+    {
+        huart->Rx.Frac += huart->Rx.Bit_Error;
+        if (huart->Rx.Frac >= 128)
+        {
+            huart->Rx.Frac -= 256;
+            ticks++;
+        }
+        else if (huart->Rx.Frac <= -128)
+        {
+            huart->Rx.Frac += 256;
+            ticks--;
+        }
+    }
+    return ticks;
 }
 
 /**
@@ -73,18 +143,472 @@ bool Get_ValidBits(uint8_t n)
  */
 void MX_Suart_Init(void)
 {
-    // Get_BaudTable(User_BaudRate, &g_table);
-    Get_BaudTable(&S_Uart1, User_BaudRate);
+#if defined(USING_SUART_EDGE_RX)
+    static const Flash_Ram_Vector vector = {.IRQn = IO_UART_RX_EXTI_IRQn, .Handler = Suart_Edge_Ram_IRQHandler,
+                                            .Leave = Suart_Flash_Leave, .Ready = Suart_Flash_Ready};
+#endif
+
+    /*校准得到的采样点修正，未校准时为0*/
+    if (Kv_Get(KV_KEY_SUART, Suart_Trim, sizeof(Suart_Trim)) != sizeof(Suart_Trim))
+    {
+        memset(Suart_Trim, 0, sizeof(Suart_Trim));
+    }
+    S_Uart1.Baud_Rate = User_BaudRate;
     S_Uart1.Check_Type = NONE;
-    S_Uart1.Tx.Finsh_Flag = false;
-    S_Uart1.Tx.Status = COM_NONE_BIT;
-    S_Uart1.Tx.Timer_Handle = &htim3;
-    S_Uart1.Rx.Finsh_Flag = false;
-    S_Uart1.Rx.Status = COM_NONE_BIT;
-    S_Uart1.Rx.Timer_Handle = &htim4;
+    S_Uart1.Tx.Port = IO_UART_TX_GPIO_Port;
+    S_Uart1.Tx.Pin = IO_UART_TX_Pin;
+    S_Uart1.Rx.Port = IO_UART_RX_GPIO_Port;
+    S_Uart1.Rx.Pin = IO_UART_RX_Pin;
     S_Uart1.Rx.IRQn = EXTI9_5_IRQn;
+    MX_Suart_Register(&S_Uart1);
+#if defined(USING_SUART_EDGE_RX)
+    /*接收定时器只作为1us自由运行的时间基准，不产生中断，所有通道共用*/
+    __HAL_TIM_SET_AUTORELOAD(&htim4, 0xFFFFU);
+    HAL_TIM_Base_Start(&htim4);
+#endif
+#if defined(USING_SUART_EDGE_RX)
+    /*flash擦写期间接收边沿仍在RAM中记录，发送在擦写前完成*/
+    FLASH_Ram_Register(&vector);
+#endif
+}
+#if defined(USING_IO_UART)
+BOOT_MODULE(suart, BOOT_LEVEL_STAGE, MX_Suart_Init, "");
+#endif
+
+#if defined(USING_SUART_DMA_TX)
+/*多路模拟串口共用的发送调度器:所有通道的发送引脚位于同一端口，由一个定时器按公共节拍写BSRR*/
+typedef struct
+{
+    TIM_HandleTypeDef *Timer_Handle; /*发送节拍定时器*/
+    GPIO_TypeDef *Port;              /*发送引脚所在端口*/
+    uint16_t Tick;                   /*公共节拍:各通道一位计数的最大公约数*/
+    volatile bool Active;
+    bool Idle;                        /*上一次填充的半区是否全部空闲*/
+    uint32_t Wave[2U * SUART_WAVE_HALF]; /*BSRR写入序列(循环DMA，前后半区交替填充)*/
+} Suart_Manager;
+
+static Suart_Manager Suart_Mgr = {0};
+
+/**
+ * @brief	把一个字节组成发送位序列
+ * @details 起始位 + 8位数据(低位在前) + 校验位(可选) + 停止位，低位先发出
+ * @param	huart 模拟串口句柄
+ * @param   data  待发送字节
+ * @retval	None
+ */
+static void Suart_Build_Frame(IoUart_HandleTypeDef *huart, uint8_t data)
+{
+    uint16_t frame = (uint16_t)data << 1U;
+    uint8_t n = 9U;
+    uint8_t parity = 0;
+
+    for (uint8_t i = 0; i < 8U; i++)
+    {
+        parity ^= (data >> i) & 0x01;
+    }
+    if (huart->Check_Type != NONE)
+    { /*奇校验:数据位与校验位中1的个数为奇数*/
+        parity = (huart->Check_Type == ODD) ? !parity : parity;
+        frame |= (uint16_t)parity << n++;
+    }
+    frame |= 1U << n++;
+    huart->Tx.Frame = frame;
+    huart->Tx.Frame_Bits = n;
+}
+
+/**
+ * @brief	填充一个半区的波形
+ * @details 每个字对应一个公共节拍；通道每 Div 个节拍取出下一位，空闲时保持高电平
+ * @param	pWave 半区起始地址
+ * @retval	true:半区内仍有通道在发送 false:全部空闲
+ */
+static bool Suart_Fill_Wave(uint32_t *pWave)
+{
+    bool busy = false;
+
+    for (uint16_t w = 0; w < SUART_WAVE_HALF; w++)
+    {
+        uint32_t word = 0;
+
+        for (uint8_t i = 0; i < Suart_Count; i++)
+        {
+            IoUart_HandleTypeDef *huart = Suart_Channels[i];
+
+            if (huart->Tx.Sub == 0U)
+            {
+                if ((huart->Tx.Frame_Bits == 0U) && (huart->Tx.Ring_Tail != huart->Tx.Ring_Head))
+                {
+                    Suart_Build_Frame(huart, huart->Tx.Ring[huart->Tx.Ring_Tail & (SUART_TX_RING_SIZE - 1U)]);
+                    huart->Tx.Ring_Tail++;
+                    huart->Tx.Freed = true;
+                }
+                if (huart->Tx.Frame_Bits)
+                {
+                    huart->Tx.Level = huart->Tx.Frame & 0x01;
+                    huart->Tx.Frame >>= 1U;
+                    huart->Tx.Frame_Bits--;
+                    huart->Tx.Status = COM_DATA_BIT;
+                }
+                else
+                { /*停止位已完整输出*/
+                    huart->Tx.Level = 1U;
+                    huart->Tx.Status = COM_NONE_BIT;
+                }
+                huart->Tx.Sub = huart->Tx.Div;
+            }
+            huart->Tx.Sub--;
+            busy |= (huart->Tx.Status != COM_NONE_BIT);
+            word |= huart->Tx.Level ? (uint32_t)huart->Tx.Pin : ((uint32_t)huart->Tx.Pin << 16U);
+        }
+        pWave[w] = word;
+    }
+
+    return busy;
+}
+
+/**
+ * @brief	半区播放完成后重新填充
+ * @details 连续两个半区全部空闲时(所有停止位已输出)停止定时器
+ * @param	pWave 刚播放完的半区
+ * @retval	None
+ */
+static void Suart_Tx_Refill(uint32_t *pWave)
+{
+    bool busy = Suart_Fill_Wave(pWave);
+
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        IoUart_HandleTypeDef *huart = Suart_Channels[i];
+        /*已腾出缓冲区空间或发送完成*/
+        if ((huart->Tx.Freed || (huart->Tx.Status == COM_NONE_BIT)) && (huart->Tx.Waiter != NULL))
+        {
+            Os_Signal_Set(huart->Tx.Waiter, SUART_SIGNAL_TX);
+        }
+        huart->Tx.Freed = false;
+    }
+    if (!busy && Suart_Mgr.Idle)
+    {
+        HAL_TIM_Base_Stop(Suart_Mgr.Timer_Handle);
+        __HAL_TIM_DISABLE_DMA(Suart_Mgr.Timer_Handle, TIM_DMA_UPDATE);
+        HAL_DMA_Abort_IT(Suart_Mgr.Timer_Handle->hdma[TIM_DMA_ID_UPDATE]);
+        Suart_Mgr.Active = false;
+    }
+    Suart_Mgr.Idle = !busy;
+}
+
+static void Suart_Tx_DmaHalfCplt(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    Suart_Tx_Refill(&Suart_Mgr.Wave[0]);
+}
+
+static void Suart_Tx_DmaCplt(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+    Suart_Tx_Refill(&Suart_Mgr.Wave[SUART_WAVE_HALF]);
+}
+
+/**
+ * @brief	发送空闲时启动DMA发送
+ * @details 与DMA完成中断互斥，避免其判定缓冲区为空后新写入的数据无人发送；
+ *          调度器运行时新数据在下一次半区填充时取出
+ * @param	huart 模拟串口句柄
+ * @retval	None
+ */
+static void Suart_Tx_Kick(IoUart_HandleTypeDef *huart)
+{
+    uint32_t primask = __get_PRIMASK();
+    DMA_HandleTypeDef *hdma = Suart_Mgr.Timer_Handle->hdma[TIM_DMA_ID_UPDATE];
+
+    UNUSED(huart);
+    __disable_irq();
+    if (!Suart_Mgr.Active && Suart_Count)
+    {
+        for (uint8_t i = 0; i < Suart_Count; i++)
+        {
+            Suart_Channels[i]->Tx.Sub = 0U;
+        }
+        Suart_Fill_Wave(&Suart_Mgr.Wave[0]);
+        Suart_Mgr.Idle = !Suart_Fill_Wave(&Suart_Mgr.Wave[SUART_WAVE_HALF]);
+        hdma->XferHalfCpltCallback = Suart_Tx_DmaHalfCplt;
+        hdma->XferCpltCallback = Suart_Tx_DmaCplt;
+        __HAL_TIM_SET_COUNTER(Suart_Mgr.Timer_Handle, 0U);
+        SUART_SET_PERIOD(Suart_Mgr.Timer_Handle, Suart_Mgr.Tick);
+        if (HAL_DMA_Start_IT(hdma, (uint32_t)Suart_Mgr.Wave, (uint32_t)&Suart_Mgr.Port->BSRR, 2U * SUART_WAVE_HALF) == HAL_OK)
+        { /*更新事件只产生DMA请求，不再进入定时器中断*/
+            __HAL_TIM_ENABLE_DMA(Suart_Mgr.Timer_Handle, TIM_DMA_UPDATE);
+            HAL_TIM_Base_Start(Suart_Mgr.Timer_Handle);
+            Suart_Mgr.Active = true;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/*求最大公约数*/
+static uint16_t Suart_Gcd(uint16_t a, uint16_t b)
+{
+    while (b)
+    {
+        uint16_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief	重新计算公共节拍
+ * @details 通道注册或改变波特率后调用，公共节拍为各通道一位计数的最大公约数，并据此计算各通道每位的节拍数
+ * @param	None
+ * @retval	None
+ */
+static void Suart_Tx_Retick(void)
+{
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        Suart_Mgr.Tick = i ? Suart_Gcd(Suart_Mgr.Tick, Suart_Channels[i]->Tx.Total_Times) : Suart_Channels[i]->Tx.Total_Times;
+    }
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        Suart_Channels[i]->Tx.Div = Suart_Channels[i]->Tx.Total_Times / Suart_Mgr.Tick;
+    }
+}
+#endif
+
+/**
+ * @brief	注册一路模拟串口
+ * @details 调用前设置波特率、校验方式、收发引脚及接收引脚的外部中断；
+ *          所有通道共用TIM3发送节拍(各通道位时间的公约数)与TIM4接收时间基准，
+ *          DMA发送时各通道的发送引脚须位于同一端口
+ * @param	huart 模拟串口句柄
+ * @retval	true/false
+ */
+bool MX_Suart_Register(IoUart_HandleTypeDef *huart)
+{
+    if ((Suart_Count >= SUART_MAX_CHANNELS) || !Get_BaudTable(huart, huart->Baud_Rate))
+    {
+        return false;
+    }
+    huart->Tx.Timer_Handle = &htim3;
+    huart->Tx.Status = COM_NONE_BIT;
+    huart->Tx.Finsh_Flag = false;
+    huart->Rx.Timer_Handle = &htim4;
+    huart->Rx.Status = COM_NONE_BIT;
+    huart->Rx.Finsh_Flag = false;
+#if defined(USING_SUART_DMA_TX)
+    if (Suart_Mgr.Active || (Suart_Count && (Suart_Mgr.Port != huart->Tx.Port)))
+    {
+        return false;
+    }
+    Suart_Mgr.Timer_Handle = huart->Tx.Timer_Handle;
+    Suart_Mgr.Port = huart->Tx.Port;
+#endif
+    Suart_Channels[Suart_Count++] = huart;
+#if defined(USING_SUART_DMA_TX)
+    Suart_Tx_Retick();
+#endif
+#if defined(USING_SUART_EDGE_RX)
+    {
+        GPIO_InitTypeDef GPIO_InitStruct = {0};
+        /*上升沿和下降沿都需要记录*/
+        GPIO_InitStruct.Pin = huart->Rx.Pin;
+        GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+        GPIO_InitStruct.Pull = GPIO_PULLUP;
+        HAL_GPIO_Init(huart->Rx.Port, &GPIO_InitStruct);
+        HAL_NVIC_EnableIRQ(huart->Rx.IRQn);
+    }
+    huart->Rx.Level = 1U;
+#endif
+
+    return true;
+}
+
+#if defined(USING_SUART_DMA_TX) || defined(USING_SUART_EDGE_RX)
+/**
+ * @brief	阻塞等待模拟串口中断的通知
+ * @details 调度器未运行时直接返回(由调用者轮询)
+ * @param	pWaiter 等待任务登记位置
+ * @param   signal  等待的信号
+ * @param   Timeout 最长等待时间(ms)
+ * @retval	None
+ */
+static void Suart_Wait(volatile Os_Thread *pWaiter, uint32_t signal, uint32_t Timeout)
+{
+    if (Os_Running())
+    {
+        *pWaiter = Os_Self();
+        Os_Signal_Wait(signal, Timeout);
+        *pWaiter = NULL;
+    }
+}
+#endif
+
+#if defined(USING_SUART_EDGE_RX)
+/*边沿记录中的电平位*/
+#define SUART_EDGE_LEVEL (1UL << 16U)
+
+/**
+ * @brief	等待下一个采样点前的边沿
+ * @details 取出采样点之前的所有边沿，更新线路电平
+ * @param	huart 模拟串口句柄
+ * @param   offset 采样点相对起始位下降沿的时间(us)
+ * @retval	true:采样点电平已确定 false:采样点尚未到达，稍后再解码
+ */
+static bool Suart_Edge_Sample(IoUart_HandleTypeDef *huart, uint16_t offset)
+{
+    uint32_t edge;
+
+    while (huart->Rx.Edge_Tail != huart->Rx.Edge_Head)
+    {
+        edge = huart->Rx.Edges[huart->Rx.Edge_Tail & (SUART_EDGE_SIZE - 1U)];
+        if ((uint16_t)((uint16_t)edge - huart->Rx.Start) > offset)
+        { /*下一个边沿在采样点之后，采样点电平即当前电平*/
+            return true;
+        }
+        huart->Rx.Level = (edge & SUART_EDGE_LEVEL) ? 1U : 0U;
+        huart->Rx.Edge_Tail++;
+    }
+    /*没有更多边沿:采样点已过(或线路已长时间空闲)时电平保持不变*/
+    return ((uint16_t)((uint16_t)__HAL_TIM_GET_COUNTER(huart->Rx.Timer_Handle) - huart->Rx.Start) > offset) ||
+           ((HAL_GetTick() - huart->Rx.Edge_Tick) > (0xFFFFU / 1000U));
+}
+
+/**
+ * @brief	从边沿时间戳中解码一个字节
+ * @details 在任务中调用；起始位下降沿后在每位中点取电平(起始位 + 8位数据 + 校验位 + 停止位)
+ * @param	huart 模拟串口句柄
+ * @param   pData 解码得到的字节
+ * @retval	true:得到一个字节 false:数据不足
+ */
+static bool Suart_Edge_Decode(IoUart_HandleTypeDef *huart, uint8_t *pData)
+{
+    uint8_t bits = (huart->Check_Type != NONE) ? 10U : 9U;
+    uint32_t edge;
+
+    for (;;)
+    {
+        if (!huart->Rx.Busy)
+        { /*查找起始位下降沿*/
+            if (huart->Rx.Edge_Tail == huart->Rx.Edge_Head)
+            {
+                return false;
+            }
+            edge = huart->Rx.Edges[huart->Rx.Edge_Tail++ & (SUART_EDGE_SIZE - 1U)];
+            huart->Rx.Level = (edge & SUART_EDGE_LEVEL) ? 1U : 0U;
+            if (huart->Rx.Level)
+            {
+                continue;
+            }
+            huart->Rx.Start = (uint16_t)edge;
+            huart->Rx.Busy = true;
+            huart->Rx.Bits = 1U;
+            huart->Rx.Data = 0U;
+        }
+        for (; huart->Rx.Bits <= bits; huart->Rx.Bits++)
+        {
+            /*采样点为第Bits位中央:(Bits + 0.5)位时间，由Q8定点直接计算，无累计误差*/
+            if (!Suart_Edge_Sample(huart, (uint16_t)((((2UL * huart->Rx.Bits + 1UL) * huart->Rx.Bit_Q8) >> 9U) + huart->Rx.Bias)))
+            {
+                return false;
+            }
+            if (huart->Rx.Bits <= 8U)
+            {
+                huart->Rx.Data |= (huart->Rx.Level & 0x01) << (huart->Rx.Bits - 1U);
+            }
+        }
+        huart->Rx.Busy = false;
+        /*停止位应为高电平，否则丢弃该字节*/
+        if (huart->Rx.Level)
+        {
+            *pData = huart->Rx.Data;
+            return true;
+        }
+        huart->Rx.Frame_Errors++;
+    }
 }
 
+/*与接收引脚共用 IO_UART_RX_EXTI_IRQn 的外部中断线5~9*/
+#define SUART_EDGE_LINES 0x03E0UL
+/*flash擦写期间暂缓处理的其他外部中断线*/
+static volatile uint32_t Suart_Edge_Deferred;
+
+/**
+ * @brief	flash擦写期间的接收引脚外部中断
+ * @details 位于RAM，只访问寄存器及RAM中的数据；照常记录接收边沿，
+ *          共用该中断的其他引脚暂时屏蔽，挂起位保留到擦写结束后由常规中断处理
+ * @param	None
+ * @retval	None
+ */
+static FLASH_RAMFUNC void Suart_Edge_Ram_IRQHandler(void)
+{
+    uint32_t pending = EXTI->PR & EXTI->IMR & SUART_EDGE_LINES;
+
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        IoUart_HandleTypeDef *huart = Suart_Channels[i];
+        uint16_t next = huart->Rx.Edge_Head;
+
+        if (!(pending & huart->Rx.Pin))
+        {
+            continue;
+        }
+        EXTI->PR = huart->Rx.Pin;
+        pending &= ~(uint32_t)huart->Rx.Pin;
+        if ((uint16_t)(next - huart->Rx.Edge_Tail) < SUART_EDGE_SIZE)
+        {
+            huart->Rx.Edges[next & (SUART_EDGE_SIZE - 1U)] = (uint16_t)huart->Rx.Timer_Handle->Instance->CNT |
+                                                           ((huart->Rx.Port->IDR & huart->Rx.Pin) ? SUART_EDGE_LEVEL : 0U);
+            huart->Rx.Edge_Head = next + 1U;
+        }
+        else
+        {
+            huart->Rx.Edge_Lost++;
+        }
+        huart->Rx.Edge_Tick = uwTick;
+    }
+    Suart_Edge_Deferred |= pending;
+    EXTI->IMR &= ~pending;
+}
+
+/**
+ * @brief	flash擦写结束
+ * @details 恢复暂缓的外部中断线，并唤醒等待接收数据的任务
+ * @param	None
+ * @retval	None
+ */
+static void Suart_Flash_Leave(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    EXTI->IMR |= Suart_Edge_Deferred;
+    Suart_Edge_Deferred = 0;
+    __set_PRIMASK(primask);
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        if ((Suart_Channels[i]->Rx.Edge_Head != Suart_Channels[i]->Rx.Edge_Tail) && (Suart_Channels[i]->Rx.Waiter != NULL))
+        {
+            Os_Signal_Set(Suart_Channels[i]->Rx.Waiter, SUART_SIGNAL_RX);
+        }
+    }
+}
+
+/**
+ * @brief	是否可以开始flash擦写
+ * @details 擦写期间DMA发送的填充中断暂停，须等待正在进行的发送结束
+ * @param	None
+ * @retval	true 发送空闲
+ */
+static bool Suart_Flash_Ready(void)
+{
+#if defined(USING_SUART_DMA_TX)
+    return !Suart_Mgr.Active;
+#else
+    return true;
+#endif
+}
+#endif
+
 /*获得接收超时标志*/
 // #define GET_SUART_FLAG(time, timeout) \
 //     ((HAL_GetTick() - time > timeout) ? true : false)
@@ -109,8 +633,33 @@ HAL_StatusTypeDef HAL_SUART_Transmit(IoUart_HandleTypeDef *huart, uint8_t *pData
     {
         return HAL_ERROR;
     }
+#if defined(USING_SUART_CAL)
+    if ((huart->Rx.Cal != NULL) && (huart->Rx.Cal != Os_Self()))
+    {
+        return HAL_BUSY;
+    }
+#endif
     /* Init tickstart for timeout managment */
     tickstart = HAL_GetTick();
+#if defined(USING_SUART_DMA_TX)
+    /*数据写入发送环形缓冲区即返回，由DMA完成中断持续取出发送；缓冲区满时阻塞等待*/
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        while ((uint16_t)(huart->Tx.Ring_Head - huart->Tx.Ring_Tail) >= SUART_TX_RING_SIZE)
+        {
+            if (GET_TIMEOUT_FLAG(tickstart, HAL_GetTick(), Timeout, HAL_MAX_DELAY) || (Timeout == 0U))
+            {
+                return HAL_TIMEOUT;
+            }
+            Suart_Wait(&huart->Tx.Waiter, SUART_SIGNAL_TX, Timeout);
+        }
+        huart->Tx.Ring[huart->Tx.Ring_Head & (SUART_TX_RING_SIZE - 1U)] = pData[i];
+        huart->Tx.Ring_Head++;
+        Suart_Tx_Kick(huart);
+    }
+
+    return HAL_OK;
+#else
     huart->Tx.Len = Size;
     huart->Tx.pBuf = pData;
     if (huart->Tx.Status == COM_NONE_BIT)
@@ -119,8 +668,8 @@ HAL_StatusTypeDef HAL_SUART_Transmit(IoUart_HandleTypeDef *huart, uint8_t *pData
         huart->Tx.En = true;
         // huart->Rx.En = false; ///
         __HAL_TIM_SET_COUNTER(huart->Tx.Timer_Handle, 0U);
-        __HAL_TIM_SET_AUTORELOAD(huart->Tx.Timer_Handle, huart->Tx.Total_Times);
-        HAL_TIM_Base_Start_IT(huart->Tx.Timer_Handle);
+        SUART_SET_PERIOD(huart->Tx.Timer_Handle, huart->Tx.Total_Times);
+        SUART_TIM_START_IT(huart->Tx.Timer_Handle->Instance);
 
         while (!huart->Tx.Finsh_Flag)
         {
@@ -135,6 +684,7 @@ HAL_StatusTypeDef HAL_SUART_Transmit(IoUart_HandleTypeDef *huart, uint8_t *pData
         return HAL_OK;
     }
     return HAL_BUSY;
+#endif
 }
 
 /**
@@ -150,6 +700,34 @@ HAL_StatusTypeDef HAL_SUART_Receive(IoUart_HandleTypeDef *huart, uint8_t *pData,
 {
     uint32_t tickstart = 0U;
 
+#if defined(USING_SUART_EDGE_RX)
+    if ((pData == NULL) || (Size == 0U))
+    {
+        return HAL_ERROR;
+    }
+#if defined(USING_SUART_CAL)
+    /*校准期间边沿归校准任务，接收者按1ms查询*/
+    if (huart->Rx.Cal != NULL)
+    {
+        Os_Delay(1U);
+        return HAL_BUSY;
+    }
+#endif
+    /* Init tickstart for timeout managment */
+    tickstart = HAL_GetTick();
+    /*每次取出一个字节，没有数据时阻塞等待边沿中断的通知*/
+    while (!Suart_Edge_Decode(huart, pData))
+    {
+        if (GET_TIMEOUT_FLAG(tickstart, HAL_GetTick(), Timeout, HAL_MAX_DELAY) || (Timeout == 0U))
+        {
+            return HAL_TIMEOUT;
+        }
+        /*字节末尾为连续高电平时没有边沿，只需等待该字节的剩余时间*/
+        Suart_Wait(&huart->Rx.Waiter, SUART_SIGNAL_RX, huart->Rx.Busy ? 1U : Timeout);
+    }
+
+    return HAL_OK;
+#else
     if (huart->Rx.Status == COM_NONE_BIT)
     {
         if ((pData == NULL) || (Size == 0U))
@@ -198,16 +776,271 @@ HAL_StatusTypeDef HAL_SUART_Receive(IoUart_HandleTypeDef *huart, uint8_t *pData,
     {
         return HAL_BUSY;
     }
+#endif
+}
+
+#if defined(USING_SUART_CAL)
+/*校准码型:交替位(每位都有边沿)、全0/全1(只有起止位边沿)及不同长度的连续位，一轮约30个边沿*/
+static const uint8_t Suart_Cal_Pattern[] = {0x55U, 0x00U, 0xFFU, 0x0FU, 0xF0U, 0x33U};
+
+/*一档波特率的校准结果*/
+typedef struct
+{
+    int32_t Sum[2];   /*下降沿/上升沿相对位边界的偏差和(us)*/
+    uint16_t Count[2];
+    int16_t Min, Max; /*全部边沿的偏差范围(us)*/
+    uint16_t Errors;  /*修正后解码错误或缺失的字节数*/
+} Suart_Cal_Result;
+
+/**
+ * @brief	改变一路模拟串口的波特率
+ * @details 须在发送空闲时调用，按新的位计数重新计算公共节拍，并应用该档的采样点修正
+ * @param	huart 模拟串口句柄
+ * @param   rate 波特率(须在波特率表中)
+ * @retval	true/false
+ */
+static bool Suart_Set_Baud(IoUart_HandleTypeDef *huart, uint32_t rate)
+{
+    if (Suart_Mgr.Active || !Get_BaudTable(huart, rate))
+    {
+        return false;
+    }
+    huart->Baud_Rate = rate;
+    Suart_Tx_Retick();
+    return true;
+}
+
+/**
+ * @brief	等待发送结束
+ * @details 最后一个停止位输出且连续两个半区空闲后DMA停止，此时回环的全部边沿都已记录
+ * @param	huart 模拟串口句柄
+ * @retval	true 已结束 false 超时
+ */
+static bool Suart_Cal_Wait(IoUart_HandleTypeDef *huart)
+{
+    uint32_t wait = (uint32_t)sizeof(Suart_Cal_Pattern) * 11000UL / huart->Baud_Rate +
+                    3UL * SUART_WAVE_HALF * Suart_Mgr.Tick / (SUART_TX_CLOCK / 1000UL) + 20U;
+
+    while (Suart_Mgr.Active && wait--)
+    {
+        Os_Delay(1U);
+    }
+    return !Suart_Mgr.Active;
+}
+
+/**
+ * @brief	统计边沿缓冲区中各边沿的偏差
+ * @details 不取出边沿；起始位下降沿之后的边沿按最近的位边界计算偏差，停止位之后的下降沿为下一字节的起始位
+ * @param	huart 模拟串口句柄
+ * @param   pR 校准结果
+ * @retval	None
+ */
+static void Suart_Cal_Measure(IoUart_HandleTypeDef *huart, Suart_Cal_Result *pR)
+{
+    uint8_t bits = (huart->Check_Type != NONE) ? 10U : 9U;
+    uint16_t start = 0;
+    bool busy = false;
+
+    for (uint16_t i = huart->Rx.Edge_Tail; i != huart->Rx.Edge_Head; i++)
+    {
+        uint32_t edge = huart->Rx.Edges[i & (SUART_EDGE_SIZE - 1U)];
+        uint8_t level = (edge & SUART_EDGE_LEVEL) ? 1U : 0U;
+
+        if (busy)
+        {
+            uint32_t offset = (uint16_t)((uint16_t)edge - start);
+            uint32_t k = (offset * 256UL + huart->Rx.Bit_Q8 / 2U) / huart->Rx.Bit_Q8;
+
+            if (k == 0U)
+            { /*紧随起始位的毛刺*/
+                continue;
+            }
+            if (k <= bits)
+            {
+                int16_t err = (int16_t)((int32_t)offset - (int32_t)((k * huart->Rx.Bit_Q8 + 128UL) >> 8U));
+
+                pR->Sum[level] += err;
+                pR->Count[level]++;
+                pR->Min = (err < pR->Min) ? err : pR->Min;
+                pR->Max = (err > pR->Max) ? err : pR->Max;
+                continue;
+            }
+            busy = false;
+        }
+        if (!level)
+        {
+            start = (uint16_t)edge;
+            busy = true;
+        }
+    }
 }
 
+/**
+ * @brief	发送一轮码型并统计或校验
+ * @param	huart 模拟串口句柄
+ * @param   pR 校准结果
+ * @param   Verify false:统计边沿偏差 true:按当前修正解码并与码型比较
+ * @retval	None
+ */
+static void Suart_Cal_Round(IoUart_HandleTypeDef *huart, Suart_Cal_Result *pR, bool Verify)
+{
+    uint8_t data;
+
+    huart->Rx.Edge_Tail = huart->Rx.Edge_Head;
+    huart->Rx.Busy = false;
+    huart->Rx.Level = 1U;
+    if ((HAL_SUART_Transmit(huart, (uint8_t *)Suart_Cal_Pattern, sizeof(Suart_Cal_Pattern), 100U) != HAL_OK) ||
+        !Suart_Cal_Wait(huart))
+    {
+        pR->Errors += sizeof(Suart_Cal_Pattern);
+        return;
+    }
+    if (!Verify)
+    {
+        Suart_Cal_Measure(huart, pR);
+        return;
+    }
+    for (uint8_t i = 0; i < sizeof(Suart_Cal_Pattern); i++)
+    {
+        if (!Suart_Edge_Decode(huart, &data) || (data != Suart_Cal_Pattern[i]))
+        {
+            pR->Errors++;
+        }
+    }
+}
+
+/*四舍五入的平均值*/
+static int16_t Suart_Cal_Mean(int32_t Sum, uint16_t Count)
+{
+    return (int16_t)((2 * Sum + ((Sum < 0) ? -(int32_t)Count : (int32_t)Count)) / (2 * (int32_t)Count));
+}
+
+/**
+ * @brief	模拟串口回环校准
+ * @details 发送引脚经跳线回接接收引脚后在shell中执行，期间其他任务不能使用该串口；按波特率表逐档:
+ *          先统计下降沿/上升沿相对位边界的平均偏差，取两者的中点为采样点修正，再按修正解码校验；
+ *          修正后偏差范围不超过一位的 1/SUART_CAL_MARGIN 且无解码错误的档为可用。
+ *          修正保存到参数区，上电后对所有档生效；未检测到回环时不保存。工作波特率仍为 User_BaudRate
+ * @param	None
+ * @retval	None
+ */
+void Suart_Calibrate(void)
+{
+    IoUart_HandleTypeDef *huart = &S_Uart1;
+    uint32_t baud = huart->Baud_Rate, best = 0;
+    int16_t trim[SUART_BAUDS];
+    bool looped = true;
+
+    huart->Rx.Cal = Os_Self();
+    memcpy(trim, Suart_Trim, sizeof(trim));
+    if (!Suart_Cal_Wait(huart))
+    {
+        huart->Rx.Cal = NULL;
+        shellPrint(&shell, "suart busy\r\n");
+        return;
+    }
+    shellPrint(&shell, "  baud  fall  rise  bias spread limit errors\r\n");
+    for (uint8_t i = 0; (i < SUART_BAUDS) && looped; i++)
+    {
+        Suart_Cal_Result r = {.Min = INT16_MAX, .Max = INT16_MIN};
+        int16_t fall, rise, bias;
+        uint16_t spread, limit;
+
+        /*统计时不带修正*/
+        Suart_Trim[i] = 0;
+        if (!Suart_Set_Baud(huart, Baud_Table[i].Baud))
+        {
+            continue;
+        }
+        for (uint8_t n = 0; n < SUART_CAL_ROUNDS; n++)
+        {
+            Suart_Cal_Round(huart, &r, false);
+        }
+        if (!r.Count[0] || !r.Count[1])
+        {
+            shellPrint(&shell, "no loopback from tx to rx pin\r\n");
+            looped = false;
+            break;
+        }
+        fall = Suart_Cal_Mean(r.Sum[0], r.Count[0]);
+        rise = Suart_Cal_Mean(r.Sum[1], r.Count[1]);
+        bias = (int16_t)((fall + rise) / 2);
+        Suart_Trim[i] = bias;
+        huart->Rx.Bias = bias;
+        for (uint8_t n = 0; n < SUART_CAL_ROUNDS; n++)
+        {
+            Suart_Cal_Round(huart, &r, true);
+        }
+        spread = (uint16_t)(((r.Max - bias) > (bias - r.Min)) ? (r.Max - bias) : (bias - r.Min));
+        limit = (uint16_t)(huart->Rx.Bit_Q8 / (256UL * SUART_CAL_MARGIN));
+        if (!r.Errors && (spread <= limit))
+        {
+            best = Baud_Table[i].Baud;
+        }
+        shellPrint(&shell, "%6u %5d %5d %5d %6u %5u %6u %s\r\n", Baud_Table[i].Baud, fall, rise, bias, spread, limit,
+                   r.Errors, (!r.Errors && (spread <= limit)) ? "ok" : "fail");
+    }
+    if (looped)
+    {
+        Kv_Set(KV_KEY_SUART, Suart_Trim, sizeof(Suart_Trim));
+    }
+    else
+    {
+        memcpy(Suart_Trim, trim, sizeof(trim));
+    }
+    Suart_Set_Baud(huart, baud);
+    huart->Rx.Edge_Tail = huart->Rx.Edge_Head;
+    huart->Rx.Busy = false;
+    huart->Rx.Level = 1U;
+    huart->Rx.Cal = NULL;
+    if (looped)
+    {
+        shellPrint(&shell, "highest usable baud = %u, running at %u\r\n", best, baud);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), suart_cal, Suart_Calibrate, calibrate soft uart with tx looped to rx);
+#endif
+
 /**
  * @brief	模拟串口RX接收中断处理
- * @details
+ * @details	其他引脚的外部中断转交数字量输入处理
  * @param	GPIO_Pin 触发中断引脚
  * @retval	None
  */
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
+    /*数字量输入与模拟串口共用外部中断回调，非数字量输入引脚在其中直接忽略*/
+    Io_Digital_Edge(GPIO_Pin);
+    /*L101模块STATUS引脚变为空闲*/
+    L101_Status_Edge(GPIO_Pin);
+#if defined(USING_SUART_EDGE_RX)
+    for (uint8_t i = 0; i < Suart_Count; i++)
+    {
+        IoUart_HandleTypeDef *huart = Suart_Channels[i];
+        uint16_t next = huart->Rx.Edge_Head;
+
+        if (GPIO_Pin != huart->Rx.Pin)
+        {
+            continue;
+        }
+        /*只记录时间戳与电平，解码在任务中进行*/
+        if ((uint16_t)(next - huart->Rx.Edge_Tail) < SUART_EDGE_SIZE)
+        {
+            huart->Rx.Edges[next & (SUART_EDGE_SIZE - 1U)] = (uint16_t)huart->Rx.Timer_Handle->Instance->CNT |
+                                                           (SUART_PIN_READ(huart->Rx.Port, huart->Rx.Pin) ? SUART_EDGE_LEVEL : 0U);
+            huart->Rx.Edge_Head = next + 1U;
+        }
+        else
+        {
+            huart->Rx.Edge_Lost++;
+        }
+        huart->Rx.Edge_Tick = HAL_GetTick();
+        if (huart->Rx.Waiter != NULL)
+        {
+            Os_Signal_Set(huart->Rx.Waiter, SUART_SIGNAL_RX);
+        }
+    }
+#else
     IoUart_HandleTypeDef *huart = &S_Uart1;
 
     if (GPIO_Pin == IO_UART_RX_Pin)
@@ -220,11 +1053,187 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
             /*Close falling edge interrupt*/
             HAL_NVIC_DisableIRQ(huart->Rx.IRQn);
             __HAL_TIM_SET_COUNTER(huart->Rx.Timer_Handle, 0U);
-            __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[Start_Recv]);
-            HAL_TIM_Base_Start_IT(huart->Rx.Timer_Handle);
+            huart->Rx.Frac = 0;
+            SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, Start_Recv));
+            SUART_TIM_START_IT(huart->Rx.Timer_Handle->Instance);
         }
 #if defined(USING_DEBUG)
         // shellPrint(&shell, "Received a falling edge!\r\n");
 #endif
     }
+#endif
 }
+
+#if !defined(USING_SUART_DMA_TX)
+/**
+ * @brief	逐位发送的定时器中断
+ * @details	在 TIM3_IRQHandler 中直接调用，不经过 HAL_TIM_IRQHandler 的分发：
+ *          发送定时器只使能更新中断，写SR清除标志，经BSRR输出每一位
+ * @param	None
+ * @retval	None
+ */
+void Suart_Tx_IRQHandler(void)
+{
+    IoUart_HandleTypeDef *huart = &S_Uart1;
+    TIM_TypeDef *tim = huart->Tx.Timer_Handle->Instance;
+
+    if (!(tim->SR & TIM_SR_UIF))
+    {
+        return;
+    }
+    tim->SR = ~TIM_SR_UIF;
+    /*Data transmission, transmission priority, no transmission before entering the receiving state*/
+    if (!huart->Tx.En)
+    {
+        return;
+    }
+    switch (huart->Tx.Status)
+    {
+    case COM_START_BIT:
+    {
+        SUART_PIN_WRITE(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, 0U);
+        huart->Tx.Status = COM_DATA_BIT;
+        huart->Tx.Bits = 0U;
+    }
+    break;
+    case COM_DATA_BIT:
+    {
+        SUART_PIN_WRITE(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, (*(huart->Tx.pBuf) >> huart->Tx.Bits) & 0x01);
+        if (++huart->Tx.Bits >= 8U)
+        {
+            huart->Tx.Status = huart->Check_Type ? COM_CHECK_BIT : COM_STOP_BIT;
+        }
+    }
+    break;
+    case COM_STOP_BIT:
+    {
+        SUART_PIN_WRITE(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, 1U);
+        huart->Tx.Bits = 0U;
+        if (--huart->Tx.Len)
+        {
+            huart->Tx.Status = COM_START_BIT;
+            huart->Tx.pBuf++;
+        }
+        else
+        {
+            huart->Tx.Status = COM_NONE_BIT;
+            huart->Tx.En = false;
+            huart->Rx.En = true;
+            SUART_TIM_STOP_IT(tim);
+            NVIC_EnableIRQ(huart->Rx.IRQn);
+            huart->Tx.Finsh_Flag = true;
+        }
+    }
+    break;
+    default:
+        break;
+    }
+}
+#endif
+
+#if !defined(USING_SUART_EDGE_RX)
+/*当前位已取得的采样值*/
+static uint8_t Suart_Samp_Bits = 0;
+
+/**
+ * @brief	每位三次定时采样的定时器中断
+ * @details	在 TIM4_IRQHandler 中直接调用，不经过 HAL_TIM_IRQHandler 的分发：
+ *          写SR清除更新标志，经IDR读取接收引脚
+ * @param	None
+ * @retval	None
+ */
+void Suart_Rx_IRQHandler(void)
+{
+    IoUart_HandleTypeDef *huart = &S_Uart1;
+    TIM_TypeDef *tim = huart->Rx.Timer_Handle->Instance;
+
+    if (!(tim->SR & TIM_SR_UIF))
+    {
+        return;
+    }
+    tim->SR = ~TIM_SR_UIF;
+    if (!huart->Rx.En)
+    {
+        return;
+    }
+    switch (huart->Rx.Status)
+    {
+    case COM_START_BIT:
+    {
+        Suart_Samp_Bits = (Suart_Samp_Bits << 1U) | SUART_PIN_READ(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin);
+        if (++huart->Rx.Filters >= MAX_SAMPING)
+        {
+            if (!Get_ValidBits(Suart_Samp_Bits))
+            {
+                huart->Rx.Status = COM_DATA_BIT;
+                SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, huart->Rx.Filters));
+            }
+            else
+            {
+                huart->Rx.Status = COM_STOP_BIT;
+            }
+            Suart_Samp_Bits = 0U;
+            huart->Rx.Filters = 0U;
+        }
+        else
+        {
+            SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, huart->Rx.Filters));
+        }
+    }
+    break;
+    case COM_DATA_BIT: /*Data bit*/
+    {
+        Suart_Samp_Bits = (Suart_Samp_Bits << 1U) | SUART_PIN_READ(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin);
+        if (++huart->Rx.Filters >= MAX_SAMPING)
+        {
+            huart->Rx.Data |= (Get_ValidBits(Suart_Samp_Bits) & 0x01) << huart->Rx.Bits;
+            if (huart->Rx.Bits >= 7U)
+            {
+                huart->Rx.Bits = 0;
+                huart->Rx.Status = huart->Check_Type ? COM_CHECK_BIT : COM_STOP_BIT;
+            }
+            else
+            {
+                huart->Rx.Bits++;
+            }
+            SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, huart->Rx.Filters));
+            huart->Rx.Filters = 0U;
+            Suart_Samp_Bits = 0U;
+        }
+        else
+        {
+            SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, huart->Rx.Filters));
+        }
+    }
+    break;
+    case COM_CHECK_BIT: /*Check bit*/
+    {
+        huart->Rx.Status = COM_NONE_BIT;
+    }
+    break;
+    case COM_STOP_BIT: /*stop bit*/
+    {
+        Suart_Samp_Bits = (Suart_Samp_Bits << 1U) | SUART_PIN_READ(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin);
+        if (++huart->Rx.Filters >= MAX_SAMPING)
+        { /*Stop bit received correctly*/
+            if (Get_ValidBits(Suart_Samp_Bits))
+            {
+                huart->Rx.Len++;
+                huart->Rx.Status = COM_NONE_BIT;
+                SUART_TIM_STOP_IT(tim);
+                huart->Rx.Finsh_Flag = true;
+            }
+            huart->Rx.Filters = 0U;
+            Suart_Samp_Bits = 0U;
+        }
+        else
+        {
+            SUART_SET_PERIOD(huart->Rx.Timer_Handle, Suart_Sample_Ticks(huart, huart->Rx.Filters));
+        }
+    }
+    break;
+    default:
+        break;
+    }
+}
+#endif
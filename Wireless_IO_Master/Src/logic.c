@@ -0,0 +1,446 @@
+#include "logic.h"
+#include "mdrtuslave.h"
+#include "shell_port.h"
+#include "L101.h"
+#include "board_cfg.h"
+#include "kv.h"
+#include "os_port.h"
+#include "string.h"
+
+#if defined(USING_LOGIC)
+typedef char Logic_Chunk_Check[(LOGIC_MAX_INSNS * sizeof(Logic_Insn) == LOGIC_KV_CHUNKS * KV_VALUE_MAX) ? 1 : -1];
+typedef char Logic_Pool_Check[(LOGIC_BITS <= COIL_POOL_SIZE) && (LOGIC_BITS <= INPUT_COIL_POOL_SIZE) ? 1 : -1];
+typedef char Logic_Stack_Check[(LOGIC_STACK_DEPTH <= 32U) && (LOGIC_EDGES <= 16U) ? 1 : -1];
+/*默认路由的输入及目标线圈须落在位空间内*/
+typedef char Logic_Space_Check[(L101_REMOTE_INPUT_START_ADDR + BOARD_DIGITAL_COUNT * L101_REMOTE_INPUTS <= LOGIC_BITS) &&
+                                       (BOARD_REG_OUTPUT + BOARD_DIGITAL_COUNT <= LOGIC_BITS)
+                                   ? 1
+                                   : -1];
+
+/*各指令的助记符及栈效果*/
+#define LOGIC_OP_NAME(name, pops, pushes, desc) #name,
+#define LOGIC_OP_POPS(name, pops, pushes, desc) pops,
+#define LOGIC_OP_PUSHES(name, pops, pushes, desc) pushes,
+static const char *const Logic_Name[LOGIC_OPS] = {LOGIC_OP_TABLE(LOGIC_OP_NAME)};
+static const uint8_t Logic_Pops[LOGIC_OPS] = {LOGIC_OP_TABLE(LOGIC_OP_POPS)};
+static const uint8_t Logic_Pushes[LOGIC_OPS] = {LOGIC_OP_TABLE(LOGIC_OP_PUSHES)};
+#undef LOGIC_OP_NAME
+#undef LOGIC_OP_POPS
+#undef LOGIC_OP_PUSHES
+
+static Logic_HandleTypeDef Logic;
+extern Os_Thread logicHandle;
+
+/**
+ * @brief	检查程序
+ * @details	逐条检查操作码、操作数范围及布尔栈的深度(不下溢、不超过 LOGIC_STACK_DEPTH)，
+ *			扫描时不再检查
+ * @param	pProgram 程序
+ * @param	Count 指令数
+ * @retval	首条无效指令的序号，LOGIC_OK:程序有效
+ */
+uint8_t Logic_Check(const Logic_Insn *pProgram, uint8_t Count)
+{
+    uint8_t depth = 0;
+
+    for (uint8_t i = 0; i < Count; i++)
+    {
+        const Logic_Insn *pI = &pProgram[i];
+        bool ok;
+
+        if ((pI->Op >= LOGIC_OPS) || (depth < Logic_Pops[pI->Op]))
+        {
+            return i;
+        }
+        switch (pI->Op)
+        {
+        case LOGIC_OP_LD:
+        case LOGIC_OP_LDN:
+            ok = (pI->Arg < LOGIC_SPACES) && (pI->Operand < LOGIC_BITS);
+            break;
+        case LOGIC_OP_ST:
+        case LOGIC_OP_STN:
+        case LOGIC_OP_SET:
+        case LOGIC_OP_RST:
+            /*输入线圈只读*/
+            ok = ((pI->Arg == LOGIC_SPACE_COIL) || (pI->Arg == LOGIC_SPACE_MARKER)) && (pI->Operand < LOGIC_BITS);
+            break;
+        case LOGIC_OP_TON:
+        case LOGIC_OP_TOF:
+            ok = (pI->Arg < LOGIC_TIMERS);
+            break;
+        case LOGIC_OP_RISE:
+        case LOGIC_OP_FALL:
+            ok = (pI->Arg < LOGIC_EDGES);
+            break;
+        default:
+            ok = true;
+            break;
+        }
+        depth = (uint8_t)(depth - Logic_Pops[pI->Op] + Logic_Pushes[pI->Op]);
+        if (!ok || (depth > LOGIC_STACK_DEPTH))
+        {
+            return i;
+        }
+    }
+    return LOGIC_OK;
+}
+
+/**
+ * @brief	重新检查程序并复位运行状态
+ * @details	逻辑任务可能正在扫描，期间禁止任务切换；定时器、边沿存储及中间变量清零，
+ *			程序有效时唤醒空闲的逻辑任务
+ * @param	None
+ * @retval	None
+ */
+static void Logic_Compile(void)
+{
+    Os_Critical_Enter();
+    for (Logic.Count = 0; (Logic.Count < LOGIC_MAX_INSNS) && (Logic.Program[Logic.Count].Op != LOGIC_OP_END);
+         Logic.Count++)
+    {
+    }
+    Logic.Error = Logic_Check(Logic.Program, Logic.Count);
+    memset(Logic.Timer, 0, sizeof(Logic.Timer));
+    Logic.Edge = 0;
+    Logic.Marker = 0;
+    Logic.Last = 0;
+    Os_Critical_Exit();
+    if (logicHandle && Logic_Ready())
+    {
+        Os_Signal_Set(logicHandle, LOGIC_SIGNAL_LOAD);
+    }
+}
+
+/**
+ * @brief	初始化本机逻辑
+ * @details	从参数存储区加载程序，缺少的分段按空程序处理；在调度开始前调用
+ * @param	None
+ * @retval	None
+ */
+void Logic_Init(void)
+{
+    uint8_t *p = (uint8_t *)Logic.Program;
+
+    memset(Logic.Program, 0, sizeof(Logic.Program));
+    for (uint8_t i = 0; i < LOGIC_KV_CHUNKS; i++, p += KV_VALUE_MAX)
+    {
+        if (Kv_Get((uint8_t)(KV_KEY_LOGIC + i), p, KV_VALUE_MAX) != KV_VALUE_MAX)
+        {
+            memset(p, 0, KV_VALUE_MAX);
+            break;
+        }
+    }
+    Logic_Compile();
+}
+
+/**
+ * @brief	是否有可扫描的程序
+ * @param	None
+ * @retval	true 程序非空且有效
+ */
+bool Logic_Ready(void)
+{
+    return Logic.Count && (Logic.Error == LOGIC_OK);
+}
+
+/**
+ * @brief	定时器指令
+ * @details	TON:输入保持为1达到设定值后输出1；TOF:输入回到0后保持输出1至设定值；时刻取本周期开始时的节拍
+ * @param	pT 定时器
+ * @param	On true:TON false:TOF
+ * @param	In 输入
+ * @param	Preset 设定值(ms)
+ * @param	Now 本周期开始时的节拍
+ * @retval	输出
+ */
+static uint32_t Logic_Timer_Run(Logic_Timer *pT, bool On, uint32_t In, uint32_t Preset, uint32_t Now)
+{
+    if (On ? !In : In)
+    {
+        /*TON的输入为0、TOF的输入为1时不计时*/
+        pT->Running = 0U;
+        pT->Q = In ? 1U : 0U;
+    }
+    else if (On || pT->Q)
+    {
+        if (!pT->Running)
+        {
+            pT->Running = 1U;
+            pT->Start = Now;
+        }
+        if (Now - pT->Start >= Preset)
+        {
+            pT->Q = On ? 1U : 0U;
+        }
+    }
+    return pT->Q;
+}
+
+/**
+ * @brief	读取寄存器作比较
+ * @param	Arg 寄存器(LOGIC_REG_HOLD | 地址)
+ * @retval	寄存器值，读取失败时为0
+ */
+static mdU16 Logic_Register(uint8_t Arg)
+{
+    mdU16 data = 0;
+    mdU32 addr = Arg & LOGIC_REG_ADDR_MASK;
+
+    if (Arg & LOGIC_REG_HOLD)
+    {
+        Master_Object->registerPool->ops->mdReadHoldRegister(Master_Object->registerPool, addr, &data);
+    }
+    else
+    {
+        Master_Object->registerPool->ops->mdReadInputRegister(Master_Object->registerPool, addr, &data);
+    }
+    return data;
+}
+
+/**
+ * @brief	一个扫描周期
+ * @details	由逻辑任务按 LOGIC_PERIOD 调用：取输入线圈及线圈的快照，逐条求值(线圈的写入先进入映像，
+ *			同一周期内后续指令读到新值)，最后只把与寄存器池不同的线圈写回；寄存器为16位，
+ *			比较指令直接读取；记录周期抖动、扫描耗时及超时次数
+ * @param	None
+ * @retval	None
+ */
+void Logic_Scan(void)
+{
+    uint32_t start = DWT->CYCCNT, now = Os_Tick(), period = (SystemCoreClock / 1000U) * LOGIC_PERIOD;
+    uint32_t input, coil, marker, written = 0, stack = 0, us;
+    uint8_t buf[LOGIC_BITS / 8U];
+    mdBit old;
+
+    if ((Master_Object == NULL) || !Logic_Ready())
+    {
+        return;
+    }
+    if (Logic.Last)
+    {
+        us = start - Logic.Last;
+        us = ((us > period) ? (us - period) : (period - us)) / (SystemCoreClock / 1000000U);
+        Logic.Jitter_Max = (us > Logic.Jitter_Max) ? us : Logic.Jitter_Max;
+    }
+    Logic.Last = start;
+    /*输入快照*/
+    memset(buf, 0, sizeof(buf));
+    Master_Object->registerPool->ops->mdReadInputCoilsPacked(Master_Object->registerPool, 0, LOGIC_BITS, buf);
+    input = buf[0] | ((uint32_t)buf[1] << 8U) | ((uint32_t)buf[2] << 16U) | ((uint32_t)buf[3] << 24U);
+    memset(buf, 0, sizeof(buf));
+    Master_Object->registerPool->ops->mdReadCoilsPacked(Master_Object->registerPool, 0, LOGIC_BITS, buf);
+    coil = buf[0] | ((uint32_t)buf[1] << 8U) | ((uint32_t)buf[2] << 16U) | ((uint32_t)buf[3] << 24U);
+    marker = Logic.Marker;
+    for (uint8_t pc = 0; pc < Logic.Count; pc++)
+    {
+        const Logic_Insn *pI = &Logic.Program[pc];
+        uint32_t top = stack & 0x01U, bit = 1UL << (pI->Operand & (LOGIC_BITS - 1U));
+        uint32_t *pSpace = (pI->Arg == LOGIC_SPACE_COIL) ? &coil : &marker;
+
+        switch (pI->Op)
+        {
+        case LOGIC_OP_LD:
+        case LOGIC_OP_LDN:
+            top = (pI->Arg == LOGIC_SPACE_INPUT) ? input : ((pI->Arg == LOGIC_SPACE_COIL) ? coil : marker);
+            top = ((top & bit) ? 1U : 0U) ^ ((pI->Op == LOGIC_OP_LDN) ? 1U : 0U);
+            stack = (stack << 1U) | top;
+            break;
+        case LOGIC_OP_ST:
+        case LOGIC_OP_STN:
+            *pSpace = (top ^ ((pI->Op == LOGIC_OP_STN) ? 1U : 0U)) ? (*pSpace | bit) : (*pSpace & ~bit);
+            written |= (pI->Arg == LOGIC_SPACE_COIL) ? bit : 0U;
+            break;
+        case LOGIC_OP_SET:
+        case LOGIC_OP_RST:
+            if (top)
+            {
+                *pSpace = (pI->Op == LOGIC_OP_SET) ? (*pSpace | bit) : (*pSpace & ~bit);
+                written |= (pI->Arg == LOGIC_SPACE_COIL) ? bit : 0U;
+            }
+            break;
+        case LOGIC_OP_AND:
+            stack = (stack >> 1U) & (~1UL | top);
+            break;
+        case LOGIC_OP_OR:
+            stack = (stack >> 1U) | top;
+            break;
+        case LOGIC_OP_XOR:
+            stack = (stack >> 1U) ^ top;
+            break;
+        case LOGIC_OP_NOT:
+            stack ^= 0x01U;
+            break;
+        case LOGIC_OP_POP:
+            stack >>= 1U;
+            break;
+        case LOGIC_OP_TON:
+        case LOGIC_OP_TOF:
+            top = Logic_Timer_Run(&Logic.Timer[pI->Arg], pI->Op == LOGIC_OP_TON, top, pI->Operand, now);
+            stack = (stack & ~1UL) | top;
+            break;
+        case LOGIC_OP_RISE:
+        case LOGIC_OP_FALL:
+            bit = (Logic.Edge >> pI->Arg) & 0x01U;
+            Logic.Edge = (uint16_t)((Logic.Edge & ~(1U << pI->Arg)) | (top << pI->Arg));
+            top = (pI->Op == LOGIC_OP_RISE) ? (top & (bit ^ 1U)) : ((top ^ 1U) & bit);
+            stack = (stack & ~1UL) | top;
+            break;
+        case LOGIC_OP_GT:
+        case LOGIC_OP_LT:
+            us = Logic_Register(pI->Arg);
+            top = (pI->Op == LOGIC_OP_GT) ? (us > pI->Operand) : (us < pI->Operand);
+            stack = (stack << 1U) | top;
+            break;
+        default:
+            break;
+        }
+    }
+    Logic.Marker = marker;
+    /*只写回变化的线圈，线圈变化由寄存器池的变化订阅通知调度器*/
+    for (uint8_t i = 0; written; i++, written >>= 1U)
+    {
+        mdBit bit = (mdBit)((coil >> i) & 0x01U);
+
+        if (!(written & 0x01U) ||
+            ((Master_Object->registerPool->ops->mdReadCoil(Master_Object->registerPool, i, &old) == mdTRUE) && (old == bit)))
+        {
+            continue;
+        }
+        if (Master_Object->registerPool->ops->mdWriteCoil(Master_Object->registerPool, i, bit) == mdTRUE)
+        {
+            Logic.Writes++;
+        }
+    }
+    us = DWT->CYCCNT - start;
+    Logic.Overruns += (us > period) ? 1U : 0U;
+    Logic.Scan_Last = us / (SystemCoreClock / 1000000U);
+    Logic.Scan_Max = (Logic.Scan_Last > Logic.Scan_Max) ? Logic.Scan_Last : Logic.Scan_Max;
+    Logic.Scans++;
+}
+
+/**
+ * @brief	追加一条指令
+ * @details	立即重新检查并复位运行状态；保存需执行 logic_save
+ * @param	op 操作码(logic_show 列出)
+ * @param	arg 位空间/定时器号/边沿存储号/寄存器
+ * @param	operand 地址/设定值(ms)/常数
+ * @retval	0 成功 0xFF 参数错误或程序已满
+ */
+uint8_t Logic_Add(int op, int arg, int operand)
+{
+    Logic_Insn *pI;
+
+    if ((op <= (int)LOGIC_OP_END) || (op >= (int)LOGIC_OPS) || (arg < 0) || (arg > 0xFF) || (operand < 0) ||
+        (operand > 0xFFFF) || (Logic.Count >= LOGIC_MAX_INSNS))
+    {
+        return 0xFF;
+    }
+    pI = &Logic.Program[Logic.Count];
+    pI->Op = (uint8_t)op;
+    pI->Arg = (uint8_t)arg;
+    pI->Operand = (uint16_t)operand;
+    Logic_Compile();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), logic_add, Logic_Add, add logic op arg operand);
+
+/**
+ * @brief	删除一条指令
+ * @param	index 序号，小于0时清空程序
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Logic_Del(int index)
+{
+    if (index >= (int)Logic.Count)
+    {
+        return 0xFF;
+    }
+    Os_Critical_Enter();
+    if (index < 0)
+    {
+        memset(Logic.Program, 0, sizeof(Logic.Program));
+    }
+    else
+    {
+        memmove(&Logic.Program[index], &Logic.Program[index + 1],
+                (LOGIC_MAX_INSNS - index - 1U) * sizeof(Logic_Insn));
+        memset(&Logic.Program[LOGIC_MAX_INSNS - 1U], 0, sizeof(Logic_Insn));
+    }
+    Os_Critical_Exit();
+    Logic_Compile();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), logic_del, Logic_Del, delete logic index);
+
+/**
+ * @brief	保存程序到参数存储区
+ * @details	按 KV_VALUE_MAX 分段保存至含END的一段，后续分段不再读取
+ * @param	None
+ * @retval	0 成功 0xFF 保存失败
+ */
+uint8_t Logic_Save(void)
+{
+    const uint8_t *p = (const uint8_t *)Logic.Program;
+    uint8_t chunks = (uint8_t)(((Logic.Count + 1U) * sizeof(Logic_Insn) + KV_VALUE_MAX - 1U) / KV_VALUE_MAX);
+
+    chunks = (chunks > LOGIC_KV_CHUNKS) ? LOGIC_KV_CHUNKS : chunks;
+    for (uint8_t i = 0; i < chunks; i++, p += KV_VALUE_MAX)
+    {
+        if (!Kv_Set((uint8_t)(KV_KEY_LOGIC + i), p, KV_VALUE_MAX))
+        {
+            return 0xFF;
+        }
+    }
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), logic_save, Logic_Save, save logic program);
+
+/**
+ * @brief	打印程序及扫描统计
+ * @param	None
+ * @retval	None
+ */
+void Logic_Show(void)
+{
+    shellPrint(&shell, "program: %d/%d, %s", Logic.Count, LOGIC_MAX_INSNS, Logic_Ready() ? "running" : "idle");
+    if (Logic.Error != LOGIC_OK)
+    {
+        shellPrint(&shell, ", invalid at %d", Logic.Error);
+    }
+    shellPrint(&shell, "\r\nperiod = %dms, scans = %u, overruns = %u, writes = %u, jitter max = %uus, scan = %u/%uus\r\n",
+               LOGIC_PERIOD, Logic.Scans, Logic.Overruns, Logic.Writes, Logic.Jitter_Max, Logic.Scan_Last,
+               Logic.Scan_Max);
+    for (uint8_t i = 0; i < Logic.Count; i++)
+    {
+        const Logic_Insn *pI = &Logic.Program[i];
+
+        shellPrint(&shell, "[%d] %s %d %d\r\n", i, (pI->Op < LOGIC_OPS) ? Logic_Name[pI->Op] : "?", pI->Arg,
+                   pI->Operand);
+    }
+    shellPrint(&shell, "ops:");
+    for (uint8_t i = 1; i < LOGIC_OPS; i++)
+    {
+        shellPrint(&shell, " %d=%s", i, Logic_Name[i]);
+    }
+    shellPrint(&shell, "\r\nspaces: 0=input 1=coil 2=marker, registers: addr | 0x80 for holding\r\n");
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), logic_show, Logic_Show, show logic program);
+
+/**
+ * @brief	清除扫描统计
+ * @param	None
+ * @retval	None
+ */
+void Logic_Clear(void)
+{
+    Logic.Scans = 0;
+    Logic.Overruns = 0;
+    Logic.Writes = 0;
+    Logic.Jitter_Max = 0;
+    Logic.Scan_Max = 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), logic_clear, Logic_Clear, clear logic counters);
+#endif
@@ -31,8 +31,22 @@
 /* USER CODE BEGIN Includes */
 #include "shell_port.h"
 #include "mdrtuslave.h"
+#include "soe.h"
+#include "extlog.h"
+#include "tunnel.h"
+#include "filerec.h"
 #include "L101.h"
 #include "io_uart.h"
+#include "io_signal.h"
+#include "kv.h"
+#include "retain.h"
+#include "trace.h"
+#include "Flash.h"
+#include "irq_prio.h"
+#include "boot.h"
+#if defined(USING_TREND)
+#include "trend.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -104,22 +118,19 @@ int main(void)
   MX_TIM3_Init();
   MX_TIM4_Init();
   /* USER CODE BEGIN 2 */
-#if defined(USING_IO_UART)
-  // HAL_Delay(500);
-  MX_Suart_Init();
-#endif
-  User_Shell_Init(Shell_Object);
-  ModbusInit(&Master_Object);
-  /*DMA buffer must point to an entity address!!!*/
-  HAL_UART_Receive_DMA(&huart1, mdRTU_Recive_Buf(Master_Object), MODBUS_PDU_SIZE_MAX);
-  Slist_Init();
+  /*Module inits registered next to their code (BOOT_MODULE), run in dependency order*/
+  Boot_Run(BOOT_LEVEL_MAIN);
 #if defined(USING_RTTHREAD)
+  /*No boot task here: the deferred stage runs before the threads are created*/
+  Boot_Stage();
+  Boot_Done();
   MX_RT_Thread_Init();
 #endif
   /*Only ADC1 channel 0 uses DMA*/
   /*Start hardware watchdog*/
   HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_4);
   HAL_ADC_Start_DMA(&hadc1, (uint32_t *)Adc_buffer, ADC_DMA_SIZE);
+  Boot_Mark(BOOT_MARK_MAIN);
   /* USER CODE END 2 */
 
   /* Call init function for freertos objects (in freertos.c) */
@@ -186,7 +197,46 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
+/**
+ * @brief  Modbus stack boot module: the local slave and its register pool
+ * @note   SOE is started here so that it gets the pool without depending on the Master object
+ * @param  None
+ * @retval None
+ */
+static void Modbus_Boot_Init(void)
+{
+  ModbusInit(&Master_Object);
+  /*The latest SOE event is exported to the local slave's input registers*/
+  Soe_Init(Master_Object->registerPool);
+}
+BOOT_MODULE(modbus, BOOT_LEVEL_MAIN, Modbus_Boot_Init, "shell");
+
+/**
+ * @brief  Count power-ups in the parameter store: one half-word append, no page erase
+ * @param  None
+ * @retval None
+ */
+static void Kv_Boots_Init(void)
+{
+  uint32_t boots = 0;
 
+  Kv_Get(KV_KEY_BOOTS, &boots, sizeof(boots));
+  boots++;
+  Kv_Set(KV_KEY_BOOTS, &boots, sizeof(boots));
+}
+BOOT_MODULE(kv_boots, BOOT_LEVEL_STAGE, Kv_Boots_Init, "kv");
+
+/**
+ * @brief  Deferred boot stage
+ * @note   Runs in the boot task once the input task is up (before the threads under RT-Thread);
+ *         the tasks that need these modules wait in Boot_Wait() until Boot_Done()
+ * @param  None
+ * @retval None
+ */
+void Boot_Stage(void)
+{
+  Boot_Run(BOOT_LEVEL_STAGE);
+}
 /* USER CODE END 4 */
 
  /**
@@ -200,161 +250,13 @@ void SystemClock_Config(void)
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
   /* USER CODE BEGIN Callback 0 */
-  IoUart_HandleTypeDef *huart = &S_Uart1;
-  static uint8_t Samp_Bits = 0;
-  // uint8_t *p = &huart->Tx.pBuf[0];
+
   /* USER CODE END Callback 0 */
   if (htim->Instance == TIM1) {
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
-  else if (htim->Instance == TIM3)
-  { /*Data transmission, transmission priority, no transmission before entering the receiving state*/
-    if (huart->Tx.En)
-    { /*Serial port sending bit status judgment*/
-      switch (huart->Tx.Status)
-      {
-      case COM_START_BIT:
-      {
-        HAL_GPIO_WritePin(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, GPIO_PIN_RESET);
-        huart->Tx.Status = COM_DATA_BIT;
-        huart->Tx.Bits = 0U;
-      }
-      break;
-      case COM_DATA_BIT:
-      {
-        HAL_GPIO_WritePin(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, (GPIO_PinState)((*(huart->Tx.pBuf) >> huart->Tx.Bits) & 0x01));
-
-        if (++huart->Tx.Bits >= 8U)
-        {
-          huart->Tx.Status = huart->Check_Type ? COM_CHECK_BIT : COM_STOP_BIT;
-        }
-      }
-      break;
-      case COM_CHECK_BIT:
-      {
-      }
-      break;
-      case COM_STOP_BIT:
-      {
-        HAL_GPIO_WritePin(IO_UART_TX_GPIO_Port, IO_UART_TX_Pin, GPIO_PIN_SET);
-        huart->Tx.Bits = 0U;
-        if (--huart->Tx.Len)
-        {
-          huart->Tx.Status = COM_START_BIT;
-          huart->Tx.pBuf++;
-        }
-        else
-        {
-          huart->Tx.Status = COM_NONE_BIT;
-          huart->Tx.En = false;
-          huart->Rx.En = true;
-          HAL_TIM_Base_Stop_IT(huart->Tx.Timer_Handle);
-          __HAL_TIM_SET_COUNTER(huart->Tx.Timer_Handle, 0U);
-          HAL_NVIC_EnableIRQ(huart->Rx.IRQn);
-          huart->Tx.Finsh_Flag = true;
-        }
-      }
-      break;
-      default:
-        break;
-      }
-    }
-  }
-  else if (htim->Instance == TIM4)
-  {
-    if (huart->Rx.En)
-    {
-      switch (huart->Rx.Status)
-      {
-      case COM_START_BIT:
-      {
-        Samp_Bits = (Samp_Bits << 1U) | (HAL_GPIO_ReadPin(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin) & 0x01);
-
-        if (++huart->Rx.Filters >= MAX_SAMPING)
-        {
-          if (!Get_ValidBits(Samp_Bits))
-          {
-            huart->Rx.Status = COM_DATA_BIT;
-            __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[huart->Rx.Filters]);
-          }
-          else
-          {
-            huart->Rx.Status = COM_STOP_BIT;
-          }
-          Samp_Bits = 0U;
-          huart->Rx.Filters = 0U;
-        }
-        else
-        {
-          __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[huart->Rx.Filters]);
-        }
-      }
-      break;
-      case COM_DATA_BIT: /*Data bit*/
-      {
-        Samp_Bits = (Samp_Bits << 1U) | (HAL_GPIO_ReadPin(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin) & 0x01);
-
-        if (++huart->Rx.Filters >= MAX_SAMPING)
-        {
-          huart->Rx.Data |= (Get_ValidBits(Samp_Bits) & 0x01) << huart->Rx.Bits;
-          if (huart->Rx.Bits >= 7U)
-          {
-            huart->Rx.Bits = 0;
-            huart->Rx.Status = huart->Check_Type ? COM_CHECK_BIT : COM_STOP_BIT;
-          }
-          else
-          {
-            huart->Rx.Bits++;
-          }
-          __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[huart->Rx.Filters]);
-          huart->Rx.Filters = 0U;
-          Samp_Bits = 0U;
-        }
-        else
-        {
-          __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[huart->Rx.Filters]);
-        }
-      }
-      break;
-      case COM_CHECK_BIT: /*Check bit*/
-      {
-        huart->Rx.Status = COM_NONE_BIT;
-      }
-      break;
-      case COM_STOP_BIT: /*stop bit*/
-      {
-        Samp_Bits = (Samp_Bits << 1U) | (HAL_GPIO_ReadPin(IO_UART_RX_GPIO_Port, IO_UART_RX_Pin) & 0x01);
-
-        if (++huart->Rx.Filters >= MAX_SAMPING)
-        { /*Stop bit received correctly*/
-          if (Get_ValidBits(Samp_Bits))
-          {
-            huart->Rx.Len++;
-            huart->Rx.Status = COM_NONE_BIT;
-            // huart->Rx.En = true;
-            // huart->Tx.En = false; ///
-            HAL_TIM_Base_Stop_IT(huart->Rx.Timer_Handle);
-            __HAL_TIM_SET_COUNTER(huart->Rx.Timer_Handle, 0U);
-            // HAL_NVIC_EnableIRQ(huart->Rx.IRQn);
-            /*Two interrupts are generated when one data is received?*/
-            // huart->Rx.Finsh_Flag ^= true;
-            huart->Rx.Finsh_Flag = true;
-          }
-          huart->Rx.Filters = 0U;
-          Samp_Bits = 0U;
-        }
-        else
-        {
-          __HAL_TIM_SET_AUTORELOAD(huart->Rx.Timer_Handle, huart->Rx.Sam_Times[huart->Rx.Filters]);
-        }
-      }
-      break;
-      default:
-        break;
-      }
-    }
-  }
+  /*The soft uart timers (TIM3/TIM4) are served directly in their IRQ handlers, see io_uart.c*/
   /* USER CODE END Callback 1 */
 }
 
@@ -365,11 +267,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
-  /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  /* Record the caller in the crash record, drive outputs safe and reset at once
+     instead of spinning until the external watchdog bites */
+  Supervisor_Error(SUPERVISOR_CALLER());
   /* USER CODE END Error_Handler_Debug */
 }
 
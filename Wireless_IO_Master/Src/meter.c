@@ -0,0 +1,197 @@
+#include "meter.h"
+#include "adc.h"
+#include "defer.h"
+#include "io_signal.h"
+#include "mdrtuslave.h"
+#include "shell_port.h"
+
+#if defined(USING_METER)
+#if !defined(USING_ADC_TIMER_TRIGGER)
+#error "USING_METER needs the fixed 1kHz sample rate, enable USING_ADC_TIMER_TRIGGER"
+#endif
+typedef char Meter_Channel_Check[(ADC_DMA_CHANNEL > METER_CHANNEL_V) ? 1 : -1];
+typedef char Meter_Window_Check[((METER_WINDOW % (ADC_SAMPLING_NUM / 2U)) == 0U) ? 1 : -1];
+
+/*电能换算:1uWh = 1000nW * 3600000ms*/
+#define METER_NWMS_PER_UWH 3600000000ULL
+
+static Meter_HandleTypeDef Meter;
+
+/**
+ * @brief	整数平方根
+ * @details	逐位试商，Q30的均方值开方得到Q15的有效值
+ * @param	x 被开方数
+ * @retval	向下取整的平方根
+ */
+static uint32_t Meter_Sqrt(uint32_t x)
+{
+    uint32_t root = 0, bit = 1UL << 30U;
+
+    while (bit > x)
+    {
+        bit >>= 2U;
+    }
+    for (; bit; bit >>= 2U)
+    {
+        if (x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1U) + bit;
+        }
+        else
+        {
+            root >>= 1U;
+        }
+    }
+    return root;
+}
+
+/**
+ * @brief	Q15有效值换算为工程值
+ * @details	有效值(码值) = Q15 / 16，工程值 = 码值 * 增益(Q16) >> 16；交流分量与校准偏移无关
+ * @param	Rms Q15有效值
+ * @param	Gain 校准增益
+ * @retval	工程值(uA/mV)，限幅到16bit
+ */
+static uint16_t Meter_Scale(uint32_t Rms, int32_t Gain)
+{
+    uint64_t value = ((uint64_t)Rms * (uint32_t)((Gain < 0) ? -Gain : Gain) + (1UL << 19U)) >> 20U;
+
+    return (uint16_t)((value > 0xFFFFU) ? 0xFFFFU : value);
+}
+
+/**
+ * @brief	结束一个窗口
+ * @details	由累加值求去除直流分量后的均方值及平均功率(Q30)，开方并按两路的校准增益换算，
+ *			累计正向有功电能并写入输入寄存器；64位除法每窗口几次，不在每个采样中进行
+ * @param	pAcc 窗口的累加值
+ * @retval	None
+ */
+static void Meter_Window(const Meter_Acc *pAcc)
+{
+    int64_t n = pAcc->Count, ms_i, ms_v, p, nw;
+    int32_t gain_i = Io_Analog_Gain(METER_CHANNEL_I), gain_v = Io_Analog_Gain(METER_CHANNEL_V);
+    uint32_t rms_i, rms_v;
+    uint64_t uwh;
+    mdU16 regs[METER_REG_SIZE];
+
+    if (n == 0)
+    {
+        return;
+    }
+    ms_i = ((int64_t)pAcc->Sum_II - (int64_t)pAcc->Sum_I * pAcc->Sum_I / n) / n;
+    ms_v = ((int64_t)pAcc->Sum_VV - (int64_t)pAcc->Sum_V * pAcc->Sum_V / n) / n;
+    p = (pAcc->Sum_VI - (int64_t)pAcc->Sum_V * pAcc->Sum_I / n) / n;
+    rms_i = Meter_Sqrt((uint32_t)((ms_i > 0) ? ms_i : 0));
+    rms_v = Meter_Sqrt((uint32_t)((ms_v > 0) ? ms_v : 0));
+    /*功率(码值^2) = Q30 / 256，nW = 码值^2 * 增益I * 增益V >> 32*/
+    nw = p * gain_i / 65536 * gain_v / 16777216;
+    Meter.Irms = Meter_Scale(rms_i, gain_i);
+    Meter.Vrms = Meter_Scale(rms_v, gain_v);
+    Meter.Power = (int32_t)((nw > INT32_MAX) ? INT32_MAX : ((nw < INT32_MIN) ? INT32_MIN : nw));
+    /*功率因数与增益无关:P / (Irms * Vrms)，均为Q30*/
+    Meter.Pf = (rms_i && rms_v) ? (int16_t)(p * 1000 / ((int64_t)rms_i * rms_v)) : 0;
+    Meter.Pf = (Meter.Pf > 1000) ? 1000 : ((Meter.Pf < -1000) ? -1000 : Meter.Pf);
+    /*窗口长度(ms)等于采样数(1kHz)*/
+    Meter.Energy += (Meter.Power > 0) ? (uint64_t)Meter.Power * pAcc->Count : 0U;
+    Meter.Windows++;
+    uwh = Meter.Energy / METER_NWMS_PER_UWH;
+    regs[METER_REG_IRMS] = Meter.Irms;
+    regs[METER_REG_VRMS] = Meter.Vrms;
+    regs[METER_REG_POWER] = (mdU16)((uint32_t)(Meter.Power / 1000) >> 16U);
+    regs[METER_REG_POWER + 1U] = (mdU16)(uint32_t)(Meter.Power / 1000);
+    regs[METER_REG_ENERGY] = (mdU16)(uwh >> 16U);
+    regs[METER_REG_ENERGY + 1U] = (mdU16)uwh;
+    regs[METER_REG_PF] = (mdU16)Meter.Pf;
+    regs[METER_REG_SEQ] = (mdU16)Meter.Windows;
+    Master_Object->registerPool->ops->mdWriteInputRegisters(Master_Object->registerPool, BOARD_REG_METER,
+                                                            METER_REG_SIZE, regs);
+}
+
+#if defined(USING_DEFER)
+/**
+ * @brief	窗口结束的下半部
+ * @details	在 defer 任务中执行，关中断取出上一个窗口的累加值后换算
+ * @param	Arg 未使用
+ * @retval	None
+ */
+static void Meter_Defer(uint32_t Arg)
+{
+    uint32_t primask = __get_PRIMASK();
+    Meter_Acc acc;
+
+    UNUSED(Arg);
+    __disable_irq();
+    acc = Meter.Done;
+    Meter.Done.Count = 0;
+    __set_PRIMASK(primask);
+    Meter_Window(&acc);
+}
+#endif
+
+/**
+ * @brief	累加半个DMA环
+ * @details	在ADC的DMA半满/全满中断中调用，每个采样3次16x16乘法及64位累加；
+ *			窗口满时交给 defer 任务(未开启时直接换算)，上一个窗口尚未取走时覆盖并计数
+ * @param	pData 半个环的首个采样
+ * @retval	None
+ */
+void Adc_Block_Callback(const uint16_t *pData)
+{
+    const uint16_t *pEnd = pData + ADC_DMA_SIZE / 2U;
+    Meter_Acc *pAcc = &Meter.Acc;
+    int32_t i, v;
+
+    for (; pData < pEnd; pData += ADC_DMA_CHANNEL)
+    {
+        i = ((int32_t)(pData[METER_CHANNEL_I] & 0x0FFFU) - 2048) * 16;
+        v = ((int32_t)(pData[METER_CHANNEL_V] & 0x0FFFU) - 2048) * 16;
+        pAcc->Sum_I += i;
+        pAcc->Sum_V += v;
+        pAcc->Sum_II += (uint32_t)(i * i);
+        pAcc->Sum_VV += (uint32_t)(v * v);
+        pAcc->Sum_VI += v * i;
+    }
+    pAcc->Count += ADC_SAMPLING_NUM / 2U;
+    if (pAcc->Count < METER_WINDOW)
+    {
+        return;
+    }
+#if defined(USING_DEFER)
+    Meter.Overruns += Meter.Done.Count ? 1U : 0U;
+    Meter.Done = *pAcc;
+    Defer_Post(DEFER_SRC_METER, Meter_Defer, 0);
+#else
+    Meter_Window(pAcc);
+#endif
+    memset(pAcc, 0, sizeof(*pAcc));
+}
+
+/**
+ * @brief	清零累计电能
+ * @param	None
+ * @retval	None
+ */
+void Meter_Clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Meter.Energy = 0;
+    __set_PRIMASK(primask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), meter_clear, Meter_Clear, clear metered energy);
+
+/**
+ * @brief	打印计量结果
+ * @param	None
+ * @retval	None
+ */
+void Meter_Show(void)
+{
+    shellPrint(&shell, "irms = %u uA, vrms = %u mV, power = %d uW, pf = %d/1000, energy = %u uWh\r\n", Meter.Irms,
+               Meter.Vrms, (int)(Meter.Power / 1000), Meter.Pf, (uint32_t)(Meter.Energy / METER_NWMS_PER_UWH));
+    shellPrint(&shell, "windows = %u, overruns = %u\r\n", Meter.Windows, Meter.Overruns);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), meter, Meter_Show, show power metering);
+#endif
@@ -0,0 +1,265 @@
+#include "mode.h"
+#include "os_port.h"
+#include "usart.h"
+#include "supervisor.h"
+#include "shell_port.h"
+
+extern Os_Thread shellHandle;
+extern Os_Thread mdbusHandle;
+extern Os_Thread radioHandle;
+extern Os_Thread atHandle;
+extern Os_Timer Timer1Handle;
+
+static Mode_HandleTypeDef Mode = {.Current = MODE_RUN, .Previous = MODE_RUN};
+
+/**
+ * @brief	停放一组对象
+ * @details	调用者所在的任务及已停放的对象跳过
+ * @param	Mask 停放对象
+ * @retval	本次实际停放的对象
+ */
+static uint8_t Mode_Park(uint8_t Mask)
+{
+    Os_Thread self = Os_Self();
+
+    Mask &= (uint8_t)~Mode.Parked;
+    if ((Mask & MODE_PARK_MDBUS) && (mdbusHandle == self))
+    {
+        Mask &= (uint8_t)~MODE_PARK_MDBUS;
+    }
+    if ((Mask & MODE_PARK_RADIO) && (radioHandle == self))
+    {
+        Mask &= (uint8_t)~MODE_PARK_RADIO;
+    }
+    if ((Mask & MODE_PARK_SHELL) && (shellHandle == self))
+    {
+        Mask &= (uint8_t)~MODE_PARK_SHELL;
+    }
+    /*先停止轮询节拍，再挂起任务*/
+    if (Mask & MODE_PARK_POLL)
+    {
+        Os_Timer_Stop(Timer1Handle);
+    }
+    if (Mask & MODE_PARK_RADIO)
+    {
+        Os_Suspend(radioHandle);
+    }
+    if (Mask & MODE_PARK_MDBUS)
+    {
+        Os_Suspend(mdbusHandle);
+    }
+    if (Mask & MODE_PARK_SHELL)
+    {
+        Os_Suspend(shellHandle);
+    }
+    Mode.Parked |= Mask;
+
+    return Mask;
+}
+
+/**
+ * @brief	恢复一组被停放的对象
+ * @details	未停放的对象跳过
+ * @param	Mask 恢复对象
+ * @retval	None
+ */
+static void Mode_Unpark(uint8_t Mask)
+{
+    Mask &= Mode.Parked;
+    Mode.Parked &= (uint8_t)~Mask;
+    if (Mask & MODE_PARK_SHELL)
+    {
+        Os_Resume(shellHandle);
+    }
+    if (Mask & MODE_PARK_MDBUS)
+    {
+        Os_Resume(mdbusHandle);
+    }
+    if (Mask & MODE_PARK_RADIO)
+    {
+        Os_Resume(radioHandle);
+    }
+    if (Mask & MODE_PARK_POLL)
+    {
+        Os_Timer_Start(Timer1Handle, MDTASK_SENDTIMES);
+    }
+}
+
+/**
+ * @brief	初始化工作模式
+ * @details	在创建全部任务后调用；以L101透传时串口归Modbus所有，shell任务停放到进入shell模式
+ * @param	None
+ * @retval	None
+ */
+void Mode_Init(void)
+{
+    Mode.Current = MODE_RUN;
+#if defined(USING_L101)
+    Mode_Park(MODE_PARK_SHELL);
+#endif
+}
+
+/**
+ * @brief	进入工作模式
+ * @details	只停放与新模式冲突的任务，本机I/O扫描照常运行；
+ *          配置模式可从运行或shell模式进入，期间暂停心跳检查；shell模式只能从运行模式进入
+ * @param	Target 目标模式
+ * @retval	false:当前模式不允许切换
+ */
+bool Mode_Enter(Mode_TypeDef Target)
+{
+    bool ret = false;
+
+    Os_Critical_Enter();
+    if (((Target == MODE_CONFIG) && (Mode.Current != MODE_CONFIG)) ||
+        ((Target == MODE_SHELL) && (Mode.Current == MODE_RUN)))
+    {
+        Mode.Previous = Mode.Current;
+        Mode.Current = Target;
+        ret = true;
+    }
+    Os_Critical_Exit();
+    if (!ret)
+    {
+        return false;
+    }
+
+    if (Target == MODE_CONFIG)
+    {
+        /*AT引擎独占串口:Modbus任务不再取帧，轮询暂停，shell不再读取控制台*/
+        Supervisor_Hold();
+        Mode.Config = Mode_Park(MODE_PARK_MDBUS | MODE_PARK_POLL | MODE_PARK_RADIO | MODE_PARK_SHELL);
+    }
+    else
+    {
+        /*只停止接收:排队中的Modbus帧及shell输出继续经DMA发送*/
+        Uart_Dma_Rx_Stop(&Uart1_Dma);
+        Shell_Rx_Start();
+        Mode_Park(MODE_PARK_POLL);
+        Mode_Unpark(MODE_PARK_SHELL);
+    }
+
+    return true;
+}
+
+/**
+ * @brief	退出当前工作模式
+ * @details	配置模式恢复到进入前的模式；shell模式恢复到运行模式
+ * @param	None
+ * @retval	false:无需退出或重新启动接收失败
+ */
+bool Mode_Leave(void)
+{
+    switch (Mode.Current)
+    {
+    case MODE_CONFIG:
+    {
+        Mode_Unpark(Mode.Config);
+        Mode.Config = 0;
+        Mode.Current = Mode.Previous;
+        Supervisor_Release();
+    }
+    break;
+    case MODE_SHELL:
+    {
+        Shell_Rx_Stop();
+        if (!Uart_Dma_Rx_Start(&Uart1_Dma))
+        {
+            Shell_Rx_Start();
+            return false;
+        }
+        Mode.Current = MODE_RUN;
+        Mode_Unpark(MODE_PARK_POLL);
+        /*隧道会话仍需shell任务；否则调用者通常就是shell任务，须最后挂起*/
+        if (!Mode.Tunnel)
+        {
+            Mode.Parked |= MODE_PARK_SHELL;
+            Os_Suspend(shellHandle);
+        }
+    }
+    break;
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief	shell隧道会话开始或结束
+ * @details	在Modbus任务中调用；运行模式下串口仍归Modbus所有，只恢复或停放shell任务，
+ *          shell经隧道取得输入，不读取串口
+ * @param	Open 会话开始/结束
+ * @retval	None
+ */
+void Mode_Tunnel(bool Open)
+{
+    Os_Critical_Enter();
+    Mode.Tunnel = Open;
+    Os_Critical_Exit();
+    if (Mode.Current != MODE_RUN)
+    {
+        return;
+    }
+    if (Open)
+    {
+        Mode_Unpark(MODE_PARK_SHELL);
+    }
+#if defined(USING_L101)
+    else
+    {
+        Mode_Park(MODE_PARK_SHELL);
+    }
+#endif
+}
+
+/**
+ * @brief	当前工作模式
+ * @details
+ * @param	None
+ * @retval	工作模式
+ */
+Mode_TypeDef Mode_Get(void)
+{
+    return Mode.Current;
+}
+
+/**
+ * @brief	请求At任务处理配置
+ * @details	At任务平时阻塞等待，只在有配置请求时运行
+ * @param	Signal 请求信号
+ * @retval	None
+ */
+void Mode_Request(uint32_t Signal)
+{
+    if (atHandle)
+    {
+        Os_Signal_Set(atHandle, Signal);
+    }
+}
+
+/**
+ * @brief	进入自由AT模式
+ * @details	由At任务执行，shell不再读取控制台直至退出
+ * @param	None
+ * @retval	None
+ */
+void Mode_Free(void)
+{
+    Mode_Request(MODE_SIGNAL_FREE);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), g_at, Mode_Free, at_cmd);
+
+/**
+ * @brief	打印工作模式
+ * @details
+ * @param	None
+ * @retval	None
+ */
+void Mode_Show(void)
+{
+    static const char *const name[] = {"run", "config", "shell"};
+
+    shellPrint(&shell, "mode = %s, parked = 0x%02x\r\n", name[Mode.Current], Mode.Parked);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), mode, Mode_Show, show mode);
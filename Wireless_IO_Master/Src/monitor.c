@@ -0,0 +1,120 @@
+#include "monitor.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+
+static Monitor_HandleTypeDef Monitor;
+static TaskStatus_t Monitor_Status[MONITOR_MAX_TASKS];
+static osTimerId Monitor_Timer;
+
+/**
+ * @brief	把运行统计导出到输入寄存器
+ * @details	堆大小超过0xFFFF时按0xFFFF导出
+ * @param	None
+ * @retval	None
+ */
+static void Monitor_Export(void)
+{
+    mdU16 regs[MONITOR_REG_SIZE] = {0};
+    mdU16 *pReg = &regs[4];
+    size_t left = xPortGetFreeHeapSize(), least = xPortGetMinimumEverFreeHeapSize();
+
+    regs[0] = Monitor.Load;
+    regs[1] = (mdU16)((left > 0xFFFFU) ? 0xFFFFU : left);
+    regs[2] = (mdU16)((least > 0xFFFFU) ? 0xFFFFU : least);
+    regs[3] = Monitor.Count;
+    for (uint8_t i = 0; (i < Monitor.Count) && (i < MONITOR_REG_TASKS); i++, pReg += MONITOR_REG_TASK_SIZE)
+    {
+        pReg[0] = Monitor.Task[i].Load;
+        pReg[1] = Monitor.Task[i].Stack;
+    }
+    Monitor.Pool->ops->mdWriteInputRegisters(Monitor.Pool, MONITOR_REG_START_ADDR, MONITOR_REG_SIZE, regs);
+}
+
+/**
+ * @brief	周期统计各任务的CPU占用率及栈余量
+ * @details	在定时器服务任务中调用；运行时间由DWT周期计数器提供，约59s回绕一次，
+ *          只使用周期内的差值，中断的执行时间计入被打断的任务
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Monitor_Poll(void const *argument)
+{
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    uint32_t total, span, run;
+    UBaseType_t count;
+    uint16_t busy = 0;
+    Monitor_Task *pT;
+
+    UNUSED(argument);
+    count = uxTaskGetSystemState(Monitor_Status, MONITOR_MAX_TASKS, &total);
+    span = total - Monitor.Last;
+    Monitor.Last = total;
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        /*任务号从1开始按创建顺序分配*/
+        if ((Monitor_Status[i].xTaskNumber == 0U) || (Monitor_Status[i].xTaskNumber > MONITOR_MAX_TASKS))
+        {
+            continue;
+        }
+        pT = &Monitor.Task[Monitor_Status[i].xTaskNumber - 1U];
+        run = Monitor_Status[i].ulRunTimeCounter - pT->Last;
+        pT->Last = Monitor_Status[i].ulRunTimeCounter;
+        pT->Name = Monitor_Status[i].pcTaskName;
+        pT->Load = span ? (uint16_t)((uint64_t)run * 1000U / span) : 0;
+        pT->Stack = Monitor_Status[i].usStackHighWaterMark;
+        busy += (Monitor_Status[i].xHandle != idle) ? pT->Load : 0;
+        if (Monitor_Status[i].xTaskNumber > Monitor.Count)
+        {
+            Monitor.Count = (uint8_t)Monitor_Status[i].xTaskNumber;
+        }
+    }
+    Monitor.Load = (busy > 1000U) ? 1000U : busy;
+
+    if (Monitor.Pool)
+    {
+        Monitor_Export();
+    }
+}
+
+/**
+ * @brief	启动运行统计
+ * @details	Pool 不为 NULL 时，每个统计周期把结果导出到其输入寄存器
+ * @param	Pool 寄存器池
+ * @retval	None
+ */
+void Monitor_Init(RegisterPoolHandle Pool)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Monitor, Monitor_Poll, &control);
+
+    Monitor.Pool = Pool;
+    Monitor_Timer = osTimerCreate(osTimer(Monitor), osTimerPeriodic, NULL);
+    if (Monitor_Timer)
+    {
+        osTimerStart(Monitor_Timer, MONITOR_PERIOD);
+    }
+}
+
+/**
+ * @brief	打印运行统计
+ * @details	显示上一统计周期的结果
+ * @param	None
+ * @retval	None
+ */
+void Monitor_Show(void)
+{
+    Monitor_Task *pT;
+
+    shellPrint(&shell, "cpu = %d.%d%%, heap = %u, heap min = %u\r\n", Monitor.Load / 10U, Monitor.Load % 10U,
+               xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
+    for (uint8_t i = 0; i < Monitor.Count; i++)
+    {
+        pT = &Monitor.Task[i];
+        if (pT->Name)
+        {
+            shellPrint(&shell, "[%d] %-10s cpu = %2d.%d%%, stack min = %d\r\n", i + 1, pT->Name, pT->Load / 10U,
+                       pT->Load % 10U, pT->Stack);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), top, Monitor_Show, show task load);
@@ -0,0 +1,424 @@
+#include "ota.h"
+#include "L101.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+#endif
+
+#if defined(USING_OTA)
+static Ota_HandleTypeDef Ota;
+
+/*CRC-32(多项式0x04C11DB7，反射)的半字节表，与从站一致*/
+static const uint32_t Ota_Crc_Table[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL,
+};
+
+/**
+ * @brief	计算CRC-32
+ * @param	pData 数据
+ * @param	Length 字节数
+ * @retval	CRC
+ */
+static uint32_t Ota_Crc32(const uint8_t *pData, uint32_t Length)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while (Length--)
+    {
+        crc ^= *pData++;
+        crc = (crc >> 4U) ^ Ota_Crc_Table[crc & 0x0FU];
+        crc = (crc >> 4U) ^ Ota_Crc_Table[crc & 0x0FU];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief	映像的块数
+ * @param	None
+ * @retval	块数
+ */
+static uint16_t Ota_Chunks(void)
+{
+    return (Ota.Length + OTA_CHUNK - 1U) / OTA_CHUNK;
+}
+
+/**
+ * @brief	把全部块标记为待广播
+ * @param	None
+ * @retval	None
+ */
+static void Ota_Need_All(void)
+{
+    memset(Ota.Need, 0, sizeof(Ota.Need));
+    for (uint16_t i = 0; i < Ota_Chunks(); i++)
+    {
+        Ota.Need[i >> 3U] |= 1U << (i & 0x07U);
+    }
+}
+
+/**
+ * @brief	从 Cursor 起查找下一个待广播的块
+ * @param	None
+ * @retval	true 找到(Cursor 指向该块)
+ */
+static bool Ota_Next_Chunk(void)
+{
+    for (; Ota.Cursor < Ota_Chunks(); Ota.Cursor++)
+    {
+        if (Ota.Need[Ota.Cursor >> 3U] & (1U << (Ota.Cursor & 0x07U)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief	从 Node 起查找下一个待查询的从站
+ * @details	只查询映射表中首次出现、位于分发信道且直接可达的从站；经中继访问的从站收不到广播
+ * @param	None
+ * @retval	true 找到
+ */
+static bool Ota_Next_Node(void)
+{
+    uint16_t addr, next;
+    uint8_t id, ch, other, other_ch;
+    bool seen;
+
+    for (; L101_Node_At(Ota.Node, &id, &addr, &ch); Ota.Node++)
+    {
+        seen = false;
+        for (uint16_t j = 0; !seen && (j < Ota.Node); j++)
+        {
+            seen = L101_Node_At(j, &other, &next, &other_ch) && (other == id);
+        }
+        if (!seen && (ch == Ota.Channel) && L101_Find_Node(id, &next, &other_ch) && (next == addr))
+        {
+            Ota.Slave = id;
+            Ota.Addr = addr;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief	一轮查询结束
+ * @details	各从站都已校验映像时激活，否则补发缺块；超过 OTA_ROUNDS 轮时分发失败
+ * @param	None
+ * @retval	None
+ */
+static void Ota_Round_End(void)
+{
+    Ota.Cursor = 0;
+    Ota.Repeat = 0;
+    if (!Ota.Need_Begin && !Ota_Next_Chunk())
+    {
+        Ota.Step = OTA_ACTIVATE;
+        return;
+    }
+    Ota.Cursor = 0;
+    Ota.Step = (++Ota.Stats.Rounds > OTA_ROUNDS) ? OTA_FAILED : (Ota.Need_Begin ? OTA_BEGIN : OTA_STREAM);
+}
+
+/**
+ * @brief	处理查询应答
+ * @details	缺块位图并入待广播的块；缺块多于一个窗口时从下一窗口继续查询同一从站
+ * @param	p 从机地址+PDU+CRC
+ * @param	Length 帧长
+ * @retval	true 应答有效
+ */
+static bool Ota_Reply(const uint8_t *p, uint16_t Length)
+{
+    uint16_t missing, start, bits = 0, chunk;
+
+    if ((Length != 2U + OTA_STATUS_SIZE + 2U) || (p[1] != MODBUS_CODE_OTA) || (p[2] != OTA_OP_STATUS))
+    {
+        return false;
+    }
+    missing = ToU16(p[5], p[6]);
+    start = ToU16(p[7], p[8]);
+    if ((p[3] != Ota.Session) || (p[4] == OTA_STATE_NONE))
+    {
+        /*从站没有本次会话:重发开始帧及全部块*/
+        Ota.Need_Begin = true;
+        Ota_Need_All();
+    }
+    else if (p[4] == OTA_STATE_VERIFIED)
+    {
+        Ota.Stats.Verified++;
+    }
+    else
+    {
+        for (uint16_t i = 0; i < OTA_WINDOW; i++)
+        {
+            chunk = start + i;
+            if ((p[9U + (i >> 3U)] & (1U << (i & 0x07U))) && (chunk < Ota_Chunks()))
+            {
+                Ota.Need[chunk >> 3U] |= 1U << (chunk & 0x07U);
+                bits++;
+            }
+        }
+        if ((bits < missing) && ((uint32_t)start + OTA_WINDOW < Ota_Chunks()))
+        {
+            Ota.From = start + OTA_WINDOW;
+            return true;
+        }
+    }
+    Ota.Node++;
+    Ota.From = 0;
+
+    return true;
+}
+
+/**
+ * @brief	请求完成
+ * @details	在接收任务或轮询调用者的上下文中执行；广播发出即完成
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Ota_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    switch (Ota.Step)
+    {
+    case OTA_BEGIN:
+        if (++Ota.Repeat >= OTA_REPEATS)
+        {
+            Ota.Need_Begin = false;
+            Ota.Cursor = 0;
+            Ota.Step = OTA_STREAM;
+        }
+        break;
+    case OTA_QUERY:
+        if ((result == MASTER_RESULT_OK) && (request->reply != NULL) && Ota_Reply(request->reply, request->replyLength))
+        {
+            Ota.Retry = 0;
+        }
+        else if (++Ota.Retry > OTA_RETRIES)
+        {
+            Ota.Stats.Lost++;
+            Ota.Retry = 0;
+            Ota.Node++;
+            Ota.From = 0;
+        }
+        break;
+    case OTA_ACTIVATE:
+        Ota.Step = (++Ota.Repeat >= OTA_REPEATS) ? OTA_DONE : OTA_ACTIVATE;
+        break;
+    default:
+        break;
+    }
+    Ota.Pending = false;
+}
+
+/**
+ * @brief	构造当前步骤的请求帧
+ * @param	None
+ * @retval	从机地址+PDU+CRC 的长度
+ */
+static uint16_t Ota_Build(void)
+{
+    uint8_t *p = &Ota.Frame[MASTER_PREFIX_SIZE];
+    uint32_t offset = (uint32_t)Ota.Cursor * OTA_CHUNK;
+    uint16_t len = 0, n, crc;
+
+    p[len++] = (Ota.Step == OTA_QUERY) ? Ota.Slave : MODBUS_BROADCAST_ID;
+    p[len++] = MODBUS_CODE_OTA;
+    switch (Ota.Step)
+    {
+    case OTA_BEGIN:
+        p[len++] = OTA_OP_BEGIN;
+        p[len++] = Ota.Session;
+        for (int8_t i = 24; i >= 0; i -= 8)
+        {
+            p[len++] = (uint8_t)(Ota.Length >> i);
+        }
+        for (int8_t i = 24; i >= 0; i -= 8)
+        {
+            p[len++] = (uint8_t)(Ota.Crc >> i);
+        }
+        p[len++] = Ota.Version >> 8U;
+        p[len++] = Ota.Version;
+        break;
+    case OTA_STREAM:
+        n = ((Ota.Length - offset) < OTA_CHUNK) ? (Ota.Length - offset) : OTA_CHUNK;
+        p[len++] = OTA_OP_DATA;
+        p[len++] = Ota.Session;
+        p[len++] = Ota.Cursor >> 8U;
+        p[len++] = Ota.Cursor;
+        memcpy(&p[len], (const uint8_t *)OTA_IMAGE_ADDR + offset, n);
+        len += n;
+        break;
+    case OTA_QUERY:
+        p[len++] = OTA_OP_STATUS;
+        p[len++] = Ota.Session;
+        p[len++] = Ota.From >> 8U;
+        p[len++] = Ota.From;
+        break;
+    default:
+        p[len++] = OTA_OP_ACTIVATE;
+        p[len++] = Ota.Session;
+        break;
+    }
+    crc = mdCrc16(p, len);
+    p[len++] = (uint8_t)crc;
+    p[len++] = (uint8_t)(crc >> 8U);
+
+    return len;
+}
+
+/**
+ * @brief	提交分发的下一个请求
+ * @details	在调度任务中执行，同时只有一个请求在途，广播的节奏由请求引擎的就绪检查(模块空闲)决定；
+ *			先广播全部块，再逐个查询从站的缺块，按缺块的并集补发，各从站都校验通过后广播激活
+ * @param	None
+ * @retval	None
+ */
+void Ota_Submit(void)
+{
+    struct ModbusRTURequest request;
+    bool query;
+
+    if ((Client_Object == NULL) || Ota.Pending || (Ota.Step < OTA_BEGIN) || (Ota.Step > OTA_ACTIVATE))
+    {
+        return;
+    }
+    if ((Ota.Step == OTA_STREAM) && !Ota_Next_Chunk())
+    {
+        Ota.Step = OTA_QUERY;
+        Ota.Node = 0;
+        Ota.From = 0;
+        Ota.Retry = 0;
+        Ota.Stats.Verified = 0;
+    }
+    if ((Ota.Step == OTA_QUERY) && !Ota_Next_Node())
+    {
+        Ota_Round_End();
+        return;
+    }
+    query = (Ota.Step == OTA_QUERY);
+    memset(&request, 0, sizeof(request));
+    request.prefix[0] = (uint8_t)((query ? Ota.Addr : L101_BROADCAST_ADDR) >> 8U);
+    request.prefix[1] = (uint8_t)(query ? Ota.Addr : L101_BROADCAST_ADDR);
+    request.prefix[2] = Ota.Channel;
+    request.prefixLength = MASTER_PREFIX_SIZE;
+#if defined(USING_L101_RADIO2)
+    request.port = Radio2_Port(Ota.Channel);
+#endif
+    request.frame = &Ota.Frame[MASTER_PREFIX_SIZE];
+    request.frameLength = Ota_Build();
+    request.slaveId = request.frame[0];
+    request.code = MODBUS_CODE_OTA;
+    request.timeout = OTA_TIMEOUT;
+    request.callback = Ota_Done;
+    Ota.Pending = true;
+    if (!mdRTU_Submit(Client_Object, &request))
+    {
+        Ota.Pending = false;
+        return;
+    }
+    if (Ota.Step == OTA_STREAM)
+    {
+        /*广播不确认，漏收的块由查询补发*/
+        Ota.Need[Ota.Cursor >> 3U] &= ~(1U << (Ota.Cursor & 0x07U));
+        Ota.Cursor++;
+        Ota.Stats.Chunks++;
+    }
+    Ota.Stats.Queries += query ? 1U : 0U;
+}
+
+/**
+ * @brief	开始分发
+ * @details	映像须已由烧录器写入 OTA_IMAGE_ADDR；同一信道上的从站同时接收，
+ *			从站校验映像后写入映像描述并复位，由引导程序安装；开启帧认证时不能广播，拒绝分发
+ * @param	channel 从站所在信道
+ * @param	length 映像字节数
+ * @param	version 映像版本
+ * @retval	0 成功 0xFF 参数错误、没有映像或已有分发进行中
+ */
+uint8_t Ota_Start(int channel, int length, int version)
+{
+    uint32_t crc;
+    bool same;
+
+    if ((channel < 0) || (channel > 0xFF) || (length <= 0) || (length > (int)OTA_IMAGE_MAX) || (version < 0) ||
+        (version > 0xFFFF) || ((Ota.Step >= OTA_BEGIN) && (Ota.Step <= OTA_ACTIVATE)) || Ota.Pending ||
+        (*(const uint32_t *)OTA_IMAGE_ADDR == 0xFFFFFFFFUL))
+    {
+        return 0xFF;
+    }
+#if (MODBUS_AUTH)
+    if ((Client_Object != NULL) && (Client_Object->auth != NULL))
+    {
+        return 0xFF;
+    }
+#endif
+    crc = Ota_Crc32((const uint8_t *)OTA_IMAGE_ADDR, (uint32_t)length);
+    same = (Ota.Session != 0) && (Ota.Channel == channel) && (Ota.Length == (uint32_t)length) && (Ota.Crc == crc) &&
+           (Ota.Version == version);
+    Ota.Channel = channel;
+    Ota.Length = length;
+    Ota.Version = version;
+    Ota.Crc = crc;
+    /*重新分发同一映像时沿用会话，先查询，只补发各从站的缺块*/
+    if (same)
+    {
+        memset(Ota.Need, 0, sizeof(Ota.Need));
+    }
+    else
+    {
+        Ota.Session++;
+        Ota_Need_All();
+    }
+    Ota.Need_Begin = false;
+    Ota.Cursor = 0;
+    Ota.Repeat = 0;
+    Ota.Retry = 0;
+    memset(&Ota.Stats, 0, sizeof(Ota.Stats));
+    Ota.Step = same ? OTA_STREAM : OTA_BEGIN;
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), ota_start, Ota_Start, start firmware distribution);
+
+/**
+ * @brief	停止分发
+ * @details	已在途的请求照常结束；从站保留已收到的块，之后以相同参数开始时只补发缺块
+ * @param	None
+ * @retval	0
+ */
+uint8_t Ota_Stop(void)
+{
+    Ota.Step = OTA_IDLE;
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), ota_stop, Ota_Stop, stop firmware distribution);
+
+/**
+ * @brief	打印分发状态及统计
+ * @param	None
+ * @retval	None
+ */
+void Ota_Show(void)
+{
+    static const char *const steps[] = {"idle", "begin", "stream", "query", "activate", "done", "failed"};
+    Ota_Stats *pO = &Ota.Stats;
+    uint16_t need = 0;
+
+    for (uint16_t i = 0; i < Ota_Chunks(); i++)
+    {
+        need += (Ota.Need[i >> 3U] & (1U << (i & 0x07U))) ? 1U : 0U;
+    }
+    shellPrint(&shell, "step = %s, session = %d, ch = %d, version = %d, length = %u, crc = 0x%08x, need = %d/%d\r\n",
+               steps[Ota.Step], Ota.Session, Ota.Channel, Ota.Version, Ota.Length, Ota.Crc, need, Ota_Chunks());
+    shellPrint(&shell, "chunks = %u, queries = %u, lost = %u, verified = %d, rounds = %d\r\n", pO->Chunks,
+               pO->Queries, pO->Lost, pO->Verified, pO->Rounds);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), ota, Ota_Show, show firmware distribution);
+#endif
@@ -0,0 +1,233 @@
+#include "pulse.h"
+#include "io_signal.h"
+#include "mdrtuslave.h"
+#include "L101.h"
+#include "kv.h"
+#include "os_port.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_PULSE)
+typedef char Pulse_Mask_Check[(BOARD_DIGITAL_COUNT <= 8U) ? 1 : -1];
+/*频率更新间隔内DWT周期计数不回绕(72MHz时约59s)*/
+typedef char Pulse_Zero_Check[(PULSE_ZERO_TIME < 50000U) ? 1 : -1];
+
+static Pulse_HandleTypeDef Pulse = {{0, 0, PULSE_DEADBAND_DEFAULT}};
+
+/**
+ * @brief	加载计数模式配置
+ * @param	None
+ * @retval	None
+ */
+void Pulse_Init(void)
+{
+    Pulse_Config config;
+
+    if (Kv_Get(KV_KEY_PULSE, &config, sizeof(config)) == sizeof(config))
+    {
+        Pulse.Config = config;
+    }
+    Pulse.Config.Mask &= (uint8_t)((1UL << BOARD_DIGITAL_COUNT) - 1U);
+    Pulse.Tick = HAL_GetTick();
+}
+
+/**
+ * @brief	数字量输入边沿计数
+ * @details	由边沿中断调用：计数通道只在有效电平的边沿上加1并记录时刻，其余通道交给去抖处理
+ * @param	Channel 通道号
+ * @param	Level 边沿后的输入电平(已翻转光耦的输入信号)
+ * @retval	true 计数通道(调用者不再处理该边沿)
+ */
+bool Pulse_Edge(uint16_t Channel, bool Level)
+{
+    Pulse_Channel *pC = &Pulse.Channel[Channel];
+
+    if (!(Pulse.Config.Mask & (1U << Channel)))
+    {
+        return false;
+    }
+    if (Level)
+    {
+        pC->Last = DWT->CYCCNT;
+        pC->Count++;
+    }
+    return true;
+}
+
+/**
+ * @brief	计算一个通道的频率
+ * @details	周期内有新脉冲时以首末脉冲之间的周期数计算(分辨率不受更新周期限制)；
+ *			没有新脉冲时频率不高于距最后一个脉冲时长的倒数，超过 PULSE_ZERO_TIME 记为0
+ * @param	pC 通道
+ * @param	Now 当前DWT周期计数
+ * @retval	None
+ */
+static void Pulse_Measure(Pulse_Channel *pC, uint32_t Now)
+{
+    uint32_t count, last, primask, cycles;
+    uint64_t freq;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    count = pC->Count;
+    last = pC->Last;
+    __set_PRIMASK(primask);
+
+    if (count != pC->Ref_Count)
+    {
+        cycles = last - pC->Ref_Last;
+        if (pC->Ref_Valid && cycles)
+        {
+            freq = ((uint64_t)(count - pC->Ref_Count) * SystemCoreClock * 10U) / cycles;
+            pC->Freq = (freq > 0xFFFFU) ? 0xFFFFU : (uint16_t)freq;
+        }
+        pC->Ref_Count = count;
+        pC->Ref_Last = last;
+        pC->Ref_Valid = true;
+        return;
+    }
+    cycles = Now - pC->Ref_Last;
+    if (!pC->Ref_Valid || (cycles / (SystemCoreClock / 1000U) >= PULSE_ZERO_TIME))
+    {
+        /*之后的首个脉冲重新作为起点*/
+        pC->Ref_Valid = false;
+        pC->Freq = 0;
+        return;
+    }
+    freq = ((uint64_t)SystemCoreClock * 10U) / cycles;
+    pC->Freq = (freq < pC->Freq) ? (uint16_t)freq : pC->Freq;
+}
+
+/**
+ * @brief	更新计数通道的寄存器
+ * @details	在输入任务中调用：到达 PULSE_PERIOD 时计算各计数通道的频率，计数及频率写入输入寄存器，
+ *			频率变化超过死区的通道写入原始码值并标记发送
+ * @param	None
+ * @retval	距下次更新的时间(ms)，没有计数通道时为 osWaitForever
+ */
+uint32_t Pulse_Update(void)
+{
+    uint32_t now = HAL_GetTick(), elapsed = now - Pulse.Tick, cycles = DWT->CYCCNT;
+    mdU16 regs[PULSE_CHANNEL_REGS], hz, delta;
+
+    if (!Pulse.Config.Mask)
+    {
+        return osWaitForever;
+    }
+    if (elapsed < PULSE_PERIOD)
+    {
+        return PULSE_PERIOD - elapsed;
+    }
+    Pulse.Tick = now;
+    for (uint16_t i = 0; i < BOARD_DIGITAL_COUNT; i++)
+    {
+        Pulse_Channel *pC = &Pulse.Channel[i];
+
+        if (!(Pulse.Config.Mask & (1U << i)))
+        {
+            continue;
+        }
+        Pulse_Measure(pC, cycles);
+        regs[0] = (mdU16)(pC->Ref_Count >> 16U);
+        regs[1] = (mdU16)pC->Ref_Count;
+        regs[2] = pC->Freq;
+        Master_Object->registerPool->ops->mdWriteInputRegisters(Master_Object->registerPool,
+                                                           BOARD_REG_PULSE + i * PULSE_CHANNEL_REGS,
+                                                           PULSE_CHANNEL_REGS, regs);
+        /*本机模拟量通道占用的原始码值不写入*/
+        if ((i < BOARD_ANALOG_COUNT) || !Pulse.Config.Deadband)
+        {
+            continue;
+        }
+        hz = (mdU16)((pC->Freq + 5U) / 10U);
+        hz = (hz > PULSE_FREQ_MAX) ? PULSE_FREQ_MAX : hz;
+        delta = (hz > pC->Published) ? (hz - pC->Published) : (pC->Published - hz);
+        if (delta < Pulse.Config.Deadband)
+        {
+            continue;
+        }
+        pC->Published = hz;
+        mdRTU_WriteHoldRegs(Master_Object, ANALOG_RAW_START_ADDR + i, 1U, hz);
+#if defined(USING_COS_MODE)
+        Set_L101_Analog(i);
+#endif
+    }
+    return PULSE_PERIOD;
+}
+
+/**
+ * @brief	设置计数模式
+ * @details	立即保存；退出计数模式的通道下一个边沿起恢复去抖及输入线圈
+ * @param	mask 计数模式的通道(位)
+ * @param	deadband 无线发送的死区(Hz)，0 不发送
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Pulse_Set(int mask, int deadband)
+{
+    Pulse_Config config = {0};
+
+    if ((mask < 0) || (mask >= (1 << BOARD_DIGITAL_COUNT)) || (deadband < 0) || (deadband > PULSE_FREQ_MAX))
+    {
+        return 0xFF;
+    }
+    config.Mask = (uint8_t)mask;
+    config.Deadband = (uint16_t)deadband;
+    Os_Critical_Enter();
+    for (uint16_t i = 0; i < BOARD_DIGITAL_COUNT; i++)
+    {
+        /*新进入计数模式的通道从下一个脉冲起测频*/
+        if ((config.Mask & ~Pulse.Config.Mask) & (1U << i))
+        {
+            Pulse.Channel[i].Ref_Valid = false;
+            Pulse.Channel[i].Freq = 0;
+        }
+    }
+    Pulse.Config = config;
+    Os_Critical_Exit();
+
+    return Kv_Set(KV_KEY_PULSE, &config, sizeof(config)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), pulse_set, Pulse_Set, set pulse mask deadband_hz);
+
+/**
+ * @brief	计数清零
+ * @param	channel 通道号，负数时清零全部通道
+ * @retval	None
+ */
+void Pulse_Clear(int channel)
+{
+    for (uint16_t i = 0; i < BOARD_DIGITAL_COUNT; i++)
+    {
+        if ((channel >= 0) && (channel != i))
+        {
+            continue;
+        }
+        Os_Critical_Enter();
+        Pulse.Channel[i].Count = 0;
+        Pulse.Channel[i].Ref_Count = 0;
+        Os_Critical_Exit();
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), pulse_clear, Pulse_Clear, clear pulse count);
+
+/**
+ * @brief	打印计数通道的计数及频率
+ * @param	None
+ * @retval	None
+ */
+void Pulse_Show(void)
+{
+    shellPrint(&shell, "mask = 0x%02x, deadband = %u Hz\r\n", Pulse.Config.Mask, Pulse.Config.Deadband);
+    for (uint16_t i = 0; i < BOARD_DIGITAL_COUNT; i++)
+    {
+        Pulse_Channel *pC = &Pulse.Channel[i];
+
+        if (Pulse.Config.Mask & (1U << i))
+        {
+            shellPrint(&shell, "di%d count = %u, freq = %u.%u Hz, published = %u Hz\r\n", i, pC->Count, pC->Freq / 10U,
+                       pC->Freq % 10U, pC->Published);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), pulse, Pulse_Show, show pulse counters);
+#endif
@@ -0,0 +1,221 @@
+#include "radio2.h"
+#include "L101.h"
+#include "io_uart.h"
+#include "kv.h"
+#include "os_port.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+#if defined(USING_TDMA)
+#include "tdma.h"
+#endif
+
+#if defined(USING_L101_RADIO2)
+#if !defined(USING_IO_UART)
+#error "USING_L101_RADIO2 needs the soft uart, enable USING_IO_UART"
+#endif
+#if defined(USING_GATEWAY)
+#error "USING_L101_RADIO2 and USING_GATEWAY both use the soft uart"
+#endif
+
+typedef char Radio2_Plan_Size_Check[(RADIO2_PLAN_SIZE <= KV_VALUE_MAX) ? 1 : -1];
+
+static Radio2_HandleTypeDef Radio2;
+/*应答帧由本任务交给请求引擎，只使用当前帧字段*/
+static struct ReceiveBuffer Radio2_Rx;
+
+/**
+ * @brief	请求引擎端口1的发送函数
+ * @details	在调度任务中调用，整帧拷贝后由软件串口任务发出，不阻塞调度
+ * @param	handler 主站请求引擎句柄
+ * @param	data 整帧(含L101帧头)
+ * @param	length 帧长
+ * @retval	None
+ */
+static mdVOID Radio2_Send(ModbusRTUMasterHandler handler, mdU8 *data, mdU32 length)
+{
+    if (Radio2.Tx_Pending || (length > sizeof(Radio2.Tx_Buf)))
+    {
+        Radio2.Stats.Drop++;
+        return;
+    }
+    memcpy(Radio2.Tx_Buf, data, length);
+    Radio2.Tx_Length = length;
+    Radio2.Tx_Pending = true;
+}
+
+/**
+ * @brief	第二个L101模块是否可以发送
+ * @details	上一帧已写出且间隔不小于 RADIO2_TX_GAP；开启时隙接入时还须处于本主站的时隙
+ * @param	None
+ * @retval	true 可以发送
+ */
+bool Radio2_Ready(void)
+{
+    bool ready = !Radio2.Tx_Pending && ((uint32_t)(Os_Tick() - Radio2.Tx_End) >= RADIO2_TX_GAP);
+
+#if defined(USING_TDMA)
+    ready = ready && Tdma_Open();
+#endif
+    return ready;
+}
+
+/**
+ * @brief	请求引擎端口1的就绪检查
+ * @param	handler 主站请求引擎句柄
+ * @retval	mdTRUE 可以发送
+ */
+static mdBOOL Radio2_Port_Ready(ModbusRTUMasterHandler handler)
+{
+    return Radio2_Ready() ? mdTRUE : mdFALSE;
+}
+
+/**
+ * @brief	加载信道分配表并登记请求引擎端口
+ * @details	在调度列表初始化时调用；无有效记录时所有信道由第一个模块服务
+ * @param	None
+ * @retval	None
+ */
+void Radio2_Init(void)
+{
+    if (Kv_Get(KV_KEY_RADIO, Radio2.Plan, sizeof(Radio2.Plan)) != sizeof(Radio2.Plan))
+    {
+        memset(Radio2.Plan, 0, sizeof(Radio2.Plan));
+    }
+    Radio2.Tx_End = Os_Tick() - RADIO2_TX_GAP;
+    if (Client_Object != NULL)
+    {
+        mdRTUMasterAttach(Client_Object, RADIO2_PORT, Radio2_Send, Radio2_Port_Ready);
+    }
+}
+
+/**
+ * @brief	取得信道所属的请求引擎端口
+ * @param	Channel 从站信道
+ * @retval	0:第一个模块 RADIO2_PORT:第二个模块
+ */
+uint8_t Radio2_Port(uint8_t Channel)
+{
+    return (Radio2.Plan[Channel >> 3U] & (1U << (Channel & 0x07U))) ? RADIO2_PORT : 0U;
+}
+
+/**
+ * @brief	接收一帧
+ * @details	等待首字节至多 Wait ms，之后字节间隔超过 RADIO2_FRAME_GAP 时帧结束；超出 Size 的字节丢弃
+ * @param	pBuf 缓冲区
+ * @param	Size 缓冲区字节数
+ * @param	Wait 首字节等待时间(ms)
+ * @retval	收到的字节数(可大于 Size)，0:没有数据
+ */
+static uint16_t Radio2_Receive(uint8_t *pBuf, uint16_t Size, uint32_t Wait)
+{
+    uint16_t len = 0;
+    uint8_t data;
+
+    if (HAL_SUART_Receive(&S_Uart1, &data, 1U, Wait) != HAL_OK)
+    {
+        return 0;
+    }
+    do
+    {
+        if (len < Size)
+        {
+            pBuf[len] = data;
+        }
+        len = (len < 0xFFFFU) ? (len + 1U) : len;
+    } while (HAL_SUART_Receive(&S_Uart1, &data, 1U, RADIO2_FRAME_GAP) == HAL_OK);
+
+    return len;
+}
+
+/**
+ * @brief	第二个模块的一次收发
+ * @details	在软件串口任务中执行：先发出请求引擎交来的请求，再接收一帧应答交给请求引擎的端口1；
+ *			模块工作在定点模式，收到的应答不带帧头
+ * @param	Wait 首字节等待时间(ms)
+ * @retval	None
+ */
+void Radio2_Process(uint32_t Wait)
+{
+    uint16_t len;
+
+    if (Radio2.Tx_Pending)
+    {
+        HAL_SUART_Transmit(&S_Uart1, Radio2.Tx_Buf, Radio2.Tx_Length, RADIO2_TX_TIMEOUT);
+        Radio2.Tx_End = Os_Tick();
+        Radio2.Tx_Pending = false;
+        Radio2.Stats.Tx++;
+    }
+    len = Radio2_Receive(Radio2_Rx.frame[0].buf, sizeof(Radio2_Rx.frame[0].buf), Wait);
+    if ((len == 0) || (Client_Object == NULL))
+    {
+        return;
+    }
+    Radio2.Stats.Rx++;
+    if (len > sizeof(Radio2_Rx.frame[0].buf))
+    {
+        Radio2.Stats.Bad_Frame++;
+        return;
+    }
+    Radio2_Rx.buf = Radio2_Rx.frame[0].buf;
+    Radio2_Rx.count = len;
+    /*正确帧连同CRC计算的结果为0；CRC错误的应答同样交给请求引擎，对应请求立即按错误结束*/
+    Radio2_Rx.crcValid = ((len >= 4U) && (mdCrc16(Radio2_Rx.buf, len) == 0)) ? mdTRUE : mdFALSE;
+#if (MODBUS_FEC)
+    mdFecReceive(&Radio2_Rx, &Client_Object->fec);
+#endif
+    Radio2.Stats.Bad_Frame += Radio2_Rx.crcValid ? 0U : 1U;
+    mdRTU_ResponseOn(Client_Object, RADIO2_PORT, &Radio2_Rx);
+}
+
+/**
+ * @brief	设置信道由哪个模块服务
+ * @details	同一信道上的从站应答均回到服务该信道的模块，从站的应答信道须设为该模块的信道；
+ *			运行中修改后，已在途的请求仍在原模块上等待应答
+ * @param	channel 信道
+ * @param	radio 0:第一个模块 1:第二个模块
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Radio2_Set(int channel, int radio)
+{
+    if ((channel < 0) || (channel > 0xFF) || (radio < 0) || (radio > 1))
+    {
+        return 0xFF;
+    }
+    Os_Critical_Enter();
+    if (radio)
+    {
+        Radio2.Plan[channel >> 3U] |= 1U << (channel & 0x07U);
+    }
+    else
+    {
+        Radio2.Plan[channel >> 3U] &= ~(1U << (channel & 0x07U));
+    }
+    Os_Critical_Exit();
+
+    return Kv_Set(KV_KEY_RADIO, Radio2.Plan, sizeof(Radio2.Plan)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_radio, Radio2_Set, set channel radio);
+
+/**
+ * @brief	打印信道分配及第二个模块的统计
+ * @param	None
+ * @retval	None
+ */
+void Radio2_Show(void)
+{
+    Radio2_Stats *pR = &Radio2.Stats;
+
+    shellPrint(&shell, "radio2 channels:");
+    for (uint16_t ch = 0; ch <= 0xFFU; ch++)
+    {
+        if (Radio2_Port((uint8_t)ch))
+        {
+            shellPrint(&shell, " %d", ch);
+        }
+    }
+    shellPrint(&shell, "\r\nrx = %u, tx = %u, bad = %u, drop = %u, pending = %u\r\n", pR->Rx, pR->Tx, pR->Bad_Frame,
+               pR->Drop, Client_Object ? Client_Object->ports[RADIO2_PORT].pending : 0U);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101_radio_show, Radio2_Show, show l101 radio plan);
+#endif
@@ -0,0 +1,196 @@
+#include "rbe.h"
+#include "boot.h"
+#include "mdrtuslave.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_RBE)
+typedef char Rbe_Ring_Pow2[((RBE_RING_SIZE & (RBE_RING_SIZE - 1U)) == 0) ? 1 : -1];
+typedef char Rbe_Seq_Pow2[((RBE_SEQ_WRAP & (RBE_SEQ_WRAP - 1U)) == 0) && (RBE_RING_SIZE < RBE_SEQ_WRAP) ? 1 : -1];
+
+static Rbe_HandleTypeDef Rbe;
+
+/**
+ * @brief	记入一条事件
+ * @details	关中断后调用；环满时覆盖最早的事件
+ * @param	Ref 点号
+ * @param	Value 新值
+ * @param	Tick 时刻(ms)
+ * @retval	None
+ */
+static void Rbe_Push(uint16_t Ref, uint16_t Value, uint32_t Tick)
+{
+    Rbe_Event *pEvent = &Rbe.Ring[Rbe.Head % RBE_RING_SIZE];
+
+    pEvent->Ref = Ref;
+    pEvent->Value = Value;
+    pEvent->Tick = Tick;
+    Rbe.Head++;
+}
+
+/**
+ * @brief	寄存器池变化回调
+ * @details	在写入方的上下文中调用(任务或中断)，关中断期间最多记入16条事件；
+ *			线圈组的 changed 即变化的位，寄存器按死区过滤
+ * @param	handler 寄存器池
+ * @param	index 变化标记表下标
+ * @param	changed 新旧值的异或
+ * @param	arg 未使用
+ * @retval	None
+ */
+static mdVOID Rbe_Changed(RegisterPoolHandle handler, mdU32 index, mdU16 changed, mdVOID *arg)
+{
+    uint16_t value = handler->coils[index], ref, slot, diff;
+    uint32_t primask, tick = HAL_GetTick();
+
+    UNUSED(arg);
+    if ((index >= REGISTER_POOL_INPUT_REGISTERS + RBE_INPUT_END) && (index < REGISTER_POOL_HOLD_REGISTERS))
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (index < REGISTER_POOL_INPUT_REGISTERS)
+    {
+        ref = (index < REGISTER_POOL_INPUT_COILS)
+                  ? (uint16_t)(COIL_OFFSET + (index - REGISTER_POOL_COILS) * REGISTER_WIDTH)
+                  : (uint16_t)(INPUT_COIL_OFFSET + (index - REGISTER_POOL_INPUT_COILS) * REGISTER_WIDTH);
+        for (uint16_t bit = 0; changed; bit++, changed >>= 1U)
+        {
+            if (changed & 0x01)
+            {
+                Rbe_Push(ref + bit, (value >> bit) & 0x01, tick);
+            }
+        }
+    }
+    else
+    {
+        if (index < REGISTER_POOL_HOLD_REGISTERS)
+        {
+            slot = (uint16_t)(index - REGISTER_POOL_INPUT_REGISTERS);
+            ref = INPUT_REGISTER_OFFSET + slot;
+        }
+        else
+        {
+            slot = (uint16_t)(RBE_INPUT_END + index - REGISTER_POOL_HOLD_REGISTERS);
+            ref = (uint16_t)(HOLD_REGISTER_OFFSET + index - REGISTER_POOL_HOLD_REGISTERS);
+        }
+        diff = (value > Rbe.Last[slot]) ? (value - Rbe.Last[slot]) : (Rbe.Last[slot] - value);
+        if (diff < Rbe.Deadband)
+        {
+            Rbe.Suppressed++;
+        }
+        else
+        {
+            Rbe.Last[slot] = value;
+            Rbe_Push(ref, value, tick);
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief	初始化变化上报
+ * @details	以当前寄存器值作为上次上报值，订阅整个寄存器池(统计区在回调中过滤，只占一个订阅)
+ * @param	Pool 寄存器池
+ * @retval	None
+ */
+void Rbe_Init(RegisterPoolHandle Pool)
+{
+    memset(&Rbe, 0, sizeof(Rbe));
+    Rbe.Deadband = RBE_DEADBAND;
+    if (Pool == NULL)
+    {
+        return;
+    }
+    memcpy(Rbe.Last, Pool->inputRegisters, RBE_INPUT_END * sizeof(uint16_t));
+    memcpy(&Rbe.Last[RBE_INPUT_END], Pool->holdRegisters, HOLD_REGISTER_POOL_SIZE * sizeof(uint16_t));
+    Pool->ops->mdSubscribe(Pool, REGISTER_POOL_COILS, REGISTER_POOL_WORDS, Rbe_Changed, NULL);
+}
+
+/**
+ * @brief	变化上报的启动模块:订阅本机从站的寄存器池(网关的本机从站共用)
+ * @param	None
+ * @retval	None
+ */
+static void Rbe_Boot_Init(void)
+{
+    Rbe_Init(Master_Object->registerPool);
+}
+BOOT_MODULE(rbe, BOOT_LEVEL_MAIN, Rbe_Boot_Init, "modbus");
+
+/**
+ * @brief	读取序号之后的事件
+ * @details	Seq 为读取方已收到的最后一条事件的序号(取模后)，返回其后由旧到新的最多 Max 条事件；
+ *			其后的事件已被覆盖(或序号不属于本次上电，如主站复位后)时从环中最早的事件读起并置 *pLost
+ * @param	Seq 已收到的序号
+ * @param	pEvents 读出的事件
+ * @param	Max 最多读出的条数
+ * @param	pFirst 第一条读出事件的序号
+ * @param	pLatest 最新事件的序号
+ * @param	pLost 是否有事件丢失
+ * @retval	读出的条数
+ */
+uint16_t Rbe_Since(uint16_t Seq, Rbe_Event *pEvents, uint16_t Max, uint16_t *pFirst, uint16_t *pLatest, bool *pLost)
+{
+    uint32_t primask, head, held, behind;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    head = Rbe.Head;
+    held = (head < RBE_RING_SIZE) ? head : RBE_RING_SIZE;
+    behind = (head - Seq) % RBE_SEQ_WRAP;
+    *pLost = (behind > held);
+    behind = *pLost ? held : behind;
+    Max = (behind < Max) ? (uint16_t)behind : Max;
+    for (uint16_t i = 0; i < Max; i++)
+    {
+        pEvents[i] = Rbe.Ring[(head - behind + i) % RBE_RING_SIZE];
+    }
+    Rbe.Lost += *pLost ? 1U : 0U;
+    __set_PRIMASK(primask);
+    *pFirst = (uint16_t)((head - behind + 1U) % RBE_SEQ_WRAP);
+    *pLatest = (uint16_t)(head % RBE_SEQ_WRAP);
+
+    return Max;
+}
+
+/**
+ * @brief	修改寄存器的死区
+ * @details	与上次上报值之差不小于死区时上报，0为每次变化都上报；线圈不受影响
+ * @param	deadband 死区
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Rbe_Set_Deadband(int deadband)
+{
+    if ((deadband < 0) || (deadband > 0xFFFF))
+    {
+        return 0xFF;
+    }
+    Rbe.Deadband = (uint16_t)deadband;
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), rbe_deadband, Rbe_Set_Deadband, set report by exception register deadband);
+
+/**
+ * @brief	打印变化上报的统计及最近的事件
+ * @param	None
+ * @retval	None
+ */
+void Rbe_Show(void)
+{
+    uint32_t head = Rbe.Head;
+    uint32_t held = (head < RBE_RING_SIZE) ? head : RBE_RING_SIZE;
+    Rbe_Event event;
+
+    shellPrint(&shell, "events = %u, latest seq = %u, deadband = %u, lost = %u, suppressed = %u\r\n", head,
+               head % RBE_SEQ_WRAP, Rbe.Deadband, Rbe.Lost, Rbe.Suppressed);
+    for (uint32_t i = 0; i < held; i++)
+    {
+        event = Rbe.Ring[(head - 1U - i) % RBE_RING_SIZE];
+        shellPrint(&shell, "[%u] %u = %u @ %u ms\r\n", (head - i) % RBE_SEQ_WRAP, event.Ref, event.Value, event.Tick);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), rbe, Rbe_Show, show report by exception events);
+#endif
@@ -0,0 +1,155 @@
+#include "regwatch.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+
+static Regwatch_HandleTypeDef Regwatch;
+static osTimerId Regwatch_Timer;
+
+/**
+ * @brief	打印一组寄存器内容
+ * @details	线圈/输入线圈按位打印，Start、Count 为位地址及位数；输入/保持寄存器按16进制打印
+ * @param	Type 寄存器组(REGWATCH_xxx)
+ * @param	Start 组内起始地址
+ * @param	Count 个数，不大于0时为1
+ * @retval	None
+ */
+void Regwatch_Dump(int Type, int Start, int Count)
+{
+    RegisterPoolHandle pool = Regwatch.Pool;
+    mdU16 regs[REGWATCH_DUMP_REGS];
+    mdBit bits[REGWATCH_DUMP_BITS];
+    uint32_t addr = (uint32_t)Start, n;
+    mdSTATUS ret = mdTRUE;
+
+    if (!pool || (Start < 0))
+    {
+        return;
+    }
+    Count = (Count > 0) ? Count : 1;
+    for (; (Count > 0) && (ret == mdTRUE); Count -= (int)n, addr += n)
+    {
+        switch (Type)
+        {
+        case REGWATCH_COILS:
+        case REGWATCH_INPUT_COILS:
+            n = ((uint32_t)Count < REGWATCH_DUMP_BITS) ? (uint32_t)Count : REGWATCH_DUMP_BITS;
+            ret = (Type == REGWATCH_COILS) ? pool->ops->mdReadCoils(pool, addr, n, bits)
+                                           : pool->ops->mdReadInputCoils(pool, addr, n, bits);
+            shellPrint(&shell, "%dx%04x:", Type, addr);
+            for (uint32_t i = 0; i < n; i++)
+            {
+                shellPrint(&shell, "%s%d", (i % 4U) ? "" : " ", bits[i]);
+            }
+            break;
+        case REGWATCH_INPUT_REGISTERS:
+        case REGWATCH_HOLD_REGISTERS:
+            n = ((uint32_t)Count < REGWATCH_DUMP_REGS) ? (uint32_t)Count : REGWATCH_DUMP_REGS;
+            ret = (Type == REGWATCH_INPUT_REGISTERS) ? pool->ops->mdReadInputRegisters(pool, addr, n, regs)
+                                                     : pool->ops->mdReadHoldRegisters(pool, addr, n, regs);
+            shellPrint(&shell, "%dx%04x:", Type, addr);
+            for (uint32_t i = 0; i < n; i++)
+            {
+                shellPrint(&shell, " %04x", regs[i]);
+            }
+            break;
+        default:
+            shellPrint(&shell, "type: 0 coil, 1 input coil, 3 input register, 4 hold register\r\n");
+            return;
+        }
+        shellPrint(&shell, "%s\r\n", (ret == mdTRUE) ? "" : " (out of range)");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), regdump, Regwatch_Dump, dump type start count);
+
+/**
+ * @brief	输出上一周期内变化的寄存器
+ * @details	在定时器服务任务中调用；只格式化带变化标记的寄存器，日志缓冲区不足时
+ *			重新置位标记并结束本周期，线圈/输入线圈以16位为一组输出
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Regwatch_Poll(void const *argument)
+{
+    RegisterPoolHandle pool = Regwatch.Pool;
+    char line[32];
+    uint32_t index = 0, type, word, base;
+    mdU16 value;
+    int len;
+
+    UNUSED(argument);
+    for (uint32_t n = 0; n < REGWATCH_MAX_CHANGES; n++, index++)
+    {
+        index = pool->ops->mdTakeDirty(pool, index);
+        if (index >= REGISTER_POOL_WORDS)
+        {
+            break;
+        }
+        if (index >= REGISTER_POOL_HOLD_REGISTERS)
+        {
+            type = REGWATCH_HOLD_REGISTERS, word = index - REGISTER_POOL_HOLD_REGISTERS, base = HOLD_REGISTER_OFFSET;
+        }
+        else if (index >= REGISTER_POOL_INPUT_REGISTERS)
+        {
+            type = REGWATCH_INPUT_REGISTERS, word = index - REGISTER_POOL_INPUT_REGISTERS, base = INPUT_REGISTER_OFFSET;
+        }
+        else if (index >= REGISTER_POOL_INPUT_COILS)
+        {
+            type = REGWATCH_INPUT_COILS, word = index - REGISTER_POOL_INPUT_COILS, base = INPUT_COIL_OFFSET;
+        }
+        else
+        {
+            type = REGWATCH_COILS, word = index, base = COIL_OFFSET;
+        }
+        /*标记先于读取清除，读取后的改写会在下一周期再次输出*/
+        pool->ops->mdReadU16(pool, base + word, &value);
+        len = snprintf(line, sizeof(line), "%ux%04x = %04x\r\n", type,
+                       (base < INPUT_REGISTER_OFFSET) ? word * REGISTER_WIDTH : word, value);
+        if (!Shell_Log_Write(line, (unsigned short)len))
+        {
+            pool->dirty[index] = 1U;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief	初始化寄存器监视
+ * @details	只创建监视定时器，由 regwatch 命令启动
+ * @param	Pool 被监视的寄存器池
+ * @retval	None
+ */
+void Regwatch_Init(RegisterPoolHandle Pool)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Regwatch, Regwatch_Poll, &control);
+
+    Regwatch.Pool = Pool;
+    Regwatch_Timer = osTimerCreate(osTimer(Regwatch), osTimerPeriodic, NULL);
+}
+
+/**
+ * @brief	启动或停止寄存器监视
+ * @details	启动时丢弃已有的变化标记，此后每个周期只输出有变化的寄存器
+ * @param	Period 监视周期(ms)，为0时停止，小于 REGWATCH_MIN_PERIOD 时按 REGWATCH_MIN_PERIOD
+ * @retval	None
+ */
+void Regwatch_Start(uint32_t Period)
+{
+    RegisterPoolHandle pool = Regwatch.Pool;
+
+    if (!Regwatch_Timer || !pool)
+    {
+        return;
+    }
+    osTimerStop(Regwatch_Timer);
+    Regwatch.Period = Period ? ((Period < REGWATCH_MIN_PERIOD) ? REGWATCH_MIN_PERIOD : Period) : 0;
+    if (Regwatch.Period)
+    {
+        for (uint32_t index = 0; index < REGISTER_POOL_WORDS; index++)
+        {
+            index = pool->ops->mdTakeDirty(pool, index);
+        }
+        osTimerStart(Regwatch_Timer, Regwatch.Period);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), regwatch, Regwatch_Start, watch registers period);
@@ -0,0 +1,378 @@
+#include "route.h"
+#include "io_signal.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "L101.h"
+#include "Flash.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+/*路由表在flash中的记录*/
+typedef struct
+{
+    uint16_t Magic;
+    uint8_t Version;
+    uint8_t Count;
+    Route_Entry Entry[ROUTE_MAX_ENTRIES];
+    uint16_t Crc16;
+} Route_Record __attribute__((aligned(2)));
+
+typedef struct
+{
+    /*配置的路由条目(源、目标)*/
+    Route_Entry Entry[ROUTE_MAX_ENTRIES];
+    uint8_t Count;
+    /*编译结果:按源点归并的扇出表*/
+    Route_Source Sources[ROUTE_MAX_ENTRIES];
+    Route_Fanout Fanout[ROUTE_MAX_ENTRIES];
+    uint8_t Source_Count;
+    /*本机数字量通道到路由源的直接索引，边沿处理无需查找*/
+    uint8_t Digital_Index[EXTERN_DIGITAL_MAX];
+} Route_HandleTypeDef;
+
+static Route_HandleTypeDef Route;
+
+/*默认路由表由板级配置展开:本机数字量输入 n 驱动线圈 BOARD_REG_OUTPUT + n，与节点映射表的默认线圈地址一致*/
+#define ROUTE_DEFAULT_ENTRY(ch, port, pin, addr, chan, id) [ch] = {ROUTE_SRC_DIGITAL, 0, (ch), BOARD_REG_OUTPUT + (ch)},
+static const Route_Entry Route_Defaults[EXTERN_DIGITAL_MAX] = {BOARD_DIGITAL_TABLE(ROUTE_DEFAULT_ENTRY)};
+typedef char Route_Defaults_Size_Check[(EXTERN_DIGITAL_MAX <= ROUTE_MAX_ENTRIES) ? 1 : -1];
+
+/**
+ * @brief	默认路由表
+ * @details	从flash中的默认表拷贝
+ * @param	None
+ * @retval	None
+ */
+static void Route_Default(void)
+{
+    memcpy(Route.Entry, Route_Defaults, sizeof(Route_Defaults));
+    Route.Count = EXTERN_DIGITAL_MAX;
+}
+
+/**
+ * @brief	编译路由表
+ * @details	同一源点的条目归并为连续的扇出表，源点变化时只遍历自己的扇出；
+ *			各源点的电平置为未传播，下一次输入或轮询时重新驱动目标线圈
+ * @param	None
+ * @retval	None
+ */
+static void Route_Build(void)
+{
+    uint8_t fill[ROUTE_MAX_ENTRIES];
+    uint16_t i, j;
+
+    Route.Source_Count = 0;
+    memset(Route.Digital_Index, ROUTE_NONE, sizeof(Route.Digital_Index));
+    /*第一遍:统计各源点的扇出数*/
+    for (i = 0; i < Route.Count; i++)
+    {
+        const Route_Entry *pE = &Route.Entry[i];
+
+        for (j = 0; j < Route.Source_Count; j++)
+        {
+            if ((Route.Sources[j].Type == pE->Type) && (Route.Sources[j].Source == pE->Source))
+            {
+                break;
+            }
+        }
+        if (j == Route.Source_Count)
+        {
+            Route.Sources[j].Type = pE->Type;
+            Route.Sources[j].Source = pE->Source;
+            Route.Sources[j].State = ROUTE_NONE;
+            Route.Sources[j].Count = 0;
+            Route.Source_Count++;
+            if ((pE->Type == ROUTE_SRC_DIGITAL) && (pE->Source < EXTERN_DIGITAL_MAX))
+            {
+                Route.Digital_Index[pE->Source] = (uint8_t)j;
+            }
+        }
+        Route.Sources[j].Count++;
+    }
+    /*第二遍:分配扇出区间并填入目标*/
+    for (i = 0, j = 0; i < Route.Source_Count; j += Route.Sources[i].Count, i++)
+    {
+        Route.Sources[i].First = (uint8_t)j;
+        fill[i] = 0;
+    }
+    for (i = 0; i < Route.Count; i++)
+    {
+        const Route_Entry *pE = &Route.Entry[i];
+        Route_Fanout *pF;
+
+        for (j = 0; (Route.Sources[j].Type != pE->Type) || (Route.Sources[j].Source != pE->Source); j++)
+        {
+        }
+        pF = &Route.Fanout[Route.Sources[j].First + fill[j]++];
+        pF->Target = pE->Target;
+        pF->Invert = pE->Invert ? 1U : 0U;
+    }
+}
+
+/**
+ * @brief	运行时重新编译路由表
+ * @details	输入任务及调度节拍可能正在使用扇出表，编译期间禁止任务切换
+ * @param	None
+ * @retval	None
+ */
+static void Route_Compile(void)
+{
+    taskENTER_CRITICAL();
+    Route_Build();
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	从flash中加载路由表
+ * @details	记录头、版本及CRC校验均正确时才覆盖默认路由表
+ * @param	None
+ * @retval	true 加载成功 false 无有效记录
+ */
+static bool Route_Load(void)
+{
+    /*直接读取flash中的记录，不拷贝*/
+    const Route_Record *pRecord = (const Route_Record *)FLASH_Map(ADDR_FLASH_PAGE_X(ROUTE_PAGE), sizeof(Route_Record));
+
+    if (pRecord == NULL)
+    {
+        return false;
+    }
+    if ((pRecord->Magic != ROUTE_MAGIC) || (pRecord->Version != ROUTE_VERSION) ||
+        (pRecord->Count > ROUTE_MAX_ENTRIES) ||
+        (pRecord->Crc16 != mdCrc16((uint8_t *)pRecord, offsetof(Route_Record, Crc16))))
+    {
+        return false;
+    }
+    memcpy(Route.Entry, pRecord->Entry, sizeof(Route.Entry));
+    Route.Count = pRecord->Count;
+
+    return true;
+}
+
+/**
+ * @brief	初始化路由表
+ * @details	flash中无有效记录时使用默认路由表，随后编译为扇出表；在调度开始前调用
+ * @param	None
+ * @retval	None
+ */
+void Route_Init(void)
+{
+    if (!Route_Load())
+    {
+        Route_Default();
+    }
+    Route_Build();
+}
+
+/**
+ * @brief	把源点的新电平传播到扇出目标
+ * @details	目标线圈电平变化时才写入，调度器经寄存器池的变化订阅立即下发映射到该线圈的节点；
+ *			多个源点驱动同一线圈时以最后变化的源点为准
+ * @param	pSrc 路由源
+ * @param	Value 新电平
+ * @retval	None
+ */
+static void Route_Propagate(Route_Source *pSrc, uint8_t Value)
+{
+    const Route_Fanout *pF = &Route.Fanout[pSrc->First];
+    mdBit bit, old;
+
+    pSrc->State = Value;
+    for (uint16_t i = 0; i < pSrc->Count; i++, pF++)
+    {
+        bit = (mdBit)(Value ^ pF->Invert);
+        if ((mdRTU_ReadCoil(Master_Object, pF->Target, old) == mdTRUE) && (old == bit))
+        {
+            continue;
+        }
+        /*写入线圈，线圈变化由寄存器池的变化订阅通知调度器*/
+        if (mdRTU_WriteCoil(Master_Object, pF->Target, bit) == mdFALSE)
+        {
+#if defined(USING_DEBUG)
+            shellPrint(&shell, "route: coil[%d] = %d failed\r\n", pF->Target, bit);
+#endif
+        }
+    }
+}
+
+/**
+ * @brief	本机数字量输入变化
+ * @details	由数字量输入处理在去抖后调用，经直接索引找到路由源，代价与扇出数成正比
+ * @param	Channel 通道号
+ * @param	Value 新电平
+ * @retval	None
+ */
+void Route_Digital(uint16_t Channel, uint8_t Value)
+{
+    uint8_t index = (Channel < EXTERN_DIGITAL_MAX) ? Route.Digital_Index[Channel] : ROUTE_NONE;
+
+    if (index != ROUTE_NONE)
+    {
+        Route_Propagate(&Route.Sources[index], Value);
+    }
+}
+
+/**
+ * @brief	轮询输入线圈及模拟量报警类路由源
+ * @details	在调度节拍中调用；只比较各源点的当前电平，变化的源点才遍历扇出
+ * @param	None
+ * @retval	None
+ */
+void Route_Poll(void)
+{
+    mdU16 alarm = 0;
+    mdBit bit = 0;
+    uint8_t value;
+
+    if (Master_Object == NULL)
+    {
+        return;
+    }
+    Master_Object->registerPool->ops->mdReadInputRegister(Master_Object->registerPool, ANALOG_ALARM_ADDR, &alarm);
+    for (uint16_t i = 0; i < Route.Source_Count; i++)
+    {
+        Route_Source *pSrc = &Route.Sources[i];
+
+        switch (pSrc->Type)
+        {
+        case ROUTE_SRC_INPUT:
+            if (Master_Object->registerPool->ops->mdReadInputCoil(Master_Object->registerPool, pSrc->Source, &bit) == mdFALSE)
+            {
+                continue;
+            }
+            value = bit ? 1U : 0U;
+            break;
+        case ROUTE_SRC_ALARM:
+            value = (pSrc->Source < 16U) ? ((alarm >> pSrc->Source) & 0x01) : 0U;
+            break;
+        default:
+            continue;
+        }
+        if (value != pSrc->State)
+        {
+            Route_Propagate(pSrc, value);
+        }
+    }
+}
+
+/**
+ * @brief	增加一条路由
+ * @details	立即重新编译；保存到flash需执行 route_save
+ * @param	type 源类型 0:本机数字量 1:输入线圈 2:模拟量报警位
+ * @param	source 源点(通道号/输入线圈地址/报警位号)
+ * @param	target 目标线圈地址
+ * @param	invert 是否取反
+ * @retval	0 成功 0xFF 参数错误或路由表满
+ */
+uint8_t Route_Add(int type, int source, int target, int invert)
+{
+    Route_Entry *pE;
+
+    if ((type < 0) || (type >= (int)ROUTE_SRC_TYPES) || (source < 0) || (source > 0xFFFF) || (target < 0) ||
+        (target > 0xFFFF) || ((type == ROUTE_SRC_DIGITAL) && (source >= (int)EXTERN_DIGITAL_MAX)) ||
+        (Route.Count >= ROUTE_MAX_ENTRIES))
+    {
+        return 0xFF;
+    }
+    pE = &Route.Entry[Route.Count++];
+    pE->Type = (uint8_t)type;
+    pE->Invert = invert ? 1U : 0U;
+    pE->Source = (uint16_t)source;
+    pE->Target = (uint16_t)target;
+    Route_Compile();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), route_add, Route_Add, add route type source target invert);
+
+/**
+ * @brief	删除一条路由
+ * @param	index 条目号，小于0时清空路由表
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Route_Del(int index)
+{
+    if (index >= (int)Route.Count)
+    {
+        return 0xFF;
+    }
+    if (index < 0)
+    {
+        Route.Count = 0;
+    }
+    else
+    {
+        memmove(&Route.Entry[index], &Route.Entry[index + 1], (Route.Count - index - 1U) * sizeof(Route_Entry));
+        Route.Count--;
+    }
+    Route_Compile();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), route_del, Route_Del, delete route index);
+
+/**
+ * @brief	恢复默认路由表
+ * @param	None
+ * @retval	None
+ */
+void Route_Reset(void)
+{
+    Route_Default();
+    Route_Compile();
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), route_reset, Route_Reset, restore default routes);
+
+/**
+ * @brief	保存路由表到flash
+ * @details	记录交给flash任务在后台写入，不等待擦写完成
+ * @param	None
+ * @retval	0 已提交 0xFF 上次保存尚未完成
+ */
+uint8_t Route_Save(void)
+{
+    static Route_Record record;
+    static Flash_Request request = {.Address = ADDR_FLASH_PAGE_X(ROUTE_PAGE), .pData = (const uint16_t *)&record,
+                                    .Size = sizeof(record) / 2U};
+
+    if (request.State == FLASH_REQ_PENDING)
+    {
+        return 0xFF;
+    }
+    memset(&record, 0x00, sizeof(record));
+    record.Magic = ROUTE_MAGIC;
+    record.Version = ROUTE_VERSION;
+    record.Count = Route.Count;
+    memcpy(record.Entry, Route.Entry, sizeof(record.Entry));
+    record.Crc16 = mdCrc16((uint8_t *)&record, offsetof(Route_Record, Crc16));
+
+    return FLASH_Post(&request) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), route_save, Route_Save, save routes);
+
+/**
+ * @brief	打印编译后的路由表
+ * @param	None
+ * @retval	None
+ */
+void Route_Show(void)
+{
+    static const char *const type[ROUTE_SRC_TYPES] = {"di", "input", "alarm"};
+
+    shellPrint(&shell, "routes: %d/%d, sources: %d\r\n", Route.Count, ROUTE_MAX_ENTRIES, Route.Source_Count);
+    for (uint16_t i = 0; i < Route.Source_Count; i++)
+    {
+        const Route_Source *pSrc = &Route.Sources[i];
+
+        shellPrint(&shell, "%s[%d] = %d ->", (pSrc->Type < ROUTE_SRC_TYPES) ? type[pSrc->Type] : "?", pSrc->Source,
+                   (pSrc->State == ROUTE_NONE) ? -1 : pSrc->State);
+        for (uint16_t j = 0; j < pSrc->Count; j++)
+        {
+            shellPrint(&shell, " %scoil[%d]", Route.Fanout[pSrc->First + j].Invert ? "!" : "",
+                       Route.Fanout[pSrc->First + j].Target);
+        }
+        shellPrint(&shell, "\r\n");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), route_show, Route_Show, show routes);
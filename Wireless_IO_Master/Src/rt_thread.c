@@ -1,5 +1,5 @@
 #include "main.h"
-#include "rtthread.h"
+#include "os_port.h"
 #include "shell.h"
 #include "at_usr.h"
 #include "mdrtuslave.h"
@@ -58,6 +58,9 @@ static void readio_task_entry(void *parameter);
 /*初始化线程函数*/
 void MX_RT_Thread_Init(void)
 {
+	/*shell输出在持锁时可能再次加锁，RT-Thread互斥量本身可递归*/
+	shellMutexHandle = rt_mutex_create("shellMutex", RT_IPC_FLAG_PRIO);
+
 	/*创建定时器1周期定时器 */
 	timer1 = rt_timer_create("timer1", timer_callback,
 							 SOFT_TIMER0, TIMER0_MS,
@@ -73,7 +76,11 @@ void MX_RT_Thread_Init(void)
 									SHELL_TIMESLICE);
 	/*如果获得线程控制块,启动这个线程 */
 	if (shell_thread != RT_NULL)
+	{
+		/*应用代码经 Os_Signal_Wait 等待中断通知*/
+		Os_Signal_Attach(shell_thread);
 		rt_thread_startup(shell_thread);
+	}
 
 	at_thread = rt_thread_create("at",
 									at_task_entry, RT_NULL,
@@ -82,7 +89,10 @@ void MX_RT_Thread_Init(void)
 									AT_TIMESLICE);
 	/*如果获得线程控制块,启动这个线程 */
 	if (at_thread != RT_NULL)
+	{
+		Os_Signal_Attach(at_thread);
 		rt_thread_startup(at_thread);
+	}
 
 	mdrtus_thread = rt_thread_create("modbus",
 									 mdrtus_task_entry, RT_NULL,
@@ -91,7 +101,10 @@ void MX_RT_Thread_Init(void)
 									 MDRTUS_TIMESLICE);
 	/*如果获得线程控制块,启动这个线程 */
 	if (mdrtus_thread != RT_NULL)
+	{
+		Os_Signal_Attach(mdrtus_thread);
 		rt_thread_startup(mdrtus_thread);
+	}
 
 	readio_thread = rt_thread_create("read_io",
 									 readio_task_entry, RT_NULL,
@@ -100,7 +113,10 @@ void MX_RT_Thread_Init(void)
 									 READIO_TIMESLICE);
 	/*如果获得线程控制块,启动这个线程 */
 	if (readio_thread != RT_NULL)
+	{
+		Os_Signal_Attach(readio_thread);
 		rt_thread_startup(readio_thread);
+	}
 }
 
 /*定时器超时函数 */
@@ -133,7 +149,7 @@ void mdrtus_task_entry(void *parameter)
 {
 	while (1)
 	{
-		mdRTU_Handler();
+		mdRTU_Handler(Master_Object);
 		rt_thread_delay(2);
 	}
 }
@@ -0,0 +1,198 @@
+#include "scene.h"
+#include "L101.h"
+#include "xfer.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+#endif
+
+#if defined(USING_SCENE)
+typedef char Scene_Table_Size_Check[(SCENE_TABLE_SIZE <= XFER_RAW_SIZE) ? 1 : -1];
+
+static Scene_HandleTypeDef Scene;
+
+/**
+ * @brief	请求完成
+ * @details	广播请求发出即完成；单播时应答须回显场景号
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Scene_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    const uint8_t *p = request->reply;
+
+    if ((result == MASTER_RESULT_OK) && (Scene.Slave != MODBUS_BROADCAST_ID) &&
+        ((p == NULL) || (request->replyLength < 3U) || (p[1] != MODBUS_CODE_SCENE) || (p[2] != Scene.Index)))
+    {
+        /*异常应答记录从站的异常码*/
+        result = ((p != NULL) && (request->replyLength >= 3U) && (p[1] & 0x80U)) ? (0x80U | p[2]) : MASTER_RESULT_ERROR;
+    }
+    Scene.Result = result;
+    Scene.Stats.Acked += (result == MASTER_RESULT_OK) ? 1U : 0U;
+    Scene.Stats.Failed += (result != MASTER_RESULT_OK) ? 1U : 0U;
+    Scene.Pending = false;
+}
+
+/**
+ * @brief	提交排队的场景请求
+ * @details	在调度任务中执行(请求引擎只由该任务提交)；请求队列已满时下一节拍再提交，不重发
+ * @param	None
+ * @retval	None
+ */
+void Scene_Submit(void)
+{
+    struct ModbusRTURequest request;
+    uint8_t *p = Scene.Frame;
+    uint16_t crc;
+
+    if ((Client_Object == NULL) || !Scene.Queued || Scene.Pending)
+    {
+        return;
+    }
+    p[0] = Scene.Slave;
+    p[1] = MODBUS_CODE_SCENE;
+    p[2] = Scene.Index;
+    crc = mdCrc16(p, 3U);
+    p[3] = (uint8_t)crc;
+    p[4] = (uint8_t)(crc >> 8U);
+    memset(&request, 0, sizeof(request));
+    request.prefix[0] = (uint8_t)(Scene.Addr >> 8U);
+    request.prefix[1] = (uint8_t)Scene.Addr;
+    request.prefix[2] = Scene.Channel;
+    request.prefixLength = MASTER_PREFIX_SIZE;
+#if defined(USING_L101_RADIO2)
+    request.port = Radio2_Port(Scene.Channel);
+#endif
+    request.frame = p;
+    request.frameLength = 5U;
+    request.slaveId = Scene.Slave;
+    request.code = MODBUS_CODE_SCENE;
+    request.timeout = SCENE_TIMEOUT;
+    request.callback = Scene_Done;
+    Scene.Pending = true;
+    if (!mdRTU_Submit(Client_Object, &request))
+    {
+        Scene.Pending = false;
+        return;
+    }
+    Scene.Queued = false;
+    Scene.Stats.Sent++;
+}
+
+/**
+ * @brief	执行从站的场景
+ * @details	一帧切换场景中的全部输出，代替逐个写线圈；广播时同一信道上的从站同时执行，不确认，
+ *			开启帧认证时不能广播
+ * @param	slave 从站号，0:广播
+ * @param	index 场景号
+ * @param	channel 广播的信道(单播时按节点映射表，忽略)
+ * @retval	0 已排队 0xFF 参数错误、从站不在节点映射表中或上一请求未完成
+ */
+uint8_t Scene_Apply(int slave, int index, int channel)
+{
+    uint16_t addr = L101_BROADCAST_ADDR;
+    uint8_t ch = (uint8_t)channel;
+
+    if ((slave < 0) || (slave >= MODBUS_BROADCAST_ID) || (index < 0) || (index >= (int)SCENE_MAX) ||
+        (channel < 0) || (channel > 0xFF) || Scene.Queued || Scene.Pending)
+    {
+        return 0xFF;
+    }
+    if ((slave != 0) && !L101_Find_Node((uint8_t)slave, &addr, &ch))
+    {
+        return 0xFF;
+    }
+#if (MODBUS_AUTH)
+    if ((slave == 0) && (Client_Object != NULL) && (Client_Object->auth != NULL))
+    {
+        return 0xFF;
+    }
+#endif
+    Scene.Slave = slave;
+    Scene.Addr = addr;
+    Scene.Channel = ch;
+    Scene.Index = index;
+    Scene.Queued = true;
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene_apply, Scene_Apply, apply slave scene slave index channel);
+
+/**
+ * @brief	编辑待下发的场景表
+ * @details	掩码都为0时场景未定义
+ * @param	index 场景号
+ * @param	coil_mask 线圈掩码(第i位为输出线圈i)
+ * @param	coil_value 线圈值
+ * @param	aout_mask 模拟量掩码
+ * @param	aout0 模拟量0(12bit码值)
+ * @param	aout1 模拟量1(12bit码值)
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Scene_Edit(int index, int coil_mask, int coil_value, int aout_mask, int aout0, int aout1)
+{
+    uint8_t *p;
+
+    if ((index < 0) || (index >= (int)SCENE_MAX) || (coil_mask < 0) || (coil_mask > 0xFFFF) || (coil_value < 0) ||
+        (coil_value > 0xFFFF) || (aout_mask < 0) || (aout_mask >= (1 << SCENE_AOUT_MAX)) || (aout0 < 0) ||
+        (aout0 > 0xFFFF) || (aout1 < 0) || (aout1 > 0xFFFF))
+    {
+        return 0xFF;
+    }
+    p = &Scene.Table[index * SCENE_WIRE_SIZE];
+    p[0] = (uint8_t)(coil_mask >> 8U);
+    p[1] = (uint8_t)coil_mask;
+    p[2] = (uint8_t)(coil_value >> 8U);
+    p[3] = (uint8_t)coil_value;
+    p[4] = (uint8_t)aout_mask;
+    p[5] = 0;
+    p[6] = (uint8_t)(aout0 >> 8U);
+    p[7] = (uint8_t)aout0;
+    p[8] = (uint8_t)(aout1 >> 8U);
+    p[9] = (uint8_t)aout1;
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene_edit, Scene_Edit, edit scene index coil_mask coil_value aout_mask aout0 aout1);
+
+#if defined(USING_XFER)
+/**
+ * @brief	把待下发的场景表写入从站
+ * @details	经分块传输一次写入整个表(xfer 命令查看进度)，从站逐个场景保存到flash
+ * @param	slave 从站号
+ * @retval	0 成功 0xFF 参数错误或已有传输会话进行中
+ */
+uint8_t Scene_Put(int slave)
+{
+    return Xfer_Write(slave, XFER_OBJ_SCENE, Scene.Table, SCENE_TABLE_SIZE);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene_put, Scene_Put, write scene table to slave);
+#endif
+
+/**
+ * @brief	打印待下发的场景表及统计
+ * @param	None
+ * @retval	None
+ */
+void Scene_Show(void)
+{
+    const uint8_t *p = Scene.Table;
+
+    for (uint8_t i = 0; i < SCENE_MAX; i++, p += SCENE_WIRE_SIZE)
+    {
+        if (p[0] || p[1] || p[4])
+        {
+            shellPrint(&shell, "[%d] coils = 0x%02x%02x/0x%02x%02x, aout = 0x%x: %u %u\r\n", i, p[2], p[3], p[0], p[1],
+                       p[4], (p[6] << 8U) | p[7], (p[8] << 8U) | p[9]);
+        }
+    }
+    shellPrint(&shell, "slave = %d, scene = %d, %s, result = 0x%02x, sent = %u, acked = %u, failed = %u\r\n", Scene.Slave,
+               Scene.Index, Scene.Pending ? "pending" : (Scene.Queued ? "queued" : "idle"), Scene.Result,
+               Scene.Stats.Sent, Scene.Stats.Acked, Scene.Stats.Failed);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene, Scene_Show, show scenes);
+#endif
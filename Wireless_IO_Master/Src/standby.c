@@ -0,0 +1,258 @@
+#include "standby.h"
+#include "kv.h"
+#include "os_port.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_STANDBY)
+typedef char Standby_Config_Size_Check[(sizeof(Standby_Config) <= KV_VALUE_MAX) ? 1 : -1];
+
+static Standby_HandleTypeDef Standby = {.Cfg = {.Role = STANDBY_OFF, .Period_Ms = 1000U}, .Active = true};
+
+/**
+ * @brief	写入32位值(高字节在前)
+ * @param	p 写入位置
+ * @param	Value 值
+ * @retval	下一写入位置
+ */
+static uint8_t *Standby_Put(uint8_t *p, uint32_t Value)
+{
+    p[0] = Value >> 24U;
+    p[1] = Value >> 16U;
+    p[2] = Value >> 8U;
+    p[3] = Value;
+    return p + 4U;
+}
+
+/**
+ * @brief	读出32位值(高字节在前)
+ * @param	p 读出位置
+ * @retval	值
+ */
+static uint32_t Standby_Get(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24U) | ((uint32_t)p[1] << 16U) | ((uint32_t)p[2] << 8U) | p[3];
+}
+
+/**
+ * @brief	接管时间(ms)
+ * @param	None
+ * @retval	STANDBY_MISSES 个镜像周期
+ */
+static uint32_t Standby_Timeout(void)
+{
+    return (uint32_t)STANDBY_MISSES * Standby.Cfg.Period_Ms;
+}
+
+/**
+ * @brief	加载热备配置
+ * @details	在恢复调度状态后调用；上电时先作为备用监听，主用等待一个接管时间、备用等待两个，
+ *			期间收到对方的镜像则保持备用(对方已在工作)
+ * @param	None
+ * @retval	None
+ */
+void Standby_Init(void)
+{
+    Standby_Config cfg;
+
+    if ((Kv_Get(KV_KEY_STANDBY, &cfg, sizeof(cfg)) == sizeof(cfg)) && (cfg.Role <= STANDBY_BACKUP) &&
+        (cfg.Period_Ms >= STANDBY_PERIOD_MIN) && (cfg.Period_Ms <= STANDBY_PERIOD_MAX))
+    {
+        Standby.Cfg = cfg;
+    }
+    Standby.Active = (Standby.Cfg.Role == STANDBY_OFF);
+    Standby.Rx_New = false;
+    Standby.Last_Rx = Os_Tick() + ((Standby.Cfg.Role == STANDBY_BACKUP) ? Standby_Timeout() : 0U);
+    Standby.Last_Tx = Os_Tick();
+}
+
+/**
+ * @brief	发出镜像
+ * @note    |---对方地址（2B）---|---信道（1B）---|---0x00---|---0x48---|---镜像（22B）---|---CRC---|
+ * @param	None
+ * @retval	None
+ */
+static void Standby_Send(void)
+{
+    mdU8 buf[3U + 2U + STANDBY_MIRROR_SIZE + 2U];
+    mdU8 *p = &buf[3];
+    L101_Mirror mirror;
+    uint16_t crc;
+
+    L101_Mirror_Get(&mirror);
+    buf[0] = Standby.Cfg.Peer >> 8U;
+    buf[1] = Standby.Cfg.Peer & 0xFFU;
+    buf[2] = Standby.Cfg.Channel;
+    p[0] = MODBUS_BROADCAST_ID;
+    p[1] = STANDBY_CODE_MIRROR;
+    p[2] = ++Standby.Seq;
+    p = Standby_Put(&p[3], mirror.Ready);
+    p = Standby_Put(p, mirror.Block);
+    p = Standby_Put(p, mirror.Coils);
+    p = Standby_Put(p, mirror.Coil_Ack);
+    p = Standby_Put(p, mirror.Coil_Valid);
+    *p++ = mirror.Scanned;
+    crc = mdCrc16(&buf[3], 2U + STANDBY_MIRROR_SIZE);
+    p[0] = crc;
+    p[1] = crc >> 8U;
+    Standby.Stats.Tx++;
+    mdRTU_SendString(Master_Object, buf, sizeof(buf));
+}
+
+/**
+ * @brief	热备调度
+ * @details	在调度节拍开始时执行:备用时采用收到的镜像，超过接管时间未收到则接管；
+ *			工作时每个镜像周期在模块空闲时发出一次镜像
+ * @param	None
+ * @retval	true 本机工作，继续本节拍的调度；false 本机备用，不发出请求
+ */
+bool Standby_Poll(void)
+{
+    uint32_t now = Os_Tick();
+    L101_Mirror mirror;
+    bool fresh;
+
+    if (Standby.Cfg.Role == STANDBY_OFF)
+    {
+        return true;
+    }
+    Os_Critical_Enter();
+    fresh = Standby.Rx_New;
+    mirror = Standby.Rx;
+    Standby.Rx_New = false;
+    Os_Critical_Exit();
+
+    if (fresh && Standby.Active)
+    {
+        /*两台同时工作(如链路恢复):备用让出，主用保持*/
+        Standby.Stats.Conflict++;
+        if (Standby.Cfg.Role == STANDBY_BACKUP)
+        {
+            Standby.Active = false;
+            Standby.Stats.Yield++;
+        }
+    }
+    if (!Standby.Active)
+    {
+        if (fresh)
+        {
+            L101_Mirror_Set(&mirror);
+        }
+        if ((int32_t)(now - Standby.Last_Rx) <= (int32_t)Standby_Timeout())
+        {
+            return false;
+        }
+        Standby.Active = true;
+        Standby.Stats.Takeover++;
+        /*接管后立即发出镜像，对方恢复时保持备用*/
+        Standby.Last_Tx = now - Standby.Cfg.Period_Ms;
+    }
+    if (((uint32_t)(now - Standby.Last_Tx) >= Standby.Cfg.Period_Ms) && (Master_Object != NULL) && Get_L101_Status())
+    {
+        Standby.Last_Tx = now;
+        Standby_Send();
+    }
+
+    return true;
+}
+
+/**
+ * @brief	本机是否工作
+ * @details	模块空闲后立即发送下一请求前检查
+ * @param	None
+ * @retval	true 工作(未开启热备时始终为true)
+ */
+bool Standby_Active(void)
+{
+    return Standby.Active;
+}
+
+/**
+ * @brief	处理收到的镜像
+ * @details	在Modbus任务中对每个CRC正确的接收帧调用，由调度任务在下一节拍采用
+ * @param	pFrame 从机地址+PDU+CRC
+ * @param	Length 帧长
+ * @retval	true 是镜像帧，不再交给主站请求引擎
+ */
+bool Standby_Frame(const uint8_t *pFrame, uint32_t Length)
+{
+    const uint8_t *p = &pFrame[3];
+
+    if ((Length != 2U + STANDBY_MIRROR_SIZE + 2U) || (pFrame[0] != MODBUS_BROADCAST_ID) ||
+        (pFrame[1] != STANDBY_CODE_MIRROR))
+    {
+        return false;
+    }
+    Standby.Stats.Rx++;
+    if (Standby.Cfg.Role == STANDBY_OFF)
+    {
+        return true;
+    }
+    Os_Critical_Enter();
+    Standby.Rx.Ready = Standby_Get(p);
+    Standby.Rx.Block = Standby_Get(p + 4U);
+    Standby.Rx.Coils = Standby_Get(p + 8U);
+    Standby.Rx.Coil_Ack = Standby_Get(p + 12U);
+    Standby.Rx.Coil_Valid = Standby_Get(p + 16U);
+    Standby.Rx.Scanned = p[20] ? true : false;
+    Standby.Rx_New = true;
+    Standby.Last_Rx = Os_Tick();
+    Os_Critical_Exit();
+
+    return true;
+}
+
+/**
+ * @brief	设置热备
+ * @details	两台主站配置互为对方的地址、相同的信道及周期，角色一台为主用一台为备用；
+ *			设置后按上电处理，先监听一个接管时间
+ * @param	role 0:关闭 1:主用 2:备用
+ * @param	peer 对方主站的模块地址
+ * @param	channel 镜像信道
+ * @param	period_ms 镜像周期(ms)
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Standby_Set(int role, int peer, int channel, int period_ms)
+{
+    if ((role < (int)STANDBY_OFF) || (role > (int)STANDBY_BACKUP) || (peer < 0) ||
+        (peer >= (int)L101_BROADCAST_ADDR) || (channel < 0) || (channel > 0xFF) ||
+        (period_ms < (int)STANDBY_PERIOD_MIN) || (period_ms > (int)STANDBY_PERIOD_MAX))
+    {
+        return 0xFF;
+    }
+    Os_Critical_Enter();
+    Standby.Cfg.Role = role;
+    Standby.Cfg.Peer = peer;
+    Standby.Cfg.Channel = channel;
+    Standby.Cfg.Period_Ms = period_ms;
+    Os_Critical_Exit();
+    if (!Kv_Set(KV_KEY_STANDBY, &Standby.Cfg, sizeof(Standby.Cfg)))
+    {
+        return 0xFF;
+    }
+    Standby_Init();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), standby_set, Standby_Set, set standby role peer channel period_ms);
+
+/**
+ * @brief	打印热备状态及统计
+ * @param	None
+ * @retval	None
+ */
+void Standby_Show(void)
+{
+    static const char *const roles[] = {"off", "primary", "backup"};
+    Standby_Stats *pS = &Standby.Stats;
+
+    shellPrint(&shell, "role = %s, %s, peer = 0x%04X, ch = %d, period_ms = %d, takeover_ms = %u, silent = %d ms\r\n",
+               roles[Standby.Cfg.Role], Standby.Active ? "active" : "passive", Standby.Cfg.Peer, Standby.Cfg.Channel,
+               Standby.Cfg.Period_Ms, Standby_Timeout(), (int32_t)(Os_Tick() - Standby.Last_Rx));
+    shellPrint(&shell, "tx = %u, rx = %u, takeover = %u, yield = %u, conflict = %u\r\n", pS->Tx, pS->Rx, pS->Takeover,
+               pS->Yield, pS->Conflict);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), standby, Standby_Show, show standby);
+#endif
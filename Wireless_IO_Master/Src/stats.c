@@ -0,0 +1,212 @@
+#include "stats.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+#include "mdrtuslave.h"
+#include "mdrtumaster.h"
+#include "usart.h"
+#include "L101.h"
+#include "os_port.h"
+#include "extlog.h"
+
+typedef char Stats_Reg_Size_Check[(STATS_REG_START_ADDR + STATS_REG_SIZE <= INPUT_REGISTER_POOL_SIZE) ? 1 : -1];
+
+/*外部日志中的一条快照:时刻及汇总计数*/
+typedef struct
+{
+    uint32_t Tick;
+    uint32_t Value[STATS_REG_HEAD];
+} Stats_Snapshot;
+
+typedef char Stats_Snapshot_Check[(sizeof(Stats_Snapshot) <= EXTLOG_DATA_MAX(EXTLOG_SLOT_STATS)) ? 1 : -1];
+
+static RegisterPoolHandle Stats_Pool;
+
+/**
+ * @brief	汇总协议统计
+ * @details	按导出区的顺序取得各计数，未创建的协议栈对象计为0
+ * @param	pValue 存放 STATS_REG_HEAD 个计数
+ * @retval	None
+ */
+static void Stats_Collect(uint32_t *pValue)
+{
+    ModbusRTUSlaveHandler pH = Master_Object;
+    ModbusRTUMasterHandler pM = Client_Object;
+    const L101_Stats *pS;
+    uint32_t retries = 0;
+    uint8_t id;
+
+    memset(pValue, 0, STATS_REG_HEAD * sizeof(uint32_t));
+    for (uint16_t i = 0; (pS = L101_Stats_Get(i, &id)) != NULL; i++)
+    {
+        retries += pS->Retries;
+    }
+    if (pH)
+    {
+        pValue[0] = pH->rxFrames;
+        pValue[1] = pH->txFrames;
+        pValue[2] = pH->errorCodes[ERROR3];
+        pValue[3] = pH->errorCodes[ERROR2];
+        pValue[9] = pH->txDropped;
+    }
+    if (pM)
+    {
+        pValue[4] = pM->unknown;
+        pValue[5] = pM->timeouts;
+        pValue[6] = pM->errors;
+        pValue[9] += pM->drops;
+    }
+    pValue[7] = retries;
+    pValue[8] = Uart1_Dma.Rx.Overrun;
+}
+
+/**
+ * @brief	把协议统计导出到输入寄存器
+ * @details	在定时器服务任务中周期调用，每 STATS_LOG_EXPORTS 次另写入一条快照
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Stats_Export(void const *argument)
+{
+    mdU16 regs[STATS_REG_SIZE] = {0};
+    uint32_t value[STATS_REG_HEAD];
+    mdU16 *pReg = &regs[STATS_REG_HEAD];
+    const L101_Stats *pS;
+    uint8_t id;
+    static uint16_t exports = 0;
+    Stats_Snapshot snapshot;
+
+    UNUSED(argument);
+    Stats_Collect(value);
+    if (++exports >= STATS_LOG_EXPORTS)
+    {
+        exports = 0;
+        snapshot.Tick = HAL_GetTick();
+        memcpy(snapshot.Value, value, sizeof(snapshot.Value));
+        Extlog_Write(EXTLOG_AREA_STATS, 0, &snapshot, sizeof(snapshot));
+    }
+    for (uint8_t i = 0; i < STATS_REG_HEAD; i++)
+    {
+        regs[i] = (mdU16)value[i];
+    }
+    /*超出导出区的从站只在 stats 命令中显示*/
+    for (uint16_t i = 0; (i < STATS_REG_NODES) && ((pS = L101_Stats_Get(i, &id)) != NULL); i++, pReg += STATS_REG_NODE_SIZE)
+    {
+        pReg[0] = (mdU16)pS->Tx;
+        pReg[1] = (mdU16)pS->Rx;
+        pReg[2] = (mdU16)pS->Timeouts;
+        pReg[3] = (mdU16)pS->Retries;
+    }
+    Stats_Pool->ops->mdWriteInputRegisters(Stats_Pool, STATS_REG_START_ADDR, STATS_REG_SIZE, regs);
+}
+
+/**
+ * @brief	启动协议统计导出
+ * @param	Pool 寄存器池
+ * @retval	None
+ */
+void Stats_Init(RegisterPoolHandle Pool)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Stats, Stats_Export, &control);
+    osTimerId timer;
+
+    Stats_Pool = Pool;
+    timer = Pool ? osTimerCreate(osTimer(Stats), osTimerPeriodic, NULL) : NULL;
+    if (timer)
+    {
+        osTimerStart(timer, STATS_PERIOD);
+    }
+}
+
+/**
+ * @brief	打印协议统计
+ * @param	None
+ * @retval	None
+ */
+void Stats_Show(void)
+{
+    uint32_t v[STATS_REG_HEAD];
+    ModbusRTUMasterHandler pM = Client_Object;
+    const L101_Stats *pS;
+    uint8_t id;
+
+    Stats_Collect(v);
+    shellPrint(&shell, "rx = %u, tx = %u, crc = %u, length = %u, unknown = %u\r\n", v[0], v[1], v[2], v[3], v[4]);
+    shellPrint(&shell, "timeouts = %u, errors = %u, retries = %u, overrun = %u, drops = %u\r\n", v[5], v[6], v[7],
+               v[8], v[9]);
+    if (pM)
+    {
+        shellPrint(&shell, "class tx: alarm = %u, control = %u, telemetry = %u, diag = %u, aged = %u\r\n",
+                   pM->classSent[MASTER_CLASS_ALARM], pM->classSent[MASTER_CLASS_CONTROL],
+                   pM->classSent[MASTER_CLASS_TELEMETRY], pM->classSent[MASTER_CLASS_DIAG], pM->aged);
+#if (MASTER_FRAME_TEMPLATES)
+        shellPrint(&shell, "frame templates: hits = %u, misses = %u\r\n", pM->templateHits, pM->templateMisses);
+#endif
+    }
+    for (uint16_t i = 0; (i < LEVENTS) && ((pS = L101_Stats_Get(i, &id)) != NULL); i++)
+    {
+        shellPrint(&shell, "[%d] id = %d, tx = %u, rx = %u, timeouts = %u, retries = %u, skips = %u\r\n", i, id, pS->Tx,
+                   pS->Rx, pS->Timeouts, pS->Retries, pS->Skips);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats, Stats_Show, show protocol counters);
+
+/**
+ * @brief	打印外部日志中的统计快照
+ * @details	由旧到新打印最近 count 条快照，count 不大于0时打印全部
+ * @param	count 条数
+ * @retval	None
+ */
+void Stats_Log_Show(int count)
+{
+    uint32_t latest = Extlog_Latest(EXTLOG_AREA_STATS), held = Extlog_Slots(EXTLOG_AREA_STATS);
+    Stats_Snapshot s;
+
+    held = (latest < held) ? latest : held;
+    if ((count <= 0) || ((uint32_t)count > held))
+    {
+        count = (int)held;
+    }
+    for (uint32_t seq = latest - (uint32_t)count + 1U; (count > 0) && (seq <= latest); seq++)
+    {
+        if (Extlog_Read(EXTLOG_AREA_STATS, seq, &s, sizeof(s)))
+        {
+            shellPrint(&shell, "[%u] %u ms, rx = %u, tx = %u, crc = %u, timeouts = %u, retries = %u, drops = %u\r\n",
+                       seq, s.Tick, s.Value[0], s.Value[1], s.Value[2], s.Value[5], s.Value[7], s.Value[9]);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats_log, Stats_Log_Show, show logged counters);
+
+/**
+ * @brief	清除协议统计
+ * @details	计数由多个任务及中断更新，在临界区内一并清零
+ * @param	None
+ * @retval	None
+ */
+void Stats_Clear(void)
+{
+    ModbusRTUSlaveHandler pH = Master_Object;
+    ModbusRTUMasterHandler pM = Client_Object;
+
+    Os_Critical_Enter();
+    if (pH)
+    {
+        pH->rxFrames = pH->txFrames = pH->txDropped = 0;
+        memset(pH->errorCodes, 0, sizeof(pH->errorCodes));
+    }
+    if (pM)
+    {
+        pM->completed = pM->errors = pM->timeouts = pM->rejected = pM->unknown = pM->drops = pM->coalesced = 0;
+        pM->crcErrors = 0;
+        pM->aged = 0;
+#if (MASTER_FRAME_TEMPLATES)
+        pM->templateHits = pM->templateMisses = 0;
+#endif
+        memset(pM->classSent, 0, sizeof(pM->classSent));
+    }
+    Uart1_Dma.Rx.Overrun = 0;
+    Os_Critical_Exit();
+    L101_Stats_Clear();
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats_clear, Stats_Clear, clear protocol counters);
@@ -24,7 +24,12 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "mdrtuslave.h"
+#include "usart.h"
 #include "cmsis_os.h"
+#include "shell_port.h"
+#include "io_uart.h"
+#include "dma_mgr.h"
+#include "utimer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -59,6 +64,8 @@
 
 /* External variables --------------------------------------------------------*/
 extern DMA_HandleTypeDef hdma_adc1;
+extern ADC_HandleTypeDef hadc1;
+extern DMA_HandleTypeDef hdma_tim3_up;
 extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim4;
 extern DMA_HandleTypeDef hdma_usart1_rx;
@@ -67,7 +74,6 @@ extern UART_HandleTypeDef huart1;
 extern TIM_HandleTypeDef htim1;
 
 /* USER CODE BEGIN EV */
-extern osSemaphoreId ReciveHandle;
 // extern DMA_HandleTypeDef hdma_usart1_rx;
 /* USER CODE END EV */
 
@@ -90,69 +96,80 @@ void NMI_Handler(void)
 }
 
 /**
- * @brief This function handles Memory management fault.
+ * @brief This function handles Debug monitor.
  */
-void MemManage_Handler(void)
+void DebugMon_Handler(void)
 {
-  /* USER CODE BEGIN MemoryManagement_IRQn 0 */
+  /* USER CODE BEGIN DebugMonitor_IRQn 0 */
 
-  /* USER CODE END MemoryManagement_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_MemoryManagement_IRQn 0 */
-    /* USER CODE END W1_MemoryManagement_IRQn 0 */
-  }
+  /* USER CODE END DebugMonitor_IRQn 0 */
+  /* USER CODE BEGIN DebugMonitor_IRQn 1 */
+
+  /* USER CODE END DebugMonitor_IRQn 1 */
 }
 
+/******************************************************************************/
+/* STM32F1xx Peripheral Interrupt Handlers                                    */
+/* Add here the Interrupt Handlers for the used peripherals.                  */
+/* For the available peripheral interrupt handler names,                      */
+/* please refer to the startup file (startup_stm32f1xx.s).                    */
+/******************************************************************************/
+
 /**
- * @brief This function handles Prefetch fault, memory access fault.
+ * @brief This function handles EXTI line0 interrupt.
  */
-void BusFault_Handler(void)
+void EXTI0_IRQHandler(void)
 {
-  /* USER CODE BEGIN BusFault_IRQn 0 */
+  /* USER CODE BEGIN EXTI0_IRQn 0 */
 
-  /* USER CODE END BusFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
-    /* USER CODE END W1_BusFault_IRQn 0 */
-  }
+  /* USER CODE END EXTI0_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
+  /* USER CODE BEGIN EXTI0_IRQn 1 */
+
+  /* USER CODE END EXTI0_IRQn 1 */
 }
 
 /**
- * @brief This function handles Undefined instruction or illegal state.
+ * @brief This function handles EXTI line1 interrupt.
  */
-void UsageFault_Handler(void)
+void EXTI1_IRQHandler(void)
 {
-  /* USER CODE BEGIN UsageFault_IRQn 0 */
+  /* USER CODE BEGIN EXTI1_IRQn 0 */
 
-  /* USER CODE END UsageFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_UsageFault_IRQn 0 */
-    /* USER CODE END W1_UsageFault_IRQn 0 */
-  }
+  /* USER CODE END EXTI1_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
+  /* USER CODE BEGIN EXTI1_IRQn 1 */
+
+  /* USER CODE END EXTI1_IRQn 1 */
 }
 
 /**
- * @brief This function handles Debug monitor.
+ * @brief This function handles EXTI line3 interrupt.
  */
-void DebugMon_Handler(void)
+void EXTI3_IRQHandler(void)
 {
-  /* USER CODE BEGIN DebugMonitor_IRQn 0 */
+  /* USER CODE BEGIN EXTI3_IRQn 0 */
 
-  /* USER CODE END DebugMonitor_IRQn 0 */
-  /* USER CODE BEGIN DebugMonitor_IRQn 1 */
+  /* USER CODE END EXTI3_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
+  /* USER CODE BEGIN EXTI3_IRQn 1 */
 
-  /* USER CODE END DebugMonitor_IRQn 1 */
+  /* USER CODE END EXTI3_IRQn 1 */
 }
 
-/******************************************************************************/
-/* STM32F1xx Peripheral Interrupt Handlers                                    */
-/* Add here the Interrupt Handlers for the used peripherals.                  */
-/* For the available peripheral interrupt handler names,                      */
-/* please refer to the startup file (startup_stm32f1xx.s).                    */
-/******************************************************************************/
+/**
+ * @brief This function handles EXTI line4 interrupt.
+ */
+void EXTI4_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI4_IRQn 0 */
+
+  /* USER CODE END EXTI4_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_4);
+  /* USER CODE BEGIN EXTI4_IRQn 1 */
+
+  /* USER CODE END EXTI4_IRQn 1 */
+}
 
 /**
  * @brief This function handles DMA1 channel1 global interrupt.
@@ -160,7 +177,7 @@ void DebugMon_Handler(void)
 void DMA1_Channel1_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel1_IRQn 0 */
-
+  Dma_Irq(&hdma_adc1);
   /* USER CODE END DMA1_Channel1_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc1);
   /* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
@@ -168,13 +185,27 @@ void DMA1_Channel1_IRQHandler(void)
   /* USER CODE END DMA1_Channel1_IRQn 1 */
 }
 
+/**
+ * @brief This function handles DMA1 channel3 global interrupt.
+ */
+void DMA1_Channel3_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel3_IRQn 0 */
+  Dma_Irq(&hdma_tim3_up);
+  /* USER CODE END DMA1_Channel3_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_tim3_up);
+  /* USER CODE BEGIN DMA1_Channel3_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel3_IRQn 1 */
+}
+
 /**
  * @brief This function handles DMA1 channel4 global interrupt.
  */
 void DMA1_Channel4_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel4_IRQn 0 */
-
+  Dma_Irq(&hdma_usart1_tx);
   /* USER CODE END DMA1_Channel4_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart1_tx);
   /* USER CODE BEGIN DMA1_Channel4_IRQn 1 */
@@ -188,7 +219,7 @@ void DMA1_Channel4_IRQHandler(void)
 void DMA1_Channel5_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel5_IRQn 0 */
-
+  Dma_Irq(&hdma_usart1_rx);
   /* USER CODE END DMA1_Channel5_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart1_rx);
   /* USER CODE BEGIN DMA1_Channel5_IRQn 1 */
@@ -196,6 +227,20 @@ void DMA1_Channel5_IRQHandler(void)
   /* USER CODE END DMA1_Channel5_IRQn 1 */
 }
 
+/**
+ * @brief This function handles ADC1 and ADC2 global interrupts.
+ */
+void ADC1_2_IRQHandler(void)
+{
+  /* USER CODE BEGIN ADC1_2_IRQn 0 */
+
+  /* USER CODE END ADC1_2_IRQn 0 */
+  HAL_ADC_IRQHandler(&hadc1);
+  /* USER CODE BEGIN ADC1_2_IRQn 1 */
+
+  /* USER CODE END ADC1_2_IRQn 1 */
+}
+
 /**
  * @brief This function handles EXTI line[9:5] interrupts.
  */
@@ -204,6 +249,9 @@ void EXTI9_5_IRQHandler(void)
   /* USER CODE BEGIN EXTI9_5_IRQn 0 */
 
   /* USER CODE END EXTI9_5_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_5);
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_6);
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_7);
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_8);
   /* USER CODE BEGIN EXTI9_5_IRQn 1 */
 
@@ -216,7 +264,13 @@ void EXTI9_5_IRQHandler(void)
 void TIM1_UP_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_UP_IRQn 0 */
-
+  /*The timebase only enables the update interrupt: clear it and tick without the HAL dispatch*/
+  if (TIM1->SR & TIM_SR_UIF)
+  {
+    TIM1->SR = ~TIM_SR_UIF;
+    HAL_IncTick();
+    return;
+  }
   /* USER CODE END TIM1_UP_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_UP_IRQn 1 */
@@ -230,7 +284,11 @@ void TIM1_UP_IRQHandler(void)
 void TIM3_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM3_IRQn 0 */
-
+#if !defined(USING_SUART_DMA_TX)
+  /*Bit-by-bit soft uart transmission is handled on registers only*/
+  Suart_Tx_IRQHandler();
+  return;
+#endif
   /* USER CODE END TIM3_IRQn 0 */
   HAL_TIM_IRQHandler(&htim3);
   /* USER CODE BEGIN TIM3_IRQn 1 */
@@ -244,7 +302,15 @@ void TIM3_IRQHandler(void)
 void TIM4_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM4_IRQn 0 */
-
+#if !defined(USING_SUART_EDGE_RX)
+  /*Timed soft uart sampling is handled on registers only*/
+  Suart_Rx_IRQHandler();
+  return;
+#elif defined(USING_UTIMER)
+  /*The free-running edge timebase also carries the microsecond timers, served on registers only*/
+  Utimer_IRQHandler();
+  return;
+#endif
   /* USER CODE END TIM4_IRQn 0 */
   HAL_TIM_IRQHandler(&htim4);
   /* USER CODE BEGIN TIM4_IRQn 1 */
@@ -258,32 +324,14 @@ void TIM4_IRQHandler(void)
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
-  // uint32_t ret = taskENTER_CRITICAL_FROM_ISR();
-  /*Gets the idle flag so that the idle flag is set*/
-  if ((__HAL_UART_GET_FLAG(&huart1, UART_FLAG_IDLE) != RESET))
+  /*Idle events only publish the received bytes, circular DMA reception keeps running*/
+  Uart_Dma_IRQHandler(&Uart1_Dma);
+  /*In shell mode the DMA is stopped and the console is taken byte by byte so the shell task can block*/
+  Shell_Rx_IRQHandler();
+  /*Most interrupts are idle events only, skip the HAL state machine when nothing is left for it*/
+  if (!Uart_Dma_Hal_Pending(&Uart1_Dma))
   {
-    /*Clear idle interrupt flag*/
-    __HAL_UART_CLEAR_IDLEFLAG(&huart1);
-    if (Master_Object)
-    {
-      /*Stop DMA transmission to prevent busy receiving data and interference during data processing*/
-      HAL_UART_DMAStop(&huart1);
-      /*Get the number of untransmitted data in DMA*/
-      /*Number received = buffersize - the number of data units remaining in the current DMA channel transmission */
-      mdRTU_Recive_Len(Master_Object) = MODBUS_PDU_SIZE_MAX - __HAL_DMA_GET_COUNTER(&hdma_usart1_rx);
-      // huart1.RxState = HAL_UART_STATE_READY;
-      // __HAL_DMA_GET_COUNTER(&hdma_usart1_rx) = MODBUS_PDU_SIZE_MAX;
-      /*Reopen DMA reception*/
-      HAL_UART_Receive_DMA(&huart1, mdRTU_Recive_Buf(Master_Object), MODBUS_PDU_SIZE_MAX);
-    }
-    /*After opening the serial port interrupt, the semaphore has not been created*/
-    if (ReciveHandle != NULL)
-    {
-      /*Notification task processing*/
-      osSemaphoreRelease(ReciveHandle);
-    }
-    /*Reopen DMA reception*/
-    // HAL_UART_Receive_DMA(&huart1, mdRTU_Recive_Buf(Master_Object), MODBUS_PDU_SIZE_MAX);
+    return;
   }
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
@@ -292,6 +340,21 @@ void USART1_IRQHandler(void)
   /* USER CODE END USART1_IRQn 1 */
 }
 
+/**
+ * @brief This function handles EXTI line[15:10] interrupts.
+ */
+void EXTI15_10_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI15_10_IRQn 0 */
+
+  /* USER CODE END EXTI15_10_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_10);
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_12);
+  /* USER CODE BEGIN EXTI15_10_IRQn 1 */
+
+  /* USER CODE END EXTI15_10_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
 /* USER CODE END 1 */
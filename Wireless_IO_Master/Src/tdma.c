@@ -0,0 +1,240 @@
+#include "tdma.h"
+#include "L101.h"
+#include "kv.h"
+#include "os_port.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_TDMA)
+typedef char Tdma_Config_Size_Check[(sizeof(Tdma_Config) <= KV_VALUE_MAX) ? 1 : -1];
+
+static Tdma_HandleTypeDef Tdma = {.Cfg = {.Mode = TDMA_OFF, .Slots = 2U, .Slot_Ms = 1000U}};
+
+/**
+ * @brief	帧长(ms)
+ * @param	None
+ * @retval	时隙数乘以时隙长度
+ */
+static uint32_t Tdma_Frame_Ms(void)
+{
+    return (uint32_t)Tdma.Cfg.Slots * Tdma.Cfg.Slot_Ms;
+}
+
+/**
+ * @brief	取得当前时刻在帧内的偏移
+ * @details	帧起点推进到最近一帧，新的一帧开始时清除信标已发标记；
+ *          信标在Modbus任务中改写帧起点，调度任务中读取，关中断访问
+ * @param	now 当前时刻(ms)
+ * @retval	帧内偏移(ms)
+ */
+static uint32_t Tdma_Offset(uint32_t now)
+{
+    uint32_t frame = Tdma_Frame_Ms(), elapsed;
+
+    Os_Critical_Enter();
+    elapsed = now - Tdma.Epoch;
+    if (elapsed >= frame)
+    {
+        Tdma.Epoch += (elapsed / frame) * frame;
+        elapsed %= frame;
+        Tdma.Sent = false;
+    }
+    Os_Critical_Exit();
+
+    return elapsed;
+}
+
+/**
+ * @brief	加载时隙配置
+ * @details	协调者以上电时刻为第一帧的起点，成员在收到信标前同样按本地时钟划分时隙
+ * @param	None
+ * @retval	None
+ */
+void Tdma_Init(void)
+{
+    Tdma_Config cfg;
+
+    if ((Kv_Get(KV_KEY_TDMA, &cfg, sizeof(cfg)) == sizeof(cfg)) && (cfg.Mode <= TDMA_MEMBER) && (cfg.Slots > 0) &&
+        (cfg.Slots <= TDMA_SLOTS_MAX) && (cfg.Slot_Ms >= TDMA_SLOT_MIN) && (cfg.Slot_Ms <= TDMA_SLOT_MAX))
+    {
+        Tdma.Cfg = cfg;
+    }
+    Tdma.Epoch = Os_Tick();
+    Tdma.Sent = false;
+    Tdma.Synced = false;
+}
+
+/**
+ * @brief	当前是否处于本主站的时隙
+ * @details	作为发送前的信道检查:时隙末尾剩余时间不足保护时间时不再发出新请求，
+ *          已发出请求的应答在本时隙内返回；成员连续TDMA_LOST_FRAMES帧未收到信标时标记失步
+ * @param	None
+ * @retval	true 可以发送(未开启时隙接入时始终为true)
+ */
+bool Tdma_Open(void)
+{
+    uint32_t now = Os_Tick(), offset, start;
+    bool open;
+
+    if (Tdma.Cfg.Mode == TDMA_OFF)
+    {
+        return true;
+    }
+    if (Tdma.Synced && ((uint32_t)(now - Tdma.Last_Beacon) > TDMA_LOST_FRAMES * Tdma_Frame_Ms()))
+    {
+        Tdma.Synced = false;
+    }
+    offset = Tdma_Offset(now);
+    start = (uint32_t)Tdma.Cfg.Slot * Tdma.Cfg.Slot_Ms;
+    open = (Tdma.Cfg.Slot < Tdma.Cfg.Slots) && (offset >= start) && (offset + TDMA_GUARD <= start + Tdma.Cfg.Slot_Ms);
+    Tdma.Stats.Deferred += open ? 0U : 1U;
+
+    return open;
+}
+
+/**
+ * @brief	协调者发出信标
+ * @details	在调度节拍中执行，每帧在本主站时隙内模块空闲时以广播地址发出一次，
+ *          帧内携带发出时刻的偏移，成员据此对齐帧起点，不受节拍抖动影响
+ * @note    |---广播地址（2B）---|---信道（1B）---|---0x00---|---0x43---|---时隙数---|---时隙长度（2B）---|---偏移（2B）---|---序号---|---CRC---|
+ * @param	None
+ * @retval	None
+ */
+void Tdma_Poll(void)
+{
+    mdU8 buf[3U + 2U + TDMA_BEACON_SIZE + 2U];
+    mdU8 *p = &buf[3];
+    uint32_t offset, start;
+    uint16_t crc;
+
+    if ((Tdma.Cfg.Mode != TDMA_COORDINATOR) || (Master_Object == NULL))
+    {
+        return;
+    }
+    offset = Tdma_Offset(Os_Tick());
+    start = (uint32_t)Tdma.Cfg.Slot * Tdma.Cfg.Slot_Ms;
+    if (Tdma.Sent || (offset < start) || (offset + TDMA_GUARD > start + Tdma.Cfg.Slot_Ms) || !Get_L101_Status())
+    {
+        return;
+    }
+    buf[0] = L101_BROADCAST_ADDR >> 8U;
+    buf[1] = L101_BROADCAST_ADDR & 0xFFU;
+    buf[2] = Tdma.Cfg.Channel;
+    p[0] = MODBUS_BROADCAST_ID;
+    p[1] = TDMA_CODE_BEACON;
+    p[2] = Tdma.Cfg.Slots;
+    p[3] = Tdma.Cfg.Slot_Ms >> 8U;
+    p[4] = Tdma.Cfg.Slot_Ms;
+    p[5] = offset >> 8U;
+    p[6] = offset;
+    p[7] = ++Tdma.Seq;
+    crc = mdCrc16(p, 2U + TDMA_BEACON_SIZE);
+    p[8] = crc;
+    p[9] = crc >> 8U;
+    Tdma.Sent = true;
+    Tdma.Stats.Beacon_Tx++;
+    mdRTU_SendString(Master_Object, buf, sizeof(buf));
+}
+
+/**
+ * @brief	处理收到的信标
+ * @details	在Modbus任务中对每个CRC正确的接收帧调用；成员采用信标中的时隙数、时隙长度并对齐帧起点，
+ *          校正量按帧长取最近的方向记录；协调者收到信标说明还有其他协调者，只计数
+ * @param	pFrame 从机地址+PDU+CRC
+ * @param	Length 帧长
+ * @retval	true 是信标帧，不再交给主站请求引擎
+ */
+bool Tdma_Beacon(const uint8_t *pFrame, uint32_t Length)
+{
+    uint32_t now = Os_Tick(), frame, offset, epoch;
+    uint16_t slot_ms;
+    int32_t drift;
+
+    if ((Length != 2U + TDMA_BEACON_SIZE + 2U) || (pFrame[0] != MODBUS_BROADCAST_ID) || (pFrame[1] != TDMA_CODE_BEACON))
+    {
+        return false;
+    }
+    Tdma.Stats.Beacon_Rx++;
+    Tdma.Stats.Conflict += (Tdma.Cfg.Mode == TDMA_COORDINATOR) ? 1U : 0U;
+    slot_ms = ((uint16_t)pFrame[3] << 8U) | pFrame[4];
+    offset = ((uint32_t)pFrame[5] << 8U) | pFrame[6];
+    if ((Tdma.Cfg.Mode != TDMA_MEMBER) || (pFrame[2] == 0) || (pFrame[2] > TDMA_SLOTS_MAX) ||
+        (slot_ms < TDMA_SLOT_MIN) || (slot_ms > TDMA_SLOT_MAX) || (offset >= (uint32_t)pFrame[2] * slot_ms))
+    {
+        return true;
+    }
+    frame = (uint32_t)pFrame[2] * slot_ms;
+    epoch = now - offset - TDMA_BEACON_DELAY;
+    Os_Critical_Enter();
+    drift = (int32_t)(epoch - Tdma.Epoch) % (int32_t)frame;
+    drift = (drift > (int32_t)(frame / 2U)) ? drift - (int32_t)frame : drift;
+    drift = (drift < -(int32_t)(frame / 2U)) ? drift + (int32_t)frame : drift;
+    Tdma.Cfg.Slots = pFrame[2];
+    Tdma.Cfg.Slot_Ms = slot_ms;
+    Tdma.Epoch = epoch;
+    Tdma.Last_Beacon = now;
+    Os_Critical_Exit();
+    if (Tdma.Synced)
+    {
+        Tdma.Stats.Drift = drift;
+    }
+    Tdma.Synced = true;
+    Tdma.Stats.Resync++;
+
+    return true;
+}
+
+/**
+ * @brief	设置时隙接入
+ * @details	各主站配置不同的时隙号，协调者的时隙数及时隙长度经信标下发给成员并保存在参数区；
+ *          时隙接入要求常收网络(占空比网络的唤醒码长于时隙)
+ * @param	mode 0:关闭 1:协调者 2:成员
+ * @param	slot 本主站时隙号
+ * @param	slots 每帧时隙数
+ * @param	slot_ms 时隙长度(ms)
+ * @param	channel 信标信道
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Tdma_Set(int mode, int slot, int slots, int slot_ms, int channel)
+{
+    if ((mode < (int)TDMA_OFF) || (mode > (int)TDMA_MEMBER) || (slots <= 0) || (slots > (int)TDMA_SLOTS_MAX) ||
+        (slot < 0) || (slot >= slots) || (slot_ms < (int)TDMA_SLOT_MIN) || (slot_ms > (int)TDMA_SLOT_MAX) ||
+        (channel < 0) || (channel > 0xFF))
+    {
+        return 0xFF;
+    }
+    Os_Critical_Enter();
+    Tdma.Cfg.Mode = mode;
+    Tdma.Cfg.Slot = slot;
+    Tdma.Cfg.Slots = slots;
+    Tdma.Cfg.Slot_Ms = slot_ms;
+    Tdma.Cfg.Channel = channel;
+    Tdma.Epoch = Os_Tick();
+    Tdma.Sent = false;
+    Tdma.Synced = false;
+    Os_Critical_Exit();
+
+    return Kv_Set(KV_KEY_TDMA, &Tdma.Cfg, sizeof(Tdma.Cfg)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), tdma_set, Tdma_Set, set tdma mode slot slots slot_ms channel);
+
+/**
+ * @brief	打印时隙接入状态及统计
+ * @param	None
+ * @retval	None
+ */
+void Tdma_Show(void)
+{
+    static const char *const modes[] = {"off", "coordinator", "member"};
+    Tdma_Stats *pT = &Tdma.Stats;
+
+    shellPrint(&shell, "mode = %s, slot = %d/%d, slot_ms = %d, guard = %d, ch = %d, synced = %d, offset = %u\r\n",
+               modes[Tdma.Cfg.Mode], Tdma.Cfg.Slot, Tdma.Cfg.Slots, Tdma.Cfg.Slot_Ms, TDMA_GUARD, Tdma.Cfg.Channel,
+               Tdma.Synced, Tdma_Offset(Os_Tick()));
+    shellPrint(&shell, "beacon tx = %u, rx = %u, resync = %u, drift = %d, conflict = %u, deferred = %u\r\n",
+               pT->Beacon_Tx, pT->Beacon_Rx, pT->Resync, pT->Drift, pT->Conflict, pT->Deferred);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), tdma, Tdma_Show, show tdma);
+#endif
@@ -0,0 +1,241 @@
+#include "trend.h"
+#include "boot.h"
+#include "shell_port.h"
+
+#if defined(USING_TREND)
+/*每级的环及其参数*/
+#define TREND_LOG_DEFINE(name, period, depth) static Trend_Record Trend_Log_##name[depth][BOARD_ANALOG_COUNT];
+#define TREND_LOG_ENTRY(name, period, depth) Trend_Log_##name,
+#define TREND_PERIOD_ENTRY(name, period, depth) (period),
+#define TREND_DEPTH_ENTRY(name, period, depth) (depth),
+
+TREND_LEVEL_TABLE(TREND_LOG_DEFINE)
+
+static Trend_Record (*const Trend_Log[TREND_LEVELS])[BOARD_ANALOG_COUNT] = {TREND_LEVEL_TABLE(TREND_LOG_ENTRY)};
+static const uint32_t Trend_Periods[TREND_LEVELS] = {TREND_LEVEL_TABLE(TREND_PERIOD_ENTRY)};
+static const uint32_t Trend_Depths[TREND_LEVELS] = {TREND_LEVEL_TABLE(TREND_DEPTH_ENTRY)};
+
+static Trend_HandleTypeDef Trend;
+
+/**
+ * @brief	清空一个累加器
+ * @param	pAcc 累加器
+ * @retval	None
+ */
+static void Trend_Acc_Reset(Trend_Acc *pAcc)
+{
+    pAcc->Min = 0xFFFFU;
+    pAcc->Max = 0;
+    pAcc->Count = 0;
+    pAcc->Sum = 0;
+}
+
+/**
+ * @brief	初始化趋势记录
+ * @details	在ADC启动前调用，窗口由此刻起按各级的窗口长度对齐
+ * @param	None
+ * @retval	None
+ */
+void Trend_Init(void)
+{
+    Trend.Base = HAL_GetTick();
+    for (uint8_t level = 0; level < TREND_LEVELS; level++)
+    {
+        Trend.Level[level].Sequence = 0;
+        Trend.Level[level].Deadline = Trend.Base + Trend_Periods[level];
+        for (uint8_t ch = 0; ch < BOARD_ANALOG_COUNT; ch++)
+        {
+            Trend_Acc_Reset(&Trend.Level[level].Acc[ch]);
+        }
+    }
+    Trend.Ready = true;
+}
+/*窗口由此刻起计，在第一个采样之前*/
+BOOT_MODULE(trend, BOOT_LEVEL_MAIN, Trend_Init, "analog_cal");
+
+/**
+ * @brief	结束一级的当前窗口
+ * @details	累加器写入环中的下一条记录并并入上一级的累加器；其后已过去的窗口没有采样，
+ *			记为采样数0(超过环深度的部分不再逐条写入)
+ * @param	Level 级号
+ * @param	Now 当前系统节拍
+ * @retval	None
+ */
+static void Trend_Close(uint8_t Level, uint32_t Now)
+{
+    Trend_Level *pL = &Trend.Level[Level];
+    uint32_t period = Trend_Periods[Level], depth = Trend_Depths[Level], empty;
+    Trend_Record *pRec = Trend_Log[Level][++pL->Sequence % depth];
+
+    for (uint8_t ch = 0; ch < BOARD_ANALOG_COUNT; ch++)
+    {
+        Trend_Acc *pAcc = &pL->Acc[ch];
+
+        if (pAcc->Count)
+        {
+            pRec[ch].Min = pAcc->Min;
+            pRec[ch].Max = pAcc->Max;
+            pRec[ch].Avg = (uint16_t)((pAcc->Sum + pAcc->Count / 2U) / pAcc->Count);
+            pRec[ch].Count = (uint16_t)((pAcc->Count > 0xFFFFU) ? 0xFFFFU : pAcc->Count);
+            if (Level + 1U < TREND_LEVELS)
+            {
+                Trend_Acc *pUp = &Trend.Level[Level + 1U].Acc[ch];
+
+                pUp->Min = (pAcc->Min < pUp->Min) ? pAcc->Min : pUp->Min;
+                pUp->Max = (pAcc->Max > pUp->Max) ? pAcc->Max : pUp->Max;
+                pUp->Count += pAcc->Count;
+                pUp->Sum += pAcc->Sum;
+            }
+        }
+        else
+        {
+            pRec[ch] = (Trend_Record){0};
+        }
+        Trend_Acc_Reset(pAcc);
+    }
+    pL->Deadline += period;
+
+    if ((int32_t)(Now - pL->Deadline) < 0)
+    {
+        return;
+    }
+    empty = (Now - pL->Deadline) / period + 1U;
+    for (uint32_t i = 0; i < ((empty < depth) ? empty : depth); i++)
+    {
+        pRec = Trend_Log[Level][(pL->Sequence + empty - i) % depth];
+        for (uint8_t ch = 0; ch < BOARD_ANALOG_COUNT; ch++)
+        {
+            pRec[ch] = (Trend_Record){0};
+        }
+    }
+    pL->Sequence += empty;
+    pL->Deadline += empty * period;
+}
+
+/**
+ * @brief	记入一组模拟量采样
+ * @details	在 Io_Analog_Handle 中调用(ADC中断或 defer 任务)；窗口结束时逐级结束，
+ *			只有到期的一级才写入记录，每个采样只更新最细一级的累加器
+ * @param	pValue 各通道的工程值
+ * @retval	None
+ */
+void Trend_Sample(const uint16_t *pValue)
+{
+    uint32_t now = HAL_GetTick();
+
+    if (!Trend.Ready)
+    {
+        return;
+    }
+    for (uint8_t level = 0; (level < TREND_LEVELS) && ((int32_t)(now - Trend.Level[level].Deadline) >= 0); level++)
+    {
+        Trend_Close(level, now);
+    }
+    for (uint8_t ch = 0; ch < BOARD_ANALOG_COUNT; ch++)
+    {
+        Trend_Acc *pAcc = &Trend.Level[0].Acc[ch];
+
+        pAcc->Min = (pValue[ch] < pAcc->Min) ? pValue[ch] : pAcc->Min;
+        pAcc->Max = (pValue[ch] > pAcc->Max) ? pValue[ch] : pAcc->Max;
+        pAcc->Count++;
+        pAcc->Sum += pValue[ch];
+    }
+}
+
+/**
+ * @brief	读取一条趋势记录
+ * @details	在任务中调用，关中断期间复制，不会读到写入一半的记录
+ * @param	Level 级号
+ * @param	Channel 通道号
+ * @param	Sequence 窗口序号
+ * @param	pRecord 记录
+ * @retval	false:参数无效、窗口尚未结束或已被覆盖
+ */
+bool Trend_Read(uint8_t Level, uint8_t Channel, uint32_t Sequence, Trend_Record *pRecord)
+{
+    uint32_t primask;
+    bool ret = false;
+
+    if ((Level >= TREND_LEVELS) || (Channel >= BOARD_ANALOG_COUNT) || !Sequence)
+    {
+        return false;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if ((Sequence <= Trend.Level[Level].Sequence) && (Trend.Level[Level].Sequence - Sequence < Trend_Depths[Level]))
+    {
+        *pRecord = Trend_Log[Level][Sequence % Trend_Depths[Level]][Channel];
+        ret = true;
+    }
+    __set_PRIMASK(primask);
+    return ret;
+}
+
+/**
+ * @brief	一级中最新结束的窗口序号
+ * @param	Level 级号
+ * @retval	0:尚无记录
+ */
+uint32_t Trend_Latest(uint8_t Level)
+{
+    return (Level < TREND_LEVELS) ? Trend.Level[Level].Sequence : 0U;
+}
+
+/**
+ * @brief	一级的环深度
+ * @param	Level 级号
+ * @retval	记录数
+ */
+uint32_t Trend_Depth(uint8_t Level)
+{
+    return (Level < TREND_LEVELS) ? Trend_Depths[Level] : 0U;
+}
+
+/**
+ * @brief	一级的窗口长度
+ * @param	Level 级号
+ * @retval	ms
+ */
+uint32_t Trend_Period(uint8_t Level)
+{
+    return (Level < TREND_LEVELS) ? Trend_Periods[Level] : 0U;
+}
+
+/**
+ * @brief	打印趋势记录
+ * @details	由旧到新打印一级中最近 count 条记录，count 不大于0时打印环中全部记录；时刻为窗口起点(s)
+ * @param	level 级号
+ * @param	count 条数
+ * @retval	None
+ */
+void Trend_Show(int level, int count)
+{
+    uint32_t latest, held;
+    Trend_Record record;
+
+    if ((level < 0) || (level >= TREND_LEVELS))
+    {
+        shellPrint(&shell, "level 0..%d\r\n", TREND_LEVELS - 1);
+        return;
+    }
+    latest = Trend_Latest((uint8_t)level);
+    held = (latest < Trend_Depths[level]) ? latest : Trend_Depths[level];
+    if ((count <= 0) || ((uint32_t)count > held))
+    {
+        count = (int)held;
+    }
+    for (uint32_t seq = latest - (uint32_t)count + 1U; (count > 0) && (seq <= latest); seq++)
+    {
+        shellPrint(&shell, "[%u] %u s:", seq, (seq - 1U) * (Trend_Periods[level] / 1000UL));
+        for (uint8_t ch = 0; ch < BOARD_ANALOG_COUNT; ch++)
+        {
+            if (Trend_Read((uint8_t)level, ch, seq, &record))
+            {
+                shellPrint(&shell, " ch%d %u/%u/%u (%u)", ch, record.Min, record.Avg, record.Max, record.Count);
+            }
+        }
+        shellPrint(&shell, "\r\n");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), trend, Trend_Show, show trend level count);
+#endif
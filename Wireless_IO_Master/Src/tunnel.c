@@ -0,0 +1,147 @@
+#include "tunnel.h"
+#include "boot.h"
+#include "mode.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+
+static Tunnel_HandleTypeDef Tunnel;
+
+/**
+ * @brief	打开或关闭隧道会话
+ * @details	打开时清除此前残留的输出；会话期间shell任务须运行，由工作模式管理停放
+ * @param	Open 打开/关闭
+ * @retval	None
+ */
+static void Tunnel_Session(bool Open)
+{
+    if (Open == Tunnel.Open)
+    {
+        return;
+    }
+    Tunnel.Tail = Tunnel.Head;
+    Tunnel.Open = Open;
+    Mode_Tunnel(Open);
+}
+
+/**
+ * @brief	处理shell隧道功能码
+ * @details	在Modbus任务中执行：输入送入shell接收环，应答带回会话期间积累的shell输出；
+ *			I/O映射的轮询与应答照常进行
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Tunnel_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU32 reclen = handler->receiveBuffer->count;
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    uint8_t n = recbuf[2];
+    uint32_t length = 0, tail;
+    mdU16 crc;
+
+    if ((n == TUNNEL_CLOSE) ? (reclen != 5U) : ((n > TUNNEL_CHUNK) || (reclen != 5U + n)))
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    Tunnel.Last = HAL_GetTick();
+    Tunnel_Session(n != TUNNEL_CLOSE);
+    if (Tunnel.Open && n)
+    {
+        Shell_Rx_Push((const char *)&recbuf[3], n);
+    }
+    for (; (length < TUNNEL_CHUNK) && (Tunnel.Tail != Tunnel.Head); length++)
+    {
+        tail = Tunnel.Tail;
+        Tunnel.Frame[3U + length] = (uint8_t)Tunnel.Buffer[tail % TUNNEL_TX_SIZE];
+        Tunnel.Tail = tail + 1U;
+    }
+    Tunnel.Frame[0] = recbuf[0];
+    Tunnel.Frame[1] = recbuf[1];
+    Tunnel.Frame[2] = (uint8_t)length;
+    crc = mdCrc16(Tunnel.Frame, 3U + length);
+    Tunnel.Frame[3U + length] = LOW(crc);
+    Tunnel.Frame[4U + length] = HIGH(crc);
+    handler->mdRTUSendString(handler, Tunnel.Frame, 5U + length);
+}
+
+/**
+ * @brief	注册shell隧道
+ * @details	在创建Modbus协议栈后调用
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Tunnel_Init(ModbusRTUSlaveHandler handler)
+{
+    if (handler)
+    {
+        mdRTURegisterCode(handler, TUNNEL_CODE, Tunnel_Handle);
+    }
+}
+
+/**
+ * @brief	shell隧道的启动模块:登记到本机从站
+ * @param	None
+ * @retval	None
+ */
+static void Tunnel_Boot_Init(void)
+{
+    Tunnel_Init(Master_Object);
+}
+BOOT_MODULE(tunnel, BOOT_LEVEL_MAIN, Tunnel_Boot_Init, "modbus,shell");
+
+/**
+ * @brief	隧道会话是否有效
+ * @details	超过 TUNNEL_TIMEOUT 没有请求时视为上位机已离开
+ * @param	None
+ * @retval	true:会话有效
+ */
+bool Tunnel_Active(void)
+{
+    return Tunnel.Open && (HAL_GetTick() - Tunnel.Last < TUNNEL_TIMEOUT);
+}
+
+/**
+ * @brief	截取shell输出
+ * @details	可在任意任务或中断中调用；会话有效时输出只经隧道返回，缓冲区不足时整段丢弃
+ * @param	data 输出数据
+ * @param	len 字节数
+ * @retval	true:已由隧道接管
+ */
+bool Tunnel_Capture(const char *data, unsigned short len)
+{
+    uint32_t primask;
+
+    if (!Tunnel_Active())
+    {
+        return false;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (len <= TUNNEL_TX_SIZE - (Tunnel.Head - Tunnel.Tail))
+    {
+        for (unsigned short i = 0; i < len; i++)
+        {
+            Tunnel.Buffer[(Tunnel.Head + i) % TUNNEL_TX_SIZE] = data[i];
+        }
+        Tunnel.Head += len;
+    }
+    else
+    {
+        Tunnel.Dropped++;
+    }
+    __set_PRIMASK(primask);
+    return true;
+}
+
+/**
+ * @brief	打印隧道状态
+ * @details
+ * @param	None
+ * @retval	None
+ */
+void Tunnel_Show(void)
+{
+    shellPrint(&shell, "tunnel = %s, pending = %u, dropped = %u\r\n", Tunnel_Active() ? "open" : "closed",
+               Tunnel.Head - Tunnel.Tail, Tunnel.Dropped);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), tunnel, Tunnel_Show, show shell tunnel);
@@ -21,7 +21,13 @@
 #include "usart.h"
 
 /* USER CODE BEGIN 0 */
+#include "dma_mgr.h"
 #include "mdrtuslave.h"
+/*USART1接收环长度(半满时提前交付数据，需不小于最长一帧)*/
+#define UART1_RX_RING_SIZE 256U
+/*USART1 DMA驱动:Modbus、AT及L101透传shell共用*/
+UartDma_HandleTypeDef Uart1_Dma;
+static uint8_t Uart1_Rx_Ring[UART1_RX_RING_SIZE];
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart1;
@@ -53,11 +59,11 @@ void MX_USART1_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART1_Init 2 */
-  /*Idle interrupt*/
-  __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
-  // __HAL_UART_ENABLE_IT(&huart1, UART_FLAG_TC);
-  /*DMA receiving function, this sentence must be added. If not, the real data transmitted for the first time cannot be received. It is empty, and the length of the data received at this time is the data length of the buffer*/
-  // HAL_UART_Receive_DMA(&huart1, mdRTU_Recive_Buf(Master_Object), MODBUS_PDU_SIZE_MAX);
+  /*Circular DMA reception with half/full/idle events, the DMA is never stopped between frames*/
+  if (!Uart_Dma_Init(&Uart1_Dma, &huart1, Uart1_Rx_Ring, UART1_RX_RING_SIZE))
+  {
+    Error_Handler();
+  }
   /* USER CODE END USART1_Init 2 */
 
 }
@@ -99,7 +105,7 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart1_rx.Init.Mode = DMA_NORMAL;
+    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
     hdma_usart1_rx.Init.Priority = DMA_PRIORITY_MEDIUM;
     if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK)
     {
@@ -128,6 +134,9 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     HAL_NVIC_SetPriority(USART1_IRQn, 5, 0);
     HAL_NVIC_EnableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspInit 1 */
+    /*Channels and priorities from the board DMA plan (dma_mgr.h)*/
+    Dma_Setup(&hdma_usart1_rx, DMA_REQ_USART1_RX);
+    Dma_Setup(&hdma_usart1_tx, DMA_REQ_USART1_TX);
 
   /* USER CODE END USART1_MspInit 1 */
   }
@@ -163,10 +172,7 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
 }
 
 /* USER CODE BEGIN 1 */
-// void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
-// {
-//   __HAL_UART_CLEAR_OREFLAG(&huart1);
-// }
+
 /* USER CODE END 1 */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
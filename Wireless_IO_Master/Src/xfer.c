@@ -0,0 +1,475 @@
+#include "xfer.h"
+#include "L101.h"
+#include "lzss.h"
+#include "os_port.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+#if defined(USING_L101_RADIO2)
+#include "radio2.h"
+#endif
+
+#if defined(USING_XFER)
+typedef char Xfer_Blocks_Check[(XFER_BLOCKS_MAX <= 8U) ? 1 : -1];
+typedef char Xfer_Read_Size_Check[(4U + XFER_READ_BLOCKS * XFER_BLOCK <= MODBUS_PDU_SIZE_MAX) ? 1 : -1];
+
+static Xfer_HandleTypeDef Xfer;
+
+/**
+ * @brief	按块传输的数据
+ * @param	None
+ * @retval	LZSS编码时为压缩数据，否则为原始数据
+ */
+static uint8_t *Xfer_Data(void)
+{
+    return (Xfer.Mode == XFER_MODE_LZSS) ? Xfer.Packed : Xfer.Raw;
+}
+
+/**
+ * @brief	取得块的数据长度
+ * @param	Block 块号
+ * @retval	字节数，0:块号超出传输长度
+ */
+static uint16_t Xfer_Block_Size(uint8_t Block)
+{
+    uint16_t offset = (uint16_t)Block * XFER_BLOCK;
+
+    if (offset >= Xfer.Length)
+    {
+        return 0;
+    }
+    return ((Xfer.Length - offset) < XFER_BLOCK) ? (Xfer.Length - offset) : XFER_BLOCK;
+}
+
+/**
+ * @brief	位图中的块数
+ * @param	Map 位图
+ * @retval	置位的块数
+ */
+static uint8_t Xfer_Count(uint8_t Map)
+{
+    uint8_t n = 0;
+
+    for (; Map; Map &= Map - 1U)
+    {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief	全部块的位图
+ * @param	None
+ * @retval	位图
+ */
+static uint8_t Xfer_All(void)
+{
+    uint8_t blocks = (Xfer.Length + XFER_BLOCK - 1U) / XFER_BLOCK;
+
+    return (uint8_t)((1U << blocks) - 1U);
+}
+
+/**
+ * @brief	结束会话
+ * @param	State XFER_DONE 或 XFER_FAILED
+ * @param	Result 结果或失败原因
+ * @retval	None
+ */
+static void Xfer_Finish(Xfer_State State, uint8_t Result)
+{
+    Xfer.Result = Result;
+    if (State == XFER_DONE)
+    {
+        Xfer.Stats.Done++;
+        Xfer.Stats.Saved += Xfer.Raw_Length - Xfer.Length;
+    }
+    else
+    {
+        Xfer.Stats.Failed++;
+    }
+    Xfer.State = State;
+}
+
+/**
+ * @brief	读取的所有块到齐
+ * @details	解压并校验原始数据的CRC
+ * @param	None
+ * @retval	None
+ */
+static void Xfer_Read_End(void)
+{
+    if ((Xfer.Mode == XFER_MODE_LZSS) &&
+        (Lzss_Unpack(Xfer.Packed, Xfer.Length, Xfer.Raw, sizeof(Xfer.Raw)) != Xfer.Raw_Length))
+    {
+        Xfer_Finish(XFER_FAILED, XFER_CORRUPT);
+        return;
+    }
+    (mdCrc16(Xfer.Raw, Xfer.Raw_Length) == Xfer.Crc) ? Xfer_Finish(XFER_DONE, XFER_OK)
+                                                     : Xfer_Finish(XFER_FAILED, XFER_CORRUPT);
+}
+
+/**
+ * @brief	构造当前步骤的请求帧
+ * @details	块传输阶段只请求或发出未确认的块(选择性确认)，应答丢失时同一块被重发，从站按块号覆盖；
+ *			读取时从首个缺少的块起连续请求至多 XFER_READ_BLOCKS 块；写入窗口未满且之后还有未发的块时
+ *			以广播站号连续写入，否则以写入块结束窗口
+ * @param	None
+ * @retval	从机地址+PDU+CRC 的长度
+ */
+static uint16_t Xfer_Build(void)
+{
+    uint8_t *p = &Xfer.Frame[MASTER_PREFIX_SIZE];
+    uint16_t len = 0, n, crc;
+    bool burst;
+
+    p[len++] = Xfer.Slave;
+    p[len++] = MODBUS_CODE_XFER;
+    switch (Xfer.State)
+    {
+    case XFER_OPEN:
+        p[len++] = Xfer.Write ? XFER_OP_OPEN_WRITE : XFER_OP_OPEN_READ;
+        p[len++] = Xfer.Object;
+        if (Xfer.Write)
+        {
+            p[len++] = Xfer.Mode;
+            p[len++] = Xfer.Raw_Length >> 8U;
+            p[len++] = Xfer.Raw_Length;
+            p[len++] = Xfer.Length >> 8U;
+            p[len++] = Xfer.Length;
+            p[len++] = Xfer.Crc >> 8U;
+            p[len++] = Xfer.Crc;
+        }
+        break;
+    case XFER_BLOCKS:
+        for (Xfer.Block = 0; (Xfer.Received | Xfer.Sent) & (1U << Xfer.Block); Xfer.Block++)
+        {
+        }
+        if (!Xfer.Write)
+        {
+            for (Xfer.Count = 1; (Xfer.Count < XFER_READ_BLOCKS) && Xfer_Block_Size(Xfer.Block + Xfer.Count) &&
+                                 !(Xfer.Received & (1U << (Xfer.Block + Xfer.Count)));
+                 Xfer.Count++)
+            {
+            }
+            p[len++] = XFER_OP_READ;
+            p[len++] = Xfer.Block;
+            p[len++] = Xfer.Count;
+            break;
+        }
+        burst = (Xfer_Count(Xfer.Sent) + 1U < Xfer.Window) &&
+                (Xfer_Count(Xfer_All() & (uint8_t) ~(Xfer.Received | Xfer.Sent)) > 1U);
+        p[0] = burst ? MODBUS_BROADCAST_ID : Xfer.Slave;
+        p[len++] = burst ? XFER_OP_BURST : XFER_OP_WRITE;
+        p[len++] = Xfer.Block;
+        n = Xfer_Block_Size(Xfer.Block);
+        p[len++] = n;
+        memcpy(&p[len], &Xfer_Data()[(uint16_t)Xfer.Block * XFER_BLOCK], n);
+        len += n;
+        break;
+    default:
+        p[len++] = XFER_OP_COMMIT;
+        break;
+    }
+    Xfer.Op = p[2];
+    crc = mdCrc16(p, len);
+    p[len++] = (uint8_t)crc;
+    p[len++] = (uint8_t)(crc >> 8U);
+
+    return len;
+}
+
+/**
+ * @brief	校验并处理应答
+ * @param	Op 请求的操作
+ * @param	p 从机地址+PDU+CRC
+ * @param	Length 帧长
+ * @retval	true 应答有效
+ */
+static bool Xfer_Reply(uint8_t Op, const uint8_t *p, uint16_t Length)
+{
+    uint16_t n = 0, raw;
+
+    switch (Op)
+    {
+    case XFER_OP_OPEN_READ:
+        raw = ToU16(p[5], p[6]);
+        n = ToU16(p[7], p[8]);
+        if ((Length != 6U + XFER_INFO_SIZE) || (p[3] != Xfer.Object) || (p[4] > XFER_MODE_LZSS) ||
+            (raw > XFER_RAW_SIZE) || (n > XFER_RAW_SIZE) || ((p[4] == XFER_MODE_STORED) && (n != raw)))
+        {
+            return false;
+        }
+        Xfer.Mode = p[4];
+        Xfer.Raw_Length = raw;
+        Xfer.Length = n;
+        Xfer.Crc = ToU16(p[9], p[10]);
+        Xfer.Received = 0;
+        Xfer.State = XFER_BLOCKS;
+        return true;
+    case XFER_OP_READ:
+        for (uint8_t i = 0; i < Xfer.Count; i++)
+        {
+            n += Xfer_Block_Size(Xfer.Block + i);
+        }
+        if ((Length != 7U + n) || (p[3] != Xfer.Block) || (p[4] != n))
+        {
+            return false;
+        }
+        memcpy(&Xfer_Data()[(uint16_t)Xfer.Block * XFER_BLOCK], &p[5], n);
+        Xfer.Received |= (uint8_t)(((1U << Xfer.Count) - 1U) << Xfer.Block);
+        Xfer.Stats.Blocks += Xfer.Count;
+        return true;
+    case XFER_OP_OPEN_WRITE:
+        if ((Length != 6U) || (p[3] != Xfer.Object))
+        {
+            return false;
+        }
+        Xfer.Received = 0;
+        Xfer.Sent = 0;
+        Xfer.State = XFER_BLOCKS;
+        return true;
+    case XFER_OP_WRITE:
+        if ((Length != 7U) || (p[3] != Xfer.Block))
+        {
+            return false;
+        }
+        /*从站回送的位图为准，覆盖此前丢失应答的块；窗口内连续写入而未到的块下一窗口补发*/
+        Xfer.Received = p[4] & Xfer_All();
+        Xfer.Sent = 0;
+        Xfer.Stats.Blocks++;
+        return true;
+    default:
+        if (Length != 6U)
+        {
+            return false;
+        }
+        if (p[3] == XFER_MISSING)
+        {
+            /*从站的会话已被取代或复位，从头重发*/
+            Xfer.State = XFER_OPEN;
+            return false;
+        }
+        (p[3] == XFER_OK) ? Xfer_Finish(XFER_DONE, XFER_OK) : Xfer_Finish(XFER_FAILED, p[3]);
+        return true;
+    }
+}
+
+/**
+ * @brief	请求完成
+ * @details	在接收任务或轮询调用者的上下文中执行；连续写入发出即完成；超时、错误及无效应答时下一节拍
+ *			重发同一步骤(写入时整个窗口中未确认的块)，连续失败超过 XFER_RETRIES 次时会话失败
+ * @param	request 请求
+ * @param	result 结果
+ * @retval	None
+ */
+static mdVOID Xfer_Done(struct ModbusRTURequest *request, mdU8 result)
+{
+    const uint8_t *p = request->reply;
+    uint8_t op = Xfer.Op;
+
+    if ((op == XFER_OP_BURST) && (result == MASTER_RESULT_OK))
+    {
+        Xfer.Sent |= 1U << Xfer.Block;
+        Xfer.Stats.Bursts++;
+    }
+    else if ((result == MASTER_RESULT_OK) && (p != NULL) && (request->replyLength >= 4U) &&
+             (p[1] == MODBUS_CODE_XFER) && (p[2] == op) && Xfer_Reply(op, p, request->replyLength))
+    {
+        Xfer.Retry = 0;
+    }
+    else if (++Xfer.Retry > XFER_RETRIES)
+    {
+        /*异常应答记录从站的异常码*/
+        Xfer_Finish(XFER_FAILED, ((result == MASTER_RESULT_OK) && (p != NULL) && (p[1] & 0x80U)) ? p[2] : 0xFFU);
+    }
+    else
+    {
+        Xfer.Sent = 0;
+        Xfer.Stats.Retries++;
+    }
+    Xfer.Pending = false;
+}
+
+/**
+ * @brief	提交会话的下一个请求
+ * @details	在调度任务中执行(请求引擎只由该任务提交)，同时只有一个请求在途；
+ *			请求队列已满时下一节拍再提交
+ * @param	None
+ * @retval	None
+ */
+void Xfer_Submit(void)
+{
+    struct ModbusRTURequest request;
+
+    if ((Client_Object == NULL) || Xfer.Pending || (Xfer.State < XFER_OPEN) || (Xfer.State > XFER_COMMIT))
+    {
+        return;
+    }
+    if ((Xfer.State == XFER_BLOCKS) && (Xfer.Received == Xfer_All()))
+    {
+        if (!Xfer.Write)
+        {
+            Xfer_Read_End();
+            return;
+        }
+        Xfer.State = XFER_COMMIT;
+    }
+    memset(&request, 0, sizeof(request));
+    request.prefix[0] = (uint8_t)(Xfer.Addr >> 8U);
+    request.prefix[1] = (uint8_t)Xfer.Addr;
+    request.prefix[2] = Xfer.Channel;
+    request.prefixLength = MASTER_PREFIX_SIZE;
+#if defined(USING_L101_RADIO2)
+    request.port = Radio2_Port(Xfer.Channel);
+#endif
+    request.frame = &Xfer.Frame[MASTER_PREFIX_SIZE];
+    request.frameLength = Xfer_Build();
+    request.slaveId = request.frame[0];
+    request.code = MODBUS_CODE_XFER;
+    request.timeout = XFER_TIMEOUT;
+    request.callback = Xfer_Done;
+    Xfer.Pending = true;
+    if (!mdRTU_Submit(Client_Object, &request))
+    {
+        Xfer.Pending = false;
+        return;
+    }
+    Xfer.Stats.Requests++;
+}
+
+/**
+ * @brief	开始一个会话
+ * @param	slave 从站号
+ * @param	object 对象
+ * @param	write 写入
+ * @retval	0 成功 0xFF 参数错误、从站不在节点映射表中或已有会话进行中
+ */
+static uint8_t Xfer_Start(int slave, int object, bool write)
+{
+    uint16_t addr;
+    uint8_t ch;
+
+    if ((slave <= 0) || (slave >= MODBUS_BROADCAST_ID) || (object < 0) || (object >= (int)XFER_OBJECTS) ||
+        ((Xfer.State >= XFER_OPEN) && (Xfer.State <= XFER_COMMIT)) || Xfer.Pending ||
+        !L101_Find_Node((uint8_t)slave, &addr, &ch))
+    {
+        return 0xFF;
+    }
+    Xfer.Slave = slave;
+    Xfer.Object = object;
+    Xfer.Addr = addr;
+    Xfer.Channel = ch;
+    Xfer.Write = write;
+    Xfer.Retry = 0;
+    Xfer.Received = 0;
+    Xfer.Sent = 0;
+    Xfer.Window = write ? L101_Burst_Window((uint8_t)slave, XFER_FRAME_SIZE, XFER_BLOCKS_MAX) : 1U;
+#if (MODBUS_AUTH)
+    /*开启帧认证时请求引擎不接受广播请求，逐块等待应答*/
+    Xfer.Window = ((Client_Object != NULL) && (Client_Object->auth != NULL)) ? 1U : Xfer.Window;
+#endif
+    Xfer.Result = XFER_OK;
+    Xfer.State = XFER_OPEN;
+
+    return 0;
+}
+
+/**
+ * @brief	读取从站对象
+ * @details	完成后内容保存在会话的原始数据区(xfer 命令查看)，可再写入其他从站
+ * @param	slave 从站号
+ * @param	object 0:SOE事件记录 1:配置寄存器 2:中继转发表 3:输出场景表
+ * @retval	0 成功 0xFF 参数错误或已有会话进行中
+ */
+uint8_t Xfer_Get(int slave, int object)
+{
+    return Xfer_Start(slave, object, false);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), xfer_get, Xfer_Get, read slave object);
+
+/**
+ * @brief	压缩待写入的内容并开始写入会话
+ * @details	压缩后不短于原始数据时原样传输
+ * @param	slave 从站号
+ * @param	object 对象
+ * @retval	0 成功 0xFF 参数错误或已有会话进行中
+ */
+static uint8_t Xfer_Start_Write(int slave, int object)
+{
+    uint16_t packed;
+
+    packed = Xfer.Raw_Length ? Lzss_Pack(Xfer.Raw, Xfer.Raw_Length, Xfer.Packed, Xfer.Raw_Length - 1U) : 0;
+    Xfer.Mode = packed ? XFER_MODE_LZSS : XFER_MODE_STORED;
+    Xfer.Length = packed ? packed : Xfer.Raw_Length;
+    Xfer.Crc = mdCrc16(Xfer.Raw, Xfer.Raw_Length);
+
+    return Xfer_Start(slave, object, true);
+}
+
+/**
+ * @brief	把最近一次读取的内容写入从站对象
+ * @details	用于在从站间复制配置、转发表或场景表
+ * @param	slave 从站号
+ * @param	object 1:配置寄存器 2:中继转发表 3:输出场景表(必须与读取的对象相同)
+ * @retval	0 成功 0xFF 参数错误、没有读取完成的内容或已有会话进行中
+ */
+uint8_t Xfer_Put(int slave, int object)
+{
+    if ((Xfer.State != XFER_DONE) || Xfer.Write || (object == (int)XFER_OBJ_SOE) || (object != (int)Xfer.Object))
+    {
+        return 0xFF;
+    }
+    return Xfer_Start_Write(slave, object);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), xfer_put, Xfer_Put, write slave object);
+
+/**
+ * @brief	把本机构造的内容写入从站对象
+ * @details	供其他模块下发整个对象(如场景表)，内容复制到会话的原始数据区
+ * @param	slave 从站号
+ * @param	object 对象(不能为SOE事件记录)
+ * @param	pRaw 内容
+ * @param	Length 字节数
+ * @retval	0 成功 0xFF 参数错误或已有会话进行中
+ */
+uint8_t Xfer_Write(int slave, int object, const uint8_t *pRaw, uint16_t Length)
+{
+    if ((object == (int)XFER_OBJ_SOE) || (Length > XFER_RAW_SIZE) || Xfer.Pending ||
+        ((Xfer.State >= XFER_OPEN) && (Xfer.State <= XFER_COMMIT)))
+    {
+        return 0xFF;
+    }
+    memcpy(Xfer.Raw, pRaw, Length);
+    Xfer.Raw_Length = Length;
+
+    return Xfer_Start_Write(slave, object);
+}
+
+/**
+ * @brief	打印会话状态、统计及原始数据
+ * @param	None
+ * @retval	None
+ */
+void Xfer_Show(void)
+{
+    static const char *const states[] = {"idle", "open", "blocks", "commit", "done", "failed"};
+    Xfer_Stats *pX = &Xfer.Stats;
+
+    shellPrint(&shell, "slave = %d, object = %d, %s, state = %s, result = 0x%02x, mode = %d, raw = %d, length = %d\r\n",
+               Xfer.Slave, Xfer.Object, Xfer.Write ? "write" : "read", states[Xfer.State], Xfer.Result, Xfer.Mode,
+               Xfer.Raw_Length, Xfer.Length);
+    shellPrint(&shell, "window = %d, received = 0x%02x, sent = 0x%02x\r\n", Xfer.Window, Xfer.Received, Xfer.Sent);
+    shellPrint(&shell, "requests = %u, blocks = %u, bursts = %u, retries = %u, done = %u, failed = %u, saved = %u\r\n",
+               pX->Requests, pX->Blocks, pX->Bursts, pX->Retries, pX->Done, pX->Failed, pX->Saved);
+    if ((Xfer.State != XFER_DONE) || Xfer.Write)
+    {
+        return;
+    }
+    for (uint16_t i = 0; i < Xfer.Raw_Length; i++)
+    {
+        shellPrint(&shell, "%02x%s", Xfer.Raw[i], (((i & 0x0FU) == 0x0FU) || (i + 1U == Xfer.Raw_Length)) ? "\r\n" : " ");
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), xfer, Xfer_Show, show block transfer);
+#endif
@@ -60,13 +60,14 @@
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 7 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)64)
-#define configTOTAL_HEAP_SIZE                    ((size_t)8192)
+#define configTOTAL_HEAP_SIZE                    ((size_t)7168)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
 #define configCHECK_FOR_STACK_OVERFLOW           2
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
+#define configUSE_TICKLESS_IDLE                  1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                    0
@@ -88,6 +89,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil             0
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -132,6 +134,30 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/*Stop the TIM1 HAL time base around tickless sleep (freertos.c)*/
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void PreSleepProcessing(uint32_t *ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t *ulExpectedIdleTime);
+#endif
+#define configPRE_SLEEP_PROCESSING(x)  PreSleepProcessing(x)
+#define configPOST_SLEEP_PROCESSING(x) PostSleepProcessing(x)
+/*The heap array lives in heap_trace.c so its block map can be walked*/
+#define configAPPLICATION_ALLOCATED_HEAP         1
+/*Log every heap_4 allocation and free with its caller (heap_trace.c); comment out to remove the hooks*/
+#define USING_HEAP_TRACE
+#if defined(USING_HEAP_TRACE)
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void Heap_Trace_Malloc(void *pBlock, size_t Size, void *pCaller);
+void Heap_Trace_Free(void *pBlock, size_t Size, void *pCaller);
+#endif
+#if defined(__CC_ARM)
+#define HEAP_TRACE_CALLER() ((void *)__return_address())
+#else
+#define HEAP_TRACE_CALLER() __builtin_return_address(0)
+#endif
+#define traceMALLOC(pvAddress, uiSize) Heap_Trace_Malloc((pvAddress), (uiSize), HEAP_TRACE_CALLER())
+#define traceFREE(pvAddress, uiSize) Heap_Trace_Free((pvAddress), (uiSize), HEAP_TRACE_CALLER())
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
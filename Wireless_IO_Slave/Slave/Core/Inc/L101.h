@@ -9,6 +9,8 @@ extern "C" {
 /*定义Master发送缓冲区字节数*/
 #define PF_TX_SIZE 64U
 #define LEVENTS (sizeof(L101_Map) / sizeof(L101_HandleTypeDef))
+/*L101状态引脚变位信号(At任务)*/
+#define L101_SIGNAL_STATUS 0x01
 
 typedef struct 
 { 
@@ -80,6 +82,7 @@ typedef struct  L101
 
 extern bool inline Get_L101_Status(void);
 extern void Set_L101_FactoryMode(void);
+extern void L101_Status_Handle(void);
 extern void Master_Poll(void);
 #ifdef __cplusplus
 }
@@ -0,0 +1,69 @@
+#ifndef __AOUT_H__
+#define __AOUT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+/*模拟量输出(USING_AOUT，main.h):主站写入 ANALOG_OUTPUT_START_ADDR + 通道 的12bit码值由TIM3 PWM输出，
+  经RC滤波及输出级得到0~10V或4~20mA。CCR开启预装载，新值在PWM周期结束的更新事件生效(双缓冲，无毛刺)；
+  斜率限制时由TIM4每 AOUT_STEP_TIME 产生一次DMA请求，从斜坡表逐点写入CCR，一段 AOUT_RAMP_STEPS 点，
+  段结束的DMA完成中断计算下一段，CPU不参与逐点更新*/
+/*PWM周期(计数，ARR+1):12bit分辨率，72MHz时约17.6kHz；时钟降档时频率同比例降低，占空比不变*/
+#define AOUT_PWM_PERIOD 4096U
+/*斜坡的步进间隔(us，TIM4按1us计数)及每段点数*/
+#define AOUT_STEP_TIME 1000U
+#define AOUT_RAMP_STEPS 32U
+/*输出级:电压(0~10V，占空比0~100%)、电流(4~20mA，占空比20%~100%)*/
+#define AOUT_STAGE_VOLTAGE 0U
+#define AOUT_STAGE_CURRENT 1U
+/*电流输出级的零点(4mA)对应的CCR*/
+#define AOUT_CURRENT_ZERO (AOUT_PWM_PERIOD / 5U)
+#define AOUT_CODE_MAX 0x0FFFU
+
+/*输出通道:X(通道, TIM3通道号, GPIOA引脚号, 输出级, 步进DMA请求(dma_mgr.h), DMA句柄)
+  两个DMA请求都由TIM4产生(更新事件、CC2)，每个步进间隔各一次*/
+#define AOUT_TABLE(X)                                                \
+    X(0, 1, 6, AOUT_STAGE_VOLTAGE, TIM4_UP, hdma_tim4_up)            \
+    X(1, 2, 7, AOUT_STAGE_CURRENT, TIM4_CH2, hdma_tim4_ch2)
+
+#define AOUT_COUNT_ENTRY(ch, tim_ch, pin, stage, req, hdma) +1U
+#define AOUT_CHANNELS (0U AOUT_TABLE(AOUT_COUNT_ENTRY))
+
+    typedef struct
+    {
+        /*斜坡表，DMA逐点写入CCR*/
+        uint16_t Ramp[AOUT_RAMP_STEPS];
+        /*目标码值及已写入斜坡表的码值(Q8)*/
+        uint16_t Target;
+        uint32_t Current;
+        /*DMA正在输出一段斜坡*/
+        volatile bool Busy;
+        /*收到的新值及计算的斜坡段数*/
+        uint32_t Updates;
+        uint32_t Segments;
+    } Aout_Channel;
+
+    typedef struct
+    {
+        Aout_Channel Channel[AOUT_CHANNELS];
+        /*每个步进的最大变化(码值，Q8)，0:不限制*/
+        uint32_t Step;
+    } Aout_HandleTypeDef;
+
+    extern DMA_HandleTypeDef hdma_tim4_up;
+    extern DMA_HandleTypeDef hdma_tim4_ch2;
+
+    extern void Aout_Init(void);
+    extern void Aout_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+    extern void Aout_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AOUT_H__ */
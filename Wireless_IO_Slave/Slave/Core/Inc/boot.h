@@ -0,0 +1,41 @@
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*分级启动:main() 中只初始化关键I/O(输出、Modbus应答及其依赖)，FRAM序号恢复及掉电前继电器状态的取回
+  在启动任务中完成。启动节点:X(节点名, 说明)，记录自 HAL_Init() 起的毫秒数*/
+#define BOOT_MARK_TABLE(X)                 \
+    X(MAIN, "critical init done")          \
+    X(OUTPUT, "first output pass")         \
+    X(FRAME, "first frame handled")        \
+    X(LOG, "fram log recovered")           \
+    X(READY, "deferred init done")
+
+#define BOOT_MARK_ENUM(name, text) BOOT_MARK_##name,
+    enum
+    {
+        BOOT_MARK_TABLE(BOOT_MARK_ENUM)
+            BOOT_MARKS
+    };
+
+    typedef struct
+    {
+        /*各节点的时刻(ms)及已到达的节点*/
+        uint32_t Tick[BOOT_MARKS];
+        uint32_t Marked;
+    } Boot_HandleTypeDef;
+
+    extern void Boot_Mark(uint8_t Mark);
+    extern void Boot_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOT_H__ */
@@ -0,0 +1,55 @@
+#ifndef __CLOCK_MGR_H__
+#define __CLOCK_MGR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*运行时钟档位:X(档位名, AHB分频, Flash等待周期, ADC分频, 说明)。PLL始终锁定在72MHz，各档只改AHB分频，
+  APB分频不变(外设时钟同比例变化)，切换只需数个总线周期；改用HSE(8MHz)或重新倍频(24MHz)须等待PLL重新锁定，
+  恢复全速要百微秒级，不采用。ADC时钟保持在0.6~14MHz之间*/
+#define CLOCK_PROFILE_TABLE(X)                                                   \
+    /*收发帧及处理，上电默认*/                                                   \
+    X(FULL, RCC_SYSCLK_DIV1, FLASH_LATENCY_2, RCC_ADCPCLK2_DIV6, "72MHz active") \
+    /*等待帧:18MHz，APB1 9MHz*/                                                  \
+    X(IDLE, RCC_SYSCLK_DIV4, FLASH_LATENCY_0, RCC_ADCPCLK2_DIV2, "18MHz idle")   \
+    /*长时间无帧:9MHz，USART3波特率误差约0.2%*/                                  \
+    X(DEEP, RCC_SYSCLK_DIV8, FLASH_LATENCY_0, RCC_ADCPCLK2_DIV2, "9MHz idle")
+
+#define CLOCK_PROFILE_ENUM(name, hpre, latency, adc, text) CLOCK_PROFILE_##name,
+    enum
+    {
+        CLOCK_PROFILE_TABLE(CLOCK_PROFILE_ENUM)
+            CLOCK_PROFILES
+    };
+
+/*最后一帧(或输出事件)之后多久降到空闲档(ms)，再过同样时间降到最低档*/
+#define CLOCK_IDLE_DELAY 2000U
+
+    typedef struct
+    {
+        /*当前档位*/
+        uint8_t Profile;
+        /*按空闲时间自动降档，shell固定档位时关闭*/
+        bool Auto;
+        /*最近一次活动的时刻(ms)*/
+        uint32_t Active;
+        /*跳过的降档(串口正在发送)*/
+        uint32_t Deferred;
+        uint32_t Switches;
+    } Clock_HandleTypeDef;
+
+    extern void Clock_Init(void);
+    extern void Clock_Active(void);
+    extern void Clock_Idle(void);
+    extern uint8_t Clock_Set(int Profile);
+    extern void Clock_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLOCK_MGR_H__ */
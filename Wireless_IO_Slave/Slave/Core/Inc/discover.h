@@ -0,0 +1,47 @@
+#ifndef __DISCOVER_H__
+#define __DISCOVER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+#include "mac.h"
+
+/*入网发现(MODBUS_CODE_JOIN)，与主站 discover.h 一致:
+  信标(广播) |会话|轮次|时隙数|时隙长度(ms,2B)|
+  应答       |会话|轮次|数字量输入数|输出数|模拟量输入数|逻辑单元数|
+  每个新轮次的信标在 [0, 时隙数) 中随机选一个时隙，在该时隙开始时应答*/
+#define DISCOVER_BEACON_SIZE 5U
+#define DISCOVER_REPLY_SIZE 6U
+/*信标中时隙数及时隙长度(ms)的上限*/
+#define DISCOVER_SLOTS_MAX 16U
+#define DISCOVER_SLOT_MAX 500U
+
+    typedef struct
+    {
+        /*已收到过信标，Session/Round 有效*/
+        bool Valid;
+        /*延迟应答待发送及其信道竞争状态*/
+        bool Pending;
+        Mac_Slot Mac;
+        uint8_t Session;
+        uint8_t Round;
+        uint32_t Beacons;
+        uint32_t Replies;
+        /*信道持续忙而放弃的应答数*/
+        uint32_t Dropped;
+    } Discover_HandleTypeDef;
+
+    extern void Discover_Init(ModbusRTUSlaveHandler handler);
+    extern uint32_t Discover_Wait(uint32_t Wait);
+    extern void Discover_Poll(ModbusRTUSlaveHandler handler);
+    extern void Discover_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISCOVER_H__ */
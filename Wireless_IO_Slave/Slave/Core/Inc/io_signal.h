@@ -5,6 +5,8 @@
 extern "C" {
 #endif
 #include "stdbool.h"
+#include "main.h"
+#include "mdrtuslave.h"
 
 /*定义外部数字量输入路数*/
 #define EXTERN_DIGITAL_MAX 2U
@@ -16,12 +18,74 @@ extern "C" {
 #define DIGITAL_OUTPUT_START_ADDR 0x02
 /*模拟信号量在内存中初始地址*/
 #define ANALOG_START_ADDR 0x00
+/*主站下发的模拟量在保持寄存器中的初始地址*/
+#define ANALOG_OUTPUT_START_ADDR 0x10
+/*继电器输出路数*/
+#define EXTERN_OUTPUT_MAX 1U
+/*通信中断看门狗超时(ms)在保持寄存器中的地址，为0时使用默认值*/
+#define FAILSAFE_TIMEOUT_ADDR 0x18
+#define FAILSAFE_TIMEOUT_DEFAULT 10000U
+#define FAILSAFE_TIMEOUT_MIN 100U
+/*各路输出的失效安全策略及脉冲宽度(ms)在保持寄存器中的初始地址，每路1个寄存器*/
+#define FAILSAFE_POLICY_START_ADDR 0x19
+#define FAILSAFE_PULSE_START_ADDR (FAILSAFE_POLICY_START_ADDR + EXTERN_OUTPUT_MAX)
+/*失效安全策略:断开(默认)、保持最后状态、闭合、闭合脉冲宽度后断开*/
+#define FAILSAFE_OFF 0x00
+#define FAILSAFE_HOLD 0x01
+#define FAILSAFE_ON 0x02
+#define FAILSAFE_PULSE 0x03
+/*各路输出的本地输出模式及其时间(ms)在保持寄存器中的初始地址，每路1个寄存器*/
+#define OUTPUT_MODE_START_ADDR (FAILSAFE_PULSE_START_ADDR + EXTERN_OUTPUT_MAX)
+#define OUTPUT_TIME_START_ADDR (OUTPUT_MODE_START_ADDR + EXTERN_OUTPUT_MAX)
+/*定点模式应答帧头中的信道在保持寄存器中的地址:主站以多个L101模块分组轮询时，设为服务本站信道组的模块所在信道，
+为0时应答发往信道0(默认)；写入在掉电保持区写回后生效，写入本身的应答仍经原信道返回*/
+#define REPLY_CHANNEL_ADDR (OUTPUT_TIME_START_ADDR + EXTERN_OUTPUT_MAX)
+/*定点模式应答帧头中的目标节点地址:经中继访问时设为中继节点的L101地址，为0时应答发往主站(默认)，生效时机同应答信道*/
+#define REPLY_ADDR_ADDR (REPLY_CHANNEL_ADDR + 1U)
+/*模拟量输出的斜率限制(12bit码值/s)，为0时新值在下一个PWM周期直接输出(aout.h)*/
+#define ANALOG_RAMP_ADDR (REPLY_ADDR_ADDR + 1U)
+/*输出模式:跟随线圈(默认)、线圈上升沿输出单次脉冲、延时闭合、延时断开、线圈上升沿翻转*/
+#define OUTPUT_MODE_DIRECT 0x00
+#define OUTPUT_MODE_PULSE 0x01
+#define OUTPUT_MODE_ON_DELAY 0x02
+#define OUTPUT_MODE_OFF_DELAY 0x03
+#define OUTPUT_MODE_TOGGLE 0x04
+/*输出任务信号:主站写入了输出线圈*/
+#define IO_SIGNAL_OUTPUT 0x01
+/*输出任务信号:启动任务从外部日志取回了掉电前的继电器状态*/
+#define IO_SIGNAL_RESTORE 0x02
+/*链路超时后输出任务的刷新周期(ms):失效安全脉冲的计时分辨率*/
+#define IO_OUTPUT_PERIOD 50U
+/*快速输出(USING_FAST_OUTPUT，main.h)的保持时间(ms):超过此时间Modbus任务仍未把线圈写成中断中已驱动的状态(帧被任务丢弃)时，
+输出任务恢复按线圈输出(在下一次被唤醒时)*/
+#define FAST_OUTPUT_HOLD 100U
+/*模拟量处理周期(ms):在定时器服务任务中取DMA循环缓冲的平均值，经一阶低通、校准后写入保持寄存器*/
+#define ANALOG_PERIOD 20U
+/*一阶低通:每周期向新码值靠近 1/2^ANALOG_FILTER_SHIFT(时间常数约 ANALOG_PERIOD * 2^ANALOG_FILTER_SHIFT)*/
+#define ANALOG_FILTER_SHIFT 3U
+/*默认校准的满量程(uA/mV，对应12bit码值4095):通道0电流，通道1电压*/
+#define ANALOG_FULL_SCALE_CURRENT 20000
+#define ANALOG_FULL_SCALE_VOLTAGE 10000
+/*模拟量上报条件默认值(同主站):绝对死区(12bit码值)、相对死区(上次上报值的0.1%)、最短间隔(ms)及最长间隔(s)*/
+#define ANALOG_DEADBAND_ABSOLUTE 8U
+#define ANALOG_DEADBAND_PERCENT 5U
+#define ANALOG_PUBLISH_MIN_INTERVAL 200U
+#define ANALOG_PUBLISH_MAX_INTERVAL 60U
 
 
 extern void Io_Digital_Input(void);
+extern void Io_Analog_Init(void);
 extern void Io_Analog_Handle(void);
+extern void Io_Analog_Start(void);
+extern uint8_t Io_Analog_Report(ModbusRTUSlaveHandler handler, mdU16 *values);
 #if defined(USING_SLAVE)
 extern void Io_Digital_Output(bool signal);
+extern void Io_Output_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+extern uint32_t Io_Failsafe_Timeout(void);
+extern void Io_Output_Mode_Init(void);
+extern void Io_Output_Restore(void);
+extern mdVOID Io_Output_Fast(ModbusRTUSlaveHandler handler, const mdU8 *frame, mdU32 length);
+extern void Io_Output_Fast_Show(void);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,50 @@
+#ifndef __IRQ_PRIO_H__
+#define __IRQ_PRIO_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "FreeRTOSConfig.h"
+
+/*中断优先级方案，与主站 irq_prio.h 一致:优先级分组4，数值越小越优先，启动时覆盖CubeMX生成的值。
+  内核中断(IRQ_KERNEL)会调用RTOS的中断接口，优先级不得高于系统调用上限(编译期检查)；
+  裸中断(IRQ_BARE)高于上限，只做不调用RTOS的工作。无线链路的帧边界判定为最高的内核中断，shell最低*/
+#define IRQ_BARE 0U
+#define IRQ_KERNEL 1U
+#define IRQ_SYSCALL_CEILING configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+
+/*X(中断号, 抢占优先级, 类型)*/
+#define IRQ_PRIORITY_TABLE(X)                                                  \
+    /*HAL时基，只递增计数*/                                                    \
+    X(TIM1_UP_IRQn, TICK_INT_PRIORITY, IRQ_BARE)                               \
+    /*SPI2从机(spis.h)命令头的逐字节接收，字节间隔只有数微秒*/                \
+    X(SPI2_IRQn, 2U, IRQ_BARE)                                                 \
+    /*USART3(L101无线模块)空闲中断分帧，唤醒Modbus任务*/                       \
+    X(USART3_IRQn, 5U, IRQ_KERNEL)                                             \
+    /*微秒定时器(utimer.h)，含RTU帧间隔的t1.5、t3.5*/                          \
+    X(TIM2_IRQn, 5U, IRQ_KERNEL)                                               \
+    /*USART3的收发DMA*/                                                        \
+    X(DMA1_Channel2_IRQn, 6U, IRQ_KERNEL)                                      \
+    X(DMA1_Channel3_IRQn, 6U, IRQ_KERNEL)                                      \
+    /*L101模块STATUS引脚、SPI2从机的片选释放*/                                 \
+    X(EXTI15_10_IRQn, 6U, IRQ_KERNEL)                                          \
+    /*ADC的DMA*/                                                               \
+    X(DMA1_Channel1_IRQn, 7U, IRQ_KERNEL)                                      \
+    /*SPI2(外部FRAM日志)的发送DMA，完成时唤醒日志任务*/                        \
+    X(DMA1_Channel5_IRQn, 7U, IRQ_KERNEL)                                      \
+    /*模拟量输出斜坡的DMA(TIM4_CH2、TIM4_UP)，段结束时计算下一段*/             \
+    X(DMA1_Channel4_IRQn, 7U, IRQ_KERNEL)                                      \
+    X(DMA1_Channel7_IRQn, 7U, IRQ_KERNEL)                                      \
+    /*USART1(shell)逐字节接收*/                                                \
+    X(USART1_IRQn, 8U, IRQ_KERNEL)
+
+    extern void Irq_Priority_Init(void);
+    extern void Irq_Priority_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IRQ_PRIO_H__ */
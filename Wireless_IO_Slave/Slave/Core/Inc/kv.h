@@ -0,0 +1,58 @@
+#ifndef __KV_H__
+#define __KV_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*参数存储区占用flash末尾的两页，交替作为活动页；工程的IROM1须扣除这两页*/
+#define KV_PAGE_A 62U
+#define KV_PAGE_B 63U
+#define KV_PAGE_SIZE FLASH_PAGE_SIZE
+#define KV_PAGE_ADDR(n) (FLASH_BASE + (uint32_t)(n) * KV_PAGE_SIZE)
+#define KV_MAGIC 0x4B56U
+/*单个参数的最大字节数*/
+#define KV_VALUE_MAX 32U
+/*无效键(擦除后的值)*/
+#define KV_KEY_NONE 0xFFU
+/*参数键*/
+/*保持寄存器中的配置区映像*/
+#define KV_KEY_HOLD 0x01U
+/*中继转发表*/
+#define KV_KEY_FORWARD 0x02U
+/*帧认证开关及密钥*/
+#define KV_KEY_AUTH 0x03U
+/*帧认证已保存的请求序号上限*/
+#define KV_KEY_AUTH_SEQ 0x04U
+/*从站模拟器的站号范围、应答延迟及丢弃概率*/
+#define KV_KEY_SIM 0x05U
+/*模拟量校准系数及上报条件(io_signal.c)*/
+#define KV_KEY_ANALOG 0x06U
+/*输出场景，场景i使用键 KV_KEY_SCENE + i(scene.h)*/
+#define KV_KEY_SCENE 0x08U
+
+    /*页格式:[KV_MAGIC][代数]，随后依次追加记录
+      记录格式:[长度<<8|键][版本][数据(补齐到半字)][CRC16]，CRC覆盖记录头、版本及数据*/
+    typedef struct
+    {
+        /*活动页地址*/
+        uint32_t Page;
+        /*活动页代数，整理时加1，较新的一页为活动页*/
+        uint16_t Gen;
+        /*下一条记录的半字偏移*/
+        uint16_t Tail;
+    } Kv_HandleTypeDef;
+
+    extern void Kv_Init(void);
+    extern uint16_t Kv_Get(uint8_t Key, void *pValue, uint16_t Size);
+    extern bool Kv_Set(uint8_t Key, const void *pValue, uint16_t Size);
+    extern void Kv_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KV_H__ */
@@ -0,0 +1,69 @@
+#ifndef __MAC_H__
+#define __MAC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+
+/*从站主动上行帧(入网应答、今后的变位上报等)的信道接入:先侦听后发送(LBT)+ 随机二进制指数退避；
+  信道忙:L101状态引脚为忙(本模块仍在发送)或 MAC_GUARD ms 内收到过无线帧(其他节点正在通信)；
+  随机数以芯片唯一ID为种子，每次开始竞争时混入ADC采样的最低位(噪声)，同批上电的从站也能错开*/
+/*退避时隙长度(ms)，不短于一帧典型上行帧在低速率等级下的空中时间*/
+#define MAC_SLOT 40U
+/*收到无线帧后视为信道忙的时间(ms)，覆盖对端的应答间隔*/
+#define MAC_GUARD 60U
+/*初始竞争窗口(时隙数)及窗口翻倍的最大次数*/
+#define MAC_CW_MIN 4U
+#define MAC_BACKOFF_MAX 5U
+/*连续侦听到信道忙的次数达到后放弃本帧*/
+#define MAC_RETRY_MAX 8U
+
+/*Mac_Access() 的结果*/
+#define MAC_WAIT 0U
+#define MAC_SEND 1U
+#define MAC_DROP 2U
+
+    /*一个上行帧的竞争状态，由发送方持有*/
+    typedef struct
+    {
+        /*下一次侦听的时刻(ms)*/
+        uint32_t Due;
+        /*已退避次数*/
+        uint8_t Attempt;
+    } Mac_Slot;
+
+    /*自由计数的统计(mac 命令查看)*/
+    typedef struct
+    {
+        /*开始竞争、侦听到信道空闲后发出、因信道忙退避及放弃的帧数*/
+        uint32_t Started;
+        uint32_t Sent;
+        uint32_t Backoffs;
+        uint32_t Dropped;
+    } Mac_Stats;
+
+    typedef struct
+    {
+        /*最近一次收到无线帧的时刻(ms)*/
+        volatile uint32_t Last_Rx;
+        /*随机数状态*/
+        uint32_t Seed;
+        Mac_Stats Stats;
+    } Mac_HandleTypeDef;
+
+    extern void Mac_Init(void);
+    extern uint32_t Mac_Random(void);
+    extern void Mac_Activity(void);
+    extern void Mac_Start(Mac_Slot *pSlot, uint32_t Delay, uint32_t Window);
+    extern uint32_t Mac_Wait(const Mac_Slot *pSlot, uint32_t Wait);
+    extern uint8_t Mac_Access(Mac_Slot *pSlot);
+    extern void Mac_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAC_H__ */
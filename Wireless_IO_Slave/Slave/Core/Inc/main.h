@@ -41,6 +41,22 @@ extern "C" {
 
 /* Exported types ------------------------------------------------------------*/
 /* USER CODE BEGIN ET */
+/*延迟测量点:事件及DWT周期计数记入RAM环并统计直方图，关闭时测量点不产生代码*/
+#define USING_TRACE
+/*从站模拟器(测试固件):本板模拟多个逻辑从站，可注入应答延迟及丢包，用于主站调度的吞吐量回归测试*/
+// #define USING_SIMULATOR
+/*模拟量输出:主站下发的模拟量由TIM3 PWM经RC滤波输出(0~10V或4~20mA)，斜率限制由TIM4节拍触发DMA逐点写入CCR*/
+#define USING_AOUT
+/*输出场景:预设的多路输出保存在flash，主站一帧(可广播)即可同时切换(scene.h)*/
+#define USING_SCENE
+/*SPI2从机:本地协处理器经SPI2以MHz速率读取寄存器映像(spis.h)，SPI2不再连接外部FRAM日志*/
+// #define USING_SPI_SLAVE
+/*模拟量上报:滤波、校准后的模拟量越过死区(或到达最长间隔)时附带在写线圈应答的健康信息之后，主站无需另行读取(cal_show 命令)*/
+#define USING_ANALOG_UPLINK
+/*快速输出:发往本站的FC05及场景帧在串口空闲中断中校验后立即驱动继电器(跟随线圈的输出)，寄存器池及应答仍由任务处理(fast_output 命令)*/
+#define USING_FAST_OUTPUT
+/*微秒定时器:TIM2扩展为32位微秒时钟，单次/周期定时器按最近的到期时刻设置一次比较中断，RTU帧间隔及通信中断失效安全到期即执行(utimer 命令)*/
+#define USING_UTIMER
 
 /* USER CODE END ET */
 
@@ -0,0 +1,70 @@
+#ifndef __OTA_H__
+#define __OTA_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+/*固件分发(MODBUS_CODE_OTA)，与主站 ota.h 一致，多字节字段高字节在前:
+  开始(广播) |0x01|会话|映像长度(4B)|映像CRC32(4B)|版本(2B)|
+  数据(广播) |0x02|会话|块号(2B)|数据(OTA_CHUNK，最后一块可更短)|
+  查询       |0x03|会话|起始块号(2B)| -> |0x03|会话|状态|缺少的块数(2B)|窗口起始块号(2B)|缺块位图(OTA_WINDOW/8)|
+  激活(广播) |0x04|会话|
+  查询应答的窗口从不小于起始块号的第一个缺块开始(按8对齐)，位为1表示缺少该块*/
+#define OTA_OP_BEGIN 0x01U
+#define OTA_OP_DATA 0x02U
+#define OTA_OP_STATUS 0x03U
+#define OTA_OP_ACTIVATE 0x04U
+/*接收状态:没有会话、接收中、映像已校验、映像CRC错误(重新接收)*/
+#define OTA_STATE_NONE 0x00U
+#define OTA_STATE_RECEIVING 0x01U
+#define OTA_STATE_VERIFIED 0x02U
+#define OTA_STATE_BAD 0x03U
+#define OTA_CHUNK 64U
+#define OTA_WINDOW 128U
+/*B区:128KB器件(STM32F103CB，多数C8芯片同样可用)的后64KB，映像最大与应用区(IROM1)相同*/
+#define OTA_SLOT_ADDR 0x08010000UL
+#define OTA_IMAGE_MAX 0xF800UL
+#define OTA_CHUNKS_MAX ((OTA_IMAGE_MAX + OTA_CHUNK - 1U) / OTA_CHUNK)
+/*映像描述页(B区之后一页):|OTA_MAGIC(4B)|长度(4B)|CRC32(4B)|版本(2B)|，半字小端写入；
+  引导程序在描述有效且B区CRC正确时把B区拷贝到应用区后擦除该页*/
+#define OTA_INFO_ADDR (OTA_SLOT_ADDR + OTA_IMAGE_MAX)
+#define OTA_MAGIC 0x4F544131UL
+
+    /*自由计数的统计(ota 命令查看)*/
+    typedef struct
+    {
+        uint32_t Chunks;
+        /*重复收到的块*/
+        uint32_t Dups;
+        /*flash擦写失败*/
+        uint32_t Flash_Errors;
+        uint32_t Bad_Images;
+    } Ota_Stats;
+
+    typedef struct
+    {
+        uint8_t Session;
+        uint8_t State;
+        uint16_t Version;
+        uint32_t Length;
+        uint32_t Crc;
+        uint16_t Missing;
+        /*已收到的块及已擦除的页*/
+        uint8_t Received[(OTA_CHUNKS_MAX + 7U) / 8U];
+        uint8_t Erased[(OTA_IMAGE_MAX / FLASH_PAGE_SIZE + 7U) / 8U];
+        Ota_Stats Stats;
+    } Ota_HandleTypeDef;
+
+    extern void Ota_Init(ModbusRTUSlaveHandler handler);
+    extern void Ota_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OTA_H__ */
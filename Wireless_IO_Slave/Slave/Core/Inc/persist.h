@@ -0,0 +1,40 @@
+#ifndef __PERSIST_H__
+#define __PERSIST_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+#include "io_signal.h"
+
+/*掉电保持的保持寄存器区:通信中断策略、输出模式、应答信道及模拟量输出斜率等配置寄存器*/
+#define PERSIST_START_ADDR FAILSAFE_TIMEOUT_ADDR
+#define PERSIST_REGS (ANALOG_RAMP_ADDR + 1U - PERSIST_START_ADDR)
+/*最后一次写入后静止的时间(ms)，期间的连续写入合并为一次flash写入*/
+#define PERSIST_DELAY 2000U
+#define PERSIST_SIGNAL 0x01
+
+    typedef struct
+    {
+        /*待写回的寄存器位图，第n位对应 PERSIST_START_ADDR + n*/
+        uint16_t Dirty;
+        /*最后一次写入的时刻*/
+        uint32_t Tick;
+        /*已完成的flash写入次数及失败次数*/
+        uint16_t Writes;
+        uint16_t Errors;
+    } Persist_HandleTypeDef;
+
+    extern void Persist_Init(void);
+    extern void Persist_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+    extern uint32_t Persist_Poll(void);
+    extern void Persist_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERSIST_H__ */
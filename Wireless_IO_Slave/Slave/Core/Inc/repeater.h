@@ -0,0 +1,30 @@
+#ifndef __REPEATER_H__
+#define __REPEATER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+    /*一条转发项(整表作为一个参数保存):发往站号 Id 的请求转发到下游节点 Addr/Channel，Id 为0时无效*/
+    typedef struct
+    {
+        uint16_t Addr;
+        uint8_t Id;
+        uint8_t Channel;
+    } Repeater_Entry;
+
+    extern void Repeater_Init(void);
+    extern uint8_t Repeater_Set(int index, int id, int addr, int channel);
+    extern uint16_t Repeater_Read(void *pBuf, uint16_t Size);
+    extern bool Repeater_Write(const void *pBuf, uint16_t Size);
+    extern void Repeater_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __REPEATER_H__ */
@@ -0,0 +1,64 @@
+#ifndef __SCENE_H__
+#define __SCENE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+#include "io_signal.h"
+
+/*输出场景(USING_SCENE，main.h):从站保存若干组预设的输出，主站一帧 MODBUS_CODE_SCENE 即可同时切换多路输出；
+  场景表作为分块传输对象 XFER_OBJ_SCENE 一次写入，每个场景一个参数键保存在flash；
+  请求 |场景号| -> |场景号|，广播站号时同一信道的从站同时执行，不应答；场景未定义时异常应答(非法数据值)*/
+#define SCENE_MAX 8U
+/*一个场景包含的模拟量输出路数(超出 AOUT_CHANNELS 的通道忽略)*/
+#define SCENE_AOUT_MAX 2U
+/*传输格式(高字节在前):|线圈掩码(2B)|线圈值(2B)|模拟量掩码|保留|模拟量0(2B)|模拟量1(2B)|，
+  线圈第i位对应输出线圈 DIGITAL_OUTPUT_START_ADDR + i，模拟量第i位对应 ANALOG_OUTPUT_START_ADDR + i；
+  两个掩码都为0的场景未定义*/
+#define SCENE_WIRE_SIZE (6U + 2U * SCENE_AOUT_MAX)
+#define SCENE_TABLE_SIZE (SCENE_MAX * SCENE_WIRE_SIZE)
+
+    typedef struct
+    {
+        uint16_t Coil_Mask;
+        uint16_t Coil_Value;
+        uint16_t Aout[SCENE_AOUT_MAX];
+        uint8_t Aout_Mask;
+        uint8_t Reserved;
+    } Scene_Entry;
+
+    /*自由计数的统计(scene 命令查看)*/
+    typedef struct
+    {
+        uint32_t Applied;
+        /*场景号越界或未定义的请求*/
+        uint32_t Rejected;
+        /*写入flash失败的场景数*/
+        uint32_t Errors;
+    } Scene_Stats;
+
+    typedef struct
+    {
+        Scene_Entry Table[SCENE_MAX];
+        /*最近执行的场景号，0xFF:未执行过*/
+        uint8_t Last;
+        Scene_Stats Stats;
+    } Scene_HandleTypeDef;
+
+    extern void Scene_Init(ModbusRTUSlaveHandler handler);
+    extern bool Scene_Apply(ModbusRTUSlaveHandler handler, uint8_t Index);
+    extern bool Scene_Coils(uint8_t Index, uint32_t *pMask, uint32_t *pBits);
+    extern uint16_t Scene_Read(uint8_t *pBuf, uint16_t Size);
+    extern bool Scene_Write(const uint8_t *pBuf, uint16_t Size);
+    extern uint8_t Scene_Set(int index, int coil_mask, int coil_value, int aout_mask, int aout0, int aout1);
+    extern void Scene_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCENE_H__ */
@@ -0,0 +1,55 @@
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+/*从站模拟器(USING_SIMULATOR，main.h):一块从站板在自身的L101地址/信道上模拟 Base ~ Base+Count-1 共 Count 个逻辑从站，
+  各站号映射到主单元(共用同一寄存器池及输入输出映像)；每个请求按 Drop(‰) 的概率丢弃不应答，其余等待
+  Delay + [0, Jitter] ms 后执行并应答。主站节点表中把这些站号配置为模拟器的地址/信道，即可在N个从站、
+  不同速率等级(SSPD)/前向纠错(SFEC)及注入丢包下测量调度吞吐量(Tools/hil_bench.py)*/
+/*逻辑从站数上限，与主站节点表容量一致*/
+#define SIM_UNITS_MAX 32U
+/*应答延迟上限(ms):一次接收中的多帧依次延迟，期间Modbus任务照常喂心跳*/
+#define SIM_DELAY_MAX 500U
+/*丢弃概率上限(‰)*/
+#define SIM_DROP_MAX 1000U
+
+    /*模拟配置(作为一个参数保存)，Count 为0时不模拟*/
+    typedef struct
+    {
+        uint8_t Base;
+        uint8_t Count;
+        uint16_t Delay;
+        uint16_t Jitter;
+        uint16_t Drop;
+    } Sim_Config;
+
+    typedef struct
+    {
+        Sim_Config Cfg;
+        /*随机数状态*/
+        uint32_t Seed;
+        /*各逻辑从站收到的请求及丢弃的请求*/
+        uint32_t Requests[SIM_UNITS_MAX];
+        uint32_t Drops[SIM_UNITS_MAX];
+    } Sim_HandleTypeDef;
+
+#if defined(USING_SIMULATOR)
+    extern void Sim_Init(ModbusRTUSlaveHandler handler);
+    extern uint8_t Sim_Set_Units(int base, int count);
+    extern uint8_t Sim_Set_Reply(int delay, int jitter, int drop);
+    extern void Sim_Show(void);
+    extern void Sim_Clear(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_H__ */
@@ -0,0 +1,90 @@
+#ifndef __SPIS_H__
+#define __SPIS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "cmsis_os.h"
+#include "mdconfig.h"
+
+/*SPI2从机(USING_SPI_SLAVE，main.h):本地协处理器(Linux/HMI板)作为SPI主机以MHz速率读取寄存器映像，
+  与外部FRAM日志(extlog.h)共用SPI2，二者只能选一。PB12为硬件NSS输入，其上升沿(EXTI12)结束一次传输。
+  每次片选期间主机在MOSI发出命令头 |功能码|起始地址(2B)|数量|，同时从MISO读出前台映像:
+  |序号|功能码|起始地址(2B)|数量|数据|CRC16|，寄存器高字节在前，线圈按位打包(同Modbus应答数据区)，
+  CRC覆盖序号至数据；多读的字节无意义。
+  命令头选择此后映像的内容(功能码1~4，0保持当前选择)，构建任务在后台映像中重建，完成后在下一次片选释放时
+  与前台交换，因此读出的总是同一时刻的完整快照，序号不变表示映像尚未更新。
+  映像由DMA1通道5发出，逐字节不占用CPU；命令头只有4字节，由接收中断读取(通道4被模拟量输出占用)*/
+#define SPIS_HEAD_SIZE 4U
+#define SPIS_PREFIX_SIZE 5U
+/*数据区最大字节数:整个输入寄存器池*/
+#define SPIS_DATA_MAX (2U * INPUT_REGISTER_POOL_SIZE)
+#define SPIS_IMAGE_SIZE (SPIS_PREFIX_SIZE + SPIS_DATA_MAX + 2U)
+#define SPIS_NSS_GPIO_Port GPIOB
+#define SPIS_NSS_Pin GPIO_PIN_12
+/*后台映像的刷新周期(ms)，片选释放时另行唤醒构建任务*/
+#define SPIS_PERIOD 5U
+#define SPIS_SIGNAL 0x01U
+/*片选释放后主机至少等待的时间(us)，用于交换映像及复位SPI2，之前再次选中时读出的数据无效*/
+#define SPIS_GAP_US 20U
+
+    /*后台映像状态:空闲(待构建)、构建中(中断不交换)、就绪(下一次片选释放时交换)*/
+    typedef enum
+    {
+        SPIS_FREE = 0,
+        SPIS_BUILDING,
+        SPIS_READY,
+    } Spis_State;
+
+    typedef struct
+    {
+        uint8_t Buf[SPIS_IMAGE_SIZE];
+        uint16_t Length;
+    } Spis_Image;
+
+    /*自由计数的统计(spis 命令查看)*/
+    typedef struct
+    {
+        /*片选释放次数及其中交换了映像的次数*/
+        uint32_t Transfers;
+        uint32_t Swaps;
+        /*构建的映像数*/
+        uint32_t Builds;
+        /*命令头不足4字节(只读)及功能码或范围无效的命令头，均保持当前选择*/
+        uint32_t Short;
+        uint32_t Rejected;
+    } Spis_Stats;
+
+    typedef struct
+    {
+        /*前台映像(DMA发送中)为 Image[Front]，后台为另一个*/
+        Spis_Image Image[2];
+        volatile uint8_t Front;
+        volatile uint8_t State;
+        /*当前选择:功能码、起始地址及数量(位或寄存器)*/
+        volatile uint8_t Code;
+        volatile uint16_t Addr;
+        volatile uint8_t Count;
+        /*本次片选收到的命令头*/
+        uint8_t Head[SPIS_HEAD_SIZE];
+        volatile uint8_t Head_Count;
+        uint8_t Seq;
+        /*HAL初始化后的控制寄存器，每次复位SPI2后恢复*/
+        uint32_t Cr1;
+        Spis_Stats Stats;
+    } Spis_HandleTypeDef;
+
+    extern void Spis_Init(void);
+    extern void Spis_Irq(void);
+    extern void Spis_Nss_Irq(void);
+    extern void Spis_Refresh(void);
+    extern void Spis_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIS_H__ */
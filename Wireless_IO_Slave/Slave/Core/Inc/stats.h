@@ -0,0 +1,30 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "mdregpool.h"
+
+/*导出周期(ms)*/
+#define STATS_PERIOD 1000U
+/*每 STATS_LOG_EXPORTS 次导出把全部计数的快照写入外部日志(extlog.h)，由 stats_log 命令读出*/
+#define STATS_LOG_EXPORTS 60U
+/*协议统计在输入寄存器中的初始地址(SOE导出区之后)*/
+#define STATS_REG_START_ADDR 0x20
+/*导出区:[接收帧][发送帧][CRC错误][其他站帧][长度错误][未知功能码][重复帧][DMA接收溢出][发送丢弃][帧间隔超时][异常应答]，
+均为自由计数的低16位，由 stats_clear 清零*/
+#define STATS_REG_SIZE 11U
+
+    extern void Stats_Init(RegisterPoolHandle Pool);
+    extern void Stats_Show(void);
+    extern void Stats_Clear(void);
+    extern void Stats_Log_Show(int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STATS_H__ */
@@ -0,0 +1,55 @@
+#ifndef __TIMESYNC_H__
+#define __TIMESYNC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+/*时间同步(MODBUS_CODE_TIME)，与主站 timesync.h 一致:
+  请求 |主站时刻(ms,4B)|单程时延估计(ms,2B)|，从站原样回显；广播请求同样采用，不应答*/
+#define TIMESYNC_REQUEST_SIZE 6U
+/*校正量超过该值(us)时直接跳变到新的时刻(主站重启或首次同步)*/
+#define TIMESYNC_STEP_US 100000L
+/*两次校正间隔不小于该值(ms)时才更新频差，间隔过短时误差主要来自时延抖动*/
+#define TIMESYNC_DRIFT_MIN 5000U
+/*频差估计的上限(ppm)*/
+#define TIMESYNC_DRIFT_MAX 2000L
+/*超过该时间(ms)未收到同步请求视为失步*/
+#define TIMESYNC_LOST 600000U
+
+    /*自由计数的统计(timesync 命令查看)*/
+    typedef struct
+    {
+        uint32_t Samples;
+        /*跳变次数*/
+        uint32_t Steps;
+        /*最近一次的校正量(us)*/
+        int32_t Error;
+    } Timesync_Stats;
+
+    typedef struct
+    {
+        bool Synced;
+        /*最近一次校正时的本机时刻(ms)*/
+        uint32_t Base;
+        /*Base 时刻主站时间减本机时间(us)*/
+        int64_t Offset;
+        /*主站时钟相对本机时钟的频差(ppm)*/
+        int32_t Drift;
+        Timesync_Stats Stats;
+    } Timesync_HandleTypeDef;
+
+    extern void Timesync_Init(ModbusRTUSlaveHandler handler);
+    extern bool Timesync_Convert(uint32_t Tick, uint16_t Us, uint32_t *pTick, uint16_t *pUs);
+    extern bool Timesync_Now(uint32_t *pTick);
+    extern void Timesync_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMESYNC_H__ */
@@ -28,14 +28,14 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "uart_dma.h"
 /* USER CODE END Includes */
 
 extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart3;
 
 /* USER CODE BEGIN Private defines */
-
+extern UartDma_HandleTypeDef Uart3_Dma;
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
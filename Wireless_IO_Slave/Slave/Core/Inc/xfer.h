@@ -0,0 +1,86 @@
+#ifndef __XFER_H__
+#define __XFER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "main.h"
+#include "stdbool.h"
+#include "mdrtuslave.h"
+
+/*分块传输(MODBUS_CODE_XFER)，与主站 xfer.h 一致:
+  打开读取 |0x01|对象| -> |0x01|对象|信息|     读取块 |0x02|块号|块数| -> |0x02|块号|长度|数据|
+  打开写入 |0x03|对象|信息| -> |0x03|对象|     写入块 |0x04|块号|长度|数据| -> |0x04|块号|已收到的块位图|
+  提交     |0x05| -> |0x05|结果|              连续写入 |0x06|块号|长度|数据| (广播站号，不应答)
+  信息:|编码|原始长度(2B)|传输长度(2B)|原始数据CRC(2B)|，高字节在前
+  读取块时从块号起连续返回至多 XFER_READ_BLOCKS 块(不足时到传输长度为止)；写入时窗口内的前几块以连续写入
+  发出(L101前缀仍指向目标从站)，窗口最后一块用写入块，其应答的位图确认整个窗口(选择重传)*/
+#define XFER_OP_OPEN_READ 0x01U
+#define XFER_OP_READ 0x02U
+#define XFER_OP_OPEN_WRITE 0x03U
+#define XFER_OP_WRITE 0x04U
+#define XFER_OP_COMMIT 0x05U
+#define XFER_OP_BURST 0x06U
+/*传输对象:SOE事件记录(只读)、掉电保持的配置寄存器、中继转发表、输出场景表(scene.h)*/
+#define XFER_OBJ_SOE 0x00U
+#define XFER_OBJ_CONFIG 0x01U
+#define XFER_OBJ_FORWARD 0x02U
+#define XFER_OBJ_SCENE 0x03U
+#define XFER_OBJECTS 4U
+/*编码:原样、LZSS(压缩后不小于原始数据时原样传输)*/
+#define XFER_MODE_STORED 0x00U
+#define XFER_MODE_LZSS 0x01U
+#define XFER_INFO_SIZE 7U
+/*每块数据字节数及对象的最大原始长度(SOE记录每条12字节)*/
+#define XFER_BLOCK 64U
+#define XFER_RAW_SIZE 384U
+#define XFER_BLOCKS_MAX ((XFER_RAW_SIZE + XFER_BLOCK - 1U) / XFER_BLOCK)
+/*一次读取应答的最多块数(应答PDU不超过 MODBUS_PDU_SIZE_MAX)*/
+#define XFER_READ_BLOCKS 3U
+/*提交结果:成功、有未收到的块、解压或CRC错误、对象拒绝写入*/
+#define XFER_OK 0x00U
+#define XFER_MISSING 0x01U
+#define XFER_CORRUPT 0x02U
+#define XFER_REJECTED 0x03U
+/*SOE记录:|序号(4B)|毫秒时刻(4B)|毫秒内微秒(2B)|点号|电平(最高位为 SOE_VALUE_SYNCED)|*/
+#define XFER_SOE_SIZE 12U
+
+    /*自由计数的统计(xfer 命令查看)*/
+    typedef struct
+    {
+        uint32_t Opens;
+        uint32_t Blocks;
+        /*连续写入收到的块*/
+        uint32_t Bursts;
+        uint32_t Commits;
+        uint32_t Errors;
+    } Xfer_Stats;
+
+    /*传输会话(同时只有一个，新的打开请求取代未完成的会话)*/
+    typedef struct
+    {
+        uint8_t Raw[XFER_RAW_SIZE];
+        /*按块传输的数据:LZSS编码时为压缩数据，原样编码时不使用(直接传输 Raw)*/
+        uint8_t Packed[XFER_RAW_SIZE];
+        uint8_t Object;
+        uint8_t Mode;
+        bool Write;
+        /*已提交(提交重传时不再写入)*/
+        bool Committed;
+        /*写入时已收到的块位图*/
+        uint8_t Received;
+        uint16_t Raw_Length;
+        uint16_t Length;
+        uint16_t Crc;
+        Xfer_Stats Stats;
+    } Xfer_HandleTypeDef;
+
+    extern void Xfer_Init(ModbusRTUSlaveHandler handler);
+    extern void Xfer_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XFER_H__ */
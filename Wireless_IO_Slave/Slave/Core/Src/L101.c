@@ -6,6 +6,7 @@
 #endif
 #include "shell_port.h"
 #include "mdrtuslave.h"
+#include "mdcrc16.h"
 #include "io_signal.h"
 
 
@@ -20,31 +21,6 @@ L101_HandleTypeDef L101_Map[EXTERN_DIGITAL_MAX] =
 };
 
 
-/**
- * @brief  取得16bitCRC校验码
- * @param  ptr   当前数据串指针
- * @param  length  数据长度
- * @param  init_dat 校验所用的初始数据
- * @retval 16bit校验码
- */
-static uint16_t Get_Crc16(uint8_t *ptr, uint16_t length, uint16_t init_dat)
-{
-    uint16_t i = 0;
-    uint16_t j = 0;
-    uint16_t crc16 = init_dat;
-
-    for (i = 0; i < length; i++)
-    {
-        crc16 ^= *ptr++;
-
-        for (j = 0; j < 8; j++)
-        {
-            crc16 = (crc16 & 0x0001) ? ((crc16 >> 1) ^ 0xa001) : (crc16 >> 1U);
-        }
-    }
-    return (crc16);
-}
-
 /**
  * @brief  大小端数据类型交换
  * @note   对于一个单精度浮点数的交换仅仅需要2次
@@ -79,6 +55,70 @@ bool inline Get_L101_Status(void)
     return ((bool)HAL_GPIO_ReadPin(STATUS_GPIO_Port, STATUS_Pin));
 }
 
+/*状态引脚统计:当前电平、无线发送次数及最近一次发送的繁忙时长*/
+static struct
+{
+    bool Level;
+    uint32_t Sends;
+    uint32_t Busy;
+    uint32_t Tick;
+} L101_Status = {.Level = true};
+extern osThreadId atHandle;
+
+/**
+ * @brief	状态引脚变位中断回调
+ * @details	唤醒At任务处理，低功耗空闲时由此引脚唤醒
+ * @param	GPIO_Pin 引脚
+ * @retval	None
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if ((GPIO_Pin == STATUS_Pin) && atHandle)
+    {
+        osSignalSet(atHandle, L101_SIGNAL_STATUS);
+    }
+}
+
+/**
+ * @brief	处理状态引脚变位
+ * @details	在At任务中调用；拉低为发送开始，恢复为发送结束
+ * @param	None
+ * @retval	None
+ */
+void L101_Status_Handle(void)
+{
+    bool level = Get_L101_Status();
+    uint32_t now = osKernelSysTick();
+
+    if (level == L101_Status.Level)
+    {
+        return;
+    }
+    if (!level)
+    {
+        L101_Status.Tick = now;
+    }
+    else
+    {
+        L101_Status.Sends++;
+        L101_Status.Busy = now - L101_Status.Tick;
+    }
+    L101_Status.Level = level;
+}
+
+/**
+ * @brief	打印L101状态引脚统计
+ * @details
+ * @param	None
+ * @retval	None
+ */
+void L101_Status_Show(void)
+{
+    shellPrint(&shell, "status = %s, sends = %u, last busy = %u ms\r\n", Get_L101_Status() ? "idle" : "busy",
+               L101_Status.Sends, L101_Status.Busy);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), l101, L101_Status_Show, show l101 status);
+
 /**
  * @brief	Lora模块恢复出厂设置
  * @details	拉低 3s 以上恢复出厂设置
@@ -108,7 +148,7 @@ uint8_t Set_BitFrame(L101_HandleTypeDef *pL)
     mdSTATUS ret = mdFALSE;
     Frame_Head pF = {.Addr.Val = 0x0000};
     /*读取对应寄存器地址*/
-    ret = mdhandler->registerPool->mdReadCoil(mdhandler->registerPool, pL->Digital_Addr, &Coil_Bit);
+    ret = mdhandler->registerPool->ops->mdReadCoil(mdhandler->registerPool, pL->Digital_Addr, &Coil_Bit);
 
     mdU8 buf[] = {0, 0, pL->Schannel, pL->Slave_Id, 0x05, pL->Digital_Addr >> 8U,
                   pL->Digital_Addr, (uint8_t)(Coil_Bit & 0x00FF),
@@ -124,7 +164,7 @@ uint8_t Set_BitFrame(L101_HandleTypeDef *pL)
     /*拷贝前2个字节到临时缓冲区*/
     memcpy(&buf[0], (mdU8 *)&pF, sizeof(pF));
     /*计算CRC:memcpy拷贝属于大端*/
-    pL->Crc16 = Get_Crc16(&buf[sizeof(pF) + 1U], sizeof(buf) - 5U, 0xffff);
+    pL->Crc16 = mdCrc16(&buf[sizeof(pF) + 1U], sizeof(buf) - 5U);
     /*拷贝两个字节CRC到临时缓冲区*/
     memcpy(&buf[sizeof(buf) - sizeof(pL->Crc16)], (mdU8 *)&pL->Crc16, sizeof(pL->Crc16));
     /*数据传输到从站*/
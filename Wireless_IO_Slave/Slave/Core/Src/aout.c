@@ -0,0 +1,299 @@
+#include "aout.h"
+#include "io_signal.h"
+#include "dma_mgr.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+
+#if defined(USING_AOUT)
+typedef char Aout_Channel_Check[(ANALOG_OUTPUT_START_ADDR + AOUT_CHANNELS <= FAILSAFE_TIMEOUT_ADDR) ? 1 : -1];
+
+DMA_HandleTypeDef hdma_tim4_up;
+DMA_HandleTypeDef hdma_tim4_ch2;
+static TIM_HandleTypeDef Aout_Pwm;
+static TIM_HandleTypeDef Aout_Pace;
+static Aout_HandleTypeDef Aout;
+
+typedef struct
+{
+    uint32_t Tim_Channel;
+    volatile uint32_t *Ccr;
+    uint16_t Pin;
+    uint8_t Stage;
+    uint8_t Request;
+    IRQn_Type Irq;
+    DMA_HandleTypeDef *hdma;
+} Aout_Port;
+
+/*F1的DMA1各通道中断号连续*/
+#define AOUT_PORT_ENTRY(ch, tim_ch, pin, stage, req, dma)                                               \
+    [ch] = {TIM_CHANNEL_##tim_ch, &TIM3->CCR##tim_ch, GPIO_PIN_##pin, (stage), DMA_REQ_##req,            \
+            (IRQn_Type)(DMA1_Channel1_IRQn + DMA_CHANNEL_##req - 1), &dma},
+static const Aout_Port Aout_Ports[AOUT_CHANNELS] = {AOUT_TABLE(AOUT_PORT_ENTRY)};
+#undef AOUT_PORT_ENTRY
+
+/**
+ * @brief	码值转换为CCR
+ * @param	Channel 通道号
+ * @param	Code 12bit码值
+ * @retval	CCR
+ */
+static uint16_t Aout_Ccr(uint8_t Channel, uint16_t Code)
+{
+    if (Aout_Ports[Channel].Stage == AOUT_STAGE_CURRENT)
+    {
+        return (uint16_t)(AOUT_CURRENT_ZERO + ((uint32_t)Code * (AOUT_PWM_PERIOD - AOUT_CURRENT_ZERO)) / AOUT_CODE_MAX);
+    }
+    return Code;
+}
+
+/**
+ * @brief	计算并启动下一段斜坡
+ * @details	在临界区或该通道的DMA完成中断中调用：从当前值向目标值每步最多变化 Aout.Step，
+ *			至多 AOUT_RAMP_STEPS 点；已到达目标值时通道空闲
+ * @param	Channel 通道号
+ * @retval	None
+ */
+static void Aout_Fill(uint8_t Channel)
+{
+    const Aout_Port *pP = &Aout_Ports[Channel];
+    Aout_Channel *pC = &Aout.Channel[Channel];
+    uint32_t target = (uint32_t)pC->Target << 8U, n;
+
+    for (n = 0; (n < AOUT_RAMP_STEPS) && (pC->Current != target); n++)
+    {
+        if (pC->Current < target)
+        {
+            pC->Current = (target - pC->Current > Aout.Step) ? (pC->Current + Aout.Step) : target;
+        }
+        else
+        {
+            pC->Current = (pC->Current - target > Aout.Step) ? (pC->Current - Aout.Step) : target;
+        }
+        pC->Ramp[n] = Aout_Ccr(Channel, (uint16_t)((pC->Current + 0x80U) >> 8U));
+    }
+    if (!n)
+    {
+        pC->Busy = false;
+        return;
+    }
+    pC->Busy = true;
+    pC->Segments++;
+    if (HAL_DMA_Start_IT(pP->hdma, (uint32_t)pC->Ramp, (uint32_t)pP->Ccr, n) != HAL_OK)
+    {
+        /*不能启动时直接输出目标值*/
+        pC->Current = target;
+        *pP->Ccr = Aout_Ccr(Channel, pC->Target);
+        pC->Busy = false;
+    }
+}
+
+/**
+ * @brief	一段斜坡输出完成
+ * @param	hdma DMA句柄
+ * @retval	None
+ */
+static void Aout_Dma_Done(DMA_HandleTypeDef *hdma)
+{
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        if (Aout_Ports[i].hdma == hdma)
+        {
+            Aout_Fill(i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief	设置一个通道的目标值
+ * @details	不限制斜率时CCR直接写入，由预装载在下一个PWM周期生效；否则DMA空闲时启动斜坡，
+ *			正在输出的斜坡在当前段结束时朝新的目标值继续
+ * @param	Channel 通道号
+ * @param	Code 12bit码值，超出时饱和
+ * @retval	None
+ */
+static void Aout_Set(uint8_t Channel, uint16_t Code)
+{
+    const Aout_Port *pP = &Aout_Ports[Channel];
+    Aout_Channel *pC = &Aout.Channel[Channel];
+
+    Code = (Code > AOUT_CODE_MAX) ? AOUT_CODE_MAX : Code;
+    /*DMA中断在内核可屏蔽的优先级上，临界区内斜坡状态不变*/
+    taskENTER_CRITICAL();
+    if (Code != pC->Target)
+    {
+        pC->Target = Code;
+        pC->Updates++;
+    }
+    if (!Aout.Step)
+    {
+        if (pC->Busy)
+        {
+            HAL_DMA_Abort(pP->hdma);
+            pC->Busy = false;
+        }
+        pC->Current = (uint32_t)Code << 8U;
+        *pP->Ccr = Aout_Ccr(Channel, Code);
+    }
+    else if (!pC->Busy)
+    {
+        Aout_Fill(Channel);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	读取斜率限制寄存器
+ * @param	None
+ * @retval	None
+ */
+static void Aout_Rate(void)
+{
+    mdU16 rate = 0;
+    uint32_t step;
+
+    mdhandler->registerPool->ops->mdReadHoldRegisters(mdhandler->registerPool, ANALOG_RAMP_ADDR, 1U, &rate);
+    step = (uint32_t)(((uint64_t)rate * 256U * AOUT_STEP_TIME) / 1000000U);
+    /*低于一个Q8刻度的斜率按最小步进输出*/
+    Aout.Step = (rate && !step) ? 1U : step;
+}
+
+/**
+ * @brief	初始化模拟量输出
+ * @details	在 Persist_Init() 之后调用：TIM3两路PWM(CCR及ARR预装载)，TIM4按1us计数、
+ *			每 AOUT_STEP_TIME 由更新事件及CC2各产生一次DMA请求；按保持寄存器中的值输出初值
+ * @param	None
+ * @retval	None
+ */
+void Aout_Init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    TIM_OC_InitTypeDef oc = {0};
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    mdU16 codes[AOUT_CHANNELS] = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    __HAL_RCC_TIM4_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        gpio.Pin |= Aout_Ports[i].Pin;
+    }
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    Aout_Pwm.Instance = TIM3;
+    Aout_Pwm.Init.Prescaler = 0;
+    Aout_Pwm.Init.CounterMode = TIM_COUNTERMODE_UP;
+    Aout_Pwm.Init.Period = AOUT_PWM_PERIOD - 1U;
+    Aout_Pwm.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    Aout_Pwm.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_PWM_Init(&Aout_Pwm) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    oc.OCMode = TIM_OCMODE_PWM1;
+    oc.Pulse = 0;
+    oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+    oc.OCFastMode = TIM_OCFAST_DISABLE;
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        const Aout_Port *pP = &Aout_Ports[i];
+
+        /*同时开启CCR预装载*/
+        if (HAL_TIM_PWM_ConfigChannel(&Aout_Pwm, &oc, pP->Tim_Channel) != HAL_OK)
+        {
+            Error_Handler();
+        }
+        pP->hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+        pP->hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+        pP->hdma->Init.MemInc = DMA_MINC_ENABLE;
+        pP->hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+        pP->hdma->Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+        pP->hdma->Init.Mode = DMA_NORMAL;
+        Dma_Setup(pP->hdma, pP->Request);
+        pP->hdma->XferCpltCallback = Aout_Dma_Done;
+        HAL_NVIC_EnableIRQ(pP->Irq);
+    }
+
+    Aout_Pace.Instance = TIM4;
+    /*APB1分频时定时器时钟为其2倍；降档后由 Clock_Apply() 重设预分频*/
+    Aout_Pace.Init.Prescaler = ((RCC->CFGR & RCC_CFGR_PPRE1_2) ? (pclk1 * 2U) : pclk1) / 1000000U - 1U;
+    Aout_Pace.Init.CounterMode = TIM_COUNTERMODE_UP;
+    Aout_Pace.Init.Period = AOUT_STEP_TIME - 1U;
+    Aout_Pace.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    Aout_Pace.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    if (HAL_TIM_Base_Init(&Aout_Pace) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    /*CC2不接引脚(冻结模式)，只在步进间隔的中点产生第二路DMA请求*/
+    __HAL_TIM_SET_COMPARE(&Aout_Pace, TIM_CHANNEL_2, AOUT_STEP_TIME / 2U);
+    __HAL_TIM_ENABLE_DMA(&Aout_Pace, TIM_DMA_UPDATE | TIM_DMA_CC2);
+    HAL_TIM_Base_Start(&Aout_Pace);
+
+    Aout_Rate();
+    mdhandler->registerPool->ops->mdReadHoldRegisters(mdhandler->registerPool, ANALOG_OUTPUT_START_ADDR, AOUT_CHANNELS,
+                                                 codes);
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        /*上电从0斜坡到寄存器中的初值*/
+        Aout.Channel[i].Target = 0;
+        Aout.Channel[i].Current = 0;
+        *Aout_Ports[i].Ccr = Aout_Ccr(i, 0);
+        HAL_TIM_PWM_Start(&Aout_Pwm, Aout_Ports[i].Tim_Channel);
+        Aout_Set(i, codes[i]);
+    }
+}
+
+/**
+ * @brief	保持寄存器写入通知
+ * @details	由Modbus接收任务在写入寄存器池后调用；写入范围包含输出通道或斜率限制寄存器时更新输出。
+ *			通信中断时不写入，输出保持最后的值
+ * @param	handler 句柄
+ * @param	addr 起始寄存器地址
+ * @param	length 寄存器数
+ * @retval	None
+ */
+void Aout_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+    mdU32 first = addr, last = (mdU32)addr + length;
+    mdU16 code;
+
+    if ((first <= ANALOG_RAMP_ADDR) && (last > ANALOG_RAMP_ADDR))
+    {
+        Aout_Rate();
+    }
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        if ((first > ANALOG_OUTPUT_START_ADDR + i) || (last <= ANALOG_OUTPUT_START_ADDR + i))
+        {
+            continue;
+        }
+        handler->registerPool->ops->mdReadHoldRegisters(handler->registerPool, ANALOG_OUTPUT_START_ADDR + i, 1U, &code);
+        Aout_Set(i, code);
+    }
+}
+
+/**
+ * @brief	打印模拟量输出状态
+ * @param	None
+ * @retval	None
+ */
+void Aout_Show(void)
+{
+    shellPrint(&shell, "step = %u/256 codes per %u us\r\n", Aout.Step, AOUT_STEP_TIME);
+    for (uint8_t i = 0; i < AOUT_CHANNELS; i++)
+    {
+        Aout_Channel *pC = &Aout.Channel[i];
+
+        shellPrint(&shell, "ao%d %s target = %u, current = %u, ccr = %u, busy = %d, updates = %u, segments = %u\r\n", i,
+                   (Aout_Ports[i].Stage == AOUT_STAGE_CURRENT) ? "4-20mA" : "0-10V", pC->Target, pC->Current >> 8U,
+                   *Aout_Ports[i].Ccr, pC->Busy, pC->Updates, pC->Segments);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), aout, Aout_Show, show analog outputs);
+#endif
@@ -0,0 +1,110 @@
+#include "auth.h"
+#include "kv.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if (MODBUS_AUTH)
+typedef char Auth_Config_Size_Check[(sizeof(Auth_Config) <= KV_VALUE_MAX) ? 1 : -1];
+
+static Auth_Config Auth_Cfg;
+static struct ModbusAuth Auth_Key;
+
+/**
+ * @brief	保存请求序号上限
+ * @details	在Modbus任务中接受超过上限的序号之前调用，每65536个序号写一次参数区
+ * @param	handler 从机协议栈句柄
+ * @param	ceiling 新的上限
+ * @retval	mdTRUE 保存成功
+ */
+static mdSTATUS Auth_Save_Ceiling(ModbusRTUSlaveHandler handler, mdU32 ceiling)
+{
+    uint32_t value = ceiling;
+
+    return Kv_Set(KV_KEY_AUTH_SEQ, &value, sizeof(value)) ? mdTRUE : mdFALSE;
+}
+
+/**
+ * @brief	按配置开关协议栈的帧认证
+ * @details	各单元从已保存的上限开始接受序号，重启前用过的序号不能重放
+ * @param	None
+ * @retval	None
+ */
+static void Auth_Apply(void)
+{
+    uint32_t ceiling;
+    mdU32 key[4];
+
+    if (Kv_Get(KV_KEY_AUTH_SEQ, &ceiling, sizeof(ceiling)) != sizeof(ceiling))
+    {
+        ceiling = 0;
+    }
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        key[i] = Auth_Cfg.Key[i];
+    }
+    mdAuthSetKey(&Auth_Key, key);
+    mdRTUSetAuth(mdhandler, Auth_Cfg.Enable ? &Auth_Key : NULL, ceiling);
+}
+
+/**
+ * @brief	加载帧认证配置
+ * @details	在 Persist_Init() 之后调用(参数区已初始化)；从未配置时不认证
+ * @param	None
+ * @retval	None
+ */
+void Auth_Init(void)
+{
+    if (Kv_Get(KV_KEY_AUTH, &Auth_Cfg, sizeof(Auth_Cfg)) != sizeof(Auth_Cfg))
+    {
+        memset(&Auth_Cfg, 0, sizeof(Auth_Cfg));
+    }
+    mdhandler->mdRTUAuthCeiling = Auth_Save_Ceiling;
+    Auth_Apply();
+}
+
+/**
+ * @brief	设置帧认证
+ * @details	开启后只处理附带正确序号及MAC的请求，应答同样签名；组播帧不再处理，
+ *			转发给下游从站的帧由下游校验；仅用于RTU编解码器
+ * @param	enable 0:关闭 1:开启
+ * @param	k0 密钥第0个字
+ * @param	k1 密钥第1个字
+ * @param	k2 密钥第2个字
+ * @param	k3 密钥第3个字
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Auth_Set(int enable, int k0, int k1, int k2, int k3)
+{
+    if ((enable < 0) || (enable > 1))
+    {
+        return 0xFF;
+    }
+    Auth_Cfg.Enable = enable;
+    Auth_Cfg.Key[0] = (uint32_t)k0;
+    Auth_Cfg.Key[1] = (uint32_t)k1;
+    Auth_Cfg.Key[2] = (uint32_t)k2;
+    Auth_Cfg.Key[3] = (uint32_t)k3;
+    /*先关闭再更换密钥，Modbus任务不会用到改了一半的密钥*/
+    mdRTUSetAuth(mdhandler, NULL, mdhandler->authCeiling);
+    Auth_Apply();
+
+    return Kv_Set(KV_KEY_AUTH, &Auth_Cfg, sizeof(Auth_Cfg)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), auth_set, Auth_Set, set auth enable k0 k1 k2 k3);
+
+/**
+ * @brief	打印帧认证状态、统计及各单元最后接受的序号(不显示密钥)
+ * @param	None
+ * @retval	None
+ */
+void Auth_Show(void)
+{
+    shellPrint(&shell, "auth = %d, failures = %u, ceiling = %u\r\n", mdhandler->auth != NULL, mdhandler->authFailures,
+               mdhandler->authCeiling);
+    for (uint32_t i = 0; i < mdhandler->unitCount; i++)
+    {
+        shellPrint(&shell, "id = %d, seq = %u\r\n", mdhandler->unitIds[i], mdhandler->authSeq[i]);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), auth, Auth_Show, show frame auth);
+#endif
@@ -0,0 +1,43 @@
+#include "boot.h"
+#include "shell_port.h"
+
+#define BOOT_MARK_TEXT(name, text) text,
+static const char *const Boot_Texts[BOOT_MARKS] = {BOOT_MARK_TABLE(BOOT_MARK_TEXT)};
+
+static Boot_HandleTypeDef Boot;
+
+/**
+ * @brief	记录启动节点
+ * @details	只记录第一次到达的时刻，之后的调用无效，可在任务的循环中调用
+ * @param	Mark 节点号(BOOT_MARK_xxx)
+ * @retval	None
+ */
+void Boot_Mark(uint8_t Mark)
+{
+    if ((Mark < BOOT_MARKS) && !(Boot.Marked & (1UL << Mark)))
+    {
+        Boot.Tick[Mark] = HAL_GetTick();
+        Boot.Marked |= 1UL << Mark;
+    }
+}
+
+/**
+ * @brief	打印启动节点的时刻
+ * @param	None
+ * @retval	None
+ */
+void Boot_Show(void)
+{
+    for (uint8_t i = 0; i < BOOT_MARKS; i++)
+    {
+        if (Boot.Marked & (1UL << i))
+        {
+            shellPrint(&shell, "%-20s %u ms\r\n", Boot_Texts[i], Boot.Tick[i]);
+        }
+        else
+        {
+            shellPrint(&shell, "%-20s -\r\n", Boot_Texts[i]);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), boot, Boot_Show, show boot timing);
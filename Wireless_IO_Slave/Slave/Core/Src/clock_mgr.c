@@ -0,0 +1,209 @@
+#include "clock_mgr.h"
+#include "usart.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+
+/*port.c:按 SystemCoreClock 重新计算每节拍计数及低功耗空闲所用的常量并重启SysTick*/
+extern void vPortSetupTimerInterrupt(void);
+
+/*时钟档位描述*/
+typedef struct
+{
+    const char *Name;
+    uint32_t Hpre;
+    uint32_t Latency;
+    uint32_t Adcpre;
+} Clock_Profile;
+
+#define CLOCK_PROFILE_ENTRY(name, hpre, latency, adc, text) {text, (hpre), (latency), (adc)},
+static const Clock_Profile Clock_Profiles[CLOCK_PROFILES] = {CLOCK_PROFILE_TABLE(CLOCK_PROFILE_ENTRY)};
+
+static Clock_HandleTypeDef Clock;
+
+/**
+ * @brief	按新的总线时钟重设定时器的1us计数
+ * @details	预分频值在更新事件时生效，置URS后软件产生的更新事件不触发中断；
+ *			更新事件会清零计数，随后写回原计数，微秒定时器(TIM2)的时刻不因换档跳变
+ * @param	tim 定时器
+ * @param	Hz 定时器时钟
+ * @retval	None
+ */
+static void Clock_Timer(TIM_TypeDef *tim, uint32_t Hz)
+{
+    uint32_t cnt = tim->CNT;
+
+    tim->PSC = Hz / 1000000U - 1U;
+    tim->CR1 |= TIM_CR1_URS;
+    tim->EGR = TIM_EGR_UG;
+    tim->CNT = cnt;
+}
+
+/**
+ * @brief	切换到指定档位
+ * @details	在临界区中调用:先改Flash等待周期(升频前加、降频后减)和AHB/ADC分频，再按新的总线时钟
+ *			重设两路串口的波特率、TIM1(HAL时基)和TIM2(微秒定时器)的1us计数以及内核节拍；
+ *			正在计的节拍的剩余部分按新时钟折算，切换不丢失也不延长节拍
+ * @param	Profile 档位(CLOCK_PROFILE_xxx)
+ * @retval	None
+ */
+static void Clock_Apply(uint8_t Profile)
+{
+    const Clock_Profile *pP = &Clock_Profiles[Profile];
+    uint32_t remain = SysTick->VAL, load = SysTick->LOAD + 1U;
+    uint32_t pclk1, pclk2, counts;
+
+    if (pP->Latency > (FLASH->ACR & FLASH_ACR_LATENCY))
+    {
+        __HAL_FLASH_SET_LATENCY(pP->Latency);
+    }
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_ADCPRE, pP->Hpre | pP->Adcpre);
+    if (pP->Latency < (FLASH->ACR & FLASH_ACR_LATENCY))
+    {
+        __HAL_FLASH_SET_LATENCY(pP->Latency);
+    }
+    SystemCoreClockUpdate();
+    pclk1 = HAL_RCC_GetPCLK1Freq();
+    pclk2 = HAL_RCC_GetPCLK2Freq();
+    huart1.Instance->BRR = UART_BRR_SAMPLING16(pclk2, huart1.Init.BaudRate);
+    huart3.Instance->BRR = UART_BRR_SAMPLING16(pclk1, huart3.Init.BaudRate);
+    /*APB2不分频；APB1分频时定时器时钟为其2倍*/
+    Clock_Timer(TIM1, pclk2);
+    Clock_Timer(TIM2, (RCC->CFGR & RCC_CFGR_PPRE1_2) ? (pclk1 * 2U) : pclk1);
+#if defined(USING_AOUT)
+    /*模拟量输出的斜坡节拍保持1us计数；PWM(TIM3)不分频，频率随时钟变化而占空比不变*/
+    Clock_Timer(TIM4, (RCC->CFGR & RCC_CFGR_PPRE1_2) ? (pclk1 * 2U) : pclk1);
+#endif
+    vPortSetupTimerInterrupt();
+    counts = SystemCoreClock / configTICK_RATE_HZ;
+    remain = (uint32_t)(((uint64_t)remain * counts) / load);
+    if (remain)
+    {
+        /*与 vPortSuppressTicksAndSleep() 相同:先装入剩余计数，启动后再恢复整节拍的重装值*/
+        SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+        SysTick->LOAD = remain - 1U;
+        SysTick->VAL = 0;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        SysTick->LOAD = counts - 1U;
+    }
+}
+
+/**
+ * @brief	切换档位
+ * @param	Profile 档位(CLOCK_PROFILE_xxx)
+ * @param	Defer true:串口正在发送时不切换(波特率改变会打乱正在发送的字符)
+ * @retval	true 已切换
+ */
+static bool Clock_Switch(uint8_t Profile, bool Defer)
+{
+    bool done = false;
+
+    taskENTER_CRITICAL();
+    if (Defer && (!(huart1.Instance->SR & USART_SR_TC) || !(huart3.Instance->SR & USART_SR_TC)))
+    {
+        Clock.Deferred++;
+    }
+    else
+    {
+        Clock_Apply(Profile);
+        Clock.Profile = Profile;
+        Clock.Switches++;
+        done = true;
+    }
+    taskEXIT_CRITICAL();
+    return done;
+}
+
+/**
+ * @brief	时钟档位初始化
+ * @details	SystemClock_Config() 设定的72MHz即全速档，开启自动降档
+ * @param	None
+ * @retval	None
+ */
+void Clock_Init(void)
+{
+    Clock.Profile = CLOCK_PROFILE_FULL;
+    Clock.Auto = true;
+    Clock.Active = HAL_GetTick();
+}
+
+/**
+ * @brief	有帧或输出事件待处理
+ * @details	在唤醒的任务中处理事件前调用，立即恢复全速(仅数个寄存器写入)并重新计算空闲时间；
+ *			帧本身已在低档下按重设的波特率收完
+ * @param	None
+ * @retval	None
+ */
+void Clock_Active(void)
+{
+    Clock.Active = HAL_GetTick();
+    if (Clock.Auto && (Clock.Profile != CLOCK_PROFILE_FULL))
+    {
+        Clock_Switch(CLOCK_PROFILE_FULL, false);
+    }
+}
+
+/**
+ * @brief	按空闲时间降档
+ * @details	在任务中周期调用(Modbus任务等待帧超时时)：无活动超过 CLOCK_IDLE_DELAY 降到空闲档，
+ *			再过同样时间降到最低档；只降不升，串口发送中时推迟到下次
+ * @param	None
+ * @retval	None
+ */
+void Clock_Idle(void)
+{
+    uint32_t idle = HAL_GetTick() - Clock.Active;
+    uint8_t target = CLOCK_PROFILE_FULL;
+
+    if (!Clock.Auto)
+    {
+        return;
+    }
+    if (idle >= CLOCK_IDLE_DELAY * 2U)
+    {
+        target = CLOCK_PROFILE_DEEP;
+    }
+    else if (idle >= CLOCK_IDLE_DELAY)
+    {
+        target = CLOCK_PROFILE_IDLE;
+    }
+    if (target > Clock.Profile)
+    {
+        Clock_Switch(target, true);
+    }
+}
+
+/**
+ * @brief	固定时钟档位
+ * @param	Profile 档位号，-1:恢复自动降档
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Clock_Set(int Profile)
+{
+    if ((Profile < -1) || (Profile >= (int)CLOCK_PROFILES))
+    {
+        return 0xFF;
+    }
+    Clock.Active = HAL_GetTick();
+    Clock.Auto = (Profile < 0);
+    Clock_Switch(Clock.Auto ? CLOCK_PROFILE_FULL : (uint8_t)Profile, false);
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), clock_set, Clock_Set, set clock profile or -1 auto);
+
+/**
+ * @brief	打印时钟档位
+ * @param	None
+ * @retval	None
+ */
+void Clock_Show(void)
+{
+    for (uint8_t i = 0; i < CLOCK_PROFILES; i++)
+    {
+        shellPrint(&shell, "%c%d %s\r\n", (i == Clock.Profile) ? '*' : ' ', i, Clock_Profiles[i].Name);
+    }
+    shellPrint(&shell, "hclk = %u, pclk1 = %u, pclk2 = %u\r\n", SystemCoreClock, HAL_RCC_GetPCLK1Freq(),
+               HAL_RCC_GetPCLK2Freq());
+    shellPrint(&shell, "%s, idle = %u ms, switches = %u, deferred = %u\r\n", Clock.Auto ? "auto" : "fixed",
+               HAL_GetTick() - Clock.Active, Clock.Switches, Clock.Deferred);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), clock, Clock_Show, show clock profile);
@@ -0,0 +1,108 @@
+#include "discover.h"
+#include "io_signal.h"
+#include "shell_port.h"
+
+static Discover_HandleTypeDef Discover;
+
+/**
+ * @brief	处理入网信标
+ * @details	在Modbus任务中执行，只选择随机时隙，由 Discover_Poll() 在时隙开始且信道空闲时发出；
+ *			同一轮次重复收到的信标不再重新选择时隙
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Discover_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *p = &handler->receiveBuffer->buf[2];
+    uint16_t slot_ms = ToU16(p[3], p[4]);
+
+    if ((handler->receiveBuffer->count != 2U + DISCOVER_BEACON_SIZE + 2U) ||
+        (handler->receiveBuffer->buf[0] != MODBUS_BROADCAST_ID) || (p[2] == 0) || (p[2] > DISCOVER_SLOTS_MAX) ||
+        (slot_ms > DISCOVER_SLOT_MAX))
+    {
+        return;
+    }
+    Discover.Beacons++;
+    if (Discover.Valid && (Discover.Session == p[0]) && (Discover.Round == p[1]))
+    {
+        return;
+    }
+    Discover.Valid = true;
+    Discover.Session = p[0];
+    Discover.Round = p[1];
+    Mac_Start(&Discover.Mac, (Mac_Random() % p[2]) * slot_ms, 0);
+    Discover.Pending = true;
+}
+
+/**
+ * @brief	注册入网发现功能码
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Discover_Init(ModbusRTUSlaveHandler handler)
+{
+    if (handler)
+    {
+        mdRTURegisterCode(handler, MODBUS_CODE_JOIN, Discover_Handle);
+    }
+}
+
+/**
+ * @brief	Modbus任务的等待时间
+ * @param	Wait 没有延迟应答时的等待时间(ms)
+ * @retval	到下一个应答时刻的时间，不大于 Wait
+ */
+uint32_t Discover_Wait(uint32_t Wait)
+{
+    return Discover.Pending ? Mac_Wait(&Discover.Mac, Wait) : Wait;
+}
+
+/**
+ * @brief	到达时隙时发出应答
+ * @details	在Modbus任务中每次唤醒后调用，应答以主单元的站号发出；信道忙时随机退避(mac.h)，
+ *			多次退避仍忙时放弃，等待主站的下一轮信标
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Discover_Poll(ModbusRTUSlaveHandler handler)
+{
+    mdU8 pdu[1U + DISCOVER_REPLY_SIZE];
+    uint8_t access;
+
+    if (!Discover.Pending)
+    {
+        return;
+    }
+    access = Mac_Access(&Discover.Mac);
+    if (access == MAC_WAIT)
+    {
+        return;
+    }
+    Discover.Pending = false;
+    if (access == MAC_DROP)
+    {
+        Discover.Dropped++;
+        return;
+    }
+    pdu[0] = MODBUS_CODE_JOIN;
+    pdu[1] = Discover.Session;
+    pdu[2] = Discover.Round;
+    pdu[3] = EXTERN_DIGITAL_MAX;
+    pdu[4] = EXTERN_OUTPUT_MAX;
+    pdu[5] = EXTERN_ANALOG_MAX;
+    pdu[6] = handler->unitCount;
+    mdRTUSendFrom(handler, handler->slaveId, pdu, sizeof(pdu));
+    Discover.Replies++;
+}
+
+/**
+ * @brief	打印入网发现统计
+ * @param	None
+ * @retval	None
+ */
+void Discover_Show(void)
+{
+    shellPrint(&shell, "session = %d, round = %d, beacons = %u, replies = %u, dropped = %u, pending = %d\r\n",
+               Discover.Session, Discover.Round, Discover.Beacons, Discover.Replies, Discover.Dropped, Discover.Pending);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), discover, Discover_Show, show node discovery);
@@ -31,6 +31,21 @@
 #include "shell_port.h"
 #include "mdrtuslave.h"
 #include "io_signal.h"
+#include "supervisor.h"
+#include "L101.h"
+#include "persist.h"
+#include "trace.h"
+#include "stats.h"
+#include "discover.h"
+#include "mac.h"
+#include "extlog.h"
+#include "soe.h"
+#include "retain.h"
+#include "boot.h"
+#include "clock_mgr.h"
+#include "aout.h"
+#include "spis.h"
+#include "utimer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -39,7 +54,8 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/*Response deadline (ms) of a received Modbus frame, well inside the Master's reply window*/
+#define MODBUS_DEADLINE 10U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -49,27 +65,45 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
-/* USER CODE END Variables */
+/*shell日志发送任务(由 shell_port.c 唤醒)*/
+osThreadId shell_logHandle;
 osThreadId shellHandle;
 osThreadId modbusHandle;
 osThreadId io_outputHandle;
 osThreadId atHandle;
+osThreadId persistHandle;
+/*外部FRAM日志写入任务(由 Extlog_Write 唤醒)*/
+osThreadId extlogHandle;
+#if defined(USING_SPI_SLAVE)
+/*SPI2从机映像构建任务(由片选释放唤醒)*/
+osThreadId spisHandle;
+#endif
+
+/* USER CODE END Variables */
 osTimerId Timer1Handle;
 osMutexId shellMutexHandle;
-osSemaphoreId ReciveHandle;
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
 GPIO_PinState g_State = GPIO_PIN_SET;
 bool g_Timerout_Flag = false;
-static uint32_t g_Counter = 0;
-/* USER CODE END FunctionPrototypes */
-
 void Shell_Task(void const * argument);
 void Modbus_Task(void const * argument);
 void Io_Output_Task(void const * argument);
 void At_Task(void const * argument);
+void Persist_Task(void const * argument);
+void Extlog_Task(void const * argument);
+void Spis_Task(void const * argument);
+void Boot_Task(void const * argument);
+static void Hold_Written(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length);
+static void Failsafe_Restart(void);
+#if defined(USING_UTIMER)
+static void Failsafe_Expire(void *Arg);
+/*Communication-loss watchdog on the microsecond timers*/
+static Utimer Failsafe_Timer = UTIMER_INIT(Failsafe_Expire, NULL);
+#endif
+/* USER CODE END FunctionPrototypes */
+
 void Timer_Callback(void const * argument);
 
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
@@ -83,16 +117,58 @@ void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, Stack
 /* Hook prototypes */
 void vApplicationStackOverflowHook(xTaskHandle xTask, signed char *pcTaskName);
 
+/* Pre/Post sleep processing prototypes */
+void PreSleepProcessing(uint32_t *ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t *ulExpectedIdleTime);
+
 /* USER CODE BEGIN 4 */
 __weak void vApplicationStackOverflowHook(xTaskHandle xTask, signed char *pcTaskName)
 {
    /* Run time stack overflow checking is performed if
    configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2. This hook function is
    called if a stack overflow is detected. */
-   shellPrint(&shell, "%s is stack overflow!\r\n", pcTaskName);
+   /* The stack is already corrupt: keep the task name in retained RAM and reset */
+   UNUSED(xTask);
+   Supervisor_Fault((const char *)pcTaskName, SUPERVISOR_FAULT_STACK);
 }
 /* USER CODE END 4 */
 
+/* USER CODE BEGIN PREPOSTSLEEP */
+/**
+  * @brief  Stop the 1 ms TIM1 time base before the tickless WFI
+  * @note   USART3, the L101 STATUS line, the shell UART and the kernel SysTick still wake the core;
+  *         HAL_GetTick follows the kernel tick, so no HAL tick is lost while TIM1 is halted
+  * @param  ulExpectedIdleTime: expected idle ticks, set to 0 to skip the sleep
+  * @retval None
+  */
+void PreSleepProcessing(uint32_t *ulExpectedIdleTime)
+{
+  UNUSED(ulExpectedIdleTime);
+  HAL_SuspendTick();
+}
+
+/**
+  * @brief  Restart the TIM1 time base after the tickless WFI
+  * @param  ulExpectedIdleTime: expected idle ticks
+  * @retval None
+  */
+void PostSleepProcessing(uint32_t *ulExpectedIdleTime)
+{
+  UNUSED(ulExpectedIdleTime);
+  HAL_ResumeTick();
+}
+
+/**
+  * @brief  HAL time base taken from the kernel tick once the scheduler runs
+  * @note   The kernel tick is stepped over tickless sleep while TIM1 is halted
+  * @retval Milliseconds
+  */
+uint32_t HAL_GetTick(void)
+{
+  return (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? uwTick : xTaskGetTickCount();
+}
+/* USER CODE END PREPOSTSLEEP */
+
 /* USER CODE BEGIN GET_IDLE_TASK_MEMORY */
 static StaticTask_t xIdleTaskTCBBuffer;
 static StackType_t xIdleStack[configMINIMAL_STACK_SIZE];
@@ -137,11 +213,6 @@ void MX_FREERTOS_Init(void) {
   /* add mutexes, ... */
   /* USER CODE END RTOS_MUTEX */
 
-  /* Create the semaphores(s) */
-  /* definition and creation of Recive */
-  osSemaphoreDef(Recive);
-  ReciveHandle = osSemaphoreCreate(osSemaphore(Recive), 1);
-
   /* USER CODE BEGIN RTOS_SEMAPHORES */
   /* add semaphores, ... */
   /* USER CODE END RTOS_SEMAPHORES */
@@ -149,77 +220,199 @@ void MX_FREERTOS_Init(void) {
   /* Create the timer(s) */
   /* definition and creation of Timer1 */
   osTimerDef(Timer1, Timer_Callback);
-  Timer1Handle = osTimerCreate(osTimer(Timer1), osTimerPeriodic, NULL);
+  Timer1Handle = osTimerCreate(osTimer(Timer1), osTimerOnce, NULL);
 
   /* USER CODE BEGIN RTOS_TIMERS */
   /* start timers, add new ones, ... */
+  /*Feed the external watchdog only while every registered task checks in*/
+  Supervisor_Init();
+  /*Frame and error counters for fleet link monitoring*/
+  Stats_Init(mdhandler->registerPool);
   /* USER CODE END RTOS_TIMERS */
 
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
   /* USER CODE END RTOS_QUEUES */
 
-  /* Create the thread(s) */
-  /* definition and creation of shell */
-  osThreadDef(shell, Shell_Task, osPriorityLow, 0, 256);
-  shellHandle = osThreadCreate(osThread(shell), (void*) &shell);
+  /* USER CODE BEGIN RTOS_THREADS */
+  /*Rate-monotonic task table: frame handling is above the relay output so the reply
+    timing no longer depends on output work. Period, deadline and heartbeat timeout in ms,
+    0 where a constraint does not apply*/
+  static const Supervisor_Entry table[] = {
+      {{"modbus", Modbus_Task, osPriorityNormal, 0, 128, NULL, NULL},
+       NULL, &modbusHandle, 0, MODBUS_DEADLINE, SUPERVISOR_DEADLINE},
+      {{"io_output", Io_Output_Task, osPriorityBelowNormal, 0, 128, NULL, NULL},
+       NULL, &io_outputHandle, 0, IO_OUTPUT_PERIOD, SUPERVISOR_DEADLINE},
+      {{"shell", Shell_Task, osPriorityLow, 0, 256, NULL, NULL},
+       &shell, &shellHandle, 0, 0, 0},
+      {{"at", At_Task, osPriorityIdle, 0, 128, NULL, NULL},
+       NULL, &atHandle, 0, 0, 0},
+      /*Drain the asynchronous shell log at the lowest priority*/
+      {{"shell_log", Shell_Log_Task, osPriorityIdle, 0, 128, NULL, NULL},
+       NULL, &shell_logHandle, 0, 0, 0},
+      /*Write the persistent holding registers back to flash once the Master stops writing*/
+      {{"persist", Persist_Task, osPriorityIdle, 0, 128, NULL, NULL},
+       NULL, &persistHandle, 0, 0, 0},
+      /*SOE, counter snapshots and retained state go to the FRAM from here by DMA, the writers only queue the record*/
+      {{"extlog", Extlog_Task, osPriorityIdle, 0, 128, NULL, NULL},
+       NULL, &extlogHandle, 0, 0, 0},
+#if defined(USING_SPI_SLAVE)
+      /*Rebuild the back register image for the SPI2 co-processor link; the ISR swaps it in between transfers*/
+      {{"spis", Spis_Task, osPriorityLow, 0, 128, NULL, NULL},
+       NULL, &spisHandle, 0, 0, 0},
+#endif
+  };
+
+  Supervisor_Create(table, sizeof(table) / sizeof(table[0]));
+  /*The deferred boot stage runs behind the output and frame tasks; the stack goes back to the heap when it ends*/
+  osThreadDef(boot, Boot_Task, osPriorityLow, 0, 128);
+  osThreadCreate(osThread(boot), NULL);
+  /*Drive the relay as soon as the Master writes the output coil*/
+  mdhandler->mdRTUCoilWritten = Io_Output_Notify;
+  /*Configuration writes only mark the persistent region dirty; flash is written later*/
+  mdhandler->mdRTUHoldWritten = Hold_Written;
+  /*Pulse and delay modes are timed locally by the timer service*/
+  Io_Output_Mode_Init();
+  /*Analog inputs are filtered, calibrated and checked against the deadband by the timer service*/
+  Io_Analog_Start();
+  /*After a warm restart the relays resume their last state before the first output pass*/
+  Io_Output_Restore();
+#if defined(USING_FAST_OUTPUT)
+  /*Validated FC05 and scene frames switch the relay from the UART idle interrupt*/
+  mdhandler->mdRTUFastWrite = Io_Output_Fast;
+#endif
+  /*Report the inputs in every coil-write reply so the Master needs no extra reads*/
+  mdhandler->reportAddress = DIGITAL_INPUT_START_ADDR;
+  mdhandler->reportLength = EXTERN_DIGITAL_MAX;
+  /*and the health counters behind them, so no separate diagnostic polls are needed*/
+  mdhandler->reportHealth = mdTRUE;
+  /* add threads, ... */
+  /*Communication-loss watchdog, re-armed by every valid frame*/
+  Failsafe_Restart();
+  /* USER CODE END RTOS_THREADS */
 
-  /* definition and creation of modbus */
-  osThreadDef(modbus, Modbus_Task, osPriorityBelowNormal, 0, 128);
-  modbusHandle = osThreadCreate(osThread(modbus), NULL);
+}
 
-  /* definition and creation of io_output */
-  osThreadDef(io_output, Io_Output_Task, osPriorityNormal, 0, 128);
-  io_outputHandle = osThreadCreate(osThread(io_output), NULL);
+/* Timer_Callback function */
+void Timer_Callback(void const * argument)
+{
+  /* USER CODE BEGIN Timer_Callback */
+  /*No valid frame within the timeout: apply the fail-safe outputs at once*/
+  g_Timerout_Flag = true;
+  osSignalSet(io_outputHandle, IO_SIGNAL_OUTPUT);
+  /* USER CODE END Timer_Callback */
+}
 
-  /* definition and creation of at */
-  osThreadDef(at, At_Task, osPriorityIdle, 0, 128);
-  atHandle = osThreadCreate(osThread(at), NULL);
+/* Private application code --------------------------------------------------*/
+/* USER CODE BEGIN Application */
+/**
+  * @brief  Re-arm the communication-loss watchdog.
+  * @note   With USING_UTIMER a microsecond one-shot applies the fail-safe exactly at the
+  *         timeout, instead of whenever the timer service task gets to run
+  * @retval None
+  */
+static void Failsafe_Restart(void)
+{
+#if defined(USING_UTIMER)
+  Utimer_Start(&Failsafe_Timer, Io_Failsafe_Timeout() * 1000U, 0);
+#else
+  osTimerStart(Timer1Handle, Io_Failsafe_Timeout());
+#endif
+}
 
-  /* USER CODE BEGIN RTOS_THREADS */
-  /* add threads, ... */
-  osTimerStart(Timer1Handle, 1000);
-  /* USER CODE END RTOS_THREADS */
+#if defined(USING_UTIMER)
+/**
+  * @brief  Communication-loss timeout, called from the TIM2 interrupt.
+  * @param  Arg: Not used
+  * @retval None
+  */
+static void Failsafe_Expire(void *Arg)
+{
+  (void)Arg;
+  Timer_Callback(NULL);
+}
+#endif
 
+/**
+  * @brief  Holding register write hook: persistent configuration and analog outputs.
+  * @param  handler: Modbus handle
+  * @param  addr: first register written
+  * @param  length: number of registers
+  * @retval None
+  */
+static void Hold_Written(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+  Persist_Notify(handler, addr, length);
+#if defined(USING_AOUT)
+  /*Analog output values take effect on the next PWM period, or ramp at the configured rate*/
+  Aout_Notify(handler, addr, length);
+#endif
 }
 
-/* USER CODE BEGIN Header_Shell_Task */
 /**
   * @brief  Function implementing the shell thread.
   * @param  argument: Not used
   * @retval None
   */
-/* USER CODE END Header_Shell_Task */
 void Shell_Task(void const * argument)
 {
-  /* USER CODE BEGIN Shell_Task */
   /* Infinite loop */
   for(;;)
   {
     shellTask((void *)argument);
   }
-  /* USER CODE END Shell_Task */
 }
 
-/* USER CODE BEGIN Header_Modbus_Task */
 /**
 * @brief Function implementing the modbus thread.
 * @param argument: Not used
 * @retval None
 */
-/* USER CODE END Header_Modbus_Task */
 void Modbus_Task(void const * argument)
 {
-  /* USER CODE BEGIN Modbus_Task */
+  uint8_t dog = Supervisor_Self();
   /* Infinite loop */
   for(;;)
   {
     /*https://www.cnblogs.com/w-smile/p/11333950.html*/
-    if(osOK == osSemaphoreWait(ReciveHandle, osWaitForever))
+    /*Woken by a direct task notification from the receive interrupt; the bounded wait
+      lets an idle bus still check in with the supervisor*/
+    osEvent event = osSignalWait(MODBUS_SIGNAL_RX, Discover_Wait(SUPERVISOR_CHECKIN_TIME));
+
+    Supervisor_Checkin(dog);
+    /*Back to full speed before the frame is handled; a quiet bus steps the clock down*/
+    if (event.status == osEventSignal)
+    {
+      Clock_Active();
+    }
+    else
+    {
+      Clock_Idle();
+    }
+    /*A join reply waits for its random slot without holding up the frames received meanwhile*/
+    Discover_Poll(mdhandler);
+    if (event.status == osEventSignal)
     {
-      g_Timerout_Flag = false;
-      g_Counter = 0;
-      mdRTU_Handler();
+      TRACE(TRACE_MODBUS_WAKE);
+      Supervisor_Activate(dog);
+      /*Any frame on the air, for this station or not, means the channel is in use for a while*/
+      Mac_Activity();
+      /*Assemble the spans published by the receive interrupt into Modbus frames*/
+      Uart_Dma_Rx_Dispatch(&Uart3_Dma);
+      /*Only a frame for this station refreshes the link timeout*/
+      if (mdReceiveBufferFetch(mdhandler->receiveBuffer))
+      {
+        Boot_Mark(BOOT_MARK_FRAME);
+        /*The fail-safe rewrote the outputs locally, so retried commands must run again*/
+        if (g_Timerout_Flag)
+        {
+          mdRTUDupFlush(mdhandler);
+        }
+        g_Timerout_Flag = false;
+        Failsafe_Restart();
+      }
+      mdRTU_Handler(mdhandler);
+      Supervisor_Complete(dog);
 //		shellPrint(&shell, "buf is %s \r\n", mdhandler->receiveBuffer->buf);
       // Usart3_Printf("%s\r\n", mdhandler->receiveBuffer->buf);
 #if defined(USING_DEBUG)
@@ -227,69 +420,141 @@ void Modbus_Task(void const * argument)
 #endif
     }
   }
-  /* USER CODE END Modbus_Task */
 }
 
-/* USER CODE BEGIN Header_Io_Output_Task */
 /**
 * @brief Function implementing the io_output thread.
 * @param argument: Not used
 * @retval None
 */
-/* USER CODE END Header_Io_Output_Task */
 void Io_Output_Task(void const * argument)
 {
-  /* USER CODE BEGIN Io_Output_Task */
+  uint8_t dog = Supervisor_Self();
+  osEvent event = {.status = osOK};
   /* Infinite loop */
   for(;;)
   {
-    /*Dog feed signal*/
-    g_State ^=  GPIO_PIN_SET;
-    HAL_GPIO_WritePin(GPIOA, WDI_Pin, g_State);
+    Supervisor_Checkin(dog);
+    Supervisor_Activate(dog);
+    if (event.status == osEventSignal)
+    {
+      Clock_Active();
+    }
+    /*Relay states taken from the FRAM by the boot task are applied here, by the owner of the outputs*/
+    if ((event.status == osEventSignal) && (event.value.signals & IO_SIGNAL_RESTORE))
+    {
+      Io_Output_Restore();
+    }
+    Io_Digital_Input();
     Io_Digital_Output(g_Timerout_Flag);
-    osDelay(50);
+    Supervisor_Complete(dog);
+    Boot_Mark(BOOT_MARK_OUTPUT);
+    /*Coil writes, mode timers and the link watchdog wake the task; only a fail-safe pulse needs the short period*/
+    event = osSignalWait(IO_SIGNAL_OUTPUT | IO_SIGNAL_RESTORE, g_Timerout_Flag ? IO_OUTPUT_PERIOD : SUPERVISOR_CHECKIN_TIME);
   }
-  /* USER CODE END Io_Output_Task */
 }
 
-/* USER CODE BEGIN Header_At_Task */
 /**
 * @brief Function implementing the at thread.
 * @param argument: Not used
 * @retval None
 */
-/* USER CODE END Header_At_Task */
 void At_Task(void const * argument)
 {
-  /* USER CODE BEGIN At_Task */
   /* Infinite loop */
   for(;;)
   {
-	 
-	  osDelay(5);
+    /*Sleep until the L101 STATUS line changes instead of polling*/
+    osSignalWait(L101_SIGNAL_STATUS, osWaitForever);
+    L101_Status_Handle();
   }
-  /* USER CODE END At_Task */
 }
 
-/* Timer_Callback function */
-void Timer_Callback(void const * argument)
+/**
+* @brief Function implementing the persist thread.
+* @param argument: Not used
+* @retval None
+*/
+void Persist_Task(void const * argument)
 {
-  /* USER CODE BEGIN Timer_Callback */
-  // Usart3_Printf("hello world !\r\n");
-//	shellPrint(&shell, "hello world !\r\n");
-  #define MAX_COUNTS 10U
+  uint32_t wait = osWaitForever;
+  /* Infinite loop */
+  for(;;)
+  {
+    /*Every further write restarts the quiet period, so a burst ends in a single flash record*/
+    osSignalWait(PERSIST_SIGNAL, wait);
+    wait = Persist_Poll();
+  }
+}
 
-  if (++g_Counter > MAX_COUNTS)
+/**
+* @brief Function implementing the extlog thread.
+* @note  Writes the queued records to the SPI2 FRAM in order; readers share the bus through its lock
+* @param argument: Not used
+* @retval None
+*/
+void Extlog_Task(void const * argument)
+{
+  /* Infinite loop */
+  for(;;)
   {
-    g_Counter = 0U;
-    g_Timerout_Flag = true;
+    Extlog_Process(osWaitForever);
+  }
+}
 
+#if defined(USING_SPI_SLAVE)
+/**
+* @brief Function implementing the spis thread.
+* @note  Refreshes the back image every SPIS_PERIOD ms and after each transfer
+* @param argument: Not used
+* @retval None
+*/
+void Spis_Task(void const * argument)
+{
+  /* Infinite loop */
+  for(;;)
+  {
+    osSignalWait(SPIS_SIGNAL, SPIS_PERIOD);
+    Spis_Refresh();
   }
-  /* USER CODE END Timer_Callback */
 }
+#endif
 
-/* Private application code --------------------------------------------------*/
-/* USER CODE BEGIN Application */
+/**
+* @brief Function implementing the boot thread.
+* @note  Created after the task table: recovers the FRAM log while the outputs and the
+*        Modbus replies are already up, continues the SOE numbering and, after a power-up,
+*        hands the saved relay states to the output task; then ends
+* @param argument: Not used
+* @retval None
+*/
+void Boot_Task(void const * argument)
+{
+  Extlog_Recover();
+  Boot_Mark(BOOT_MARK_LOG);
+  Soe_Resume();
+  /*Skipped when the Master has already written the outputs since the power-up*/
+  if (Retain_Resume())
+  {
+    osSignalSet(io_outputHandle, IO_SIGNAL_RESTORE);
+  }
+  Boot_Mark(BOOT_MARK_READY);
+  osThreadTerminate(NULL);
+}
+
+/**
+  * @brief  Toggle the external watchdog input
+  * @param  Healthy: false once a supervised task missed its deadline
+  * @retval None
+  */
+void Supervisor_Feed(bool Healthy)
+{
+  if (Healthy)
+  {
+    g_State ^= GPIO_PIN_SET;
+    HAL_GPIO_WritePin(WDI_GPIO_Port, WDI_Pin, g_State);
+  }
+}
 
 /* USER CODE END Application */
 
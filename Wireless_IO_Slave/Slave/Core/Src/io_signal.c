@@ -3,116 +3,989 @@
 #include "mdrtuslave.h"
 #include "adc.h"
 #include "shell_port.h"
-
-#if defined(USING_SLAVE)
-#define DDI5_Pin NULL
-#define DDI7_Pin NULL
+#include "soe.h"
+#include "retain.h"
+#include "cmsis_os.h"
+#include "trace.h"
+#include "kv.h"
+#include "string.h"
+#if defined(USING_SCENE)
+#include "scene.h"
 #endif
 
-#define Get_Digital_Port(GPIO_Port) \
-    (GPIO_Port ? GPIOA : GPIOB)
+/*引脚表中的一路输入/输出*/
+typedef struct
+{
+    GPIO_TypeDef *Port;
+    uint16_t Pin;
+} Io_Pin;
+
+/*数字量输入引脚表:第i项为通道i，超出表的通道读为低电平*/
+static const Io_Pin Digital_Inputs[] = {
+    {DDI0_GPIO_Port, DDI0_Pin},
+};
+
+/*继电器输出引脚表:第i项为输出线圈 DIGITAL_OUTPUT_START_ADDR + i，多继电器的板卡在此扩展并修改 EXTERN_OUTPUT_MAX*/
+static const Io_Pin Digital_Outputs[EXTERN_OUTPUT_MAX] = {
+    {RELAY_GPIO_Port, RELAY_Pin},
+};
+/*输出引脚分布的端口数上限(GPIOA~GPIOC)*/
+#define OUTPUT_PORTS_MAX 3U
 
-#define Get_Digital_Pin(GPIO_Pin) \
-    (GPIO_Pin < 5U ? (DDI0_Pin << GPIO_Pin) : (GPIO_Pin < 7U ? \
-    (DDI5_Pin << (GPIO_Pin - 5U)) : DDI7_Pin))
 /**
  * @brief	外部数字量输入处理
- * @details	STM32F103C8T6共在io口扩展了8路数字输入
+ * @details	按输入引脚表读取并写入线圈
  * @param	None
  * @retval	None
  */
 void Io_Digital_Input(void)
 {
-    GPIO_TypeDef *pGPIOx;
-	uint16_t GPIO_Pinx;
-    mdBit bit = mdLow;
+    mdBit bit;
     mdU32 addr;
     mdSTATUS ret;
-    
+
+    TRACE(TRACE_DI_BEGIN);
     for (uint16_t i = 0; i < EXTERN_DIGITAL_MAX; i++)
     {
-        pGPIOx = Get_Digital_Port((i < 5U ? 1 : 0));
-        GPIO_Pinx = Get_Digital_Pin(i);
-        /*指针合法*/
-        if (pGPIOx)
+        bit = mdLow;
+        if (i < sizeof(Digital_Inputs) / sizeof(Digital_Inputs[0]))
         {
             /*读取外部数字引脚状态*/
-            bit = (mdBit)HAL_GPIO_ReadPin(pGPIOx, GPIO_Pinx);
+            bit = (Digital_Inputs[i].Port->IDR & Digital_Inputs[i].Pin) ? mdHigh : mdLow;
         }
         /*计算出出当前写入地址*/
         addr = DIGITAL_INPUT_START_ADDR + i;
         /*写入线圈*/
-        ret = mdhandler->registerPool->mdWriteCoil(mdhandler->registerPool, addr, bit);
+        ret = mdhandler->registerPool->ops->mdWriteCoil(mdhandler->registerPool, addr, bit);
         /*写入失败*/
         if (ret == mdFALSE)
         {
 #if defined(USING_DEBUG)
-        // mdhandler->registerPool->mdReadInputCoil(mdhandler->registerPool, addr, &bit);
-        shellPrint(&shell,"DDI[%d] = 0x%d\r\n", i, bit);
+            shellPrint(&shell, "DDI[%d] = 0x%d\r\n", i, bit);
 #endif
-        }  
+        }
+    }
+    TRACE(TRACE_DI_END);
+}
+
+/*模拟量校准:工程值(uA/mV) = (码值 * Gain + Offset) >> 16，系数为Q16定点数*/
+typedef struct
+{
+    int32_t Gain;
+    int32_t Offset;
+} Io_AnalogCal;
+
+/*模拟量上报条件，单位同 ANALOG_DEADBAND_ABSOLUTE 等默认值*/
+typedef struct
+{
+    uint16_t Absolute;
+    uint16_t Percent;
+    uint16_t Min_Interval;
+    uint16_t Max_Interval;
+} Io_AnalogDeadband;
+
+/*校准系数及上报条件在参数区中的记录(KV_KEY_ANALOG)*/
+typedef struct
+{
+    Io_AnalogCal Cal[ADC_DMA_CHANNEL];
+    Io_AnalogDeadband Deadband[ADC_DMA_CHANNEL];
+} Io_AnalogCal_Record;
+typedef char Io_AnalogCal_Record_Size[(sizeof(Io_AnalogCal_Record) <= KV_VALUE_MAX) ? 1 : -1];
+
+/*最近一次标记上报的码值及时刻*/
+typedef struct
+{
+    mdU16 Code;
+    bool Valid;
+    uint32_t Tick;
+} Io_AnalogPublish;
+
+/*两点校准的采集点:码值及对应的参考值*/
+typedef struct
+{
+    mdU16 Code[2];
+    int32_t Value[2];
+    bool Valid;
+} Io_AnalogCal_Point;
+
+#define ANALOG_CAL_Q16(full_scale) ((int32_t)(((int64_t)(full_scale) << 16) / 4095))
+/*两点的码值差不足时拒绝计算，避免分辨率不足导致的增益误差*/
+#define ANALOG_CAL_MIN_SPAN 256
+
+static const Io_AnalogCal Analog_Cal_Default[ADC_DMA_CHANNEL] = {
+    {ANALOG_CAL_Q16(ANALOG_FULL_SCALE_CURRENT), 0},
+    {ANALOG_CAL_Q16(ANALOG_FULL_SCALE_VOLTAGE), 0},
+};
+/*换算中使用的系数(定时器服务任务)，修改时在临界区内成对更新*/
+static Io_AnalogCal Analog_Cal[ADC_DMA_CHANNEL] = {
+    {ANALOG_CAL_Q16(ANALOG_FULL_SCALE_CURRENT), 0},
+    {ANALOG_CAL_Q16(ANALOG_FULL_SCALE_VOLTAGE), 0},
+};
+static Io_AnalogCal_Point Analog_Cal_Point[ADC_DMA_CHANNEL];
+static Io_AnalogDeadband Analog_Deadband[ADC_DMA_CHANNEL] = {
+    {ANALOG_DEADBAND_ABSOLUTE, ANALOG_DEADBAND_PERCENT, ANALOG_PUBLISH_MIN_INTERVAL, ANALOG_PUBLISH_MAX_INTERVAL},
+    {ANALOG_DEADBAND_ABSOLUTE, ANALOG_DEADBAND_PERCENT, ANALOG_PUBLISH_MIN_INTERVAL, ANALOG_PUBLISH_MAX_INTERVAL},
+};
+static Io_AnalogPublish Analog_Publish[ADC_DMA_CHANNEL];
+/*低通滤波器状态(码值左移 ANALOG_FILTER_SHIFT 位)，第一个周期以当前码值初始化*/
+static uint32_t Analog_Filter[ADC_DMA_CHANNEL];
+static bool Analog_Filter_Valid;
+/*待上报的通道(第i位为通道i)及其工程值，由写线圈应答取走*/
+static uint8_t Analog_Pending;
+static mdU16 Analog_Value[ADC_DMA_CHANNEL];
+static osTimerId Analog_Timer;
+
+/**
+ * @brief	登记模拟量的字顺序并加载校准系数
+ * @details	浮点数在报文中高位字在前，只在应答及写入请求的收发时转换，其余保持寄存器不交换；
+ *			参数区中的记录长度正确时才覆盖默认系数及上报条件，在 Persist_Init() 之后调用
+ * @param	None
+ * @retval	None
+ */
+void Io_Analog_Init(void)
+{
+    RegisterPoolHandle regPool = mdhandler->registerPool;
+    Io_AnalogCal_Record record;
+
+    regPool->ops->mdSetWordOrder(regPool, HOLD_REGISTER_OFFSET + ANALOG_START_ADDR, ADC_DMA_CHANNEL * 2U,
+                            mdWORD_ORDER_ABCD);
+    if (Kv_Get(KV_KEY_ANALOG, &record, sizeof(record)) == sizeof(record))
+    {
+        for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+        {
+            /*增益为0的记录无意义，保留默认系数*/
+            if (record.Cal[i].Gain)
+            {
+                Analog_Cal[i] = record.Cal[i];
+            }
+            Analog_Deadband[i] = record.Deadband[i];
+        }
+    }
+#if defined(USING_ANALOG_UPLINK)
+    mdhandler->mdRTUReportAnalog = Io_Analog_Report;
+#endif
+}
+
+/**
+ * @brief	码值换算为工程值
+ * @details	只用整数乘法与移位，结果四舍五入并限幅到16bit
+ * @param	Channel 通道号
+ * @param	Code 滤波后的码值
+ * @retval	工程值(uA/mV)
+ */
+static mdU16 Io_Analog_Apply(uint16_t Channel, mdU16 Code)
+{
+    int64_t value = (int64_t)Code * Analog_Cal[Channel].Gain + Analog_Cal[Channel].Offset + 0x8000;
+
+    if (value < 0)
+    {
+        return 0;
+    }
+    value >>= 16;
+    return (mdU16)((value > 0xFFFF) ? 0xFFFF : value);
+}
+
+/**
+ * @brief	模拟量上报判断
+ * @details	变化超过死区(绝对死区与相对死区取大)且距上次上报不小于最短间隔，或到达最长间隔时，
+ *			标记该通道在下一个写线圈应答中上报；应答丢失时由最长间隔补发
+ * @param	raw 滤波后的码值
+ * @param	value 工程值
+ * @retval	None
+ */
+static void Io_Analog_Publish(const mdU16 *raw, const mdU16 *value)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        Io_AnalogPublish *pPub = &Analog_Publish[i];
+        const Io_AnalogDeadband *pBand = &Analog_Deadband[i];
+        uint32_t elapsed = now - pPub->Tick;
+        uint32_t band = ((uint32_t)pPub->Code * pBand->Percent) / 1000U;
+        uint32_t delta = (raw[i] > pPub->Code) ? (raw[i] - pPub->Code) : (pPub->Code - raw[i]);
+
+        band = (band > pBand->Absolute) ? band : pBand->Absolute;
+        taskENTER_CRITICAL();
+        /*已标记的通道以最新值上报*/
+        Analog_Value[i] = value[i];
+        taskEXIT_CRITICAL();
+        if ((pPub->Valid && ((delta <= band) || (elapsed < pBand->Min_Interval))) &&
+            (!pBand->Max_Interval || (elapsed < pBand->Max_Interval * 1000UL)))
+        {
+            continue;
+        }
+        pPub->Code = raw[i];
+        pPub->Valid = true;
+        pPub->Tick = now;
+        taskENTER_CRITICAL();
+        Analog_Pending |= 1U << i;
+        taskEXIT_CRITICAL();
     }
 }
 
 /**
  * @brief	外部模拟量输入处理
- * @details	STM32F103C8T6共在io口扩展了2路模拟输入，通道0为电流，通道1为电压
+ * @details	STM32F103C8T6共在io口扩展了2路模拟输入，通道0为电流，通道1为电压；
+ *			DMA循环缓冲的平均值经一阶低通、校准后以浮点数写入保持寄存器，并检查上报条件
  * @param	None
  * @retval	None
  */
 void Io_Analog_Handle(void)
 {
-    mdU32 addr = ANALOG_START_ADDR;
     mdSTATUS ret;
-    float temp_data[ADC_DMA_CHANNEL] = {0};
+    float temp_data[ADC_DMA_CHANNEL];
+    mdU16 raw_data[ADC_DMA_CHANNEL];
+    mdU16 value[ADC_DMA_CHANNEL];
 
-    // Get_AdcValue(ADC_CHANNEL_0);
-    /*写入保持寄存器*/
-    ret = mdhandler->registerPool->mdWriteHoldRegisters(mdhandler->registerPool, addr, sizeof(temp_data), (mdU16 *)&temp_data); 
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        uint32_t code = Get_AdcValue(i);
+
+        Analog_Filter[i] = Analog_Filter_Valid
+                               ? (Analog_Filter[i] + code - (Analog_Filter[i] >> ANALOG_FILTER_SHIFT))
+                               : (code << ANALOG_FILTER_SHIFT);
+        raw_data[i] = (mdU16)(Analog_Filter[i] >> ANALOG_FILTER_SHIFT);
+        value[i] = Io_Analog_Apply(i, raw_data[i]);
+        temp_data[i] = value[i];
+    }
+    Analog_Filter_Valid = true;
+    /*写入保持寄存器:整段为一次原子提交，主站读取时不会得到新旧各半的浮点数*/
+    ret = mdhandler->registerPool->ops->mdWriteFloats(mdhandler->registerPool, HOLD_REGISTER_OFFSET + ANALOG_START_ADDR,
+                                                 ADC_DMA_CHANNEL, temp_data);
+    Io_Analog_Publish(raw_data, value);
     /*写入失败*/
     if (ret == mdFALSE)
     {
 
     } 
-#if defined(USING_DEBUG)
-    // shellPrint(&shell,"AD[%d] = 0x%d\r\n", 0, Get_AdcValue(ADC_CHANNEL_1));
-#endif
 }
 
+/**
+ * @brief	模拟量定时到
+ * @details	在定时器服务任务中调用，两路的处理只有整数运算及一次寄存器写入
+ * @param	argument 未使用
+ * @retval	None
+ */
+static void Io_Analog_Timer(void const *argument)
+{
+    UNUSED(argument);
+    Io_Analog_Handle();
+}
+
+/**
+ * @brief	启动模拟量的周期处理
+ * @details	在 MX_FREERTOS_Init() 中调用
+ * @param	None
+ * @retval	None
+ */
+void Io_Analog_Start(void)
+{
+    osTimerDef(Analog_Timer, Io_Analog_Timer);
+
+    Analog_Timer = osTimerCreate(osTimer(Analog_Timer), osTimerPeriodic, NULL);
+    osTimerStart(Analog_Timer, ANALOG_PERIOD);
+}
+
+/**
+ * @brief	取走待上报的模拟量
+ * @details	在写线圈应答中调用(接收任务)，取走后清除标记；复发的请求由重复请求缓存回放原应答
+ * @param	handler Modbus句柄
+ * @param	values 各通道的工程值
+ * @retval	上报的通道掩码
+ */
+uint8_t Io_Analog_Report(ModbusRTUSlaveHandler handler, mdU16 *values)
+{
+    uint8_t mask;
+
+    UNUSED(handler);
+    taskENTER_CRITICAL();
+    mask = Analog_Pending;
+    Analog_Pending = 0;
+    memcpy(values, Analog_Value, sizeof(Analog_Value));
+    taskEXIT_CRITICAL();
+
+    return mask;
+}
+
+/**
+ * @brief	保存模拟量校准系数及上报条件
+ * @details	写入参数区(内容未变时不写flash)
+ * @param	None
+ * @retval	0 成功 0xFF 写入失败
+ */
+uint8_t Io_Analog_Cal_Save(void)
+{
+    Io_AnalogCal_Record record;
+
+    taskENTER_CRITICAL();
+    memcpy(record.Cal, Analog_Cal, sizeof(record.Cal));
+    memcpy(record.Deadband, Analog_Deadband, sizeof(record.Deadband));
+    taskEXIT_CRITICAL();
+
+    return Kv_Set(KV_KEY_ANALOG, &record, sizeof(record)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal_save, Io_Analog_Cal_Save, save analog calibration);
+
+/**
+ * @brief	两点校准采集
+ * @details	输入端接入参考信号后调用，记录当前滤波码值；采集高点时由两点计算增益与偏移，
+ *			新系数立即生效，保存需另行执行 cal_save
+ * @param	Channel 通道号
+ * @param	Point 0:低点 1:高点
+ * @param	Value 参考值(uA/mV)
+ * @retval	0 成功 0xFF 失败
+ */
+static uint8_t Io_Analog_Cal_Point(uint16_t Channel, uint8_t Point, int32_t Value)
+{
+    Io_AnalogCal_Point *pPoint;
+    int32_t span;
+    int64_t gain, offset;
+
+    if ((Channel >= ADC_DMA_CHANNEL) || (Point > 1U))
+    {
+        return 0xFF;
+    }
+    pPoint = &Analog_Cal_Point[Channel];
+    pPoint->Code[Point] = (mdU16)(Analog_Filter[Channel] >> ANALOG_FILTER_SHIFT);
+    pPoint->Value[Point] = Value;
+    if (Point == 0U)
+    {
+        pPoint->Valid = true;
+        return 0;
+    }
+    if (!pPoint->Valid)
+    {
+        return 0xFF;
+    }
+    span = (int32_t)pPoint->Code[1] - (int32_t)pPoint->Code[0];
+    if ((span < ANALOG_CAL_MIN_SPAN) && (span > -ANALOG_CAL_MIN_SPAN))
+    {
+        return 0xFF;
+    }
+    gain = ((int64_t)(pPoint->Value[1] - pPoint->Value[0]) * 65536) / span;
+    offset = (int64_t)pPoint->Value[0] * 65536 - gain * pPoint->Code[0];
+    if ((gain <= 0) || (gain > INT32_MAX) || (offset > INT32_MAX) || (offset < INT32_MIN))
+    {
+        return 0xFF;
+    }
+    taskENTER_CRITICAL();
+    Analog_Cal[Channel].Gain = (int32_t)gain;
+    Analog_Cal[Channel].Offset = (int32_t)offset;
+    taskEXIT_CRITICAL();
+    pPoint->Valid = false;
+
+    return 0;
+}
+
+/**
+ * @brief	shell两点校准
+ * @param	ch 通道号
+ * @param	point 0:低点 1:高点 其他:恢复默认系数
+ * @param	value 参考值(uA/mV)
+ * @retval	0 成功 0xFF 失败
+ */
+int Io_Analog_Cal_Shell(int ch, int point, int value)
+{
+    if ((ch < 0) || (ch >= (int)ADC_DMA_CHANNEL))
+    {
+        return 0xFF;
+    }
+    if ((point != 0) && (point != 1))
+    {
+        taskENTER_CRITICAL();
+        Analog_Cal[ch] = Analog_Cal_Default[ch];
+        taskEXIT_CRITICAL();
+        Analog_Cal_Point[ch].Valid = false;
+        return 0;
+    }
+    return Io_Analog_Cal_Point((uint16_t)ch, (uint8_t)point, value);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal, Io_Analog_Cal_Shell, analog calibration ch point value);
+
+/**
+ * @brief	设置模拟量上报条件
+ * @details	在下一个处理周期生效，保存需执行 cal_save
+ * @param	ch 通道号
+ * @param	absolute 绝对死区(12bit码值)
+ * @param	percent 相对死区(上次上报值的0.1%)
+ * @param	min_ms 最短上报间隔(ms)
+ * @param	max_s 最长上报间隔(s)，为0时不限
+ * @retval	0 成功 0xFF 参数错误
+ */
+uint8_t Io_Analog_Set_Deadband(int ch, int absolute, int percent, int min_ms, int max_s)
+{
+    Io_AnalogDeadband band;
+
+    if ((ch < 0) || (ch >= (int)ADC_DMA_CHANNEL) || (absolute < 0) || (absolute > 0x0FFF) || (percent < 0) ||
+        (percent > 1000) || (min_ms < 0) || (min_ms > 0xFFFF) || (max_s < 0) || (max_s > 0xFFFF) ||
+        (max_s && ((uint32_t)max_s * 1000UL < (uint32_t)min_ms)))
+    {
+        return 0xFF;
+    }
+    band.Absolute = (uint16_t)absolute;
+    band.Percent = (uint16_t)percent;
+    band.Min_Interval = (uint16_t)min_ms;
+    band.Max_Interval = (uint16_t)max_s;
+    taskENTER_CRITICAL();
+    Analog_Deadband[ch] = band;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), deadband, Io_Analog_Set_Deadband, set ch abs pct min_ms max_s);
+
+/**
+ * @brief	打印模拟量校准系数及上报条件
+ * @param	None
+ * @retval	None
+ */
+void Io_Analog_Cal_Show(void)
+{
+    for (uint16_t i = 0; i < ADC_DMA_CHANNEL; i++)
+    {
+        mdU16 code = (mdU16)(Analog_Filter[i] >> ANALOG_FILTER_SHIFT);
+
+        shellPrint(&shell, "[%d] gain = %d, offset = %d (Q16), code = %d, value = %d\r\n", i, Analog_Cal[i].Gain,
+                   Analog_Cal[i].Offset, code, Io_Analog_Apply(i, code));
+        shellPrint(&shell, "    deadband = %d/%d.%d%%, interval = %dms/%ds, reported = %d\r\n",
+                   Analog_Deadband[i].Absolute, Analog_Deadband[i].Percent / 10U, Analog_Deadband[i].Percent % 10U,
+                   Analog_Deadband[i].Min_Interval, Analog_Deadband[i].Max_Interval, Analog_Publish[i].Code);
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), cal_show, Io_Analog_Cal_Show, show analog calibration);
+
 #if defined(USING_SLAVE)
 /**
- * @brief	数字量对应继电器输出
- * @details	从站仅有一路数字量继电器输出
+ * @brief	通信中断看门狗超时时间
+ * @details	每收到一帧本站的有效帧时用于重新启动单次定时器
  * @param	None
+ * @retval	超时时间(ms)
+ */
+uint32_t Io_Failsafe_Timeout(void)
+{
+    mdU16 timeout = 0;
+
+    mdhandler->registerPool->ops->mdReadHoldRegister(mdhandler->registerPool, FAILSAFE_TIMEOUT_ADDR, &timeout);
+    if (timeout == 0)
+    {
+        return FAILSAFE_TIMEOUT_DEFAULT;
+    }
+    return (timeout < FAILSAFE_TIMEOUT_MIN) ? FAILSAFE_TIMEOUT_MIN : timeout;
+}
+
+/**
+ * @brief	通信中断期间的输出状态
+ * @details	按保持寄存器中配置的策略给出输出，强制的状态同时写回寄存器池，
+ *			通信恢复后主站重新下发前不会回到中断前的旧命令；脉冲宽度以输出任务周期为分辨率
+ * @param	Channel 输出通道号
+ * @param	Elapsed 进入失效安全后的时间(ms)
+ * @param	pBit 输出状态
+ * @retval	mdFALSE 保持最后状态，不驱动输出
+ */
+static mdSTATUS Io_Failsafe_Output(uint16_t Channel, uint32_t Elapsed, mdBit *pBit)
+{
+    RegisterPoolHandle regPool = mdhandler->registerPool;
+    mdU16 policy = FAILSAFE_OFF, pulse = 0;
+
+    regPool->ops->mdReadHoldRegister(regPool, FAILSAFE_POLICY_START_ADDR + Channel, &policy);
+    regPool->ops->mdReadHoldRegister(regPool, FAILSAFE_PULSE_START_ADDR + Channel, &pulse);
+    switch (policy)
+    {
+    case FAILSAFE_HOLD:
+        return mdFALSE;
+    case FAILSAFE_ON:
+        *pBit = mdHigh;
+        break;
+    case FAILSAFE_PULSE:
+        *pBit = (Elapsed < pulse) ? mdHigh : mdLow;
+        break;
+    default:
+        *pBit = mdLow;
+        break;
+    }
+    /*数据写回寄存器池*/
+    regPool->ops->mdWriteCoil(regPool, DIGITAL_OUTPUT_START_ADDR + Channel, *pBit);
+
+    return mdTRUE;
+}
+
+/*本地输出模式的状态:线圈命令的上一电平、模式给出的输出及定时器*/
+typedef struct
+{
+    mdBit Command;
+    mdBit Output;
+    osTimerId Timer;
+    volatile bool Expired;
+} Io_OutputMode;
+
+static Io_OutputMode Output_Mode[EXTERN_OUTPUT_MAX];
+/*继电器当前输出:第i位为输出i的状态*/
+static uint32_t Relay_Output;
+/*通信中断看门狗已超时，输出由失效安全策略接管*/
+static volatile bool Output_Failsafe;
+#if defined(USING_FAST_OUTPUT)
+/*快速输出:接收中断中已驱动、Modbus任务尚未写入相同线圈的输出*/
+typedef struct
+{
+    /*第i位为输出i的快速输出有效及其状态，Driven 为中断中实际改变、输出任务尚未计入动作延迟的输出*/
+    volatile uint32_t Mask;
+    volatile uint32_t Bits;
+    volatile uint32_t Driven;
+    uint32_t Tick;
+    /*驱动的帧数、因输出模式或失效安全未驱动的帧数、超过保持时间仍未被线圈确认而撤销的次数*/
+    uint32_t Applied;
+    uint32_t Skipped;
+    uint32_t Expired;
+} Io_FastOutput;
+
+static Io_FastOutput Fast_Output;
+#endif
+extern osThreadId io_outputHandle;
+
+/**
+ * @brief	输出模式定时到
+ * @details	在定时器服务任务中调用，只记录到时并唤醒输出任务，继电器仍由输出任务操作
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Io_Output_Timer(void const *argument)
+{
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        if ((void const *)Output_Mode[i].Timer == argument)
+        {
+            Output_Mode[i].Expired = true;
+        }
+    }
+    osSignalSet(io_outputHandle, IO_SIGNAL_OUTPUT);
+}
+
+/**
+ * @brief	创建各路输出模式的单次定时器
+ * @details	在创建输出任务后调用
+ * @param	None
+ * @retval	None
+ */
+void Io_Output_Mode_Init(void)
+{
+    osTimerDef(Output_Timer, Io_Output_Timer);
+
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        Output_Mode[i].Timer = osTimerCreate(osTimer(Output_Timer), osTimerOnce, NULL);
+    }
+}
+
+/**
+ * @brief	按本地输出模式得到输出
+ * @details	脉冲、延时及翻转均由线圈命令的边沿触发，时间由定时器服务计时，主站一帧即可完成动作，
+ *			动作时长不受无线链路时延影响；时间为0时按1ms处理
+ * @param	Channel 输出通道号
+ * @param	Command 线圈命令
+ * @retval	输出状态
+ */
+static mdBit Io_Output_Mode(uint16_t Channel, mdBit Command)
+{
+    RegisterPoolHandle regPool = mdhandler->registerPool;
+    Io_OutputMode *pMode = &Output_Mode[Channel];
+    mdU16 mode = OUTPUT_MODE_DIRECT, time = 0;
+    bool rise = Command && !pMode->Command, fall = !Command && pMode->Command;
+    bool expired = pMode->Expired;
+
+    pMode->Expired = false;
+    pMode->Command = Command;
+    regPool->ops->mdReadHoldRegister(regPool, OUTPUT_MODE_START_ADDR + Channel, &mode);
+    regPool->ops->mdReadHoldRegister(regPool, OUTPUT_TIME_START_ADDR + Channel, &time);
+    time = time ? time : 1U;
+    switch (mode)
+    {
+    case OUTPUT_MODE_PULSE:
+        if (rise)
+        {
+            pMode->Output = mdHigh;
+            osTimerStart(pMode->Timer, time);
+        }
+        else if (expired)
+        {
+            pMode->Output = mdLow;
+        }
+        break;
+    case OUTPUT_MODE_ON_DELAY:
+        if (rise)
+        {
+            osTimerStart(pMode->Timer, time);
+        }
+        else if (fall)
+        {
+            osTimerStop(pMode->Timer);
+            pMode->Output = mdLow;
+        }
+        else if (expired && Command)
+        {
+            pMode->Output = mdHigh;
+        }
+        break;
+    case OUTPUT_MODE_OFF_DELAY:
+        if (rise)
+        {
+            osTimerStop(pMode->Timer);
+            pMode->Output = mdHigh;
+        }
+        else if (fall)
+        {
+            osTimerStart(pMode->Timer, time);
+        }
+        else if (expired && !Command)
+        {
+            pMode->Output = mdLow;
+        }
+        break;
+    case OUTPUT_MODE_TOGGLE:
+        pMode->Output = rise ? !pMode->Output : pMode->Output;
+        break;
+    default:
+        pMode->Output = Command;
+        break;
+    }
+
+    return pMode->Output;
+}
+
+/**
+ * @brief	失效安全接管输出后同步输出模式
+ * @details	停止正在计时的动作，通信恢复后以失效安全的输出为起点
+ * @param	Channel 输出通道号
+ * @param	Output 失效安全的输出
+ * @retval	None
+ */
+static void Io_Output_Mode_Reset(uint16_t Channel, mdBit Output)
+{
+    Io_OutputMode *pMode = &Output_Mode[Channel];
+
+    if (pMode->Timer)
+    {
+        osTimerStop(pMode->Timer);
+    }
+    pMode->Expired = false;
+    pMode->Command = pMode->Output = Output;
+}
+
+/**
+ * @brief	一次写入全部继电器输出
+ * @details	按端口合并置位/复位掩码，每个端口只写一次BSRR，同一端口的继电器在同一条指令中动作
+ * @param	Bits 第i位为输出i的状态
+ * @retval	None
+ */
+static void Io_Output_Write(uint32_t Bits)
+{
+    GPIO_TypeDef *ports[OUTPUT_PORTS_MAX];
+    uint32_t bsrr[OUTPUT_PORTS_MAX];
+    uint16_t count = 0, j;
+
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        const Io_Pin *pPin = &Digital_Outputs[i];
+
+        for (j = 0; (j < count) && (ports[j] != pPin->Port); j++)
+        {
+        }
+        if (j == count)
+        {
+            if (count >= OUTPUT_PORTS_MAX)
+            {
+                continue;
+            }
+            ports[count] = pPin->Port;
+            bsrr[count++] = 0;
+        }
+        bsrr[j] |= ((Bits >> i) & 0x01) ? pPin->Pin : ((uint32_t)pPin->Pin << 16U);
+    }
+    for (j = 0; j < count; j++)
+    {
+        ports[j]->BSRR = bsrr[j];
+    }
+}
+
+#if defined(USING_FAST_OUTPUT)
+/**
+ * @brief	合并快速输出
+ * @details	关中断后由输出任务调用；线圈已写成快速输出的状态(Modbus任务已处理该帧)或超过保持时间
+ *			(帧被任务丢弃)时撤销，否则继续按快速输出驱动，输出任务不会以旧线圈覆盖中断中刚驱动的继电器；
+ *			失效安全接管时全部撤销
+ * @param	Output 按线圈及输出模式得到的输出
+ * @param	Coils 输出线圈(按位打包)
+ * @param	Failsafe 失效安全已接管
+ * @param	pDriven 中断中已实际驱动的输出
+ * @retval	合并后的输出
+ */
+static uint32_t Io_Output_Fast_Merge(uint32_t Output, const mdU8 *Coils, bool Failsafe, uint32_t *pDriven)
+{
+    uint32_t mask = Fast_Output.Mask, bit;
+    bool drop = Failsafe;
+
+    *pDriven = Fast_Output.Driven;
+    Fast_Output.Driven = 0;
+    if (mask && !drop && (HAL_GetTick() - Fast_Output.Tick >= FAST_OUTPUT_HOLD))
+    {
+        Fast_Output.Expired++;
+        drop = true;
+    }
+    for (uint16_t i = 0; mask && (i < EXTERN_OUTPUT_MAX); i++)
+    {
+        bit = 1UL << i;
+        if (!(mask & bit))
+        {
+            continue;
+        }
+        if (drop || ((((Coils[i / 8U] >> (i % 8U)) & 0x01) ? bit : 0U) == (Fast_Output.Bits & bit)))
+        {
+            mask &= ~bit;
+            continue;
+        }
+        Output = (Output & ~bit) | (Fast_Output.Bits & bit);
+    }
+    Fast_Output.Mask = mask;
+
+    return Output;
+}
+
+/**
+ * @brief	快速写入:在串口空闲中断中驱动继电器
+ * @details	由协议栈在CRC(及认证)校验通过后调用，FC05写输出线圈或场景帧中跟随线圈(直接输出模式)的输出
+ *			立即写入端口，不等待Modbus任务及输出任务；寄存器池、事件记录、保留区及应答仍由任务照常处理，
+ *			二者动作相同(FC05及场景均为幂等命令)。其他输出模式及失效安全接管期间不驱动
+ * @param	handler Modbus句柄
+ * @param	frame 从机地址+PDU
+ * @param	length 长度
+ * @retval	None
+ */
+mdVOID Io_Output_Fast(ModbusRTUSlaveHandler handler, const mdU8 *frame, mdU32 length)
+{
+    RegisterPoolHandle regPool = handler->registerPool;
+    uint32_t mask = 0, bits = 0, output, before;
+    uint16_t addr, value;
+    mdU16 mode;
+
+    UNUSED(length);
+    if (frame[1] == MODBUS_CODE_5)
+    {
+        addr = ToU16(frame[2], frame[3]);
+        value = ToU16(frame[4], frame[5]);
+        if ((addr < DIGITAL_OUTPUT_START_ADDR) || (addr >= DIGITAL_OUTPUT_START_ADDR + EXTERN_OUTPUT_MAX) ||
+            ((value != 0xFF00U) && (value != 0x0000U)))
+        {
+            return;
+        }
+        mask = 1UL << (addr - DIGITAL_OUTPUT_START_ADDR);
+        bits = value ? mask : 0U;
+    }
+#if defined(USING_SCENE)
+    else if (!Scene_Coils(frame[2], &mask, &bits))
+    {
+        return;
+    }
+#endif
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        mode = OUTPUT_MODE_DIRECT;
+        regPool->ops->mdReadHoldRegister(regPool, OUTPUT_MODE_START_ADDR + i, &mode);
+        if (mode != OUTPUT_MODE_DIRECT)
+        {
+            mask &= ~(1UL << i);
+        }
+    }
+    if (!mask || Output_Failsafe)
+    {
+        Fast_Output.Skipped++;
+        return;
+    }
+    before = (Relay_Output & ~Fast_Output.Mask) | (Fast_Output.Bits & Fast_Output.Mask);
+    Fast_Output.Bits = (Fast_Output.Bits & ~mask) | (bits & mask);
+    Fast_Output.Mask |= mask;
+    Fast_Output.Tick = HAL_GetTick();
+    output = (Relay_Output & ~Fast_Output.Mask) | (Fast_Output.Bits & Fast_Output.Mask);
+    Io_Output_Write(output);
+    if (output != before)
+    {
+        TRACE(TRACE_RELAY);
+    }
+    /*与输出任务的当前输出不同的输出，输出任务写入时不再计入动作延迟*/
+    Fast_Output.Driven |= output ^ Relay_Output;
+    Fast_Output.Applied++;
+}
+
+/**
+ * @brief	打印快速输出的统计
+ * @param	None
+ * @retval	None
+ */
+void Io_Output_Fast_Show(void)
+{
+    shellPrint(&shell, "frames = %u, applied = %u, skipped = %u, expired = %u, pending = 0x%02x\r\n",
+               mdhandler->fastFrames, Fast_Output.Applied, Fast_Output.Skipped, Fast_Output.Expired,
+               Fast_Output.Mask);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), fast_output, Io_Output_Fast_Show, show fast output statistics);
+#endif
+
+/**
+ * @brief	数字量对应继电器输出
+ * @details	一次读取全部输出线圈；正常时线圈命令经本地输出模式输出，通信中断时按失效安全策略输出，
+ *			最后一次写入全部继电器，主站一帧FC15即可同时更新所有输出；继电器动作时写入保留区
+ * @param	signal 通信中断看门狗已超时
  * @retval	None
  */
 void Io_Digital_Output(bool signal)
 {
+    static uint32_t failsafe_tick = 0;
+    mdU8 coils[(EXTERN_OUTPUT_MAX + 7U) / 8U] = {0};
+    uint32_t output = Relay_Output, changed, driven = 0;
     mdBit bit = mdLow;
-    mdU32 addr = DIGITAL_OUTPUT_START_ADDR;
-    mdSTATUS ret = mdTRUE;
-    /*产生超时信号，复位输出*/
-    if(signal)
+#if defined(USING_FAST_OUTPUT)
+    uint32_t primask;
+#endif
+
+    TRACE(TRACE_DO_BEGIN);
+    if (signal && !Output_Failsafe)
     {
-        bit = mdLow;
-        /*数据写回寄存器池*/
-        mdhandler->registerPool->mdWriteCoil(mdhandler->registerPool, addr, bit);
+        failsafe_tick = HAL_GetTick();
     }
-    else
+    Output_Failsafe = signal;
+    /*读取远程信号*/
+    if (!signal && (mdhandler->registerPool->ops->mdReadCoilsPacked(mdhandler->registerPool, DIGITAL_OUTPUT_START_ADDR,
+                                                               EXTERN_OUTPUT_MAX, coils) == mdFALSE))
     {
-        /*读取远程信号*/
-        ret = mdhandler->registerPool->mdReadCoil(mdhandler->registerPool, addr, &bit);
+        return;
     }
-
-    /*读取正确且没有超时信号产生*/
-    if (ret == mdTRUE)
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
     {
-      HAL_GPIO_WritePin(RELAY_GPIO_Port, RELAY_Pin, (GPIO_PinState)bit);  
+        /*产生超时信号，按策略输出*/
+        if (signal)
+        {
+            if (Io_Failsafe_Output(i, HAL_GetTick() - failsafe_tick, &bit) == mdFALSE)
+            {
+                continue;
+            }
+            Io_Output_Mode_Reset(i, bit);
+        }
+        else
+        {
+            bit = Io_Output_Mode(i, (coils[i / 8U] >> (i % 8U)) & 0x01);
+        }
+        output = bit ? (output | (1UL << i)) : (output & ~(1UL << i));
     }
+#if defined(USING_FAST_OUTPUT)
+    /*接收中断随时可能驱动继电器，合并快速输出、写端口及更新当前输出在同一临界区内完成*/
+    primask = __get_PRIMASK();
+    __disable_irq();
+    output = Io_Output_Fast_Merge(output, coils, signal, &driven);
+#endif
+    Io_Output_Write(output);
+    changed = output ^ Relay_Output;
+    Relay_Output = output;
+#if defined(USING_FAST_OUTPUT)
+    __set_PRIMASK(primask);
+#endif
+    /*继电器动作时记录事件*/
+    if (changed)
+    {
+        /*主站命令到继电器动作的延迟，通信中断时的输出及已在接收中断中驱动的输出不计入*/
+        if (!signal && (changed & ~driven))
+        {
+            TRACE(TRACE_RELAY);
+        }
+        Retain_Set_Outputs(output);
+    }
+    for (uint16_t i = 0; changed; i++, changed >>= 1U)
+    {
+        if (changed & 0x01)
+        {
+            Soe_Record(DIGITAL_OUTPUT_START_ADDR + i, (output >> i) & 0x01);
+        }
+    }
+    TRACE(TRACE_DO_END);
 #if defined(USING_DEBUG)
-    shellPrint(&shell,"DDOx = 0x%d\r\n", bit);
+    shellPrint(&shell, "DDOx = 0x%02x\r\n", output);
 #endif
 }
+
+/**
+ * @brief	故障复位前驱动继电器到失效安全状态
+ * @details	在故障现场调用(中断已关闭)：按失效安全策略直接写端口，脉冲策略按断开处理；
+ *			不写保留区，热复位后仍按 Io_Output_Restore() 恢复故障前的输出
+ * @param	None
+ * @retval	None
+ */
+void Supervisor_Safe(void)
+{
+    uint32_t output = Relay_Output;
+    mdU16 policy;
+
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        policy = FAILSAFE_OFF;
+        if (mdhandler != NULL)
+        {
+            mdhandler->registerPool->ops->mdReadHoldRegister(mdhandler->registerPool, FAILSAFE_POLICY_START_ADDR + i,
+                                                             &policy);
+        }
+        if (policy != FAILSAFE_HOLD)
+        {
+            output = (policy == FAILSAFE_ON) ? (output | (1UL << i)) : (output & ~(1UL << i));
+        }
+    }
+    Io_Output_Write(output);
+}
+
+/**
+ * @brief	热复位后恢复继电器输出
+ * @details	在创建输出模式定时器后、输出任务首次运行前调用；保留区有效时以复位前的输出
+ *			回写输出线圈并作为各路输出模式的起点，继电器不会因复位而掉电，也不产生边沿动作；
+ *			上电时保留区无效，输出保持断开直到主站下发
+ * @param	None
+ * @retval	None
+ */
+void Io_Output_Restore(void)
+{
+    RegisterPoolHandle regPool = mdhandler->registerPool;
+    mdU8 coils[(EXTERN_OUTPUT_MAX + 7U) / 8U] = {0};
+    Retain_Data retain;
+
+    if (!Retain_Load(&retain))
+    {
+        return;
+    }
+    Relay_Output = retain.Outputs & ((EXTERN_OUTPUT_MAX >= 32U) ? 0xFFFFFFFFUL : ((1UL << EXTERN_OUTPUT_MAX) - 1UL));
+    for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+    {
+        coils[i / 8U] |= ((Relay_Output >> i) & 0x01) << (i % 8U);
+        Output_Mode[i].Command = Output_Mode[i].Output = (Relay_Output >> i) & 0x01;
+    }
+    regPool->ops->mdWriteCoilsPacked(regPool, DIGITAL_OUTPUT_START_ADDR, EXTERN_OUTPUT_MAX, coils);
+    Io_Output_Write(Relay_Output);
+}
+
+/**
+ * @brief	主站写线圈通知
+ * @details	在Modbus接收任务中调用；先刷新应答附带的输入，写入范围包含输出线圈时
+ *			唤醒输出任务立即驱动继电器，继电器仍只由输出任务操作
+ * @param	handler Modbus句柄
+ * @param	addr 起始线圈地址
+ * @param	length 线圈数
+ * @retval	None
+ */
+void Io_Output_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+    UNUSED(handler);
+    /*应答附带的输入在回复前刷新，输出任务不必为此周期唤醒*/
+    Io_Digital_Input();
+    if ((addr < DIGITAL_OUTPUT_START_ADDR + EXTERN_OUTPUT_MAX) && ((mdU32)addr + length > DIGITAL_OUTPUT_START_ADDR) &&
+        io_outputHandle)
+    {
+        osSignalSet(io_outputHandle, IO_SIGNAL_OUTPUT);
+    }
+}
 #endif
 
 
@@ -0,0 +1,148 @@
+#include "mac.h"
+#include "L101.h"
+#include "adc.h"
+#include "shell_port.h"
+
+static Mac_HandleTypeDef Mac;
+
+/**
+ * @brief	混入ADC噪声
+ * @details	DMA缓冲区中各采样的最低位由输入噪声决定，逐位移入随机数状态
+ * @param	None
+ * @retval	None
+ */
+static void Mac_Stir(void)
+{
+    uint32_t x = Mac.Seed;
+
+    for (uint32_t i = 0; i < ADC_DMA_SIZE; i++)
+    {
+        x = (x << 1U | x >> 31U) ^ (Adc_buffer[i] & 0x01U);
+    }
+    Mac.Seed = x ? x : 1U;
+}
+
+/**
+ * @brief	初始化随机数种子
+ * @param	None
+ * @retval	None
+ */
+void Mac_Init(void)
+{
+    Mac.Seed = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2();
+    Mac.Seed = Mac.Seed ? Mac.Seed : 1U;
+}
+
+/**
+ * @brief	取得随机数
+ * @details	xorshift32，以芯片唯一ID作种子，同一批从站上电时刻相同也能错开
+ * @param	None
+ * @retval	随机数
+ */
+uint32_t Mac_Random(void)
+{
+    uint32_t x = Mac.Seed;
+
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    Mac.Seed = x;
+
+    return x;
+}
+
+/**
+ * @brief	记录收到无线帧
+ * @details	在Modbus任务收到数据时调用，不论目标站号，此后 MAC_GUARD ms 内视为信道忙
+ * @param	None
+ * @retval	None
+ */
+void Mac_Activity(void)
+{
+    Mac.Last_Rx = HAL_GetTick();
+}
+
+/**
+ * @brief	信道是否空闲
+ * @param	None
+ * @retval	true 空闲
+ */
+static bool Mac_Idle(void)
+{
+    return Get_L101_Status() && ((uint32_t)(HAL_GetTick() - Mac.Last_Rx) >= MAC_GUARD);
+}
+
+/**
+ * @brief	开始为一个上行帧竞争信道
+ * @details	在 Delay 之后再随机等待 [0, Window] ms 才首次侦听，同一事件触发的从站不会同时侦听到空闲
+ * @param	pSlot 竞争状态
+ * @param	Delay 固定延迟(ms)
+ * @param	Window 随机延迟的上限(ms)
+ * @retval	None
+ */
+void Mac_Start(Mac_Slot *pSlot, uint32_t Delay, uint32_t Window)
+{
+    Mac_Stir();
+    pSlot->Attempt = 0;
+    pSlot->Due = HAL_GetTick() + Delay + (Mac_Random() % (Window + 1U));
+    Mac.Stats.Started++;
+}
+
+/**
+ * @brief	到下一次侦听的时间
+ * @param	pSlot 竞争状态
+ * @param	Wait 没有上行帧时的等待时间(ms)
+ * @retval	等待时间，不大于 Wait
+ */
+uint32_t Mac_Wait(const Mac_Slot *pSlot, uint32_t Wait)
+{
+    int32_t left = (int32_t)(pSlot->Due - HAL_GetTick());
+
+    return (left <= 0) ? 0 : (((uint32_t)left < Wait) ? (uint32_t)left : Wait);
+}
+
+/**
+ * @brief	侦听信道
+ * @details	到达侦听时刻且信道空闲时可以发送；信道忙时在 [0, MAC_CW_MIN * 2^n) 个时隙中随机退避，
+ *			再加上一个时隙内的随机抖动，n 为已退避次数(不超过 MAC_BACKOFF_MAX)；连续 MAC_RETRY_MAX 次忙时放弃
+ * @param	pSlot 竞争状态
+ * @retval	MAC_WAIT 未到侦听时刻或已退避 MAC_SEND 立即发送 MAC_DROP 放弃本帧
+ */
+uint8_t Mac_Access(Mac_Slot *pSlot)
+{
+    uint32_t window;
+
+    if ((int32_t)(pSlot->Due - HAL_GetTick()) > 0)
+    {
+        return MAC_WAIT;
+    }
+    if (Mac_Idle())
+    {
+        Mac.Stats.Sent++;
+        return MAC_SEND;
+    }
+    if (pSlot->Attempt >= MAC_RETRY_MAX)
+    {
+        Mac.Stats.Dropped++;
+        return MAC_DROP;
+    }
+    window = MAC_CW_MIN << ((pSlot->Attempt < MAC_BACKOFF_MAX) ? pSlot->Attempt : MAC_BACKOFF_MAX);
+    pSlot->Attempt++;
+    pSlot->Due = HAL_GetTick() + (Mac_Random() % window) * MAC_SLOT + (Mac_Random() % MAC_SLOT);
+    Mac.Stats.Backoffs++;
+
+    return MAC_WAIT;
+}
+
+/**
+ * @brief	打印信道接入统计
+ * @param	None
+ * @retval	None
+ */
+void Mac_Show(void)
+{
+    shellPrint(&shell, "channel = %s, started = %u, sent = %u, backoffs = %u, dropped = %u\r\n",
+               Mac_Idle() ? "idle" : "busy", Mac.Stats.Started, Mac.Stats.Sent, Mac.Stats.Backoffs,
+               Mac.Stats.Dropped);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), mac, Mac_Show, show uplink channel access);
@@ -23,6 +23,7 @@
 #include "adc.h"
 #include "dma.h"
 #include "spi.h"
+#include "tim.h"
 #include "usart.h"
 #include "gpio.h"
 
@@ -30,6 +31,27 @@
 /* USER CODE BEGIN Includes */
 #include "shell_port.h"
 #include "mdrtuslave.h"
+#include "io_signal.h"
+#include "soe.h"
+#include "extlog.h"
+#include "retain.h"
+#include "persist.h"
+#include "repeater.h"
+#include "auth.h"
+#include "sim.h"
+#include "xfer.h"
+#include "ota.h"
+#include "discover.h"
+#include "mac.h"
+#include "timesync.h"
+#include "trace.h"
+#include "irq_prio.h"
+#include "boot.h"
+#include "clock_mgr.h"
+#include "aout.h"
+#include "scene.h"
+#include "spis.h"
+#include "utimer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -97,10 +119,69 @@ int main(void)
   MX_ADC1_Init();
   MX_SPI2_Init();
   MX_USART1_UART_Init();
+  MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
+  /*Cycle counter for the latency trace points, which may fire in the first interrupts*/
+  Trace_Init();
+  /*Start in the full-speed profile; frames and output events keep it there, idle periods step it down*/
+  Clock_Init();
+  /*One priority table over the CubeMX defaults, kernel-aware ISRs below the syscall ceiling*/
+  Irq_Priority_Init();
+#if defined(USING_UTIMER)
+  /*TIM2 runs free at 1 us from here on and carries the microsecond timers*/
+  Utimer_Init();
+#endif
   User_Shell_Init();
   ModbusInit();
+  /*Rejected CRC errors and dropped replies can trigger a frozen trace capture*/
+  Trace_Watch(TRACE_TRIG_CRC, (const volatile uint32_t *)&mdhandler->receiveBuffer->crcErrors);
+  Trace_Watch(TRACE_TRIG_QUEUE, (const volatile uint32_t *)&mdhandler->txDropped);
+  /*Only the FRAM presence check here; the slot scan runs in the boot task*/
+  Extlog_Init();
+#if defined(USING_SPI_SLAVE)
+  /*SPI2 serves the register image to a local co-processor instead of the FRAM*/
+  Spis_Init();
+#endif
+  /*Retained RAM tells a warm restart from a power-up; the outputs are restored once the I/O task starts*/
+  Retain_Init();
+  /*Load the saved configuration registers before the tasks read them*/
+  Persist_Init();
+  /*Analog floats go out high word first; the word order is applied only when frames are built*/
+  Io_Analog_Init();
+#if defined(USING_AOUT)
+  /*PWM analog outputs start from zero and ramp to the saved registers*/
+  Aout_Init();
+#endif
+  /*Frames for the downstream Slaves listed here are relayed rather than answered*/
+  Repeater_Init();
+#if defined(USING_SIMULATOR)
+  /*Test firmware: answer for a range of logical slaves with the configured delay and loss*/
+  Sim_Init(mdhandler);
+#endif
+#if (MODBUS_AUTH)
+  /*With a key configured only requests carrying a valid sequence number and MAC are served*/
+  Auth_Init();
+#endif
+  /*Events are numbered from 1 until Soe_Resume() continues the FRAM sequence*/
+  Soe_Init(mdhandler->registerPool);
+  /*Bulk reads and writes of the event log, configuration and forwarding table in compressed blocks*/
+  Xfer_Init(mdhandler);
+  /*Firmware images streamed by the Master over broadcast frames are staged in the upper flash slot*/
+  Ota_Init(mdhandler);
+  /*Unsolicited uplinks listen before talking and back off at random when the channel is busy*/
+  Mac_Init();
+  /*Answer the join beacon in a random slot so a network comes up without probing absent nodes*/
+  Discover_Init(mdhandler);
+  /*Track the Master clock so event timestamps can be reported in master time*/
+  Timesync_Init(mdhandler);
+#if defined(USING_SCENE)
+  /*Preset output states stored here are switched together by one short (or broadcast) frame*/
+  Scene_Init(mdhandler);
+#endif
   HAL_ADC_Start_DMA(&hadc1, (uint32_t *)Adc_buffer, ADC_DMA_SIZE);
+  /*The averages are read from the circular buffer on demand, so the per-block DMA interrupts would only keep the core awake*/
+  __HAL_DMA_DISABLE_IT(hadc1.DMA_Handle, DMA_IT_HT | DMA_IT_TC);
+  Boot_Mark(BOOT_MARK_MAIN);
   /* USER CODE END 2 */
 
   /* Call init function for freertos objects (in freertos.c) */
@@ -197,11 +278,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
-  /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  /* Record the caller in the crash record, drive outputs safe and reset at once
+     instead of spinning until the external watchdog bites */
+  Supervisor_Error(SUPERVISOR_CALLER());
   /* USER CODE END Error_Handler_Debug */
 }
 
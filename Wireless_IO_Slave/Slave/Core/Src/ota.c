@@ -0,0 +1,310 @@
+#include "ota.h"
+#include "shell_port.h"
+#include "string.h"
+
+typedef char Ota_Slot_Check[(OTA_INFO_ADDR + FLASH_PAGE_SIZE <= FLASH_BASE + 0x20000UL) ? 1 : -1];
+typedef char Ota_Page_Check[((FLASH_PAGE_SIZE % OTA_CHUNK) == 0) ? 1 : -1];
+
+static Ota_HandleTypeDef Ota;
+
+/*CRC-32(多项式0x04C11DB7，反射)的半字节表*/
+static const uint32_t Ota_Crc_Table[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL,
+};
+
+/**
+ * @brief	计算CRC-32
+ * @details	与常见的zip/以太网CRC-32一致，逐个半字节查表(62KB映像约40ms)
+ * @param	pData 数据
+ * @param	Length 字节数
+ * @retval	CRC
+ */
+static uint32_t Ota_Crc32(const uint8_t *pData, uint32_t Length)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while (Length--)
+    {
+        crc ^= *pData++;
+        crc = (crc >> 4U) ^ Ota_Crc_Table[crc & 0x0FU];
+        crc = (crc >> 4U) ^ Ota_Crc_Table[crc & 0x0FU];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief	擦除一页
+ * @param	Page 页地址
+ * @retval	true 擦除成功
+ */
+static bool Ota_Erase(uint32_t Page)
+{
+    FLASH_EraseInitTypeDef erase = {.TypeErase = FLASH_TYPEERASE_PAGES, .PageAddress = Page, .NbPages = 1U};
+    uint32_t error = 0;
+    bool ok;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+    ok = (HAL_FLASHEx_Erase(&erase, &error) == HAL_OK) && (error == 0xFFFFFFFFUL);
+    HAL_FLASH_Lock();
+
+    return ok;
+}
+
+/**
+ * @brief	向flash写入字节串
+ * @details	按半字(小端)写入并读回校验，奇数长度时末字节补0xFF
+ * @param	Address 起始地址(半字对齐)
+ * @param	pData 数据
+ * @param	Length 字节数
+ * @retval	true 写入成功
+ */
+static bool Ota_Program(uint32_t Address, const uint8_t *pData, uint16_t Length)
+{
+    uint16_t data;
+    bool ok = true;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+    for (uint16_t i = 0; ok && (i < Length); i += 2U, Address += 2U)
+    {
+        data = pData[i] | (((i + 1U < Length) ? pData[i + 1U] : 0xFFU) << 8U);
+        ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, Address, data) == HAL_OK) &&
+             (*(__IO uint16_t *)Address == data);
+    }
+    HAL_FLASH_Lock();
+
+    return ok;
+}
+
+/**
+ * @brief	映像的块数
+ * @param	None
+ * @retval	块数
+ */
+static uint16_t Ota_Chunks(void)
+{
+    return (Ota.Length + OTA_CHUNK - 1U) / OTA_CHUNK;
+}
+
+/**
+ * @brief	开始接收新映像
+ * @details	只清除位图，B区的页在收到其中的第一块时再擦除，避免一次停顿过久
+ * @param	None
+ * @retval	None
+ */
+static void Ota_Restart(void)
+{
+    memset(Ota.Received, 0, sizeof(Ota.Received));
+    memset(Ota.Erased, 0, sizeof(Ota.Erased));
+    Ota.Missing = Ota_Chunks();
+}
+
+/**
+ * @brief	写入一块
+ * @details	全部块到齐后校验B区映像的CRC，错误时整个映像重新接收
+ * @param	Chunk 块号
+ * @param	pData 数据
+ * @param	Length 字节数
+ * @retval	None
+ */
+static void Ota_Store(uint16_t Chunk, const uint8_t *pData, uint16_t Length)
+{
+    uint32_t offset = (uint32_t)Chunk * OTA_CHUNK;
+    uint16_t page = offset / FLASH_PAGE_SIZE;
+
+    if (Ota.Received[Chunk >> 3U] & (1U << (Chunk & 0x07U)))
+    {
+        Ota.Stats.Dups++;
+        return;
+    }
+    if (!(Ota.Erased[page >> 3U] & (1U << (page & 0x07U))))
+    {
+        if (!Ota_Erase(OTA_SLOT_ADDR + (uint32_t)page * FLASH_PAGE_SIZE))
+        {
+            Ota.Stats.Flash_Errors++;
+            return;
+        }
+        Ota.Erased[page >> 3U] |= 1U << (page & 0x07U);
+    }
+    if (!Ota_Program(OTA_SLOT_ADDR + offset, pData, Length))
+    {
+        Ota.Stats.Flash_Errors++;
+        return;
+    }
+    Ota.Received[Chunk >> 3U] |= 1U << (Chunk & 0x07U);
+    Ota.Stats.Chunks++;
+    Ota.State = OTA_STATE_RECEIVING;
+    if (--Ota.Missing)
+    {
+        return;
+    }
+    if (Ota_Crc32((const uint8_t *)OTA_SLOT_ADDR, Ota.Length) == Ota.Crc)
+    {
+        Ota.State = OTA_STATE_VERIFIED;
+        return;
+    }
+    Ota.State = OTA_STATE_BAD;
+    Ota.Stats.Bad_Images++;
+    Ota_Restart();
+}
+
+/**
+ * @brief	写入映像描述并复位
+ * @details	由引导程序把B区拷贝到应用区，拷贝期间输出保持复位状态，之后按保持区恢复
+ * @param	None
+ * @retval	None
+ */
+static void Ota_Activate(void)
+{
+    uint32_t words[3] = {OTA_MAGIC, Ota.Length, Ota.Crc};
+    uint8_t info[14];
+
+    for (uint8_t i = 0; i < 12U; i++)
+    {
+        info[i] = (uint8_t)(words[i >> 2U] >> (8U * (i & 0x03U)));
+    }
+    info[12] = Ota.Version;
+    info[13] = Ota.Version >> 8U;
+    if (!Ota_Erase(OTA_INFO_ADDR) || !Ota_Program(OTA_INFO_ADDR, info, sizeof(info)))
+    {
+        Ota.Stats.Flash_Errors++;
+        return;
+    }
+    NVIC_SystemReset();
+}
+
+/**
+ * @brief	回送查询应答
+ * @param	handler Modbus句柄
+ * @param	From 起始块号
+ * @retval	None
+ */
+static void Ota_Status(ModbusRTUSlaveHandler handler, uint16_t From)
+{
+    mdU8 reply[9U + OTA_WINDOW / 8U] = {MODBUS_CODE_OTA, OTA_OP_STATUS};
+    uint16_t chunks = Ota_Chunks(), start = From & ~0x07U, chunk;
+
+    /*窗口从第一个缺块开始*/
+    while ((Ota.State != OTA_STATE_NONE) && Ota.Missing && (start < chunks) && (Ota.Received[start >> 3U] == 0xFFU))
+    {
+        start += 8U;
+    }
+    reply[2] = Ota.Session;
+    reply[3] = Ota.State;
+    reply[4] = Ota.Missing >> 8U;
+    reply[5] = Ota.Missing;
+    reply[6] = start >> 8U;
+    reply[7] = start;
+    for (uint16_t i = 0; (Ota.State != OTA_STATE_NONE) && (i < OTA_WINDOW); i++)
+    {
+        chunk = start + i;
+        if ((chunk < chunks) && !(Ota.Received[chunk >> 3U] & (1U << (chunk & 0x07U))))
+        {
+            reply[8U + (i >> 3U)] |= 1U << (i & 0x07U);
+        }
+    }
+    mdRTUReply(handler, reply, 8U + OTA_WINDOW / 8U);
+}
+
+/**
+ * @brief	处理固件分发功能码
+ * @details	在Modbus任务中执行；开始、数据及激活以广播地址发出，不应答，只有查询应答；
+ *			写入一块约2ms，首次写入一页时另有约20ms的擦除
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Ota_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count, length, crc;
+    mdU8 *p = &recbuf[2];
+    uint16_t chunk, n;
+
+    switch ((reclen >= 6U) ? p[0] : 0U)
+    {
+    case OTA_OP_BEGIN:
+        if (reclen != 16U)
+        {
+            break;
+        }
+        length = ((uint32_t)p[2] << 24U) | ((uint32_t)p[3] << 16U) | ((uint32_t)p[4] << 8U) | p[5];
+        crc = ((uint32_t)p[6] << 24U) | ((uint32_t)p[7] << 16U) | ((uint32_t)p[8] << 8U) | p[9];
+        /*开始帧重复发出，同一会话已在接收时不再清除*/
+        if ((length == 0) || (length > OTA_IMAGE_MAX) ||
+            ((Ota.State != OTA_STATE_NONE) && (Ota.Session == p[1]) && (Ota.Length == length) && (Ota.Crc == crc)))
+        {
+            break;
+        }
+        Ota.Session = p[1];
+        Ota.Length = length;
+        Ota.Crc = crc;
+        Ota.Version = ToU16(p[10], p[11]);
+        Ota.State = OTA_STATE_RECEIVING;
+        Ota_Restart();
+        break;
+    case OTA_OP_DATA:
+        chunk = ToU16(p[2], p[3]);
+        n = (chunk < Ota_Chunks()) ? (((Ota.Length - (uint32_t)chunk * OTA_CHUNK) < OTA_CHUNK)
+                                          ? (Ota.Length - (uint32_t)chunk * OTA_CHUNK)
+                                          : OTA_CHUNK)
+                                   : 0;
+        if ((Ota.State != OTA_STATE_NONE) && (Ota.State != OTA_STATE_VERIFIED) && (p[1] == Ota.Session) && n &&
+            (reclen == 8U + n))
+        {
+            Ota_Store(chunk, &p[4], n);
+        }
+        break;
+    case OTA_OP_STATUS:
+        if ((reclen == 8U) && (recbuf[0] != MODBUS_BROADCAST_ID))
+        {
+            Ota_Status(handler, ToU16(p[2], p[3]));
+            return;
+        }
+        break;
+    case OTA_OP_ACTIVATE:
+        if ((reclen == 6U) && (p[1] == Ota.Session) && (Ota.State == OTA_STATE_VERIFIED))
+        {
+            Ota_Activate();
+        }
+        break;
+    default:
+        break;
+    }
+    if (recbuf[0] != MODBUS_BROADCAST_ID)
+    {
+        mdRTUReplyException(handler, MODBUS_EXCEPTION_VALUE);
+    }
+}
+
+/**
+ * @brief	注册固件分发功能码
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Ota_Init(ModbusRTUSlaveHandler handler)
+{
+    if (handler)
+    {
+        mdRTURegisterCode(handler, MODBUS_CODE_OTA, Ota_Handle);
+    }
+}
+
+/**
+ * @brief	打印接收状态及统计
+ * @param	None
+ * @retval	None
+ */
+void Ota_Show(void)
+{
+    static const char *const states[] = {"none", "receiving", "verified", "bad"};
+    Ota_Stats *pO = &Ota.Stats;
+
+    shellPrint(&shell, "session = %d, state = %s, version = %d, length = %u, crc = 0x%08x, missing = %d/%d\r\n",
+               Ota.Session, states[Ota.State], Ota.Version, Ota.Length, Ota.Crc, Ota.Missing, Ota_Chunks());
+    shellPrint(&shell, "chunks = %u, dups = %u, flash errors = %u, bad images = %u, pending install = %d\r\n",
+               pO->Chunks, pO->Dups, pO->Flash_Errors, pO->Bad_Images,
+               *(__IO uint32_t *)OTA_INFO_ADDR == OTA_MAGIC);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), ota, Ota_Show, show firmware update);
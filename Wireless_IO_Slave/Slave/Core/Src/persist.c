@@ -0,0 +1,120 @@
+#include "persist.h"
+#include "kv.h"
+#include "shell_port.h"
+#include "cmsis_os.h"
+#include "mdcodec.h"
+
+#if (PERSIST_REGS * 2U > KV_VALUE_MAX) || (PERSIST_REGS > 16U)
+#error "PERSIST_REGS exceeds one parameter record"
+#endif
+
+extern osThreadId persistHandle;
+static Persist_HandleTypeDef Persist;
+
+/**
+ * @brief	初始化掉电保持区
+ * @details	在 ModbusInit() 之后、输出任务启动之前调用，把flash中的配置映像装入保持寄存器；
+ *			从未保存过时保持寄存器的默认值不变，旧版本保存的较短映像只覆盖其中的寄存器
+ * @param	None
+ * @retval	None
+ */
+void Persist_Init(void)
+{
+    mdU16 image[PERSIST_REGS] = {0};
+    uint16_t size;
+
+    Kv_Init();
+    mdhandler->registerPool->ops->mdReadHoldRegisters(mdhandler->registerPool, PERSIST_START_ADDR, PERSIST_REGS, image);
+    size = Kv_Get(KV_KEY_HOLD, image, sizeof(image));
+    if ((size >= sizeof(mdU16)) && (size <= sizeof(image)))
+    {
+        mdhandler->registerPool->ops->mdWriteHoldRegisters(mdhandler->registerPool, PERSIST_START_ADDR, PERSIST_REGS, image);
+    }
+    mdCodecReplyTo(image[REPLY_ADDR_ADDR - PERSIST_START_ADDR], (mdU8)image[REPLY_CHANNEL_ADDR - PERSIST_START_ADDR]);
+}
+
+/**
+ * @brief	保持寄存器写入通知
+ * @details	由Modbus接收任务在写入寄存器池后调用，只标记脏位并唤醒写回任务，不访问flash
+ * @param	handler 句柄
+ * @param	addr 起始寄存器地址
+ * @param	length 寄存器数
+ * @retval	None
+ */
+void Persist_Notify(ModbusRTUSlaveHandler handler, mdU16 addr, mdU16 length)
+{
+    mdU32 first = addr, last = (mdU32)addr + length;
+
+    UNUSED(handler);
+    if ((last <= PERSIST_START_ADDR) || (first >= PERSIST_START_ADDR + PERSIST_REGS))
+    {
+        return;
+    }
+    first = (first < PERSIST_START_ADDR) ? 0U : first - PERSIST_START_ADDR;
+    last = (last > PERSIST_START_ADDR + PERSIST_REGS) ? PERSIST_REGS : last - PERSIST_START_ADDR;
+    taskENTER_CRITICAL();
+    for (; first < last; first++)
+    {
+        Persist.Dirty |= (uint16_t)(1U << first);
+    }
+    Persist.Tick = HAL_GetTick();
+    taskEXIT_CRITICAL();
+    if (persistHandle)
+    {
+        osSignalSet(persistHandle, PERSIST_SIGNAL);
+    }
+}
+
+/**
+ * @brief	延迟写回掉电保持区
+ * @details	最后一次写入后静止 PERSIST_DELAY 才写入，连续的配置写入只产生一条flash记录；
+ *			内容与已保存的记录相同时 Kv_Set() 不写flash
+ * @param	None
+ * @retval	距下次须检查的时间(ms)，osWaitForever:无待写回的寄存器
+ */
+uint32_t Persist_Poll(void)
+{
+    mdU16 image[PERSIST_REGS] = {0};
+    uint32_t elapsed;
+
+    taskENTER_CRITICAL();
+    elapsed = HAL_GetTick() - Persist.Tick;
+    if (Persist.Dirty == 0U)
+    {
+        taskEXIT_CRITICAL();
+        return osWaitForever;
+    }
+    if (elapsed < PERSIST_DELAY)
+    {
+        taskEXIT_CRITICAL();
+        return PERSIST_DELAY - elapsed;
+    }
+    /*读取前清除脏位，写回期间新的写入会再次标记*/
+    Persist.Dirty = 0;
+    taskEXIT_CRITICAL();
+    mdhandler->registerPool->ops->mdReadHoldRegisters(mdhandler->registerPool, PERSIST_START_ADDR, PERSIST_REGS, image);
+    /*写入应答早已发出，此时切换应答地址及信道*/
+    mdCodecReplyTo(image[REPLY_ADDR_ADDR - PERSIST_START_ADDR], (mdU8)image[REPLY_CHANNEL_ADDR - PERSIST_START_ADDR]);
+    if (Kv_Set(KV_KEY_HOLD, image, sizeof(image)))
+    {
+        Persist.Writes++;
+    }
+    else
+    {
+        Persist.Errors++;
+    }
+
+    return osWaitForever;
+}
+
+/**
+ * @brief	打印掉电保持区状态
+ * @param	None
+ * @retval	None
+ */
+void Persist_Show(void)
+{
+    shellPrint(&shell, "range = 0x%02x..0x%02x, dirty = 0x%04x, writes = %d, errors = %d\r\n", PERSIST_START_ADDR,
+               PERSIST_START_ADDR + PERSIST_REGS - 1U, Persist.Dirty, Persist.Writes, Persist.Errors);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), persist, Persist_Show, show persistent holding registers);
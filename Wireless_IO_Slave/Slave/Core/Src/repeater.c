@@ -0,0 +1,132 @@
+#include "repeater.h"
+#include "kv.h"
+#include "shell_port.h"
+#include "string.h"
+
+typedef char Repeater_Size_Check[(sizeof(Repeater_Entry) * MODBUS_FORWARDS <= KV_VALUE_MAX) ? 1 : -1];
+
+static Repeater_Entry Repeater[MODBUS_FORWARDS];
+
+/**
+ * @brief	按转发表登记协议栈的中继转发
+ * @param	None
+ * @retval	None
+ */
+static void Repeater_Apply(void)
+{
+    mdRTUClearForwards(mdhandler);
+    for (uint8_t i = 0; i < MODBUS_FORWARDS; i++)
+    {
+        if (Repeater[i].Id != 0U)
+        {
+            mdRTUAddForward(mdhandler, Repeater[i].Id, Repeater[i].Addr, Repeater[i].Channel);
+        }
+    }
+}
+
+/**
+ * @brief	加载中继转发表
+ * @details	在 Persist_Init() 之后调用(参数区已初始化)；从未配置时本站不转发
+ * @param	None
+ * @retval	None
+ */
+void Repeater_Init(void)
+{
+    if (Kv_Get(KV_KEY_FORWARD, Repeater, sizeof(Repeater)) != sizeof(Repeater))
+    {
+        memset(Repeater, 0, sizeof(Repeater));
+    }
+    Repeater_Apply();
+}
+
+/**
+ * @brief	设置一条转发项
+ * @details	本站作为中继时，主站把远端从站的请求发往本站节点，本站转发给下游节点并回传其应答；
+ *			下游从站的应答地址及信道寄存器须设为本站节点
+ * @param	index 表项号
+ * @param	id 下游从站号，0:删除该项
+ * @param	addr 下游节点L101地址
+ * @param	channel 下游节点信道
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Repeater_Set(int index, int id, int addr, int channel)
+{
+    if ((index < 0) || (index >= (int)MODBUS_FORWARDS) || (id < 0) || (id > (int)MODBUS_UNIT_ID_MAX) ||
+        (addr < 0) || (addr > 0xFFFF) || (channel < 0) || (channel > 0xFF) || (mdRTUFindUnit(mdhandler, id) != NULL))
+    {
+        return 0xFF;
+    }
+    Repeater[index].Id = id;
+    Repeater[index].Addr = addr;
+    Repeater[index].Channel = channel;
+    Repeater_Apply();
+
+    return Kv_Set(KV_KEY_FORWARD, Repeater, sizeof(Repeater)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), repeater_set, Repeater_Set, set repeater index id addr channel);
+
+/**
+ * @brief	取出整个转发表
+ * @details	供分块传输读取(与参数区中保存的格式相同)
+ * @param	pBuf 缓冲区
+ * @param	Size 缓冲区字节数
+ * @retval	转发表字节数，缓冲区不足时为0
+ */
+uint16_t Repeater_Read(void *pBuf, uint16_t Size)
+{
+    if (Size < sizeof(Repeater))
+    {
+        return 0;
+    }
+    memcpy(pBuf, Repeater, sizeof(Repeater));
+
+    return sizeof(Repeater);
+}
+
+/**
+ * @brief	替换整个转发表
+ * @details	供分块传输写入；任一表项的站号为本站单元时整表拒绝
+ * @param	pBuf 转发表
+ * @param	Size 字节数
+ * @retval	true 已生效并保存
+ */
+bool Repeater_Write(const void *pBuf, uint16_t Size)
+{
+    const Repeater_Entry *pE = (const Repeater_Entry *)pBuf;
+
+    if (Size != sizeof(Repeater))
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < MODBUS_FORWARDS; i++)
+    {
+        if ((pE[i].Id > MODBUS_UNIT_ID_MAX) || ((pE[i].Id != 0U) && (mdRTUFindUnit(mdhandler, pE[i].Id) != NULL)))
+        {
+            return false;
+        }
+    }
+    memcpy(Repeater, pBuf, sizeof(Repeater));
+    Repeater_Apply();
+
+    return Kv_Set(KV_KEY_FORWARD, Repeater, sizeof(Repeater));
+}
+
+/**
+ * @brief	打印中继转发表及统计
+ * @param	None
+ * @retval	None
+ */
+void Repeater_Show(void)
+{
+    struct ModbusRTUForward *pF = NULL;
+
+    for (uint32_t i = 0; i < mdhandler->forwardCount; i++)
+    {
+        pF = &mdhandler->forwards[i];
+        shellPrint(&shell, "[%d] id = %d, addr = 0x%04x, ch = %d%s\r\n", i, pF->id, pF->addr, pF->channel,
+                   pF->waiting ? " (waiting)" : "");
+    }
+    shellPrint(&shell, "forwarded = %u, returned = %u, timeout = %u, timeout_ms = %d\r\n", mdhandler->forwarded,
+               mdhandler->returned, mdhandler->forwardTimeouts, MODBUS_FORWARD_TIMEOUT);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), repeater, Repeater_Show, show repeater table);
@@ -0,0 +1,274 @@
+#include "scene.h"
+#include "kv.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_SCENE)
+typedef char Scene_Coil_Check[(EXTERN_OUTPUT_MAX <= 16U) ? 1 : -1];
+typedef char Scene_Size_Check[(sizeof(Scene_Entry) <= KV_VALUE_MAX) ? 1 : -1];
+typedef char Scene_Key_Check[(KV_KEY_SCENE + SCENE_MAX <= KV_KEY_NONE) ? 1 : -1];
+
+static Scene_HandleTypeDef Scene = {.Last = 0xFFU};
+
+/**
+ * @brief	场景是否已定义
+ * @param	pEntry 场景
+ * @retval	true 至少包含一路输出
+ */
+static bool Scene_Defined(const Scene_Entry *pEntry)
+{
+    return (pEntry->Coil_Mask != 0U) || (pEntry->Aout_Mask != 0U);
+}
+
+/**
+ * @brief	处理场景功能码
+ * @details	在Modbus任务中执行，与主站的线圈写入同一上下文，场景内的输出不会与其他写入交错
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Scene_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    bool broadcast = (recbuf[0] == MODBUS_BROADCAST_ID);
+
+    if (handler->receiveBuffer->count != 5U)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    if (!Scene_Apply(handler, recbuf[2]))
+    {
+        if (!broadcast)
+        {
+            mdRTUReplyException(handler, MODBUS_EXCEPTION_VALUE);
+        }
+        return;
+    }
+    /*广播请求不应答*/
+    if (!broadcast)
+    {
+        mdRTUReply(handler, &recbuf[1], 2U);
+    }
+}
+
+/**
+ * @brief	加载场景表并注册场景功能码
+ * @details	在 Persist_Init() 之后调用(参数区已初始化)；未保存的场景为未定义
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Scene_Init(ModbusRTUSlaveHandler handler)
+{
+    for (uint8_t i = 0; i < SCENE_MAX; i++)
+    {
+        if (Kv_Get(KV_KEY_SCENE + i, &Scene.Table[i], sizeof(Scene_Entry)) != sizeof(Scene_Entry))
+        {
+            memset(&Scene.Table[i], 0, sizeof(Scene_Entry));
+        }
+    }
+    if (handler)
+    {
+        mdRTURegisterCode(handler, MODBUS_CODE_SCENE, Scene_Handle);
+    }
+}
+
+/**
+ * @brief	执行场景
+ * @details	在Modbus任务中调用；先在寄存器池中一次写入全部输出线圈及模拟量寄存器，再经写入通知
+ *			唤醒输出任务，由其按端口一次写入全部继电器(同 FC15)，模拟量按配置的斜率输出
+ * @param	handler Modbus句柄
+ * @param	Index 场景号
+ * @retval	false 场景号越界或未定义
+ */
+bool Scene_Apply(ModbusRTUSlaveHandler handler, uint8_t Index)
+{
+    RegisterPoolHandle regPool = handler->registerPool;
+    mdU8 coils[(EXTERN_OUTPUT_MAX + 7U) / 8U] = {0};
+    const Scene_Entry *pEntry;
+    mdU16 mask;
+
+    if ((Index >= SCENE_MAX) || !Scene_Defined(&Scene.Table[Index]))
+    {
+        Scene.Stats.Rejected++;
+        return false;
+    }
+    pEntry = &Scene.Table[Index];
+    mask = pEntry->Coil_Mask & (mdU16)((1UL << EXTERN_OUTPUT_MAX) - 1UL);
+    if (mask)
+    {
+        regPool->ops->mdReadCoilsPacked(regPool, DIGITAL_OUTPUT_START_ADDR, EXTERN_OUTPUT_MAX, coils);
+        for (uint16_t i = 0; i < EXTERN_OUTPUT_MAX; i++)
+        {
+            if ((mask >> i) & 0x01U)
+            {
+                coils[i / 8U] = (mdU8)((coils[i / 8U] & ~(1U << (i % 8U))) | (((pEntry->Coil_Value >> i) & 0x01U) << (i % 8U)));
+            }
+        }
+        regPool->ops->mdWriteCoilsPacked(regPool, DIGITAL_OUTPUT_START_ADDR, EXTERN_OUTPUT_MAX, coils);
+        if (handler->mdRTUCoilWritten != NULL)
+        {
+            handler->mdRTUCoilWritten(handler, DIGITAL_OUTPUT_START_ADDR, EXTERN_OUTPUT_MAX);
+        }
+    }
+    for (uint16_t i = 0; i < SCENE_AOUT_MAX; i++)
+    {
+        if (!((pEntry->Aout_Mask >> i) & 0x01U))
+        {
+            continue;
+        }
+        regPool->ops->mdWriteHoldRegisters(regPool, ANALOG_OUTPUT_START_ADDR + i, 1U, (mdU16 *)&pEntry->Aout[i]);
+        if (handler->mdRTUHoldWritten != NULL)
+        {
+            handler->mdRTUHoldWritten(handler, ANALOG_OUTPUT_START_ADDR + i, 1U);
+        }
+    }
+    Scene.Last = Index;
+    Scene.Stats.Applied++;
+
+    return true;
+}
+
+/**
+ * @brief	取出场景的输出线圈
+ * @details	只读场景表，可在中断中调用(快速输出)
+ * @param	Index 场景号
+ * @param	pMask 场景包含的输出，第i位对应输出i
+ * @param	pBits 各输出的状态
+ * @retval	false 场景号越界或未定义
+ */
+bool Scene_Coils(uint8_t Index, uint32_t *pMask, uint32_t *pBits)
+{
+    if ((Index >= SCENE_MAX) || !Scene_Defined(&Scene.Table[Index]))
+    {
+        return false;
+    }
+    *pMask = Scene.Table[Index].Coil_Mask & (uint32_t)((1UL << EXTERN_OUTPUT_MAX) - 1UL);
+    *pBits = Scene.Table[Index].Coil_Value;
+
+    return true;
+}
+
+/**
+ * @brief	取出场景表(传输格式)
+ * @details	供分块传输读取
+ * @param	pBuf 缓冲区
+ * @param	Size 缓冲区字节数
+ * @retval	字节数，缓冲区不足时为0
+ */
+uint16_t Scene_Read(uint8_t *pBuf, uint16_t Size)
+{
+    uint16_t len = 0;
+
+    if (Size < SCENE_TABLE_SIZE)
+    {
+        return 0;
+    }
+    for (uint8_t i = 0; i < SCENE_MAX; i++)
+    {
+        const Scene_Entry *pEntry = &Scene.Table[i];
+
+        pBuf[len++] = HIGH(pEntry->Coil_Mask);
+        pBuf[len++] = LOW(pEntry->Coil_Mask);
+        pBuf[len++] = HIGH(pEntry->Coil_Value);
+        pBuf[len++] = LOW(pEntry->Coil_Value);
+        pBuf[len++] = pEntry->Aout_Mask;
+        pBuf[len++] = 0;
+        for (uint8_t j = 0; j < SCENE_AOUT_MAX; j++)
+        {
+            pBuf[len++] = HIGH(pEntry->Aout[j]);
+            pBuf[len++] = LOW(pEntry->Aout[j]);
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief	替换整个场景表
+ * @details	供分块传输写入；只有内容变化的场景写入flash(Kv_Set() 对相同内容不写入)
+ * @param	pBuf 场景表(传输格式)
+ * @param	Size 字节数
+ * @retval	true 已生效并保存
+ */
+bool Scene_Write(const uint8_t *pBuf, uint16_t Size)
+{
+    bool ok = true;
+
+    if (Size != SCENE_TABLE_SIZE)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < SCENE_MAX; i++, pBuf += SCENE_WIRE_SIZE)
+    {
+        Scene_Entry *pEntry = &Scene.Table[i];
+
+        pEntry->Coil_Mask = ToU16(pBuf[0], pBuf[1]);
+        pEntry->Coil_Value = ToU16(pBuf[2], pBuf[3]);
+        pEntry->Aout_Mask = pBuf[4];
+        pEntry->Reserved = 0;
+        for (uint8_t j = 0; j < SCENE_AOUT_MAX; j++)
+        {
+            pEntry->Aout[j] = ToU16(pBuf[6U + 2U * j], pBuf[7U + 2U * j]);
+        }
+        if (!Kv_Set(KV_KEY_SCENE + i, pEntry, sizeof(Scene_Entry)))
+        {
+            Scene.Stats.Errors++;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief	设置一个场景
+ * @details	掩码都为0时清除该场景
+ * @param	index 场景号
+ * @param	coil_mask 线圈掩码
+ * @param	coil_value 线圈值
+ * @param	aout_mask 模拟量掩码
+ * @param	aout0 模拟量0(12bit码值)
+ * @param	aout1 模拟量1(12bit码值)
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Scene_Set(int index, int coil_mask, int coil_value, int aout_mask, int aout0, int aout1)
+{
+    Scene_Entry entry = {0};
+
+    if ((index < 0) || (index >= (int)SCENE_MAX) || (coil_mask < 0) || (coil_mask > 0xFFFF) || (coil_value < 0) ||
+        (coil_value > 0xFFFF) || (aout_mask < 0) || (aout_mask >= (1 << SCENE_AOUT_MAX)) || (aout0 < 0) ||
+        (aout0 > 0xFFFF) || (aout1 < 0) || (aout1 > 0xFFFF))
+    {
+        return 0xFF;
+    }
+    entry.Coil_Mask = coil_mask;
+    entry.Coil_Value = coil_value;
+    entry.Aout_Mask = aout_mask;
+    entry.Aout[0] = aout0;
+    entry.Aout[1] = aout1;
+    Scene.Table[index] = entry;
+
+    return Kv_Set(KV_KEY_SCENE + index, &entry, sizeof(entry)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene_set, Scene_Set, set scene index coil_mask coil_value aout_mask aout0 aout1);
+
+/**
+ * @brief	打印场景表及统计
+ * @param	None
+ * @retval	None
+ */
+void Scene_Show(void)
+{
+    for (uint8_t i = 0; i < SCENE_MAX; i++)
+    {
+        const Scene_Entry *pEntry = &Scene.Table[i];
+
+        if (Scene_Defined(pEntry))
+        {
+            shellPrint(&shell, "[%d] coils = 0x%04x/0x%04x, aout = 0x%x: %u %u\r\n", i, pEntry->Coil_Value,
+                       pEntry->Coil_Mask, pEntry->Aout_Mask, pEntry->Aout[0], pEntry->Aout[1]);
+        }
+    }
+    shellPrint(&shell, "last = %d, applied = %u, rejected = %u, errors = %u\r\n", (Scene.Last == 0xFFU) ? -1 : Scene.Last,
+               Scene.Stats.Applied, Scene.Stats.Rejected, Scene.Stats.Errors);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), scene, Scene_Show, show scenes);
+#endif
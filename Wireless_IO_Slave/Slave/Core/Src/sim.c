@@ -0,0 +1,175 @@
+#include "sim.h"
+#include "kv.h"
+#include "supervisor.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_SIMULATOR)
+typedef char Sim_Size_Check[(sizeof(Sim_Config) <= KV_VALUE_MAX) ? 1 : -1];
+
+static Sim_HandleTypeDef Sim;
+
+/**
+ * @brief	取得随机数
+ * @details	xorshift32，与 Mac_Random() 相同
+ * @param	None
+ * @retval	随机数
+ */
+static uint32_t Sim_Random(void)
+{
+    uint32_t x = Sim.Seed;
+
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    Sim.Seed = x;
+
+    return x;
+}
+
+/**
+ * @brief	模拟范围内的请求在执行前按配置丢弃或延迟
+ * @details	在Modbus任务中调用(协议栈的 mdRTURequest)；延迟期间后续帧留在接收环中，
+ *			与处理较慢的真实从站相同，延迟后补一次心跳
+ * @param	handler Modbus句柄
+ * @param	id 请求的站号
+ * @retval	mdFALSE 丢弃该请求
+ */
+static mdBOOL Sim_Request(ModbusRTUSlaveHandler handler, mdU8 id)
+{
+    uint8_t unit = (uint8_t)(id - Sim.Cfg.Base);
+    uint32_t wait;
+
+    UNUSED(handler);
+    /*模拟范围以外的站号(本站的其他逻辑单元)照常处理*/
+    if (unit >= Sim.Cfg.Count)
+    {
+        return mdTRUE;
+    }
+    Sim.Requests[unit]++;
+    if ((Sim_Random() % 1000U) < Sim.Cfg.Drop)
+    {
+        Sim.Drops[unit]++;
+        return mdFALSE;
+    }
+    wait = Sim.Cfg.Delay + (Sim.Cfg.Jitter ? (Sim_Random() % (Sim.Cfg.Jitter + 1U)) : 0);
+    if (wait)
+    {
+        osDelay(wait);
+        Supervisor_Checkin(Supervisor_Self());
+    }
+    return mdTRUE;
+}
+
+/**
+ * @brief	按配置登记模拟的站号
+ * @param	Enable true:映射到主单元 false:取消映射
+ * @retval	None
+ */
+static void Sim_Apply(bool Enable)
+{
+    for (uint8_t i = 0; i < Sim.Cfg.Count; i++)
+    {
+        mdRTUAliasUnit(mdhandler, (uint8_t)(Sim.Cfg.Base + i), Enable ? mdTRUE : mdFALSE);
+    }
+}
+
+/**
+ * @brief	从站模拟器初始化
+ * @details	在 Repeater_Init() 之后调用，已登记为转发的站号不被模拟；从未配置时不模拟
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Sim_Init(ModbusRTUSlaveHandler handler)
+{
+    Sim.Seed = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2();
+    Sim.Seed = Sim.Seed ? Sim.Seed : 1U;
+    if ((Kv_Get(KV_KEY_SIM, &Sim.Cfg, sizeof(Sim.Cfg)) != sizeof(Sim.Cfg)) || (Sim.Cfg.Count > SIM_UNITS_MAX))
+    {
+        memset(&Sim.Cfg, 0, sizeof(Sim.Cfg));
+    }
+    if (handler)
+    {
+        handler->mdRTURequest = Sim_Request;
+        Sim_Apply(true);
+    }
+}
+
+/**
+ * @brief	设置模拟的站号范围
+ * @details	立即生效并保存；范围内已属于其他逻辑单元或转发表的站号不被模拟
+ * @param	base 首个站号
+ * @param	count 逻辑从站数，0:不模拟
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Sim_Set_Units(int base, int count)
+{
+    if ((base <= 0) || (count < 0) || (count > (int)SIM_UNITS_MAX) || (base + count - 1 > (int)MODBUS_UNIT_ID_MAX) ||
+        (mdhandler == NULL))
+    {
+        return 0xFF;
+    }
+    Sim_Apply(false);
+    Sim.Cfg.Base = (uint8_t)base;
+    Sim.Cfg.Count = (uint8_t)count;
+    Sim_Clear();
+    Sim_Apply(true);
+    return Kv_Set(KV_KEY_SIM, &Sim.Cfg, sizeof(Sim.Cfg)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), sim_units, Sim_Set_Units, set simulated slaves base count);
+
+/**
+ * @brief	设置应答延迟及丢弃概率
+ * @param	delay 最短应答延迟(ms)
+ * @param	jitter 随机附加的延迟上限(ms)
+ * @param	drop 丢弃概率(‰)
+ * @retval	0 成功 0xFF 参数错误或保存失败
+ */
+uint8_t Sim_Set_Reply(int delay, int jitter, int drop)
+{
+    if ((delay < 0) || (jitter < 0) || (delay + jitter > (int)SIM_DELAY_MAX) || (drop < 0) ||
+        (drop > (int)SIM_DROP_MAX))
+    {
+        return 0xFF;
+    }
+    Sim.Cfg.Delay = (uint16_t)delay;
+    Sim.Cfg.Jitter = (uint16_t)jitter;
+    Sim.Cfg.Drop = (uint16_t)drop;
+    return Kv_Set(KV_KEY_SIM, &Sim.Cfg, sizeof(Sim.Cfg)) ? 0 : 0xFF;
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), sim_reply, Sim_Set_Reply, set simulated delay jitter drop);
+
+/**
+ * @brief	打印模拟配置及各逻辑从站的请求数
+ * @param	None
+ * @retval	None
+ */
+void Sim_Show(void)
+{
+    uint32_t requests = 0, drops = 0;
+
+    shellPrint(&shell, "base = %d, count = %d, delay = %u+%u ms, drop = %u\r\n", Sim.Cfg.Base, Sim.Cfg.Count,
+               Sim.Cfg.Delay, Sim.Cfg.Jitter, Sim.Cfg.Drop);
+    for (uint8_t i = 0; i < Sim.Cfg.Count; i++)
+    {
+        shellPrint(&shell, "[%d] id = %d, requests = %u, drops = %u\r\n", i, Sim.Cfg.Base + i, Sim.Requests[i],
+                   Sim.Drops[i]);
+        requests += Sim.Requests[i];
+        drops += Sim.Drops[i];
+    }
+    shellPrint(&shell, "total requests = %u, drops = %u\r\n", requests, drops);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), sim, Sim_Show, show simulated slaves);
+
+/**
+ * @brief	清除各逻辑从站的请求数
+ * @param	None
+ * @retval	None
+ */
+void Sim_Clear(void)
+{
+    memset(Sim.Requests, 0, sizeof(Sim.Requests));
+    memset(Sim.Drops, 0, sizeof(Sim.Drops));
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), sim_clear, Sim_Clear, clear simulated slave counters);
+#endif
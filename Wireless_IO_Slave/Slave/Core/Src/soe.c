@@ -0,0 +1,240 @@
+#include "soe.h"
+#include "timesync.h"
+#include "extlog.h"
+#include "shell_port.h"
+
+typedef char Soe_Extlog_Check[(sizeof(Soe_Event) <= EXTLOG_DATA_MAX(EXTLOG_SLOT_SOE)) ? 1 : -1];
+
+static Soe_HandleTypeDef Soe;
+
+/*静态函数声明*/
+static void Soe_Export(void);
+
+/**
+ * @brief	初始化事件顺序记录
+ * @details	在输入采集开始前调用，序号先从1起编号，外部日志的序号恢复后由 Soe_Resume() 接续；
+ *			Pool 不为 NULL 时，每次记录后把最新事件导出到其输入寄存器
+ * @param	Pool 寄存器池
+ * @retval	None
+ */
+void Soe_Init(RegisterPoolHandle Pool)
+{
+    Soe.Sequence = 0;
+    Soe.First = 1U;
+    Soe.Resumed = false;
+    Soe.Pool = Pool;
+}
+
+/**
+ * @brief	翻转RAM环的一段
+ * @param	From 起始位置
+ * @param	To 结束位置(含)
+ * @retval	None
+ */
+static void Soe_Reverse(uint8_t From, uint8_t To)
+{
+    Soe_Event event;
+
+    for (; From < To; From++, To--)
+    {
+        event = Soe.Log[From];
+        Soe.Log[From] = Soe.Log[To];
+        Soe.Log[To] = event;
+    }
+}
+
+/**
+ * @brief	接续外部日志的序号
+ * @details	在 Extlog_Recover() 之后调用一次：已记录的事件序号整体加上日志中最新的序号(环中位置随之
+ *			循环右移，三次翻转原地完成)，随后补写入外部日志，之后的事件由 Soe_Record() 直接写入
+ * @param	None
+ * @retval	None
+ */
+void Soe_Resume(void)
+{
+    uint32_t latest = Extlog_Latest(EXTLOG_AREA_SOE), primask = __get_PRIMASK(), first, last;
+    uint8_t shift = (uint8_t)(latest % SOE_LOG_SIZE);
+    Soe_Event event;
+
+    __disable_irq();
+    if (shift)
+    {
+        Soe_Reverse(0, SOE_LOG_SIZE - 1U);
+        Soe_Reverse(0, shift - 1U);
+        Soe_Reverse(shift, SOE_LOG_SIZE - 1U);
+    }
+    for (uint8_t i = 0; i < SOE_LOG_SIZE; i++)
+    {
+        Soe.Log[i].Sequence += Soe.Log[i].Sequence ? latest : 0U;
+    }
+    last = Soe.Sequence += latest;
+    Soe.First = latest + 1U;
+    Soe.Resumed = true;
+    __set_PRIMASK(primask);
+
+    /*RAM环中已被覆盖的早期事件无从补写*/
+    first = (last - latest > SOE_LOG_SIZE) ? last - SOE_LOG_SIZE + 1U : latest + 1U;
+    for (uint32_t seq = first; seq <= last; seq++)
+    {
+        if (Soe_Read(seq, &event))
+        {
+            Extlog_Write(EXTLOG_AREA_SOE, seq, &event, sizeof(event));
+        }
+    }
+    if (Soe.Pool && last)
+    {
+        Soe_Export();
+    }
+}
+
+/**
+ * @brief	取得当前时刻
+ * @details	关中断后调用；毫秒取内核节拍(低功耗空闲时TIM1时基停止)，毫秒内时间取自SysTick，
+ *			SysTick已回绕而节拍中断尚未执行时补偿1ms
+ * @param	pTick 毫秒时刻
+ * @param	pUs 毫秒内微秒数
+ * @retval	None
+ */
+static void Soe_Timestamp(uint32_t *pTick, uint16_t *pUs)
+{
+    uint32_t tick = HAL_GetTick();
+    uint16_t us = (uint16_t)((SysTick->LOAD - SysTick->VAL) / (SystemCoreClock / 1000000U));
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && (us < 500U))
+    {
+        tick++;
+    }
+    *pTick = tick;
+    *pUs = us;
+}
+
+/**
+ * @brief	把最新的事件导出到输入寄存器
+ * @details	最新事件在前，不足 SOE_REG_EVENTS 条的位置填0
+ * @param	None
+ * @retval	None
+ */
+static void Soe_Export(void)
+{
+    mdU16 regs[SOE_REG_SIZE] = {0};
+    mdU16 *pReg = &regs[2];
+    uint32_t latest = Soe.Sequence;
+    Soe_Event event;
+
+    regs[0] = (mdU16)latest;
+    regs[1] = (mdU16)((latest < SOE_LOG_SIZE) ? latest : SOE_LOG_SIZE);
+    for (uint32_t i = 0; i < SOE_REG_EVENTS; i++, pReg += SOE_REG_EVENT_SIZE)
+    {
+        if (!Soe_Read(latest - i, &event))
+        {
+            break;
+        }
+        pReg[0] = (mdU16)event.Sequence;
+        pReg[1] = (mdU16)(((mdU16)event.Point << 8U) | event.Value);
+        pReg[2] = (mdU16)(event.Tick >> 16U);
+        pReg[3] = (mdU16)event.Tick;
+        pReg[4] = event.Us;
+    }
+    Soe.Pool->ops->mdWriteInputRegisters(Soe.Pool, SOE_REG_START_ADDR, SOE_REG_SIZE, regs);
+}
+
+/**
+ * @brief	记录一个变位事件
+ * @details	时刻在关中断期间取得，事件顺序与序号一致；已与主站同步时换算为主站时间；在任务中调用
+ * @param	Point 点号
+ * @param	Value 新电平
+ * @retval	None
+ */
+void Soe_Record(uint8_t Point, uint8_t Value)
+{
+    uint32_t primask = __get_PRIMASK();
+    Soe_Event *pEvent, event;
+    bool log;
+
+    __disable_irq();
+    pEvent = &Soe.Log[++Soe.Sequence % SOE_LOG_SIZE];
+    pEvent->Sequence = Soe.Sequence;
+    Soe_Timestamp(&pEvent->Tick, &pEvent->Us);
+    pEvent->Point = Point;
+    pEvent->Value = Value;
+    if (Timesync_Convert(pEvent->Tick, pEvent->Us, &pEvent->Tick, &pEvent->Us))
+    {
+        pEvent->Value |= SOE_VALUE_SYNCED;
+    }
+    event = *pEvent;
+    log = Soe.Resumed;
+    __set_PRIMASK(primask);
+
+    /*按事件的序号写入外部日志，写入队列满时只保留在RAM环中；接续序号前的事件由 Soe_Resume() 补写*/
+    if (log)
+    {
+        Extlog_Write(EXTLOG_AREA_SOE, event.Sequence, &event, sizeof(event));
+    }
+    if (Soe.Pool)
+    {
+        Soe_Export();
+    }
+}
+
+/**
+ * @brief	读取一条事件记录
+ * @details	RAM环中没有的记录从外部日志读取(在任务中调用)
+ * @param	Sequence 序号
+ * @param	pEvent 事件记录
+ * @retval	false:序号尚未记录或已被覆盖
+ */
+bool Soe_Read(uint32_t Sequence, Soe_Event *pEvent)
+{
+    uint32_t primask = __get_PRIMASK();
+    bool ret = false;
+
+    __disable_irq();
+    if ((Sequence >= Soe.First) && (Sequence <= Soe.Sequence) && (Soe.Sequence - Sequence < SOE_LOG_SIZE))
+    {
+        *pEvent = Soe.Log[Sequence % SOE_LOG_SIZE];
+        ret = true;
+    }
+    __set_PRIMASK(primask);
+    return ret || ((Sequence <= Soe.Sequence) && Extlog_Read(EXTLOG_AREA_SOE, Sequence, pEvent, sizeof(*pEvent)));
+}
+
+/**
+ * @brief	最新事件的序号
+ * @details
+ * @param	None
+ * @retval	0:尚无记录
+ */
+uint32_t Soe_Latest(void)
+{
+    return Soe.Sequence;
+}
+
+/**
+ * @brief	打印事件顺序记录
+ * @details	由旧到新打印最近 count 条记录，count 不大于0时打印全部(含外部日志中的记录)
+ * @param	count 条数
+ * @retval	None
+ */
+void Soe_Show(int count)
+{
+    uint32_t latest = Soe_Latest(), held = Extlog_Slots(EXTLOG_AREA_SOE);
+    Soe_Event event;
+
+    held = (held > SOE_LOG_SIZE) ? held : SOE_LOG_SIZE;
+    held = (latest < held) ? latest : held;
+
+    if ((count <= 0) || ((uint32_t)count > held))
+    {
+        count = (int)held;
+    }
+    for (uint32_t seq = latest - (uint32_t)count + 1U; (count > 0) && (seq <= latest); seq++)
+    {
+        if (Soe_Read(seq, &event))
+        {
+            shellPrint(&shell, "[%u] %u.%03u ms, point = %d, value = %d%s\r\n", event.Sequence, event.Tick,
+                       event.Us, event.Point, event.Value & ~SOE_VALUE_SYNCED,
+                       (event.Value & SOE_VALUE_SYNCED) ? " (master time)" : "");
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), soe, Soe_Show, show soe count);
@@ -21,7 +21,10 @@
 #include "spi.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "dma_mgr.h"
+/*SPI2_TX for the FRAM record writes (extlog.h), or the register image in SPI slave mode (spis.h);
+  DMA1 channel 4 (SPI2_RX) is not used*/
+DMA_HandleTypeDef hdma_spi2_tx;
 /* USER CODE END 0 */
 
 SPI_HandleTypeDef hspi2;
@@ -54,6 +57,20 @@ void MX_SPI2_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN SPI2_Init 2 */
+#if defined(USING_SPI_SLAVE)
+  /*Co-processor link (spis.h): mode 0 bytes, clocked by the host with the hardware NSS input*/
+  hspi2.Init.Mode = SPI_MODE_SLAVE;
+  hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+  hspi2.Init.NSS = SPI_NSS_HARD_INPUT;
+#else
+  /*External FRAM (extlog.h): full duplex bytes with the chip select driven in software*/
+  hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+  hspi2.Init.NSS = SPI_NSS_SOFT;
+#endif
+  if (HAL_SPI_Init(&hspi2) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
   /* USER CODE END SPI2_Init 2 */
 
@@ -83,6 +100,50 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef* spiHandle)
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
   /* USER CODE BEGIN SPI2_MspInit 1 */
+#if defined(USING_SPI_SLAVE)
+    /*Slave: NSS, SCK and MOSI are inputs driven by the host, PB12 (pulled up while unselected) also
+      raises EXTI12 at the end of each transfer (spis.h); MISO is the only output*/
+    GPIO_InitStruct.Pin = GPIO_PIN_13|GPIO_PIN_15;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_INPUT;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    GPIO_InitStruct.Pin = GPIO_PIN_12;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    GPIO_InitStruct.Pin = GPIO_PIN_14;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+#else
+    /*PB12 becomes the FRAM chip select, idle high; PB14 is MISO, pulled up so an absent chip reads 0xFF*/
+    HAL_GPIO_WritePin(GPIOB, GPIO_PIN_12, GPIO_PIN_SET);
+    GPIO_InitStruct.Pin = GPIO_PIN_12;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    GPIO_InitStruct.Pin = GPIO_PIN_14;
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+#endif
+
+    /* SPI2 DMA Init */
+    /* SPI2_TX Init */
+    hdma_spi2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi2_tx.Init.Mode = DMA_NORMAL;
+    /*Channel and priority from the board DMA plan (dma_mgr.h)*/
+    Dma_Setup(&hdma_spi2_tx, DMA_REQ_SPI2_TX);
+
+    __HAL_LINKDMA(spiHandle,hdmatx,hdma_spi2_tx);
+
+    /* DMA1_Channel5_IRQn interrupt configuration (priority from irq_prio.h) */
+    HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
 
   /* USER CODE END SPI2_MspInit 1 */
   }
@@ -107,6 +168,12 @@ void HAL_SPI_MspDeInit(SPI_HandleTypeDef* spiHandle)
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_12|GPIO_PIN_13|GPIO_PIN_15);
 
   /* USER CODE BEGIN SPI2_MspDeInit 1 */
+    HAL_GPIO_DeInit(GPIOB, GPIO_PIN_14);
+#if defined(USING_SPI_SLAVE)
+    HAL_NVIC_DisableIRQ(SPI2_IRQn);
+#endif
+    HAL_DMA_DeInit(spiHandle->hdmatx);
+    HAL_NVIC_DisableIRQ(DMA1_Channel5_IRQn);
 
   /* USER CODE END SPI2_MspDeInit 1 */
   }
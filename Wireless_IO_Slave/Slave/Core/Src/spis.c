@@ -0,0 +1,255 @@
+#include "spis.h"
+#include "spi.h"
+#include "mdrtuslave.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+#if defined(USING_SPI_SLAVE)
+/*任一选择的数据区都放得下后台映像*/
+typedef char Spis_Size_Check[((2U * HOLD_REGISTER_POOL_SIZE <= SPIS_DATA_MAX) &&
+                              ((COIL_POOL_SIZE + 7U) / 8U <= SPIS_DATA_MAX) &&
+                              ((INPUT_COIL_POOL_SIZE + 7U) / 8U <= SPIS_DATA_MAX))
+                                 ? 1
+                                 : -1];
+
+extern DMA_HandleTypeDef hdma_spi2_tx;
+extern osThreadId spisHandle;
+
+static Spis_HandleTypeDef Spis;
+
+/**
+ * @brief	检查选择的范围
+ * @param	Code 功能码(1~4)
+ * @param	Addr 起始地址
+ * @param	Count 数量(位或寄存器)
+ * @retval	true 功能码有效且范围在寄存器池内
+ */
+static bool Spis_Valid(uint8_t Code, uint16_t Addr, uint8_t Count)
+{
+    uint32_t size;
+
+    switch (Code)
+    {
+    case MODBUS_CODE_1:
+        size = COIL_POOL_SIZE;
+        break;
+    case MODBUS_CODE_2:
+        size = INPUT_COIL_POOL_SIZE;
+        break;
+    case MODBUS_CODE_3:
+        size = HOLD_REGISTER_POOL_SIZE;
+        break;
+    case MODBUS_CODE_4:
+        size = INPUT_REGISTER_POOL_SIZE;
+        break;
+    default:
+        return false;
+    }
+    return (Count != 0U) && (Addr < size) && (Count <= size - Addr);
+}
+
+/**
+ * @brief	构建一个映像
+ * @details	寄存器整段按报文格式读出(mdReadU16sPacked 在写入交错时重读)，与Modbus应答的数据区一致
+ * @param	pImage 映像
+ * @param	Code 功能码
+ * @param	Addr 起始地址
+ * @param	Count 数量
+ * @retval	None
+ */
+static void Spis_Build(Spis_Image *pImage, uint8_t Code, uint16_t Addr, uint8_t Count)
+{
+    RegisterPoolHandle regPool = mdhandler->registerPool;
+    uint8_t *p = pImage->Buf;
+    uint16_t len = SPIS_PREFIX_SIZE, crc;
+
+    p[0] = ++Spis.Seq;
+    p[1] = Code;
+    p[2] = HIGH(Addr);
+    p[3] = LOW(Addr);
+    p[4] = Count;
+    switch (Code)
+    {
+    case MODBUS_CODE_1:
+        regPool->ops->mdReadCoilsPacked(regPool, Addr, Count, &p[len]);
+        len += (Count + 7U) / 8U;
+        break;
+    case MODBUS_CODE_2:
+        regPool->ops->mdReadInputCoilsPacked(regPool, Addr, Count, &p[len]);
+        len += (Count + 7U) / 8U;
+        break;
+    case MODBUS_CODE_3:
+        regPool->ops->mdReadU16sPacked(regPool, Addr + HOLD_REGISTER_OFFSET, Count, &p[len]);
+        len += 2U * Count;
+        break;
+    case MODBUS_CODE_4:
+        regPool->ops->mdReadU16sPacked(regPool, Addr + INPUT_REGISTER_OFFSET, Count, &p[len]);
+        len += 2U * Count;
+        break;
+    default:
+        break;
+    }
+    crc = mdCrc16(p, len);
+    p[len++] = LOW(crc);
+    p[len++] = HIGH(crc);
+    pImage->Length = len;
+}
+
+/**
+ * @brief	从头开始发送前台映像
+ * @details	经RCC复位SPI2以丢弃已装入发送缓冲及移位寄存器的字节(从机模式下无法清空)，恢复控制寄存器，
+ *			先启动DMA再使能SPI，第一个字节在主机选中前已装入；接收中断只读取命令头
+ * @param	None
+ * @retval	None
+ */
+static void Spis_Arm(void)
+{
+    const Spis_Image *pImage = &Spis.Image[Spis.Front];
+
+    __HAL_RCC_SPI2_FORCE_RESET();
+    __HAL_RCC_SPI2_RELEASE_RESET();
+    SPI2->CR1 = Spis.Cr1;
+    Spis.Head_Count = 0;
+    HAL_DMA_Start(&hdma_spi2_tx, (uint32_t)pImage->Buf, (uint32_t)&SPI2->DR, pImage->Length);
+    SPI2->CR2 = SPI_CR2_TXDMAEN | SPI_CR2_RXNEIE;
+    SPI2->CR1 = Spis.Cr1 | SPI_CR1_SPE;
+}
+
+/**
+ * @brief	初始化SPI2从机
+ * @details	在 MX_SPI2_Init()(从机模式)及 ModbusInit() 之后调用；默认选择整个输入寄存器池，
+ *			第一个映像在此构建，之后由构建任务刷新
+ * @param	None
+ * @retval	None
+ */
+void Spis_Init(void)
+{
+    memset(&Spis, 0, sizeof(Spis));
+    Spis.Code = MODBUS_CODE_4;
+    Spis.Addr = 0;
+    Spis.Count = INPUT_REGISTER_POOL_SIZE;
+    Spis.Cr1 = hspi2.Instance->CR1 & ~SPI_CR1_SPE;
+    Spis_Build(&Spis.Image[0], Spis.Code, Spis.Addr, Spis.Count);
+    Spis.State = SPIS_FREE;
+    __HAL_GPIO_EXTI_CLEAR_IT(SPIS_NSS_Pin);
+    HAL_NVIC_EnableIRQ(SPI2_IRQn);
+    Spis_Arm();
+}
+
+/**
+ * @brief	SPI2接收中断
+ * @details	裸中断，不调用RTOS；收齐命令头后关闭，其余字节不再读取(溢出由片选释放时的复位清除)
+ * @param	None
+ * @retval	None
+ */
+void Spis_Irq(void)
+{
+    uint8_t data = (uint8_t)SPI2->DR;
+
+    if (Spis.Head_Count < SPIS_HEAD_SIZE)
+    {
+        Spis.Head[Spis.Head_Count++] = data;
+    }
+    if (Spis.Head_Count >= SPIS_HEAD_SIZE)
+    {
+        CLEAR_BIT(SPI2->CR2, SPI_CR2_RXNEIE);
+    }
+}
+
+/**
+ * @brief	片选释放(NSS上升沿)
+ * @details	在EXTI15_10中断中调用；按命令头更新选择(选择变化时丢弃就绪的旧映像)，后台映像就绪时交换，
+ *			然后从头发送前台映像并唤醒构建任务
+ * @param	None
+ * @retval	None
+ */
+void Spis_Nss_Irq(void)
+{
+    uint8_t code = Spis.Head[0], count = Spis.Head[3];
+    uint16_t addr = ToU16(Spis.Head[1], Spis.Head[2]);
+
+    if (!__HAL_GPIO_EXTI_GET_IT(SPIS_NSS_Pin))
+    {
+        return;
+    }
+    __HAL_GPIO_EXTI_CLEAR_IT(SPIS_NSS_Pin);
+    HAL_DMA_Abort(&hdma_spi2_tx);
+    Spis.Stats.Transfers++;
+    if (Spis.Head_Count < SPIS_HEAD_SIZE)
+    {
+        Spis.Stats.Short++;
+    }
+    else if ((code != 0U) && !Spis_Valid(code, addr, count))
+    {
+        Spis.Stats.Rejected++;
+    }
+    else if ((code != 0U) && ((code != Spis.Code) || (addr != Spis.Addr) || (count != Spis.Count)))
+    {
+        Spis.Code = code;
+        Spis.Addr = addr;
+        Spis.Count = count;
+        if (Spis.State == SPIS_READY)
+        {
+            Spis.State = SPIS_FREE;
+        }
+    }
+    if (Spis.State == SPIS_READY)
+    {
+        Spis.Front ^= 1U;
+        Spis.State = SPIS_FREE;
+        Spis.Stats.Swaps++;
+    }
+    Spis_Arm();
+    if (spisHandle != NULL)
+    {
+        osSignalSet(spisHandle, SPIS_SIGNAL);
+    }
+}
+
+/**
+ * @brief	刷新后台映像
+ * @details	在构建任务中调用；构建期间中断不交换，完成时选择已变化则丢弃(片选释放时已再次唤醒)
+ * @param	None
+ * @retval	None
+ */
+void Spis_Refresh(void)
+{
+    Spis_Image *pImage;
+    uint8_t code, count;
+    uint16_t addr;
+
+    if (mdhandler == NULL)
+    {
+        return;
+    }
+    taskENTER_CRITICAL();
+    Spis.State = SPIS_BUILDING;
+    pImage = &Spis.Image[Spis.Front ^ 1U];
+    code = Spis.Code;
+    addr = Spis.Addr;
+    count = Spis.Count;
+    taskEXIT_CRITICAL();
+    Spis_Build(pImage, code, addr, count);
+    taskENTER_CRITICAL();
+    Spis.State = ((code == Spis.Code) && (addr == Spis.Addr) && (count == Spis.Count)) ? SPIS_READY : SPIS_FREE;
+    taskEXIT_CRITICAL();
+    Spis.Stats.Builds++;
+}
+
+/**
+ * @brief	打印SPI从机的选择及统计
+ * @param	None
+ * @retval	None
+ */
+void Spis_Show(void)
+{
+    static const char *const states[] = {"free", "building", "ready"};
+
+    shellPrint(&shell, "code = %d, addr = %d, count = %d, front seq = %d, length = %d, back %s\r\n", Spis.Code, Spis.Addr,
+               Spis.Count, Spis.Image[Spis.Front].Buf[0], Spis.Image[Spis.Front].Length, states[Spis.State]);
+    shellPrint(&shell, "transfers = %u, swaps = %u, builds = %u, short = %u, rejected = %u\r\n", Spis.Stats.Transfers,
+               Spis.Stats.Swaps, Spis.Stats.Builds, Spis.Stats.Short, Spis.Stats.Rejected);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), spis, Spis_Show, show spi slave image);
+#endif
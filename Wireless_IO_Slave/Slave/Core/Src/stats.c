@@ -0,0 +1,158 @@
+#include "stats.h"
+#include "cmsis_os.h"
+#include "shell_port.h"
+#include "mdrtuslave.h"
+#include "usart.h"
+#include "extlog.h"
+
+typedef char Stats_Reg_Size_Check[(STATS_REG_START_ADDR + STATS_REG_SIZE <= INPUT_REGISTER_POOL_SIZE) ? 1 : -1];
+
+/*外部日志中的一条快照:时刻及全部计数*/
+typedef struct
+{
+    uint32_t Tick;
+    uint32_t Value[STATS_REG_SIZE];
+} Stats_Snapshot;
+
+typedef char Stats_Snapshot_Check[(sizeof(Stats_Snapshot) <= EXTLOG_DATA_MAX(EXTLOG_SLOT_STATS)) ? 1 : -1];
+
+static RegisterPoolHandle Stats_Pool;
+
+/**
+ * @brief	汇总协议统计
+ * @details	按导出区的顺序取得各计数，协议栈未创建时计为0
+ * @param	pValue 存放 STATS_REG_SIZE 个计数
+ * @retval	None
+ */
+static void Stats_Collect(uint32_t *pValue)
+{
+    ModbusRTUSlaveHandler pH = mdhandler;
+
+    memset(pValue, 0, STATS_REG_SIZE * sizeof(uint32_t));
+    if (pH)
+    {
+        pValue[0] = pH->rxFrames;
+        pValue[1] = pH->txFrames;
+        pValue[2] = pH->errorCodes[ERROR3];
+        pValue[3] = pH->errorCodes[ERROR4];
+        pValue[4] = pH->errorCodes[ERROR2];
+        pValue[5] = pH->errorCodes[ERROR5];
+        pValue[6] = pH->dupHits;
+        pValue[8] = pH->txDropped;
+        pValue[9] = pH->lossFrames;
+        pValue[10] = pH->exceptions;
+    }
+    pValue[7] = Uart3_Dma.Rx.Overrun;
+}
+
+/**
+ * @brief	把协议统计导出到输入寄存器
+ * @details	在定时器服务任务中周期调用，每 STATS_LOG_EXPORTS 次另写入一条快照
+ * @param	argument 定时器句柄
+ * @retval	None
+ */
+static void Stats_Export(void const *argument)
+{
+    mdU16 regs[STATS_REG_SIZE];
+    uint32_t value[STATS_REG_SIZE];
+    static uint16_t exports = 0;
+    Stats_Snapshot snapshot;
+
+    UNUSED(argument);
+    Stats_Collect(value);
+    if (++exports >= STATS_LOG_EXPORTS)
+    {
+        exports = 0;
+        snapshot.Tick = HAL_GetTick();
+        memcpy(snapshot.Value, value, sizeof(snapshot.Value));
+        Extlog_Write(EXTLOG_AREA_STATS, 0, &snapshot, sizeof(snapshot));
+    }
+    for (uint8_t i = 0; i < STATS_REG_SIZE; i++)
+    {
+        regs[i] = (mdU16)value[i];
+    }
+    Stats_Pool->ops->mdWriteInputRegisters(Stats_Pool, STATS_REG_START_ADDR, STATS_REG_SIZE, regs);
+}
+
+/**
+ * @brief	启动协议统计导出
+ * @param	Pool 寄存器池
+ * @retval	None
+ */
+void Stats_Init(RegisterPoolHandle Pool)
+{
+    static osStaticTimerDef_t control;
+    osTimerStaticDef(Stats, Stats_Export, &control);
+    osTimerId timer;
+
+    Stats_Pool = Pool;
+    timer = Pool ? osTimerCreate(osTimer(Stats), osTimerPeriodic, NULL) : NULL;
+    if (timer)
+    {
+        osTimerStart(timer, STATS_PERIOD);
+    }
+}
+
+/**
+ * @brief	打印协议统计
+ * @param	None
+ * @retval	None
+ */
+void Stats_Show(void)
+{
+    uint32_t v[STATS_REG_SIZE];
+
+    Stats_Collect(v);
+    shellPrint(&shell, "rx = %u, tx = %u, crc = %u, other = %u, length = %u\r\n", v[0], v[1], v[2], v[3], v[4]);
+    shellPrint(&shell, "code = %u, dup = %u, overrun = %u, drops = %u, loss = %u, exception = %u\r\n", v[5], v[6], v[7],
+               v[8], v[9], v[10]);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats, Stats_Show, show protocol counters);
+
+/**
+ * @brief	打印外部日志中的统计快照
+ * @details	由旧到新打印最近 count 条快照，count 不大于0时打印全部
+ * @param	count 条数
+ * @retval	None
+ */
+void Stats_Log_Show(int count)
+{
+    uint32_t latest = Extlog_Latest(EXTLOG_AREA_STATS), held = Extlog_Slots(EXTLOG_AREA_STATS);
+    Stats_Snapshot s;
+
+    held = (latest < held) ? latest : held;
+    if ((count <= 0) || ((uint32_t)count > held))
+    {
+        count = (int)held;
+    }
+    for (uint32_t seq = latest - (uint32_t)count + 1U; (count > 0) && (seq <= latest); seq++)
+    {
+        if (Extlog_Read(EXTLOG_AREA_STATS, seq, &s, sizeof(s)))
+        {
+            shellPrint(&shell, "[%u] %u ms, rx = %u, tx = %u, crc = %u, drops = %u, loss = %u, exception = %u\r\n",
+                       seq, s.Tick, s.Value[0], s.Value[1], s.Value[2], s.Value[8], s.Value[9], s.Value[10]);
+        }
+    }
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats_log, Stats_Log_Show, show logged counters);
+
+/**
+ * @brief	清除协议统计
+ * @details	应答附带的健康信息中的累计错误数不清零
+ * @param	None
+ * @retval	None
+ */
+void Stats_Clear(void)
+{
+    ModbusRTUSlaveHandler pH = mdhandler;
+
+    taskENTER_CRITICAL();
+    if (pH)
+    {
+        pH->rxFrames = pH->txFrames = pH->txDropped = pH->lossFrames = pH->dupHits = pH->exceptions = 0;
+        memset(pH->errorCodes, 0, sizeof(pH->errorCodes));
+    }
+    Uart3_Dma.Rx.Overrun = 0;
+    taskEXIT_CRITICAL();
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), stats_clear, Stats_Clear, clear protocol counters);
@@ -25,11 +25,18 @@
 /* USER CODE BEGIN Includes */
 #include "mdrtuslave.h"
 #include "cmsis_os.h"
+#include "tim.h"
+#include "usart.h"
+#include "shell_port.h"
+#include "dma_mgr.h"
+#include "aout.h"
+#include "spis.h"
+#include "utimer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN TD */
-extern osSemaphoreId ReciveHandle;
+extern osThreadId modbusHandle;
 /* USER CODE END TD */
 
 /* Private define ------------------------------------------------------------*/
@@ -65,7 +72,7 @@ extern UART_HandleTypeDef huart3;
 extern TIM_HandleTypeDef htim1;
 
 /* USER CODE BEGIN EV */
-
+extern DMA_HandleTypeDef hdma_spi2_tx;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -86,66 +93,6 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Memory management fault.
-  */
-void MemManage_Handler(void)
-{
-  /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
-  /* USER CODE END MemoryManagement_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_MemoryManagement_IRQn 0 */
-    /* USER CODE END W1_MemoryManagement_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Prefetch fault, memory access fault.
-  */
-void BusFault_Handler(void)
-{
-  /* USER CODE BEGIN BusFault_IRQn 0 */
-
-  /* USER CODE END BusFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
-    /* USER CODE END W1_BusFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Undefined instruction or illegal state.
-  */
-void UsageFault_Handler(void)
-{
-  /* USER CODE BEGIN UsageFault_IRQn 0 */
-
-  /* USER CODE END UsageFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_UsageFault_IRQn 0 */
-    /* USER CODE END W1_UsageFault_IRQn 0 */
-  }
-}
-
 /**
   * @brief This function handles Debug monitor.
   */
@@ -172,7 +119,7 @@ void DebugMon_Handler(void)
 void DMA1_Channel1_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel1_IRQn 0 */
-
+  Dma_Irq(&hdma_adc1);
   /* USER CODE END DMA1_Channel1_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc1);
   /* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
@@ -186,7 +133,7 @@ void DMA1_Channel1_IRQHandler(void)
 void DMA1_Channel2_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel2_IRQn 0 */
-
+  Dma_Irq(&hdma_usart3_tx);
   /* USER CODE END DMA1_Channel2_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart3_tx);
   /* USER CODE BEGIN DMA1_Channel2_IRQn 1 */
@@ -200,7 +147,7 @@ void DMA1_Channel2_IRQHandler(void)
 void DMA1_Channel3_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel3_IRQn 0 */
-
+  Dma_Irq(&hdma_usart3_rx);
   /* USER CODE END DMA1_Channel3_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart3_rx);
   /* USER CODE BEGIN DMA1_Channel3_IRQn 1 */
@@ -222,30 +169,47 @@ void TIM1_UP_IRQHandler(void)
   /* USER CODE END TIM1_UP_IRQn 1 */
 }
 
+/**
+  * @brief This function handles TIM2 global interrupt.
+  */
+void TIM2_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM2_IRQn 0 */
+#if defined(USING_UTIMER)
+  /*TIM2 runs free and carries the microsecond timers, served on registers only*/
+  Utimer_IRQHandler();
+  return;
+#endif
+  /* USER CODE END TIM2_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim2);
+  /* USER CODE BEGIN TIM2_IRQn 1 */
+
+  /* USER CODE END TIM2_IRQn 1 */
+}
+
+/**
+  * @brief This function handles USART1 global interrupt.
+  */
+void USART1_IRQHandler(void)
+{
+  /* USER CODE BEGIN USART1_IRQn 0 */
+  /*Shell input is taken byte by byte here so the shell task can block instead of polling*/
+  Shell_Rx_IRQHandler();
+  /* USER CODE END USART1_IRQn 0 */
+  HAL_UART_IRQHandler(&huart1);
+  /* USER CODE BEGIN USART1_IRQn 1 */
+
+  /* USER CODE END USART1_IRQn 1 */
+}
+
 /**
   * @brief This function handles USART3 global interrupt.
   */
 void USART3_IRQHandler(void)
 {
   /* USER CODE BEGIN USART3_IRQn 0 */
-    if((__HAL_UART_GET_FLAG(&huart3, UART_FLAG_IDLE) != RESET))	
-    {
-        /*Clear idle interrupt flag*/
-        __HAL_UART_CLEAR_IDLEFLAG(&huart3);
-        /*Stop DMA transmission to prevent busy receiving data and interference during data processing*/
-        HAL_UART_DMAStop(&huart3);
-        /*Get the number of untransmitted data in DMA*/
-        /*Number received = buffersize - the number of data units remaining in the current DMA channel transmission*/
-        mdhandler->receiveBuffer->count =  MODBUS_PDU_SIZE_MAX - __HAL_DMA_GET_COUNTER(&hdma_usart3_rx);
-       /*After opening the serial port interrupt, the semaphore has not been created*/
-       if (ReciveHandle != NULL)
-       {
-         /*Notification task processing*/
-        osSemaphoreRelease(ReciveHandle);
-       }
-       /*Reopen DMA reception*/
-       HAL_UART_Receive_DMA(&huart3, mdhandler->receiveBuffer->buf, MODBUS_PDU_SIZE_MAX);
-    }
+  /*Idle events only publish the received bytes, circular DMA reception keeps running*/
+  Uart_Dma_IRQHandler(&Uart3_Dma);
   /* USER CODE END USART3_IRQn 0 */
   HAL_UART_IRQHandler(&huart3);
   /* USER CODE BEGIN USART3_IRQn 1 */
@@ -253,7 +217,112 @@ void USART3_IRQHandler(void)
   /* USER CODE END USART3_IRQn 1 */
 }
 
+/**
+  * @brief This function handles EXTI line[15:10] interrupts.
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI15_10_IRQn 0 */
+
+  /* USER CODE END EXTI15_10_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(STATUS_Pin);
+  /* USER CODE BEGIN EXTI15_10_IRQn 1 */
+#if defined(USING_SPI_SLAVE)
+  /*PB12 rising: the co-processor released the SPI2 slave select*/
+  Spis_Nss_Irq();
+#endif
+  /* USER CODE END EXTI15_10_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles DMA1 channel5 global interrupt (SPI2_TX, external FRAM log).
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+  Dma_Irq(&hdma_spi2_tx);
+  HAL_DMA_IRQHandler(&hdma_spi2_tx);
+}
+
+#if defined(USING_SPI_SLAVE)
+/**
+  * @brief This function handles SPI2 global interrupt (slave command header bytes).
+  */
+void SPI2_IRQHandler(void)
+{
+  Spis_Irq();
+}
+#endif
+
+#if defined(USING_AOUT)
+/**
+  * @brief This function handles DMA1 channel4 global interrupt (TIM4_CH2, analog output ramp).
+  */
+void DMA1_Channel4_IRQHandler(void)
+{
+  Dma_Irq(&hdma_tim4_ch2);
+  HAL_DMA_IRQHandler(&hdma_tim4_ch2);
+}
+
+/**
+  * @brief This function handles DMA1 channel7 global interrupt (TIM4_UP, analog output ramp).
+  */
+void DMA1_Channel7_IRQHandler(void)
+{
+  Dma_Irq(&hdma_tim4_up);
+  HAL_DMA_IRQHandler(&hdma_tim4_up);
+}
+#endif
+
+#if (RTU_TIMER_FRAMING)
+#if !defined(USING_UTIMER)
+#error "RTU_TIMER_FRAMING runs on the microsecond timers, enable USING_UTIMER"
+#endif
+/*
+ * RTU frame gap timing: two one-shots on the microsecond timers, both counted from the UART idle interrupt
+ */
+static void Rtu_Frame_T15(void *Arg);
+static void Rtu_Frame_T35(void *Arg);
+static Utimer Rtu_T15 = UTIMER_INIT(Rtu_Frame_T15, NULL);
+static Utimer Rtu_T35 = UTIMER_INIT(Rtu_Frame_T35, NULL);
+
+void Rtu_Frame_Start(uint32_t t15, uint32_t t35)
+{
+    uint32_t now = Utimer_Now();
+
+    /*A later idle interrupt restarts both gaps*/
+    Utimer_Start_At(&Rtu_T15, now + t15, 0);
+    Utimer_Start_At(&Rtu_T35, now + t35, 0);
+}
+
+/*t1.5 after the idle interrupt: check whether the line stayed quiet*/
+static void Rtu_Frame_T15(void *Arg)
+{
+    (void)Arg;
+    /*Pull the bytes received since the last idle event into the current frame*/
+    Uart_Dma_Rx_Poll(&Uart3_Dma);
+    mdRTUFrameCheck(mdhandler, mdReceiveBufferPending(mdhandler->receiveBuffer));
+}
+
+/*t3.5 after the idle interrupt: end of frame unless a character arrived meanwhile*/
+static void Rtu_Frame_T35(void *Arg)
+{
+    mdU32 count;
 
+    (void)Arg;
+    Uart_Dma_Rx_Poll(&Uart3_Dma);
+    count = mdReceiveBufferPending(mdhandler->receiveBuffer);
+    /*A character arrived within t3.5: the frame continues, wait for the next idle interrupt*/
+    if (!mdRTUFrameTimeout(mdhandler, count))
+    {
+        return;
+    }
+    /*Frames with an inter-character gap above t1.5 are dropped here, the task is only woken for complete frames*/
+    if (mdRTUFrameCommit(mdhandler, count) && (modbusHandle != NULL))
+    {
+        osSignalSet(modbusHandle, MODBUS_SIGNAL_RX);
+    }
+}
+#endif
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,148 @@
+#include "timesync.h"
+#include "shell_port.h"
+
+static Timesync_HandleTypeDef Timesync;
+
+/**
+ * @brief	按频差推算某一本机时刻的主站时间偏移
+ * @details	关中断后调用
+ * @param	Tick 本机时刻(ms)
+ * @retval	主站时间减本机时间(us)
+ */
+static int64_t Timesync_Predict(uint32_t Tick)
+{
+    return Timesync.Offset + (int64_t)Timesync.Drift * (int32_t)(Tick - Timesync.Base) / 1000;
+}
+
+/**
+ * @brief	处理时间同步请求
+ * @details	在Modbus任务中执行；取样值为主站时刻加单程时延减本机收到的时刻，
+ *			偏移按1/4、频差按1/8的增益跟踪取样值，误差过大时直接跳变
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Timesync_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf, *p = &recbuf[2];
+    uint32_t now = HAL_GetTick(), primask, dt;
+    uint32_t master = ((uint32_t)ToU16(p[0], p[1]) << 16U) | ToU16(p[2], p[3]);
+    int64_t sample, predict;
+    int32_t error = 0, drift;
+    bool step;
+
+    if (handler->receiveBuffer->count != 2U + TIMESYNC_REQUEST_SIZE + 2U)
+    {
+        handler->mdRTUError(handler, ERROR2);
+        return;
+    }
+    sample = (int64_t)(int32_t)(master + ToU16(p[4], p[5]) - now) * 1000;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    predict = Timesync_Predict(now);
+    dt = now - Timesync.Base;
+    step = !Timesync.Synced || (sample - predict > TIMESYNC_STEP_US) || (predict - sample > TIMESYNC_STEP_US);
+    if (step)
+    {
+        Timesync.Offset = sample;
+        Timesync.Drift = Timesync.Synced ? Timesync.Drift : 0;
+        Timesync.Synced = true;
+        Timesync.Stats.Steps++;
+    }
+    else
+    {
+        error = (int32_t)(sample - predict);
+        Timesync.Offset = predict + error / 4;
+        if (dt >= TIMESYNC_DRIFT_MIN)
+        {
+            drift = Timesync.Drift + (int32_t)((int64_t)error * 1000 / (int32_t)dt) / 8;
+            drift = (drift > TIMESYNC_DRIFT_MAX) ? TIMESYNC_DRIFT_MAX : drift;
+            Timesync.Drift = (drift < -TIMESYNC_DRIFT_MAX) ? -TIMESYNC_DRIFT_MAX : drift;
+        }
+    }
+    Timesync.Base = now;
+    __set_PRIMASK(primask);
+    Timesync.Stats.Samples++;
+    Timesync.Stats.Error = error;
+
+    /*广播请求不应答*/
+    if (recbuf[0] != MODBUS_BROADCAST_ID)
+    {
+        mdRTUReply(handler, &recbuf[1], 1U + TIMESYNC_REQUEST_SIZE);
+    }
+}
+
+/**
+ * @brief	注册时间同步功能码
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Timesync_Init(ModbusRTUSlaveHandler handler)
+{
+    Timesync.Synced = false;
+    if (handler)
+    {
+        mdRTURegisterCode(handler, MODBUS_CODE_TIME, Timesync_Handle);
+    }
+}
+
+/**
+ * @brief	把本机时刻换算为主站时间
+ * @details	可在任务及关中断期间调用
+ * @param	Tick 本机时刻(ms)
+ * @param	Us 毫秒内微秒数
+ * @param	pTick 主站时刻(ms)
+ * @param	pUs 毫秒内微秒数
+ * @retval	false:尚未同步或已失步，输出不变
+ */
+bool Timesync_Convert(uint32_t Tick, uint16_t Us, uint32_t *pTick, uint16_t *pUs)
+{
+    uint32_t primask = __get_PRIMASK();
+    int64_t offset;
+    int32_t ms;
+    bool synced;
+
+    __disable_irq();
+    synced = Timesync.Synced && ((uint32_t)(HAL_GetTick() - Timesync.Base) <= TIMESYNC_LOST);
+    offset = Timesync_Predict(Tick) + Us;
+    __set_PRIMASK(primask);
+    if (!synced)
+    {
+        return false;
+    }
+    /*向下取整到毫秒，余数为毫秒内的微秒*/
+    ms = (int32_t)(offset / 1000);
+    ms -= ((offset % 1000) < 0) ? 1 : 0;
+    *pTick = Tick + (uint32_t)ms;
+    *pUs = (uint16_t)(offset - (int64_t)ms * 1000);
+
+    return true;
+}
+
+/**
+ * @brief	取得当前的主站时刻
+ * @param	pTick 主站时刻(ms)
+ * @retval	false:尚未同步或已失步
+ */
+bool Timesync_Now(uint32_t *pTick)
+{
+    uint16_t us;
+
+    return Timesync_Convert(HAL_GetTick(), 0, pTick, &us);
+}
+
+/**
+ * @brief	打印时间同步状态
+ * @param	None
+ * @retval	None
+ */
+void Timesync_Show(void)
+{
+    uint32_t master = 0;
+    bool synced = Timesync_Now(&master);
+
+    shellPrint(&shell, "synced = %d, master = %u ms, local = %u ms, drift = %d ppm, age = %u ms\r\n", synced, master,
+               HAL_GetTick(), Timesync.Drift, HAL_GetTick() - Timesync.Base);
+    shellPrint(&shell, "samples = %u, steps = %u, error = %d us\r\n", Timesync.Stats.Samples, Timesync.Stats.Steps,
+               Timesync.Stats.Error);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), timesync, Timesync_Show, show time sync);
@@ -22,6 +22,12 @@
 
 /* USER CODE BEGIN 0 */
 #include "mdrtuslave.h"
+#include "dma_mgr.h"
+/*USART3接收环长度(半满时提前交付数据，需不小于最长一帧)*/
+#define UART3_RX_RING_SIZE 256U
+/*USART3 DMA驱动:Modbus从站使用*/
+UartDma_HandleTypeDef Uart3_Dma;
+static uint8_t Uart3_Rx_Ring[UART3_RX_RING_SIZE];
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart1;
@@ -83,11 +89,11 @@ void MX_USART3_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART3_Init 2 */
-  /*Idle interrupt*/
-  __HAL_UART_ENABLE_IT(&huart3, UART_IT_IDLE); 
-  // __HAL_UART_ENABLE_IT(&huart1, UART_FLAG_TC);
-  /*DMA receiving function, this sentence must be added. If not, the real data transmitted for the first time cannot be received. It is empty, and the length of the data received at this time is the data length of the buffer*/
-  HAL_UART_Receive_DMA(&huart3, mdhandler->receiveBuffer->buf, MODBUS_PDU_SIZE_MAX);
+  /*Circular DMA reception with half/full/idle events, the DMA is never stopped between frames*/
+  if (!Uart_Dma_Init(&Uart3_Dma, &huart3, Uart3_Rx_Ring, UART3_RX_RING_SIZE))
+  {
+    Error_Handler();
+  }
   /* USER CODE END USART3_Init 2 */
 
 }
@@ -121,6 +127,9 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
 
     __HAL_AFIO_REMAP_USART1_ENABLE();
 
+    /* USART1 interrupt Init */
+    HAL_NVIC_SetPriority(USART1_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspInit 1 */
 
   /* USER CODE END USART1_MspInit 1 */
@@ -172,7 +181,7 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     hdma_usart3_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_usart3_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_usart3_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart3_rx.Init.Mode = DMA_NORMAL;
+    hdma_usart3_rx.Init.Mode = DMA_CIRCULAR;
     hdma_usart3_rx.Init.Priority = DMA_PRIORITY_HIGH;
     if (HAL_DMA_Init(&hdma_usart3_rx) != HAL_OK)
     {
@@ -185,7 +194,9 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     HAL_NVIC_SetPriority(USART3_IRQn, 5, 0);
     HAL_NVIC_EnableIRQ(USART3_IRQn);
   /* USER CODE BEGIN USART3_MspInit 1 */
-
+    /*Channels and priorities from the board DMA plan (dma_mgr.h)*/
+    Dma_Setup(&hdma_usart3_tx, DMA_REQ_USART3_TX);
+    Dma_Setup(&hdma_usart3_rx, DMA_REQ_USART3_RX);
   /* USER CODE END USART3_MspInit 1 */
   }
 }
@@ -207,6 +218,8 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
     */
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_6|GPIO_PIN_7);
 
+    /* USART1 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspDeInit 1 */
 
   /* USER CODE END USART1_MspDeInit 1 */
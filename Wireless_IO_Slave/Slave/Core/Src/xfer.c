@@ -0,0 +1,336 @@
+#include "xfer.h"
+#include "lzss.h"
+#include "soe.h"
+#include "persist.h"
+#include "repeater.h"
+#include "scene.h"
+#include "mdcrc16.h"
+#include "shell_port.h"
+#include "string.h"
+
+typedef char Xfer_Soe_Size_Check[(SOE_LOG_SIZE * XFER_SOE_SIZE <= XFER_RAW_SIZE) ? 1 : -1];
+typedef char Xfer_Blocks_Check[(XFER_BLOCKS_MAX <= 8U) ? 1 : -1];
+typedef char Xfer_Read_Size_Check[(4U + XFER_READ_BLOCKS * XFER_BLOCK <= MODBUS_PDU_SIZE_MAX) ? 1 : -1];
+typedef char Xfer_Forward_Size_Check[(sizeof(Repeater_Entry) * MODBUS_FORWARDS <= XFER_RAW_SIZE) ? 1 : -1];
+
+static Xfer_HandleTypeDef Xfer;
+
+/**
+ * @brief	取出对象的当前内容
+ * @details	SOE按由旧到新排列环内仍保存的记录；配置为掉电保持区的保持寄存器(高字节在前)；
+ *			未启用的对象内容为空
+ * @param	handler Modbus句柄
+ * @param	Object 对象
+ * @param	pBuf 缓冲区(XFER_RAW_SIZE 字节)
+ * @retval	内容字节数
+ */
+static uint16_t Xfer_Snapshot(ModbusRTUSlaveHandler handler, uint8_t Object, uint8_t *pBuf)
+{
+    mdU16 image[PERSIST_REGS];
+    uint32_t latest = Soe_Latest(), seq;
+    uint16_t len = 0;
+    Soe_Event event;
+
+    switch (Object)
+    {
+    case XFER_OBJ_SOE:
+        seq = (latest > SOE_LOG_SIZE) ? latest - SOE_LOG_SIZE + 1U : 1U;
+        for (; (seq <= latest) && (len + XFER_SOE_SIZE <= XFER_RAW_SIZE); seq++)
+        {
+            if (!Soe_Read(seq, &event))
+            {
+                continue;
+            }
+            pBuf[len++] = event.Sequence >> 24U;
+            pBuf[len++] = event.Sequence >> 16U;
+            pBuf[len++] = event.Sequence >> 8U;
+            pBuf[len++] = event.Sequence;
+            pBuf[len++] = event.Tick >> 24U;
+            pBuf[len++] = event.Tick >> 16U;
+            pBuf[len++] = event.Tick >> 8U;
+            pBuf[len++] = event.Tick;
+            pBuf[len++] = event.Us >> 8U;
+            pBuf[len++] = event.Us;
+            pBuf[len++] = event.Point;
+            pBuf[len++] = event.Value;
+        }
+        break;
+    case XFER_OBJ_CONFIG:
+        handler->registerPool->ops->mdReadHoldRegisters(handler->registerPool, PERSIST_START_ADDR, PERSIST_REGS, image);
+        for (uint16_t i = 0; i < PERSIST_REGS; i++)
+        {
+            pBuf[len++] = HIGH(image[i]);
+            pBuf[len++] = LOW(image[i]);
+        }
+        break;
+#if defined(USING_SCENE)
+    case XFER_OBJ_SCENE:
+        len = Scene_Read(pBuf, XFER_RAW_SIZE);
+        break;
+#endif
+    case XFER_OBJ_FORWARD:
+        len = Repeater_Read(pBuf, XFER_RAW_SIZE);
+        break;
+    default:
+        break;
+    }
+    return len;
+}
+
+/**
+ * @brief	把收到的内容写入对象
+ * @details	配置按主站写保持寄存器处理，由掉电保持区延迟写回flash
+ * @param	handler Modbus句柄
+ * @retval	XFER_OK 或 XFER_REJECTED
+ */
+static uint8_t Xfer_Apply(ModbusRTUSlaveHandler handler)
+{
+    mdU16 image[PERSIST_REGS];
+
+    switch (Xfer.Object)
+    {
+    case XFER_OBJ_CONFIG:
+        if (Xfer.Raw_Length != sizeof(image))
+        {
+            return XFER_REJECTED;
+        }
+        for (uint16_t i = 0; i < PERSIST_REGS; i++)
+        {
+            image[i] = ToU16(Xfer.Raw[2U * i], Xfer.Raw[2U * i + 1U]);
+        }
+        if (!handler->registerPool->ops->mdWriteHoldRegisters(handler->registerPool, PERSIST_START_ADDR, PERSIST_REGS, image))
+        {
+            return XFER_REJECTED;
+        }
+        if (handler->mdRTUHoldWritten != NULL)
+        {
+            handler->mdRTUHoldWritten(handler, PERSIST_START_ADDR, PERSIST_REGS);
+        }
+        return XFER_OK;
+    case XFER_OBJ_FORWARD:
+        return Repeater_Write(Xfer.Raw, Xfer.Raw_Length) ? XFER_OK : XFER_REJECTED;
+#if defined(USING_SCENE)
+    case XFER_OBJ_SCENE:
+        return Scene_Write(Xfer.Raw, Xfer.Raw_Length) ? XFER_OK : XFER_REJECTED;
+#endif
+    default:
+        return XFER_REJECTED;
+    }
+}
+
+/**
+ * @brief	按块传输的数据
+ * @param	None
+ * @retval	原样编码时为原始数据，否则为压缩数据
+ */
+static uint8_t *Xfer_Data(void)
+{
+    return (Xfer.Mode == XFER_MODE_LZSS) ? Xfer.Packed : Xfer.Raw;
+}
+
+/**
+ * @brief	写入信息字段
+ * @param	pBuf 信息字段(XFER_INFO_SIZE 字节)
+ * @retval	None
+ */
+static void Xfer_Put_Info(uint8_t *pBuf)
+{
+    pBuf[0] = Xfer.Mode;
+    pBuf[1] = Xfer.Raw_Length >> 8U;
+    pBuf[2] = Xfer.Raw_Length;
+    pBuf[3] = Xfer.Length >> 8U;
+    pBuf[4] = Xfer.Length;
+    pBuf[5] = Xfer.Crc >> 8U;
+    pBuf[6] = Xfer.Crc;
+}
+
+/**
+ * @brief	提交写入的内容
+ * @details	全部块到齐后解压并校验原始数据的CRC再写入对象；重传的提交只回送上次的结果
+ * @param	handler Modbus句柄
+ * @retval	提交结果
+ */
+static uint8_t Xfer_Commit(ModbusRTUSlaveHandler handler)
+{
+    uint8_t blocks = (Xfer.Length + XFER_BLOCK - 1U) / XFER_BLOCK;
+
+    if (Xfer.Committed)
+    {
+        return XFER_OK;
+    }
+    if (Xfer.Received != (uint8_t)((1U << blocks) - 1U))
+    {
+        return XFER_MISSING;
+    }
+    if ((Xfer.Mode == XFER_MODE_LZSS) &&
+        (Lzss_Unpack(Xfer.Packed, Xfer.Length, Xfer.Raw, sizeof(Xfer.Raw)) != Xfer.Raw_Length))
+    {
+        return XFER_CORRUPT;
+    }
+    if (mdCrc16(Xfer.Raw, Xfer.Raw_Length) != Xfer.Crc)
+    {
+        return XFER_CORRUPT;
+    }
+    Xfer.Committed = (Xfer_Apply(handler) == XFER_OK);
+    Xfer.Stats.Commits += Xfer.Committed ? 1U : 0U;
+
+    return Xfer.Committed ? XFER_OK : XFER_REJECTED;
+}
+
+/**
+ * @brief	处理分块传输功能码
+ * @details	在Modbus任务中执行；打开读取时取出对象并压缩(压缩耗时与对象长度成正比，不超过数毫秒)，
+ *			之后主站每次连续读取数块；写入时主站按窗口发出，窗口内的连续写入以广播站号到达、不应答，
+ *			窗口最后一块的应答位图为已收到的块，主站只补发缺少的块
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+static mdVOID Xfer_Handle(ModbusRTUSlaveHandler handler)
+{
+    mdU8 *recbuf = handler->receiveBuffer->buf;
+    mdU32 reclen = handler->receiveBuffer->count;
+    /*只在Modbus任务中使用，不占任务栈*/
+    static mdU8 reply[4U + XFER_READ_BLOCKS * XFER_BLOCK];
+    mdU8 *p = &recbuf[2];
+    uint16_t len = 0, n, offset, packed;
+    bool burst = (recbuf[0] == MODBUS_BROADCAST_ID);
+
+    /*广播站号只接受连续写入，其余操作须按站号请求*/
+    if (burst != ((reclen >= 5U) && (p[0] == XFER_OP_BURST)))
+    {
+        Xfer.Stats.Errors++;
+        if (!burst)
+        {
+            mdRTUReplyException(handler, MODBUS_EXCEPTION_VALUE);
+        }
+        return;
+    }
+    reply[len++] = MODBUS_CODE_XFER;
+    reply[len++] = p[0];
+    switch ((reclen >= 5U) ? p[0] : 0U)
+    {
+    case XFER_OP_OPEN_READ:
+        if ((reclen != 6U) || (p[1] >= XFER_OBJECTS))
+        {
+            break;
+        }
+        Xfer.Object = p[1];
+        Xfer.Write = false;
+        Xfer.Raw_Length = Xfer_Snapshot(handler, Xfer.Object, Xfer.Raw);
+        Xfer.Crc = mdCrc16(Xfer.Raw, Xfer.Raw_Length);
+        /*只在压缩后更短时使用压缩数据*/
+        packed = Xfer.Raw_Length ? Lzss_Pack(Xfer.Raw, Xfer.Raw_Length, Xfer.Packed, Xfer.Raw_Length - 1U) : 0;
+        Xfer.Mode = packed ? XFER_MODE_LZSS : XFER_MODE_STORED;
+        Xfer.Length = packed ? packed : Xfer.Raw_Length;
+        Xfer.Stats.Opens++;
+        reply[len++] = Xfer.Object;
+        Xfer_Put_Info(&reply[len]);
+        mdRTUReply(handler, reply, len + XFER_INFO_SIZE);
+        return;
+    case XFER_OP_READ:
+        offset = (uint16_t)p[1] * XFER_BLOCK;
+        if ((reclen != 7U) || Xfer.Write || (offset >= Xfer.Length) || (p[2] == 0) || (p[2] > XFER_READ_BLOCKS))
+        {
+            break;
+        }
+        n = ((Xfer.Length - offset) < (uint16_t)p[2] * XFER_BLOCK) ? (Xfer.Length - offset) : (uint16_t)p[2] * XFER_BLOCK;
+        reply[len++] = p[1];
+        reply[len++] = n;
+        memcpy(&reply[len], &Xfer_Data()[offset], n);
+        Xfer.Stats.Blocks += (n + XFER_BLOCK - 1U) / XFER_BLOCK;
+        mdRTUReply(handler, reply, len + n);
+        return;
+    case XFER_OP_OPEN_WRITE:
+        if ((reclen != 6U + XFER_INFO_SIZE) || (p[1] == XFER_OBJ_SOE) || (p[1] >= XFER_OBJECTS) ||
+            (p[2] > XFER_MODE_LZSS))
+        {
+            break;
+        }
+        Xfer.Raw_Length = ToU16(p[3], p[4]);
+        Xfer.Length = ToU16(p[5], p[6]);
+        if ((Xfer.Raw_Length > XFER_RAW_SIZE) || (Xfer.Length > XFER_RAW_SIZE) ||
+            ((p[2] == XFER_MODE_STORED) && (Xfer.Length != Xfer.Raw_Length)))
+        {
+            break;
+        }
+        Xfer.Object = p[1];
+        Xfer.Mode = p[2];
+        Xfer.Crc = ToU16(p[7], p[8]);
+        Xfer.Write = true;
+        Xfer.Committed = false;
+        Xfer.Received = 0;
+        Xfer.Stats.Opens++;
+        reply[len++] = Xfer.Object;
+        mdRTUReply(handler, reply, len);
+        return;
+    case XFER_OP_BURST:
+    case XFER_OP_WRITE:
+        offset = (uint16_t)p[1] * XFER_BLOCK;
+        n = (offset < Xfer.Length) ? (((Xfer.Length - offset) < XFER_BLOCK) ? (Xfer.Length - offset) : XFER_BLOCK) : 0;
+        if ((reclen < 7U) || !Xfer.Write || (n == 0) || (p[2] != n) || (reclen != 7U + n))
+        {
+            break;
+        }
+        if (!Xfer.Committed)
+        {
+            memcpy(&Xfer_Data()[offset], &p[3], n);
+            Xfer.Received |= 1U << p[1];
+        }
+        if (burst)
+        {
+            Xfer.Stats.Bursts++;
+            return;
+        }
+        Xfer.Stats.Blocks++;
+        reply[len++] = p[1];
+        reply[len++] = Xfer.Received;
+        mdRTUReply(handler, reply, len);
+        return;
+    case XFER_OP_COMMIT:
+        if ((reclen != 5U) || !Xfer.Write)
+        {
+            break;
+        }
+        reply[len++] = Xfer_Commit(handler);
+        Xfer.Stats.Errors += (reply[len - 1U] != XFER_OK) ? 1U : 0U;
+        mdRTUReply(handler, reply, len);
+        return;
+    default:
+        break;
+    }
+    Xfer.Stats.Errors++;
+    if (!burst)
+    {
+        mdRTUReplyException(handler, MODBUS_EXCEPTION_VALUE);
+    }
+}
+
+/**
+ * @brief	注册分块传输功能码
+ * @details	在 Persist_Init() 及 Repeater_Init() 之后调用
+ * @param	handler Modbus句柄
+ * @retval	None
+ */
+void Xfer_Init(ModbusRTUSlaveHandler handler)
+{
+    if (handler)
+    {
+        mdRTURegisterCode(handler, MODBUS_CODE_XFER, Xfer_Handle);
+    }
+}
+
+/**
+ * @brief	打印当前会话及统计
+ * @param	None
+ * @retval	None
+ */
+void Xfer_Show(void)
+{
+    Xfer_Stats *pX = &Xfer.Stats;
+
+    shellPrint(&shell, "object = %d, %s, mode = %d, raw = %d, length = %d, received = 0x%02x\r\n", Xfer.Object,
+               Xfer.Write ? "write" : "read", Xfer.Mode, Xfer.Raw_Length, Xfer.Length, Xfer.Received);
+    shellPrint(&shell, "opens = %u, blocks = %u, bursts = %u, commits = %u, errors = %u\r\n", pX->Opens, pX->Blocks,
+               pX->Bursts, pX->Commits, pX->Errors);
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), xfer, Xfer_Show, show block transfer);
@@ -0,0 +1,43 @@
+#ifndef __MDCODEC_H__
+#define __MDCODEC_H__
+
+#include "mdtype.h"
+#include "mdconfig.h"
+#include "mdrecbuffer.h"
+#if (MODBUS_FEC)
+#include "mdfec.h"
+#endif
+
+/*成帧编解码器编号(MODBUS_FRAME_CODEC 及 md_codec 命令使用)*/
+#define MODBUS_CODEC_RTU    0U
+#define MODBUS_CODEC_RTU_FP 1U
+#define MODBUS_CODEC_ASCII  2U
+#define MODBUS_CODEC_PIPE   3U
+#define MODBUS_CODECS       4U
+
+/*
+    成帧编解码器:接收帧先就地还原为RTU帧(从机地址+PDU+CRC16)，再交给同一个协议处理器；
+    应答按RTU组织在发送缓冲区中，发送前由编码器加上校验并转换为线路帧
+*/
+struct ModbusCodec
+{
+    const char *name;
+    /*应答帧头(原样发送，不参与校验)，如L101定点模式的目标地址及信道*/
+    const mdU8 *header;
+    mdU8 headerLength;
+    /*接收帧可在中断中按RTU帧过滤(CRC及站号)*/
+    mdBOOL rtuFilter;
+    /*接收帧就地还原为RTU帧并更新 count/crcValid，校验失败返回 mdFALSE；
+    为 NULL 时为透明通道，接收数据不经过协议处理器*/
+    mdSTATUS (*decode)(ReceiveBufferHandle recbuf);
+    /*buf[start, length) 为 从机地址+PDU，就地编码为线路帧，返回整帧长度，超过 size 时返回0*/
+    mdU32 (*encode)(mdU8 *buf, mdU32 start, mdU32 length, mdU32 size);
+};
+
+mdAPI const struct ModbusCodec *mdCodecFind(mdU32 id);
+mdAPI mdVOID mdCodecReplyTo(mdU16 addr, mdU8 channel);
+#if (MODBUS_FEC)
+mdAPI const struct ModbusFecStats *mdCodecFecStats(mdVOID);
+#endif
+
+#endif
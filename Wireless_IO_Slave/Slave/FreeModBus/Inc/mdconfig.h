@@ -10,20 +10,86 @@
 #define CRC_CHECK                   (1) 
 /*ModBus数据帧位数:1bit start + 8bit data + 1bit stop*/
 #define DATA_BITS                   (10)
+/*使用硬件定时器比较检测t1.5/t3.5帧间隔成帧(0:仅依赖串口空闲中断成帧)*/
+#define RTU_TIMER_FRAMING           (0)
+/*上电时使用的成帧编解码器(mdcodec.h):0 RTU，1 L101定点模式帧头+RTU，2 Modbus ASCII*/
+#define MODBUS_FRAME_CODEC          (1)
+/*Modbus ASCII编解码器:应答帧长度约为RTU的两倍，发送缓冲区及发送队列随之加大*/
+#define MODBUS_ASCII                (0)
 
 
+/*协议栈角色:从站映像不含主站请求引擎，公共部分(Common/FreeModBus)按此裁剪*/
+#define MODBUS_ROLE_MASTER          (0)
+/*主机地址(L101定点模式帧头中的应答地址)*/
+#define MASTER_ID                   (0x00)
+/*从机地址(主单元的站号)*/
+#define SLAVE_ID                    (0x03)
+/*Modbus协议栈绑定的串口DMA驱动句柄(usart.c)*/
+#define MODBUS_UART_DMA             Uart3_Dma
+/*接收通知唤醒的Modbus任务句柄(freertos.c)*/
+#define MODBUS_TASK_HANDLE          modbusHandle
+/*固定块内存池:从机协议栈、寄存器池及接收缓冲各一个池，每个池的块数(链接时分配)*/
+#define MODBUS_POOL_BLOCKS          (1)
+/*一个从站上的逻辑单元数(含主单元)，每个单元一个站号及独立的寄存器池(寄存器池的块数随之增加)*/
+#define MODBUS_UNITS                (2)
+/*中继转发表项数:本站作为中继时可转发的下游站号个数*/
+#define MODBUS_FORWARDS             (4)
+/*转发请求后等待下游应答的时间(ms)，不得大于主站为每一跳预留的应答时间，
+超时后同一站号的下一帧按新的请求转发*/
+#define MODBUS_FORWARD_TIMEOUT      (300)
+
 #define MODBUS_PDU_SIZE_MIN         (4)
 #define MODBUS_PDU_SIZE_MAX         (253)
+/*接收帧环的帧数(>=2)，保证处理一帧时后续帧不被覆盖*/
+#define RECEIVE_BUFFER_FRAMES       (3)
+/*异步发送队列的帧数(>=2)*/
+#define TRANSMIT_QUEUE_FRAMES       (2)
+/*每个从机可注册的自定义功能码个数*/
+#define MODBUS_CUSTOM_CODES         (7)
+/*重复帧缓存:最近执行的写命令帧数、可缓存的应答最大长度(含纠错编码增加的17字节)、判定为重传的时间窗(ms)*/
+#define MODBUS_DUP_CACHE            (4)
+#define MODBUS_DUP_REPLY_SIZE       (45)
+#define MODBUS_DUP_WINDOW           (3000)
+/*帧认证(mdauth.c):请求及应答在CRC之前附带序号低字节及24位MAC，仅用于RTU编解码器，运行中由句柄的 auth 指针开关*/
+#define MODBUS_AUTH                 (1)
+/*应用层前向纠错(mdfec.c):整帧RS编码并按字节交织，纠正突发干扰损坏的少量字节而不必重传；
+主站按链路选择纠错等级，从站以请求的等级应答*/
+#define MODBUS_FEC                  (1)
+/*功能码分派统计:各功能码处理函数的调用次数及耗时(DWT周期)，md_prof 命令查看；每次分派增加约数十个周期*/
+#define MODBUS_CODE_PROFILE         (1)
+/*参与统计的功能码个数(按首次出现的顺序占用，用尽后计入其他)*/
+#define MODBUS_PROFILE_CODES        (12)
+/*每个寄存器池可订阅的寄存器变化回调个数*/
+#define MODBUS_REGISTER_WATCHES     (4)
+/*每个寄存器池可登记的32位数据字顺序区段个数(高位字在前的区段)*/
+#define MODBUS_WORD_RANGES          (4)
+/*主站请求队列深度*/
+#define MASTER_REQUEST_QUEUE_SIZE   (8)
+/*主站同时等待应答的最大请求数(目标从站互不相同)*/
+#define MASTER_MAX_PIPELINE         (2)
+/*请求的传输层前缀最大长度(如L101目标节点地址+信道)*/
+#define MASTER_PREFIX_SIZE          (3)
+/*自定义功能码请求的最大数据长度*/
+#define MASTER_DATA_SIZE            (24)
 
 #define REGISTER_WIDTH              (16)
+/*线圈单个位的读改写经Cortex-M3 SRAM位带别名区完成(单条存储指令，中断中可直接调用)，
+寄存器池须位于SRAM位带区(0x20000000~0x200FFFFF)；主机仿真构建中关闭*/
+#ifndef MODBUS_BIT_BAND
+#define MODBUS_BIT_BAND             (1)
+#endif
 
 #define COIL_OFFSET                         (1)
 #define INPUT_COIL_OFFSET                   (10001)
 #define INPUT_REGISTER_OFFSET               (30001)
 #define HOLD_REGISTER_OFFSET                (40001)
-/*每个寄存器组最大寄存器个数(占用4*REGISTER_POOL_MAX_BUFFER <REGISTER_POOL_MAX_REGISTER_NUMBER)*/
+/*每个寄存器组默认寄存器个数(每个寄存器占用2字节，编译期静态分配)*/
 #define REGISTER_POOL_MAX_BUFFER            (32)
-
-#define REGISTER_POOL_MAX_REGISTER_NUMBER   (256)
+/*线圈、输入状态、输入寄存器、保持寄存器各组的寄存器个数*/
+#define COIL_POOL_SIZE                      REGISTER_POOL_MAX_BUFFER
+#define INPUT_COIL_POOL_SIZE                REGISTER_POOL_MAX_BUFFER
+/*输入寄存器另含协议统计区(stats.h)*/
+#define INPUT_REGISTER_POOL_SIZE            (48)
+#define HOLD_REGISTER_POOL_SIZE             REGISTER_POOL_MAX_BUFFER
 
 #endif
@@ -1,24 +0,0 @@
-#ifndef __MDTYPE_H__
-#define __MDTYPE_H__
-
-typedef void                mdVOID;
-typedef int                 mdBit;
-typedef unsigned char       mdBOOL;
-typedef int                 mdSTATUS;
-typedef unsigned char       mdU8;
-typedef unsigned short      mdU16;
-typedef unsigned long       mdU32;
-typedef unsigned long long  mdU64;
-typedef int                 mdFMStatus;
-typedef int                 mdCodeType;
-
-#define mdTRUE              1
-#define mdFALSE             0
-#define mdHigh              1
-#define mdLow               0
-
-#define mdAPI               extern
-#define mdExport            extern
-
-#endif
-
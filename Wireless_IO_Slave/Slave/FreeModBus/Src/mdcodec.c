@@ -0,0 +1,226 @@
+#include "mdcodec.h"
+#include "mdcrc16.h"
+#include "mdrtuslave.h"
+
+#if (USER_MODBUS_LIB)
+#if (MODBUS_FRAME_CODEC == MODBUS_CODEC_ASCII) && (MODBUS_ASCII == 0)
+#error "MODBUS_FRAME_CODEC selects the ASCII codec, enable MODBUS_ASCII"
+#endif
+
+/*定点模式应答帧头:主站地址(2B)+信道，可由 mdCodecReplyTo 修改*/
+static mdU8 mdCodecFPHeader[] = {MASTER_ID, MASTER_ID, MASTER_ID};
+#if (MODBUS_FEC)
+/*最近一帧请求的纠错等级(应答以同一等级编码)及纠错统计*/
+static mdU8 mdCodecFecLevel;
+static struct ModbusFecStats mdCodecFec;
+#endif
+
+/*
+    mdCodecRTUDecode
+        @recbuf 接收缓冲区
+        @return CRC正确返回 mdTRUE
+    接口：RTU帧无需转换，CRC已在接收过程中增量计算；纠错编码的帧先就地还原并重新校验
+*/
+static mdSTATUS mdCodecRTUDecode(ReceiveBufferHandle recbuf)
+{
+#if (MODBUS_FEC)
+    mdCodecFecLevel = mdFecReceive(recbuf, &mdCodecFec);
+#endif
+    return ((CRC_CHECK == 0) || recbuf->crcValid) ? mdTRUE : mdFALSE;
+}
+
+/*
+    mdCodecRTUEncode
+        @buf    发送缓冲区
+        @start  从机地址所在位置(之前为帧头)
+        @length 已写入的长度
+        @size   缓冲区容量
+        @return 整帧长度，空间不足返回0
+    接口：在末尾追加CRC(低字节在前)
+*/
+static mdU32 mdCodecRTUEncode(mdU8 *buf, mdU32 start, mdU32 length, mdU32 size)
+{
+    mdU16 crc;
+
+    if (length + 2U > size)
+    {
+        return 0;
+    }
+    crc = mdCrc16(&buf[start], length - start);
+    buf[length++] = LOW(crc);
+    buf[length++] = HIGH(crc);
+    return length;
+}
+
+#if (MODBUS_FEC)
+/*
+    mdCodecRTUFecEncode
+        @buf    发送缓冲区
+        @start  从机地址所在位置(之前为帧头)
+        @length 已写入的长度
+        @size   缓冲区容量
+        @return 整帧长度，空间不足返回0
+    接口：追加CRC后按最近一帧请求的纠错等级编码(帧头不编码)；编码后超出帧容量时按RTU帧发出
+*/
+static mdU32 mdCodecRTUFecEncode(mdU8 *buf, mdU32 start, mdU32 length, mdU32 size)
+{
+    mdU32 n;
+
+    length = mdCodecRTUEncode(buf, start, length, size);
+    if ((length == 0) || (mdCodecFecLevel == MODBUS_FEC_OFF))
+    {
+        return length;
+    }
+    n = mdFecEncode(&buf[start], length - start, size - start, mdCodecFecLevel);
+    return n ? (start + n) : length;
+}
+
+/*
+    mdCodecFecStats
+        @return 接收帧的纠错统计
+*/
+const struct ModbusFecStats *mdCodecFecStats(mdVOID)
+{
+    return &mdCodecFec;
+}
+#else
+#define mdCodecRTUFecEncode mdCodecRTUEncode
+#endif
+
+#if (MODBUS_ASCII)
+static const char mdCodecHex[] = "0123456789ABCDEF";
+
+/*
+    mdCodecHexValue
+        @c      字符
+        @return 十六进制字符的值，非法字符返回 0xFF
+*/
+static mdU8 mdCodecHexValue(mdU8 c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return (mdU8)(c - '0');
+    }
+    c |= 0x20U;
+    return ((c >= 'a') && (c <= 'f')) ? (mdU8)(c - 'a' + 10U) : 0xFFU;
+}
+
+/*
+    mdCodecASCIIDecode
+        @recbuf 接收缓冲区
+        @return 帧格式及LRC正确返回 mdTRUE
+    接口：|':'|十六进制字符对|LRC|CR|LF| 就地还原为字节(写入位置始终落后于读取位置)，
+    再追加CRC16构成RTU帧，重复帧识别等依赖请求CRC的功能照常工作；
+    接收帧长度受 MODBUS_PDU_SIZE_MAX 限制，ASCII请求的PDU最长约为RTU的一半
+*/
+static mdSTATUS mdCodecASCIIDecode(ReceiveBufferHandle recbuf)
+{
+    mdU8 *buf = recbuf->buf;
+    mdU32 count = recbuf->count, pairs, i;
+    mdU8 lrc = 0, hi, lo;
+    mdU16 crc;
+
+    /*最短帧为 从机地址+功能码+LRC*/
+    if ((count < 9U) || (buf[0] != ':') || (buf[count - 2U] != '\r') || (buf[count - 1U] != '\n') ||
+        ((count - 3U) % 2U != 0))
+    {
+        return mdFALSE;
+    }
+    pairs = (count - 3U) / 2U;
+    for (i = 0; i < pairs; i++)
+    {
+        hi = mdCodecHexValue(buf[1U + 2U * i]);
+        lo = mdCodecHexValue(buf[2U + 2U * i]);
+        if ((hi | lo) & 0xF0U)
+        {
+            return mdFALSE;
+        }
+        buf[i] = (mdU8)((hi << 4U) | lo);
+        lrc += buf[i];
+    }
+    /*包含LRC在内的所有字节之和为0*/
+    if (lrc != 0)
+    {
+        return mdFALSE;
+    }
+    count = pairs - 1U;
+    crc = mdCrc16(buf, count);
+    buf[count++] = LOW(crc);
+    buf[count++] = HIGH(crc);
+    recbuf->count = count;
+    recbuf->crcValid = mdTRUE;
+    return mdTRUE;
+}
+
+/*
+    mdCodecASCIIEncode
+        @buf    发送缓冲区
+        @start  从机地址所在位置
+        @length 已写入的长度
+        @size   缓冲区容量
+        @return 整帧长度，空间不足返回0
+    接口：就地展开为 |':'|十六进制字符对|LRC|CR|LF|，从末尾向前写，第i字节写到 start+1+2i 处，
+    不会覆盖尚未转换的字节
+*/
+static mdU32 mdCodecASCIIEncode(mdU8 *buf, mdU32 start, mdU32 length, mdU32 size)
+{
+    mdU32 n = length - start, i = n;
+    mdU8 lrc = 0, c;
+    mdU8 *out = &buf[start];
+
+    if (start + 2U * n + 5U > size)
+    {
+        return 0;
+    }
+    while (i--)
+    {
+        c = out[i];
+        lrc += c;
+        out[1U + 2U * i] = mdCodecHex[c >> 4U];
+        out[2U + 2U * i] = mdCodecHex[c & 0x0FU];
+    }
+    lrc = (mdU8)(-lrc);
+    out[0] = ':';
+    out[1U + 2U * n] = mdCodecHex[lrc >> 4U];
+    out[2U + 2U * n] = mdCodecHex[lrc & 0x0FU];
+    out[3U + 2U * n] = '\r';
+    out[4U + 2U * n] = '\n';
+    return start + 2U * n + 5U;
+}
+#endif
+
+static const struct ModbusCodec mdCodecTable[MODBUS_CODECS] = {
+    [MODBUS_CODEC_RTU] = {"rtu", NULL, 0, mdTRUE, mdCodecRTUDecode, mdCodecRTUFecEncode},
+    [MODBUS_CODEC_RTU_FP] = {"rtu-fp", mdCodecFPHeader, sizeof(mdCodecFPHeader), mdTRUE, mdCodecRTUDecode,
+                             mdCodecRTUFecEncode},
+#if (MODBUS_ASCII)
+    [MODBUS_CODEC_ASCII] = {"ascii", NULL, 0, mdFALSE, mdCodecASCIIDecode, mdCodecASCIIEncode},
+#endif
+    /*透明通道:接收数据由端口直接转发，协议栈仅在退出前可能发出的应答使用RTU格式*/
+    [MODBUS_CODEC_PIPE] = {"pipe", NULL, 0, mdFALSE, NULL, mdCodecRTUEncode},
+};
+
+/*
+    mdCodecReplyTo
+        @addr    应答目标节点地址
+        @channel 应答信道
+        @return
+    接口：修改定点模式应答帧头，主站以多个L101模块分组轮询时应答发往服务本站的模块，经中继访问时发往中继节点
+*/
+mdVOID mdCodecReplyTo(mdU16 addr, mdU8 channel)
+{
+    mdCodecFPHeader[0] = HIGH(addr);
+    mdCodecFPHeader[1] = LOW(addr);
+    mdCodecFPHeader[2] = channel;
+}
+
+/*
+    mdCodecFind
+        @id     编解码器编号(MODBUS_CODEC_RTU 等)
+        @return 编解码器，不存在或未编译时返回 NULL
+*/
+const struct ModbusCodec *mdCodecFind(mdU32 id)
+{
+    return ((id < MODBUS_CODECS) && (mdCodecTable[id].encode != NULL)) ? &mdCodecTable[id] : NULL;
+}
+#endif
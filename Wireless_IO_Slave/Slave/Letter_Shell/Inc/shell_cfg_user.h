@@ -0,0 +1,14 @@
+#ifndef _SHELL_CFG_USER_H_
+#define _SHELL_CFG_USER_H_
+
+/*从站shell裁剪配置，未列出的配置项取 Common/Letter_Shell/Inc/shell_cfg.h 中的默认值；
+  SHELL_PROFILE 也可在工程的预定义宏中给出*/
+#ifndef SHELL_PROFILE
+#define SHELL_PROFILE SHELL_PROFILE_FIELD_DEBUG
+#endif
+/*量产从站只用于现场诊断时可换用精简后端(shell_lite.c)，命令导出方式不变*/
+// #define SHELL_USING_LITE 1
+/*从站格式化输出的内容较短*/
+#define SHELL_PRINT_BUFFER 128
+
+#endif /* _SHELL_CFG_USER_H_ */
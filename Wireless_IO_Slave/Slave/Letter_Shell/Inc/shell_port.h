@@ -5,7 +5,7 @@
 // #define USING_FREERTOS
 //#define USING_RTTHREAD
 
-/*定义shell缓冲区尺寸*/
+/*定义shell缓冲区尺寸(命令行及历史记录共用，命令行长度为 SHELL_BUFFER_SIZE / (历史深度 + 1))*/
 #define SHELL_BUFFER_SIZE 128U
 
 /*声明shell对象*/
@@ -14,4 +14,23 @@ extern Shell shell;
 /*初始化shell*/
 void User_Shell_Init(void);
 
+/*shell日志缓冲区有数据待发送信号*/
+#define SHELL_SIGNAL_LOG 0x08
+/*shell接收环收到数据信号及接收环长度(2的整数次幂)*/
+#define SHELL_SIGNAL_RX 0x01
+#define SHELL_RX_SIZE 64U
+/*异步写入(shell->write)及低优先级发送任务*/
+extern unsigned short Shell_Log_Write(char *data, unsigned short len);
+extern void Shell_Log_Task(void const *argument);
+/*USART1接收中断中调用*/
+extern void Shell_Rx_IRQHandler(void);
+/*USART1直接读写(Modbus透明通道使用):无数据时读取阻塞等待，写入为阻塞发送*/
+extern unsigned short User_Shell_Read(char *data, unsigned short len);
+extern unsigned short User_Shell_Write(char *data, unsigned short len);
+
+/*shell缓冲区借出/交还，及运行时选择历史记录深度*/
+extern char *Shell_Arena_Lend(unsigned short *pSize);
+extern void Shell_Arena_Return(void);
+extern void Shell_Arena_Split(int depth);
+
 #endif /* _SHELL_PORT_H_ */
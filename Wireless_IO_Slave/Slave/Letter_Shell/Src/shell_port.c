@@ -20,10 +20,14 @@ extern rt_mutex_t shellMutexHandle;
 #else
 #include "cmsis_os.h"
 extern osMutexId shellMutexHandle;
+extern osThreadId shell_logHandle;
+extern osThreadId shellHandle;
 #endif
 /* 定义shell对象*/
 Shell shell;
-char shell_buffer[SHELL_BUFFER_SIZE];
+/*shell输入缓冲区:命令行及历史记录按当前深度等分*/
+static char shell_buffer[SHELL_BUFFER_SIZE];
+static unsigned short Shell_History = SHELL_HISTORY_MAX_NUMBER;
 
 
 /**
@@ -34,14 +38,65 @@ char shell_buffer[SHELL_BUFFER_SIZE];
  *
  * @return unsigned short 实际读取到的字符数量
  */
+/*shell接收环:USART1接收中断写入，shell任务读取*/
+typedef struct
+{
+	char Buffer[SHELL_RX_SIZE];
+	/*自由计数的写入/读取位置*/
+	volatile uint32_t Head, Tail;
+} Shell_RxRing;
+
+static Shell_RxRing Shell_Rx;
+
+/**
+ * @brief shell串口接收中断处理
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Shell_Rx_IRQHandler(void)
+{
+	if (__HAL_UART_GET_FLAG(&SHELL_TARGET_UART, UART_FLAG_RXNE))
+	{
+		/*读DR同时清除RXNE及溢出标志；环满时丢弃*/
+		char data = (char)(SHELL_TARGET_UART.Instance->DR & 0xFF);
+
+		if (Shell_Rx.Head - Shell_Rx.Tail < SHELL_RX_SIZE)
+		{
+			Shell_Rx.Buffer[Shell_Rx.Head % SHELL_RX_SIZE] = data;
+			Shell_Rx.Head++;
+		}
+		if ((shellHandle != NULL) && osKernelRunning())
+		{
+			osSignalSet(shellHandle, SHELL_SIGNAL_RX);
+		}
+	}
+}
+
+/**
+ * @brief shell读取数据函数原型
+ *
+ * @param data shell读取的字符
+ * @param len 请求读取的字符数量
+ *
+ * @return unsigned short 实际读取到的字符数量(无数据时阻塞等待接收中断)
+ */
 unsigned short User_Shell_Read(char *data, unsigned short len)
 {
-	if(HAL_UART_Receive(&SHELL_TARGET_UART, (uint8_t *)data, len, 0x01) != HAL_OK)
-	{	/*串口接收数据失败*/
-		len = 0;
+	unsigned short count = 0;
+
+	while (Shell_Rx.Head == Shell_Rx.Tail)
+	{
+		osSignalWait(SHELL_SIGNAL_RX, osWaitForever);
+	}
+	for (; (count < len) && (Shell_Rx.Head != Shell_Rx.Tail); count++)
+	{
+		data[count] = Shell_Rx.Buffer[Shell_Rx.Tail % SHELL_RX_SIZE];
+		Shell_Rx.Tail++;
 	}
 
-	return len;
+	return count;
 }
 
 /**
@@ -62,6 +117,87 @@ unsigned short User_Shell_Write(char *data, unsigned short len)
 	return len;
 }
 
+/*日志缓冲区尺寸(2的整数次幂)*/
+#define SHELL_LOG_SIZE 512U
+
+/*异步日志缓冲区:任意任务或中断写入，由低优先级的 Shell_Log_Task 合并发送*/
+typedef struct
+{
+	char Buffer[SHELL_LOG_SIZE];
+	/*自由计数的写入/发送位置*/
+	volatile uint32_t Head, Tail;
+	uint32_t Dropped;
+} Shell_LogRing;
+
+static Shell_LogRing Shell_Log;
+
+/**
+ * @brief shell异步写数据
+ *
+ * @param data 需写的字符数据
+ * @param len 需要写入的字符数
+ *
+ * @return unsigned short 实际写入的字符数量(缓冲区不足时整段丢弃并返回0)
+ */
+unsigned short Shell_Log_Write(char *data, unsigned short len)
+{
+	uint32_t primask, head, first;
+
+	if (len == 0U)
+	{
+		return 0;
+	}
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (len > SHELL_LOG_SIZE - (Shell_Log.Head - Shell_Log.Tail))
+	{
+		Shell_Log.Dropped++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	head = Shell_Log.Head % SHELL_LOG_SIZE;
+	first = (len < SHELL_LOG_SIZE - head) ? len : (SHELL_LOG_SIZE - head);
+	memcpy(&Shell_Log.Buffer[head], data, first);
+	memcpy(Shell_Log.Buffer, &data[first], len - first);
+	Shell_Log.Head += len;
+	__set_PRIMASK(primask);
+	/*调度器启动前只缓存，任务运行后统一发送*/
+	if ((shell_logHandle != NULL) && osKernelRunning())
+	{
+		osSignalSet(shell_logHandle, SHELL_SIGNAL_LOG);
+	}
+	return len;
+}
+
+/**
+ * @brief shell日志发送任务
+ *
+ * @param argument 未使用
+ *
+ * @return None
+ */
+void Shell_Log_Task(void const *argument)
+{
+	uint32_t tail, length;
+
+	for (;;)
+	{
+		/*上一次发送期间累积的输出合并为一次写入*/
+		while ((length = Shell_Log.Head - Shell_Log.Tail) != 0U)
+		{
+			tail = Shell_Log.Tail % SHELL_LOG_SIZE;
+			/*只发送到缓冲区末尾的连续部分，回绕部分在下一轮发送*/
+			if (length > SHELL_LOG_SIZE - tail)
+			{
+				length = SHELL_LOG_SIZE - tail;
+			}
+			User_Shell_Write(&Shell_Log.Buffer[tail], (unsigned short)length);
+			Shell_Log.Tail += length;
+		}
+		osSignalWait(SHELL_SIGNAL_LOG, osWaitForever);
+	}
+}
+
 /**
  * @brief 用户shell上锁
  * 
@@ -97,6 +233,58 @@ int userShellUnlock(Shell *shell)
     return 0;
 }
 
+/**
+ * @brief 借出shell输入缓冲区
+ *
+ * @param pSize 缓冲区大小
+ *
+ * @return char* 缓冲区，已借出时返回NULL
+ * @note 只在shell任务停放期间使用(如 USING_L101 的运行模式)，恢复shell前须调用 Shell_Arena_Return 交还；
+ *       借出期间shell丢弃输入
+ */
+char *Shell_Arena_Lend(unsigned short *pSize)
+{
+	if (shell.parser.buffer == NULL)
+	{
+		return NULL;
+	}
+	shellSetArena(&shell, NULL, 0, 0);
+	*pSize = SHELL_BUFFER_SIZE;
+	return shell_buffer;
+}
+
+/**
+ * @brief 交还shell输入缓冲区
+ *
+ * @param None
+ *
+ * @return None
+ * @note 按当前的历史记录深度重新划分缓冲区，命令行及历史记录被清空
+ */
+void Shell_Arena_Return(void)
+{
+	shellSetArena(&shell, shell_buffer, SHELL_BUFFER_SIZE, Shell_History);
+}
+
+/**
+ * @brief 设置历史记录深度
+ *
+ * @param depth 历史记录深度，大于 SHELL_HISTORY_MAX_NUMBER 时按 SHELL_HISTORY_MAX_NUMBER
+ *
+ * @return None
+ * @note 深度越小命令行越长，命令行长度为 SHELL_BUFFER_SIZE / (depth + 1)
+ */
+void Shell_Arena_Split(int depth)
+{
+	Shell_History = (depth <= 0) ? 0U : (((unsigned int)depth > SHELL_HISTORY_MAX_NUMBER) ? SHELL_HISTORY_MAX_NUMBER : (unsigned short)depth);
+	if (shell.parser.buffer != NULL)
+	{
+		Shell_Arena_Return();
+	}
+	shellPrint(&shell, "history = %d, line = %d\r\n", Shell_History, SHELL_BUFFER_SIZE / (Shell_History + 1U));
+}
+SHELL_EXPORT_CMD(SHELL_CMD_PERMISSION(0) | SHELL_CMD_TYPE(SHELL_TYPE_CMD_FUNC), history, Shell_Arena_Split, history depth);
+
 
 /**
  * @brief shell初始化
@@ -107,10 +295,12 @@ int userShellUnlock(Shell *shell)
  */
 void User_Shell_Init(void)
 {
-	shell.write = User_Shell_Write;
+	shell.write = Shell_Log_Write;
 	shell.read = User_Shell_Read;
 	shell.lock = userShellLock;
     shell.unlock = userShellUnlock;
 
 	shellInit(&shell, shell_buffer, SHELL_BUFFER_SIZE);
+	/*接收改为中断驱动，shell任务空闲时不再轮询串口*/
+	__HAL_UART_ENABLE_IT(&SHELL_TARGET_UART, UART_IT_RXNE);
 }